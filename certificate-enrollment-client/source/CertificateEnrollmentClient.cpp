@@ -39,7 +39,18 @@
 #define RESOURCE_ID_CERTIFICATE_NAME "27002"
 #define OBJECT_LWM2M_CERTIFICATE "35011"
 
+// Renewals of different certificates may run side by side: their keys and CSRs are
+// generated and EST requests sent without waiting for the previous certificate to be
+// stored. Storing is still done one certificate at a time, each with its own backup.
+#ifdef MBED_CONF_MBED_CLOUD_CLIENT_MAX_CONCURRENT_RENEWALS
+#define NUMBER_OF_CONCURRENT_RENEWALS MBED_CONF_MBED_CLOUD_CLIENT_MAX_CONCURRENT_RENEWALS
+#else
 #define NUMBER_OF_CONCURRENT_RENEWALS 1
+#endif
+
+#if NUMBER_OF_CONCURRENT_RENEWALS < 1
+#error "max-concurrent-renewals must be at least 1"
+#endif
 
 
 /************************************************************************/
@@ -61,8 +72,8 @@ namespace CertificateEnrollmentClient {
     // Pointer to the EST client object for dealing with the EST service.
     extern const CERT_ENROLLMENT_EST_CLIENT *g_est_client;
 
-    // Data for certificate that is currently being renewed. Will change to list if we need to support multiple renewals
-    static CertificateRenewalDataBase *current_cert = NULL;
+    // Data for the certificates that are currently being renewed, NULL for a free slot
+    static CertificateRenewalDataBase *current_certs[NUMBER_OF_CONCURRENT_RENEWALS];
 
     // ID of the handler we register to the MbedCloudClient event loop
     static int8_t handler_id = -1;
@@ -70,16 +81,24 @@ namespace CertificateEnrollmentClient {
     // Flag that indicates whether the module is initialized
     static bool is_initialized = false;
 
-    // Semaphore for enforcing that only NUMBER_OF_CONCURRENT_RENEWALS (currently 1) request at a time may update current_cert. Hold lock until process finished.
+    // Semaphore counting to NUMBER_OF_CONCURRENT_RENEWALS, one count is held by each renewal in current_certs until the process finished.
     // Important: When pal_osSemaphoreWait called from within event loop - do not block, must set timeout to 0, and fail if failed to acquire lock
-    // Future: For supporting renewals of NUMBER_OF_CONCURRENT_RENEWALS certificates simultaneously - change to semaphore that counts to NUMBER_OF_CONCURRENT_RENEWALS
-    //         and maintain a list of certificates of size NUMBER_OF_CONCURRENT_RENEWALS inside the event loop.
     static palSemaphoreID_t g_renewal_sem = 0;
 
+    /**
+    * \brief Put the renewal data to a free slot of current_certs. Caller must hold a count of g_renewal_sem, so a free slot exists.
+    */
+    static void add_current_cert(CertificateRenewalDataBase *renewal_data);
+
+    /**
+    * \brief Check whether another renewal of the same certificate is in progress.
+    */
+    static bool is_renewal_in_progress(const CertificateRenewalDataBase *renewal_data);
+
 
     /**
     * \brief Finish the renewal process.
-    * Zero current_cert pointer, then release the semaphore. Note that when the semaphore is released - new device renewals may be made.
+    * Free the slot in current_certs, then release the semaphore. Note that when the semaphore is released - new device renewals may be made.
     * Then call renewal_data->finish() and delete renewal_data.
     *
     * \param renewal_data the data of the certificate to be renewed.
@@ -103,10 +122,10 @@ namespace CertificateEnrollmentClient {
     * Create an arm_event_s object and call eventOS_event_send()
     * The event will have an application level priority
     *
-    * \param renewal_data A pointer to an object derived from CertificateRenewalDataBase
     * \param event_type An event identifier
+    * \param renewal_data A pointer to an object derived from CertificateRenewalDataBase, passed to the event handler
     */
-    static ce_status_e schedule_event(event_type_e event_type);
+    static ce_status_e schedule_event(event_type_e event_type, CertificateRenewalDataBase *renewal_data);
 
     /**
     * \brief Callback that will be executed when an EST service response is available
@@ -114,7 +133,7 @@ namespace CertificateEnrollmentClient {
     *
     * \param result Whether the EST client successfully received a certificate from the EST service
     * \param cert_chain structure containing the certificate/chain received from the EST service
-    * \param Context passed when requesting a certificate via the EST client. Currently unused. In the future will be used to identify the relevant CertificateRenewalDataBase object.
+    * \param context The CertificateRenewalDataBase object passed when requesting a certificate via the EST client.
     */
     static void est_cb(est_enrollment_result_e result,
                        cert_chain_context_s *cert_chain,
@@ -210,8 +229,8 @@ void CertificateEnrollmentClient::certificate_renewal_post(void *arg)
     pal_status = pal_osSemaphoreWait(g_renewal_sem, 0, NULL);
 
     if (pal_status == PAL_SUCCESS) {
-        CertificateEnrollmentClient::current_cert = new CertificateEnrollmentClient::CertificateRenewalDataFromServer(data, data_size);
-        if (!CertificateEnrollmentClient::current_cert) {
+        CertificateRenewalDataBase *renewal_data = new CertificateEnrollmentClient::CertificateRenewalDataFromServer(data, data_size);
+        if (!renewal_data) {
             status = CE_STATUS_OUT_OF_MEMORY;
             pal_status = pal_osSemaphoreRelease(g_renewal_sem);
             if (PAL_SUCCESS != pal_status) { // Should never happen
@@ -222,9 +241,11 @@ void CertificateEnrollmentClient::certificate_renewal_post(void *arg)
             return;
         }
 
+        add_current_cert(renewal_data);
+
         // Enqueue the event
-        status = schedule_event(CertificateEnrollmentClient::EVENT_TYPE_RENEWAL_REQUEST);
-        SA_PV_ERR_RECOVERABLE_RETURN_IF((status != CE_STATUS_SUCCESS), certificate_renewal_finish(CertificateEnrollmentClient::current_cert, status), "Error scheduling event");
+        status = schedule_event(CertificateEnrollmentClient::EVENT_TYPE_RENEWAL_REQUEST, renewal_data);
+        SA_PV_ERR_RECOVERABLE_RETURN_IF((status != CE_STATUS_SUCCESS), certificate_renewal_finish(renewal_data, status), "Error scheduling event");
 
     } else {
         SA_PV_LOG_ERR("Failed to take semaphore- device busy\n");
@@ -246,6 +267,7 @@ ce_status_e CertificateEnrollmentClient::certificate_renew(const char *cert_name
 {
     palStatus_t pal_status = PAL_SUCCESS;
     ce_status_e status = CE_STATUS_SUCCESS;
+    CertificateRenewalDataBase *renewal_data = NULL;
 
     SA_PV_ERR_RECOVERABLE_RETURN_IF((!cert_name), CE_STATUS_INVALID_PARAMETER, "Provided NULL certificate name");
     SA_PV_ERR_RECOVERABLE_RETURN_IF((!is_initialized), CE_STATUS_NOT_INITIALIZED, "Certificate Renewal module not initialized");
@@ -255,17 +277,21 @@ ce_status_e CertificateEnrollmentClient::certificate_renew(const char *cert_name
     pal_status = pal_osSemaphoreWait(g_renewal_sem, 0, NULL);
 
     if (pal_status == PAL_SUCCESS) {
-        CertificateEnrollmentClient::current_cert = new CertificateEnrollmentClient::CertificateRenewalDataFromDevice(cert_name);
-        SA_PV_ERR_RECOVERABLE_GOTO_IF((!CertificateEnrollmentClient::current_cert), status = CE_STATUS_OUT_OF_MEMORY, ReleseSemReturn, "Allocation error");
+        renewal_data = new CertificateEnrollmentClient::CertificateRenewalDataFromDevice(cert_name);
+        SA_PV_ERR_RECOVERABLE_GOTO_IF((!renewal_data), status = CE_STATUS_OUT_OF_MEMORY, ReleseSemReturn, "Allocation error");
 
         // Enqueue the event
-        status = schedule_event(CertificateEnrollmentClient::EVENT_TYPE_RENEWAL_REQUEST);
+        status = schedule_event(CertificateEnrollmentClient::EVENT_TYPE_RENEWAL_REQUEST, renewal_data);
         SA_PV_ERR_RECOVERABLE_GOTO_IF((status != CE_STATUS_SUCCESS), status = status, ReleseSemReturn, "Error scheduling event");
 
+        // Event is handled from the event loop, after this function has returned
+        add_current_cert(renewal_data);
+
         // If some error synchronous error has occurred before scheduling the event - release the semaphore we had just taken, 
         // and then return the error without calling the user callback 
 ReleseSemReturn:
         if (status != CE_STATUS_SUCCESS) {
+            delete renewal_data;
             pal_status = pal_osSemaphoreRelease(g_renewal_sem);
             if (PAL_SUCCESS != pal_status) { // Should never happen
                 status = CE_STATUS_ERROR;
@@ -412,8 +438,31 @@ void CertificateEnrollmentClient::finalize()
     }
 }
 
+void CertificateEnrollmentClient::add_current_cert(CertificateRenewalDataBase *renewal_data)
+{
+    for (int i = 0; i < NUMBER_OF_CONCURRENT_RENEWALS; i++) {
+        if (!current_certs[i]) {
+            current_certs[i] = renewal_data;
+            return;
+        }
+    }
+}
+
+bool CertificateEnrollmentClient::is_renewal_in_progress(const CertificateRenewalDataBase *renewal_data)
+{
+    for (int i = 0; i < NUMBER_OF_CONCURRENT_RENEWALS; i++) {
+        const CertificateRenewalDataBase *other = current_certs[i];
+        // Only renewals that got past parsing have a name
+        if (other && other != renewal_data && other->csr && strcmp(other->cert_name, renewal_data->cert_name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void CertificateEnrollmentClient::event_handler(arm_event_s* event)
 {
+    CertificateRenewalDataBase *renewal_data = (CertificateRenewalDataBase *)event->data_ptr;
     SA_PV_LOG_INFO_FUNC_ENTER_NO_ARGS();
 
     switch (event->event_type) {
@@ -421,10 +470,10 @@ void CertificateEnrollmentClient::event_handler(arm_event_s* event)
             // Nothing to do - ce module already initialized
             break;
         case EVENT_TYPE_RENEWAL_REQUEST:
-            certificate_renewal_start(current_cert);
+            certificate_renewal_start(renewal_data);
             break;
         case EVENT_TYPE_EST_RESPONDED:
-            est_response_process(current_cert);
+            est_response_process(renewal_data);
             break;
         default:
             // Should never happen
@@ -448,6 +497,9 @@ void CertificateEnrollmentClient::certificate_renewal_start(CertificateRenewalDa
     ce_status = renewal_data->parse();
     SA_PV_ERR_RECOVERABLE_RETURN_IF((ce_status != CE_STATUS_SUCCESS), certificate_renewal_finish(renewal_data, ce_status), "Parse error");
 
+    // The same keys and backup items can not be used by two renewals at once
+    SA_PV_ERR_RECOVERABLE_RETURN_IF((is_renewal_in_progress(renewal_data)), certificate_renewal_finish(renewal_data, CE_STATUS_DEVICE_BUSY), "Certificate renewal already in progress");
+
     // Create CSR's key handle
     kcm_status = cs_key_pair_new(&(renewal_data->key_handle), true);
     // translate error to some CE native error
@@ -472,7 +524,7 @@ void CertificateEnrollmentClient::certificate_renewal_start(CertificateRenewalDa
     }
 
     // Request a certificate from a CSR via the EST service
-    est_status = g_est_client->est_request_enrollment(cert_name, cert_name_size, renewal_data->csr, renewal_data->csr_size, est_cb, NULL);
+    est_status = g_est_client->est_request_enrollment(cert_name, cert_name_size, renewal_data->csr, renewal_data->csr_size, est_cb, renewal_data);
     // FIXME: Currently commented out. If we find that the CSR must be persistent only during est_request_enrollment call - uncomment, and this should be the only place we free the CSR
     //free(renewal_data->csr);
     SA_PV_ERR_RECOVERABLE_RETURN_IF((est_status != EST_STATUS_SUCCESS), certificate_renewal_finish(renewal_data, CE_STATUS_EST_ERROR), "EST request failed");
@@ -480,7 +532,7 @@ void CertificateEnrollmentClient::certificate_renewal_start(CertificateRenewalDa
     SA_PV_LOG_INFO_FUNC_EXIT_NO_ARGS();
 }
 
-ce_status_e CertificateEnrollmentClient::schedule_event(event_type_e event_type)
+ce_status_e CertificateEnrollmentClient::schedule_event(event_type_e event_type, CertificateRenewalDataBase *renewal_data)
 {
     int8_t event_status;
 
@@ -489,9 +541,9 @@ ce_status_e CertificateEnrollmentClient::schedule_event(event_type_e event_type)
         .sender = 0, // Which tasklet sent us the event is irrelevant to us 
         .event_type = event_type, // Indicate event type 
         .event_id = 0, // We currently do not need an ID for a specific event - event type is enough
-        .data_ptr = 0, // Not needed, data handled in internal structure
+        .data_ptr = renewal_data, // The renewal the event is for
         .priority = ARM_LIB_LOW_PRIORITY_EVENT, // Application level priority
-        .event_data = 0, // With one certificate this is irrelevant. If allow multiple certificates, This will be a certificate descriptor (index in a CertificateRenewalDataBase list)
+        .event_data = 0, // Not needed
     };
 
     SA_PV_LOG_INFO_FUNC_ENTER_NO_ARGS();
@@ -508,24 +560,24 @@ void CertificateEnrollmentClient::est_cb(est_enrollment_result_e result,
                                          void *context)
 {
     ce_status_e status;
+    CertificateRenewalDataBase *renewal_data = (CertificateRenewalDataBase *)context;
     SA_PV_LOG_INFO_FUNC_ENTER("result = %d", result);
 
-    PV_UNUSED_PARAM(context);
     if (result != EST_ENROLLMENT_SUCCESS || cert_chain == NULL) {
-        return certificate_renewal_finish(current_cert, CE_STATUS_EST_ERROR);
+        return certificate_renewal_finish(renewal_data, CE_STATUS_EST_ERROR);
     }
 
     // Cert chain remains persistent until g_est_client->free_cert_chain_context is called
-    current_cert->est_data = cert_chain;
+    renewal_data->est_data = cert_chain;
 
-    status = schedule_event(CertificateEnrollmentClient::EVENT_TYPE_EST_RESPONDED);
+    status = schedule_event(CertificateEnrollmentClient::EVENT_TYPE_EST_RESPONDED, renewal_data);
     if (status != CE_STATUS_SUCCESS) { // If event scheduling fails - free the chain context and finish the process
         SA_PV_LOG_INFO("Error scheduling event");
-        g_est_client->free_cert_chain_context(current_cert->est_data);
+        g_est_client->free_cert_chain_context(renewal_data->est_data);
 
         // Make sure we do not keep an invalid pointer
-        current_cert->est_data = NULL;
-        certificate_renewal_finish(current_cert, status);
+        renewal_data->est_data = NULL;
+        certificate_renewal_finish(renewal_data, status);
     }
 
     SA_PV_LOG_INFO_FUNC_EXIT_NO_ARGS();
@@ -559,7 +611,11 @@ void CertificateEnrollmentClient::certificate_renewal_finish(CertificateRenewalD
     SA_PV_LOG_INFO_FUNC_ENTER("exit_status = %d", exit_status);
 
     // Don't leave an invalid global pointer
-    current_cert = NULL;
+    for (int i = 0; i < NUMBER_OF_CONCURRENT_RENEWALS; i++) {
+        if (current_certs[i] == renewal_data) {
+            current_certs[i] = NULL;
+        }
+    }
 
     // Note: release of the mutex is before the deletion of the object (which holds the allocated cert_name)
     // and before the user callback is invoked (so that the user may call the renewal API successfully from within his callback)
@@ -568,7 +624,7 @@ void CertificateEnrollmentClient::certificate_renewal_finish(CertificateRenewalD
         exit_status = CE_STATUS_ERROR;
     }
 
-    // At this point, new device requests may be made and the global pointer CertificateEnrollmentClient::current_cert may be changed.
+    // At this point, new device requests may be made and the slot in CertificateEnrollmentClient::current_certs may be reused.
     // Therefore, we use the renewal_data pointer that was past as a parameter to this function
     // New server requests will not be made until after this function returns since the response to the server is enqueued into the event loop by renewal_data->finish()
     // and it is guaranteed that the server will not send another request until it receives a response.
@@ -74,32 +74,17 @@ namespace CertificateEnrollmentClient {
         // NOTE: We should treat the TLV's VALUE according to the given type
         //       since there is only one type at the moment no parsing is needed.
 
-        ce_tlv_status_e status;
-        ce_tlv_element_s element;
+        size_t names_count = 0;
 
         cert_name = NULL;
 
-        if (ce_tlv_parser_init(_raw_data, _raw_data_size, &element) != CE_TLV_STATUS_SUCCESS) {
+        // The whole buffer is validated, cert_name points to the first name inside _raw_data
+        if (ce_tlv_parse_cert_names(_raw_data, _raw_data_size, &cert_name, 1, &names_count) != CE_TLV_STATUS_SUCCESS) {
             return CE_STATUS_BAD_INPUT_FROM_SERVER;
         }
 
-        while ((status = ce_tlv_parse_next(&element)) != CE_TLV_STATUS_END) {
-            if (status != CE_TLV_STATUS_SUCCESS) {
-                // something got wrong while parsing
-                return CE_STATUS_BAD_INPUT_FROM_SERVER;
-            }
-
-            // element parsed successfully - check if type supported
-
-            if ((element.type != CE_TLV_TYPE_CERT_NAME) && (is_required(&element))) {
-                return CE_STATUS_BAD_INPUT_FROM_SERVER;
-            } else if ((element.type != CE_TLV_TYPE_CERT_NAME) && (!is_required(&element))) {
-                // unsupported type but optional - ignored
-                continue;
-            }
-
-            cert_name = element.val.text;
-            SA_PV_LOG_INFO("\nParsed certificate to be updated is %s\n", (char *)element.val.text);
+        if (names_count > 1) {
+            SA_PV_LOG_INFO("\nGot %u certificate names, only the first one is renewed\n", (unsigned int)names_count);
         }
 
         if (cert_name == NULL) {
@@ -107,6 +92,8 @@ namespace CertificateEnrollmentClient {
             return CE_STATUS_BAD_INPUT_FROM_SERVER;
         }
 
+        SA_PV_LOG_INFO("\nParsed certificate to be updated is %s\n", cert_name);
+
         return CE_STATUS_SUCCESS;
     };
 
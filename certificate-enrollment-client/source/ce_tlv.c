@@ -98,8 +98,8 @@ static ce_tlv_status_e take_string(ce_tlv_element_s *element)
     ce_tlv_status_e status = take_bytes(element);
     SA_PV_ERR_RECOVERABLE_RETURN_IF((status != CE_TLV_STATUS_SUCCESS), status, "failed in take_bytes()");
     
-    // Assert null terminator at the end
-    if (element->val.bytes[element->len - 1] != '\0') {
+    // Assert null terminator at the end, an empty value has none
+    if (element->len == 0 || element->val.bytes[element->len - 1] != '\0') {
         return CE_TLV_STATUS_TEXT_NOT_TERMINATED;
     }
 
@@ -112,12 +112,9 @@ static ce_tlv_status_e take_value(ce_tlv_element_s *element)
         case CE_TLV_TYPE_CERT_NAME:
             return take_string(element);
         default:
-            // Skip next
-            element->_current += element->len;
-            break;
+            // Skip next, the value is still checked to be inside the buffer
+            return take_bytes(element);
     }
-
-    return CE_TLV_STATUS_SUCCESS;
 }
 
 
@@ -166,6 +163,37 @@ ce_tlv_status_e ce_tlv_parse_next(ce_tlv_element_s *element)
     return CE_TLV_STATUS_SUCCESS;
 }
 
+ce_tlv_status_e ce_tlv_parse_cert_names(const uint8_t *tlv_buf, size_t tlv_buf_len, const char **names_out, size_t max_names, size_t *count_out)
+{
+    ce_tlv_status_e status;
+    ce_tlv_element_s element;
+    size_t count = 0;
+
+    SA_PV_ERR_RECOVERABLE_RETURN_IF((names_out == NULL && max_names != 0), CE_TLV_STATUS_INVALID_ARG, "Invalid names_out");
+    SA_PV_ERR_RECOVERABLE_RETURN_IF((count_out == NULL), CE_TLV_STATUS_INVALID_ARG, "Invalid count_out");
+
+    status = ce_tlv_parser_init(tlv_buf, tlv_buf_len, &element);
+    SA_PV_ERR_RECOVERABLE_RETURN_IF((status != CE_TLV_STATUS_SUCCESS), status, "failed in ce_tlv_parser_init()");
+
+    while ((status = ce_tlv_parse_next(&element)) != CE_TLV_STATUS_END) {
+        SA_PV_ERR_RECOVERABLE_RETURN_IF((status != CE_TLV_STATUS_SUCCESS), status, "failed in ce_tlv_parse_next()");
+
+        if (element.type != CE_TLV_TYPE_CERT_NAME) {
+            // unsupported type, ignored if optional
+            SA_PV_ERR_RECOVERABLE_RETURN_IF((is_required(&element)), CE_TLV_STATUS_UNSUPPORTED_TYPE, "Unsupported required type %u", element.type);
+            continue;
+        }
+
+        if (count < max_names) {
+            names_out[count] = element.val.text;
+        }
+        count++;
+    }
+
+    *count_out = count;
+    return CE_TLV_STATUS_SUCCESS;
+}
+
 #ifdef CERT_RENEWAL_TEST
 static void _append_16bit_number(uint16_t number, ce_tlv_encoder_s *encoder)
 {
@@ -31,7 +31,8 @@ typedef enum  {
     CE_TLV_STATUS_TEXT_NOT_TERMINATED,
     CE_TLV_STATUS_MALFORMED_TLV,
     CE_TLV_STATUS_ERROR,
-    CE_TLV_STATUS_ENCODER_INSUFFICIENT_BUFFER
+    CE_TLV_STATUS_ENCODER_INSUFFICIENT_BUFFER,
+    CE_TLV_STATUS_UNSUPPORTED_TYPE
 } ce_tlv_status_e;
 
 typedef enum {
@@ -63,6 +64,22 @@ ce_tlv_status_e ce_tlv_parse_next(ce_tlv_element_s *element);
 */
 bool is_required(const ce_tlv_element_s *element);
 
+/* Parses a whole TLV buffer in a single pass and collects the certificate names in it.
+*
+* Every element must be well formed, and every required element must be of a supported type,
+* unsupported optional elements are skipped. The names point to the null terminated texts
+* inside tlv_buf, nothing is copied or allocated, so they are valid as long as tlv_buf is.
+*
+* @param tlv_buf[IN] The TLV buffer
+* @param tlv_buf_len[IN] Size of tlv_buf in bytes
+* @param names_out[OUT] Receives the names in the order of the buffer, may be NULL if max_names is 0
+* @param max_names[IN] Number of entries in names_out, the names beyond it are counted but not stored
+* @param count_out[OUT] Number of certificate names in the buffer
+*
+* @return CE_TLV_STATUS_SUCCESS if the whole buffer is valid, or the error of the first faulty element.
+*/
+ce_tlv_status_e ce_tlv_parse_cert_names(const uint8_t *tlv_buf, size_t tlv_buf_len, const char **names_out, size_t max_names, size_t *count_out);
+
 #ifdef CERT_RENEWAL_TEST
 typedef struct ce_tlv_encoder_ {
     uint8_t *buf; // 4 bytes
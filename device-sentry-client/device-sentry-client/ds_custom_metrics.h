@@ -47,8 +47,37 @@
      */
     typedef uint64_t ds_custom_metric_id_t;
 
+    /**
+     * Number of bits of a histogram value that select the bucket within its power of two.
+     * Each power of two is split to 2^DS_HISTOGRAM_SUB_BUCKET_BITS buckets, so a value is
+     * reported with a relative error below 2^-DS_HISTOGRAM_SUB_BUCKET_BITS (12.5% for 3).
+     */
+    #ifndef DS_HISTOGRAM_SUB_BUCKET_BITS
+    #define DS_HISTOGRAM_SUB_BUCKET_BITS 3
+    #endif
+
+    #if (DS_HISTOGRAM_SUB_BUCKET_BITS < 1) || (DS_HISTOGRAM_SUB_BUCKET_BITS > 8)
+    #error "DS_HISTOGRAM_SUB_BUCKET_BITS must be between 1 and 8"
+    #endif
+
+    /**
+     * Number of buckets in a histogram, covering all 32 bit values.
+     */
+    #define DS_HISTOGRAM_BUCKET_COUNT ((32 - DS_HISTOGRAM_SUB_BUCKET_BITS + 1) << DS_HISTOGRAM_SUB_BUCKET_BITS)
+
+    /**
+     * Histogram of 32 bit values, for example latencies in microseconds.
+     * Values below 2^(DS_HISTOGRAM_SUB_BUCKET_BITS + 1) have a bucket each, larger values
+     * share buckets of 2^-DS_HISTOGRAM_SUB_BUCKET_BITS of their power of two.
+     * The counts are cumulative, they are not reset when the histogram is reported.
+     * Zero-initialize it before use.
+     */
+    typedef struct ds_histogram_t {
+        int32_t buckets[DS_HISTOGRAM_BUCKET_COUNT];
+    } ds_histogram_t;
+
     /** Type of the custom metric.
-     * Note: We currently support DS_INT64 only.
+     * Note: We currently support DS_INT64 and DS_HISTOGRAM only.
      */
     typedef enum ds_custom_metrics_value_type_t {
         DS_INVALID_TYPE = 0,                           /** Invalid or uninitialized type.*/
@@ -57,6 +86,7 @@
         DS_FLOAT,                                      /** Numeric float type.*/
         DS_BOOLEAN,                                    /** Boolean type.*/
         DS_OPAQUE_BUFFER,                              /** Byte array.*/
+        DS_HISTOGRAM,                                  /** Distribution of values, ds_histogram_t.*/
 
         DS_MAX_TYPE                                    /** Must be the last item.*/
     } ds_custom_metrics_value_type_t;
@@ -72,9 +102,9 @@
      * @param[out] metric_value_out_addr - Address of the pointer that points to the output buffer.
      *                              Note: You are responsible for managing the memory allocation for the output buffer (Device Sentry does not free this buffer).
      * @param[out] metric_value_type_out - Output type of the metric with an appropriate metric ID.
-     *                              Note: We currently support DS_INT64 only.
+     *                              Note: We currently support DS_INT64 and DS_HISTOGRAM only.
      * @param[out] metric_value_size_out - The metric_value_out_addr buffer size in bytes.
-     *                              Note: We currently support DS_INT64 only.
+     *                              Note: DS_SIZE_OF_INT64 for DS_INT64, sizeof(ds_histogram_t) for DS_HISTOGRAM.
      * @returns
      *      ::DS_STATUS_SUCCESS If the function returns all output values successfully.
      *      One of the ::ds_status_e errors otherwise.
@@ -98,4 +128,12 @@
             void *user_context
         );
 
+    /**
+     * Records a value to the histogram.
+     * The function does not lock, and can be called from any thread or from interrupt context.
+     * @param histogram - Histogram to record to, reported as a DS_HISTOGRAM custom metric.
+     * @param value - Value to record.
+     */
+    void ds_histogram_record(ds_histogram_t *histogram, uint32_t value);
+
 #endif // DS_CUSTOM_METRICS_H
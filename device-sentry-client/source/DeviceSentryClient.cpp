@@ -37,6 +37,7 @@
 #include "key_config_manager.h"
 #include "ds_custom_metrics_internal.h"
 #include "ds_custom_metrics.h"
+#include "mbed-cloud-client/PerfCounters.h"
 
 #ifdef DS_TEST_API
 #include "ds_test_metrics_report.h"
@@ -50,6 +51,14 @@
 
 #define MBED_OS_INVALID_HANDLER_ID (-1)
 
+// Number of times the metrics report is encoded, when it does not fit into the buffer
+#define DS_METRICS_REPORT_ENCODE_ATTEMPTS 3
+
+// Hex dump of each encoded metrics report to the trace
+#ifndef DS_METRICS_REPORT_DUMP
+#define DS_METRICS_REPORT_DUMP 0
+#endif
+
 // Event type that is part of the arm_event_s structure.
 enum event_type_e {
     EVENT_TYPE_INIT, // Init event id - will do nothing currently, initialization called by mbed cloud client.
@@ -152,6 +161,16 @@ static ds_status_e metrics_report_not_labeled_encode(CborEncoder *main_array);
 */
 static ds_status_e metrics_report_labeled_encode(CborEncoder *main_array);
 
+/**
+* \brief Encode metrics report into cbor buffer.
+*
+* \param buffer buffer to encode the report to.
+* \param buffer_size size of the buffer.
+* \param report_size_out output size of the encoded report.
+* \param extra_bytes_needed_out output number of bytes the report did not fit into the buffer by, 0 if it fit.
+*/
+static ds_status_e metrics_report_encode(uint8_t *buffer, size_t buffer_size, size_t *report_size_out, size_t *extra_bytes_needed_out);
+
 /**
  * @brief Releases LWM2M objects
  */
@@ -586,10 +605,8 @@ static void event_handler(arm_event_s* event)
 {
     ds_status_e status = DS_STATUS_SUCCESS;
 
-    // TODO: replace by dynamic alocation
-    // the size of the buffer depends on platform. 
-    uint8_t metrics_report[DS_PLAT_METRICS_REPORT_BUFFER];
-    size_t metrics_report_size = sizeof(metrics_report);
+    uint8_t *metrics_report = NULL;
+    size_t metrics_report_size = 0;
 
     SA_PV_ERR_RECOVERABLE_GOTO_IF((event == NULL), status = DS_STATUS_INVALID_PARAMETER, send_response, "Invalid parameter: event is NULL");
     SA_PV_LOG_INFO_FUNC_ENTER("event = %d", event->event_type);
@@ -604,7 +621,7 @@ static void event_handler(arm_event_s* event)
         send_response, "Unsupported event = %d", event->event_type);
 
     //Create metrics report message
-    status = ds_metrics_report_create(metrics_report, &metrics_report_size);
+    status = ds_metrics_report_create(&metrics_report, &metrics_report_size);
     SA_PV_ERR_RECOVERABLE_GOTO_IF((status != DS_STATUS_SUCCESS), status = status, send_response, "Failed to create report, error=%d", status);
 
 send_response:
@@ -624,8 +641,14 @@ send_response:
         status = (status == DS_STATUS_SUCCESS) ? DS_STATUS_ERROR : status;
     } else {
         SA_PV_LOG_INFO("metrics report (size %" PRIu32 " bytes) was reported to MCC", metrics_report_size_to_send);
+        if (status == DS_STATUS_SUCCESS) {
+            PERF_COUNTER_ADD(DS_REPORTS, 1);
+        }
     }
 
+    // the resource keeps a copy of the value
+    free(metrics_report);
+
     if (status == DS_STATUS_SUCCESS) {
         SA_PV_LOG_INFO_FUNC_EXIT_NO_ARGS();
     } else {
@@ -765,10 +788,10 @@ static ds_status_e encode_policy_id(CborEncoder* main_map)
 {
     if(ds_ctx.is_policy_id_initialized) {
         CborError cbor_err = cbor_encode_uint(main_map, DS_METRIC_POLICY_ID);
-        SA_PV_ERR_RECOVERABLE_RETURN_IF((cbor_err != CborNoError), DS_STATUS_ENCODE_FAILED, "Failed to encode policy id label");
+        SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to encode policy id label");
 
         cbor_err = cbor_encode_text_string(main_map, ds_ctx.policy_id, POLICY_ID_LEN);
-        SA_PV_ERR_RECOVERABLE_RETURN_IF((cbor_err != CborNoError), DS_STATUS_ENCODE_FAILED, "Failed to encode policy_id");
+        SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to encode policy_id");
     }
 
     return DS_STATUS_SUCCESS;
@@ -1011,26 +1034,24 @@ Example of cbor array for MbedOS platform:
     DS_METRIC_POLICY_ID: "0168c6ed50b40000000000010010016a"
 }
 */
-ds_status_e ds_metrics_report_create(uint8_t *metrics_report, size_t *metrics_report_size)
+static ds_status_e metrics_report_encode(uint8_t *buffer, size_t buffer_size, size_t *report_size_out, size_t *extra_bytes_needed_out)
 {
     ds_status_e status = DS_STATUS_SUCCESS;
     CborEncoder cbor_report, main_map, main_array;
 
-    SA_PV_LOG_TRACE_FUNC_ENTER_NO_ARGS();
-    
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((metrics_report == NULL), DS_STATUS_INVALID_PARAMETER, "Invalid parameter: metrics_report is NULL");
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((metrics_report_size == 0), DS_STATUS_INVALID_PARAMETER, "Invalid parameter: metrics_report_size is 0");
-    cbor_encoder_init(&cbor_report, metrics_report, *metrics_report_size, 0);
+    SA_PV_LOG_TRACE_FUNC_ENTER("buffer_size=%" PRIu32, (uint32_t)buffer_size);
+
+    cbor_encoder_init(&cbor_report, buffer, buffer_size, 0);
 
     CborError cbor_err = cbor_encoder_create_map(&cbor_report, &main_map, CborIndefiniteLength);
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((cbor_err != CborNoError), DS_STATUS_ENCODE_FAILED, "Failed to create cbor outer map");
+    SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to create cbor outer map");
 
     cbor_err = cbor_encode_uint(&main_map, DS_METRIC_REPORT_V1);
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((cbor_err != CborNoError), DS_STATUS_ENCODE_FAILED, "Failed to encode version");
+    SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to encode version");
 
     // we don't know how much metrics will be, so put CborIndefiniteLength
     cbor_err = cbor_encoder_create_array(&main_map, &main_array, CborIndefiniteLength);
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((cbor_err != CborNoError), DS_STATUS_ENCODE_FAILED, "Failed to create main array");
+    SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to create main array");
 
     // encode all NOT labeled metrics
     status = metrics_report_not_labeled_encode(&main_array);
@@ -1041,7 +1062,7 @@ ds_status_e ds_metrics_report_create(uint8_t *metrics_report, size_t *metrics_re
     SA_PV_ERR_RECOVERABLE_RETURN_IF((status != DS_STATUS_SUCCESS), DS_STATUS_ENCODE_FAILED, "Failed to add labeled metrics"); 
 
     cbor_err = cbor_encoder_close_container(&main_map, &main_array);
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((cbor_err != CborNoError), DS_STATUS_ENCODE_FAILED, "Failed to close main array");
+    SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to close main array");
 
     if(is_metric_active_by_group_id(DS_METRIC_GROUP_NETWORK)) {
         // encode network active destivations - relevant only for Linux platform, on MbedOS will do nothing
@@ -1053,25 +1074,73 @@ ds_status_e ds_metrics_report_create(uint8_t *metrics_report, size_t *metrics_re
     SA_PV_ERR_RECOVERABLE_RETURN_IF((status != DS_STATUS_SUCCESS), status, "Failed to get policy id");	
 
     cbor_err = cbor_encoder_close_container(&cbor_report, &main_map);
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((cbor_err != CborNoError), DS_STATUS_ENCODE_FAILED, "Failed to close outer map");
-
-    *metrics_report_size = cbor_encoder_get_buffer_size(&cbor_report, metrics_report);
-
-    // print buffer by lines
-    const size_t LINE_SIZE = 32;
-    for (size_t start_offset = 0; start_offset < *metrics_report_size;  start_offset += LINE_SIZE) {
-        // print_size is the minimum between LINE_SIZE and the remainder (*metrics_report_size - start_offset)
-        size_t print_size = (LINE_SIZE > (*metrics_report_size - start_offset)) ? 
-                                (*metrics_report_size - start_offset) : 
-                                LINE_SIZE;
-        (void)print_size;
-        SA_PV_LOG_BYTE_BUFF_TRACE("report buffer", metrics_report + start_offset, (uint16_t)print_size);
-    }
+    SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to close outer map");
+
+    // the buffer size is meaningful only if everything fit into the buffer
+    *extra_bytes_needed_out = cbor_encoder_get_extra_bytes_needed(&cbor_report);
+    *report_size_out = (*extra_bytes_needed_out == 0) ? cbor_encoder_get_buffer_size(&cbor_report, buffer) : 0;
 
-    SA_PV_LOG_TRACE_FUNC_EXIT("metric cbor report size %" PRIu32 " bytes", (uint32_t)(*metrics_report_size));
+    SA_PV_LOG_TRACE_FUNC_EXIT("report_size=%" PRIu32 ", extra_bytes_needed=%" PRIu32, (uint32_t)(*report_size_out), (uint32_t)(*extra_bytes_needed_out));
     return DS_STATUS_SUCCESS;
 }
 
+ds_status_e ds_metrics_report_create(uint8_t **metrics_report_out, size_t *metrics_report_size_out)
+{
+    // size of the buffer for the next report, grows to the size of the largest report encoded so far
+    static size_t report_buffer_size = DS_PLAT_METRICS_REPORT_BUFFER;
+
+    SA_PV_LOG_TRACE_FUNC_ENTER_NO_ARGS();
+
+    SA_PV_ERR_RECOVERABLE_RETURN_IF((metrics_report_out == NULL), DS_STATUS_INVALID_PARAMETER, "Invalid parameter: metrics_report_out is NULL");
+    SA_PV_ERR_RECOVERABLE_RETURN_IF((metrics_report_size_out == NULL), DS_STATUS_INVALID_PARAMETER, "Invalid parameter: metrics_report_size_out is NULL");
+
+    // the metrics are collected again on each attempt, and may have grown since the previous one
+    for (int attempt = 0; attempt < DS_METRICS_REPORT_ENCODE_ATTEMPTS; attempt++) {
+
+        uint8_t *metrics_report = (uint8_t *)malloc(report_buffer_size);
+        SA_PV_ERR_RECOVERABLE_RETURN_IF((metrics_report == NULL), DS_STATUS_ERROR,
+            "Failed to allocate %" PRIu32 " bytes for metrics report", (uint32_t)report_buffer_size);
+
+        size_t report_size = 0, extra_bytes_needed = 0;
+        ds_status_e status = metrics_report_encode(metrics_report, report_buffer_size, &report_size, &extra_bytes_needed);
+        if (status != DS_STATUS_SUCCESS) {
+            free(metrics_report);
+            SA_PV_LOG_TRACE_FUNC_EXIT("status=%d", status);
+            return status;
+        }
+
+        if (extra_bytes_needed == 0) {
+#if DS_METRICS_REPORT_DUMP
+            // print buffer by lines
+            const size_t LINE_SIZE = 32;
+            for (size_t start_offset = 0; start_offset < report_size;  start_offset += LINE_SIZE) {
+                // print_size is the minimum between LINE_SIZE and the remainder (report_size - start_offset)
+                size_t print_size = (LINE_SIZE > (report_size - start_offset)) ? 
+                                        (report_size - start_offset) : 
+                                        LINE_SIZE;
+                (void)print_size;
+                SA_PV_LOG_BYTE_BUFF_TRACE("report buffer", metrics_report + start_offset, (uint16_t)print_size);
+            }
+#endif
+            *metrics_report_out = metrics_report;
+            *metrics_report_size_out = report_size;
+            SA_PV_LOG_TRACE_FUNC_EXIT("metric cbor report size %" PRIu32 " bytes", (uint32_t)report_size);
+            return DS_STATUS_SUCCESS;
+        }
+
+        free(metrics_report);
+
+        // leave some room for the metrics that show up before the next attempt
+        size_t required_size = report_buffer_size + extra_bytes_needed;
+        report_buffer_size = required_size + required_size / 8;
+        SA_PV_LOG_INFO("metrics report requires %" PRIu32 " bytes, encoding again", (uint32_t)required_size);
+    }
+
+    SA_PV_LOG_ERR("Failed to fit metrics report into %" PRIu32 " bytes", (uint32_t)report_buffer_size);
+    SA_PV_LOG_TRACE_FUNC_EXIT_NO_ARGS();
+    return DS_STATUS_ENCODE_FAILED;
+}
+
 
 static ds_status_e metrics_report_not_labeled_encode(CborEncoder *main_array)
 {
@@ -1091,7 +1160,7 @@ static ds_status_e metrics_report_not_labeled_encode(CborEncoder *main_array)
             if (!not_labeled_map_opened) { 
                 //first not_labeled metric, map should be created
                 cbor_err = cbor_encoder_create_map(main_array, &not_labeled_map, CborIndefiniteLength);
-                SA_PV_ERR_RECOVERABLE_RETURN_IF((cbor_err != CborNoError), DS_STATUS_ENCODE_FAILED, "Failed to create not labeled map");
+                SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to create not labeled map");
                 not_labeled_map_opened = true;
             }
             
@@ -1107,10 +1176,10 @@ static ds_status_e metrics_report_not_labeled_encode(CborEncoder *main_array)
                     SA_PV_ERR_RECOVERABLE_RETURN_IF((status != DS_STATUS_SUCCESS), DS_STATUS_ENCODE_FAILED, "Failed to get CPU metrics");
 
                     cbor_err = cbor_map_encode_uint_uint(&not_labeled_map, DS_METRIC_CPU_UP_TIME, cpu_stats.uptime);
-                    SA_PV_ERR_RECOVERABLE_RETURN_IF((cbor_err != CborNoError), DS_STATUS_ENCODE_FAILED, "Failed to encode cpu uptime");
+                    SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to encode cpu uptime");
 
                     cbor_err = cbor_map_encode_uint_uint(&not_labeled_map, DS_METRIC_CPU_IDLE_TIME, cpu_stats.idle_time);
-                    SA_PV_ERR_RECOVERABLE_RETURN_IF((cbor_err != CborNoError), DS_STATUS_ENCODE_FAILED, "Failed to encode cpu idle time");
+                    SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to encode cpu idle time");
 
                     SA_PV_LOG_INFO("cpu metric encoded: uptime=%" PRIu64 ", idle_time=%" PRIu64, cpu_stats.uptime, cpu_stats.idle_time); 
                 }
@@ -1121,7 +1190,7 @@ static ds_status_e metrics_report_not_labeled_encode(CborEncoder *main_array)
                     SA_PV_ERR_RECOVERABLE_RETURN_IF((status != DS_STATUS_SUCCESS), DS_STATUS_ENCODE_FAILED, "Failed to get thread metrics");
 
                     cbor_err = cbor_map_encode_uint_uint(&not_labeled_map, DS_METRIC_THREADS_COUNT, thread_count);
-                    SA_PV_ERR_RECOVERABLE_RETURN_IF((cbor_err != CborNoError), DS_STATUS_ENCODE_FAILED, "Failed to encode thread count");
+                    SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to encode thread count");
 
                     SA_PV_LOG_INFO("thread metric encoded: thread_count=%" PRIu32, thread_count); 
                 }
@@ -1132,10 +1201,10 @@ static ds_status_e metrics_report_not_labeled_encode(CborEncoder *main_array)
                     SA_PV_ERR_RECOVERABLE_RETURN_IF((status != DS_STATUS_SUCCESS), DS_STATUS_ENCODE_FAILED, "Failed to get memory metrics");
 
                     cbor_err = cbor_map_encode_uint_uint(&not_labeled_map, mem_stats.mem_available_id, mem_stats.mem_available_bytes);
-                    SA_PV_ERR_RECOVERABLE_RETURN_IF((cbor_err != CborNoError), DS_STATUS_ENCODE_FAILED, "Failed to encode mem available");
+                    SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to encode mem available");
 
                     cbor_err = cbor_map_encode_uint_uint(&not_labeled_map, mem_stats.mem_used_id, mem_stats.mem_used_bytes);
-                    SA_PV_ERR_RECOVERABLE_RETURN_IF((cbor_err != CborNoError), DS_STATUS_ENCODE_FAILED, "Failed to encode mem used");
+                    SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to encode mem used");
 
                     SA_PV_LOG_INFO("mem metric encoded: available=%" PRIu64 ", used=%" PRIu64, mem_stats.mem_available_bytes, mem_stats.mem_used_bytes); 
                 }
@@ -1159,7 +1228,7 @@ static ds_status_e metrics_report_not_labeled_encode(CborEncoder *main_array)
             if (!not_labeled_map_opened) { 
                 //first not_labeled metric, map should be created
                 cbor_err = cbor_encoder_create_map(main_array, &not_labeled_map, CborIndefiniteLength);
-                SA_PV_ERR_RECOVERABLE_RETURN_IF((cbor_err != CborNoError), DS_STATUS_ENCODE_FAILED, "Failed to create not labeled map");
+                SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to create not labeled map");
                 not_labeled_map_opened = true;
             }
             
@@ -1182,11 +1251,26 @@ static ds_status_e metrics_report_not_labeled_encode(CborEncoder *main_array)
                 );    // ouput value
             SA_PV_ERR_RECOVERABLE_RETURN_IF((status != DS_STATUS_SUCCESS), DS_STATUS_ENCODE_FAILED, "Failed to get custom metric, error = %d", status);
 
-            // Currently we support only int64
+            // put metrice_id (as uint64) to the cbor buffer
+            cbor_err = cbor_encode_uint(&not_labeled_map, custom_metric_id);
+            SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to encode custom metric_id=%" PRIu64, custom_metric_id);
+
+            // Currently we support only int64 and histogram
+            if (metric_value_type_out == DS_HISTOGRAM) {
+
+                SA_PV_ERR_RECOVERABLE_RETURN_IF((metric_value_size_out != sizeof(ds_histogram_t)), DS_STATUS_ENCODE_FAILED, 
+                    "Failed on getting wrong size (= %" PRIu32 ") of the histogram metric value", (uint32_t)metric_value_size_out);
+
+                status = ds_histogram_encode((const ds_histogram_t*)metric_value_out, &not_labeled_map);
+                SA_PV_ERR_RECOVERABLE_RETURN_IF((status != DS_STATUS_SUCCESS), DS_STATUS_ENCODE_FAILED, "Failed to encode custom histogram (metric_id=%" PRIu64 ")", custom_metric_id);
+
+                SA_PV_LOG_INFO("custom metric encoded: metric_id=%" PRIu64 ", histogram", custom_metric_id); 
+                continue;
+            }
 
             // verify that we got int 64 
             SA_PV_ERR_RECOVERABLE_RETURN_IF((metric_value_type_out != DS_INT64), DS_STATUS_ENCODE_FAILED, 
-                "Failed on getting wrong type (= %d) of the metric value. Currently only DS_INT64 is supported!", metric_value_type_out);
+                "Failed on getting wrong type (= %d) of the metric value. Currently only DS_INT64 and DS_HISTOGRAM are supported!", metric_value_type_out);
 
             SA_PV_ERR_RECOVERABLE_RETURN_IF((metric_value_size_out != DS_SIZE_OF_INT64), DS_STATUS_ENCODE_FAILED, 
                 "Failed on getting wrong size (= %" PRIu32 ") of the metric value. Currently Only int 64 bit is supported!", (uint32_t)metric_value_size_out);
@@ -1194,12 +1278,9 @@ static ds_status_e metrics_report_not_labeled_encode(CborEncoder *main_array)
             // cast the output value to int 64
             int64_t value = *(int64_t*) (metric_value_out); 
 
-            // put metrice_id (as uint64) and the value (as int64) to the cbor buffer
-            cbor_err = cbor_encode_uint(&not_labeled_map, custom_metric_id);
-            SA_PV_ERR_RECOVERABLE_RETURN_IF((cbor_err != CborNoError), DS_STATUS_ENCODE_FAILED, "Failed to encode custom metric_id=%" PRIu64, custom_metric_id);
-
+            // put the value (as int64) to the cbor buffer
             cbor_err = cbor_encode_int(&not_labeled_map, value);
-            SA_PV_ERR_RECOVERABLE_RETURN_IF((cbor_err != CborNoError), DS_STATUS_ENCODE_FAILED, "Failed to encode custom metric value (metric_id=%" PRIu64 ", value=%" PRId64 ")", custom_metric_id, value);
+            SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to encode custom metric value (metric_id=%" PRIu64 ", value=%" PRId64 ")", custom_metric_id, value);
 
             SA_PV_LOG_INFO("custom metric encoded: metric_id=%" PRIu64 ", value=%" PRId64, custom_metric_id, value); 
         }
@@ -1207,7 +1288,7 @@ static ds_status_e metrics_report_not_labeled_encode(CborEncoder *main_array)
 
     if (not_labeled_map_opened) {
         cbor_err = cbor_encoder_close_container(main_array, &not_labeled_map);
-        SA_PV_ERR_RECOVERABLE_RETURN_IF((cbor_err != CborNoError), DS_STATUS_ENCODE_FAILED, "Failed to close not labeled map");
+        SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to close not labeled map");
         not_labeled_map_opened = false;
     }
 
@@ -1244,15 +1325,15 @@ static ds_status_e metrics_report_labeled_encode(CborEncoder *main_array)
                     for (uint32_t i = 0; i < network_stats_count; i++) {
                         CborEncoder report_labled_map;
                         CborError cbor_err = cbor_encoder_create_map(main_array, &report_labled_map, CborIndefiniteLength);
-                        SA_PV_ERR_RECOVERABLE_GOTO_IF((cbor_err != CborNoError), status = DS_STATUS_ENCODE_FAILED, release_resources, "Failed to create group map");
+                        SA_PV_ERR_RECOVERABLE_GOTO_IF(DS_CBOR_ENCODE_FAILED(cbor_err), status = DS_STATUS_ENCODE_FAILED, release_resources, "Failed to create group map");
 
                         cbor_err = cbor_encode_uint(&report_labled_map, DS_METRIC_GROUP_LABELS);
-                        SA_PV_ERR_RECOVERABLE_GOTO_IF((cbor_err != CborNoError), status = DS_STATUS_ENCODE_FAILED, release_resources, "Failed to encode group label");
+                        SA_PV_ERR_RECOVERABLE_GOTO_IF(DS_CBOR_ENCODE_FAILED(cbor_err), status = DS_STATUS_ENCODE_FAILED, release_resources, "Failed to encode group label");
 
                         CborEncoder lable;
                         // open map for labeled metrics
                         cbor_err = cbor_encoder_create_map(&report_labled_map, &lable, CborIndefiniteLength);
-                        SA_PV_ERR_RECOVERABLE_GOTO_IF((cbor_err != CborNoError), status = DS_STATUS_ENCODE_FAILED, release_resources, "Failed to create lable map");
+                        SA_PV_ERR_RECOVERABLE_GOTO_IF(DS_CBOR_ENCODE_FAILED(cbor_err), status = DS_STATUS_ENCODE_FAILED, release_resources, "Failed to create lable map");
 
                         // encode network ip data - relevant only for Mbed OS platform, on Linux will do nothing
                         status = ds_plat_labeled_metric_ip_data_encode(&lable, &network_stats[i].ip_data);
@@ -1260,29 +1341,29 @@ static ds_status_e metrics_report_labeled_encode(CborEncoder *main_array)
 
                         // add interface name to lable
                         cbor_err = cbor_encode_uint(&lable, DS_METRIC_LABEL_INTERFACE_NAME);
-                        SA_PV_ERR_RECOVERABLE_GOTO_IF((cbor_err != CborNoError), status = DS_STATUS_ENCODE_FAILED, release_resources, "Failed to encode if name key");
+                        SA_PV_ERR_RECOVERABLE_GOTO_IF(DS_CBOR_ENCODE_FAILED(cbor_err), status = DS_STATUS_ENCODE_FAILED, release_resources, "Failed to encode if name key");
 
                         cbor_err = cbor_encode_text_stringz(&lable, network_stats[i].interface);
-                        SA_PV_ERR_RECOVERABLE_GOTO_IF((cbor_err != CborNoError), status = DS_STATUS_ENCODE_FAILED, release_resources, "Failed to encode if name");
+                        SA_PV_ERR_RECOVERABLE_GOTO_IF(DS_CBOR_ENCODE_FAILED(cbor_err), status = DS_STATUS_ENCODE_FAILED, release_resources, "Failed to encode if name");
 
                         // close map for labeled metrics
                         cbor_err = cbor_encoder_close_container(&report_labled_map, &lable);
-                        SA_PV_ERR_RECOVERABLE_GOTO_IF((cbor_err != CborNoError), status = DS_STATUS_ENCODE_FAILED, release_resources, "Failed to close label map");
+                        SA_PV_ERR_RECOVERABLE_GOTO_IF(DS_CBOR_ENCODE_FAILED(cbor_err), status = DS_STATUS_ENCODE_FAILED, release_resources, "Failed to close label map");
 
                         // add received bytes
                         cbor_err = cbor_map_encode_uint_uint(&report_labled_map, DS_METRIC_BYTES_IN, network_stats[i].recv_bytes);
-                        SA_PV_ERR_RECOVERABLE_GOTO_IF((cbor_err != CborNoError), status = DS_STATUS_ENCODE_FAILED, release_resources, "Failed to encode tcp bytes in");
+                        SA_PV_ERR_RECOVERABLE_GOTO_IF(DS_CBOR_ENCODE_FAILED(cbor_err), status = DS_STATUS_ENCODE_FAILED, release_resources, "Failed to encode tcp bytes in");
 
                         // add sent bytes
                         cbor_err = cbor_map_encode_uint_uint(&report_labled_map, DS_METRIC_BYTES_OUT, network_stats[i].sent_bytes);
-                        SA_PV_ERR_RECOVERABLE_GOTO_IF((cbor_err != CborNoError), status = DS_STATUS_ENCODE_FAILED, release_resources, "Failed to encode tcp bytes out");
+                        SA_PV_ERR_RECOVERABLE_GOTO_IF(DS_CBOR_ENCODE_FAILED(cbor_err), status = DS_STATUS_ENCODE_FAILED, release_resources, "Failed to encode tcp bytes out");
 
                         SA_PV_LOG_INFO("net metric [%" PRIu32 "] if_name=%s, recv_bytes=%" PRIu64 " sent_bytes=%" PRIu64 " encoded", 
                             i, network_stats[i].interface, network_stats[i].recv_bytes, network_stats[i].sent_bytes);
 
                         // close current socket report map
                         cbor_err = cbor_encoder_close_container(main_array, &report_labled_map);
-                        SA_PV_ERR_RECOVERABLE_GOTO_IF((cbor_err != CborNoError), status = DS_STATUS_ENCODE_FAILED, release_resources, "Failed to close group map");
+                        SA_PV_ERR_RECOVERABLE_GOTO_IF(DS_CBOR_ENCODE_FAILED(cbor_err), status = DS_STATUS_ENCODE_FAILED, release_resources, "Failed to close group map");
                     }
             
                     release_resources:
@@ -17,6 +17,7 @@
 #include "ds_metrics_report.h"
 #include "ds_plat_metrics_report.h"
 #include "pv_error_handling.h"
+#include "pal.h"
 
 #ifndef DS_TEST_API
 ds_status_e ds_cpu_stats_get(ds_stats_cpu_t *stats)
@@ -53,14 +54,14 @@ ds_status_e ds_ip_data_encode(CborEncoder *ip_data_map, const ds_stat_ip_data_t
     SA_PV_ERR_RECOVERABLE_RETURN_IF((ip_data == NULL), DS_STATUS_INVALID_PARAMETER, "Invalid parameter: ip_data is NULL");
 
     CborError cbor_err = cbor_encode_uint(ip_data_map, DS_METRIC_LABEL_DEST_IP);
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((cbor_err != CborNoError), DS_STATUS_ENCODE_FAILED, "Failed to encode dest ip key");
+    SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to encode dest ip key");
 
     cbor_err = cbor_encode_text_stringz(ip_data_map, ip_data->ip_addr);
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((cbor_err != CborNoError), DS_STATUS_ENCODE_FAILED, "Failed to encode dest ip addr");
+    SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to encode dest ip addr");
 
     // encode socket port
     cbor_err = cbor_map_encode_uint_uint(ip_data_map, DS_METRIC_LABEL_DEST_PORT, ip_data->port);
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((cbor_err != CborNoError), DS_STATUS_ENCODE_FAILED, "Failed to encode dest port");
+    SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to encode dest port");
 
     SA_PV_LOG_TRACE("net metric ip_addr=%s, port=%" PRIu16 " encoded", ip_data->ip_addr, ip_data->port);
     return DS_STATUS_SUCCESS;
@@ -77,7 +78,7 @@ ds_status_e ds_ip_data_array_encode(const ds_stat_ip_data_t *ip_data_stats, uint
 
         CborEncoder dest_ip_map;
         CborError cbor_err = cbor_encoder_create_map(active_dests_array, &dest_ip_map, CborIndefiniteLength);
-        SA_PV_ERR_RECOVERABLE_RETURN_IF((cbor_err != CborNoError), DS_STATUS_ENCODE_FAILED, "Failed to create %" PRIu32 " dest ip map", i);
+        SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to create %" PRIu32 " dest ip map", i);
 
         // encode ip address to lable
         ds_status_e status = ds_ip_data_encode(&dest_ip_map, &ip_data_stats[i]);
@@ -85,10 +86,67 @@ ds_status_e ds_ip_data_array_encode(const ds_stat_ip_data_t *ip_data_stats, uint
 
         //Close lable map
         cbor_err = cbor_encoder_close_container(active_dests_array, &dest_ip_map);
-        SA_PV_ERR_RECOVERABLE_RETURN_IF((cbor_err != CborNoError), DS_STATUS_ENCODE_FAILED, "Failed to close dest ip map");
+        SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to close dest ip map");
     }
 
     SA_PV_LOG_TRACE_FUNC_EXIT_NO_ARGS();
     return DS_STATUS_SUCCESS;
 }
 
+#define DS_HISTOGRAM_SUB_BUCKET_COUNT (1 << DS_HISTOGRAM_SUB_BUCKET_BITS)
+
+void ds_histogram_record(ds_histogram_t *histogram, uint32_t value)
+{
+    uint32_t index = value;
+
+    if (value >= 2 * DS_HISTOGRAM_SUB_BUCKET_COUNT) {
+        // keep the DS_HISTOGRAM_SUB_BUCKET_BITS bits after the most significant bit
+#if defined(__GNUC__)
+        uint32_t shift = (31 - __builtin_clz(value)) - DS_HISTOGRAM_SUB_BUCKET_BITS;
+#else
+        uint32_t shift = 0;
+        while ((value >> shift) >= 2 * DS_HISTOGRAM_SUB_BUCKET_COUNT) {
+            shift++;
+        }
+#endif
+        index = ((shift + 1) << DS_HISTOGRAM_SUB_BUCKET_BITS) + ((value >> shift) - DS_HISTOGRAM_SUB_BUCKET_COUNT);
+    }
+
+    pal_osAtomicIncrement(&histogram->buckets[index], 1);
+}
+
+ds_status_e ds_histogram_encode(const ds_histogram_t *histogram, CborEncoder *encoder)
+{
+    SA_PV_ERR_RECOVERABLE_RETURN_IF((histogram == NULL), DS_STATUS_INVALID_PARAMETER, "Invalid parameter: histogram is NULL");
+    SA_PV_ERR_RECOVERABLE_RETURN_IF((encoder == NULL), DS_STATUS_INVALID_PARAMETER, "Invalid parameter: encoder is NULL");
+
+    CborEncoder histogram_array;
+    CborError cbor_err = cbor_encoder_create_array(encoder, &histogram_array, CborIndefiniteLength);
+    SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to create histogram array");
+
+    cbor_err = cbor_encode_uint(&histogram_array, DS_HISTOGRAM_SUB_BUCKET_BITS);
+    SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to encode histogram sub bucket bits");
+
+    // the counts may be incremented while encoding, each bucket is read once
+    int32_t previous_index = -1;
+    for (int32_t index = 0; index < DS_HISTOGRAM_BUCKET_COUNT; index++) {
+        int32_t count = histogram->buckets[index];
+        if (count == 0) {
+            continue;
+        }
+
+        cbor_err = cbor_encode_uint(&histogram_array, (uint64_t)(index - previous_index));
+        SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to encode histogram bucket index");
+
+        // the counts are kept signed for the atomic increment, and wrap around after 2^32 values
+        cbor_err = cbor_encode_uint(&histogram_array, (uint32_t)count);
+        SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to encode histogram bucket count");
+
+        previous_index = index;
+    }
+
+    cbor_err = cbor_encoder_close_container(encoder, &histogram_array);
+    SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to close histogram array");
+
+    return DS_STATUS_SUCCESS;
+}
@@ -37,10 +37,13 @@ ds_status_e ds_metrics_config_message_handle(const uint8_t *message, uint16_t me
 /**
 * \brief Create message that contains metrics report.
 *
-* \param metrics_report to metrics buffer to be allocated.
-* \param metrics_report_size to output metrics buffer size.
+* The buffer is allocated to fit the report, starting from DS_PLAT_METRICS_REPORT_BUFFER bytes,
+* and should be released by the caller with free().
+*
+* \param metrics_report_out output allocated metrics buffer.
+* \param metrics_report_size_out output metrics buffer size.
 */
-ds_status_e ds_metrics_report_create(uint8_t *metrics_report, size_t *metrics_report_size);
+ds_status_e ds_metrics_report_create(uint8_t **metrics_report_out, size_t *metrics_report_size_out);
 
 /**
  * @brief Returns current minimal report interval.
@@ -21,6 +21,7 @@
 #include <stdint.h>
 #include "ds_status.h"
 #include "tinycbor.h"
+#include "ds_custom_metrics.h"
 
 // The size is suitable for IPV4 and IPV6 (if we will use IPV6 protocol it will take 39 bytes)
 #define DS_MAX_IP_ADDR_SIZE 40
@@ -41,6 +42,11 @@
 // Note: for custom metrics see include files ds_custom_metrics_*.h
 #define DS_MAX_METRIC_NUMBER 4
 
+/* Encoding into a buffer that is too small continues and counts the missing bytes,
+   so CborErrorOutOfMemory is not a failure. The report is encoded again into a
+   buffer of the required size. */
+#define DS_CBOR_ENCODE_FAILED(cbor_err) (((cbor_err) != CborNoError) && ((cbor_err) != CborErrorOutOfMemory))
+
 
 /** Metrics group identifiers.
  * This enums are used in configuration messages (start/stop metric collection) that are sent from Pelion to MCC.
@@ -205,4 +211,18 @@ ds_status_e ds_ip_data_encode(CborEncoder *ip_data_map, const ds_stat_ip_data_t
  */
 ds_status_e ds_ip_data_array_encode(const ds_stat_ip_data_t *ip_data_stats, uint32_t ip_data_stats_count, CborEncoder *active_dests_array);
 
+/**
+ * @brief Encodes histogram to a cbor array of the non-empty buckets.
+ * 
+ * The array starts with DS_HISTOGRAM_SUB_BUCKET_BITS, followed by a pair for each non-empty bucket:
+ * the distance of the bucket index from the previous non-empty bucket (from -1 for the first), and the count.
+ * Bucket index i < 2^(DS_HISTOGRAM_SUB_BUCKET_BITS + 1) holds the value i, larger buckets hold values
+ * from (2^DS_HISTOGRAM_SUB_BUCKET_BITS + i % 2^DS_HISTOGRAM_SUB_BUCKET_BITS) << (i / 2^DS_HISTOGRAM_SUB_BUCKET_BITS - 1).
+ * 
+ * @param histogram histogram to encode.
+ * @param encoder cbor container to which the histogram array is encoded.
+ * @return ds_status_e DS_STATUS_SUCCESS on successful operation of the function, or error code otherwise.
+ */
+ds_status_e ds_histogram_encode(const ds_histogram_t *histogram, CborEncoder *encoder);
+
 #endif // DS_METRICS_REPORT_H
@@ -18,87 +18,229 @@
 #include "ds_plat_metrics_report.h"
 #include "pv_error_handling.h"
 #include <sys/sysinfo.h>
-#include <stdio.h> 
+#include <stdio.h>
 #include <sys/sysinfo.h>
 #include <netinet/tcp.h>
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 typedef enum {
-    UDPV4, 
+    UDPV4,
     TCPV4,
     PROTOCOL_TYPE_MAX
 } ds_net_protocol_type_t;
 
 /**
- * @brief Extracts ip data (ip address and ip port) from rem_address linux field.
- * 
- * @param rem_address_field the field in the linux format, in which the remote address is reported in /proc/net{protocol}.
- * @param ip_data_out out put ip data
- * @return ds_status_e DS_STATUS_SUCCESS on successful operation of the function, or error code otherwise. 
- *                     In case of success, ip_data_out will be filled.  
+ * @brief /proc file that is kept open between reports.
+ *
+ * The kernel generates the content again on every read from offset 0, so the file is opened once and read with pread().
  */
-static ds_status_e extract_ip_addr_and_port(const char *rem_address_field, ds_stat_ip_data_t * ip_data_out);
+typedef struct {
+    const char *path;
+    int fd;
+} ds_proc_file_t;
+
+static ds_proc_file_t proc_uptime = { "/proc/uptime", -1 };
+static ds_proc_file_t proc_loadavg = { "/proc/loadavg", -1 };
+static ds_proc_file_t proc_meminfo = { "/proc/meminfo", -1 };
+static ds_proc_file_t proc_net_dev = { "/proc/net/dev", -1 };
+static ds_proc_file_t proc_net_protocol[PROTOCOL_TYPE_MAX] = { { "/proc/net/udp", -1 }, { "/proc/net/tcp", -1 } };
+
+// content of the last read file, reports are created from a single thread
+static char *proc_buffer = NULL;
+static size_t proc_buffer_size = 0;
+
+// initial size of proc_buffer, doubled while the content does not fit
+#define PROC_BUFFER_INITIAL_SIZE 16384
+
+// number of configured CPUs, does not change while running
+static int cpus_num = 0;
+
+/**
+ * @brief Reads the whole content of a /proc file.
+ *
+ * @param file the file to read, opened on first use.
+ * @param content_out output parameter that will point to the null terminated content, valid until the next read.
+ * @return ds_status_e DS_STATUS_SUCCESS on successful operation of the function, or error code otherwise.
+ */
+static ds_status_e proc_file_read(ds_proc_file_t *file, const char **content_out);
+
+/**
+ * @brief Set of ip addresses and ports, used to report each destination once.
+ */
+typedef struct {
+    uint64_t *keys;     // 0 marks an empty slot
+    uint32_t capacity;  // power of two
+    uint32_t count;
+} ds_ip_data_set_t;
+
+/**
+ * @brief Adds ip address and port to the set.
+ *
+ * @param set the set.
+ * @param ip_addr ip address in network byte order, as reported in /proc/net/{protocol}.
+ * @param port port number.
+ * @param added_out output parameter that will be true if the ip data was not in the set before.
+ * @return ds_status_e DS_STATUS_SUCCESS on successful operation of the function, or error code otherwise.
+ */
+static ds_status_e ip_data_set_add(ds_ip_data_set_t *set, uint32_t ip_addr, uint16_t port, bool *added_out);
+
+/**
+ * @brief Extracts ip data (ip address and ip port) and connection state from a /proc/net/{protocol} line.
+ *
+ * @param line the line in the linux format, in which the remote address is the third field and the state the fourth.
+ * @param ip_addr_out output remote ip address in network byte order.
+ * @param port_out output remote port.
+ * @param connection_state_out output socket state.
+ * @return true if the line was parsed.
+ */
+static bool parse_socket_line(const char *line, uint32_t *ip_addr_out, uint16_t *port_out, unsigned int *connection_state_out);
 
 /**
  * @brief Checks if the linux rem_address should be reported or not.
- * 
- * @param rem_address_field the field in the linux format, in which the remote address is reported in /proc/net{protocol}.
+ *
+ * @param ip_addr remote ip address, how it reported in /proc/net{protocol}.
  * @param connection_state_field socket state field, how it reported in /proc/net{protocol}.
  * @param protocol tcp or udp.
  * @return true if the address should not be reported.
  * @return false if the address should be reported.
  */
-static bool avoid_report_remote_address(const char *rem_address_field, int connection_state_field, ds_net_protocol_type_t protocol);
+static bool avoid_report_remote_address(uint32_t ip_addr, unsigned int connection_state_field, ds_net_protocol_type_t protocol);
 
-/**
- * @brief Checks if the ip address and port already reported.  
- * 
- * @param stats_array array of ip data to search in
- * @param number_items_to_search index of item below which the ip_data can possibly be found (the range includs the index it self).
- *                          Note the rabge is [0, ..., number_items_to_search]
- * @param ip_data ip data to search.
- * @return true if the ip data already exists in the array.
- * @return false if the ip data does not exist in the array.
- */
-static bool is_ip_addr_and_port_already_reported(const ds_stat_ip_data_t *stats_array, uint32_t number_items_to_search, const ds_stat_ip_data_t* ip_data);
 
+static ds_status_e proc_file_read(ds_proc_file_t *file, const char **content_out)
+{
+    if (file->fd < 0) {
+        file->fd = open(file->path, O_RDONLY | O_CLOEXEC);
+        SA_PV_ERR_RECOVERABLE_RETURN_IF((file->fd < 0), DS_STATUS_ERROR, "Failed to open %s", file->path);
+    }
 
-ds_status_e ds_plat_cpu_stats_get(ds_stats_cpu_t *stats)
+    size_t length = 0;
+    for (;;) {
+        // keep space for the null terminator
+        if (length + 1 >= proc_buffer_size) {
+            size_t new_size = (proc_buffer_size == 0) ? PROC_BUFFER_INITIAL_SIZE : proc_buffer_size * 2;
+            char *new_buffer = (char *)realloc(proc_buffer, new_size);
+            SA_PV_ERR_RECOVERABLE_RETURN_IF((new_buffer == NULL), DS_STATUS_ERROR,
+                "Failed to reallocate memory to new size %" PRIu32 " bytes", (uint32_t)new_size);
+            proc_buffer = new_buffer;
+            proc_buffer_size = new_size;
+        }
+
+        ssize_t read_chars = pread(file->fd, proc_buffer + length, proc_buffer_size - length - 1, (off_t)length);
+        if (read_chars < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // reopen on the next report
+            close(file->fd);
+            file->fd = -1;
+            SA_PV_ERR_RECOVERABLE_RETURN_IF(true, DS_STATUS_ERROR, "Failed to read %s", file->path);
+        }
+        if (read_chars == 0) {
+            break;
+        }
+        length += (size_t)read_chars;
+    }
+
+    proc_buffer[length] = '\0';
+    *content_out = proc_buffer;
+    return DS_STATUS_SUCCESS;
+}
+
+static inline const char *skip_spaces(const char *ptr)
 {
-    SA_PV_LOG_TRACE_FUNC_ENTER_NO_ARGS();
+    while (*ptr == ' ' || *ptr == '\t') {
+        ptr++;
+    }
+    return ptr;
+}
 
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((stats == NULL), DS_STATUS_INVALID_PARAMETER, "Invalid parameter: stats is NULL");
+static inline const char *skip_field(const char *ptr)
+{
+    ptr = skip_spaces(ptr);
+    while (*ptr != '\0' && *ptr != ' ' && *ptr != '\t' && *ptr != '\n') {
+        ptr++;
+    }
+    return ptr;
+}
+
+static inline const char *next_line(const char *ptr)
+{
+    const char *newline = strchr(ptr, '\n');
+    return (newline == NULL) ? NULL : newline + 1;
+}
 
-    FILE* fp = fopen("/proc/uptime", "r");
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((fp == NULL), DS_STATUS_ERROR, "Failed to open /proc/uptime");
+/**
+ * @brief Parses an unsigned number in base 10 or 16, leading spaces are skipped.
+ *
+ * @return pointer to the first character after the number, or NULL if there are no digits.
+ */
+static const char *parse_uint(const char *ptr, unsigned int base, uint64_t *value_out)
+{
+    uint64_t value = 0;
+    const char *start;
+
+    ptr = skip_spaces(ptr);
+    start = ptr;
+    for (;; ptr++) {
+        unsigned int digit;
+        if (*ptr >= '0' && *ptr <= '9') {
+            digit = (unsigned int)(*ptr - '0');
+        } else if (base == 16 && *ptr >= 'A' && *ptr <= 'F') {
+            digit = (unsigned int)(*ptr - 'A' + 10);
+        } else if (base == 16 && *ptr >= 'a' && *ptr <= 'f') {
+            digit = (unsigned int)(*ptr - 'a' + 10);
+        } else {
+            break;
+        }
+        value = value * base + digit;
+    }
 
-    char *line = NULL; // getline will allocate line according to the required size
-    size_t line_len = 0;
-    // read 1 line from the file
-    ssize_t read_chars = getline(&line, &line_len, fp); // getline always puts \0 at the end
-    fclose (fp);
+    *value_out = value;
+    return (ptr == start) ? NULL : ptr;
+}
 
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((read_chars == -1), DS_STATUS_ERROR, "Failed to read /proc/uptime");
- 
-    double uptime; // the number of seconds that have elapsed since the machine was booted.
-    double idle_time; // sum of time periods in seconds that each processor has spent idle.
 
-    int items_scanned = sscanf(line, "%lf %lf", &uptime, &idle_time);
+ds_status_e ds_plat_cpu_stats_get(ds_stats_cpu_t *stats)
+{
+    SA_PV_LOG_TRACE_FUNC_ENTER_NO_ARGS();
 
-    // line was allocated in getline, free it
-    free(line);
+    SA_PV_ERR_RECOVERABLE_RETURN_IF((stats == NULL), DS_STATUS_INVALID_PARAMETER, "Invalid parameter: stats is NULL");
 
-    // we should read exactly 2 items
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((items_scanned != 2), DS_STATUS_ERROR, "Failed to parse /proc/uptime");
+    const char *content;
+    ds_status_e status = proc_file_read(&proc_uptime, &content);
+    SA_PV_ERR_RECOVERABLE_RETURN_IF((status != DS_STATUS_SUCCESS), status, "Failed to read /proc/uptime");
+
+    /* /proc/uptime content:
+    350735.47 234388.90
+       |          |-------> sum of time periods in seconds that each processor has spent idle.
+       |------------------> the number of seconds that have elapsed since the machine was booted. */
+    uint64_t uptime, idle_time, idle_time_fraction = 0;
+    const char *ptr = parse_uint(content, 10, &uptime);
+    SA_PV_ERR_RECOVERABLE_RETURN_IF((ptr == NULL), DS_STATUS_ERROR, "Failed to parse /proc/uptime");
+    // skip fraction of uptime
+    ptr = skip_field(ptr);
+    ptr = parse_uint(ptr, 10, &idle_time);
+    SA_PV_ERR_RECOVERABLE_RETURN_IF((ptr == NULL), DS_STATUS_ERROR, "Failed to parse /proc/uptime");
+    // idle time is divided between the CPUs, so keep the hundredths of a second
+    if (ptr[0] == '.' && ptr[1] >= '0' && ptr[1] <= '9' && ptr[2] >= '0' && ptr[2] <= '9') {
+        idle_time_fraction = (uint64_t)((ptr[1] - '0') * 10 + (ptr[2] - '0'));
+    }
 
     // retrieve number of configured CPU's
-    int cpus_num = get_nprocs_conf(); 
+    if (cpus_num == 0) {
+        cpus_num = get_nprocs_conf();
+    }
 
     // avoid dividing by zero
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((cpus_num == 0), DS_STATUS_ERROR, "Error: get_nprocs_conf returned 0");
+    SA_PV_ERR_RECOVERABLE_RETURN_IF((cpus_num <= 0), DS_STATUS_ERROR, "Error: get_nprocs_conf returned 0");
 
-    stats->uptime = (uint64_t)uptime;
-    stats->idle_time = (uint64_t)(idle_time / cpus_num);
+    stats->uptime = uptime;
+    stats->idle_time = (idle_time * 100 + idle_time_fraction) / (100 * (uint64_t)cpus_num);
 
     SA_PV_LOG_TRACE_FUNC_EXIT("uptime=%" PRIu64 ", idletime=%" PRIu64, stats->uptime, stats->idle_time);
 
@@ -109,42 +251,28 @@ ds_status_e ds_plat_thread_stats_get(uint32_t *thread_count_out)
 {
     SA_PV_LOG_TRACE_FUNC_ENTER_NO_ARGS();
 
-    /* This function counts all light-weight procceses (LWP) in the Linux. The output of the 'ps -eLf --no-heading' is the table 
-    of all LWP's in the system without the first heading line. For each LWP there is exacly 1 line in the table, 
-    so it's enough to count the number of lines in the output of the command. 'wc -l' counts the number of lines in the table. */
-
     SA_PV_ERR_RECOVERABLE_RETURN_IF((thread_count_out == NULL), DS_STATUS_INVALID_PARAMETER, "Invalid parameter: thread_count_out is NULL");
 
-    const char command[] = "ps -eLf --no-heading | wc -l";
-    // Open the file to which was written output of the command
-    FILE *fp = popen(command, "r");
-
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((fp == NULL), DS_STATUS_ERROR, "Failed to run %s", command);
-
-    char *line = NULL;
-    size_t line_len = 0;
-    // read 1 line from the open file
-    ssize_t read_chars = getline(&line, &line_len, fp); // getline always puts \0 at the end
+    const char *content;
+    ds_status_e status = proc_file_read(&proc_loadavg, &content);
+    SA_PV_ERR_RECOVERABLE_RETURN_IF((status != DS_STATUS_SUCCESS), status, "Failed to read /proc/loadavg");
 
-    pclose (fp);
-
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((read_chars == -1), DS_STATUS_ERROR, "Failed to read %s output", command);
-
-    unsigned int threads_num; // the number of light weight threads in system
-
-    int items_scanned = sscanf(line, "%u", &threads_num);
-
-    // line was allocated in getline, free it
-    free(line);
-
-    // we should read exactly 1 item
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((items_scanned != 1), DS_STATUS_ERROR, "Failed to parse %s output", command);
+    /* /proc/loadavg content:
+    0.20 0.18 0.12 1/80 11206
+                     |-----------> number of kernel scheduling entities, that is all light-weight processes (LWP) in the system. */
+    const char *ptr = content;
+    for (int field = 0; field < 3; field++) {
+        ptr = skip_field(ptr);
+    }
+    ptr = skip_spaces(ptr);
+    ptr = strchr(ptr, '/');
+    SA_PV_ERR_RECOVERABLE_RETURN_IF((ptr == NULL), DS_STATUS_ERROR, "Failed to parse /proc/loadavg");
 
-    // running of 'ps -eLf --no-heading | wc -l' initiates 2 extra proccesses, so we need to substruct 2 from the output of the command
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((threads_num <= 2), DS_STATUS_ERROR, "Command %s failed to count threads, count = %u", command, threads_num);
+    uint64_t threads_num;
+    ptr = parse_uint(ptr + 1, 10, &threads_num);
+    SA_PV_ERR_RECOVERABLE_RETURN_IF((ptr == NULL || threads_num == 0), DS_STATUS_ERROR, "Failed to parse /proc/loadavg");
 
-    // substruct 'ps' and 'wc' proccesses from the count of total proccesses
-    *thread_count_out = threads_num - 2;
+    *thread_count_out = (uint32_t)threads_num;
 
     SA_PV_LOG_TRACE_FUNC_EXIT("thread_count_out=%" PRIu32, *thread_count_out);
 
@@ -158,61 +286,51 @@ ds_status_e ds_plat_network_stats_get(ds_stats_network_t **network_stats_out, ui
     SA_PV_ERR_RECOVERABLE_RETURN_IF((network_stats_out == NULL), DS_STATUS_INVALID_PARAMETER, "Invalid parameter: network_stats_out is NULL");
     SA_PV_ERR_RECOVERABLE_RETURN_IF((stats_count_out == NULL), DS_STATUS_INVALID_PARAMETER, "Invalid parameter: stats_count_out is NULL");
 
-    ds_status_e status = DS_STATUS_SUCCESS;
-
     // memory allocation stuff
     const uint32_t STAT_ARRAY_BLOCK_SIZE = 10;
     uint32_t stats_array_current_size = 0;
     ds_stats_network_t *stats_array = NULL;
-
-    // placeholder for /proc/net/dev interface name field
-    char if_name_field[DS_MAX_INTERFACE_NAME_SIZE];
-
-    // use long long integers in order not to overflow the variable in sscanf
-    long long unsigned int received_bytes, transmit_bytes;
-
-    // fields not used in report
-    long long unsigned int not_used_packets, not_used_errs, not_used_drop, not_used_fifo, not_used_frame, not_used_compressed, not_used_multicast;
-
-    // read file content stuff
-    char *line = NULL;
-    size_t line_len = 0;
-    ssize_t read_chars;
     uint32_t stats_array_index = 0;
 
-    // open /proc/net/{protocol}
-    FILE* fp = fopen("/proc/net/dev", "r");
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((fp == NULL), DS_STATUS_ERROR, "Failed to open /proc/net/dev");
+    const char *content;
+    ds_status_e status = proc_file_read(&proc_net_dev, &content);
+    SA_PV_ERR_RECOVERABLE_RETURN_IF((status != DS_STATUS_SUCCESS), status, "Failed to read /proc/net/dev");
 
-    uint32_t dropped_headers = 0; 
-    
-    // read file content by lines and parse each line
-    while ((read_chars = getline(&line, &line_len, fp)) != -1) {
+    // avoid parsing of 2 first lines that contains titles
+    const char *line = next_line(content);
+    line = (line == NULL) ? NULL : next_line(line);
 
-        // avoid parsing of 2 first lines that contains titles
-        if(dropped_headers < 2){
-            dropped_headers ++;
-            continue;
-        }
+    // parse each line
+    for (; line != NULL && *line != '\0'; line = next_line(line)) {
 
         /*
         Inter-| Receive                                                   | Transmit                     header line
         face  | bytes    packets errs drop fifo frame compressed multicast| bytes        ...             header line
         eth2:   5788008  59755   0    0    0    0     0          0          2751000      ...
-        eno1:   30035065 4850550 0    2314 0    0     0          2894166    454136946417 ...
+        eno1:30035065    4850550 0    2314 0    0     0          2894166    454136946417 ...
           |     |        |       |    |    |    |     |          |           |----> transmitted bytes    reported
-          |     |     not used not used  not used  not used  not used ------------>                      not reported, but required to extract
+          |     |     not used not used  not used  not used  not used ------------>                      not reported, but required to skip
           |     |-----------------------------------------------------------------> received bytes       reported
           |-----------------------------------------------------------------------> interface name       reported
 
-        We need to scan first 10 fileds: 'Interface',  'rx bytes', 'packets', ..., 'multicast', and 'tx bytes', 
-        but only interface name and received/sent bytes reported */
-        
-        // extract first 10 fields
-        sscanf(line, "%s %llu %llu %llu %llu %llu %llu %llu %llu %llu", if_name_field, 
-          &received_bytes,                                                                                                               // received bytes
-          &not_used_packets, &not_used_errs, &not_used_drop, &not_used_fifo, &not_used_frame, &not_used_compressed, &not_used_multicast, // not used fileds
-          &transmit_bytes);                                                                                                              // sent bytes
+        The interface name ends with a colon, which may be followed by the received bytes without a space. */
+
+        const char *if_name = skip_spaces(line);
+        const char *colon_ptr = strchr(if_name, ':');
+        const char *end_of_line = strchr(if_name, '\n');
+        // if colon not found in interface name, the format of interface name is not supported
+        SA_PV_ERR_RECOVERABLE_GOTO_IF((colon_ptr == NULL || (end_of_line != NULL && colon_ptr > end_of_line)), status = DS_STATUS_ERROR, release_resources,
+                "Failed to find \':\' in the linux interface name");
+        size_t if_name_len = (size_t)(colon_ptr - if_name);
+
+        uint64_t received_bytes, transmit_bytes, not_used_field;
+        const char *ptr = parse_uint(colon_ptr + 1, 10, &received_bytes);
+        for (int field = 0; ptr != NULL && field < 7; field++) {
+            ptr = parse_uint(ptr, 10, &not_used_field);
+        }
+        ptr = (ptr == NULL) ? NULL : parse_uint(ptr, 10, &transmit_bytes);
+        SA_PV_ERR_RECOVERABLE_GOTO_IF((ptr == NULL || if_name_len >= DS_MAX_INTERFACE_NAME_SIZE), status = DS_STATUS_ERROR, release_resources,
+                "Failed to parse /proc/net/dev line");
 
         if(received_bytes == 0 && transmit_bytes == 0){
             // avoid reporting such interface
@@ -224,7 +342,7 @@ ds_status_e ds_plat_network_stats_get(ds_stats_network_t **network_stats_out, ui
             // reallocate the output array
             size_t new_size = sizeof(ds_stats_network_t) *(stats_array_current_size + STAT_ARRAY_BLOCK_SIZE);
             ds_stats_network_t *new_stats_array = (ds_stats_network_t *)realloc(stats_array, new_size);
-            
+
             // in the case of allocation error, release original array in the goto label
             SA_PV_ERR_RECOVERABLE_GOTO_IF((new_stats_array == NULL), status = DS_STATUS_ERROR, release_resources,
                 "Failed to reallocate memory to new size %" PRIu32 " bytes", (uint32_t)new_size);
@@ -233,15 +351,9 @@ ds_status_e ds_plat_network_stats_get(ds_stats_network_t **network_stats_out, ui
             stats_array = new_stats_array;
         }
 
-        // cut off the colon from the interface name
-        char* colon_ptr = (char*)memchr(if_name_field, ':', DS_MAX_INTERFACE_NAME_SIZE);
-        // if colon not found in interface name, the format of interface name is not supported
-        SA_PV_ERR_RECOVERABLE_GOTO_IF((colon_ptr == NULL), status = DS_STATUS_ERROR, release_resources,
-                "Failed to find \':\' in the linux interface name");
-        *colon_ptr = 0;
-
-        // fill fields in the output array        
-        strncpy(stats_array[stats_array_index].interface, if_name_field, DS_MAX_INTERFACE_NAME_SIZE);
+        // fill fields in the output array
+        memcpy(stats_array[stats_array_index].interface, if_name, if_name_len);
+        stats_array[stats_array_index].interface[if_name_len] = '\0';
         stats_array[stats_array_index].recv_bytes = received_bytes;
         stats_array[stats_array_index].sent_bytes = transmit_bytes;
 
@@ -249,20 +361,16 @@ ds_status_e ds_plat_network_stats_get(ds_stats_network_t **network_stats_out, ui
         strncpy(stats_array[stats_array_index].ip_data.ip_addr, "not valid", DS_MAX_IP_ADDR_SIZE);
         stats_array[stats_array_index].ip_data.port = NOT_USED_FIELD;
 
-
-        // use only third field rem_address_field
-        SA_PV_LOG_TRACE("report [%d] interface=%s, rx=%" PRIu64 ", tx=%" PRIu64, 
-            stats_array_index, 
-            stats_array[stats_array_index].interface, 
-            stats_array[stats_array_index].recv_bytes, 
+        SA_PV_LOG_TRACE("report [%d] interface=%s, rx=%" PRIu64 ", tx=%" PRIu64,
+            stats_array_index,
+            stats_array[stats_array_index].interface,
+            stats_array[stats_array_index].recv_bytes,
             stats_array[stats_array_index].sent_bytes);
 
         stats_array_index++;
     }
 
 release_resources:
-    free(line);
-
     if(status != DS_STATUS_SUCCESS)
     {
         free(stats_array);
@@ -277,68 +385,53 @@ release_resources:
 }
 
 
-static ds_status_e extract_ip_addr_and_port(const char *rem_address_field, ds_stat_ip_data_t * ip_data_out)
+static bool parse_socket_line(const char *line, uint32_t *ip_addr_out, uint16_t *port_out, unsigned int *connection_state_out)
 {
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((rem_address_field == NULL), DS_STATUS_INVALID_PARAMETER, "Invalid parameter: rem_address_field is NULL");
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((ip_data_out == NULL), DS_STATUS_INVALID_PARAMETER, "Invalid parameter: ip_data_out is NULL");
-    SA_PV_LOG_TRACE_FUNC_ENTER("rem_address_field=%s", rem_address_field);
-
-    // length of the ip address field part in the rem_address (the "AE1E320A" part in the AE1E320A:CF3D) 
-    const unsigned int REM_ADDRESS_IPADDRESS_LENGTH = 8;
-
-    // length of the ip port field part in the rem_address (the "CF3D" part in the AE1E320A:CF3D) 
-    const unsigned int REM_ADDRESS_PORTNUM_LENGTH = 4;
-
-    // index of the colon in the rem_address (the ":" in the AE1E320A:CF3D) 
-    const unsigned int REM_ADDRESS_COLON_INDEX = 8;
-
-    const unsigned int HEXA_RADIX = 16;
-
-    size_t rem_address_field_len = strnlen(rem_address_field, DS_MAX_IP_ADDR_SIZE);
-
-    // verify that the format is supported                    
-    SA_PV_ERR_RECOVERABLE_RETURN_IF(                       // (+ 1 is for size of ":" placeholder in rem_address)
-        (rem_address_field_len != REM_ADDRESS_IPADDRESS_LENGTH + 1 + REM_ADDRESS_PORTNUM_LENGTH || rem_address_field[REM_ADDRESS_COLON_INDEX] != ':'), 
-        DS_STATUS_ERROR, "Wrong rem_adress(=%s)", rem_address_field);
-
-
-    char *end_ptr = NULL, *end_ptr2 = NULL; // will point to next byte after the handled integer
-    const uint32_t ip_addr_int = (uint32_t) strtol(rem_address_field, &end_ptr, HEXA_RADIX);
-
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((*end_ptr != ':'), DS_STATUS_ERROR, "Ip address parsing failed, rem_adress(=%s)", rem_address_field);
-
-    // advance end_ptr to point to the next byte after ":"
-    end_ptr++;
-
-    // end_ptr points to port number       
-    //                                     not used
-    ip_data_out->port = (uint16_t) strtol(end_ptr, &end_ptr2, HEXA_RADIX);
+    /* /proc/net{udp or tcp} fields
+      sl    local_address rem_address   st ...                          header line
+      0:    00000000:006F 00000000:0000 0A
+      1:    3500007F:0035 00000000:0000 0A
+      |         |      |      |      |   |--> connection state          used for decision-making, not reported
+      |         |      |      |      |------> remote TCP port number    reported
+      |         |      |      |-------------> remote IPv4 address       reported
+      |         |      |--------------------> local TCP port number     (not reported, but required to skip)
+      |         |---------------------------> local IPv4 address        (not reported, but required to skip)
+      |-------------------------------------> number of entry           (not reported, but required to skip)
+
+      All numbers are hexadecimal. */
+    uint64_t ip_addr, port, connection_state;
+
+    const char *ptr = skip_field(line);
+    ptr = skip_field(ptr);
+    ptr = parse_uint(ptr, 16, &ip_addr);
+    if (ptr == NULL || *ptr != ':') {
+        return false;
+    }
+    ptr = parse_uint(ptr + 1, 16, &port);
+    ptr = (ptr == NULL) ? NULL : parse_uint(ptr, 16, &connection_state);
+    if (ptr == NULL || ip_addr > UINT32_MAX || port > UINT16_MAX) {
+        return false;
+    }
 
-    snprintf(ip_data_out->ip_addr, DS_MAX_IP_ADDR_SIZE, "%u.%u.%u.%u", 
-      ip_addr_int & 0x000000FF,                // LSB to first part of stringified ip address 
-      (ip_addr_int & 0x0000FF00)>>8, 
-      (ip_addr_int & 0x00FF0000)>>16, 
-      (ip_addr_int & 0xFF000000)>>24);          // MSB to last part of stringified ip address
-  
-    SA_PV_LOG_TRACE_FUNC_EXIT("returning ip_addrs=%s port=%" PRIu16, ip_data_out->ip_addr, ip_data_out->port);
-    return DS_STATUS_SUCCESS;
+    *ip_addr_out = (uint32_t)ip_addr;
+    *port_out = (uint16_t)port;
+    *connection_state_out = (unsigned int)connection_state;
+    return true;
 }
 
 
-static bool avoid_report_remote_address(const char *rem_address_field, int connection_state_field, ds_net_protocol_type_t protocol)
+static bool avoid_report_remote_address(uint32_t ip_addr, unsigned int connection_state_field, ds_net_protocol_type_t protocol)
 {
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((rem_address_field == NULL), true, "Invalid parameter: rem_address_field is NULL");
-    SA_PV_LOG_TRACE_FUNC_ENTER("rem_address_field=%s, connection_state_field=%d, protocol=%d", rem_address_field, connection_state_field, protocol);
+    SA_PV_LOG_TRACE_FUNC_ENTER("ip_addr=%08" PRIX32 ", connection_state_field=%u, protocol=%d", ip_addr, connection_state_field, protocol);
 
     bool ret_var = false;
-    // In the Internet Protocol Version 4, the address 0.0.0.0 is a non-routable meta-address used to designate an invalid, 
-    // unknown or non-applicable target. These destinations should not be reported(for both, udp and tcp). 
-    const char unaddressable_ip[] = "00000000";
-    if (0 == strncmp(rem_address_field, unaddressable_ip, strlen(unaddressable_ip))) {
+    // In the Internet Protocol Version 4, the address 0.0.0.0 is a non-routable meta-address used to designate an invalid,
+    // unknown or non-applicable target. These destinations should not be reported(for both, udp and tcp).
+    if (ip_addr == 0) {
         ret_var = true;
     }
 
-    // In the TCP Linux implementation, the only state that allows data transfer is state ESTABLISHED. 
+    // In the TCP Linux implementation, the only state that allows data transfer is state ESTABLISHED.
     if(protocol == TCPV4) {
         if(connection_state_field != TCP_ESTABLISHED) {
             ret_var = true;
@@ -351,12 +444,12 @@ static bool avoid_report_remote_address(const char *rem_address_field, int conne
 
 
 static const char* protocol_to_str(ds_net_protocol_type_t protocol)
-{    
+{
     switch (protocol)
     {
     case TCPV4: return "tcp";
     case UDPV4: return "udp";
-   
+
     default:
         SA_PV_LOG_ERR("Invalid protocol type %d", protocol);
         return "not_supported";
@@ -364,22 +457,43 @@ static const char* protocol_to_str(ds_net_protocol_type_t protocol)
 }
 
 
-static bool is_ip_addr_and_port_already_reported(const ds_stat_ip_data_t *stats_array, uint32_t number_items_to_search, const ds_stat_ip_data_t* ip_data)
+static ds_status_e ip_data_set_add(ds_ip_data_set_t *set, uint32_t ip_addr, uint16_t port, bool *added_out)
 {
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((ip_data == NULL), true, "Invalid parameter: ip_data is NULL");
-    SA_PV_LOG_TRACE_FUNC_ENTER("ip address=%s, port=%" PRIu16, ip_data->ip_addr, ip_data->port);
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((stats_array == NULL), true, "Invalid parameter: stats_array is NULL");
-
-    bool ret_var = false;
-    for (uint32_t i = 0; i <= number_items_to_search; i++) {
-        if((0 == strncmp(stats_array[i].ip_addr, ip_data->ip_addr, DS_MAX_IP_ADDR_SIZE)) && 
-            (stats_array[i].port == ip_data->port) ){
-                ret_var = true;
-                break;
+    // keep the table at most half full
+    if ((set->count + 1) * 2 > set->capacity) {
+        uint32_t new_capacity = (set->capacity == 0) ? 64 : set->capacity * 2;
+        uint64_t *new_keys = (uint64_t *)calloc(new_capacity, sizeof(uint64_t));
+        SA_PV_ERR_RECOVERABLE_RETURN_IF((new_keys == NULL), DS_STATUS_ERROR,
+            "Failed to allocate memory for %" PRIu32 " destinations", new_capacity);
+        for (uint32_t i = 0; i < set->capacity; i++) {
+            uint64_t key = set->keys[i];
+            if (key != 0) {
+                uint32_t slot = (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & (new_capacity - 1);
+                while (new_keys[slot] != 0) {
+                    slot = (slot + 1) & (new_capacity - 1);
+                }
+                new_keys[slot] = key;
             }
+        }
+        free(set->keys);
+        set->keys = new_keys;
+        set->capacity = new_capacity;
     }
-    SA_PV_LOG_TRACE_FUNC_EXIT("returning %d", ret_var);
-    return ret_var;
+
+    // the top bit keeps the key of 0.0.0.0:0 from marking an empty slot
+    uint64_t key = (1ULL << 48) | ((uint64_t)ip_addr << 16) | port;
+    uint32_t slot = (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & (set->capacity - 1);
+    while (set->keys[slot] != 0) {
+        if (set->keys[slot] == key) {
+            *added_out = false;
+            return DS_STATUS_SUCCESS;
+        }
+        slot = (slot + 1) & (set->capacity - 1);
+    }
+    set->keys[slot] = key;
+    set->count++;
+    *added_out = true;
+    return DS_STATUS_SUCCESS;
 }
 
 static ds_status_e ds_socket_stats_by_protocol_get(ds_stat_ip_data_t **socket_stats_out, uint32_t *dest_count_out, ds_net_protocol_type_t protocol)
@@ -392,72 +506,55 @@ static ds_status_e ds_socket_stats_by_protocol_get(ds_stat_ip_data_t **socket_st
     const uint32_t STAT_ARRAY_BLOCK_SIZE = 10;
     uint32_t stats_array_current_size = 0;
     ds_stat_ip_data_t *stats_array = NULL;
-
-    // placeholders for /proc/net/{protocol} string fields
-    char not_used_sl_field[128];
-    char not_used_local_address_field[DS_MAX_IP_ADDR_SIZE];
-    char rem_address_field[DS_MAX_IP_ADDR_SIZE];
-    int connection_state_field;
-
-    // read file content by lines stuff
-    ds_status_e status = DS_STATUS_SUCCESS;
-    char *line = NULL;
-    size_t line_len = 0;
-    ssize_t read_chars;
-    bool header_line_dropped = false;
     uint32_t stats_array_index = 0;
 
-    const char *protocol_name = protocol_to_str(protocol);
-
-    #define PROC_FILE_NAME_MAX_LEN 64
-    char proc_file_name[PROC_FILE_NAME_MAX_LEN] = {0};
-    snprintf(proc_file_name, PROC_FILE_NAME_MAX_LEN, "/proc/net/%s", protocol_name);
+    // destinations already reported
+    ds_ip_data_set_t reported = { NULL, 0, 0 };
 
-    // open /proc/net/{protocol}
-    FILE* fp = fopen(proc_file_name, "r");
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((fp == NULL), DS_STATUS_ERROR, "Failed to open %s", proc_file_name);
+    const char *protocol_name = protocol_to_str(protocol);
+    (void)protocol_name; // used only in traces
+    ds_proc_file_t *proc_file = &proc_net_protocol[protocol];
 
-    SA_PV_LOG_INFO("reading %s:", proc_file_name);
+    const char *content;
+    ds_status_e status = proc_file_read(proc_file, &content);
+    SA_PV_ERR_RECOVERABLE_RETURN_IF((status != DS_STATUS_SUCCESS), status, "Failed to read %s", proc_file->path);
 
-    // read file content by lines and parse each line
-    while ((read_chars = getline(&line, &line_len, fp)) != -1) {
+    SA_PV_LOG_INFO("reading %s:", proc_file->path);
 
-        // avoid parsing of first line that contains titles
-        if(!header_line_dropped){
-            header_line_dropped = true;
-            continue;
-        }
+    // avoid parsing of first line that contains titles
+    const char *line = next_line(content);
 
-        /* /proc/net{udp or tcp} fields
-          sl    local_address rem_address   st ...                          header line
-          0:    00000000:006F 00000000:0000 0A 
-          1:    3500007F:0035 00000000:0000 0A 
-          |         |      |      |      |   |--> connection state          used for decision-making, not reported
-          |         |      |      |      |------> remote TCP port number    reported
-          |         |      |      |-------------> remote IPv4 address       reported
-          |         |      |--------------------> local TCP port number     (not reported, but required to extract)
-          |         |---------------------------> local IPv4 address        (not reported, but required to extract)
-          |-------------------------------------> number of entry           (not reported, but required to extract)
+    // parse each line
+    for (; line != NULL && *line != '\0'; line = next_line(line)) {
 
-          We need to scan only first 4 fileds: 'sl',  'local_address', 'rem_address' and 'st', byt only remote TCP address and port number reported */
-        // extract first 4 fields
-        sscanf(line, "%s %s %s %d", not_used_sl_field, not_used_local_address_field, rem_address_field, &connection_state_field);
+        uint32_t ip_addr;
+        uint16_t port;
+        unsigned int connection_state_field;
+        SA_PV_ERR_RECOVERABLE_GOTO_IF((!parse_socket_line(line, &ip_addr, &port, &connection_state_field)), status = DS_STATUS_ERROR, release_resources,
+            "Failed to parse line of %s", proc_file->path);
 
-        // use only third field rem_address_field
-        SA_PV_LOG_TRACE("handling linux rem_address=%s, state=%d", rem_address_field, connection_state_field);
+        SA_PV_LOG_TRACE("handling linux rem_address=%08" PRIX32 ":%04" PRIX16 ", state=%u", ip_addr, port, connection_state_field);
 
         // verify, may be this destination point should not be reported
-        if(avoid_report_remote_address(rem_address_field, connection_state_field, protocol)){
-            SA_PV_LOG_TRACE("destination address=%s, state=%d report avoided!", rem_address_field, connection_state_field);
+        if(avoid_report_remote_address(ip_addr, connection_state_field, protocol)){
+            SA_PV_LOG_TRACE("destination address=%08" PRIX32 ", state=%u report avoided!", ip_addr, connection_state_field);
+            continue;
+        }
+
+        bool added;
+        status = ip_data_set_add(&reported, ip_addr, port, &added);
+        SA_PV_ERR_RECOVERABLE_GOTO_IF((status != DS_STATUS_SUCCESS), (void)status, release_resources, "Failed to add destination");
+        if (!added) {
+            // avoid reporting this ip
             continue;
-        }   
+        }
 
         // verify if reallocation is required
         if(stats_array_index == stats_array_current_size) {
             // reallocate the output array
             size_t new_size = sizeof(ds_stat_ip_data_t) *(stats_array_current_size + STAT_ARRAY_BLOCK_SIZE);
             ds_stat_ip_data_t *new_stats_array = (ds_stat_ip_data_t *)realloc(stats_array, new_size);
-            
+
             SA_PV_ERR_RECOVERABLE_GOTO_IF((new_stats_array == NULL), status = DS_STATUS_ERROR, release_resources,
                 "Failed to reallocate memory to new size %" PRIu32 " bytes", (uint32_t)new_size);
 
@@ -466,27 +563,18 @@ static ds_status_e ds_socket_stats_by_protocol_get(ds_stat_ip_data_t **socket_st
             stats_array = new_stats_array;
         }
 
-        ds_stat_ip_data_t ip_data_tmp;
-        ds_status_e status = extract_ip_addr_and_port(
-            rem_address_field, 
-            &ip_data_tmp);
-
-        SA_PV_ERR_RECOVERABLE_GOTO_IF((status != DS_STATUS_SUCCESS), status = DS_STATUS_ERROR, release_resources,
-            "Failed to extract ip addr from %s", rem_address_field);
-        
-        if(is_ip_addr_and_port_already_reported(stats_array, stats_array_index, &ip_data_tmp)){
-            // avoid reporting this ip
-            continue;
-        }
-
-        // report new ip data
-        strncpy(stats_array[stats_array_index].ip_addr, ip_data_tmp.ip_addr, DS_MAX_IP_ADDR_SIZE);
-        stats_array[stats_array_index].port = ip_data_tmp.port;
-
-        SA_PV_LOG_INFO("report %s [%d]: %s:%d", 
-            protocol_name, 
-            stats_array_index, 
-            stats_array[stats_array_index].ip_addr, 
+        // report new ip data, the address is in network byte order
+        snprintf(stats_array[stats_array_index].ip_addr, DS_MAX_IP_ADDR_SIZE, "%u.%u.%u.%u",
+          ip_addr & 0x000000FF,                // LSB to first part of stringified ip address
+          (ip_addr & 0x0000FF00)>>8,
+          (ip_addr & 0x00FF0000)>>16,
+          (ip_addr & 0xFF000000)>>24);          // MSB to last part of stringified ip address
+        stats_array[stats_array_index].port = port;
+
+        SA_PV_LOG_INFO("report %s [%d]: %s:%d",
+            protocol_name,
+            stats_array_index,
+            stats_array[stats_array_index].ip_addr,
             stats_array[stats_array_index].port);
 
         stats_array_index++;
@@ -494,7 +582,7 @@ static ds_status_e ds_socket_stats_by_protocol_get(ds_stat_ip_data_t **socket_st
 
 release_resources:
 
-    free(line);
+    free(reported.keys);
 
     if(status != DS_STATUS_SUCCESS)
     {
@@ -510,46 +598,43 @@ release_resources:
 }
 
 
-static ds_status_e meminfo_fields_get_from_line(uint64_t *out_value, const char *exp_field_name, FILE* fp){
+static ds_status_e meminfo_fields_get_from_line(uint64_t *out_value, const char *exp_field_name, const char **line){
 
     SA_PV_LOG_TRACE_FUNC_ENTER_NO_ARGS();
 
-    char *line = NULL; // getline will allocate line according to the required size
-    size_t line_len = 0;
-    ssize_t read_chars = getline(&line, &line_len, fp); // getline always puts \0 at the end
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((read_chars == -1), DS_STATUS_ERROR, "Failed to read content of the meminfo");
- 
+    SA_PV_ERR_RECOVERABLE_RETURN_IF((*line == NULL), DS_STATUS_ERROR, "Failed to read content of the meminfo");
+
     /* /proc/meminfo output:
     MemTotal:       131902356 kB
     MemFree:        10437624 kB
     MemAvailable:   90474708 kB
     Buffers:         4091804 kB
-    ... |               |    | 
+    ... |               |    |
         |               |    |----------> memory size units
         |               |---------------> memory size value in kb (reported in bytes)
         |-------------------------------> filed name (used for verifying that we read corerect filed, not reported) */
 
-    char field_name[128] = {0};
-    char size_units[128] = {0};
-    long long unsigned int memory_kb = 0;
-    int items_scanned = sscanf(line, "%s %llu %s", field_name, &memory_kb, size_units);
-    free(line);
-
-    // we should read exactly 3 items
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((items_scanned != 3), DS_STATUS_ERROR, "Failed to parse meminfo line content");
+    const char *ptr = *line;
+    size_t field_name_len = strlen(exp_field_name);
 
     // we should read the expected field name
-    SA_PV_ERR_RECOVERABLE_RETURN_IF(strcmp(exp_field_name, field_name) != 0, DS_STATUS_ERROR, 
-        "Actual field name(=%s) not as expected(=%s)", field_name, exp_field_name);
+    SA_PV_ERR_RECOVERABLE_RETURN_IF(strncmp(exp_field_name, ptr, field_name_len) != 0, DS_STATUS_ERROR,
+        "Actual field name not as expected(=%s)", exp_field_name);
+
+    uint64_t memory_kb = 0;
+    ptr = parse_uint(ptr + field_name_len, 10, &memory_kb);
+    SA_PV_ERR_RECOVERABLE_RETURN_IF((ptr == NULL), DS_STATUS_ERROR, "Failed to parse meminfo line content");
 
     // value read can't be 0
     SA_PV_ERR_RECOVERABLE_RETURN_IF(memory_kb == 0, DS_STATUS_ERROR, "Memory size read can't be 0");
 
     // units should be kb
-    SA_PV_ERR_RECOVERABLE_RETURN_IF(strcmp("kB", size_units) != 0, DS_STATUS_ERROR, 
-        "Actual memory size units (=%s) not as expected(=%s)", size_units, "kB");
+    ptr = skip_spaces(ptr);
+    SA_PV_ERR_RECOVERABLE_RETURN_IF(strncmp("kB\n", ptr, 3) != 0, DS_STATUS_ERROR,
+        "Actual memory size units not as expected(=%s)", "kB");
 
-    *out_value = (uint64_t)memory_kb;
+    *out_value = memory_kb;
+    *line = next_line(ptr);
 
     SA_PV_LOG_TRACE_FUNC_EXIT_NO_ARGS();
 
@@ -561,20 +646,19 @@ ds_status_e ds_plat_memory_stats_get(ds_stats_memory_t *mem_stats_out)
 {
     SA_PV_LOG_TRACE_FUNC_ENTER_NO_ARGS();
     SA_PV_ERR_RECOVERABLE_RETURN_IF((mem_stats_out == NULL), DS_STATUS_INVALID_PARAMETER, "Invalid parameter: mem_stats_out is NULL");
-    
-    FILE* fp = fopen("/proc/meminfo", "r");
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((fp == NULL), DS_STATUS_ERROR, "Failed to open /proc/meminfo");
+
+    const char *line;
+    ds_status_e status = proc_file_read(&proc_meminfo, &line);
+    SA_PV_ERR_RECOVERABLE_RETURN_IF((status != DS_STATUS_SUCCESS), status, "Failed to read /proc/meminfo");
 
     uint64_t mem_total_kb = 0, mem_free_kb = 0;
-    ds_status_e status = meminfo_fields_get_from_line(&mem_total_kb, "MemTotal:", fp);
+    status = meminfo_fields_get_from_line(&mem_total_kb, "MemTotal:", &line);
     SA_PV_ERR_RECOVERABLE_GOTO_IF((status != DS_STATUS_SUCCESS), (void)status, release_resources, "Failed to get MemTotal field");
 
-    status = meminfo_fields_get_from_line(&mem_free_kb, "MemFree:", fp);
+    status = meminfo_fields_get_from_line(&mem_free_kb, "MemFree:", &line);
     SA_PV_ERR_RECOVERABLE_GOTO_IF((status != DS_STATUS_SUCCESS), (void)status, release_resources, "Failed to get MemFree field");
 
 release_resources:
-    fclose (fp);
-
     if(status == DS_STATUS_SUCCESS){
 
         mem_stats_out->mem_available_bytes = mem_total_kb * 1024;
@@ -602,11 +686,11 @@ ds_status_e ds_plat_active_dests_collect_and_encode(CborEncoder *main_map)
 
     // encode active destinations
     CborError cbor_err = cbor_encode_uint(main_map, DS_METRIC_ACTIVE_DESTS);
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((cbor_err != CborNoError), DS_STATUS_ENCODE_FAILED, "Failed to encode active dests key");
+    SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to encode active dests key");
 
     // we don't know how much metrics will be, so put CborIndefiniteLength
     cbor_err = cbor_encoder_create_array(main_map, &active_dests_array, CborIndefiniteLength);
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((cbor_err != CborNoError), DS_STATUS_ENCODE_FAILED, "Failed to create active dests array");
+    SA_PV_ERR_RECOVERABLE_RETURN_IF(DS_CBOR_ENCODE_FAILED(cbor_err), DS_STATUS_ENCODE_FAILED, "Failed to create active dests array");
 
     // fetch all active destinations
 
@@ -640,7 +724,7 @@ ds_status_e ds_plat_active_dests_collect_and_encode(CborEncoder *main_map)
 
     // close active_dests_array
     cbor_err = cbor_encoder_close_container(main_map, &active_dests_array);
-    SA_PV_ERR_RECOVERABLE_GOTO_IF((cbor_err != CborNoError), status = DS_STATUS_ENCODE_FAILED, release_resources, "Failed to close active dests array");
+    SA_PV_ERR_RECOVERABLE_GOTO_IF(DS_CBOR_ENCODE_FAILED(cbor_err), status = DS_STATUS_ENCODE_FAILED, release_resources, "Failed to close active dests array");
 
 release_resources:
     // free resources in any case, it's ok to pass NULL to free()
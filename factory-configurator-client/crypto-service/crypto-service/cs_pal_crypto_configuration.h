@@ -42,6 +42,13 @@
 #define PAL_CMAC_SUPPORT 1
 #endif //PAL_CMAC_SUPPORT
 
+//! Verify signatures with public keys through PSA Crypto, so that an accelerator or secure element driver
+//! registered with it does the work. Applies with MBED_CONF_MBED_CLOUD_CLIENT_PSA_SUPPORT only, falls back
+//! to mbedTLS if PSA Crypto does not support the operation.
+#ifndef PAL_PSA_ASYMMETRIC_VERIFY
+#define PAL_PSA_ASYMMETRIC_VERIFY 1
+#endif
+
 //! Certificate date validation in Unix time format.
 #ifndef PAL_CRYPTO_CERT_DATE_LENGTH
 #define PAL_CRYPTO_CERT_DATE_LENGTH sizeof(uint64_t)
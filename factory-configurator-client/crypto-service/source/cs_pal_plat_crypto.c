@@ -2565,6 +2565,56 @@ palStatus_t pal_plat_asymmetricSign( palECKeyHandle_t privateKeyHandle, palMDTyp
     return status;
 }
 
+#if defined(MBED_CONF_MBED_CLOUD_CLIENT_PSA_SUPPORT) && (PAL_PSA_ASYMMETRIC_VERIFY == 1)
+//! Verifies a raw SHA256 ECDSA signature with a secp256r1 public key through PSA Crypto.
+//! Returns FCC_PAL_ERR_NOT_SUPPORTED if PSA Crypto can not do it, so that the caller falls back to mbedTLS.
+static palStatus_t pal_plat_psaAsymmetricVerify(palECKey_t* localECKey, const unsigned char *hash, size_t hashSize, const unsigned char *signature, size_t signatureSize)
+{
+    palStatus_t status = FCC_PAL_SUCCESS;
+    int32_t platStatus = CRYPTO_PLAT_SUCCESS;
+    psa_status_t psa_status = PSA_SUCCESS;
+    psa_key_handle_t keyHandle = 0;
+    psa_key_attributes_t psa_key_attr = PSA_KEY_ATTRIBUTES_INIT;
+    mbedtls_ecp_keypair* keyPair = NULL;
+    uint8_t rawPublicKey[PAL_SECP256R1_MAX_PUB_KEY_RAW_SIZE] = { 0 };
+    size_t rawPublicKeySize = 0;
+
+    // Opaque keys already live in PSA, other than secp256r1 keys are left to mbedTLS
+    if (mbedtls_pk_get_type(localECKey) != MBEDTLS_PK_ECKEY || signatureSize != PAL_ECDSA_SECP256R1_SIGNATURE_RAW_SIZE) {
+        return FCC_PAL_ERR_NOT_SUPPORTED;
+    }
+    keyPair = (mbedtls_ecp_keypair*)localECKey->pk_ctx;
+    if (keyPair->grp.id != MBEDTLS_ECP_DP_SECP256R1) {
+        return FCC_PAL_ERR_NOT_SUPPORTED;
+    }
+
+    platStatus = mbedtls_ecp_point_write_binary(&keyPair->grp, &keyPair->Q, MBEDTLS_ECP_PF_UNCOMPRESSED, &rawPublicKeySize, rawPublicKey, sizeof(rawPublicKey));
+    if (platStatus != CRYPTO_PLAT_SUCCESS) {
+        return FCC_PAL_ERR_NOT_SUPPORTED;
+    }
+
+    psa_set_key_type(&psa_key_attr, PSA_KEY_TYPE_ECC_PUBLIC_KEY(PSA_ECC_CURVE_SECP256R1));
+    psa_set_key_usage_flags(&psa_key_attr, PSA_KEY_USAGE_VERIFY);
+    psa_set_key_algorithm(&psa_key_attr, PSA_ALG_ECDSA(PSA_ALG_SHA_256));
+
+    // Import as volatile key, only for the time of the verification
+    psa_status = psa_import_key(&psa_key_attr, rawPublicKey, rawPublicKeySize, &keyHandle);
+    if (psa_status != PSA_SUCCESS) {
+        return FCC_PAL_ERR_NOT_SUPPORTED;
+    }
+
+    psa_status = psa_asymmetric_verify(keyHandle, PSA_ALG_ECDSA(PSA_ALG_SHA_256), hash, hashSize, signature, signatureSize);
+    if (psa_status == PSA_ERROR_NOT_SUPPORTED) {
+        status = FCC_PAL_ERR_NOT_SUPPORTED;
+    } else if (psa_status != PSA_SUCCESS) {
+        status = FCC_PAL_ERR_PK_SIG_VERIFY_FAILED;
+    }
+
+    (void)psa_destroy_key(keyHandle);
+    return status;
+}
+#endif
+
 palStatus_t pal_plat_asymmetricVerify(palECKeyHandle_t publicKeyHandle, palMDType_t mdType, const unsigned char *hash, size_t hashSize, const unsigned char *signature, size_t signatureSize)
 {
     palStatus_t status = FCC_PAL_SUCCESS;
@@ -2583,6 +2633,16 @@ palStatus_t pal_plat_asymmetricVerify(palECKeyHandle_t publicKeyHandle, palMDTyp
         status = FCC_PAL_ERR_INVALID_MD_TYPE;
     }
 
+#if defined(MBED_CONF_MBED_CLOUD_CLIENT_PSA_SUPPORT) && (PAL_PSA_ASYMMETRIC_VERIFY == 1)
+    if (status == FCC_PAL_SUCCESS) {
+        status = pal_plat_psaAsymmetricVerify(localECKey, hash, hashSize, signature, signatureSize);
+        if (status != FCC_PAL_ERR_NOT_SUPPORTED) {
+            return status;
+        }
+        status = FCC_PAL_SUCCESS;
+    }
+#endif
+
     //Convert asn1 signature to raw format
     platStatus = pal_plat_convertRawSignatureToDer(signature, signatureSize, derSignature, sizeof(derSignature), &derSignatureSize);
     if (platStatus != CRYPTO_PLAT_SUCCESS) {
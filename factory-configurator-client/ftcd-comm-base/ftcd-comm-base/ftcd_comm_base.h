@@ -180,6 +180,10 @@ protected:
 
 private:
 
+    /* Internal method that reads a signed message in chunks and calculates its SHA256
+    * while receiving, so that hashing overlaps with the wait for the line */
+    ftcd_comm_status_e _read_message_and_hash(uint8_t *message, uint32_t message_size, uint8_t *digest);
+
     /* Internal method that build response message with status, header and signature (if requested)
     * and writes it to the line */
     ftcd_comm_status_e _send_response(const uint8_t *response_message, uint32_t response_message_size, bool send_status_code, ftcd_comm_status_e status_code);
@@ -25,6 +25,11 @@
 
 #define TRACE_GROUP "fcbs"
 
+// Signed messages are read in chunks of this size, each hashed while the next one arrives
+#ifndef FTCD_COMM_MESSAGE_CHUNK_SIZE
+#define FTCD_COMM_MESSAGE_CHUNK_SIZE 1024
+#endif
+
 FtcdCommBase::FtcdCommBase(ftcd_comm_network_endianness_e network_endianness, const uint8_t *header_token, bool use_signature)
 {
     _network_endianness = network_endianness;
@@ -105,17 +110,24 @@ ftcd_comm_status_e FtcdCommBase::wait_for_message(uint8_t **message_out, uint32_
         status_code = FTCD_COMM_MEMORY_OUT;
         return status_code;
     }
-    success = read_message(message, message_size);
-    if (!success) {
-        mbed_tracef(TRACE_LEVEL_CMD, TRACE_GROUP, "Failed getting message bytes");
-        status_code = FTCD_COMM_FAILED_TO_READ_MESSAGE_BYTES;
-        fcc_free(message);
-        return status_code;
-    }
+    if (_use_signature == false) {
+        success = read_message(message, message_size);
+        if (!success) {
+            mbed_tracef(TRACE_LEVEL_CMD, TRACE_GROUP, "Failed getting message bytes");
+            status_code = FTCD_COMM_FAILED_TO_READ_MESSAGE_BYTES;
+            fcc_free(message);
+            return status_code;
+        }
+    } else {
+        //read message and calculate its signature on the way
+        uint8_t self_calculated_sig[KCM_SHA256_SIZE];
+        status_code = _read_message_and_hash(message, message_size, self_calculated_sig);
+        if (status_code != FTCD_COMM_STATUS_SUCCESS) {
+            fcc_free(message);
+            return status_code;
+        }
 
-    if (_use_signature == true) {
         //read message signature
-
         uint8_t sig_from_message[KCM_SHA256_SIZE];
         success = read_message_signature(sig_from_message, sizeof(sig_from_message));
         if (!success) {
@@ -125,17 +137,6 @@ ftcd_comm_status_e FtcdCommBase::wait_for_message(uint8_t **message_out, uint32_
             return status_code;
         }
 
-        //calculate message signature
-        uint8_t self_calculated_sig[KCM_SHA256_SIZE];
-        kcm_status_e kcm_status = KCM_STATUS_SUCCESS;
-        kcm_status = cs_hash(CS_SHA256, message, message_size, self_calculated_sig, sizeof(self_calculated_sig));
-        if (kcm_status != KCM_STATUS_SUCCESS) {
-            mbed_tracef(TRACE_LEVEL_CMD, TRACE_GROUP, "Failed calculating message signature");
-            status_code = FTCD_COMM_FAILED_TO_CALCULATE_MESSAGE_SIGNATURE;
-            fcc_free(message);
-            return status_code;
-        }
-
         //compare signatures
         if (memcmp(self_calculated_sig, sig_from_message, KCM_SHA256_SIZE) != 0) {
             mbed_tracef(TRACE_LEVEL_CMD, TRACE_GROUP, "Inconsistent message signature");
@@ -150,6 +151,52 @@ ftcd_comm_status_e FtcdCommBase::wait_for_message(uint8_t **message_out, uint32_
     return status_code;
 }
 
+ftcd_comm_status_e FtcdCommBase::_read_message_and_hash(uint8_t *message, uint32_t message_size, uint8_t *digest)
+{
+    ftcd_comm_status_e status_code = FTCD_COMM_STATUS_SUCCESS;
+    palMDHandle_t md_handle = 0;
+    palStatus_t pal_status = PAL_SUCCESS;
+    uint32_t offset = 0;
+    uint32_t chunk_size = 0;
+
+    pal_status = pal_mdInit(&md_handle, PAL_SHA256);
+    if (pal_status != PAL_SUCCESS) {
+        mbed_tracef(TRACE_LEVEL_CMD, TRACE_GROUP, "Failed calculating message signature");
+        return FTCD_COMM_FAILED_TO_CALCULATE_MESSAGE_SIGNATURE;
+    }
+
+    while (offset < message_size) {
+        chunk_size = message_size - offset;
+        if (chunk_size > FTCD_COMM_MESSAGE_CHUNK_SIZE) {
+            chunk_size = FTCD_COMM_MESSAGE_CHUNK_SIZE;
+        }
+
+        if (!read_message(message + offset, chunk_size)) {
+            mbed_tracef(TRACE_LEVEL_CMD, TRACE_GROUP, "Failed getting message bytes");
+            status_code = FTCD_COMM_FAILED_TO_READ_MESSAGE_BYTES;
+            goto exit;
+        }
+
+        pal_status = pal_mdUpdate(md_handle, message + offset, chunk_size);
+        if (pal_status != PAL_SUCCESS) {
+            mbed_tracef(TRACE_LEVEL_CMD, TRACE_GROUP, "Failed calculating message signature");
+            status_code = FTCD_COMM_FAILED_TO_CALCULATE_MESSAGE_SIGNATURE;
+            goto exit;
+        }
+        offset += chunk_size;
+    }
+
+    pal_status = pal_mdFinal(md_handle, digest);
+    if (pal_status != PAL_SUCCESS) {
+        mbed_tracef(TRACE_LEVEL_CMD, TRACE_GROUP, "Failed calculating message signature");
+        status_code = FTCD_COMM_FAILED_TO_CALCULATE_MESSAGE_SIGNATURE;
+    }
+
+exit:
+    (void)pal_mdFree(&md_handle);
+    return status_code;
+}
+
 ftcd_comm_status_e FtcdCommBase::send_response(const uint8_t *response_message, uint32_t response_message_size)
 {
     return _send_response(response_message, response_message_size, false, FTCD_COMM_STATUS_SUCCESS);
@@ -26,7 +26,12 @@
 #include "ftcd_comm_socket.h"
 #include "fcc_malloc.h"
 
-#define NUM_OF_PENDING_CONNECTIONS 1
+// Connections of further factory tools wait in the listen queue while a session is served,
+// instead of being refused, and are accepted one after another
+#ifndef FTCD_COMM_SOCKET_PENDING_CONNECTIONS
+#define FTCD_COMM_SOCKET_PENDING_CONNECTIONS 8
+#endif
+#define NUM_OF_PENDING_CONNECTIONS FTCD_COMM_SOCKET_PENDING_CONNECTIONS
 #define NUM_OF_TRIES_TO_GET_INTERFACE_INFO 5
 #define TRACE_GROUP "fcsk"
 #define RANDOM_PORT_MIN 1024
@@ -56,6 +56,15 @@
 // We choose a size that does not take up too much stack, but minimizes the number of reads.
 #define ESFS_READ_CHUNK_SIZE_IN_BYTES   (64)
 
+// Chunk size for reading through the whole file to calculate the cmac. Same stack usage as the
+// AES buffer of esfs_write(), with a quarter of the reads of ESFS_READ_CHUNK_SIZE_IN_BYTES.
+#define ESFS_CMAC_CHUNK_SIZE_IN_BYTES   (256)
+
+// Number of files of which the verified cmac is remembered by esfs_open(), 0 disables it.
+#if !defined(ESFS_VERIFIED_FILE_CACHE_SIZE)
+#define ESFS_VERIFIED_FILE_CACHE_SIZE   (8)
+#endif
+
 #define ESFS_BITS_IN_BYTE               (8)
 #define ESFS_AES_BLOCK_SIZE_BYTES       (16)
 #define ESFS_AES_IV_SIZE_BYTES          (16)
@@ -81,6 +90,22 @@
 
 static bool esfs_initialize = false;
 
+#if ESFS_VERIFIED_FILE_CACHE_SIZE > 0
+// A file whose cmac was verified by esfs_open(). A file that is opened again with the same size and
+// the same cmac at its end is not read through again to check the cmac. This only saves the check on
+// open - esfs_read() and esfs_read_meta_data() still calculate the cmac of the whole file.
+// The cache is in RAM, so the files are checked in full again after each boot.
+typedef struct {
+    char short_file_name[ESFS_QUALIFIED_FILE_NAME_LENGTH];
+    int32_t file_size;
+    uint8_t cmac[ESFS_CMAC_SIZE_IN_BYTES];
+} esfs_verified_file_t;
+
+static esfs_verified_file_t esfs_verified_files[ESFS_VERIFIED_FILE_CACHE_SIZE];
+// Index of the entry to be replaced next
+static uint32_t esfs_verified_files_next = 0;
+#endif
+
 
 
 // -------------------------------------------------- Functions Implementation ----------------------------------------------------
@@ -197,9 +222,12 @@ errorExit:
 
 }
 
+static void esfs_verified_files_clear(void);
+
 esfs_result_e esfs_finalize(void)
 {
     esfs_initialize = false;
+    esfs_verified_files_clear();
     tr_info("esfs_finalize - enter");
     return ESFS_SUCCESS;
 }
@@ -387,13 +415,13 @@ static esfs_result_e esfs_cmac_skip_to(esfs_file_t *file_handle, int32_t to)
 
     // Iterate over the rest of file in chunks to calculate the cmac
     // buffer will contain only data read form the file
-    for (int32_t i = to - current_pos; i > 0; i -= ESFS_READ_CHUNK_SIZE_IN_BYTES)
+    for (int32_t i = to - current_pos; i > 0; i -= ESFS_CMAC_CHUNK_SIZE_IN_BYTES)
     {
         // Read a chunk
         // Here we read the file as is - plain text or encrypted
-        uint8_t buffer[ESFS_READ_CHUNK_SIZE_IN_BYTES];
+        uint8_t buffer[ESFS_CMAC_CHUNK_SIZE_IN_BYTES];
         size_t num_bytes;
-        esfs_result_e res = esfs_cmac_read(file_handle, buffer, PAL_MIN((size_t)i, ESFS_READ_CHUNK_SIZE_IN_BYTES), &num_bytes);
+        esfs_result_e res = esfs_cmac_read(file_handle, buffer, PAL_MIN((size_t)i, ESFS_CMAC_CHUNK_SIZE_IN_BYTES), &num_bytes);
         if (res != ESFS_SUCCESS || num_bytes == 0)
         {
             tr_err("esfs_cmac_skip_to() failed  num_bytes bytes = %zu", num_bytes);
@@ -461,6 +489,105 @@ static esfs_result_e esfs_cmac_check_and_restore(esfs_file_t *file_handle, unsig
     return  ESFS_SUCCESS;
 }
 
+// Helper functions for the cache of files whose cmac was verified on open.
+// The short file name identifies the file, the size and the cmac that ends the file identify its content.
+static void esfs_verified_files_clear(void)
+{
+#if ESFS_VERIFIED_FILE_CACHE_SIZE > 0
+    memset(esfs_verified_files, 0, sizeof(esfs_verified_files));
+    esfs_verified_files_next = 0;
+#endif
+}
+
+static void esfs_verified_file_remove(const char *short_file_name)
+{
+#if ESFS_VERIFIED_FILE_CACHE_SIZE > 0
+    for (uint32_t i = 0; i < ESFS_VERIFIED_FILE_CACHE_SIZE; i++)
+    {
+        if (strcmp(esfs_verified_files[i].short_file_name, short_file_name) == 0)
+        {
+            memset(&esfs_verified_files[i], 0, sizeof(esfs_verified_files[i]));
+        }
+    }
+#else
+    (void)short_file_name;
+#endif
+}
+
+// Remember the cmac that esfs_open() verified for the file.
+static void esfs_verified_file_add(const esfs_file_t *file_handle)
+{
+#if ESFS_VERIFIED_FILE_CACHE_SIZE > 0
+    esfs_verified_file_remove(file_handle->short_file_name);
+
+    esfs_verified_file_t *entry = &esfs_verified_files[esfs_verified_files_next];
+    esfs_verified_files_next = (esfs_verified_files_next + 1) % ESFS_VERIFIED_FILE_CACHE_SIZE;
+
+    strncpy(entry->short_file_name, file_handle->short_file_name, sizeof(entry->short_file_name) - 1);
+    entry->short_file_name[sizeof(entry->short_file_name) - 1] = '\0';
+    entry->file_size = file_handle->file_size;
+    memcpy(entry->cmac, file_handle->cmac, sizeof(entry->cmac));
+#else
+    (void)file_handle;
+#endif
+}
+
+// Check if the file has already been verified with the cmac that now ends it.
+// The file position is restored to position.
+// Parameters :
+// file_handle - [IN]   A pointer to a file handle of an opened file, with file_size set.
+// pcmac       - [OUT]  A pointer to a buffer into which the verified cmac is written. It must be at least ESFS_CMAC_SIZE_IN_BYTES.
+// position    - [IN]   The absolute position from the start of the file to which we restore the file position.
+// Return     : true if the file was verified, false if its cmac must be calculated.
+static bool esfs_verified_file_get(esfs_file_t *file_handle, unsigned char *pcmac, int32_t position)
+{
+#if ESFS_VERIFIED_FILE_CACHE_SIZE > 0
+    const esfs_verified_file_t *entry = NULL;
+    for (uint32_t i = 0; i < ESFS_VERIFIED_FILE_CACHE_SIZE; i++)
+    {
+        if (esfs_verified_files[i].file_size == file_handle->file_size &&
+                strcmp(esfs_verified_files[i].short_file_name, file_handle->short_file_name) == 0)
+        {
+            entry = &esfs_verified_files[i];
+            break;
+        }
+    }
+    if (entry == NULL)
+    {
+        return false;
+    }
+
+    // Compare with the cmac at the end of the file
+    unsigned char file_cmac[ESFS_CMAC_SIZE_IN_BYTES];
+    size_t num_bytes;
+    palStatus_t res = pal_fsFseek(&file_handle->file, file_handle->file_size - ESFS_CMAC_SIZE_IN_BYTES, PAL_FS_OFFSET_SEEKSET);
+    if (res == PAL_SUCCESS)
+    {
+        res = pal_fsFread(&file_handle->file, &file_cmac[0], ESFS_CMAC_SIZE_IN_BYTES, &num_bytes);
+    }
+    bool verified = (res == PAL_SUCCESS && num_bytes == ESFS_CMAC_SIZE_IN_BYTES &&
+                     memcmp(&file_cmac[0], entry->cmac, ESFS_CMAC_SIZE_IN_BYTES) == 0);
+
+    // Restore the position, the cmac calculation continues from it if the file was not verified
+    if (pal_fsFseek(&file_handle->file, position, PAL_FS_OFFSET_SEEKSET) != PAL_SUCCESS)
+    {
+        tr_err("esfs_verified_file_get() - pal_fsFseek() failed");
+        return false;
+    }
+
+    if (verified)
+    {
+        memcpy(pcmac, entry->cmac, ESFS_CMAC_SIZE_IN_BYTES);
+    }
+    return verified;
+#else
+    (void)file_handle;
+    (void)pcmac;
+    (void)position;
+    return false;
+#endif
+}
+
 //Function   : esfs_memcpy_reverse
 //
 //Description: This function copies the first <len_bytes> bytes from input buffer <src_ptr> to output buffer <dest_ptr> in
@@ -620,15 +747,30 @@ static esfs_result_e esfs_aes_enc_dec_by_file_pos( palAesHandle_t  aes_ctx,
 
     prev_remainder = (uint8_t)(position % ESFS_AES_BLOCK_SIZE_BYTES);
 
+    // Prepare iv_arr: Copy nonce into bytes [0 - 7] of IV buffer
+    memcpy(iv_arr, nonce64_ptr, ESFS_AES_NONCE_SIZE_BYTES);
+
+    // Data that starts on a block boundary is encrypted / decrypted in one run, without the partial block
+    if(prev_remainder == 0)
+    {
+        esfs_set_counter_in_iv_by_file_pos(position, iv_arr);
+
+        pal_status = pal_aesCTRWithZeroOffset(aes_ctx, buf_in, buf_out, len_bytes, iv_arr);
+
+        if(pal_status != PAL_SUCCESS)
+        {
+            tr_err("esfs_aes_enc_dec_by_file_pos() - pal_aesCTRWithZeroOffset() failed with pal_status = 0x%x", (unsigned int)pal_status);
+            return ESFS_ERROR;
+        }
+        return ESFS_SUCCESS;
+    }
+
     partial_block_size_temp = (uint8_t)(ESFS_AES_BLOCK_SIZE_BYTES - prev_remainder);
     partial_block_size      = (uint8_t)PAL_MIN(partial_block_size_temp, len_bytes);
 
     // Prepare partial_block_in: Copy data for next encrypt / decrypt from buf_in to partial_block_in
     memcpy(partial_block_in + prev_remainder, buf_in, partial_block_size);
 
-    // Prepare iv_arr: Copy nonce into bytes [0 - 7] of IV buffer
-    memcpy(iv_arr, nonce64_ptr, ESFS_AES_NONCE_SIZE_BYTES);
-
     // Prepare iv_arr: Set counter in bytes [8 - 15] of IV buffer
     esfs_set_counter_in_iv_by_file_pos(position, iv_arr);
 
@@ -830,6 +972,7 @@ esfs_result_e esfs_reset(void)
     palStatus_t pal_result = PAL_SUCCESS;
     char dir_path[MAX_FULL_PATH_SIZE] = { 0 };
     tr_info("esfs_reset - enter");
+    esfs_verified_files_clear();
     pal_result = pal_fsGetMountPoint(PAL_FS_PARTITION_PRIMARY, PAL_MAX_FOLDER_DEPTH_CHAR + 1, dir_path);
     if (pal_result != PAL_SUCCESS)
     {
@@ -926,6 +1069,7 @@ esfs_result_e esfs_factory_reset(void) {
     bool is_single_partition = true;
     
     tr_info("esfs_factory_reset - enter");
+    esfs_verified_files_clear();
     pal_result = pal_fsGetMountPoint(PAL_FS_PARTITION_SECONDARY, PAL_MAX_FOLDER_DEPTH_CHAR + 1, full_path_backup_dir);
     if (pal_result != PAL_SUCCESS)
     {
@@ -1945,8 +2089,20 @@ esfs_result_e esfs_open(const uint8_t *name, size_t name_length, uint16_t *esfs_
         goto errorExit;
     }
 
-    // Skip to the end of the file while calculating the cmac
-    if(esfs_cmac_skip_to(file_handle, file_handle->file_size - ESFS_CMAC_SIZE_IN_BYTES) != ESFS_SUCCESS)
+    // Skip to the end of the file while calculating the cmac, unless it was verified before
+    unsigned char cmac[ESFS_CMAC_SIZE_IN_BYTES];
+    bool is_verified = esfs_verified_file_get(file_handle, &cmac[0], current_pos);
+    if(is_verified)
+    {
+        res = pal_fsFseek(&file_handle->file, file_handle->file_size - ESFS_CMAC_SIZE_IN_BYTES, PAL_FS_OFFSET_SEEKSET);
+        if(res != PAL_SUCCESS)
+        {
+            tr_err("esfs_open() - pal_fsFseek() failed with pal status 0x%x", (unsigned int)res);
+            result = ESFS_ERROR;
+            goto errorExit;
+        }
+    }
+    else if(esfs_cmac_skip_to(file_handle, file_handle->file_size - ESFS_CMAC_SIZE_IN_BYTES) != ESFS_SUCCESS)
     {
         tr_err("esfs_open() - esfs_cmac_skip_to() failed.");
         result = ESFS_ERROR;
@@ -1954,13 +2110,17 @@ esfs_result_e esfs_open(const uint8_t *name, size_t name_length, uint16_t *esfs_
     }
 
     // Terminate cmac calculation and get it.
-    unsigned char cmac[ESFS_CMAC_SIZE_IN_BYTES];
-    if(esfs_cmac_finish(file_handle, &cmac[0]) != ESFS_SUCCESS)
+    unsigned char calculated_cmac[ESFS_CMAC_SIZE_IN_BYTES];
+    if(esfs_cmac_finish(file_handle, &calculated_cmac[0]) != ESFS_SUCCESS)
     {
         tr_err("esfs_open() - esfs_finish_cmac() failed");
         goto errorExit;
     }
     cmac_created = 0;
+    if(!is_verified)
+    {
+        memcpy(&cmac[0], &calculated_cmac[0], sizeof(cmac));
+    }
 
     // save the CMAC in the file descriptor. We will use this to check that the file has not
     // changed when esfs_read() or read_meta_data() is called.
@@ -1983,6 +2143,11 @@ esfs_result_e esfs_open(const uint8_t *name, size_t name_length, uint16_t *esfs_
     file_handle->file_flag = ESFS_READ;
     file_handle->blob_name_length = (uint16_t)name_length;
 
+    if(!is_verified)
+    {
+        esfs_verified_file_add(file_handle);
+    }
+
     return ESFS_SUCCESS;
 
 errorExit:
@@ -2409,6 +2574,8 @@ esfs_result_e esfs_delete(const uint8_t *name, size_t name_length)
     }
     tr_info("esfs_delete %s", short_file_name);
 
+    esfs_verified_file_remove(short_file_name);
+
     pal_result = pal_fsGetMountPoint(PAL_FS_PARTITION_PRIMARY, PAL_MAX_FOLDER_DEPTH_CHAR + 1, working_dir_path);
     if (pal_result != PAL_SUCCESS)
     {
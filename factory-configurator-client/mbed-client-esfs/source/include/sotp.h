@@ -157,6 +157,33 @@ sotp_result_e sotp_get_item_size(uint32_t type, uint16_t *actual_len_bytes);
  */
 sotp_result_e sotp_set(uint32_t type, uint16_t buf_len_bytes, const uint32_t *buf);
 
+/**
+ * @brief Sets one item of data, to be programmed on Flash later.
+ *        Successive writes of the same type are coalesced to one Flash write. The item is written
+ *        by sotp_flush(), sotp_deinit() or replaced by sotp_set() of the same type. Until then,
+ *        sotp_get() returns the new data, but a power failure loses it. Items that must survive
+ *        a power failure should be written with sotp_set(), or followed by sotp_flush().
+ * @param [in] type
+ *               Type of stored item (must be between 0-15).
+ * @param [in] buf_len_bytes
+ *               Item length in bytes.
+ * @param [in] buf
+ *               Buffer containing data  (must be aligned to a 32 bit boundary).
+ * @returns SOTP_SUCCESS           Value was successfully set.
+ *          SOTP_BAD_VALUE         Bad value in any of the parameters.
+ *          SOTP_BUFF_NOT_ALIGNED  Buffer not aligned to 32 bits.
+ *          SOTP_MEM_ALLOC_ERROR   Not enough memory for the item.
+ *          or any error of sotp_set() for OTP types, which are written at once.
+ */
+sotp_result_e sotp_set_deferred(uint32_t type, uint16_t buf_len_bytes, const uint32_t *buf);
+
+/**
+ * @brief Programs on Flash all items set with sotp_set_deferred().
+ * @returns SOTP_SUCCESS           All items were written on Flash.
+ *          or any error of sotp_set(). Items not written are kept for the next flush.
+ */
+sotp_result_e sotp_flush(void);
+
 #ifdef RBP_TESTING
 /**
  * @brief Delete an item from flash.
@@ -60,6 +60,23 @@ STATIC sotp_shared_lock_t write_lock;
 STATIC uint8_t *page_buf = NULL;
 STATIC uint32_t min_prog_size;
 
+// Items written with sotp_set_deferred and not yet programmed to Flash, by type.
+// Allocated with malloc, so the data is aligned to 32 bits like the user buffers.
+typedef struct {
+    uint16_t data_len;
+    uint32_t data[];
+} pending_item_t;
+
+STATIC pending_item_t *pending_by_type[SOTP_MAX_TYPES];
+#ifdef SOTP_THREAD_SAFE
+STATIC palMutexID_t pending_mutex = NULLPTR;
+#define PENDING_LOCK()      pal_osMutexWait(pending_mutex, PAL_RTOS_WAIT_FOREVER)
+#define PENDING_UNLOCK()    pal_osMutexRelease(pending_mutex)
+#else
+#define PENDING_LOCK()
+#define PENDING_UNLOCK()
+#endif
+
 // Currently disable OTP feature
 #if 0
 static const sotp_type_e otp_types[] =
@@ -578,6 +595,58 @@ sotp_result_e sotp_garbage_collection(uint16_t type, uint16_t buf_len_bytes, con
 // actual_len_bytes - [OUT]  Actual length of returned data.
 // validate_only    - [IN]   Just validate (don't return user data).
 // Return      : SOTP_SUCCESS on success. Error code otherwise.
+// Get an item from the pending items, if it has a deferred write.
+// Parameters :
+// type             - [IN]   Item type.
+// buf_len_bytes    - [IN]   Length of user buffer in bytes.
+// buf              - [IN]   User buffer.
+// actual_len_bytes - [Out]  Actual length of data.
+// validate_only    - [IN]   Only return the length.
+// ret              - [Out]  Result of the get, if the item is pending.
+// Return           : Whether the item is pending.
+STATIC bool pending_get(uint8_t type, uint16_t buf_len_bytes, uint32_t *buf, uint16_t *actual_len_bytes,
+                        bool validate_only, sotp_result_e *ret)
+{
+    pending_item_t *item;
+
+    PENDING_LOCK();
+    item = pending_by_type[type];
+    if (!item) {
+        PENDING_UNLOCK();
+        return false;
+    }
+
+    *ret = SOTP_SUCCESS;
+    *actual_len_bytes = item->data_len;
+    if (!validate_only) {
+        if (item->data_len > buf_len_bytes) {
+            *ret = SOTP_BUFF_TOO_SMALL;
+        } else {
+            memcpy(buf, item->data, item->data_len);
+        }
+    }
+    PENDING_UNLOCK();
+    return true;
+}
+
+// Drop the deferred write of an item, as a newer write replaces it.
+// Parameters :
+// type          - [IN]   Item type.
+STATIC void pending_drop(uint32_t type)
+{
+    pending_item_t *item;
+
+    if (!init_done || (type >= SOTP_MAX_TYPES)) {
+        return;
+    }
+
+    PENDING_LOCK();
+    item = pending_by_type[type];
+    pending_by_type[type] = NULL;
+    PENDING_UNLOCK();
+    free(item);
+}
+
 STATIC sotp_result_e sotp_do_get(uint8_t type, uint16_t buf_len_bytes, uint32_t *buf, uint16_t *actual_len_bytes,
                           bool validate_only)
 {
@@ -611,6 +680,12 @@ STATIC sotp_result_e sotp_do_get(uint8_t type, uint16_t buf_len_bytes, uint32_t
         return SOTP_BUFF_NOT_ALIGNED;
     }
 
+    // Deferred writes are newer than what is on Flash
+    if (pending_get(type, buf_len_bytes, buf, actual_len_bytes, validate_only, &ret)) {
+        SOTP_LOG_FINALIZE();
+        return ret;
+    }
+
     // This loop is required for the case we try to perform reading while GC is in progress.
     // If so, we have the following cases:
     // 1. Record is still in the older area. It will be successfully read.
@@ -809,18 +884,107 @@ STATIC sotp_result_e sotp_do_set(uint32_t type, uint16_t buf_len_bytes, const ui
 
 sotp_result_e sotp_set(uint32_t type, uint16_t buf_len_bytes, const uint32_t *buf)
 {
+    pending_drop(type);
     return sotp_do_set(type, buf_len_bytes, buf, false, 0);
 }
 
+sotp_result_e sotp_set_deferred(uint32_t type, uint16_t buf_len_bytes, const uint32_t *buf)
+{
+    sotp_result_e ret;
+    pending_item_t *item, *old_item;
+
+    if (!init_done) {
+        ret = sotp_init();
+        if (ret != SOTP_SUCCESS) {
+            return ret;
+        }
+    }
+
+    if (type >= SOTP_MAX_TYPES) {
+        return SOTP_BAD_VALUE;
+    }
+
+    if (!buf)
+        buf_len_bytes = 0;
+
+    if (buf_len_bytes && !is_buf_aligned(buf, sizeof(uint32_t))) {
+        return SOTP_BUFF_NOT_ALIGNED;
+    }
+
+    // Whether an OTP item exists can only be known on Flash
+    if (sotp_is_otp_type(type)) {
+        return sotp_set(type, buf_len_bytes, buf);
+    }
+
+    item = (pending_item_t *) malloc(sizeof(pending_item_t) + buf_len_bytes);
+    if (!item) {
+        PR_ERR("sotp_set_deferred: malloc failed\n");
+        return SOTP_MEM_ALLOC_ERROR;
+    }
+    item->data_len = buf_len_bytes;
+    if (buf_len_bytes) {
+        memcpy(item->data, buf, buf_len_bytes);
+    }
+
+    // Replacing the pending item coalesces successive writes to one Flash write
+    PENDING_LOCK();
+    old_item = pending_by_type[type];
+    pending_by_type[type] = item;
+    PENDING_UNLOCK();
+    free(old_item);
+
+    return SOTP_SUCCESS;
+}
+
+sotp_result_e sotp_flush(void)
+{
+    sotp_result_e ret;
+    pending_item_t *item;
+    uint32_t type;
+
+    if (!init_done) {
+        return SOTP_SUCCESS;
+    }
+
+    for (type = 0; type < SOTP_MAX_TYPES; type++) {
+        PENDING_LOCK();
+        item = pending_by_type[type];
+        pending_by_type[type] = NULL;
+        PENDING_UNLOCK();
+        if (!item) {
+            continue;
+        }
+
+        ret = sotp_do_set(type, item->data_len, item->data, false, 0);
+        if (ret != SOTP_SUCCESS) {
+            PR_ERR("sotp_flush: sotp_do_set failed with err code 0x%x\n", ret);
+            // Keep the item for the next flush, unless it was written again meanwhile
+            PENDING_LOCK();
+            if (!pending_by_type[type]) {
+                pending_by_type[type] = item;
+                item = NULL;
+            }
+            PENDING_UNLOCK();
+            free(item);
+            return ret;
+        }
+        free(item);
+    }
+
+    return SOTP_SUCCESS;
+}
+
 #ifdef RBP_TESTING
 
 sotp_result_e sotp_set_for_testing(uint32_t type, uint16_t buf_len_bytes, const uint32_t *buf)
 {
+    pending_drop(type);
     return sotp_do_set(type, buf_len_bytes, buf, true, 0);
 }
 
 sotp_result_e sotp_delete(uint32_t type)
 {
+    pending_drop(type);
     return sotp_do_set(type, 0, NULL, true, DELETE_ITEM_FLAG);
 }
 #endif
@@ -883,6 +1047,14 @@ sotp_result_e sotp_init(void)
         goto init_end;
     }
 
+#ifdef SOTP_THREAD_SAFE
+    if (pal_osMutexCreate(&pending_mutex) != PAL_SUCCESS) {
+        PR_ERR("sotp_init: pal_osMutexCreate failed\n");
+        ret = SOTP_OS_ERROR;
+        goto init_end;
+    }
+#endif
+
     for (area = 0; area < SOTP_NUM_AREAS; area++) {
         pal_ret = pal_internalFlashGetAreaInfo(area, &flash_area_params[area]);
         if (pal_ret != PAL_SUCCESS) {
@@ -1005,8 +1177,19 @@ init_end:
 
 sotp_result_e sotp_deinit(void)
 {
+    uint32_t type;
+
     if (init_done) {
+        if (sotp_flush() != SOTP_SUCCESS) {
+            PR_ERR("sotp_deinit: deferred writes lost\n");
+        }
+        for (type = 0; type < SOTP_MAX_TYPES; type++) {
+            pending_drop(type);
+        }
         sotp_sh_lock_destroy(write_lock);
+#ifdef SOTP_THREAD_SAFE
+        pal_osMutexDelete(&pending_mutex);
+#endif
         free(page_buf);
     }
 
@@ -1021,8 +1204,14 @@ sotp_result_e sotp_deinit(void)
 sotp_result_e sotp_reset(void)
 {
     uint8_t area;
+    uint32_t type;
     palStatus_t pal_ret;
 
+    // Deferred writes are erased too
+    for (type = 0; type < SOTP_MAX_TYPES; type++) {
+        pending_drop(type);
+    }
+
     // Erase both areas, and reinitialize the module. This is totally not thread safe,
     // as init doesn't take the case of re-initialization into account. It's OK, as this function
     // should only be called in pre-production cases.
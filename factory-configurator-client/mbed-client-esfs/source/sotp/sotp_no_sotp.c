@@ -219,6 +219,17 @@ sotp_result_e sotp_set(uint32_t type, uint16_t buf_len_bytes, const uint32_t *bu
     return SOTP_SUCCESS;
 }
 
+sotp_result_e sotp_set_deferred(uint32_t type, uint16_t buf_len_bytes, const uint32_t *buf)
+{
+    // Only OTP types are stored, and they are written at once
+    return sotp_set(type, buf_len_bytes, buf);
+}
+
+sotp_result_e sotp_flush(void)
+{
+    return SOTP_SUCCESS;
+}
+
 #ifdef RBP_TESTING
 
 sotp_result_e sotp_set_for_testing(uint32_t type, uint16_t buf_len_bytes, const uint32_t *buf)
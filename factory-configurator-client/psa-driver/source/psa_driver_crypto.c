@@ -32,6 +32,110 @@ kcm_status_e psa_drv_ps_set(void* data, size_t data_size, uint32_t extra_flags,
 kcm_status_e psa_drv_ps_remove(const uint16_t ksa_id);
 #endif
 
+/*
+ * Cache of open key handles. Every signature with the device key used to open and close
+ * the persistent key, reading it back from storage each time. Handles are kept open per key
+ * id and shared by the users of the key, the least recently used unused handle is closed when
+ * another key needs the entry. psa_drv_crypto_destroy() evicts the key before destroying it,
+ * so a deleted or renewed key is never served from the cache. 0 disables the cache.
+ */
+#ifdef MBED_CONF_MBED_CLOUD_CLIENT_PSA_KEY_HANDLE_CACHE_SIZE
+#define PSA_KEY_HANDLE_CACHE_SIZE MBED_CONF_MBED_CLOUD_CLIENT_PSA_KEY_HANDLE_CACHE_SIZE
+#endif
+
+#ifndef PSA_KEY_HANDLE_CACHE_SIZE
+#define PSA_KEY_HANDLE_CACHE_SIZE 4
+#endif
+
+#if PSA_KEY_HANDLE_CACHE_SIZE > 0
+typedef struct psa_key_handle_cache_entry_ {
+    uint16_t key_id;            // PSA_INVALID_SLOT_ID if the key was destroyed while in use
+    psa_key_handle_t handle;    // PSA_CRYPTO_INVALID_KEY_HANDLE if the entry is free
+    uint16_t refs;
+    uint32_t last_use;
+} psa_key_handle_cache_entry_s;
+
+static psa_key_handle_cache_entry_s g_key_handle_cache[PSA_KEY_HANDLE_CACHE_SIZE];
+static uint32_t g_key_handle_cache_use_counter = 0;
+
+static psa_key_handle_cache_entry_s *key_handle_cache_find_id(uint16_t key_id)
+{
+    // Would match the entries of destroyed keys
+    if (key_id == PSA_INVALID_SLOT_ID) {
+        return NULL;
+    }
+    for (int i = 0; i < PSA_KEY_HANDLE_CACHE_SIZE; i++) {
+        if (g_key_handle_cache[i].handle != PSA_CRYPTO_INVALID_KEY_HANDLE && g_key_handle_cache[i].key_id == key_id) {
+            return &g_key_handle_cache[i];
+        }
+    }
+    return NULL;
+}
+
+static psa_key_handle_cache_entry_s *key_handle_cache_find_handle(psa_key_handle_t handle)
+{
+    for (int i = 0; i < PSA_KEY_HANDLE_CACHE_SIZE; i++) {
+        if (g_key_handle_cache[i].handle != PSA_CRYPTO_INVALID_KEY_HANDLE && g_key_handle_cache[i].handle == handle) {
+            return &g_key_handle_cache[i];
+        }
+    }
+    return NULL;
+}
+
+static void key_handle_cache_release(psa_key_handle_cache_entry_s *entry)
+{
+    psa_close_key(entry->handle);
+    entry->handle = PSA_CRYPTO_INVALID_KEY_HANDLE;
+    entry->key_id = PSA_INVALID_SLOT_ID;
+    entry->refs = 0;
+}
+
+// Returns a free entry, closing the least recently used handle nobody holds if needed, NULL if all are in use
+static psa_key_handle_cache_entry_s *key_handle_cache_alloc(void)
+{
+    psa_key_handle_cache_entry_s *victim = NULL;
+
+    for (int i = 0; i < PSA_KEY_HANDLE_CACHE_SIZE; i++) {
+        psa_key_handle_cache_entry_s *entry = &g_key_handle_cache[i];
+        if (entry->handle == PSA_CRYPTO_INVALID_KEY_HANDLE) {
+            return entry;
+        }
+        if (entry->refs == 0 && (victim == NULL || entry->last_use < victim->last_use)) {
+            victim = entry;
+        }
+    }
+    if (victim != NULL) {
+        key_handle_cache_release(victim);
+    }
+    return victim;
+}
+
+static void key_handle_cache_evict(uint16_t key_id)
+{
+    psa_key_handle_cache_entry_s *entry = key_handle_cache_find_id(key_id);
+
+    if (entry == NULL) {
+        return;
+    }
+    if (entry->refs == 0) {
+        key_handle_cache_release(entry);
+    } else {
+        // Closed by the last psa_drv_crypto_close_handle(), never handed out again
+        entry->key_id = PSA_INVALID_SLOT_ID;
+    }
+}
+
+static void key_handle_cache_clear(void)
+{
+    for (int i = 0; i < PSA_KEY_HANDLE_CACHE_SIZE; i++) {
+        if (g_key_handle_cache[i].handle != PSA_CRYPTO_INVALID_KEY_HANDLE) {
+            key_handle_cache_release(&g_key_handle_cache[i]);
+        }
+    }
+    g_key_handle_cache_use_counter = 0;
+}
+#endif // PSA_KEY_HANDLE_CACHE_SIZE > 0
+
 /*============================================== Static functions CRYPTO driver implementation =========================================*/
 static kcm_status_e psa_import_or_generate(const void* raw_data,
                                             size_t raw_data_size,
@@ -424,6 +528,10 @@ kcm_status_e psa_drv_crypto_destroy(const uint16_t ksa_id)
 
     SA_PV_LOG_TRACE_FUNC_ENTER_NO_ARGS();
 
+#if PSA_KEY_HANDLE_CACHE_SIZE > 0
+    key_handle_cache_evict(ksa_id);
+#endif
+
 #ifndef TARGET_TFM_V1_0
     //Check parameters
     SA_PV_ERR_RECOVERABLE_RETURN_IF((ksa_id < PSA_CRYPTO_MIN_ID_VALUE) || (ksa_id > PSA_CRYPTO_MAX_ID_VALUE), KCM_STATUS_INVALID_PARAMETER, "ksa_id is in invalid range %d", ksa_id);
@@ -542,6 +650,10 @@ void psa_drv_crypto_fini(void)
 
     SA_PV_LOG_TRACE_FUNC_ENTER_NO_ARGS();
 
+#if PSA_KEY_HANDLE_CACHE_SIZE > 0
+    key_handle_cache_clear();
+#endif
+
 #if !(defined(TARGET_TFM) && (MBED_MAJOR_VERSION > 5))
     mbedtls_psa_crypto_free();
 #endif
@@ -554,6 +666,17 @@ kcm_status_e psa_drv_crypto_get_handle(uint16_t key_id, psa_key_handle_t *key_ha
     psa_status_t psa_status = PSA_SUCCESS;
 
     SA_PV_ERR_RECOVERABLE_RETURN_IF((key_handle_out == NULL), KCM_STATUS_INVALID_PARAMETER, "Wrong key handle pointer");
+
+#if PSA_KEY_HANDLE_CACHE_SIZE > 0
+    psa_key_handle_cache_entry_s *entry = key_handle_cache_find_id(key_id);
+    if (entry != NULL) {
+        entry->refs++;
+        entry->last_use = ++g_key_handle_cache_use_counter;
+        *key_handle_out = entry->handle;
+        return KCM_STATUS_SUCCESS;
+    }
+#endif
+
 #ifndef TARGET_TFM_V1_0
     //TODO: check correct range one we move to KSA table for all items
     SA_PV_ERR_RECOVERABLE_RETURN_IF((key_id == PSA_INVALID_SLOT_ID || key_id > PSA_CRYPTO_MAX_ID_VALUE), KCM_STATUS_INVALID_PARAMETER, "Invalid key id ");
@@ -581,6 +704,17 @@ kcm_status_e psa_drv_crypto_get_handle(uint16_t key_id, psa_key_handle_t *key_ha
                                     psa_drv_translate_to_kcm_error(psa_status), "Failed to import the key (%" PRIi32 ")", (int32_t)psa_status);
 #endif // TARGET_TFM_V1_0
 
+#if PSA_KEY_HANDLE_CACHE_SIZE > 0
+    // Without a free entry the handle is not cached, psa_drv_crypto_close_handle() closes it
+    entry = key_handle_cache_alloc();
+    if (entry != NULL) {
+        entry->key_id = key_id;
+        entry->handle = *key_handle_out;
+        entry->refs = 1;
+        entry->last_use = ++g_key_handle_cache_use_counter;
+    }
+#endif
+
     return KCM_STATUS_SUCCESS;
 }
 
@@ -588,6 +722,20 @@ kcm_status_e psa_drv_crypto_close_handle(psa_key_handle_t key_handle)
 {
     psa_status_t psa_status = PSA_SUCCESS;
 
+#if PSA_KEY_HANDLE_CACHE_SIZE > 0
+    psa_key_handle_cache_entry_s *entry = key_handle_cache_find_handle(key_handle);
+    if (entry != NULL) {
+        if (entry->refs > 0) {
+            entry->refs--;
+        }
+        // Kept open for the next user unless the key was destroyed meanwhile
+        if (entry->refs == 0 && entry->key_id == PSA_INVALID_SLOT_ID) {
+            key_handle_cache_release(entry);
+        }
+        return KCM_STATUS_SUCCESS;
+    }
+#endif
+
     //Close key handle
     psa_status = psa_close_key(key_handle);
     SA_PV_ERR_RECOVERABLE_RETURN_IF((psa_status != PSA_SUCCESS), psa_drv_translate_to_kcm_error(psa_status), "Failed to close the key");
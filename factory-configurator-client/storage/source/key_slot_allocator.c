@@ -108,6 +108,10 @@ typedef struct ksa_descriptor {
     ksa_item_entry_s *ksa_start_entry;          // start of KSA table
     ksa_item_entry_s *ksa_last_occupied_entry;  // pointer to last slot that contains at least single valid psa_id (active, factory or renewal)
     uint32_t ksa_num_of_table_entries;          // KSA buffer size 
+    uint16_t *ksa_index;                        // open addressing index of the entries by item name, see build_table_index()
+    uint32_t ksa_index_size;                    // number of slots in ksa_index, a power of two
+    uint32_t ksa_first_free_entry;              // number of the first empty entry, valid with the index
+    bool ksa_index_valid;                       // false if entries were added, moved or renamed after the index was built
 } ksa_descriptor_s;
 
 //descriptor for KSA tables 
@@ -131,6 +135,121 @@ static void reset_table_entry(ksa_item_entry_s *entry)
     entry->renewal_item_id = PSA_INVALID_SLOT_ID;
 }
 
+/**
+* Marks the index of a table out of date. Must be called whenever an item name is
+* written to or removed from the table, or entries are moved.
+*/
+static void invalidate_table_index(ksa_item_type_e item_type)
+{
+    g_ksa_desc[item_type].ksa_index_valid = false;
+}
+
+/**
+* FNV-1a hash of the complete item name, used to place the entry in the table index
+*/
+static uint32_t item_name_hash(const uint8_t *item_name)
+{
+    uint32_t hash = 2166136261UL;
+
+    for (int name_index = 0; name_index < KSA_ITEM_NAME_SIZE; name_index++) {
+        hash = (hash ^ item_name[name_index]) * 16777619UL;
+    }
+    return hash;
+}
+
+/**
+* Builds the index of the occupied entries of the table, from the first entry up to the first
+* empty one. Each index slot holds the entry number + 1, zero marks a free slot. The index
+* has at least twice as many slots as the table has entries, so the probing always ends.
+*
+* @returns true if the index is valid, false if there is not enough memory for it.
+*/
+static bool build_table_index(ksa_descriptor_s *table_descriptor)
+{
+    uint8_t zero_buffer[KSA_ITEM_NAME_SIZE] = { 0 };
+    uint32_t index_size = 1;
+    uint32_t entry_index;
+
+    if (table_descriptor->ksa_index_valid) {
+        return true;
+    }
+
+    // The index holds 16 bit entry numbers
+    if (table_descriptor->ksa_num_of_table_entries >= UINT16_MAX) {
+        return false;
+    }
+
+    // a power of two, so that the slot is found with a mask
+    while (index_size < table_descriptor->ksa_num_of_table_entries * 2) {
+        index_size *= 2;
+    }
+
+    if (index_size != table_descriptor->ksa_index_size) {
+        free(table_descriptor->ksa_index);
+        table_descriptor->ksa_index_size = 0;
+        table_descriptor->ksa_index = malloc(sizeof(uint16_t) * index_size);
+        if (table_descriptor->ksa_index == NULL) {
+            SA_PV_LOG_INFO("Not enough memory for the KSA table index, using linear search");
+            return false;
+        }
+        table_descriptor->ksa_index_size = index_size;
+    }
+    memset(table_descriptor->ksa_index, 0, sizeof(uint16_t) * index_size);
+
+    //KSA table design guarantees that there are no occupied slots after an empty one
+    for (entry_index = 0; entry_index < table_descriptor->ksa_num_of_table_entries; entry_index++) {
+        const ksa_item_entry_s *entry = &table_descriptor->ksa_start_entry[entry_index];
+        if (memcmp(entry->item_name, zero_buffer, KSA_ITEM_NAME_SIZE) == 0) {
+            break;
+        }
+
+        uint32_t slot = item_name_hash(entry->item_name) & (index_size - 1);
+        while (table_descriptor->ksa_index[slot] != 0) {
+            slot = (slot + 1) & (index_size - 1);
+        }
+        table_descriptor->ksa_index[slot] = (uint16_t)(entry_index + 1);
+    }
+
+    table_descriptor->ksa_first_free_entry = entry_index;
+    table_descriptor->ksa_index_valid = true;
+    return true;
+}
+
+/**
+* Looks up an item through the table index. Gives the same result as the linear search in
+* get_ksa_item_entry(): the first entry with the item name and a valid active or factory
+* id, or the first empty entry if there is no such entry.
+*/
+static kcm_status_e get_indexed_item_entry(const ksa_descriptor_s *table_descriptor, const uint8_t* item_name, ksa_item_entry_s **ksa_item_entry_out, bool *is_new_entry)
+{
+    const uint32_t index_mask = table_descriptor->ksa_index_size - 1;
+    ksa_item_entry_s *found_entry = NULL;
+    uint32_t slot = item_name_hash(item_name) & index_mask;
+
+    while (table_descriptor->ksa_index[slot] != 0) {
+        ksa_item_entry_s *ksa_entry = &table_descriptor->ksa_start_entry[table_descriptor->ksa_index[slot] - 1];
+
+        if ((found_entry == NULL || ksa_entry < found_entry) &&
+            (ksa_entry->active_item_id != PSA_INVALID_SLOT_ID || ksa_entry->factory_item_id != PSA_INVALID_SLOT_ID) &&
+            memcmp(ksa_entry->item_name, item_name, KSA_ITEM_NAME_SIZE) == 0) {
+            found_entry = ksa_entry;
+        }
+        slot = (slot + 1) & index_mask;
+    }
+
+    if (found_entry != NULL) {
+        *ksa_item_entry_out = found_entry;
+        *is_new_entry = false;
+        // if active item is present, item already exist in KSA table, otherwise the entry of the deleted factory item is reused
+        return (found_entry->active_item_id != PSA_INVALID_SLOT_ID) ? KCM_STATUS_FILE_EXIST : KCM_STATUS_SUCCESS;
+    }
+
+    if (table_descriptor->ksa_first_free_entry < table_descriptor->ksa_num_of_table_entries) {
+        *ksa_item_entry_out = &table_descriptor->ksa_start_entry[table_descriptor->ksa_first_free_entry];
+    }
+    return KCM_STATUS_SUCCESS;
+}
+
 static kcm_status_e get_ksa_item_entry(const uint8_t* item_name, ksa_item_type_e item_type, ksa_item_entry_s **ksa_item_entry_out, bool *is_new_entry)
 {
     uint32_t current_table_index = (uint32_t)item_type;
@@ -141,6 +260,12 @@ static kcm_status_e get_ksa_item_entry(const uint8_t* item_name, ksa_item_type_e
 
     SA_PV_LOG_TRACE_FUNC_ENTER_NO_ARGS();
 
+    if (build_table_index(&g_ksa_desc[current_table_index])) {
+        result = get_indexed_item_entry(&g_ksa_desc[current_table_index], item_name, ksa_item_entry_out, is_new_entry);
+        SA_PV_LOG_TRACE_FUNC_EXIT("result = %d, is_new_entry = %u", result, *is_new_entry);
+        return result;
+    }
+
     //Check if current item was already saved as factory and its active version was deleted ==> use the existing entry.
     for (uint32_t ksa_entry_index = 0; ksa_entry_index < g_ksa_desc[current_table_index].ksa_num_of_table_entries; ksa_entry_index++, ksa_entry++) {
 
@@ -262,6 +387,7 @@ static kcm_status_e get_active_entry_for_new_item(const uint8_t *item_name, ksa_
 
         //update the size of the new table
         g_ksa_desc[item_type].ksa_num_of_table_entries = new_ksa_table_size;
+        invalidate_table_index(item_type);
     }
 
     SA_PV_LOG_TRACE_FUNC_EXIT_NO_ARGS();
@@ -320,6 +446,7 @@ static void destroy_ksa_tables()
             free(g_ksa_desc[table_index].ksa_start_entry);
             g_ksa_desc[table_index].ksa_start_entry = NULL;
         }
+        free(g_ksa_desc[table_index].ksa_index);
 
         /*invalidate ksa descriptor of the table*/
         memset(&g_ksa_desc[table_index], 0x0, sizeof(ksa_descriptor_s));
@@ -329,10 +456,12 @@ static void destroy_ksa_tables()
 }
 
 
-static kcm_status_e set_entry_id(ksa_item_entry_s *item_entry, ksa_id_type_e item_id_type, uint16_t id_value, ksa_item_type_e table_index)
+/**
+* Sets one id of the entry. The caller stores the table, so that several changes
+* of one operation are written to the storage at once.
+*/
+static kcm_status_e set_entry_id(ksa_item_entry_s *item_entry, ksa_id_type_e item_id_type, uint16_t id_value)
 {
-    kcm_status_e kcm_status = KCM_STATUS_SUCCESS;
-
     SA_PV_LOG_TRACE_FUNC_ENTER("id type %" PRIu32 ", id value %" PRIu16 "", (uint32_t)item_id_type, id_value);
 
     SA_PV_ERR_RECOVERABLE_RETURN_IF((item_entry == NULL), KCM_STATUS_INVALID_PARAMETER, "table_entry is NULL");
@@ -352,10 +481,6 @@ static kcm_status_e set_entry_id(ksa_item_entry_s *item_entry, ksa_id_type_e ite
             SA_PV_ERR_RECOVERABLE_RETURN_IF((true), KCM_STATUS_INVALID_PARAMETER, "Invalid item_entry type");
     }
 
-    //Save the table
-    kcm_status = store_table(&g_ksa_desc[table_index]);
-    SA_PV_ERR_RECOVERABLE_RETURN_IF((kcm_status != KCM_STATUS_SUCCESS), kcm_status, "Failed to store KSA table to persistent store");
-
     SA_PV_LOG_TRACE_FUNC_EXIT_NO_ARGS();
     return KCM_STATUS_SUCCESS;
 }
@@ -385,6 +510,8 @@ static void squeeze_item_entries(ksa_item_entry_s *item_entry, ksa_item_type_e k
 {
     ksa_item_entry_s* last_occupied_entry = g_ksa_desc[ksa_item_type].ksa_last_occupied_entry;
 
+    invalidate_table_index(ksa_item_type);
+
     //copy ksa_item_entry_s parameters of ksa_last_occupied_entry to the destroyed entry.
     if (item_entry != last_occupied_entry) {
         memcpy(item_entry, last_occupied_entry, sizeof(ksa_item_entry_s));
@@ -428,6 +555,7 @@ static kcm_status_e destroy_all_ce_keys()
 {
     ksa_item_entry_s *table_entry = (ksa_item_entry_s*)g_ksa_desc[KSA_KEY_ITEM].ksa_start_entry;
     kcm_status_e kcm_status = KCM_STATUS_SUCCESS;
+    bool is_table_changed = false;
 
     while (table_entry <= g_ksa_desc[KSA_KEY_ITEM].ksa_last_occupied_entry) {
         if (table_entry->renewal_item_id != 0) {
@@ -437,10 +565,17 @@ static kcm_status_e destroy_all_ce_keys()
             kcm_status = delete_data(table_entry->renewal_item_id);
             SA_PV_ERR_RECOVERABLE_RETURN_IF((kcm_status != KCM_STATUS_SUCCESS && kcm_status != KCM_STATUS_INVALID_PARAMETER), kcm_status, "Failed to destroy key id");
             //zero the entry
-            set_entry_id(table_entry, KSA_CE_PSA_ID_TYPE, PSA_INVALID_SLOT_ID, KSA_KEY_ITEM);
+            set_entry_id(table_entry, KSA_CE_PSA_ID_TYPE, PSA_INVALID_SLOT_ID);
+            is_table_changed = true;
         }
         table_entry++;
     }
+
+    //Store all the changes at once
+    if (is_table_changed) {
+        kcm_status = store_table(&g_ksa_desc[KSA_KEY_ITEM]);
+        SA_PV_ERR_RECOVERABLE_RETURN_IF((kcm_status != KCM_STATUS_SUCCESS), kcm_status, "Failed to store KSA table to persistent store");
+    }
     return KCM_STATUS_SUCCESS;
 }
 
@@ -460,6 +595,7 @@ static kcm_status_e store_item_to_entry(ksa_item_entry_s *item_entry,
 
     //1. store item-name hash in the slot
     memcpy(item_entry->item_name, item_name, KSA_ITEM_NAME_SIZE);
+    invalidate_table_index(ksa_item_type);
 
     if (is_factory == true) {
         //If factory id of this entry is valid : this factory item is should be destroyed and its id should be overwritten in the table
@@ -592,6 +728,7 @@ static kcm_status_e init_ksa_tables()
                 g_ksa_desc[table_index].ksa_num_of_table_entries = KSA_INITIAL_TABLE_ENTRIES;
                 //update the last occupied_entry
                 g_ksa_desc[table_index].ksa_last_occupied_entry = NULL;
+                invalidate_table_index((ksa_item_type_e)table_index);
 
             } else { //If the table is in the storage
 
@@ -610,6 +747,7 @@ static kcm_status_e init_ksa_tables()
 
                 //update pointer to last occupied entry
                 g_ksa_desc[table_index].ksa_last_occupied_entry = find_last_occuppied_slot(g_ksa_desc[table_index].ksa_start_entry, g_ksa_desc[table_index].ksa_num_of_table_entries);
+                invalidate_table_index((ksa_item_type_e)table_index);
 
 
                 //destroy remaining keys in ce slots if exist
@@ -1173,8 +1311,8 @@ kcm_status_e ksa_factory_reset(void)
                 kcm_status = delete_data(table_entry->renewal_item_id);
                 SA_PV_ERR_RECOVERABLE_RETURN_IF((kcm_status != KCM_STATUS_SUCCESS), kcm_status, "Failed destroying CE item ");
 
-                //zero the entry
-                set_entry_id(table_entry, KSA_CE_PSA_ID_TYPE, PSA_INVALID_SLOT_ID, table_index);
+                //zero the entry, the table is stored after all entries are reset
+                set_entry_id(table_entry, KSA_CE_PSA_ID_TYPE, PSA_INVALID_SLOT_ID);
             }
 
             //squeeze the entry, if it became empty after factory reset - e.g both active and factory entries are 0
@@ -1408,15 +1546,19 @@ kcm_status_e ksa_generate_ce_keys(
     kcm_status = psa_drv_crypto_generate_keys_from_existing_ids(prv_ksa_id, pub_ksa_id, &prv_ksa_id, &pub_ksa_id, psa_priv_key_handle, psa_pub_key_handle);
     SA_PV_ERR_RECOVERABLE_RETURN_IF((kcm_status != KCM_STATUS_SUCCESS), kcm_status, "Failed to generate keys");
 
-    kcm_status = set_entry_id(priv_key_entry, KSA_CE_PSA_ID_TYPE, prv_ksa_id, KSA_KEY_ITEM);
+    kcm_status = set_entry_id(priv_key_entry, KSA_CE_PSA_ID_TYPE, prv_ksa_id);
     SA_PV_ERR_RECOVERABLE_GOTO_IF((kcm_status != KCM_STATUS_SUCCESS), kcm_status = kcm_status, exit, "Failed to set_entry_id");
 
     if (public_key_name != NULL) {
 
-        kcm_status = set_entry_id(pub_key_entry, KSA_CE_PSA_ID_TYPE, pub_ksa_id, KSA_KEY_ITEM);
+        kcm_status = set_entry_id(pub_key_entry, KSA_CE_PSA_ID_TYPE, pub_ksa_id);
         SA_PV_ERR_RECOVERABLE_GOTO_IF((kcm_status != KCM_STATUS_SUCCESS), kcm_status = kcm_status, exit, "Failed to set_entry_id");
     }
 
+    //Store the ids of both keys at once
+    kcm_status = store_table(&g_ksa_desc[KSA_KEY_ITEM]);
+    SA_PV_ERR_RECOVERABLE_GOTO_IF((kcm_status != KCM_STATUS_SUCCESS), kcm_status = kcm_status, exit, "Failed to store KSA table to persistent store");
+
     SA_PV_LOG_INFO_FUNC_EXIT_NO_ARGS();
 
 exit:
@@ -1424,14 +1566,15 @@ exit:
         //In case of error we need to close and destroy allocated key handles
         if (psa_priv_key_handle != 0) {
             psa_destroy_key(*psa_priv_key_handle);
-            set_entry_id(priv_key_entry, KSA_CE_PSA_ID_TYPE, PSA_INVALID_SLOT_ID, KSA_KEY_ITEM);
+            set_entry_id(priv_key_entry, KSA_CE_PSA_ID_TYPE, PSA_INVALID_SLOT_ID);
             *psa_priv_key_handle = 0;
         }
         if (psa_pub_key_handle != 0) {
             psa_destroy_key(*psa_pub_key_handle);
-            set_entry_id(pub_key_entry, KSA_CE_PSA_ID_TYPE, PSA_INVALID_SLOT_ID, KSA_KEY_ITEM);
+            set_entry_id(pub_key_entry, KSA_CE_PSA_ID_TYPE, PSA_INVALID_SLOT_ID);
             *psa_pub_key_handle = 0;
         }
+        (void)store_table(&g_ksa_desc[KSA_KEY_ITEM]);
     }
 
     return kcm_status;
@@ -1470,7 +1613,7 @@ kcm_status_e ksa_destroy_ce_key(const uint8_t *item_name, uint32_t item_type)
     SA_PV_ERR_RECOVERABLE_RETURN_IF((kcm_status != KCM_STATUS_SUCCESS && kcm_status != KCM_STATUS_INVALID_PARAMETER), kcm_status, "Failed to destroy key id");
 
     //Clean the current id field
-    kcm_status = set_entry_id(ksa_key_entry, KSA_CE_PSA_ID_TYPE, PSA_INVALID_SLOT_ID, ksa_item_type);
+    kcm_status = set_entry_id(ksa_key_entry, KSA_CE_PSA_ID_TYPE, PSA_INVALID_SLOT_ID);
     SA_PV_ERR_RECOVERABLE_RETURN_IF((kcm_status != KCM_STATUS_SUCCESS), kcm_status, "Failed to update active id");
 
     kcm_status = store_table(&g_ksa_desc[item_type]);
@@ -1498,6 +1641,7 @@ kcm_status_e  ksa_remove_entry(const uint8_t *item_name, uint32_t item_type, boo
     //if only active id should be removed, no need to clean factory id .
     if (remove_active_only == false) {
         reset_table_entry(table_entry);
+        invalidate_table_index(ksa_item_type);
     }
     //Clean the entry and squeeze the table
     kcm_status = deactivate_entry(table_entry, ksa_item_type);
@@ -1533,6 +1677,7 @@ kcm_status_e ksa_copy_item(const uint8_t *existing_item_name, uint32_t item_type
     SA_PV_ERR_RECOVERABLE_RETURN_IF((kcm_status != KCM_STATUS_SUCCESS && kcm_status != KCM_STATUS_FILE_EXIST), kcm_status, "Failed to get a new entry");
 
     ksa_copy_entry((const uint8_t*)new_item_name, (const ksa_item_entry_s*)ksa_source_key_entry, ksa_new_key_entry);
+    invalidate_table_index(ksa_item_type);
     if (ksa_new_key_entry > ksa_source_key_entry) {
         g_ksa_desc[ksa_item_type].ksa_last_occupied_entry = ksa_new_key_entry;
     }
@@ -1559,13 +1704,17 @@ kcm_status_e ksa_activate_ce_key(const uint8_t *key_name)
     SA_PV_ERR_RECOVERABLE_RETURN_IF((table_entry->renewal_item_id == 0), kcm_status = KCM_STATUS_ITEM_NOT_FOUND, "Renewal ID is not valid");
 
     //Update active id of the entry with value of renewal id
-    kcm_status = set_entry_id(table_entry, KSA_ACTIVE_PSA_ID_TYPE, table_entry->renewal_item_id, KSA_KEY_ITEM);
+    kcm_status = set_entry_id(table_entry, KSA_ACTIVE_PSA_ID_TYPE, table_entry->renewal_item_id);
     SA_PV_ERR_RECOVERABLE_RETURN_IF((kcm_status != KCM_STATUS_SUCCESS), kcm_status, "Failed to update active id");
 
     // default renewal id 
-    kcm_status = set_entry_id(table_entry, KSA_CE_PSA_ID_TYPE, PSA_INVALID_SLOT_ID, KSA_KEY_ITEM);
+    kcm_status = set_entry_id(table_entry, KSA_CE_PSA_ID_TYPE, PSA_INVALID_SLOT_ID);
     SA_PV_ERR_RECOVERABLE_RETURN_IF((kcm_status != KCM_STATUS_SUCCESS), kcm_status, "Failed to zero renewal id");
 
+    //Store both changes at once, so the renewal id never remains equal to the active id in the storage
+    kcm_status = store_table(&g_ksa_desc[KSA_KEY_ITEM]);
+    SA_PV_ERR_RECOVERABLE_RETURN_IF((kcm_status != KCM_STATUS_SUCCESS), kcm_status, "Failed to store KSA table to persistent store");
+
     SA_PV_LOG_INFO_FUNC_EXIT_NO_ARGS();
     return kcm_status;
 }
@@ -1658,9 +1807,12 @@ kcm_status_e ksa_update_key_id(const uint8_t *key_name, ksa_id_type_e key_id_typ
     SA_PV_ERR_RECOVERABLE_RETURN_IF((kcm_status != KCM_STATUS_SUCCESS), kcm_status, "Failed get_active_entry_of_existing_item");
 
     //Update active id of the entry with value of renewal id
-    kcm_status = set_entry_id(table_entry, key_id_type, id_value, KSA_KEY_ITEM);
+    kcm_status = set_entry_id(table_entry, key_id_type, id_value);
     SA_PV_ERR_RECOVERABLE_RETURN_IF((kcm_status != KCM_STATUS_SUCCESS), kcm_status, "Failed to update active id");
 
+    kcm_status = store_table(&g_ksa_desc[KSA_KEY_ITEM]);
+    SA_PV_ERR_RECOVERABLE_RETURN_IF((kcm_status != KCM_STATUS_SUCCESS), kcm_status, "Failed to store KSA table to persistent store");
+
     SA_PV_LOG_INFO_FUNC_EXIT_NO_ARGS();
     return kcm_status;
 }
@@ -32,17 +32,21 @@
 typedef struct sotp_type_lookup_record_ {
     sotp_type_e sotp_type;
     const char *type_name;
+    bool is_deferred;
 } sotp_type_lookup_record_s;
 
 
 /**
 * sotp type table, correlating for each sotp type and name.
+* Deferred types are written to flash on storage_finalize() or by the next write of the type.
+* The saved time is one of them, as it is written on every time update, and the boot time
+* falls back to the last time back if it is lost.
 */
 static const sotp_type_lookup_record_s sotp_type_lookup_table[] = {
-    { SOTP_TYPE_FACTORY_DONE,               STORAGE_RBP_FACTORY_DONE_NAME },
-    { SOTP_TYPE_SAVED_TIME,                 STORAGE_RBP_SAVED_TIME_NAME },
-    { SOTP_TYPE_LAST_TIME_BACK,             STORAGE_RBP_LAST_TIME_BACK_NAME },
-    { SOTP_TYPE_TRUSTED_TIME_SRV_ID,        STORAGE_RBP_TRUSTED_TIME_SRV_ID_NAME }
+    { SOTP_TYPE_FACTORY_DONE,               STORAGE_RBP_FACTORY_DONE_NAME,          false },
+    { SOTP_TYPE_SAVED_TIME,                 STORAGE_RBP_SAVED_TIME_NAME,            true },
+    { SOTP_TYPE_LAST_TIME_BACK,             STORAGE_RBP_LAST_TIME_BACK_NAME,        false },
+    { SOTP_TYPE_TRUSTED_TIME_SRV_ID,        STORAGE_RBP_TRUSTED_TIME_SRV_ID_NAME,   false }
 };
 
 #define ARRAY_LENGTH(array) (sizeof(array)/sizeof((array)[0]))
@@ -50,7 +54,7 @@ static const sotp_type_lookup_record_s sotp_type_lookup_table[] = {
 
 extern bool g_kcm_initialized;
 
-static bool get_sotp_type(const char *sotp_item, sotp_type_e *sotp_type)
+static bool get_sotp_type(const char *sotp_item, sotp_type_e *sotp_type, bool *is_deferred)
 {
     size_t index = 0;
 
@@ -58,6 +62,9 @@ static bool get_sotp_type(const char *sotp_item, sotp_type_e *sotp_type)
         if (strlen(sotp_item) == strlen(sotp_type_lookup_table[index].type_name)) {
             if (memcmp(sotp_type_lookup_table[index].type_name, sotp_item, strlen(sotp_type_lookup_table[index].type_name)) == 0) {
                 *sotp_type = sotp_type_lookup_table[index].sotp_type;
+                if (is_deferred != NULL) {
+                    *is_deferred = sotp_type_lookup_table[index].is_deferred;
+                }
                 return true;
             }
         }
@@ -209,9 +216,13 @@ kcm_status_e storage_init()
 kcm_status_e storage_finalize()
 {
     esfs_result_e esfs_status;
+    sotp_result_e sotp_status;
 
     SA_PV_LOG_TRACE_FUNC_ENTER_NO_ARGS();
 
+    sotp_status = sotp_flush();
+    SA_PV_ERR_RECOVERABLE_RETURN_IF((sotp_status != SOTP_SUCCESS), KCM_STATUS_STORAGE_ERROR, "Failed to flush sotp storage (sotp_status %d)", sotp_status);
+
     esfs_status = esfs_finalize();
     SA_PV_ERR_RECOVERABLE_RETURN_IF((esfs_status != ESFS_SUCCESS), esfs_to_kcm_error_translation(esfs_status), "Failed finalizing ESFS (esfs_status %d)", esfs_status);
 
@@ -269,7 +280,7 @@ palStatus_t storage_rbp_read(
     SA_PV_ERR_RECOVERABLE_RETURN_IF((data_size == 0 || data_size > UINT16_MAX), PAL_ERR_INVALID_ARGUMENT, "Invalid data_length");
     SA_PV_ERR_RECOVERABLE_RETURN_IF((data_actual_size_out == NULL), PAL_ERR_INVALID_ARGUMENT, "Invalid data_actual_size_out");
 
-    status = get_sotp_type(item_name, &sotp_type);
+    status = get_sotp_type(item_name, &sotp_type, NULL);
     SA_PV_ERR_RECOVERABLE_RETURN_IF((status != true), PAL_ERR_INVALID_ARGUMENT, "Invalid sotp data name");
 
     // Prior to reading from the SOTP, set the data_actual_size_out to 0. sotp_get() writes only 2 bytes
@@ -294,6 +305,7 @@ palStatus_t storage_rbp_write(
     bool is_write_once)
 {
     bool status = false;
+    bool is_deferred = false;
     sotp_type_e sotp_type = SOTP_MAX_TYPES;
     sotp_result_e sotp_result = SOTP_SUCCESS;
     uint16_t sotp_buffer_size = 0;
@@ -304,7 +316,7 @@ palStatus_t storage_rbp_write(
     SA_PV_ERR_RECOVERABLE_RETURN_IF((data == NULL), PAL_ERR_INVALID_ARGUMENT, "Invalid data");
     SA_PV_ERR_RECOVERABLE_RETURN_IF((data_size == 0 || data_size > UINT16_MAX), PAL_ERR_INVALID_ARGUMENT, "Invalid data_length");
 
-    status = get_sotp_type(item_name, &sotp_type);
+    status = get_sotp_type(item_name, &sotp_type, &is_deferred);
     SA_PV_ERR_RECOVERABLE_RETURN_IF((status != true), PAL_ERR_INVALID_ARGUMENT, "Invalid sotp data name");
 
     if (is_write_once == true) {
@@ -313,7 +325,11 @@ palStatus_t storage_rbp_write(
         SA_PV_ERR_RECOVERABLE_RETURN_IF((sotp_result == SOTP_SUCCESS), PAL_ERR_ITEM_EXIST, "The item was already written to sotp");
     }
 
-    sotp_result = sotp_set(sotp_type, (uint16_t)data_size, (const uint32_t*)data);
+    if (is_deferred == true && is_write_once == false) {
+        sotp_result = sotp_set_deferred(sotp_type, (uint16_t)data_size, (const uint32_t*)data);
+    } else {
+        sotp_result = sotp_set(sotp_type, (uint16_t)data_size, (const uint32_t*)data);
+    }
     SA_PV_ERR_RECOVERABLE_RETURN_IF((sotp_result != SOTP_SUCCESS), PAL_ERR_GENERIC_FAILURE, "SOTP set failed");
 
     return PAL_SUCCESS;
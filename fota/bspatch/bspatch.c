@@ -166,6 +166,31 @@ void printStats()
 
 #endif
 
+/**
+ * Add diff bytes to old file bytes in place (modulo 256 per byte).
+ * Works a 32-bit word at a time: low 7 bits of each byte are added without
+ * carrying to the next byte, top bit is then put back with xor.
+ * @param data old file bytes, replaced with new file bytes
+ * @param diff diff bytes
+ * @param len number of bytes
+ */
+static void add_diff_bytes(uint8_t *data, const uint8_t *diff, uint32_t len)
+{
+    uint32_t i = 0;
+
+    for (; i + sizeof(uint32_t) <= len; i += sizeof(uint32_t)) {
+        uint32_t a, b;
+        memcpy(&a, data + i, sizeof(a));
+        memcpy(&b, diff + i, sizeof(b));
+        a = ((a & 0x7F7F7F7F) + (b & 0x7F7F7F7F)) ^ ((a ^ b) & 0x80808080);
+        memcpy(data + i, &a, sizeof(a));
+    }
+
+    for (; i < len; i++) {
+        data[i] += diff[i];
+    }
+}
+
 static int64_t offtin(uint8_t *buf)
 {
     int64_t y;
@@ -235,6 +260,12 @@ static bs_patch_api_return_code_t read_deCompressBuffer(struct bspatch_stream *s
  }
  */
 
+/*
+ * Each frame is an independent LZ4 block (no dictionary shared between frames), so a frame is
+ * decoded as soon as its last byte is read from the patch stream. Patch data is pulled from the
+ * caller one frame at a time, and the caller already fetches the next payload fragment while
+ * this one is decoded and patched, so decoding frames ahead of the patcher would only add memory.
+ */
 bs_patch_api_return_code_t read_deCompressBuffer_process(struct bspatch_stream *stream, uint32_t frame_len)
 {
     stream->undeCompressBuffer_len = LZ4_decompress_safe((char *) stream->bufferForCompressedData,
@@ -627,11 +658,8 @@ bs_patch_api_return_code_t ARM_BS_ProcessPatchEvent(bspatch_stream *stream, bs_p
                 break;
             case EBspatch_processDiffBytes_processSinglePieceContinue_writePart:
 
-                for (uint32_t i = 0; i < stream->readRequestSize; i++) {
-                    uint8_t newByte = stream->bufferForCompressedData[i]
-                                      + stream->nonCompressedDataBuffer[stream->i + i];
-                    stream->bufferForCompressedData[i] = newByte;
-                }
+                add_diff_bytes(stream->bufferForCompressedData, stream->nonCompressedDataBuffer + stream->i,
+                               stream->readRequestSize);
                 status = sendWriteNewRequest(stream, stream->bufferForCompressedData, stream->readRequestSize);
                 stream->i += stream->readRequestSize;
                 WAIT_FOR_WRITE_NEW(EBspatch_processDiffBytes_processSinglePieceContinue2)
@@ -28,6 +28,7 @@
 #include "fota/fota_manifest.h"
 #include "fota/fota_source.h"
 #include "fota/fota_delta.h"
+#include "fota/fota_decompress.h"
 #include "fota/fota_app_ifs.h"
 #include "fota_platform_hooks.h"
 #include "fota/fota_nvm.h"
@@ -41,6 +42,8 @@
 #include "fota/fota_component_internal.h"
 #include "fota/fota_fw_download.h"
 #include "fota/fota_ext_downloader.h"
+#include "fota/fota_stats.h"
+#include "mbed-cloud-client/PerfCounters.h"
 #include <stdlib.h>
 #include <inttypes.h>
 
@@ -80,6 +83,15 @@ static size_t storage_available;
 
 static bool fota_defer_by_user = false;
 static bool erase_candidate_image = true;
+static bool reboot_pending = false;
+
+#if defined(FOTA_DEFERRED_REBOOT)
+// Component installed with its reboot deferred, verified after the next reboot
+typedef struct {
+    char comp_name[FOTA_COMPONENT_MAX_NAME_SIZE];
+    fota_header_info_t header;
+} fota_pending_component_t;
+#endif
 
 bool fota_resume_download_after_user_auth = true; //indication if resume flow  executed after reboot, used also in test_fota_core.cpp.
 fota_install_state_e fota_install_state = FOTA_INSTALL_STATE_IDLE; //FOTA installation state, used also in test_fota_core.cpp.
@@ -93,6 +105,22 @@ static size_t mc_image_data_addr;
 static int multicast_br_candidate_iterate_handler(fota_candidate_iterate_callback_info *info);
 #endif
 static int multicast_br_post_install_handler(const char *component_name, const fota_header_info_t *expected_header_info);
+
+#if (MBED_CLOUD_CLIENT_FOTA_MULTICAST_BR_READ_CACHE_BLOCKS > 0)
+// Image blocks recently served to the nodes. Block 0 reads ahead for the distribution pass,
+// the others keep the blocks of repair requests, as many nodes miss the same fragments.
+typedef struct {
+    uint8_t *buf;
+    size_t offset;
+    size_t size;                // 0 if the block holds no data
+    uint32_t last_use;
+} mc_br_cache_block_t;
+
+static mc_br_cache_block_t mc_br_read_cache[MBED_CLOUD_CLIENT_FOTA_MULTICAST_BR_READ_CACHE_BLOCKS];
+static uint32_t mc_br_read_cache_clock = 0;
+static size_t mc_br_next_read_offset = 0;
+static size_t mc_br_image_size = 0;     // 0 if no image is served
+#endif
 #elif (MBED_CLOUD_CLIENT_FOTA_MULTICAST_SUPPORT == FOTA_MULTICAST_NODE_MODE)
 #if MBED_CLOUD_CLIENT_FOTA_EXTERNAL_DOWNLOADER
 static void ext_downloader_manifest_post_action_cb(int ret);
@@ -101,6 +129,24 @@ static bool mc_node_new_image = false;
 static size_t mc_node_image_size = 0;
 static size_t mc_node_frag_size = 0;
 static void fota_multicast_node_on_fragment(void);
+
+#if (MBED_CLOUD_CLIENT_FOTA_MULTICAST_NODE_WRITE_CACHE_SIZE > 0)
+// Fragments staged before programming, so that fragments arriving out of order are programmed together
+typedef struct {
+    uint8_t *buf;
+    uint8_t *filled;            // Bitmap of the fragments staged in the window
+    size_t num_frags;
+    size_t num_filled;
+    size_t base;                // Image offset of the window
+    size_t short_frag;          // Fragment shorter than the fragment size (image end), num_frags if none
+    size_t short_frag_size;
+    bool in_use;
+} mc_node_write_cache_t;
+
+static mc_node_write_cache_t mc_node_write_cache = { 0 };
+static int write_cache_flush(void);
+static void write_cache_free(void);
+#endif
 #endif
 #endif
 
@@ -136,6 +182,9 @@ int manifest_delete(void)
 #if (MBED_CLOUD_CLIENT_FOTA_RESUME_SUPPORT == FOTA_RESUME_UNSUPPORTED)
     return FOTA_STATUS_SUCCESS;
 #else
+#if defined(FOTA_RESUME_HASH_CHECKPOINT)
+    fota_nvm_hash_checkpoint_delete();
+#endif
     return fota_nvm_manifest_delete();
 #endif
 
@@ -146,6 +195,13 @@ fota_context_t *fota_get_context(void)
     return fota_ctx;
 }
 
+// Delta and compressed payloads are unpacked on device, so installed FW differs from payload
+static bool is_payload_unpacked(void)
+{
+    return (fota_ctx->fw_info->payload_format == FOTA_MANIFEST_PAYLOAD_FORMAT_DELTA) ||
+           (fota_ctx->fw_info->payload_format == FOTA_MANIFEST_PAYLOAD_FORMAT_COMPRESSED_RAW);
+}
+
 static void free_context_buffers(void)
 {
     if (!fota_ctx) {
@@ -164,14 +220,23 @@ static void free_context_buffers(void)
     }
 #endif  // !defined(FOTA_DISABLE_DELTA)
 
+#if (MBED_CLOUD_CLIENT_FOTA_COMPRESSED_PAYLOAD_SUPPORT == 1)
+    free(fota_ctx->decompress_buf);
+    fota_ctx->decompress_buf = NULL;
+    fota_decompress_finalize(&fota_ctx->decompress_ctx);
+#endif
+
 #if (MBED_CLOUD_CLIENT_FOTA_ENCRYPTION_SUPPORT == 1)
     fota_encrypt_finalize(&fota_ctx->enc_ctx);
 #endif
 
     fota_hash_finish(&fota_ctx->payload_hash_ctx);
-#if !defined(FOTA_DISABLE_DELTA)
+#if defined(FOTA_UNPACKED_PAYLOAD_SUPPORT)
     fota_hash_finish(&fota_ctx->installed_hash_ctx);
 #endif
+#if defined(FOTA_RESUME_HASH_CHECKPOINT)
+    fota_hash_finish(&fota_ctx->checkpoint_hash_ctx);
+#endif
 #if (MBED_CLOUD_CLIENT_FOTA_MULTICAST_SUPPORT == FOTA_MULTICAST_NODE_MODE)
     free(fota_ctx->mc_node_frag_buf);
     fota_ctx->mc_node_frag_buf = NULL;
@@ -203,6 +268,9 @@ static inline void handle_fota_app_on_download_progress(size_t downloaded_size,
 static void update_cleanup(void)
 {
     if (fota_ctx) {
+        // Installation may still be running in slices
+        fota_event_handler_cancel_sliced();
+        fota_candidate_iterate_abort();
         fota_download_deinit(&fota_ctx->download_handle);
         free_context_buffers();
         free(fota_ctx);
@@ -440,6 +508,56 @@ static int comp_install_verify(const fota_component_desc_t *comp_desc, unsigned
 }
 #endif
 
+#if defined(FOTA_DEFERRED_REBOOT)
+// Reads the components installed since the last reboot, returns how many there are
+static size_t pending_components_get(fota_pending_component_t *pending)
+{
+    size_t bytes_read = 0;
+    if (fota_nvm_pending_components_get((uint8_t *) pending,
+                                        MBED_CLOUD_CLIENT_FOTA_DEFERRED_REBOOT_COMPONENTS * sizeof(fota_pending_component_t),
+                                        &bytes_read)) {
+        return 0;
+    }
+    return bytes_read / sizeof(fota_pending_component_t);
+}
+
+static void verify_pending_components(void)
+{
+    unsigned int comp_id;
+    const fota_component_desc_t *comp_desc;
+    fota_pending_component_t *pending = (fota_pending_component_t *) calloc(MBED_CLOUD_CLIENT_FOTA_DEFERRED_REBOOT_COMPONENTS,
+                                                                            sizeof(fota_pending_component_t));
+    if (!pending) {
+        FOTA_TRACE_ERROR("FOTA pending components - allocation failed");
+        return;
+    }
+
+    size_t count = pending_components_get(pending);
+    for (size_t i = 0; i < count; i++) {
+        FOTA_TRACE_DEBUG("Verifying deferred installation of component %s", pending[i].comp_name);
+        int ret = fota_component_name_to_id(pending[i].comp_name, &comp_id);
+        if (!ret) {
+            fota_component_get_desc(comp_id, &comp_desc);
+            ret = comp_install_verify(comp_desc, comp_id, &pending[i].header);
+        }
+        if (ret) {
+            FOTA_TRACE_ERROR("Deferred installation of component %s failed %d", pending[i].comp_name, ret);
+            fota_source_report_update_result(FOTA_STATUS_FW_INSTALLATION_FAILED);
+        }
+    }
+
+    if (count) {
+        fota_nvm_pending_components_delete();
+    }
+    free(pending);
+}
+#endif // defined(FOTA_DEFERRED_REBOOT)
+
+bool fota_is_reboot_pending(void)
+{
+    return reboot_pending;
+}
+
 int fota_verify_installation_after_upgrade()
 {
     int ret = FOTA_STATUS_SUCCESS;
@@ -635,6 +753,11 @@ int fota_init(void *m2m_interface, void *resource_list)
         fota_nvm_fw_encryption_key_delete();
     }
 
+#if defined(FOTA_DEFERRED_REBOOT)
+    // Components whose reboot was deferred are running their new versions now
+    verify_pending_components();
+#endif
+
 #if (FOTA_COMPONENT_SUPPORT)
     // Now we should have all components registered, report them all
     unsigned int num_comps = fota_component_num_components();
@@ -1126,6 +1249,158 @@ finish:
 #endif
 }
 
+static void finish_install_component(const fota_component_desc_t *comp_desc, int ret, bool reboot)
+{
+    (void) ret;
+
+    // remove manifest after candidate installation finished and before potential reboot.
+    // MAIN component for mbed-os will be installed by the bootloader
+    manifest_delete();
+	
+    if (reboot && (fota_install_state == FOTA_INSTALL_STATE_AUTHORIZE)) {
+        fota_ctx->state = FOTA_STATE_IDLE;
+        fota_source_report_state(FOTA_SOURCE_STATE_REBOOTING, on_reboot, on_reboot);
+        return;
+    }
+
+    if (fota_install_state == FOTA_INSTALL_STATE_AUTHORIZE) {
+
+#if (MBED_CLOUD_CLIENT_FOTA_MULTICAST_SUPPORT == FOTA_MULTICAST_NODE_MODE)
+        if (fota_ctx->mc_node_update) {
+            FOTA_DBG_ASSERT(fota_ctx->mc_node_post_action_callback);
+            fota_ctx->mc_node_post_action_callback(ret);
+        }
+#endif
+        fota_platform_finish_update_hook(comp_desc->name);
+        fota_source_report_update_result(FOTA_STATUS_FW_UPDATE_OK);
+        fota_source_report_state(FOTA_SOURCE_STATE_IDLE, NULL, NULL);
+
+#if (MBED_CLOUD_CLIENT_FOTA_MULTICAST_SUPPORT == FOTA_MULTICAST_BR_MODE)
+        if (fota_ctx->mc_br_update) {
+            // don't erase candidate image in case of node update by border router
+            erase_candidate_image = false;
+        }
+#endif
+
+        if (erase_candidate_image == true)
+        {
+            fota_candidate_erase();
+        }
+    }
+
+    update_cleanup();
+}
+
+#if FOTA_COMPONENT_SUPPORT
+static int read_installed_header(fota_header_info_t *header)
+{
+    size_t bd_read_size, bd_prog_size, offest = fota_ctx->fw_header_offset;
+    int ret = fota_bd_get_read_size(&bd_read_size);
+    if (ret) {
+        return ret;
+    }
+    ret = fota_bd_get_program_size(&bd_prog_size);
+    if (ret) {
+        return ret;
+    }
+    return fota_candidate_read_header(&offest, bd_read_size, bd_prog_size, header);
+}
+
+#if defined(FOTA_DEFERRED_REBOOT)
+// Adds the installed component to the ones verified after the next reboot, false if it has to reboot now
+static bool defer_component_reboot(const fota_component_desc_t *comp_desc)
+{
+    bool deferred = false;
+    size_t count;
+    fota_pending_component_t *pending = (fota_pending_component_t *) calloc(MBED_CLOUD_CLIENT_FOTA_DEFERRED_REBOOT_COMPONENTS,
+                                                                            sizeof(fota_pending_component_t));
+    if (!pending) {
+        return false;
+    }
+
+    count = pending_components_get(pending);
+    if (count == MBED_CLOUD_CLIENT_FOTA_DEFERRED_REBOOT_COMPONENTS) {
+        goto finish;
+    }
+
+    strncpy(pending[count].comp_name, comp_desc->name, FOTA_COMPONENT_MAX_NAME_SIZE - 1);
+    if (read_installed_header(&pending[count].header)) {
+        goto finish;
+    }
+
+    if (fota_nvm_pending_components_set((const uint8_t *) pending, (count + 1) * sizeof(fota_pending_component_t))) {
+        goto finish;
+    }
+
+    reboot_pending = true;
+    deferred = true;
+
+finish:
+    free(pending);
+    return deferred;
+}
+#endif // defined(FOTA_DEFERRED_REBOOT)
+
+// Called once the installer iterated over the whole candidate, possibly in several event loop slices
+static void on_component_installed(int32_t status)
+{
+    unsigned int comp_id;
+    const fota_component_desc_t *comp_desc;
+    int ret = (int) status;
+
+    if (!fota_ctx) {
+        return;
+    }
+
+    comp_id = fota_ctx->comp_id;
+    fota_component_get_desc(comp_id, &comp_desc);
+
+    if (ret) {
+        abort_update(ret, "Failed on component update");
+        return;
+    }
+
+#if defined(TARGET_LIKE_LINUX)
+    if (!fota_component_is_internal_component(comp_id)) {
+        ret = fota_app_on_install_candidate(fota_linux_get_candidate_file_name(), fota_ctx->fw_info);
+        if (ret) {
+            FOTA_TRACE_ERROR("Application candidate install callback for %s failed %d", comp_desc->name, ret);
+            abort_update(FOTA_STATUS_FW_INSTALLATION_FAILED, "Failed on component install");
+            return;
+        }
+    }
+#endif
+
+    bool reboot = comp_desc->desc_info.need_reboot;
+
+#if defined(FOTA_DEFERRED_REBOOT)
+    // Components installed here are verified after the next reboot, which may cover the rest of the set
+    if (reboot && (comp_id != FOTA_COMPONENT_MAIN_COMP_NUM) &&
+            (fota_install_state == FOTA_INSTALL_STATE_AUTHORIZE) && defer_component_reboot(comp_desc)) {
+        FOTA_TRACE_INFO("Reboot for component %s deferred", comp_desc->name);
+        reboot = false;
+        fota_nvm_fw_encryption_key_delete();
+        handle_fota_app_on_complete(FOTA_STATUS_SUCCESS); //notify application on after install, reboot pending
+    }
+#endif
+
+    if (!comp_desc->desc_info.need_reboot) {
+        fota_header_info_t header;
+        ret = read_installed_header(&header);
+        if (ret) {
+            goto fail;
+        }
+
+        ret = comp_install_verify(comp_desc, comp_id, &header);
+fail:
+        fota_nvm_fw_encryption_key_delete();
+        handle_fota_app_on_complete(ret); //notify application on after install, no reset
+    }
+
+    finish_install_component(comp_desc, ret, reboot);
+}
+#endif // FOTA_COMPONENT_SUPPORT
+
 static void install_component()
 {
     unsigned int comp_id = fota_ctx->comp_id;
@@ -1166,8 +1441,8 @@ static void install_component()
     if (do_install) {
         FOTA_TRACE_INFO("Installing new version for component %s", comp_desc->name);
 
-        // Run the installer using the candidate iterate service
-        ret = fota_candidate_iterate_image(true, (bool) MBED_CLOUD_CLIENT_FOTA_ENCRYPTION_SUPPORT,
+        // Run the installer using the candidate iterate service, in time slices if so configured
+        ret = fota_candidate_iterate_start(true, (bool) MBED_CLOUD_CLIENT_FOTA_ENCRYPTION_SUPPORT,
                                            comp_desc->name, install_alignment,
                                            iterate_handler);
         if (ret) {
@@ -1175,78 +1450,13 @@ static void install_component()
             return;
         }
 
-#if defined(TARGET_LIKE_LINUX)
-        if (!fota_component_is_internal_component(comp_id)) {
-            ret = fota_app_on_install_candidate(fota_linux_get_candidate_file_name(), fota_ctx->fw_info);
-            if (ret) {
-                FOTA_TRACE_ERROR("Application candidate install callback for %s failed %d", comp_desc->name, ret);
-                abort_update(FOTA_STATUS_FW_INSTALLATION_FAILED, "Failed on component install");
-                return;
-            }
-        }
-#endif
-
-        if (!comp_desc->desc_info.need_reboot) {
-            size_t bd_read_size, bd_prog_size, offest = fota_ctx->fw_header_offset;
-            fota_header_info_t header;
-            ret = fota_bd_get_read_size(&bd_read_size);
-            if (ret) {
-                goto fail;
-            }
-            ret = fota_bd_get_program_size(&bd_prog_size);
-            if (ret) {
-                goto fail;
-            }
-            ret = fota_candidate_read_header(&offest, bd_read_size, bd_prog_size, &header);
-            if (ret) {
-                goto fail;
-            }
-
-            ret = comp_install_verify(comp_desc, comp_id, &header);
-fail:
-            fota_nvm_fw_encryption_key_delete();
-            handle_fota_app_on_complete(ret); //notify application on after install, no reset
-        }
-    }
-
-#endif // FOTA_COMPONENT_SUPPORT
-
-    // remove manifest after candidate installation finished and before potential reboot.
-    // MAIN component for mbed-os will be installed by the bootloader
-    manifest_delete();
-	
-    if ((comp_desc->desc_info.need_reboot) && (fota_install_state == FOTA_INSTALL_STATE_AUTHORIZE)) {
-        fota_ctx->state = FOTA_STATE_IDLE;
-        fota_source_report_state(FOTA_SOURCE_STATE_REBOOTING, on_reboot, on_reboot);
+        fota_event_handler_run_sliced(fota_candidate_iterate_step, on_component_installed);
         return;
     }
 
-    if (fota_install_state == FOTA_INSTALL_STATE_AUTHORIZE) {
-
-#if (MBED_CLOUD_CLIENT_FOTA_MULTICAST_SUPPORT == FOTA_MULTICAST_NODE_MODE)
-        if (fota_ctx->mc_node_update) {
-            FOTA_DBG_ASSERT(fota_ctx->mc_node_post_action_callback);
-            fota_ctx->mc_node_post_action_callback(ret);
-        }
-#endif
-        fota_platform_finish_update_hook(comp_desc->name);
-        fota_source_report_update_result(FOTA_STATUS_FW_UPDATE_OK);
-        fota_source_report_state(FOTA_SOURCE_STATE_IDLE, NULL, NULL);
-
-#if (MBED_CLOUD_CLIENT_FOTA_MULTICAST_SUPPORT == FOTA_MULTICAST_BR_MODE)
-        if (fota_ctx->mc_br_update) {
-            // don't erase candidate image in case of node update by border router
-            erase_candidate_image = false;
-        }
-#endif
-
-        if (erase_candidate_image == true)
-        {
-            fota_candidate_erase();
-        }
-    }
+#endif // FOTA_COMPONENT_SUPPORT
 
-    update_cleanup();
+    finish_install_component(comp_desc, ret, comp_desc->desc_info.need_reboot);
 }
 
 static int prepare_and_program_header(void)
@@ -1349,6 +1559,124 @@ static int check_if_blank(size_t addr, size_t size, uint8_t erase_val, size_t *b
     return ret;
 }
 
+#if defined(FOTA_RESUME_HASH_CHECKPOINT)
+
+#define FOTA_HASH_CHECKPOINT_MAGIC 0x4643484b
+
+// Payload hash state after payload_offset bytes, whose next block is programmed at storage_addr
+typedef struct {
+    uint32_t magic;
+    uint32_t payload_offset;
+    uint32_t storage_addr;
+    uint8_t payload_digest[FOTA_CRYPTO_HASH_SIZE];
+    uint8_t hash_state[FOTA_HASH_STATE_SIZE];
+} fota_hash_checkpoint_t;
+
+// Update payload hash with a fragment, taking a snapshot at the block boundary a checkpoint is due at
+static int update_payload_hash(const uint8_t *buf, size_t size)
+{
+    int ret;
+
+    if (fota_ctx->checkpoint_hash_ctx) {
+        size_t hashed_size = fota_ctx->fw_bytes_written + fota_ctx->page_buf_offset;
+        size_t end_offset = hashed_size + size;
+        if ((end_offset >= fota_ctx->next_checkpoint_offset) &&
+                (fota_ctx->next_checkpoint_offset < fota_ctx->fw_info->payload_size)) {
+            size_t chunk = fota_ctx->next_checkpoint_offset - hashed_size;
+            ret = fota_hash_update(fota_ctx->payload_hash_ctx, buf, chunk);
+            if (ret) {
+                return ret;
+            }
+            fota_hash_clone(fota_ctx->checkpoint_hash_ctx, fota_ctx->payload_hash_ctx);
+            fota_ctx->checkpoint_offset = fota_ctx->next_checkpoint_offset;
+            // At most one checkpoint per fragment, so next one can't fall behind the hashed data
+            fota_ctx->next_checkpoint_offset = FOTA_ALIGN_UP(MAX(fota_ctx->checkpoint_offset + MBED_CLOUD_CLIENT_FOTA_RESUME_CHECKPOINT_INTERVAL, end_offset),
+                                                             fota_ctx->effective_page_buf_size);
+            fota_ctx->checkpoint_pending = true;
+            buf += chunk;
+            size -= chunk;
+        }
+    }
+
+    return fota_hash_update(fota_ctx->payload_hash_ctx, buf, size);
+}
+
+// Save the pending checkpoint, once the block ending at its offset has been programmed
+static void save_hash_checkpoint(void)
+{
+    fota_hash_checkpoint_t checkpoint;
+    int ret;
+
+    if (!fota_ctx->checkpoint_pending || (fota_ctx->fw_bytes_written < fota_ctx->checkpoint_offset)) {
+        return;
+    }
+    fota_ctx->checkpoint_pending = false;
+
+    // Storage address advances a whole page for each effective page of data
+    checkpoint.magic = FOTA_HASH_CHECKPOINT_MAGIC;
+    checkpoint.payload_offset = fota_ctx->checkpoint_offset;
+    checkpoint.storage_addr = fota_ctx->storage_addr - fota_ctx->page_buf_size *
+                              ((fota_ctx->fw_bytes_written - fota_ctx->checkpoint_offset) / fota_ctx->effective_page_buf_size);
+    memcpy(checkpoint.payload_digest, fota_ctx->fw_info->payload_digest, FOTA_CRYPTO_HASH_SIZE);
+    ret = fota_hash_state_get(fota_ctx->checkpoint_hash_ctx, checkpoint.hash_state);
+    if (!ret) {
+        ret = fota_nvm_hash_checkpoint_set((const uint8_t *) &checkpoint, sizeof(checkpoint));
+    }
+    if (ret) {
+        // Not fatal, resume just verifies more data
+        FOTA_TRACE_DEBUG("Failed saving hash checkpoint %d", ret);
+    }
+}
+
+// Restore payload hash and download position from a saved checkpoint matching current update
+static bool restore_hash_checkpoint(size_t data_start_addr)
+{
+    fota_hash_checkpoint_t checkpoint;
+    size_t bytes_read;
+    size_t blocks_done;
+
+    if (!fota_ctx->checkpoint_hash_ctx) {
+        return false;
+    }
+
+    if (fota_nvm_hash_checkpoint_get((uint8_t *) &checkpoint, sizeof(checkpoint), &bytes_read) ||
+            (bytes_read != sizeof(checkpoint)) ||
+            (checkpoint.magic != FOTA_HASH_CHECKPOINT_MAGIC) ||
+            memcmp(checkpoint.payload_digest, fota_ctx->fw_info->payload_digest, FOTA_CRYPTO_HASH_SIZE)) {
+        return false;
+    }
+
+    // Bad blocks are skipped on storage, so checkpoint block may be further than its offset implies
+    blocks_done = checkpoint.payload_offset / fota_ctx->effective_page_buf_size;
+    if ((checkpoint.payload_offset % fota_ctx->effective_page_buf_size) ||
+            (checkpoint.payload_offset >= fota_ctx->fw_info->payload_size) ||
+            (checkpoint.storage_addr < data_start_addr + blocks_done * fota_ctx->page_buf_size) ||
+            ((checkpoint.storage_addr - data_start_addr) % fota_ctx->page_buf_size) ||
+            (checkpoint.storage_addr - data_start_addr > storage_available)) {
+        FOTA_TRACE_DEBUG("Hash checkpoint invalid");
+        return false;
+    }
+
+    if (fota_hash_state_set(fota_ctx->payload_hash_ctx, checkpoint.hash_state)) {
+        return false;
+    }
+
+#if (MBED_CLOUD_CLIENT_FOTA_ENCRYPTION_SUPPORT == 1)
+    // IV is incremented once for every block decrypted so far
+    for (size_t i = 0; i < blocks_done; i++) {
+        fota_encryption_iv_increment(fota_ctx->enc_ctx);
+    }
+#endif
+
+    fota_ctx->payload_offset = checkpoint.payload_offset;
+    fota_ctx->fw_bytes_written = checkpoint.payload_offset;
+    fota_ctx->storage_addr = checkpoint.storage_addr;
+    FOTA_TRACE_DEBUG("Resuming hash from checkpoint at offset %" PRIu32, checkpoint.payload_offset);
+    return true;
+}
+
+#endif // defined(FOTA_RESUME_HASH_CHECKPOINT)
+
 static int analyze_resume_state(fota_state_e *next_fota_state)
 {
     int ret = FOTA_STATUS_SUCCESS;
@@ -1375,6 +1703,12 @@ static int analyze_resume_state(fota_state_e *next_fota_state)
         goto no_resume;
     }
 
+    // Decompressor state can't be restored at a block boundary of the stored image
+    if (fota_ctx->fw_info->payload_format == FOTA_MANIFEST_PAYLOAD_FORMAT_COMPRESSED_RAW) {
+        FOTA_TRACE_DEBUG("Compressed update resume is not supported");
+        goto no_resume;
+    }
+
     fota_ctx->page_buf = malloc(fota_ctx->page_buf_size);
     if (!fota_ctx->page_buf) {
         FOTA_TRACE_ERROR("Not enough memory for page_buf");
@@ -1447,6 +1781,14 @@ static int analyze_resume_state(fota_state_e *next_fota_state)
     num_blocks_left = FOTA_ALIGN_UP(fota_ctx->fw_info->payload_size, fota_ctx->effective_page_buf_size) /
                       fota_ctx->effective_page_buf_size;
 
+#if defined(FOTA_RESUME_HASH_CHECKPOINT)
+    // Data up to the checkpoint was already verified, only check the blocks after it
+    if (restore_hash_checkpoint(save_storage_addr)) {
+        num_blocks_available -= (fota_ctx->storage_addr - save_storage_addr) / fota_ctx->page_buf_size;
+        num_blocks_left -= fota_ctx->payload_offset / fota_ctx->effective_page_buf_size;
+    }
+#endif
+
     while (num_blocks_left) {
 
         if (num_blocks_left > num_blocks_available) {
@@ -1494,10 +1836,7 @@ static int analyze_resume_state(fota_state_e *next_fota_state)
         }
 
 #else
-        checksum = 0;
-        for (uint32_t i = 0; i < chunk; i++) {
-            checksum += fota_ctx->effective_page_buf[i];
-        }
+        checksum = fota_candidate_calc_block_checksum(fota_ctx->effective_page_buf, chunk);
         if (checksum != *(fota_candidate_block_checksum_t *) fota_ctx->page_buf) {
             // Bad checksum - Skip the block
             FOTA_TRACE_DEBUG("Bad checksum - block skipped");
@@ -1530,9 +1869,9 @@ next_block:
         fota_ctx->storage_addr += fota_ctx->page_buf_size;
     }
 
-#if !defined(FOTA_DISABLE_DELTA)
+#if defined(FOTA_UNPACKED_PAYLOAD_SUPPORT)
     // for a delta patch, copy payload_hash_ctx to installed_hash_ctx
-    if (fota_ctx->fw_info->payload_format == FOTA_MANIFEST_PAYLOAD_FORMAT_DELTA) {
+    if (is_payload_unpacked()) {
         fota_hash_clone(fota_ctx->installed_hash_ctx, fota_ctx->payload_hash_ctx);
     }
 #endif
@@ -1553,8 +1892,8 @@ no_resume:
     // reset payload_hash_ctx
     fota_hash_finish(&fota_ctx->payload_hash_ctx);
     fota_hash_start(&fota_ctx->payload_hash_ctx);
-#if !defined(FOTA_DISABLE_DELTA)
-    if (fota_ctx->fw_info->payload_format == FOTA_MANIFEST_PAYLOAD_FORMAT_DELTA) {
+#if defined(FOTA_UNPACKED_PAYLOAD_SUPPORT)
+    if (is_payload_unpacked()) {
         // reset installed_hash_ctx
         fota_hash_finish(&fota_ctx->installed_hash_ctx);
         fota_hash_start(&fota_ctx->installed_hash_ctx);
@@ -1576,10 +1915,51 @@ finish:
 
 #endif // MBED_CLOUD_CLIENT_FOTA_RESUME_SUPPORT == FOTA_RESUME_SUPPORT_RESUME
 
-static int calc_and_erase_needed_storage()
+#if (MBED_CLOUD_CLIENT_FOTA_ERASE_AHEAD_SIZE > 0)
+
+// Erase whole sectors from the end of the erased region, until end_addr is covered
+static int erase_storage_up_to(size_t end_addr)
 {
     int ret;
-    size_t storage_needed = 0, erase_size, total_erase_size, end_addr;
+    size_t erase_size;
+
+    end_addr = MIN(end_addr, fota_candidate_get_config()->storage_start_addr + storage_available);
+
+    while (fota_ctx->erased_addr < end_addr) {
+        ret = fota_bd_get_erase_size(fota_ctx->erased_addr, &erase_size);
+        if (ret) {
+            FOTA_TRACE_ERROR("Get erase size failed %d", ret);
+            return ret;
+        }
+
+        ret = fota_bd_erase(fota_ctx->erased_addr, erase_size);
+        if (ret) {
+            FOTA_TRACE_ERROR("Erase storage failed %d", ret);
+            return ret;
+        }
+        fota_ctx->erased_addr += erase_size;
+    }
+
+    return FOTA_STATUS_SUCCESS;
+}
+
+// Called after each fragment request, erases one sector while the fragment is in flight
+static int erase_ahead_step(void)
+{
+    if (!fota_ctx->erase_ahead ||
+            (fota_ctx->erased_addr >= fota_ctx->storage_addr + MBED_CLOUD_CLIENT_FOTA_ERASE_AHEAD_SIZE)) {
+        return FOTA_STATUS_SUCCESS;
+    }
+
+    return erase_storage_up_to(fota_ctx->erased_addr + 1);
+}
+
+#endif // (MBED_CLOUD_CLIENT_FOTA_ERASE_AHEAD_SIZE > 0)
+
+static int calc_and_erase_needed_storage()
+{
+    int ret;
+    size_t storage_needed = 0, erase_size, total_erase_size, end_addr;
 
     if (fota_ctx) {
         // Calculate needed space for FW data in storage:
@@ -1607,9 +1987,9 @@ static int calc_and_erase_needed_storage()
         // Multicast FOTA case, need to tweak our needs
         mc_node_new_image = false;
         mc_node_image_size = fota_ctx->fw_info->payload_size;
-        if (fota_ctx->fw_info->payload_format == FOTA_MANIFEST_PAYLOAD_FORMAT_DELTA) {
-            // Delta case - need to add space for delta image right after candidate image.
-            // Multicast reading should be on the delta image.
+        if (is_payload_unpacked()) {
+            // Delta or compressed case - need to add space for payload image right after candidate image.
+            // Multicast reading should be on the payload image.
             mc_image_data_addr = fota_candidate_get_config()->storage_start_addr + storage_needed;
             storage_needed += mc_node_image_size;
         } else {
@@ -1625,6 +2005,15 @@ static int calc_and_erase_needed_storage()
         return FOTA_STATUS_INSUFFICIENT_STORAGE;
     }
 
+#if (MBED_CLOUD_CLIENT_FOTA_ERASE_AHEAD_SIZE > 0)
+    if (fota_ctx && fota_ctx->erase_ahead) {
+        // Only headers and first window are erased now, the rest during download
+        fota_ctx->erased_addr = fota_candidate_get_config()->storage_start_addr;
+        FOTA_TRACE_DEBUG("Erasing storage at %zu ahead of download", fota_ctx->erased_addr);
+        return erase_storage_up_to(fota_ctx->storage_addr + MBED_CLOUD_CLIENT_FOTA_ERASE_AHEAD_SIZE);
+    }
+#endif
+
     end_addr = fota_candidate_get_config()->storage_start_addr + storage_needed;
     ret = fota_bd_get_erase_size(end_addr - 1, &erase_size);
     if (ret) {
@@ -1721,8 +2110,8 @@ static void fota_on_download_authorize()
         goto fail;
     }
 
-#if !defined(FOTA_DISABLE_DELTA)
-    if (fota_ctx->fw_info->payload_format == FOTA_MANIFEST_PAYLOAD_FORMAT_DELTA) {
+#if defined(FOTA_UNPACKED_PAYLOAD_SUPPORT)
+    if (is_payload_unpacked()) {
         ret = fota_hash_start(&fota_ctx->installed_hash_ctx);
         if (ret) {
             goto fail;
@@ -1730,6 +2119,16 @@ static void fota_on_download_authorize()
     }
 #endif
 
+#if defined(FOTA_RESUME_HASH_CHECKPOINT)
+    // Only raw payload hash is a function of the stored data alone
+    if (fota_ctx->fw_info->payload_format == FOTA_MANIFEST_PAYLOAD_FORMAT_RAW) {
+        ret = fota_hash_start(&fota_ctx->checkpoint_hash_ctx);
+        if (ret) {
+            goto fail;
+        }
+    }
+#endif
+
     fota_ctx->fw_header_offset = fota_ctx->storage_addr - fota_ctx->fw_header_bd_size;
 
     ret = calc_available_storage();
@@ -1747,6 +2146,28 @@ static void fota_on_download_authorize()
     fota_ctx->resume_state = FOTA_RESUME_STATE_INACTIVE;
 #endif
 
+#if (MBED_CLOUD_CLIENT_FOTA_ERASE_AHEAD_SIZE > 0)
+    fota_ctx->erase_ahead = true;
+#if (MBED_CLOUD_CLIENT_FOTA_MULTICAST_SUPPORT == FOTA_MULTICAST_NODE_MODE)
+    // Image is already placed in storage by Multicast module
+    fota_ctx->erase_ahead = !fota_ctx->mc_node_update;
+#endif
+    if (fota_ctx->erase_ahead && (fota_ctx->resume_state != FOTA_RESUME_STATE_INACTIVE)) {
+        // Sector holding the resume point was fully erased before anything was programmed to it.
+        // If the point is at sector start, its erase may have been interrupted, so erase it again.
+        size_t erase_size;
+        ret = fota_bd_get_erase_size(fota_ctx->storage_addr, &erase_size);
+        if (ret) {
+            FOTA_TRACE_ERROR("Get erase size failed %d", ret);
+            goto fail;
+        }
+        fota_ctx->erased_addr = FOTA_ALIGN_DOWN(fota_ctx->storage_addr, erase_size);
+        if (fota_ctx->erased_addr != fota_ctx->storage_addr) {
+            fota_ctx->erased_addr += erase_size;
+        }
+    }
+#endif
+
     // Erase storage (if we're resuming, this has already been done)
     if (fota_ctx->resume_state == FOTA_RESUME_STATE_INACTIVE) {
 
@@ -1755,6 +2176,11 @@ static void fota_on_download_authorize()
             goto fail;
         }
 
+#if defined(FOTA_RESUME_HASH_CHECKPOINT)
+        // Checkpoint of an earlier download of this update is no longer valid
+        fota_nvm_hash_checkpoint_delete();
+#endif
+
         // In non legacy headers we can and should program the FW header already here, to support full resume (as resume needs info from header).
         // This is OK, as the candidate ready header will be programmed at install phase.
         if (fota_ctx->candidate_header_size) {
@@ -1768,6 +2194,11 @@ static void fota_on_download_authorize()
     // At this point, we have converged to regular state, even if we were resuming
     fota_ctx->resume_state = FOTA_RESUME_STATE_INACTIVE;
 
+#if defined(FOTA_RESUME_HASH_CHECKPOINT)
+    fota_ctx->next_checkpoint_offset = FOTA_ALIGN_UP(fota_ctx->fw_bytes_written + MBED_CLOUD_CLIENT_FOTA_RESUME_CHECKPOINT_INTERVAL,
+                                                     fota_ctx->effective_page_buf_size);
+#endif
+
     fota_ctx->page_buf = malloc(fota_ctx->page_buf_size);
     if (!fota_ctx->page_buf) {
         ret = FOTA_STATUS_OUT_OF_MEMORY;
@@ -1794,6 +2225,23 @@ static void fota_on_download_authorize()
     }
 #endif  // defined(FOTA_DISABLE_DELTA)
 
+#if (MBED_CLOUD_CLIENT_FOTA_COMPRESSED_PAYLOAD_SUPPORT == 1)
+    if (fota_ctx->fw_info->payload_format == FOTA_MANIFEST_PAYLOAD_FORMAT_COMPRESSED_RAW) {
+        fota_ctx->decompress_buf = malloc(MBED_CLOUD_CLIENT_FOTA_COMPRESSED_BLOCK_SIZE);
+        if (!fota_ctx->decompress_buf) {
+            FOTA_TRACE_ERROR("FOTA decompress buffer - allocation failed");
+            ret = FOTA_STATUS_OUT_OF_MEMORY;
+            goto fail;
+        }
+
+        ret = fota_decompress_start(&fota_ctx->decompress_ctx);
+        if (ret) {
+            goto fail;
+        }
+        FOTA_TRACE_DEBUG("FOTA decompress engine initialized");
+    }
+#endif
+
 #if (MBED_CLOUD_CLIENT_FOTA_MULTICAST_SUPPORT == FOTA_MULTICAST_NODE_MODE)
     if (fota_ctx->mc_node_update) {
 #if MBED_CLOUD_CLIENT_FOTA_EXTERNAL_DOWNLOADER
@@ -1811,6 +2259,7 @@ static void fota_on_download_authorize()
 
     fota_ctx->state = FOTA_STATE_DOWNLOADING;
     fota_source_report_state(FOTA_SOURCE_STATE_DOWNLOADING, NULL, NULL);
+    fota_stats_reset();
 
     ret = fota_download_init(&fota_ctx->download_handle);
     if (ret) {
@@ -1907,7 +2356,7 @@ static int program_to_storage(uint8_t *buf, size_t addr, uint32_t size)
     // In case of a full multicast node update, image was already placed there by Multicast module.
     // Just skip programming (but keep all other calculations).
     if (fota_ctx && fota_ctx->mc_node_update &&
-            (fota_ctx->fw_info->payload_format != FOTA_MANIFEST_PAYLOAD_FORMAT_DELTA)) {
+            !is_payload_unpacked()) {
         do_program = false;
     }
 #endif
@@ -1929,7 +2378,9 @@ static int program_to_storage(uint8_t *buf, size_t addr, uint32_t size)
         if (fota_ctx->fw_info->payload_format != FOTA_MANIFEST_PAYLOAD_FORMAT_ENCRYPTED_RAW) {
             // on encrypted payload, data already encrypted
             uint8_t *tag = fota_ctx->page_buf;
+            FOTA_STATS_START(encrypt_start);
             ret = fota_encrypt_data(fota_ctx->enc_ctx, src_buf, data_size, src_buf, tag);
+            FOTA_STATS_ADD(FOTA_STATS_ENCRYPT, encrypt_start, data_size);
             if (ret) {
                 FOTA_TRACE_ERROR("encryption failed %d", ret);
                 return ret;
@@ -1937,10 +2388,7 @@ static int program_to_storage(uint8_t *buf, size_t addr, uint32_t size)
         }
 #elif MBED_CLOUD_CLIENT_FOTA_RESUME_SUPPORT == FOTA_RESUME_SUPPORT_RESUME
         fota_candidate_block_checksum_t *checksum = (fota_candidate_block_checksum_t *) fota_ctx->page_buf;
-        *checksum = 0;
-        for (uint32_t i = 0; i < data_size; i++) {
-            *checksum += fota_ctx->effective_page_buf[i];
-        }
+        *checksum = fota_candidate_calc_block_checksum(fota_ctx->effective_page_buf, data_size);
 #endif
 
         if (prog_size < fota_ctx->page_buf_size) {
@@ -1949,7 +2397,18 @@ static int program_to_storage(uint8_t *buf, size_t addr, uint32_t size)
             prog_size = FOTA_ALIGN_UP(prog_size, fota_ctx->page_buf_size);
         }
         if (do_program) {
+#if (MBED_CLOUD_CLIENT_FOTA_ERASE_AHEAD_SIZE > 0)
+            if (fota_ctx->erase_ahead) {
+                // Keep the following block erased as well, as resume looks for the first blank one
+                ret = erase_storage_up_to(addr + prog_size + fota_ctx->page_buf_size);
+                if (ret) {
+                    return ret;
+                }
+            }
+#endif
+            FOTA_STATS_START(program_start);
             ret = fota_bd_program(prog_buf, addr, prog_size);
+            FOTA_STATS_ADD(FOTA_STATS_PROGRAM, program_start, prog_size);
             if (ret) {
                 FOTA_TRACE_ERROR("Write to storage failed, address 0x%zx, size %" PRIu32 " %d",
                                  addr, size, ret);
@@ -2023,9 +2482,9 @@ static int finalize_update(void)
     fota_hash_context_t *calced_hash_ctx = fota_ctx->payload_hash_ctx;
     uint8_t *expected_digest = fota_ctx->fw_info->payload_digest;
 
-#if !defined(FOTA_DISABLE_DELTA)
-    // on delta, digest is calced on the install/unpatch data
-    if (fota_ctx->fw_info->payload_format == FOTA_MANIFEST_PAYLOAD_FORMAT_DELTA) {
+#if defined(FOTA_UNPACKED_PAYLOAD_SUPPORT)
+    // on delta or compressed payload, digest is calced on the install/unpacked data
+    if (is_payload_unpacked()) {
         calced_hash_ctx = fota_ctx->installed_hash_ctx;
         expected_digest = fota_ctx->fw_info->installed_digest;
     }
@@ -2077,8 +2536,17 @@ finished:
         fota_ctx->delta_ctx = 0;
     }
 #endif
+#if (MBED_CLOUD_CLIENT_FOTA_COMPRESSED_PAYLOAD_SUPPORT == 1)
+    if (fota_ctx->fw_info->payload_format == FOTA_MANIFEST_PAYLOAD_FORMAT_COMPRESSED_RAW) {
+        ret = fota_decompress_finalize(&fota_ctx->decompress_ctx);
+        if (ret) {
+            return ret;
+        }
+    }
+#endif
 
     FOTA_TRACE_INFO("Firmware download finished");
+    fota_stats_report();
 
 #if (MBED_CLOUD_CLIENT_FOTA_MULTICAST_SUPPORT == FOTA_MULTICAST_BR_MODE)
     if (fota_ctx->mc_br_update) {
@@ -2133,6 +2601,7 @@ void fota_on_fragment(uint8_t *buf, size_t size)
 {
     int ret = 0;
     bool last_fragment;
+    bool next_requested = false;
 
     // Silently ignore unexpected fragments (can be received prematurely as a result of retransmissions)
     // TODO: Check expected offset (requires API change here and in downloading engines)
@@ -2142,6 +2611,10 @@ void fota_on_fragment(uint8_t *buf, size_t size)
     }
 
     uint32_t payload_bytes_left = fota_ctx->fw_info->payload_size - fota_ctx->payload_offset;
+#if (MBED_CLOUD_CLIENT_FOTA_STATS == 1)
+    uint64_t fragment_start = fota_stats_start();
+    size_t fragment_size = size;
+#endif
 
     //TODO: consider replacing with FOTA_DBG_ASSERT - as this should never happen
     if (size > payload_bytes_left) {
@@ -2149,10 +2622,37 @@ void fota_on_fragment(uint8_t *buf, size_t size)
         return;
     }
 
+    PERF_COUNTER_ADD(FOTA_FRAGMENTS, 1);
+    PERF_COUNTER_ADD(FOTA_BYTES, size);
+
     handle_fota_app_on_download_progress(fota_ctx->payload_offset, size, fota_ctx->fw_info->payload_size);
 
+    fota_ctx->payload_offset += size;
+
+    // Request next fragment before handling this one, so that its download overlaps with
+    // encrypting and programming this one. Fragment buffer stays valid until we return.
+    next_requested = (size < payload_bytes_left);
+#if (MBED_CLOUD_CLIENT_FOTA_MULTICAST_SUPPORT == FOTA_MULTICAST_NODE_MODE)
+    // Multicast node reads the fragments from storage in a deferred event, nothing to overlap
+    if (fota_ctx->mc_node_update) {
+        next_requested = false;
+    }
+#endif
+    if (next_requested) {
+        ret = get_next_fragment();
+        if (ret) {
+            goto fail;
+        }
+    }
+
     // update payload_hash_ctx with fragment
+    FOTA_STATS_START(hash_start);
+#if defined(FOTA_RESUME_HASH_CHECKPOINT)
+    ret = update_payload_hash(buf, size);
+#else
     ret = fota_hash_update(fota_ctx->payload_hash_ctx, buf, size);
+#endif
+    FOTA_STATS_ADD(FOTA_STATS_HASH, hash_start, size);
 
     if (fota_ctx->fw_info->payload_format == FOTA_MANIFEST_PAYLOAD_FORMAT_DELTA) {
 #if !defined(FOTA_DISABLE_DELTA)
@@ -2163,7 +2663,9 @@ void fota_on_fragment(uint8_t *buf, size_t size)
         do {
             uint32_t actual_frag_size;
             if (payload_bytes_left) {
+                FOTA_STATS_START(unpack_start);
                 ret = fota_delta_new_payload_frag(fota_ctx->delta_ctx, buf, size);
+                FOTA_STATS_ADD(FOTA_STATS_UNPACK, unpack_start, 0);
                 if (ret == FOTA_STATUS_FW_DELTA_REQUIRED_MORE_DATA) {
                     payload_bytes_left -= size;
                     break;
@@ -2177,17 +2679,21 @@ void fota_on_fragment(uint8_t *buf, size_t size)
                 goto fail;
             }
             do {
+                FOTA_STATS_START(unpack_start);
                 ret = fota_delta_get_next_fw_frag(fota_ctx->delta_ctx,
                                                   fota_ctx->delta_buf,
                                                   MBED_CLOUD_CLIENT_FOTA_DELTA_BLOCK_SIZE,
                                                   &actual_frag_size);
+                FOTA_STATS_ADD(FOTA_STATS_UNPACK, unpack_start, actual_frag_size);
                 if (ret) {
                     goto fail;
                 }
                 if (actual_frag_size) {
                     last_fragment = ((fota_ctx->fw_bytes_written + fota_ctx->page_buf_offset + actual_frag_size) == fota_ctx->fw_info->installed_size);
                     // update installed_hash_ctx with delta_buf
+                    FOTA_STATS_START(hash_start);
                     ret = fota_hash_update(fota_ctx->installed_hash_ctx, fota_ctx->delta_buf, actual_frag_size);
+                    FOTA_STATS_ADD(FOTA_STATS_HASH, hash_start, actual_frag_size);
                     if (ret) {
                         goto fail;
                     }
@@ -2203,6 +2709,52 @@ void fota_on_fragment(uint8_t *buf, size_t size)
         // we should not get here. The error is reported from fota_on_manifest
         FOTA_ASSERT(0);
 #endif  // #if !defined(FOTA_DISABLE_DELTA)
+    } else if (fota_ctx->fw_info->payload_format == FOTA_MANIFEST_PAYLOAD_FORMAT_COMPRESSED_RAW) {
+#if (MBED_CLOUD_CLIENT_FOTA_COMPRESSED_PAYLOAD_SUPPORT == 1)
+        uint32_t actual_frag_size;
+        if (ret) {
+            goto fail;
+        }
+        FOTA_STATS_START(unpack_start);
+        ret = fota_decompress_new_payload_frag(fota_ctx->decompress_ctx, buf, size);
+        FOTA_STATS_ADD(FOTA_STATS_UNPACK, unpack_start, 0);
+        if (ret) {
+            goto fail;
+        }
+        do {
+            FOTA_STATS_START(unpack_next_start);
+            ret = fota_decompress_get_next_fw_frag(fota_ctx->decompress_ctx,
+                                                   fota_ctx->decompress_buf,
+                                                   MBED_CLOUD_CLIENT_FOTA_COMPRESSED_BLOCK_SIZE,
+                                                   &actual_frag_size);
+            FOTA_STATS_ADD(FOTA_STATS_UNPACK, unpack_next_start, actual_frag_size);
+            if (ret) {
+                goto fail;
+            }
+            if (actual_frag_size) {
+                size_t unpacked_size = fota_ctx->fw_bytes_written + fota_ctx->page_buf_offset + actual_frag_size;
+                if (unpacked_size > fota_ctx->fw_info->installed_size) {
+                    ret = FOTA_STATUS_FW_SIZE_MISMATCH;
+                    goto fail;
+                }
+                last_fragment = (unpacked_size == fota_ctx->fw_info->installed_size);
+                FOTA_STATS_START(hash_start);
+                ret = fota_hash_update(fota_ctx->installed_hash_ctx, fota_ctx->decompress_buf, actual_frag_size);
+                FOTA_STATS_ADD(FOTA_STATS_HASH, hash_start, actual_frag_size);
+                if (ret) {
+                    goto fail;
+                }
+                ret = handle_fw_fragment(fota_ctx->decompress_buf, actual_frag_size, last_fragment);
+                if (ret) {
+                    goto fail;
+                }
+            }
+        } while (actual_frag_size);
+        payload_bytes_left -= size;
+#else
+        // we should not get here. The error is reported from fota_on_manifest
+        FOTA_ASSERT(0);
+#endif  // (MBED_CLOUD_CLIENT_FOTA_COMPRESSED_PAYLOAD_SUPPORT == 1)
     } else {
         if (ret) {
             goto fail;
@@ -2212,12 +2764,16 @@ void fota_on_fragment(uint8_t *buf, size_t size)
         if (ret) {
             goto fail;
         }
+#if defined(FOTA_RESUME_HASH_CHECKPOINT)
+        if (!last_fragment) {
+            save_hash_checkpoint();
+        }
+#endif
         payload_bytes_left -= size;
     }
 
-    fota_ctx->payload_offset += size;
-
     clear_buffer_from_mem(buf, size);
+    FOTA_STATS_ADD(FOTA_STATS_FRAGMENT, fragment_start, fragment_size);
 
     if (!payload_bytes_left) {
         ret = finalize_update();
@@ -2227,10 +2783,19 @@ void fota_on_fragment(uint8_t *buf, size_t size)
         return;
     }
 
-    ret = get_next_fragment();
+    if (!next_requested) {
+        ret = get_next_fragment();
+        if (ret) {
+            goto fail;
+        }
+    }
+
+#if (MBED_CLOUD_CLIENT_FOTA_ERASE_AHEAD_SIZE > 0)
+    ret = erase_ahead_step();
     if (ret) {
         goto fail;
     }
+#endif
 
     return;
 
@@ -2470,6 +3035,13 @@ int fota_multicast_node_on_image_ready(void)
     if (ret) {
         return ret;
     }
+#if (MBED_CLOUD_CLIENT_FOTA_MULTICAST_NODE_WRITE_CACHE_SIZE > 0)
+    ret = write_cache_flush();
+    write_cache_free();
+    if (ret) {
+        return ret;
+    }
+#endif
     if (fota_ctx && fota_ctx->mc_node_update) {
         fota_ctx->state = FOTA_STATE_DOWNLOADING;
         // From service POV, image is already downloaded,so report application approval
@@ -2515,6 +3087,9 @@ int fota_multicast_node_on_abort(void)
             abort_update(FOTA_STATUS_MULTICAST_UPDATE_ABORTED, "Multicast abort requested");
         }
     }
+#if (MBED_CLOUD_CLIENT_FOTA_MULTICAST_NODE_WRITE_CACHE_SIZE > 0)
+    write_cache_free();
+#endif
     return FOTA_STATUS_SUCCESS;
 }
 
@@ -2538,6 +3113,15 @@ int fota_multicast_node_get_ready_for_image(size_t image_size)
         }
     }
 
+#if (MBED_CLOUD_CLIENT_FOTA_MULTICAST_NODE_WRITE_CACHE_SIZE > 0)
+    // Fragments already acknowledged may still be staged
+    ret = write_cache_flush();
+    write_cache_free();
+    if (ret) {
+        return ret;
+    }
+#endif
+
     // Just mark image as new, but don't erase yet, as we don't know location and size yet
     mc_node_new_image = true;
     mc_node_image_size = image_size;
@@ -2545,30 +3129,9 @@ int fota_multicast_node_get_ready_for_image(size_t image_size)
     return FOTA_STATUS_SUCCESS;
 }
 
-int fota_multicast_node_write_image_fragment(const void *buffer, size_t offset, size_t size)
+static int program_image_fragment(const void *buffer, size_t offset, size_t size)
 {
-    int ret = fota_multicast_node_check_update_status(false);
-    if (ret) {
-        return ret;
-    }
-    if (!mc_node_frag_size) {
-        FOTA_TRACE_ERROR("FOTA multicast command ignored - fragment size not set");
-        return FOTA_STATUS_INTERNAL_ERROR;
-    }
-    if (offset % mc_node_frag_size) {
-        FOTA_TRACE_ERROR("FOTA multicast node - attempted to write to storage with an invalid offset");
-        return FOTA_STATUS_STORAGE_WRITE_FAILED;
-    }
-
-    if (mc_node_new_image) {
-        // Got here with new image flag still set. This means that no manifest was received,
-        // so this is a non FOTA image. Erase storage now.
-        ret = calc_and_erase_needed_storage();
-        if (ret) {
-            return ret;
-        }
-    }
-
+    int ret;
     size_t prog_size, addr;
 
     ret = fota_bd_get_program_size(&prog_size);
@@ -2614,12 +3177,169 @@ end:
     return ret;
 }
 
+#if (MBED_CLOUD_CLIENT_FOTA_MULTICAST_NODE_WRITE_CACHE_SIZE > 0)
+static inline bool write_cache_is_filled(size_t frag)
+{
+    return mc_node_write_cache.filled[frag / 8] & (1 << (frag % 8));
+}
+
+// Drops the staged fragments and frees the cache
+static void write_cache_free(void)
+{
+    free(mc_node_write_cache.buf);
+    free(mc_node_write_cache.filled);
+    memset(&mc_node_write_cache, 0, sizeof(mc_node_write_cache));
+}
+
+// Programs the staged fragments, each run of neighbouring fragments in a single program
+static int write_cache_flush(void)
+{
+    int ret = FOTA_STATUS_SUCCESS;
+    size_t first = 0;
+
+    if (!mc_node_write_cache.in_use) {
+        return FOTA_STATUS_SUCCESS;
+    }
+
+    while (first < mc_node_write_cache.num_frags) {
+        if (!write_cache_is_filled(first)) {
+            first++;
+            continue;
+        }
+        size_t end = first;
+        while ((end < mc_node_write_cache.num_frags) && write_cache_is_filled(end)) {
+            end++;
+        }
+        size_t size = (end - first) * mc_node_frag_size;
+        if (end == mc_node_write_cache.short_frag + 1) {
+            size -= mc_node_frag_size - mc_node_write_cache.short_frag_size;
+        }
+        ret = program_image_fragment(mc_node_write_cache.buf + first * mc_node_frag_size,
+                                     mc_node_write_cache.base + first * mc_node_frag_size, size);
+        if (ret) {
+            break;
+        }
+        first = end;
+    }
+
+    memset(mc_node_write_cache.filled, 0, (mc_node_write_cache.num_frags + 7) / 8);
+    mc_node_write_cache.num_filled = 0;
+    mc_node_write_cache.in_use = false;
+    return ret;
+}
+
+// Stages the fragment in the cache, staged is false if there's no memory for it
+static int write_cache_stage(const void *buffer, size_t offset, size_t size, bool *staged)
+{
+    int ret;
+    size_t window_size, base, frag, window_frags;
+
+    *staged = false;
+
+    if (!mc_node_write_cache.buf) {
+        mc_node_write_cache.num_frags = MAX(MBED_CLOUD_CLIENT_FOTA_MULTICAST_NODE_WRITE_CACHE_SIZE / mc_node_frag_size, 1);
+        mc_node_write_cache.buf = (uint8_t *) malloc(mc_node_write_cache.num_frags * mc_node_frag_size);
+        mc_node_write_cache.filled = (uint8_t *) calloc((mc_node_write_cache.num_frags + 7) / 8, 1);
+        if (!mc_node_write_cache.buf || !mc_node_write_cache.filled) {
+            FOTA_TRACE_DEBUG("FOTA multicast node - no memory for write cache, programming fragments directly");
+            write_cache_free();
+            return FOTA_STATUS_SUCCESS;
+        }
+    }
+
+    window_size = mc_node_write_cache.num_frags * mc_node_frag_size;
+    base = offset - offset % window_size;
+
+    if (mc_node_write_cache.in_use && (base != mc_node_write_cache.base)) {
+        ret = write_cache_flush();
+        if (ret) {
+            return ret;
+        }
+    }
+
+    if (!mc_node_write_cache.in_use) {
+        mc_node_write_cache.base = base;
+        mc_node_write_cache.short_frag = mc_node_write_cache.num_frags;
+        memset(mc_node_write_cache.buf, 0, window_size);
+        mc_node_write_cache.in_use = true;
+    }
+
+    frag = (offset - base) / mc_node_frag_size;
+    memcpy(mc_node_write_cache.buf + offset - base, buffer, size);
+    if (size < mc_node_frag_size) {
+        mc_node_write_cache.short_frag = frag;
+        mc_node_write_cache.short_frag_size = size;
+    }
+    if (!write_cache_is_filled(frag)) {
+        mc_node_write_cache.filled[frag / 8] |= 1 << (frag % 8);
+        mc_node_write_cache.num_filled++;
+    }
+    *staged = true;
+
+    // Program the window once all its fragments are in (image end may cut the window short)
+    window_frags = mc_node_write_cache.num_frags;
+    if (mc_node_image_size > base) {
+        window_frags = MIN(window_frags, FOTA_ALIGN_UP(mc_node_image_size - base, mc_node_frag_size) / mc_node_frag_size);
+    }
+    if (mc_node_write_cache.num_filled == window_frags) {
+        return write_cache_flush();
+    }
+    return FOTA_STATUS_SUCCESS;
+}
+#endif // (MBED_CLOUD_CLIENT_FOTA_MULTICAST_NODE_WRITE_CACHE_SIZE > 0)
+
+int fota_multicast_node_write_image_fragment(const void *buffer, size_t offset, size_t size)
+{
+    int ret = fota_multicast_node_check_update_status(false);
+    if (ret) {
+        return ret;
+    }
+    if (!mc_node_frag_size) {
+        FOTA_TRACE_ERROR("FOTA multicast command ignored - fragment size not set");
+        return FOTA_STATUS_INTERNAL_ERROR;
+    }
+    if (offset % mc_node_frag_size) {
+        FOTA_TRACE_ERROR("FOTA multicast node - attempted to write to storage with an invalid offset");
+        return FOTA_STATUS_STORAGE_WRITE_FAILED;
+    }
+
+    if (mc_node_new_image) {
+        // Got here with new image flag still set. This means that no manifest was received,
+        // so this is a non FOTA image. Erase storage now.
+        ret = calc_and_erase_needed_storage();
+        if (ret) {
+            return ret;
+        }
+    }
+
+#if (MBED_CLOUD_CLIENT_FOTA_MULTICAST_NODE_WRITE_CACHE_SIZE > 0)
+    bool staged = false;
+    if (size <= mc_node_frag_size) {
+        ret = write_cache_stage(buffer, offset, size, &staged);
+    } else {
+        // Multiple fragments at once, keep the cache out of their way
+        ret = write_cache_flush();
+    }
+    if (ret || staged) {
+        return ret;
+    }
+#endif
+
+    return program_image_fragment(buffer, offset, size);
+}
+
 int fota_multicast_node_read_image_fragment(void *buffer, size_t offset, size_t size)
 {
     int ret = fota_multicast_node_check_update_status(false);
     if (ret) {
         return ret;
     }
+#if (MBED_CLOUD_CLIENT_FOTA_MULTICAST_NODE_WRITE_CACHE_SIZE > 0)
+    ret = write_cache_flush();
+    if (ret) {
+        return ret;
+    }
+#endif
     return fota_multicast_read_from_image(buffer, offset, size);
 }
 
@@ -2690,10 +3410,77 @@ static int multicast_br_candidate_iterate_handler(fota_candidate_iterate_callbac
 }
 #endif
 
+#if (MBED_CLOUD_CLIENT_FOTA_MULTICAST_BR_READ_CACHE_BLOCKS > 0)
+static void multicast_br_read_cache_free(void)
+{
+    for (size_t i = 0; i < MBED_CLOUD_CLIENT_FOTA_MULTICAST_BR_READ_CACHE_BLOCKS; i++) {
+        free(mc_br_read_cache[i].buf);
+    }
+    memset(mc_br_read_cache, 0, sizeof(mc_br_read_cache));
+    mc_br_next_read_offset = 0;
+    mc_br_image_size = 0;
+}
+
+// Returns the block holding the image offset, reading it if needed. NULL if the block can't be cached.
+static mc_br_cache_block_t *multicast_br_read_cache_get(size_t offset, bool sequential, int *ret)
+{
+    mc_br_cache_block_t *block = NULL;
+    size_t first_lru = (MBED_CLOUD_CLIENT_FOTA_MULTICAST_BR_READ_CACHE_BLOCKS > 1) ? 1 : 0;
+    size_t block_offset = FOTA_ALIGN_DOWN(offset, MBED_CLOUD_CLIENT_FOTA_MULTICAST_BR_READ_CACHE_BLOCK_SIZE);
+
+    *ret = FOTA_STATUS_SUCCESS;
+
+    if (block_offset >= mc_br_image_size) {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < MBED_CLOUD_CLIENT_FOTA_MULTICAST_BR_READ_CACHE_BLOCKS; i++) {
+        if (mc_br_read_cache[i].size && (mc_br_read_cache[i].offset == block_offset)) {
+            mc_br_read_cache[i].last_use = ++mc_br_read_cache_clock;
+            return &mc_br_read_cache[i];
+        }
+    }
+
+    // Distribution pass goes through the read ahead block, keeping the repair blocks
+    if (sequential) {
+        block = &mc_br_read_cache[0];
+    } else {
+        block = &mc_br_read_cache[first_lru];
+        for (size_t i = first_lru + 1; i < MBED_CLOUD_CLIENT_FOTA_MULTICAST_BR_READ_CACHE_BLOCKS; i++) {
+            if (mc_br_read_cache[i].last_use < block->last_use) {
+                block = &mc_br_read_cache[i];
+            }
+        }
+    }
+
+    if (!block->buf) {
+        block->buf = (uint8_t *) malloc(MBED_CLOUD_CLIENT_FOTA_MULTICAST_BR_READ_CACHE_BLOCK_SIZE);
+        if (!block->buf) {
+            return NULL;
+        }
+    }
+
+    block->size = 0;
+    block->offset = block_offset;
+    *ret = fota_multicast_read_from_image(block->buf, block_offset,
+                                          MIN(MBED_CLOUD_CLIENT_FOTA_MULTICAST_BR_READ_CACHE_BLOCK_SIZE, mc_br_image_size - block_offset));
+    if (*ret) {
+        return NULL;
+    }
+    block->size = MIN(MBED_CLOUD_CLIENT_FOTA_MULTICAST_BR_READ_CACHE_BLOCK_SIZE, mc_br_image_size - block_offset);
+    block->last_use = ++mc_br_read_cache_clock;
+    return block;
+}
+#endif // (MBED_CLOUD_CLIENT_FOTA_MULTICAST_BR_READ_CACHE_BLOCKS > 0)
+
 static int multicast_br_post_install_handler(const char *component_name, const fota_header_info_t *expected_header_info)
 {
     // Actual image data starts right after FW header
     mc_image_data_addr = fota_ctx->fw_header_bd_size + fota_ctx->fw_header_offset;
+#if (MBED_CLOUD_CLIENT_FOTA_MULTICAST_BR_READ_CACHE_BLOCKS > 0)
+    multicast_br_read_cache_free();
+    mc_br_image_size = expected_header_info->fw_size;
+#endif
     FOTA_DBG_ASSERT(fota_ctx->mc_br_post_action_callback);
     fota_ctx->mc_br_post_action_callback(FOTA_STATUS_SUCCESS);
     return FOTA_STATUS_SUCCESS;
@@ -2714,6 +3501,11 @@ int fota_multicast_br_on_image_request(const fota_multicast_br_image_params *ima
         goto fail;
     }
 
+#if (MBED_CLOUD_CLIENT_FOTA_MULTICAST_BR_READ_CACHE_BLOCKS > 0)
+    // Previous image is about to be overwritten
+    multicast_br_read_cache_free();
+#endif
+
     ret = handle_manifest_init();
     if (ret) {
         goto fail;
@@ -2750,7 +3542,32 @@ fail:
 
 int fota_multicast_br_read_from_image(void *buffer, size_t offset, size_t size)
 {
+#if (MBED_CLOUD_CLIENT_FOTA_MULTICAST_BR_READ_CACHE_BLOCKS > 0)
+    int ret;
+    uint8_t *buf = (uint8_t *) buffer;
+    bool sequential = (offset == mc_br_next_read_offset);
+
+    mc_br_next_read_offset = offset + size;
+
+    while (size) {
+        mc_br_cache_block_t *block = multicast_br_read_cache_get(offset, sequential, &ret);
+        if (!block) {
+            if (ret) {
+                return ret;
+            }
+            // Past the image or out of memory
+            return fota_multicast_read_from_image(buf, offset, size);
+        }
+        size_t chunk = MIN(size, block->offset + block->size - offset);
+        memcpy(buf, block->buf + offset - block->offset, chunk);
+        buf += chunk;
+        offset += chunk;
+        size -= chunk;
+    }
+    return FOTA_STATUS_SUCCESS;
+#else
     return fota_multicast_read_from_image(buffer, offset, size);
+#endif
 }
 
 #endif // FOTA_MULTICAST_BR_MODE
@@ -64,6 +64,16 @@ int fota_deinit(void);
  */
 bool fota_is_active_update(void);
 
+/*
+ * Tell if installed components wait for a reboot
+ *
+ * Set when MBED_CLOUD_CLIENT_FOTA_DEFERRED_REBOOT_COMPONENTS lets a component finish its update
+ * without rebooting. The application reboots once the whole set of components is installed.
+ *
+ * \return true if a reboot is pending
+ */
+bool fota_is_reboot_pending(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -46,6 +46,13 @@ typedef struct {
     size_t   bytes_completed;
     uint32_t install_alignment;
     uint8_t  *fragment_buf;
+#if (MBED_CLOUD_CLIENT_FOTA_CANDIDATE_READ_AHEAD_SIZE > 0)
+    // Read-ahead window over candidate storage, holding read_ahead_size bytes from read_ahead_addr
+    uint8_t  *read_ahead_buf;
+    size_t   read_ahead_addr;
+    size_t   read_ahead_size;
+    size_t   read_ahead_alloc_size;
+#endif
 
 #if (MBED_CLOUD_CLIENT_FOTA_ENCRYPTION_SUPPORT == 1)
     fota_encrypt_context_t *enc_ctx;
@@ -68,6 +75,37 @@ void fota_candidate_set_config(fota_candidate_config_t *in_fota_candidate_config
     memcpy(&fota_candidate_config, in_fota_candidate_config, sizeof(fota_candidate_config_t));
 }
 
+fota_candidate_block_checksum_t fota_candidate_calc_block_checksum(const uint8_t *buf, size_t size)
+{
+    uint32_t sum = 0;
+
+    while (size && ((uintptr_t) buf % sizeof(uint32_t))) {
+        sum += *buf++;
+        size--;
+    }
+
+    // Word at a time: even and odd bytes are added in two 16-bit lanes,
+    // folded every 128 words, before a lane can overflow.
+    while (size >= sizeof(uint32_t)) {
+        uint32_t lanes = 0;
+        size_t num_words = MIN(size / sizeof(uint32_t), 128);
+        size -= num_words * sizeof(uint32_t);
+        while (num_words--) {
+            uint32_t word;
+            memcpy(&word, buf, sizeof(word));
+            lanes += (word & 0x00FF00FF) + ((word >> 8) & 0x00FF00FF);
+            buf += sizeof(uint32_t);
+        }
+        sum += (lanes & 0xFFFF) + (lanes >> 16);
+    }
+
+    while (size--) {
+        sum += *buf++;
+    }
+
+    return (fota_candidate_block_checksum_t) sum;
+}
+
 const fota_candidate_config_t *fota_candidate_get_config(void)
 {
     if (!fota_candidate_config.storage_size) {
@@ -142,6 +180,9 @@ static void cleanup()
     fota_encrypt_finalize(&ctx->enc_ctx);
 #endif
     free(ctx->fragment_buf);
+#if (MBED_CLOUD_CLIENT_FOTA_CANDIDATE_READ_AHEAD_SIZE > 0)
+    free(ctx->read_ahead_buf);
+#endif
     free(ctx);
     ctx = 0;
 }
@@ -327,6 +368,20 @@ static int fota_candidate_extract_start(bool force_encrypt, const char *expected
         goto fail;
     }
 
+#if (MBED_CLOUD_CLIENT_FOTA_CANDIDATE_READ_AHEAD_SIZE > 0)
+    ctx->read_ahead_size = 0;
+    if (!ctx->read_ahead_buf) {
+        // Window is only worth it if it holds several blocks, otherwise fall back to direct reads
+        ctx->read_ahead_alloc_size = FOTA_ALIGN_UP(MBED_CLOUD_CLIENT_FOTA_CANDIDATE_READ_AHEAD_SIZE, ctx->bd_read_size);
+        if (ctx->read_ahead_alloc_size > ctx->effective_block_size + ctx->block_checker_size) {
+            ctx->read_ahead_buf = (uint8_t *) malloc(ctx->read_ahead_alloc_size);
+            if (!ctx->read_ahead_buf) {
+                FOTA_TRACE_DEBUG("FOTA read ahead buffer allocation failed, reading block at a time");
+            }
+        }
+    }
+#endif
+
     return FOTA_STATUS_SUCCESS;
 
 fail:
@@ -334,6 +389,38 @@ fail:
     return ret;
 }
 
+// Reads candidate storage sequentially, through the read-ahead window if there is one
+static int candidate_read(uint8_t *buf, size_t addr, size_t size)
+{
+#if (MBED_CLOUD_CLIENT_FOTA_CANDIDATE_READ_AHEAD_SIZE > 0)
+    if (ctx->read_ahead_buf) {
+        size_t storage_end = fota_candidate_get_config()->storage_start_addr + fota_candidate_get_config()->storage_size;
+
+        while (size) {
+            if ((addr < ctx->read_ahead_addr) || (addr >= ctx->read_ahead_addr + ctx->read_ahead_size)) {
+                // Fills are read size aligned, so the window ends where the next aligned read starts
+                size_t fill_size = MIN(ctx->read_ahead_alloc_size, FOTA_ALIGN_DOWN(storage_end - addr, ctx->bd_read_size));
+                int ret = fota_bd_read(ctx->read_ahead_buf, addr, fill_size);
+                if (ret) {
+                    ctx->read_ahead_size = 0;
+                    return ret;
+                }
+                ctx->read_ahead_addr = addr;
+                ctx->read_ahead_size = fill_size;
+            }
+
+            size_t chunk = MIN(size, ctx->read_ahead_addr + ctx->read_ahead_size - addr);
+            memcpy(buf, ctx->read_ahead_buf + addr - ctx->read_ahead_addr, chunk);
+            buf += chunk;
+            addr += chunk;
+            size -= chunk;
+        }
+        return FOTA_STATUS_SUCCESS;
+    }
+#endif
+    return fota_bd_read(buf, addr, size);
+}
+
 static int fota_candidate_extract_fragment(uint8_t **buf, size_t *actual_size, bool *ignore)
 {
     size_t read_size;
@@ -362,7 +449,7 @@ static int fota_candidate_extract_fragment(uint8_t **buf, size_t *actual_size, b
         return FOTA_STATUS_STORAGE_READ_FAILED;
     }
 
-    ret = fota_bd_read(*buf, ctx->curr_addr, read_size);
+    ret = candidate_read(*buf, ctx->curr_addr, read_size);
     if (ret) {
         FOTA_TRACE_ERROR("storage read failed, ret %d", ret);
         return ret;
@@ -389,10 +476,7 @@ static int fota_candidate_extract_fragment(uint8_t **buf, size_t *actual_size, b
             (ctx->header_info.flags & FOTA_HEADER_SUPPORT_RESUME_FLAG)) {
         fota_candidate_block_checksum_t read_checksum = *(fota_candidate_block_checksum_t *) *buf;
         *buf += sizeof(fota_candidate_block_checksum_t);
-        fota_candidate_block_checksum_t calc_checksum = 0;
-        for (uint32_t i = 0; i < *actual_size; i++) {
-            calc_checksum += (*buf)[i];
-        }
+        fota_candidate_block_checksum_t calc_checksum = fota_candidate_calc_block_checksum(*buf, *actual_size);
         if (calc_checksum != read_checksum) {
             FOTA_TRACE_DEBUG("Bad block ignored");
             *ignore = true;
@@ -422,119 +506,165 @@ static int fota_candidate_extract_fragment(uint8_t **buf, size_t *actual_size, b
     return FOTA_STATUS_SUCCESS;
 }
 
-int fota_candidate_iterate_image(uint8_t validate, bool force_encrypt, const char *expected_comp_name,
-                                 uint32_t install_alignment, fota_candidate_iterate_handler_t handler)
-{
-    int ret;
+// Iteration state, kept between fota_candidate_iterate_step() calls
+typedef struct {
+    fota_candidate_iterate_handler_t handler;
     fota_candidate_iterate_callback_info cb_info;
-    size_t actual_size = 0;
-    uint8_t *buf = NULL;
-    fota_hash_context_t *hash_ctx = NULL;
-    bool ignore = false;
+    fota_hash_context_t *hash_ctx;
+    size_t actual_size;                 // Size and ignore flag of the last fragment, used by the next extract
+    bool ignore;
+    const char *expected_comp_name;
+    uint32_t install_alignment;
+    bool force_encrypt;
+    bool validating;
+} candidate_iterate_state_t;
 
-    FOTA_ASSERT(handler);
+static candidate_iterate_state_t iterate_state = { 0 };
 
-    // Make sure previous context is cleared (relevant mainly in tests)
+void fota_candidate_iterate_abort(void)
+{
+    fota_hash_finish(&iterate_state.hash_ctx);
     cleanup();
+}
 
-    // Install alignment of zero is just like an alignment of 1 (i.e. no limitation)
-    install_alignment = install_alignment ? install_alignment : 1;
+static int iterate_install_start(void)
+{
+    int ret;
 
-    // Validation phase
+    iterate_state.validating = false;
+    iterate_state.actual_size = 0;
+    iterate_state.ignore = false;
 
-    // Can use install alignment of 1 here, as this is just validation, no installation yet
-    ret = fota_candidate_extract_start(force_encrypt, expected_comp_name, 1);
+    ret = fota_candidate_extract_start(iterate_state.force_encrypt, iterate_state.expected_comp_name,
+                                       iterate_state.install_alignment);
     if (ret) {
-        goto fail;
+        return ret;
     }
 
-    if (validate != FOTA_CANDIDATE_SKIP_VALIDATION) {
-        FOTA_TRACE_INFO("Validating image...");
-        uint8_t hash_output[FOTA_CRYPTO_HASH_SIZE];
-
-        ret = fota_hash_start(&hash_ctx);
-        if (ret) {
-            goto fail;
-        }
-        do {
-            ret = fota_candidate_extract_fragment(&buf, &actual_size, &ignore);
-            if (ret) {
-                goto fail;
-            }
-            if (ignore) {
-                continue;
-            }
+    memset(&iterate_state.cb_info, 0, sizeof(iterate_state.cb_info));
 
-            ret = fota_hash_update(hash_ctx, buf, actual_size);
-            if (ret) {
-                goto fail;
-            }
+    iterate_state.cb_info.status = FOTA_CANDIDATE_ITERATE_START;
+    iterate_state.cb_info.header_info = &ctx->header_info;
+    ret = iterate_state.handler(&iterate_state.cb_info);
+    if (ret) {
+        FOTA_TRACE_ERROR("Candidate user handler failed on start, ret %d", ret);
+    }
+    return ret;
+}
 
-        } while (actual_size);
+static int iterate_validate_finish(void)
+{
+    int ret;
+    uint8_t hash_output[FOTA_CRYPTO_HASH_SIZE];
 
-        ret = fota_hash_result(hash_ctx, hash_output);
-        if (ret) {
-            goto fail;
-        }
+    ret = fota_hash_result(iterate_state.hash_ctx, hash_output);
+    if (ret) {
+        goto fail;
+    }
 
-        fota_hash_finish(&hash_ctx);
+    fota_hash_finish(&iterate_state.hash_ctx);
 
 #if defined(MBED_CLOUD_CLIENT_FOTA_SIGNED_IMAGE_SUPPORT)
-        int sig_verify_status = fota_verify_signature_prehashed(
-                                    hash_output,
-                                    ctx->header_info.signature, FOTA_IMAGE_RAW_SIGNATURE_SIZE
-                                );
-        FOTA_FI_SAFE_COND(
-            (sig_verify_status == FOTA_STATUS_SUCCESS),
-            (sig_verify_status == FOTA_STATUS_MANIFEST_SIGNATURE_INVALID) ? FOTA_STATUS_MANIFEST_PAYLOAD_CORRUPTED : ret,
-            "Candidate image is not authentic"
-        );
+    int sig_verify_status = fota_verify_signature_prehashed(
+                                hash_output,
+                                ctx->header_info.signature, FOTA_IMAGE_RAW_SIGNATURE_SIZE
+                            );
+    FOTA_FI_SAFE_COND(
+        (sig_verify_status == FOTA_STATUS_SUCCESS),
+        (sig_verify_status == FOTA_STATUS_MANIFEST_SIGNATURE_INVALID) ? FOTA_STATUS_MANIFEST_PAYLOAD_CORRUPTED : ret,
+        "Candidate image is not authentic"
+    );
 #else
-        FOTA_FI_SAFE_MEMCMP(hash_output, ctx->header_info.digest, FOTA_CRYPTO_HASH_SIZE,
-                            FOTA_STATUS_MANIFEST_PAYLOAD_CORRUPTED,
-                            "Hash mismatch - corrupted candidate");
+    FOTA_FI_SAFE_MEMCMP(hash_output, ctx->header_info.digest, FOTA_CRYPTO_HASH_SIZE,
+                        FOTA_STATUS_MANIFEST_PAYLOAD_CORRUPTED,
+                        "Hash mismatch - corrupted candidate");
 #endif
-        FOTA_TRACE_INFO("Image is valid.");
-    }
+    FOTA_TRACE_INFO("Image is valid.");
 
     // Start iteration phase
+    ret = iterate_install_start();
+
+fail:
+    return ret;
+}
+
+int fota_candidate_iterate_start(uint8_t validate, bool force_encrypt, const char *expected_comp_name,
+                                 uint32_t install_alignment, fota_candidate_iterate_handler_t handler)
+{
+    int ret;
+
+    FOTA_ASSERT(handler);
 
-    actual_size = 0;
-    ignore = false;
+    // Make sure previous context is cleared (relevant mainly in tests)
+    fota_candidate_iterate_abort();
+
+    memset(&iterate_state, 0, sizeof(iterate_state));
+    iterate_state.handler = handler;
+    iterate_state.expected_comp_name = expected_comp_name;
+    iterate_state.force_encrypt = force_encrypt;
+    // Install alignment of zero is just like an alignment of 1 (i.e. no limitation)
+    iterate_state.install_alignment = install_alignment ? install_alignment : 1;
+
+    if (validate == FOTA_CANDIDATE_SKIP_VALIDATION) {
+        ret = iterate_install_start();
+    } else {
+        FOTA_TRACE_INFO("Validating image...");
+        iterate_state.validating = true;
+
+        // Can use install alignment of 1 here, as this is just validation, no installation yet
+        ret = fota_candidate_extract_start(force_encrypt, expected_comp_name, 1);
+        if (!ret) {
+            ret = fota_hash_start(&iterate_state.hash_ctx);
+        }
+    }
 
-    ret = fota_candidate_extract_start(force_encrypt, expected_comp_name, install_alignment);
     if (ret) {
-        goto fail;
+        fota_candidate_iterate_abort();
     }
+    return ret;
+}
+
+int fota_candidate_iterate_step(bool *done)
+{
+    int ret;
+    uint8_t *buf = NULL;
 
-    memset(&cb_info, 0, sizeof(cb_info));
+    *done = false;
 
-    cb_info.status = FOTA_CANDIDATE_ITERATE_START;
-    cb_info.header_info = &ctx->header_info;
-    ret = handler(&cb_info);
+    ret = fota_candidate_extract_fragment(&buf, &iterate_state.actual_size, &iterate_state.ignore);
     if (ret) {
-        FOTA_TRACE_ERROR("Candidate user handler failed on start, ret %d", ret);
         goto fail;
     }
+    const size_t actual_size = iterate_state.actual_size;
+    if (iterate_state.ignore) {
+        return FOTA_STATUS_SUCCESS;
+    }
 
-    do {
-        ret = fota_candidate_extract_fragment(&buf, &actual_size, &ignore);
-        if (ret) {
-            goto fail;
-        }
-        if (ignore) {
-            continue;
+    if (iterate_state.validating) {
+        if (actual_size) {
+            ret = fota_hash_update(iterate_state.hash_ctx, buf, actual_size);
+        } else {
+            ret = iterate_validate_finish();
         }
-        cb_info.status = FOTA_CANDIDATE_ITERATE_FRAGMENT;
-        cb_info.frag_size = actual_size;
-        cb_info.frag_buf = buf;
-        ret = handler(&cb_info);
         if (ret) {
-            FOTA_TRACE_ERROR("Candidate user handler failed on fragment, ret %d", ret);
             goto fail;
         }
-        cb_info.frag_pos += actual_size;
-    } while (cb_info.frag_pos < ctx->header_info.fw_size);
+        return FOTA_STATUS_SUCCESS;
+    }
+
+    iterate_state.cb_info.status = FOTA_CANDIDATE_ITERATE_FRAGMENT;
+    iterate_state.cb_info.frag_size = actual_size;
+    iterate_state.cb_info.frag_buf = buf;
+    ret = iterate_state.handler(&iterate_state.cb_info);
+    if (ret) {
+        FOTA_TRACE_ERROR("Candidate user handler failed on fragment, ret %d", ret);
+        goto fail;
+    }
+    iterate_state.cb_info.frag_pos += actual_size;
+
+    if (iterate_state.cb_info.frag_pos < ctx->header_info.fw_size) {
+        return FOTA_STATUS_SUCCESS;
+    }
 
 #if (MBED_CLOUD_CLIENT_FOTA_ENCRYPTION_SUPPORT == 1)
     if (ctx->header_info.flags & FOTA_HEADER_ENCRYPTED_FLAG) {
@@ -542,15 +672,27 @@ int fota_candidate_iterate_image(uint8_t validate, bool force_encrypt, const cha
     }
 #endif
 
-    cb_info.status = FOTA_CANDIDATE_ITERATE_FINISH;
-    ret = handler(&cb_info);
+    iterate_state.cb_info.status = FOTA_CANDIDATE_ITERATE_FINISH;
+    ret = iterate_state.handler(&iterate_state.cb_info);
     if (ret) {
         FOTA_TRACE_ERROR("Candidate user handler failed on finish, ret %d", ret);
     }
 
 fail:
-    fota_hash_finish(&hash_ctx);
-    cleanup();
+    *done = true;
+    fota_candidate_iterate_abort();
+    return ret;
+}
+
+int fota_candidate_iterate_image(uint8_t validate, bool force_encrypt, const char *expected_comp_name,
+                                 uint32_t install_alignment, fota_candidate_iterate_handler_t handler)
+{
+    bool done = false;
+    int ret = fota_candidate_iterate_start(validate, force_encrypt, expected_comp_name, install_alignment, handler);
+
+    while (!ret && !done) {
+        ret = fota_candidate_iterate_step(&done);
+    }
     return ret;
 }
 
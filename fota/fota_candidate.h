@@ -112,6 +112,33 @@ typedef int (*fota_candidate_iterate_handler_t)(fota_candidate_iterate_callback_
 int fota_candidate_iterate_image(uint8_t validate, bool force_encrypt, const char *expected_comp_name,
                                  uint32_t install_alignment, fota_candidate_iterate_handler_t handler);
 
+/**
+ * Start iterating on candidate image one fragment at a time, same as fota_candidate_iterate_image().
+ * Continue with fota_candidate_iterate_step() until it fails or sets done.
+ *
+ * \param[in] validate optionally validate image on storage, could add significant time to validate candidate.
+ * \param[in] force_encrypt force encryption.
+ * \param[in] expected_comp_name expected component name, must stay valid until done.
+ * \param[in] install_alignment  installer alignment in bytes.
+ * \param[in] handler callback called on iteration start, each fragment and finish.
+ * \return FOTA_STATUS_SUCCESS on success.
+ */
+int fota_candidate_iterate_start(uint8_t validate, bool force_encrypt, const char *expected_comp_name,
+                                 uint32_t install_alignment, fota_candidate_iterate_handler_t handler);
+
+/**
+ * Handle the next fragment of the iteration started by fota_candidate_iterate_start().
+ *
+ * \param[out] done set when the iteration is finished, or failed.
+ * \return FOTA_STATUS_SUCCESS on success.
+ */
+int fota_candidate_iterate_step(bool *done);
+
+/**
+ * Stop the iteration started by fota_candidate_iterate_start() and free its resources.
+ */
+void fota_candidate_iterate_abort(void);
+
 /**
  * Read candidate component ready header.
  *
@@ -142,6 +169,15 @@ int fota_candidate_read_header(size_t *addr, uint32_t bd_read_size, uint32_t bd_
  */
 int fota_candidate_erase(void);
 
+/**
+ * Calculate block checksum (sum of all bytes).
+ *
+ * \param[in] buf block data.
+ * \param[in] size block data size.
+ * \return block checksum.
+ */
+fota_candidate_block_checksum_t fota_candidate_calc_block_checksum(const uint8_t *buf, size_t size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -146,6 +146,12 @@
 #define MBED_CLOUD_CLIENT_FOTA_LINUX_CANDIDATE_FILENAME "fota_candidate"
 #endif
 
+// Size of each of the two buffers used to write the candidate file on install,
+// one is written by a writer thread while the other is filled. 0 writes each fragment directly.
+#if !defined(MBED_CLOUD_CLIENT_FOTA_LINUX_INSTALL_BUFFER_SIZE)
+#define MBED_CLOUD_CLIENT_FOTA_LINUX_INSTALL_BUFFER_SIZE (256 * 1024)
+#endif
+
 #if defined(FOTA_UNIT_TEST)
 // Unit tests don't actually replace the current running app, but use a test file
 extern char *unitest_curr_fw_filename;
@@ -251,6 +257,59 @@ extern char *program_invocation_name;
 #define MBED_CLOUD_CLIENT_FOTA_CANDIDATE_BLOCK_SIZE 1024
 #endif
 
+#if !defined(MBED_CLOUD_CLIENT_FOTA_ERASE_AHEAD_SIZE)
+#define MBED_CLOUD_CLIENT_FOTA_ERASE_AHEAD_SIZE 0
+#endif
+
+// Time each stage of payload handling and trace the throughput when the download finishes
+#if !defined(MBED_CLOUD_CLIENT_FOTA_STATS)
+#define MBED_CLOUD_CLIENT_FOTA_STATS 0
+#endif
+
+#if (MBED_CLOUD_CLIENT_FOTA_STATS == 1) && !MBED_CLOUD_CLIENT_FOTA_SUPPORT_PAL
+#error MBED_CLOUD_CLIENT_FOTA_STATS requires PAL support
+#endif
+
+#if !defined(MBED_CLOUD_CLIENT_FOTA_CANDIDATE_READ_AHEAD_SIZE)
+#define MBED_CLOUD_CLIENT_FOTA_CANDIDATE_READ_AHEAD_SIZE 0
+#endif
+
+#if !defined(MBED_CLOUD_CLIENT_FOTA_RESUME_CHECKPOINT_INTERVAL)
+#define MBED_CLOUD_CLIENT_FOTA_RESUME_CHECKPOINT_INTERVAL 0
+#endif
+
+#if !defined(MBED_CLOUD_CLIENT_FOTA_MULTICAST_NODE_WRITE_CACHE_SIZE)
+#define MBED_CLOUD_CLIENT_FOTA_MULTICAST_NODE_WRITE_CACHE_SIZE 0
+#endif
+
+#if !defined(MBED_CLOUD_CLIENT_FOTA_MULTICAST_BR_READ_CACHE_BLOCKS)
+#define MBED_CLOUD_CLIENT_FOTA_MULTICAST_BR_READ_CACHE_BLOCKS 0
+#endif
+
+#if !defined(MBED_CLOUD_CLIENT_FOTA_MULTICAST_BR_READ_CACHE_BLOCK_SIZE)
+#define MBED_CLOUD_CLIENT_FOTA_MULTICAST_BR_READ_CACHE_BLOCK_SIZE 4096
+#endif
+
+#if !defined(MBED_CLOUD_CLIENT_FOTA_DEFERRED_REBOOT_COMPONENTS)
+#define MBED_CLOUD_CLIENT_FOTA_DEFERRED_REBOOT_COMPONENTS 0
+#endif
+
+#if !defined(MBED_CLOUD_CLIENT_FOTA_SLICE_TIME_BUDGET)
+#define MBED_CLOUD_CLIENT_FOTA_SLICE_TIME_BUDGET 0
+#endif
+
+#if !defined(MBED_CLOUD_CLIENT_FOTA_DELTA_READ_CACHE_SIZE)
+#define MBED_CLOUD_CLIENT_FOTA_DELTA_READ_CACHE_SIZE 0
+#endif
+
+#if !defined(MBED_CLOUD_CLIENT_FOTA_COMPRESSED_PAYLOAD_SUPPORT)
+#define MBED_CLOUD_CLIENT_FOTA_COMPRESSED_PAYLOAD_SUPPORT 0
+#endif
+
+#if !defined(MBED_CLOUD_CLIENT_FOTA_COMPRESSED_BLOCK_SIZE)
+#define MBED_CLOUD_CLIENT_FOTA_COMPRESSED_BLOCK_SIZE 1024
+#endif
+
 #if !defined(MBED_CLOUD_CLIENT_FOTA_ENCRYPTION_SUPPORT)
 #define MBED_CLOUD_CLIENT_FOTA_ENCRYPTION_SUPPORT 0
 #endif  // !defined(MBED_CLOUD_CLIENT_FOTA_ENCRYPTION_SUPPORT)
@@ -363,6 +422,11 @@ extern char *program_invocation_name;
 #define FOTA_COMPONENT_SUPPORT 1
 #endif
 
+#if (MBED_CLOUD_CLIENT_FOTA_DEFERRED_REBOOT_COMPONENTS > 0) && FOTA_COMPONENT_SUPPORT && FOTA_VERIFY_INSTALLATION_AFTER_UPGRADE
+// Components needing a reboot are verified after the next one, so a set of components shares a single reboot
+#define FOTA_DEFERRED_REBOOT 1
+#endif
+
 #if (MBED_CLOUD_CLIENT_FOTA_FW_HEADER_VERSION >= 3)
 
 #define FOTA_HEADER_HAS_CANDIDATE_READY 1
@@ -390,6 +454,12 @@ extern char *program_invocation_name;
 
 #endif // (MBED_CLOUD_CLIENT_FOTA_FW_HEADER_VERSION >= 3)
 
+#undef FOTA_RESUME_HASH_CHECKPOINT
+#if (MBED_CLOUD_CLIENT_FOTA_RESUME_SUPPORT == FOTA_RESUME_SUPPORT_RESUME) && (MBED_CLOUD_CLIENT_FOTA_RESUME_CHECKPOINT_INTERVAL > 0)
+// Payload hash state is saved to NVM during download, so resume doesn't need to hash all stored data again
+#define FOTA_RESUME_HASH_CHECKPOINT 1
+#endif
+
 #if !defined(MBED_CLOUD_CLIENT_FOTA_DOWNLOAD)
 #if defined(TARGET_LIKE_LINUX)
 #define MBED_CLOUD_CLIENT_FOTA_DOWNLOAD MBED_CLOUD_CLIENT_FOTA_CURL_HTTP_DOWNLOAD
@@ -407,8 +477,36 @@ extern char *program_invocation_name;
 #define MBED_CLOUD_CLIENT_FOTA_CURL_PAYLOAD_SIZE 0x4000L
 #endif
 
+// Number of concurrent HTTP range requests, 1 downloads the payload in a single stream
+#if !defined(MBED_CLOUD_CLIENT_FOTA_CURL_PARALLEL_CONNECTIONS)
+#define MBED_CLOUD_CLIENT_FOTA_CURL_PARALLEL_CONNECTIONS 1
+#endif
+
+// Size of each range request in parallel mode (also buffered in RAM per connection)
+#if !defined(MBED_CLOUD_CLIENT_FOTA_CURL_RANGE_SIZE)
+#define MBED_CLOUD_CLIENT_FOTA_CURL_RANGE_SIZE 0x100000L
+#endif
+
+// Base URL of a peer cache on the local network, e.g. "http://fota-cache.local:8080".
+// When defined, the payload is requested from there first, using the path of the
+// cloud URL, and from the cloud from where the peer failed. Not defined by default.
+// #define MBED_CLOUD_CLIENT_FOTA_CURL_PEER_CACHE_URL "http://fota-cache.local:8080"
+
 #endif  // (MBED_CLOUD_CLIENT_FOTA_DOWNLOAD == MBED_CLOUD_CLIENT_FOTA_CURL_HTTP_DOWNLOAD)
 
+#if (MBED_CLOUD_CLIENT_FOTA_DOWNLOAD == MBED_CLOUD_CLIENT_FOTA_COAP_DOWNLOAD)
+// Number of fragments requested ahead of the one being processed, 1 requests one fragment at a time.
+// Fragments received ahead are buffered in RAM (one CoAP block each), and every outstanding request
+// takes a slot in the CoAP resend queue, so keep this below MBED_CLIENT_SN_COAP_RESENDING_QUEUE_SIZE_MSGS.
+#if !defined(MBED_CLOUD_CLIENT_FOTA_COAP_DOWNLOAD_WINDOW)
+#define MBED_CLOUD_CLIENT_FOTA_COAP_DOWNLOAD_WINDOW 1
+#endif
+
+#if (MBED_CLOUD_CLIENT_FOTA_COAP_DOWNLOAD_WINDOW < 1)
+#error MBED_CLOUD_CLIENT_FOTA_COAP_DOWNLOAD_WINDOW must be at least 1
+#endif
+#endif  // (MBED_CLOUD_CLIENT_FOTA_DOWNLOAD == MBED_CLOUD_CLIENT_FOTA_COAP_DOWNLOAD)
+
 #if (FOTA_SOURCE_LEGACY_OBJECTS_REPORT == 1)
 #define FOTA_MCCP_PROTOCOL_VERSION 3
 #else
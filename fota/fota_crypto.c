@@ -432,6 +432,44 @@ void fota_hash_finish(fota_hash_context_t **ctx)
     }
 }
 
+#if defined(FOTA_RESUME_HASH_CHECKPOINT)
+int fota_hash_state_get(const fota_hash_context_t *ctx, uint8_t state[FOTA_HASH_STATE_SIZE])
+{
+    FOTA_DBG_ASSERT(ctx);
+#if defined(MBEDTLS_SHA256_ALT)
+    // Context layout of an alternative implementation is unknown
+    (void) state;
+    return FOTA_STATUS_INTERNAL_CRYPTO_ERROR;
+#else
+    const mbedtls_sha256_context *sha256_ctx = &ctx->sha256_ctx;
+    memcpy(state, sha256_ctx->total, sizeof(sha256_ctx->total));
+    state += sizeof(sha256_ctx->total);
+    memcpy(state, sha256_ctx->state, sizeof(sha256_ctx->state));
+    state += sizeof(sha256_ctx->state);
+    memcpy(state, sha256_ctx->buffer, sizeof(sha256_ctx->buffer));
+    return FOTA_STATUS_SUCCESS;
+#endif
+}
+
+int fota_hash_state_set(fota_hash_context_t *ctx, const uint8_t state[FOTA_HASH_STATE_SIZE])
+{
+    FOTA_DBG_ASSERT(ctx);
+#if defined(MBEDTLS_SHA256_ALT)
+    (void) state;
+    return FOTA_STATUS_INTERNAL_CRYPTO_ERROR;
+#else
+    mbedtls_sha256_context *sha256_ctx = &ctx->sha256_ctx;
+    memcpy(sha256_ctx->total, state, sizeof(sha256_ctx->total));
+    state += sizeof(sha256_ctx->total);
+    memcpy(sha256_ctx->state, state, sizeof(sha256_ctx->state));
+    state += sizeof(sha256_ctx->state);
+    memcpy(sha256_ctx->buffer, state, sizeof(sha256_ctx->buffer));
+    sha256_ctx->is224 = 0;
+    return FOTA_STATUS_SUCCESS;
+#endif
+}
+#endif // defined(FOTA_RESUME_HASH_CHECKPOINT)
+
 int fota_random_init(const uint8_t *seed, uint32_t seed_size)
 {
 #if !defined(MBEDTLS_SSL_CONF_RNG)
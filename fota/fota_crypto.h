@@ -86,6 +86,14 @@ void fota_hash_clone(fota_hash_context_t *dst_ctx, const fota_hash_context_t *sr
 int fota_hash_result(fota_hash_context_t *ctx, uint8_t *hash_buf);
 void fota_hash_finish(fota_hash_context_t **ctx);
 
+#if defined(FOTA_RESUME_HASH_CHECKPOINT)
+// Serialized hash state: processed length, intermediate digest and pending input block
+#define FOTA_HASH_STATE_SIZE (10 * sizeof(uint32_t) + 64)
+
+int fota_hash_state_get(const fota_hash_context_t *ctx, uint8_t state[FOTA_HASH_STATE_SIZE]);
+int fota_hash_state_set(fota_hash_context_t *ctx, const uint8_t state[FOTA_HASH_STATE_SIZE]);
+#endif
+
 int fota_random_init(const uint8_t *seed, uint32_t seed_size);
 int fota_gen_random(uint8_t *buf, uint32_t buf_size);
 int fota_random_deinit(void);
@@ -0,0 +1,169 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 Pelion Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+#include "fota/fota_base.h"
+
+#ifdef MBED_CLOUD_CLIENT_FOTA_ENABLE
+
+#define TRACE_GROUP "FOTA"
+
+#if (MBED_CLOUD_CLIENT_FOTA_COMPRESSED_PAYLOAD_SUPPORT == 1)
+
+#include "fota/fota_decompress.h"
+
+#include "fota/fota_status.h"
+#include "bspatch/lz4.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BLOCK_HEADER_SIZE   2
+#define BLOCK_STORED_FLAG   0x8000
+#define BLOCK_LEN_MASK      0x7FFF
+// LZ4_COMPRESSBOUND(), in a form usable by the preprocessor
+#define BLOCK_MAX_LEN       (MBED_CLOUD_CLIENT_FOTA_COMPRESSED_BLOCK_SIZE + MBED_CLOUD_CLIENT_FOTA_COMPRESSED_BLOCK_SIZE / 255 + 16)
+
+#if (BLOCK_MAX_LEN > BLOCK_LEN_MASK)
+#error "MBED_CLOUD_CLIENT_FOTA_COMPRESSED_BLOCK_SIZE too large for block header"
+#endif
+
+struct fota_decompress_ctx_s {
+    // current payload fragment
+    const uint8_t *frag;
+    uint32_t frag_size;
+    uint32_t frag_offset;
+    // current block, header bytes and block bytes read so far
+    uint8_t header[BLOCK_HEADER_SIZE];
+    uint32_t header_len;
+    uint32_t block_len;
+    uint32_t block_offset;
+    bool block_stored;
+    // holds a block split between fragments
+    uint8_t block_buf[BLOCK_MAX_LEN];
+};
+
+int fota_decompress_start(fota_decompress_ctx_t **ctx)
+{
+    FOTA_DBG_ASSERT(ctx);
+
+    fota_decompress_ctx_t *decompress_ctx = (fota_decompress_ctx_t *) calloc(1, sizeof(fota_decompress_ctx_t));
+    if (!decompress_ctx) {
+        FOTA_TRACE_ERROR("Failed to allocate decompress context");
+        return FOTA_STATUS_OUT_OF_MEMORY;
+    }
+
+    *ctx = decompress_ctx;
+    return FOTA_STATUS_SUCCESS;
+}
+
+int fota_decompress_new_payload_frag(
+    fota_decompress_ctx_t *ctx,
+    const uint8_t *payload_frag, uint32_t payload_frag_size)
+{
+    FOTA_DBG_ASSERT(ctx);
+    ctx->frag = payload_frag;
+    ctx->frag_size = payload_frag_size;
+    ctx->frag_offset = 0;
+    return FOTA_STATUS_SUCCESS;
+}
+
+int fota_decompress_get_next_fw_frag(
+    fota_decompress_ctx_t *ctx,
+    uint8_t *fw_frag, uint32_t fw_frag_buf_size,
+    uint32_t *fw_frag_actual_size)
+{
+    FOTA_DBG_ASSERT(ctx);
+    FOTA_DBG_ASSERT(fw_frag_buf_size >= MBED_CLOUD_CLIENT_FOTA_COMPRESSED_BLOCK_SIZE);
+
+    *fw_frag_actual_size = 0;
+
+    while (ctx->frag_offset < ctx->frag_size) {
+        if (ctx->header_len < BLOCK_HEADER_SIZE) {
+            ctx->header[ctx->header_len++] = ctx->frag[ctx->frag_offset++];
+            if (ctx->header_len < BLOCK_HEADER_SIZE) {
+                continue;
+            }
+            uint16_t header = ctx->header[0] | (ctx->header[1] << 8);
+            ctx->block_stored = ((header & BLOCK_STORED_FLAG) != 0);
+            ctx->block_len = header & BLOCK_LEN_MASK;
+            ctx->block_offset = 0;
+            if (!ctx->block_len ||
+                    (ctx->block_len > (ctx->block_stored ? MBED_CLOUD_CLIENT_FOTA_COMPRESSED_BLOCK_SIZE : BLOCK_MAX_LEN))) {
+                FOTA_TRACE_ERROR("Invalid compressed block length %" PRIu32, ctx->block_len);
+                return FOTA_STATUS_MANIFEST_PAYLOAD_CORRUPTED;
+            }
+            continue;
+        }
+
+        const uint8_t *block;
+        uint32_t frag_left = ctx->frag_size - ctx->frag_offset;
+        if (!ctx->block_offset && (frag_left >= ctx->block_len)) {
+            // whole block in this fragment, unpack it in place
+            block = ctx->frag + ctx->frag_offset;
+            ctx->frag_offset += ctx->block_len;
+        } else {
+            uint32_t copy_size = MIN(frag_left, ctx->block_len - ctx->block_offset);
+            memcpy(ctx->block_buf + ctx->block_offset, ctx->frag + ctx->frag_offset, copy_size);
+            ctx->block_offset += copy_size;
+            ctx->frag_offset += copy_size;
+            if (ctx->block_offset < ctx->block_len) {
+                break;
+            }
+            block = ctx->block_buf;
+        }
+
+        // next byte starts a new block
+        ctx->header_len = 0;
+
+        if (ctx->block_stored) {
+            memcpy(fw_frag, block, ctx->block_len);
+            *fw_frag_actual_size = ctx->block_len;
+        } else {
+            int unpacked_size = LZ4_decompress_safe((const char *) block, (char *) fw_frag, (int) ctx->block_len,
+                                                    MBED_CLOUD_CLIENT_FOTA_COMPRESSED_BLOCK_SIZE);
+            if (unpacked_size <= 0) {
+                FOTA_TRACE_ERROR("Failed to decompress block %d", unpacked_size);
+                return FOTA_STATUS_MANIFEST_PAYLOAD_CORRUPTED;
+            }
+            *fw_frag_actual_size = (uint32_t) unpacked_size;
+        }
+        break;
+    }
+
+    return FOTA_STATUS_SUCCESS;
+}
+
+int fota_decompress_finalize(fota_decompress_ctx_t **ctx)
+{
+    FOTA_DBG_ASSERT(ctx);
+    int status = FOTA_STATUS_SUCCESS;
+    if (*ctx) {
+        // payload must not end in the middle of a block
+        if ((*ctx)->header_len) {
+            FOTA_TRACE_ERROR("Compressed payload truncated");
+            status = FOTA_STATUS_MANIFEST_PAYLOAD_CORRUPTED;
+        }
+        free(*ctx);
+        *ctx = NULL;
+    }
+    return status;
+}
+
+#endif  // (MBED_CLOUD_CLIENT_FOTA_COMPRESSED_PAYLOAD_SUPPORT == 1)
+
+#endif  // MBED_CLOUD_CLIENT_FOTA_ENABLE
@@ -0,0 +1,63 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 Pelion Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef __FOTA_DECOMPRESS_H_
+#define __FOTA_DECOMPRESS_H_
+
+#include "fota/fota_base.h"
+
+#if defined(MBED_CLOUD_CLIENT_FOTA_ENABLE)
+
+#if (MBED_CLOUD_CLIENT_FOTA_COMPRESSED_PAYLOAD_SUPPORT == 1)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Compressed full image payload is a sequence of blocks, each prefixed with a 16-bit little
+ * endian header. Header bits 0-14 hold the block length in the payload, bit 15 is set if the
+ * block is stored as is and cleared if it is an LZ4 block (no dictionary shared between blocks).
+ * Each block unpacks to at most MBED_CLOUD_CLIENT_FOTA_COMPRESSED_BLOCK_SIZE bytes.
+ */
+typedef struct fota_decompress_ctx_s fota_decompress_ctx_t;
+
+int fota_decompress_start(fota_decompress_ctx_t **ctx);
+int fota_decompress_new_payload_frag(
+    fota_decompress_ctx_t *ctx,
+    const uint8_t *payload_frag, uint32_t payload_frag_size);
+/*
+ * Unpack next block of the current payload fragment.
+ * fw_frag_actual_size is set to 0 once the fragment is consumed.
+ * fw_frag_buf_size must be at least MBED_CLOUD_CLIENT_FOTA_COMPRESSED_BLOCK_SIZE.
+ */
+int fota_decompress_get_next_fw_frag(
+    fota_decompress_ctx_t *ctx,
+    uint8_t *fw_frag, uint32_t fw_frag_buf_size,
+    uint32_t *fw_frag_actual_size);
+int fota_decompress_finalize(fota_decompress_ctx_t **ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // (MBED_CLOUD_CLIENT_FOTA_COMPRESSED_PAYLOAD_SUPPORT == 1)
+
+#endif // defined(MBED_CLOUD_CLIENT_FOTA_ENABLE)
+
+#endif // __FOTA_DECOMPRESS_H_
@@ -65,6 +65,12 @@ typedef struct fota_delta_ctx_s {
     uint32_t outgoing_frag_ptr_offset;
     // current fw reader function
     fota_component_curr_fw_read curr_fw_read;
+#if (MBED_CLOUD_CLIENT_FOTA_DELTA_READ_CACHE_SIZE > 0)
+    // Read-ahead window over current fw, holding cache_size bytes from cache_offset
+    uint8_t *cache_buf;
+    size_t cache_offset;
+    size_t cache_size;
+#endif
     struct bspatch_stream bs_patch_stream;
 } fota_delta_ctx_t;
 
@@ -132,6 +138,14 @@ int fota_delta_start(fota_delta_ctx_t **ctx, fota_component_curr_fw_read curr_fw
     delta_ctx->incoming_frag_ptr_offset = 0;
     delta_ctx->incoming_frag_ptr = 0;
     delta_ctx->curr_fw_read = curr_fw_read;
+#if (MBED_CLOUD_CLIENT_FOTA_DELTA_READ_CACHE_SIZE > 0)
+    delta_ctx->cache_buf = (uint8_t *) malloc(MBED_CLOUD_CLIENT_FOTA_DELTA_READ_CACHE_SIZE);
+    if (!delta_ctx->cache_buf) {
+        free(delta_ctx);
+        return FOTA_STATUS_OUT_OF_MEMORY;
+    }
+    delta_ctx->cache_size = 0;
+#endif
     ARM_BS_Init(&delta_ctx->bs_patch_stream, (void *)delta_ctx,
                 read_patch,
                 original_read,
@@ -229,6 +243,9 @@ int fota_delta_finalize(fota_delta_ctx_t **ctx)
         }
 
         ARM_BS_Free(&(*ctx)->bs_patch_stream);
+#if (MBED_CLOUD_CLIENT_FOTA_DELTA_READ_CACHE_SIZE > 0)
+        free((*ctx)->cache_buf);
+#endif
         free(*ctx);
         *ctx = NULL;
     }
@@ -290,6 +307,41 @@ bs_patch_api_return_code_t read_patch(
     return return_code;
 }
 
+#if (MBED_CLOUD_CLIENT_FOTA_DELTA_READ_CACHE_SIZE > 0)
+// Short reads are served from the window, refilled from the read offset on a miss.
+// Seeks are only offset updates, so forward seeks within the window need no read at all.
+static bs_patch_api_return_code_t original_read_cached(fota_delta_ctx_t *delta_ctx, uint8_t *buffer, size_t length)
+{
+    size_t offset = (size_t)delta_ctx->bspatch_seek_diff;
+    size_t remaining = length;
+
+    while (remaining) {
+        if ((offset < delta_ctx->cache_offset) || (offset >= delta_ctx->cache_offset + delta_ctx->cache_size)) {
+            size_t num_read = 0;
+            int status = delta_ctx->curr_fw_read(delta_ctx->cache_buf, offset,
+                                                 MBED_CLOUD_CLIENT_FOTA_DELTA_READ_CACHE_SIZE, &num_read);
+            if (status || !num_read) {
+                delta_ctx->cache_size = 0;
+                FOTA_TRACE_ERROR("[DELTA] failed to read current FW");
+                return EBSAPI_ERR_FILE_IO;
+            }
+            delta_ctx->cache_offset = offset;
+            delta_ctx->cache_size = num_read;
+        }
+
+        size_t chunk = MIN(remaining, delta_ctx->cache_offset + delta_ctx->cache_size - offset);
+        memcpy(buffer, delta_ctx->cache_buf + offset - delta_ctx->cache_offset, chunk);
+        buffer += chunk;
+        offset += chunk;
+        remaining -= chunk;
+    }
+
+    DBG("[DELTA] original_read(offset=%" PRIu64 ", length=%" PRIu64 ") cached", delta_ctx->bspatch_seek_diff, length);
+    delta_ctx->bspatch_seek_diff = offset;
+    return EBSAPI_OPERATION_DONE_IMMEDIATELY;
+}
+#endif
+
 bs_patch_api_return_code_t original_read(
     const struct bspatch_stream *stream,
     void *buffer,
@@ -297,6 +349,11 @@ bs_patch_api_return_code_t original_read(
 {
     fota_delta_ctx_t *delta_ctx = (fota_delta_ctx_t *)stream->opaque;
     FOTA_DBG_ASSERT(delta_ctx);
+#if (MBED_CLOUD_CLIENT_FOTA_DELTA_READ_CACHE_SIZE > 0)
+    if (length < MBED_CLOUD_CLIENT_FOTA_DELTA_READ_CACHE_SIZE) {
+        return original_read_cached(delta_ctx, buffer, length);
+    }
+#endif
     // always return 0. No need to check
     size_t num_read = 0;
     int status = delta_ctx->curr_fw_read(buffer, (size_t)delta_ctx->bspatch_seek_diff, length, &num_read);
@@ -35,6 +35,7 @@
 #define FOTA_EVENT_INIT                1
 #define FOTA_EVENT_EXECUTE_WITH_BUFFER 2
 #define FOTA_EVENT_EXECUTE_WITH_RESULT 4
+#define FOTA_EVENT_EXECUTE_SLICE       8
 
 typedef struct {
     uint8_t *data;
@@ -57,9 +58,40 @@ typedef struct {
 
 static fota_event_handler_ctx_t g_ctx = { 0 };
 
+// Sliced work has its own event, other callbacks may be deferred between its slices
+typedef struct {
+    fota_sliced_step_callback_t step;
+    fota_deferred_result_callabck_t on_finish;
+    arm_event_storage_t event_storage;
+} fota_sliced_work_ctx_t;
+
+static fota_sliced_work_ctx_t g_sliced_ctx = { 0 };
+
 // keep tasklet id separate because it can't be reset as part of the context on reinitialization
 static int8_t g_tasklet_id = -1;
 
+static void run_slice(void)
+{
+    const uint32_t start = eventOS_event_timer_ticks();
+    bool done = false;
+    int ret;
+
+    do {
+        ret = g_sliced_ctx.step(&done);
+    } while (!ret && !done &&
+             (eventOS_event_timer_ticks() - start) < eventOS_event_timer_ms_to_ticks(MBED_CLOUD_CLIENT_FOTA_SLICE_TIME_BUDGET));
+
+    if (ret || done) {
+        fota_deferred_result_callabck_t on_finish = g_sliced_ctx.on_finish;
+        g_sliced_ctx.step = NULL;
+        on_finish(ret);
+        return;
+    }
+
+    // Budget used up, let the other events run before the next slice
+    eventOS_event_send_user_allocated(&g_sliced_ctx.event_storage);
+}
+
 static void event_handler(arm_event_t *event)
 {
     FOTA_TRACE_DEBUG("FOTA event-handler got event [type= %d]", event->event_type);
@@ -69,6 +101,13 @@ static void event_handler(arm_event_t *event)
         case FOTA_EVENT_EXECUTE_WITH_RESULT:
             break;
 
+        case FOTA_EVENT_EXECUTE_SLICE:
+            // Cancelled work leaves its event queued
+            if (g_sliced_ctx.step) {
+                run_slice();
+            }
+            return;
+
         case FOTA_EVENT_INIT:
             return; // ignore event - nothing to be done
         default:
@@ -187,6 +226,38 @@ void fota_event_handler_defer_with_result(
     eventOS_event_send_user_allocated(&g_ctx.event_storage);
 }
 
+int fota_event_handler_run_sliced(fota_sliced_step_callback_t step, fota_deferred_result_callabck_t on_finish)
+{
+    FOTA_ASSERT(!g_sliced_ctx.step);
+
+    if (!MBED_CLOUD_CLIENT_FOTA_SLICE_TIME_BUDGET) {
+        bool done = false;
+        int ret;
+        do {
+            ret = step(&done);
+        } while (!ret && !done);
+        on_finish(ret);
+        return FOTA_STATUS_SUCCESS;
+    }
+
+    g_sliced_ctx.step = step;
+    g_sliced_ctx.on_finish = on_finish;
+
+    g_sliced_ctx.event_storage.data.priority = ARM_LIB_LOW_PRIORITY_EVENT;
+    g_sliced_ctx.event_storage.data.receiver = g_tasklet_id;
+    g_sliced_ctx.event_storage.data.event_type = FOTA_EVENT_EXECUTE_SLICE;
+    g_sliced_ctx.event_storage.data.data_ptr = NULL;
+
+    eventOS_event_send_user_allocated(&g_sliced_ctx.event_storage);
+
+    return FOTA_STATUS_SUCCESS;
+}
+
+void fota_event_handler_cancel_sliced(void)
+{
+    g_sliced_ctx.step = NULL;
+}
+
 void fota_event_handler_defer_with_result_ignore_busy(
     fota_deferred_result_callabck_t cb, int32_t status)
 {
@@ -30,6 +30,7 @@ extern "C" {
 
 typedef  void (*fota_deferred_data_callabck_t)(uint8_t *data, size_t size);
 typedef  void (*fota_deferred_result_callabck_t)(int32_t param);
+typedef  int (*fota_sliced_step_callback_t)(bool *done);
 
 /*
  * Initialize event handler
@@ -81,6 +82,24 @@ int fota_event_handler_defer_with_data_in_ms(
 void fota_event_handler_defer_with_result(
     fota_deferred_result_callabck_t cb, int32_t status);
 
+/*
+ * Run long work in slices of MBED_CLOUD_CLIENT_FOTA_SLICE_TIME_BUDGET milliseconds
+ *
+ * The step callback is called repeatedly, until it fails or sets done. Between the slices
+ * other events, such as CoAP retransmissions, get to run. With a budget of 0 all the steps
+ * run in this call. Only one sliced work can be active at a time.
+ *
+ * /param step[in] callback doing a small part of the work, sets done when all of it is done
+ * /param on_finish[in] callback called with the result of the last step
+ * \return FOTA_STATUS_SUCCESS on success.
+ */
+int fota_event_handler_run_sliced(fota_sliced_step_callback_t step, fota_deferred_result_callabck_t on_finish);
+
+/*
+ * Cancel the sliced work, its finish callback is not called
+ */
+void fota_event_handler_cancel_sliced(void);
+
 /*
  * Defer execution of a FOTA callback with error details
  * /param cb callback function pointer to be deferred
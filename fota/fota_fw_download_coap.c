@@ -29,6 +29,225 @@
 #include "fota/fota_fw_download.h"
 #include "fota/fota_source.h"
 
+#if (MBED_CLOUD_CLIENT_FOTA_COAP_DOWNLOAD_WINDOW > 1)
+
+#include <stdlib.h>
+#include <string.h>
+#include "fota/fota_internal.h"
+
+/*
+ * Fragments are requested ahead with plain Block2 GETs at the following offsets, so that
+ * a window of requests is in flight instead of paying a round trip per block. Each request
+ * is retransmitted by CoAP on its own, so a lost block does not stall the others.
+ * Fragments are passed to FOTA in order, the ones received ahead are buffered in their slot.
+ */
+
+typedef enum {
+    FOTA_DOWNLOAD_SLOT_FREE,
+    FOTA_DOWNLOAD_SLOT_REQUESTED,
+    FOTA_DOWNLOAD_SLOT_RECEIVED
+} fota_download_slot_state_e;
+
+typedef struct {
+    fota_download_slot_state_e state;
+    size_t offset;
+    size_t size;
+    size_t buf_size;
+    uint8_t *buf;
+} fota_download_slot_t;
+
+static struct {
+    bool active;
+    bool delivering;
+    const char *uri;
+    size_t first_offset;    // offset the download started from
+    size_t deliver_offset;  // offset FOTA expects next
+    size_t request_offset;  // next offset to request
+    size_t frag_size;       // full fragment size, 0 until known
+    size_t total_size;      // payload size, 0 until known
+    fota_download_slot_t slots[MBED_CLOUD_CLIENT_FOTA_COAP_DOWNLOAD_WINDOW];
+} fota_download_window;
+
+static fota_download_slot_t *find_slot(fota_download_slot_state_e state, size_t offset)
+{
+    for (int i = 0; i < MBED_CLOUD_CLIENT_FOTA_COAP_DOWNLOAD_WINDOW; i++) {
+        fota_download_slot_t *slot = &fota_download_window.slots[i];
+        if (slot->state == state && (state == FOTA_DOWNLOAD_SLOT_FREE || slot->offset == offset)) {
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+static int request_fragment(size_t offset)
+{
+    fota_download_slot_t *slot = find_slot(FOTA_DOWNLOAD_SLOT_FREE, 0);
+    if (!slot) {
+        return FOTA_STATUS_SUCCESS;
+    }
+    slot->state = FOTA_DOWNLOAD_SLOT_REQUESTED;
+    slot->offset = offset;
+    return fota_source_firmware_request_fragment(fota_download_window.uri, offset);
+}
+
+static int fill_window(void)
+{
+    int ret = FOTA_STATUS_SUCCESS;
+
+    // Drop fragments FOTA has moved past, they are not going to be asked for
+    for (int i = 0; i < MBED_CLOUD_CLIENT_FOTA_COAP_DOWNLOAD_WINDOW; i++) {
+        if (fota_download_window.slots[i].offset < fota_download_window.deliver_offset) {
+            fota_download_window.slots[i].state = FOTA_DOWNLOAD_SLOT_FREE;
+        }
+    }
+
+    // Until the fragment and payload sizes are known, fragments are requested one at a time
+    // as FOTA asks for them
+    if (!fota_download_window.frag_size || !fota_download_window.total_size) {
+        if (!find_slot(FOTA_DOWNLOAD_SLOT_REQUESTED, fota_download_window.deliver_offset) &&
+                !find_slot(FOTA_DOWNLOAD_SLOT_RECEIVED, fota_download_window.deliver_offset)) {
+            ret = request_fragment(fota_download_window.deliver_offset);
+        }
+        return ret;
+    }
+
+    // Restart from the expected fragment if it is not on the grid of the requested ones
+    if (!find_slot(FOTA_DOWNLOAD_SLOT_REQUESTED, fota_download_window.deliver_offset) &&
+            !find_slot(FOTA_DOWNLOAD_SLOT_RECEIVED, fota_download_window.deliver_offset)) {
+        fota_download_window.request_offset = fota_download_window.deliver_offset;
+    }
+
+    while (!ret && fota_download_window.request_offset < fota_download_window.total_size &&
+            find_slot(FOTA_DOWNLOAD_SLOT_FREE, 0)) {
+        size_t offset = fota_download_window.request_offset;
+        if (!find_slot(FOTA_DOWNLOAD_SLOT_REQUESTED, offset) && !find_slot(FOTA_DOWNLOAD_SLOT_RECEIVED, offset)) {
+            ret = request_fragment(offset);
+        }
+        fota_download_window.request_offset += fota_download_window.frag_size;
+    }
+    return ret;
+}
+
+static void deliver_fragments(void)
+{
+    // FOTA requests the next fragment from within fota_on_fragment(), before it is done
+    // with the current one, so the next one is only passed on after it returns
+    if (fota_download_window.delivering) {
+        return;
+    }
+
+    fota_download_slot_t *slot;
+    while (fota_download_window.active &&
+            (slot = find_slot(FOTA_DOWNLOAD_SLOT_RECEIVED, fota_download_window.deliver_offset))) {
+        // Slot can be requested again meanwhile, its buffer is only written when a fragment arrives
+        slot->state = FOTA_DOWNLOAD_SLOT_FREE;
+        fota_download_window.deliver_offset += slot->size;
+        fota_download_window.delivering = true;
+        fota_on_fragment(slot->buf, slot->size);
+        fota_download_window.delivering = false;
+    }
+}
+
+static void on_fragment(uint8_t *buf, size_t size, size_t offset, size_t total_size)
+{
+    fota_download_slot_t *slot = find_slot(FOTA_DOWNLOAD_SLOT_REQUESTED, offset);
+    if (!fota_download_window.active || !slot) {
+        FOTA_TRACE_DEBUG("Unexpected fragment at %zu - ignored", offset);
+        return;
+    }
+
+    if (!fota_download_window.total_size) {
+        fota_download_window.total_size = total_size;
+    }
+    // First fragment may be cut to the block boundary when resuming, the following ones are full
+    if (!fota_download_window.frag_size && offset != fota_download_window.first_offset &&
+            offset + size < fota_download_window.total_size) {
+        fota_download_window.frag_size = size;
+        fota_download_window.request_offset = offset + size;
+    }
+
+    if (offset == fota_download_window.deliver_offset && !fota_download_window.delivering) {
+        // Next one in order, pass it on without copying
+        slot->state = FOTA_DOWNLOAD_SLOT_FREE;
+        fota_download_window.deliver_offset += size;
+        fota_download_window.delivering = true;
+        fota_on_fragment(buf, size);
+        fota_download_window.delivering = false;
+    } else {
+        if (slot->buf_size < size) {
+            free(slot->buf);
+            slot->buf = malloc(size);
+            slot->buf_size = slot->buf ? size : 0;
+            if (!slot->buf) {
+                FOTA_TRACE_ERROR("FOTA fragment buffer allocation failed");
+                slot->state = FOTA_DOWNLOAD_SLOT_FREE;
+                fota_on_fragment_failure(FOTA_STATUS_OUT_OF_MEMORY);
+                return;
+            }
+        }
+        memcpy(slot->buf, buf, size);
+        slot->size = size;
+        slot->state = FOTA_DOWNLOAD_SLOT_RECEIVED;
+    }
+
+    deliver_fragments();
+    if (fota_download_window.active && fota_download_window.frag_size && fota_download_window.total_size &&
+            fill_window()) {
+        fota_on_fragment_failure(FOTA_STATUS_DOWNLOAD_FRAGMENT_FAILED);
+    }
+}
+
+int fota_download_init(void **download_handle)
+{
+    (void)download_handle;  // unused
+    memset(&fota_download_window, 0, sizeof(fota_download_window));
+    fota_source_set_fragment_handler(on_fragment);
+    return FOTA_STATUS_SUCCESS;
+}
+
+int fota_download_start(void *download_handle, const char *payload_url, size_t payload_offset)
+{
+    (void)download_handle;  // unused
+    fota_download_window.active = true;
+    fota_download_window.uri = payload_url;
+    fota_download_window.first_offset = payload_offset;
+    fota_download_window.deliver_offset = payload_offset;
+    fota_download_window.request_offset = payload_offset;
+    return fill_window();
+}
+
+int fota_download_request_next_fragment(void *download_handle, const char *payload_url, size_t payload_offset)
+{
+    (void)download_handle;  // unused
+    fota_download_window.uri = payload_url;
+    fota_download_window.deliver_offset = payload_offset;
+    if (fota_download_window.request_offset < payload_offset) {
+        fota_download_window.request_offset = payload_offset;
+    }
+
+    int ret = fill_window();
+    if (!ret) {
+        // Fragment may have arrived already while FOTA was busy elsewhere
+        deliver_fragments();
+    }
+    return ret;
+}
+
+void fota_download_deinit(void **download_handle)
+{
+    fota_source_set_fragment_handler(NULL);
+    for (int i = 0; i < MBED_CLOUD_CLIENT_FOTA_COAP_DOWNLOAD_WINDOW; i++) {
+        free(fota_download_window.slots[i].buf);
+        fota_download_window.slots[i].buf = NULL;
+        fota_download_window.slots[i].buf_size = 0;
+        fota_download_window.slots[i].state = FOTA_DOWNLOAD_SLOT_FREE;
+    }
+    fota_download_window.active = false;
+    *download_handle = NULL;
+}
+
+#else  // MBED_CLOUD_CLIENT_FOTA_COAP_DOWNLOAD_WINDOW > 1
+
 int fota_download_init(void **download_handle)
 {
     (void)download_handle;  // unused
@@ -52,6 +271,7 @@ void fota_download_deinit(void **download_handle)
     *download_handle = NULL;
 }
 
+#endif  // MBED_CLOUD_CLIENT_FOTA_COAP_DOWNLOAD_WINDOW > 1
 
 #endif  // MBED_CLOUD_CLIENT_FOTA_DOWNLOAD == MBED_CLOUD_CLIENT_FOTA_COAP_DOWNLOAD
 
@@ -27,17 +27,46 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
 #include "fota/fota_internal.h"
 #include "fota/fota_fw_download.h"
 #include "curl/curl.h"
 
+// Single stream download, tracks the payload offset so that another URL can continue from it
+typedef struct {
+    CURL *handle;
+    size_t offset;
+    bool check_range;
+} stream_download_t;
+
 static size_t handle_data_callback(void *buf, size_t size, size_t nmemb, void *stream)
 {
+    stream_download_t *download = (stream_download_t *) stream;
     size_t real_data_size = size * nmemb;
+
+    if (download->check_range) {
+        long response_code = 0;
+
+        // Peer ignoring the range header would send the payload from the start
+        curl_easy_getinfo(download->handle, CURLINFO_RESPONSE_CODE, &response_code);
+        if ((download->offset > 0) && (response_code != 206)) {
+            return 0;
+        }
+        download->check_range = false;
+    }
+
     fota_on_fragment(buf, real_data_size);
+    download->offset += real_data_size;
     return real_data_size;
 }
 
+static bool is_downloading(void)
+{
+    fota_context_t *fota_ctx = fota_get_context();
+    return fota_ctx && (fota_ctx->state == FOTA_STATE_DOWNLOADING);
+}
+
 int fota_download_init(void **download_handle)
 {
     int ret = curl_global_init(CURL_GLOBAL_ALL);
@@ -59,41 +88,62 @@ fail:
     return FOTA_STATUS_INTERNAL_ERROR;
 }
 
-int fota_download_start(void *download_handle, const char *payload_url, size_t payload_offset)
+static int set_common_options(CURL *handle, const char *payload_url)
 {
     int res;
 
     // set URL to get here
-    res = curl_easy_setopt(download_handle, CURLOPT_URL, payload_url);
+    res = curl_easy_setopt(handle, CURLOPT_URL, payload_url);
     if (res != CURLE_OK) {
         FOTA_TRACE_ERROR("curl setopt url failed with error %d", res);
         return FOTA_STATUS_INTERNAL_ERROR;
     }
 
     // Switch on full protocol/debug output while testing
-    res = curl_easy_setopt(download_handle, CURLOPT_VERBOSE, 0L);
+    res = curl_easy_setopt(handle, CURLOPT_VERBOSE, 0L);
     if (res != CURLE_OK) {
         FOTA_TRACE_ERROR("curl setopt verbose failed with error %d", res);
         return FOTA_STATUS_INTERNAL_ERROR;
     }
 
     // disable progress meter, set to 0L to enable it
-    res = curl_easy_setopt(download_handle, CURLOPT_NOPROGRESS, 1L);
+    res = curl_easy_setopt(handle, CURLOPT_NOPROGRESS, 1L);
     if (res != CURLE_OK) {
         FOTA_TRACE_ERROR("curl setopt no progress failed with error %d", res);
         return FOTA_STATUS_INTERNAL_ERROR;
     }
 
-    res = curl_easy_setopt(download_handle, CURLOPT_BUFFERSIZE, MBED_CLOUD_CLIENT_FOTA_CURL_PAYLOAD_SIZE);
+    res = curl_easy_setopt(handle, CURLOPT_BUFFERSIZE, MBED_CLOUD_CLIENT_FOTA_CURL_PAYLOAD_SIZE);
     if (res != CURLE_OK) {
         FOTA_TRACE_ERROR("curl setopt buffer size failed with error %d", res);
         return FOTA_STATUS_INTERNAL_ERROR;
     }
 
+    return FOTA_STATUS_SUCCESS;
+}
+
+static int download_single_stream(void *download_handle, const char *payload_url, size_t *payload_offset,
+                                  bool from_peer)
+{
+    stream_download_t download = { download_handle, *payload_offset, from_peer };
+    int res;
+
+    res = set_common_options(download_handle, payload_url);
+    if (res) {
+        return res;
+    }
+
+    // An error page from the peer must not be taken as payload
+    res = curl_easy_setopt(download_handle, CURLOPT_FAILONERROR, from_peer ? 1L : 0L);
+    if (res != CURLE_OK) {
+        FOTA_TRACE_ERROR("curl setopt fail on error failed with error %d", res);
+        return FOTA_STATUS_INTERNAL_ERROR;
+    }
+
     // resuming upload at this position, possibly beyond 2GB
     // curl_easy_setopt(curl, CURLOPT_RESUME_FROM_LARGE, resume_position);
     // currently using regular one, resume still at debugging
-    res = curl_easy_setopt(download_handle, CURLOPT_RESUME_FROM, payload_offset);
+    res = curl_easy_setopt(download_handle, CURLOPT_RESUME_FROM, (long) *payload_offset);
     if (res != CURLE_OK) {
         FOTA_TRACE_ERROR("curl setopt resume from failed with error %d", res);
         return FOTA_STATUS_INTERNAL_ERROR;
@@ -106,15 +156,286 @@ int fota_download_start(void *download_handle, const char *payload_url, size_t p
         return FOTA_STATUS_INTERNAL_ERROR;
     }
 
+    res = curl_easy_setopt(download_handle, CURLOPT_WRITEDATA, &download);
+    if (res != CURLE_OK) {
+        FOTA_TRACE_ERROR("curl setopt data failed with error %d", res);
+        return FOTA_STATUS_INTERNAL_ERROR;
+    }
+
     // get it
     res = curl_easy_perform(download_handle);
+    *payload_offset = download.offset;
     if (res != CURLE_OK) {
         FOTA_TRACE_ERROR("curl start downloading failed with error %d", res);
         return FOTA_STATUS_INTERNAL_ERROR;
     }
 
     return FOTA_STATUS_SUCCESS;
+}
+
+#if (MBED_CLOUD_CLIENT_FOTA_CURL_PARALLEL_CONNECTIONS > 1)
+
+// One range request of the parallel download. Ranges may complete out of order,
+// each is buffered until all ranges before it have been passed to FOTA.
+typedef struct {
+    CURL *handle;
+    uint8_t *buf;
+    size_t start;
+    size_t size;
+    size_t received;
+    size_t delivered;
+    bool active;
+    bool range_unsupported;
+} range_download_t;
+
+static size_t handle_range_data_callback(void *buf, size_t size, size_t nmemb, void *stream)
+{
+    range_download_t *range = (range_download_t *) stream;
+    size_t real_data_size = size * nmemb;
+    long response_code = 0;
+
+    // Server ignoring the range header sends the whole payload with 200
+    curl_easy_getinfo(range->handle, CURLINFO_RESPONSE_CODE, &response_code);
+    if ((response_code != 206) || (range->received + real_data_size > range->size)) {
+        range->range_unsupported = true;
+        return 0;
+    }
+
+    memcpy(range->buf + range->received, buf, real_data_size);
+    range->received += real_data_size;
+    return real_data_size;
+}
+
+static int start_range(CURLM *multi_handle, range_download_t *range, const char *payload_url,
+                       size_t start, size_t payload_size)
+{
+    char range_str[2 * 20 + 2];
+    int res;
+
+    range->start = start;
+    range->size = MIN(MBED_CLOUD_CLIENT_FOTA_CURL_RANGE_SIZE, payload_size - start);
+    range->received = 0;
+    range->delivered = 0;
+
+    snprintf(range_str, sizeof(range_str), "%zu-%zu", start, start + range->size - 1);
+
+    res = set_common_options(range->handle, payload_url);
+    if (res) {
+        return res;
+    }
+
+    // curl copies the string
+    res = curl_easy_setopt(range->handle, CURLOPT_RANGE, range_str);
+    if (res != CURLE_OK) {
+        FOTA_TRACE_ERROR("curl setopt range failed with error %d", res);
+        return FOTA_STATUS_INTERNAL_ERROR;
+    }
+
+    res = curl_easy_setopt(range->handle, CURLOPT_WRITEFUNCTION, handle_range_data_callback);
+    if (res != CURLE_OK) {
+        FOTA_TRACE_ERROR("curl setopt data callback failed with error %d", res);
+        return FOTA_STATUS_INTERNAL_ERROR;
+    }
+
+    res = curl_easy_setopt(range->handle, CURLOPT_WRITEDATA, range);
+    if (res != CURLE_OK) {
+        FOTA_TRACE_ERROR("curl setopt data failed with error %d", res);
+        return FOTA_STATUS_INTERNAL_ERROR;
+    }
+
+    res = curl_multi_add_handle(multi_handle, range->handle);
+    if (res != CURLM_OK) {
+        FOTA_TRACE_ERROR("curl multi add handle failed with error %d", res);
+        return FOTA_STATUS_INTERNAL_ERROR;
+    }
+    range->active = true;
+
+    return FOTA_STATUS_SUCCESS;
+}
+
+// Range holding the data at offset, which hasn't been passed to FOTA yet
+static range_download_t *find_range(range_download_t *ranges, size_t offset)
+{
+    for (uint32_t i = 0; i < MBED_CLOUD_CLIENT_FOTA_CURL_PARALLEL_CONNECTIONS; i++) {
+        if ((ranges[i].delivered < ranges[i].size) && (ranges[i].start + ranges[i].delivered == offset)) {
+            return &ranges[i];
+        }
+    }
+    return NULL;
+}
+
+// Returns FOTA_STATUS_SUCCESS with *delivered_offset set to the end of data passed to FOTA.
+// Download from there continues in a single stream if server does not support ranges.
+static int download_parallel(const char *payload_url, size_t payload_offset, size_t payload_size,
+                             size_t *delivered_offset, bool *range_unsupported)
+{
+    range_download_t ranges[MBED_CLOUD_CLIENT_FOTA_CURL_PARALLEL_CONNECTIONS];
+    CURLM *multi_handle;
+    size_t next_start = payload_offset;
+    int running, queued;
+    int ret = FOTA_STATUS_SUCCESS;
+    int res;
+    uint32_t i;
+
+    *delivered_offset = payload_offset;
+    *range_unsupported = false;
+    memset(ranges, 0, sizeof(ranges));
+
+    multi_handle = curl_multi_init();
+    if (!multi_handle) {
+        FOTA_TRACE_ERROR("curl multi init failed");
+        return FOTA_STATUS_INTERNAL_ERROR;
+    }
+
+    for (i = 0; i < MBED_CLOUD_CLIENT_FOTA_CURL_PARALLEL_CONNECTIONS; i++) {
+        ranges[i].handle = curl_easy_init();
+        ranges[i].buf = malloc(MBED_CLOUD_CLIENT_FOTA_CURL_RANGE_SIZE);
+        if (!ranges[i].handle || !ranges[i].buf) {
+            FOTA_TRACE_ERROR("curl range download - allocation failed");
+            ret = FOTA_STATUS_OUT_OF_MEMORY;
+            goto end;
+        }
+    }
+
+    while (*delivered_offset < payload_size) {
+        // Keep all connections busy, but never further ahead than the reassembly window
+        for (i = 0; i < MBED_CLOUD_CLIENT_FOTA_CURL_PARALLEL_CONNECTIONS; i++) {
+            if (!ranges[i].active && (ranges[i].delivered == ranges[i].size) && (next_start < payload_size)) {
+                ret = start_range(multi_handle, &ranges[i], payload_url, next_start, payload_size);
+                if (ret) {
+                    goto end;
+                }
+                next_start += ranges[i].size;
+            }
+        }
+
+        res = curl_multi_perform(multi_handle, &running);
+        if (res != CURLM_OK) {
+            FOTA_TRACE_ERROR("curl multi perform failed with error %d", res);
+            ret = FOTA_STATUS_INTERNAL_ERROR;
+            goto end;
+        }
+
+        CURLMsg *msg;
+        while ((msg = curl_multi_info_read(multi_handle, &queued))) {
+            if (msg->msg != CURLMSG_DONE) {
+                continue;
+            }
+            for (i = 0; i < MBED_CLOUD_CLIENT_FOTA_CURL_PARALLEL_CONNECTIONS; i++) {
+                if (ranges[i].handle == msg->easy_handle) {
+                    break;
+                }
+            }
+            FOTA_DBG_ASSERT(i < MBED_CLOUD_CLIENT_FOTA_CURL_PARALLEL_CONNECTIONS);
+            curl_multi_remove_handle(multi_handle, msg->easy_handle);
+            ranges[i].active = false;
+            if (ranges[i].range_unsupported) {
+                FOTA_TRACE_INFO("Server does not support range requests, using single stream");
+                *range_unsupported = true;
+                goto end;
+            }
+            if ((msg->data.result != CURLE_OK) || (ranges[i].received != ranges[i].size)) {
+                FOTA_TRACE_ERROR("curl range download failed with error %d", msg->data.result);
+                ret = FOTA_STATUS_DOWNLOAD_FRAGMENT_FAILED;
+                goto end;
+            }
+        }
+
+        // Pass the contiguous prefix to FOTA
+        range_download_t *range;
+        while ((range = find_range(ranges, *delivered_offset)) && (range->delivered < range->received)) {
+            size_t frag_size = MIN(MBED_CLOUD_CLIENT_FOTA_CURL_PAYLOAD_SIZE, range->received - range->delivered);
+            fota_on_fragment(range->buf + range->delivered, frag_size);
+            range->delivered += frag_size;
+            *delivered_offset += frag_size;
+            if (!is_downloading()) {
+                // Aborted or finished
+                goto end;
+            }
+        }
+
+        if (running) {
+            res = curl_multi_wait(multi_handle, NULL, 0, 1000, NULL);
+            if (res != CURLM_OK) {
+                FOTA_TRACE_ERROR("curl multi wait failed with error %d", res);
+                ret = FOTA_STATUS_INTERNAL_ERROR;
+                goto end;
+            }
+        }
+    }
+
+end:
+    for (i = 0; i < MBED_CLOUD_CLIENT_FOTA_CURL_PARALLEL_CONNECTIONS; i++) {
+        if (ranges[i].handle) {
+            if (ranges[i].active) {
+                curl_multi_remove_handle(multi_handle, ranges[i].handle);
+            }
+            curl_easy_cleanup(ranges[i].handle);
+        }
+        free(ranges[i].buf);
+    }
+    curl_multi_cleanup(multi_handle);
+    return ret;
+}
+
+#endif // (MBED_CLOUD_CLIENT_FOTA_CURL_PARALLEL_CONNECTIONS > 1)
+
+static int download_url(void *download_handle, const char *url, size_t *payload_offset, bool from_peer)
+{
+#if (MBED_CLOUD_CLIENT_FOTA_CURL_PARALLEL_CONNECTIONS > 1)
+    fota_context_t *fota_ctx = fota_get_context();
+    bool range_unsupported;
+    int ret;
+
+    FOTA_DBG_ASSERT(fota_ctx);
+    ret = download_parallel(url, *payload_offset, fota_ctx->fw_info->payload_size,
+                            payload_offset, &range_unsupported);
+    if (ret || !range_unsupported) {
+        return ret;
+    }
+#endif
+
+    return download_single_stream(download_handle, url, payload_offset, from_peer);
+}
+
+#if defined(MBED_CLOUD_CLIENT_FOTA_CURL_PEER_CACHE_URL)
+
+// Peer URL for the payload: the peer cache base URL followed by the path of the cloud URL
+static int make_peer_url(const char *payload_url, char *peer_url, size_t peer_url_size)
+{
+    const char *path = strstr(payload_url, "://");
+
+    path = path ? strchr(path + 3, '/') : NULL;
+    if (!path) {
+        return FOTA_STATUS_INVALID_ARGUMENT;
+    }
+
+    int len = snprintf(peer_url, peer_url_size, "%s%s", MBED_CLOUD_CLIENT_FOTA_CURL_PEER_CACHE_URL, path);
+    if ((len < 0) || ((size_t) len >= peer_url_size)) {
+        return FOTA_STATUS_INVALID_ARGUMENT;
+    }
+
+    return FOTA_STATUS_SUCCESS;
+}
+
+#endif // defined(MBED_CLOUD_CLIENT_FOTA_CURL_PEER_CACHE_URL)
+
+int fota_download_start(void *download_handle, const char *payload_url, size_t payload_offset)
+{
+#if defined(MBED_CLOUD_CLIENT_FOTA_CURL_PEER_CACHE_URL)
+    char peer_url[sizeof(MBED_CLOUD_CLIENT_FOTA_CURL_PEER_CACHE_URL) + FOTA_MANIFEST_URI_SIZE];
+
+    // The payload is still checked against the manifest digest, so the peer needs no trust
+    if (make_peer_url(payload_url, peer_url, sizeof(peer_url)) == FOTA_STATUS_SUCCESS) {
+        int ret = download_url(download_handle, peer_url, &payload_offset, true);
+        if (!ret || !is_downloading()) {
+            return ret;
+        }
+        FOTA_TRACE_INFO("Peer cache download stopped at %zu, continuing from the cloud", payload_offset);
+    }
+#endif
 
+    return download_url(download_handle, payload_url, &payload_offset, false);
 }
 
 int fota_download_request_next_fragment(void *download_handle, const char *payload_url, size_t payload_offset)
@@ -26,6 +26,7 @@
 #include "fota/fota_manifest.h"
 #include "fota/fota_app_ifs.h"
 #include "fota/fota_delta.h"
+#include "fota/fota_decompress.h"
 #include "fota/fota_header_info.h"
 #include "fota/fota_crypto.h"
 #include "fota/fota_component.h"
@@ -61,6 +62,11 @@ typedef enum {
 // The encryption block size used to encrypt payload by the cloud
 #define FOTA_CLOUD_ENCRYPTION_BLOCK_SIZE 1024
 
+// Payload formats unpacked on device (delta, compressed), which have a separate installed FW digest
+#if !defined(FOTA_DISABLE_DELTA) || (MBED_CLOUD_CLIENT_FOTA_COMPRESSED_PAYLOAD_SUPPORT == 1)
+#define FOTA_UNPACKED_PAYLOAD_SUPPORT 1
+#endif
+
 // Internal component for BR downloader (must start with '%' as it's internal)
 #define FOTA_MULTICAST_BR_INT_COMP_NAME "%MC_BR"
 
@@ -75,12 +81,16 @@ typedef struct {
     uint8_t *delta_buf;
     fota_delta_ctx_t *delta_ctx;
 #endif
+#if (MBED_CLOUD_CLIENT_FOTA_COMPRESSED_PAYLOAD_SUPPORT == 1)
+    uint8_t *decompress_buf;
+    fota_decompress_ctx_t *decompress_ctx;
+#endif
 #if (MBED_CLOUD_CLIENT_FOTA_ENCRYPTION_SUPPORT == 1)
     fota_encrypt_context_t *enc_ctx;
     uint8_t encryption_key[FOTA_ENCRYPT_KEY_SIZE];
 #endif
     fota_hash_context_t *payload_hash_ctx;
-#if !defined(FOTA_DISABLE_DELTA)
+#if defined(FOTA_UNPACKED_PAYLOAD_SUPPORT)
     fota_hash_context_t *installed_hash_ctx;
 #endif
     uint8_t *page_buf;
@@ -94,6 +104,18 @@ typedef struct {
     uint32_t candidate_header_size;
     fota_resume_state_e resume_state;
     void *download_handle;
+#if (MBED_CLOUD_CLIENT_FOTA_ERASE_AHEAD_SIZE > 0)
+    // Storage is erased during download, up to erased_addr (sector aligned)
+    bool erase_ahead;
+    size_t erased_addr;
+#endif
+#if defined(FOTA_RESUME_HASH_CHECKPOINT)
+    // Payload hash at the block boundary of a pending checkpoint, saved once that block is programmed
+    fota_hash_context_t *checkpoint_hash_ctx;
+    size_t checkpoint_offset;
+    size_t next_checkpoint_offset;
+    bool checkpoint_pending;
+#endif
 #if (MBED_CLOUD_CLIENT_FOTA_MULTICAST_SUPPORT == FOTA_MULTICAST_BR_MODE)
     // Tells that this is a Multicast BR mode update on a BR (unlike unicast update to the BR itself)
     bool mc_br_update;
@@ -40,6 +40,7 @@ extern "C" {
 #define FOTA_MANIFEST_PAYLOAD_FORMAT_RAW             0x0001
 #define FOTA_MANIFEST_PAYLOAD_FORMAT_DELTA           0x0005
 //  V3 only
+#define FOTA_MANIFEST_PAYLOAD_FORMAT_COMPRESSED_RAW  0x0006
 #define FOTA_MANIFEST_PAYLOAD_FORMAT_ENCRYPTED_RAW   0x0101
 #define FOTA_MANIFEST_PAYLOAD_FORMAT_ENCRYPTED_DELTA 0x0105 // not supported yet
 
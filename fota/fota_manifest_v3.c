@@ -117,7 +117,8 @@ cleanup:
  *    precursor-digest OCTET STRING OPTIONAL
  *  }
  */
-#if !defined(FOTA_DISABLE_DELTA) || (MBED_CLOUD_CLIENT_FOTA_ENCRYPTION_SUPPORT == 1)
+#if !defined(FOTA_DISABLE_DELTA) || (MBED_CLOUD_CLIENT_FOTA_ENCRYPTION_SUPPORT == 1) || \
+    (MBED_CLOUD_CLIENT_FOTA_COMPRESSED_PAYLOAD_SUPPORT == 1)
 static int parse_payload_metadata(
     const uint8_t *metadata, size_t metadata_size,
     manifest_firmware_info_t *fw_info, const uint8_t *input_data
@@ -174,7 +175,7 @@ static int parse_payload_metadata(
     return FOTA_STATUS_SUCCESS;
 
 }
-#endif // !FOTA_DISABLE_DELTA || (MBED_CLOUD_CLIENT_FOTA_ENCRYPTION_SUPPORT == 1)
+#endif // !FOTA_DISABLE_DELTA || (MBED_CLOUD_CLIENT_FOTA_ENCRYPTION_SUPPORT == 1) || (MBED_CLOUD_CLIENT_FOTA_COMPRESSED_PAYLOAD_SUPPORT == 1)
 
 
 /*
@@ -200,6 +201,7 @@ static int parse_payload_metadata(
  *      -- 01xx-FFxx describe encrypted-format
  *      raw-binary(1),
  *      arm-patch-stream(5),
+ *      lz4-compressed-raw(6),
  *      encrypted-raw(257),  -- 0x0101
  *      encrypted-patch(261) -- 0x0105
  *    },
@@ -207,7 +209,7 @@ static int parse_payload_metadata(
  *    -- raw ECDSA signature (r||s) over installed payload
  *    installed-signature OCTET STRING,
  *
- *    -- Used with 'arm-patch-stream', 'encrypted-raw' and 'encrypted-patch'
+ *    -- Used with 'arm-patch-stream', 'lz4-compressed-raw', 'encrypted-raw' and 'encrypted-patch'
  *    -- never for 'raw-binary'
  *    payload-metadata PayloadMetadata OPTIONAL,
  *
@@ -370,6 +372,9 @@ int parse_manifest_internal(
 
 #if !defined(FOTA_DISABLE_DELTA)
         case FOTA_MANIFEST_PAYLOAD_FORMAT_DELTA:
+#endif
+#if (MBED_CLOUD_CLIENT_FOTA_COMPRESSED_PAYLOAD_SUPPORT == 1)
+        case FOTA_MANIFEST_PAYLOAD_FORMAT_COMPRESSED_RAW:
 #endif
             break;
 #if (MBED_CLOUD_CLIENT_FOTA_ENCRYPTION_SUPPORT == 1)
@@ -406,7 +411,8 @@ int parse_manifest_internal(
         FOTA_MANIFEST_TRACE_DEBUG("installed-signature not found ptr=%p", p);
     }
 
-#if !defined(FOTA_DISABLE_DELTA) || (MBED_CLOUD_CLIENT_FOTA_ENCRYPTION_SUPPORT == 1)
+#if !defined(FOTA_DISABLE_DELTA) || (MBED_CLOUD_CLIENT_FOTA_ENCRYPTION_SUPPORT == 1) || \
+    (MBED_CLOUD_CLIENT_FOTA_COMPRESSED_PAYLOAD_SUPPORT == 1)
     if (fw_info->payload_format != FOTA_MANIFEST_PAYLOAD_FORMAT_RAW) {
         FOTA_MANIFEST_TRACE_DEBUG("Parse Manifest:payload-metadata @%d",  p - input_data);
         tls_status = mbedtls_asn1_get_tag(
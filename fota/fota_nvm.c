@@ -129,6 +129,42 @@ int fota_nvm_fw_encryption_key_delete(void)
     return fota_nvm_remove(FOTA_ENCRYPT_KEY, CCS_SYMMETRIC_KEY_ITEM);
 }
 #endif  // !defined(FOTA_KEY_ENCRYPTION_EXTERNAL_STORAGE)
+
+#if defined(FOTA_RESUME_HASH_CHECKPOINT)
+int fota_nvm_hash_checkpoint_get(uint8_t *buffer, size_t buffer_size, size_t *bytes_read)
+{
+    return fota_nvm_get(FOTA_HASH_CHECKPOINT_KEY, buffer, buffer_size, bytes_read, CCS_CONFIG_ITEM);
+}
+
+int fota_nvm_hash_checkpoint_set(const uint8_t *buffer, size_t buffer_size)
+{
+    return fota_nvm_set(FOTA_HASH_CHECKPOINT_KEY, buffer, buffer_size, CCS_CONFIG_ITEM);
+}
+
+int fota_nvm_hash_checkpoint_delete(void)
+{
+    fota_nvm_remove(FOTA_HASH_CHECKPOINT_KEY, CCS_CONFIG_ITEM);
+    return FOTA_STATUS_SUCCESS;
+}
+#endif // defined(FOTA_RESUME_HASH_CHECKPOINT)
+
+#if defined(FOTA_DEFERRED_REBOOT)
+int fota_nvm_pending_components_get(uint8_t *buffer, size_t buffer_size, size_t *bytes_read)
+{
+    return fota_nvm_get(FOTA_PENDING_COMPONENTS_KEY, buffer, buffer_size, bytes_read, CCS_CONFIG_ITEM);
+}
+
+int fota_nvm_pending_components_set(const uint8_t *buffer, size_t buffer_size)
+{
+    return fota_nvm_set(FOTA_PENDING_COMPONENTS_KEY, buffer, buffer_size, CCS_CONFIG_ITEM);
+}
+
+int fota_nvm_pending_components_delete(void)
+{
+    fota_nvm_remove(FOTA_PENDING_COMPONENTS_KEY, CCS_CONFIG_ITEM);
+    return FOTA_STATUS_SUCCESS;
+}
+#endif // defined(FOTA_DEFERRED_REBOOT)
 /******************************************************************************************************/
 /*                        Update x509 Certificate                                                     */
 /******************************************************************************************************/
@@ -123,6 +123,66 @@ int fota_nvm_manifest_set(const uint8_t *buffer, size_t size);
 
 int fota_nvm_manifest_delete(void);
 
+#if defined(FOTA_RESUME_HASH_CHECKPOINT)
+/**
+ * Get saved payload hash checkpoint.
+ *
+ * \param[out] buffer buffer for returning the checkpoint.
+ * \param[in]  buffer_size Buffer size available for reading the checkpoint.
+ * \param[out] bytes_read  Actual checkpoint size.
+ *
+ * \return FOTA_STATUS_SUCCESS on success.
+ */
+int fota_nvm_hash_checkpoint_get(uint8_t *buffer, size_t size, size_t *bytes_read);
+
+/**
+ * Save payload hash checkpoint - used for resuming interrupted updates without hashing all stored data.
+ *
+ * \param[in] buffer buffer with the checkpoint.
+ * \param[in] buffer_size Buffer size.
+ *
+ * \return FOTA_STATUS_SUCCESS on success.
+ */
+int fota_nvm_hash_checkpoint_set(const uint8_t *buffer, size_t size);
+
+/**
+ * Delete saved payload hash checkpoint.
+ *
+ * \return FOTA_STATUS_SUCCESS on success.
+ */
+int fota_nvm_hash_checkpoint_delete(void);
+#endif // defined(FOTA_RESUME_HASH_CHECKPOINT)
+
+#if defined(FOTA_DEFERRED_REBOOT)
+/**
+ * Get the components installed with their reboot deferred.
+ *
+ * \param[out] buffer buffer for returning the components.
+ * \param[in]  buffer_size Buffer size available for reading the components.
+ * \param[out] bytes_read  Actual size of the components.
+ *
+ * \return FOTA_STATUS_SUCCESS on success.
+ */
+int fota_nvm_pending_components_get(uint8_t *buffer, size_t size, size_t *bytes_read);
+
+/**
+ * Save the components installed with their reboot deferred - verified after the next reboot.
+ *
+ * \param[in] buffer buffer with the components.
+ * \param[in] buffer_size Buffer size.
+ *
+ * \return FOTA_STATUS_SUCCESS on success.
+ */
+int fota_nvm_pending_components_set(const uint8_t *buffer, size_t size);
+
+/**
+ * Delete the components installed with their reboot deferred.
+ *
+ * \return FOTA_STATUS_SUCCESS on success.
+ */
+int fota_nvm_pending_components_delete(void);
+#endif // defined(FOTA_DEFERRED_REBOOT)
+
 #if defined(MBED_CLOUD_DEV_UPDATE_ID)
 
 int fota_nvm_update_class_id_set(void);
@@ -52,6 +52,8 @@ typedef const char * cloud_client_param;
 #define FOTA_ENCRYPT_KEY                        "FOTA_ENCRYPT_KEY" // "FTEncryptKey"
 #define FOTA_SALT_KEY                           "FOTA_SALT_KEY" // ""FTSaltKey"
 #define FOTA_MANIFEST_KEY                       "FOTA_MANIFEST_KEY" // ""FTManKey"
+#define FOTA_HASH_CHECKPOINT_KEY                "FOTA_HASH_CP_KEY"
+#define FOTA_PENDING_COMPONENTS_KEY             "FOTA_PEND_COMP_KEY"
 #define FOTA_COMP_VER_BASE                      "FTCmpV"
 
 #endif  // (MBED_CLOUD_CLIENT_PROFILE == MBED_CLOUD_CLIENT_PROFILE_LITE)
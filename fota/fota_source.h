@@ -56,6 +56,14 @@ int fota_source_add_component(unsigned int comp_id, const char *name, const char
 int fota_source_deinit(void);
 int fota_source_firmware_request_fragment(const char *uri, size_t offset);
 
+/*
+ * Fragment handler, gets the fragments requested with fota_source_firmware_request_fragment()
+ * together with their offset and the total payload size (0 if not known).
+ * Fragments are passed to fota_on_fragment() when no handler is set.
+ */
+typedef void (*fota_source_fragment_handler_t)(uint8_t *buf, size_t size, size_t offset, size_t total_size);
+void fota_source_set_fragment_handler(fota_source_fragment_handler_t handler);
+
 typedef void (*report_sent_callback_t)(void);
 int fota_source_report_state(fota_source_state_e state, report_sent_callback_t on_sent, report_sent_callback_t on_failure);
 int fota_source_report_update_result(int result);
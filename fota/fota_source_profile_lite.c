@@ -669,6 +669,13 @@ int fota_source_report_update_result(int result)
 #endif
 }
 
+static fota_source_fragment_handler_t fragment_handler = NULL;
+
+void fota_source_set_fragment_handler(fota_source_fragment_handler_t handler)
+{
+    fragment_handler = handler;
+}
+
 static void data_req_callback(const uint8_t *buffer, size_t buffer_size, size_t total_size, bool last_block,
                               void *context)
 {
@@ -683,7 +690,11 @@ static void data_req_callback(const uint8_t *buffer, size_t buffer_size, size_t
         }
         // removing const qualifier here allows FOTA the manipulation of fragment data in place (like encryption).
         // TODO: Need to decide whether this is legit. If so, all preceding LWM2M calls should also remove this qualifier.
-        fota_on_fragment((uint8_t *)buffer, buffer_size);
+        if (fragment_handler) {
+            fragment_handler((uint8_t *)buffer, buffer_size, offset, total_size);
+        } else {
+            fota_on_fragment((uint8_t *)buffer, buffer_size);
+        }
     } else {
         FOTA_TRACE_ERROR("Fragment received ignored - FOTA not ready");
     }
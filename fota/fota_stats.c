@@ -0,0 +1,106 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 Pelion Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+#include "fota/fota_base.h"
+
+#ifdef MBED_CLOUD_CLIENT_FOTA_ENABLE
+
+#include "fota/fota_stats.h"
+
+#if (MBED_CLOUD_CLIENT_FOTA_STATS == 1)
+
+#define TRACE_GROUP "FOTA"
+
+#include <inttypes.h>
+#include <string.h>
+#include "pal.h"
+
+#if defined(__MBED__)
+#include "platform/mbed_stats.h"
+#endif
+
+typedef struct {
+    uint64_t ticks;
+    uint64_t bytes;
+} fota_stats_entry_t;
+
+static const char *const stage_names[FOTA_STATS_NUM_STAGES] = {
+    "fragment", "hash", "unpack", "encrypt", "program"
+};
+
+static fota_stats_entry_t stats[FOTA_STATS_NUM_STAGES];
+static uint64_t download_start_ticks;
+
+static uint64_t ticks_to_us(uint64_t ticks)
+{
+    uint64_t freq = pal_osKernelSysTickFrequency();
+    return freq ? (ticks * 1000000) / freq : 0;
+}
+
+void fota_stats_reset(void)
+{
+    memset(stats, 0, sizeof(stats));
+    download_start_ticks = pal_osKernelSysTick();
+}
+
+uint64_t fota_stats_start(void)
+{
+    return pal_osKernelSysTick();
+}
+
+void fota_stats_add(fota_stats_stage_e stage, uint64_t start, size_t bytes)
+{
+    stats[stage].ticks += pal_osKernelSysTick() - start;
+    stats[stage].bytes += bytes;
+}
+
+void fota_stats_report(void)
+{
+    uint64_t total_us = ticks_to_us(pal_osKernelSysTick() - download_start_ticks);
+
+    // bytes per microsecond is MB/s, traced in KB/s to keep integer precision
+    FOTA_TRACE_INFO("Download: %" PRIu64 " bytes in %" PRIu64 " ms, %" PRIu64 " KB/s",
+                    stats[FOTA_STATS_FRAGMENT].bytes, total_us / 1000,
+                    total_us ? (stats[FOTA_STATS_FRAGMENT].bytes * 1000) / total_us : 0);
+    (void) total_us;  // unused when traces are disabled
+
+    for (int i = 0; i < FOTA_STATS_NUM_STAGES; i++) {
+        uint64_t us = ticks_to_us(stats[i].ticks);
+        if (!stats[i].bytes) {
+            continue;
+        }
+        FOTA_TRACE_INFO("Stage %s: %" PRIu64 " bytes in %" PRIu64 " ms, %" PRIu64 " KB/s",
+                        stage_names[i], stats[i].bytes, us / 1000,
+                        us ? (stats[i].bytes * 1000) / us : 0);
+        (void) us;
+    }
+
+#if defined(MBED_HEAP_STATS_ENABLED) && MBED_HEAP_STATS_ENABLED
+    mbed_stats_heap_t heap_stats;
+    mbed_stats_heap_get(&heap_stats);
+    FOTA_TRACE_INFO("Peak heap: %" PRIu32 " bytes", heap_stats.max_size);
+#endif
+#if defined(MBED_STACK_STATS_ENABLED) && MBED_STACK_STATS_ENABLED
+    mbed_stats_stack_t stack_stats;
+    mbed_stats_stack_get(&stack_stats);
+    FOTA_TRACE_INFO("Peak stack: %" PRIu32 " bytes", stack_stats.max_size);
+#endif
+}
+
+#endif // (MBED_CLOUD_CLIENT_FOTA_STATS == 1)
+
+#endif // MBED_CLOUD_CLIENT_FOTA_ENABLE
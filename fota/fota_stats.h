@@ -0,0 +1,88 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 Pelion Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+#ifndef __FOTA_STATS_H_
+#define __FOTA_STATS_H_
+
+#include "fota/fota_base.h"
+
+#if defined(MBED_CLOUD_CLIENT_FOTA_ENABLE)
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if (MBED_CLOUD_CLIENT_FOTA_STATS == 1)
+
+// Stages of payload handling that are timed separately
+typedef enum {
+    FOTA_STATS_FRAGMENT,    // all handling of a downloaded fragment, includes the stages below
+    FOTA_STATS_HASH,
+    FOTA_STATS_UNPACK,      // delta or decompression
+    FOTA_STATS_ENCRYPT,
+    FOTA_STATS_PROGRAM,
+    FOTA_STATS_NUM_STAGES
+} fota_stats_stage_e;
+
+/*
+ * Clear all statistics, called when the download starts.
+ */
+void fota_stats_reset(void);
+
+/*
+ * Start timing an operation.
+ *
+ * \return Start time to pass to fota_stats_add().
+ */
+uint64_t fota_stats_start(void);
+
+/*
+ * Account an operation to a stage.
+ *
+ * \param[in] stage  Stage the operation belongs to.
+ * \param[in] start  Value returned by fota_stats_start() when the operation started.
+ * \param[in] bytes  Number of bytes the operation handled.
+ */
+void fota_stats_add(fota_stats_stage_e stage, uint64_t start, size_t bytes);
+
+/*
+ * Trace the throughput of each stage and of the whole download.
+ */
+void fota_stats_report(void);
+
+#define FOTA_STATS_START(var)               uint64_t var = fota_stats_start()
+#define FOTA_STATS_ADD(stage, var, bytes)   fota_stats_add(stage, var, bytes)
+
+#else
+
+#define fota_stats_reset()
+#define fota_stats_report()
+#define FOTA_STATS_START(var)
+#define FOTA_STATS_ADD(stage, var, bytes)
+
+#endif // (MBED_CLOUD_CLIENT_FOTA_STATS == 1)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // defined(MBED_CLOUD_CLIENT_FOTA_ENABLE)
+
+#endif // __FOTA_STATS_H_
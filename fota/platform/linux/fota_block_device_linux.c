@@ -29,8 +29,9 @@
 #include "fota/fota_status.h"
 #include "fota_platform_linux.h"
 
-#include <stdio.h>
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #define BD_ERASE_VALUE 0x0
 #define BD_ERASE_SIZE 0x1
@@ -38,25 +39,9 @@
 #define BD_PROGRAM_SIZE 0x1
 #define BD_ERASE_BUFFER_SIZE 0x1000
 
-static size_t get_bd_backend_file_size()
-{
-    struct stat st;
-
-    if (stat(fota_linux_get_update_storage_file_name(), &st) == 0) {
-        return (st.st_size);
-    } else {
-        FOTA_TRACE_ERROR("stat failed: %s", strerror(errno));
-        FOTA_ASSERT(0);
-        return 0;
-    }
-}
-
-static FILE *get_bd_backend(void)
-{
-    FILE *bd_backend = fopen(fota_linux_get_update_storage_file_name(), "rb+");
-    FOTA_ASSERT(bd_backend);
-    return bd_backend;
-}
+// Backend file stays open from init to deinit, its size is only changed here
+static int bd_backend_fd = -1;
+static size_t bd_backend_file_size = 0;
 
 int fota_bd_size(size_t *size)
 {
@@ -66,131 +51,150 @@ int fota_bd_size(size_t *size)
 
 int fota_bd_init(void)
 {
-    FILE *bd_backend = fopen(fota_linux_get_update_storage_file_name(), "rb+");
-    if (NULL == bd_backend) {
-        bd_backend = fopen(fota_linux_get_update_storage_file_name(), "wb+");
-        if (NULL == bd_backend) {
-            FOTA_TRACE_ERROR("fopen failed: %s", strerror(errno));
-            FOTA_TRACE_ERROR("Failed to initialize BlockDevice - failed to create file %s", fota_linux_get_update_storage_file_name());
-            return FOTA_STATUS_STORAGE_WRITE_FAILED;
-        }
+    struct stat st;
+
+    if (bd_backend_fd >= 0) {
+        return FOTA_STATUS_SUCCESS;
     }
-    fclose(bd_backend);
+
+    bd_backend_fd = open(fota_linux_get_update_storage_file_name(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (bd_backend_fd < 0) {
+        FOTA_TRACE_ERROR("open failed: %s", strerror(errno));
+        FOTA_TRACE_ERROR("Failed to initialize BlockDevice - failed to create file %s", fota_linux_get_update_storage_file_name());
+        return FOTA_STATUS_STORAGE_WRITE_FAILED;
+    }
+
+    if (fstat(bd_backend_fd, &st)) {
+        FOTA_TRACE_ERROR("fstat failed: %s", strerror(errno));
+        close(bd_backend_fd);
+        bd_backend_fd = -1;
+        return FOTA_STATUS_STORAGE_READ_FAILED;
+    }
+    bd_backend_file_size = st.st_size;
+
+    // Images are written and read front to back
+    posix_fadvise(bd_backend_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
 
     return FOTA_STATUS_SUCCESS;
 }
 
 int fota_bd_deinit(void)
 {
+    if (bd_backend_fd < 0) {
+        return FOTA_STATUS_SUCCESS;
+    }
+
+    // Programs are left to the page cache, make them durable before letting go of the file
+    if (fdatasync(bd_backend_fd)) {
+        FOTA_TRACE_ERROR("fdatasync failed: %s", strerror(errno));
+    }
+    close(bd_backend_fd);
+    bd_backend_fd = -1;
     return FOTA_STATUS_SUCCESS;
 }
 
 int fota_bd_read(void *buffer, size_t addr, size_t size)
 {
-    size_t bytes_read;
-    size_t file_size = get_bd_backend_file_size();
-    int ret;
+    uint8_t *buf = (uint8_t *) buffer;
+
+    FOTA_ASSERT(bd_backend_fd >= 0);
 
-    if (addr + size > file_size) {
-        FOTA_TRACE_ERROR("Read failed: addr %ld, size %ld file size %ld", addr, size, file_size);
+    if (addr + size > bd_backend_file_size) {
+        FOTA_TRACE_ERROR("Read failed: addr %ld, size %ld file size %ld", addr, size, bd_backend_file_size);
         return FOTA_STATUS_STORAGE_READ_FAILED;
     }
 
-    FILE *bd_backend = get_bd_backend();
-
-    if (fseek(bd_backend, addr, SEEK_SET)) {
-        FOTA_TRACE_ERROR("fseek failed: %s", strerror(errno));
-        ret = FOTA_STATUS_STORAGE_READ_FAILED;
-        goto end;
+    while (size) {
+        ssize_t bytes_read = pread(bd_backend_fd, buf, size, addr);
+        if (bytes_read < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            FOTA_TRACE_ERROR("pread failed: %s", strerror(errno));
+            return FOTA_STATUS_STORAGE_READ_FAILED;
+        }
+        if (!bytes_read) {
+            memset(buf, BD_ERASE_VALUE, size);
+            break;
+        }
+        buf += bytes_read;
+        addr += bytes_read;
+        size -= bytes_read;
     }
 
-    bytes_read = fread(buffer, 1, size, bd_backend);
-    memset(buffer + bytes_read, BD_ERASE_VALUE, size - bytes_read);
-    ret = FOTA_STATUS_SUCCESS;
-
-end:
-    fclose(bd_backend);
-    return ret;
+    return FOTA_STATUS_SUCCESS;
 }
 
-int fota_bd_program(const void *buffer, size_t addr, size_t size)
+static int write_backend(const void *buffer, size_t addr, size_t size)
 {
-    size_t bytes_written;
-    size_t file_size = get_bd_backend_file_size();
-    int ret;
-
-    if (addr + size > file_size) {
-        FOTA_TRACE_ERROR("Program failed: addr %ld, size %ld file size %ld", addr, size, file_size);
-        return FOTA_STATUS_STORAGE_WRITE_FAILED;
+    const uint8_t *buf = (const uint8_t *) buffer;
+
+    while (size) {
+        ssize_t bytes_written = pwrite(bd_backend_fd, buf, size, addr);
+        if (bytes_written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            FOTA_TRACE_ERROR("pwrite failed: %s", strerror(errno));
+            return FOTA_STATUS_STORAGE_WRITE_FAILED;
+        }
+        buf += bytes_written;
+        addr += bytes_written;
+        size -= bytes_written;
     }
 
-    FILE *bd_backend = get_bd_backend();
+    return FOTA_STATUS_SUCCESS;
+}
 
-    if (fseek(bd_backend, addr, SEEK_SET)) {
-        FOTA_TRACE_ERROR("fseek failed: %s", strerror(errno));
-        ret = FOTA_STATUS_STORAGE_WRITE_FAILED;
-        goto end;
-    }
+int fota_bd_program(const void *buffer, size_t addr, size_t size)
+{
+    FOTA_ASSERT(bd_backend_fd >= 0);
 
-    bytes_written = fwrite(buffer, 1, size, bd_backend);
-    if (bytes_written != size) {
-        FOTA_TRACE_ERROR("fwrite failed: %s", strerror(errno));
-        ret = FOTA_STATUS_STORAGE_WRITE_FAILED;
-        goto end;
+    if (addr + size > bd_backend_file_size) {
+        FOTA_TRACE_ERROR("Program failed: addr %ld, size %ld file size %ld", addr, size, bd_backend_file_size);
+        return FOTA_STATUS_STORAGE_WRITE_FAILED;
     }
 
-    ret = FOTA_STATUS_SUCCESS;
-
-end:
-    fclose(bd_backend);
-    return ret;
+    return write_backend(buffer, addr, size);
 }
 
 int fota_bd_erase(size_t addr, size_t size)
 {
     int ret;
-    size_t erase_size;
+    size_t erase_end = addr + size;
     uint8_t erase_buff[BD_ERASE_BUFFER_SIZE];
 
+    FOTA_ASSERT(bd_backend_fd >= 0);
+
     if (addr + size > MBED_CLOUD_CLIENT_FOTA_STORAGE_SIZE) {
         FOTA_TRACE_ERROR("Erase failed: addr %ld, size %ld storage size %ld", addr, size, MBED_CLOUD_CLIENT_FOTA_STORAGE_SIZE);
         return FOTA_STATUS_STORAGE_WRITE_FAILED;
     }
 
-    size_t file_size = get_bd_backend_file_size();
-
-    if (addr >= file_size) {
-        size += addr - file_size;
-        addr = file_size;
-    }
-
-    FILE *bd_backend = get_bd_backend();
-
-    if (fseek(bd_backend, addr, SEEK_SET)) {
-        FOTA_TRACE_ERROR("fseek failed: %s", strerror(errno));
-        ret = FOTA_STATUS_STORAGE_WRITE_FAILED;
-        goto end;
-    }
-
+    // Part inside the file is overwritten with the erase value
     memset(erase_buff, BD_ERASE_VALUE, sizeof(erase_buff));
-    erase_size = size;
-    while (erase_size) {
-        size_t size_to_write = MIN(sizeof(erase_buff), erase_size);
-        size_t bytes_written = fwrite(erase_buff, 1, size_to_write, bd_backend);
-        if (bytes_written != size_to_write) {
-            FOTA_TRACE_ERROR("fwrite failed: %s", strerror(errno));
+    while (addr < MIN(erase_end, bd_backend_file_size)) {
+        size_t size_to_write = MIN(sizeof(erase_buff), MIN(erase_end, bd_backend_file_size) - addr);
+        ret = write_backend(erase_buff, addr, size_to_write);
+        if (ret) {
             FOTA_TRACE_ERROR("Write failed BlockDevice - file %s", fota_linux_get_update_storage_file_name());
-            ret = FOTA_STATUS_STORAGE_WRITE_FAILED;
-            goto end;
+            return ret;
         }
-        erase_size -= size_to_write;
+        addr += size_to_write;
     }
 
-    ret = FOTA_STATUS_SUCCESS;
+    // Part past the end grows the file, new blocks read as zeros (the erase value).
+    // Allocate them now, so that programming doesn't run out of space halfway.
+    if (erase_end > bd_backend_file_size) {
+        int err = posix_fallocate(bd_backend_fd, bd_backend_file_size, erase_end - bd_backend_file_size);
+        if (err && ftruncate(bd_backend_fd, erase_end)) {
+            FOTA_TRACE_ERROR("Failed to extend BlockDevice file %s: %s", fota_linux_get_update_storage_file_name(), strerror(err));
+            return FOTA_STATUS_STORAGE_WRITE_FAILED;
+        }
+        bd_backend_file_size = erase_end;
+    }
 
-end:
-    fclose(bd_backend);
-    return ret;
+    return FOTA_STATUS_SUCCESS;
 }
 
 int fota_bd_get_read_size(size_t *read_size)
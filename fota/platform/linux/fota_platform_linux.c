@@ -25,6 +25,8 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
 #include <sys/stat.h>
 
 #include "fota_platform_linux.h"
@@ -124,6 +126,227 @@ const char *fota_linux_get_candidate_file_name(void)
 
 static const int fw_buf_size = 2048;
 
+#if (MBED_CLOUD_CLIENT_FOTA_LINUX_INSTALL_BUFFER_SIZE > 0)
+
+// Fragments are collected in one buffer while a writer thread writes the other,
+// so that writing the candidate file overlaps reading and decrypting the candidate.
+typedef struct {
+    int fd;
+    uint8_t *buf[2];
+    int fill;               // index of the buffer being filled
+    size_t used;
+    size_t file_pos;        // file position of the buffer being filled
+    const uint8_t *write_buf;
+    size_t write_size;
+    size_t write_pos;
+    bool stop;
+    int error;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+} install_writer_t;
+
+static void *install_writer_thread(void *arg)
+{
+    install_writer_t *writer = (install_writer_t *) arg;
+
+    pthread_mutex_lock(&writer->mutex);
+    for (;;) {
+        while (!writer->write_buf && !writer->stop) {
+            pthread_cond_wait(&writer->cond, &writer->mutex);
+        }
+        if (!writer->write_buf) {
+            break;
+        }
+        pthread_mutex_unlock(&writer->mutex);
+
+        int error = 0;
+        size_t done = 0;
+        while (done < writer->write_size) {
+            ssize_t written = pwrite(writer->fd, writer->write_buf + done,
+                                     writer->write_size - done, (off_t)(writer->write_pos + done));
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                error = errno;
+                break;
+            }
+            done += written;
+        }
+
+        pthread_mutex_lock(&writer->mutex);
+        if (error && !writer->error) {
+            writer->error = error;
+        }
+        writer->write_buf = NULL;
+        pthread_cond_broadcast(&writer->cond);
+    }
+    pthread_mutex_unlock(&writer->mutex);
+
+    return NULL;
+}
+
+// Hand the buffer being filled to the writer thread, once it has finished the previous one
+static int install_writer_submit(install_writer_t *writer)
+{
+    int error;
+
+    pthread_mutex_lock(&writer->mutex);
+    while (writer->write_buf) {
+        pthread_cond_wait(&writer->cond, &writer->mutex);
+    }
+    error = writer->error;
+    if (!error && writer->used) {
+        writer->write_buf = writer->buf[writer->fill];
+        writer->write_size = writer->used;
+        writer->write_pos = writer->file_pos;
+        pthread_cond_signal(&writer->cond);
+        writer->fill ^= 1;
+        writer->file_pos += writer->used;
+        writer->used = 0;
+    }
+    pthread_mutex_unlock(&writer->mutex);
+
+    if (error) {
+        FOTA_TRACE_ERROR("Failed writing file %s: %d", fota_linux_get_candidate_file_name(), error);
+        return FOTA_STATUS_STORAGE_WRITE_FAILED;
+    }
+    return FOTA_STATUS_SUCCESS;
+}
+
+// Write the remaining data, stop the writer thread and close the file
+static int install_writer_close(install_writer_t *writer, bool flush)
+{
+    int ret = FOTA_STATUS_SUCCESS;
+
+    if (flush) {
+        ret = install_writer_submit(writer);
+    }
+
+    pthread_mutex_lock(&writer->mutex);
+    writer->stop = true;
+    pthread_cond_signal(&writer->cond);
+    pthread_mutex_unlock(&writer->mutex);
+    pthread_join(writer->thread, NULL);
+
+    if (!ret && writer->error) {
+        FOTA_TRACE_ERROR("Failed writing file %s: %d", fota_linux_get_candidate_file_name(), writer->error);
+        ret = FOTA_STATUS_STORAGE_WRITE_FAILED;
+    }
+    if (close(writer->fd) && !ret) {
+        FOTA_TRACE_ERROR("Failed closing file %s: %d", fota_linux_get_candidate_file_name(), errno);
+        ret = FOTA_STATUS_STORAGE_WRITE_FAILED;
+    }
+
+    pthread_cond_destroy(&writer->cond);
+    pthread_mutex_destroy(&writer->mutex);
+    free(writer->buf[0]);
+    free(writer->buf[1]);
+    free(writer);
+    return ret;
+}
+
+static int install_writer_open(void **user_ctx)
+{
+    install_writer_t *writer = (install_writer_t *) calloc(1, sizeof(install_writer_t));
+    if (!writer) {
+        return FOTA_STATUS_OUT_OF_MEMORY;
+    }
+    writer->buf[0] = (uint8_t *) malloc(MBED_CLOUD_CLIENT_FOTA_LINUX_INSTALL_BUFFER_SIZE);
+    writer->buf[1] = (uint8_t *) malloc(MBED_CLOUD_CLIENT_FOTA_LINUX_INSTALL_BUFFER_SIZE);
+    if (!writer->buf[0] || !writer->buf[1]) {
+        free(writer->buf[0]);
+        free(writer->buf[1]);
+        free(writer);
+        return FOTA_STATUS_OUT_OF_MEMORY;
+    }
+
+    writer->fd = open(fota_linux_get_candidate_file_name(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (writer->fd < 0) {
+        FOTA_TRACE_ERROR("Failed opening file %s: %d", fota_linux_get_candidate_file_name(), errno);
+        free(writer->buf[0]);
+        free(writer->buf[1]);
+        free(writer);
+        return FOTA_STATUS_STORAGE_WRITE_FAILED;
+    }
+
+    pthread_mutex_init(&writer->mutex, NULL);
+    pthread_cond_init(&writer->cond, NULL);
+    if (pthread_create(&writer->thread, NULL, install_writer_thread, writer)) {
+        FOTA_TRACE_ERROR("Failed starting install writer thread");
+        pthread_cond_destroy(&writer->cond);
+        pthread_mutex_destroy(&writer->mutex);
+        close(writer->fd);
+        free(writer->buf[0]);
+        free(writer->buf[1]);
+        free(writer);
+        return FOTA_STATUS_INTERNAL_ERROR;
+    }
+
+    *user_ctx = writer;
+    return FOTA_STATUS_SUCCESS;
+}
+
+static int install_writer_write(install_writer_t *writer, const uint8_t *buf, size_t size, size_t pos)
+{
+    int ret;
+
+    // Fragments normally follow each other, start a new buffer if not
+    if (pos != writer->file_pos + writer->used) {
+        ret = install_writer_submit(writer);
+        if (ret) {
+            return ret;
+        }
+        writer->file_pos = pos;
+    }
+
+    while (size) {
+        size_t chunk = MIN(size, MBED_CLOUD_CLIENT_FOTA_LINUX_INSTALL_BUFFER_SIZE - writer->used);
+        memcpy(writer->buf[writer->fill] + writer->used, buf, chunk);
+        writer->used += chunk;
+        buf += chunk;
+        size -= chunk;
+        if (writer->used == MBED_CLOUD_CLIENT_FOTA_LINUX_INSTALL_BUFFER_SIZE) {
+            ret = install_writer_submit(writer);
+            if (ret) {
+                return ret;
+            }
+        }
+    }
+
+    return FOTA_STATUS_SUCCESS;
+}
+
+int fota_linux_candidate_iterate(fota_candidate_iterate_callback_info *info)
+{
+    int ret;
+
+    switch (info->status) {
+        case FOTA_CANDIDATE_ITERATE_START:
+            return install_writer_open(&info->user_ctx);
+
+        case FOTA_CANDIDATE_ITERATE_FRAGMENT:
+            ret = install_writer_write((install_writer_t *) info->user_ctx, info->frag_buf, info->frag_size, info->frag_pos);
+            if (ret) {
+                // iteration stops here, no finish call follows
+                (void) install_writer_close((install_writer_t *) info->user_ctx, false);
+                info->user_ctx = NULL;
+            }
+            return ret;
+
+        case FOTA_CANDIDATE_ITERATE_FINISH:
+            ret = install_writer_close((install_writer_t *) info->user_ctx, true);
+            info->user_ctx = NULL;
+            return ret;
+
+        default:
+            return FOTA_STATUS_INTERNAL_ERROR;
+    }
+}
+
+#else // (MBED_CLOUD_CLIENT_FOTA_LINUX_INSTALL_BUFFER_SIZE > 0)
+
 int fota_linux_candidate_iterate(fota_candidate_iterate_callback_info *info)
 {
     switch (info->status) {
@@ -162,6 +385,8 @@ int fota_linux_candidate_iterate(fota_candidate_iterate_callback_info *info)
     return FOTA_STATUS_INTERNAL_ERROR;
 }
 
+#endif // (MBED_CLOUD_CLIENT_FOTA_LINUX_INSTALL_BUFFER_SIZE > 0)
+
 int fota_linux_update_curr_fw_header(fota_header_info_t *header_info)
 {
     int status;
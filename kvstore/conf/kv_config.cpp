@@ -63,6 +63,12 @@ const spi_pinmap_t static_spi_pinmap = get_spi_pinmap(MBED_CONF_SD_SPI_MOSI, MBE
 #define MBED_CONF_STORAGE_TDB_INTERNAL_INTERNAL_SIZE 0
 #endif
 
+// Mount the external TDBStore and the SecureStore on their first use instead of at init,
+// the internal store holding the device key is still initialized right away
+#if !defined(MBED_CONF_STORAGE_DEFERRED_MOUNT)
+#define MBED_CONF_STORAGE_DEFERRED_MOUNT 0
+#endif
+
 /**
  * @brief This function initializes internal memory secure storage
  *        This includes a TDBStore instance with a FlashIAPBlockdevice
@@ -896,9 +902,9 @@ int _storage_config_TDB_EXTERNAL_NO_RBP()
 #endif
 }
 
-int _storage_config_tdb_external_common()
-{
 #if SECURESTORE_ENABLED
+static int _storage_config_tdb_external_mount()
+{
     //Initialize external block device
     int ret = kvstore_config.external_bd->init();
     if (ret != MBED_SUCCESS) {
@@ -912,20 +918,37 @@ int _storage_config_tdb_external_common()
         return MBED_ERROR_INVALID_SIZE;
     }
 
+    //Initialize SecureStore, which initializes the external TDBStore
+    ret = kvstore_config.kvstore_main_instance->init();
+    if (ret != MBED_SUCCESS) {
+        tr_error("KV Config: Fail to init SecureStore.");
+        return ret ;
+    }
+
+    return MBED_SUCCESS;
+}
+#endif
+
+int _storage_config_tdb_external_common()
+{
+#if SECURESTORE_ENABLED
     //Create external TDBStore
     static TDBStore tdb_external(kvstore_config.external_bd);
     kvstore_config.external_store = &tdb_external;
 
-    //Create SecureStore and initialize it
+    //Create SecureStore
     static SecureStore secst(kvstore_config.external_store, kvstore_config.internal_store);
+    kvstore_config.kvstore_main_instance = &secst;
 
-    ret = secst.init();
+#if MBED_CONF_STORAGE_DEFERRED_MOUNT
+    kvstore_config.deferred_init = _storage_config_tdb_external_mount;
+    int ret;
+#else
+    int ret = _storage_config_tdb_external_mount();
     if (ret != MBED_SUCCESS) {
-        tr_error("KV Config: Fail to init SecureStore.");
-        return ret ;
+        return ret;
     }
-
-    kvstore_config.kvstore_main_instance = &secst;
+#endif
 
     //Init kv_map and add the configuration struct to KVStore map.
     KVMap &kv_map = KVMap::get_instance();
@@ -1136,3 +1159,13 @@ int kv_init_storage_config()
 exit:
     return ret;
 }
+
+int kv_complete_storage_config()
+{
+    int ret = kv_init_storage_config();
+    if (ret != MBED_SUCCESS) {
+        return ret;
+    }
+
+    return KVMap::get_instance().complete_init(NULL);
+}
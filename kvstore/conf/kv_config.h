@@ -35,6 +35,15 @@ extern "C" {
  */
 int kv_init_storage_config();
 
+/**
+ * @brief With MBED_CONF_STORAGE_DEFERRED_MOUNT, kv_init_storage_config() only initializes the
+ *        internal store and the external one is mounted on its first use. This function
+ *        mounts it now, for example from a low priority thread while the network connects.
+ *
+ * @returns 0 on success or negative value on failure.
+ */
+int kv_complete_storage_config();
+
 /**
  * @brief A getter for filesystemstore folder path configuration
  *
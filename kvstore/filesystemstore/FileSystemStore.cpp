@@ -322,7 +322,63 @@ exit_point:
     return status;
 }
 
+int FileSystemStore::remove_prefix(const char *prefix)
+{
+    iterator_t it;
+    char key[KVStore::MAX_KEY_SIZE];
+    bool write_protected = false;
+
+    if ((prefix == NULL) || (strlen(prefix) == 0)) {
+        return MBED_ERROR_INVALID_ARGUMENT;
+    }
+
+    _mutex.lock();
+
+    int status = iterator_open(&it, prefix);
+    if (status != MBED_SUCCESS) {
+        goto exit_point;
+    }
+
+    while ((status = iterator_next(it, key, sizeof(key))) == MBED_SUCCESS) {
+        status = remove(key);
+        if (status == MBED_ERROR_WRITE_PROTECTED) {
+            write_protected = true;
+        } else if (status != MBED_SUCCESS) {
+            break;
+        }
+    }
+    iterator_close(it);
+
+    if (status == MBED_ERROR_ITEM_NOT_FOUND) {
+        status = write_protected ? MBED_ERROR_WRITE_PROTECTED : MBED_SUCCESS;
+    }
+
+exit_point:
+    _mutex.unlock();
+    return status;
+}
+
 // Incremental set API
+int FileSystemStore::batch_begin()
+{
+    return MBED_ERROR_UNSUPPORTED;
+}
+
+int FileSystemStore::batch_set(const char *key, const void *buffer, size_t size, uint32_t create_flags)
+{
+    return MBED_ERROR_UNSUPPORTED;
+}
+
+int FileSystemStore::batch_commit()
+{
+    return MBED_ERROR_UNSUPPORTED;
+}
+
+int FileSystemStore::batch_abort()
+{
+    return MBED_ERROR_UNSUPPORTED;
+}
+
 int FileSystemStore::set_start(set_handle_t *handle, const char *key, size_t final_data_size, uint32_t create_flags)
 {
     int status = MBED_SUCCESS;
@@ -136,6 +136,48 @@ public:
      */
     virtual int remove(const char *key);
 
+    /**
+     * @brief Remove all FileSystemStore items whose key starts with a prefix.
+     *        Items stored with the "write once" flag are kept.
+     *
+     * @param[in]  prefix               Key prefix, must not be empty.
+     *
+     * @returns MBED_SUCCESS                        Success.
+     *          MBED_ERROR_NOT_READY                Not initialized.
+     *          MBED_ERROR_FAILED_OPERATION         Underlying file system failed operation.
+     *          MBED_ERROR_INVALID_ARGUMENT         Invalid argument given in function arguments.
+     *          MBED_ERROR_WRITE_PROTECTED          Some items were kept as they have the "write once" flag.
+     */
+    virtual int remove_prefix(const char *prefix);
+
+    /**
+     * @brief Write batches are not supported by FileSystemStore.
+     *
+     * @returns MBED_ERROR_UNSUPPORTED              Not supported.
+     */
+    virtual int batch_begin();
+
+    /**
+     * @brief Write batches are not supported by FileSystemStore.
+     *
+     * @returns MBED_ERROR_UNSUPPORTED              Not supported.
+     */
+    virtual int batch_set(const char *key, const void *buffer, size_t size, uint32_t create_flags);
+
+    /**
+     * @brief Write batches are not supported by FileSystemStore.
+     *
+     * @returns MBED_ERROR_UNSUPPORTED              Not supported.
+     */
+    virtual int batch_commit();
+
+    /**
+     * @brief Write batches are not supported by FileSystemStore.
+     *
+     * @returns MBED_ERROR_UNSUPPORTED              Not supported.
+     */
+    virtual int batch_abort();
+
     /**
      * @brief Start an incremental FileSystemStore set sequence. This operation is blocking other operations.
      *        Any get/set/remove/iterator operation will be blocked until set_finalize is called.
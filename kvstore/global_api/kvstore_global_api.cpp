@@ -29,6 +29,12 @@ struct _opaque_kv_key_iterator {
     char *path;
 };
 
+// resolved partition handle
+struct _opaque_kv_handle {
+    KVStore *kvstore_intance;
+    uint32_t flags_mask;
+};
+
 int kv_set(const char *full_name_key, const void *buffer, size_t size, uint32_t create_flags)
 {
     int ret = kv_init_storage_config();
@@ -110,6 +116,24 @@ int kv_remove(const char *full_name_key)
     return kv_instance->remove(full_name_key + key_index);
 }
 
+int kv_remove_prefix(const char *full_prefix)
+{
+    int ret = kv_init_storage_config();
+    if (MBED_SUCCESS != ret) {
+        return ret;
+    }
+
+    KVMap &kv_map = KVMap::get_instance();
+    KVStore *kv_instance = NULL;
+    size_t key_index = 0;
+    ret  = kv_map.lookup(full_prefix, &kv_instance, &key_index);
+    if (ret != MBED_SUCCESS) {
+        return ret;
+    }
+
+    return kv_instance->remove_prefix(full_prefix + key_index);
+}
+
 int kv_iterator_open(kv_iterator_t *it, const char *full_prefix)
 {
     if (it == NULL) {
@@ -201,3 +225,80 @@ int kv_reset(const char *kvstore_name)
 
 }
 
+int kv_handle_open(kv_handle_t *handle, const char *kvstore_path)
+{
+    if (handle == NULL) {
+        return MBED_ERROR_INVALID_ARGUMENT;
+    }
+
+    int ret = kv_init_storage_config();
+    if (MBED_SUCCESS != ret) {
+        return ret;
+    }
+
+    KVMap &kv_map = KVMap::get_instance();
+    KVStore *kv_instance = NULL;
+    uint32_t flags_mask = 0;
+    size_t key_index = 0;
+    ret = kv_map.lookup(kvstore_path, &kv_instance, &key_index, &flags_mask);
+    if (ret != MBED_SUCCESS) {
+        return ret;
+    }
+
+    (*handle) = new _opaque_kv_handle;
+    if (*handle == NULL) {
+        return MBED_ERROR_FAILED_OPERATION;
+    }
+    (*handle)->kvstore_intance = kv_instance;
+    (*handle)->flags_mask = flags_mask;
+    return MBED_SUCCESS;
+}
+
+int kv_handle_set(kv_handle_t handle, const char *key, const void *buffer, size_t size, uint32_t create_flags)
+{
+    if (handle == NULL) {
+        return MBED_ERROR_INVALID_ARGUMENT;
+    }
+
+    return handle->kvstore_intance->set(key, buffer, size, create_flags & handle->flags_mask);
+}
+
+int kv_handle_get(kv_handle_t handle, const char *key, void *buffer, size_t buffer_size, size_t *actual_size)
+{
+    if (handle == NULL) {
+        return MBED_ERROR_INVALID_ARGUMENT;
+    }
+
+    return handle->kvstore_intance->get(key, buffer, buffer_size, actual_size);
+}
+
+int kv_handle_get_info(kv_handle_t handle, const char *key, kv_info_t *info)
+{
+    if (handle == NULL) {
+        return MBED_ERROR_INVALID_ARGUMENT;
+    }
+
+    KVStore::info_t inner_info;
+    int ret = handle->kvstore_intance->get_info(key, &inner_info);
+    if (MBED_SUCCESS != ret) {
+        return ret;
+    }
+    info->flags = inner_info.flags;
+    info->size =  inner_info.size;
+    return ret;
+}
+
+int kv_handle_remove(kv_handle_t handle, const char *key)
+{
+    if (handle == NULL) {
+        return MBED_ERROR_INVALID_ARGUMENT;
+    }
+
+    return handle->kvstore_intance->remove(key);
+}
+
+int kv_handle_close(kv_handle_t handle)
+{
+    delete handle;
+    return MBED_SUCCESS;
+}
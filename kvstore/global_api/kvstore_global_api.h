@@ -24,6 +24,7 @@ extern "C" {
 #endif
 
 typedef struct _opaque_kv_key_iterator *kv_iterator_t;
+typedef struct _opaque_kv_handle *kv_handle_t;
 
 #define KV_WRITE_ONCE_FLAG                      (1 << 0)
 #define KV_REQUIRE_CONFIDENTIALITY_FLAG         (1 << 1)
@@ -92,6 +93,17 @@ int kv_get_info(const char *full_name_key, kv_info_t *info);
  */
 int kv_remove(const char *full_name_key);
 
+/**
+ * @brief Remove all KVStore items whose key starts with a given prefix. Items stored with
+ *        the "write once" flag are kept.
+ *
+ * @param[in]  full_prefix          /Partition_path/Key_prefix. The key prefix must not be empty.
+ *
+ * @returns MBED_SUCCESS on success, MBED_ERROR_WRITE_PROTECTED if some items were kept
+ *          or an error code from underlying KVStore instances
+ */
+int kv_remove_prefix(const char *full_prefix);
+
 /**
  * @brief Start an iteration over KVStore keys to find all the entries
  *        that fit the full_prefix. There are no issues with any other operations while
@@ -138,6 +150,75 @@ int kv_iterator_close(kv_iterator_t it);
  */
 int kv_reset(const char *kvstore_path);
 
+/**
+ * @brief Resolve a partition once, so that the kv_handle_* calls on it skip the partition
+ *        lookup of the full name calls. The handle is valid until the partition is detached.
+ *
+ * @param[out] handle               Allocating handle.
+ *                                  Do not forget to call kv_handle_close
+ *                                  to deallocate the memory.
+ * @param[in]  kvstore_path         /Partition/
+ *
+ * @returns MBED_SUCCESS on success or an error code from underlying KVStore instances
+ */
+int kv_handle_open(kv_handle_t *handle, const char *kvstore_path);
+
+/**
+ * @brief Set one KVStore item in a resolved partition, given key and value.
+ *
+ * @param[in]  handle               Partition handle.
+ * @param[in]  key                  Key without the partition. Must not include '*' '/' '?' ':' ';' '\' '"' '|' ' ' '<' '>' '\'.
+ * @param[in]  buffer               Value data buffer.
+ * @param[in]  size                 Value data size.
+ * @param[in]  create_flags         Flag mask.
+ *
+ * @returns MBED_SUCCESS on success or an error code from underlying KVStore instances
+ */
+int kv_handle_set(kv_handle_t handle, const char *key, const void *buffer, size_t size, uint32_t create_flags);
+
+/**
+ * @brief Get one KVStore item of a resolved partition by given key.
+ *
+ * @param[in]  handle               Partition handle.
+ * @param[in]  key                  Key without the partition. Must not include '*' '/' '?' ':' ';' '\' '"' '|' ' ' '<' '>' '\'.
+ * @param[in]  buffer               Value data buffer.
+ * @param[in]  buffer_size          Value data buffer size.
+ * @param[out] actual_size          Actual read size.
+ *
+ * @returns MBED_SUCCESS on success or an error code from underlying KVStore instances
+ */
+int kv_handle_get(kv_handle_t handle, const char *key, void *buffer, size_t buffer_size, size_t *actual_size);
+
+/**
+ * @brief Get information of a given key of a resolved partition.
+ *
+ * @param[in]  handle               Partition handle.
+ * @param[in]  key                  Key without the partition. Must not include '*' '/' '?' ':' ';' '\' '"' '|' ' ' '<' '>' '\'.
+ * @param[out] info                 Returned information structure.
+ *
+ * @returns MBED_SUCCESS on success or an error code from underlying KVStore instances
+ */
+int kv_handle_get_info(kv_handle_t handle, const char *key, kv_info_t *info);
+
+/**
+ * @brief Remove a KVStore item of a resolved partition by given key.
+ *
+ * @param[in]  handle               Partition handle.
+ * @param[in]  key                  Key without the partition. Must not include '*' '/' '?' ':' ';' '\' '"' '|' ' ' '<' '>' '\'.
+ *
+ * @returns MBED_SUCCESS on success or an error code from underlying KVStore instances
+ */
+int kv_handle_remove(kv_handle_t handle, const char *key);
+
+/**
+ * @brief Deallocate a partition handle.
+ *
+ * @param[in]  handle               Partition handle.
+ *
+ * @returns MBED_SUCCESS on success or an error code from underlying KVStore instances
+ */
+int kv_handle_close(kv_handle_t handle);
+
 #ifdef __cplusplus
 } // closing brace for extern "C"
 #endif
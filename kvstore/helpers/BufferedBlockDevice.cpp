@@ -27,7 +27,8 @@ static inline uint32_t align_down(bd_size_t val, bd_size_t size)
 
 BufferedBlockDevice::BufferedBlockDevice(BlockDevice *bd)
     : _bd(bd), _bd_program_size(0), _bd_read_size(0), _bd_size(0), _write_cache_addr(0), _write_cache_valid(false),
-      _write_cache(0), _read_buf(0), _is_initialized(false)
+      _write_cache(0), _read_buf(0), _is_initialized(false), _read_cache_lines(0), _read_cache(0),
+      _read_cache_line_size(0), _read_cache_num_lines(0), _read_cache_clock(0), _read_cache_next_addr(0)
 {
 }
 
@@ -55,7 +56,20 @@ int BufferedBlockDevice::init()
         _read_buf = new uint8_t[_bd_read_size];
     }
 
+    if (MBED_CONF_STORAGE_BUFFERED_BD_READ_CACHE_LINES && !_read_cache) {
+        _read_cache_line_size = (MBED_CONF_STORAGE_BUFFERED_BD_READ_CACHE_LINE_SIZE + _bd_read_size - 1) /
+                                _bd_read_size * _bd_read_size;
+        _read_cache_num_lines = MBED_CONF_STORAGE_BUFFERED_BD_READ_CACHE_LINES;
+        _read_cache_lines = new read_cache_line_t[_read_cache_num_lines];
+        _read_cache = new uint8_t[_read_cache_num_lines * _read_cache_line_size];
+    }
+
     invalidate_write_cache();
+    for (uint32_t i = 0; i < _read_cache_num_lines; i++) {
+        _read_cache_lines[i].addr = _bd_size;
+        _read_cache_lines[i].last_use = 0;
+    }
+    _read_cache_next_addr = _bd_size;
 
     _is_initialized = true;
     return BD_ERROR_OK;
@@ -77,6 +91,10 @@ int BufferedBlockDevice::deinit()
     _write_cache = 0;
     delete[] _read_buf;
     _read_buf = 0;
+    delete[] _read_cache_lines;
+    _read_cache_lines = 0;
+    delete[] _read_cache;
+    _read_cache = 0;
     _is_initialized = false;
     return _bd->deinit();
 }
@@ -88,6 +106,7 @@ int BufferedBlockDevice::flush()
     }
 
     if (_write_cache_valid) {
+        invalidate_read_cache(_write_cache_addr, _bd_program_size);
         int ret = _bd->program(_write_cache, _write_cache_addr, _bd_program_size);
         if (ret) {
             return ret;
@@ -103,6 +122,76 @@ void BufferedBlockDevice::invalidate_write_cache()
     _write_cache_valid = false;
 }
 
+void BufferedBlockDevice::invalidate_read_cache(bd_addr_t addr, bd_size_t size)
+{
+    for (uint32_t i = 0; i < _read_cache_num_lines; i++) {
+        if ((_read_cache_lines[i].addr < addr + size) &&
+                (_read_cache_lines[i].addr + _read_cache_line_size > addr)) {
+            _read_cache_lines[i].addr = _bd_size;
+            _read_cache_lines[i].last_use = 0;
+        }
+    }
+}
+
+int BufferedBlockDevice::read_cached(uint8_t *buffer, bd_addr_t addr, bd_size_t size)
+{
+    bd_addr_t line_addr = addr - addr % _read_cache_line_size;
+    uint32_t line;
+
+    for (line = 0; line < _read_cache_num_lines; line++) {
+        if (_read_cache_lines[line].addr == line_addr) {
+            break;
+        }
+    }
+
+    if (line == _read_cache_num_lines) {
+        // Miss. If it continues the previous one, read ahead the following lines as well.
+        uint32_t span = 1;
+        if (line_addr == _read_cache_next_addr) {
+            span += std::min((uint32_t) MBED_CONF_STORAGE_BUFFERED_BD_READ_AHEAD_LINES, _read_cache_num_lines - 1);
+        }
+        while ((span > 1) && (line_addr + span * _read_cache_line_size > _bd_size)) {
+            span--;
+        }
+
+        // Lines read together must be adjacent, take the least recently used run of them
+        uint32_t oldest_use = (uint32_t) -1;
+        line = 0;
+        for (uint32_t i = 0; i + span <= _read_cache_num_lines; i++) {
+            uint32_t use = 0;
+            for (uint32_t j = i; j < i + span; j++) {
+                use = std::max(use, _read_cache_lines[j].last_use);
+            }
+            if (use < oldest_use) {
+                oldest_use = use;
+                line = i;
+            }
+        }
+
+        bd_size_t fill_size = span * _read_cache_line_size;
+        invalidate_read_cache(line_addr, fill_size);
+        for (uint32_t i = line; i < line + span; i++) {
+            _read_cache_lines[i].addr = _bd_size;
+        }
+
+        int ret = _bd->read(_read_cache + line * _read_cache_line_size, line_addr, fill_size);
+        if (ret) {
+            return ret;
+        }
+
+        _read_cache_clock++;
+        for (uint32_t i = 0; i < span; i++) {
+            _read_cache_lines[line + i].addr = line_addr + i * _read_cache_line_size;
+            _read_cache_lines[line + i].last_use = _read_cache_clock;
+        }
+        _read_cache_next_addr = line_addr + fill_size;
+    }
+
+    memcpy(buffer, _read_cache + line * _read_cache_line_size + (addr - line_addr), size);
+    _read_cache_lines[line].last_use = ++_read_cache_clock;
+    return 0;
+}
+
 int BufferedBlockDevice::sync()
 {
     if (!_is_initialized) {
@@ -126,8 +215,8 @@ int BufferedBlockDevice::read(void *b, bd_addr_t addr, bd_size_t size)
         return BD_ERROR_DEVICE_ERROR;
     }
 
-    // Common case - no need to involve write cache or read buffer
-    if (_bd->is_valid_read(addr, size) &&
+    // Common case - no need to involve write cache, read buffer or read cache
+    if (_bd->is_valid_read(addr, size) && (!_read_cache || (size >= _read_cache_line_size)) &&
             ((addr + size <= _write_cache_addr) || (addr > _write_cache_addr + _bd_program_size))) {
         return _bd->read(b, addr, size);
     }
@@ -153,8 +242,14 @@ int BufferedBlockDevice::read(void *b, bd_addr_t addr, bd_size_t size)
         // If not, use read buffer as a helper.
         if (read_from_bd) {
             bd_size_t offs_in_read_buf = addr % _bd_read_size;
+            bd_size_t offs_in_line = _read_cache ? addr % _read_cache_line_size : 0;
             int ret;
-            if (offs_in_read_buf || (chunk < _bd_read_size)) {
+            if (_read_cache && (offs_in_line || (chunk < _read_cache_line_size)) &&
+                    (addr - offs_in_line + _read_cache_line_size <= _bd_size)) {
+                // Small or unaligned read, serve it from the cache a line at a time
+                chunk = std::min(chunk, _read_cache_line_size - offs_in_line);
+                ret = read_cached(buf, addr, chunk);
+            } else if (offs_in_read_buf || (chunk < _bd_read_size)) {
                 chunk = std::min(chunk, _bd_read_size - offs_in_read_buf);
                 ret = _bd->read(_read_buf, addr - offs_in_read_buf, _bd_read_size);
                 memcpy(buf, _read_buf + offs_in_read_buf, chunk);
@@ -227,6 +322,7 @@ int BufferedBlockDevice::program(const void *b, bd_addr_t addr, bd_size_t size)
 
         // Only program if we reached the end of a program unit
         if (!((offs_in_buf + chunk) % _bd_program_size)) {
+            invalidate_read_cache(_write_cache_addr, std::max(chunk, _bd_program_size));
             ret = _bd->program(prog_buf, _write_cache_addr, std::max(chunk, _bd_program_size));
             if (ret) {
                 return ret;
@@ -257,6 +353,7 @@ int BufferedBlockDevice::erase(bd_addr_t addr, bd_size_t size)
     if ((_write_cache_addr >= addr) && (_write_cache_addr <= addr + size)) {
         invalidate_write_cache();
     }
+    invalidate_read_cache(addr, size);
     return _bd->erase(addr, size);
 }
 
@@ -269,6 +366,7 @@ int BufferedBlockDevice::trim(bd_addr_t addr, bd_size_t size)
     if ((_write_cache_addr >= addr) && (_write_cache_addr <= addr + size)) {
         invalidate_write_cache();
     }
+    invalidate_read_cache(addr, size);
     return _bd->trim(addr, size);
 }
 
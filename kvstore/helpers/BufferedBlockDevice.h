@@ -28,10 +28,28 @@
 
 #include "BlockDevice.h"
 
+/** Number of lines in the read cache, 0 disables read caching */
+#ifndef MBED_CONF_STORAGE_BUFFERED_BD_READ_CACHE_LINES
+#define MBED_CONF_STORAGE_BUFFERED_BD_READ_CACHE_LINES 0
+#endif
+
+/** Size of a read cache line in bytes, rounded up to a multiple of the underlying read size */
+#ifndef MBED_CONF_STORAGE_BUFFERED_BD_READ_CACHE_LINE_SIZE
+#define MBED_CONF_STORAGE_BUFFERED_BD_READ_CACHE_LINE_SIZE 64
+#endif
+
+/** Number of lines read ahead in the same transaction when reads are sequential */
+#ifndef MBED_CONF_STORAGE_BUFFERED_BD_READ_AHEAD_LINES
+#define MBED_CONF_STORAGE_BUFFERED_BD_READ_AHEAD_LINES 1
+#endif
+
 namespace mbed {
 
 /** Block device for allowing minimal read and program sizes (of 1) for the underlying BD,
  *  using a buffer on the heap.
+ *
+ *  Small reads can optionally be served from an LRU cache of read lines, see
+ *  MBED_CONF_STORAGE_BUFFERED_BD_READ_CACHE_LINES.
  */
 class BufferedBlockDevice : public BlockDevice {
 public:
@@ -171,6 +189,18 @@ protected:
     uint32_t _init_ref_count;
     bool _is_initialized;
 
+    typedef struct {
+        bd_addr_t addr;
+        uint32_t last_use;
+    } read_cache_line_t;
+
+    read_cache_line_t *_read_cache_lines;
+    uint8_t *_read_cache;
+    bd_size_t _read_cache_line_size;
+    uint32_t _read_cache_num_lines;
+    uint32_t _read_cache_clock;
+    bd_addr_t _read_cache_next_addr;
+
 #if !(DOXYGEN_ONLY)
     /** Flush data in cache
      *
@@ -183,6 +213,23 @@ protected:
      *  @return         none
      */
     void invalidate_write_cache();
+
+    /** Read from a single read cache line, filling it from the underlying BD if needed
+     *
+     *  @param buffer   Buffer to read into
+     *  @param addr     Address to read from
+     *  @param size     Size to read, must not cross the line
+     *  @return         0 on success or a negative error code on failure
+     */
+    int read_cached(uint8_t *buffer, bd_addr_t addr, bd_size_t size);
+
+    /** Invalidate read cache lines overlapping given range
+     *
+     *  @param addr     Start address of the range
+     *  @param size     Size of the range
+     *  @return         none
+     */
+    void invalidate_read_cache(bd_addr_t addr, bd_size_t size);
 #endif //#if !(DOXYGEN_ONLY)
 };
 } // namespace mbed
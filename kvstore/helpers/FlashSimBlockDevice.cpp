@@ -25,6 +25,31 @@ namespace mbed {
 
 static const bd_size_t min_blank_buf_size = 32;
 
+// Typical datasheet figures, rounded
+const FlashSimBlockDevice::timing_t FlashSimBlockDevice::internal_flash_timing = {
+    0,      // read_setup_us
+    10,     // read_us_per_kb
+    20,     // program_setup_us
+    8000,   // program_us_per_kb
+    20000   // erase_us_per_unit
+};
+
+const FlashSimBlockDevice::timing_t FlashSimBlockDevice::spif_timing = {
+    5,      // read_setup_us
+    210,    // read_us_per_kb
+    50,     // program_setup_us
+    2800,   // program_us_per_kb
+    45000   // erase_us_per_unit
+};
+
+const FlashSimBlockDevice::timing_t FlashSimBlockDevice::qspi_timing = {
+    2,      // read_setup_us
+    30,     // read_us_per_kb
+    20,     // program_setup_us
+    2400,   // program_us_per_kb
+    45000   // erase_us_per_unit
+};
+
 static inline uint32_t align_up(bd_size_t val, bd_size_t size)
 {
     return (((val - 1) / size) + 1) * size;
@@ -32,14 +57,18 @@ static inline uint32_t align_up(bd_size_t val, bd_size_t size)
 
 FlashSimBlockDevice::FlashSimBlockDevice(BlockDevice *bd, uint8_t erase_value) :
     _erase_value(erase_value), _blank_buf_size(0),
-    _blank_buf(0), _bd(bd), _init_ref_count(0), _is_initialized(false)
+    _blank_buf(0), _bd(bd), _init_ref_count(0), _is_initialized(false),
+    _erase_unit_size(0), _num_erase_units(0), _erase_counts(0)
 {
+    memset(&_timing, 0, sizeof(_timing));
+    memset(&_stats, 0, sizeof(_stats));
 }
 
 FlashSimBlockDevice::~FlashSimBlockDevice()
 {
     deinit();
     delete[] _blank_buf;
+    delete[] _erase_counts;
 }
 
 int FlashSimBlockDevice::init()
@@ -61,6 +90,14 @@ int FlashSimBlockDevice::init()
         assert(_blank_buf);
     }
 
+    // Erase counts are kept per smallest erase unit
+    _erase_unit_size = _bd->get_erase_size();
+    if (!_erase_counts && _erase_unit_size) {
+        _num_erase_units = (size_t)(_bd->size() / _erase_unit_size);
+        _erase_counts = new uint32_t[_num_erase_units];
+    }
+    reset_stats();
+
     _is_initialized = true;
     return BD_ERROR_OK;
 
@@ -146,6 +183,10 @@ int FlashSimBlockDevice::read(void *b, bd_addr_t addr, bd_size_t size)
         return BD_ERROR_DEVICE_ERROR;
     }
 
+    _stats.reads++;
+    _stats.read_bytes += size;
+    _stats.read_time_us += op_time(_timing.read_setup_us, _timing.read_us_per_kb, size);
+
     return _bd->read(b, addr, size);
 }
 
@@ -178,6 +219,10 @@ int FlashSimBlockDevice::program(const void *b, bd_addr_t addr, bd_size_t size)
         curr_size -= read_size;
     }
 
+    _stats.programs++;
+    _stats.programmed_bytes += size;
+    _stats.program_time_us += op_time(_timing.program_setup_us, _timing.program_us_per_kb, size);
+
     return _bd->program(b, addr, size);
 }
 
@@ -204,6 +249,18 @@ int FlashSimBlockDevice::erase(bd_addr_t addr, bd_size_t size)
         curr_size -= prog_size;
     }
 
+    _stats.erases++;
+    _stats.erased_bytes += size;
+    if (_erase_counts) {
+        for (bd_addr_t unit_addr = addr; unit_addr < addr + size; unit_addr += _erase_unit_size) {
+            size_t unit = (size_t)(unit_addr / _erase_unit_size);
+            if (unit < _num_erase_units) {
+                _stats.max_unit_erases = std::max(_stats.max_unit_erases, ++_erase_counts[unit]);
+            }
+            _stats.erase_time_us += _timing.erase_us_per_unit;
+        }
+    }
+
     return BD_ERROR_OK;
 }
 
@@ -212,6 +269,47 @@ int FlashSimBlockDevice::get_erase_value() const
     return _erase_value;
 }
 
+void FlashSimBlockDevice::set_timing(const timing_t &timing)
+{
+    _timing = timing;
+}
+
+int FlashSimBlockDevice::get_stats(stats_t &stats) const
+{
+    if (!_is_initialized) {
+        return BD_ERROR_DEVICE_ERROR;
+    }
+
+    stats = _stats;
+    return BD_ERROR_OK;
+}
+
+uint32_t FlashSimBlockDevice::get_erase_count(bd_addr_t addr) const
+{
+    if (!_is_initialized || !_erase_counts) {
+        return 0;
+    }
+
+    size_t unit = (size_t)(addr / _erase_unit_size);
+    if (unit >= _num_erase_units) {
+        return 0;
+    }
+    return _erase_counts[unit];
+}
+
+void FlashSimBlockDevice::reset_stats()
+{
+    memset(&_stats, 0, sizeof(_stats));
+    if (_erase_counts) {
+        memset(_erase_counts, 0, _num_erase_units * sizeof(uint32_t));
+    }
+}
+
+uint64_t FlashSimBlockDevice::op_time(uint32_t setup_us, uint32_t us_per_kb, bd_size_t size) const
+{
+    return setup_us + (uint64_t)us_per_kb * size / 1024;
+}
+
 const char *FlashSimBlockDevice::get_type() const
 {
     if (_bd != NULL) {
@@ -42,6 +42,42 @@ enum {
 class FlashSimBlockDevice : public BlockDevice {
 public:
 
+    /** Latencies of a simulated flash part, in microseconds
+     *
+     *  An operation takes its setup time plus its per KB time for each KB
+     *  (erase: each erase unit) it covers. All zero means no timing model.
+     */
+    struct timing_t {
+        uint32_t read_setup_us;
+        uint32_t read_us_per_kb;
+        uint32_t program_setup_us;
+        uint32_t program_us_per_kb;
+        uint32_t erase_us_per_unit;
+    };
+
+    /** Typical latencies of an internal MCU flash with small sectors */
+    static const timing_t internal_flash_timing;
+
+    /** Typical latencies of a SPI NOR flash with 4KB sectors */
+    static const timing_t spif_timing;
+
+    /** Typical latencies of a quad SPI NOR flash with 4KB sectors */
+    static const timing_t qspi_timing;
+
+    /** Operation counters and simulated time since init or reset_stats() */
+    struct stats_t {
+        uint32_t reads;
+        uint32_t programs;
+        uint32_t erases;
+        uint64_t read_bytes;
+        uint64_t programmed_bytes;
+        uint64_t erased_bytes;
+        uint64_t read_time_us;
+        uint64_t program_time_us;
+        uint64_t erase_time_us;
+        uint32_t max_unit_erases;
+    };
+
     /** Constructor
      *
      * @param bd           Block device to back the FlashSimBlockDevice
@@ -142,13 +178,47 @@ public:
      */
     virtual const char *get_type() const;
 
+    /** Set the timing model of the simulated flash
+     *
+     *  Time is only accounted in the statistics, operations are not delayed,
+     *  so results are the same on every run.
+     *
+     *  @param timing   Latencies of the simulated part
+     */
+    void set_timing(const timing_t &timing);
+
+    /** Get the operation counters and simulated time
+     *
+     *  @param stats    Returned statistics
+     *  @return         0 on success or a negative error code on failure
+     */
+    int get_stats(stats_t &stats) const;
+
+    /** Get the number of times an erase unit has been erased
+     *
+     *  @param addr     Address within the erase unit
+     *  @return         Erase count of the unit, 0 if not initialized
+     */
+    uint32_t get_erase_count(bd_addr_t addr) const;
+
+    /** Clear the operation counters, simulated time and erase counts
+     */
+    void reset_stats();
+
 private:
+    uint64_t op_time(uint32_t setup_us, uint32_t us_per_kb, bd_size_t size) const;
+
     uint8_t _erase_value;
     bd_size_t _blank_buf_size;
     uint8_t *_blank_buf;
     BlockDevice *_bd;
     int32_t _init_ref_count;
     bool _is_initialized;
+    timing_t _timing;
+    stats_t _stats;
+    bd_size_t _erase_unit_size;
+    size_t _num_erase_units;
+    uint32_t *_erase_counts;
 };
 
 } // namespace mbed
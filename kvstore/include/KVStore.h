@@ -127,6 +127,16 @@ public:
      */
     virtual int remove(const char *key) = 0;
 
+    /**
+     * @brief Remove all KVStore items whose key starts with a prefix. Items stored with the
+     *        "write once" flag are kept.
+     *
+     * @param[in]  prefix               Key prefix, must not be empty.
+     *
+     * @returns MBED_SUCCESS on success or an error code on failure
+     */
+    virtual int remove_prefix(const char *prefix) = 0;
+
 
     /**
      * @brief Start an incremental KVStore set sequence.
@@ -160,6 +170,41 @@ public:
      */
     virtual int set_finalize(set_handle_t handle) = 0;
 
+    /**
+     * @brief Start a write batch. Keys set in the batch are stored atomically on batch_commit():
+     *        after a power failure either all or none of them are found. They are not
+     *        visible to get APIs before the commit.
+     *
+     * @returns MBED_SUCCESS on success or an error code on failure
+     */
+    virtual int batch_begin() = 0;
+
+    /**
+     * @brief Set one KVStore item as part of the write batch started with batch_begin().
+     *
+     * @param[in]  key                  Key - must not include '*' '/' '?' ':' ';' '\' '"' '|' ' ' '<' '>' '\'.
+     * @param[in]  buffer               Value data buffer.
+     * @param[in]  size                 Value data size.
+     * @param[in]  create_flags         Flag mask.
+     *
+     * @returns MBED_SUCCESS on success or an error code on failure
+     */
+    virtual int batch_set(const char *key, const void *buffer, size_t size, uint32_t create_flags) = 0;
+
+    /**
+     * @brief Commit the write batch, making all its items visible at once.
+     *
+     * @returns MBED_SUCCESS on success or an error code on failure
+     */
+    virtual int batch_commit() = 0;
+
+    /**
+     * @brief Abort the write batch, dropping all its items.
+     *
+     * @returns MBED_SUCCESS on success or an error code on failure
+     */
+    virtual int batch_abort() = 0;
+
     /**
      * @brief Start an iteration over KVStore keys.
      *
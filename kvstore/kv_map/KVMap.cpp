@@ -170,6 +170,11 @@ int KVMap::lookup(const char *full_name, KVStore **kv_instance, size_t *key_inde
         goto exit;
     }
 
+    ret = deferred_init(kv_config);
+    if (ret != MBED_SUCCESS) {
+        goto exit;
+    }
+
     *kv_instance = kv_config->kvstore_main_instance;
     if (flags_mask != NULL) {
         *flags_mask = kv_config->flags_mask;
@@ -261,6 +266,9 @@ KVStore *KVMap::get_external_kv_instance(const char *name)
     size_t key_index = 0;
 
     int ret = config_lookup(name, &kv_config, &key_index);
+    if (ret == MBED_SUCCESS) {
+        ret = deferred_init(kv_config);
+    }
 
     pal_osMutexRelease(_mutex);
 
@@ -276,6 +284,9 @@ KVStore *KVMap::get_main_kv_instance(const char *name)
     size_t key_index = 0;
 
     int ret = config_lookup(name, &kv_config, &key_index);
+    if (ret == MBED_SUCCESS) {
+        ret = deferred_init(kv_config);
+    }
 
     pal_osMutexRelease(_mutex);
 
@@ -312,5 +323,37 @@ BlockDevice *KVMap::get_external_blockdevice_instance(const char *name)
     return ret != MBED_SUCCESS ? NULL : kv_config->external_bd;
 }
 
+int KVMap::complete_init(const char *name)
+{
+
+    pal_osMutexWait(_mutex, PAL_RTOS_WAIT_FOREVER);
+
+    kvstore_config_t *kv_config;
+    size_t key_index = 0;
+
+    int ret = config_lookup(name, &kv_config, &key_index);
+    if (ret == MBED_SUCCESS) {
+        ret = deferred_init(kv_config);
+    }
+
+    pal_osMutexRelease(_mutex);
+
+    return ret;
+}
+
+int KVMap::deferred_init(kvstore_config_t *kv_config)
+{
+    if (kv_config->deferred_init == NULL) {
+        return MBED_SUCCESS;
+    }
+
+    // A failure is returned to the caller and the initialization is tried again on the next use
+    int ret = kv_config->deferred_init();
+    if (ret == MBED_SUCCESS) {
+        kv_config->deferred_init = NULL;
+    }
+    return ret;
+}
+
 } // namespace mbed
 
@@ -62,6 +62,12 @@ typedef struct {
      * prevent errors in case the user choose an different security level.
      */
     uint32_t flags_mask;
+    /**
+     * Completes the initialization of the partition on the first use of its main or
+     * external store, so the internal store can be used before the external block
+     * device has been mounted. NULL once the partition is fully initialized.
+     */
+    int (*deferred_init)(void);
 } kvstore_config_t;
 
 /**
@@ -193,6 +199,15 @@ public:
      *         NULL on failure or if not exist
      */
     BlockDevice *get_external_blockdevice_instance(const char *name);
+    /**
+     * @brief Completes a deferred initialization of a partition now, instead of on
+     *        the first use of its main or external store.
+     *
+     * @param name String parameter contains the /partition name/.
+     *
+     * @return 0 on success, negative error code on failure
+     */
+    int complete_init(const char *name);
 
 #if !defined(DOXYGEN_ONLY)
 private:
@@ -214,6 +229,15 @@ private:
      */
     int config_lookup(const char *full_name, kvstore_config_t **kv_config, size_t *key_index);
 
+    /**
+     * @brief Runs the deferred initialization of a partition, if it has not been run yet.
+     *        Called with the mutex held.
+     *
+     * @param[in] kv_config  Partition configuration struct.
+     * @return 0 on success, negative error code on failure
+     */
+    int deferred_init(kvstore_config_t *kv_config);
+
     // Attachment table
     kv_map_entry_t _kv_map_table[MAX_ATTACHED_KVS];
     int _kv_num_attached_kvs;
@@ -73,6 +73,15 @@ typedef struct {
     KVStore::iterator_t underlying_it;
 } key_iterator_handle_t;
 
+// Derived keys of a record, cached as deriving them on each access is costly
+typedef struct {
+    char key[KVStore::MAX_KEY_SIZE + 1];
+    uint8_t enc_key[derived_key_size];
+    uint8_t auth_key[derived_key_size];
+    bool enc_key_valid;
+    uint32_t last_use;  // 0 for an unused entry
+} key_cache_entry_t;
+
 } // anonymous namespace
 
 
@@ -80,28 +89,34 @@ typedef struct {
 
 // -------------------------------------------------- Functions Implementation ----------------------------------------------------
 
-int encrypt_decrypt_start(mbedtls_aes_context &enc_aes_ctx, uint8_t *iv, const char *key,
-                          uint8_t *ctr_buf, uint8_t *salt_buf, int salt_buf_size)
+// Not optimized away like memset, so key material does not remain in memory
+static void zeroize(void *buf, size_t size)
+{
+    volatile uint8_t *ptr = static_cast<volatile uint8_t *>(buf);
+    while (size--) {
+        *ptr++ = 0;
+    }
+}
+
+int derive_key(const char *prefix, const char *key, uint8_t *derived_key, uint8_t *salt_buf, int salt_buf_size)
 {
     DeviceKey &devkey = DeviceKey::get_instance();
     char *salt = reinterpret_cast<char *>(salt_buf);
-    uint8_t encrypt_key[derived_key_size];
-    strcpy(salt, enc_prefix);
-    int pos = strlen(enc_prefix);
+    strcpy(salt, prefix);
+    int pos = strlen(prefix);
     strncpy(salt + pos, key, salt_buf_size - pos - 1);
     salt_buf[salt_buf_size - 1] = 0;
-    int os_ret = devkey.generate_derived_key(salt_buf, strlen(salt), encrypt_key,  DEVICE_KEY_16BYTE);
-    if (os_ret) {
-        return os_ret;
-    }
+    return devkey.generate_derived_key(salt_buf, strlen(salt), derived_key, DEVICE_KEY_16BYTE);
+}
 
+void encrypt_decrypt_start(mbedtls_aes_context &enc_aes_ctx, uint8_t *iv, const uint8_t *encrypt_key,
+                           uint8_t *ctr_buf)
+{
     mbedtls_aes_init(&enc_aes_ctx);
     mbedtls_aes_setkey_enc(&enc_aes_ctx, encrypt_key, enc_block_size * 8);
 
     memcpy(ctr_buf, iv, iv_size);
     memset(ctr_buf + iv_size, 0, iv_size);
-
-    return 0;
 }
 
 int encrypt_decrypt_data(mbedtls_aes_context &enc_aes_ctx, const uint8_t *in_buf,
@@ -113,20 +128,9 @@ int encrypt_decrypt_data(mbedtls_aes_context &enc_aes_ctx, const uint8_t *in_buf
                                  stream_block, in_buf, out_buf);
 }
 
-int cmac_calc_start(mbedtls_cipher_context_t &auth_ctx, const char *key, uint8_t *salt_buf, int salt_buf_size)
+int cmac_calc_start(mbedtls_cipher_context_t &auth_ctx, const uint8_t *auth_key)
 {
-    DeviceKey &devkey = DeviceKey::get_instance();
-    char *salt = reinterpret_cast<char *>(salt_buf);
-    uint8_t auth_key[derived_key_size];
-    strcpy(salt, auth_prefix);
-    int pos = strlen(auth_prefix);
-    strncpy(salt + pos, key, salt_buf_size - pos - 1);
-    salt_buf[salt_buf_size - 1] = 0;
-    int os_ret = devkey.generate_derived_key(salt_buf, strlen(salt), auth_key, DEVICE_KEY_16BYTE);
-    if (os_ret) {
-        return os_ret;
-    }
-
+    int os_ret;
     const mbedtls_cipher_info_t *cipher_info = mbedtls_cipher_info_from_type(MBEDTLS_CIPHER_AES_128_ECB);
 
     mbedtls_cipher_init(&auth_ctx);
@@ -167,7 +171,7 @@ int cmac_calc_finish(mbedtls_cipher_context_t &auth_ctx, uint8_t *output)
 
 SecureStore::SecureStore(KVStore *underlying_kv, KVStore *rbp_kv) :
     _is_initialized(false), _underlying_kv(underlying_kv), _rbp_kv(rbp_kv), _entropy(0),
-    _inc_set_handle(0), _scratch_buf(0)
+    _inc_set_handle(0), _scratch_buf(0), _batch_in_progress(false), _key_cache(0), _key_cache_use_count(0)
 {
 }
 
@@ -177,6 +181,65 @@ SecureStore::~SecureStore()
 }
 
 
+int SecureStore::get_derived_keys(const char *key, uint8_t *enc_key, uint8_t *auth_key)
+{
+    key_cache_entry_t *cache = static_cast<key_cache_entry_t *>(_key_cache);
+    key_cache_entry_t *entry = 0, *lru_entry = 0;
+    int os_ret;
+
+    if (cache) {
+        for (uint32_t i = 0; i < MBED_CONF_STORAGE_SECURESTORE_KEY_CACHE_ENTRIES; i++) {
+            if (cache[i].last_use && !strcmp(cache[i].key, key)) {
+                entry = &cache[i];
+                break;
+            }
+            if (!lru_entry || (cache[i].last_use < lru_entry->last_use)) {
+                lru_entry = &cache[i];
+            }
+        }
+    }
+
+    if (!entry && lru_entry) {
+        entry = lru_entry;
+        zeroize(entry, sizeof(key_cache_entry_t));
+        strcpy(entry->key, key);
+        os_ret = derive_key(auth_prefix, key, entry->auth_key, _scratch_buf, scratch_buf_size);
+        if (os_ret) {
+            zeroize(entry, sizeof(key_cache_entry_t));
+            return os_ret;
+        }
+    }
+
+    if (!entry) {
+        // No cache, derive directly to the caller
+        os_ret = derive_key(auth_prefix, key, auth_key, _scratch_buf, scratch_buf_size);
+        if (os_ret || !enc_key) {
+            return os_ret;
+        }
+        return derive_key(enc_prefix, key, enc_key, _scratch_buf, scratch_buf_size);
+    }
+
+    // Encryption key is only derived for records that need it
+    if (enc_key && !entry->enc_key_valid) {
+        os_ret = derive_key(enc_prefix, key, entry->enc_key, _scratch_buf, scratch_buf_size);
+        if (os_ret) {
+            return os_ret;
+        }
+        entry->enc_key_valid = true;
+    }
+
+    if (!++_key_cache_use_count) {
+        _key_cache_use_count = 1;
+    }
+    entry->last_use = _key_cache_use_count;
+
+    memcpy(auth_key, entry->auth_key, derived_key_size);
+    if (enc_key) {
+        memcpy(enc_key, entry->enc_key, derived_key_size);
+    }
+    return 0;
+}
+
 int SecureStore::set_start(set_handle_t *handle, const char *key, size_t final_data_size,
                            uint32_t create_flags)
 {
@@ -184,6 +247,7 @@ int SecureStore::set_start(set_handle_t *handle, const char *key, size_t final_d
     inc_set_handle_t *ih;
     info_t info;
     bool enc_started = false, auth_started = false;
+    uint8_t enc_key[derived_key_size], auth_key[derived_key_size];
 
     if (!_is_initialized) {
         return MBED_ERROR_NOT_READY;
@@ -241,18 +305,22 @@ int SecureStore::set_start(set_handle_t *handle, const char *key, size_t final_d
             ret = MBED_ERROR_FAILED_OPERATION;
             goto fail;
         }
-        os_ret = encrypt_decrypt_start(ih->enc_ctx, ih->metadata.iv, key, ih->ctr_buf, _scratch_buf,
-                                       scratch_buf_size);
-        if (os_ret) {
-            ret = MBED_ERROR_FAILED_OPERATION;
-            goto fail;
-        }
-        enc_started = true;
     } else {
         memset(ih->metadata.iv, 0, iv_size);
     }
 
-    os_ret = cmac_calc_start(ih->auth_ctx, key, _scratch_buf, scratch_buf_size);
+    os_ret = get_derived_keys(key, (create_flags & REQUIRE_CONFIDENTIALITY_FLAG) ? enc_key : 0, auth_key);
+    if (os_ret) {
+        ret = MBED_ERROR_FAILED_OPERATION;
+        goto fail;
+    }
+
+    if (create_flags & REQUIRE_CONFIDENTIALITY_FLAG) {
+        encrypt_decrypt_start(ih->enc_ctx, ih->metadata.iv, enc_key, ih->ctr_buf);
+        enc_started = true;
+    }
+
+    os_ret = cmac_calc_start(ih->auth_ctx, auth_key);
     if (os_ret) {
         ret = MBED_ERROR_FAILED_OPERATION;
         goto fail;
@@ -308,6 +376,8 @@ fail:
     pal_osMutexRelease(_mutex);
 
 end:
+    zeroize(enc_key, derived_key_size);
+    zeroize(auth_key, derived_key_size);
     return ret;
 }
 
@@ -513,6 +583,116 @@ end:
     return ret;
 }
 
+int SecureStore::remove_prefix(const char *prefix)
+{
+    int ret, rbp_ret;
+
+    if (!_is_initialized) {
+        return MBED_ERROR_NOT_READY;
+    }
+
+    pal_osMutexWait(_mutex, PAL_RTOS_WAIT_FOREVER);
+
+    // Same order as remove(). The "write once" flag is passed to both stores, so both keep
+    // the same items.
+    ret = _underlying_kv->remove_prefix(prefix);
+    if ((ret != MBED_SUCCESS) && (ret != MBED_ERROR_WRITE_PROTECTED)) {
+        goto end;
+    }
+
+    if (_rbp_kv) {
+        rbp_ret = _rbp_kv->remove_prefix(prefix);
+        if ((rbp_ret != MBED_SUCCESS) && (rbp_ret != MBED_ERROR_WRITE_PROTECTED)) {
+            ret = rbp_ret;
+        }
+    }
+
+end:
+    pal_osMutexRelease(_mutex);
+    return ret;
+}
+
+int SecureStore::batch_begin()
+{
+    int ret;
+
+    if (!_is_initialized) {
+        return MBED_ERROR_NOT_READY;
+    }
+
+    // Held until the batch ends, the underlying KVStore is locked for the same time
+    pal_osMutexWait(_mutex, PAL_RTOS_WAIT_FOREVER);
+
+    if (_batch_in_progress) {
+        pal_osMutexRelease(_mutex);
+        return MBED_ERROR_INVALID_ARGUMENT;
+    }
+
+    ret = _underlying_kv->batch_begin();
+    if (ret) {
+        pal_osMutexRelease(_mutex);
+        return ret;
+    }
+
+    _batch_in_progress = true;
+    return MBED_SUCCESS;
+}
+
+int SecureStore::batch_set(const char *key, const void *buffer, size_t size, uint32_t create_flags)
+{
+    if (!_is_initialized) {
+        return MBED_ERROR_NOT_READY;
+    }
+
+    if (!_batch_in_progress) {
+        return MBED_ERROR_INVALID_ARGUMENT;
+    }
+
+    // CMAC in RBP store can't be updated atomically with the batch
+    if (_rbp_kv && (create_flags & (REQUIRE_REPLAY_PROTECTION_FLAG | WRITE_ONCE_FLAG))) {
+        return MBED_ERROR_INVALID_ARGUMENT;
+    }
+
+    // Records go to the batch of the underlying KVStore
+    return set(key, buffer, size, create_flags);
+}
+
+int SecureStore::batch_commit()
+{
+    int ret;
+
+    if (!_is_initialized) {
+        return MBED_ERROR_NOT_READY;
+    }
+
+    if (!_batch_in_progress) {
+        return MBED_ERROR_INVALID_ARGUMENT;
+    }
+
+    ret = _underlying_kv->batch_commit();
+    _batch_in_progress = false;
+    pal_osMutexRelease(_mutex);
+    return ret;
+}
+
+int SecureStore::batch_abort()
+{
+    int ret;
+
+    if (!_is_initialized) {
+        return MBED_ERROR_NOT_READY;
+    }
+
+    if (!_batch_in_progress) {
+        return MBED_ERROR_INVALID_ARGUMENT;
+    }
+
+    ret = _underlying_kv->batch_abort();
+    _batch_in_progress = false;
+    pal_osMutexRelease(_mutex);
+    return ret;
+}
+
 int SecureStore::do_get(const char *key, void *buffer, size_t buffer_size, size_t *actual_size,
                         size_t offset, info_t *info)
 {
@@ -528,6 +708,7 @@ int SecureStore::do_get(const char *key, void *buffer, size_t buffer_size, size_
     uint8_t *dest_buf;
     bool enc_started = false, auth_started = false;
     uint32_t create_flags;
+    uint8_t enc_key[derived_key_size], auth_key[derived_key_size];
 
     if (!is_valid_key(key)) {
         return MBED_ERROR_INVALID_ARGUMENT;
@@ -567,7 +748,13 @@ int SecureStore::do_get(const char *key, void *buffer, size_t buffer_size, size_
         goto end;
     }
 
-    os_ret = cmac_calc_start(ih->auth_ctx, key, _scratch_buf, scratch_buf_size);
+    os_ret = get_derived_keys(key, (create_flags & REQUIRE_CONFIDENTIALITY_FLAG) ? enc_key : 0, auth_key);
+    if (os_ret) {
+        ret = MBED_ERROR_FAILED_OPERATION;
+        goto end;
+    }
+
+    os_ret = cmac_calc_start(ih->auth_ctx, auth_key);
     if (os_ret) {
         ret = MBED_ERROR_FAILED_OPERATION;
         goto end;
@@ -587,12 +774,7 @@ int SecureStore::do_get(const char *key, void *buffer, size_t buffer_size, size_
     }
 
     if (create_flags & REQUIRE_CONFIDENTIALITY_FLAG) {
-        os_ret = encrypt_decrypt_start(ih->enc_ctx, ih->metadata.iv, key, ih->ctr_buf, _scratch_buf,
-                                       scratch_buf_size);
-        if (os_ret) {
-            ret = MBED_ERROR_FAILED_OPERATION;
-            goto end;
-        }
+        encrypt_decrypt_start(ih->enc_ctx, ih->metadata.iv, enc_key, ih->ctr_buf);
         enc_started = true;
     }
 
@@ -697,6 +879,8 @@ int SecureStore::do_get(const char *key, void *buffer, size_t buffer_size, size_
 
 end:
     ih->metadata.metadata_size = 0;
+    zeroize(enc_key, derived_key_size);
+    zeroize(auth_key, derived_key_size);
 
     if (enc_started) {
         mbedtls_aes_free(&ih->enc_ctx);
@@ -755,6 +939,12 @@ int SecureStore::init()
     _scratch_buf = new uint8_t[scratch_buf_size];
     _inc_set_handle = new inc_set_handle_t;
 
+    if (MBED_CONF_STORAGE_SECURESTORE_KEY_CACHE_ENTRIES) {
+        _key_cache = new key_cache_entry_t[MBED_CONF_STORAGE_SECURESTORE_KEY_CACHE_ENTRIES];
+        memset(_key_cache, 0, sizeof(key_cache_entry_t) * MBED_CONF_STORAGE_SECURESTORE_KEY_CACHE_ENTRIES);
+        _key_cache_use_count = 0;
+    }
+
     ret = _underlying_kv->init();
     if (ret) {
         goto fail;
@@ -782,6 +972,11 @@ int SecureStore::deinit()
         delete static_cast<mbedtls_entropy_context *>(_entropy);
         delete static_cast<inc_set_handle_t *>(_inc_set_handle);
         delete _scratch_buf;
+        if (_key_cache) {
+            zeroize(_key_cache, sizeof(key_cache_entry_t) * MBED_CONF_STORAGE_SECURESTORE_KEY_CACHE_ENTRIES);
+            delete[] static_cast<key_cache_entry_t *>(_key_cache);
+            _key_cache = 0;
+        }
         // TODO: Deinit member KVs?
     }
 
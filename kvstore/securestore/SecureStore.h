@@ -40,6 +40,14 @@
 #include "KVStore.h"
 #include "pal.h"
 
+/**
+ * Number of records whose derived encryption and authentication keys are kept
+ * in RAM, least recently used ones are evicted. 0 derives the keys on every access.
+ */
+#ifndef MBED_CONF_STORAGE_SECURESTORE_KEY_CACHE_ENTRIES
+#define MBED_CONF_STORAGE_SECURESTORE_KEY_CACHE_ENTRIES 4
+#endif
+
 namespace mbed {
 
 /** TDBStore class
@@ -173,6 +181,68 @@ public:
      */
     virtual int remove(const char *key);
 
+    /**
+     * @brief Remove all KVStore items whose key starts with a prefix, from the underlying
+     *        KVStore and from the rollback protection KVStore. Items stored with the
+     *        "write once" flag are kept.
+     *
+     * @param[in]  prefix               Key prefix, must not be empty.
+     *
+     * @returns MBED_SUCCESS                        Success.
+     *          MBED_ERROR_NOT_READY                Not initialized.
+     *          MBED_ERROR_WRITE_PROTECTED          Some items were kept as they have the "write once" flag.
+     *          or any other error from underlying KVStore instances.
+     */
+    virtual int remove_prefix(const char *prefix);
+
+    /**
+     * @brief Start a write batch in the underlying KVStore. This operation is blocking other operations
+     *        until batch_commit or batch_abort is called.
+     *
+     * @returns MBED_SUCCESS                        Success.
+     *          MBED_ERROR_NOT_READY                Not initialized.
+     *          MBED_ERROR_INVALID_ARGUMENT         Batch already started.
+     *          or any other error from underlying KVStore instances.
+     */
+    virtual int batch_begin();
+
+    /**
+     * @brief Set one KVStore item in the write batch. Items requiring rollback protection or
+     *        written once can't be batched, as they are also stored in the rollback protection KVStore.
+     *
+     * @param[in]  key                  Key - must not include '*' '/' '?' ':' ';' '\' '"' '|' ' ' '<' '>' '\'.
+     * @param[in]  buffer               Value data buffer.
+     * @param[in]  size                 Value data size.
+     * @param[in]  create_flags         Flag mask - REQUIRE_CONFIDENTIALITY_FLAG|REQUIRE_INTEGRITY_FLAG
+     *
+     * @returns MBED_SUCCESS                        Success.
+     *          MBED_ERROR_NOT_READY                Not initialized.
+     *          MBED_ERROR_INVALID_ARGUMENT         No batch started or invalid argument given in function arguments.
+     *          MBED_ERROR_FAILED_OPERATION         Internal error.
+     *          or any other error from underlying KVStore instances.
+     */
+    virtual int batch_set(const char *key, const void *buffer, size_t size, uint32_t create_flags);
+
+    /**
+     * @brief Commit the write batch.
+     *
+     * @returns MBED_SUCCESS                        Success.
+     *          MBED_ERROR_NOT_READY                Not initialized.
+     *          MBED_ERROR_INVALID_ARGUMENT         No batch started.
+     *          or any other error from underlying KVStore instances.
+     */
+    virtual int batch_commit();
+
+    /**
+     * @brief Abort the write batch.
+     *
+     * @returns MBED_SUCCESS                        Success.
+     *          MBED_ERROR_NOT_READY                Not initialized.
+     *          MBED_ERROR_INVALID_ARGUMENT         No batch started.
+     *          or any other error from underlying KVStore instances.
+     */
+    virtual int batch_abort();
+
 
     /**
      * @brief Start an incremental KVStore set sequence. This operation is blocking other operations.
@@ -276,6 +346,20 @@ private:
     void *_entropy;
     void *_inc_set_handle;
     uint8_t *_scratch_buf;
+    bool _batch_in_progress;
+    void *_key_cache;
+    uint32_t _key_cache_use_count;
+
+    /**
+     * @brief Get derived keys of a record, from the cache or by deriving them from the device key.
+     *
+     * @param[in]  key                  Key.
+     * @param[out] enc_key              Returned encryption key (null if not needed).
+     * @param[out] auth_key             Returned authentication key.
+     *
+     * @returns 0 on success or a nonzero error code on failure
+     */
+    int get_derived_keys(const char *key, uint8_t *enc_key, uint8_t *auth_key);
 
     /**
      * @brief Actual get function, serving get and get_info APIs.
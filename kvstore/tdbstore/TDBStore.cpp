@@ -28,7 +28,14 @@ using namespace mbed;
 // --------------------------------------------------------- Definitions ----------------------------------------------------------
 
 static const uint32_t delete_flag = (1UL << 31);
-static const uint32_t internal_flags = delete_flag;
+// Write batch markers, stored as records with the master record key
+static const uint32_t batch_begin_flag = (1UL << 30);
+static const uint32_t batch_commit_flag = (1UL << 29);
+static const uint32_t batch_abort_flag = (1UL << 28);
+static const uint32_t batch_marker_flags = batch_begin_flag | batch_commit_flag | batch_abort_flag;
+// RAM table snapshot, stored as a record with the master record key
+static const uint32_t checkpoint_flag = (1UL << 27);
+static const uint32_t internal_flags = delete_flag | batch_marker_flags | checkpoint_flag;
 // Only write once flag is supported, other two are kept in storage but ignored
 static const uint32_t supported_flags = KVStore::WRITE_ONCE_FLAG | KVStore::REQUIRE_CONFIDENTIALITY_FLAG | KVStore::REQUIRE_REPLAY_PROTECTION_FLAG;
 
@@ -45,9 +52,17 @@ typedef struct {
     uint32_t crc;
 } record_header_t;
 
+// Entries are sorted by hash in descending order. Key hint is a second, independent
+// hash of the key, so that most hash collisions are resolved without reading the
+// record. Prefix fingerprint lets iterations skip most keys that do not match the
+// prefix without reading the record. gc_offset is the offset of the record copy in the standby area during
+// incremental garbage collection, 0 if not copied yet.
 typedef struct {
     uint32_t  hash;
-    bd_size_t bd_offset;
+    uint16_t  key_hint;
+    uint16_t  prefix_fp;
+    uint32_t  bd_offset;
+    uint32_t  gc_offset;
 } ram_table_entry_t;
 
 static const char *master_rec_key = "TDBS";
@@ -60,6 +75,21 @@ typedef struct {
     uint32_t reserved;
 } master_record_data_t;
 
+// RAM table snapshot written at garbage collection. Master record of the area points to it,
+// so that init only needs to scan the records written after it.
+typedef struct {
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t num_keys;
+} checkpoint_data_t;
+
+typedef struct {
+    uint32_t hash;
+    uint16_t key_hint;
+    uint16_t prefix_fp;
+    uint32_t bd_offset;
+} checkpoint_entry_t;
+
 typedef enum {
     TDBSTORE_AREA_STATE_NONE = 0,
     TDBSTORE_AREA_STATE_EMPTY,
@@ -83,7 +113,10 @@ typedef struct {
     uint32_t offset_in_data;
     uint32_t ram_table_ind;
     uint32_t hash;
+    uint16_t key_hint;
+    uint16_t prefix_fp;
     bool new_key;
+    bool batch;
 } inc_set_handle_t;
 
 // iterator handle
@@ -91,6 +124,8 @@ typedef struct {
     int iterator_num;
     uint32_t ram_table_ind;
     char *prefix;
+    size_t prefix_len;
+    uint16_t prefix_fp;
 } key_iterator_handle_t;
 
 } // anonymous namespace
@@ -129,12 +164,67 @@ static uint32_t calc_crc(uint32_t init_crc, uint32_t size, const void *buffer)
     return crc;
 }
 
+// FNV-1a, folded to 16 bits. Independent of the CRC used as the primary key hash.
+static uint16_t calc_key_hint(const char *key)
+{
+    uint32_t hint = 0x811C9DC5;
+
+    for (const uint8_t *data = (const uint8_t *)key; *data; data++) {
+        hint = (hint ^ *data) * 0x01000193;
+    }
+
+    return (uint16_t)((hint >> 16) ^ hint);
+}
+
+// Prefix fingerprint holds 5 bit hashes of the first 4, 8 and 16 characters of the key.
+// A key can only start with a prefix of at least 4 characters if its hash of as many
+// characters as the longest of these that fits in the prefix is the same as the prefix's.
+// The top bit marks the fingerprint valid, checkpoints of older versions have none.
+static const uint16_t prefix_fp_valid = 0x8000;
+static const uint8_t prefix_fp_lengths[] = {4, 8, 16};
+static const int prefix_fp_hash_bits = 5;
+
+static uint16_t calc_prefix_fp(const char *key)
+{
+    uint32_t hash = 0x811C9DC5;
+    uint16_t fp = prefix_fp_valid;
+    size_t len = 0;
+
+    for (size_t i = 0; i < sizeof(prefix_fp_lengths); i++) {
+        for (; (len < prefix_fp_lengths[i]) && key[len]; len++) {
+            hash = (hash ^ (uint8_t)key[len]) * 0x01000193;
+        }
+        fp |= (uint16_t)(((hash >> 16) ^ hash) & ((1 << prefix_fp_hash_bits) - 1)) << (i * prefix_fp_hash_bits);
+    }
+
+    return fp;
+}
+
+static bool prefix_fp_may_match(uint16_t key_fp, uint16_t prefix_fp, size_t prefix_len)
+{
+    if (!(key_fp & prefix_fp_valid)) {
+        return true;
+    }
+
+    for (int i = sizeof(prefix_fp_lengths) - 1; i >= 0; i--) {
+        if (prefix_len >= prefix_fp_lengths[i]) {
+            uint16_t mask = ((1 << prefix_fp_hash_bits) - 1) << (i * prefix_fp_hash_bits);
+            return (key_fp & mask) == (prefix_fp & mask);
+        }
+    }
+
+    return true;
+}
+
 // Class member functions
 
 TDBStore::TDBStore(BlockDevice *bd) : _ram_table(0), _max_keys(0),
     _num_keys(0), _bd(bd), _buff_bd(0),  _free_space_offset(0), _master_record_offset(0),
     _master_record_size(0), _is_initialized(false), _active_area(0), _active_area_version(0), _size(0),
-    _area_params{}, _prog_size(0), _work_buf(0), _key_buf(0), _variant_bd_erase_unit_size(false), _inc_set_handle(0)
+    _area_params{}, _prog_size(0), _work_buf(0), _key_buf(0), _variant_bd_erase_unit_size(false), _inc_set_handle(0),
+    _gc_in_progress(false), _gc_ram_table_ind(0), _gc_offset(0), _gc_last_free_offset(0),
+    _batch_in_progress(false), _batch_offset(0), _checkpoint_offset(0), _bd_read_mutex(0), _readers_done_sem(0),
+    _num_readers(0), _writer_waiting(0), _reader_bufs_busy(0), _reader_work_bufs(0)
 {
     for (int i = 0; i < _num_areas; i++) {
         _area_params[i] = { 0 };
@@ -155,7 +245,14 @@ int TDBStore::read_area(uint8_t area, uint32_t offset, uint32_t size, void *buf)
     if (offset + size > _size) {
         return MBED_ERROR_READ_FAILED;
     }
+#if MBED_CONF_STORAGE_TDB_CONCURRENT_READERS
+    // Readers share the buffered block device
+    pal_osMutexWait(_bd_read_mutex, PAL_RTOS_WAIT_FOREVER);
     int os_ret = _buff_bd->read(buf, _area_params[area].address + offset, size);
+    pal_osMutexRelease(_bd_read_mutex);
+#else
+    int os_ret = _buff_bd->read(buf, _area_params[area].address + offset, size);
+#endif
 
     if (os_ret) {
         return MBED_ERROR_READ_FAILED;
@@ -213,7 +310,8 @@ int TDBStore::read_record(uint8_t area, uint32_t offset, char *key,
                           void *data_buf, uint32_t data_buf_size,
                           uint32_t &actual_data_size, size_t data_offset, bool copy_key,
                           bool copy_data, bool check_expected_key, bool calc_hash,
-                          uint32_t &hash, uint32_t &flags, uint32_t &next_offset)
+                          uint32_t &hash, uint32_t &flags, uint32_t &next_offset,
+                          uint8_t *work_buf)
 {
     int ret;
     record_header_t header;
@@ -225,6 +323,10 @@ int TDBStore::read_record(uint8_t area, uint32_t offset, char *key,
     // so only validate entire record at first chunk (otherwise we'll have a serious performance penalty).
     bool validate = (data_offset == 0);
 
+    if (!work_buf) {
+        work_buf = _work_buf;
+    }
+
     ret = MBED_SUCCESS;
     // next offset should only be updated to the end of record if successful
     next_offset = offset;
@@ -296,7 +398,7 @@ int TDBStore::read_record(uint8_t area, uint32_t offset, char *key,
                 chunk_size = key_size;
                 user_key_ptr[key_size] = '\0';
             } else {
-                dest_buf = _work_buf;
+                dest_buf = work_buf;
                 chunk_size = std::min(key_size, _prog_size);
             }
         } else {
@@ -308,13 +410,13 @@ int TDBStore::read_record(uint8_t area, uint32_t offset, char *key,
             // 4. Copy data flag not set - read to work buffer
             if (curr_data_offset < data_offset) {
                 chunk_size = std::min((size_t)_prog_size, (size_t)(data_offset - curr_data_offset));
-                dest_buf = _work_buf;
+                dest_buf = work_buf;
             } else if (copy_data && (curr_data_offset < data_offset + actual_data_size)) {
                 chunk_size = actual_data_size;
                 dest_buf = static_cast<uint8_t *>(data_buf);
             } else {
                 chunk_size = std::min(_prog_size, total_size);
-                dest_buf = _work_buf;
+                dest_buf = work_buf;
             }
         }
         ret = read_area(area, offset, chunk_size, dest_buf);
@@ -364,28 +466,45 @@ end:
 }
 
 int TDBStore::find_record(uint8_t area, const char *key, uint32_t &offset,
-                          uint32_t &ram_table_ind, uint32_t &hash)
+                          uint32_t &ram_table_ind, uint32_t &hash, uint8_t *work_buf)
 {
     ram_table_entry_t *ram_table = (ram_table_entry_t *) _ram_table;
     ram_table_entry_t *entry;
     int ret = MBED_ERROR_ITEM_NOT_FOUND;
     uint32_t actual_data_size;
     uint32_t flags, dummy_hash, next_offset;
+    uint32_t low, high, mid;
+    uint16_t key_hint;
 
 
     hash = calc_crc(initial_crc, strlen(key), key);
+    key_hint = calc_key_hint(key);
+
+    // Binary search for the first entry whose hash is not greater than ours
+    low = 0;
+    high = _num_keys;
+    while (low < high) {
+        mid = low + (high - low) / 2;
+        if (ram_table[mid].hash > hash) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
 
-    for (ram_table_ind = 0; ram_table_ind < _num_keys; ram_table_ind++) {
+    // Go over entries with the same hash. If none matches, index ends up after them,
+    // which is where a new record is to be inserted.
+    for (ram_table_ind = low; ram_table_ind < _num_keys; ram_table_ind++) {
         entry = &ram_table[ram_table_ind];
         offset = entry->bd_offset;
-        if (hash < entry->hash)  {
-            continue;
-        }
         if (hash > entry->hash)  {
             return MBED_ERROR_ITEM_NOT_FOUND;
         }
+        if (key_hint != entry->key_hint) {
+            continue;
+        }
         ret = read_record(_active_area, offset, const_cast<char *>(key), 0, 0, actual_data_size, 0,
-                          false, false, true, false, dummy_hash, flags, next_offset);
+                          false, false, true, false, dummy_hash, flags, next_offset, work_buf);
         // not found return code here means that hash doesn't belong to name. Continue searching.
         if (ret != MBED_ERROR_ITEM_NOT_FOUND) {
             break;
@@ -422,7 +541,7 @@ int TDBStore::set_start(set_handle_t *handle, const char *key, size_t final_data
     *handle = reinterpret_cast<set_handle_t>(_inc_set_handle);
     ih = reinterpret_cast<inc_set_handle_t *>(*handle);
 
-    if (!strcmp(key, master_rec_key)) {
+    if (!strcmp(key, master_rec_key) && !(create_flags & batch_marker_flags)) {
         // Master record - special case (no need to protect by the mutex, as it is already covered
         // in the upper layers).
         ih->bd_base_offset = _master_record_offset;
@@ -431,7 +550,7 @@ int TDBStore::set_start(set_handle_t *handle, const char *key, size_t final_data
         hash = 0;
     } else {
 
-        pal_osMutexWait(_mutex, PAL_RTOS_WAIT_FOREVER);
+        write_lock();
 
         // A valid magic in the header means that this function has been called after an aborted
         // incremental set process. This means that our media may be in a bad state - call GC.
@@ -473,7 +592,7 @@ int TDBStore::set_start(set_handle_t *handle, const char *key, size_t final_data
             if (create_flags & delete_flag) {
                 goto fail;
             }
-            if (_num_keys >= _max_keys) {
+            if ((_num_keys >= _max_keys) && !(create_flags & batch_marker_flags)) {
                 increment_max_keys();
             }
             ih->new_key = true;
@@ -492,7 +611,11 @@ int TDBStore::set_start(set_handle_t *handle, const char *key, size_t final_data
     ih->bd_curr_offset = ih->bd_base_offset + align_up(sizeof(record_header_t), _prog_size);
     ih->offset_in_data = 0;
     ih->hash = hash;
+    ih->key_hint = calc_key_hint(key);
+    ih->prefix_fp = calc_prefix_fp(key);
     ih->ram_table_ind = ram_table_ind;
+    // Records of a write batch are taken into use only when it is committed
+    ih->batch = _batch_in_progress && (ih->bd_base_offset != _master_record_offset);
     ih->header.magic = tdbstore_magic;
     ih->header.header_size = sizeof(record_header_t);
     ih->header.revision = tdbstore_revision;
@@ -520,7 +643,7 @@ fail:
     // mark handle as invalid by clearing magic field in header
     ih->header.magic = 0;
 
-    pal_osMutexRelease(_mutex);
+    write_unlock();
 
 end:
     return ret;
@@ -579,8 +702,6 @@ int TDBStore::set_finalize(set_handle_t handle)
 {
     int os_ret, ret = MBED_SUCCESS;
     inc_set_handle_t *ih;
-    ram_table_entry_t *ram_table = (ram_table_entry_t *) _ram_table;
-    ram_table_entry_t *entry;
     bool need_gc = false;
     uint32_t actual_data_size, hash, flags, next_offset;
 
@@ -632,26 +753,13 @@ int TDBStore::set_finalize(set_handle_t handle)
         goto end;
     }
 
-    // Update RAM table
-    if (ih->header.flags & delete_flag) {
-        _num_keys--;
-        if (ih->ram_table_ind < _num_keys) {
-            memmove(&ram_table[ih->ram_table_ind], &ram_table[ih->ram_table_ind + 1],
-                    sizeof(ram_table_entry_t) * (_num_keys - ih->ram_table_ind));
+    if (ih->batch) {
+        if (ih->header.flags & batch_begin_flag) {
+            _batch_offset = ih->bd_base_offset;
         }
-        update_all_iterators(false, ih->ram_table_ind);
     } else {
-        if (ih->new_key) {
-            if (ih->ram_table_ind < _num_keys) {
-                memmove(&ram_table[ih->ram_table_ind + 1], &ram_table[ih->ram_table_ind],
-                        sizeof(ram_table_entry_t) * (_num_keys - ih->ram_table_ind));
-            }
-            _num_keys++;
-            update_all_iterators(true, ih->ram_table_ind);
-        }
-        entry = &ram_table[ih->ram_table_ind];
-        entry->hash = ih->hash;
-        entry->bd_offset = ih->bd_base_offset;
+        update_ram_table(ih->ram_table_ind, ih->new_key, ih->hash, ih->key_hint, ih->prefix_fp,
+                         ih->header.flags, ih->bd_base_offset);
     }
 
     _free_space_offset = align_up(ih->bd_curr_offset, _prog_size);
@@ -675,11 +783,192 @@ end:
         if (need_gc) {
             garbage_collection();
         }
-        pal_osMutexRelease(_mutex);
+        write_unlock();
+    }
+    return ret;
+}
+
+void TDBStore::update_ram_table(uint32_t ram_table_ind, bool new_key, uint32_t hash, uint16_t key_hint, uint16_t prefix_fp,
+                                uint32_t flags, uint32_t bd_offset)
+{
+    ram_table_entry_t *ram_table = (ram_table_entry_t *) _ram_table;
+    ram_table_entry_t *entry;
+    uint32_t next_offset;
+
+    if (flags & delete_flag) {
+        if (_gc_in_progress) {
+            // Record already copied to standby area must be deleted there too
+            entry = &ram_table[ram_table_ind];
+            if (entry->gc_offset) {
+                if (copy_record(_active_area, bd_offset, _gc_offset, next_offset)) {
+                    _gc_in_progress = false;
+                } else {
+                    _gc_offset = next_offset;
+                }
+            }
+            if (ram_table_ind < _gc_ram_table_ind) {
+                _gc_ram_table_ind--;
+            }
+        }
+        _num_keys--;
+        if (ram_table_ind < _num_keys) {
+            memmove(&ram_table[ram_table_ind], &ram_table[ram_table_ind + 1],
+                    sizeof(ram_table_entry_t) * (_num_keys - ram_table_ind));
+        }
+        update_all_iterators(false, ram_table_ind);
+    } else {
+        if (new_key) {
+            if (ram_table_ind < _num_keys) {
+                memmove(&ram_table[ram_table_ind + 1], &ram_table[ram_table_ind],
+                        sizeof(ram_table_entry_t) * (_num_keys - ram_table_ind));
+            }
+            _num_keys++;
+            update_all_iterators(true, ram_table_ind);
+        }
+        entry = &ram_table[ram_table_ind];
+        entry->hash = hash;
+        entry->key_hint = key_hint;
+        entry->prefix_fp = prefix_fp;
+        entry->bd_offset = bd_offset;
+        // New record needs to be (re)copied by compaction in progress
+        entry->gc_offset = 0;
+        if (_gc_in_progress && (ram_table_ind < _gc_ram_table_ind)) {
+            _gc_ram_table_ind = ram_table_ind;
+        }
+    }
+}
+
+int TDBStore::write_batch_marker(uint32_t flags)
+{
+    return set(master_rec_key, 0, 0, flags);
+}
+
+int TDBStore::batch_begin()
+{
+    int ret;
+
+    if (!_is_initialized) {
+        return MBED_ERROR_NOT_READY;
+    }
+
+    // Held until the batch ends, so that no other records get between the batch records
+    write_lock();
+
+    if (_batch_in_progress) {
+        write_unlock();
+        return MBED_ERROR_INVALID_ARGUMENT;
     }
+
+    _batch_in_progress = true;
+    _batch_offset = _free_space_offset;
+
+    ret = write_batch_marker(batch_begin_flag);
+    if (ret) {
+        _batch_in_progress = false;
+        write_unlock();
+    }
+
     return ret;
 }
 
+int TDBStore::batch_set(const char *key, const void *buffer, size_t size, uint32_t create_flags)
+{
+    if (!_is_initialized) {
+        return MBED_ERROR_NOT_READY;
+    }
+
+    if (!_batch_in_progress || (create_flags & internal_flags)) {
+        return MBED_ERROR_INVALID_ARGUMENT;
+    }
+
+    return set(key, buffer, size, create_flags);
+}
+
+int TDBStore::apply_batch()
+{
+    uint32_t offset, next_offset, dummy;
+    uint32_t hash, flags, actual_data_size;
+    uint32_t ram_table_ind;
+    int ret;
+
+    // Skip the begin marker
+    ret = read_record(_active_area, _batch_offset, 0, 0, 0, actual_data_size, 0,
+                      false, false, false, false, hash, flags, next_offset);
+    if (ret) {
+        return ret;
+    }
+    offset = next_offset;
+
+    while (offset < _free_space_offset) {
+        ret = read_record(_active_area, offset, _key_buf, 0, 0, actual_data_size, 0,
+                          true, false, false, true, hash, flags, next_offset);
+        if (ret) {
+            return ret;
+        }
+
+        if (flags & batch_commit_flag) {
+            break;
+        }
+
+        ret = find_record(_active_area, _key_buf, dummy, ram_table_ind, hash);
+        if ((ret != MBED_SUCCESS) && (ret != MBED_ERROR_ITEM_NOT_FOUND)) {
+            return ret;
+        }
+
+        if (ret == MBED_ERROR_ITEM_NOT_FOUND) {
+            if (!(flags & delete_flag)) {
+                if (_num_keys >= _max_keys) {
+                    increment_max_keys();
+                }
+                update_ram_table(ram_table_ind, true, hash, calc_key_hint(_key_buf), calc_prefix_fp(_key_buf), flags, offset);
+            }
+        } else {
+            update_ram_table(ram_table_ind, false, hash, calc_key_hint(_key_buf), calc_prefix_fp(_key_buf), flags, offset);
+        }
+
+        offset = next_offset;
+    }
+
+    return MBED_SUCCESS;
+}
+
+int TDBStore::end_batch(uint32_t marker_flags)
+{
+    int ret;
+
+    if (!_is_initialized) {
+        return MBED_ERROR_NOT_READY;
+    }
+
+    if (!_batch_in_progress) {
+        return MBED_ERROR_INVALID_ARGUMENT;
+    }
+
+    ret = write_batch_marker(marker_flags);
+    _batch_in_progress = false;
+
+    if (ret) {
+        // Without an end marker the batch would swallow the records written after it
+        // on the next init, compact the area to get rid of it.
+        garbage_collection();
+    } else if (marker_flags & batch_commit_flag) {
+        ret = apply_batch();
+    }
+
+    write_unlock();
+    return ret;
+}
+
+int TDBStore::batch_commit()
+{
+    return end_batch(batch_commit_flag);
+}
+
+int TDBStore::batch_abort()
+{
+    return end_batch(batch_abort_flag);
+}
+
 int TDBStore::set(const char *key, const void *buffer, size_t size, uint32_t create_flags)
 {
     int ret;
@@ -709,6 +998,95 @@ int TDBStore::remove(const char *key)
     return set(key, 0, 0, delete_flag);
 }
 
+int TDBStore::remove_prefix(const char *prefix)
+{
+    ram_table_entry_t *ram_table = (ram_table_entry_t *) _ram_table;
+    uint32_t actual_data_size, hash, flags, next_offset;
+    uint32_t *remove_bits = 0;
+    size_t prefix_len, ind, num_kept;
+    uint16_t prefix_fp;
+    bool write_protected = false;
+    int area;
+    int ret = MBED_SUCCESS;
+
+    if (!_is_initialized) {
+        return MBED_ERROR_NOT_READY;
+    }
+
+    if (!prefix || !strcmp(prefix, "")) {
+        return MBED_ERROR_INVALID_ARGUMENT;
+    }
+
+    write_lock();
+
+    if (_batch_in_progress) {
+        ret = MBED_ERROR_INVALID_ARGUMENT;
+        goto end;
+    }
+
+    prefix_len = strlen(prefix);
+    prefix_fp = calc_prefix_fp(prefix);
+
+    // Find the keys to remove first, so that a read error leaves the RAM table as it is
+    remove_bits = new uint32_t[_num_keys / 32 + 1];
+    memset(remove_bits, 0, sizeof(uint32_t) * (_num_keys / 32 + 1));
+    for (ind = 0; ind < _num_keys; ind++) {
+        if (!prefix_fp_may_match(ram_table[ind].prefix_fp, prefix_fp, prefix_len)) {
+            continue;
+        }
+        ret = read_record(_active_area, ram_table[ind].bd_offset, _key_buf,
+                          0, 0, actual_data_size, 0, true, false, false, false, hash, flags, next_offset);
+        if (ret) {
+            goto end;
+        }
+        if (strncmp(_key_buf, prefix, prefix_len)) {
+            continue;
+        }
+        if (flags & WRITE_ONCE_FLAG) {
+            write_protected = true;
+            continue;
+        }
+        remove_bits[ind / 32] |= 1UL << (ind % 32);
+    }
+
+    // Drop them from the RAM table, backwards so that the iterators follow
+    num_kept = 0;
+    for (ind = 0; ind < _num_keys; ind++) {
+        if (!(remove_bits[ind / 32] & (1UL << (ind % 32)))) {
+            ram_table[num_kept++] = ram_table[ind];
+        }
+    }
+    for (ind = _num_keys; ind > 0; ind--) {
+        if (remove_bits[(ind - 1) / 32] & (1UL << ((ind - 1) % 32))) {
+            update_all_iterators(false, ind - 1);
+        }
+    }
+
+    if (num_kept < _num_keys) {
+        _num_keys = num_kept;
+
+        // Compaction copies only the records in the RAM table. The removal takes effect
+        // when the master record of the new area is written.
+        _gc_in_progress = false;
+        area = _active_area;
+        ret = garbage_collection();
+        if (ret && (area == _active_area)) {
+            // Old area still in use, take its keys back
+            build_ram_table();
+            goto end;
+        }
+    }
+
+    if (!ret && write_protected) {
+        ret = MBED_ERROR_WRITE_PROTECTED;
+    }
+
+end:
+    delete[] remove_bits;
+    write_unlock();
+    return ret;
+}
+
 int TDBStore::get(const char *key, void *buffer, size_t buffer_size, size_t *actual_size, size_t offset)
 {
     int ret;
@@ -720,23 +1098,24 @@ int TDBStore::get(const char *key, void *buffer, size_t buffer_size, size_t *act
         return MBED_ERROR_INVALID_ARGUMENT;
     }
 
-    pal_osMutexWait(_mutex, PAL_RTOS_WAIT_FOREVER);
+    int reader = read_lock();
+    uint8_t *work_buf = reader_work_buf(reader);
 
-    ret = find_record(_active_area, key, bd_offset, ram_table_ind, hash);
+    ret = find_record(_active_area, key, bd_offset, ram_table_ind, hash, work_buf);
 
     if (ret != MBED_SUCCESS) {
         goto end;
     }
 
     ret = read_record(_active_area, bd_offset, const_cast<char *>(key), buffer, buffer_size,
-                      actual_data_size, offset, false, true, false, false, hash, flags, next_bd_offset);
+                      actual_data_size, offset, false, true, false, false, hash, flags, next_bd_offset, work_buf);
 
     if (actual_size) {
         *actual_size = actual_data_size;
     }
 
 end:
-    pal_osMutexRelease(_mutex);
+    read_unlock(reader);
     return ret;
 }
 
@@ -751,9 +1130,10 @@ int TDBStore::get_info(const char *key, info_t *info)
         return MBED_ERROR_INVALID_ARGUMENT;
     }
 
-    pal_osMutexWait(_mutex, PAL_RTOS_WAIT_FOREVER);
+    int reader = read_lock();
+    uint8_t *work_buf = reader_work_buf(reader);
 
-    ret = find_record(_active_area, key, bd_offset, ram_table_ind, hash);
+    ret = find_record(_active_area, key, bd_offset, ram_table_ind, hash, work_buf);
 
     if (ret) {
         goto end;
@@ -763,7 +1143,7 @@ int TDBStore::get_info(const char *key, info_t *info)
     // (as copy_data flag is not set, data won't be copied anywhere)
     ret = read_record(_active_area, bd_offset, const_cast<char *>(key), 0, (uint32_t) -1,
                       actual_data_size, 0, false, false, false, false, hash, flags,
-                      next_bd_offset);
+                      next_bd_offset, work_buf);
 
     if (ret) {
         goto end;
@@ -775,7 +1155,7 @@ int TDBStore::get_info(const char *key, info_t *info)
     }
 
 end:
-    pal_osMutexRelease(_mutex);
+    read_unlock(reader);
     return ret;
 }
 
@@ -785,7 +1165,8 @@ int TDBStore::write_master_record(uint8_t area, uint16_t version, uint32_t &next
 
     master_rec.version = version;
     master_rec.tdbstore_revision = tdbstore_revision;
-    master_rec.reserved = 0;
+    // Reserved field of earlier revisions, always 0 there
+    master_rec.reserved = _checkpoint_offset;
     next_offset = _master_record_offset + _master_record_size;
     return set(master_rec_key, &master_rec, sizeof(master_rec), 0);
 }
@@ -808,6 +1189,10 @@ int TDBStore::copy_record(uint8_t from_area, uint32_t from_offset, uint32_t to_o
     total_size = align_up(sizeof(record_header_t), _prog_size) +
                  align_up(header->key_size + header->data_size, _prog_size);;
 
+    // Areas are adjacent, never write past the destination one
+    if (to_offset + total_size > _size) {
+        return MBED_ERROR_MEDIA_FULL;
+    }
 
     ret = check_erase_before_write(1 - from_area, to_offset, total_size);
     if (ret) {
@@ -846,18 +1231,95 @@ int TDBStore::copy_record(uint8_t from_area, uint32_t from_offset, uint32_t to_o
 }
 
 int TDBStore::garbage_collection()
+{
+    int ret;
+
+    // Complete compaction in progress. If the standby area has no room left because of
+    // records copied more than once, start over.
+    if (_gc_in_progress) {
+        ret = gc_copy_records((uint32_t) -1);
+        if (ret == MBED_ERROR_MEDIA_FULL) {
+            _gc_in_progress = false;
+        } else if (ret) {
+            _gc_in_progress = false;
+            return ret;
+        }
+    }
+
+    if (!_gc_in_progress) {
+        ret = gc_start();
+        if (ret) {
+            return ret;
+        }
+        ret = gc_copy_records((uint32_t) -1);
+        if (ret) {
+            _gc_in_progress = false;
+            return ret;
+        }
+    }
+
+    return gc_finish();
+}
+
+int TDBStore::gc_start()
 {
     ram_table_entry_t *ram_table = (ram_table_entry_t *) _ram_table;
-    uint32_t to_offset, to_next_offset;
-    uint32_t chunk_size, reserved_size;
     int ret;
-    size_t ind;
 
     ret = check_erase_before_write(1 - _active_area, 0, _master_record_offset + _master_record_size);
     if (ret) {
         return ret;
     }
 
+    for (size_t ind = 0; ind < _num_keys; ind++) {
+        ram_table[ind].gc_offset = 0;
+    }
+
+    _gc_ram_table_ind = 0;
+    _gc_offset = _master_record_offset + _master_record_size;
+    _gc_in_progress = true;
+
+    return MBED_SUCCESS;
+}
+
+int TDBStore::gc_copy_records(uint32_t max_records)
+{
+    ram_table_entry_t *ram_table = (ram_table_entry_t *) _ram_table;
+    uint32_t to_next_offset;
+    int ret;
+
+    // Records already copied are skipped, index only moves back when one of them changes
+    while (_gc_ram_table_ind < _num_keys) {
+        ram_table_entry_t *entry = &ram_table[_gc_ram_table_ind];
+        if (!entry->gc_offset) {
+            if (!max_records) {
+                break;
+            }
+            ret = copy_record(_active_area, entry->bd_offset, _gc_offset, to_next_offset);
+            if (ret) {
+                return ret;
+            }
+            entry->gc_offset = _gc_offset;
+            _gc_offset = to_next_offset;
+            max_records--;
+        }
+        _gc_ram_table_ind++;
+    }
+
+    return MBED_SUCCESS;
+}
+
+int TDBStore::gc_finish()
+{
+    ram_table_entry_t *ram_table = (ram_table_entry_t *) _ram_table;
+    uint32_t to_offset, to_next_offset;
+    uint32_t chunk_size, reserved_size;
+    int ret;
+    size_t ind;
+
+    _gc_in_progress = false;
+
+    // Reserved data may have been written during compaction, so copy it only now
     ret = do_reserved_data_get(0, RESERVED_AREA_SIZE);
 
     if (!ret) {
@@ -880,31 +1342,48 @@ int TDBStore::garbage_collection()
         }
     }
 
-    to_offset = _master_record_offset + _master_record_size;
-
-    // Initialize in case table is empty
-    to_next_offset = to_offset;
+    // Records of the write batch in progress are not in RAM table yet, carry them over as they are
+    if (_batch_in_progress) {
+        uint32_t from_offset = _batch_offset;
+        uint32_t batch_offset = _gc_offset;
+        while (from_offset < _free_space_offset) {
+            ret = copy_record(_active_area, from_offset, _gc_offset, to_next_offset);
+            if (ret) {
+                return ret;
+            }
+            from_offset += to_next_offset - _gc_offset;
+            _gc_offset = to_next_offset;
+        }
+        _batch_offset = batch_offset;
+    }
 
-    // Go over ram table and copy all entries to opposite area
+    // Update RAM table
     for (ind = 0; ind < _num_keys; ind++) {
-        uint32_t from_offset = ram_table[ind].bd_offset;
-        ret = copy_record(_active_area, from_offset, to_offset, to_next_offset);
-        if (ret) {
-            return ret;
-        }
-        // Update RAM table
-        ram_table[ind].bd_offset = to_offset;
-        to_offset = to_next_offset;
+        ram_table[ind].bd_offset = ram_table[ind].gc_offset;
     }
 
-    to_offset = to_next_offset;
-    _free_space_offset = to_next_offset;
+    to_offset = _gc_offset;
+    _free_space_offset = _gc_offset;
 
     // Now we can switch to the new active area
     _active_area = 1 - _active_area;
+    _active_area_version++;
+
+    // Snapshot RAM table for the next init. A batch in progress is left out of it,
+    // so then records must be scanned from the start.
+    _checkpoint_offset = 0;
+    if (MBED_CONF_STORAGE_TDB_CHECKPOINT && !_batch_in_progress) {
+        ret = write_checkpoint(_free_space_offset, to_offset);
+        if (ret == MBED_SUCCESS) {
+            _checkpoint_offset = _free_space_offset;
+            _free_space_offset = to_offset;
+        } else if (ret != MBED_ERROR_MEDIA_FULL) {
+            return ret;
+        }
+    }
+    _gc_last_free_offset = _free_space_offset;
 
     // Now write master record, with version incremented by 1.
-    _active_area_version++;
     ret = write_master_record(_active_area, _active_area_version, to_offset);
     if (ret) {
         return ret;
@@ -919,6 +1398,198 @@ int TDBStore::garbage_collection()
     return MBED_SUCCESS;
 }
 
+int TDBStore::gc_step(bool *pending)
+{
+    int ret = MBED_SUCCESS;
+
+    if (!_is_initialized) {
+        return MBED_ERROR_NOT_READY;
+    }
+
+    write_lock();
+
+    if (!MBED_CONF_STORAGE_TDB_GC_STEP_RECORDS) {
+        goto end;
+    }
+
+    // Start when half of the free space left by the previous compaction is used, so that
+    // an area full of live data is not compacted over and over again
+    if (!_gc_in_progress &&
+            (_free_space_offset - _gc_last_free_offset >= (_size - _gc_last_free_offset) / 2)) {
+        ret = gc_start();
+        if (ret) {
+            goto end;
+        }
+    }
+
+    if (!_gc_in_progress) {
+        goto end;
+    }
+
+    ret = gc_copy_records(MBED_CONF_STORAGE_TDB_GC_STEP_RECORDS);
+    if (ret == MBED_ERROR_MEDIA_FULL) {
+        // Standby area filled up with stale copies, start over in the next step
+        _gc_in_progress = false;
+        ret = MBED_SUCCESS;
+        goto end;
+    } else if (ret) {
+        _gc_in_progress = false;
+        goto end;
+    }
+
+    if (_gc_ram_table_ind >= _num_keys) {
+        ret = gc_finish();
+    }
+
+end:
+    if (pending) {
+        *pending = _gc_in_progress;
+    }
+    write_unlock();
+    return ret;
+}
+
+
+int TDBStore::write_checkpoint(uint32_t offset, uint32_t &next_offset)
+{
+    ram_table_entry_t *ram_table = (ram_table_entry_t *) _ram_table;
+    record_header_t header;
+    checkpoint_data_t data;
+    checkpoint_entry_t entry;
+    uint32_t actual_data_size, hash, flags;
+    uint32_t curr_offset;
+    int os_ret, ret;
+
+    header.magic = tdbstore_magic;
+    header.header_size = sizeof(record_header_t);
+    header.revision = tdbstore_revision;
+    header.flags = checkpoint_flag;
+    header.key_size = strlen(master_rec_key);
+    header.reserved = 0;
+    header.data_size = sizeof(data) + _num_keys * sizeof(entry);
+
+    uint32_t rec_size = record_size(master_rec_key, header.data_size);
+    if (offset + rec_size >= _size) {
+        return MBED_ERROR_MEDIA_FULL;
+    }
+
+    ret = check_erase_before_write(_active_area, offset, rec_size);
+    if (ret) {
+        return ret;
+    }
+
+    // Write key and data first, header last, as in set_finalize
+    header.crc = calc_crc(initial_crc, sizeof(record_header_t) - sizeof(header.crc), &header);
+    header.crc = calc_crc(header.crc, header.key_size, master_rec_key);
+    curr_offset = offset + align_up(sizeof(record_header_t), _prog_size);
+    ret = write_area(_active_area, curr_offset, header.key_size, master_rec_key);
+    if (ret) {
+        return ret;
+    }
+    curr_offset += header.key_size;
+
+    data.version = _active_area_version;
+    data.reserved = 0;
+    data.num_keys = _num_keys;
+    header.crc = calc_crc(header.crc, sizeof(data), &data);
+    ret = write_area(_active_area, curr_offset, sizeof(data), &data);
+    if (ret) {
+        return ret;
+    }
+    curr_offset += sizeof(data);
+
+    for (size_t ind = 0; ind < _num_keys; ind++) {
+        entry.hash = ram_table[ind].hash;
+        entry.key_hint = ram_table[ind].key_hint;
+        entry.prefix_fp = ram_table[ind].prefix_fp;
+        entry.bd_offset = ram_table[ind].bd_offset;
+        header.crc = calc_crc(header.crc, sizeof(entry), &entry);
+        ret = write_area(_active_area, curr_offset, sizeof(entry), &entry);
+        if (ret) {
+            return ret;
+        }
+        curr_offset += sizeof(entry);
+    }
+
+    ret = write_area(_active_area, offset, sizeof(record_header_t), &header);
+    if (ret) {
+        return ret;
+    }
+
+    os_ret = _buff_bd->sync();
+    if (os_ret) {
+        return MBED_ERROR_WRITE_FAILED;
+    }
+
+    // Reread to ensure write success
+    return read_record(_active_area, offset, 0, 0, 0, actual_data_size, 0,
+                       false, false, false, false, hash, flags, next_offset);
+}
+
+int TDBStore::load_checkpoint(uint32_t &offset)
+{
+    ram_table_entry_t *ram_table = (ram_table_entry_t *) _ram_table;
+    checkpoint_data_t data;
+    checkpoint_entry_t entry;
+    uint32_t actual_data_size, hash, flags, next_offset;
+    uint32_t curr_offset;
+    int ret;
+
+    if (_checkpoint_offset < _master_record_offset + _master_record_size) {
+        return MBED_ERROR_ITEM_NOT_FOUND;
+    }
+
+    // Validates the CRC of the whole snapshot
+    ret = read_record(_active_area, _checkpoint_offset, 0, 0, (uint32_t) -1, actual_data_size, 0,
+                      false, false, false, false, hash, flags, next_offset);
+    if (ret) {
+        return ret;
+    }
+
+    if (!(flags & checkpoint_flag) || (actual_data_size < sizeof(data))) {
+        return MBED_ERROR_INVALID_DATA_DETECTED;
+    }
+
+    curr_offset = _checkpoint_offset + align_up(sizeof(record_header_t), _prog_size) + strlen(master_rec_key);
+    ret = read_area(_active_area, curr_offset, sizeof(data), &data);
+    if (ret) {
+        return ret;
+    }
+    curr_offset += sizeof(data);
+
+    if ((data.version != _active_area_version) ||
+            (actual_data_size != sizeof(data) + data.num_keys * sizeof(entry))) {
+        return MBED_ERROR_INVALID_DATA_DETECTED;
+    }
+
+    if (data.num_keys > _max_keys) {
+        delete[] ram_table;
+        _max_keys = data.num_keys;
+        ram_table = new ram_table_entry_t[_max_keys];
+        memset(ram_table, 0, sizeof(ram_table_entry_t) * _max_keys);
+        _ram_table = ram_table;
+    }
+
+    for (uint32_t ind = 0; ind < data.num_keys; ind++) {
+        ret = read_area(_active_area, curr_offset, sizeof(entry), &entry);
+        if (ret) {
+            return ret;
+        }
+        if ((entry.bd_offset < _master_record_offset) || (entry.bd_offset >= _checkpoint_offset)) {
+            return MBED_ERROR_INVALID_DATA_DETECTED;
+        }
+        ram_table[ind].hash = entry.hash;
+        ram_table[ind].key_hint = entry.key_hint;
+        ram_table[ind].prefix_fp = entry.prefix_fp;
+        ram_table[ind].bd_offset = entry.bd_offset;
+        ram_table[ind].gc_offset = 0;
+        curr_offset += sizeof(entry);
+    }
+
+    _num_keys = data.num_keys;
+    offset = next_offset;
+    return MBED_SUCCESS;
+}
 
 int TDBStore::build_ram_table()
 {
@@ -933,6 +1604,12 @@ int TDBStore::build_ram_table()
     _num_keys = 0;
     offset = _master_record_offset;
 
+    // Take the RAM table snapshot of the last garbage collection, and only scan the records after it
+    if (load_checkpoint(offset) != MBED_SUCCESS) {
+        _num_keys = 0;
+        offset = _master_record_offset;
+    }
+
     while (offset < _free_space_offset) {
         ret = read_record(_active_area, offset, _key_buf, 0, 0, actual_data_size, 0,
                           true, false, false, true, hash, flags, next_offset);
@@ -941,6 +1618,33 @@ int TDBStore::build_ram_table()
             goto end;
         }
 
+        if (flags & batch_begin_flag) {
+            // Records of a write batch are only valid if it has been committed
+            bool committed;
+            uint32_t end_offset;
+            ret = check_batch(next_offset, committed, end_offset);
+            if (ret) {
+                goto end;
+            }
+            if (committed) {
+                offset = next_offset;
+            } else if (end_offset < _free_space_offset) {
+                // Aborted batch, continue after it
+                offset = end_offset;
+            } else {
+                // Interrupted batch at the end, treat as corrupt so that it is collected out
+                next_offset = offset;
+                ret = MBED_ERROR_INVALID_DATA_DETECTED;
+                goto end;
+            }
+            continue;
+        }
+
+        if (flags & (batch_marker_flags | checkpoint_flag)) {
+            offset = next_offset;
+            continue;
+        }
+
         ret = find_record(_active_area, _key_buf, dummy, ram_table_ind, hash);
 
         if ((ret != MBED_SUCCESS) && (ret != MBED_ERROR_ITEM_NOT_FOUND)) {
@@ -976,6 +1680,8 @@ int TDBStore::build_ram_table()
 
         // update record parameters
         ram_table[ram_table_ind].hash = hash;
+        ram_table[ram_table_ind].key_hint = calc_key_hint(_key_buf);
+        ram_table[ram_table_ind].prefix_fp = calc_prefix_fp(_key_buf);
         ram_table[ram_table_ind].bd_offset = save_offset;
     }
 
@@ -984,6 +1690,35 @@ end:
     return ret;
 }
 
+int TDBStore::check_batch(uint32_t offset, bool &committed, uint32_t &end_offset)
+{
+    uint32_t next_offset, hash, flags, actual_data_size;
+    int ret;
+
+    committed = false;
+
+    while (offset < _free_space_offset) {
+        ret = read_record(_active_area, offset, 0, 0, 0, actual_data_size, 0,
+                          false, false, false, false, hash, flags, next_offset);
+        if (ret == MBED_ERROR_INVALID_DATA_DETECTED) {
+            break;
+        }
+        if (ret) {
+            return ret;
+        }
+        if (flags & batch_marker_flags) {
+            // Another begin marker means this batch was interrupted by a failed write
+            committed = (flags & batch_commit_flag) != 0;
+            end_offset = offset;
+            return MBED_SUCCESS;
+        }
+        offset = next_offset;
+    }
+
+    end_offset = _free_space_offset;
+    return MBED_SUCCESS;
+}
+
 int TDBStore::increment_max_keys(void **ram_table)
 {
     // Reallocate ram table with new size
@@ -1014,11 +1749,20 @@ int TDBStore::init()
     uint32_t actual_data_size;
     int os_ret, ret = MBED_SUCCESS, reserved_ret;
     uint16_t versions[_num_areas];
+    uint32_t checkpoints[_num_areas];
 
     pal_osMutexCreate(&_mutex);
     pal_osMutexCreate(&_inc_set_mutex);
+    if (!_readers_done_sem) {
+        pal_osSemaphoreCreate(0, &_readers_done_sem);
+    }
+#if MBED_CONF_STORAGE_TDB_CONCURRENT_READERS
+    if (!_bd_read_mutex) {
+        pal_osMutexCreate(&_bd_read_mutex);
+    }
+#endif
 
-    pal_osMutexWait(_mutex, PAL_RTOS_WAIT_FOREVER);
+    write_lock();
 
     if (_is_initialized) {
         goto end;
@@ -1046,6 +1790,7 @@ int TDBStore::init()
 
     _prog_size = _bd->get_program_size();
     _work_buf = new uint8_t[_prog_size];
+    _reader_work_bufs = new uint8_t[_prog_size * MBED_CONF_STORAGE_TDB_CONCURRENT_READERS];
     _key_buf = new char[MAX_KEY_SIZE];
     _inc_set_handle = new inc_set_handle_t;
     memset(_inc_set_handle, 0, sizeof(inc_set_handle_t));
@@ -1059,6 +1804,7 @@ int TDBStore::init()
     for (uint8_t area = 0; area < _num_areas; area++) {
         area_state[area] = TDBSTORE_AREA_STATE_NONE;
         versions[area] = 0;
+        checkpoints[area] = 0;
 
         _size = std::min(_size, _area_params[area].size);
 
@@ -1082,6 +1828,7 @@ int TDBStore::init()
         }
 
         versions[area] = master_rec.version;
+        checkpoints[area] = master_rec.reserved;
 
         area_state[area] = TDBSTORE_AREA_STATE_VALID;
 
@@ -1095,6 +1842,7 @@ int TDBStore::init()
     if ((area_state[0] == TDBSTORE_AREA_STATE_EMPTY) && (area_state[1] == TDBSTORE_AREA_STATE_EMPTY)) {
         _active_area = 0;
         _active_area_version = 1;
+        _checkpoint_offset = 0;
         ret = write_master_record(_active_area, _active_area_version, _free_space_offset);
         assert(ret == 0);
         // Nothing more to do here if active area is empty
@@ -1117,6 +1865,7 @@ int TDBStore::init()
     // Currently set free space offset pointer to the end of free space.
     // Ram table build process needs it, but will update it.
     _free_space_offset = _size;
+    _checkpoint_offset = checkpoints[_active_area];
     ret = build_ram_table();
 
     if ((ret != MBED_SUCCESS) && (ret != MBED_ERROR_INVALID_DATA_DETECTED)) {
@@ -1147,27 +1896,30 @@ int TDBStore::init()
     }
 
 end:
+    _gc_last_free_offset = _free_space_offset;
     _is_initialized = true;
-    pal_osMutexRelease(_mutex);
+    write_unlock();
     return ret;
 fail:
     delete[] ram_table;
     delete _buff_bd;
     delete[] _work_buf;
+    delete[] _reader_work_bufs;
     delete[] _key_buf;
     delete reinterpret_cast<inc_set_handle_t *>(_inc_set_handle);
     _ram_table = nullptr;
     _buff_bd = nullptr;
     _work_buf = nullptr;
+    _reader_work_bufs = nullptr;
     _key_buf = nullptr;
     _inc_set_handle = nullptr;
-    pal_osMutexRelease(_mutex);
+    write_unlock();
     return ret;
 }
 
 int TDBStore::deinit()
 {
-    pal_osMutexWait(_mutex, PAL_RTOS_WAIT_FOREVER);
+    write_lock();
     if (_is_initialized) {
         _buff_bd->deinit();
         delete _buff_bd;
@@ -1175,11 +1927,15 @@ int TDBStore::deinit()
         ram_table_entry_t *ram_table = (ram_table_entry_t *) _ram_table;
         delete[] ram_table;
         delete[] _work_buf;
+        delete[] _reader_work_bufs;
         delete[] _key_buf;
+        _reader_work_bufs = nullptr;
     }
 
     _is_initialized = false;
-    pal_osMutexRelease(_mutex);
+    _gc_in_progress = false;
+    _batch_in_progress = false;
+    write_unlock();
 
     return MBED_SUCCESS;
 }
@@ -1199,7 +1955,7 @@ int TDBStore::reset()
         return MBED_ERROR_NOT_READY;
     }
 
-    pal_osMutexWait(_mutex, PAL_RTOS_WAIT_FOREVER);
+    write_lock();
 
     // Reset both areas
     for (area = 0; area < _num_areas; area++) {
@@ -1213,12 +1969,16 @@ int TDBStore::reset()
     _num_keys = 0;
     _free_space_offset = _master_record_offset;
     _active_area_version = 1;
+    _gc_in_progress = false;
+    _batch_in_progress = false;
+    _checkpoint_offset = 0;
     memset(_ram_table, 0, sizeof(ram_table_entry_t) * _max_keys);
     // Write an initial master record on active area
     ret = write_master_record(_active_area, _active_area_version, _free_space_offset);
+    _gc_last_free_offset = _free_space_offset;
 
 end:
-    pal_osMutexRelease(_mutex);
+    write_unlock();
     return ret;
 }
 
@@ -1235,7 +1995,7 @@ int TDBStore::iterator_open(iterator_t *it, const char *prefix)
         return MBED_ERROR_INVALID_ARGUMENT;
     }
 
-    pal_osMutexWait(_mutex, PAL_RTOS_WAIT_FOREVER);
+    write_lock();
 
     int it_num;
     for (it_num = 0; it_num < _max_open_iterators; it_num++) {
@@ -1255,15 +2015,19 @@ int TDBStore::iterator_open(iterator_t *it, const char *prefix)
     if (prefix && strcmp(prefix, "")) {
         handle->prefix = new char[strlen(prefix) + 1];
         strcpy(handle->prefix, prefix);
+        handle->prefix_len = strlen(prefix);
+        handle->prefix_fp = calc_prefix_fp(prefix);
     } else {
         handle->prefix = 0;
+        handle->prefix_len = 0;
+        handle->prefix_fp = 0;
     }
     handle->ram_table_ind = 0;
     handle->iterator_num = it_num;
     _iterator_table[it_num] = handle;
 
 end:
-    pal_osMutexRelease(_mutex);
+    write_unlock();
     return ret;
 }
 
@@ -1278,13 +2042,18 @@ int TDBStore::iterator_next(iterator_t it, char *key, size_t key_size)
         return MBED_ERROR_NOT_READY;
     }
 
-    pal_osMutexWait(_mutex, PAL_RTOS_WAIT_FOREVER);
+    write_lock();
 
     handle = reinterpret_cast<key_iterator_handle_t *>(it);
 
     ret = MBED_ERROR_ITEM_NOT_FOUND;
 
     while (ret && (handle->ram_table_ind < _num_keys)) {
+        if (handle->prefix &&
+                !prefix_fp_may_match(ram_table[handle->ram_table_ind].prefix_fp, handle->prefix_fp, handle->prefix_len)) {
+            handle->ram_table_ind++;
+            continue;
+        }
         ret = read_record(_active_area, ram_table[handle->ram_table_ind].bd_offset, _key_buf,
                           0, 0, actual_data_size, 0, true, false, false, false, hash, flags, next_offset);
         if (ret) {
@@ -1303,7 +2072,7 @@ int TDBStore::iterator_next(iterator_t it, char *key, size_t key_size)
     }
 
 end:
-    pal_osMutexRelease(_mutex);
+    write_unlock();
     return ret;
 }
 
@@ -1315,18 +2084,78 @@ int TDBStore::iterator_close(iterator_t it)
         return MBED_ERROR_NOT_READY;
     }
 
-    pal_osMutexWait(_mutex, PAL_RTOS_WAIT_FOREVER);
+    write_lock();
 
     handle = reinterpret_cast<key_iterator_handle_t *>(it);
     delete[] handle->prefix;
     _iterator_table[handle->iterator_num] = 0;
     delete handle;
 
-    pal_osMutexRelease(_mutex);
+    write_unlock();
 
     return MBED_SUCCESS;
 }
 
+int TDBStore::read_lock()
+{
+    // Only the mutex, readers with a work buffer do not wait for each other
+    pal_osMutexWait(_mutex, PAL_RTOS_WAIT_FOREVER);
+
+    int32_t busy = pal_osAtomicIncrement(&_reader_bufs_busy, 0);
+    for (int reader = 0; reader < MBED_CONF_STORAGE_TDB_CONCURRENT_READERS; reader++) {
+        if (!(busy & (1 << reader))) {
+            pal_osAtomicIncrement(&_reader_bufs_busy, 1 << reader);
+            pal_osAtomicIncrement(&_num_readers, 1);
+            pal_osMutexRelease(_mutex);
+            return reader;
+        }
+    }
+
+    // No work buffer left, read with the mutex held
+    return -1;
+}
+
+void TDBStore::read_unlock(int reader)
+{
+    if (reader < 0) {
+        pal_osMutexRelease(_mutex);
+        return;
+    }
+
+    // Not under the mutex - a writer may hold it, waiting for this reader to finish
+    pal_osAtomicIncrement(&_reader_bufs_busy, -(1 << reader));
+    if (!pal_osAtomicIncrement(&_num_readers, -1) && pal_osAtomicIncrement(&_writer_waiting, 0)) {
+        pal_osSemaphoreRelease(_readers_done_sem);
+    }
+}
+
+uint8_t *TDBStore::reader_work_buf(int reader)
+{
+    return (reader < 0) ? _work_buf : _reader_work_bufs + reader * _prog_size;
+}
+
+void TDBStore::write_lock()
+{
+    pal_osMutexWait(_mutex, PAL_RTOS_WAIT_FOREVER);
+
+    // New readers wait for the mutex, so only the current ones need to finish
+    if (pal_osAtomicIncrement(&_num_readers, 0)) {
+        pal_osAtomicIncrement(&_writer_waiting, 1);
+        while (pal_osAtomicIncrement(&_num_readers, 0)) {
+            pal_osSemaphoreWait(_readers_done_sem, PAL_RTOS_WAIT_FOREVER, NULL);
+        }
+        pal_osAtomicIncrement(&_writer_waiting, -1);
+        // Drop a release of a reader that finished before this writer started waiting
+        while (pal_osSemaphoreWait(_readers_done_sem, 0, NULL) == PAL_SUCCESS) {
+        }
+    }
+}
+
+void TDBStore::write_unlock()
+{
+    pal_osMutexRelease(_mutex);
+}
+
 void TDBStore::update_all_iterators(bool added, uint32_t ram_table_ind)
 {
     for (int it_num = 0; it_num < _max_open_iterators; it_num++) {
@@ -1356,7 +2185,7 @@ int TDBStore::reserved_data_set(const void *reserved_data, size_t reserved_data_
         return MBED_ERROR_INVALID_SIZE;
     }
 
-    pal_osMutexWait(_mutex, PAL_RTOS_WAIT_FOREVER);
+    write_lock();
 
     ret = do_reserved_data_get(0, RESERVED_AREA_SIZE);
     if ((ret == MBED_SUCCESS) || (ret == MBED_ERROR_INVALID_DATA_DETECTED)) {
@@ -1387,7 +2216,7 @@ int TDBStore::reserved_data_set(const void *reserved_data, size_t reserved_data_
     }
 
 end:
-    pal_osMutexRelease(_mutex);
+    write_unlock();
     return ret;
 }
 
@@ -1464,9 +2293,9 @@ int TDBStore::do_reserved_data_get(void *reserved_data, size_t reserved_data_buf
 
 int TDBStore::reserved_data_get(void *reserved_data, size_t reserved_data_buf_size, size_t *actual_data_size)
 {
-    pal_osMutexWait(_mutex, PAL_RTOS_WAIT_FOREVER);
+    write_lock();
     int ret = do_reserved_data_get(reserved_data, reserved_data_buf_size, actual_data_size);
-    pal_osMutexRelease(_mutex);
+    write_unlock();
     return ret;
 }
 
@@ -24,6 +24,36 @@
 #include "BufferedBlockDevice.h"
 #include "pal.h"
 
+/**
+ * Maximum number of records the incremental garbage collection copies in one gc_step() call.
+ * 0 disables incremental garbage collection, compaction then only happens in full when the
+ * active area runs out of space.
+ */
+#ifndef MBED_CONF_STORAGE_TDB_GC_STEP_RECORDS
+#define MBED_CONF_STORAGE_TDB_GC_STEP_RECORDS 0
+#endif
+
+/**
+ * Write a snapshot of the RAM table at garbage collection, so that init only needs to scan
+ * the records written after it.
+ */
+#ifndef MBED_CONF_STORAGE_TDB_CHECKPOINT
+#define MBED_CONF_STORAGE_TDB_CHECKPOINT 1
+#endif
+
+/**
+ * Number of get() and get_info() calls that may read at the same time, each with a work buffer
+ * of its own. Writes wait for the readers to finish. Further readers, and all of them when 0,
+ * read exclusively, as writes do.
+ */
+#ifndef MBED_CONF_STORAGE_TDB_CONCURRENT_READERS
+#define MBED_CONF_STORAGE_TDB_CONCURRENT_READERS 4
+#endif
+
+#if (MBED_CONF_STORAGE_TDB_CONCURRENT_READERS < 0) || (MBED_CONF_STORAGE_TDB_CONCURRENT_READERS > 30)
+#error "MBED_CONF_STORAGE_TDB_CONCURRENT_READERS must be between 0 and 30"
+#endif
+
 namespace mbed {
 
 /** TDBStore class
@@ -153,6 +183,23 @@ public:
      */
     virtual int remove(const char *key);
 
+    /**
+     * @brief Remove all TDBStore items whose key starts with a prefix, in one garbage
+     *        collection that leaves their records behind. No delete records are written,
+     *        and after a power failure either all or none of the items are removed.
+     *        Items stored with the "write once" flag are kept.
+     *
+     * @param[in]  prefix               Key prefix, must not be empty.
+     *
+     * @returns MBED_SUCCESS                        Success.
+     *          MBED_ERROR_NOT_READY                Not initialized.
+     *          MBED_ERROR_READ_FAILED              Unable to read from media.
+     *          MBED_ERROR_WRITE_FAILED             Unable to write to media.
+     *          MBED_ERROR_INVALID_ARGUMENT         Empty prefix or a write batch in progress.
+     *          MBED_ERROR_WRITE_PROTECTED          Some items were kept as they have the "write once" flag.
+     */
+    virtual int remove_prefix(const char *prefix);
+
 
     /**
      * @brief Start an incremental TDBStore set sequence. This operation is blocking other operations.
@@ -202,6 +249,61 @@ public:
      */
     virtual int set_finalize(set_handle_t handle);
 
+    /**
+     * @brief Start a write batch. All keys set or removed until batch_commit() are
+     *        appended as one contiguous run of records, framed by begin and commit markers,
+     *        and are only taken into use once the commit marker is written. The store is
+     *        locked for other threads while the batch is open.
+     *
+     * @returns MBED_SUCCESS                        Success.
+     *          MBED_ERROR_NOT_READY                Not initialized.
+     *          MBED_ERROR_WRITE_FAILED             Unable to write to media.
+     *          MBED_ERROR_INVALID_ARGUMENT         Batch already started.
+     *          MBED_ERROR_MEDIA_FULL               No space left on media.
+     */
+    virtual int batch_begin();
+
+    /**
+     * @brief Set one KVStore item in the write batch.
+     *
+     * @param[in]  key                  Key - must not include '*' '/' '?' ':' ';' '\' '"' '|' ' ' '<' '>' '\'.
+     * @param[in]  buffer               Value data buffer.
+     * @param[in]  size                 Value data size.
+     * @param[in]  create_flags         Flag mask.
+     *
+     * @returns MBED_SUCCESS                        Success.
+     *          MBED_ERROR_NOT_READY                Not initialized.
+     *          MBED_ERROR_READ_FAILED              Unable to read from media.
+     *          MBED_ERROR_WRITE_FAILED             Unable to write to media.
+     *          MBED_ERROR_INVALID_ARGUMENT         No batch started or invalid argument given in function arguments.
+     *          MBED_ERROR_INVALID_SIZE             Invalid size given in function arguments.
+     *          MBED_ERROR_MEDIA_FULL               No space left on media.
+     *          MBED_ERROR_WRITE_PROTECTED          Already stored with a write once flag.
+     */
+    virtual int batch_set(const char *key, const void *buffer, size_t size, uint32_t create_flags);
+
+    /**
+     * @brief Commit the write batch.
+     *
+     * @returns MBED_SUCCESS                        Success.
+     *          MBED_ERROR_NOT_READY                Not initialized.
+     *          MBED_ERROR_READ_FAILED              Unable to read from media.
+     *          MBED_ERROR_WRITE_FAILED             Unable to write to media.
+     *          MBED_ERROR_INVALID_ARGUMENT         No batch started.
+     *          MBED_ERROR_MEDIA_FULL               No space left on media.
+     */
+    virtual int batch_commit();
+
+    /**
+     * @brief Abort the write batch.
+     *
+     * @returns MBED_SUCCESS                        Success.
+     *          MBED_ERROR_NOT_READY                Not initialized.
+     *          MBED_ERROR_WRITE_FAILED             Unable to write to media.
+     *          MBED_ERROR_INVALID_ARGUMENT         No batch started.
+     */
+    virtual int batch_abort();
+
     /**
      * @brief Start an iteration over KVStore keys.
      *        There are no issues with any other operations while iterator is open.
@@ -279,6 +381,23 @@ public:
     virtual int reserved_data_get(void *reserved_data, size_t reserved_data_buf_size,
                                   size_t *actual_data_size = 0);
 
+    /**
+     * @brief Perform one step of incremental garbage collection, meant to be called from
+     *        an idle-time hook. Compaction is started once half of the free space left by the
+     *        previous one has been used, and each step copies at most
+     *        MBED_CONF_STORAGE_TDB_GC_STEP_RECORDS records to the standby area. The areas are
+     *        switched in the step that copies the last record. Keys may be set and removed
+     *        between the steps.
+     *
+     * @param[out] pending              Set to true if compaction is still in progress after the step.
+     *
+     * @returns MBED_SUCCESS                        Success.
+     *          MBED_ERROR_NOT_READY                Not initialized.
+     *          MBED_ERROR_READ_FAILED              Unable to read from media.
+     *          MBED_ERROR_WRITE_FAILED             Unable to write to media.
+     */
+    int gc_step(bool *pending = 0);
+
 #if !defined(DOXYGEN_ONLY)
 private:
 
@@ -311,6 +430,19 @@ private:
     bool _variant_bd_erase_unit_size;
     void *_inc_set_handle;
     void *_iterator_table[_max_open_iterators];
+    bool _gc_in_progress;
+    uint32_t _gc_ram_table_ind;
+    uint32_t _gc_offset;
+    uint32_t _gc_last_free_offset;
+    bool _batch_in_progress;
+    uint32_t _batch_offset;
+    uint32_t _checkpoint_offset;
+    palMutexID_t _bd_read_mutex;
+    palSemaphoreID_t _readers_done_sem;
+    int32_t _num_readers;
+    int32_t _writer_waiting;
+    int32_t _reader_bufs_busy;
+    uint8_t *_reader_work_bufs;
 
     /**
      * @brief Read a block from an area.
@@ -377,6 +509,7 @@ private:
      * @param[out] hash                   Calculated hash.
      * @param[out] flags                  Record flags.
      * @param[out] next_offset            Offset of next record.
+     * @param[in]  work_buf               Work buffer of program size, the shared one if NULL.
      *
      * @returns 0 for success, nonzero for failure.
      */
@@ -384,7 +517,8 @@ private:
                     void *data_buf, uint32_t data_buf_size,
                     uint32_t &actual_data_size, size_t data_offset, bool copy_key,
                     bool copy_data, bool check_expected_key, bool calc_hash,
-                    uint32_t &hash, uint32_t &flags, uint32_t &next_offset);
+                    uint32_t &hash, uint32_t &flags, uint32_t &next_offset,
+                    uint8_t *work_buf = 0);
 
     /**
      * @brief Write a master record of a given area.
@@ -417,6 +551,30 @@ private:
      */
     int garbage_collection();
 
+    /**
+     * @brief Start compaction: prepare the standby area and mark all records to be copied.
+     *
+     * @returns 0 for success, nonzero for failure.
+     */
+    int gc_start();
+
+    /**
+     * @brief Copy records not yet copied to the standby area.
+     *
+     * @param[in]  max_records            Maximum number of records to copy.
+     *
+     * @returns 0 for success, MBED_ERROR_MEDIA_FULL if standby area has no room for
+     *          the record, other nonzero for failure.
+     */
+    int gc_copy_records(uint32_t max_records);
+
+    /**
+     * @brief Finish compaction: copy the reserved data and switch to the standby area.
+     *
+     * @returns 0 for success, nonzero for failure.
+     */
+    int gc_finish();
+
     /**
      * @brief Return record size given key and data size.
      *
@@ -435,11 +593,46 @@ private:
      * @param[out] offset                 Offset of record.
      * @param[out] ram_table_ind          Index in RAM table (target one if not found).
      * @param[out] hash                   Calculated key hash.
+     * @param[in]  work_buf               Work buffer of program size, the shared one if NULL.
      *
      * @returns 0 for success, nonzero for failure.
      */
     int find_record(uint8_t area, const char *key, uint32_t &offset,
-                    uint32_t &ram_table_ind, uint32_t &hash);
+                    uint32_t &ram_table_ind, uint32_t &hash, uint8_t *work_buf = 0);
+
+    /**
+     * @brief Lock for reading. Readers that got a work buffer of their own read at the same
+     *        time, the others hold the mutex as writers do.
+     *
+     * @returns Index of the reader work buffer, -1 if the mutex is held.
+     */
+    int read_lock();
+
+    /**
+     * @brief Unlock a read_lock().
+     *
+     * @param[in]  reader                 Value returned by read_lock().
+     */
+    void read_unlock(int reader);
+
+    /**
+     * @brief Work buffer of a reader.
+     *
+     * @param[in]  reader                 Value returned by read_lock().
+     *
+     * @returns Work buffer of program size.
+     */
+    uint8_t *reader_work_buf(int reader);
+
+    /**
+     * @brief Lock for writing. Holds the mutex and waits for the current readers to finish.
+     */
+    void write_lock();
+
+    /**
+     * @brief Unlock a write_lock().
+     */
+    void write_unlock();
     /**
      * @brief Actual logics of get API (also covers all other get APIs).
      *
@@ -468,6 +661,77 @@ private:
      */
     int do_set(const char *key, const void *data_buf, uint32_t data_buf_size, uint32_t flags);
 
+    /**
+     * @brief Update RAM table with a record written to the active area.
+     *
+     * @param[in]  ram_table_ind          Index in RAM table, as given by find_record.
+     * @param[in]  new_key                Key is not in RAM table yet.
+     * @param[in]  hash                   Key hash.
+     * @param[in]  key_hint               Key hint.
+     * @param[in]  flags                  Record flags.
+     * @param[in]  bd_offset              Record offset.
+     *
+     * @returns none
+     */
+    void update_ram_table(uint32_t ram_table_ind, bool new_key, uint32_t hash, uint16_t key_hint, uint16_t prefix_fp,
+                          uint32_t flags, uint32_t bd_offset);
+
+    /**
+     * @brief Write a marker record framing a write batch.
+     *
+     * @param[in]  flags                  Marker flag.
+     *
+     * @returns 0 for success, nonzero for failure.
+     */
+    int write_batch_marker(uint32_t flags);
+
+    /**
+     * @brief Take the records of a committed write batch into use.
+     *
+     * @returns 0 for success, nonzero for failure.
+     */
+    int apply_batch();
+
+    /**
+     * @brief End a write batch.
+     *
+     * @param[in]  marker_flags           Flag of the marker ending the batch (commit or abort).
+     *
+     * @returns 0 for success, nonzero for failure.
+     */
+    int end_batch(uint32_t marker_flags);
+
+    /**
+     * @brief Check whether a write batch found in the active area was committed.
+     *
+     * @param[in]  offset                 Offset of the first record after the begin marker.
+     * @param[out] committed              Batch is followed by a commit marker.
+     * @param[out] end_offset             Offset of the marker or the invalid record ending the batch.
+     *
+     * @returns 0 for success, nonzero for failure.
+     */
+    int check_batch(uint32_t offset, bool &committed, uint32_t &end_offset);
+
+    /**
+     * @brief Write a snapshot of the RAM table to the active area.
+     *
+     * @param[in]  offset                 Offset of the snapshot record.
+     * @param[out] next_offset            Offset of next record.
+     *
+     * @returns 0 for success, MBED_ERROR_MEDIA_FULL if there is no room for it,
+     *          other nonzero for failure.
+     */
+    int write_checkpoint(uint32_t offset, uint32_t &next_offset);
+
+    /**
+     * @brief Load RAM table from the snapshot the master record of the active area points to.
+     *
+     * @param[out] offset                 Offset of the first record written after the snapshot.
+     *
+     * @returns 0 for success, nonzero if there is no valid snapshot.
+     */
+    int load_checkpoint(uint32_t &offset);
+
     /**
      * @brief Build RAM table and update _free_space_offset (scanning all the records in the area).
      *
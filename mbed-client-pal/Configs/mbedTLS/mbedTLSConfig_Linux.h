@@ -2613,6 +2613,11 @@
 
 /* SSL options */
 #define MBEDTLS_SSL_MAX_CONTENT_LEN             4096 /**< Maxium fragment length in bytes, determines the size of each of the two internal I/O buffers */
+
+// Shrink the IO buffers to the negotiated maximum fragment length after the handshake.
+#if defined(PAL_USE_TLS_VARIABLE_BUFFERS) && (PAL_USE_TLS_VARIABLE_BUFFERS == 1)
+    #define MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH
+#endif
 //#define MBEDTLS_SSL_DEFAULT_TICKET_LIFETIME     86400 /**< Lifetime of session tickets (if enabled) */
 //#define MBEDTLS_PSK_MAX_LEN               32 /**< Max size of TLS pre-shared keys, in bytes (default 256 bits) */
 //#define MBEDTLS_SSL_COOKIE_TIMEOUT        60 /**< Default expiration delay of DTLS cookies, in seconds if HAVE_TIME, or in number of cookies issued */
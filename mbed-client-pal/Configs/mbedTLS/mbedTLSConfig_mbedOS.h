@@ -234,6 +234,11 @@
     #define MBEDTLS_SSL_MAX_CONTENT_LEN 4096
 #endif
 
+// Shrink the IO buffers to the negotiated maximum fragment length after the handshake.
+#if defined(PAL_USE_TLS_VARIABLE_BUFFERS) && (PAL_USE_TLS_VARIABLE_BUFFERS == 1)
+    #define MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH
+#endif
+
 // needed for Base64 encoding Opaque data for
 // registration payload, adds 500 bytes to flash.
 #ifndef MBEDTLS_BASE64_C
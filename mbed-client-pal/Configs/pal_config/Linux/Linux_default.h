@@ -59,6 +59,12 @@
 #endif
 #endif
 
+/*\brief  Files opened read only of up to this size are mapped to memory and read without system calls. 0 disables it.
+ * The mapping has the size of the file when it was opened, and the file must not be truncated while it is open.*/
+#ifndef PAL_FS_MMAP_MAX_FILE_SIZE
+    #define PAL_FS_MMAP_MAX_FILE_SIZE (256 * 1024)
+#endif
+
 #ifndef PAL_NET_MAX_IF_NAME_LENGTH
     #define PAL_NET_MAX_IF_NAME_LENGTH   	16  //15 + '\0'
 #endif
@@ -67,6 +73,17 @@
     #define PAL_NET_TEST_MAX_ASYNC_SOCKETS 	5
 #endif
 
+/*\brief  Batch datagram APIs are implemented with recvmmsg() and sendmmsg()*/
+#ifndef PAL_NET_DATAGRAM_BATCH_SUPPORT
+    #define PAL_NET_DATAGRAM_BATCH_SUPPORT true
+#endif
+
+/*\brief  Use edge-triggered epoll instead of SIGIO and ppoll() in the async socket manager.
+ * Sockets are registered with epoll_ctl() and the number of async sockets is not limited by PAL_NET_TEST_MAX_ASYNC_SOCKETS.*/
+#ifndef PAL_NET_ASYNC_SOCKET_MANAGER_EPOLL
+    #define PAL_NET_ASYNC_SOCKET_MANAGER_EPOLL 0
+#endif
+
 // 16KB does not seem to be enough, some tests are failing with it
 #ifndef PAL_NET_TEST_ASYNC_SOCKET_MANAGER_THREAD_STACK_SIZE
     #define PAL_NET_TEST_ASYNC_SOCKET_MANAGER_THREAD_STACK_SIZE (1024 * 24)
@@ -84,6 +101,26 @@
     #endif
 #endif
 
+/*\brief  Multiplex all PAL timers onto one timerfd ordered by a min-heap instead of a POSIX timer and signal per timer*/
+#ifndef PAL_RTOS_TIMERFD_TIMERS
+    #define PAL_RTOS_TIMERFD_TIMERS 0
+#endif
+
+/*\brief  Time in milliseconds a timer may expire late, so that timers expiring close to each other share a wakeup. Used with PAL_RTOS_TIMERFD_TIMERS.*/
+#ifndef PAL_RTOS_TIMER_SLACK_MS
+    #define PAL_RTOS_TIMER_SLACK_MS 0
+#endif
+
+/*\brief  Implement mutexes and semaphores on atomics and futexes, entering the kernel only on contention, instead of on pthread mutexes and POSIX semaphores*/
+#ifndef PAL_RTOS_FUTEX_SYNC
+    #define PAL_RTOS_FUTEX_SYNC 0
+#endif
+
+/*\brief  Number of times a contended mutex is polled before the thread sleeps. Used with PAL_RTOS_FUTEX_SYNC.*/
+#ifndef PAL_RTOS_MUTEX_SPIN_COUNT
+    #define PAL_RTOS_MUTEX_SPIN_COUNT 100
+#endif
+
 #ifndef PAL_ASYNC_DNS_THREAD_STACK_SIZE
     #define PAL_ASYNC_DNS_THREAD_STACK_SIZE (1024 * 24)
 #else
@@ -19,6 +19,8 @@
 #include "pal_network.h"
 #include "pal_plat_network.h"
 
+#include <string.h>
+
 #define TRACE_GROUP "PAL"
 
 typedef struct pal_in_addr {
@@ -57,8 +59,27 @@ typedef struct pal_asyncAddressInfo
     void* callbackArgument;
 } pal_asyncAddressInfo_t;
 #endif // PAL_DNS_API_VERSION
+
+#if PAL_USE_DNS_CACHE && ((PAL_DNS_API_VERSION == 0) || (PAL_DNS_API_VERSION == 1))
+// entry of the cache used by pal_getAddressInfo
+typedef struct pal_dnsCacheEntry
+{
+    char* hostname; // NULL if the entry is free
+    palSocketAddress_t address;
+    palSocketLength_t addressLength;
+    uint64_t resolvedAt; // seconds since boot
+    uint64_t usedAt; // seconds since boot, the least recently used entry is replaced first
+    bool refreshing; // the hostname is being resolved again in the background
+} pal_dnsCacheEntry_t;
+#endif
 #endif // PAL_NET_DNS_SUPPORT
 
+#if PAL_NET_DNS_SUPPORT && PAL_USE_DNS_CACHE && ((PAL_DNS_API_VERSION == 0) || (PAL_DNS_API_VERSION == 1))
+PAL_PRIVATE pal_dnsCacheEntry_t g_dnsCache[PAL_DNS_CACHE_SIZE];
+PAL_PRIVATE palMutexID_t g_dnsCacheMutex = NULLPTR;
+PAL_PRIVATE int32_t g_dnsCacheRefreshes = 0;
+#endif
+
 palStatus_t pal_registerNetworkInterface(void* networkInterfaceContext, uint32_t* interfaceIndex)
 {
     PAL_VALIDATE_ARGUMENTS((networkInterfaceContext == NULL) || (interfaceIndex == NULL));
@@ -331,6 +352,68 @@ palStatus_t pal_sendTo(palSocket_t socket, const void* buffer, size_t length, co
 }
 
 
+palStatus_t pal_receiveFromBatch(palSocket_t socket, palDatagram_t* datagrams, uint32_t count, uint32_t* received)
+{
+
+    PAL_VALIDATE_ARGUMENTS((NULL == datagrams) || (0 == count) || (NULL == received));
+
+    palStatus_t result = PAL_SUCCESS;
+#if PAL_NET_DATAGRAM_BATCH_SUPPORT
+    result = pal_plat_receiveFromBatch(socket, datagrams, count, received);
+#else
+    uint32_t i;
+    for (i = 0; i < count; i++)
+    {
+        palDatagram_t* datagram = &datagrams[i];
+        datagram->addressLength = sizeof(palSocketAddress_t);
+        result = pal_plat_receiveFrom(socket, datagram->buffer, datagram->length, datagram->address,
+                                      datagram->address ? &datagram->addressLength : NULL, &datagram->bytesTransferred);
+        if (PAL_SUCCESS != result)
+        {
+            break;
+        }
+    }
+    // An error after the first datagram is reported again on the next call
+    if (i > 0)
+    {
+        result = PAL_SUCCESS;
+    }
+    *received = i;
+#endif
+    return result;
+}
+
+
+palStatus_t pal_sendToBatch(palSocket_t socket, palDatagram_t* datagrams, uint32_t count, uint32_t* sent)
+{
+
+    PAL_VALIDATE_ARGUMENTS((NULL == datagrams) || (0 == count) || (NULL == sent));
+
+    palStatus_t result = PAL_SUCCESS;
+#if PAL_NET_DATAGRAM_BATCH_SUPPORT
+    result = pal_plat_sendToBatch(socket, datagrams, count, sent);
+#else
+    uint32_t i;
+    for (i = 0; i < count; i++)
+    {
+        palDatagram_t* datagram = &datagrams[i];
+        result = pal_plat_sendTo(socket, datagram->buffer, datagram->length, datagram->address,
+                                 datagram->addressLength, &datagram->bytesTransferred);
+        if (PAL_SUCCESS != result)
+        {
+            break;
+        }
+    }
+    if (i > 0)
+    {
+        result = PAL_SUCCESS;
+    }
+    *sent = i;
+#endif
+    return result;
+}
+
+
 palStatus_t pal_close(palSocket_t* socket)
 {
 
@@ -438,12 +521,211 @@ palStatus_t pal_asynchronousSocketWithArgument(palSocketDomain_t domain, palSock
 
 #if PAL_NET_DNS_SUPPORT
 #if (PAL_DNS_API_VERSION == 0) || (PAL_DNS_API_VERSION == 1)
+#if PAL_USE_DNS_CACHE
+PAL_PRIVATE uint64_t pal_dnsCacheNow(void)
+{
+    return pal_osKernelSysTick() / pal_osKernelSysTickFrequency();
+}
+
+// must be called with g_dnsCacheMutex held
+PAL_PRIVATE pal_dnsCacheEntry_t* pal_dnsCacheFind(const char* hostname)
+{
+    for (int i = 0; i < PAL_DNS_CACHE_SIZE; i++)
+    {
+        if ((NULL != g_dnsCache[i].hostname) && (0 == strcmp(g_dnsCache[i].hostname, hostname)))
+        {
+            return &g_dnsCache[i];
+        }
+    }
+    return NULL;
+}
+
+// must be called with g_dnsCacheMutex held
+PAL_PRIVATE void pal_dnsCacheStore(const char* hostname, const palSocketAddress_t* address, palSocketLength_t addressLength)
+{
+    pal_dnsCacheEntry_t* entry = pal_dnsCacheFind(hostname);
+    if (NULL == entry)
+    {
+        entry = &g_dnsCache[0];
+        for (int i = 0; (i < PAL_DNS_CACHE_SIZE) && (NULL != entry->hostname); i++)
+        {
+            if ((NULL == g_dnsCache[i].hostname) || (g_dnsCache[i].usedAt < entry->usedAt))
+            {
+                entry = &g_dnsCache[i];
+            }
+        }
+
+        size_t length = strlen(hostname) + 1;
+        char* copy = (char*)malloc(length);
+        if (NULL == copy)
+        {
+            return;
+        }
+        memcpy(copy, hostname, length);
+        free(entry->hostname);
+        entry->hostname = copy;
+        entry->refreshing = false;
+    }
+    entry->address = *address;
+    entry->addressLength = addressLength;
+    entry->resolvedAt = pal_dnsCacheNow();
+    entry->usedAt = entry->resolvedAt;
+}
+
+// resolves an expired hostname again while its stale address is in use
+PAL_PRIVATE void pal_dnsCacheRefreshThreadFunc(void const* arg)
+{
+    char* hostname = (char*)arg;
+    palSocketAddress_t address;
+    palSocketLength_t addressLength = 0;
+
+    palStatus_t status = pal_plat_getAddressInfo(hostname, &address, &addressLength);
+
+    pal_osMutexWait(g_dnsCacheMutex, PAL_RTOS_WAIT_FOREVER);
+    if (PAL_SUCCESS == status)
+    {
+        pal_dnsCacheStore(hostname, &address, addressLength);
+    }
+    else
+    {
+        PAL_LOG_DBG("DNS cache refresh of %s failed with %" PRIx32 "\n", hostname, status);
+    }
+    pal_dnsCacheEntry_t* entry = pal_dnsCacheFind(hostname);
+    if (NULL != entry)
+    {
+        entry->refreshing = false;
+    }
+    g_dnsCacheRefreshes--;
+    pal_osMutexRelease(g_dnsCacheMutex);
+
+    free(hostname);
+}
+
+PAL_PRIVATE bool pal_dnsCacheLookup(const char* hostname, palSocketAddress_t* address, palSocketLength_t* addressLength)
+{
+    bool found = false;
+    char* refresh = NULL;
+
+    pal_osMutexWait(g_dnsCacheMutex, PAL_RTOS_WAIT_FOREVER);
+    pal_dnsCacheEntry_t* entry = pal_dnsCacheFind(hostname);
+    if (NULL != entry)
+    {
+        uint64_t now = pal_dnsCacheNow();
+        uint64_t age = now - entry->resolvedAt;
+        if (age < (uint64_t)PAL_DNS_CACHE_TTL + PAL_DNS_CACHE_STALE_TIME)
+        {
+            *address = entry->address;
+            *addressLength = entry->addressLength;
+            entry->usedAt = now;
+            found = true;
+
+            if ((age >= PAL_DNS_CACHE_TTL) && !entry->refreshing)
+            {
+                size_t length = strlen(hostname) + 1;
+                refresh = (char*)malloc(length);
+                if (NULL != refresh)
+                {
+                    memcpy(refresh, hostname, length);
+                    entry->refreshing = true;
+                    g_dnsCacheRefreshes++;
+                }
+            }
+        }
+    }
+    pal_osMutexRelease(g_dnsCacheMutex);
+
+    if (NULL != refresh)
+    {
+        palThreadID_t threadID = NULLPTR;
+        if (PAL_SUCCESS != pal_osThreadCreateWithAlloc(pal_dnsCacheRefreshThreadFunc, refresh, PAL_osPriorityReservedDNS, PAL_NET_ASYNC_DNS_THREAD_STACK_SIZE, NULL, &threadID))
+        {
+            // the stale address is still returned, the next lookup tries again
+            pal_osMutexWait(g_dnsCacheMutex, PAL_RTOS_WAIT_FOREVER);
+            entry = pal_dnsCacheFind(hostname);
+            if (NULL != entry)
+            {
+                entry->refreshing = false;
+            }
+            g_dnsCacheRefreshes--;
+            pal_osMutexRelease(g_dnsCacheMutex);
+            free(refresh);
+        }
+    }
+
+    return found;
+}
+
+palStatus_t pal_initDNSCache(void)
+{
+    memset(g_dnsCache, 0, sizeof(g_dnsCache));
+    g_dnsCacheRefreshes = 0;
+    return pal_osMutexCreate(&g_dnsCacheMutex);
+}
+
+void pal_cleanupDNSCache(void)
+{
+    if (NULLPTR == g_dnsCacheMutex)
+    {
+        return;
+    }
+
+    // background resolves hold the mutex when they finish
+    pal_osMutexWait(g_dnsCacheMutex, PAL_RTOS_WAIT_FOREVER);
+    while (g_dnsCacheRefreshes > 0)
+    {
+        pal_osMutexRelease(g_dnsCacheMutex);
+        pal_osDelay(10);
+        pal_osMutexWait(g_dnsCacheMutex, PAL_RTOS_WAIT_FOREVER);
+    }
+    pal_osMutexRelease(g_dnsCacheMutex);
+
+    pal_removeDNSCacheEntry(NULL);
+    pal_osMutexDelete(&g_dnsCacheMutex);
+    g_dnsCacheMutex = NULLPTR;
+}
+
+palStatus_t pal_removeDNSCacheEntry(const char *hostname)
+{
+    if (NULLPTR == g_dnsCacheMutex)
+    {
+        return PAL_SUCCESS;
+    }
+
+    pal_osMutexWait(g_dnsCacheMutex, PAL_RTOS_WAIT_FOREVER);
+    for (int i = 0; i < PAL_DNS_CACHE_SIZE; i++)
+    {
+        if ((NULL != g_dnsCache[i].hostname) && ((NULL == hostname) || (0 == strcmp(g_dnsCache[i].hostname, hostname))))
+        {
+            free(g_dnsCache[i].hostname);
+            g_dnsCache[i].hostname = NULL;
+            g_dnsCache[i].refreshing = false;
+        }
+    }
+    pal_osMutexRelease(g_dnsCacheMutex);
+    return PAL_SUCCESS;
+}
+#endif // PAL_USE_DNS_CACHE
+
 palStatus_t pal_getAddressInfo(const char *hostname, palSocketAddress_t *address, palSocketLength_t* addressLength)
 {
     PAL_VALIDATE_ARGUMENTS ((NULL == hostname) || (NULL == address) || (NULL == addressLength));
 
     palStatus_t result = PAL_SUCCESS;
+#if PAL_USE_DNS_CACHE
+    if ((NULLPTR != g_dnsCacheMutex) && pal_dnsCacheLookup(hostname, address, addressLength))
+    {
+        return PAL_SUCCESS;
+    }
+#endif
     result = pal_plat_getAddressInfo(hostname, address, addressLength);
+#if PAL_USE_DNS_CACHE
+    if ((PAL_SUCCESS == result) && (NULLPTR != g_dnsCacheMutex))
+    {
+        pal_osMutexWait(g_dnsCacheMutex, PAL_RTOS_WAIT_FOREVER);
+        pal_dnsCacheStore(hostname, address, *addressLength);
+        pal_osMutexRelease(g_dnsCacheMutex);
+    }
+#endif
     return result; // TODO(nirson01) ADD debug print for error propagation(once debug print infrastructure is finalized)
 }
 #endif
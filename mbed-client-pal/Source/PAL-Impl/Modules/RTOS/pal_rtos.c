@@ -18,6 +18,7 @@
 #include "pal_plat_rtos.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #define TRACE_GROUP "PAL"
 
@@ -143,6 +144,14 @@ palThreadID_t pal_osThreadGetId(void)
     return threadID;
 }
 
+palStatus_t pal_osThreadStatsGet(palThreadID_t threadID, palThreadStats_t* stats)
+{
+    PAL_VALIDATE_ARGUMENTS((PAL_INVALID_THREAD == threadID) || (NULL == stats));
+    memset(stats, 0, sizeof(palThreadStats_t));
+    palStatus_t status = pal_plat_osThreadStatsGet(threadID, stats);
+    return status;
+}
+
 palStatus_t pal_osDelay(uint32_t milliseconds)
 {
     palStatus_t status;
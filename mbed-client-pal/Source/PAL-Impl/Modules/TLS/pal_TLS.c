@@ -123,6 +123,13 @@ palStatus_t pal_initTLS(palTLSConfHandle_t palTLSConf, palTLSHandle_t* palTLSHan
                 PAL_LOG_ERR("Failed to load ssl session:-0x%" PRIx32 ".", tmp_status);
                 status = tmp_status;
             }
+#if (PAL_USE_SSL_SESSION_TICKETS == 1)
+            // Without a CID context to continue, a session ticket still avoids the full handshake
+            if (PAL_SUCCESS == status && palTLSConfCtx->useSslSessionResume &&
+                    !(palTLSConfCtx->isDtlsMode && pal_plat_sslSessionAvailable())) {
+                (void)pal_plat_loadSslTicketSession(palTLSCtx->platTlsHandle);
+            }
+#endif
         }
 #endif
     }
@@ -512,7 +519,7 @@ palStatus_t pal_handShake(palTLSHandle_t palTLSHandle, palTLSConfHandle_t palTLS
                 {
                     palTLSCtx->serverTime = 0;
 #if (PAL_USE_SSL_SESSION_RESUME == 1)
-                    pal_removeSslSessionFromStorage(palTLSConfCtx->platTlsConfHandle);
+                    pal_removeSslSessionFromStorage(palTLSConf);
 #endif
                 }
             }
@@ -528,7 +535,7 @@ palStatus_t pal_handShake(palTLSHandle_t palTLSHandle, palTLSConfHandle_t palTLS
         if (PAL_SUCCESS != status)
         {
 #if (PAL_USE_SSL_SESSION_RESUME == 1)
-            pal_removeSslSessionFromStorage(palTLSConfCtx->platTlsConfHandle);
+            pal_removeSslSessionFromStorage(palTLSConf);
 #endif
             goto finish;
         }
@@ -547,6 +554,11 @@ palStatus_t pal_handShake(palTLSHandle_t palTLSHandle, palTLSConfHandle_t palTLS
     if (PAL_SUCCESS == status) {
         pal_saveSslSessionToStorage(palTLSHandle, palTLSConf);
         PAL_LOG_DBG("pal_handShake: handshake done, storing session!");
+#if (PAL_USE_SSL_SESSION_TICKETS == 1)
+        if (palTLSConfCtx->useSslSessionResume) {
+            (void)pal_plat_saveSslTicketSession(palTLSCtx->platTlsHandle);
+        }
+#endif
         if (palTLSConfCtx->isDtlsMode) {
             pal_print_cid(palTLSCtx->platTlsHandle);
         }
@@ -603,6 +615,30 @@ palStatus_t pal_sslRead(palTLSHandle_t palTLSHandle, void *buffer, uint32_t len,
     return status;
 }
 
+palStatus_t pal_sslReadInPlace(palTLSHandle_t palTLSHandle, const uint8_t **data, uint32_t* actualLen)
+{
+    palStatus_t status = PAL_SUCCESS;
+    palTLSService_t* palTLSCtx = (palTLSService_t*)palTLSHandle;
+
+    PAL_VALIDATE_ARGUMENTS (NULLPTR == palTLSHandle);
+    PAL_VALIDATE_ARGUMENTS ((NULLPTR == palTLSCtx->platTlsHandle || NULL == data || NULL == actualLen));
+
+    status = pal_plat_sslReadInPlace(palTLSCtx->platTlsHandle, data, actualLen);
+    return status;
+}
+
+palStatus_t pal_sslReadInPlaceDone(palTLSHandle_t palTLSHandle)
+{
+    palStatus_t status = PAL_SUCCESS;
+    palTLSService_t* palTLSCtx = (palTLSService_t*)palTLSHandle;
+
+    PAL_VALIDATE_ARGUMENTS (NULLPTR == palTLSHandle);
+    PAL_VALIDATE_ARGUMENTS (NULLPTR == palTLSCtx->platTlsHandle);
+
+    status = pal_plat_sslReadInPlaceDone(palTLSCtx->platTlsHandle);
+    return status;
+}
+
 
 palStatus_t pal_sslWrite(palTLSHandle_t palTLSHandle, palTLSConfHandle_t palTLSConf, const void *buffer, uint32_t len, uint32_t *bytesWritten)
 {
@@ -622,11 +658,37 @@ palStatus_t pal_sslWrite(palTLSHandle_t palTLSHandle, palTLSConfHandle_t palTLSC
     return status;
 }
 
+palStatus_t pal_sslBeginCoalescing(palTLSHandle_t palTLSHandle, uint32_t datagramSize)
+{
+    palStatus_t status = PAL_SUCCESS;
+    palTLSService_t* palTLSCtx = (palTLSService_t*)palTLSHandle;
+
+    PAL_VALIDATE_ARGUMENTS((NULLPTR == palTLSHandle || 0 == datagramSize));
+    status = pal_plat_sslBeginCoalescing(palTLSCtx->platTlsHandle, datagramSize);
+    return status;
+}
+
+palStatus_t pal_sslEndCoalescing(palTLSHandle_t palTLSHandle)
+{
+    palStatus_t status = PAL_SUCCESS;
+    palTLSService_t* palTLSCtx = (palTLSService_t*)palTLSHandle;
+
+    PAL_VALIDATE_ARGUMENTS(NULLPTR == palTLSHandle);
+    status = pal_plat_sslEndCoalescing(palTLSCtx->platTlsHandle);
+    return status;
+}
+
 palStatus_t pal_sslDebugging(uint8_t turnOn)
 {
     return PAL_ERR_NOT_SUPPORTED;
 }
 
+palStatus_t pal_sslGetHeapUsage(uint32_t* currentBytes, uint32_t* peakBytes)
+{
+    PAL_VALIDATE_ARGUMENTS((NULL == currentBytes || NULL == peakBytes));
+    return pal_plat_sslGetHeapUsage(currentBytes, peakBytes);
+}
+
 palStatus_t pal_sslSetDebugging(palTLSConfHandle_t palTLSConf, uint8_t turnOn)
 {
     palStatus_t status = PAL_SUCCESS;
@@ -646,6 +708,11 @@ void pal_enableSslSessionStoring(palTLSConfHandle_t palTLSConf, bool enable)
             pal_plat_removeSslSession();
         }
     }
+#if (PAL_USE_SSL_SESSION_TICKETS == 1)
+    if (!enable) {
+        pal_plat_removeSslTicketSession();
+    }
+#endif
     palTLSConfCtx->useSslSessionResume = enable;
 }
 #endif
@@ -686,6 +753,9 @@ void pal_remove_cid()
                                  KCM_CONFIG_ITEM);
 
     pal_plat_removeSslSession();
+#if (PAL_USE_SSL_SESSION_TICKETS == 1)
+    pal_plat_removeSslTicketSession();
+#endif
 #endif
 }
 
@@ -715,6 +785,9 @@ void pal_removeSslSessionFromStorage(palTLSConfHandle_t palTLSConf)
                         strlen(kcm_session_item_name),
                         KCM_CONFIG_ITEM);
     }
+#if (PAL_USE_SSL_SESSION_TICKETS == 1)
+    pal_plat_removeSslTicketSession();
+#endif
 }
 
 void pal_saveSslSessionToStorage(palTLSHandle_t palTLSHandle, palTLSConfHandle_t palTLSConf)
@@ -243,6 +243,28 @@ palStatus_t pal_sslGetVerifyResultExtended(palTLSHandle_t palTLSHandle, int32_t*
  */
 palStatus_t pal_sslRead(palTLSHandle_t palTLSHandle, void *buffer, uint32_t len, uint32_t* actualLen);
 
+/*! \brief Read the application data of the next record without copying it out of the TLS library.
+ *
+ * The data stays valid until `pal_sslReadInPlaceDone()` is called, which must be done before
+ * any other call with the same TLS context, other than `pal_sslWrite()` and `pal_freeTLS()`.
+ *
+ * @param[in] palTLSHandle: The TLS context.
+ * @param[out] data: Points to the decrypted application data.
+ * @param[out] actualLen: The number of bytes of application data.
+ *
+ * \return PAL_SUCCESS on success, or a negative value indicating a specific error code in case of failure.
+ * \return PAL_ERR_NOT_SUPPORTED if the TLS library cannot lend its buffer, `pal_sslRead()` must be used instead.
+ */
+palStatus_t pal_sslReadInPlace(palTLSHandle_t palTLSHandle, const uint8_t **data, uint32_t* actualLen);
+
+/*! \brief Release the application data returned by `pal_sslReadInPlace()`.
+ *
+ * @param[in] palTLSHandle: The TLS context.
+ *
+ * \return PAL_SUCCESS on success, or a negative value indicating a specific error code in case of failure.
+ */
+palStatus_t pal_sslReadInPlaceDone(palTLSHandle_t palTLSHandle);
+
 /*! \brief Write the exact length of application data bytes.
  *
  * @param[in] palTLSHandle: The TLS context.
@@ -255,6 +277,26 @@ palStatus_t pal_sslRead(palTLSHandle_t palTLSHandle, void *buffer, uint32_t len,
  */
 palStatus_t pal_sslWrite(palTLSHandle_t palTLSHandle, palTLSConfHandle_t palTLSConf, const void *buffer, uint32_t len, uint32_t *bytesWritten);
 
+/*! \brief Start packing the records of the following `pal_sslWrite()` calls into shared datagrams.
+ *  DTLS only, TLS returns `PAL_ERR_NOT_SUPPORTED`.
+ *
+ * A datagram is sent when the next record would not fit in `datagramSize` bytes, and when `pal_sslEndCoalescing()` is called.
+ *
+ * @param[in] palTLSHandle: The TLS context.
+ * @param[in] datagramSize: The maximum size of a datagram, normally the path MTU less the IP and UDP headers.
+ *
+ * \return PAL_SUCCESS on success, or a negative value indicating a specific error code in case of failure.
+ */
+palStatus_t pal_sslBeginCoalescing(palTLSHandle_t palTLSHandle, uint32_t datagramSize);
+
+/*! \brief Send the records packed since `pal_sslBeginCoalescing()` and send the following records one per datagram again.
+ *
+ * @param[in] palTLSHandle: The TLS context.
+ *
+ * \return PAL_SUCCESS on success, or a negative value indicating a specific error code in case of failure.
+ */
+palStatus_t pal_sslEndCoalescing(palTLSHandle_t palTLSHandle);
+
 /*! \brief Turn the debugging on or off for the given TLS library configuration handle. The logs are sent via the `mbedTrace`.
  *   In case of release mode, an error will be returned.
  *
@@ -274,6 +316,17 @@ palStatus_t pal_sslSetDebugging(palTLSConfHandle_t palTLSConf,uint8_t turnOn);
  */
 palStatus_t pal_sslDebugging(uint8_t turnOn);
 
+/*! \brief Get the heap used by the TLS library, for sizing the heap of memory-constrained devices.
+ *  Requires PAL_USE_TLS_HEAP_STATS.
+ *
+ * @param[out] currentBytes: The number of bytes the TLS library has allocated now.
+ * @param[out] peakBytes: The highest number of bytes the TLS library has had allocated at once.
+ *
+ * \return PAL_SUCCESS on success.
+ * \return PAL_ERR_NOT_SUPPORTED if PAL_USE_TLS_HEAP_STATS is not enabled.
+ */
+palStatus_t pal_sslGetHeapUsage(uint32_t* currentBytes, uint32_t* peakBytes);
+
 /*! \brief Stores CID context persistently for DTLS based setup.
  *
  */
@@ -139,10 +139,34 @@
 #define PAL_DNS_API_VERSION 0 //!< syncronous DNS API
 #endif
 
+//! Cache the results of `pal_getAddressInfo` for `PAL_DNS_CACHE_TTL` seconds. Applies to DNS API versions 0 and 1, which all resolve through `pal_getAddressInfo`.
+#ifndef PAL_USE_DNS_CACHE
+    #define PAL_USE_DNS_CACHE 0
+#endif
+
+//! The number of hostnames kept in the DNS cache, the least recently used entry is replaced when it is full.
+#ifndef PAL_DNS_CACHE_SIZE
+    #define PAL_DNS_CACHE_SIZE 4
+#endif
+
+//! Time in seconds a cached address is used without resolving the hostname again. The platform resolvers do not report the record TTL.
+#ifndef PAL_DNS_CACHE_TTL
+    #define PAL_DNS_CACHE_TTL 300
+#endif
+
+//! Time in seconds after the TTL during which an expired address is still returned while the hostname is resolved again in the background. 0 resolves expired entries synchronously.
+#ifndef PAL_DNS_CACHE_STALE_TIME
+    #define PAL_DNS_CACHE_STALE_TIME 3600
+#endif
+
 #ifndef PAL_NET_SERVER_SOCKET_API
     #define PAL_NET_SERVER_SOCKET_API                 true //!< Add PAL support for server socket.
 #endif
 
+#ifndef PAL_NET_DATAGRAM_BATCH_SUPPORT
+    #define PAL_NET_DATAGRAM_BATCH_SUPPORT            false //!< Platform implements batch datagram APIs. If not, `pal_receiveFromBatch` and `pal_sendToBatch` loop over single datagrams.
+#endif
+
 #ifndef PAL_SUPPORT_IP_V4
     #define PAL_SUPPORT_IP_V4                 1 //!< support IPV4 as default
 #endif
@@ -516,6 +540,48 @@
     #define PAL_USE_SSL_SESSION_RESUME 0
 #endif
 
+//! Keep the last RFC 5077 session ticket in RAM and offer it on reconnect when there is no
+//! CID context to restore, so that a new connection takes an abbreviated handshake.
+//! Requires PAL_USE_SSL_SESSION_RESUME and MBEDTLS_SSL_SESSION_TICKETS.
+#ifndef PAL_USE_SSL_SESSION_TICKETS
+    #define PAL_USE_SSL_SESSION_TICKETS 0
+#endif
+
+#if ((PAL_USE_SSL_SESSION_TICKETS == 1) && (PAL_USE_SSL_SESSION_RESUME == 0))
+    #error "PAL_USE_SSL_SESSION_TICKETS requires PAL_USE_SSL_SESSION_RESUME"
+#endif
+
+//! Keep the parsed own certificate chain, private key and CA chain in RAM after the TLS
+//! configuration is freed. The next configuration reuses them as long as the credentials
+//! given to it are identical, which saves parsing and heap churn on every reconnect.
+#ifndef PAL_USE_TLS_CREDENTIAL_CACHE
+    #define PAL_USE_TLS_CREDENTIAL_CACHE 0
+#endif
+
+//! Remember the hash of the last server certificate chain that passed full path validation,
+//! together with a hash of the trusted CA chain it was validated against. While the CA chain
+//! is the same and the time is known, handshakes skip path validation, and the chain the
+//! server presented is compared to the remembered one after the handshake instead. A different
+//! chain is validated in full before the handshake is reported successful. The server still
+//! proves ownership of the certificate key in the handshake.
+#ifndef PAL_USE_TLS_VERIFIED_CHAIN_CACHE
+    #define PAL_USE_TLS_VERIFIED_CHAIN_CACHE 0
+#endif
+
+//! Shrink the mbedTLS input and output buffers to the negotiated maximum fragment length
+//! after the handshake and grow them again for the next handshake. Enables
+//! MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH in the PAL mbedTLS configurations, so it saves RAM
+//! only together with PAL_MAX_FRAG_LEN.
+#ifndef PAL_USE_TLS_VARIABLE_BUFFERS
+    #define PAL_USE_TLS_VARIABLE_BUFFERS 0
+#endif
+
+//! Track the current and peak heap used by mbedTLS, read with pal_sslGetHeapUsage().
+//! Requires MBEDTLS_PLATFORM_MEMORY, or MBEDTLS_MEMORY_DEBUG with PAL_USE_STATIC_MEMBUF_FOR_MBEDTLS.
+#ifndef PAL_USE_TLS_HEAP_STATS
+    #define PAL_USE_TLS_HEAP_STATS 0
+#endif
+
 // Sanity check for using static memory buffer with mbedtls.
 #ifdef PAL_USE_STATIC_MEMBUF_FOR_MBEDTLS
 
@@ -159,9 +159,16 @@ extern "C" {
 #define PAL_DAYS_IN_A_YEAR            (365U)
 #define PAL_RATIO_SECONDS_PER_DAY     480
 #define PAL_MINIMUM_RTC_LATENCY_SEC       100
+//!< Drift needed before the secure time is written to storage, can be overridden to trade flash wear against accuracy after a reboot
+#ifndef PAL_MINIMUM_STORAGE_LATENCY_SEC
 #define PAL_MINIMUM_STORAGE_LATENCY_SEC   500000
+#endif
+#ifndef PAL_MINIMUM_FORWARD_LATENCY_SEC
 #define PAL_MINIMUM_FORWARD_LATENCY_SEC      100000
+#endif
+#ifndef PAL_MINIMUM_BACKWARD_LATENCY_SEC
 #define PAL_MINIMUM_BACKWARD_LATENCY_SEC      100
+#endif
 #define PAL_FEB_MONTH 2
 #define PAL_MILLI_PER_SECOND 1000
 #define PAL_NANO_PER_MILLI 1000000L
@@ -56,6 +56,15 @@ typedef void *palAddressInfo_t; /*!< \brief PAL address info handle type. */
 #endif // (PAL_DNS_API_VERSION == 3)
 #endif // PAL_NET_DNS_SUPPORT
 
+/*! \brief A datagram used with `pal_receiveFromBatch` and `pal_sendToBatch`. */
+typedef struct palDatagram {
+    void *buffer;                       /*!< \brief The buffer for the payload data. */
+    size_t length;                      /*!< \brief The length of the buffer on receive, the length of the payload on send. */
+    palSocketAddress_t *address;        /*!< \brief The address that sent the payload on receive (optional, pass NULL when not used), the destination address on send. */
+    palSocketLength_t addressLength;    /*!< \brief The length of the address returned on receive, the length of `address` on send. */
+    size_t bytesTransferred;            /*!< \brief The actual amount of payload data received or sent. */
+} palDatagram_t;
+
 typedef struct palNetInterfaceInfo {
     char interfaceName[16]; //15 + ‘\0’
     palSocketAddress_t address;
@@ -241,6 +250,25 @@ palStatus_t pal_receiveFrom(palSocket_t socket, void *buffer, size_t length, pal
  */
 palStatus_t pal_sendTo(palSocket_t socket, const void *buffer, size_t length, const palSocketAddress_t *to, palSocketLength_t toLength, size_t *bytesSent);
 
+/*! \brief Receive several payloads from a specific socket with as few system calls as the platform allows.
+ * @param[in] socket The socket to receive from. The socket passed to this function should be of type `PAL_SOCK_DGRAM`.
+ * @param[in, out] datagrams The datagrams to fill, one payload per datagram. `buffer`, `length` and `address` are inputs, `addressLength` and `bytesTransferred` are outputs.
+ * @param[in] count The number of datagrams in `datagrams`.
+ * @param[out] received The number of datagrams filled. This may be less than `count` even if more data is pending.
+ * \return PAL_SUCCESS (0) if at least one datagram was received, or a specific negative error code in case of failure.
+ * PAL_ERR_SOCKET_WOULD_BLOCK is returned from a non-blocking socket which has no data available.
+ */
+palStatus_t pal_receiveFromBatch(palSocket_t socket, palDatagram_t *datagrams, uint32_t count, uint32_t *received);
+
+/*! \brief Send several payloads using a specific socket with as few system calls as the platform allows.
+ * @param[in] socket The socket to use for sending the payloads. The socket passed to this function should be of type `PAL_SOCK_DGRAM`.
+ * @param[in, out] datagrams The datagrams to send, in order. `bytesTransferred` is updated for the datagrams sent.
+ * @param[in] count The number of datagrams in `datagrams`.
+ * @param[out] sent The number of datagrams sent. Sending stops at the first datagram which could not be sent.
+ * \return PAL_SUCCESS (0) if at least one datagram was sent, or a specific negative error code in case of failure.
+ */
+palStatus_t pal_sendToBatch(palSocket_t socket, palDatagram_t *datagrams, uint32_t count, uint32_t *sent);
+
 /*! \brief Close a network socket.
  * @param[in,out] socket The socket to be closed.
  * \return PAL_SUCCESS (0) in case of success, or a specific negative error code in case of failure.
@@ -372,6 +400,29 @@ palStatus_t pal_asynchronousSocketWithArgument(palSocketDomain_t domain, palSock
  */
 palStatus_t pal_getAddressInfo(const char *hostname, palSocketAddress_t *address, palSocketLength_t *addressLength);
 
+#if PAL_USE_DNS_CACHE
+/*! \brief Remove a hostname from the DNS cache so that the next `pal_getAddressInfo` call resolves it again.
+ *
+ * Use this when the cached address no longer answers, for example after a connection to it has failed.
+ * @param[in] hostname The hostname to remove, or NULL to remove all the hostnames.
+ * \return PAL_SUCCESS (0) in case of success, or a specific negative error code in case of failure.
+ */
+palStatus_t pal_removeDNSCacheEntry(const char *hostname);
+
+/*! \brief Initialize the DNS cache.
+ *
+ * \note You must call this function in the general PAL initialization function.
+ * \return PAL_SUCCESS (0) in case of success, or a specific negative error code in case of failure.
+ */
+palStatus_t pal_initDNSCache(void);
+
+/*! \brief Free the DNS cache.
+ *
+ * \note You must call this function in the general PAL cleanup function.
+ */
+void pal_cleanupDNSCache(void);
+#endif
+
 #if (PAL_DNS_API_VERSION == 1)
 
 /*! \brief Prototype of the callback function invoked when querying address info asynchronously using `pal_getAddressInfoAsync`.
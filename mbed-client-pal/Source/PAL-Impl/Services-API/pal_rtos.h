@@ -91,6 +91,16 @@ typedef struct pal_threadLocalStore{
     void* storeData;
 } palThreadLocalStore_t;
 
+//! \brief Runtime statistics of a PAL thread.
+//!
+//! Values that the platform cannot measure are 0.
+typedef struct pal_threadStats{
+    uint32_t    stackSize;          /*!< \brief Stack size of the thread in bytes. */
+    uint32_t    stackHighWater;     /*!< \brief Largest stack use of the thread in bytes, measured from the stack painted at creation. */
+    uint64_t    cpuTimeMicroSec;    /*!< \brief CPU time used by the thread in microseconds. */
+    uint32_t    contextSwitches;    /*!< \brief Number of times the thread was switched out. */
+} palThreadStats_t;
+
 typedef struct pal_timeVal{
     int32_t    pal_tv_sec;      /*!< \brief Seconds. */
     int32_t    pal_tv_usec;     /*!< \brief Microseconds. */
@@ -171,6 +181,19 @@ palStatus_t pal_osThreadTerminate(palThreadID_t* threadID);
 */
 palThreadID_t pal_osThreadGetId(void);
 
+/*! \brief Get the runtime statistics of a thread created with \c pal_osThreadCreateWithAlloc().
+*
+* Can be used to size thread stacks from the measured stack use instead of by estimate.
+*
+* @param[in] threadID The thread ID of a running thread.
+* @param[out] stats The statistics of the thread.
+*
+* \return PAL_SUCCESS(0) in case of success.
+* \return PAL_ERR_RTOS_PARAMETER if the thread was not created by PAL or has finished.
+* \return PAL_ERR_NOT_SUPPORTED if the platform does not provide thread statistics.
+*/
+palStatus_t pal_osThreadStatsGet(palThreadID_t threadID, palThreadStats_t* stats);
+
 /*! \brief Wait for a specified time period in milliseconds.
 *
 * @param[in] milliseconds The number of milliseconds to wait before proceeding.
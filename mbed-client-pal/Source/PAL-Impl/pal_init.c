@@ -33,6 +33,9 @@ PAL_PRIVATE int32_t g_palIntialized = 0;
 PAL_PRIVATE void pal_modulesCleanup(void)
 {
     DEBUG_PRINT("Destroying modules\r\n");
+#if PAL_NET_DNS_SUPPORT && PAL_USE_DNS_CACHE && ((PAL_DNS_API_VERSION == 0) || (PAL_DNS_API_VERSION == 1))
+    pal_cleanupDNSCache();
+#endif
     pal_plat_socketsTerminate(NULL);
     pal_plat_DRBGDestroy();
 #ifndef MBED_CONF_MBED_CLOUD_CLIENT_EXTERNAL_SST_SUPPORT
@@ -67,6 +70,12 @@ palStatus_t pal_init(void)
         {
             DEBUG_PRINT("Network init\r\n");
             status = pal_plat_socketsInit(NULL);
+#if PAL_NET_DNS_SUPPORT && PAL_USE_DNS_CACHE && ((PAL_DNS_API_VERSION == 0) || (PAL_DNS_API_VERSION == 1))
+            if (PAL_SUCCESS == status)
+            {
+                status = pal_initDNSCache();
+            }
+#endif
             if (PAL_SUCCESS != status)
             {
                 DEBUG_PRINT("init of network module has failed with status %" PRIx32 "\r\n",status);
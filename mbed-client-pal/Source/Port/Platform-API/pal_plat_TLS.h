@@ -172,6 +172,42 @@ palStatus_t pal_plat_sslRead(palTLSHandle_t palTLSHandle, void *buffer, uint32_t
  */
 palStatus_t pal_plat_sslWrite(palTLSHandle_t palTLSHandle, const void *buffer, uint32_t len, uint32_t *bytesWritten);
 
+/*! \brief Read the application data of the next record in place, without copying it.
+ *
+ * @param[in] palTLSHandle: The TLS context.
+ * @param[out] data: Points to the decrypted application data, valid until `pal_plat_sslReadInPlaceDone()`.
+ * @param[out] actualLen: The number of bytes of application data.
+ *
+ * \return PAL_SUCCESS on success. A negative value indicating a specific error code in case of failure.
+ */
+palStatus_t pal_plat_sslReadInPlace(palTLSHandle_t palTLSHandle, const uint8_t **data, uint32_t* actualLen);
+
+/*! \brief Consume the application data returned by `pal_plat_sslReadInPlace()`.
+ *
+ * @param[in] palTLSHandle: The TLS context.
+ *
+ * \return PAL_SUCCESS on success. A negative value indicating a specific error code in case of failure.
+ */
+palStatus_t pal_plat_sslReadInPlaceDone(palTLSHandle_t palTLSHandle);
+
+/*! \brief Start packing the records written with `pal_plat_sslWrite()` into shared datagrams.
+ *	DTLS only.
+ *
+ * @param[in] palTLSHandle: The TLS context.
+ * @param[in] datagramSize: The maximum size of a datagram.
+ *
+ * \return PAL_SUCCESS on success. A negative value indicating a specific error code in case of failure.
+ */
+palStatus_t pal_plat_sslBeginCoalescing(palTLSHandle_t palTLSHandle, uint32_t datagramSize);
+
+/*! \brief Send the packed records and stop packing records into shared datagrams.
+ *
+ * @param[in] palTLSHandle: The TLS context.
+ *
+ * \return PAL_SUCCESS on success. A negative value indicating a specific error code in case of failure.
+ */
+palStatus_t pal_plat_sslEndCoalescing(palTLSHandle_t palTLSHandle);
+
 /*! \brief Set the retransmit timeout values for the DTLS handshake.
  *	DTLS only, no effect on TLS.
  *
@@ -284,6 +320,15 @@ palStatus_t pal_plat_setAuthenticationMode(palTLSConfHandle_t sslConf, palTLSAut
  */
 palStatus_t pal_plat_sslSetDebugging(palTLSConfHandle_t palTLSConf, uint8_t turnOn);
 
+/*! \brief Get the current and peak heap used by the TLS library.
+ *
+ * @param[out] currentBytes: The number of bytes allocated now.
+ * @param[out] peakBytes: The highest number of bytes allocated at once.
+ *
+ * \return PAL_SUCCESS on success, PAL_ERR_NOT_SUPPORTED if the usage is not tracked.
+ */
+palStatus_t pal_plat_sslGetHeapUsage(uint32_t* currentBytes, uint32_t* peakBytes);
+
 /*! \brief Set the IO callbacks for the TLS context.
  *
  * @param[in] palTLSConf: The TLS configuration context.
@@ -401,6 +446,28 @@ void pal_plat_set_cid_value(palTLSHandle_t palTLSHandle, const uint8_t *data_ptr
  */
 void pal_plat_get_cid_value(palTLSHandle_t palTLSHandle, uint8_t *data_ptr, size_t *data_len);
 
+#if (PAL_USE_SSL_SESSION_TICKETS == 1)
+/*! \brief Keep the session of a completed handshake in RAM if the server issued a session ticket for it.
+ *
+ * @param[in] palTLSHandle: The TLS context.
+ *
+ * \return PAL_SUCCESS if a ticket was stored, otherwise an error and any earlier ticket is dropped.
+ */
+palStatus_t pal_plat_saveSslTicketSession(palTLSHandle_t palTLSHandle);
+
+/*! \brief Offer the session ticket kept in RAM in the next handshake.
+ *
+ * @param[in] palTLSHandle: The TLS context, after `pal_plat_sslSetup()`.
+ *
+ * \return PAL_SUCCESS if a ticket was set, PAL_ERR_GENERIC_FAILURE if there is none.
+ */
+palStatus_t pal_plat_loadSslTicketSession(palTLSHandle_t palTLSHandle);
+
+/*! \brief Drop the session ticket kept in RAM.
+ */
+void pal_plat_removeSslTicketSession(void);
+#endif //PAL_USE_SSL_SESSION_TICKETS
+
 #endif //PAL_USE_SSL_SESSION_RESUME
 #endif //_PAL_PLAT_TLS_H_
 
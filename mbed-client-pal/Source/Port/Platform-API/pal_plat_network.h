@@ -126,6 +126,28 @@ palStatus_t pal_plat_receiveFrom(palSocket_t socket, void* buffer, size_t length
  */
 palStatus_t pal_plat_sendTo(palSocket_t socket, const void* buffer, size_t length, const palSocketAddress_t* to, palSocketLength_t toLength, size_t* bytesSent);
 
+#if PAL_NET_DATAGRAM_BATCH_SUPPORT
+
+/*! \brief Receive several payloads from a socket.
+ * @param[in] socket The socket to receive from. The socket passed to this function should be of type `PAL_SOCK_DGRAM`.
+ * @param[in, out] datagrams The datagrams to fill, one payload per datagram. `address` is optional, pass NULL when not used.
+ * @param[in] count The number of datagrams in `datagrams`, at least 1.
+ * @param[out] received The number of datagrams filled.
+ * \return PAL_SUCCESS (0) if at least one datagram was received. A specific negative error code in case of failure.
+ */
+palStatus_t pal_plat_receiveFromBatch(palSocket_t socket, palDatagram_t* datagrams, uint32_t count, uint32_t* received);
+
+/*! \brief Send several payloads using a specific socket.
+ * @param[in] socket The socket to use for sending the payloads. The socket passed to this function should be of type `PAL_SOCK_DGRAM`.
+ * @param[in, out] datagrams The datagrams to send, in order.
+ * @param[in] count The number of datagrams in `datagrams`, at least 1.
+ * @param[out] sent The number of datagrams sent.
+ * \return PAL_SUCCESS (0) if at least one datagram was sent. A specific negative error code in case of failure.
+ */
+palStatus_t pal_plat_sendToBatch(palSocket_t socket, palDatagram_t* datagrams, uint32_t count, uint32_t* sent);
+
+#endif // PAL_NET_DATAGRAM_BATCH_SUPPORT
+
 /*! \brief Close a network socket.
  * \note The function recieves `palSocket_t*` and not `palSocket_t` so that it can zero the socket to avoid re-use.
  * @param[in,out] socket Pointer to the socket to release and zero.
@@ -99,6 +99,16 @@ palStatus_t pal_plat_osThreadCreate(palThreadFuncPtr function, void* funcArgumen
  */
 palStatus_t pal_plat_osThreadTerminate(palThreadID_t* threadID);
 
+/*! \brief Get the runtime statistics of a PAL thread.
+ *
+ * @param[in] threadID The thread ID of a running thread.
+ * @param[out] stats The statistics of the thread, cleared by the caller.
+ *
+ * \return PAL_SUCCESS(0) in case of success. PAL_ERR_NOT_SUPPORTED if the port has no thread statistics.
+ *
+ */
+palStatus_t pal_plat_osThreadStatsGet(palThreadID_t threadID, palThreadStats_t* stats);
+
 /*! \brief Get the ID of the current thread.
  * \return The ID of the current thread. In case of error, returns PAL_MAX_UINT32.
  */
@@ -34,6 +34,50 @@ PAL_PRIVATE palStatus_t pal_plat_setWeakTimeBackward(uint64_t setNewTimeInSecond
 
 static uint64_t g_palDeviceBootTimeInSec = 0;
 
+// Values of the saved time and last time back items as they are in storage. The time is
+// updated after every handshake, so reading them from storage each time would put storage
+// access on the handshake path. Set by pal_plat_initTime() and kept up to date by the writes.
+static uint64_t g_palSavedTime = 0;
+static uint64_t g_palLastTimeBack = 0;
+static bool g_palStoredTimeCached = false;
+
+PAL_PRIVATE palStatus_t pal_plat_readStoredTime(const char *itemName, uint64_t *cached, uint64_t *value)
+{
+    size_t actualLenBytes = 0;
+
+    if (g_palStoredTimeCached)
+    {
+        *value = *cached;
+        return PAL_SUCCESS;
+    }
+    return storage_rbp_read(itemName, (uint8_t *)value, sizeof(uint64_t), &actualLenBytes);
+}
+
+PAL_PRIVATE palStatus_t pal_plat_writeStoredTime(const char *itemName, uint64_t *cached, uint64_t value)
+{
+    palStatus_t status;
+
+    if (g_palStoredTimeCached && (*cached == value))
+    {// Already in storage, do not wear the flash
+        return PAL_SUCCESS;
+    }
+    status = storage_rbp_write(itemName, (uint8_t *)&value, sizeof(uint64_t), false);
+    if (PAL_SUCCESS == status)
+    {
+        *cached = value;
+    }
+    else
+    {// Storage content is not known, read it again the next time
+        g_palStoredTimeCached = false;
+    }
+    return status;
+}
+
+#define pal_plat_readSavedTime(value) pal_plat_readStoredTime(STORAGE_RBP_SAVED_TIME_NAME, &g_palSavedTime, value)
+#define pal_plat_readLastTimeBack(value) pal_plat_readStoredTime(STORAGE_RBP_LAST_TIME_BACK_NAME, &g_palLastTimeBack, value)
+#define pal_plat_writeSavedTime(value) pal_plat_writeStoredTime(STORAGE_RBP_SAVED_TIME_NAME, &g_palSavedTime, value)
+#define pal_plat_writeLastTimeBack(value) pal_plat_writeStoredTime(STORAGE_RBP_LAST_TIME_BACK_NAME, &g_palLastTimeBack, value)
+
 palStatus_t pal_plat_initTime(void)
 {
     uint64_t rtcTime = 0;
@@ -41,7 +85,10 @@ palStatus_t pal_plat_initTime(void)
     palStatus_t  ret = PAL_SUCCESS;
     palStatus_t pal_status = PAL_SUCCESS;
     size_t actualLenBytes = 0;
+    uint64_t savedTime = 0;
+    bool storedTimeKnown = true;
 
+    g_palStoredTimeCached = false;
     ret = storage_rbp_read(STORAGE_RBP_SAVED_TIME_NAME, (uint8_t *)&getTime, sizeof(uint64_t), &actualLenBytes);
     //In case the weak time corrupted (could be due to power failure) :
     // 1. Set 0 getTime 
@@ -53,7 +100,9 @@ palStatus_t pal_plat_initTime(void)
         //Rewrite weak time to avoid error in pal_plat_osSetStrongTime
         ret = storage_rbp_write(STORAGE_RBP_SAVED_TIME_NAME, (uint8_t *)&getTime, sizeof(uint64_t), false);
         pal_status = ret;
+        storedTimeKnown = (PAL_SUCCESS == ret);
     }
+    savedTime = getTime;
 
     ret = storage_rbp_read(STORAGE_RBP_LAST_TIME_BACK_NAME, (uint8_t *)&lastTimeBack, sizeof(uint64_t),&actualLenBytes);
     //Strong time : avoid error, reset device time and continue
@@ -70,6 +119,7 @@ palStatus_t pal_plat_initTime(void)
         //Rewrite strong time to avoid error in pal_plat_osSetWeak functions
         ret = storage_rbp_write(STORAGE_RBP_LAST_TIME_BACK_NAME, (uint8_t *)&lastTimeBack, sizeof(uint64_t), false);
         pal_status = ret;
+        storedTimeKnown = storedTimeKnown && (PAL_SUCCESS == ret);
         getTime = 0; //to avoid setting of the value to device time with  pal_status = pal_osSetTime(PAL_MAX(rtcTime, getTime))
     }
 
@@ -79,10 +129,17 @@ palStatus_t pal_plat_initTime(void)
         if (PAL_SUCCESS != ret)
         {
             pal_status = ret;
+            storedTimeKnown = false;
         }
         getTime = lastTimeBack;
+        savedTime = lastTimeBack;
     }
 
+    // From now on the items are read from RAM
+    g_palSavedTime = savedTime;
+    g_palLastTimeBack = lastTimeBack;
+    g_palStoredTimeCached = storedTimeKnown;
+
 #if (PAL_USE_HW_RTC)
     if (PAL_SUCCESS == pal_status)
     {
@@ -144,7 +201,6 @@ palStatus_t pal_plat_osSetStrongTime(uint64_t setNewTimeInSeconds)
     palStatus_t pal_status = PAL_SUCCESS;
 
     uint64_t getTimeValue = 0;
-    size_t actualLenBytes = 0;
 
 #if (PAL_USE_HW_RTC)
     //RTC Time Latency
@@ -162,7 +218,7 @@ palStatus_t pal_plat_osSetStrongTime(uint64_t setNewTimeInSeconds)
     }
 #endif
 
-    ret = storage_rbp_read(STORAGE_RBP_SAVED_TIME_NAME, (uint8_t *)&getTimeValue, sizeof(uint64_t), &actualLenBytes);
+    ret = pal_plat_readSavedTime(&getTimeValue);
     if ((PAL_SUCCESS != ret) && (PAL_ERR_ITEM_NOT_EXIST != ret))
     {
         pal_status =  ret;
@@ -171,14 +227,14 @@ palStatus_t pal_plat_osSetStrongTime(uint64_t setNewTimeInSeconds)
     else if (((setNewTimeInSeconds > getTimeValue) && (setNewTimeInSeconds - getTimeValue > PAL_MINIMUM_FORWARD_LATENCY_SEC)) //Forward Time
             || ((setNewTimeInSeconds < getTimeValue) && (getTimeValue - setNewTimeInSeconds > PAL_MINIMUM_BACKWARD_LATENCY_SEC))) //Backward Time
     {
-        ret = storage_rbp_write(STORAGE_RBP_LAST_TIME_BACK_NAME,  (uint8_t *)&setNewTimeInSeconds, sizeof(uint64_t), false);
+        ret = pal_plat_writeLastTimeBack(setNewTimeInSeconds);
         if (PAL_SUCCESS != ret)
         {
             pal_status = ret;
         }
         else
         {
-            pal_status = storage_rbp_write(STORAGE_RBP_SAVED_TIME_NAME, (uint8_t *)&setNewTimeInSeconds, sizeof(uint64_t), false);            
+            pal_status = pal_plat_writeSavedTime(setNewTimeInSeconds);
         }
     }
 
@@ -213,7 +269,7 @@ PAL_PRIVATE palStatus_t pal_plat_setWeakTimeForward(uint64_t setNewTimeInSeconds
 
     if ((setNewTimeInSeconds - currentOsTime > PAL_MINIMUM_FORWARD_LATENCY_SEC) && (PAL_SUCCESS == ret))
     {  //time forward
-        ret = storage_rbp_write(STORAGE_RBP_SAVED_TIME_NAME, (uint8_t *)&setNewTimeInSeconds, sizeof(uint64_t), false);
+        ret = pal_plat_writeSavedTime(setNewTimeInSeconds);
     }
     
     return ret;
@@ -222,11 +278,10 @@ PAL_PRIVATE palStatus_t pal_plat_setWeakTimeForward(uint64_t setNewTimeInSeconds
 PAL_PRIVATE palStatus_t pal_plat_setWeakTimeBackward(uint64_t setNewTimeInSeconds, uint64_t currentOsTime)
 {
     uint64_t getTimeValue = 0;
-    size_t actualLenBytes = 0;
     palStatus_t ret = PAL_SUCCESS;
     palStatus_t pal_status = PAL_SUCCESS;
 
-    ret = storage_rbp_read(STORAGE_RBP_LAST_TIME_BACK_NAME, (uint8_t *)&getTimeValue, sizeof(uint64_t), &actualLenBytes);
+    ret = pal_plat_readLastTimeBack(&getTimeValue);
     if ((PAL_SUCCESS != ret) && (PAL_ERR_ITEM_NOT_EXIST != ret))
     {
         pal_status = ret;
@@ -236,14 +291,14 @@ PAL_PRIVATE palStatus_t pal_plat_setWeakTimeBackward(uint64_t setNewTimeInSecond
     {
         if ((setNewTimeInSeconds - getTimeValue) / PAL_RATIO_SECONDS_PER_DAY  > (currentOsTime - setNewTimeInSeconds))
         {
-            ret = storage_rbp_write(STORAGE_RBP_LAST_TIME_BACK_NAME, (uint8_t *)&setNewTimeInSeconds, sizeof(uint64_t), false);
+            ret = pal_plat_writeLastTimeBack(setNewTimeInSeconds);
             if (PAL_SUCCESS != ret)
             {
                 pal_status = ret;
             }
             else
             {
-                ret = storage_rbp_write(STORAGE_RBP_SAVED_TIME_NAME, (uint8_t *)&setNewTimeInSeconds, sizeof(uint64_t), false);
+                ret = pal_plat_writeSavedTime(setNewTimeInSeconds);
                 if (PAL_SUCCESS == ret)
                 {
                     pal_status = pal_osSetTime(setNewTimeInSeconds); //Save new time to RAM
@@ -258,7 +313,6 @@ PAL_PRIVATE palStatus_t pal_plat_setWeakTimeBackward(uint64_t setNewTimeInSecond
 palStatus_t pal_plat_osSetWeakTime(uint64_t setNewTimeInSeconds)
 {
     uint64_t getTimeValue = 0;
-    size_t actualLenBytes = 0;
     palStatus_t ret = PAL_SUCCESS;
     palStatus_t pal_status = PAL_SUCCESS;
     uint64_t getOsTimeValue = 0;
@@ -277,14 +331,14 @@ palStatus_t pal_plat_osSetWeakTime(uint64_t setNewTimeInSeconds)
     if(PAL_SUCCESS == ret)
     {
         getTimeValue = 0;
-        ret = storage_rbp_read(STORAGE_RBP_SAVED_TIME_NAME, (uint8_t *)&getTimeValue, sizeof(uint64_t), &actualLenBytes);
+        ret = pal_plat_readSavedTime(&getTimeValue);
         if ((PAL_SUCCESS != ret) && (PAL_ERR_ITEM_NOT_EXIST != ret))
         {
             pal_status = ret;
         }
         else if ((setNewTimeInSeconds > getTimeValue) && (setNewTimeInSeconds - getTimeValue > PAL_MINIMUM_STORAGE_LATENCY_SEC))
         {
-            pal_status = storage_rbp_write(STORAGE_RBP_SAVED_TIME_NAME, (uint8_t *)&setNewTimeInSeconds, sizeof(uint64_t), false);
+            pal_status = pal_plat_writeSavedTime(setNewTimeInSeconds);
         }
     }
     
@@ -23,6 +23,14 @@
 #ifdef PAL_USE_STATIC_MEMBUF_FOR_MBEDTLS
 #include "mbedtls/memory_buffer_alloc.h"
 #endif
+#if (PAL_USE_TLS_CREDENTIAL_CACHE == 1) && (PAL_ENABLE_X509 == 1)
+#include "mbedtls/platform.h"
+#include "mbedtls/sha256.h"
+#endif
+#if (PAL_USE_TLS_VERIFIED_CHAIN_CACHE == 1) && (PAL_ENABLE_X509 == 1)
+#include "mbedtls/sha256.h"
+#include "mbedtls/oid.h"
+#endif
 #ifdef MBED_CONF_MBED_CLOUD_CLIENT_PSA_SUPPORT
 #include "crypto.h"
 #include "stdio.h"
@@ -72,6 +80,30 @@ unsigned char mbedtls_buf[PAL_STATIC_MEMBUF_SIZE_FOR_MBEDTLS];
 #endif // #ifdef PAL_STATIC_MEMBUF_SECTION_NAME
 #endif // #if PAL_USE_STATIC_MEMBUF_FOR_MBEDTLS
 
+#if (PAL_USE_TLS_HEAP_STATS == 1)
+#if defined(PAL_USE_STATIC_MEMBUF_FOR_MBEDTLS)
+#if !defined(MBEDTLS_MEMORY_DEBUG)
+    #error "Using PAL_USE_TLS_HEAP_STATS with PAL_USE_STATIC_MEMBUF_FOR_MBEDTLS requires also using MBEDTLS_MEMORY_DEBUG"
+#endif
+#else
+#if !defined(MBEDTLS_PLATFORM_MEMORY) || defined(MBEDTLS_PLATFORM_CALLOC_MACRO)
+    #error "Using PAL_USE_TLS_HEAP_STATS requires also using MBEDTLS_PLATFORM_MEMORY without MBEDTLS_PLATFORM_CALLOC_MACRO"
+#endif
+#include "mbedtls/platform.h"
+
+// Kept in front of each mbedTLS allocation, so that the size is known when it is freed
+typedef union palTLSHeapHeader {
+    size_t size;
+    void* alignPointer;
+    uint64_t alignInteger;
+    double alignFloat;
+} palTLSHeapHeader_t;
+
+PAL_PRIVATE int32_t g_tlsHeapCurrent = 0;
+PAL_PRIVATE int32_t g_tlsHeapPeak = 0;
+#endif // PAL_USE_STATIC_MEMBUF_FOR_MBEDTLS
+#endif // PAL_USE_TLS_HEAP_STATS
+
 typedef mbedtls_ssl_context platTlsContext;
 typedef mbedtls_ssl_config platTlsConfigurationContext;
 
@@ -97,6 +129,16 @@ typedef mbedtls_ssl_config platTlsConfigurationContext;
 static const int ssl_session_size = 92;
 unsigned char ssl_session_context[SSL_SESSION_STORE_SIZE] = {0};
 uint16_t ssl_session_context_length = 0;
+
+#if (PAL_USE_SSL_SESSION_TICKETS == 1)
+#if !defined(MBEDTLS_SSL_SESSION_TICKETS) || !defined(MBEDTLS_SSL_CLI_C)
+#error "MBEDTLS_SSL_SESSION_TICKETS and MBEDTLS_SSL_CLI_C must be defined with PAL_USE_SSL_SESSION_TICKETS"
+#endif
+
+// Session of the last full handshake which got a ticket from the server
+PAL_PRIVATE mbedtls_ssl_session g_ticketSession;
+PAL_PRIVATE bool g_ticketSessionValid = false;
+#endif // PAL_USE_SSL_SESSION_TICKETS
 #endif
 
 PAL_PRIVATE mbedtls_entropy_context *g_entropy = NULL;
@@ -125,6 +167,13 @@ typedef struct palTLS {
     char* psk; //NULL terminated
     char* identity; //NULL terminated
     bool wantReadOrWrite;
+    unsigned char* coalesceBuffer; // records waiting to be sent in one datagram, NULL when not coalescing
+    size_t coalesceSize;
+    size_t coalesceLength;
+    palTLSSocket_t* coalesceSocket; // the BIO context replaced while coalescing
+#if (PAL_USE_TLS_VERIFIED_CHAIN_CACHE == 1) && (PAL_ENABLE_X509 == 1)
+    bool trustsVerifiedChain; // path validation is skipped in the ongoing handshake
+#endif
 }palTLS_t;
 
 
@@ -148,8 +197,49 @@ typedef struct palTLSConf {
     bool hasKeyHandle;
     psa_key_handle_t key_handle;
 #endif
+#if (PAL_USE_TLS_CREDENTIAL_CACHE == 1) && (PAL_ENABLE_X509 == 1)
+    bool usesCredentialCache; // credentials are in g_credentialCache instead of the fields above
+    uint8_t cachedCACerts; // number of certificates given to pal_plat_setCAChain() so far
+    uint8_t cachedOwnCerts; // number of certificates given to pal_plat_setOwnCertChain() so far
+#endif
 }palTLSConf_t;
 
+#if (PAL_USE_TLS_CREDENTIAL_CACHE == 1) && (PAL_ENABLE_X509 == 1)
+/** Parsed credentials kept alive across TLS configurations. One configuration at a time
+    borrows the cache, others parse their own copies. Certificates are matched against
+    the DER they were parsed from, the private key against a hash of its DER. */
+typedef struct palTLSCredentialCache {
+    mbedtls_x509_crt cacert;
+    mbedtls_x509_crt owncert;
+#ifndef MBED_CONF_MBED_CLOUD_CLIENT_PSA_SUPPORT
+    mbedtls_pk_context pkey;
+    unsigned char keyHash[32];
+    bool hasKey;
+#endif
+    palTLSConf_t* user;
+} palTLSCredentialCache_t;
+
+// Zero initialized state equals what mbedtls_x509_crt_init() and mbedtls_pk_init() set
+PAL_PRIVATE palTLSCredentialCache_t g_credentialCache;
+
+PAL_PRIVATE void pal_plat_truncateCertChain(mbedtls_x509_crt* chain, uint8_t length);
+PAL_PRIVATE int32_t pal_plat_cacheCert(mbedtls_x509_crt* chain, uint8_t index, const unsigned char* der, size_t derLen);
+#endif // PAL_USE_TLS_CREDENTIAL_CACHE
+
+#if (PAL_USE_TLS_VERIFIED_CHAIN_CACHE == 1) && (PAL_ENABLE_X509 == 1)
+/** The server certificate chain which last passed full path validation. */
+typedef struct palTLSVerifiedChain {
+    unsigned char chainHash[32]; // over the DER of every certificate the server sent
+    unsigned char caHash[32]; // over the DER of the trusted CA chain used for the validation
+    bool valid;
+} palTLSVerifiedChain_t;
+
+PAL_PRIVATE palTLSVerifiedChain_t g_verifiedChain;
+
+PAL_PRIVATE void pal_plat_verifiedChainStart(palTLS_t* localTLSCtx);
+PAL_PRIVATE int32_t pal_plat_verifiedChainFinish(palTLS_t* localTLSCtx, bool succeeded);
+#endif // PAL_USE_TLS_VERIFIED_CHAIN_CACHE
+
 PAL_PRIVATE palStatus_t translateTLSErrToPALError(int32_t error)
 {
     palStatus_t status;
@@ -280,6 +370,11 @@ PAL_PRIVATE palStatus_t translateTLSHandShakeErrToPALError(palTLS_t* tlsCtx, int
 PAL_PRIVATE int palBIORecv_timeout(palTLSSocketHandle_t socket, unsigned char *buf, size_t len, uint32_t timeout);
 PAL_PRIVATE int palBIORecv(palTLSSocketHandle_t socket, unsigned char *buf, size_t len);
 PAL_PRIVATE int palBIOSend(palTLSSocketHandle_t socket, const unsigned char *buf, size_t len);
+PAL_PRIVATE int palBIOSendCoalesced(palTLSSocketHandle_t socket, const unsigned char *buf, size_t len);
+#if (PAL_USE_TLS_HEAP_STATS == 1) && !defined(PAL_USE_STATIC_MEMBUF_FOR_MBEDTLS)
+PAL_PRIVATE void* palTLSHeapCalloc(size_t count, size_t size);
+PAL_PRIVATE void palTLSHeapFree(void* ptr);
+#endif
 PAL_PRIVATE void palDebug(void *ctx, int debugLevel, const char *fileName, int line, const char *message);
 int pal_plat_entropySourceTLS( void *data, unsigned char *output, size_t len, size_t *olen );
 PAL_PRIVATE int palTimingGetDelay( void *data );
@@ -309,6 +404,9 @@ palStatus_t pal_plat_initTLSLibrary(void)
 
 #if defined(PAL_USE_STATIC_MEMBUF_FOR_MBEDTLS)
     mbedtls_memory_buffer_alloc_init(mbedtls_buf, sizeof(mbedtls_buf));
+#elif (PAL_USE_TLS_HEAP_STATS == 1)
+    // Left in place on cleanup, as memory allocated through these must also be freed through them
+    mbedtls_platform_set_calloc_free(palTLSHeapCalloc, palTLSHeapFree);
 #endif
 
 #if PAL_USE_SECURE_TIME
@@ -346,6 +444,19 @@ palStatus_t pal_plat_cleanupTLS(void)
     free(g_entropy);
     g_entropy = NULL;
 
+#if (PAL_USE_TLS_CREDENTIAL_CACHE == 1) && (PAL_ENABLE_X509 == 1)
+    mbedtls_x509_crt_free(&g_credentialCache.cacert);
+    mbedtls_x509_crt_free(&g_credentialCache.owncert);
+#ifndef MBED_CONF_MBED_CLOUD_CLIENT_PSA_SUPPORT
+    mbedtls_pk_free(&g_credentialCache.pkey);
+#endif
+    memset(&g_credentialCache, 0, sizeof(g_credentialCache));
+#endif
+
+#if (PAL_USE_SSL_SESSION_TICKETS == 1)
+    pal_plat_removeSslTicketSession();
+#endif
+
 #if defined(PAL_USE_STATIC_MEMBUF_FOR_MBEDTLS)
     mbedtls_memory_buffer_alloc_free();
 #endif
@@ -441,6 +552,17 @@ palStatus_t pal_plat_initTLSConf(palTLSConfHandle_t* palConfCtx, palTLSTransport
     mbedtls_x509_crt_init(&localConfigCtx->owncert);
     mbedtls_x509_crt_init(&localConfigCtx->cacert);
 #endif
+    mbedtls_pk_init(&localConfigCtx->pkey);
+
+#if (PAL_USE_TLS_CREDENTIAL_CACHE == 1) && (PAL_ENABLE_X509 == 1)
+    localConfigCtx->cachedCACerts = 0;
+    localConfigCtx->cachedOwnCerts = 0;
+    localConfigCtx->usesCredentialCache = (NULL == g_credentialCache.user);
+    if (localConfigCtx->usesCredentialCache)
+    {
+        g_credentialCache.user = localConfigCtx;
+    }
+#endif
 
     if (PAL_TLS_IS_CLIENT == methodType)
     {
@@ -485,6 +607,12 @@ palStatus_t pal_plat_initTLSConf(palTLSConfHandle_t* palConfCtx, palTLSTransport
     }
 
     mbedtls_ssl_conf_rng(localConfigCtx->confCtx, mbedtls_ctr_drbg_random, &localConfigCtx->ctrDrbg);
+#if (PAL_USE_SSL_SESSION_TICKETS == 1)
+    if (MBEDTLS_SSL_IS_CLIENT == endpoint)
+    {
+        mbedtls_ssl_conf_session_tickets(localConfigCtx->confCtx, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+    }
+#endif
     *palConfCtx = (uintptr_t)localConfigCtx;
 
 finish:
@@ -494,6 +622,12 @@ finish:
         {
             free(localConfigCtx->confCtx);
         }
+#if (PAL_USE_TLS_CREDENTIAL_CACHE == 1) && (PAL_ENABLE_X509 == 1)
+        if (g_credentialCache.user == localConfigCtx)
+        {
+            g_credentialCache.user = NULL;
+        }
+#endif
         free(localConfigCtx);
         *palConfCtx = NULLPTR;
     }
@@ -537,6 +671,14 @@ palStatus_t pal_plat_tlsConfigurationFree(palTLSConfHandle_t* palTLSConf)
 #endif
     }
 
+#if (PAL_USE_TLS_CREDENTIAL_CACHE == 1) && (PAL_ENABLE_X509 == 1)
+    // Cached credentials stay parsed for the next configuration
+    if (localConfigCtx->usesCredentialCache)
+    {
+        g_credentialCache.user = NULL;
+    }
+#endif
+
     mbedtls_ssl_config_free(localConfigCtx->confCtx);
     mbedtls_ctr_drbg_free(&localConfigCtx->ctrDrbg);
 
@@ -608,6 +750,7 @@ palStatus_t pal_plat_freeTLS(palTLSHandle_t* palTLSHandle)
 
 
     mbedtls_ssl_free(&localTLSCtx->tlsCtx);
+    free(localTLSCtx->coalesceBuffer);
     free(localTLSCtx);
     *palTLSHandle = NULLPTR;
 
@@ -758,6 +901,58 @@ palStatus_t pal_plat_sslRead(palTLSHandle_t palTLSHandle, void *buffer, uint32_t
 }
 
 
+palStatus_t pal_plat_sslReadInPlace(palTLSHandle_t palTLSHandle, const uint8_t **data, uint32_t* actualLen)
+{
+    palStatus_t status = PAL_SUCCESS;
+    int32_t platStatus = SSL_LIB_SUCCESS;
+    palTLS_t* localTLSCtx = (palTLS_t*)palTLSHandle;
+    unsigned char unused;
+
+    // A zero length read processes the next record but leaves its data in the input buffer
+    platStatus = mbedtls_ssl_read(&localTLSCtx->tlsCtx, &unused, 0);
+    if (platStatus == SSL_LIB_SUCCESS && NULL != localTLSCtx->tlsCtx.in_offt && localTLSCtx->tlsCtx.in_msglen > 0)
+    {
+        *data = localTLSCtx->tlsCtx.in_offt;
+        *actualLen = (uint32_t)localTLSCtx->tlsCtx.in_msglen;
+    }
+    else if (platStatus >= SSL_LIB_SUCCESS)
+    {
+        status = PAL_ERR_TLS_WANT_READ;
+    }
+    else
+    {
+        status = translateTLSErrToPALError(platStatus);
+        if (platStatus != MBEDTLS_ERR_SSL_WANT_READ && platStatus != MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY)
+        {
+            PAL_LOG_ERR("SSL Read return code -0x%" PRIx32 ".", -platStatus);
+        }
+        else
+        {
+            PAL_LOG_DBG("SSL Read return code -0x%" PRIx32 ".", -platStatus);
+        }
+    }
+
+    return status;
+}
+
+palStatus_t pal_plat_sslReadInPlaceDone(palTLSHandle_t palTLSHandle)
+{
+    palTLS_t* localTLSCtx = (palTLS_t*)palTLSHandle;
+    mbedtls_ssl_context* ssl = &localTLSCtx->tlsCtx;
+
+    // Same as mbedtls_ssl_read() does when all of the record has been read
+    if (NULL != ssl->in_offt)
+    {
+        memset(ssl->in_offt, 0, ssl->in_msglen);
+        ssl->in_msglen = 0;
+        ssl->in_offt = NULL;
+        ssl->keep_current_message = 0;
+    }
+
+    return PAL_SUCCESS;
+}
+
+
 palStatus_t pal_plat_sslWrite(palTLSHandle_t palTLSHandle, const void *buffer, uint32_t len, uint32_t *bytesWritten)
 {
     palStatus_t status = PAL_SUCCESS;
@@ -787,6 +982,82 @@ palStatus_t pal_plat_sslWrite(palTLSHandle_t palTLSHandle, const void *buffer, u
 }
 
 
+palStatus_t pal_plat_sslBeginCoalescing(palTLSHandle_t palTLSHandle, uint32_t datagramSize)
+{
+    palTLS_t* localTLSCtx = (palTLS_t*)palTLSHandle;
+    palTLSSocket_t* localSocket = (palTLSSocket_t*)localTLSCtx->tlsCtx.p_bio;
+
+    if (NULL != localTLSCtx->coalesceBuffer)
+    {
+        return PAL_SUCCESS;
+    }
+
+    // TLS records could be split between sends, which a stream cannot undo
+    if (NULL == localSocket || PAL_DTLS_MODE != localSocket->transportationMode)
+    {
+        return PAL_ERR_NOT_SUPPORTED;
+    }
+
+    localTLSCtx->coalesceBuffer = (unsigned char*)malloc(datagramSize);
+    if (NULL == localTLSCtx->coalesceBuffer)
+    {
+        return PAL_ERR_NO_MEMORY;
+    }
+    localTLSCtx->coalesceSize = datagramSize;
+    localTLSCtx->coalesceLength = 0;
+    localTLSCtx->coalesceSocket = localSocket;
+
+    mbedtls_ssl_set_bio(&localTLSCtx->tlsCtx, localTLSCtx, palBIOSendCoalesced,
+                        localTLSCtx->tlsCtx.f_recv, localTLSCtx->tlsCtx.f_recv_timeout);
+    return PAL_SUCCESS;
+}
+
+PAL_PRIVATE int palCoalescedFlush(palTLS_t* localTLSCtx)
+{
+    int platStatus = SSL_LIB_SUCCESS;
+
+    if (0 != localTLSCtx->coalesceLength)
+    {
+        platStatus = palBIOSend(localTLSCtx->coalesceSocket, localTLSCtx->coalesceBuffer, localTLSCtx->coalesceLength);
+        if (MBEDTLS_ERR_SSL_WANT_WRITE == platStatus || PAL_ERR_NO_MEMORY == platStatus)
+        {
+            // mbedTLS already counts these records as sent, they are lost like any dropped datagram
+            PAL_LOG_DBG("Dropped %" PRIu32 " bytes of coalesced records", (uint32_t)localTLSCtx->coalesceLength);
+            platStatus = SSL_LIB_SUCCESS;
+        }
+        localTLSCtx->coalesceLength = 0;
+    }
+
+    return (platStatus < 0) ? platStatus : SSL_LIB_SUCCESS;
+}
+
+palStatus_t pal_plat_sslEndCoalescing(palTLSHandle_t palTLSHandle)
+{
+    palStatus_t status = PAL_SUCCESS;
+    int32_t platStatus = SSL_LIB_SUCCESS;
+    palTLS_t* localTLSCtx = (palTLS_t*)palTLSHandle;
+
+    if (NULL == localTLSCtx->coalesceBuffer)
+    {
+        return PAL_SUCCESS;
+    }
+
+    mbedtls_ssl_set_bio(&localTLSCtx->tlsCtx, localTLSCtx->coalesceSocket, palBIOSend,
+                        localTLSCtx->tlsCtx.f_recv, localTLSCtx->tlsCtx.f_recv_timeout);
+
+    platStatus = palCoalescedFlush(localTLSCtx);
+    if (SSL_LIB_SUCCESS != platStatus)
+    {
+        PAL_LOG_ERR("Sending coalesced records failed -0x%" PRIx32 ".", -platStatus);
+        status = translateTLSErrToPALError(platStatus);
+    }
+
+    free(localTLSCtx->coalesceBuffer);
+    localTLSCtx->coalesceBuffer = NULL;
+    return status;
+}
+
+
 palStatus_t pal_plat_setHandShakeTimeOut(palTLSConfHandle_t palTLSConf, uint32_t minTimeout, uint32_t maxTimeout)
 {
     PAL_LOG_DBG("DTLS min timeout %d max timeout %d", minTimeout, maxTimeout);
@@ -806,6 +1077,21 @@ palStatus_t pal_plat_sslSetup(palTLSHandle_t palTLSHandle, palTLSConfHandle_t pa
 
     if (!localTLSCtx->wantReadOrWrite)
     {
+#if (PAL_USE_TLS_CREDENTIAL_CACHE == 1) && (PAL_ENABLE_X509 == 1)
+        // All credentials are set by now, drop cached certificates beyond the ones this
+        // configuration gave so that a longer earlier chain is not trusted or sent.
+        if (localConfigCtx->usesCredentialCache)
+        {
+            if (localConfigCtx->cachedCACerts)
+            {
+                pal_plat_truncateCertChain(&g_credentialCache.cacert, localConfigCtx->cachedCACerts);
+            }
+            if (localConfigCtx->cachedOwnCerts)
+            {
+                pal_plat_truncateCertChain(&g_credentialCache.owncert, localConfigCtx->cachedOwnCerts);
+            }
+        }
+#endif
         platStatus = mbedtls_ssl_setup(&localTLSCtx->tlsCtx, localConfigCtx->confCtx);
         if (SSL_LIB_SUCCESS != platStatus)
         {
@@ -852,6 +1138,13 @@ palStatus_t pal_plat_handShake(palTLSHandle_t palTLSHandle, uint64_t* serverTime
     palTLS_t* localTLSCtx = (palTLS_t*)palTLSHandle;
     int32_t platStatus = SSL_LIB_SUCCESS;
 
+#if (PAL_USE_TLS_VERIFIED_CHAIN_CACHE == 1) && (PAL_ENABLE_X509 == 1)
+    if (MBEDTLS_SSL_HELLO_REQUEST == localTLSCtx->tlsCtx.state)
+    {
+        pal_plat_verifiedChainStart(localTLSCtx);
+    }
+#endif
+
     while( (MBEDTLS_SSL_HANDSHAKE_OVER != localTLSCtx->tlsCtx.state) && (PAL_SUCCESS == status) )
     {
         platStatus = mbedtls_ssl_handshake_step( &localTLSCtx->tlsCtx );
@@ -872,9 +1165,162 @@ palStatus_t pal_plat_handShake(palTLSHandle_t palTLSHandle, uint64_t* serverTime
         }
     }
 
+#if (PAL_USE_TLS_VERIFIED_CHAIN_CACHE == 1) && (PAL_ENABLE_X509 == 1)
+    // Other errors end the handshake, with these it continues on the next call
+    if (PAL_ERR_TLS_WANT_READ != status && PAL_ERR_TLS_WANT_WRITE != status)
+    {
+        platStatus = pal_plat_verifiedChainFinish(localTLSCtx, (PAL_SUCCESS == status));
+        if (SSL_LIB_SUCCESS != platStatus)
+        {
+            status = PAL_ERR_X509_CERT_VERIFY_FAILED;
+        }
+    }
+#endif
+
     return status;
 }
 
+#if (PAL_USE_TLS_VERIFIED_CHAIN_CACHE == 1) && (PAL_ENABLE_X509 == 1)
+PAL_PRIVATE int32_t pal_plat_hashCertChain(const mbedtls_x509_crt* chain, unsigned char hash[32])
+{
+    mbedtls_sha256_context sha;
+    int32_t platStatus;
+
+    mbedtls_sha256_init(&sha);
+    platStatus = mbedtls_sha256_starts_ret(&sha, 0);
+    for (; SSL_LIB_SUCCESS == platStatus && NULL != chain && NULL != chain->raw.p; chain = chain->next)
+    {
+        platStatus = mbedtls_sha256_update_ret(&sha, chain->raw.p, chain->raw.len);
+    }
+    if (SSL_LIB_SUCCESS == platStatus)
+    {
+        platStatus = mbedtls_sha256_finish_ret(&sha, hash);
+    }
+    mbedtls_sha256_free(&sha);
+    return platStatus;
+}
+
+PAL_PRIVATE void pal_plat_verifiedChainStart(palTLS_t* localTLSCtx)
+{
+    mbedtls_ssl_config* conf = (mbedtls_ssl_config*)localTLSCtx->tlsCtx.conf;
+    unsigned char caHash[32];
+
+    localTLSCtx->trustsVerifiedChain = false;
+
+    // Only a required validation against plain CA certificates can be replaced, and only with a known time
+    if (!g_verifiedChain.valid || MBEDTLS_SSL_VERIFY_REQUIRED != conf->authmode || NULL == conf->ca_chain ||
+        NULL != conf->ca_crl || NULL != conf->f_vrfy || 0 == pal_osGetTime())
+    {
+        return;
+    }
+
+    if (SSL_LIB_SUCCESS != pal_plat_hashCertChain(conf->ca_chain, caHash) ||
+        0 != memcmp(caHash, g_verifiedChain.caHash, sizeof(caHash)))
+    {
+        return;
+    }
+
+    PAL_LOG_DBG("Skipping server chain validation, checked after the handshake");
+    mbedtls_ssl_conf_authmode(conf, MBEDTLS_SSL_VERIFY_NONE);
+    localTLSCtx->trustsVerifiedChain = true;
+}
+
+PAL_PRIVATE int32_t pal_plat_verifiedChainFinish(palTLS_t* localTLSCtx, bool succeeded)
+{
+    mbedtls_ssl_config* conf = (mbedtls_ssl_config*)localTLSCtx->tlsCtx.conf;
+    const mbedtls_x509_crt* peerChain;
+    const mbedtls_x509_crt* crt;
+    unsigned char chainHash[32];
+    unsigned char caHash[32];
+    bool validated = (MBEDTLS_SSL_VERIFY_REQUIRED == conf->authmode && NULL == conf->f_vrfy && NULL == conf->ca_crl);
+    int32_t platStatus = SSL_LIB_SUCCESS;
+
+    if (localTLSCtx->trustsVerifiedChain)
+    {
+        mbedtls_ssl_conf_authmode(conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+        localTLSCtx->trustsVerifiedChain = false;
+        validated = false;
+    }
+    else if (!validated)
+    {
+        // Not validated against the CA chain by mbedTLS, so not remembered either
+        return SSL_LIB_SUCCESS;
+    }
+
+    if (!succeeded)
+    {
+        return SSL_LIB_SUCCESS;
+    }
+
+    peerChain = mbedtls_ssl_get_peer_cert(&localTLSCtx->tlsCtx);
+    if (NULL == peerChain || NULL == conf->ca_chain)
+    {
+        platStatus = validated ? SSL_LIB_SUCCESS : MBEDTLS_ERR_X509_CERT_VERIFY_FAILED;
+        goto finish;
+    }
+
+    platStatus = pal_plat_hashCertChain(peerChain, chainHash);
+    if (SSL_LIB_SUCCESS == platStatus)
+    {
+        platStatus = pal_plat_hashCertChain(conf->ca_chain, caHash);
+    }
+    if (SSL_LIB_SUCCESS != platStatus)
+    {
+        platStatus = validated ? SSL_LIB_SUCCESS : platStatus;
+        goto finish;
+    }
+
+    if (!validated)
+    {
+        bool remembered = (g_verifiedChain.valid &&
+                           0 == memcmp(chainHash, g_verifiedChain.chainHash, sizeof(chainHash)) &&
+                           0 == memcmp(caHash, g_verifiedChain.caHash, sizeof(caHash)));
+        // The remembered chain was valid then, it still has to be valid now
+        for (crt = peerChain; remembered && NULL != crt && NULL != crt->raw.p; crt = crt->next)
+        {
+            if (mbedtls_x509_time_is_past(&crt->valid_to) || mbedtls_x509_time_is_future(&crt->valid_from))
+            {
+                remembered = false;
+            }
+        }
+
+        if (!remembered)
+        {
+            uint32_t flags = 0;
+            PAL_LOG_DBG("Server chain changed, validating it");
+            platStatus = mbedtls_x509_crt_verify_with_profile((mbedtls_x509_crt*)peerChain, conf->ca_chain, NULL,
+                                                              conf->cert_profile, localTLSCtx->tlsCtx.hostname,
+                                                              &flags, NULL, NULL);
+#if defined(MBEDTLS_X509_CHECK_EXTENDED_KEY_USAGE)
+            if (SSL_LIB_SUCCESS == platStatus)
+            {
+                platStatus = mbedtls_x509_crt_check_extended_key_usage(peerChain, MBEDTLS_OID_SERVER_AUTH,
+                                                                       MBEDTLS_OID_SIZE(MBEDTLS_OID_SERVER_AUTH));
+            }
+#endif
+            if (SSL_LIB_SUCCESS != platStatus)
+            {
+                PAL_LOG_ERR("Server chain validation failed -0x%" PRIx32 ", flags 0x%" PRIx32 ".", -platStatus, flags);
+                platStatus = MBEDTLS_ERR_X509_CERT_VERIFY_FAILED;
+                goto finish;
+            }
+        }
+    }
+
+    memcpy(g_verifiedChain.chainHash, chainHash, sizeof(chainHash));
+    memcpy(g_verifiedChain.caHash, caHash, sizeof(caHash));
+    g_verifiedChain.valid = true;
+    return SSL_LIB_SUCCESS;
+
+finish:
+    if (SSL_LIB_SUCCESS != platStatus)
+    {
+        g_verifiedChain.valid = false;
+    }
+    return platStatus;
+}
+#endif // PAL_USE_TLS_VERIFIED_CHAIN_CACHE
+
 #if PAL_USE_SECURE_TIME
 palStatus_t pal_plat_renegotiate(palTLSHandle_t palTLSHandle, uint64_t serverTime)
 {
@@ -943,6 +1389,39 @@ palStatus_t pal_plat_setOwnPrivateKey(palTLSConfHandle_t palTLSConf, palPrivateK
     localConfigCtx->hasKeyHandle = true;
 
 #else //MBED_CONF_MBED_CLOUD_CLIENT_PSA_SUPPORT
+#if (PAL_USE_TLS_CREDENTIAL_CACHE == 1)
+    if (localConfigCtx->usesCredentialCache)
+    {
+        unsigned char keyHash[sizeof(g_credentialCache.keyHash)];
+        platStatus = mbedtls_sha256_ret((const unsigned char *)privateKey->buffer, privateKey->size, keyHash, 0);
+        if (SSL_LIB_SUCCESS != platStatus)
+        {
+            status = PAL_ERR_TLS_FAILED_TO_PARSE_KEY;
+            goto finish;
+        }
+
+        if (!g_credentialCache.hasKey || 0 != memcmp(keyHash, g_credentialCache.keyHash, sizeof(keyHash)))
+        {
+            mbedtls_pk_free(&g_credentialCache.pkey);
+            mbedtls_pk_init(&g_credentialCache.pkey);
+            g_credentialCache.hasKey = false;
+
+            platStatus = mbedtls_pk_parse_key(&g_credentialCache.pkey, (const unsigned char *)privateKey->buffer, privateKey->size, NULL, 0);
+            if (SSL_LIB_SUCCESS != platStatus)
+            {
+                status = PAL_ERR_TLS_FAILED_TO_PARSE_KEY;
+                goto finish;
+            }
+            memcpy(g_credentialCache.keyHash, keyHash, sizeof(keyHash));
+            g_credentialCache.hasKey = true;
+        }
+        else
+        {
+            PAL_LOG_DBG("Using cached private key");
+        }
+        goto finish;
+    }
+#endif
      platStatus = mbedtls_pk_parse_key(&localConfigCtx->pkey, (const unsigned char *)privateKey->buffer, privateKey->size, NULL, 0);
      if (SSL_LIB_SUCCESS != platStatus)
      {
@@ -963,15 +1442,34 @@ palStatus_t pal_plat_setOwnCertChain(palTLSConfHandle_t palTLSConf, palX509_t* o
     palStatus_t status = PAL_SUCCESS;
     palTLSConf_t* localConfigCtx = (palTLSConf_t*)palTLSConf;
     int32_t platStatus = SSL_LIB_SUCCESS;
+    mbedtls_x509_crt* chain = &localConfigCtx->owncert;
+    mbedtls_pk_context* pkey = &localConfigCtx->pkey;
 
-    platStatus = mbedtls_x509_crt_parse_der(&localConfigCtx->owncert, (const unsigned char *)ownCert->buffer, ownCert->size);
+#if (PAL_USE_TLS_CREDENTIAL_CACHE == 1)
+    if (localConfigCtx->usesCredentialCache)
+    {
+        chain = &g_credentialCache.owncert;
+#ifndef MBED_CONF_MBED_CLOUD_CLIENT_PSA_SUPPORT
+        pkey = &g_credentialCache.pkey;
+#endif
+        platStatus = pal_plat_cacheCert(chain, localConfigCtx->cachedOwnCerts, (const unsigned char *)ownCert->buffer, ownCert->size);
+        if (SSL_LIB_SUCCESS == platStatus)
+        {
+            localConfigCtx->cachedOwnCerts++;
+        }
+    }
+    else
+#endif
+    {
+        platStatus = mbedtls_x509_crt_parse_der(chain, (const unsigned char *)ownCert->buffer, ownCert->size);
+    }
     if (SSL_LIB_SUCCESS != platStatus)
     {
         status = PAL_ERR_TLS_FAILED_TO_PARSE_CERT;
         goto finish;
     }
 
-    platStatus = mbedtls_ssl_conf_own_cert(localConfigCtx->confCtx, &localConfigCtx->owncert, &localConfigCtx->pkey);
+    platStatus = mbedtls_ssl_conf_own_cert(localConfigCtx->confCtx, chain, pkey);
     if (SSL_LIB_SUCCESS != platStatus)
     {
         status = PAL_ERR_TLS_FAILED_TO_SET_CERT;
@@ -990,20 +1488,83 @@ palStatus_t pal_plat_setCAChain(palTLSConfHandle_t palTLSConf, palX509_t* caChai
     palStatus_t status = PAL_SUCCESS;
     palTLSConf_t* localConfigCtx = (palTLSConf_t*)palTLSConf;
     int32_t platStatus = SSL_LIB_SUCCESS;
+    mbedtls_x509_crt* chain = &localConfigCtx->cacert;
 
-    platStatus = mbedtls_x509_crt_parse_der(&localConfigCtx->cacert, (const unsigned char *)caChain->buffer, caChain->size);
+#if (PAL_USE_TLS_CREDENTIAL_CACHE == 1)
+    if (localConfigCtx->usesCredentialCache)
+    {
+        chain = &g_credentialCache.cacert;
+        platStatus = pal_plat_cacheCert(chain, localConfigCtx->cachedCACerts, (const unsigned char *)caChain->buffer, caChain->size);
+        if (SSL_LIB_SUCCESS == platStatus)
+        {
+            localConfigCtx->cachedCACerts++;
+        }
+    }
+    else
+#endif
+    {
+        platStatus = mbedtls_x509_crt_parse_der(chain, (const unsigned char *)caChain->buffer, caChain->size);
+    }
     if (SSL_LIB_SUCCESS != platStatus)
     {
         PAL_LOG_ERR("TLS CA chain status %" PRId32 ".", platStatus);
         status = PAL_ERR_GENERIC_FAILURE;
         goto finish;
     }
-    mbedtls_ssl_conf_ca_chain(localConfigCtx->confCtx, &localConfigCtx->cacert, NULL );
+    mbedtls_ssl_conf_ca_chain(localConfigCtx->confCtx, chain, NULL );
 
     localConfigCtx->hasChain = true;
 finish:
     return status;
 }
+
+#if (PAL_USE_TLS_CREDENTIAL_CACHE == 1)
+PAL_PRIVATE void pal_plat_truncateCertChain(mbedtls_x509_crt* chain, uint8_t length)
+{
+    mbedtls_x509_crt* last = chain;
+
+    if (0 == length)
+    {
+        mbedtls_x509_crt_free(chain);
+        mbedtls_x509_crt_init(chain);
+        return;
+    }
+
+    while (--length && NULL != last->next)
+    {
+        last = last->next;
+    }
+
+    // mbedtls_x509_crt_free() releases every certificate after the given one, but only clears the given one
+    if (NULL != last->next)
+    {
+        mbedtls_x509_crt_free(last->next);
+        mbedtls_free(last->next);
+        last->next = NULL;
+    }
+}
+
+PAL_PRIVATE int32_t pal_plat_cacheCert(mbedtls_x509_crt* chain, uint8_t index, const unsigned char* der, size_t derLen)
+{
+    mbedtls_x509_crt* crt = chain;
+    uint8_t i;
+
+    for (i = 0; i < index && NULL != crt; i++)
+    {
+        crt = crt->next;
+    }
+
+    if (NULL != crt && NULL != crt->raw.p && crt->raw.len == derLen && 0 == memcmp(crt->raw.p, der, derLen))
+    {
+        PAL_LOG_DBG("Using cached certificate %" PRIu32, (uint32_t)index);
+        return SSL_LIB_SUCCESS;
+    }
+
+    // Certificates from the first different one on are parsed again
+    pal_plat_truncateCertChain(chain, index);
+    return mbedtls_x509_crt_parse_der(chain, der, derLen);
+}
+#endif // PAL_USE_TLS_CREDENTIAL_CACHE
 #endif
 
 #if (PAL_ENABLE_PSK == 1)
@@ -1081,6 +1642,67 @@ palStatus_t pal_plat_sslSetDebugging(palTLSConfHandle_t palTLSConf, uint8_t turn
     return  status;
 }
 
+#if (PAL_USE_TLS_HEAP_STATS == 1) && !defined(PAL_USE_STATIC_MEMBUF_FOR_MBEDTLS)
+PAL_PRIVATE void* palTLSHeapCalloc(size_t count, size_t size)
+{
+    palTLSHeapHeader_t* header;
+    size_t len;
+    int32_t current;
+
+    if ((0 != size) && (count > (SIZE_MAX - sizeof(palTLSHeapHeader_t)) / size))
+    {
+        return NULL;
+    }
+    len = count * size;
+
+    header = (palTLSHeapHeader_t*)calloc(1, sizeof(palTLSHeapHeader_t) + len);
+    if (NULL == header)
+    {
+        return NULL;
+    }
+    header->size = len;
+
+    current = pal_osAtomicIncrement(&g_tlsHeapCurrent, (int32_t)len);
+    // Not atomic with the increment, so two threads allocating at once may lower the peak by one allocation
+    if (current > g_tlsHeapPeak)
+    {
+        g_tlsHeapPeak = current;
+    }
+    return header + 1;
+}
+
+PAL_PRIVATE void palTLSHeapFree(void* ptr)
+{
+    if (NULL != ptr)
+    {
+        palTLSHeapHeader_t* header = (palTLSHeapHeader_t*)ptr - 1;
+        pal_osAtomicIncrement(&g_tlsHeapCurrent, -(int32_t)header->size);
+        free(header);
+    }
+}
+#endif
+
+palStatus_t pal_plat_sslGetHeapUsage(uint32_t* currentBytes, uint32_t* peakBytes)
+{
+#if (PAL_USE_TLS_HEAP_STATS == 1)
+#if defined(PAL_USE_STATIC_MEMBUF_FOR_MBEDTLS)
+    size_t currentUsed, currentBlocks, maxUsed, maxBlocks;
+    mbedtls_memory_buffer_alloc_cur_get(&currentUsed, &currentBlocks);
+    mbedtls_memory_buffer_alloc_max_get(&maxUsed, &maxBlocks);
+    *currentBytes = (uint32_t)currentUsed;
+    *peakBytes = (uint32_t)maxUsed;
+#else
+    *currentBytes = (uint32_t)g_tlsHeapCurrent;
+    *peakBytes = (uint32_t)g_tlsHeapPeak;
+#endif
+    return PAL_SUCCESS;
+#else
+    *currentBytes = 0;
+    *peakBytes = 0;
+    return PAL_ERR_NOT_SUPPORTED;
+#endif
+}
+
 palStatus_t pal_plat_SetLoggingCb(palTLSConfHandle_t palTLSConf, palLogFunc_f palLogFunction, void *logContext)
 {
     palTLSConf_t* localConfigCtx = (palTLSConf_t*)palTLSConf;
@@ -1238,6 +1860,31 @@ finish:
     return status;
 }
 
+PAL_PRIVATE int palBIOSendCoalesced(palTLSSocketHandle_t socket, const unsigned char *buf, size_t len)
+{
+    palTLS_t* localTLSCtx = (palTLS_t*)socket;
+    int platStatus = SSL_LIB_SUCCESS;
+
+    if (localTLSCtx->coalesceLength + len > localTLSCtx->coalesceSize)
+    {
+        platStatus = palCoalescedFlush(localTLSCtx);
+        if (SSL_LIB_SUCCESS != platStatus)
+        {
+            return platStatus;
+        }
+    }
+
+    // A record bigger than a datagram goes out on its own
+    if (len > localTLSCtx->coalesceSize)
+    {
+        return palBIOSend(localTLSCtx->coalesceSocket, buf, len);
+    }
+
+    memcpy(localTLSCtx->coalesceBuffer + localTLSCtx->coalesceLength, buf, len);
+    localTLSCtx->coalesceLength += len;
+    return (int)len;
+}
+
 PAL_PRIVATE int palBIORecv(palTLSSocketHandle_t socket, unsigned char *buf, size_t len)
 {
     palStatus_t status = PAL_SUCCESS;
@@ -1579,4 +2226,65 @@ void pal_plat_get_cid_value(palTLSHandle_t palTLSHandle, uint8_t *data_ptr, size
     }
 #endif
 }
+
+#if (PAL_USE_SSL_SESSION_TICKETS == 1)
+palStatus_t pal_plat_saveSslTicketSession(palTLSHandle_t palTLSHandle)
+{
+    palTLS_t* localTLSCtx = (palTLS_t*)palTLSHandle;
+
+    pal_plat_removeSslTicketSession();
+
+    int32_t platStatus = mbedtls_ssl_get_session(&localTLSCtx->tlsCtx, &g_ticketSession);
+    if (SSL_LIB_SUCCESS != platStatus)
+    {
+        PAL_LOG_ERR("pal_plat_saveSslTicketSession - failed to get ssl session -0x%" PRIx32 ".", -platStatus);
+        mbedtls_ssl_session_free(&g_ticketSession);
+        return translateTLSErrToPALError(platStatus);
+    }
+
+    // Resuming with the bare session id is already covered by the stored session
+    if (NULL == g_ticketSession.ticket || 0 == g_ticketSession.ticket_len)
+    {
+        PAL_LOG_DBG("pal_plat_saveSslTicketSession - no ticket from server");
+        mbedtls_ssl_session_free(&g_ticketSession);
+        return PAL_ERR_GENERIC_FAILURE;
+    }
+
+    PAL_LOG_DBG("pal_plat_saveSslTicketSession - ticket of %" PRIu32 " bytes kept", (uint32_t)g_ticketSession.ticket_len);
+    g_ticketSessionValid = true;
+    return PAL_SUCCESS;
+}
+
+palStatus_t pal_plat_loadSslTicketSession(palTLSHandle_t palTLSHandle)
+{
+    palTLS_t* localTLSCtx = (palTLS_t*)palTLSHandle;
+
+    if (!g_ticketSessionValid)
+    {
+        return PAL_ERR_GENERIC_FAILURE;
+    }
+
+    // The session is copied, so the same ticket can be offered again if this connection fails too
+    int32_t platStatus = mbedtls_ssl_set_session(&localTLSCtx->tlsCtx, &g_ticketSession);
+    if (SSL_LIB_SUCCESS != platStatus)
+    {
+        PAL_LOG_ERR("pal_plat_loadSslTicketSession - session set failed -0x%" PRIx32 ".", -platStatus);
+        return translateTLSErrToPALError(platStatus);
+    }
+
+    PAL_LOG_DBG("pal_plat_loadSslTicketSession - offering session ticket");
+    return PAL_SUCCESS;
+}
+
+void pal_plat_removeSslTicketSession(void)
+{
+    if (g_ticketSessionValid)
+    {
+        PAL_LOG_DBG("pal_plat_removeSslTicketSession");
+    }
+    // Zero initialized session is also valid for mbedtls_ssl_session_free()
+    mbedtls_ssl_session_free(&g_ticketSession);
+    g_ticketSessionValid = false;
+}
+#endif // PAL_USE_SSL_SESSION_TICKETS
 #endif // PAL_USE_SSL_SESSION_RESUME
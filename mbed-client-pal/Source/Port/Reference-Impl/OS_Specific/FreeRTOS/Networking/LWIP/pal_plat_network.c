@@ -32,6 +32,8 @@
     struct netconn *connection;
     struct netbuf *buffer;
     uint32_t offset;
+    uint32_t connectedAddress; // UDP peer given to netconn_connect(), valid when connectedPort is not 0
+    uint16_t connectedPort;
     palAsyncSocketCallback_t callback;
     void *callbackArgument;
  } palLwipNetConnInfo_t;
@@ -422,7 +424,8 @@ palStatus_t pal_plat_sendTo(palSocket_t socket, const void* buffer, size_t lengt
 {
     int result = 0;
     struct netconn* conn = NULL;
-    struct netbuf *localNetbuf;
+    palLwipNetConnInfo_t* socketInfo = NULL;
+    struct netbuf localNetbuf = {0};
     struct ip_addr toAddr;
     palIpV4Addr_t ipv4;
     unsigned short toPort;
@@ -431,7 +434,8 @@ palStatus_t pal_plat_sendTo(palSocket_t socket, const void* buffer, size_t lengt
     {
         return PAL_ERR_INVALID_ARGUMENT;
     }
-    conn = ((palLwipNetConnInfo_t*)socket)->connection;
+    socketInfo = (palLwipNetConnInfo_t*)socket;
+    conn = socketInfo->connection;
 
     // netconn documentaiton (http://www.ece.ualberta.ca/~cmpe401/docs/lwip.pdf) says buffers over the size of the MTU should nto be sent. since this isn not always known 1000bytes is a good heuristic
 
@@ -442,14 +446,8 @@ palStatus_t pal_plat_sendTo(palSocket_t socket, const void* buffer, size_t lengt
         goto finish;
     }
 
-    localNetbuf = netbuf_new();
-    if (NULL == localNetbuf)
-    {
-        result = PAL_ERR_NO_MEMORY;
-        goto finish;
-    }
-
-    result = netbuf_ref(localNetbuf, buffer, length);
+    // The netbuf only refers to the caller's buffer, so it is not taken from the netbuf pool
+    result = netbuf_ref(&localNetbuf, buffer, length);
     if (PAL_SUCCESS == result)
     {
         result = pal_getSockAddrPort(to, &toPort);
@@ -460,10 +458,20 @@ palStatus_t pal_plat_sendTo(palSocket_t socket, const void* buffer, size_t lengt
             {
                 toAddr.addr = ipv4[0] | (ipv4[1] << 8) | (ipv4[2] << 16) | (ipv4[3] << 24);
 
-                result = netconn_connect(conn, &toAddr, toPort);
+                // Connecting is a round trip to the tcpip thread, skip it when the peer has not changed
+                if ((0 != socketInfo->connectedPort) && (toPort == socketInfo->connectedPort) && (toAddr.addr == socketInfo->connectedAddress))
+                {
+                    result = ERR_OK;
+                }
+                else
+                {
+                    result = netconn_connect(conn, &toAddr, toPort);
+                    socketInfo->connectedAddress = toAddr.addr;
+                    socketInfo->connectedPort = (ERR_OK == result) ? toPort : 0;
+                }
                 if (ERR_OK == result)
                 {
-                    result = netconn_send(conn, localNetbuf);
+                    result = netconn_send(conn, &localNetbuf);
                     if (ERR_OK != result)
                     {
                         result = translateErrnoToPALError(result);
@@ -477,7 +485,7 @@ palStatus_t pal_plat_sendTo(palSocket_t socket, const void* buffer, size_t lengt
         }
     }
 
-    netbuf_delete(localNetbuf);
+    netbuf_free(&localNetbuf);
     *bytesSent = length;
 
 finish:
@@ -672,6 +680,7 @@ palStatus_t pal_plat_accept(palSocket_t socket, palSocketAddress_t * address, pa
             socketInfo->callback = callback;
             socketInfo->callbackArgument = callbackArgument;
             socketInfo->buffer = NULL;
+            socketInfo->connectedPort = 0;
             *acceptedSocket = (palSocket_t)socketInfo;
 
             result = netconn_getaddr(new_conn, &addr, &port, 0);
@@ -901,6 +910,7 @@ palStatus_t pal_plat_asynchronousSocket(palSocketDomain_t domain, palSocketType_
         {
             socketInfo->connection = con;
             socketInfo->buffer = NULL;
+            socketInfo->connectedPort = 0;
             // TODO(nirson01) : add binding to specific network interface  (interfaceNum)
             if (nonBlockingSocket)
             {
@@ -74,6 +74,7 @@ typedef struct palThreadData
     palThreadFuncPtr userFunction;
     void* userFunctionArgument;
     TaskHandle_t sysThreadID;
+    uint32_t stackSize;
 } palThreadData_t;
 
 #define PAL_MAX_CONCURRENT_THREADS 20
@@ -234,7 +235,7 @@ PAL_PRIVATE palThreadData_t** threadFind(const TaskHandle_t sysThreadID)
     palThreadData_t** threadData = NULL;
     for (int i = 0; i < PAL_MAX_CONCURRENT_THREADS; i++)
     {
-        if (sysThreadID == g_threadsArray[i]->sysThreadID)
+        if ((NULL != g_threadsArray[i]) && (sysThreadID == g_threadsArray[i]->sysThreadID))
         {
             threadData = &g_threadsArray[i];
             break;
@@ -307,6 +308,7 @@ palStatus_t pal_plat_osThreadCreate(palThreadFuncPtr function, void* funcArgumen
 
     (*threadData)->userFunction = function; // note that threadData is safe here (eventhough it's not mutex locked), no other thread will attempt to change it until the thread is either finished or terminated
     (*threadData)->userFunctionArgument = funcArgument;
+    (*threadData)->stackSize = stackSize;
     
     //Note: the stack in this API is handled as an array of "StackType_t" which can be of different sizes for different ports.
     //      in this specific port of (8.1.2) the "StackType_t" is defined to 4-bytes this is why we divide the "stackSize" parameter by "sizeof(uint32_t)".
@@ -374,6 +376,58 @@ end:
     return status;
 }
 
+palStatus_t pal_plat_osThreadStatsGet(palThreadID_t threadID, palThreadStats_t* stats)
+{
+    palStatus_t status = PAL_SUCCESS;
+    palStatus_t mutexStatus;
+    TaskHandle_t sysThreadID = (TaskHandle_t)threadID;
+    palThreadData_t** threadData;
+
+    PAL_THREADS_MUTEX_LOCK(mutexStatus);
+    if (PAL_SUCCESS != mutexStatus)
+    {
+        status = mutexStatus;
+        goto end;
+    }
+    threadData = threadFind(sysThreadID);
+    if (NULL == threadData) // not a PAL thread, or ended already
+    {
+        status = PAL_ERR_RTOS_PARAMETER;
+    }
+    else
+    {
+        stats->stackSize = (*threadData)->stackSize;
+#if (INCLUDE_uxTaskGetStackHighWaterMark == 1)
+        // FreeRTOS fills the stack at creation and returns the smallest free space seen, in words
+        stats->stackHighWater = (*threadData)->stackSize - (uxTaskGetStackHighWaterMark(sysThreadID) * sizeof(StackType_t));
+#endif
+#if (configGENERATE_RUN_TIME_STATS == 1) && (configUSE_TRACE_FACILITY == 1) && defined(PAL_RTOS_RUN_TIME_COUNTER_FREQUENCY)
+        {
+            UBaseType_t count = uxTaskGetNumberOfTasks();
+            TaskStatus_t* tasks = (TaskStatus_t*)malloc(count * sizeof(TaskStatus_t));
+            if (NULL != tasks)
+            {
+                count = uxTaskGetSystemState(tasks, count, NULL);
+                for (UBaseType_t i = 0; i < count; i++)
+                {
+                    if (tasks[i].xHandle == sysThreadID)
+                    {
+                        // the run time counter is in the units of the port's run time stats timer
+                        stats->cpuTimeMicroSec = ((uint64_t)tasks[i].ulRunTimeCounter * 1000000) / PAL_RTOS_RUN_TIME_COUNTER_FREQUENCY;
+                        break;
+                    }
+                }
+                free(tasks);
+            }
+        }
+#endif
+        // FreeRTOS keeps no context switch counts per task
+    }
+    PAL_THREADS_MUTEX_UNLOCK(mutexStatus);
+end:
+    return status;
+}
+
 PAL_PRIVATE palTimer_t* s_timerArrays[PAL_MAX_NUM_OF_TIMERS] = {0};
 
 PAL_PRIVATE void pal_plat_osTimerWarpperFunction( TimerHandle_t xTimer )
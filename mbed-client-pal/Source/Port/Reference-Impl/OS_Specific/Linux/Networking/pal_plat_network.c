@@ -39,6 +39,10 @@
 #include <fcntl.h>
 #include <time.h>
 #include <assert.h>
+#if PAL_NET_ASYNC_SOCKET_MANAGER_EPOLL
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
 
 #define TRACE_GROUP "PAL"
 
@@ -123,6 +127,145 @@ PAL_PRIVATE palStatus_t translateErrorToPALError(int errnoValue)
 }
 
 
+#if PAL_NET_ASYNC_SOCKET_MANAGER_EPOLL
+
+// Maximum number of events handled per epoll_wait() call
+#define PAL_NET_EPOLL_MAX_EVENTS 16
+
+typedef struct palAsyncSocket {
+    int fd;
+    palAsyncSocketCallback_t callback;
+    void* callbackArgument;
+    struct palAsyncSocket* next;
+} palAsyncSocket_t;
+
+static palMutexID_t s_mutexSocketCallbacks = 0;
+static palSemaphoreID_t s_socketCallbackSemaphore = 0;
+static int s_epollFd = -1;
+static int s_epollWakeupFd = -1;
+
+// These must be updated only when protected by s_mutexSocketCallbacks
+static palAsyncSocket_t* s_asyncSockets = NULL;
+// Sockets removed by pal_plat_close(). These are freed only by the async socket manager
+// between epoll_wait() calls, as the events it is dispatching may still point to them.
+static palAsyncSocket_t* s_closedAsyncSockets = NULL;
+static volatile bool s_socketThreadTerminateSignaled = false;
+
+// Edge-triggered sockets do not need the event filter of the ppoll() based manager
+PAL_PRIVATE void clearSocketFilter(int socketFD)
+{
+    PAL_UNUSED_ARG(socketFD); // unused
+}
+
+PAL_PRIVATE void freeAsyncSocketList(palAsyncSocket_t* list)
+{
+    while (list)
+    {
+        palAsyncSocket_t* next = list->next;
+        free(list);
+        list = next;
+    }
+}
+
+// Thread function.
+PAL_PRIVATE void asyncSocketManager(void const* arg)
+{
+    PAL_UNUSED_ARG(arg); // unused
+    struct epoll_event events[PAL_NET_EPOLL_MAX_EVENTS];
+    palStatus_t result = PAL_SUCCESS;
+    bool terminate = false;
+
+    // Tell the calling thread that we have finished initialization
+    result = pal_osSemaphoreRelease(s_socketCallbackSemaphore);
+    if (result != PAL_SUCCESS)
+    {
+        PAL_LOG_ERR("Error in async socket manager on semaphore release");
+    }
+
+    while (result == PAL_SUCCESS && !terminate)
+    {
+        palAsyncSocket_t* closed;
+        int res;
+        int i;
+
+        // Events of the previous round have been dispatched, the closed sockets are not referenced anymore
+        result = pal_osMutexWait(s_mutexSocketCallbacks, PAL_RTOS_WAIT_FOREVER);
+        if (PAL_SUCCESS != result)
+        {
+            PAL_LOG_ERR("Error in async socket manager on mutex wait");
+            break;
+        }
+        closed = s_closedAsyncSockets;
+        s_closedAsyncSockets = NULL;
+        result = pal_osMutexRelease(s_mutexSocketCallbacks);
+        if (PAL_SUCCESS != result)
+        {
+            PAL_LOG_ERR("Error in async socket manager on mutex release");
+            break;
+        }
+        freeAsyncSocketList(closed);
+
+        res = epoll_wait(s_epollFd, events, PAL_NET_EPOLL_MAX_EVENTS, -1);
+        if (res == -1)
+        {
+            if (errno != EINTR)
+            {
+                PAL_LOG_ERR("Error in async socket manager %d", errno);
+                result = translateErrorToPALError(errno);
+            }
+            continue;
+        }
+
+        for (i = 0; i < res; i++)
+        {
+            palAsyncSocket_t* asyncSocket = (palAsyncSocket_t*)events[i].data.ptr;
+            palAsyncSocketCallback_t callback;
+            void* callbackArgument;
+
+            // Only the wakeup eventfd is registered without a socket, and it is used for termination
+            if (asyncSocket == NULL)
+            {
+                terminate = true;
+                continue;
+            }
+
+            // Notes:
+            // The sockets are edge-triggered, so a callback is called once per state change and the
+            // repeated POLLOUT filtering of the ppoll() based manager is not needed. The specific
+            // event combination sent to all unconnected sockets in Linux is still filtered out.
+            if (events[i].events == (EPOLLOUT|EPOLLHUP))
+            {
+                continue;
+            }
+
+            result = pal_osMutexWait(s_mutexSocketCallbacks, PAL_RTOS_WAIT_FOREVER);
+            if (PAL_SUCCESS != result)
+            {
+                PAL_LOG_ERR("Error in async socket manager on mutex wait");
+                break;
+            }
+            // Cleared if the socket was closed after epoll_wait() returned
+            callback = asyncSocket->callback;
+            callbackArgument = asyncSocket->callbackArgument;
+            result = pal_osMutexRelease(s_mutexSocketCallbacks);
+            if (PAL_SUCCESS != result)
+            {
+                PAL_LOG_ERR("Error in async socket manager on mutex release");
+                break;
+            }
+
+            if (callback)
+            {
+                callback(callbackArgument);
+            }
+        }
+    }
+
+    s_socketThreadTerminateSignaled = true; // mark that the thread has receieved the termination request
+}
+
+#else // PAL_NET_ASYNC_SOCKET_MANAGER_EPOLL
+
 static pthread_t s_pollThread = NULLPTR;
 static palMutexID_t s_mutexSocketCallbacks = 0;
 static palMutexID_t s_mutexSocketEventFilter = 0;
@@ -355,6 +498,8 @@ PAL_PRIVATE void asyncSocketManager(void const* arg)
     }  // while
 }
 
+#endif // PAL_NET_ASYNC_SOCKET_MANAGER_EPOLL
+
 
 PAL_PRIVATE palStatus_t pal_plat_SockAddrToSocketAddress(const palSocketAddress_t* palAddr, struct sockaddr* output)
 {
@@ -471,6 +616,21 @@ palStatus_t pal_plat_socketsInit(void* context)
         return result;
     }
 
+#if PAL_NET_ASYNC_SOCKET_MANAGER_EPOLL
+    struct epoll_event wakeupEvent = {0};
+    wakeupEvent.events = EPOLLIN;
+    wakeupEvent.data.ptr = NULL;
+
+    s_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    s_epollWakeupFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if ((s_epollFd == -1) || (s_epollWakeupFd == -1) ||
+        (epoll_ctl(s_epollFd, EPOLL_CTL_ADD, s_epollWakeupFd, &wakeupEvent) == -1))
+    {
+        result = translateErrorToPALError(errno);
+        // todo: clean up the mess created so far
+        return result;
+    }
+#else
     result = pal_osMutexCreate(&s_mutexSocketEventFilter);
     if (PAL_SUCCESS != result)
     {
@@ -483,6 +643,7 @@ palStatus_t pal_plat_socketsInit(void* context)
         // todo: clean up the mess created so far
         return result;
     }
+#endif
 
     // Sleep at first wait
     result = pal_osSemaphoreCreate(0, &s_socketCallbackSemaphore);
@@ -591,6 +752,14 @@ palStatus_t pal_plat_socketsTerminate(void* context)
         firstError = result;
     }
 
+#if PAL_NET_ASYNC_SOCKET_MANAGER_EPOLL
+    // Tell the poll thread to interrupt so that it can check for termination.
+    const uint64_t wakeup = 1;
+    if ((write(s_epollWakeupFd, &wakeup, sizeof(wakeup)) != sizeof(wakeup)) && (PAL_SUCCESS == firstError))
+    {
+        firstError = translateErrorToPALError(errno);
+    }
+#else
     s_nfds = PAL_SOCKETS_TERMINATE;
     result = pal_osSemaphoreRelease(s_socketCallbackSignalSemaphore);
     if ((PAL_SUCCESS != result) && (PAL_SUCCESS == firstError))
@@ -603,6 +772,7 @@ palStatus_t pal_plat_socketsTerminate(void* context)
     {
         pthread_kill(s_pollThread, SIGUSR1);
     }
+#endif
 
     result = pal_osMutexRelease(s_mutexSocketCallbacks);
     if ((PAL_SUCCESS != result) && (PAL_SUCCESS == firstError))
@@ -616,6 +786,18 @@ palStatus_t pal_plat_socketsTerminate(void* context)
         pal_osDelay(10);
     }
 
+#if PAL_NET_ASYNC_SOCKET_MANAGER_EPOLL
+    close(s_epollWakeupFd);
+    close(s_epollFd);
+    s_epollWakeupFd = -1;
+    s_epollFd = -1;
+
+    // The thread has exited, so nothing references the remaining sockets
+    freeAsyncSocketList(s_asyncSockets);
+    freeAsyncSocketList(s_closedAsyncSockets);
+    s_asyncSockets = NULL;
+    s_closedAsyncSockets = NULL;
+#else
     result = pal_osSemaphoreDelete(&s_socketCallbackSignalSemaphore);
     if ((PAL_SUCCESS != result) && (PAL_SUCCESS == firstError))
     {
@@ -629,6 +811,7 @@ palStatus_t pal_plat_socketsTerminate(void* context)
         // TODO print error using logging mechanism when available.
         firstError = result;
     }
+#endif
 
     result = pal_osMutexDelete(&s_mutexSocketCallbacks);
     if ((PAL_SUCCESS != result ) && (PAL_SUCCESS == firstError))
@@ -785,6 +968,123 @@ palStatus_t pal_plat_isNonBlocking(palSocket_t socket, bool* isNonBlocking)
 }
 
 
+#if PAL_NET_DATAGRAM_BATCH_SUPPORT
+
+// Maximum number of datagrams per recvmmsg() and sendmmsg() call
+#define PAL_NET_DATAGRAM_MAX_BATCH 16
+
+palStatus_t pal_plat_receiveFromBatch(palSocket_t socket, palDatagram_t* datagrams, uint32_t count, uint32_t* received)
+{
+    palStatus_t result = PAL_SUCCESS;
+    int res;
+    uint32_t i;
+    struct mmsghdr msgs[PAL_NET_DATAGRAM_MAX_BATCH];
+    struct iovec iovecs[PAL_NET_DATAGRAM_MAX_BATCH];
+    struct sockaddr_storage internalAddrs[PAL_NET_DATAGRAM_MAX_BATCH];
+
+    if (count > PAL_NET_DATAGRAM_MAX_BATCH)
+    {
+        count = PAL_NET_DATAGRAM_MAX_BATCH;
+    }
+
+    memset(msgs, 0, count * sizeof(msgs[0]));
+    for (i = 0; i < count; i++)
+    {
+        iovecs[i].iov_base = datagrams[i].buffer;
+        iovecs[i].iov_len = datagrams[i].length;
+        msgs[i].msg_hdr.msg_iov = &iovecs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = &internalAddrs[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(internalAddrs[i]);
+    }
+
+    clearSocketFilter((intptr_t)socket);
+    // Block only until the first datagram, like recvfrom() does
+    res = recvmmsg((intptr_t)socket, msgs, count, MSG_WAITFORONE, NULL);
+    if(res == -1)
+    {
+        result = translateErrorToPALError(errno);
+    }
+    else // only return addresses / bytesTransferred in case of success
+    {
+        for (i = 0; i < (uint32_t)res; i++)
+        {
+            datagrams[i].bytesTransferred = msgs[i].msg_len;
+            if (NULL != datagrams[i].address)
+            {
+                palStatus_t status = pal_plat_socketAddressToPalSockAddr((struct sockaddr *)&internalAddrs[i],
+                                                                         datagrams[i].address, &datagrams[i].addressLength);
+                if (PAL_SUCCESS != status)
+                {
+                    result = status;
+                }
+            }
+        }
+        *received = res;
+    }
+
+    return result;
+}
+
+palStatus_t pal_plat_sendToBatch(palSocket_t socket, palDatagram_t* datagrams, uint32_t count, uint32_t* sent)
+{
+    palStatus_t result = PAL_SUCCESS;
+    int res;
+    uint32_t i;
+    uint32_t total = 0;
+    struct mmsghdr msgs[PAL_NET_DATAGRAM_MAX_BATCH];
+    struct iovec iovecs[PAL_NET_DATAGRAM_MAX_BATCH];
+
+    clearSocketFilter((intptr_t)socket);
+    while (total < count)
+    {
+        uint32_t batch = count - total;
+        if (batch > PAL_NET_DATAGRAM_MAX_BATCH)
+        {
+            batch = PAL_NET_DATAGRAM_MAX_BATCH;
+        }
+
+        memset(msgs, 0, batch * sizeof(msgs[0]));
+        for (i = 0; i < batch; i++)
+        {
+            palDatagram_t* datagram = &datagrams[total + i];
+            iovecs[i].iov_base = datagram->buffer;
+            iovecs[i].iov_len = datagram->length;
+            msgs[i].msg_hdr.msg_iov = &iovecs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_name = datagram->address;
+            msgs[i].msg_hdr.msg_namelen = datagram->addressLength;
+        }
+
+        res = sendmmsg((intptr_t)socket, msgs, batch, 0);
+        if (res == -1)
+        {
+            // The datagrams sent so far are reported as a success, the error is returned on the next call
+            if (total == 0)
+            {
+                result = translateErrorToPALError(errno);
+            }
+            break;
+        }
+
+        for (i = 0; i < (uint32_t)res; i++)
+        {
+            datagrams[total + i].bytesTransferred = msgs[i].msg_len;
+        }
+        total += res;
+
+        if ((uint32_t)res < batch)
+        {
+            break;
+        }
+    }
+
+    *sent = total;
+    return result;
+}
+
+#endif // PAL_NET_DATAGRAM_BATCH_SUPPORT
+
 palStatus_t pal_plat_bind(palSocket_t socket, palSocketAddress_t* myAddress, palSocketLength_t addressLength)
 {
     int result = PAL_SUCCESS;
@@ -854,7 +1154,9 @@ palStatus_t pal_plat_close(palSocket_t* socket)
 {
     palStatus_t result = PAL_SUCCESS;
     int res;
+#if !PAL_NET_ASYNC_SOCKET_MANAGER_EPOLL
     unsigned int i,j;
+#endif
 
     if  (*socket == (void *)PAL_LINUX_INVALID_SOCKET) // socket already closed - return success.
     {
@@ -870,6 +1172,25 @@ palStatus_t pal_plat_close(palSocket_t* socket)
         return result;
     }
 
+#if PAL_NET_ASYNC_SOCKET_MANAGER_EPOLL
+    palAsyncSocket_t** asyncSocket = &s_asyncSockets;
+    while (*asyncSocket)
+    {
+        if ((*asyncSocket)->fd == (intptr_t)*socket)
+        {
+            palAsyncSocket_t* closed = *asyncSocket;
+            *asyncSocket = closed->next;
+            // Remove from the epoll set before the fd can be reused, the manager thread will free the entry
+            (void)epoll_ctl(s_epollFd, EPOLL_CTL_DEL, closed->fd, NULL);
+            closed->callback = NULL;
+            closed->callbackArgument = NULL;
+            closed->next = s_closedAsyncSockets;
+            s_closedAsyncSockets = closed;
+            break;
+        }
+        asyncSocket = &(*asyncSocket)->next;
+    }
+#else
     for(i= 0 ; i < s_nfds; i++)
     {
         // check if we have we found the socket being closed
@@ -894,6 +1215,7 @@ palStatus_t pal_plat_close(palSocket_t* socket)
             break;
         }
     }
+#endif
     result = pal_osMutexRelease(s_mutexSocketCallbacks);
     if (result != PAL_SUCCESS)
     {
@@ -979,6 +1301,54 @@ palStatus_t pal_plat_getNetInterfaceInfo(uint32_t interfaceNum, palNetInterfaceI
     return result;
 }
 
+#if PAL_NET_ASYNC_SOCKET_MANAGER_EPOLL
+
+PAL_PRIVATE palStatus_t registerAsyncSocketParams(palSocket_t socket, palAsyncSocketCallback_t callback, void* callbackArgument)
+{
+    palStatus_t result;
+    struct epoll_event event = {0};
+    palAsyncSocket_t* asyncSocket = (palAsyncSocket_t*)malloc(sizeof(palAsyncSocket_t));
+
+    if (asyncSocket == NULL)
+    {
+        return PAL_ERR_NO_MEMORY;
+    }
+
+    asyncSocket->fd = (intptr_t)socket;
+    asyncSocket->callback = callback;
+    asyncSocket->callbackArgument = callbackArgument;
+
+    // Critical section to update globals
+    result = pal_osMutexWait(s_mutexSocketCallbacks, PAL_RTOS_WAIT_FOREVER);
+    if (result != PAL_SUCCESS)
+    {
+        free(asyncSocket);
+        return result;
+    }
+
+    event.events = EPOLLIN|EPOLLOUT|EPOLLRDHUP|EPOLLERR|EPOLLET;
+    event.data.ptr = asyncSocket;
+    if (epoll_ctl(s_epollFd, EPOLL_CTL_ADD, asyncSocket->fd, &event) == -1)
+    {
+        result = translateErrorToPALError(errno);
+        free(asyncSocket);
+    }
+    else
+    {
+        asyncSocket->next = s_asyncSockets;
+        s_asyncSockets = asyncSocket;
+    }
+
+    if (pal_osMutexRelease(s_mutexSocketCallbacks) != PAL_SUCCESS)
+    {
+        // TODO print error using logging mechanism when available.
+    }
+
+    return result;
+}
+
+#else // PAL_NET_ASYNC_SOCKET_MANAGER_EPOLL
+
 PAL_PRIVATE palStatus_t registerAsyncSocketParams(palSocket_t socket, palAsyncSocketCallback_t callback, void* callbackArgument)
 {
     palStatus_t result;
@@ -1012,6 +1382,8 @@ PAL_PRIVATE palStatus_t registerAsyncSocketParams(palSocket_t socket, palAsyncSo
     return result;
 }
 
+#endif // PAL_NET_ASYNC_SOCKET_MANAGER_EPOLL
+
 #if PAL_NET_TCP_AND_TLS_SUPPORT // functionality below supported only in case TCP is supported.
 
 #if PAL_NET_SERVER_SOCKET_API
@@ -1135,9 +1507,11 @@ palStatus_t pal_plat_send(palSocket_t socket, const void *buf, size_t len, size_
 palStatus_t pal_plat_asynchronousSocket(palSocketDomain_t domain, palSocketType_t type, bool nonBlockingSocket, uint32_t interfaceNum, palAsyncSocketCallback_t callback, void* callbackArgument, palSocket_t* socket)
 {
 
+    palStatus_t result = create_socket(domain,  type,  nonBlockingSocket,  interfaceNum, socket);
+
+#if !PAL_NET_ASYNC_SOCKET_MANAGER_EPOLL
     int err;
     int flags;
-    palStatus_t result = create_socket(domain,  type,  nonBlockingSocket,  interfaceNum, socket);
 
     // initialize the socket to be ASYNC so we get SIGIO's for it
     // XXX: this needs to be conditionalized as the blocking IO might have some use also.
@@ -1155,6 +1529,7 @@ palStatus_t pal_plat_asynchronousSocket(palSocketDomain_t domain, palSocketType_
     {
         result = translateErrorToPALError(errno);
     }
+#endif
 
     if (result == PAL_SUCCESS)
     {
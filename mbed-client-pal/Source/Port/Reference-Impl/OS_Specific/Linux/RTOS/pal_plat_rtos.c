@@ -31,10 +31,19 @@
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <sys/utsname.h>
+#include <sys/syscall.h>
 
 #include "pal.h"
 #include "pal_plat_rtos.h"
 
+#if PAL_RTOS_TIMERFD_TIMERS
+#include <sys/timerfd.h>
+#endif
+
+#if PAL_RTOS_FUTEX_SYNC
+#include <linux/futex.h>
+#endif
+
 #define TRACE_GROUP "PAL"
 
  /*
@@ -56,12 +65,67 @@
 
 #define PAL_THREAD_PRIORITY_TRANSLATE(x) ((int16_t)(x + 7))
 
+// GNU extension, declared here as _GNU_SOURCE would make PTHREAD_STACK_MIN unusable in the configuration checks
+extern int pthread_getattr_np(pthread_t thread, pthread_attr_t* attr);
+
+// stack words not yet used by a thread hold this value
+#define PAL_THREAD_STACK_PAINT 0xCCCCCCCCU
+// part of the stack below the painting thread's frame left unpainted
+#define PAL_THREAD_STACK_PAINT_MARGIN 1024
+
 typedef struct palThreadData
 {
     palThreadFuncPtr userFunction;
     void* userFunctionArgument;
+    struct palThreadData* next;
+    pthread_t sysThreadID;
+    pid_t tid;
+    clockid_t cpuClock;
+    uint32_t* stackStart;
+    size_t stackSize;
 } palThreadData_t;
 
+// running PAL threads, for pal_plat_osThreadStatsGet()
+PAL_PRIVATE palThreadData_t* s_palThreads = NULL;
+PAL_PRIVATE pthread_mutex_t s_palThreadsMutex = PTHREAD_MUTEX_INITIALIZER;
+
+#if PAL_RTOS_TIMERFD_TIMERS
+
+#define PAL_TIMER_NOT_ARMED -1
+
+// Initial number of armed timers the heap has room for, it grows as needed
+#define PAL_RTOS_TIMER_HEAP_INITIAL_SIZE 16
+
+/*
+ * Internal struct to handle timers.
+ */
+struct palTimerInfo
+{
+    uint64_t deadline;
+    uint64_t period;
+    palTimerFuncPtr function;
+    void *funcArgs;
+    palTimerType_t timerType;
+    // index in g_timerHeap, PAL_TIMER_NOT_ARMED when the timer is not running
+    ssize_t heapIndex;
+};
+
+// Mutex to prevent simultaneus modification of the heap of the timers in g_timerHeap.
+PAL_PRIVATE palMutexID_t g_timerListMutex = 0;
+
+// All the running timers are multiplexed onto one timerfd, which is set to the earliest deadline
+// of a binary min-heap. The heap and the timerfd may be accessed only if holding the g_timerListMutex.
+// Timers which are not running are only owned by their creator, so deleting a timer does not need
+// to wait for the timer thread.
+PAL_PRIVATE struct palTimerInfo **g_timerHeap = NULL;
+PAL_PRIVATE size_t g_timerHeapCount = 0;
+PAL_PRIVATE size_t g_timerHeapCapacity = 0;
+PAL_PRIVATE int g_timerFd = -1;
+// Absolute wakeup time the timerfd is set to, zero when disarmed
+PAL_PRIVATE uint64_t g_timerFdWakeup = 0;
+
+#else
+
 /*
  * Internal struct to handle timers.
  */
@@ -77,17 +141,21 @@ struct palTimerInfo
 // Mutex to prevent simultaneus modification of the linked list of the timers in g_timerList.
 PAL_PRIVATE palMutexID_t g_timerListMutex = 0;
 
+#endif // PAL_RTOS_TIMERFD_TIMERS
+
 #if (PAL_SIMULATE_RTOS_REBOOT == 1)
     extern char *program_invocation_name;
 #endif
 
 
+#if !PAL_RTOS_TIMERFD_TIMERS
 // A singly linked list of the timers, access may be done only if holding the g_timerListMutex.
 // The list is needed as the timers use async signals and when the signal is finally delivered, the
 // palTimerInfo timer struct may be already deleted. The signals themselves carry pointer to timer,
 // so whenever a signal is received, the thread will look if the palTimerInfo is still on the list,
 // and if it is, uses the struct to find the callback pointer and arguments.
 PAL_PRIVATE volatile struct palTimerInfo *g_timerList = NULL;
+#endif
 
 extern palStatus_t pal_plat_getRandomBufferFromHW(uint8_t *randomBuf, size_t bufSizeBytes, size_t* actualRandomSizeBytes);
 
@@ -225,9 +293,64 @@ inline uint64_t pal_plat_osKernelSysTickFrequency(void)
 
 PAL_PRIVATE void threadCleanupHandler(void* arg)
 {
+    palThreadData_t** link;
+    pthread_mutex_lock(&s_palThreadsMutex);
+    for (link = &s_palThreads; *link != NULL; link = &(*link)->next)
+    {
+        if (*link == arg)
+        {
+            *link = (*link)->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&s_palThreadsMutex);
     free(arg);
 }
 
+/*
+ * Paint the unused part of the stack of the calling thread, so that its high-water mark can be found later.
+ * Thread stacks are reused by the C library, so they can not be assumed to be clear.
+ */
+PAL_PRIVATE void threadStackPaint(palThreadData_t* threadData)
+{
+    pthread_attr_t attr;
+    void* stackAddr;
+    size_t stackSize;
+    volatile uint32_t* word;
+    uint32_t* end = (uint32_t*)((uintptr_t)&attr - PAL_THREAD_STACK_PAINT_MARGIN);
+
+    if (0 != pthread_getattr_np(pthread_self(), &attr))
+    {
+        return;
+    }
+    if ((0 == pthread_attr_getstack(&attr, &stackAddr, &stackSize)) && ((uint32_t*)stackAddr < end))
+    {
+        threadData->stackStart = (uint32_t*)stackAddr;
+        threadData->stackSize = stackSize;
+        for (word = threadData->stackStart; word < end; word++)
+        {
+            *word = PAL_THREAD_STACK_PAINT;
+        }
+    }
+    pthread_attr_destroy(&attr);
+}
+
+PAL_PRIVATE void threadRegister(palThreadData_t* threadData)
+{
+    threadData->sysThreadID = pthread_self();
+    threadData->tid = (pid_t)syscall(SYS_gettid);
+    if (0 != pthread_getcpuclockid(threadData->sysThreadID, &threadData->cpuClock))
+    {
+        threadData->cpuClock = (clockid_t)-1;
+    }
+    threadStackPaint(threadData);
+
+    pthread_mutex_lock(&s_palThreadsMutex);
+    threadData->next = s_palThreads;
+    s_palThreads = threadData;
+    pthread_mutex_unlock(&s_palThreadsMutex);
+}
+
 PAL_PRIVATE void* threadFunction(void* arg)
 {
     /*
@@ -237,6 +360,7 @@ PAL_PRIVATE void* threadFunction(void* arg)
     */
     pthread_cleanup_push(threadCleanupHandler, arg); // register a cleanup handler to be executed once the thread is finished/terminated (threads can terminate only when reaching a cancellation point)
     palThreadData_t* threadData = (palThreadData_t*)arg;
+    threadRegister(threadData);
     threadData->userFunction(threadData->userFunctionArgument);
     pthread_cleanup_pop(1); // in case the thread has not terminated execute the cleanup handler (passing a non zero value to pthread_cleanup_pop)
     return NULL;
@@ -275,7 +399,7 @@ palStatus_t pal_plat_osThreadCreate(palThreadFuncPtr function, void* funcArgumen
         goto finish;
     }
 
-    threadData = (palThreadData_t*)malloc(sizeof(palThreadData_t));
+    threadData = (palThreadData_t*)calloc(1, sizeof(palThreadData_t));
     if (NULL == threadData)
     {
         status = PAL_ERR_RTOS_RESOURCE;
@@ -333,6 +457,72 @@ palStatus_t pal_plat_osThreadTerminate(palThreadID_t* threadID)
     return status;
 }
 
+// read the context switch counts of a thread of this process from procfs
+PAL_PRIVATE uint32_t threadContextSwitches(pid_t tid)
+{
+    char path[64];
+    char line[128];
+    unsigned long count;
+    uint32_t switches = 0;
+    FILE* file;
+
+    snprintf(path, sizeof(path), "/proc/self/task/%d/status", (int)tid);
+    file = fopen(path, "r");
+    if (NULL == file)
+    {
+        return 0;
+    }
+    while (NULL != fgets(line, sizeof(line), file))
+    {
+        if ((1 == sscanf(line, "voluntary_ctxt_switches: %lu", &count)) ||
+            (1 == sscanf(line, "nonvoluntary_ctxt_switches: %lu", &count)))
+        {
+            switches += (uint32_t)count;
+        }
+    }
+    fclose(file);
+    return switches;
+}
+
+palStatus_t pal_plat_osThreadStatsGet(palThreadID_t threadID, palThreadStats_t* stats)
+{
+    palStatus_t status = PAL_ERR_RTOS_PARAMETER;
+    palThreadData_t* threadData;
+    struct timespec cpuTime;
+    const uint32_t* word;
+    const uint32_t* end;
+
+    // the thread can not finish while it is found in the list, so its stack and clock stay valid
+    pthread_mutex_lock(&s_palThreadsMutex);
+    for (threadData = s_palThreads; threadData != NULL; threadData = threadData->next)
+    {
+        if (pthread_equal(threadData->sysThreadID, (pthread_t)threadID))
+        {
+            break;
+        }
+    }
+    if (NULL != threadData)
+    {
+        if (NULL != threadData->stackStart)
+        {
+            end = threadData->stackStart + (threadData->stackSize / sizeof(uint32_t));
+            for (word = threadData->stackStart; (word < end) && (*word == PAL_THREAD_STACK_PAINT); word++)
+            {
+            }
+            stats->stackSize = (uint32_t)threadData->stackSize;
+            stats->stackHighWater = (uint32_t)(threadData->stackSize - ((uintptr_t)word - (uintptr_t)threadData->stackStart));
+        }
+        if ((threadData->cpuClock != (clockid_t)-1) && (0 == clock_gettime(threadData->cpuClock, &cpuTime)))
+        {
+            stats->cpuTimeMicroSec = ((uint64_t)cpuTime.tv_sec * 1000000) + ((uint64_t)cpuTime.tv_nsec / 1000);
+        }
+        stats->contextSwitches = threadContextSwitches(threadData->tid);
+        status = PAL_SUCCESS;
+    }
+    pthread_mutex_unlock(&s_palThreadsMutex);
+    return status;
+}
+
 /*! Wait for a specified period of time in milliseconds.
  *
  * @param[in] milliseconds The number of milliseconds to wait before proceeding.
@@ -378,6 +568,410 @@ typedef struct palTimerThreadContext
 static palThreadID_t s_palHighResTimerThreadID = NULLPTR;
 static palTimerThreadContext_t s_palTimerThreadContext = {0};
 
+#if PAL_RTOS_TIMERFD_TIMERS
+
+/* Absolute CLOCK_MONOTONIC time in nanoseconds
+ */
+PAL_PRIVATE uint64_t timerNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * PAL_NANO_PER_SECOND) + ts.tv_nsec;
+}
+
+PAL_PRIVATE void timerHeapSwap(size_t a, size_t b)
+{
+    struct palTimerInfo *temp = g_timerHeap[a];
+    g_timerHeap[a] = g_timerHeap[b];
+    g_timerHeap[b] = temp;
+    g_timerHeap[a]->heapIndex = a;
+    g_timerHeap[b]->heapIndex = b;
+}
+
+PAL_PRIVATE void timerHeapSiftUp(size_t index)
+{
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (g_timerHeap[parent]->deadline <= g_timerHeap[index]->deadline) {
+            break;
+        }
+        timerHeapSwap(parent, index);
+        index = parent;
+    }
+}
+
+PAL_PRIVATE void timerHeapSiftDown(size_t index)
+{
+    while (1) {
+        size_t smallest = index;
+        size_t child = (2 * index) + 1;
+
+        if ((child < g_timerHeapCount) && (g_timerHeap[child]->deadline < g_timerHeap[smallest]->deadline)) {
+            smallest = child;
+        }
+        child++;
+        if ((child < g_timerHeapCount) && (g_timerHeap[child]->deadline < g_timerHeap[smallest]->deadline)) {
+            smallest = child;
+        }
+        if (smallest == index) {
+            break;
+        }
+        timerHeapSwap(index, smallest);
+        index = smallest;
+    }
+}
+
+// Must be called while holding g_timerListMutex, the timer must not be on the heap.
+PAL_PRIVATE palStatus_t timerHeapInsert(struct palTimerInfo *timerInfo)
+{
+    if (g_timerHeapCount == g_timerHeapCapacity) {
+        size_t capacity = g_timerHeapCapacity ? (g_timerHeapCapacity * 2) : PAL_RTOS_TIMER_HEAP_INITIAL_SIZE;
+        struct palTimerInfo **heap = (struct palTimerInfo **)realloc(g_timerHeap, capacity * sizeof(*heap));
+        if (NULL == heap) {
+            return PAL_ERR_NO_MEMORY;
+        }
+        g_timerHeap = heap;
+        g_timerHeapCapacity = capacity;
+    }
+
+    timerInfo->heapIndex = g_timerHeapCount;
+    g_timerHeap[g_timerHeapCount++] = timerInfo;
+    timerHeapSiftUp(timerInfo->heapIndex);
+    return PAL_SUCCESS;
+}
+
+// Must be called while holding g_timerListMutex, the timer must be on the heap.
+PAL_PRIVATE void timerHeapRemove(struct palTimerInfo *timerInfo)
+{
+    size_t index = timerInfo->heapIndex;
+
+    g_timerHeapCount--;
+    if (index != g_timerHeapCount) {
+        g_timerHeap[index] = g_timerHeap[g_timerHeapCount];
+        g_timerHeap[index]->heapIndex = index;
+        timerHeapSiftUp(index);
+        timerHeapSiftDown(g_timerHeap[index]->heapIndex);
+    }
+    timerInfo->heapIndex = PAL_TIMER_NOT_ARMED;
+}
+
+/* Set the timerfd to the earliest deadline on the heap. The wakeup is delayed by the
+ * slack, so that all the timers expiring within it are handled on the same wakeup.
+ * Must be called while holding g_timerListMutex.
+ */
+PAL_PRIVATE void timerFdUpdate(void)
+{
+    uint64_t wakeup = 0;
+    struct itimerspec its;
+
+    if (s_palTimerThreadContext.threadStopRequested) {
+        // any time in the past expires immediately
+        wakeup = 1;
+    } else if (g_timerHeapCount) {
+        wakeup = g_timerHeap[0]->deadline + ((uint64_t)PAL_RTOS_TIMER_SLACK_MS * PAL_NANO_PER_MILLI);
+    }
+
+    if (wakeup == g_timerFdWakeup) {
+        return;
+    }
+
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = wakeup / PAL_NANO_PER_SECOND;
+    its.it_value.tv_nsec = wakeup % PAL_NANO_PER_SECOND;
+
+    // a zero value disarms the timerfd
+    if (-1 == timerfd_settime(g_timerFd, TFD_TIMER_ABSTIME, &its, NULL)) {
+        PAL_LOG_ERR("timerfd_settime failed with %d", errno);
+    } else {
+        g_timerFdWakeup = wakeup;
+    }
+}
+
+/*
+* Thread for handling the expirations of all timers by calling the attached callback
+*/
+
+PAL_PRIVATE void palTimerThread(void const *args)
+{
+    palTimerThreadContext_t* context = (palTimerThreadContext_t*)args;
+
+    // signal the caller that thread has started
+    if (pal_osSemaphoreRelease(context->startStopSemaphore) != PAL_SUCCESS) {
+        PAL_LOG_ERR("pal_osSemaphoreRelease(context->startStopSemaphore) failed!");
+    }
+
+    // loop until signaled with threadStopRequested
+    while (1) {
+
+        uint64_t expirations;
+
+        // wait for the earliest deadline, the timerfd is re-armed while waiting if it changes
+        if (read(g_timerFd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+            if (errno != EINTR) {
+                PAL_LOG_ERR("palTimerThread: read failed with %d\n", errno);
+            }
+            continue;
+        }
+
+        // before using the timer heap or threadStopRequested flag, we need to claim the mutex
+        pal_osMutexWait(g_timerListMutex, PAL_RTOS_WAIT_FOREVER);
+
+        // timerFdUpdate() skips re-arming if the wakeup does not change, so it is expired now
+        g_timerFdWakeup = 0;
+
+        const uint64_t now = timerNow();
+
+        while (!context->threadStopRequested && g_timerHeapCount && (g_timerHeap[0]->deadline <= now)) {
+
+            struct palTimerInfo *expired_timer = g_timerHeap[0];
+
+            // backup the parameters as we release the mutex before calling the callback
+            // and the timer may very well get deleted just after the mutex is released.
+            palTimerFuncPtr found_function = expired_timer->function;
+            void *found_funcArgs = expired_timer->funcArgs;
+
+            if (palOsTimerPeriodic == expired_timer->timerType) {
+                // skip the periods which were missed while waiting
+                expired_timer->deadline += expired_timer->period;
+                if (expired_timer->deadline <= now) {
+                    expired_timer->deadline = now + expired_timer->period;
+                }
+                timerHeapSiftDown(0);
+            } else {
+                timerHeapRemove(expired_timer);
+            }
+
+            // Release the mutex before callback to avoid callback deadlocking other threads
+            // if they try to create a timer.
+            (void)pal_osMutexRelease(g_timerListMutex);
+
+            found_function(found_funcArgs);
+
+            pal_osMutexWait(g_timerListMutex, PAL_RTOS_WAIT_FOREVER);
+        }
+
+        if (context->threadStopRequested) {
+
+            // release mutex and bail out
+            (void)pal_osMutexRelease(g_timerListMutex);
+            break;
+        }
+
+        timerFdUpdate();
+
+        (void)pal_osMutexRelease(g_timerListMutex);
+    }
+
+    // signal the caller that thread is now stopping and it can continue the pal_destroy()
+    (void)pal_osSemaphoreRelease(context->startStopSemaphore);
+}
+
+PAL_PRIVATE palStatus_t startTimerThread()
+{
+    palStatus_t status;
+
+    g_timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (-1 == g_timerFd) {
+        PAL_LOG_ERR("timerfd_create failed with %d", errno);
+        return PAL_ERR_SYSCALL_FAILED;
+    }
+    g_timerFdWakeup = 0;
+
+    status = pal_osSemaphoreCreate(0, &s_palTimerThreadContext.startStopSemaphore);
+
+    if (status == PAL_SUCCESS) {
+
+        s_palTimerThreadContext.threadStopRequested = false;
+
+        status = pal_osThreadCreateWithAlloc(palTimerThread, &s_palTimerThreadContext, PAL_osPriorityReservedHighResTimer,
+                                                PAL_RTOS_HIGH_RES_TIMER_THREAD_STACK_SIZE, NULL, &s_palHighResTimerThreadID);
+
+        if (status == PAL_SUCCESS) {
+
+            // the timer thread will signal on semaphore when it has started
+            pal_osSemaphoreWait(s_palTimerThreadContext.startStopSemaphore, PAL_RTOS_WAIT_FOREVER, NULL);
+
+        } else {
+            // cleanup the semaphore
+            pal_osSemaphoreDelete(&s_palTimerThreadContext.startStopSemaphore);
+        }
+    }
+
+    if (status != PAL_SUCCESS) {
+        close(g_timerFd);
+        g_timerFd = -1;
+    }
+
+    return status;
+}
+
+PAL_PRIVATE palStatus_t stopTimerThread()
+{
+    palStatus_t status;
+
+    status = pal_osMutexWait(g_timerListMutex, PAL_RTOS_WAIT_FOREVER);
+
+    if (status == PAL_SUCCESS) {
+
+        // set the flag to end the thread and wake it up
+        s_palTimerThreadContext.threadStopRequested = true;
+        timerFdUpdate();
+
+        (void)pal_osMutexRelease(g_timerListMutex);
+
+        // wait for for acknowledgement that timer thread is going down
+        pal_osSemaphoreWait(s_palTimerThreadContext.startStopSemaphore, PAL_RTOS_WAIT_FOREVER, NULL);
+
+        pal_osSemaphoreDelete(&s_palTimerThreadContext.startStopSemaphore);
+
+        // and clean up the thread
+        status = pal_osThreadTerminate(&s_palHighResTimerThreadID);
+
+        close(g_timerFd);
+        g_timerFd = -1;
+
+        // the timers themselves are owned by their creators
+        free(g_timerHeap);
+        g_timerHeap = NULL;
+        g_timerHeapCount = 0;
+        g_timerHeapCapacity = 0;
+    }
+    return status;
+}
+
+/*! Create a timer.
+ *
+ * @param[in] function A function pointer to the timer callback function.
+ * @param[in] funcArgument An argument for the timer callback function.
+ * @param[in] timerType The timer type to be created, periodic or oneShot.
+ * @param[out] timerID The ID of the created timer, zero value indicates an error.
+ *
+ * \return PAL_SUCCESS when the timer was created successfully. A specific error in case of failure.
+ */
+palStatus_t pal_plat_osTimerCreate(palTimerFuncPtr function, void* funcArgument,
+        palTimerType_t timerType, palTimerID_t* timerID)
+{
+    struct palTimerInfo* timerInfo = NULL;
+
+    if ((NULL == timerID) || (NULL == (void*) function))
+    {
+        return PAL_ERR_INVALID_ARGUMENT;
+    }
+
+    // the timer is not known by the timer thread until it is started
+    timerInfo = (struct palTimerInfo*) malloc(sizeof(struct palTimerInfo));
+    if (NULL == timerInfo)
+    {
+        return PAL_ERR_NO_MEMORY;
+    }
+
+    timerInfo->function = function;
+    timerInfo->funcArgs = funcArgument;
+    timerInfo->timerType = timerType;
+    timerInfo->deadline = 0;
+    timerInfo->period = 0;
+    timerInfo->heapIndex = PAL_TIMER_NOT_ARMED;
+
+    *timerID = (palTimerID_t) timerInfo;
+    return PAL_SUCCESS;
+}
+
+/*! Start or restart a timer.
+ *
+ * @param[in] timerID The handle for the timer to start.
+ * @param[in] millisec The time in milliseconds to set the timer to.
+ *
+ * \return The status in the form of palStatus_t; PAL_SUCCESS(0) in case of success, a negative value indicating a specific error code in case of failure.
+ */
+palStatus_t pal_plat_osTimerStart(palTimerID_t timerID, uint32_t millisec)
+{
+    palStatus_t status = PAL_SUCCESS;
+    if (NULL == (struct palTimerInfo *) timerID)
+    {
+        return PAL_ERR_INVALID_ARGUMENT;
+    }
+
+    struct palTimerInfo* timerInfo = (struct palTimerInfo *) timerID;
+
+    pal_osMutexWait(g_timerListMutex, PAL_RTOS_WAIT_FOREVER);
+
+    timerInfo->deadline = timerNow() + ((uint64_t)millisec * PAL_NANO_PER_MILLI);
+    timerInfo->period = (uint64_t)millisec * PAL_NANO_PER_MILLI;
+
+    if (PAL_TIMER_NOT_ARMED == timerInfo->heapIndex) {
+        status = timerHeapInsert(timerInfo);
+    } else {
+        // restart, the deadline may move either way
+        timerHeapSiftUp(timerInfo->heapIndex);
+        timerHeapSiftDown(timerInfo->heapIndex);
+    }
+
+    timerFdUpdate();
+
+    (void)pal_osMutexRelease(g_timerListMutex);
+
+    return status;
+}
+
+/*! Stop a timer.
+ *
+ * @param[in] timerID The handle for the timer to stop.
+ *
+ * \return The status in the form of palStatus_t; PAL_SUCCESS(0) in case of success, a negative value indicating a specific error code in case of failure.
+ */
+palStatus_t pal_plat_osTimerStop(palTimerID_t timerID)
+{
+    if (NULL == (struct palTimerInfo *) timerID)
+    {
+        return PAL_ERR_INVALID_ARGUMENT;
+    }
+
+    struct palTimerInfo* timerInfo = (struct palTimerInfo *) timerID;
+
+    pal_osMutexWait(g_timerListMutex, PAL_RTOS_WAIT_FOREVER);
+
+    if (PAL_TIMER_NOT_ARMED != timerInfo->heapIndex) {
+        timerHeapRemove(timerInfo);
+        timerFdUpdate();
+    }
+
+    (void)pal_osMutexRelease(g_timerListMutex);
+
+    return PAL_SUCCESS;
+}
+
+/*! Delete the timer object
+ *
+ * @param[inout] timerID The handle for the timer to delete. In success, *timerID = NULL.
+ *
+ * \return PAL_SUCCESS when the timer was deleted successfully, PAL_ERR_RTOS_PARAMETER when the timerID is incorrect.
+ */
+palStatus_t pal_plat_osTimerDelete(palTimerID_t* timerID)
+{
+    if ((NULL == timerID) || ((struct palTimerInfo *)*timerID == NULL)) {
+        return PAL_ERR_INVALID_ARGUMENT;
+    }
+    struct palTimerInfo* timerInfo = (struct palTimerInfo *) *timerID;
+
+    // the heap of timers is protected by a mutex to avoid concurrency issues
+    pal_osMutexWait(g_timerListMutex, PAL_RTOS_WAIT_FOREVER);
+
+    if (PAL_TIMER_NOT_ARMED != timerInfo->heapIndex) {
+        timerHeapRemove(timerInfo);
+        timerFdUpdate();
+    }
+
+    (void)pal_osMutexRelease(g_timerListMutex);
+
+    free(timerInfo);
+    *timerID = (palTimerID_t) NULL;
+
+    return PAL_SUCCESS;
+}
+
+#else // PAL_RTOS_TIMERFD_TIMERS
+
+
 /*
 * Thread for handling the signals from all timers by calling the attached callback
 */
@@ -764,6 +1358,299 @@ palStatus_t pal_plat_osTimerDelete(palTimerID_t* timerID)
     return status;
 }
 
+#endif // PAL_RTOS_TIMERFD_TIMERS
+
+#if PAL_RTOS_FUTEX_SYNC
+
+/*
+ * Mutexes and semaphores built on an atomic word and a futex. Taking a free mutex
+ * or an available semaphore token is one atomic operation, the kernel is entered
+ * only to sleep on contention or to wake a sleeping thread. Timed waits read the
+ * clock only when they have to sleep.
+ */
+
+typedef struct palFutexMutex
+{
+    int32_t state;          // 0 unlocked, 1 locked, 2 locked with possible sleepers
+    pthread_t owner;        // valid while locked, only compared against the calling thread
+    uint32_t recursion;     // written by the owner only
+} palFutexMutex_t;
+
+typedef struct palFutexSemaphore
+{
+    int32_t count;          // available tokens
+    int32_t sleepers;       // threads sleeping or about to sleep on count
+} palFutexSemaphore_t;
+
+// wait while *address == value, until woken or the absolute CLOCK_MONOTONIC deadline passes (NULL waits forever)
+PAL_PRIVATE int palFutexWait(int32_t* address, int32_t value, const struct timespec* deadline)
+{
+    if (-1 == syscall(SYS_futex, address, FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG, value, deadline, NULL, FUTEX_BITSET_MATCH_ANY))
+    {
+        return errno;
+    }
+    return 0;
+}
+
+PAL_PRIVATE void palFutexWake(int32_t* address)
+{
+    syscall(SYS_futex, address, FUTEX_WAKE | FUTEX_PRIVATE_FLAG, 1, NULL, NULL, 0);
+}
+
+PAL_PRIVATE void palFutexDeadline(uint32_t millisec, struct timespec* deadline)
+{
+    clock_gettime(CLOCK_MONOTONIC, deadline);
+    deadline->tv_sec += millisec / PAL_MILLI_PER_SECOND;
+    deadline->tv_nsec += PAL_MILLI_TO_NANO(millisec);
+    deadline->tv_sec += deadline->tv_nsec / PAL_NANO_PER_SECOND;
+    deadline->tv_nsec = deadline->tv_nsec % PAL_NANO_PER_SECOND;
+}
+
+PAL_PRIVATE bool palFutexMutexTryLock(palFutexMutex_t* mutex)
+{
+    int32_t unlocked = 0;
+    return __atomic_compare_exchange_n(&mutex->state, &unlocked, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+palStatus_t pal_plat_osMutexCreate(palMutexID_t* mutexID)
+{
+    if (NULL == mutexID)
+    {
+        return PAL_ERR_INVALID_ARGUMENT;
+    }
+
+    palFutexMutex_t* mutex = calloc(1, sizeof(palFutexMutex_t));
+    if (NULL == mutex)
+    {
+        return PAL_ERR_NO_MEMORY;
+    }
+    *mutexID = (palMutexID_t) mutex;
+    return PAL_SUCCESS;
+}
+
+palStatus_t pal_plat_osMutexWait(palMutexID_t mutexID, uint32_t millisec)
+{
+    palFutexMutex_t* mutex = (palFutexMutex_t*) mutexID;
+    if (NULL == mutex)
+    {
+        return PAL_ERR_INVALID_ARGUMENT;
+    }
+
+    pthread_t self = pthread_self();
+    if ((0 != __atomic_load_n(&mutex->state, __ATOMIC_RELAXED)) && pthread_equal(mutex->owner, self))
+    {
+        // the mutexes are recursive, only the owner can see itself as owner here
+        mutex->recursion++;
+        return PAL_SUCCESS;
+    }
+
+    if (!palFutexMutexTryLock(mutex))
+    {
+        // the mutexes are held for short sections, so spin for a while before sleeping
+        uint32_t spin;
+        for (spin = 0; spin < PAL_RTOS_MUTEX_SPIN_COUNT; spin++)
+        {
+            if ((0 == __atomic_load_n(&mutex->state, __ATOMIC_RELAXED)) && palFutexMutexTryLock(mutex))
+            {
+                break;
+            }
+        }
+
+        if (PAL_RTOS_MUTEX_SPIN_COUNT == spin)
+        {
+            struct timespec deadline;
+            if (PAL_RTOS_WAIT_FOREVER != millisec)
+            {
+                palFutexDeadline(millisec, &deadline);
+            }
+            // marking the mutex contended makes the owner wake a sleeper when releasing it
+            while (0 != __atomic_exchange_n(&mutex->state, 2, __ATOMIC_ACQUIRE))
+            {
+                int err = palFutexWait(&mutex->state, 2, (PAL_RTOS_WAIT_FOREVER != millisec) ? &deadline : NULL);
+                if (ETIMEDOUT == err)
+                {
+                    return PAL_ERR_RTOS_TIMEOUT;
+                }
+            }
+        }
+    }
+
+    mutex->owner = self;
+    mutex->recursion = 1;
+    return PAL_SUCCESS;
+}
+
+palStatus_t pal_plat_osMutexRelease(palMutexID_t mutexID)
+{
+    palFutexMutex_t* mutex = (palFutexMutex_t*) mutexID;
+    if (NULL == mutex)
+    {
+        return PAL_ERR_INVALID_ARGUMENT;
+    }
+
+    if ((0 == __atomic_load_n(&mutex->state, __ATOMIC_RELAXED)) || !pthread_equal(mutex->owner, pthread_self()))
+    {
+        PAL_LOG_ERR("Rtos mutex release failure - not the owner");
+        return PAL_ERR_GENERIC_FAILURE;
+    }
+
+    if (--mutex->recursion > 0)
+    {
+        return PAL_SUCCESS;
+    }
+
+    if (2 == __atomic_exchange_n(&mutex->state, 0, __ATOMIC_RELEASE))
+    {
+        palFutexWake(&mutex->state);
+    }
+    return PAL_SUCCESS;
+}
+
+palStatus_t pal_plat_osMutexDelete(palMutexID_t* mutexID)
+{
+    if (NULL == mutexID)
+    {
+        return PAL_ERR_INVALID_ARGUMENT;
+    }
+    palFutexMutex_t* mutex = (palFutexMutex_t*) *mutexID;
+    if (NULL == mutex)
+    {
+        return PAL_ERR_RTOS_RESOURCE;
+    }
+
+    palStatus_t status = PAL_SUCCESS;
+    if (0 != __atomic_load_n(&mutex->state, __ATOMIC_RELAXED))
+    {
+        // same as pthread_mutex_destroy() on a locked mutex, but the mutex is freed regardless
+        PAL_LOG_ERR("pal_plat_osMutexDelete of a locked mutex");
+        status = PAL_ERR_RTOS_RESOURCE;
+    }
+    free(mutex);
+    *mutexID = (palMutexID_t) NULL;
+    return status;
+}
+
+palStatus_t pal_plat_osSemaphoreCreate(uint32_t count, palSemaphoreID_t* semaphoreID)
+{
+    if (NULL == semaphoreID)
+    {
+        return PAL_ERR_INVALID_ARGUMENT;
+    }
+    *semaphoreID = (palSemaphoreID_t) NULL;
+    if (count > INT32_MAX)
+    {
+        return PAL_ERR_INVALID_ARGUMENT;
+    }
+
+    palFutexSemaphore_t* semaphore = calloc(1, sizeof(palFutexSemaphore_t));
+    if (NULL == semaphore)
+    {
+        return PAL_ERR_NO_MEMORY;
+    }
+    semaphore->count = (int32_t) count;
+    *semaphoreID = (palSemaphoreID_t) semaphore;
+    return PAL_SUCCESS;
+}
+
+palStatus_t pal_plat_osSemaphoreWait(palSemaphoreID_t semaphoreID, uint32_t millisec, int32_t* countersAvailable)
+{
+    palStatus_t status = PAL_SUCCESS;
+    int32_t tmpCounters = 0;
+    palFutexSemaphore_t* sem = (palFutexSemaphore_t*) semaphoreID;
+    if (NULL == sem)
+    {
+        return PAL_ERR_INVALID_ARGUMENT;
+    }
+
+    bool deadlineSet = false;
+    struct timespec deadline;
+    int32_t count = __atomic_load_n(&sem->count, __ATOMIC_RELAXED);
+    for (;;)
+    {
+        if (count > 0)
+        {
+            if (__atomic_compare_exchange_n(&sem->count, &count, count - 1, true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            {
+                tmpCounters = count - 1;
+                break;
+            }
+            continue; // count was reloaded by the failed exchange
+        }
+
+        if (0 == millisec)
+        {
+            status = PAL_ERR_RTOS_TIMEOUT;
+            break;
+        }
+        if ((PAL_RTOS_WAIT_FOREVER != millisec) && !deadlineSet)
+        {
+            palFutexDeadline(millisec, &deadline);
+            deadlineSet = true;
+        }
+
+        // a release either sees the sleeper or makes the futex wait return at once
+        __atomic_add_fetch(&sem->sleepers, 1, __ATOMIC_SEQ_CST);
+        int err = palFutexWait(&sem->count, 0, deadlineSet ? &deadline : NULL);
+        __atomic_sub_fetch(&sem->sleepers, 1, __ATOMIC_SEQ_CST);
+
+        count = __atomic_load_n(&sem->count, __ATOMIC_RELAXED);
+        if ((ETIMEDOUT == err) && (count <= 0))
+        {
+            status = PAL_ERR_RTOS_TIMEOUT;
+            break;
+        }
+    }
+
+    if (NULL != countersAvailable)
+    {
+        *countersAvailable = tmpCounters;
+    }
+    return status;
+}
+
+palStatus_t pal_plat_osSemaphoreRelease(palSemaphoreID_t semaphoreID)
+{
+    palFutexSemaphore_t* sem = (palFutexSemaphore_t*) semaphoreID;
+    if (NULL == sem)
+    {
+        return PAL_ERR_INVALID_ARGUMENT;
+    }
+
+    int32_t count = __atomic_load_n(&sem->count, __ATOMIC_RELAXED);
+    do
+    {
+        if (INT32_MAX == count)
+        {
+            PAL_LOG_ERR("Rtos semaphore release error - max value exceeded");
+            return PAL_ERR_GENERIC_FAILURE;
+        }
+    } while (!__atomic_compare_exchange_n(&sem->count, &count, count + 1, true, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED));
+
+    if (0 != __atomic_load_n(&sem->sleepers, __ATOMIC_SEQ_CST))
+    {
+        palFutexWake(&sem->count);
+    }
+    return PAL_SUCCESS;
+}
+
+palStatus_t pal_plat_osSemaphoreDelete(palSemaphoreID_t* semaphoreID)
+{
+    if (NULL == semaphoreID)
+    {
+        return PAL_ERR_INVALID_ARGUMENT;
+    }
+    palFutexSemaphore_t* sem = (palFutexSemaphore_t*) *semaphoreID;
+    if (NULL == sem)
+    {
+        return PAL_ERR_RTOS_RESOURCE;
+    }
+    free(sem);
+    *semaphoreID = (palSemaphoreID_t) NULL;
+    return PAL_SUCCESS;
+}
+
+#else // PAL_RTOS_FUTEX_SYNC
+
 /*! Create and initialize a mutex object.
  *
  * @param[out] mutexID The created mutex ID handle, zero value indicates an error.
@@ -1140,6 +2027,8 @@ palStatus_t pal_plat_osSemaphoreDelete(palSemaphoreID_t* semaphoreID)
     finish: return status;
 }
 
+#endif // PAL_RTOS_FUTEX_SYNC
+
 /*! Perform an atomic increment for a signed32 bit value.
  *
  * @param[in,out] valuePtr The address of the value to increment.
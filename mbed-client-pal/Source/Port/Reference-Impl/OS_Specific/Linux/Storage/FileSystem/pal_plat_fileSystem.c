@@ -26,6 +26,7 @@
 #include <dirent.h>
 #include <stdlib.h>
 #include <fcntl.h>
+#include <sys/mman.h>
 
 
 
@@ -58,6 +59,18 @@ PAL_PRIVATE const platOpenModeConvert_t g_platOpenModeConvert[] =
 PAL_PRIVATE const int g_platSeekWhenceConvert[] = {0, SEEK_SET, SEEK_CUR, SEEK_END};                //!< platform convert table for \b fseek() relative position modes
 
 
+/*! \brief An open file. A file opened read only is mapped to memory, and read and seeked in the mapping
+ *  without system calls. Other files are read and written through a stdio stream.
+ */
+typedef struct palPlatFile
+{
+    FILE *stream;           //!< NULL for a mapped file
+    const uint8_t *map;     //!< mapping of a file opened read only
+    size_t mapSize;         //!< size of the file when it was opened
+    size_t pos;             //!< position in the mapping
+} palPlatFile_t;
+
+
 
 /*! \brief This function find the next file in a directory
  *
@@ -106,6 +119,16 @@ PAL_PRIVATE palStatus_t pal_plat_addFileNameToPath(const char *pathName, const c
 */
 PAL_PRIVATE palStatus_t pal_plat_fsCpFile(const char *pathNameSrc,  char *pathNameDest, char * fileName);
 
+/*! \brief This function allocates the file descriptor of a stream
+*
+* @param[in]  stream - open stdio stream, closed on failure
+* @param[out] fd - file descriptor
+*
+* \return PAL_SUCCESS upon successful operation.\n
+*         PAL_ERR_NO_MEMORY - no memory for the descriptor
+*/
+PAL_PRIVATE palStatus_t pal_plat_fsStreamToFd(FILE *stream, palFileDescriptor_t *fd);
+
 palStatus_t pal_plat_fsMkdir(const char *pathName)
 {
     palStatus_t ret = PAL_SUCCESS;
@@ -139,10 +162,28 @@ palStatus_t pal_plat_fsRmdir(const char *pathName)
 }
 
 
+PAL_PRIVATE palStatus_t pal_plat_fsStreamToFd(FILE *stream, palFileDescriptor_t *fd)
+{
+    palPlatFile_t *file = (palPlatFile_t *)pal_plat_malloc(sizeof(palPlatFile_t));
+    if (file == NULL)
+    {
+        fclose(stream);
+        return PAL_ERR_NO_MEMORY;
+    }
+    file->stream = stream;
+    file->map = NULL;
+    file->mapSize = 0;
+    file->pos = 0;
+    *fd = (palFileDescriptor_t)file;
+    return PAL_SUCCESS;
+}
+
+
 palStatus_t pal_plat_fsFopen(const char *pathName, pal_fsFileMode_t mode, palFileDescriptor_t *fd)
 {
     palStatus_t ret = PAL_SUCCESS;
     int fDesc;
+    FILE *stream;
 
     fDesc = open(pathName, g_platOpenModeConvert[mode].flags | O_SYNC, 0666); //same permissions as for fopen()
     if (fDesc < 0)
@@ -150,22 +191,63 @@ palStatus_t pal_plat_fsFopen(const char *pathName, pal_fsFileMode_t mode, palFil
         return pal_plat_errorTranslation(errno);
     } 
 
-    *fd = (palFileDescriptor_t)fdopen(fDesc, g_platOpenModeConvert[mode].mode);
-    if ((*fd) == NULLPTR)
+#if PAL_FS_MMAP_MAX_FILE_SIZE
+    // Files opened for reading only are small, often read in parts and seeked around in.
+    // Map them so that reads and seeks do not need system calls.
+    struct stat fileStat;
+    if ((mode == PAL_FS_FLAG_READONLY) && (fstat(fDesc, &fileStat) == 0) && S_ISREG(fileStat.st_mode) &&
+        (fileStat.st_size > 0) && (fileStat.st_size <= PAL_FS_MMAP_MAX_FILE_SIZE))
+    {
+        void *map = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_SHARED, fDesc, 0);
+        if (map != MAP_FAILED)
+        {
+            palPlatFile_t *file = (palPlatFile_t *)pal_plat_malloc(sizeof(palPlatFile_t));
+            if (file == NULL)
+            {
+                munmap(map, (size_t)fileStat.st_size);
+                close(fDesc);
+                return PAL_ERR_NO_MEMORY;
+            }
+            // The mapping stays valid after the descriptor is closed
+            close(fDesc);
+            file->stream = NULL;
+            file->map = (const uint8_t *)map;
+            file->mapSize = (size_t)fileStat.st_size;
+            file->pos = 0;
+            *fd = (palFileDescriptor_t)file;
+            return PAL_SUCCESS;
+        }
+    }
+#endif
+
+    stream = fdopen(fDesc, g_platOpenModeConvert[mode].mode);
+    if (stream == NULLPTR)
     {
         ret = pal_plat_errorTranslation(errno);
+        close(fDesc);
+        return ret;
     }
-    return ret;
+    return pal_plat_fsStreamToFd(stream, fd);
 }
 
 
 palStatus_t pal_plat_fsFclose(palFileDescriptor_t *fd)
 {
     palStatus_t ret = PAL_SUCCESS;
-    if (fclose((FILE *)*fd))
+    palPlatFile_t *file = (palPlatFile_t *)*fd;
+
+    if (file->stream == NULL)
+    {
+        if (munmap((void *)file->map, file->mapSize))
+        {
+            ret = pal_plat_errorTranslation(errno);
+        }
+    }
+    else if (fclose(file->stream))
     {
         ret = pal_plat_errorTranslation(errno);
     }
+    pal_plat_free(file);
 
     return ret;
 }
@@ -174,14 +256,25 @@ palStatus_t pal_plat_fsFclose(palFileDescriptor_t *fd)
 palStatus_t pal_plat_fsFread(palFileDescriptor_t *fd, void * buffer, size_t numOfBytes, size_t *numberOfBytesRead)
 {
     palStatus_t ret = PAL_SUCCESS;
-    *numberOfBytesRead = fread(buffer, 1, numOfBytes, (FILE *)*fd);
+    palPlatFile_t *file = (palPlatFile_t *)*fd;
+
+    if (file->stream == NULL)
+    {
+        size_t available = (file->pos < file->mapSize) ? (file->mapSize - file->pos) : 0;
+        *numberOfBytesRead = PAL_MIN(numOfBytes, available);
+        memcpy(buffer, file->map + file->pos, *numberOfBytesRead);
+        file->pos += *numberOfBytesRead;
+        return ret;
+    }
+
+    *numberOfBytesRead = fread(buffer, 1, numOfBytes, file->stream);
     if (*numberOfBytesRead != numOfBytes)
     {
-        if (ferror((FILE *)*fd))
+        if (ferror(file->stream))
         {
             ret = PAL_ERR_FS_ERROR;
         }
-        clearerr((FILE *)*fd);
+        clearerr(file->stream);
     }
     return ret;
 }
@@ -190,7 +283,16 @@ palStatus_t pal_plat_fsFread(palFileDescriptor_t *fd, void * buffer, size_t numO
 palStatus_t pal_plat_fsFwrite(palFileDescriptor_t *fd, const void *buffer, size_t numOfBytes, size_t *numberOfBytesWritten)
 {
     palStatus_t ret = PAL_SUCCESS;
-    *numberOfBytesWritten = fwrite(buffer, 1, numOfBytes, (FILE *)*fd);
+    palPlatFile_t *file = (palPlatFile_t *)*fd;
+
+    if (file->stream == NULL)
+    {
+        // Opened for reading only
+        *numberOfBytesWritten = 0;
+        return PAL_ERR_FS_ACCESS_DENIED;
+    }
+
+    *numberOfBytesWritten = fwrite(buffer, 1, numOfBytes, file->stream);
     errno = 0;
     if (*numberOfBytesWritten != numOfBytes)
     {
@@ -207,7 +309,28 @@ palStatus_t pal_plat_fsFwrite(palFileDescriptor_t *fd, const void *buffer, size_
 palStatus_t pal_plat_fsFseek(palFileDescriptor_t *fd, off_t offset, pal_fsOffset_t whence)
 {
     palStatus_t ret = PAL_SUCCESS;
-    if (fseek((FILE *)*fd, offset, g_platSeekWhenceConvert[whence]))
+    palPlatFile_t *file = (palPlatFile_t *)*fd;
+
+    if (file->stream == NULL)
+    {
+        off_t base = 0;
+        if (whence == PAL_FS_OFFSET_SEEKCUR)
+        {
+            base = (off_t)file->pos;
+        }
+        else if (whence == PAL_FS_OFFSET_SEEKEND)
+        {
+            base = (off_t)file->mapSize;
+        }
+        if (base + offset < 0)
+        {
+            return pal_plat_errorTranslation(EINVAL);
+        }
+        file->pos = (size_t)(base + offset);
+        return ret;
+    }
+
+    if (fseek(file->stream, offset, g_platSeekWhenceConvert[whence]))
     {
         ret = pal_plat_errorTranslation(errno);
     }
@@ -219,8 +342,16 @@ palStatus_t pal_plat_fsFtell(palFileDescriptor_t *fd, off_t * pos)
 {
     palStatus_t ret = PAL_SUCCESS;
     long retPos = 0;
+    palPlatFile_t *file = (palPlatFile_t *)*fd;
     *pos = 0;
-    retPos = ftell((FILE *)*fd);
+
+    if (file->stream == NULL)
+    {
+        *pos = (off_t)file->pos;
+        return ret;
+    }
+
+    retPos = ftell(file->stream);
     if (retPos < 0)
     {
         ret = pal_plat_errorTranslation(errno);
@@ -358,14 +489,15 @@ PAL_PRIVATE palStatus_t pal_plat_fsCpFile(const char *pathNameSrc,  char *pathNa
     palStatus_t ret = PAL_SUCCESS;
     palFileDescriptor_t src_fd = 0;
     palFileDescriptor_t dst_fd = 0;
+    FILE *stream;
     char buffer_name[PAL_MAX_FILE_AND_FOLDER_LENGTH] = {0}; //Buffer for coping the name and folder
     char * buffer = NULL;
     size_t bytesCount = 0;
 
     //Add file name to path
     pal_plat_addFileNameToPath(pathNameSrc, fileName, buffer_name, sizeof(buffer_name));
-    src_fd = (palFileDescriptor_t)fopen(buffer_name, g_platOpenModeConvert[PAL_FS_FLAG_READONLY].mode);
-    if (src_fd == 0)
+    stream = fopen(buffer_name, g_platOpenModeConvert[PAL_FS_FLAG_READONLY].mode);
+    if (stream == NULL)
     {
         ret = pal_plat_errorTranslation(errno);
         if (ret == PAL_SUCCESS)
@@ -373,12 +505,12 @@ PAL_PRIVATE palStatus_t pal_plat_fsCpFile(const char *pathNameSrc,  char *pathNa
             ret = PAL_ERR_FS_ERROR;
         }
     }
-    else
+    else if ((ret = pal_plat_fsStreamToFd(stream, &src_fd)) == PAL_SUCCESS)
     {
         //Add file name to path
         pal_plat_addFileNameToPath(pathNameDest, fileName, buffer_name, sizeof(buffer_name));
-        dst_fd = (palFileDescriptor_t)fopen(buffer_name, g_platOpenModeConvert[PAL_FS_FLAG_READWRITETRUNC].mode);
-        if (dst_fd == 0)
+        stream = fopen(buffer_name, g_platOpenModeConvert[PAL_FS_FLAG_READWRITETRUNC].mode);
+        if (stream == NULL)
         {
             ret = pal_plat_errorTranslation(errno);
             if (ret == PAL_SUCCESS)
@@ -386,7 +518,7 @@ PAL_PRIVATE palStatus_t pal_plat_fsCpFile(const char *pathNameSrc,  char *pathNa
                 ret = PAL_ERR_FS_ERROR;
             }
         }
-        else
+        else if ((ret = pal_plat_fsStreamToFd(stream, &dst_fd)) == PAL_SUCCESS)
         {
             buffer = (char*)pal_plat_malloc(PAL_FS_COPY_BUFFER_SIZE);
             if (!buffer)
@@ -355,6 +355,13 @@ palThreadID_t pal_plat_osThreadGetId(void)
     return threadID;
 }
 
+palStatus_t pal_plat_osThreadStatsGet(palThreadID_t threadID, palThreadStats_t* stats)
+{
+    (void)threadID;
+    (void)stats;
+    return PAL_ERR_NOT_SUPPORTED;
+}
+
 palStatus_t pal_plat_osThreadTerminate(palThreadID_t* threadID)
 {
     palStatus_t status = PAL_ERR_RTOS_TASK;
@@ -613,6 +613,168 @@ palStatus_t pal_plat_receiveFrom(palSocket_t handle, void* buffer, size_t length
     return result;
 }
 
+#if PAL_NET_DATAGRAM_BATCH_SUPPORT
+
+palStatus_t pal_plat_receiveFromBatch(palSocket_t handle, palDatagram_t* datagrams, uint32_t count, uint32_t* received)
+{
+    DEBUG_DEBUG("pal_plat_receiveFromBatch");
+
+    palStatus_t result = PAL_ERR_INVALID_ARGUMENT;
+
+    if (handle && datagrams && received) {
+
+        pal_socket_t* pointer = (pal_socket_t*) handle;
+        uint32_t index = 0;
+
+        result = PAL_SUCCESS;
+
+        for (index = 0; index < count; index++) {
+
+            palDatagram_t* datagram = &datagrams[index];
+            struct sockaddr address = { 0 };
+            socklen_t addrlen = sizeof(struct sockaddr);
+
+            /* only the first datagram may block, the rest are the ones already queued */
+            ssize_t retval = recvfrom(pointer->fd, datagram->buffer, datagram->length,
+                                      (index > 0) ? MSG_DONTWAIT : 0, &address, &addrlen);
+
+            if (retval == -1) {
+
+                /* datagrams received so far are reported as a success,
+                 * the error is returned on the next call.
+                 */
+                if (index == 0) {
+                    switch (errno) {
+                        case EWOULDBLOCK:
+                            result = PAL_ERR_SOCKET_WOULD_BLOCK;
+                            break;
+
+                        default:
+                            result = PAL_ERR_SOCKET_GENERIC;
+                            break;
+                    }
+                }
+                break;
+            }
+
+            datagram->bytesTransferred = retval;
+
+            if (datagram->address) {
+
+                /* convert Zephyr address to PAL address */
+#if PAL_SUPPORT_IP_V4
+                /* FIXME: pal_getSockAddrPort is returning wrong endian, use htons workaround */
+                net_sin(&address)->sin_port = htons(net_sin(&address)->sin_port);
+
+                pal_setSockAddrPort(datagram->address, net_sin(&address)->sin_port);
+                pal_setSockAddrIPV4Addr(datagram->address, net_sin(&address)->sin_addr.s4_addr);
+#else
+                /* FIXME: pal_getSockAddrPort is returning wrong endian, use htons workaround */
+                net_sin6(&address)->sin6_port = htons(net_sin6(&address)->sin6_port);
+
+                pal_setSockAddrPort(datagram->address, net_sin6(&address)->sin6_port);
+                pal_setSockAddrIPV6Addr(datagram->address, net_sin6(&address)->sin6_addr.s6_addr);
+#endif
+                datagram->addressLength = sizeof(palSocketAddress_t);
+            }
+        }
+
+        /* invoke callback when more data is available to read, once for the whole batch */
+        fd_work_poll_submit(&pointer->workin, &pointer->pollin, 1, K_FOREVER);
+
+        *received = index;
+    }
+
+    return result;
+}
+
+palStatus_t pal_plat_sendToBatch(palSocket_t handle, palDatagram_t* datagrams, uint32_t count, uint32_t* sent)
+{
+    DEBUG_DEBUG("pal_plat_sendToBatch");
+
+    palStatus_t result = PAL_ERR_INVALID_ARGUMENT;
+
+    if (handle && datagrams && sent) {
+
+        pal_socket_t* pointer = (pal_socket_t*) handle;
+        uint32_t index = 0;
+
+        result = PAL_SUCCESS;
+
+        for (index = 0; index < count; index++) {
+
+            palDatagram_t* datagram = &datagrams[index];
+
+            if (!datagram->address) {
+                if (index == 0) {
+                    result = PAL_ERR_INVALID_ARGUMENT;
+                }
+                break;
+            }
+
+            /* convert PAL address to Zephyr address */
+#if PAL_SUPPORT_IP_V4
+            struct sockaddr_in address = { 0 };
+            socklen_t addrlen = sizeof(struct sockaddr_in);
+
+            address.sin_family = AF_INET;
+            pal_getSockAddrPort(datagram->address, &address.sin_port);
+            pal_getSockAddrIPV4Addr(datagram->address, address.sin_addr.s4_addr);
+
+            /* FIXME: pal_getSockAddrPort is returning wrong endian, use htons workaround */
+            address.sin_port = htons(address.sin_port);
+#else
+            struct sockaddr_in6 address = { 0 };
+            socklen_t addrlen = sizeof(struct sockaddr_in6);
+
+            address.sin6_family = AF_INET6;
+            pal_getSockAddrPort(datagram->address, &address.sin6_port);
+            pal_getSockAddrIPV6Addr(datagram->address, address.sin6_addr.s6_addr);
+
+            /* FIXME: pal_getSockAddrPort is returning wrong endian, use htons workaround */
+            address.sin6_port = htons(address.sin6_port);
+#endif
+
+            ssize_t retval = sendto(pointer->fd, datagram->buffer, datagram->length, 0, (struct sockaddr*) &address, addrlen);
+
+            if (retval == -1) {
+
+                /* datagrams sent so far are reported as a success,
+                 * the error is returned on the next call.
+                 */
+                if (index == 0) {
+                    switch (errno) {
+                        case ENOBUFS:
+                        case ENOMEM:
+                            result = PAL_ERR_NO_MEMORY;
+                            break;
+
+                        case EWOULDBLOCK:
+                            result = PAL_ERR_SOCKET_WOULD_BLOCK;
+                            break;
+
+                        default:
+                            result = PAL_ERR_SOCKET_GENERIC;
+                            break;
+                    }
+                }
+                break;
+            }
+
+            datagram->bytesTransferred = retval;
+        }
+
+        /* provide callback for when more data can be sent, once for the whole batch */
+        fd_work_poll_submit(&pointer->workout, &pointer->pollout, 1, K_FOREVER);
+
+        *sent = index;
+    }
+
+    return result;
+}
+
+#endif // PAL_NET_DATAGRAM_BATCH_SUPPORT
+
 palStatus_t pal_plat_close(palSocket_t* handle)
 {
     DEBUG_DEBUG("pal_plat_close");
@@ -163,6 +163,13 @@ palThreadID_t pal_plat_osThreadGetId(void)
     return (palThreadID_t) k_current_get();
 }
 
+palStatus_t pal_plat_osThreadStatsGet(palThreadID_t threadID, palThreadStats_t* stats)
+{
+    (void)threadID;
+    (void)stats;
+    return PAL_ERR_NOT_SUPPORTED;
+}
+
 
 palStatus_t pal_plat_osDelay(uint32_t milliseconds)
 {
@@ -37,6 +37,8 @@
 
 #define PAL_THREAD_NAME_MAX_LEN 20 // max len for thread name which holds the pointer (as string) to dynamically allocated thread data
 #define PAL_THREAD_STACK_ALIGN(x) ((x % sizeof(uint64_t)) ? (x + ((sizeof(uint64_t)) - (x % sizeof(uint64_t)))) : x)
+// stack words not yet used by a thread hold this value, the same as RTX uses for its stack watermark
+#define PAL_THREAD_STACK_PAINT 0xCCCCCCCCU
 
 typedef struct palThreadData 
 {
@@ -323,6 +325,7 @@ palStatus_t pal_plat_osThreadCreate(palThreadFuncPtr function, void* funcArgumen
         goto clean;
     }
 
+    memset(threadStack, (uint8_t)PAL_THREAD_STACK_PAINT, stackSize); // for pal_plat_osThreadStatsGet()
     memset(&(threadData->threadStore), 0, sizeof(threadData->threadStore));
     threadData->threadAttr.priority = threadPriority;
     threadData->threadAttr.stack_size = stackSize;
@@ -412,6 +415,50 @@ end:
     return status;
 }
 
+palStatus_t pal_plat_osThreadStatsGet(palThreadID_t threadID, palThreadStats_t* stats)
+{
+    palStatus_t status;
+    palThreadData_t* threadData = NULL;
+    osThreadId_t sysThreadID = (osThreadId_t)threadID;
+    osThreadState_t threadState;
+    const char* threadName;
+    const uint32_t* word;
+    const uint32_t* end;
+
+    status = pal_osMutexWait(g_threadsMutex, PAL_RTOS_WAIT_FOREVER); // the thread data is released under the mutex
+    if (PAL_SUCCESS != status)
+    {
+        PAL_LOG_ERR("thread stats mutex wait failed\n");
+        goto end;
+    }
+
+    status = PAL_ERR_RTOS_PARAMETER;
+    threadState = osThreadGetState(sysThreadID);
+    threadName = osThreadGetName(sysThreadID);
+    if ((osThreadTerminated != threadState) && (osThreadInactive != threadState) && (osThreadError != threadState) &&
+        (NULL != threadName) && (1 == sscanf(threadName, "%p", &threadData))) // the name is cleared when the thread function returns
+    {
+        // the first word holds the RTX stack overflow marker
+        word = (const uint32_t*)threadData->threadAttr.stack_mem + 1;
+        end = (const uint32_t*)threadData->threadAttr.stack_mem + (threadData->threadAttr.stack_size / sizeof(uint32_t));
+        while ((word < end) && (PAL_THREAD_STACK_PAINT == *word))
+        {
+            word++;
+        }
+        stats->stackSize = threadData->threadAttr.stack_size;
+        stats->stackHighWater = (uint32_t)((const uint8_t*)end - (const uint8_t*)word);
+        // RTX keeps no CPU time or context switch counts per thread
+        status = PAL_SUCCESS;
+    }
+
+    if (PAL_SUCCESS != pal_osMutexRelease(g_threadsMutex))
+    {
+        PAL_LOG_ERR("thread stats mutex release failed\n");
+    }
+end:
+    return status;
+}
+
 palStatus_t pal_plat_osTimerCreate(palTimerFuncPtr function, void* funcArgument, palTimerType_t timerType, palTimerID_t* timerID)
 {
     palStatus_t status = PAL_SUCCESS;
@@ -1558,6 +1558,10 @@ TEST(pal_socket, socketApiInputParamValidation)
     TEST_ASSERT_EQUAL_HEX(PAL_ERR_INVALID_ARGUMENT, status);
     status = pal_sendTo(NULL, NULL, 0, NULL, 0, NULL);
     TEST_ASSERT_EQUAL_HEX(PAL_ERR_INVALID_ARGUMENT, status);
+    status = pal_receiveFromBatch(NULL, NULL, 0, NULL);
+    TEST_ASSERT_EQUAL_HEX(PAL_ERR_INVALID_ARGUMENT, status);
+    status = pal_sendToBatch(NULL, NULL, 0, NULL);
+    TEST_ASSERT_EQUAL_HEX(PAL_ERR_INVALID_ARGUMENT, status);
     status = pal_close(NULL);
     TEST_ASSERT_EQUAL_HEX(PAL_ERR_INVALID_ARGUMENT, status);
     status = pal_getNumberOfNetInterfaces(NULL);
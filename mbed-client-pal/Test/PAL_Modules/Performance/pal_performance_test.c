@@ -0,0 +1,411 @@
+/*******************************************************************************
+ * Copyright 2021 Pelion.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+// Needed for PRIu32 on FreeRTOS
+#include <stdio.h>
+
+#include "pal.h"
+#include "unity.h"
+#include "unity_fixture.h"
+#include "test_runners.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+#define TRACE_GROUP "PAL"
+
+/*
+ * Performance measurements of a PAL port. The tests only fail if the PAL calls fail,
+ * the numbers are printed one per line in the same format on every port:
+ *
+ *     PAL_PERF <metric> <value> <unit>
+ *
+ * so the output of different ports and releases can be compared with a simple diff or script.
+ */
+
+#define PAL_PERF_MUTEX_ROUNDS           10000
+#define PAL_PERF_SEMAPHORE_ROUNDS       1000
+#define PAL_PERF_TIMER_SAMPLES          20
+#define PAL_PERF_UDP_DATAGRAMS          200
+#define PAL_PERF_UDP_DATAGRAM_SIZE      512
+#define PAL_PERF_UDP_PORT               50300
+#define PAL_PERF_FILE_ROUNDS            20
+#define PAL_PERF_FILE_SIZE              4096
+#define PAL_PERF_FILE_NAME              "/perf.bin"
+
+#define PAL_PERF_REPORT(metric, value, unit) perfReport(metric, (uint32_t)(value), unit)
+
+TEST_GROUP(pal_performance);
+
+static palSemaphoreID_t g_perfPing = NULLPTR;
+static palSemaphoreID_t g_perfPong = NULLPTR;
+static palSemaphoreID_t g_perfTimerDone = NULLPTR;
+static palSemaphoreID_t g_perfSocketEvent = NULLPTR;
+
+// Written from the timer callback
+static volatile uint64_t g_perfTimerTicks[PAL_PERF_TIMER_SAMPLES];
+static volatile uint32_t g_perfTimerCount = 0;
+
+static uint8_t g_perfBuffer[PAL_PERF_FILE_SIZE];
+
+TEST_SETUP(pal_performance)
+{
+    palStatus_t status = pal_init();
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+}
+
+TEST_TEAR_DOWN(pal_performance)
+{
+    if (g_perfPing) {
+        pal_osSemaphoreDelete(&g_perfPing);
+    }
+    if (g_perfPong) {
+        pal_osSemaphoreDelete(&g_perfPong);
+    }
+    if (g_perfTimerDone) {
+        pal_osSemaphoreDelete(&g_perfTimerDone);
+    }
+    if (g_perfSocketEvent) {
+        pal_osSemaphoreDelete(&g_perfSocketEvent);
+    }
+    pal_destroy();
+}
+
+// Printed through Unity, so the results are in the test output also when PAL_PRINTF is compiled out
+static void perfReport(const char *metric, uint32_t value, const char *unit)
+{
+    char line[80];
+    snprintf(line, sizeof(line), "PAL_PERF %s %" PRIu32 " %s", metric, value, unit);
+    UnityPrint(line);
+    UNITY_PRINT_EOL();
+}
+
+static uint64_t perfTicksToUnits(uint64_t ticks, uint64_t unitsPerSecond)
+{
+    const uint64_t frequency = pal_osKernelSysTickFrequency();
+    // Split so that the multiplication does not overflow with a high tick frequency
+    return (ticks / frequency) * unitsPerSecond + (ticks % frequency) * unitsPerSecond / frequency;
+}
+
+static uint64_t perfTicksToMicroSec(uint64_t ticks)
+{
+    return perfTicksToUnits(ticks, 1000000);
+}
+
+/*! \brief Measures an uncontended mutex lock and unlock.
+*
+* | # |    Step                        |   Expected  |
+* |---|--------------------------------|-------------|
+* | 1 | Create a mutex using `pal_osMutexCreate`.                                  | PAL_SUCCESS |
+* | 2 | Lock and unlock it in a loop using `pal_osMutexWait` and `pal_osMutexRelease`. | PAL_SUCCESS |
+* | 3 | Report the time of one lock and unlock in nanoseconds.                     | |
+* | 4 | Delete the mutex using `pal_osMutexDelete`.                                | PAL_SUCCESS |
+*/
+TEST(pal_performance, MutexLockUnlock)
+{
+    palMutexID_t mutex = NULLPTR;
+    palStatus_t status;
+
+    /*#1*/
+    status = pal_osMutexCreate(&mutex);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+
+    /*#2*/
+    const uint64_t start = pal_osKernelSysTick();
+    for (int i = 0; i < PAL_PERF_MUTEX_ROUNDS; i++) {
+        status = pal_osMutexWait(mutex, PAL_RTOS_WAIT_FOREVER);
+        TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+        status = pal_osMutexRelease(mutex);
+        TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+    }
+    const uint64_t elapsed = pal_osKernelSysTick() - start;
+
+    /*#3*/
+    PAL_PERF_REPORT("mutex_lock_unlock", perfTicksToUnits(elapsed, 1000000000) / PAL_PERF_MUTEX_ROUNDS, "ns");
+
+    /*#4*/
+    status = pal_osMutexDelete(&mutex);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+}
+
+static void perfPongThread(void const *argument)
+{
+    int32_t count;
+    (void)argument;
+    for (int i = 0; i < PAL_PERF_SEMAPHORE_ROUNDS; i++) {
+        pal_osSemaphoreWait(g_perfPing, PAL_RTOS_WAIT_FOREVER, &count);
+        pal_osSemaphoreRelease(g_perfPong);
+    }
+}
+
+/*! \brief Measures the latency of waking up another thread with a semaphore.
+*
+* | # |    Step                        |   Expected  |
+* |---|--------------------------------|-------------|
+* | 1 | Create two semaphores using `pal_osSemaphoreCreate`.                              | PAL_SUCCESS |
+* | 2 | Create a thread which releases the second semaphore when it gets the first one.   | PAL_SUCCESS |
+* | 3 | Release the first semaphore and wait for the second in a loop.                   | PAL_SUCCESS |
+* | 4 | Report the time of one round trip in microseconds.                                | |
+* | 5 | Terminate the thread using `pal_osThreadTerminate`.                              | PAL_SUCCESS |
+*/
+TEST(pal_performance, SemaphorePingPong)
+{
+    palThreadID_t thread = NULLPTR;
+    palStatus_t status;
+    int32_t count;
+
+    /*#1*/
+    status = pal_osSemaphoreCreate(0, &g_perfPing);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+    status = pal_osSemaphoreCreate(0, &g_perfPong);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+
+    /*#2*/
+    status = pal_osThreadCreateWithAlloc(perfPongThread, NULL, PAL_osPriorityNormal, PAL_TEST_THREAD_STACK_SIZE, NULL, &thread);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+
+    /*#3*/
+    const uint64_t start = pal_osKernelSysTick();
+    for (int i = 0; i < PAL_PERF_SEMAPHORE_ROUNDS; i++) {
+        status = pal_osSemaphoreRelease(g_perfPing);
+        TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+        status = pal_osSemaphoreWait(g_perfPong, PAL_RTOS_WAIT_FOREVER, &count);
+        TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+    }
+    const uint64_t elapsed = pal_osKernelSysTick() - start;
+
+    /*#4*/
+    PAL_PERF_REPORT("semaphore_ping_pong", perfTicksToMicroSec(elapsed) / PAL_PERF_SEMAPHORE_ROUNDS, "us");
+
+    /*#5*/
+    status = pal_osThreadTerminate(&thread);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+}
+
+static void perfTimerCallback(void const *argument)
+{
+    (void)argument;
+    if (g_perfTimerCount < PAL_PERF_TIMER_SAMPLES) {
+        g_perfTimerTicks[g_perfTimerCount] = pal_osKernelSysTick();
+        if (++g_perfTimerCount == PAL_PERF_TIMER_SAMPLES) {
+            pal_osSemaphoreRelease(g_perfTimerDone);
+        }
+    }
+}
+
+static void perfTimerJitter(uint32_t periodMs)
+{
+    palTimerID_t timer = NULLPTR;
+    palStatus_t status;
+    int32_t count;
+    char metric[32];
+
+    g_perfTimerCount = 0;
+    status = pal_osTimerCreate(perfTimerCallback, NULL, palOsTimerPeriodic, &timer);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+    status = pal_osTimerStart(timer, periodMs);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+
+    status = pal_osSemaphoreWait(g_perfTimerDone, periodMs * PAL_PERF_TIMER_SAMPLES * 2 + 1000, &count);
+    pal_osTimerStop(timer);
+    pal_osTimerDelete(&timer);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+
+    // Deviation of each interval from the period
+    const int64_t periodUs = (int64_t)periodMs * 1000;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+    for (int i = 1; i < PAL_PERF_TIMER_SAMPLES; i++) {
+        const int64_t intervalUs = (int64_t)perfTicksToMicroSec(g_perfTimerTicks[i] - g_perfTimerTicks[i - 1]);
+        const uint64_t deviation = intervalUs > periodUs ? intervalUs - periodUs : periodUs - intervalUs;
+        sum += deviation;
+        if (deviation > max) {
+            max = deviation;
+        }
+    }
+
+    snprintf(metric, sizeof(metric), "timer_jitter_%" PRIu32 "ms_mean", periodMs);
+    PAL_PERF_REPORT(metric, sum / (PAL_PERF_TIMER_SAMPLES - 1), "us");
+    snprintf(metric, sizeof(metric), "timer_jitter_%" PRIu32 "ms_max", periodMs);
+    PAL_PERF_REPORT(metric, max, "us");
+}
+
+/*! \brief Measures the jitter of periodic timers.
+*
+* | # |    Step                        |   Expected  |
+* |---|--------------------------------|-------------|
+* | 1 | Create a semaphore using `pal_osSemaphoreCreate`.                                  | PAL_SUCCESS |
+* | 2 | Run a periodic timer of 1, 10 and 100 ms, recording the tick count of each expiry. | PAL_SUCCESS |
+* | 3 | Report the mean and the largest deviation of the intervals from the period.        | |
+*/
+TEST(pal_performance, TimerJitter)
+{
+    palStatus_t status;
+
+    /*#1*/
+    status = pal_osSemaphoreCreate(0, &g_perfTimerDone);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+
+    /*#2*/
+    /*#3*/
+    perfTimerJitter(1);
+    perfTimerJitter(10);
+    perfTimerJitter(100);
+}
+
+static void perfSocketCallback(void *argument)
+{
+    (void)argument;
+    pal_osSemaphoreRelease(g_perfSocketEvent);
+}
+
+// Receives a datagram from a non-blocking socket, waiting for the socket callback in between
+static palStatus_t perfReceiveFrom(palSocket_t sock, void *buffer, size_t length, size_t *received)
+{
+    palSocketAddress_t from;
+    palSocketLength_t fromLength;
+    palStatus_t status;
+    int32_t count;
+
+    do {
+        fromLength = sizeof(from);
+        status = pal_receiveFrom(sock, buffer, length, &from, &fromLength, received);
+        if (PAL_ERR_SOCKET_WOULD_BLOCK == status &&
+                PAL_SUCCESS != pal_osSemaphoreWait(g_perfSocketEvent, PAL_MILLI_PER_SECOND, &count)) {
+            break;
+        }
+    } while (PAL_ERR_SOCKET_WOULD_BLOCK == status);
+    return status;
+}
+
+/*! \brief Measures the UDP throughput over the loopback path of the network interface.
+*
+* | # |    Step                        |   Expected  |
+* |---|--------------------------------|-------------|
+* | 1 | Get the address of the interface using `pal_getNetInterfaceInfo`.           | PAL_SUCCESS |
+* | 2 | Create a UDP socket and bind it to the address using `pal_bind`.            | PAL_SUCCESS |
+* | 3 | Send datagrams to the socket itself and receive each of them.              | PAL_SUCCESS |
+* | 4 | Report the time of one datagram and the throughput.                         | |
+* | 5 | Close the socket using `pal_close`.                                         | PAL_SUCCESS |
+*/
+TEST(pal_performance, UdpLoopbackThroughput)
+{
+    palNetInterfaceInfo_t interfaceInfo;
+    palSocket_t sock = 0;
+    palStatus_t status;
+    size_t transferred = 0;
+
+    /*#1*/
+    memset(&interfaceInfo, 0, sizeof(interfaceInfo));
+    status = pal_getNetInterfaceInfo(0, &interfaceInfo);
+    if (PAL_SUCCESS != status) {
+        TEST_IGNORE_MESSAGE("Ignored, no network interface");
+    }
+
+    /*#2*/
+    status = pal_osSemaphoreCreate(0, &g_perfSocketEvent);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+    status = pal_asynchronousSocket(PAL_AF_INET, PAL_SOCK_DGRAM, true, 0, perfSocketCallback, &sock);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+    status = pal_setSockAddrPort(&interfaceInfo.address, PAL_PERF_UDP_PORT);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+    status = pal_bind(sock, &interfaceInfo.address, interfaceInfo.addressSize);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+
+    /*#3*/
+    memset(g_perfBuffer, 0xA5, PAL_PERF_UDP_DATAGRAM_SIZE);
+    const uint64_t start = pal_osKernelSysTick();
+    for (int i = 0; i < PAL_PERF_UDP_DATAGRAMS; i++) {
+        status = pal_sendTo(sock, g_perfBuffer, PAL_PERF_UDP_DATAGRAM_SIZE, &interfaceInfo.address, interfaceInfo.addressSize, &transferred);
+        TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+        status = perfReceiveFrom(sock, g_perfBuffer, PAL_PERF_UDP_DATAGRAM_SIZE, &transferred);
+        TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+        TEST_ASSERT_EQUAL(PAL_PERF_UDP_DATAGRAM_SIZE, transferred);
+    }
+    const uint64_t elapsedUs = perfTicksToMicroSec(pal_osKernelSysTick() - start);
+
+    /*#4*/
+    PAL_PERF_REPORT("udp_loopback_datagram", elapsedUs / PAL_PERF_UDP_DATAGRAMS, "us");
+    if (elapsedUs) {
+        PAL_PERF_REPORT("udp_loopback_throughput",
+                        (uint64_t)PAL_PERF_UDP_DATAGRAMS * PAL_PERF_UDP_DATAGRAM_SIZE * 1000000 / 1024 / elapsedUs, "KiB/s");
+    }
+
+    /*#5*/
+    status = pal_close(&sock);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+}
+
+/*! \brief Measures the latency of file operations on the primary partition.
+*
+* | # |    Step                        |   Expected  |
+* |---|--------------------------------|-------------|
+* | 1 | Get the mount point using `pal_fsGetMountPoint`.                              | PAL_SUCCESS |
+* | 2 | Create, write and close a file in a loop.                                     | PAL_SUCCESS |
+* | 3 | Open, read and close the file in a loop.                                      | PAL_SUCCESS |
+* | 4 | Report the time of a write and of a read of the file.                         | |
+* | 5 | Delete the file using `pal_fsUnlink`.                                         | PAL_SUCCESS |
+*/
+TEST(pal_performance, FileWriteRead)
+{
+#if PAL_USE_FILESYSTEM == 1
+    char path[PAL_MAX_FILE_AND_FOLDER_LENGTH] = {0};
+    palFileDescriptor_t fd = 0;
+    palStatus_t status;
+    size_t transferred = 0;
+
+    /*#1*/
+    status = pal_fsGetMountPoint(PAL_FS_PARTITION_PRIMARY, PAL_MAX_FILE_AND_FOLDER_LENGTH, path);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+    strncat(path, PAL_PERF_FILE_NAME, PAL_MAX_FILE_AND_FOLDER_LENGTH - strlen(path) - 1);
+    memset(g_perfBuffer, 0x5A, sizeof(g_perfBuffer));
+
+    /*#2*/
+    uint64_t start = pal_osKernelSysTick();
+    for (int i = 0; i < PAL_PERF_FILE_ROUNDS; i++) {
+        status = pal_fsFopen(path, PAL_FS_FLAG_READWRITETRUNC, &fd);
+        TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+        status = pal_fsFwrite(&fd, g_perfBuffer, sizeof(g_perfBuffer), &transferred);
+        TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+        status = pal_fsFclose(&fd);
+        TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+    }
+    const uint64_t writeUs = perfTicksToMicroSec(pal_osKernelSysTick() - start);
+
+    /*#3*/
+    start = pal_osKernelSysTick();
+    for (int i = 0; i < PAL_PERF_FILE_ROUNDS; i++) {
+        status = pal_fsFopen(path, PAL_FS_FLAG_READONLY, &fd);
+        TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+        status = pal_fsFread(&fd, g_perfBuffer, sizeof(g_perfBuffer), &transferred);
+        TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+        TEST_ASSERT_EQUAL(sizeof(g_perfBuffer), transferred);
+        status = pal_fsFclose(&fd);
+        TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+    }
+    const uint64_t readUs = perfTicksToMicroSec(pal_osKernelSysTick() - start);
+
+    /*#4*/
+    PAL_PERF_REPORT("file_write_4k", writeUs / PAL_PERF_FILE_ROUNDS, "us");
+    PAL_PERF_REPORT("file_read_4k", readUs / PAL_PERF_FILE_ROUNDS, "us");
+
+    /*#5*/
+    status = pal_fsUnlink(path);
+    TEST_ASSERT_EQUAL_HEX(PAL_SUCCESS, status);
+#else // PAL_USE_FILESYSTEM
+    TEST_IGNORE_MESSAGE("Ignored, PAL_USE_FILESYSTEM not set");
+#endif // PAL_USE_FILESYSTEM
+}
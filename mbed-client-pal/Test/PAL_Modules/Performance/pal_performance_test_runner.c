@@ -0,0 +1,30 @@
+/*******************************************************************************
+ * Copyright 2021 Pelion.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#include "unity.h"
+#include "unity_fixture.h"
+#include "pal.h"
+
+TEST_GROUP_RUNNER(pal_performance)
+{
+#ifndef PAL_SKIP_TEST_MODULE_PERFORMANCE
+    RUN_TEST_CASE(pal_performance, MutexLockUnlock);
+    RUN_TEST_CASE(pal_performance, SemaphorePingPong);
+    RUN_TEST_CASE(pal_performance, TimerJitter);
+    RUN_TEST_CASE(pal_performance, UdpLoopbackThroughput);
+    RUN_TEST_CASE(pal_performance, FileWriteRead);
+#endif
+}
@@ -51,6 +51,8 @@ int mbed_cloud_application_entrypoint(void)
     status = palSanityTestMain();
 #elif defined(PAL_UNIT_TEST_REFORMAT)
     status = palReformatTestMain();
+#elif defined(PAL_UNIT_TEST_PERFORMANCE)
+    status = palPerformanceTestMain();
 #else 
     // No need for defined(PAL_UNIT_TEST_ALL), this is likely the most needed one
     status = palAllTestMain(); // this will execute tests for all the other modules above
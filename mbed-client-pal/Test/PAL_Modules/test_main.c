@@ -463,4 +463,10 @@ int palReformatTestMain(void)
     return palTestMain(TEST_pal_sanity_GROUP_RUNNER, init_flags);
 }
 
+int palPerformanceTestMain(void)
+{
+    int init_flags = PAL_TEST_PLATFORM_INIT_BASE|PAL_TEST_PLATFORM_INIT_CONNECTION|PAL_TEST_PLATFORM_INIT_STORAGE;
+    return palTestMain(TEST_pal_performance_GROUP_RUNNER, init_flags);
+}
+
 
@@ -79,6 +79,8 @@ int test_main(int argc, char * argv[], testMain_t func);
 
 #ifdef PAL_MEMORY_STATISTICS
 void printMemoryStats(void);
+void palMemoryHeapLock(bool locked);
+int32_t palMemoryAllocationsAfterLock(void);
 #define PRINT_MEMORY_STATS  printMemoryStats();
 #else //PAL_MEMORY_STATISTICS
 #define PRINT_MEMORY_STATS
@@ -109,6 +111,8 @@ void TEST_pal_SOTP_GROUP_RUNNER(void);
 
 void TEST_pal_sanity_GROUP_RUNNER(void);
 
+void TEST_pal_performance_GROUP_RUNNER(void);
+
 
 typedef struct _palTestsStatusData_t
 {
@@ -178,6 +182,7 @@ int palUpdateTestMain(void);
 int palSOTPTestMain(void);
 int palSanityTestMain(void);
 int palReformatTestMain(void);
+int palPerformanceTestMain(void); // not part of palAllTestMain(), it measures instead of testing
 
 typedef enum _palTestSOTPTests_t
 {
@@ -28,12 +28,35 @@
     #define PAL_MEMORY_BUCKET		0
 #endif
 
+// Set to 1 to assert on an allocation made while the heap is locked with palMemoryHeapLock()
+#ifndef PAL_MEMORY_HEAP_LOCK_ASSERT
+    #define PAL_MEMORY_HEAP_LOCK_ASSERT	0
+#endif
+
 #ifdef PAL_MEMORY_STATISTICS
 #include "stdio.h"
 #include "mbed-trace/mbed_trace.h"
 
+#include <assert.h>
+#include <stdbool.h>
+
 #define TRACE_GROUP "PAL_MEMORY"
 
+// Allocations are not expected once the heap is locked, when the initialization is done.
+// They are counted, so that the steady state allocations can be found and removed.
+static volatile bool heapLocked = false;
+static int32_t allocationsAfterLock = 0;
+
+void palMemoryHeapLock(bool locked)
+{
+	heapLocked = locked;
+}
+
+int32_t palMemoryAllocationsAfterLock(void)
+{
+	return allocationsAfterLock;
+}
+
 #ifdef PAL_MEMORY_BUCKET
 
 #define SMALL_BUCKET	32
@@ -90,6 +113,14 @@ static inline memoryBucketSizes getBucketNumber(size_t size)
 void* __wrap_malloc(size_t c)
 {
 	void *ptr  = NULL;
+	if (heapLocked)
+	{
+		// No tracing here, it could allocate itself
+		pal_osAtomicIncrement(&allocationsAfterLock, 1);
+#if PAL_MEMORY_HEAP_LOCK_ASSERT
+		assert(!"heap allocation after the heap was locked");
+#endif
+	}
 #ifdef PAL_MEMORY_BUCKET
 	ptr = __real_malloc(c + sizeof(size_t) + sizeof(size_t));
 	if (ptr == NULL)
@@ -167,6 +198,7 @@ void* __wrap_calloc(size_t num, size_t size)
 
 void printMemoryStats(void)
 {
+	tr_info("allocations after heap lock = %ld\r\n", allocationsAfterLock);
 #ifdef PAL_MEMORY_BUCKET
 	tr_info("\n*******************************************************\r\n");
 	tr_info("water mark size = %ld\r\n",memoryStats.waterMark);
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 #include <stdint.h>
+#include <stdbool.h>
 #include <limits.h>
 #include "randLIB.h"
 #include "platform/arm_hal_random.h"
@@ -46,11 +47,48 @@
 #endif
 #endif // RANDLIB_PRNG
 
-/* RAM usage - 16 bytes of state (or a FILE * pointer and underlying FILE, which
- * will include a buffer) */
+/* RAM usage - 16 bytes of state (or a FILE * pointer and underlying FILE, and
+ * a buffer of random bytes) */
 #ifdef RANDOM_DEVICE
 #include <stdio.h>
+#include <string.h>
+
+/* Bytes read from the device at once. The FILE is unbuffered, so each refill
+ * is one read, and draws in between only copy from the buffer. */
+#ifndef RANDLIB_DEVICE_BUFFER_SIZE
+#define RANDLIB_DEVICE_BUFFER_SIZE 256
+#endif
+
 static FILE *random_file;
+static uint8_t random_buffer[RANDLIB_DEVICE_BUFFER_SIZE];
+static size_t random_buffer_pos = RANDLIB_DEVICE_BUFFER_SIZE;
+
+/* Copy count bytes from the buffer, refilling it as needed. Returns false,
+ * with the rest of the output zeroed, if the device fails. */
+static bool random_device_read(uint8_t *data_ptr, size_t count)
+{
+    while (count) {
+        size_t pos = random_buffer_pos;
+        if (pos >= sizeof random_buffer) {
+            if (!random_file || fread(random_buffer, sizeof random_buffer, 1, random_file) != 1) {
+                memset(data_ptr, 0, count);
+                return false;
+            }
+            pos = 0;
+        }
+        size_t len = sizeof random_buffer - pos;
+        if (len > count) {
+            len = count;
+        }
+        memcpy(data_ptr, random_buffer + pos, len);
+        /* Used bytes are cleared, so that they are not left in memory */
+        memset(random_buffer + pos, 0, len);
+        random_buffer_pos = pos + len;
+        data_ptr += len;
+        count -= len;
+    }
+    return true;
+}
 #else
 static uint64_t state[2];
 #endif
@@ -87,6 +125,9 @@ void randLIB_seed_random(void)
 #ifdef RANDOM_DEVICE
     if (!random_file) {
         random_file = fopen(RANDOM_DEVICE, "rb");
+        if (random_file) {
+            setvbuf(random_file, NULL, _IONBF, 0);
+        }
     }
 #else
     arm_random_module_init();
@@ -148,13 +189,8 @@ uint32_t randLIB_get_32bit(void)
 uint64_t randLIB_get_64bit(void)
 {
 #ifdef RANDOM_DEVICE
-    if (!random_file) {
-        return 0;
-    }
     uint64_t result;
-    if (fread(&result, sizeof result, 1, random_file) != 1) {
-        result = 0;
-    }
+    random_device_read((uint8_t *) &result, sizeof result);
     return result;
 #else
     const uint64_t s0 = state[0];
@@ -171,6 +207,10 @@ uint64_t randLIB_get_64bit(void)
 
 void *randLIB_get_n_bytes_random(void *ptr, uint8_t count)
 {
+#ifdef RANDOM_DEVICE
+    random_device_read(ptr, count);
+    return ptr;
+#else
     uint8_t *data_ptr = ptr;
     uint64_t r = 0;
     for (uint_fast8_t i = 0; i < count; i++) {
@@ -183,6 +223,7 @@ void *randLIB_get_n_bytes_random(void *ptr, uint8_t count)
         data_ptr[i] = (uint8_t) r;
     }
     return data_ptr;
+#endif
 }
 
 uint16_t randLIB_get_random_in_range(uint16_t min, uint16_t max)
@@ -203,8 +203,24 @@ typedef struct sn_nsdl_resource_parameters_ {
     bool                                        always_publish: 1;   /**< 1 if resource should always be published in registration or registration update **/
     unsigned                                    publish_value: 2;     /**< 0 for non-publishing,1 if resource value to be published in registration message,
                                                                          2 if resource value to be published in Base64 encoded format */
+    bool                                        report_deferred: 1;  /**< 1 if value changed during M2MObjectInstance::begin_update(), reported on commit */
+#if MBED_CLIENT_GRS_HASH_INDEX_SIZE
+    struct sn_nsdl_resource_parameters_         *hash_next;          /**< Next resource in the same GRS hash bucket, owned by GRS */
+    uint16_t                                    path_len;            /**< Length of static_resource_parameters->path, set by GRS */
+#endif
+#if MBED_CLIENT_INLINE_RESOURCE_VALUE_SIZE
+    uint8_t                                     value_buffer[MBED_CLIENT_INLINE_RESOURCE_VALUE_SIZE]; /**< Storage for a short value, resource points here
+                                                                                                            when used and must then not be freed */
+#endif
 } sn_nsdl_dynamic_resource_parameters_s;
 
+#if MBED_CLIENT_INLINE_RESOURCE_VALUE_SIZE
+/** True if the value of the resource is allocated from heap and not stored in value_buffer. */
+#define SN_NSDL_RESOURCE_VALUE_ALLOCATED(res) ((res)->resource != (res)->value_buffer)
+#else
+#define SN_NSDL_RESOURCE_VALUE_ALLOCATED(res) true
+#endif
+
 
 /**
  * \fn struct nsdl_s *sn_nsdl_init  (uint8_t (*sn_nsdl_tx_cb)(sn_nsdl_capab_e , uint8_t *, uint16_t, sn_nsdl_addr_s *),
@@ -278,6 +294,44 @@ extern int32_t sn_nsdl_update_registration(struct nsdl_s *handle, uint8_t *lt_pt
  */
 extern int8_t sn_nsdl_set_endpoint_location(struct nsdl_s *handle, uint8_t *location_ptr, uint8_t location_len);
 
+#if MBED_CLIENT_REGISTRATION_RESUME
+/**
+ * \fn extern uint32_t sn_nsdl_get_registration_fingerprint(const struct nsdl_s *handle);
+ *
+ * \brief Returns the fingerprint of the latest full registration.
+ *
+ * The fingerprint covers the endpoint parameters, the uri query parameters and the
+ * link format entries of all published resources, so it changes whenever the server
+ * would see a different registration.
+ *
+ * \param *handle   Pointer to nsdl-library handle
+ *
+ * \return  Fingerprint, 0 if no registration has been sent
+ */
+extern uint32_t sn_nsdl_get_registration_fingerprint(const struct nsdl_s *handle);
+
+/**
+ * \fn extern int8_t sn_nsdl_resume_registration(struct nsdl_s *handle, sn_nsdl_ep_parameters_s *endpoint_info_ptr, const char *uri_query_parameters, uint32_t fingerprint, uint8_t *location_ptr, uint8_t location_len);
+ *
+ * \brief Restores a registration made before a reset, so that it can be refreshed with sn_nsdl_update_registration().
+ *
+ * The registration is restored only if the registration sn_nsdl_register_endpoint() would send
+ * now has the given fingerprint. The published resources are then marked as registered, so the
+ * next registration update publishes only the ones changed afterwards.
+ *
+ * \param *handle                   Pointer to nsdl-library handle
+ * \param *endpoint_info_ptr        Contains endpoint information
+ * \param *uri_query_parameters     Uri query parameters, as given to sn_nsdl_register_endpoint()
+ * \param fingerprint               Stored result of sn_nsdl_get_registration_fingerprint()
+ * \param *location_ptr             Stored location of the registration
+ * \param location_len              Length of the location
+ *
+ * \return  SN_NSDL_SUCCESS if restored, SN_NSDL_FAILURE if the registration has changed
+ */
+extern int8_t sn_nsdl_resume_registration(struct nsdl_s *handle, sn_nsdl_ep_parameters_s *endpoint_info_ptr, const char *uri_query_parameters,
+                                          uint32_t fingerprint, uint8_t *location_ptr, uint8_t location_len);
+#endif
+
 /**
  * \fn extern int8_t sn_nsdl_is_ep_registered(struct nsdl_s *handle)
  *
@@ -381,6 +435,32 @@ extern int8_t sn_nsdl_process_coap(struct nsdl_s *handle, sn_coap_hdr_s *coap_pa
  */
 extern int8_t sn_nsdl_exec(struct nsdl_s *handle, uint32_t time);
 
+/**
+ * \fn extern int8_t sn_nsdl_set_time(struct nsdl_s *handle, uint32_t time);
+ *
+ * \brief Updates the library time between sn_nsdl_exec() calls, without doing any retransmissions.
+ *
+ * \param   *handle Pointer to nsdl-library handle
+ *
+ * \param  time Time in seconds.
+ *
+ * \return  0   Success
+ * \return  -1  Failure
+ */
+extern int8_t sn_nsdl_set_time(struct nsdl_s *handle, uint32_t time);
+
+/**
+ * \fn extern uint32_t sn_nsdl_get_next_exec_time(struct nsdl_s *handle);
+ *
+ * \brief Returns the time when sn_nsdl_exec() has next work to do.
+ *
+ * \param   *handle Pointer to nsdl-library handle
+ *
+ * \return  Time in seconds, may be in the past if something is already due.
+ * \return  UINT32_MAX if nothing is pending.
+ */
+extern uint32_t sn_nsdl_get_next_exec_time(struct nsdl_s *handle);
+
 /**
  * \fn  extern int8_t sn_nsdl_put_resource(struct nsdl_s *handle, const sn_nsdl_dynamic_resource_parameters_s *res);
  *
@@ -418,6 +498,22 @@ extern int8_t sn_nsdl_put_resource(struct nsdl_s *handle, sn_nsdl_dynamic_resour
  */
 extern int8_t sn_nsdl_pop_resource(struct nsdl_s *handle, sn_nsdl_dynamic_resource_parameters_s *res);
 
+/**
+ * \fn  extern int8_t sn_nsdl_resource_changed(struct nsdl_s *handle, sn_nsdl_dynamic_resource_parameters_s *res);
+ *
+ * \brief Includes resource to the next registration update.
+ *
+ * Must be called when the published attributes or the registration state of a resource already put
+ * with sn_nsdl_put_resource() are changed, as registration update publishes only the resources added
+ * or reported changed since the previous registration, when MBED_CLIENT_REGISTRATION_JOURNAL_SIZE is in use.
+ *
+ * \param   *res    Pointer to the resource.
+ *
+ * \return  0   Success
+ * \return  -1  Failure
+ */
+extern int8_t sn_nsdl_resource_changed(struct nsdl_s *handle, sn_nsdl_dynamic_resource_parameters_s *res);
+
 /**
  * \fn extern int8_t sn_nsdl_delete_resource(struct nsdl_s *handle, char *path)
  *
@@ -60,6 +60,18 @@ struct grs_s {
 
     uint16_t resource_root_count;
     resource_list_t resource_root_list;
+#if MBED_CLIENT_GRS_HASH_INDEX_SIZE
+    sn_nsdl_dynamic_resource_parameters_s *resource_hash_table[MBED_CLIENT_GRS_HASH_INDEX_SIZE];
+#endif
+#if MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+    /* Resources changed since the last registration, registration update publishes only these */
+    sn_nsdl_dynamic_resource_parameters_s *registration_journal[MBED_CLIENT_REGISTRATION_JOURNAL_SIZE];
+    uint16_t registration_journal_count;
+    bool registration_journal_overflow;
+#endif
+#if MBED_CLIENT_STREAMED_REGISTRATION
+    sn_nsdl_dynamic_resource_parameters_s *registration_stream_resource; // Next resource of registration payload being streamed
+#endif
 };
 
 
@@ -79,6 +91,23 @@ struct nsdl_s {
     unsigned int is_bs_server:1;
 #endif
 
+#if MBED_CLIENT_STREAMED_REGISTRATION
+    unsigned int registration_stream_active:1;
+    unsigned int registration_stream_updating:1;
+    unsigned int registration_stream_first:1;
+    uint8_t *registration_stream_entry;              // Resource entry split at block boundary
+    uint16_t registration_stream_entry_len;
+    uint16_t registration_stream_entry_offset;
+#endif
+
+#if MBED_CLIENT_CBOR_REGISTRATION
+    unsigned int registration_cbor:1;                // Cleared when server rejects CBOR link format
+#endif
+
+#if MBED_CLIENT_REGISTRATION_RESUME
+    uint32_t registration_fingerprint;               // Fingerprint of the latest full registration
+#endif
+
     struct grs_s *grs;
     sn_nsdl_ep_parameters_s *ep_information_ptr;     // Endpoint parameters, Name, Domain etc..
     sn_nsdl_addr_s server_address;                   // server address information
@@ -134,6 +163,12 @@ extern int8_t                                   sn_grs_put_resource(struct grs_s
 extern int8_t                                   sn_grs_pop_resource(struct grs_s *handle, sn_nsdl_dynamic_resource_parameters_s *res);
 extern int8_t                                   sn_grs_delete_resource(struct grs_s *handle, const char *path);
 extern void                                     sn_grs_mark_resources_as_registered(struct nsdl_s *handle);
+#if MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+extern void                                     sn_grs_journal_add(struct grs_s *handle, sn_nsdl_dynamic_resource_parameters_s *res);
+extern void                                     sn_grs_journal_reset(struct grs_s *handle);
+extern void                                     sn_grs_journal_commit(struct grs_s *handle);
+extern void                                     sn_grs_journal_retain(struct grs_s *handle, sn_nsdl_dynamic_resource_parameters_s *res);
+#endif
 
 #ifdef __cplusplus
 }
@@ -32,6 +32,7 @@
 #include "sn_nsdl_lib.h"
 #include "sn_grs.h"
 #include "mbed-client/m2mconfig.h"
+#include "mbed-cloud-client/PerfCounters.h"
 
 /* Defines */
 #define WELLKNOWN_PATH_LEN              16
@@ -44,6 +45,17 @@ static int8_t sn_grs_core_request(struct nsdl_s *handle, sn_nsdl_addr_s *src_add
 static uint8_t coap_tx_callback(uint8_t *, uint16_t, sn_nsdl_addr_s *, void *);
 static int8_t coap_rx_callback(sn_coap_hdr_s *coap_ptr, sn_nsdl_addr_s *address_ptr, void *param);
 static void sn_grs_free_coap_packet(struct nsdl_s *nsdl_handle, sn_coap_hdr_s *coap_packet_ptr, sn_nsdl_addr_s *src_addr_ptr);
+static void sn_grs_unlink_resource(struct grs_s *handle, sn_nsdl_dynamic_resource_parameters_s *res);
+static bool sn_grs_is_subresource(const sn_nsdl_dynamic_resource_parameters_s *res, const char *path, uint16_t pathlen);
+#if MBED_CLIENT_GRS_HASH_INDEX_SIZE
+static uint16_t sn_grs_path_hash(const char *path, uint16_t pathlen);
+static void sn_grs_index_add(struct grs_s *handle, sn_nsdl_dynamic_resource_parameters_s *res);
+static void sn_grs_index_remove(struct grs_s *handle, sn_nsdl_dynamic_resource_parameters_s *res);
+#endif
+#if MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+static void sn_grs_journal_remove(struct grs_s *handle, const sn_nsdl_dynamic_resource_parameters_s *res);
+static bool sn_grs_journal_is_retained(const sn_nsdl_dynamic_resource_parameters_s *res);
+#endif
 
 /* Extern function prototypes */
 extern int8_t                       sn_nsdl_build_registration_body(struct nsdl_s *handle, sn_coap_hdr_s *message_ptr, uint8_t updating_registeration);
@@ -59,8 +71,7 @@ extern int8_t sn_grs_destroy(struct grs_s *handle)
         return 0;
     }
     ns_list_foreach_safe(sn_nsdl_dynamic_resource_parameters_s, tmp, &handle->resource_root_list) {
-        ns_list_remove(&handle->resource_root_list, tmp);
-        --handle->resource_root_count;
+        sn_grs_unlink_resource(handle, tmp);
         sn_grs_resource_info_free(handle, tmp);
     }
     handle->sn_grs_free(handle);
@@ -162,6 +173,8 @@ extern int8_t sn_grs_delete_resource(struct grs_s *handle, const char *path)
 {
     /* Local variables */
     sn_nsdl_dynamic_resource_parameters_s     *resource_temp  = NULL;
+    const char                                *path_temp_ptr  = NULL;
+    uint16_t                                  pathlen         = 0;
 
     /* Search if resource found */
     resource_temp = sn_grs_search_resource(handle, path, SN_GRS_SEARCH_METHOD);
@@ -171,18 +184,19 @@ extern int8_t sn_grs_delete_resource(struct grs_s *handle, const char *path)
         return SN_NSDL_FAILURE;
     }
 
-    /* If found, delete it and delete also subresources, if there is any */
-    do {
-        /* Remove from list */
-        ns_list_remove(&handle->resource_root_list, resource_temp);
-        --handle->resource_root_count;
+    pathlen = strlen(path);
+    path_temp_ptr = sn_grs_convert_uri(&pathlen, path);
 
-        /* Free */
-        sn_grs_resource_info_free(handle, resource_temp);
+    /* Delete subresources first in a single pass, the path may belong to the resource itself */
+    ns_list_foreach_safe(sn_nsdl_dynamic_resource_parameters_s, tmp, &handle->resource_root_list) {
+        if (sn_grs_is_subresource(tmp, path_temp_ptr, pathlen)) {
+            sn_grs_unlink_resource(handle, tmp);
+            sn_grs_resource_info_free(handle, tmp);
+        }
+    }
 
-        /* Search for subresources */
-        resource_temp = sn_grs_search_resource(handle, path, SN_GRS_DELETE_METHOD);
-    } while (resource_temp != NULL);
+    sn_grs_unlink_resource(handle, resource_temp);
+    sn_grs_resource_info_free(handle, resource_temp);
 
     return SN_NSDL_SUCCESS;
 }
@@ -208,6 +222,12 @@ int8_t sn_grs_put_resource(struct grs_s *handle, sn_nsdl_dynamic_resource_parame
 
     ns_list_add_to_start(&handle->resource_root_list, res);
     ++handle->resource_root_count;
+#if MBED_CLIENT_GRS_HASH_INDEX_SIZE
+    sn_grs_index_add(handle, res);
+#endif
+#if MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+    sn_grs_journal_add(handle, res);
+#endif
 
     return SN_NSDL_SUCCESS;
 }
@@ -229,8 +249,7 @@ int8_t sn_grs_pop_resource(struct grs_s *handle, sn_nsdl_dynamic_resource_parame
         return SN_NSDL_FAILURE;
     }
 
-    ns_list_remove(&handle->resource_root_list, res);
-    --handle->resource_root_count;
+    sn_grs_unlink_resource(handle, res);
 
     return SN_NSDL_SUCCESS;
 }
@@ -476,6 +495,10 @@ extern int8_t sn_grs_send_coap_message(struct nsdl_s *handle, sn_nsdl_addr_s *ad
         } else {
             return SN_NSDL_FAILURE;
         }
+    } else if (ret_val == 0) {
+        /* Stored for sending later by CoAP library */
+        handle->grs->sn_grs_free(message_ptr);
+        return SN_NSDL_SUCCESS;
     }
 
     /* Call tx callback function to send message */
@@ -541,6 +564,7 @@ static int8_t sn_grs_core_request(struct nsdl_s *handle, sn_nsdl_addr_s *src_add
  * \brief Searches given resource from linked list
  *
  *  Search either precise path, or subresources, eg. dr/x -> returns dr/x/1, dr/x/2 etc...
+ *  When MBED_CLIENT_GRS_HASH_INDEX_SIZE is set, precise path search is done through the hash index.
  *
  *  \param  pathlen         Length of the path to be search
  *
@@ -566,6 +590,25 @@ sn_nsdl_dynamic_resource_parameters_s *sn_grs_search_resource(struct grs_s *hand
 
     /* Searchs exact path */
     if (search_method == SN_GRS_SEARCH_METHOD) {
+        sn_nsdl_dynamic_resource_parameters_s *found = NULL;
+        /* Nodes compared, a growing maximum shows the lookup turning linear */
+        uint32_t steps = 0;
+#if MBED_CLIENT_GRS_HASH_INDEX_SIZE
+        /* Scan only the nodes in the matching bucket */
+        sn_nsdl_dynamic_resource_parameters_s *resource_search_temp =
+            handle->resource_hash_table[sn_grs_path_hash(path_temp_ptr, pathlen)];
+        while (resource_search_temp) {
+            steps++;
+            if (resource_search_temp->path_len == pathlen &&
+                    0 == memcmp(resource_search_temp->static_resource_parameters->path,
+                                path_temp_ptr,
+                                pathlen)) {
+                found = resource_search_temp;
+                break;
+            }
+            resource_search_temp = resource_search_temp->hash_next;
+        }
+#else
         /* Scan all nodes on list */
         ns_list_foreach(sn_nsdl_dynamic_resource_parameters_s, resource_search_temp, &handle->resource_root_list) {
             /* If length equals.. */
@@ -576,26 +619,28 @@ sn_nsdl_dynamic_resource_parameters_s *sn_grs_search_resource(struct grs_s *hand
                 len = strlen(resource_search_temp->static_resource_parameters->path);
             }
 
+            steps++;
             if (len == pathlen) {
                 /* Compare paths, If same return node pointer*/
                 if (0 == memcmp(resource_search_temp->static_resource_parameters->path,
                                 path_temp_ptr,
                                 pathlen)) {
-                    return resource_search_temp;
+                    found = resource_search_temp;
+                    break;
                 }
             }
         }
+#endif
+        PERF_COUNTER_ADD(RESOURCE_LOOKUPS, 1);
+        PERF_COUNTER_MAX(RESOURCE_LOOKUP_STEPS_MAX, steps);
+        (void)steps;
+        return found;
     }
     /* Search also subresources, eg. dr/x -> returns dr/x/1, dr/x/2 etc... */
     else if (search_method == SN_GRS_DELETE_METHOD) {
         /* Scan all nodes on list */
         ns_list_foreach(sn_nsdl_dynamic_resource_parameters_s, resource_search_temp, &handle->resource_root_list) {
-            char *temp_path = resource_search_temp->static_resource_parameters->path;
-            if (strlen(resource_search_temp->static_resource_parameters->path) > pathlen &&
-                    (*(temp_path + (uint8_t)pathlen) == '/') &&
-                    0 == memcmp(resource_search_temp->static_resource_parameters->path,
-                                path_temp_ptr,
-                                pathlen)) {
+            if (sn_grs_is_subresource(resource_search_temp, path_temp_ptr, pathlen)) {
                 return resource_search_temp;
             }
         }
@@ -638,6 +683,172 @@ static char *sn_grs_convert_uri(uint16_t *uri_len, const char *uri_ptr)
     return uri_start_ptr;
 }
 
+/**
+ * \fn  static void sn_grs_unlink_resource(struct grs_s *handle, sn_nsdl_dynamic_resource_parameters_s *res)
+ *
+ * \brief Removes resource from the resource list and from the hash index
+ *
+ *  \param *res             Pointer to the resource, must be on the list
+ *
+*/
+static void sn_grs_unlink_resource(struct grs_s *handle, sn_nsdl_dynamic_resource_parameters_s *res)
+{
+#if MBED_CLIENT_STREAMED_REGISTRATION
+    /* Registration being streamed continues from the next resource */
+    if (handle->registration_stream_resource == res) {
+        handle->registration_stream_resource = sn_grs_get_next_resource(handle, res);
+    }
+#endif
+    ns_list_remove(&handle->resource_root_list, res);
+    --handle->resource_root_count;
+#if MBED_CLIENT_GRS_HASH_INDEX_SIZE
+    sn_grs_index_remove(handle, res);
+#endif
+#if MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+    sn_grs_journal_remove(handle, res);
+#endif
+}
+
+/**
+ * \fn  static bool sn_grs_is_subresource(const sn_nsdl_dynamic_resource_parameters_s *res, const char *path, uint16_t pathlen)
+ *
+ * \brief Checks whether resource is below given path, eg. dr/x -> dr/x/1, dr/x/2 etc...
+ *
+ *  \param *path            Pointer to the path, '/' - marks already removed
+ *
+ *  \param  pathlen         Length of the path
+ *
+ *  \return true if resource path starts with "path/"
+ *
+*/
+static bool sn_grs_is_subresource(const sn_nsdl_dynamic_resource_parameters_s *res, const char *path, uint16_t pathlen)
+{
+    const char *res_path = res->static_resource_parameters->path;
+#if MBED_CLIENT_GRS_HASH_INDEX_SIZE
+    size_t res_path_len = res->path_len;
+#else
+    size_t res_path_len = strlen(res_path);
+#endif
+
+    return (res_path_len > pathlen &&
+            res_path[pathlen] == '/' &&
+            0 == memcmp(res_path, path, pathlen));
+}
+
+#if MBED_CLIENT_GRS_HASH_INDEX_SIZE
+/**
+ * \fn  static uint16_t sn_grs_path_hash(const char *path, uint16_t pathlen)
+ *
+ * \brief Calculates hash index bucket for the path (FNV-1a)
+ *
+ *  \return bucket index
+ *
+*/
+static uint16_t sn_grs_path_hash(const char *path, uint16_t pathlen)
+{
+    uint32_t hash = 2166136261u;
+
+    for (uint16_t i = 0; i < pathlen; i++) {
+        hash ^= (uint8_t)path[i];
+        hash *= 16777619u;
+    }
+
+    return (uint16_t)(hash % MBED_CLIENT_GRS_HASH_INDEX_SIZE);
+}
+
+static void sn_grs_index_add(struct grs_s *handle, sn_nsdl_dynamic_resource_parameters_s *res)
+{
+    uint16_t bucket;
+
+    res->path_len = strlen(res->static_resource_parameters->path);
+    bucket = sn_grs_path_hash(res->static_resource_parameters->path, res->path_len);
+
+    res->hash_next = handle->resource_hash_table[bucket];
+    handle->resource_hash_table[bucket] = res;
+}
+
+static void sn_grs_index_remove(struct grs_s *handle, sn_nsdl_dynamic_resource_parameters_s *res)
+{
+    sn_nsdl_dynamic_resource_parameters_s **link =
+        &handle->resource_hash_table[sn_grs_path_hash(res->static_resource_parameters->path, res->path_len)];
+
+    while (*link) {
+        if (*link == res) {
+            *link = res->hash_next;
+            res->hash_next = NULL;
+            return;
+        }
+        link = &(*link)->hash_next;
+    }
+}
+#endif
+
+#if MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+void sn_grs_journal_add(struct grs_s *handle, sn_nsdl_dynamic_resource_parameters_s *res)
+{
+    if (handle->registration_journal_overflow) {
+        return;
+    }
+
+    for (uint16_t i = 0; i < handle->registration_journal_count; i++) {
+        if (handle->registration_journal[i] == res) {
+            return;
+        }
+    }
+
+    if (handle->registration_journal_count < MBED_CLIENT_REGISTRATION_JOURNAL_SIZE) {
+        handle->registration_journal[handle->registration_journal_count++] = res;
+    } else {
+        // Too many changes to track, next update falls back to walking all resources
+        handle->registration_journal_overflow = true;
+    }
+}
+
+static void sn_grs_journal_remove(struct grs_s *handle, const sn_nsdl_dynamic_resource_parameters_s *res)
+{
+    for (uint16_t i = 0; i < handle->registration_journal_count; i++) {
+        if (handle->registration_journal[i] == res) {
+            handle->registration_journal_count--;
+            memmove(&handle->registration_journal[i], &handle->registration_journal[i + 1],
+                    (handle->registration_journal_count - i) * sizeof(handle->registration_journal[0]));
+            return;
+        }
+    }
+}
+
+void sn_grs_journal_reset(struct grs_s *handle)
+{
+    handle->registration_journal_count = 0;
+    handle->registration_journal_overflow = false;
+}
+
+/* Resource stays in the journal after being published, if the next update publishes it again */
+static bool sn_grs_journal_is_retained(const sn_nsdl_dynamic_resource_parameters_s *res)
+{
+    return res->publish_uri && (res->always_publish || res->registered == SN_NDSL_RESOURCE_DELETE);
+}
+
+void sn_grs_journal_retain(struct grs_s *handle, sn_nsdl_dynamic_resource_parameters_s *res)
+{
+    if (sn_grs_journal_is_retained(res)) {
+        sn_grs_journal_add(handle, res);
+    }
+}
+
+void sn_grs_journal_commit(struct grs_s *handle)
+{
+    uint16_t kept = 0;
+
+    for (uint16_t i = 0; i < handle->registration_journal_count; i++) {
+        sn_nsdl_dynamic_resource_parameters_s *res = handle->registration_journal[i];
+        if (sn_grs_journal_is_retained(res)) {
+            handle->registration_journal[kept++] = res;
+        }
+    }
+    handle->registration_journal_count = kept;
+}
+#endif
+
 /**
  * \fn  static int8_t sn_grs_resource_info_free(sn_grs_resource_info_s *resource_ptr)
  *
@@ -681,7 +892,9 @@ static int8_t sn_grs_resource_info_free(struct grs_s *handle, sn_nsdl_dynamic_re
             }
 
             if (resource_ptr->resource) {
-                handle->sn_grs_free(resource_ptr->resource);
+                if (SN_NSDL_RESOURCE_VALUE_ALLOCATED(resource_ptr)) {
+                    handle->sn_grs_free(resource_ptr->resource);
+                }
                 resource_ptr->resource = 0;
             }
 
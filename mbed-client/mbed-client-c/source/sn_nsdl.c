@@ -43,6 +43,9 @@
 #include "common_functions.h"
 #include "mbed-client/m2mconfig.h"
 #include "randLIB.h"
+#if MBED_CLIENT_CBOR_REGISTRATION
+#include "tinycbor.h"
+#endif
 
 #include <assert.h>
 #include <stdlib.h>
@@ -117,9 +120,24 @@ static uint8_t bs_queue_mode[]                  = {'b', '='};
 
 /* Function prototypes */
 static int32_t          sn_nsdl_internal_coap_send(struct nsdl_s *handle, sn_coap_hdr_s *coap_header_ptr, sn_nsdl_addr_s *dst_addr_ptr);
+static int32_t          sn_nsdl_internal_coap_send_registration(struct nsdl_s *handle, sn_coap_hdr_s *coap_header_ptr, sn_nsdl_addr_s *dst_addr_ptr);
+static int32_t          sn_nsdl_internal_coap_send_with_producer(struct nsdl_s *handle, sn_coap_hdr_s *coap_header_ptr, sn_nsdl_addr_s *dst_addr_ptr, sn_coap_payload_producer_cb producer);
 static void             sn_nsdl_resolve_nsp_address(struct nsdl_s *handle);
 int8_t                  sn_nsdl_build_registration_body(struct nsdl_s *handle, sn_coap_hdr_s *message_ptr, uint8_t updating_registeration);
 static uint16_t         sn_nsdl_calculate_registration_body_size(struct nsdl_s *handle, uint8_t updating_registeration, int8_t *error);
+#if MBED_CLIENT_REGISTRATION_RESUME
+static bool             sn_nsdl_is_resource_to_register(const sn_nsdl_dynamic_resource_parameters_s *resource, uint8_t updating_registeration);
+static uint32_t         sn_nsdl_calculate_registration_fingerprint(struct nsdl_s *handle, const sn_nsdl_ep_parameters_s *endpoint_info_ptr, const char *uri_query);
+#endif
+static sn_coap_content_format_e sn_nsdl_get_registration_content_format(const struct nsdl_s *handle);
+#if MBED_CLIENT_STREAMED_REGISTRATION && SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE
+static int8_t           sn_nsdl_start_registration_stream(struct nsdl_s *handle, sn_coap_hdr_s *message_ptr, uint8_t updating_registeration);
+static void             sn_nsdl_reset_registration_stream(struct nsdl_s *handle);
+static int32_t          sn_nsdl_produce_registration_body(void *param, uint8_t *dst_ptr, uint16_t block_size, bool *more);
+#endif
+#if MBED_CLIENT_CBOR_REGISTRATION
+static int8_t           sn_nsdl_build_registration_body_cbor(struct nsdl_s *handle, sn_coap_hdr_s *message_ptr, uint8_t updating_registeration);
+#endif
 static uint8_t          sn_nsdl_calculate_uri_query_option_len(sn_nsdl_ep_parameters_s *endpoint_info_ptr, uint8_t msg_type, const char *uri_query);
 static int8_t           sn_nsdl_fill_uri_query_options(struct nsdl_s *handle, sn_nsdl_ep_parameters_s *parameter_ptr, sn_coap_hdr_s *source_msg_ptr, uint8_t msg_type, const char *uri_query);
 static int8_t           sn_nsdl_local_rx_function(struct nsdl_s *handle, sn_coap_hdr_s *coap_packet_ptr, sn_nsdl_addr_s *address_ptr);
@@ -162,6 +180,10 @@ int8_t sn_nsdl_destroy(struct nsdl_s *handle)
         handle->server_address.type = SN_NSDL_ADDRESS_TYPE_NONE;
     }
 
+#if MBED_CLIENT_STREAMED_REGISTRATION && SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE
+    sn_nsdl_reset_registration_stream(handle);
+#endif
+
     /* Destroy also libCoap and grs part of libNsdl */
     sn_coap_protocol_destroy(handle->grs->coap);
     sn_grs_destroy(handle->grs);
@@ -223,6 +245,10 @@ struct nsdl_s *sn_nsdl_init(uint8_t (*sn_nsdl_tx_cb)(struct nsdl_s *, sn_nsdl_ca
     handle->sn_nsdl_endpoint_registered = SN_NSDL_ENDPOINT_NOT_REGISTERED;
     handle->context = NULL;
 
+#if MBED_CLIENT_CBOR_REGISTRATION
+    handle->registration_cbor = 1;
+#endif
+
     randLIB_seed_random();
     randLIB_get_n_bytes_random(&handle->token_seed, sizeof(handle->token_seed));
     if (handle->token_seed == 0) {
@@ -264,7 +290,7 @@ int32_t sn_nsdl_register_endpoint(struct nsdl_s *handle,
     register_message_ptr->msg_code = COAP_MSG_CODE_REQUEST_POST;
 
     /* Register message content format must be Core Link Format as stated in OMA LwM2M  */
-    register_message_ptr->content_format = COAP_CT_LINK_FORMAT;
+    register_message_ptr->content_format = sn_nsdl_get_registration_content_format(handle);
 
     /* Allocate memory for the extended options list */
     if (sn_coap_parser_alloc_options(handle->grs->coap, register_message_ptr) == NULL) {
@@ -285,6 +311,10 @@ int32_t sn_nsdl_register_endpoint(struct nsdl_s *handle,
         return SN_NSDL_FAILURE;
     }
 
+#if MBED_CLIENT_REGISTRATION_RESUME
+    handle->registration_fingerprint = sn_nsdl_calculate_registration_fingerprint(handle, endpoint_info_ptr, uri_query_parameters);
+#endif
+
     if (endpoint_info_ptr->ds_register_mode == REGISTER_WITH_RESOURCES) {
         /* Built body for message */
         int ret = sn_nsdl_build_registration_body(handle, register_message_ptr, 0);
@@ -300,6 +330,10 @@ int32_t sn_nsdl_register_endpoint(struct nsdl_s *handle,
     int i = 0;
     int row_len = 60;
     int max_length = 2048;
+    if (register_message_ptr->content_format != COAP_CT_LINK_FORMAT) {
+        tr_info("REGISTER MESSAGE: %d bytes, content format %d", register_message_ptr->payload_len, register_message_ptr->content_format);
+        max_length = 0;
+    }
     while (i < register_message_ptr->payload_len && i < max_length) {
         if (i + row_len > register_message_ptr->payload_len) {
             row_len = register_message_ptr->payload_len - i;
@@ -314,6 +348,9 @@ int32_t sn_nsdl_register_endpoint(struct nsdl_s *handle,
     /* Clean (possible) existing and save new endpoint info to handle */
     if (set_endpoint_info(handle, endpoint_info_ptr) == SN_NSDL_FAILURE) {
 
+#if MBED_CLIENT_STREAMED_REGISTRATION && SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE
+        sn_nsdl_reset_registration_stream(handle);
+#endif
         handle->sn_nsdl_free(register_message_ptr->payload_ptr);
         register_message_ptr->payload_ptr = NULL;
 
@@ -328,7 +365,7 @@ int32_t sn_nsdl_register_endpoint(struct nsdl_s *handle,
     sn_nsdl_add_token(handle, &handle->register_token, register_message_ptr);
 
     /* Build and send coap message to NSP */
-    message_id = sn_nsdl_internal_coap_send(handle, register_message_ptr, &handle->server_address);
+    message_id = sn_nsdl_internal_coap_send_registration(handle, register_message_ptr, &handle->server_address);
 
     handle->sn_nsdl_free(register_message_ptr->payload_ptr);
     register_message_ptr->payload_ptr = NULL;
@@ -463,8 +500,8 @@ int32_t sn_nsdl_update_registration(struct nsdl_s *handle, uint8_t *lt_ptr, uint
     register_message_ptr->msg_type = COAP_MSG_TYPE_CONFIRMABLE;
     register_message_ptr->msg_code = COAP_MSG_CODE_REQUEST_POST;
 
-    /* Register update message content format must be same as register messages content format which is Core Link Format  */
-    register_message_ptr->content_format = COAP_CT_LINK_FORMAT;
+    /* Register update message content format must be same as register messages content format */
+    register_message_ptr->content_format = sn_nsdl_get_registration_content_format(handle);
 
     if (handle->ep_information_ptr->location_ptr) {
         register_message_ptr->uri_path_len  =   handle->ep_information_ptr->location_len;    /* = Only location set by Device Server*/
@@ -524,10 +561,14 @@ int32_t sn_nsdl_update_registration(struct nsdl_s *handle, uint8_t *lt_ptr, uint
 
     sn_nsdl_add_token(handle, &handle->update_register_token, register_message_ptr);
 
-    tr_info("UPDATE REGISTER MESSAGE %.*s", register_message_ptr->payload_len, register_message_ptr->payload_ptr);
+    if (register_message_ptr->content_format == COAP_CT_LINK_FORMAT) {
+        tr_info("UPDATE REGISTER MESSAGE %.*s", register_message_ptr->payload_len, register_message_ptr->payload_ptr);
+    } else {
+        tr_info("UPDATE REGISTER MESSAGE: %d bytes, content format %d", register_message_ptr->payload_len, register_message_ptr->content_format);
+    }
 
     /* Build and send coap message to NSP */
-    message_id = sn_nsdl_internal_coap_send(handle, register_message_ptr, &handle->server_address);
+    message_id = sn_nsdl_internal_coap_send_registration(handle, register_message_ptr, &handle->server_address);
 
     register_message_ptr->token_ptr = NULL;
     register_message_ptr->token_len = 0;
@@ -553,6 +594,65 @@ int8_t sn_nsdl_set_endpoint_location(struct nsdl_s *handle, uint8_t *location_pt
     return SN_NSDL_SUCCESS;
 }
 
+#if MBED_CLIENT_REGISTRATION_RESUME
+uint32_t sn_nsdl_get_registration_fingerprint(const struct nsdl_s *handle)
+{
+    if (handle == NULL) {
+        return 0;
+    }
+
+    return handle->registration_fingerprint;
+}
+
+int8_t sn_nsdl_resume_registration(struct nsdl_s *handle, sn_nsdl_ep_parameters_s *endpoint_info_ptr, const char *uri_query_parameters,
+                                   uint32_t fingerprint, uint8_t *location_ptr, uint8_t location_len)
+{
+    if (!handle || !endpoint_info_ptr || !location_ptr || (location_len == 0) || (fingerprint == 0)) {
+        return SN_NSDL_FAILURE;
+    }
+
+    if (sn_nsdl_calculate_registration_fingerprint(handle, endpoint_info_ptr, uri_query_parameters) != fingerprint) {
+        tr_info("sn_nsdl_resume_registration - registration has changed");
+        return SN_NSDL_FAILURE;
+    }
+
+    if (set_endpoint_info(handle, endpoint_info_ptr) == SN_NSDL_FAILURE) {
+        return SN_NSDL_FAILURE;
+    }
+
+    uint8_t *location_copy = handle->sn_nsdl_alloc(location_len);
+    if (!location_copy) {
+        return SN_NSDL_FAILURE;
+    }
+    memcpy(location_copy, location_ptr, location_len);
+    handle->sn_nsdl_free(handle->ep_information_ptr->location_ptr);
+    handle->ep_information_ptr->location_ptr = location_copy;
+    handle->ep_information_ptr->location_len = location_len;
+
+    /* Same state as after the full registration was accepted */
+#if MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+    sn_grs_journal_reset(handle->grs);
+#endif
+    sn_nsdl_dynamic_resource_parameters_s *resource = sn_grs_get_first_resource(handle->grs);
+    while (resource) {
+        if (sn_nsdl_is_resource_to_register(resource, 0)) {
+            if (resource->registered != SN_NDSL_RESOURCE_DELETE) {
+                resource->registered = SN_NDSL_RESOURCE_REGISTERED;
+            }
+#if MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+            sn_grs_journal_retain(handle->grs, resource);
+#endif
+        }
+        resource = sn_grs_get_next_resource(handle->grs, resource);
+    }
+
+    handle->registration_fingerprint = fingerprint;
+    handle->sn_nsdl_endpoint_registered = SN_NSDL_ENDPOINT_IS_REGISTERED;
+
+    return SN_NSDL_SUCCESS;
+}
+#endif
+
 void sn_nsdl_nsp_lost(struct nsdl_s *handle)
 {
     /* Check parameters */
@@ -891,6 +991,22 @@ int8_t sn_nsdl_exec(struct nsdl_s *handle, uint32_t time)
     return sn_coap_protocol_exec(handle->grs->coap, time);
 }
 
+int8_t sn_nsdl_set_time(struct nsdl_s *handle, uint32_t time)
+{
+    if (!handle || !handle->grs) {
+        return SN_NSDL_FAILURE;
+    }
+    return sn_coap_protocol_set_time(handle->grs->coap, time);
+}
+
+uint32_t sn_nsdl_get_next_exec_time(struct nsdl_s *handle)
+{
+    if (!handle || !handle->grs) {
+        return UINT32_MAX;
+    }
+    return sn_coap_protocol_get_next_exec_time(handle->grs->coap);
+}
+
 sn_nsdl_dynamic_resource_parameters_s *sn_nsdl_get_resource(struct nsdl_s *handle, const char *path_ptr)
 {
     /* Check parameters */
@@ -915,6 +1031,47 @@ sn_nsdl_dynamic_resource_parameters_s *sn_nsdl_get_resource(struct nsdl_s *handl
  * \return  message id, < 0 if failed
  */
 static int32_t sn_nsdl_internal_coap_send(struct nsdl_s *handle, sn_coap_hdr_s *coap_header_ptr, sn_nsdl_addr_s *dst_addr_ptr)
+{
+    return sn_nsdl_internal_coap_send_with_producer(handle, coap_header_ptr, dst_addr_ptr, NULL);
+}
+
+/**
+ * \fn static int32_t sn_nsdl_internal_coap_send_registration(struct nsdl_s *handle, sn_coap_hdr_s *coap_header_ptr, sn_nsdl_addr_s *dst_addr_ptr)
+ *
+ * \brief To send registration and registration update messages. If the payload is being streamed,
+ *        rest of the blocks are produced while CoAP library sends them.
+ * \param   *handle             Pointer to nsdl-library handle
+ * \param   *coap_header_ptr    Pointer to the CoAP message header to be sent
+ * \param   *dst_addr_ptr       Pointer to the address structure that contains destination address information
+ *
+ * \return  message id, < 0 if failed
+ */
+static int32_t sn_nsdl_internal_coap_send_registration(struct nsdl_s *handle, sn_coap_hdr_s *coap_header_ptr, sn_nsdl_addr_s *dst_addr_ptr)
+{
+#if MBED_CLIENT_STREAMED_REGISTRATION && SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE
+    if (handle->registration_stream_active) {
+        int32_t message_id = sn_nsdl_internal_coap_send_with_producer(handle, coap_header_ptr, dst_addr_ptr, sn_nsdl_produce_registration_body);
+        if (message_id < 0) {
+            sn_nsdl_reset_registration_stream(handle);
+        }
+        return message_id;
+    }
+#endif
+    return sn_nsdl_internal_coap_send(handle, coap_header_ptr, dst_addr_ptr);
+}
+
+/**
+ * \fn static int32_t sn_nsdl_internal_coap_send_with_producer(struct nsdl_s *handle, sn_coap_hdr_s *coap_header_ptr, sn_nsdl_addr_s *dst_addr_ptr, sn_coap_payload_producer_cb producer)
+ *
+ * \brief To send NSDL messages, optionally with payload produced block by block
+ * \param   *handle             Pointer to nsdl-library handle
+ * \param   *coap_header_ptr    Pointer to the CoAP message header to be sent
+ * \param   *dst_addr_ptr       Pointer to the address structure that contains destination address information
+ * \param   producer            Producer of the blocks following the payload in header, NULL if payload is complete
+ *
+ * \return  message id, < 0 if failed
+ */
+static int32_t sn_nsdl_internal_coap_send_with_producer(struct nsdl_s *handle, sn_coap_hdr_s *coap_header_ptr, sn_nsdl_addr_s *dst_addr_ptr, sn_coap_payload_producer_cb producer)
 {
     uint8_t     *coap_message_ptr   = NULL;
     int32_t     coap_message_len    = 0;
@@ -938,13 +1095,21 @@ static int32_t sn_nsdl_internal_coap_send(struct nsdl_s *handle, sn_coap_hdr_s *
     }
 
     /* Build message */
-    int16_t ret = sn_coap_protocol_build(handle->grs->coap, dst_addr_ptr, coap_message_ptr, coap_header_ptr, (void *)handle);
+    int16_t ret;
+    if (producer) {
+        ret = sn_coap_protocol_build_stream(handle->grs->coap, dst_addr_ptr, coap_message_ptr, coap_header_ptr, producer, (void *)handle);
+    } else {
+        ret = sn_coap_protocol_build(handle->grs->coap, dst_addr_ptr, coap_message_ptr, coap_header_ptr, (void *)handle);
+    }
     if (ret < 0) {
         handle->sn_nsdl_free(coap_message_ptr);
         return ret;
     }
 
-    handle->sn_nsdl_tx_callback(handle, SN_NSDL_PROTOCOL_COAP, coap_message_ptr, coap_message_len, dst_addr_ptr);
+    /* Nothing to send now, if CoAP library stored the message for sending later */
+    if (ret > 0) {
+        handle->sn_nsdl_tx_callback(handle, SN_NSDL_PROTOCOL_COAP, coap_message_ptr, coap_message_len, dst_addr_ptr);
+    }
     handle->sn_nsdl_free(coap_message_ptr);
 
     return coap_header_ptr->msg_id;
@@ -983,6 +1148,273 @@ static char *sn_nsdl_build_resource_attribute_str(char *dst, const sn_nsdl_attri
 }
 #endif
 
+/**
+ * \fn static bool sn_nsdl_is_resource_to_register(const sn_nsdl_dynamic_resource_parameters_s *resource, uint8_t updating_registeration)
+ *
+ * \brief   Checks if resource is included to registration message payload
+ * \param   *resource               Pointer to resource
+ * \param   updating_registeration  Non zero if payload is for registration update
+ *
+ * \return  true if resource is included
+ */
+static bool sn_nsdl_is_resource_to_register(const sn_nsdl_dynamic_resource_parameters_s *resource, uint8_t updating_registeration)
+{
+    if (!resource->publish_uri) {
+        return false;
+    }
+
+    if (!resource->always_publish && updating_registeration && resource->registered == SN_NDSL_RESOURCE_REGISTERED) {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * \fn static sn_coap_content_format_e sn_nsdl_get_registration_content_format(const struct nsdl_s *handle)
+ *
+ * \brief   Returns content format of registration and registration update payloads
+ * \param   *handle Pointer to nsdl-library handle
+ *
+ * \return  COAP_CT_LINK_FORMAT_CBOR until server has rejected it, otherwise COAP_CT_LINK_FORMAT
+ */
+static sn_coap_content_format_e sn_nsdl_get_registration_content_format(const struct nsdl_s *handle)
+{
+#if MBED_CLIENT_CBOR_REGISTRATION
+    if (handle->registration_cbor) {
+        return COAP_CT_LINK_FORMAT_CBOR;
+    }
+#else
+    (void)handle;
+#endif
+    return COAP_CT_LINK_FORMAT;
+}
+
+/**
+ * \fn static bool sn_nsdl_use_registration_journal(const struct nsdl_s *handle, uint8_t updating_registeration)
+ *
+ * \brief   Checks if registration message payload is built from the change journal instead of all resources
+ * \param   *handle                 Pointer to nsdl-library handle
+ * \param   updating_registeration  Non zero if payload is for registration update
+ *
+ * \return  true if only journaled resources are walked
+ */
+static bool sn_nsdl_use_registration_journal(const struct nsdl_s *handle, uint8_t updating_registeration)
+{
+#if MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+    return updating_registeration && !handle->grs->registration_journal_overflow;
+#else
+    (void)handle;
+    (void)updating_registeration;
+    return false;
+#endif
+}
+
+/**
+ * \fn static sn_nsdl_dynamic_resource_parameters_s *sn_nsdl_get_first_registration_resource(struct nsdl_s *handle, bool use_journal, uint16_t *index)
+ *
+ * \brief   Returns first candidate resource for registration message payload
+ * \param   *handle         Pointer to nsdl-library handle
+ * \param   use_journal     Walk journaled resources only, see sn_nsdl_use_registration_journal()
+ * \param   *index          Position of the walk, passed on to sn_nsdl_get_next_registration_resource()
+ *
+ * \return  Pointer to resource, NULL if none
+ */
+static sn_nsdl_dynamic_resource_parameters_s *sn_nsdl_get_first_registration_resource(struct nsdl_s *handle, bool use_journal, uint16_t *index)
+{
+    *index = 0;
+#if MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+    if (use_journal) {
+        return handle->grs->registration_journal_count ? handle->grs->registration_journal[0] : NULL;
+    }
+#else
+    (void)use_journal;
+#endif
+    return sn_grs_get_first_resource(handle->grs);
+}
+
+/**
+ * \fn static sn_nsdl_dynamic_resource_parameters_s *sn_nsdl_get_next_registration_resource(struct nsdl_s *handle, const sn_nsdl_dynamic_resource_parameters_s *resource, bool use_journal, uint16_t *index)
+ *
+ * \brief   Returns next candidate resource for registration message payload
+ * \param   *handle         Pointer to nsdl-library handle
+ * \param   *resource       Current resource
+ * \param   use_journal     Walk journaled resources only
+ * \param   *index          Position of the walk
+ *
+ * \return  Pointer to resource, NULL if no more resources
+ */
+static sn_nsdl_dynamic_resource_parameters_s *sn_nsdl_get_next_registration_resource(struct nsdl_s *handle, const sn_nsdl_dynamic_resource_parameters_s *resource,
+                                                                                     bool use_journal, uint16_t *index)
+{
+#if MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+    if (use_journal) {
+        (*index)++;
+        return (*index < handle->grs->registration_journal_count) ? handle->grs->registration_journal[*index] : NULL;
+    }
+#else
+    (void)use_journal;
+    (void)index;
+#endif
+    return sn_grs_get_next_resource(handle->grs, resource);
+}
+
+/**
+ * \fn static uint8_t *sn_nsdl_build_resource_entry(struct nsdl_s *handle, sn_nsdl_dynamic_resource_parameters_s *resource_temp_ptr, uint8_t *temp_ptr)
+ *
+ * \brief   Writes link format entry of one resource, without separator
+ * \param   *handle             Pointer to nsdl-library handle
+ * \param   *resource_temp_ptr  Pointer to resource
+ * \param   *temp_ptr           Destination, must have room for sn_nsdl_calculate_resource_entry_size() bytes
+ *
+ * \return  Pointer to the byte following the entry
+ */
+static uint8_t *sn_nsdl_build_resource_entry(struct nsdl_s *handle, sn_nsdl_dynamic_resource_parameters_s *resource_temp_ptr, uint8_t *temp_ptr)
+{
+    *temp_ptr++ = '<';
+    *temp_ptr++ = '/';
+    size_t path_len = 0;
+    if (resource_temp_ptr->static_resource_parameters->path) {
+        path_len = strlen(resource_temp_ptr->static_resource_parameters->path);
+    }
+    memcpy(temp_ptr,
+           resource_temp_ptr->static_resource_parameters->path,
+           path_len);
+    temp_ptr += path_len;
+    *temp_ptr++ = '>';
+
+    /* Resource attributes */
+    if (resource_temp_ptr->registered == SN_NDSL_RESOURCE_DELETE) {
+        *temp_ptr++ = ';';
+        *temp_ptr++ = 'd';
+    }
+#ifndef RESOURCE_ATTRIBUTES_LIST
+#ifndef DISABLE_RESOURCE_TYPE
+    size_t resource_type_len = 0;
+    if (resource_temp_ptr->static_resource_parameters->resource_type_ptr) {
+        resource_type_len = strlen(resource_temp_ptr->static_resource_parameters->resource_type_ptr);
+    }
+    if (resource_type_len) {
+        *temp_ptr++ = ';';
+        memcpy(temp_ptr, resource_type_parameter, RT_PARAMETER_LEN);
+        temp_ptr += RT_PARAMETER_LEN;
+        *temp_ptr++ = '"';
+        memcpy(temp_ptr,
+               resource_temp_ptr->static_resource_parameters->resource_type_ptr,
+               resource_type_len);
+        temp_ptr += resource_type_len;
+        *temp_ptr++ = '"';
+    }
+#endif
+#ifndef DISABLE_INTERFACE_DESCRIPTION
+    size_t interface_description_len = 0;
+    if (resource_temp_ptr->static_resource_parameters->interface_description_ptr) {
+        interface_description_len = strlen(resource_temp_ptr->static_resource_parameters->interface_description_ptr);
+    }
+
+    if (interface_description_len) {
+        *temp_ptr++ = ';';
+        memcpy(temp_ptr, if_description_parameter, IF_PARAMETER_LEN);
+        temp_ptr += IF_PARAMETER_LEN;
+        *temp_ptr++ = '"';
+        memcpy(temp_ptr,
+               resource_temp_ptr->static_resource_parameters->interface_description_ptr,
+               interface_description_len);
+        temp_ptr += interface_description_len;
+        *temp_ptr++ = '"';
+    }
+#endif
+#else
+    size_t attribute_len = 0;
+    if (resource_temp_ptr->static_resource_parameters->attributes_ptr) {
+        sn_nsdl_attribute_item_s *attribute = resource_temp_ptr->static_resource_parameters->attributes_ptr;
+        while (attribute->attribute_name != ATTR_END) {
+            switch (attribute->attribute_name) {
+                case ATTR_RESOURCE_TYPE:
+                    temp_ptr = sn_nsdl_build_resource_attribute_str(temp_ptr, attribute, resource_type_parameter, RT_PARAMETER_LEN);
+                    break;
+                case ATTR_INTERFACE_DESCRIPTION:
+                    temp_ptr = sn_nsdl_build_resource_attribute_str(temp_ptr, attribute, if_description_parameter, IF_PARAMETER_LEN);
+                    break;
+                case ATTR_ENDPOINT_NAME:
+                    temp_ptr = sn_nsdl_build_resource_attribute_str(temp_ptr, attribute, name_parameter, NAME_PARAMETER_LEN);
+                    break;
+                default:
+                    break;
+            }
+            attribute++;
+        }
+    }
+#endif
+    if (resource_temp_ptr->coap_content_type != 0) {
+        *temp_ptr++ = ';';
+        memcpy(temp_ptr, coap_con_type_parameter, COAP_CON_PARAMETER_LEN);
+        temp_ptr += COAP_CON_PARAMETER_LEN;
+        *temp_ptr++ = '"';
+        temp_ptr = sn_nsdl_itoa(temp_ptr,
+                                resource_temp_ptr->coap_content_type);
+        *temp_ptr++ = '"';
+    }
+
+    /* ;v */
+    if ((resource_temp_ptr->publish_value > 0) && resource_temp_ptr->resource) {
+        // If the resource is Opaque then do Base64 encoding of data
+        if (resource_temp_ptr->publish_value == 2) {
+            size_t dst_size = (((resource_temp_ptr->resource_len + 2) / 3) << 2) + 1;
+            unsigned char *dst = (unsigned char *)handle->sn_nsdl_alloc(dst_size);
+            size_t olen = 0;
+            if (dst) {
+                if (mbedtls_base64_encode(dst, dst_size, &olen,
+                                          resource_temp_ptr->resource, resource_temp_ptr->resource_len) == 0) {
+                    *temp_ptr++ = ';';
+                    memcpy(temp_ptr, resource_value, RESOURCE_VALUE_PARAMETER_LEN);
+                    temp_ptr += RESOURCE_VALUE_PARAMETER_LEN;
+                    *temp_ptr++ = '"';
+                    memcpy(temp_ptr, dst, olen);
+                    temp_ptr += olen;
+                    *temp_ptr++ = '"';
+
+                }
+                handle->sn_nsdl_free(dst);
+            }
+
+        } else {      // For resources which does not require Base64 encoding of data
+            *temp_ptr++ = ';';
+            memcpy(temp_ptr, resource_value, RESOURCE_VALUE_PARAMETER_LEN);
+            temp_ptr += RESOURCE_VALUE_PARAMETER_LEN;
+            *temp_ptr++ = '"';
+            memcpy(temp_ptr, resource_temp_ptr->resource, resource_temp_ptr->resource_len);
+            temp_ptr += resource_temp_ptr->resource_len;
+            *temp_ptr++ = '"';
+        }
+    }
+
+    /* ;aobs / ;obs */
+    // This needs to be re-visited and may be need an API for maganging obs value for different server implementation
+#ifndef COAP_DISABLE_OBS_FEATURE
+    if (resource_temp_ptr->auto_observable) {
+        uint8_t token[MAX_TOKEN_SIZE] = {0};
+        uint8_t len = handle->sn_nsdl_auto_obs_token_callback(handle,
+                                                              resource_temp_ptr->static_resource_parameters->path,
+                                                              (uint8_t *)token);
+        if (len > 0) {
+            *temp_ptr++ = ';';
+            memcpy(temp_ptr, aobs_parameter, AOBS_PARAMETER_LEN);
+            temp_ptr += AOBS_PARAMETER_LEN;
+            *temp_ptr++ = '"';
+            uint16_t temp = common_read_16_bit((uint8_t *)token);
+            temp_ptr = sn_nsdl_itoa(temp_ptr, temp);
+            *temp_ptr++ = '"';
+        }
+    } else if (resource_temp_ptr->observable) {
+        *temp_ptr++ = ';';
+        memcpy(temp_ptr, obs_parameter, OBS_PARAMETER_LEN);
+        temp_ptr += OBS_PARAMETER_LEN;
+    }
+#endif
+    return temp_ptr;
+}
+
 /**
  * \fn int8_t sn_nsdl_build_registration_body(struct nsdl_s *handle, sn_coap_hdr_s *message_ptr, uint8_t updating_registeration)
  *
@@ -998,6 +1430,22 @@ int8_t sn_nsdl_build_registration_body(struct nsdl_s *handle, sn_coap_hdr_s *mes
     /* Local variables */
     uint8_t                 *temp_ptr;
     sn_nsdl_dynamic_resource_parameters_s   *resource_temp_ptr;
+    uint16_t                journal_index;
+    bool                    use_journal = sn_nsdl_use_registration_journal(handle, updating_registeration);
+
+#if MBED_CLIENT_CBOR_REGISTRATION
+    if (message_ptr->content_format == COAP_CT_LINK_FORMAT_CBOR) {
+        return sn_nsdl_build_registration_body_cbor(handle, message_ptr, updating_registeration);
+    }
+#endif
+
+#if MBED_CLIENT_STREAMED_REGISTRATION && SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE
+    /* Only one registration body can be streamed at a time, any other is built in one piece.
+     * Journaled updates are small, so they are not streamed either. */
+    if (handle->grs->coap->sn_coap_block_data_size && !handle->registration_stream_active && !use_journal) {
+        return sn_nsdl_start_registration_stream(handle, message_ptr, updating_registeration);
+    }
+#endif
 
     /* Calculate needed memory and allocate */
     int8_t error = 0;
@@ -1007,6 +1455,13 @@ int8_t sn_nsdl_build_registration_body(struct nsdl_s *handle, sn_coap_hdr_s *mes
     }
 
     if (!msg_len) {
+#if MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+        if (use_journal) {
+            sn_grs_journal_commit(handle->grs);
+        } else {
+            sn_grs_journal_reset(handle->grs);
+        }
+#endif
         return SN_NSDL_SUCCESS;
     } else {
         message_ptr->payload_len = msg_len;
@@ -1020,16 +1475,20 @@ int8_t sn_nsdl_build_registration_body(struct nsdl_s *handle, sn_coap_hdr_s *mes
     /* Build message */
     temp_ptr = message_ptr->payload_ptr;
 
-    resource_temp_ptr = sn_grs_get_first_resource(handle->grs);
+#if MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+    /* All resources are published, journal restarts with the ones published again in next update */
+    if (!use_journal) {
+        sn_grs_journal_reset(handle->grs);
+    }
+#endif
+
+    resource_temp_ptr = sn_nsdl_get_first_registration_resource(handle, use_journal, &journal_index);
 
     /* Loop trough all resources */
     while (resource_temp_ptr) {
         /* if resource needs to be registered */
-        if (resource_temp_ptr->publish_uri) {
-            if (!resource_temp_ptr->always_publish && updating_registeration && resource_temp_ptr->registered == SN_NDSL_RESOURCE_REGISTERED) {
-                resource_temp_ptr = sn_grs_get_next_resource(handle->grs, resource_temp_ptr);
-                continue;
-            } else if (resource_temp_ptr->registered != SN_NDSL_RESOURCE_DELETE) {
+        if (sn_nsdl_is_resource_to_register(resource_temp_ptr, updating_registeration)) {
+            if (resource_temp_ptr->registered != SN_NDSL_RESOURCE_DELETE) {
                 resource_temp_ptr->registered = SN_NDSL_RESOURCE_REGISTERED;
             }
 
@@ -1038,185 +1497,230 @@ int8_t sn_nsdl_build_registration_body(struct nsdl_s *handle, sn_coap_hdr_s *mes
                 *temp_ptr++ = ',';
             }
 
-            *temp_ptr++ = '<';
-            *temp_ptr++ = '/';
-            size_t path_len = 0;
-            if (resource_temp_ptr->static_resource_parameters->path) {
-                path_len = strlen(resource_temp_ptr->static_resource_parameters->path);
-            }
-            memcpy(temp_ptr,
-                   resource_temp_ptr->static_resource_parameters->path,
-                   path_len);
-            temp_ptr += path_len;
-            *temp_ptr++ = '>';
-
-            /* Resource attributes */
-            if (resource_temp_ptr->registered == SN_NDSL_RESOURCE_DELETE) {
-                *temp_ptr++ = ';';
-                *temp_ptr++ = 'd';
-            }
-#ifndef RESOURCE_ATTRIBUTES_LIST
-#ifndef DISABLE_RESOURCE_TYPE
-            size_t resource_type_len = 0;
-            if (resource_temp_ptr->static_resource_parameters->resource_type_ptr) {
-                resource_type_len = strlen(resource_temp_ptr->static_resource_parameters->resource_type_ptr);
-            }
-            if (resource_type_len) {
-                *temp_ptr++ = ';';
-                memcpy(temp_ptr, resource_type_parameter, RT_PARAMETER_LEN);
-                temp_ptr += RT_PARAMETER_LEN;
-                *temp_ptr++ = '"';
-                memcpy(temp_ptr,
-                       resource_temp_ptr->static_resource_parameters->resource_type_ptr,
-                       resource_type_len);
-                temp_ptr += resource_type_len;
-                *temp_ptr++ = '"';
-            }
-#endif
-#ifndef DISABLE_INTERFACE_DESCRIPTION
-            size_t interface_description_len = 0;
-            if (resource_temp_ptr->static_resource_parameters->interface_description_ptr) {
-                interface_description_len = strlen(resource_temp_ptr->static_resource_parameters->interface_description_ptr);
-            }
-
-            if (interface_description_len) {
-                *temp_ptr++ = ';';
-                memcpy(temp_ptr, if_description_parameter, IF_PARAMETER_LEN);
-                temp_ptr += IF_PARAMETER_LEN;
-                *temp_ptr++ = '"';
-                memcpy(temp_ptr,
-                       resource_temp_ptr->static_resource_parameters->interface_description_ptr,
-                       interface_description_len);
-                temp_ptr += interface_description_len;
-                *temp_ptr++ = '"';
-            }
-#endif
-#else
-            size_t attribute_len = 0;
-            if (resource_temp_ptr->static_resource_parameters->attributes_ptr) {
-                sn_nsdl_attribute_item_s *attribute = resource_temp_ptr->static_resource_parameters->attributes_ptr;
-                while (attribute->attribute_name != ATTR_END) {
-                    switch (attribute->attribute_name) {
-                        case ATTR_RESOURCE_TYPE:
-                            temp_ptr = sn_nsdl_build_resource_attribute_str(temp_ptr, attribute, resource_type_parameter, RT_PARAMETER_LEN);
-                            break;
-                        case ATTR_INTERFACE_DESCRIPTION:
-                            temp_ptr = sn_nsdl_build_resource_attribute_str(temp_ptr, attribute, if_description_parameter, IF_PARAMETER_LEN);
-                            break;
-                        case ATTR_ENDPOINT_NAME:
-                            temp_ptr = sn_nsdl_build_resource_attribute_str(temp_ptr, attribute, name_parameter, NAME_PARAMETER_LEN);
-                            break;
-                        default:
-                            break;
-                    }
-                    attribute++;
-                }
-            }
-#endif
-            if (resource_temp_ptr->coap_content_type != 0) {
-                *temp_ptr++ = ';';
-                memcpy(temp_ptr, coap_con_type_parameter, COAP_CON_PARAMETER_LEN);
-                temp_ptr += COAP_CON_PARAMETER_LEN;
-                *temp_ptr++ = '"';
-                temp_ptr = sn_nsdl_itoa(temp_ptr,
-                                        resource_temp_ptr->coap_content_type);
-                *temp_ptr++ = '"';
-            }
-
-            /* ;v */
-            if ((resource_temp_ptr->publish_value > 0) && resource_temp_ptr->resource) {
-                // If the resource is Opaque then do Base64 encoding of data
-                if (resource_temp_ptr->publish_value == 2) {
-                    size_t dst_size = (((resource_temp_ptr->resource_len + 2) / 3) << 2) + 1;
-                    unsigned char *dst = (unsigned char *)handle->sn_nsdl_alloc(dst_size);
-                    size_t olen = 0;
-                    if (dst) {
-                        if (mbedtls_base64_encode(dst, dst_size, &olen,
-                                                  resource_temp_ptr->resource, resource_temp_ptr->resource_len) == 0) {
-                            *temp_ptr++ = ';';
-                            memcpy(temp_ptr, resource_value, RESOURCE_VALUE_PARAMETER_LEN);
-                            temp_ptr += RESOURCE_VALUE_PARAMETER_LEN;
-                            *temp_ptr++ = '"';
-                            memcpy(temp_ptr, dst, olen);
-                            temp_ptr += olen;
-                            *temp_ptr++ = '"';
-
-                        }
-                        handle->sn_nsdl_free(dst);
-                    }
-
-                } else {      // For resources which does not require Base64 encoding of data
-                    *temp_ptr++ = ';';
-                    memcpy(temp_ptr, resource_value, RESOURCE_VALUE_PARAMETER_LEN);
-                    temp_ptr += RESOURCE_VALUE_PARAMETER_LEN;
-                    *temp_ptr++ = '"';
-                    memcpy(temp_ptr, resource_temp_ptr->resource, resource_temp_ptr->resource_len);
-                    temp_ptr += resource_temp_ptr->resource_len;
-                    *temp_ptr++ = '"';
-                }
-            }
-
-            /* ;aobs / ;obs */
-            // This needs to be re-visited and may be need an API for maganging obs value for different server implementation
-#ifndef COAP_DISABLE_OBS_FEATURE
-            if (resource_temp_ptr->auto_observable) {
-                uint8_t token[MAX_TOKEN_SIZE] = {0};
-                uint8_t len = handle->sn_nsdl_auto_obs_token_callback(handle,
-                                                                      resource_temp_ptr->static_resource_parameters->path,
-                                                                      (uint8_t *)token);
-                if (len > 0) {
-                    *temp_ptr++ = ';';
-                    memcpy(temp_ptr, aobs_parameter, AOBS_PARAMETER_LEN);
-                    temp_ptr += AOBS_PARAMETER_LEN;
-                    *temp_ptr++ = '"';
-                    uint16_t temp = common_read_16_bit((uint8_t *)token);
-                    temp_ptr = sn_nsdl_itoa(temp_ptr, temp);
-                    *temp_ptr++ = '"';
-                }
-            } else if (resource_temp_ptr->observable) {
-                *temp_ptr++ = ';';
-                memcpy(temp_ptr, obs_parameter, OBS_PARAMETER_LEN);
-                temp_ptr += OBS_PARAMETER_LEN;
+            temp_ptr = sn_nsdl_build_resource_entry(handle, resource_temp_ptr, temp_ptr);
+#if MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+            if (!use_journal) {
+                sn_grs_journal_retain(handle->grs, resource_temp_ptr);
             }
 #endif
         }
-        resource_temp_ptr = sn_grs_get_next_resource(handle->grs, resource_temp_ptr);
+        resource_temp_ptr = sn_nsdl_get_next_registration_resource(handle, resource_temp_ptr, use_journal, &journal_index);
+
+    }
 
+#if MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+    if (use_journal) {
+        sn_grs_journal_commit(handle->grs);
     }
+#endif
     return SN_NSDL_SUCCESS;
 }
 
 /**
- * \fn static uint16_t sn_nsdl_calculate_registration_body_size(struct nsdl_s *handle, uint8_t updating_registeration, int8_t *error)
+ * \fn static uint16_t sn_nsdl_calculate_resource_entry_size(struct nsdl_s *handle, const sn_nsdl_dynamic_resource_parameters_s *resource_temp_ptr, int8_t *error)
  *
  *
- * \brief   Calculates registration message payload size
- * \param   *handle                 Pointer to nsdl-library handle
- * \param   *updating_registeration Pointer to list of GRS resources
- * \param   *error                  Error code, SN_NSDL_SUCCESS or SN_NSDL_FAILURE
+ * \brief   Calculates size of link format entry of one resource, without separator
+ * \param   *handle             Pointer to nsdl-library handle
+ * \param   *resource_temp_ptr  Pointer to resource
+ * \param   *error              Error code, SN_NSDL_SUCCESS or SN_NSDL_FAILURE
  *
- * \return  Needed payload size
+ * \return  Needed entry size
  */
-static uint16_t sn_nsdl_calculate_registration_body_size(struct nsdl_s *handle, uint8_t updating_registeration, int8_t *error)
+static uint16_t sn_nsdl_calculate_resource_entry_size(struct nsdl_s *handle, const sn_nsdl_dynamic_resource_parameters_s *resource_temp_ptr, int8_t *error)
 {
-    tr_debug("sn_nsdl_calculate_registration_body_size");
-    /* Local variables */
     uint16_t return_value = 0;
     *error = SN_NSDL_SUCCESS;
-    const sn_nsdl_dynamic_resource_parameters_s *resource_temp_ptr;
 
-    /* check pointer */
-    resource_temp_ptr = sn_grs_get_first_resource(handle->grs);
+    /* Count length for the resource path </path> */
+    size_t path_len = 0;
+    if (resource_temp_ptr->static_resource_parameters->path) {
+        path_len = strlen(resource_temp_ptr->static_resource_parameters->path);
+    }
 
-    while (resource_temp_ptr) {
-        if (resource_temp_ptr->publish_uri) {
-            if (!resource_temp_ptr->always_publish && updating_registeration && resource_temp_ptr->registered == SN_NDSL_RESOURCE_REGISTERED) {
-                resource_temp_ptr = sn_grs_get_next_resource(handle->grs, resource_temp_ptr);
-                continue;
-            }
-            /* If not first resource, then '.' will be added */
-            if (return_value) {
-                if (sn_nsdl_check_uint_overflow(return_value, 1, 0)) {
+    if (sn_nsdl_check_uint_overflow(return_value, 3, path_len)) {
+        return_value += (3 + path_len);
+    } else {
+        *error = SN_NSDL_FAILURE;
+        return 0;
+    }
+
+    /* Count lengths of the attributes */
+    if (resource_temp_ptr->registered == SN_NDSL_RESOURCE_DELETE) {
+        return_value += 2;
+    }
+#ifndef RESOURCE_ATTRIBUTES_LIST
+#ifndef DISABLE_RESOURCE_TYPE
+    /* Resource type parameter */
+    size_t resource_type_len = 0;
+    if (resource_temp_ptr->static_resource_parameters->resource_type_ptr) {
+        resource_type_len = strlen(resource_temp_ptr->static_resource_parameters->resource_type_ptr);
+    }
+
+    if (resource_type_len) {
+        /* ;rt="restype" */
+        if (sn_nsdl_check_uint_overflow(return_value,
+                                        6,
+                                        resource_type_len)) {
+            return_value += (6 + resource_type_len);
+        } else {
+            *error = SN_NSDL_FAILURE;
+            return 0;
+        }
+    }
+#endif
+
+#ifndef DISABLE_INTERFACE_DESCRIPTION
+    /* Interface description parameter */
+    size_t interface_description_len = 0;
+    if (resource_temp_ptr->static_resource_parameters->interface_description_ptr) {
+        interface_description_len = strlen(resource_temp_ptr->static_resource_parameters->interface_description_ptr);
+    }
+    if (interface_description_len) {
+        /* ;if="iftype" */
+        if (sn_nsdl_check_uint_overflow(return_value,
+                                        6,
+                                        interface_description_len)) {
+            return_value += (6 + interface_description_len);
+        } else {
+            *error = SN_NSDL_FAILURE;
+            return 0;
+        }
+    }
+#endif
+#else
+    /* All attributes */
+    if (resource_temp_ptr->static_resource_parameters->attributes_ptr) {
+        size_t attribute_len = 0;
+        size_t attribute_desc_len = 0;
+        uint8_t success = 1;
+        sn_nsdl_attribute_item_s *item = resource_temp_ptr->static_resource_parameters->attributes_ptr;
+        while (item->attribute_name != ATTR_END) {
+            switch (item->attribute_name) {
+                case ATTR_RESOURCE_TYPE:
+                    /* ;rt="restype" */
+                    attribute_desc_len = 6;
+                    attribute_len = strlen(item->value);
+                    break;
+                case ATTR_INTERFACE_DESCRIPTION:
+                    /* ;if="iftype" */
+                    attribute_desc_len = 6;
+                    attribute_len = strlen(item->value);
+                    break;
+                case ATTR_ENDPOINT_NAME:
+                    /* ;name="name" */
+                    attribute_desc_len = 8;
+                    attribute_len = strlen(item->value);
+                    break;
+                default:
+                    break;
+            }
+            if (sn_nsdl_check_uint_overflow(return_value,
+                                            attribute_desc_len,
+                                            attribute_len)) {
+                return_value += (attribute_desc_len + attribute_len);
+            } else {
+                success = 0;
+                break;
+            }
+            item++;
+        }
+        if (!success) {
+            *error = SN_NSDL_FAILURE;
+            return 0;
+        }
+    }
+#endif
+    if (resource_temp_ptr->coap_content_type != 0) {
+        /* ;if="content" */
+        uint8_t len = sn_nsdl_itoa_len(resource_temp_ptr->coap_content_type);
+        if (sn_nsdl_check_uint_overflow(return_value, 6, len)) {
+            return_value += (6 + len);
+        } else {
+            *error = SN_NSDL_FAILURE;
+            return 0;
+        }
+    }
+
+    if ((resource_temp_ptr->publish_value > 0) && resource_temp_ptr->resource) {
+        /* ;v="" */
+        uint16_t len = resource_temp_ptr->resource_len;
+        if (resource_temp_ptr->publish_value == 2) {
+            len = (((resource_temp_ptr->resource_len + 2) / 3) << 2);
+        }
+        if (sn_nsdl_check_uint_overflow(return_value, 5, len)) {
+            return_value += 5 + len;
+        } else {
+            *error = SN_NSDL_FAILURE;
+            return 0;
+        }
+        /* ;v="" */
+    }
+
+#ifndef COAP_DISABLE_OBS_FEATURE
+    // Auto obs will take higher priority
+    // This needs to be re-visited and may be need an API for maganging obs value for different server implementation
+    if (resource_temp_ptr->auto_observable) {
+        /* ;aobs="" */
+        uint8_t token[MAX_TOKEN_SIZE] = {0};
+        uint8_t len = handle->sn_nsdl_auto_obs_token_callback(handle,
+                                                              resource_temp_ptr->static_resource_parameters->path,
+                                                              (uint8_t *)token);
+
+        if (len > 0) {
+            uint16_t temp = common_read_16_bit((uint8_t *)token);
+            uint8_t token_len = sn_nsdl_itoa_len(temp);
+            if (sn_nsdl_check_uint_overflow(return_value, 8, token_len)) {
+                return_value += (8 + token_len);
+            } else {
+                *error = SN_NSDL_FAILURE;
+                return 0;
+            }
+        } else {
+            *error = SN_NSDL_FAILURE;
+            return 0;
+        }
+    } else if (resource_temp_ptr->observable) {
+        if (sn_nsdl_check_uint_overflow(return_value, 4, 0)) {
+            return_value += 4;
+        } else {
+            *error = SN_NSDL_FAILURE;
+            return 0;
+        }
+    }
+#endif
+    return return_value;
+}
+
+/**
+ * \fn static uint16_t sn_nsdl_calculate_registration_body_size(struct nsdl_s *handle, uint8_t updating_registeration, int8_t *error)
+ *
+ *
+ * \brief   Calculates registration message payload size
+ * \param   *handle                 Pointer to nsdl-library handle
+ * \param   *updating_registeration Pointer to list of GRS resources
+ * \param   *error                  Error code, SN_NSDL_SUCCESS or SN_NSDL_FAILURE
+ *
+ * \return  Needed payload size
+ */
+static uint16_t sn_nsdl_calculate_registration_body_size(struct nsdl_s *handle, uint8_t updating_registeration, int8_t *error)
+{
+    tr_debug("sn_nsdl_calculate_registration_body_size");
+    /* Local variables */
+    uint16_t return_value = 0;
+    *error = SN_NSDL_SUCCESS;
+    const sn_nsdl_dynamic_resource_parameters_s *resource_temp_ptr;
+    uint16_t journal_index;
+    bool use_journal = sn_nsdl_use_registration_journal(handle, updating_registeration);
+
+    /* check pointer */
+    resource_temp_ptr = sn_nsdl_get_first_registration_resource(handle, use_journal, &journal_index);
+
+    while (resource_temp_ptr) {
+        if (sn_nsdl_is_resource_to_register(resource_temp_ptr, updating_registeration)) {
+            /* If not first resource, then '.' will be added */
+            if (return_value) {
+                if (sn_nsdl_check_uint_overflow(return_value, 1, 0)) {
                     return_value++;
                 } else {
                     *error = SN_NSDL_FAILURE;
@@ -1224,169 +1728,566 @@ static uint16_t sn_nsdl_calculate_registration_body_size(struct nsdl_s *handle,
                 }
             }
 
-            /* Count length for the resource path </path> */
-            size_t path_len = 0;
-            if (resource_temp_ptr->static_resource_parameters->path) {
-                path_len = strlen(resource_temp_ptr->static_resource_parameters->path);
+            uint16_t entry_size = sn_nsdl_calculate_resource_entry_size(handle, resource_temp_ptr, error);
+            if (*error == SN_NSDL_FAILURE) {
+                break;
             }
 
-            if (sn_nsdl_check_uint_overflow(return_value, 3, path_len)) {
-                return_value += (3 + path_len);
+            if (sn_nsdl_check_uint_overflow(return_value, entry_size, 0)) {
+                return_value += entry_size;
             } else {
                 *error = SN_NSDL_FAILURE;
                 break;
             }
+        }
+        resource_temp_ptr = sn_nsdl_get_next_registration_resource(handle, resource_temp_ptr, use_journal, &journal_index);
+    }
+    return return_value;
+}
 
-            /* Count lengths of the attributes */
-            if (resource_temp_ptr->registered == SN_NDSL_RESOURCE_DELETE) {
-                return_value += 2;
-            }
-#ifndef RESOURCE_ATTRIBUTES_LIST
-#ifndef DISABLE_RESOURCE_TYPE
-            /* Resource type parameter */
-            size_t resource_type_len = 0;
-            if (resource_temp_ptr->static_resource_parameters->resource_type_ptr) {
-                resource_type_len = strlen(resource_temp_ptr->static_resource_parameters->resource_type_ptr);
-            }
+#if MBED_CLIENT_REGISTRATION_RESUME
+static uint32_t sn_nsdl_fnv1a(uint32_t hash, const void *data, size_t len)
+{
+    const uint8_t *ptr = (const uint8_t *)data;
+    while (len--) {
+        hash ^= *ptr++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
 
-            if (resource_type_len) {
-                /* ;rt="restype" */
-                if (sn_nsdl_check_uint_overflow(return_value,
-                                                6,
-                                                resource_type_len)) {
-                    return_value += (6 + resource_type_len);
-                } else {
-                    *error = SN_NSDL_FAILURE;
+/**
+ * \fn static uint32_t sn_nsdl_calculate_registration_fingerprint(struct nsdl_s *handle, const sn_nsdl_ep_parameters_s *endpoint_info_ptr, const char *uri_query)
+ *
+ * \brief   Calculates FNV-1a hash of the full registration, independent of the payload content format
+ * \param   *handle             Pointer to nsdl-library handle
+ * \param   *endpoint_info_ptr  Endpoint parameters of the registration
+ * \param   *uri_query          Uri query parameters of the registration, may be NULL
+ *
+ * \return  Fingerprint, never 0, or 0 if it could not be calculated
+ */
+static uint32_t sn_nsdl_calculate_registration_fingerprint(struct nsdl_s *handle, const sn_nsdl_ep_parameters_s *endpoint_info_ptr, const char *uri_query)
+{
+    uint32_t hash = 2166136261u;
+    const uint8_t separator = ',';
+
+    hash = sn_nsdl_fnv1a(hash, endpoint_info_ptr->endpoint_name_ptr, endpoint_info_ptr->endpoint_name_len);
+    hash = sn_nsdl_fnv1a(hash, &separator, 1);
+    hash = sn_nsdl_fnv1a(hash, endpoint_info_ptr->domain_name_ptr, endpoint_info_ptr->domain_name_len);
+    hash = sn_nsdl_fnv1a(hash, &separator, 1);
+    hash = sn_nsdl_fnv1a(hash, endpoint_info_ptr->type_ptr, endpoint_info_ptr->type_len);
+    hash = sn_nsdl_fnv1a(hash, &separator, 1);
+    hash = sn_nsdl_fnv1a(hash, endpoint_info_ptr->lifetime_ptr, endpoint_info_ptr->lifetime_len);
+    hash = sn_nsdl_fnv1a(hash, &endpoint_info_ptr->binding_and_mode, sizeof(endpoint_info_ptr->binding_and_mode));
+    hash = sn_nsdl_fnv1a(hash, &endpoint_info_ptr->ds_register_mode, sizeof(endpoint_info_ptr->ds_register_mode));
+    if (uri_query) {
+        hash = sn_nsdl_fnv1a(hash, uri_query, strlen(uri_query));
+    }
+
+    if (endpoint_info_ptr->ds_register_mode == REGISTER_WITH_RESOURCES) {
+        /* Link format entries are hashed one at a time, through a buffer of the longest entry so far */
+        uint8_t *entry = NULL;
+        uint16_t entry_capacity = 0;
+        sn_nsdl_dynamic_resource_parameters_s *resource = sn_grs_get_first_resource(handle->grs);
+        while (resource) {
+            if (sn_nsdl_is_resource_to_register(resource, 0)) {
+                int8_t error;
+                uint16_t entry_size = sn_nsdl_calculate_resource_entry_size(handle, resource, &error);
+                if (error == SN_NSDL_FAILURE) {
                     break;
                 }
+                if (entry_size > entry_capacity) {
+                    handle->sn_nsdl_free(entry);
+                    entry = handle->sn_nsdl_alloc(entry_size);
+                    entry_capacity = entry ? entry_size : 0;
+                    if (!entry) {
+                        break;
+                    }
+                }
+                uint8_t *end = sn_nsdl_build_resource_entry(handle, resource, entry);
+                hash = sn_nsdl_fnv1a(hash, &separator, 1);
+                hash = sn_nsdl_fnv1a(hash, entry, end - entry);
             }
+            resource = sn_grs_get_next_resource(handle->grs, resource);
+        }
+        handle->sn_nsdl_free(entry);
+
+        if (resource) {
+            /* Walk was cut short, registration cannot be resumed with this */
+            return 0;
+        }
+    }
+
+    /* 0 marks a missing fingerprint */
+    return hash ? hash : 1;
+}
 #endif
 
+#if MBED_CLIENT_CBOR_REGISTRATION
+/* Link attribute keys of CBOR link format, attributes without a number are keyed by name */
+#define SN_NSDL_CBOR_LINK_HREF          1
+#define SN_NSDL_CBOR_LINK_RT            9
+#define SN_NSDL_CBOR_LINK_IF            10
+#define SN_NSDL_CBOR_LINK_CT            12
+#define SN_NSDL_CBOR_LINK_OBS           13
+
+/* Running out of buffer is not an error while measuring, encoder keeps counting needed bytes */
+#define SN_NSDL_CBOR_OK(err) ((err) == CborNoError || (err) == CborErrorOutOfMemory)
+
+/**
+ * \fn static CborError sn_nsdl_encode_cbor_text_attribute(CborEncoder *link, uint8_t key, const char *name, const char *value)
+ *
+ * \brief   Encodes text valued link attribute, skipped if value is empty
+ * \param   *link   Map encoder of the link
+ * \param   key     Numeric key, 0 if attribute is keyed by name
+ * \param   *name   Attribute name, used if key is 0
+ * \param   *value  Attribute value, may be NULL
+ *
+ * \return  CborError
+ */
+static CborError sn_nsdl_encode_cbor_text_attribute(CborEncoder *link, uint8_t key, const char *name, const char *value)
+{
+    if (!value || !*value) {
+        return CborNoError;
+    }
+    CborError err = key ? cbor_encode_uint(link, key) : cbor_encode_text_stringz(link, name);
+    if (SN_NSDL_CBOR_OK(err)) {
+        err = cbor_encode_text_stringz(link, value);
+    }
+    return err;
+}
+
+/**
+ * \fn static CborError sn_nsdl_encode_resource_entry_cbor(struct nsdl_s *handle, CborEncoder *links, const sn_nsdl_dynamic_resource_parameters_s *resource_temp_ptr)
+ *
+ * \brief   Encodes one resource as CBOR link format map, same attributes as sn_nsdl_build_resource_entry()
+ * \param   *handle             Pointer to nsdl-library handle
+ * \param   *links              Array encoder of the payload
+ * \param   *resource_temp_ptr  Pointer to resource
+ *
+ * \return  CborError
+ */
+static CborError sn_nsdl_encode_resource_entry_cbor(struct nsdl_s *handle, CborEncoder *links, const sn_nsdl_dynamic_resource_parameters_s *resource_temp_ptr)
+{
+    CborEncoder link;
+    CborError err = cbor_encoder_create_map(links, &link, CborIndefiniteLength);
+
+    /* href is the resource path with leading '/' */
+    const char *path = resource_temp_ptr->static_resource_parameters->path;
+    size_t path_len = path ? strlen(path) : 0;
+    if (SN_NSDL_CBOR_OK(err)) {
+        err = cbor_encode_uint(&link, SN_NSDL_CBOR_LINK_HREF);
+    }
+    if (SN_NSDL_CBOR_OK(err)) {
+        char *href = handle->sn_nsdl_alloc(1 + path_len);
+        if (href) {
+            href[0] = '/';
+            memcpy(href + 1, path, path_len);
+            err = cbor_encode_text_string(&link, href, 1 + path_len);
+            handle->sn_nsdl_free(href);
+        } else {
+            err = CborUnknownError;
+        }
+    }
+
+    if (SN_NSDL_CBOR_OK(err) && resource_temp_ptr->registered == SN_NDSL_RESOURCE_DELETE) {
+        err = cbor_encode_text_stringz(&link, "d");
+        if (SN_NSDL_CBOR_OK(err)) {
+            err = cbor_encode_boolean(&link, true);
+        }
+    }
+
+#ifndef RESOURCE_ATTRIBUTES_LIST
+#ifndef DISABLE_RESOURCE_TYPE
+    if (SN_NSDL_CBOR_OK(err)) {
+        err = sn_nsdl_encode_cbor_text_attribute(&link, SN_NSDL_CBOR_LINK_RT, NULL,
+                                                 resource_temp_ptr->static_resource_parameters->resource_type_ptr);
+    }
+#endif
 #ifndef DISABLE_INTERFACE_DESCRIPTION
-            /* Interface description parameter */
-            size_t interface_description_len = 0;
-            if (resource_temp_ptr->static_resource_parameters->interface_description_ptr) {
-                interface_description_len = strlen(resource_temp_ptr->static_resource_parameters->interface_description_ptr);
-            }
-            if (interface_description_len) {
-                /* ;if="iftype" */
-                if (sn_nsdl_check_uint_overflow(return_value,
-                                                6,
-                                                interface_description_len)) {
-                    return_value += (6 + interface_description_len);
-                } else {
-                    *error = SN_NSDL_FAILURE;
-                    break;
-                }
-            }
+    if (SN_NSDL_CBOR_OK(err)) {
+        err = sn_nsdl_encode_cbor_text_attribute(&link, SN_NSDL_CBOR_LINK_IF, NULL,
+                                                 resource_temp_ptr->static_resource_parameters->interface_description_ptr);
+    }
 #endif
 #else
-            /* All attributes */
-            if (resource_temp_ptr->static_resource_parameters->attributes_ptr) {
-                size_t attribute_len = 0;
-                size_t attribute_desc_len = 0;
-                uint8_t success = 1;
-                sn_nsdl_attribute_item_s *item = resource_temp_ptr->static_resource_parameters->attributes_ptr;
-                while (item->attribute_name != ATTR_END) {
-                    switch (item->attribute_name) {
-                        case ATTR_RESOURCE_TYPE:
-                            /* ;rt="restype" */
-                            attribute_desc_len = 6;
-                            attribute_len = strlen(item->value);
-                            break;
-                        case ATTR_INTERFACE_DESCRIPTION:
-                            /* ;if="iftype" */
-                            attribute_desc_len = 6;
-                            attribute_len = strlen(item->value);
-                            break;
-                        case ATTR_ENDPOINT_NAME:
-                            /* ;name="name" */
-                            attribute_desc_len = 8;
-                            attribute_len = strlen(item->value);
-                            break;
-                        default:
-                            break;
-                    }
-                    if (sn_nsdl_check_uint_overflow(return_value,
-                                                    attribute_desc_len,
-                                                    attribute_len)) {
-                        return_value += (attribute_desc_len + attribute_len);
-                    } else {
-                        success = 0;
-                        break;
-                    }
-                    item++;
-                }
-                if (!success) {
-                    *error = SN_NSDL_FAILURE;
+    if (resource_temp_ptr->static_resource_parameters->attributes_ptr) {
+        const sn_nsdl_attribute_item_s *attribute = resource_temp_ptr->static_resource_parameters->attributes_ptr;
+        while (SN_NSDL_CBOR_OK(err) && attribute->attribute_name != ATTR_END) {
+            switch (attribute->attribute_name) {
+                case ATTR_RESOURCE_TYPE:
+                    err = sn_nsdl_encode_cbor_text_attribute(&link, SN_NSDL_CBOR_LINK_RT, NULL, attribute->value);
                     break;
-                }
-            }
-#endif
-            if (resource_temp_ptr->coap_content_type != 0) {
-                /* ;if="content" */
-                uint8_t len = sn_nsdl_itoa_len(resource_temp_ptr->coap_content_type);
-                if (sn_nsdl_check_uint_overflow(return_value, 6, len)) {
-                    return_value += (6 + len);
-                } else {
-                    *error = SN_NSDL_FAILURE;
+                case ATTR_INTERFACE_DESCRIPTION:
+                    err = sn_nsdl_encode_cbor_text_attribute(&link, SN_NSDL_CBOR_LINK_IF, NULL, attribute->value);
+                    break;
+                case ATTR_ENDPOINT_NAME:
+                    err = sn_nsdl_encode_cbor_text_attribute(&link, 0, "name", attribute->value);
+                    break;
+                default:
                     break;
-                }
             }
+            attribute++;
+        }
+    }
+#endif
 
-            if ((resource_temp_ptr->publish_value > 0) && resource_temp_ptr->resource) {
-                /* ;v="" */
-                uint16_t len = resource_temp_ptr->resource_len;
-                if (resource_temp_ptr->publish_value == 2) {
-                    len = (((resource_temp_ptr->resource_len + 2) / 3) << 2);
-                }
-                if (sn_nsdl_check_uint_overflow(return_value, 5, len)) {
-                    return_value += 5 + len;
-                } else {
-                    *error = SN_NSDL_FAILURE;
-                    break;
-                }
-                /* ;v="" */
+    if (SN_NSDL_CBOR_OK(err) && resource_temp_ptr->coap_content_type != 0) {
+        err = cbor_map_encode_uint_uint(&link, SN_NSDL_CBOR_LINK_CT, resource_temp_ptr->coap_content_type);
+    }
+
+    /* Opaque value goes as byte string, no Base64 needed */
+    if (SN_NSDL_CBOR_OK(err) && (resource_temp_ptr->publish_value > 0) && resource_temp_ptr->resource) {
+        err = cbor_encode_text_stringz(&link, "v");
+        if (SN_NSDL_CBOR_OK(err)) {
+            if (resource_temp_ptr->publish_value == 2) {
+                err = cbor_encode_byte_string(&link, resource_temp_ptr->resource, resource_temp_ptr->resource_len);
+            } else {
+                err = cbor_encode_text_string(&link, (const char *)resource_temp_ptr->resource, resource_temp_ptr->resource_len);
             }
+        }
+    }
 
 #ifndef COAP_DISABLE_OBS_FEATURE
-            // Auto obs will take higher priority
-            // This needs to be re-visited and may be need an API for maganging obs value for different server implementation
-            if (resource_temp_ptr->auto_observable) {
-                /* ;aobs="" */
-                uint8_t token[MAX_TOKEN_SIZE] = {0};
-                uint8_t len = handle->sn_nsdl_auto_obs_token_callback(handle,
-                                                                      resource_temp_ptr->static_resource_parameters->path,
-                                                                      (uint8_t *)token);
-
-                if (len > 0) {
-                    uint16_t temp = common_read_16_bit((uint8_t *)token);
-                    uint8_t token_len = sn_nsdl_itoa_len(temp);
-                    if (sn_nsdl_check_uint_overflow(return_value, 8, token_len)) {
-                        return_value += (8 + token_len);
-                    } else {
-                        *error = SN_NSDL_FAILURE;
-                        break;
-                    }
-                } else {
-                    *error = SN_NSDL_FAILURE;
-                    break;
+    if (SN_NSDL_CBOR_OK(err) && resource_temp_ptr->auto_observable) {
+        uint8_t token[MAX_TOKEN_SIZE] = {0};
+        uint8_t len = handle->sn_nsdl_auto_obs_token_callback(handle,
+                                                              resource_temp_ptr->static_resource_parameters->path,
+                                                              (uint8_t *)token);
+        if (len > 0) {
+            err = cbor_encode_text_stringz(&link, "aobs");
+            if (SN_NSDL_CBOR_OK(err)) {
+                err = cbor_encode_uint(&link, common_read_16_bit((uint8_t *)token));
+            }
+        }
+    } else if (SN_NSDL_CBOR_OK(err) && resource_temp_ptr->observable) {
+        err = cbor_encode_uint(&link, SN_NSDL_CBOR_LINK_OBS);
+        if (SN_NSDL_CBOR_OK(err)) {
+            err = cbor_encode_boolean(&link, true);
+        }
+    }
+#endif
+
+    if (SN_NSDL_CBOR_OK(err)) {
+        err = cbor_encoder_close_container(links, &link);
+    }
+    return err;
+}
+
+/**
+ * \fn static CborError sn_nsdl_encode_registration_body_cbor(struct nsdl_s *handle, uint8_t *dst_ptr, uint16_t dst_len, uint8_t updating_registeration, size_t *body_len)
+ *
+ * \brief   Encodes registration message payload as CBOR link format
+ * \param   *handle                 Pointer to nsdl-library handle
+ * \param   *dst_ptr                Destination, NULL to only measure the payload
+ * \param   dst_len                 Size of destination
+ * \param   updating_registeration  Non zero if payload is for registration update
+ * \param   *body_len               Payload size, 0 if there are no resources to register
+ *
+ * \return  CborError
+ */
+static CborError sn_nsdl_encode_registration_body_cbor(struct nsdl_s *handle, uint8_t *dst_ptr, uint16_t dst_len,
+                                                       uint8_t updating_registeration, size_t *body_len)
+{
+    CborEncoder encoder;
+    CborEncoder links;
+    sn_nsdl_dynamic_resource_parameters_s *resource_temp_ptr;
+    uint16_t journal_index;
+    uint16_t link_count = 0;
+    bool use_journal = sn_nsdl_use_registration_journal(handle, updating_registeration);
+
+    cbor_encoder_init(&encoder, dst_ptr, dst_len, 0);
+    CborError err = cbor_encoder_create_array(&encoder, &links, CborIndefiniteLength);
+
+#if MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+    /* All resources are published, journal restarts with the ones published again in next update */
+    if (dst_ptr && !use_journal) {
+        sn_grs_journal_reset(handle->grs);
+    }
+#endif
+
+    resource_temp_ptr = sn_nsdl_get_first_registration_resource(handle, use_journal, &journal_index);
+    while (resource_temp_ptr && SN_NSDL_CBOR_OK(err)) {
+        if (sn_nsdl_is_resource_to_register(resource_temp_ptr, updating_registeration)) {
+            /* Resource state is only changed when payload is actually built */
+            if (dst_ptr) {
+                if (resource_temp_ptr->registered != SN_NDSL_RESOURCE_DELETE) {
+                    resource_temp_ptr->registered = SN_NDSL_RESOURCE_REGISTERED;
                 }
-            } else if (resource_temp_ptr->observable) {
-                if (sn_nsdl_check_uint_overflow(return_value, 4, 0)) {
-                    return_value += 4;
-                } else {
-                    *error = SN_NSDL_FAILURE;
-                    break;
+#if MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+                if (!use_journal) {
+                    sn_grs_journal_retain(handle->grs, resource_temp_ptr);
                 }
+#endif
             }
+            err = sn_nsdl_encode_resource_entry_cbor(handle, &links, resource_temp_ptr);
+            link_count++;
+        }
+        resource_temp_ptr = sn_nsdl_get_next_registration_resource(handle, resource_temp_ptr, use_journal, &journal_index);
+    }
+
+    if (SN_NSDL_CBOR_OK(err)) {
+        err = cbor_encoder_close_container(&encoder, &links);
+    }
+
+#if MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+    if (dst_ptr && use_journal) {
+        sn_grs_journal_commit(handle->grs);
+    }
 #endif
+
+    if (!link_count) {
+        *body_len = 0;
+    } else if (dst_ptr) {
+        *body_len = cbor_encoder_get_buffer_size(&encoder, dst_ptr);
+    } else {
+        *body_len = cbor_encoder_get_extra_bytes_needed(&encoder);
+    }
+    return err;
+}
+
+/**
+ * \fn static int8_t sn_nsdl_build_registration_body_cbor(struct nsdl_s *handle, sn_coap_hdr_s *message_ptr, uint8_t updating_registeration)
+ *
+ * \brief   To build GRS resources to registration message payload in CBOR link format
+ * \param   *handle                 Pointer to nsdl-library handle
+ * \param   *message_ptr            Pointer to CoAP message header
+ * \param   updating_registeration  Non zero if payload is for registration update
+ *
+ * \return  SN_NSDL_SUCCESS = 0, Failed < 0
+ */
+static int8_t sn_nsdl_build_registration_body_cbor(struct nsdl_s *handle, sn_coap_hdr_s *message_ptr, uint8_t updating_registeration)
+{
+    size_t body_len = 0;
+
+    /* First pass only measures the payload */
+    CborError err = sn_nsdl_encode_registration_body_cbor(handle, NULL, 0, updating_registeration, &body_len);
+    if (!SN_NSDL_CBOR_OK(err) || body_len > UINT16_MAX) {
+        return SN_NSDL_FAILURE;
+    }
+
+    if (!body_len) {
+#if MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+        if (sn_nsdl_use_registration_journal(handle, updating_registeration)) {
+            sn_grs_journal_commit(handle->grs);
+        } else {
+            sn_grs_journal_reset(handle->grs);
         }
-        resource_temp_ptr = sn_grs_get_next_resource(handle->grs, resource_temp_ptr);
+#endif
+        return SN_NSDL_SUCCESS;
     }
-    return return_value;
+
+    tr_debug("sn_nsdl_build_registration_body_cbor - body size: [%d]", (int)body_len);
+    message_ptr->payload_ptr = handle->sn_nsdl_alloc((uint16_t)body_len);
+    if (!message_ptr->payload_ptr) {
+        return SN_NSDL_MEMORY_ALLOCATION_FAILED;
+    }
+
+    err = sn_nsdl_encode_registration_body_cbor(handle, message_ptr->payload_ptr, (uint16_t)body_len,
+                                                updating_registeration, &body_len);
+    if (err != CborNoError) {
+        handle->sn_nsdl_free(message_ptr->payload_ptr);
+        message_ptr->payload_ptr = NULL;
+        return SN_NSDL_FAILURE;
+    }
+    message_ptr->payload_len = (uint16_t)body_len;
+
+    return SN_NSDL_SUCCESS;
+}
+#endif
+
+#if MBED_CLIENT_STREAMED_REGISTRATION && SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE
+/**
+ * \fn static void sn_nsdl_reset_registration_stream(struct nsdl_s *handle)
+ *
+ * \brief   Stops streaming of registration message payload
+ * \param   *handle Pointer to nsdl-library handle
+ */
+static void sn_nsdl_reset_registration_stream(struct nsdl_s *handle)
+{
+#if MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+    /* Resources not streamed yet were dropped from the journal when the stream started */
+    if (handle->registration_stream_active && (handle->registration_stream_entry || handle->grs->registration_stream_resource)) {
+        handle->grs->registration_journal_overflow = true;
+    }
+#endif
+    handle->sn_nsdl_free(handle->registration_stream_entry);
+    handle->registration_stream_entry = NULL;
+    handle->registration_stream_entry_len = 0;
+    handle->registration_stream_entry_offset = 0;
+    handle->registration_stream_active = 0;
+    handle->grs->registration_stream_resource = NULL;
 }
 
+/**
+ * \fn static sn_nsdl_dynamic_resource_parameters_s *sn_nsdl_registration_stream_next_resource(struct nsdl_s *handle)
+ *
+ * \brief   Moves the stream cursor to the next resource to be included to payload
+ * \param   *handle Pointer to nsdl-library handle
+ *
+ * \return  Pointer to resource, NULL if there is no more resources to include
+ */
+static sn_nsdl_dynamic_resource_parameters_s *sn_nsdl_registration_stream_next_resource(struct nsdl_s *handle)
+{
+    sn_nsdl_dynamic_resource_parameters_s *resource = handle->grs->registration_stream_resource;
+    while (resource && !sn_nsdl_is_resource_to_register(resource, handle->registration_stream_updating)) {
+        resource = sn_grs_get_next_resource(handle->grs, resource);
+    }
+    handle->grs->registration_stream_resource = resource;
+    return resource;
+}
+
+/**
+ * \fn static int32_t sn_nsdl_produce_registration_body(void *param, uint8_t *dst_ptr, uint16_t block_size, bool *more)
+ *
+ * \brief   Writes next block of registration message payload, called by CoAP library for each Block1 block.
+ *          Resource entries are built one at a time, an entry crossing the block boundary is kept until the next call.
+ * \param   *param      Pointer to nsdl-library handle
+ * \param   *dst_ptr    Destination of the block
+ * \param   block_size  Size of the block
+ * \param   *more       Set to true if payload continues after this block
+ *
+ * \return  Number of bytes written, < 0 if failed
+ */
+static int32_t sn_nsdl_produce_registration_body(void *param, uint8_t *dst_ptr, uint16_t block_size, bool *more)
+{
+    struct nsdl_s *handle = (struct nsdl_s *)param;
+    uint16_t len = 0;
+
+    /* Stream was reset i.e. registration restarted or handle cleared */
+    if (!handle->registration_stream_active) {
+        return -1;
+    }
+
+    while (len < block_size) {
+        /* Rest of the entry which did not fit to previous block */
+        if (handle->registration_stream_entry) {
+            uint16_t chunk = handle->registration_stream_entry_len - handle->registration_stream_entry_offset;
+            if (chunk > block_size - len) {
+                chunk = block_size - len;
+            }
+            memcpy(dst_ptr + len, handle->registration_stream_entry + handle->registration_stream_entry_offset, chunk);
+            len += chunk;
+            handle->registration_stream_entry_offset += chunk;
+            if (handle->registration_stream_entry_offset == handle->registration_stream_entry_len) {
+                handle->sn_nsdl_free(handle->registration_stream_entry);
+                handle->registration_stream_entry = NULL;
+            }
+            continue;
+        }
+
+        sn_nsdl_dynamic_resource_parameters_s *resource = sn_nsdl_registration_stream_next_resource(handle);
+        if (!resource) {
+            break;
+        }
+
+        int8_t error = SN_NSDL_SUCCESS;
+        uint16_t entry_size = sn_nsdl_calculate_resource_entry_size(handle, resource, &error);
+        if (error == SN_NSDL_FAILURE || !sn_nsdl_check_uint_overflow(entry_size, 1, 0)) {
+            sn_nsdl_reset_registration_stream(handle);
+            return -1;
+        }
+
+        /* Separator */
+        if (!handle->registration_stream_first) {
+            entry_size++;
+        }
+
+        /* Entry is built straight to the block if it fits, otherwise to a temporary buffer */
+        uint8_t *entry_ptr = dst_ptr + len;
+        if (entry_size > block_size - len) {
+            entry_ptr = handle->sn_nsdl_alloc(entry_size);
+            if (!entry_ptr) {
+                sn_nsdl_reset_registration_stream(handle);
+                return -1;
+            }
+        }
+
+        uint8_t *temp_ptr = entry_ptr;
+        if (!handle->registration_stream_first) {
+            *temp_ptr++ = ',';
+        }
+        handle->registration_stream_first = 0;
+
+        if (resource->registered != SN_NDSL_RESOURCE_DELETE) {
+            resource->registered = SN_NDSL_RESOURCE_REGISTERED;
+        }
+        temp_ptr = sn_nsdl_build_resource_entry(handle, resource, temp_ptr);
+#if MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+        sn_grs_journal_retain(handle->grs, resource);
+#endif
+        handle->grs->registration_stream_resource = sn_grs_get_next_resource(handle->grs, resource);
+
+        if (entry_ptr == dst_ptr + len) {
+            len += (temp_ptr - entry_ptr);
+        } else {
+            handle->registration_stream_entry = entry_ptr;
+            handle->registration_stream_entry_len = (temp_ptr - entry_ptr);
+            handle->registration_stream_entry_offset = 0;
+        }
+    }
+
+    *more = (handle->registration_stream_entry || sn_nsdl_registration_stream_next_resource(handle));
+    if (!*more) {
+        sn_nsdl_reset_registration_stream(handle);
+    }
+
+    return len;
+}
+
+/**
+ * \fn static int8_t sn_nsdl_start_registration_stream(struct nsdl_s *handle, sn_coap_hdr_s *message_ptr, uint8_t updating_registeration)
+ *
+ * \brief   Builds first block of registration message payload. If payload continues,
+ *          the stream is left active and the rest is produced while the blocks are acknowledged.
+ * \param   *handle                 Pointer to nsdl-library handle
+ * \param   *message_ptr            Pointer to CoAP message header
+ * \param   updating_registeration  Non zero if payload is for registration update
+ *
+ * \return  SN_NSDL_SUCCESS = 0, Failed < 0
+ */
+static int8_t sn_nsdl_start_registration_stream(struct nsdl_s *handle, sn_coap_hdr_s *message_ptr, uint8_t updating_registeration)
+{
+    uint16_t block_size = handle->grs->coap->sn_coap_block_data_size;
+    bool more = false;
+
+    sn_nsdl_reset_registration_stream(handle);
+
+    if (!message_ptr->options_list_ptr && !sn_coap_parser_alloc_options(handle->grs->coap, message_ptr)) {
+        return SN_NSDL_MEMORY_ALLOCATION_FAILED;
+    }
+
+    message_ptr->payload_ptr = handle->sn_nsdl_alloc(block_size);
+    if (!message_ptr->payload_ptr) {
+        return SN_NSDL_MEMORY_ALLOCATION_FAILED;
+    }
+
+#if MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+    sn_grs_journal_reset(handle->grs);
+#endif
+    handle->registration_stream_active = 1;
+    handle->registration_stream_first = 1;
+    handle->registration_stream_updating = updating_registeration ? 1 : 0;
+    handle->grs->registration_stream_resource = sn_grs_get_first_resource(handle->grs);
+
+    int32_t len = sn_nsdl_produce_registration_body(handle, message_ptr->payload_ptr, block_size, &more);
+    if (len <= 0) {
+        /* Nothing to register or failed */
+        sn_nsdl_reset_registration_stream(handle);
+        handle->sn_nsdl_free(message_ptr->payload_ptr);
+        message_ptr->payload_ptr = NULL;
+        return (len < 0) ? SN_NSDL_FAILURE : SN_NSDL_SUCCESS;
+    }
+
+    message_ptr->payload_len = len;
+    if (more) {
+        message_ptr->options_list_ptr->block1 = 0x08 | sn_coap_convert_block_size(block_size);
+    }
+    tr_debug("sn_nsdl_start_registration_stream - first block: [%d], more: %d", message_ptr->payload_len, more);
+
+    return SN_NSDL_SUCCESS;
+}
+#endif
 /**
  * \fn static uint8_t sn_nsdl_calculate_uri_query_option_len(sn_nsdl_ep_parameters_s *endpoint_info_ptr, uint8_t msg_type)
  *
@@ -1714,6 +2615,17 @@ static int8_t sn_nsdl_local_rx_function(struct nsdl_s *handle, sn_coap_hdr_s *co
         handle->ep_information_ptr->domain_name_ptr = 0;
         handle->ep_information_ptr->domain_name_len = 0;
     }
+#if MBED_CLIENT_CBOR_REGISTRATION
+    else if (coap_packet_ptr->msg_code == COAP_MSG_CODE_RESPONSE_UNSUPPORTED_CONTENT_FORMAT &&
+             handle->registration_cbor &&
+             coap_packet_ptr->token_len == sizeof(handle->register_token) &&
+             memcmp(coap_packet_ptr->token_ptr, &handle->register_token, coap_packet_ptr->token_len) == 0) {
+        /* Server does not know CBOR link format, next registration is sent as Core Link Format */
+        tr_warn("sn_nsdl_local_rx_function - CBOR registration rejected, using link format");
+        handle->registration_cbor = 0;
+        is_reg_msg = true;
+    }
+#endif
 #ifndef MBED_CLIENT_DISABLE_BOOTSTRAP_FEATURE
     else if (coap_packet_ptr->token_len == sizeof(handle->bootstrap_token) &&
              memcmp(coap_packet_ptr->token_ptr, &handle->bootstrap_token, coap_packet_ptr->token_len) == 0) {
@@ -1971,6 +2883,9 @@ extern int8_t sn_nsdl_clear_coap_sent_blockwise_messages(struct nsdl_s *handle)
 
     // Enable function once new CoAP API is released to mbed-os
     sn_coap_protocol_clear_sent_blockwise_messages(handle->grs->coap);
+#if MBED_CLIENT_STREAMED_REGISTRATION && SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE
+    sn_nsdl_reset_registration_stream(handle);
+#endif
 
     return SN_NSDL_SUCCESS;
 }
@@ -2079,6 +2994,23 @@ extern int8_t sn_nsdl_pop_resource(struct nsdl_s *handle, sn_nsdl_dynamic_resour
     return sn_grs_pop_resource(handle->grs, res);
 }
 
+extern int8_t sn_nsdl_resource_changed(struct nsdl_s *handle, sn_nsdl_dynamic_resource_parameters_s *res)
+{
+    if (!handle || !res) {
+        return SN_NSDL_FAILURE;
+    }
+
+    if (res->registered == SN_NDSL_RESOURCE_REGISTERED) {
+        res->registered = SN_NDSL_RESOURCE_NOT_REGISTERED;
+    }
+
+#if MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+    sn_grs_journal_add(handle->grs, res);
+#endif
+
+    return SN_NSDL_SUCCESS;
+}
+
 extern int8_t sn_nsdl_delete_resource(struct nsdl_s *handle, const char *path)
 {
     /* Check parameters */
@@ -2503,6 +3435,8 @@ const char *sn_nsdl_coap_message_code_desc(int msg_code)
             return "COAP_MSG_CODE_REQUEST_PUT";
         case COAP_MSG_CODE_REQUEST_DELETE:
             return "COAP_MSG_CODE_REQUEST_DELETE";
+        case COAP_MSG_CODE_REQUEST_FETCH:
+            return "COAP_MSG_CODE_REQUEST_FETCH";
         case COAP_MSG_CODE_RESPONSE_CREATED:
             return "COAP_MSG_CODE_RESPONSE_CREATED";
         case COAP_MSG_CODE_RESPONSE_DELETED:
@@ -37,6 +37,18 @@ class M2MSecurity;
 class M2MTimer;
 #endif
 
+// Happy Eyeballs needs the full address list from DNS
+#define M2M_HAPPY_EYEBALLS ((PAL_DNS_API_VERSION == 3) && (MBED_CLIENT_CONNECTION_ATTEMPT_DELAY > 0))
+
+// Parallel connection attempts are only possible when there is a connect phase
+#if M2M_HAPPY_EYEBALLS && defined(PAL_NET_TCP_AND_TLS_SUPPORT)
+#define M2M_CONNECTION_RACING 1
+#else
+#define M2M_CONNECTION_RACING 0
+#endif
+
+#define M2M_SEND_PACING ((MBED_CLIENT_SEND_PACING_RATE_UDP > 0) || (MBED_CLIENT_SEND_PACING_RATE_TCP > 0))
+
 /**
  * @brief M2MConnectionHandlerPimpl.
  * This class handles the socket connection for LWM2M Client
@@ -155,6 +167,15 @@ public:
     */
     void receive_handler();
 
+#ifdef PAL_NET_TCP_AND_TLS_SUPPORT
+    /**
+    * @brief Passes the complete frames of the TCP receive buffer to the observer
+    * and keeps a partial frame for the next read.
+    * @return false if the connection was closed meanwhile.
+    */
+    bool process_tcp_frames();
+#endif
+
     /**
     * @brief Returns true if DTLS handshake is still ongoing.
     */
@@ -165,6 +186,23 @@ public:
     */
     void send_socket_data();
 
+    /**
+    * @brief Sends queued datagrams to socket with one PAL call,
+    * used in non-secure UDP mode.
+    */
+    void send_socket_datagrams();
+
+    /**
+    * @brief Sends queued messages to socket with their DTLS records
+    * packed into shared datagrams, used in secure UDP mode.
+    */
+    void send_socket_records();
+
+    /**
+    * @brief Reports a failed send to the observer and closes the socket.
+    */
+    void send_failed(int error);
+
     /**
     * @brief Does DNS resolving. Return true if DNS has been resolved
     * or triggered though DNS thread.
@@ -265,6 +303,30 @@ private:
     */
     bool init_socket();
 
+    /**
+    * @brief Create an asynchronous socket for the family of the given address and bind it.
+    * @param socket Set to the created socket.
+    * @param address Server address the socket will be used for.
+    * @param socket_type Stream or datagram socket.
+    * @return true if the socket was created.
+    */
+    bool open_socket(palSocket_t &socket, const palSocketAddress_t &address, palSocketType_t socket_type);
+
+#if MBED_CLIENT_CID_FAST_RESUME
+    /**
+    * @brief Move a secure UDP connection with a DTLS connection ID to a new socket,
+    * keeping the DTLS session.
+    * @return true if the connection was moved to a new socket.
+    */
+    bool rebind_socket();
+#endif
+
+    /**
+    * @brief Update _address from _socket_address. Reports an error to the observer on failure.
+    * @return true if the address is usable.
+    */
+    bool update_server_address();
+
     /**
     * @brief Check socket type
     * @return True if TCP connection otherwise false
@@ -299,25 +361,112 @@ public:
     void interface_event(palNetworkStatus_t status);
 
 private:
+    // Send queue classes in priority order, a lower class is always sent first
+    enum SendClass {
+        SendClassControl = 0,   // Empty messages (ping), ACK and RST
+        SendClassRegistration,  // Bootstrap and registration requests
+        SendClassNotification,  // Notifications and other messages
+        SendClassBulk,          // Blockwise transfers
+        SendClassCount
+    };
+
     typedef struct send_data_queue {
-        uint8_t *data;
+        uint8_t *data;          // Points to the storage following this header
         uint16_t offset;
         uint16_t data_len;
+        uint16_t capacity;
+        uint8_t send_class;
         ns_list_link_t link;
     } send_data_queue_s;
 
     /**
-     * @brief Get first item from the queue list.
+     * @brief Get the send queue class of a CoAP message.
+     */
+    static SendClass classify_send_data(const uint8_t *data, uint16_t data_len);
+
+    /**
+     * @brief Get a send buffer with room for given amount of data,
+     * either from the buffer pool or from heap.
+     * Header and data storage are in one allocation.
+     */
+    send_data_queue_s *alloc_send_buffer(uint16_t size);
+
+    /**
+     * @brief Return send buffer to the pool, or free it if the pool is full.
+     */
+    void free_send_buffer(send_data_queue_s *data);
+
+    /**
+     * @brief Free all pooled send buffers.
+     */
+    void clear_send_buffer_pool();
+
+    /**
+     * @brief Get first item of the highest priority class from the queue list.
      */
     send_data_queue_s *get_item_from_list();
 
     /**
-     * @brief Add queue data back to list.
+     * @brief Add queue data back to the front of its class in the list.
      */
     void add_item_to_list(send_data_queue_s *data);
+
+#if M2M_SEND_PACING
+    /**
+     * @brief Check if pacing lets given data go out now. If not, a send
+     * event is scheduled for when the budget allows it.
+     */
+    bool send_pacing_allows(const send_data_queue_s *data);
+
+    /**
+     * @brief Take the bytes sent from the pacing budget.
+     */
+    void send_pacing_consume(uint16_t bytes);
+
+    /**
+     * @brief Cancel the scheduled pacing send event, if any.
+     */
+    void send_pacing_cancel();
+#endif
 #if (PAL_DNS_API_VERSION == 3)
 private:
     void free_address_info();
+
+    /**
+     * @brief Index in _address_info of the address to try at given position.
+     */
+    uint16_t address_info_index(uint16_t position) const;
+
+    /**
+     * @brief Check if there are resolved addresses which have not been tried yet.
+     */
+    bool has_untried_address() const;
+
+#if M2M_HAPPY_EYEBALLS
+    /**
+     * @brief Order the resolved addresses to alternate between address families,
+     * starting with the family of the first one (RFC 8305 chapter 4).
+     */
+    void sort_address_info();
+#endif
+
+#if M2M_CONNECTION_RACING
+    /**
+     * @brief Start connecting to the next address while the current attempt is pending.
+     */
+    void start_racing_connect();
+
+    /**
+     * @brief Make the racing attempt the current one, closing the current one.
+     * @return true if the racing address is usable.
+     */
+    bool promote_racing_socket();
+
+    /**
+     * @brief Close the racing attempt, if any.
+     */
+    void close_racing_socket();
+#endif
 #endif
 private:
     enum SocketState {
@@ -380,6 +529,17 @@ private:
     uint16_t                                    _current_address_info;
     uint16_t                                    _address_info_count;
     palAddressInfo_t                            *_address_info;
+#if M2M_HAPPY_EYEBALLS
+    uint16_t                                    *_address_info_order;
+#endif
+#if MBED_CLIENT_DNS_CACHE_TTL > 0
+    uint32_t                                    _address_info_ticks;
+#endif
+#if M2M_CONNECTION_RACING
+    palSocket_t                                 _racing_socket;
+    palSocketAddress_t                          _racing_socket_address;
+    M2MTimer                                    *_connection_attempt_timer;
+#endif
 #endif
     palDNSQuery_t                               _handler_async_DNS;
     M2MTimer                                    *_dns_fallback_timer;
@@ -392,7 +552,20 @@ private:
     // asynchronous events and callbacks. Note: the state may be accessed from
     // event sender and receiver threads.
     SocketState                                 _socket_state;
-    send_data_list_t                            _linked_list_send_data;
+    send_data_list_t                            _linked_list_send_data[SendClassCount];
+#if M2M_SEND_PACING
+    arm_event_storage_t                         *_send_pacing_event;
+    int32_t                                     _send_pacing_tokens;
+    uint32_t                                    _send_pacing_ticks;
+#endif
+#ifdef PAL_NET_TCP_AND_TLS_SUPPORT
+    // Frames of the TCP stream may be split over reads and one read may hold several
+    uint8_t                                     *_tcp_frame_buffer;
+    uint32_t                                    _tcp_frame_length;
+    uint32_t                                    _tcp_frame_skip;
+#endif
+    send_data_list_t                            _send_buffer_pool;
+    uint8_t                                     _send_buffer_pool_count;
     bool                                        _secure_connection;
     bool                                        _is_server_ping;
     arm_event_storage_t                         _event;
@@ -19,6 +19,7 @@
 
 #include "ns_types.h"
 #include "eventOS_event.h"
+#include "mbed-client/m2mconfig.h"
 #include "mbed-client/m2mtimerobserver.h"
 
 class M2MTimerPimpl {
@@ -81,12 +82,32 @@ public:
      */
     uint64_t get_still_left_time() const;
 
+    /**
+     * @brief Get time since the timer was started or last restarted at expiry
+     * @return Elapsed time in milliseconds
+     */
+    uint64_t elapsed_time() const;
+
+    /**
+     * @brief Get time until the timer expires next
+     * @return Remaining time in milliseconds, UINT64_MAX if not running
+     */
+    uint64_t remaining_time() const;
+
     /**
      * Tasklet's internal event handler, which needs to be public as it is used from C wrapper side.
      * This makes it possible to at least keep the member variables private.
      */
     void handle_timer_event(const arm_event_s &event);
 
+#if MBED_CLIENT_TIMER_WHEEL_SIZE
+    /**
+     * Handler of the event loop timer shared by all timers, public for the
+     * same reason as handle_timer_event().
+     */
+    static void handle_wheel_event();
+#endif
+
 private:
 
     /**
@@ -110,6 +131,20 @@ private:
 
     void set_event_id();
 
+#if MBED_CLIENT_TIMER_WHEEL_SIZE
+    /**
+     * Timing wheel. Running timers are kept in the slot of their expiry, a
+     * slot being MBED_CLIENT_TIMER_WHEEL_RESOLUTION wide, and a single event
+     * loop timer is requested for the earliest of them.
+     */
+    void wheel_insert(uint64_t interval);
+    void wheel_link(M2MTimerPimpl **list);
+    void wheel_unlink();
+    static void wheel_advance();
+    static void wheel_schedule();
+    static void wheel_schedule_at(uint64_t slot);
+#endif
+
 private:
     M2MTimerObserver&   _observer;
     uint64_t            _interval;
@@ -118,6 +153,9 @@ private:
     uint64_t            _total_interval;
     uint64_t            _still_left;
 
+    // event timer ticks on last start
+    uint32_t            _start_ticks;
+
     // pointer to the current timer event pending, NULL if none is in flight
     arm_event_storage_t *_timer_event;
 
@@ -133,6 +171,27 @@ private:
     uint8_t             _event_id;
     static uint8_t      _next_event_id;
 
+#if MBED_CLIENT_TIMER_WHEEL_SIZE
+    // absolute slot of the expiry, and the list the timer is on, NULL if not running
+    uint64_t            _wheel_expiry;
+    M2MTimerPimpl       *_wheel_next;
+    M2MTimerPimpl       *_wheel_prev;
+    M2MTimerPimpl       **_wheel_list;
+
+    static M2MTimerPimpl *_wheel_slots[MBED_CLIENT_TIMER_WHEEL_SIZE];
+    // timers due, being fired by handle_wheel_event()
+    static M2MTimerPimpl *_wheel_expired;
+    // current slot, which started at _wheel_base_ticks
+    static uint64_t     _wheel_now;
+    static uint32_t     _wheel_base_ticks;
+    // last slot whose timers have been moved to the expired list
+    static uint64_t     _wheel_done;
+    // slot the event loop timer is requested for, UINT64_MAX if none
+    static uint64_t     _wheel_wake;
+    static arm_event_storage_t *_wheel_event;
+    static bool         _wheel_dispatching;
+#endif
+
     friend class M2MTimer;
     friend class Test_M2MTimerPimpl_classic;
 };
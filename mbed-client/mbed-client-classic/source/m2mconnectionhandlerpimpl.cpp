@@ -27,9 +27,11 @@
 #include "mbed-client/m2mtimer.h"
 #endif
 #include "pal.h"
+#include "sn_coap_header.h"
 #include "eventOS_scheduler.h"
 #include "eventOS_event_timer.h"
 #include "mbed-trace/mbed_trace.h"
+#include "mbed-cloud-client/SpanTrace.h"
 #include <stdlib.h> // free() and malloc()
 
 #ifdef MBED_CLOUD_CLIENT_SUPPORT_MULTICAST_UPDATE
@@ -51,6 +53,33 @@
 #define DNS_FALLBACK_TIMEOUT 600000
 #endif
 
+#if (MBED_CLIENT_DNS_CACHE_TTL > 0) && (PAL_DNS_API_VERSION != 3)
+#warning "MBED_CLIENT_DNS_CACHE_TTL requires PAL_DNS_API_VERSION 3"
+#endif
+
+#if M2M_SEND_PACING
+// Event id of the delayed send event, the other events use 0
+#define SEND_PACING_EVENT_ID 1
+#endif
+
+#ifdef PAL_NET_TCP_AND_TLS_SUPPORT
+// Non-secure TCP frames have a 4 byte length in front of the CoAP message
+#define TCP_FRAME_HEADER_LENGTH 4
+#define TCP_FRAME_BUFFER_SIZE (BUFFER_LENGTH + TCP_FRAME_HEADER_LENGTH)
+#endif
+
+#ifdef PAL_NET_TCP_AND_TLS_SUPPORT
+static inline bool connect_pending(palStatus_t status)
+{
+    return (status == PAL_ERR_SOCKET_IN_PROGRES) || (status == PAL_ERR_SOCKET_WOULD_BLOCK);
+}
+
+static inline bool connect_completed(palStatus_t status)
+{
+    return (status == PAL_SUCCESS) || (status == PAL_ERR_SOCKET_ALREADY_CONNECTED);
+}
+#endif
+
 extern "C" void network_status_event(palNetworkStatus_t status, void *client_arg)
 {
     if (!client_arg) {
@@ -90,6 +119,12 @@ void M2MConnectionHandlerPimpl::event_handler(arm_event_s *event)
 
         // Event from socket callback method
         case M2MConnectionHandlerPimpl::EInterfaceConnected:
+#if MBED_CLIENT_CID_FAST_RESUME
+            if (rebind_socket()) {
+                _observer.network_interface_status_change(M2MConnectionObserver::NetworkInterfaceRebound);
+                break;
+            }
+#endif
             _observer.network_interface_status_change(M2MConnectionObserver::NetworkInterfaceConnected);
             break;
         case M2MConnectionHandlerPimpl::EInterfaceDisconnected:
@@ -118,6 +153,11 @@ void M2MConnectionHandlerPimpl::event_handler(arm_event_s *event)
 
         // Data send request from client side
         case M2MConnectionHandlerPimpl::ESocketSend:
+#if M2M_SEND_PACING
+            if (event->event_id == SEND_PACING_EVENT_ID) {
+                _send_pacing_event = NULL;
+            }
+#endif
             send_socket_data();
             break;
 
@@ -186,10 +226,31 @@ M2MConnectionHandlerPimpl::M2MConnectionHandlerPimpl(M2MConnectionHandler *base,
       _current_address_info(0),
       _address_info_count(0),
       _address_info(0),
+#if M2M_HAPPY_EYEBALLS
+      _address_info_order(NULL),
+#endif
+#if MBED_CLIENT_DNS_CACHE_TTL > 0
+      _address_info_ticks(0),
+#endif
+#if M2M_CONNECTION_RACING
+      _racing_socket(0),
+      _connection_attempt_timer(NULL),
+#endif
 #endif
       _handler_async_DNS(0),
 #endif
       _socket_state(ESocketStateDisconnected),
+#if M2M_SEND_PACING
+      _send_pacing_event(NULL),
+      _send_pacing_tokens(MBED_CLIENT_SEND_PACING_BURST),
+      _send_pacing_ticks(0),
+#endif
+#ifdef PAL_NET_TCP_AND_TLS_SUPPORT
+      _tcp_frame_buffer(NULL),
+      _tcp_frame_length(0),
+      _tcp_frame_skip(0),
+#endif
+      _send_buffer_pool_count(0),
       _secure_connection(false),
       _is_server_ping(false)
 {
@@ -201,6 +262,10 @@ M2MConnectionHandlerPimpl::M2MConnectionHandlerPimpl(M2MConnectionHandler *base,
 #endif
 #if (PAL_DNS_API_VERSION == 2) || (PAL_DNS_API_VERSION == 3)
     _dns_fallback_timer = new M2MTimer(*this);
+#endif
+#if M2M_CONNECTION_RACING
+    _connection_attempt_timer = new M2MTimer(*this);
+    memset(&_racing_socket_address, 0, sizeof(_racing_socket_address));
 #endif
     if (PAL_SUCCESS != pal_init()) {
         tr_error("PAL init failed.");
@@ -211,7 +276,10 @@ M2MConnectionHandlerPimpl::M2MConnectionHandlerPimpl(M2MConnectionHandler *base,
     memset((void *)&_socket_address, 0, sizeof _socket_address);
     memset(&_ipV4Addr, 0, sizeof(palIpV4Addr_t));
     memset(&_ipV6Addr, 0, sizeof(palIpV6Addr_t));
-    ns_list_init(&_linked_list_send_data);
+    for (int i = 0; i < SendClassCount; i++) {
+        ns_list_init(&_linked_list_send_data[i]);
+    }
+    ns_list_init(&_send_buffer_pool);
 
     eventOS_scheduler_mutex_wait();
     if (M2MConnectionHandlerPimpl::_tasklet_id == -1) {
@@ -237,6 +305,15 @@ M2MConnectionHandlerPimpl::~M2MConnectionHandlerPimpl()
     free_address_info();
 #endif
     close_socket();
+#if M2M_CONNECTION_RACING
+    delete _connection_attempt_timer;
+    _connection_attempt_timer = NULL;
+#endif
+    clear_send_buffer_pool();
+#ifdef PAL_NET_TCP_AND_TLS_SUPPORT
+    free(_tcp_frame_buffer);
+    _tcp_frame_buffer = NULL;
+#endif
     delete _security_impl;
     _security_impl = NULL;
     pal_destroy();
@@ -283,6 +360,7 @@ extern "C" void address_resolver_cb(const char *url, palAddressInfo_t *addrInfo,
     tr_debug("M2MConnectionHandlerPimpl::address_resolver callback");
     M2MConnectionHandlerPimpl *instance = (M2MConnectionHandlerPimpl *)callbackArgument;
     instance->stop_dns_fallback_timer();
+    SPAN_TRACE_END(DNS, PAL_SUCCESS != status);
 #if (PAL_DNS_API_VERSION == 3)
     instance->set_address_info(addrInfo);
 #endif
@@ -301,6 +379,12 @@ void M2MConnectionHandlerPimpl::set_address_info(palAddressInfo_t *addrInfo)
     _address_info = addrInfo;
     _address_info_count = pal_getDNSCount(_address_info);
     tr_debug("Found %d dns addresses", _address_info_count);
+#if MBED_CLIENT_DNS_CACHE_TTL > 0
+    _address_info_ticks = eventOS_event_timer_ticks();
+#endif
+#if M2M_HAPPY_EYEBALLS
+    sort_address_info();
+#endif
 }
 
 void M2MConnectionHandlerPimpl::free_address_info()
@@ -309,7 +393,141 @@ void M2MConnectionHandlerPimpl::free_address_info()
     _address_info_count = 0;
     pal_freeAddrInfo(_address_info);
     _address_info = NULL;
+#if M2M_HAPPY_EYEBALLS
+    free(_address_info_order);
+    _address_info_order = NULL;
+#endif
 }
+
+uint16_t M2MConnectionHandlerPimpl::address_info_index(uint16_t position) const
+{
+#if M2M_HAPPY_EYEBALLS
+    if (_address_info_order) {
+        return _address_info_order[position];
+    }
+#endif
+    return position;
+}
+
+bool M2MConnectionHandlerPimpl::has_untried_address() const
+{
+    return _address_info && _current_address_info < _address_info_count;
+}
+
+#if M2M_HAPPY_EYEBALLS
+void M2MConnectionHandlerPimpl::sort_address_info()
+{
+    free(_address_info_order);
+    _address_info_order = NULL;
+
+    if (!_address_info || _address_info_count < 2) {
+        return;
+    }
+
+    // Without memory the addresses are just tried in resolver order
+    _address_info_order = (uint16_t *)malloc(_address_info_count * sizeof(uint16_t));
+    if (!_address_info_order) {
+        return;
+    }
+
+    palSocketAddress_t address;
+    unsigned short first_family = PAL_AF_UNSPEC;
+    uint16_t first_count = 0;
+    uint16_t other_count = 0;
+
+    // Count the families first, the positions follow from the counts
+    for (uint16_t i = 0; i < _address_info_count; i++) {
+        if (pal_getDNSAddress(_address_info, i, &address) != PAL_SUCCESS) {
+            address.addressType = PAL_AF_UNSPEC;
+        }
+        if (i == 0) {
+            first_family = address.addressType;
+        }
+        if (address.addressType == first_family) {
+            first_count++;
+        } else {
+            other_count++;
+        }
+    }
+
+    // k:th address of the first family goes to 2k and of the other family to 2k + 1,
+    // once one family runs out the rest of the other follow in their order
+    uint16_t first_seen = 0;
+    uint16_t other_seen = 0;
+    for (uint16_t i = 0; i < _address_info_count; i++) {
+        if (pal_getDNSAddress(_address_info, i, &address) != PAL_SUCCESS) {
+            address.addressType = PAL_AF_UNSPEC;
+        }
+        uint16_t position;
+        if (address.addressType == first_family) {
+            position = (first_seen < other_count) ? 2 * first_seen : other_count + first_seen;
+            first_seen++;
+        } else {
+            position = (other_seen < first_count) ? 2 * other_seen + 1 : first_count + other_seen;
+            other_seen++;
+        }
+        _address_info_order[position] = i;
+    }
+}
+#endif // M2M_HAPPY_EYEBALLS
+
+#if M2M_CONNECTION_RACING
+void M2MConnectionHandlerPimpl::start_racing_connect()
+{
+    // At most two attempts are pending, the older one is given up for the next address
+    if (_racing_socket && !promote_racing_socket()) {
+        return;
+    }
+
+    if (!has_untried_address()) {
+        return;
+    }
+
+    palStatus_t status = pal_getDNSAddress(_address_info, address_info_index(_current_address_info), &_racing_socket_address);
+    _current_address_info++;
+    if (PAL_SUCCESS == status) {
+        status = pal_setSockAddrPort(&_racing_socket_address, _server_port);
+    }
+
+    if (PAL_SUCCESS == status && open_socket(_racing_socket, _racing_socket_address, PAL_SOCK_STREAM)) {
+        tr_info("M2MConnectionHandlerPimpl::start_racing_connect - trying dns address %d of possible %d in parallel",
+                _current_address_info, _address_info_count);
+        // Connect is started and completed by socket_connect_handler() together with the current one
+        send_event(ESocketCallback);
+    } else {
+        tr_warn("M2MConnectionHandlerPimpl::start_racing_connect - could not start attempt: %" PRIx32, status);
+        close_racing_socket();
+    }
+
+    if (has_untried_address()) {
+        _connection_attempt_timer->start_timer(MBED_CLIENT_CONNECTION_ATTEMPT_DELAY, M2MTimerObserver::ConnectionAttempt, true);
+    }
+}
+
+bool M2MConnectionHandlerPimpl::promote_racing_socket()
+{
+    pal_close(&_socket);
+    _socket = _racing_socket;
+    _racing_socket = 0;
+    memcpy((void *)&_socket_address, &_racing_socket_address, sizeof(_racing_socket_address));
+
+    if (_secure_connection) {
+        _security_impl->set_socket(_socket, (palSocketAddress_t *)&_socket_address);
+    }
+    return update_server_address();
+}
+
+void M2MConnectionHandlerPimpl::close_racing_socket()
+{
+    if (_connection_attempt_timer) {
+        _connection_attempt_timer->stop_timer();
+    }
+    if (_racing_socket) {
+        pal_close(&_racing_socket);
+        _racing_socket = 0;
+    }
+}
+#endif // M2M_CONNECTION_RACING
 #endif
 
 bool M2MConnectionHandlerPimpl::address_resolver(void)
@@ -317,6 +535,17 @@ bool M2MConnectionHandlerPimpl::address_resolver(void)
     palStatus_t status;
     bool ret = false;
 #if (PAL_DNS_API_VERSION == 3)
+#if MBED_CLIENT_DNS_CACHE_TTL > 0
+    // A stored DTLS session with connection ID lets the client send right away on wake-up, but only
+    // to the address it was made with. Keep that address rather than a fresh result needing a handshake.
+    const bool keep_address = (_server_type == M2MConnectionObserver::LWM2MServer) &&
+                              _security_impl && _security_impl->is_cid_available();
+    if (_address_info_count && !keep_address &&
+            (eventOS_event_timer_ticks() - _address_info_ticks) >= eventOS_event_timer_ms_to_ticks(MBED_CLIENT_DNS_CACHE_TTL * 1000UL)) {
+        tr_debug("M2MConnectionHandlerPimpl::address_resolver - cached dns result expired");
+        free_address_info();
+    }
+#endif
     if (_current_address_info < _address_info_count) {
         send_event(ESocketDnsResolved);
         return true;
@@ -331,6 +560,7 @@ bool M2MConnectionHandlerPimpl::address_resolver(void)
     tr_debug("M2MConnectionHandlerPimpl::address_resolver start _dns_fallback_timer");
     _dns_fallback_timer->stop_timer();
     _dns_fallback_timer->start_timer(DNS_FALLBACK_TIMEOUT, M2MTimerObserver::DnsQueryFallback, true);
+    SPAN_TRACE_BEGIN(DNS);
 #if (PAL_DNS_API_VERSION == 2)
     status = pal_getAddressInfoAsync(_server_address.c_str(), (palSocketAddress_t *)&_socket_address, &address_resolver_cb, this, &_handler_async_DNS);
 #elif (PAL_DNS_API_VERSION == 3)
@@ -338,6 +568,7 @@ bool M2MConnectionHandlerPimpl::address_resolver(void)
 #endif
     if (PAL_SUCCESS != status) {
         _dns_fallback_timer->stop_timer();
+        SPAN_TRACE_END(DNS, 1);
         tr_error("M2MConnectionHandlerPimpl::address_resolver, pal_getAddressInfoAsync fail. %" PRIx32, status);
 #if (PAL_DNS_API_VERSION == 3)
         free_address_info();
@@ -349,7 +580,9 @@ bool M2MConnectionHandlerPimpl::address_resolver(void)
 #else // #if (PAL_DNS_API_VERSION == 0)
     tr_debug("M2MConnectionHandlerPimpl::address_resolver:synchronous DNS");
 
+    SPAN_TRACE_BEGIN(DNS);
     status = pal_getAddressInfo(_server_address.c_str(), (palSocketAddress_t *)&_socket_address, &_socket_address_len);
+    SPAN_TRACE_END(DNS, PAL_SUCCESS != status);
     if (PAL_SUCCESS != status) {
         tr_error("M2MConnectionHandlerPimpl::getAddressInfo failed with %" PRIx32, status);
         send_event(ESocketDnsError);
@@ -477,7 +710,7 @@ void M2MConnectionHandlerPimpl::socket_connect_handler()
             close_socket();
 #if (PAL_DNS_API_VERSION == 3)
             if (_address_info) {
-                status = pal_getDNSAddress(_address_info, _current_address_info, (palSocketAddress_t *)&_socket_address);
+                status = pal_getDNSAddress(_address_info, address_info_index(_current_address_info), (palSocketAddress_t *)&_socket_address);
                 _current_address_info++;
                 if (PAL_SUCCESS != status) {
                     tr_error("M2MConnectionHandlerPimpl::socket_connect_handler - pal_getDNSAddress %" PRIx32, status);
@@ -490,44 +723,7 @@ void M2MConnectionHandlerPimpl::socket_connect_handler()
                 tr_debug("M2MConnectionHandlerPimpl::socket_connect_handler - continue with current DNS");
             }
 #endif
-            status = pal_setSockAddrPort((palSocketAddress_t *)&_socket_address, _server_port);
-
-            if (PAL_SUCCESS != status) {
-                tr_error("M2MConnectionHandlerPimpl::socket_connect_handler - setSockAddrPort err: %" PRIx32, status);
-            } else {
-                tr_debug("M2MConnectionHandlerPimpl::socket_connect_handler - address family: %d", (int)_socket_address.addressType);
-            }
-
-            if (_socket_address.addressType == PAL_AF_INET) {
-                status = pal_getSockAddrIPV4Addr((palSocketAddress_t *)&_socket_address, _ipV4Addr);
-                if (PAL_SUCCESS != status) {
-                    tr_error("M2MConnectionHandlerPimpl::socket_connect_handler - sockAddr4, err: %" PRIx32, status);
-                    _observer.socket_error(M2MConnectionHandler::DNS_RESOLVING_ERROR);
-                    return;
-                }
-
-                tr_info("M2MConnectionHandlerPimpl::socket_connect_handler - IPv4 Address %d.%d.%d.%d",
-                        _ipV4Addr[0], _ipV4Addr[1], _ipV4Addr[2], _ipV4Addr[3]);
-                _address._stack = M2MInterface::LwIP_IPv4;
-                _address._address = (void *)_ipV4Addr;
-                _address._length = PAL_IPV4_ADDRESS_SIZE;
-                _address._port = _server_port;
-            } else if (_socket_address.addressType == PAL_AF_INET6) {
-                status = pal_getSockAddrIPV6Addr((palSocketAddress_t *)&_socket_address, _ipV6Addr);
-                if (PAL_SUCCESS != status) {
-                    tr_error("M2MConnectionHandlerPimpl::socket_connect_handler - sockAddr6, err: %" PRIx32, status);
-                    _observer.socket_error(M2MConnectionHandler::DNS_RESOLVING_ERROR);
-                    return;
-                }
-
-                tr_info("M2MConnectionHandlerPimpl::socket_connect_handler - IPv6 Address: %s", mbed_trace_ipv6(_ipV6Addr));
-                _address._stack = M2MInterface::LwIP_IPv6;
-                _address._address = (void *)_ipV6Addr;
-                _address._length = PAL_IPV6_ADDRESS_SIZE;
-                _address._port = _server_port;
-            } else {
-                tr_error("M2MConnectionHandlerPimpl::socket_connect_handler - socket config error, stack: %d", (int)_socket_address.addressType);
-                _observer.socket_error(M2MConnectionHandler::SOCKET_ABORT);
+            if (!update_server_address()) {
                 return;
             }
 
@@ -541,6 +737,7 @@ void M2MConnectionHandlerPimpl::socket_connect_handler()
             // This state was used to ignore the spurious events _during_ the call of non-blocking pal_connect().
             // Now that we just retry connect when it is not yet succeeded anyway this state might be removed completely.
             _socket_state = ESocketStateConnectBeingCalled;
+            SPAN_TRACE_BEGIN(CONNECT);
 
         // fall through
         case ESocketStateConnectBeingCalled:
@@ -551,21 +748,62 @@ void M2MConnectionHandlerPimpl::socket_connect_handler()
 
                 status = pal_connect(_socket, (palSocketAddress_t *)&_socket_address, sizeof(_socket_address));
 
-                if ((status == PAL_ERR_SOCKET_IN_PROGRES) || (status == PAL_ERR_SOCKET_WOULD_BLOCK)) {
+#if M2M_CONNECTION_RACING
+                if (_racing_socket && !connect_completed(status)) {
+                    palStatus_t racing_status = pal_connect(_racing_socket, &_racing_socket_address, sizeof(_racing_socket_address));
+                    // First attempt to complete wins, a pending one also takes over a failed one
+                    if (connect_completed(racing_status) || (connect_pending(racing_status) && !connect_pending(status))) {
+                        tr_debug("M2MConnectionHandlerPimpl::socket_connect_handler - continue with parallel attempt");
+                        if (!promote_racing_socket()) {
+                            return;
+                        }
+                        status = racing_status;
+                    } else if (!connect_pending(racing_status)) {
+                        tr_debug("M2MConnectionHandlerPimpl::socket_connect_handler - parallel attempt failed: %" PRIx32, racing_status);
+                        close_racing_socket();
+                    }
+                }
+#endif
+
+                if (connect_pending(status)) {
                     // In this case the connect is done asynchronously, and the pal_socketMiniSelect()
                     // will be used to detect the end of connect.
                     tr_debug("M2MConnectionHandlerPimpl::socket_connect_handler - pal_connect(): %" PRIx32 ", async connect started", status);
+#if M2M_CONNECTION_RACING
+                    // Next address is tried in parallel if this one does not complete in time
+                    if (_socket_state == ESocketStateConnectBeingCalled && has_untried_address()) {
+                        _connection_attempt_timer->start_timer(MBED_CLIENT_CONNECTION_ATTEMPT_DELAY, M2MTimerObserver::ConnectionAttempt, true);
+                    }
+#endif
                     // we need to wait for the event
                     _socket_state = ESocketStateConnecting;
                     break;
 
-                } else if (status == PAL_SUCCESS || status == PAL_ERR_SOCKET_ALREADY_CONNECTED) {
+                } else if (connect_completed(status)) {
 
                     tr_debug("M2MConnectionHandlerPimpl::socket_connect_handler - pal_connect(): success");
+#if M2M_CONNECTION_RACING
+                    close_racing_socket();
+#endif
                     _socket_state = ESocketStateConnected;
+                    SPAN_TRACE_END(CONNECT, 0);
 
                 } else {
                     tr_error("M2MConnectionHandlerPimpl::socket_connect_handler - pal_connect(): failed: %" PRIx32, status);
+                    SPAN_TRACE_END(CONNECT, 1);
+#if M2M_CONNECTION_RACING
+                    // Move on to the next address right away instead of reporting an error
+                    if (has_untried_address()) {
+                        close_socket();
+                        _socket_state = EsocketStateInitializeConnection;
+                        send_event(ESocketConnect);
+                        return;
+                    }
+#endif
+#if PAL_USE_DNS_CACHE && ((PAL_DNS_API_VERSION == 0) || (PAL_DNS_API_VERSION == 1))
+                    // Resolve the server again on the next attempt instead of using the cached address
+                    pal_removeDNSCacheEntry(_server_address.c_str());
+#endif
                     close_socket();
                     _observer.socket_error(M2MConnectionHandler::SOCKET_ABORT);
                     return;
@@ -576,6 +814,7 @@ void M2MConnectionHandlerPimpl::socket_connect_handler()
             } else {
                 tr_info("M2MConnectionHandlerPimpl::socket_connect_handler - Using UDP");
                 _socket_state = ESocketStateConnected;
+                SPAN_TRACE_END(CONNECT, 0);
             }
         // fall through
         // is a normal flow in case the UDP was used or pal_connect() happened to return immediately with PAL_SUCCESS
@@ -592,6 +831,7 @@ void M2MConnectionHandlerPimpl::socket_connect_handler()
                         if (ret_code == M2MConnectionHandler::ERROR_NONE) {
                             // Initiate handshake. Perhaps there could be a separate event type for this?
                             _socket_state = ESocketStateHandshaking;
+                            SPAN_TRACE_BEGIN(TLS_HANDSHAKE);
                             send_event(ESocketCallback);
                         } else {
                             tr_error("M2MConnectionHandlerPimpl::socket_connect_handler - init failed");
@@ -625,6 +865,53 @@ void M2MConnectionHandlerPimpl::socket_connect_handler()
     }
 }
 
+bool M2MConnectionHandlerPimpl::update_server_address()
+{
+    palStatus_t status;
+
+    status = pal_setSockAddrPort((palSocketAddress_t *)&_socket_address, _server_port);
+
+    if (PAL_SUCCESS != status) {
+        tr_error("M2MConnectionHandlerPimpl::update_server_address - setSockAddrPort err: %" PRIx32, status);
+    } else {
+        tr_debug("M2MConnectionHandlerPimpl::update_server_address - address family: %d", (int)_socket_address.addressType);
+    }
+
+    if (_socket_address.addressType == PAL_AF_INET) {
+        status = pal_getSockAddrIPV4Addr((palSocketAddress_t *)&_socket_address, _ipV4Addr);
+        if (PAL_SUCCESS != status) {
+            tr_error("M2MConnectionHandlerPimpl::update_server_address - sockAddr4, err: %" PRIx32, status);
+            _observer.socket_error(M2MConnectionHandler::DNS_RESOLVING_ERROR);
+            return false;
+        }
+
+        tr_info("M2MConnectionHandlerPimpl::update_server_address - IPv4 Address %d.%d.%d.%d",
+                _ipV4Addr[0], _ipV4Addr[1], _ipV4Addr[2], _ipV4Addr[3]);
+        _address._stack = M2MInterface::LwIP_IPv4;
+        _address._address = (void *)_ipV4Addr;
+        _address._length = PAL_IPV4_ADDRESS_SIZE;
+        _address._port = _server_port;
+    } else if (_socket_address.addressType == PAL_AF_INET6) {
+        status = pal_getSockAddrIPV6Addr((palSocketAddress_t *)&_socket_address, _ipV6Addr);
+        if (PAL_SUCCESS != status) {
+            tr_error("M2MConnectionHandlerPimpl::update_server_address - sockAddr6, err: %" PRIx32, status);
+            _observer.socket_error(M2MConnectionHandler::DNS_RESOLVING_ERROR);
+            return false;
+        }
+
+        tr_info("M2MConnectionHandlerPimpl::update_server_address - IPv6 Address: %s", mbed_trace_ipv6(_ipV6Addr));
+        _address._stack = M2MInterface::LwIP_IPv6;
+        _address._address = (void *)_ipV6Addr;
+        _address._length = PAL_IPV6_ADDRESS_SIZE;
+        _address._port = _server_port;
+    } else {
+        tr_error("M2MConnectionHandlerPimpl::update_server_address - socket config error, stack: %d", (int)_socket_address.addressType);
+        _observer.socket_error(M2MConnectionHandler::SOCKET_ABORT);
+        return false;
+    }
+    return true;
+}
+
 bool M2MConnectionHandlerPimpl::send_data(uint8_t *data,
                                           uint16_t data_len,
                                           sn_nsdl_addr_s *address)
@@ -634,13 +921,6 @@ bool M2MConnectionHandlerPimpl::send_data(uint8_t *data,
         return false;
     }
 
-    send_data_queue_s *out_data = (send_data_queue_s *)malloc(sizeof(send_data_queue_s));
-    if (!out_data) {
-        return false;
-    }
-
-    memset(out_data, 0, sizeof(send_data_queue_s));
-
     uint8_t offset = 0;
 #ifdef PAL_NET_TCP_AND_TLS_SUPPORT
     if (is_tcp_connection() && !_secure_connection) {
@@ -648,9 +928,12 @@ bool M2MConnectionHandlerPimpl::send_data(uint8_t *data,
     }
 #endif
 
-    out_data->data = (uint8_t *)malloc(data_len + offset);
-    if (!out_data->data) {
-        free(out_data);
+    if (data_len > UINT16_MAX - offset) {
+        return false;
+    }
+
+    send_data_queue_s *out_data = alloc_send_buffer(data_len + offset);
+    if (!out_data) {
         return false;
     }
 
@@ -667,9 +950,10 @@ bool M2MConnectionHandlerPimpl::send_data(uint8_t *data,
 
     memcpy(out_data->data + offset, data, data_len);
     out_data->data_len = data_len + offset;
+    out_data->send_class = classify_send_data(data, data_len);
 
     claim_mutex();
-    ns_list_add_to_end(&_linked_list_send_data, out_data);
+    ns_list_add_to_end(&_linked_list_send_data[out_data->send_class], out_data);
     release_mutex();
 
     send_event(ESocketSend);
@@ -683,6 +967,20 @@ void M2MConnectionHandlerPimpl::send_socket_data()
     int bytes_sent = 0;
     bool success = true;
 
+#if MBED_CLIENT_DATAGRAM_BATCH_SIZE > 1
+    if (_socket_state == ESocketStateUnsecureConnection && !is_tcp_connection()) {
+        send_socket_datagrams();
+        return;
+    }
+#endif
+
+#if MBED_CLIENT_DTLS_COALESCING_SIZE
+    if (_socket_state == ESocketStateSecureConnection && !is_tcp_connection()) {
+        send_socket_records();
+        return;
+    }
+#endif
+
     send_data_queue_s *out_data = get_item_from_list();
     if (!out_data) {
         return;
@@ -694,6 +992,13 @@ void M2MConnectionHandlerPimpl::send_socket_data()
         return;
     }
 
+#if M2M_SEND_PACING
+    if (!send_pacing_allows(out_data)) {
+        add_item_to_list(out_data);
+        return;
+    }
+#endif
+
     // Loop until all the data is sent
     while (out_data->offset < out_data->data_len) {
         // Secure send
@@ -747,6 +1052,9 @@ void M2MConnectionHandlerPimpl::send_socket_data()
                 break;
             }
         }
+#if M2M_SEND_PACING
+        send_pacing_consume(bytes_sent);
+#endif
         int new_offset = out_data->offset + bytes_sent;
         if (new_offset >= out_data->data_len) {
             break;
@@ -755,25 +1063,152 @@ void M2MConnectionHandlerPimpl::send_socket_data()
         }
     }
 
-    free(out_data->data);
-    free(out_data);
+    free_send_buffer(out_data);
 
     if (!success) {
-        if (bytes_sent == M2MConnectionHandler::SSL_PEER_CLOSE_NOTIFY) {
-            _observer.socket_error(bytes_sent, true);
-        } else if (bytes_sent == M2MConnectionHandler::MEMORY_ALLOCATION_FAILED) {
-            tr_error("M2MConnectionHandlerPimpl::send_socket_data() - memory allocation failed!");
-            _observer.socket_error(bytes_sent, false);
-        } else if (bytes_sent == M2MConnectionHandler::SOCKET_SEND_ERROR) {
-            tr_error("M2MConnectionHandlerPimpl::send_socket_data() - SOCKET_SEND_ERROR");
-            _observer.socket_error(bytes_sent, true);
-        }
-        close_socket();
+        send_failed(bytes_sent);
     } else {
         _observer.data_sent();
     }
 }
 
+void M2MConnectionHandlerPimpl::send_failed(int error)
+{
+    if (error == M2MConnectionHandler::SSL_PEER_CLOSE_NOTIFY) {
+        _observer.socket_error(error, true);
+    } else if (error == M2MConnectionHandler::MEMORY_ALLOCATION_FAILED) {
+        tr_error("M2MConnectionHandlerPimpl::send_failed() - memory allocation failed!");
+        _observer.socket_error(error, false);
+    } else if (error == M2MConnectionHandler::SOCKET_SEND_ERROR) {
+        tr_error("M2MConnectionHandlerPimpl::send_failed() - SOCKET_SEND_ERROR");
+        _observer.socket_error(error, true);
+    }
+    close_socket();
+}
+
+void M2MConnectionHandlerPimpl::send_socket_records()
+{
+    bool coalescing = false;
+    int bytes_sent = 0;
+    int error = 0;
+    uint32_t sent = 0;
+
+    send_data_queue_s *out_data = get_item_from_list();
+    while (out_data) {
+#if M2M_SEND_PACING
+        if (!send_pacing_allows(out_data)) {
+            add_item_to_list(out_data);
+            break;
+        }
+#endif
+        // A lone message is sent as it is
+        send_data_queue_s *next_data = get_item_from_list();
+        if (next_data && !coalescing) {
+            coalescing = _security_impl->begin_coalescing(MBED_CLIENT_DTLS_COALESCING_SIZE);
+        }
+
+        while ((bytes_sent = _security_impl->send_message(out_data->data + out_data->offset,
+                                                          out_data->data_len - out_data->offset)) ==
+                M2MConnectionHandler::CONNECTION_ERROR_WANTS_READ) {
+        }
+
+        if (bytes_sent == M2MConnectionHandler::CONNECTION_ERROR_WANTS_WRITE) {
+            // Wait the next event, put both back in the original order
+            if (next_data) {
+                add_item_to_list(next_data);
+            }
+            add_item_to_list(out_data);
+            break;
+        }
+
+        if (bytes_sent <= 0) {
+            tr_error("M2MConnectionHandlerPimpl::send_socket_records() - failed %d", bytes_sent);
+            error = bytes_sent;
+            free_send_buffer(out_data);
+            if (next_data) {
+                add_item_to_list(next_data);
+            }
+            break;
+        }
+
+#if M2M_SEND_PACING
+        send_pacing_consume(bytes_sent);
+#endif
+        free_send_buffer(out_data);
+        sent++;
+        out_data = next_data;
+    }
+
+    if (coalescing) {
+        int ret = _security_impl->end_coalescing();
+        if (!error) {
+            error = ret;
+        }
+    }
+
+    for (uint32_t i = 0; i < sent; i++) {
+        _observer.data_sent();
+    }
+
+    if (error) {
+        send_failed(error);
+    }
+}
+
+void M2MConnectionHandlerPimpl::send_socket_datagrams()
+{
+    send_data_queue_s *out_data[MBED_CLIENT_DATAGRAM_BATCH_SIZE];
+    palDatagram_t datagrams[MBED_CLIENT_DATAGRAM_BATCH_SIZE];
+    uint32_t count = 0;
+    uint32_t sent = 0;
+
+    while (count < MBED_CLIENT_DATAGRAM_BATCH_SIZE) {
+        send_data_queue_s *data = get_item_from_list();
+        if (!data) {
+            break;
+        }
+#if M2M_SEND_PACING
+        if (!send_pacing_allows(data)) {
+            add_item_to_list(data);
+            break;
+        }
+        send_pacing_consume(data->data_len - data->offset);
+#endif
+        out_data[count] = data;
+        datagrams[count].buffer = data->data + data->offset;
+        datagrams[count].length = data->data_len - data->offset;
+        datagrams[count].address = (palSocketAddress_t *)&_socket_address;
+        datagrams[count].addressLength = sizeof(_socket_address);
+        count++;
+    }
+
+    if (!count) {
+        return;
+    }
+
+    palStatus_t ret = pal_sendToBatch(_socket, datagrams, count, &sent);
+
+    // Put the rest back to the front of the queue in the original order, the failed one is dropped
+    uint32_t failed = (ret != PAL_SUCCESS && ret != PAL_ERR_SOCKET_WOULD_BLOCK) ? 1 : 0;
+    for (uint32_t i = count; i > sent + failed; i--) {
+#if M2M_SEND_PACING
+        _send_pacing_tokens += out_data[i - 1]->data_len - out_data[i - 1]->offset;
+#endif
+        add_item_to_list(out_data[i - 1]);
+    }
+
+    for (uint32_t i = 0; i < sent; i++) {
+        free_send_buffer(out_data[i]);
+        _observer.data_sent();
+    }
+
+    if (failed) {
+        tr_error("M2MConnectionHandlerPimpl::send_socket_datagrams() - unsecure failed %" PRIx32, ret);
+        free_send_buffer(out_data[sent]);
+        close_socket();
+    }
+}
+
 bool M2MConnectionHandlerPimpl::start_listening_for_data()
 {
     return true;
@@ -827,6 +1262,10 @@ void M2MConnectionHandlerPimpl::receive_handshake_handler()
         // free current dns resources
         pal_freeAddrInfo(_address_info);
         _address_info = NULL;
+#if M2M_HAPPY_EYEBALLS
+        free(_address_info_order);
+        _address_info_order = NULL;
+#endif
     }
 #endif
     if (_is_server_ping && return_value == M2MConnectionHandler::ERROR_NONE) {
@@ -835,6 +1274,7 @@ void M2MConnectionHandlerPimpl::receive_handshake_handler()
         if (_security_impl->is_cid_available()) {
             tr_debug("M2MConnectionHandlerPimpl::receive_handshake_handler() - Server ping success");
             _socket_state = ESocketStateSecureConnection;
+            SPAN_TRACE_END(TLS_HANDSHAKE, 0);
             _observer.data_available(NULL, 0, _address);
         }
         return;
@@ -842,6 +1282,7 @@ void M2MConnectionHandlerPimpl::receive_handshake_handler()
 
     if (return_value == M2MConnectionHandler::ERROR_NONE) {
         _socket_state = ESocketStateSecureConnection;
+        SPAN_TRACE_END(TLS_HANDSHAKE, 0);
         _observer.address_ready(_address,
                                 _server_type,
                                 _server_port);
@@ -852,6 +1293,24 @@ void M2MConnectionHandlerPimpl::receive_handshake_handler()
                return_value == M2MConnectionHandler::SOCKET_TIMEOUT        ||
                return_value == M2MConnectionHandler::MEMORY_ALLOCATION_FAILED) {
         tr_error("M2MConnectionHandlerPimpl::receive_handshake_handler() - retcode %d", return_value);
+        SPAN_TRACE_END(TLS_HANDSHAKE, 1);
+#if M2M_HAPPY_EYEBALLS
+        // No answer from this address, move on to the next one right away
+        if ((return_value == M2MConnectionHandler::SOCKET_TIMEOUT || return_value == M2MConnectionHandler::SOCKET_READ_ERROR) &&
+                !_is_server_ping && has_untried_address()) {
+            tr_info("M2MConnectionHandlerPimpl::receive_handshake_handler() - trying next address");
+            close_socket();
+            _socket_state = EsocketStateInitializeConnection;
+            send_event(ESocketConnect);
+            return;
+        }
+#endif
+#if PAL_USE_DNS_CACHE && ((PAL_DNS_API_VERSION == 0) || (PAL_DNS_API_VERSION == 1))
+        // No answer from the cached address, resolve the server again on the next attempt
+        if (return_value == M2MConnectionHandler::SOCKET_TIMEOUT || return_value == M2MConnectionHandler::SOCKET_READ_ERROR) {
+            pal_removeDNSCacheEntry(_server_address.c_str());
+        }
+#endif
         _observer.socket_error(return_value, true);
         close_socket();
     } else {
@@ -871,16 +1330,31 @@ void M2MConnectionHandlerPimpl::receive_handler()
     if (_socket_state == ESocketStateSecureConnection) {
 
         int rcv_size;
+#if MBED_CLIENT_ZERO_COPY_RECEIVE
+        const uint8_t *recv_data;
+#else
         unsigned char recv_buffer[BUFFER_LENGTH];
+#endif
 
         // we need to read as much as there is data available as the events may or may not be suppressed
         do {
             tr_debug("M2MConnectionHandlerPimpl::receive_handler()..");
+#if MBED_CLIENT_ZERO_COPY_RECEIVE
+            rcv_size = _security_impl->read_in_place(&recv_data);
+#else
             rcv_size = _security_impl->read(recv_buffer, sizeof(recv_buffer));
+#endif
             tr_debug("M2MConnectionHandlerPimpl::receive_handler() res: %d", rcv_size);
             if (rcv_size > 0) {
+#if MBED_CLIENT_ZERO_COPY_RECEIVE
+                // The record stays in the TLS input buffer until the packet has been processed
+                _observer.data_available((uint8_t *)recv_data,
+                                         rcv_size, _address);
+                _security_impl->read_in_place_done();
+#else
                 _observer.data_available((uint8_t *)recv_buffer,
                                          rcv_size, _address);
+#endif
             } else if (M2MConnectionHandler::SSL_PEER_CLOSE_NOTIFY == rcv_size) {
                 // This is common notification for termination of BS.
                 tr_info("M2MConnectionHandlerPimpl::receive_handler() - peer close notify!");
@@ -899,22 +1373,60 @@ void M2MConnectionHandlerPimpl::receive_handler()
             }
         } while (rcv_size > 0 && _socket_state == ESocketStateSecureConnection);
 
-    } else {
-        size_t recv;
+    } else if (!is_tcp_connection()) {
+        uint32_t received;
         palStatus_t status;
-        unsigned char recv_buffer[BUFFER_LENGTH];
+        unsigned char recv_buffer[MBED_CLIENT_DATAGRAM_BATCH_SIZE][BUFFER_LENGTH];
+        palDatagram_t datagrams[MBED_CLIENT_DATAGRAM_BATCH_SIZE];
+
+        for (int i = 0; i < MBED_CLIENT_DATAGRAM_BATCH_SIZE; i++) {
+            datagrams[i].buffer = recv_buffer[i];
+            datagrams[i].length = sizeof(recv_buffer[i]);
+            datagrams[i].address = NULL;
+        }
+
         do {
-            if (is_tcp_connection()) {
+            status = pal_receiveFromBatch(_socket, datagrams, MBED_CLIENT_DATAGRAM_BATCH_SIZE, &received);
+
+            if (status == PAL_ERR_SOCKET_WOULD_BLOCK) {
+                return;
+            } else if (status != PAL_SUCCESS) {
+                tr_error("M2MConnectionHandlerPimpl::receive_handler() - SOCKET_READ_ERROR %" PRIx32, status);
+                _observer.socket_error(M2MConnectionHandler::SOCKET_READ_ERROR, true);
+                close_socket();
+                return;
+            }
+
+            // Observer for UDP plain mode
+            for (uint32_t i = 0; i < received && _socket_state == ESocketStateUnsecureConnection; i++) {
+                tr_debug("M2MConnectionHandlerPimpl::receive_handler() - data received, len: %zu", datagrams[i].bytesTransferred);
+                _observer.data_available((uint8_t *)recv_buffer[i], datagrams[i].bytesTransferred, _address);
+            }
+        } while (received > 0 && _socket_state == ESocketStateUnsecureConnection);
+
+    } else {
 #ifdef PAL_NET_TCP_AND_TLS_SUPPORT
-                status = pal_recv(_socket, recv_buffer, sizeof(recv_buffer), &recv);
-#endif //PAL_NET_TCP_AND_TLS_SUPPORT
-            } else {
-                status = pal_receiveFrom(_socket, recv_buffer, sizeof(recv_buffer), NULL, NULL, &recv);
+        size_t recv;
+        palStatus_t status;
+
+        if (!_tcp_frame_buffer) {
+            _tcp_frame_buffer = (uint8_t *)malloc(TCP_FRAME_BUFFER_SIZE);
+            if (!_tcp_frame_buffer) {
+                tr_error("M2MConnectionHandlerPimpl::receive_handler() - memory allocation failed!");
+                _observer.socket_error(M2MConnectionHandler::MEMORY_ALLOCATION_FAILED, false);
+                close_socket();
+                return;
             }
+        }
+
+        do {
+            status = pal_recv(_socket, _tcp_frame_buffer + _tcp_frame_length,
+                              TCP_FRAME_BUFFER_SIZE - _tcp_frame_length, &recv);
 
             if (status == PAL_ERR_SOCKET_WOULD_BLOCK) {
                 return;
-            } else if (status != PAL_SUCCESS) {
+            } else if (status != PAL_SUCCESS || recv == 0) {
+                // Zero length read means that the peer has closed the connection
                 tr_error("M2MConnectionHandlerPimpl::receive_handler() - SOCKET_READ_ERROR %" PRIx32, status);
                 _observer.socket_error(M2MConnectionHandler::SOCKET_READ_ERROR, true);
                 close_socket();
@@ -923,29 +1435,64 @@ void M2MConnectionHandlerPimpl::receive_handler()
 
             tr_debug("M2MConnectionHandlerPimpl::receive_handler() - data received, len: %zu", recv);
 
-            if (!is_tcp_connection()) { // Observer for UDP plain mode
-                _observer.data_available((uint8_t *)recv_buffer, recv, _address);
-            } else {
+            _tcp_frame_length += recv;
+        } while (process_tcp_frames());
+#endif //PAL_NET_TCP_AND_TLS_SUPPORT
+    }
+}
+
 #ifdef PAL_NET_TCP_AND_TLS_SUPPORT
-                if (recv < 4) {
-                    tr_error("M2MConnectionHandlerPimpl::receive_handler() - TCP SOCKET_READ_ERROR");
-                    _observer.socket_error(M2MConnectionHandler::SOCKET_READ_ERROR, true);
-                    close_socket();
-                    return;
-                }
+bool M2MConnectionHandlerPimpl::process_tcp_frames()
+{
+    uint32_t offset = 0;
 
-                //We need to "shim" out the length from the front
-                uint32_t len = (recv_buffer[0] << 24 & 0xFF000000) + (recv_buffer[1] << 16 & 0xFF0000);
-                len += (recv_buffer[2] << 8 & 0xFF00) + (recv_buffer[3] & 0xFF);
-                if (len > 0 && len <= recv - 4) {
-                    // Observer for TCP plain mode
-                    _observer.data_available(recv_buffer + 4, len, _address);
-                }
-#endif //PAL_NET_TCP_AND_TLS_SUPPORT
+    // Rest of a frame which did not fit into the buffer
+    if (_tcp_frame_skip) {
+        offset = (_tcp_frame_skip < _tcp_frame_length) ? _tcp_frame_skip : _tcp_frame_length;
+        _tcp_frame_skip -= offset;
+    }
+
+    while (_tcp_frame_length - offset >= TCP_FRAME_HEADER_LENGTH) {
+        // We need to "shim" out the length from the front
+        const uint8_t *frame = _tcp_frame_buffer + offset;
+        uint32_t len = ((uint32_t)frame[0] << 24) | ((uint32_t)frame[1] << 16) |
+                       ((uint32_t)frame[2] << 8) | frame[3];
+
+        if (len > TCP_FRAME_BUFFER_SIZE - TCP_FRAME_HEADER_LENGTH) {
+            tr_error("M2MConnectionHandlerPimpl::process_tcp_frames() - frame too long %" PRIu32 ", dropped", len);
+            uint32_t available = _tcp_frame_length - offset - TCP_FRAME_HEADER_LENGTH;
+            if (len > available) {
+                _tcp_frame_skip = len - available;
+                len = available;
+            }
+            offset += TCP_FRAME_HEADER_LENGTH + len;
+            continue;
+        }
+
+        if (_tcp_frame_length - offset - TCP_FRAME_HEADER_LENGTH < len) {
+            // Wait for the rest of the frame
+            break;
+        }
+
+        offset += TCP_FRAME_HEADER_LENGTH + len;
+        if (len > 0) {
+            // Observer for TCP plain mode
+            _observer.data_available((uint8_t *)frame + TCP_FRAME_HEADER_LENGTH, len, _address);
+
+            // Observer may have closed the connection, which drops the buffered data
+            if (_socket_state != ESocketStateUnsecureConnection) {
+                return false;
             }
-        } while (recv > 0 && _socket_state == ESocketStateUnsecureConnection);
+        }
+    }
+
+    _tcp_frame_length -= offset;
+    if (_tcp_frame_length && offset) {
+        memmove(_tcp_frame_buffer, _tcp_frame_buffer + offset, _tcp_frame_length);
     }
+    return true;
 }
+#endif //PAL_NET_TCP_AND_TLS_SUPPORT
 
 void M2MConnectionHandlerPimpl::claim_mutex()
 {
@@ -960,14 +1507,6 @@ void M2MConnectionHandlerPimpl::release_mutex()
 bool M2MConnectionHandlerPimpl::init_socket()
 {
     palSocketType_t socket_type = PAL_SOCK_DGRAM;
-    palStatus_t status;
-    palSocketAddress_t bind_address;
-    palIpV4Addr_t interface_address4;
-    palIpV6Addr_t interface_address6;
-
-    memset(&bind_address, 0, sizeof(palSocketAddress_t));
-    memset(&interface_address4, 0, sizeof(interface_address4));
-    memset(&interface_address6, 0, sizeof(interface_address6));
 
     if (is_tcp_connection()) {
 #ifdef PAL_NET_TCP_AND_TLS_SUPPORT
@@ -980,39 +1519,86 @@ bool M2MConnectionHandlerPimpl::init_socket()
         return;
 #endif //PAL_NET_TCP_AND_TLS_SUPPORT
     }
-    status = pal_asynchronousSocketWithArgument((palSocketDomain_t)_socket_address.addressType,
+
+    if (!open_socket(_socket, (const palSocketAddress_t &)_socket_address, socket_type)) {
+        _observer.socket_error(M2MConnectionHandler::SOCKET_ABORT);
+        return false;
+    }
+
+    if (_secure_connection) {
+        _security_impl->set_socket(_socket, (palSocketAddress_t *)&_socket_address);
+    }
+    return true;
+}
+
+bool M2MConnectionHandlerPimpl::open_socket(palSocket_t &socket, const palSocketAddress_t &address, palSocketType_t socket_type)
+{
+    palStatus_t status;
+    palSocketAddress_t bind_address;
+    palIpV4Addr_t interface_address4;
+    palIpV6Addr_t interface_address6;
+
+    memset(&bind_address, 0, sizeof(palSocketAddress_t));
+    memset(&interface_address4, 0, sizeof(interface_address4));
+    memset(&interface_address6, 0, sizeof(interface_address6));
+
+    status = pal_asynchronousSocketWithArgument((palSocketDomain_t)address.addressType,
                                                 socket_type, true, _net_iface, &socket_event_handler,
-                                                this, &_socket);
+                                                this, &socket);
 
     if (PAL_SUCCESS != status) {
-        tr_error("M2MConnectionHandlerPimpl::init_socket() - socket create error : %" PRIx32, status);
-        _observer.socket_error(M2MConnectionHandler::SOCKET_ABORT);
+        tr_error("M2MConnectionHandlerPimpl::open_socket() - socket create error : %" PRIx32, status);
         return false;
     }
 
-    if (_socket_address.addressType == PAL_AF_INET) {
+    if (address.addressType == PAL_AF_INET) {
         status = pal_setSockAddrIPV4Addr(&bind_address, interface_address4);
-    } else if (_socket_address.addressType == PAL_AF_INET6) {
+    } else if (address.addressType == PAL_AF_INET6) {
         status = pal_setSockAddrIPV6Addr(&bind_address, interface_address6);
     } else {
-        tr_warn("M2MConnectionHandlerPimpl::init_socket() - stack type: %d", (int)_socket_address.addressType);
+        tr_warn("M2MConnectionHandlerPimpl::open_socket() - stack type: %d", (int)address.addressType);
     }
     if (PAL_SUCCESS != status) {
-        tr_error("M2MConnectionHandlerPimpl::init_socket - setSockAddrIPV err: %" PRIx32, status);
+        tr_error("M2MConnectionHandlerPimpl::open_socket - setSockAddrIPV err: %" PRIx32, status);
         return false;
     }
     status = pal_setSockAddrPort(&bind_address, _listen_port);
     if (PAL_SUCCESS != status) {
-        tr_error("M2MConnectionHandlerPimpl::init_socket - setSockAddrPort err: %" PRIx32, status);
+        tr_error("M2MConnectionHandlerPimpl::open_socket - setSockAddrPort err: %" PRIx32, status);
         return false;
     }
-    pal_bind(_socket, &bind_address, sizeof(bind_address));
+    pal_bind(socket, &bind_address, sizeof(bind_address));
+    return true;
+}
 
-    if (_secure_connection) {
-        _security_impl->set_socket(_socket, (palSocketAddress_t *)&_socket_address);
+#if MBED_CLIENT_CID_FAST_RESUME
+bool M2MConnectionHandlerPimpl::rebind_socket()
+{
+    if (_socket_state != ESocketStateSecureConnection || is_tcp_connection() ||
+            !_security_impl || !_security_impl->is_cid_available()) {
+        return false;
+    }
+
+    // The new socket picks up the current local address, the server finds the session by the connection ID
+    palSocket_t socket = 0;
+    if (!open_socket(socket, (const palSocketAddress_t &)_socket_address, PAL_SOCK_DGRAM)) {
+        if (socket) {
+            pal_close(&socket);
+        }
+        return false;
     }
+
+    // Callbacks for the old socket during pal_close() are ignored in this state
+    _socket_state = ESocketStateCloseBeingCalled;
+    pal_close(&_socket);
+    _socket = socket;
+    _socket_state = ESocketStateSecureConnection;
+
+    _security_impl->set_socket(_socket, (palSocketAddress_t *)&_socket_address);
+    tr_info("M2MConnectionHandlerPimpl::rebind_socket - DTLS session moved to a new socket");
     return true;
 }
+#endif
 
 bool M2MConnectionHandlerPimpl::is_tcp_connection() const
 {
@@ -1032,10 +1618,19 @@ void M2MConnectionHandlerPimpl::close_socket()
         tr_info("M2MConnectionHandlerPimpl::close_socket");
         _socket = 0;
     }
+#if M2M_CONNECTION_RACING
+    close_racing_socket();
+#endif
 
     // make sure the socket connection statemachine is reset too.
     _socket_state = ESocketStateDisconnected;
 
+#ifdef PAL_NET_TCP_AND_TLS_SUPPORT
+    // Partial frame of the old connection is useless for the next one
+    _tcp_frame_length = 0;
+    _tcp_frame_skip = 0;
+#endif
+
     if (_security_impl) {
         _security_impl->reset();
     }
@@ -1043,26 +1638,97 @@ void M2MConnectionHandlerPimpl::close_socket()
     claim_mutex();
     /*ns_list_foreach_safe(M2MConnectionHandlerPimpl::send_data_queue_s, tmp, &_linked_list_send_data) {
         ns_list_remove(&_linked_list_send_data, tmp);
-        free(tmp->data);
         free(tmp);
     }*/
     // Workaround for IAR compilation issue. ns_list_foreach does not compile with IAR.
     // Error[Pe144]: a value of type "void *" cannot be used to initialize an entity of type "M2MConnectionHandlerPimpl::send_data_queue *"
-    while (!ns_list_is_empty(&_linked_list_send_data)) {
-        send_data_queue_s *data = (send_data_queue_s *)ns_list_get_first(&_linked_list_send_data);
-        ns_list_remove(&_linked_list_send_data, data);
-        free(data->data);
+    for (int i = 0; i < SendClassCount; i++) {
+        while (!ns_list_is_empty(&_linked_list_send_data[i])) {
+            send_data_queue_s *data = (send_data_queue_s *)ns_list_get_first(&_linked_list_send_data[i]);
+            ns_list_remove(&_linked_list_send_data[i], data);
+            free(data);
+        }
+    }
+    release_mutex();
+
+#if M2M_SEND_PACING
+    send_pacing_cancel();
+    _send_pacing_tokens = MBED_CLIENT_SEND_PACING_BURST;
+#endif
+}
+
+M2MConnectionHandlerPimpl::send_data_queue_s *M2MConnectionHandlerPimpl::alloc_send_buffer(uint16_t size)
+{
+    send_data_queue_s *out_data = NULL;
+
+    claim_mutex();
+    while (!ns_list_is_empty(&_send_buffer_pool)) {
+        out_data = (send_data_queue_s *)ns_list_get_first(&_send_buffer_pool);
+        ns_list_remove(&_send_buffer_pool, out_data);
+        _send_buffer_pool_count--;
+        if (out_data->capacity >= size) {
+            break;
+        }
+        // Too small for this packet, drop it and allocate a bigger one
+        free(out_data);
+        out_data = NULL;
+    }
+    release_mutex();
+
+    if (!out_data) {
+        // Round up so that the buffer can be reused for slightly bigger packets
+        uint32_t capacity = ((uint32_t)size + MBED_CLIENT_SEND_BUFFER_GRANULARITY - 1) &
+                            ~((uint32_t)MBED_CLIENT_SEND_BUFFER_GRANULARITY - 1);
+        if (capacity > UINT16_MAX) {
+            capacity = UINT16_MAX;
+        }
+        out_data = (send_data_queue_s *)malloc(sizeof(send_data_queue_s) + capacity);
+        if (!out_data) {
+            return NULL;
+        }
+        out_data->capacity = capacity;
+    }
+
+    out_data->data = (uint8_t *)(out_data + 1);
+    out_data->offset = 0;
+    out_data->data_len = 0;
+    return out_data;
+}
+
+void M2MConnectionHandlerPimpl::free_send_buffer(send_data_queue_s *data)
+{
+    claim_mutex();
+    if (_send_buffer_pool_count < MBED_CLIENT_SEND_BUFFER_POOL_SIZE) {
+        ns_list_add_to_start(&_send_buffer_pool, data);
+        _send_buffer_pool_count++;
+        data = NULL;
+    }
+    release_mutex();
+
+    free(data);
+}
+
+void M2MConnectionHandlerPimpl::clear_send_buffer_pool()
+{
+    claim_mutex();
+    while (!ns_list_is_empty(&_send_buffer_pool)) {
+        send_data_queue_s *data = (send_data_queue_s *)ns_list_get_first(&_send_buffer_pool);
+        ns_list_remove(&_send_buffer_pool, data);
         free(data);
     }
+    _send_buffer_pool_count = 0;
     release_mutex();
 }
 
 M2MConnectionHandlerPimpl::send_data_queue_s *M2MConnectionHandlerPimpl::get_item_from_list()
 {
+    send_data_queue_s *out_data = NULL;
     claim_mutex();
-    send_data_queue_s *out_data = (send_data_queue_s *)ns_list_get_first(&_linked_list_send_data);
-    if (out_data) {
-        ns_list_remove(&_linked_list_send_data, out_data);
+    for (int i = 0; i < SendClassCount && !out_data; i++) {
+        out_data = (send_data_queue_s *)ns_list_get_first(&_linked_list_send_data[i]);
+        if (out_data) {
+            ns_list_remove(&_linked_list_send_data[i], out_data);
+        }
     }
     release_mutex();
     return out_data;
@@ -1071,10 +1737,134 @@ M2MConnectionHandlerPimpl::send_data_queue_s *M2MConnectionHandlerPimpl::get_ite
 void M2MConnectionHandlerPimpl::add_item_to_list(M2MConnectionHandlerPimpl::send_data_queue_s *data)
 {
     claim_mutex();
-    ns_list_add_to_start(&_linked_list_send_data, data);
+    ns_list_add_to_start(&_linked_list_send_data[data->send_class], data);
     release_mutex();
 }
 
+M2MConnectionHandlerPimpl::SendClass M2MConnectionHandlerPimpl::classify_send_data(const uint8_t *data, uint16_t data_len)
+{
+    // Fixed header: version, type and token length, code and message id
+    if (data_len < 4) {
+        return SendClassNotification;
+    }
+
+    const uint8_t type = data[0] & 0x30;
+    if (data[1] == COAP_MSG_CODE_EMPTY ||
+            type == COAP_MSG_TYPE_ACKNOWLEDGEMENT ||
+            type == COAP_MSG_TYPE_RESET) {
+        return SendClassControl;
+    }
+
+    // Walk the options up to block1, the only larger option number used is size1
+    const bool request = data[1] < COAP_MSG_CODE_RESPONSE_CREATED;
+    bool first_path = true;
+    uint32_t pos = 4 + (data[0] & 0x0f);
+    uint32_t option = 0;
+    while (pos < data_len && data[pos] != 0xff) {
+        uint32_t delta = data[pos] >> 4;
+        uint32_t length = data[pos] & 0x0f;
+        pos++;
+
+        uint32_t *fields[2] = { &delta, &length };
+        for (int i = 0; i < 2; i++) {
+            if (*fields[i] == 13 && pos < data_len) {
+                *fields[i] = data[pos] + 13;
+                pos += 1;
+            } else if (*fields[i] == 14 && pos + 1 < data_len) {
+                *fields[i] = ((data[pos] << 8) | data[pos + 1]) + 269;
+                pos += 2;
+            } else if (*fields[i] >= 13) {
+                // Malformed or truncated, mbed-coap does not build such
+                return SendClassNotification;
+            }
+        }
+
+        option += delta;
+        if (option > COAP_OPTION_BLOCK1 || pos + length > data_len) {
+            break;
+        }
+
+        if (option == COAP_OPTION_URI_PATH && first_path) {
+            first_path = false;
+            // Location of registration resources starts with rd
+            if (request && length == 2 &&
+                    ((data[pos] == 'r' && data[pos + 1] == 'd') ||
+                     (data[pos] == 'b' && data[pos + 1] == 's'))) {
+                return SendClassRegistration;
+            }
+        } else if (option == COAP_OPTION_BLOCK1 || option == COAP_OPTION_BLOCK2) {
+            return SendClassBulk;
+        }
+        pos += length;
+    }
+
+    return SendClassNotification;
+}
+
+#if M2M_SEND_PACING
+bool M2MConnectionHandlerPimpl::send_pacing_allows(const send_data_queue_s *data)
+{
+    const uint32_t rate = is_tcp_connection() ? MBED_CLIENT_SEND_PACING_RATE_TCP : MBED_CLIENT_SEND_PACING_RATE_UDP;
+    if (!rate || data->send_class == SendClassControl) {
+        // Control messages are small and time critical, they only take from the budget
+        return true;
+    }
+
+    // Refill, the budget may be negative after a message bigger than it
+    const uint32_t now = eventOS_event_timer_ticks();
+    const uint64_t refill = ((uint64_t)rate * (now - _send_pacing_ticks)) / EVENTOS_EVENT_TIMER_HZ;
+    if (refill > 0) {
+        _send_pacing_ticks = now;
+        if (refill >= (uint64_t)(MBED_CLIENT_SEND_PACING_BURST - _send_pacing_tokens)) {
+            _send_pacing_tokens = MBED_CLIENT_SEND_PACING_BURST;
+        } else {
+            _send_pacing_tokens += (int32_t)refill;
+        }
+    }
+
+    if (_send_pacing_tokens > 0) {
+        return true;
+    }
+
+    if (!_send_pacing_event) {
+        const uint64_t wait_ms = ((uint64_t)(1 - _send_pacing_tokens) * 1000 + rate - 1) / rate;
+        arm_event_t event;
+        event.receiver = M2MConnectionHandlerPimpl::_tasklet_id;
+        event.sender = 0;
+        event.event_type = ESocketSend;
+        event.event_id = SEND_PACING_EVENT_ID;
+        event.data_ptr = this;
+        event.priority = ARM_LIB_MED_PRIORITY_EVENT;
+        event.event_data = 0;
+        uint32_t ticks = eventOS_event_timer_ms_to_ticks((uint32_t)wait_ms);
+        _send_pacing_event = eventOS_event_timer_request_in(&event, ticks ? ticks : 1);
+        if (!_send_pacing_event) {
+            tr_error("M2MConnectionHandlerPimpl::send_pacing_allows() - timer request failed");
+            // Sending is the only way forward without a timer
+            return true;
+        }
+    }
+    return false;
+}
+
+void M2MConnectionHandlerPimpl::send_pacing_consume(uint16_t bytes)
+{
+    // Keep the debt bounded so that the refill arithmetic can not overflow
+    _send_pacing_tokens -= bytes;
+    if (_send_pacing_tokens < -(int32_t)UINT16_MAX) {
+        _send_pacing_tokens = -(int32_t)UINT16_MAX;
+    }
+}
+
+void M2MConnectionHandlerPimpl::send_pacing_cancel()
+{
+    if (_send_pacing_event) {
+        eventOS_cancel(_send_pacing_event);
+        _send_pacing_event = NULL;
+    }
+}
+#endif
+
 void M2MConnectionHandlerPimpl::force_close()
 {
     close_socket();
@@ -1144,11 +1934,19 @@ void M2MConnectionHandlerPimpl::timer_expired(M2MTimerObserver::Type type)
     switch (type) {
         case M2MTimerObserver::DnsQueryFallback:
             tr_warn("DNS Query Fallback timer expired!");
+            SPAN_TRACE_END(DNS, 1);
             if (_handler_async_DNS > 0) {
                 pal_cancelAddressInfoAsync(_handler_async_DNS);
             }
             send_event(ESocketDnsError);
             break;
+#if M2M_CONNECTION_RACING
+        case M2MTimerObserver::ConnectionAttempt:
+            if (_socket_state == ESocketStateConnecting) {
+                start_racing_connect();
+            }
+            break;
+#endif
         default:
             break;
     }
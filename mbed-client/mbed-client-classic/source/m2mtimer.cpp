@@ -55,3 +55,11 @@ bool M2MTimer::is_intermediate_interval_passed(){
 bool M2MTimer::is_total_interval_passed(){
     return _private_impl->is_total_interval_passed();
 }
+
+uint64_t M2MTimer::elapsed_time(){
+    return _private_impl->elapsed_time();
+}
+
+uint64_t M2MTimer::remaining_time(){
+    return _private_impl->remaining_time();
+}
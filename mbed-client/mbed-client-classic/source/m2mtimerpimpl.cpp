@@ -28,12 +28,32 @@
 
 #define MBED_CLIENT_TIMER_TASKLET_INIT_EVENT 0
 #define MBED_CLIENT_TIMER_EVENT 10
+#define MBED_CLIENT_TIMER_WHEEL_EVENT 11
 
 #define TRACE_GROUP "tmer"
 
 int8_t M2MTimerPimpl::_tasklet_id = -1;
 uint8_t M2MTimerPimpl::_next_event_id = (uint8_t)M2MTimerObserver::TypeNotUsed + 1;
 
+#if MBED_CLIENT_TIMER_WHEEL_SIZE
+#define MBED_CLIENT_TIMER_WHEEL_MASK (MBED_CLIENT_TIMER_WHEEL_SIZE - 1)
+
+M2MTimerPimpl *M2MTimerPimpl::_wheel_slots[MBED_CLIENT_TIMER_WHEEL_SIZE];
+M2MTimerPimpl *M2MTimerPimpl::_wheel_expired = NULL;
+uint64_t M2MTimerPimpl::_wheel_now = 0;
+uint32_t M2MTimerPimpl::_wheel_base_ticks = 0;
+uint64_t M2MTimerPimpl::_wheel_done = 0;
+uint64_t M2MTimerPimpl::_wheel_wake = UINT64_MAX;
+arm_event_storage_t *M2MTimerPimpl::_wheel_event = NULL;
+bool M2MTimerPimpl::_wheel_dispatching = false;
+
+static uint32_t wheel_slot_ticks()
+{
+    const uint32_t ticks = eventOS_event_timer_ms_to_ticks(MBED_CLIENT_TIMER_WHEEL_RESOLUTION);
+    return ticks ? ticks : 1;
+}
+#endif
+
 extern "C" void tasklet_func(arm_event_s *event)
 {
     // skip the init event as there will be a timer event after
@@ -45,6 +65,11 @@ extern "C" void tasklet_func(arm_event_s *event)
             tr_debug("M2MTimerPimpl:tasklet_func event->data_ptr == NULL: event->event_id: %d",event->event_id);
         }
     }
+#if MBED_CLIENT_TIMER_WHEEL_SIZE
+    else if (event->event_type == MBED_CLIENT_TIMER_WHEEL_EVENT) {
+        M2MTimerPimpl::handle_wheel_event();
+    }
+#endif
 }
 
 
@@ -65,12 +90,19 @@ M2MTimerPimpl::M2MTimerPimpl(M2MTimerObserver& observer)
   _intermediate_interval(0),
   _total_interval(0),
   _still_left(0),
+  _start_ticks(0),
   _timer_event(NULL),
   _type(M2MTimerObserver::Notdefined),
   _status(0),
   _dtls_type(false),
   _single_shot(true),
   _event_id(-1)
+#if MBED_CLIENT_TIMER_WHEEL_SIZE
+  ,_wheel_expiry(0),
+  _wheel_next(NULL),
+  _wheel_prev(NULL),
+  _wheel_list(NULL)
+#endif
 {
     eventOS_scheduler_mutex_wait();
     if (_tasklet_id < 0) {
@@ -124,6 +156,14 @@ void M2MTimerPimpl::start()
 
     int32_t wait_time;
 
+    _start_ticks = eventOS_event_timer_ticks();
+
+#if MBED_CLIENT_TIMER_WHEEL_SIZE
+    (void)wait_time;
+    eventOS_scheduler_mutex_wait();
+    wheel_insert(_interval);
+    eventOS_scheduler_mutex_release();
+#else
     if (_interval > INT32_MAX) {
         _still_left = _interval - INT32_MAX;
         wait_time = INT32_MAX;
@@ -131,6 +171,7 @@ void M2MTimerPimpl::start()
         wait_time = _interval;
     }
     request_event_in(wait_time);
+#endif
 }
 
 void M2MTimerPimpl::request_event_in(int32_t delay_ms)
@@ -182,13 +223,199 @@ void M2MTimerPimpl::set_event_id()
 
 void M2MTimerPimpl::cancel()
 {
+#if MBED_CLIENT_TIMER_WHEEL_SIZE
+    // the shared event loop timer is left as is, a wake with nothing due only reschedules it
+    eventOS_scheduler_mutex_wait();
+    wheel_unlink();
+    eventOS_scheduler_mutex_release();
+#else
     if (_timer_event) {
         eventOS_event_timer_cancel(_event_id, _tasklet_id);
         _timer_event->data.data_ptr = NULL;
         _timer_event = NULL;
     }
+#endif
+}
+
+#if MBED_CLIENT_TIMER_WHEEL_SIZE
+void M2MTimerPimpl::wheel_link(M2MTimerPimpl **list)
+{
+    _wheel_list = list;
+    _wheel_prev = NULL;
+    _wheel_next = *list;
+    if (_wheel_next) {
+        _wheel_next->_wheel_prev = this;
+    }
+    *list = this;
+}
+
+void M2MTimerPimpl::wheel_unlink()
+{
+    if (!_wheel_list) {
+        return;
+    }
+    if (_wheel_prev) {
+        _wheel_prev->_wheel_next = _wheel_next;
+    } else {
+        *_wheel_list = _wheel_next;
+    }
+    if (_wheel_next) {
+        _wheel_next->_wheel_prev = _wheel_prev;
+    }
+    _wheel_list = NULL;
+    _wheel_next = NULL;
+    _wheel_prev = NULL;
+}
+
+void M2MTimerPimpl::wheel_advance()
+{
+    const uint32_t slot_ticks = wheel_slot_ticks();
+    const uint32_t slots = (eventOS_event_timer_ticks() - _wheel_base_ticks) / slot_ticks;
+    _wheel_now += slots;
+    _wheel_base_ticks += slots * slot_ticks;
+}
+
+void M2MTimerPimpl::wheel_insert(uint64_t interval)
+{
+    if (_wheel_wake == UINT64_MAX && !_wheel_dispatching) {
+        // Nothing is running, so the wheel may have been idle for longer than
+        // the tick counter wraps. Restart the slot count from now.
+        _wheel_base_ticks = eventOS_event_timer_ticks();
+        _wheel_now = _wheel_done + 1;
+    } else {
+        wheel_advance();
+    }
+
+    if (interval > UINT64_MAX / 2) {
+        interval = UINT64_MAX / 2;
+    }
+
+    // Expire at the first slot boundary at or after the interval, never early
+    const uint32_t slot_ms = eventOS_event_timer_ticks_to_ms(wheel_slot_ticks());
+    const uint64_t offset = eventOS_event_timer_ticks_to_ms(eventOS_event_timer_ticks() - _wheel_base_ticks) + interval;
+    _wheel_expiry = _wheel_now + (offset + slot_ms - 1) / slot_ms;
+    if (_wheel_expiry <= _wheel_done) {
+        _wheel_expiry = _wheel_done + 1;
+    }
+
+    wheel_link(&_wheel_slots[_wheel_expiry & MBED_CLIENT_TIMER_WHEEL_MASK]);
+
+    // handle_wheel_event() reschedules once it has fired the timers due
+    if (!_wheel_dispatching && _wheel_expiry < _wheel_wake) {
+        wheel_schedule_at(_wheel_expiry);
+    }
+}
+
+void M2MTimerPimpl::wheel_schedule_at(uint64_t slot)
+{
+    if (_wheel_event) {
+        eventOS_cancel(_wheel_event);
+        _wheel_event = NULL;
+    }
+
+    // The event loop compares ticks in 32 bits, a far wake only advances the wheel
+    const uint32_t slot_ticks = wheel_slot_ticks();
+    uint32_t ticks = 0;
+    if (slot > _wheel_now) {
+        const uint64_t slots = slot - _wheel_now;
+        ticks = (slots > (INT32_MAX / 2) / slot_ticks) ? INT32_MAX / 2 : (uint32_t)slots * slot_ticks;
+    }
+
+    arm_event_t event = { 0 };
+
+    event.receiver = _tasklet_id;
+    event.sender = _tasklet_id;
+    event.event_type = MBED_CLIENT_TIMER_WHEEL_EVENT;
+    event.priority = ARM_LIB_MED_PRIORITY_EVENT;
+
+    _wheel_event = eventOS_event_timer_request_at(&event, _wheel_base_ticks + ticks);
+
+    // See request_event_in(), the event loop is out of timers
+    assert(_wheel_event != NULL);
+    if (_wheel_event == NULL) {
+        tr_error("M2MTimerPimpl _wheel_event allocation failed");
+        _wheel_wake = UINT64_MAX;
+    } else {
+        _wheel_wake = slot;
+    }
+}
+
+void M2MTimerPimpl::wheel_schedule()
+{
+    uint64_t earliest = UINT64_MAX;
+
+    // The earliest expiry is usually within one turn of the wheel, where it is
+    // the first slot holding a timer of the current turn
+    for (uint64_t slot = _wheel_done + 1; earliest == UINT64_MAX && slot <= _wheel_done + MBED_CLIENT_TIMER_WHEEL_SIZE; slot++) {
+        for (M2MTimerPimpl *timer = _wheel_slots[slot & MBED_CLIENT_TIMER_WHEEL_MASK]; timer; timer = timer->_wheel_next) {
+            if (timer->_wheel_expiry == slot) {
+                earliest = slot;
+                break;
+            }
+        }
+    }
+
+    if (earliest == UINT64_MAX) {
+        for (uint32_t index = 0; index < MBED_CLIENT_TIMER_WHEEL_SIZE; index++) {
+            for (M2MTimerPimpl *timer = _wheel_slots[index]; timer; timer = timer->_wheel_next) {
+                if (timer->_wheel_expiry < earliest) {
+                    earliest = timer->_wheel_expiry;
+                }
+            }
+        }
+    }
+
+    if (earliest != UINT64_MAX) {
+        wheel_schedule_at(earliest);
+    } else if (_wheel_event) {
+        eventOS_cancel(_wheel_event);
+        _wheel_event = NULL;
+    }
 }
 
+void M2MTimerPimpl::handle_wheel_event()
+{
+    eventOS_scheduler_mutex_wait();
+
+    _wheel_event = NULL;
+    _wheel_wake = UINT64_MAX;
+    wheel_advance();
+
+    // Collect the timers due from the slots passed since the last round.
+    // Timers of later turns of the wheel stay in their slot.
+    uint64_t last = _wheel_now;
+    if (last - _wheel_done > MBED_CLIENT_TIMER_WHEEL_SIZE) {
+        last = _wheel_done + MBED_CLIENT_TIMER_WHEEL_SIZE;
+    }
+    for (uint64_t slot = _wheel_done + 1; slot <= last; slot++) {
+        M2MTimerPimpl *timer = _wheel_slots[slot & MBED_CLIENT_TIMER_WHEEL_MASK];
+        while (timer) {
+            M2MTimerPimpl *next = timer->_wheel_next;
+            if (timer->_wheel_expiry <= _wheel_now) {
+                timer->wheel_unlink();
+                timer->wheel_link(&_wheel_expired);
+            }
+            timer = next;
+        }
+    }
+    _wheel_done = _wheel_now;
+
+    // The observers may start, stop or delete any timer, including the ones
+    // still on the expired list, so it is popped one at a time
+    _wheel_dispatching = true;
+    while (_wheel_expired) {
+        M2MTimerPimpl *timer = _wheel_expired;
+        timer->wheel_unlink();
+        timer->timer_expired();
+    }
+    _wheel_dispatching = false;
+
+    wheel_schedule();
+
+    eventOS_scheduler_mutex_release();
+}
+#endif
+
 void M2MTimerPimpl::stop_timer()
 {
     _interval = 0;
@@ -240,6 +467,26 @@ uint64_t M2MTimerPimpl::get_still_left_time() const
    return _still_left;
 }
 
+uint64_t M2MTimerPimpl::elapsed_time() const
+{
+    return eventOS_event_timer_ticks_to_ms(eventOS_event_timer_ticks() - _start_ticks);
+}
+
+uint64_t M2MTimerPimpl::remaining_time() const
+{
+#if MBED_CLIENT_TIMER_WHEEL_SIZE
+    if (!_wheel_list) {
+#else
+    if (!_timer_event) {
+#endif
+        return UINT64_MAX;
+    }
+
+    // The rounds of a long interval all count from the last start
+    const uint64_t elapsed = elapsed_time();
+    return (elapsed < _interval) ? _interval - elapsed : 0;
+}
+
 void M2MTimerPimpl::start_still_left_timer()
 {
     if (_still_left > 0) {
@@ -24,6 +24,7 @@
 #include "mbed-client/m2mconfig.h"
 
 #include "pal.h"
+#include "mbed-cloud-client/PerfCounters.h"
 
 #include <time.h>
 
@@ -85,6 +86,20 @@ public:
      */
     int send_message(unsigned char *message, int len);
 
+    /**
+     * \brief Packs the DTLS records of the following send_message() calls into
+     * shared datagrams, until end_coalescing() is called.
+     * \param datagram_size The maximum size of a datagram.
+     * \return True if the records are packed, false if they are sent one per datagram.
+     */
+    bool begin_coalescing(uint16_t datagram_size);
+
+    /**
+     * \brief Sends the records packed since begin_coalescing().
+     * \return 0 on success, or an M2MConnectionHandler error code.
+     */
+    int end_coalescing();
+
     /**
      * \brief Reads the data received from the server.
      * \param message The data to be read.
@@ -93,6 +108,19 @@ public:
      */
     int read(unsigned char* buffer, uint16_t len);
 
+    /**
+     * \brief Reads the data of the next record received from the server
+     * without copying it out of the TLS library.
+     * \param data Set to point to the data, valid until read_in_place_done() is called.
+     * \return The length of the data, or an M2MConnectionHandler error code.
+     */
+    int read_in_place(const uint8_t **data);
+
+    /**
+     * \brief Releases the data returned by read_in_place().
+     */
+    void read_in_place_done();
+
     /**
      * This function is no longer used.
      */
@@ -169,6 +197,14 @@ private:
     palTLSSocket_t                      _tls_socket;
     entropy_cb                          _entropy;
     uint8_t                            _network_rtt_estimate;
+    // Context whose record is lent out by read_in_place(), and the configuration
+    // to free with it if it was reset while lent
+    palTLSHandle_t                      _lent_ssl;
+    palTLSConfHandle_t                  _lent_conf;
+#if PERF_COUNTERS_ENABLED
+    // Start of the handshake, set when the context is initialized
+    uint32_t                            _handshake_start_ticks;
+#endif
 
     friend class Test_M2MConnectionSecurityPimpl;
 };
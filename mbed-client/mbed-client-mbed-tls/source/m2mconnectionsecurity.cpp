@@ -44,10 +44,26 @@ int M2MConnectionSecurity::send_message(unsigned char *message, int len){
     return _private_impl->send_message(message, len);
 }
 
+bool M2MConnectionSecurity::begin_coalescing(uint16_t datagram_size){
+    return _private_impl->begin_coalescing(datagram_size);
+}
+
+int M2MConnectionSecurity::end_coalescing(){
+    return _private_impl->end_coalescing();
+}
+
 int M2MConnectionSecurity::read(unsigned char* buffer, uint16_t len){
     return _private_impl->read(buffer, len);
 }
 
+int M2MConnectionSecurity::read_in_place(const uint8_t **data){
+    return _private_impl->read_in_place(data);
+}
+
+void M2MConnectionSecurity::read_in_place_done(){
+    _private_impl->read_in_place_done();
+}
+
 void M2MConnectionSecurity::set_random_number_callback(random_number_cb callback)
 {
     _private_impl->set_random_number_callback(callback);
@@ -31,6 +31,8 @@
 #include "mbed-trace/mbed_trace.h"
 #include "mbed-client/m2mconstants.h"
 #include "pal.h"
+#include "eventOS_event_timer.h"
+#include "mbed-cloud-client/SpanTrace.h"
 #include "m2mdevice.h"
 #include "m2minterfacefactory.h"
 
@@ -43,7 +45,12 @@ M2MConnectionSecurityPimpl::M2MConnectionSecurityPimpl(M2MConnectionSecurity::Se
      _conf(0),
      _ssl(0),
      _sec_mode(mode),
-     _network_rtt_estimate(10)    // Use reasonable initialization value for the RTT estimate. Must be larger than 0.
+     _network_rtt_estimate(10),    // Use reasonable initialization value for the RTT estimate. Must be larger than 0.
+     _lent_ssl(0),
+     _lent_conf(0)
+#if PERF_COUNTERS_ENABLED
+     , _handshake_start_ticks(0)
+#endif
 {
     memset(&_entropy, 0, sizeof(entropy_cb));
     memset(&_tls_socket, 0, sizeof(palTLSSocket_t));
@@ -51,6 +58,7 @@ M2MConnectionSecurityPimpl::M2MConnectionSecurityPimpl(M2MConnectionSecurity::Se
 
 M2MConnectionSecurityPimpl::~M2MConnectionSecurityPimpl()
 {
+    read_in_place_done();
     if(_ssl) {
         pal_freeTLS(&_ssl);
     }
@@ -61,6 +69,12 @@ M2MConnectionSecurityPimpl::~M2MConnectionSecurityPimpl()
 
 void M2MConnectionSecurityPimpl::reset()
 {
+    if(_ssl && _ssl == _lent_ssl) {
+        // The record is still being processed, the context is freed by read_in_place_done()
+        _lent_conf = _conf;
+        _ssl = 0;
+        _conf = 0;
+    }
     if(_ssl) {
         pal_freeTLS(&_ssl);
     }
@@ -239,6 +253,9 @@ int M2MConnectionSecurityPimpl::init(const M2MSecurity *security, uint16_t secur
     }
 
     _init_done = M2MConnectionSecurityPimpl::INIT_DONE;
+#if PERF_COUNTERS_ENABLED
+    _handshake_start_ticks = eventOS_event_timer_ticks();
+#endif
 
 #if MBED_CONF_MBED_TRACE_ENABLE
     // Note: This call is not enough, one also needs the MBEDTLS_DEBUG_C to be defined globally
@@ -253,6 +270,7 @@ int M2MConnectionSecurityPimpl::init(const M2MSecurity *security, uint16_t secur
 int M2MConnectionSecurityPimpl::connect(M2MConnectionHandler* /*connHandler*/, bool is_server_ping)
 {
     palStatus_t ret = PAL_SUCCESS;
+    SPAN_TRACE_BEGIN(TLS_HANDSHAKE_STEP);
     if (is_server_ping) {
         tr_info("M2MConnectionSecurityPimpl::connect is SERVER PING");
         ret = pal_handShake(_ssl, _conf, true);
@@ -260,10 +278,18 @@ int M2MConnectionSecurityPimpl::connect(M2MConnectionHandler* /*connHandler*/, b
         tr_debug("M2MConnectionSecurityPimpl::connect is normal HANDSHAKE");
         ret = pal_handShake(_ssl, _conf, false);
     }
+    // The low bits tell a pending flight from an error
+    SPAN_TRACE_END(TLS_HANDSHAKE_STEP, ret);
 
     tr_debug("M2MConnectionSecurityPimpl::connect return code  %" PRIx32, ret);
 
     if (ret == PAL_SUCCESS) {
+#if PERF_COUNTERS_ENABLED
+        const uint32_t handshake_time = eventOS_event_timer_ticks_to_ms(eventOS_event_timer_ticks() - _handshake_start_ticks);
+        PERF_COUNTER_ADD(TLS_HANDSHAKES, 1);
+        PERF_COUNTER_SET(TLS_HANDSHAKE_TIME, handshake_time);
+        PERF_COUNTER_MAX(TLS_HANDSHAKE_TIME_MAX, handshake_time);
+#endif
         return M2MConnectionHandler::ERROR_NONE;
     } else if (ret == PAL_ERR_TLS_WANT_READ || ret == PAL_ERR_TLS_WANT_WRITE){
         return M2MConnectionHandler::CONNECTION_ERROR_WANTS_READ;
@@ -313,6 +339,23 @@ int M2MConnectionSecurityPimpl::send_message(unsigned char *message, int len)
     return ret; //bytes written or error
 }
 
+bool M2MConnectionSecurityPimpl::begin_coalescing(uint16_t datagram_size)
+{
+    return pal_sslBeginCoalescing(_ssl, datagram_size) == PAL_SUCCESS;
+}
+
+int M2MConnectionSecurityPimpl::end_coalescing()
+{
+    palStatus_t return_value = pal_sslEndCoalescing(_ssl);
+    if (return_value == PAL_SUCCESS) {
+        return 0;
+    } else if (return_value == PAL_ERR_NO_MEMORY) {
+        return M2MConnectionHandler::MEMORY_ALLOCATION_FAILED;
+    }
+    tr_error("M2MConnectionSecurityPimpl::end_coalescing - failed %" PRIx32, return_value);
+    return M2MConnectionHandler::SOCKET_SEND_ERROR;
+}
+
 int M2MConnectionSecurityPimpl::read(unsigned char* buffer, uint16_t len)
 {
     int ret = M2MConnectionHandler::SOCKET_READ_ERROR;
@@ -338,6 +381,50 @@ int M2MConnectionSecurityPimpl::read(unsigned char* buffer, uint16_t len)
     return ret;
 }
 
+int M2MConnectionSecurityPimpl::read_in_place(const uint8_t **data)
+{
+    int ret = M2MConnectionHandler::SOCKET_READ_ERROR;
+    palStatus_t return_value;
+    uint32_t len_read;
+
+    read_in_place_done();
+
+    if (PAL_SUCCESS == (return_value = pal_sslReadInPlace(_ssl, data, &len_read))) {
+        _lent_ssl = _ssl;
+        ret = (int)len_read;
+    }
+    else if (return_value == PAL_ERR_TLS_WANT_READ || return_value == PAL_ERR_TLS_WANT_WRITE || return_value == PAL_ERR_TIMEOUT_EXPIRED) {
+        ret = M2MConnectionHandler::CONNECTION_ERROR_WANTS_READ;
+    }
+    else if (return_value == PAL_ERR_TLS_PEER_CLOSE_NOTIFY) {
+        ret = M2MConnectionHandler::SSL_PEER_CLOSE_NOTIFY;
+    }
+    else if (return_value == PAL_ERR_NO_MEMORY) {
+        ret = M2MConnectionHandler::MEMORY_ALLOCATION_FAILED;
+    }
+    else if (return_value == PAL_ERR_TLS_TIMEOUT) {
+        ret = M2MConnectionHandler::SOCKET_TIMEOUT;
+    }
+
+    return ret;
+}
+
+void M2MConnectionSecurityPimpl::read_in_place_done()
+{
+    if (!_lent_ssl) {
+        return;
+    }
+    if (_lent_ssl == _ssl) {
+        pal_sslReadInPlaceDone(_ssl);
+    } else {
+        pal_freeTLS(&_lent_ssl);
+        if (_lent_conf) {
+            pal_tlsConfigurationFree(&_lent_conf);
+        }
+    }
+    _lent_ssl = 0;
+}
+
 void M2MConnectionSecurityPimpl::set_random_number_callback(random_number_cb callback)
 {
     (void)callback;
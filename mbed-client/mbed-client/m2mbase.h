@@ -197,6 +197,26 @@ public:
      * \deprecated This is internal datastructure and subject to be changed or removed. Do not use on application.
      */
     typedef struct lwm2m_parameters {
+#if MBED_CLIENT_COMPACT_LWM2M_PARAMETERS
+        /*! \union identifier
+         *  \brief Parameter identifier.
+         */
+        union {
+            char               *name;
+            uint16_t            instance_id;
+        } identifier;
+        sn_nsdl_dynamic_resource_parameters_s *dynamic_resource_params;
+        BaseType            base_type : 3;
+        M2MBase::DataType   data_type : 3;
+        bool                multiple_instance : 1;
+        bool                free_on_delete : 1;   /**< \brief true if struct is dynamically allocated and it
+                                                     and its members (name) are to be freed on destructor.
+                                                     \note This also serves as a read-only flag. */
+        bool                identifier_int_type : 1;
+        bool                read_write_callback_set : 1; /**< \brief If set, all the read and write operations are handled in callbacks
+                                                            and the resource value is not stored anymore in M2MResourceBase. */
+        bool                max_age_set : 1;      /**< \brief Max age is not zero and is kept in M2MCallbackStorage. */
+#else
         //add multiple_instances
         uint32_t            max_age; // todo: add flag
         /*! \union identifier
@@ -219,6 +239,7 @@ public:
         bool                 identifier_int_type;
         bool                 read_write_callback_set; /**< \brief If set, all the read and write operations are handled in callbacks
                                                          and the resource value is not stored anymore in M2MResourceBase. */
+#endif // MBED_CLIENT_COMPACT_LWM2M_PARAMETERS
     } lwm2m_parameters_s;
 
 protected:
@@ -354,6 +375,20 @@ public:
      */
     void set_confirmable(bool confirmable);
 
+#if MBED_CLIENT_ADAPTIVE_CONFIRMABLE
+    /**
+     * \brief Sends the notifications as non-confirmable CoAP messages, with a confirmable
+     * one at least every con_every notifications or con_interval seconds. A confirmable
+     * notification is also sent after a lost one and when the value crosses the gt or lt
+     * attribute. Calling set_confirmable() returns to a fixed message type.
+     *
+     * \param con_every Every how manyth notification is confirmable, 0 for no limit.
+     * \param con_interval Maximum seconds between confirmable notifications, 0 for no limit.
+     * Both 0 return to the type set with set_confirmable().
+     */
+    void set_confirmable_policy(uint16_t con_every, uint16_t con_interval);
+#endif
+
     /**
      * \brief Adds the observation level for the object.
      * \param observation_level The level of observation.
@@ -763,6 +798,21 @@ protected: // from M2MReportObserver
 
     static char *stringdup(const char *s);
 
+    /**
+     * \brief Allocates a copy of a name, resource type or interface description,
+     * shared between resources when MBED_CLIENT_SHARED_RESOURCE_STRINGS is enabled.
+     * \param source The string, does not need to be zero terminated.
+     * \param size The length of the string.
+     * \return Zero terminated copy, to be freed with free_resource_string().
+     */
+    static char *alloc_resource_string(const char *source, size_t size);
+
+    /**
+     * \brief Frees a string allocated with alloc_resource_string().
+     * \param str The string, may be NULL.
+     */
+    static void free_resource_string(char *str);
+
     /**
      * \brief Delete the resource structures owned by this object. Note: this needs
      * to be called separately from each subclass' destructor as this method uses a
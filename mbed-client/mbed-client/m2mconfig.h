@@ -61,6 +61,28 @@ using namespace m2m;
  */
 #undef MBED_CLIENT_EVENT_LOOP_SIZE      /* 1024 */
 
+/**
+ * \def MBED_CLIENT_TIMER_WHEEL_SIZE
+ *
+ * \brief Number of slots in the timing wheel of M2MTimer, must be a power
+ * of two. When non-zero, all M2MTimers share one event loop timer instead
+ * of requesting one each, and starting, stopping and restarting a timer
+ * costs no allocation and no walk of the event loop timer list. Timers are
+ * rounded up to MBED_CLIENT_TIMER_WHEEL_RESOLUTION, so they never fire
+ * early. Each slot costs one pointer of RAM.
+ * By default, this is 0 (each timer is an event loop timer).
+ */
+#undef MBED_CLIENT_TIMER_WHEEL_SIZE  /* 0 */
+
+/**
+ * \def MBED_CLIENT_TIMER_WHEEL_RESOLUTION
+ *
+ * \brief Width in milliseconds of a slot of the M2MTimer timing wheel, see
+ * MBED_CLIENT_TIMER_WHEEL_SIZE.
+ * By default, the value is 100 milliseconds.
+ */
+#undef MBED_CLIENT_TIMER_WHEEL_RESOLUTION  /* 100 */
+
 /**
  * \def MBED_CLIENT_SN_COAP_RESENDING_QUEUE_SIZE_MSGS
  *
@@ -81,6 +103,459 @@ using namespace m2m;
  */
 
 #undef MBED_CLIENT_MEMORY_OPTIMIZED_API
+
+/**
+ * \def MBED_CLIENT_GRS_HASH_INDEX_SIZE
+ *
+ * \brief Number of buckets in the resource path hash index of the
+ * general resource server. When non-zero, resource lookups done for
+ * every incoming CoAP request are hashed instead of scanning the whole
+ * resource list. Each bucket costs one pointer of RAM.
+ * By default, this is 0 (index disabled).
+ */
+#undef MBED_CLIENT_GRS_HASH_INDEX_SIZE  /* 0 */
+
+/**
+ * \def MBED_CLIENT_RESPONSE_INDEX_SIZE
+ *
+ * \brief Number of buckets in the hash indexes of the outstanding requests
+ * and responses, keyed by token, message id and uri path. When non-zero,
+ * matching a received response or a delayed response to its entry does not
+ * scan the whole list. Each bucket costs three pointers of RAM and each
+ * outstanding entry one or two pointers more.
+ * By default, this is 0 (indexes disabled).
+ */
+#undef MBED_CLIENT_RESPONSE_INDEX_SIZE  /* 0 */
+
+/**
+ * \def MBED_CLIENT_STREAMED_REGISTRATION
+ *
+ * \brief Set to 1 to build registration and registration update payloads
+ * one block at a time while the blocks are sent, instead of building the
+ * whole resource list before sending. Only takes effect when blockwise
+ * transfer is enabled. As the total payload size is not known beforehand,
+ * Size1 option is not sent with the streamed payload.
+ * By default, this is 0 (whole payload is built before sending).
+ */
+#undef MBED_CLIENT_STREAMED_REGISTRATION  /* 0 */
+
+/**
+ * \def MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+ *
+ * \brief Number of resources tracked in the change journal of the
+ * general resource server. When non-zero, registration update publishes
+ * the resources added or changed since the previous registration from the
+ * journal instead of walking the whole resource list, and an update with
+ * no changes costs no walk at all. If more resources change than fit in
+ * the journal, the next update walks the list as before. Each entry costs
+ * one pointer of RAM.
+ * By default, this is 0 (journal disabled).
+ */
+#undef MBED_CLIENT_REGISTRATION_JOURNAL_SIZE  /* 0 */
+
+/**
+ * \def MBED_CLIENT_CBOR_REGISTRATION
+ *
+ * \brief Enables CBOR link format (content format 64) for registration
+ * and registration update payloads. Attribute names are encoded as small
+ * integers and values without quoting, so the payload is a fraction of the
+ * size of CoRE link format and needs fewer blocks to send. If the server
+ * answers registration with 4.15 Unsupported Content-Format, the client
+ * falls back to CoRE link format for the following attempts.
+ * Registration is then not streamed block by block.
+ * By default, this is disabled.
+ */
+#undef MBED_CLIENT_CBOR_REGISTRATION  /* 0 */
+
+/**
+ * \def MBED_CLIENT_REGISTRATION_RESUME
+ *
+ * \brief Set to 1 to resume the registration after a reset with a
+ * registration update instead of a full registration. A fingerprint of the
+ * registration, covering the endpoint parameters and the published
+ * resources with their attributes, is stored with the registration location
+ * when the server accepts a full registration. After a reset, if the
+ * fingerprint still matches and a DTLS session with connection ID is
+ * stored, the first registration is sent as an update of the stored one,
+ * and the client falls back to full registration if the server rejects it.
+ * Observations made by the server before the reset are not restored, the
+ * server needs to observe the resources again.
+ * By default, this is 0 (full registration after every reset).
+ */
+#undef MBED_CLIENT_REGISTRATION_RESUME  /* 0 */
+
+/**
+ * \def MBED_CLIENT_COMPACT_LWM2M_PARAMETERS
+ *
+ * \brief Packs the per-object LwM2M parameters into two pointers and one
+ * flag word. Max age, which is rarely set, is moved out of the parameters
+ * to the callback storage. This saves 8 bytes per object, resource and
+ * resource instance on 32-bit targets. Hand written
+ * M2MBase::lwm2m_parameters_s initializers must follow the changed field
+ * order, M2M_STATIC_RESOURCE() does so.
+ * By default, this is disabled.
+ */
+#undef MBED_CLIENT_COMPACT_LWM2M_PARAMETERS  /* 0 */
+
+/**
+ * \def MBED_CLIENT_INLINE_RESOURCE_VALUE_SIZE
+ *
+ * \brief Size of a buffer in the dynamic resource parameters for storing
+ * short resource values, including the terminating zero. Values that fit
+ * are not allocated from heap. 24 bytes fits the text form of any integer
+ * or float value. The buffer is added to every resource and resource
+ * instance, so this trades RAM for less heap churn on frequently updated
+ * values. By default, this is 0 (values always allocated from heap).
+ */
+#undef MBED_CLIENT_INLINE_RESOURCE_VALUE_SIZE  /* 0 */
+
+/**
+ * \def MBED_CLIENT_COMPOSITE_OPERATIONS
+ *
+ * \brief Enables LwM2M 1.1 Read-Composite and Observe-Composite, i.e. FETCH
+ * requests carrying a SenML-CBOR list of paths. One composite observation
+ * holds a single token and report handler for all of its paths, and the
+ * values changed during one event loop round are sent in one notification.
+ * Requires MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR.
+ * By default, this is disabled.
+ */
+#undef MBED_CLIENT_COMPOSITE_OPERATIONS  /* 0 */
+
+/**
+ * \def MBED_CLIENT_LWM2M_SEND_SAMPLES
+ *
+ * \brief Capacity of the LwM2M 1.1 Send buffer, in samples. Value changes
+ * of the resources added with M2MInterface::add_send_path() are stored
+ * with a timestamp and sent to the server with the Send operation (POST
+ * /dp, SenML-CBOR), also while the client is offline or sleeping. When
+ * the buffer is full, the oldest sample is dropped. One sample takes
+ * 24 bytes. Requires MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR.
+ * By default, this is 0 (Send disabled).
+ */
+#undef MBED_CLIENT_LWM2M_SEND_SAMPLES  /* 0 */
+
+/**
+ * \def MBED_CLIENT_LWM2M_SEND_BATCH_SIZE
+ *
+ * \brief Maximum number of samples in one Send request. Payloads larger
+ * than the CoAP block size are sent blockwise.
+ * By default, the value is 16.
+ */
+#undef MBED_CLIENT_LWM2M_SEND_BATCH_SIZE  /* 16 */
+
+/**
+ * \def MBED_CLIENT_LWM2M_SEND_INTERVAL
+ *
+ * \brief Minimum time in seconds between two Send requests, so that
+ * a buffer filled while offline is drained gradually after reconnecting.
+ * By default, the value is 5.
+ */
+#undef MBED_CLIENT_LWM2M_SEND_INTERVAL  /* 5 */
+
+/**
+ * \def MBED_CLIENT_DISCOVER_CACHE
+ *
+ * \brief Set to 1 to keep the object level Discover payload of each object
+ * once it has been asked for, so that the Block2 requests of the following
+ * blocks are served from it instead of walking the object again. The payload
+ * is dropped when an object instance or a resource is created or removed, or
+ * the attributes of the object are written.
+ * Without the cache, the requested block is produced directly into the
+ * response and the complete payload is never held in memory.
+ * By default, the value is 0.
+ */
+#undef MBED_CLIENT_DISCOVER_CACHE  /* 0 */
+
+/**
+ * \def MBED_CLIENT_SEND_BUFFER_POOL_SIZE
+ *
+ * \brief Number of already sent outgoing datagram buffers the connection
+ * handler keeps for reuse instead of returning them to heap.
+ * Setting this to 0 allocates and frees a buffer for every sent packet.
+ * By default, the value is 2.
+ */
+#undef MBED_CLIENT_SEND_BUFFER_POOL_SIZE  /* 2 */
+
+/**
+ * \def MBED_CLIENT_SEND_BUFFER_GRANULARITY
+ *
+ * \brief Allocation size step (power of two) of the outgoing datagram
+ * buffers, so that a pooled buffer fits packets of slightly varying size.
+ * By default, the value is 64 bytes.
+ */
+#undef MBED_CLIENT_SEND_BUFFER_GRANULARITY  /* 64 */
+
+/**
+ * \def MBED_CLIENT_NSDL_EXECUTION_MAX_INTERVAL
+ *
+ * \brief Longest time in seconds the NSDL execution timer sleeps when
+ * CoAP has no retransmissions or timeouts due and no CoAP ping is pending.
+ * Setting this to 1 runs the timer every second.
+ * By default, the value is 60 seconds.
+ */
+#undef MBED_CLIENT_NSDL_EXECUTION_MAX_INTERVAL  /* 60 */
+
+/**
+ * \def MBED_CLIENT_DATAGRAM_BATCH_SIZE
+ *
+ * \brief Maximum number of datagrams the connection handler receives or
+ * sends with one PAL call in non-secure UDP mode. The receive buffers take
+ * this many times 1152 bytes of stack.
+ * By default, the value is 1.
+ */
+#undef MBED_CLIENT_DATAGRAM_BATCH_SIZE  /* 1 */
+
+/**
+ * \def MBED_CLIENT_ZERO_COPY_RECEIVE
+ *
+ * \brief Parse the data received over a secure connection directly from the
+ * decrypted record in the TLS library's input buffer, instead of copying it
+ * to a 1152 byte receive buffer on the stack first. The PAL TLS port must
+ * implement pal_sslReadInPlace().
+ * By default, this is 0 (disabled).
+ */
+#undef MBED_CLIENT_ZERO_COPY_RECEIVE  /* 0 */
+
+/**
+ * \def MBED_CLIENT_DTLS_COALESCING_SIZE
+ *
+ * \brief Maximum size in bytes of a datagram into which the connection
+ * handler packs the DTLS records of queued messages. Set it to the path MTU
+ * less the IP and UDP headers, for example 1232 for the IPv6 minimum MTU.
+ * Peers must accept several records in one datagram, as DTLS 1.2 allows.
+ * By default, the value is 0, which sends one record per datagram.
+ */
+#undef MBED_CLIENT_DTLS_COALESCING_SIZE  /* 0 */
+
+/**
+ * \def MBED_CLIENT_REPORT_TIMER_TOLERANCE
+ *
+ * \brief Coalescing tolerance in milliseconds of the observation pmin and
+ * pmax timers. When non-zero, report handlers do not run timers of their own
+ * but share one scheduler, which rounds the deadlines to multiples of this
+ * value and evaluates all reports due at the same time in one pass.
+ * pmin deadlines are rounded up and pmax deadlines down, so neither limit
+ * is violated.
+ * By default, the value is 0, which gives every report handler own timers.
+ */
+#undef MBED_CLIENT_REPORT_TIMER_TOLERANCE  /* 0 */
+
+/**
+ * \def MBED_CLIENT_WAKE_WINDOW
+ *
+ * \brief Window in seconds within which periodic traffic is combined into
+ * one wakeup of the radio. When non-zero, every message the client sends
+ * also sends the registration update and the pmax reports due within the
+ * window, instead of waking up again for each of them later.
+ * M2MInterface::next_wake_time() then tells the application when the client
+ * needs the network next, for planning deep sleep in queue mode.
+ * Requires MBED_CLIENT_REPORT_TIMER_TOLERANCE when observation parameters
+ * are enabled, as the pmax deadlines are taken from the shared scheduler.
+ * By default, the value is 0, which schedules every event separately.
+ */
+#undef MBED_CLIENT_WAKE_WINDOW  /* 0 */
+
+/**
+ * \def MBED_CLIENT_CONNECTION_ATTEMPT_DELAY
+ *
+ * \brief Happy Eyeballs (RFC 8305) connection attempt delay in milliseconds.
+ * When non-zero and the PAL DNS API returns address lists (version 3), the
+ * resolved addresses are tried with IPv6 and IPv4 interleaved. Over TCP the
+ * next address is tried in parallel if a connect has not completed within
+ * this delay, and the first connection to complete wins. Over UDP a failed
+ * handshake moves to the next address right away instead of reporting
+ * an error.
+ * By default, the value is 0, which tries the addresses one at a time.
+ */
+#undef MBED_CLIENT_CONNECTION_ATTEMPT_DELAY  /* 0 */
+
+/**
+ * \def MBED_CLIENT_DNS_CACHE_TTL
+ *
+ * \brief Time in seconds a DNS result is reused for reconnecting to the
+ * same server. Reconnecting starts from the address that worked last.
+ * Requires PAL DNS API version 3.
+ * The result is also kept while a DTLS session with connection ID is stored
+ * for the LwM2M server, as the session only works with the address it was
+ * made with.
+ * By default, the value is 0, which keeps the result until none of the
+ * addresses works.
+ */
+#undef MBED_CLIENT_DNS_CACHE_TTL  /* 0 */
+
+/**
+ * \def MBED_CLIENT_SERVER_BACKOFF_HINT
+ *
+ * \brief Set to 1 to follow the retry time a server gives in the Max-Age
+ * option of a 5.03 Service Unavailable response to registration or
+ * registration update. The time is kept over the reconnection attempts until
+ * the client is registered again, and each attempt waits a random time
+ * between it and three times the previous wait (decorrelated jitter), capped
+ * at MBED_CLIENT_MAX_RECONNECT_TIMEOUT unless the server asked for longer.
+ * A rejected registration update is then retried after the wait, instead of
+ * falling back to full registration at once.
+ * By default, this is 0 (5.03 is handled like any other failure).
+ */
+#undef MBED_CLIENT_SERVER_BACKOFF_HINT  /* 0 */
+
+/**
+ * \def MBED_CLIENT_LATENCY_HISTOGRAM
+ *
+ * \brief Set to 1 to record the latency of registration, registration
+ * update, notification and client request round trips in log2 histograms,
+ * readable with M2MInterface::get_latency_histogram(). Meant for performance
+ * regression tests and load testing of servers, each histogram costs
+ * M2M_LATENCY_HISTOGRAM_BUCKETS counters of RAM.
+ * By default, this is 0 (nothing is recorded).
+ */
+#undef MBED_CLIENT_LATENCY_HISTOGRAM  /* 0 */
+
+/**
+ * \def MBED_CLIENT_EXECUTE_THREADS
+ *
+ * \brief Number of worker threads running the execute callbacks of resources,
+ * so that a slow callback does not hold up CoAP processing, retransmissions
+ * and pings on the event loop. The callbacks of one resource run one at a
+ * time in the order of the POST requests. The 2.04 response is sent when the
+ * request is queued, a resource using delayed response can call
+ * send_delayed_post_response() from the callback, and the response is sent
+ * from the event loop when the callback returns. Other client APIs must not
+ * be called from a callback running on a worker thread. Deleting a resource
+ * waits for its running callback to return.
+ * By default, this is 0 (callbacks run on the event loop).
+ */
+#undef MBED_CLIENT_EXECUTE_THREADS  /* 0 */
+
+/**
+ * \def MBED_CLIENT_EXECUTE_THREAD_STACK_SIZE
+ *
+ * \brief Stack size in bytes of each worker thread, see MBED_CLIENT_EXECUTE_THREADS.
+ * By default, the value is 32768.
+ */
+#undef MBED_CLIENT_EXECUTE_THREAD_STACK_SIZE  /* 32768 */
+
+/**
+ * \def MBED_CLIENT_CID_FAST_RESUME
+ *
+ * \brief On a network interface change, move a secure UDP connection
+ * that has a DTLS connection ID to a new socket without a new handshake,
+ * and send a registration update over it right away. A full reconnect
+ * follows only if the server does not answer with the connection ID.
+ * By default, this is 0 (disabled).
+ */
+#undef MBED_CLIENT_CID_FAST_RESUME  /* 0 */
+
+/**
+ * \def MBED_CLIENT_NOTIFICATION_QUEUE
+ *
+ * \brief Keep the report handlers with a queued confirmable notification in
+ * a list, so that sending the next queued notification does not walk every
+ * object, object instance and resource. Takes two pointers per report handler.
+ * By default, this is 0 (disabled).
+ */
+#undef MBED_CLIENT_NOTIFICATION_QUEUE  /* 0 */
+
+/**
+ * \def MBED_CLIENT_OBSERVATION_DIFF
+ *
+ * \brief Send only the changed resources in object and object instance notifications.
+ * An object instance records which of its resources changed since the last notification,
+ * and a SenML-CBOR notification of an observed object or object instance carries only
+ * those resources. A full snapshot is sent every MBED_CLIENT_OBSERVATION_DIFF_FULL_INTERVAL
+ * notifications, after the resources of the instance are added or removed, and after
+ * M2MObjectInstance::request_full_notification(). TLV notifications are always full.
+ * Requires MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR.
+ */
+#undef MBED_CLIENT_OBSERVATION_DIFF  /* 0 */
+
+/**
+ * \def MBED_CLIENT_OBSERVATION_DIFF_FULL_INTERVAL
+ *
+ * \brief Number of partial notifications sent between full snapshots when
+ * MBED_CLIENT_OBSERVATION_DIFF is enabled. 0 sends a full snapshot only when one is needed
+ * or requested.
+ */
+#undef MBED_CLIENT_OBSERVATION_DIFF_FULL_INTERVAL  /* 10 */
+
+/**
+ * \def MBED_CLIENT_SHARED_RESOURCE_STRINGS
+ *
+ * \brief Share the name, resource type and interface description strings of resources.
+ * Resources created with the same strings, such as the resources of many instances of
+ * one object, point to a single reference counted copy instead of allocating their own.
+ * Paths stay per resource, as the CoAP resource directory owns and indexes them.
+ */
+#undef MBED_CLIENT_SHARED_RESOURCE_STRINGS  /* 0 */
+
+/**
+ * \def MBED_CLIENT_ADAPTIVE_CONFIRMABLE
+ *
+ * \brief Adaptive choice between confirmable and non-confirmable notifications.
+ * Enables M2MBase::set_confirmable_policy(). A resource with a policy sends non-confirmable
+ * notifications and a confirmable one at least every given number of notifications or
+ * seconds, as suggested by RFC 7641 section 4.5. A confirmable notification is also sent
+ * after a notification was lost and when the value crosses the gt or lt attribute.
+ * MBED_CLIENT_CON_NOTIFICATION_COUNT and MBED_CLIENT_CON_NOTIFICATION_INTERVAL set the
+ * policy of the resources that do not call set_confirmable() or set_confirmable_policy().
+ */
+#undef MBED_CLIENT_ADAPTIVE_CONFIRMABLE  /* 0 */
+
+/**
+ * \def MBED_CLIENT_CON_NOTIFICATION_COUNT
+ *
+ * \brief Default policy of MBED_CLIENT_ADAPTIVE_CONFIRMABLE, every how manyth notification
+ * is confirmable. 0 and MBED_CLIENT_CON_NOTIFICATION_INTERVAL 0 keep all notifications confirmable.
+ */
+#undef MBED_CLIENT_CON_NOTIFICATION_COUNT  /* 0 */
+
+/**
+ * \def MBED_CLIENT_CON_NOTIFICATION_INTERVAL
+ *
+ * \brief Default policy of MBED_CLIENT_ADAPTIVE_CONFIRMABLE, maximum seconds between
+ * confirmable notifications, 0 for no time limit.
+ */
+#undef MBED_CLIENT_CON_NOTIFICATION_INTERVAL  /* 0 */
+
+/**
+ * \def MBED_CLIENT_DEFERRED_BOOTSTRAP_WRITES
+ *
+ * \brief Keeps the certificates and keys written during bootstrap in RAM and stores
+ * them together when the bootstrap server sends Bootstrap-Finish. Each write otherwise goes
+ * to the storage as it arrives, which on slow external flash takes longer than the network
+ * exchange, and an interrupted bootstrap leaves a mix of old and new credentials.
+ */
+#undef MBED_CLIENT_DEFERRED_BOOTSTRAP_WRITES  /* 0 */
+
+/**
+ * \def MBED_CLIENT_SEND_PACING_RATE_UDP
+ *
+ * \brief Pacing rate in bytes per second for sending over UDP. Outgoing
+ * messages are queued in priority classes, empty messages and ACKs first,
+ * then registration, notifications and last blockwise transfers. When the
+ * rate is non-zero, all but the control messages are held back once the
+ * send budget is used up.
+ * By default, the value is 0, which sends without pacing.
+ */
+#undef MBED_CLIENT_SEND_PACING_RATE_UDP  /* 0 */
+
+/**
+ * \def MBED_CLIENT_SEND_PACING_RATE_TCP
+ *
+ * \brief Pacing rate in bytes per second for sending over TCP, see
+ * MBED_CLIENT_SEND_PACING_RATE_UDP.
+ * By default, the value is 0, which sends without pacing.
+ */
+#undef MBED_CLIENT_SEND_PACING_RATE_TCP  /* 0 */
+
+/**
+ * \def MBED_CLIENT_SEND_PACING_BURST
+ *
+ * \brief Size in bytes of the pacing token bucket, which is the amount
+ * of data that can be sent back to back after an idle period.
+ * By default, the value is 1024.
+ */
+#undef MBED_CLIENT_SEND_PACING_BURST  /* 1024 */
+
 #if defined (__ICCARM__)
 #define m2m_deprecated
 #else
@@ -168,6 +643,170 @@ typedef struct mbedtls_entropy {
 #define MBED_CLIENT_SN_COAP_RESENDING_QUEUE_SIZE_MSGS MBED_CONF_MBED_CLIENT_SN_COAP_RESENDING_QUEUE_SIZE_MSGS
 #endif
 
+#ifdef MBED_CONF_MBED_CLIENT_GRS_HASH_INDEX_SIZE
+#define MBED_CLIENT_GRS_HASH_INDEX_SIZE MBED_CONF_MBED_CLIENT_GRS_HASH_INDEX_SIZE
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_RESPONSE_INDEX_SIZE
+#define MBED_CLIENT_RESPONSE_INDEX_SIZE MBED_CONF_MBED_CLIENT_RESPONSE_INDEX_SIZE
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_STREAMED_REGISTRATION
+#define MBED_CLIENT_STREAMED_REGISTRATION MBED_CONF_MBED_CLIENT_STREAMED_REGISTRATION
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+#define MBED_CLIENT_REGISTRATION_JOURNAL_SIZE MBED_CONF_MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_CBOR_REGISTRATION
+#define MBED_CLIENT_CBOR_REGISTRATION MBED_CONF_MBED_CLIENT_CBOR_REGISTRATION
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_REGISTRATION_RESUME
+#define MBED_CLIENT_REGISTRATION_RESUME MBED_CONF_MBED_CLIENT_REGISTRATION_RESUME
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_COMPACT_LWM2M_PARAMETERS
+#define MBED_CLIENT_COMPACT_LWM2M_PARAMETERS MBED_CONF_MBED_CLIENT_COMPACT_LWM2M_PARAMETERS
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_INLINE_RESOURCE_VALUE_SIZE
+#define MBED_CLIENT_INLINE_RESOURCE_VALUE_SIZE MBED_CONF_MBED_CLIENT_INLINE_RESOURCE_VALUE_SIZE
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_COMPOSITE_OPERATIONS
+#define MBED_CLIENT_COMPOSITE_OPERATIONS MBED_CONF_MBED_CLIENT_COMPOSITE_OPERATIONS
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_LWM2M_SEND_SAMPLES
+#define MBED_CLIENT_LWM2M_SEND_SAMPLES MBED_CONF_MBED_CLIENT_LWM2M_SEND_SAMPLES
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_LWM2M_SEND_BATCH_SIZE
+#define MBED_CLIENT_LWM2M_SEND_BATCH_SIZE MBED_CONF_MBED_CLIENT_LWM2M_SEND_BATCH_SIZE
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_LWM2M_SEND_INTERVAL
+#define MBED_CLIENT_LWM2M_SEND_INTERVAL MBED_CONF_MBED_CLIENT_LWM2M_SEND_INTERVAL
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_DISCOVER_CACHE
+#define MBED_CLIENT_DISCOVER_CACHE MBED_CONF_MBED_CLIENT_DISCOVER_CACHE
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_SEND_BUFFER_POOL_SIZE
+#define MBED_CLIENT_SEND_BUFFER_POOL_SIZE MBED_CONF_MBED_CLIENT_SEND_BUFFER_POOL_SIZE
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_SEND_BUFFER_GRANULARITY
+#define MBED_CLIENT_SEND_BUFFER_GRANULARITY MBED_CONF_MBED_CLIENT_SEND_BUFFER_GRANULARITY
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_NSDL_EXECUTION_MAX_INTERVAL
+#define MBED_CLIENT_NSDL_EXECUTION_MAX_INTERVAL MBED_CONF_MBED_CLIENT_NSDL_EXECUTION_MAX_INTERVAL
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_DATAGRAM_BATCH_SIZE
+#define MBED_CLIENT_DATAGRAM_BATCH_SIZE MBED_CONF_MBED_CLIENT_DATAGRAM_BATCH_SIZE
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_ZERO_COPY_RECEIVE
+#define MBED_CLIENT_ZERO_COPY_RECEIVE MBED_CONF_MBED_CLIENT_ZERO_COPY_RECEIVE
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_DTLS_COALESCING_SIZE
+#define MBED_CLIENT_DTLS_COALESCING_SIZE MBED_CONF_MBED_CLIENT_DTLS_COALESCING_SIZE
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_REPORT_TIMER_TOLERANCE
+#define MBED_CLIENT_REPORT_TIMER_TOLERANCE MBED_CONF_MBED_CLIENT_REPORT_TIMER_TOLERANCE
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_WAKE_WINDOW
+#define MBED_CLIENT_WAKE_WINDOW MBED_CONF_MBED_CLIENT_WAKE_WINDOW
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_CONNECTION_ATTEMPT_DELAY
+#define MBED_CLIENT_CONNECTION_ATTEMPT_DELAY MBED_CONF_MBED_CLIENT_CONNECTION_ATTEMPT_DELAY
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_TIMER_WHEEL_SIZE
+#define MBED_CLIENT_TIMER_WHEEL_SIZE MBED_CONF_MBED_CLIENT_TIMER_WHEEL_SIZE
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_TIMER_WHEEL_RESOLUTION
+#define MBED_CLIENT_TIMER_WHEEL_RESOLUTION MBED_CONF_MBED_CLIENT_TIMER_WHEEL_RESOLUTION
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_DNS_CACHE_TTL
+#define MBED_CLIENT_DNS_CACHE_TTL MBED_CONF_MBED_CLIENT_DNS_CACHE_TTL
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_SERVER_BACKOFF_HINT
+#define MBED_CLIENT_SERVER_BACKOFF_HINT MBED_CONF_MBED_CLIENT_SERVER_BACKOFF_HINT
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_LATENCY_HISTOGRAM
+#define MBED_CLIENT_LATENCY_HISTOGRAM MBED_CONF_MBED_CLIENT_LATENCY_HISTOGRAM
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_EXECUTE_THREADS
+#define MBED_CLIENT_EXECUTE_THREADS MBED_CONF_MBED_CLIENT_EXECUTE_THREADS
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_EXECUTE_THREAD_STACK_SIZE
+#define MBED_CLIENT_EXECUTE_THREAD_STACK_SIZE MBED_CONF_MBED_CLIENT_EXECUTE_THREAD_STACK_SIZE
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_CID_FAST_RESUME
+#define MBED_CLIENT_CID_FAST_RESUME MBED_CONF_MBED_CLIENT_CID_FAST_RESUME
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_NOTIFICATION_QUEUE
+#define MBED_CLIENT_NOTIFICATION_QUEUE MBED_CONF_MBED_CLIENT_NOTIFICATION_QUEUE
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_OBSERVATION_DIFF
+#define MBED_CLIENT_OBSERVATION_DIFF MBED_CONF_MBED_CLIENT_OBSERVATION_DIFF
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_OBSERVATION_DIFF_FULL_INTERVAL
+#define MBED_CLIENT_OBSERVATION_DIFF_FULL_INTERVAL MBED_CONF_MBED_CLIENT_OBSERVATION_DIFF_FULL_INTERVAL
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_SHARED_RESOURCE_STRINGS
+#define MBED_CLIENT_SHARED_RESOURCE_STRINGS MBED_CONF_MBED_CLIENT_SHARED_RESOURCE_STRINGS
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_ADAPTIVE_CONFIRMABLE
+#define MBED_CLIENT_ADAPTIVE_CONFIRMABLE MBED_CONF_MBED_CLIENT_ADAPTIVE_CONFIRMABLE
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_CON_NOTIFICATION_COUNT
+#define MBED_CLIENT_CON_NOTIFICATION_COUNT MBED_CONF_MBED_CLIENT_CON_NOTIFICATION_COUNT
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_CON_NOTIFICATION_INTERVAL
+#define MBED_CLIENT_CON_NOTIFICATION_INTERVAL MBED_CONF_MBED_CLIENT_CON_NOTIFICATION_INTERVAL
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_DEFERRED_BOOTSTRAP_WRITES
+#define MBED_CLIENT_DEFERRED_BOOTSTRAP_WRITES MBED_CONF_MBED_CLIENT_DEFERRED_BOOTSTRAP_WRITES
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_SEND_PACING_RATE_UDP
+#define MBED_CLIENT_SEND_PACING_RATE_UDP MBED_CONF_MBED_CLIENT_SEND_PACING_RATE_UDP
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_SEND_PACING_RATE_TCP
+#define MBED_CLIENT_SEND_PACING_RATE_TCP MBED_CONF_MBED_CLIENT_SEND_PACING_RATE_TCP
+#endif
+
+#ifdef MBED_CONF_MBED_CLIENT_SEND_PACING_BURST
+#define MBED_CLIENT_SEND_PACING_BURST MBED_CONF_MBED_CLIENT_SEND_PACING_BURST
+#endif
+
 #ifdef MBED_CLIENT_MEMORY_OPTIMIZED_API
 #define MEMORY_OPTIMIZED_API MBED_CLIENT_MEMORY_OPTIMIZED_API
 #elif defined MBED_CONF_MBED_CLIENT_MEMORY_OPTIMIZED_API
@@ -188,6 +827,10 @@ typedef struct mbedtls_entropy {
 #define MBED_CONF_MBED_CLIENT_ENABLE_DISCOVERY 1
 #endif
 
+#ifndef MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR
+#define MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR 0
+#endif
+
 #ifdef MBED_CONF_MBED_CLIENT_BOOTSTRAP_PIGGYBACKED_RESPONSE
 #define MBED_CLIENT_BOOTSTRAP_PIGGYBACKED_RESPONSE MBED_CONF_MBED_CLIENT_BOOTSTRAP_PIGGYBACKED_RESPONSE
 #endif
@@ -222,4 +865,192 @@ typedef struct mbedtls_entropy {
 #define MBED_CLIENT_SN_COAP_RESENDING_QUEUE_SIZE_MSGS 5
 #endif
 
+#ifndef MBED_CLIENT_GRS_HASH_INDEX_SIZE
+#define MBED_CLIENT_GRS_HASH_INDEX_SIZE 0
+#endif
+
+#ifndef MBED_CLIENT_RESPONSE_INDEX_SIZE
+#define MBED_CLIENT_RESPONSE_INDEX_SIZE 0
+#endif
+
+#ifndef MBED_CLIENT_STREAMED_REGISTRATION
+#define MBED_CLIENT_STREAMED_REGISTRATION 0
+#endif
+
+#ifndef MBED_CLIENT_REGISTRATION_JOURNAL_SIZE
+#define MBED_CLIENT_REGISTRATION_JOURNAL_SIZE 0
+#endif
+
+#ifndef MBED_CLIENT_CBOR_REGISTRATION
+#define MBED_CLIENT_CBOR_REGISTRATION 0
+#endif
+
+#ifndef MBED_CLIENT_REGISTRATION_RESUME
+#define MBED_CLIENT_REGISTRATION_RESUME 0
+#endif
+
+#ifndef MBED_CLIENT_COMPACT_LWM2M_PARAMETERS
+#define MBED_CLIENT_COMPACT_LWM2M_PARAMETERS 0
+#endif
+
+#ifndef MBED_CLIENT_INLINE_RESOURCE_VALUE_SIZE
+#define MBED_CLIENT_INLINE_RESOURCE_VALUE_SIZE 0
+#endif
+
+#ifndef MBED_CLIENT_COMPOSITE_OPERATIONS
+#define MBED_CLIENT_COMPOSITE_OPERATIONS 0
+#endif
+
+#if MBED_CLIENT_COMPOSITE_OPERATIONS && (MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR != 1)
+#error "MBED_CLIENT_COMPOSITE_OPERATIONS requires MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR"
+#endif
+
+#ifndef MBED_CLIENT_LWM2M_SEND_SAMPLES
+#define MBED_CLIENT_LWM2M_SEND_SAMPLES 0
+#endif
+
+#ifndef MBED_CLIENT_LWM2M_SEND_BATCH_SIZE
+#define MBED_CLIENT_LWM2M_SEND_BATCH_SIZE 16
+#endif
+
+#ifndef MBED_CLIENT_LWM2M_SEND_INTERVAL
+#define MBED_CLIENT_LWM2M_SEND_INTERVAL 5
+#endif
+
+#ifndef MBED_CLIENT_DISCOVER_CACHE
+#define MBED_CLIENT_DISCOVER_CACHE 0
+#endif
+
+#if MBED_CLIENT_DISCOVER_CACHE && (MBED_CONF_MBED_CLIENT_ENABLE_DISCOVERY != 1)
+#error "MBED_CLIENT_DISCOVER_CACHE requires MBED_CONF_MBED_CLIENT_ENABLE_DISCOVERY"
+#endif
+
+#if MBED_CLIENT_LWM2M_SEND_SAMPLES && (MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR != 1)
+#error "MBED_CLIENT_LWM2M_SEND_SAMPLES requires MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR"
+#endif
+
+#ifndef MBED_CLIENT_SEND_BUFFER_POOL_SIZE
+#define MBED_CLIENT_SEND_BUFFER_POOL_SIZE 2
+#endif
+
+#ifndef MBED_CLIENT_SEND_BUFFER_GRANULARITY
+#define MBED_CLIENT_SEND_BUFFER_GRANULARITY 64
+#endif
+
+#ifndef MBED_CLIENT_NSDL_EXECUTION_MAX_INTERVAL
+#define MBED_CLIENT_NSDL_EXECUTION_MAX_INTERVAL 60
+#endif
+
+#ifndef MBED_CLIENT_DATAGRAM_BATCH_SIZE
+#define MBED_CLIENT_DATAGRAM_BATCH_SIZE 1
+#endif
+
+#ifndef MBED_CLIENT_ZERO_COPY_RECEIVE
+#define MBED_CLIENT_ZERO_COPY_RECEIVE 0
+#endif
+
+#ifndef MBED_CLIENT_DTLS_COALESCING_SIZE
+#define MBED_CLIENT_DTLS_COALESCING_SIZE 0
+#endif
+
+#ifndef MBED_CLIENT_REPORT_TIMER_TOLERANCE
+#define MBED_CLIENT_REPORT_TIMER_TOLERANCE 0
+#endif
+
+#ifndef MBED_CLIENT_WAKE_WINDOW
+#define MBED_CLIENT_WAKE_WINDOW 0
+#endif
+
+#if MBED_CLIENT_WAKE_WINDOW && defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1) && (MBED_CLIENT_REPORT_TIMER_TOLERANCE == 0)
+#error "MBED_CLIENT_WAKE_WINDOW requires MBED_CLIENT_REPORT_TIMER_TOLERANCE"
+#endif
+
+#ifndef MBED_CLIENT_CONNECTION_ATTEMPT_DELAY
+#define MBED_CLIENT_CONNECTION_ATTEMPT_DELAY 0
+#endif
+
+#ifndef MBED_CLIENT_DNS_CACHE_TTL
+#define MBED_CLIENT_DNS_CACHE_TTL 0
+#endif
+
+#ifndef MBED_CLIENT_TIMER_WHEEL_SIZE
+#define MBED_CLIENT_TIMER_WHEEL_SIZE 0
+#endif
+
+#ifndef MBED_CLIENT_TIMER_WHEEL_RESOLUTION
+#define MBED_CLIENT_TIMER_WHEEL_RESOLUTION 100
+#endif
+
+#if MBED_CLIENT_TIMER_WHEEL_SIZE & (MBED_CLIENT_TIMER_WHEEL_SIZE - 1)
+#error "MBED_CLIENT_TIMER_WHEEL_SIZE must be a power of two"
+#endif
+
+#ifndef MBED_CLIENT_SERVER_BACKOFF_HINT
+#define MBED_CLIENT_SERVER_BACKOFF_HINT 0
+#endif
+
+#ifndef MBED_CLIENT_LATENCY_HISTOGRAM
+#define MBED_CLIENT_LATENCY_HISTOGRAM 0
+#endif
+
+#ifndef MBED_CLIENT_EXECUTE_THREADS
+#define MBED_CLIENT_EXECUTE_THREADS 0
+#endif
+
+#ifndef MBED_CLIENT_EXECUTE_THREAD_STACK_SIZE
+#define MBED_CLIENT_EXECUTE_THREAD_STACK_SIZE 32768
+#endif
+
+#ifndef MBED_CLIENT_CID_FAST_RESUME
+#define MBED_CLIENT_CID_FAST_RESUME 0
+#endif
+
+#ifndef MBED_CLIENT_NOTIFICATION_QUEUE
+#define MBED_CLIENT_NOTIFICATION_QUEUE 0
+#endif
+
+#ifndef MBED_CLIENT_OBSERVATION_DIFF
+#define MBED_CLIENT_OBSERVATION_DIFF 0
+#endif
+
+#ifndef MBED_CLIENT_OBSERVATION_DIFF_FULL_INTERVAL
+#define MBED_CLIENT_OBSERVATION_DIFF_FULL_INTERVAL 10
+#endif
+
+#ifndef MBED_CLIENT_SHARED_RESOURCE_STRINGS
+#define MBED_CLIENT_SHARED_RESOURCE_STRINGS 0
+#endif
+
+#ifndef MBED_CLIENT_ADAPTIVE_CONFIRMABLE
+#define MBED_CLIENT_ADAPTIVE_CONFIRMABLE 0
+#endif
+
+#ifndef MBED_CLIENT_CON_NOTIFICATION_COUNT
+#define MBED_CLIENT_CON_NOTIFICATION_COUNT 0
+#endif
+
+#ifndef MBED_CLIENT_CON_NOTIFICATION_INTERVAL
+#define MBED_CLIENT_CON_NOTIFICATION_INTERVAL 0
+#endif
+
+#ifndef MBED_CLIENT_DEFERRED_BOOTSTRAP_WRITES
+#define MBED_CLIENT_DEFERRED_BOOTSTRAP_WRITES 0
+#endif
+
+#if MBED_CLIENT_OBSERVATION_DIFF && (MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR != 1)
+#error "MBED_CLIENT_OBSERVATION_DIFF requires MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR"
+#endif
+
+#ifndef MBED_CLIENT_SEND_PACING_RATE_UDP
+#define MBED_CLIENT_SEND_PACING_RATE_UDP 0
+#endif
+
+#ifndef MBED_CLIENT_SEND_PACING_RATE_TCP
+#define MBED_CLIENT_SEND_PACING_RATE_TCP 0
+#endif
+
+#ifndef MBED_CLIENT_SEND_PACING_BURST
+#define MBED_CLIENT_SEND_PACING_BURST 1024
+#endif
+
 #endif // M2MCONFIG_H
@@ -37,7 +37,8 @@ public :
 
     typedef enum {
         NetworkInterfaceConnected,
-        NetworkInterfaceDisconnected
+        NetworkInterfaceDisconnected,
+        NetworkInterfaceRebound // Connected again, the secure connection was moved to a new socket
     }NetworkInterfaceStatus;
 
     /**
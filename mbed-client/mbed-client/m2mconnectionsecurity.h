@@ -97,6 +97,20 @@ public:
      */
     int send_message(unsigned char *message, int len);
 
+    /**
+     * \brief Packs the DTLS records of the following send_message() calls into
+     * shared datagrams, until end_coalescing() is called.
+     * \param datagram_size The maximum size of a datagram.
+     * \return True if the records are packed, false if they are sent one per datagram.
+     */
+    bool begin_coalescing(uint16_t datagram_size);
+
+    /**
+     * \brief Sends the records packed since begin_coalescing().
+     * \return 0 on success, or an M2MConnectionHandler error code.
+     */
+    int end_coalescing();
+
     /**
      * \brief Reads the data received from the server.
      * \param message The data to be read.
@@ -105,6 +119,19 @@ public:
      */
     int read(unsigned char* buffer, uint16_t len);
 
+    /**
+     * \brief Reads the data of the next record received from the server
+     * without copying it out of the TLS library.
+     * \param data Set to point to the data, valid until read_in_place_done() is called.
+     * \return The length of the data, or an M2MConnectionHandler error code.
+     */
+    int read_in_place(const uint8_t **data);
+
+    /**
+     * \brief Releases the data returned by read_in_place().
+     */
+    void read_in_place_done();
+
     /**
      * \brief Sets the function callback that is called by mbed Client to
      * fetch a random number from an application to ensure strong entropy.
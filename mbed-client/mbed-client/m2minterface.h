@@ -73,6 +73,53 @@ typedef request_data_cb get_data_cb; // For backward compatibility
 typedef void (*request_error_cb)(request_error_t error_code, void *context);
 typedef request_error_cb get_data_error_cb; // For backward compatibility
 
+#if MBED_CLIENT_LWM2M_SEND_SAMPLES
+/*!
+ * @brief A callback function to read the stored Send buffer.
+ * @param buffer Buffer to read into.
+ * @param buffer_size Size of the buffer.
+ * @param context Application context
+ * @return Number of bytes read, 0 if nothing is stored.
+*/
+typedef size_t (*send_storage_load_cb)(uint8_t *buffer, size_t buffer_size, void *context);
+
+/*!
+ * @brief A callback function to store the Send buffer, for example to KVStore.
+ * @param buffer Data to store, replacing the earlier data.
+ * @param buffer_size Size of the data, 0 to remove the stored data.
+ * @param context Application context
+ * @return true if stored.
+*/
+typedef bool (*send_storage_save_cb)(const uint8_t *buffer, size_t buffer_size, void *context);
+#endif
+
+#if MBED_CLIENT_LATENCY_HISTOGRAM
+/*!
+ * \brief Number of buckets in a latency histogram.
+ */
+#define M2M_LATENCY_HISTOGRAM_BUCKETS 20
+#endif
+
+#if MBED_CLIENT_REGISTRATION_RESUME
+/*!
+ * @brief A callback function to read the stored registration.
+ * @param buffer Buffer to read into.
+ * @param buffer_size Size of the buffer.
+ * @param context Application context
+ * @return Number of bytes read, 0 if nothing is stored.
+*/
+typedef size_t (*registration_storage_load_cb)(uint8_t *buffer, size_t buffer_size, void *context);
+
+/*!
+ * @brief A callback function to store the registration, for example to KVStore.
+ * @param buffer Data to store, replacing the earlier data.
+ * @param buffer_size Size of the data, 0 to remove the stored data.
+ * @param context Application context
+ * @return true if stored.
+*/
+typedef bool (*registration_storage_save_cb)(const uint8_t *buffer, size_t buffer_size, void *context);
+#endif
+
 
 /** This class handles LwM2M Client logic related to communicating with
  * all four interfaces defined in LwM2M.
@@ -145,6 +192,20 @@ public:
         Unknown
     } NetworkStack;
 
+#if MBED_CLIENT_LATENCY_HISTOGRAM
+    /**
+     * \brief An enum defining the operations whose latency is recorded,
+     * from sending the request to receiving the response, retransmissions included.
+     */
+    typedef enum {
+        LatencyRegister = 0,
+        LatencyRegisterUpdate,
+        LatencyNotification,
+        LatencyRequest,
+        LatencyOperationCount
+    } LatencyOperation;
+#endif
+
 public:
 
     virtual ~M2MInterface() {}
@@ -408,6 +469,74 @@ public:
      * \param data_len length of the CID
      */
     virtual void set_cid_value(const uint8_t *data_ptr, const size_t data_len) = 0;
+
+#if MBED_CLIENT_LWM2M_SEND_SAMPLES
+    /**
+     * \brief Starts recording the value changes of a resource or resource instance,
+     * or of all resources under an object or object instance, for the LwM2M Send
+     * operation. Each change is stored with a timestamp and sent to the server in
+     * the next Send request, so samples taken while offline or sleeping are not lost.
+     * Only integer, float, boolean and time values are recorded.
+     * \param base Path to record.
+     * \return false if the path was already added or memory allocation failed.
+     */
+    virtual bool add_send_path(M2MBase *base) = 0;
+
+    /**
+     * \brief Stops recording the value changes of a path added with add_send_path().
+     * Samples already recorded are still sent.
+     * \param base Path to remove.
+     */
+    virtual void remove_send_path(M2MBase *base) = 0;
+
+    /**
+     * \brief Sets the storage of the Send buffer, so that samples not yet sent survive
+     * a reset. Samples stored earlier are loaded immediately. The buffer is saved when
+     * a sample is recorded while the client is not registered and when the server
+     * has accepted a Send request.
+     * \param load_cb Reads the stored buffer.
+     * \param save_cb Stores the buffer.
+     * \param context Passed to the callbacks.
+     */
+    virtual void set_send_storage(send_storage_load_cb load_cb, send_storage_save_cb save_cb, void *context) = 0;
+#endif
+
+#if MBED_CLIENT_REGISTRATION_RESUME
+    /**
+     * \brief Sets the storage of the registration, so that it can be resumed after a reset.
+     * The fingerprint and location of the registration are saved when the server has
+     * accepted a full registration, and removed when the client unregisters. The record
+     * stored earlier is loaded immediately and used for the first registration only.
+     * \param load_cb Reads the stored registration.
+     * \param save_cb Stores the registration.
+     * \param context Passed to the callbacks.
+     */
+    virtual void set_registration_storage(registration_storage_load_cb load_cb, registration_storage_save_cb save_cb, void *context) = 0;
+#endif
+
+#if MBED_CLIENT_WAKE_WINDOW
+    /**
+     * \brief Returns the time until the client needs the network next, for a
+     * registration update, a pmax report, a CoAP ping or a Send request. An
+     * application in queue mode can use this to plan deep sleep after the
+     * client has gone to sleep.
+     * \return Time in milliseconds, UINT64_MAX if nothing is scheduled.
+     */
+    virtual uint64_t next_wake_time() = 0;
+#endif
+
+#if MBED_CLIENT_LATENCY_HISTOGRAM
+    /**
+     * \brief Copies the latency histogram of an operation. Bucket 0 counts the
+     * latencies below 1 millisecond and bucket n the ones from 2^(n-1) up to
+     * 2^n milliseconds, the last bucket counting also all the longer ones.
+     * Latencies are measured in event loop timer ticks.
+     * \param operation The operation.
+     * \param buckets Array of M2M_LATENCY_HISTOGRAM_BUCKETS counters to fill.
+     * \param reset Set to true to clear the histogram once read.
+     */
+    virtual void get_latency_histogram(LatencyOperation operation, uint32_t *buckets, bool reset) = 0;
+#endif
 };
 
 #endif // M2M_INTERFACE_H
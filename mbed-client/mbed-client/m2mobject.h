@@ -38,6 +38,7 @@ class M2MObject : public M2MBase
 friend class M2MInterfaceFactory;
 friend class M2MEndpoint;
 friend class TestFactory;
+friend class M2MDiscover;
 
 protected :
 
@@ -116,6 +117,25 @@ public:
      */
     uint16_t instance_count() const;
 
+    /**
+     * \brief Starts updating resource values of several object instances as one change.
+     * Until the matching commit_update(), value changes are not evaluated for notifications.
+     * \note Calls can be nested, the update ends with the outermost commit_update().
+     */
+    void begin_update();
+
+    /**
+     * \brief Ends an update started with begin_update(). An observed object is
+     * notified once of all the changed object instances.
+     */
+    void commit_update();
+
+    /**
+     * \brief Returns true if the object is being updated.
+     * \deprecated Internal API, subject to be modified or removed.
+     */
+    bool update_in_progress() const;
+
     /**
      * \brief Returns the Observation Handler object.
      * \return M2MObservationHandler object.
@@ -205,12 +225,30 @@ protected :
      */
     virtual M2MBase *get_parent() const;
 
+#if MBED_CLIENT_DISCOVER_CACHE
+    /**
+     * \brief Drops the cached Discover payload, as the structure of the object has changed.
+     */
+    virtual void set_changed();
+#endif
+
 private:
 
+#if MBED_CLIENT_DISCOVER_CACHE
+    void clear_discover_cache();
+#endif
+
     M2MObjectInstanceList     _instance_list; // owned
 
     M2MObservationHandler    *_observation_handler; // Not owned
 
+    uint8_t                  _update_depth;
+
+#if MBED_CLIENT_DISCOVER_CACHE
+    uint8_t                  *_discover_cache; // owned, object level Discover payload
+    uint32_t                 _discover_cache_length;
+#endif
+
 #ifdef MBED_CLOUD_CLIENT_EDGE_EXTENSION
     M2MEndpoint              *_endpoint; // Parent endpoint
 #endif
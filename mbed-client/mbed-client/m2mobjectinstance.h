@@ -263,6 +263,53 @@ public:
      */
     uint16_t resource_count(const char *resource) const;
 
+    /**
+     * \brief Starts updating several resource values as one change. Until the
+     * matching commit_update(), value changes are not evaluated for notifications.
+     * \note Calls can be nested, the update ends with the outermost commit_update().
+     */
+    void begin_update();
+
+    /**
+     * \brief Ends an update started with begin_update(). Each changed resource is
+     * evaluated once and an observed object instance is notified once of all the changes.
+     */
+    void commit_update();
+
+    /**
+     * \brief Returns true if this object instance or its object is being updated.
+     * \deprecated Internal API, subject to be modified or removed.
+     */
+    bool update_in_progress() const;
+
+    /**
+     * \brief Marks that a resource value changed during the update.
+     * \deprecated Internal API, subject to be modified or removed.
+     */
+    void defer_report();
+
+#if MBED_CLIENT_OBSERVATION_DIFF
+    /**
+     * \brief Makes the next notification of this object instance, or of its object,
+     * carry all the resources instead of only the changed ones.
+     */
+    void request_full_notification();
+
+    /**
+     * \brief Records that the value of a resource changed since the last notification.
+     * \deprecated Internal API, subject to be modified or removed.
+     */
+    void set_resource_changed(const M2MResource &resource);
+
+    /**
+     * \brief Takes the resources changed since the last notification.
+     * \param list Filled with the changed resources.
+     * \return false if a full snapshot is to be sent instead, the list is left empty.
+     * \deprecated Internal API, subject to be modified or removed.
+     */
+    bool take_changed_resources(M2MResourceList &list);
+#endif
+
     /**
      * \brief Adds the observation level for the object.
      * \param observation_level The level of observation.
@@ -344,6 +391,13 @@ public:
 protected:
     virtual M2MBase *get_parent() const;
 
+#if MBED_CLIENT_OBSERVATION_DIFF
+    /**
+     * \brief Requests a full notification, as the resources of the instance have changed.
+     */
+    virtual void set_changed();
+#endif
+
 private:
 
     /**
@@ -354,12 +408,35 @@ private:
      */
     M2MBase::DataType convert_resource_type(M2MResourceInstance::ResourceType);
 
+    /**
+     * \brief Reports the values changed during the update.
+     * \param report_object false if the object is notified by the caller.
+     * \return true if any value changed.
+     */
+    bool report_deferred_changes(bool report_object);
+
+    void report_deferred_change(M2MResourceBase &resource);
+
 private:
 
     M2MObject      &_parent;
 
     M2MResourceList     _resource_list; // owned
 
+    uint8_t             _update_depth;
+
+    bool                _update_changed;
+
+#if MBED_CLIENT_OBSERVATION_DIFF
+    // Bit per position in _resource_list, set when the value changed since the last notification
+    uint64_t            _changed_resources;
+
+    // Partial notifications sent since the last full one
+    uint8_t             _partial_notifications;
+
+    bool                _full_notification;
+#endif
+
     friend class Test_M2MObjectInstance;
     friend class Test_M2MObject;
     friend class Test_M2MDevice;
@@ -66,6 +66,17 @@ class M2MObservationHandler
      */
     virtual void remove_object(M2MBase *object) = 0;
 
+#if MBED_CLIENT_COMPOSITE_OPERATIONS || MBED_CLIENT_LWM2M_SEND_SAMPLES
+    /**
+     * \brief A callback indicating that the value of a resource or resource
+     * instance has changed, whether or not it is observed on its own.
+     * Used for composite observations and the Send operation, the default
+     * implementation does nothing.
+     * \param base The changed resource or resource instance.
+     */
+    virtual void value_changed(M2MBase * /*base*/) {}
+#endif
+
 #ifndef DISABLE_DELAYED_RESPONSE
     /**
      * \brief Sends a delayed post response to the server with 'COAP_MSG_CODE_RESPONSE_CHANGED' response code.
@@ -307,6 +307,16 @@ public:
 
     virtual M2MResource& get_parent_resource() const;
 
+    /** \internal
+     * \brief Executes the resource as for a POST request, for requests
+     * received outside of the server connection, such as mesh group requests.
+     * \param value The argument of the request, may be NULL.
+     * \param value_length The length of the argument.
+     *
+     * \deprecated Internal API, subject to be modified or removed.
+     */
+    void execute_with_argument(const uint8_t *value, uint16_t value_length);
+
 #ifdef MBED_CLOUD_CLIENT_EDGE_EXTENSION
     /**
      * \brief save the status of the manifest verification.
@@ -325,16 +335,17 @@ private:
 
     M2MResourceInstanceList     _resource_instance_list; // owned
 
-#ifdef MBED_CLOUD_CLIENT_EDGE_EXTENSION
-    bool                        _status;
-#endif
-
 #ifndef DISABLE_DELAYED_RESPONSE
     uint8_t                     *_delayed_token;
     uint8_t                     _delayed_token_len;
     bool                        _delayed_response;
 #endif
 
+    // After the small members above, to share their padding
+#ifdef MBED_CLOUD_CLIENT_EDGE_EXTENSION
+    bool                        _status;
+#endif
+
 friend class Test_M2MResource;
 friend class Test_M2MObjectInstance;
 friend class Test_M2MObject;
@@ -447,6 +458,7 @@ private:
 
 friend class Test_M2MResource;
 friend class M2MResource;
+friend class M2MExecutePool;
 };
 
 #endif // M2M_RESOURCE_H
@@ -22,6 +22,10 @@
 // (space needed for -3.402823 × 10^38) + (magic decimal 6 digits added as no precision is added to "%f") + trailing zero
 #define REGISTRY_FLOAT_STRING_MAX_LEN 48
 
+// -9223372036854775808 - +9223372036854775807
+// max length of int64_t string is 20 bytes + nil
+#define REGISTRY_INT64_STRING_MAX_LEN 21
+
 /*! \file m2mresourcebase.h \brief header for M2MResourceBase. */
 
 // Forward declarations
@@ -270,6 +274,18 @@ public:
      */
     int read_resource_value_size(const M2MResourceBase &resource, size_t *buffer_len);
 
+    /**
+     * \brief Reads one block of the value through the function set in "set_read_resource_function".
+     * \note The buffer stays owned by the application, only one block of a large value
+     * needs to be in memory at a time.
+     * \param buffer[OUT] Pointer to the block data.
+     * \param buffer_size[IN/OUT] On input the maximum size of the block, on output the size of the block.
+     * \param total_size[OUT] Total size of the value.
+     * \param offset Offset of the block in the value.
+     * \return CoAP response code, COAP_RESPONSE_NOT_FOUND if the function is not set.
+     */
+    coap_response_code_e read_value_block(uint8_t *&buffer, size_t &buffer_size, size_t &total_size, size_t offset);
+
     /**
      * \brief Executes the function that is set in "set_resource_write_callback".
      * \param resource Pointer to resource where value will be stored.
@@ -485,12 +501,22 @@ public:
 
 private:
 
-    void report();
+    void report(bool report_parents = true);
 
     void report_value_change();
 
+    /**
+     * \brief Evaluates a value change for notifications.
+     * @param report_parents false if the object and object instance are reported separately.
+     */
+    void report_change(bool report_parents);
+
     bool has_value_changed(const uint8_t *value, const uint32_t value_len);
 
+    bool copy_value(const uint8_t *value, const uint32_t value_length);
+
+    void free_value();
+
     M2MResourceBase::ResourceType convert_data_type(M2MBase::DataType type) const;
 
     void read_data_from_application(M2MCallbackAssociation *item, nsdl_s *nsdl, const sn_coap_hdr_s *received_coap,
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2020 ARM Limited. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef M2M_STATIC_RESOURCE_H
+#define M2M_STATIC_RESOURCE_H
+
+/** \file m2mstaticresource.h \brief Compile time resource descriptors.
+ *
+ * A resource created with M2MObjectInstance::create_dynamic_resource(const lwm2m_parameters_s*, ...)
+ * uses the given descriptors as they are, instead of allocating them from heap. The
+ * M2M_STATIC_RESOURCE() macro defines such descriptors at file scope. The name, path
+ * and resource type strings and the descriptors themselves are constant data, so
+ * they are placed in flash. Only the dynamic resource parameters, which hold the
+ * value and the registration state, take RAM, plus the value itself once set.
+ *
+ * Usage:
+ * \code
+ * M2M_STATIC_RESOURCE(temperature, 3303, 0, 5700, "temperature", M2MBase::FLOAT, false);
+ *
+ * M2MObjectInstance *inst = M2MInterfaceFactory::create_object(3303)->create_object_instance((uint16_t)0);
+ * M2MResource *res = inst->create_dynamic_resource(&temperature, M2MResourceInstance::FLOAT, true);
+ * res->set_operation(M2MBase::GET_ALLOWED);
+ * \endcode
+ *
+ * The object and object instance the resource is created in must match the IDs given
+ * to the macro, as the path is fixed at compile time. Resource type and interface
+ * description of such a resource can not be changed at runtime. A resource whose value
+ * is read and written through callbacks, see M2MResourceBase::set_resource_read_callback(),
+ * is defined with M2M_STATIC_CALLBACK_RESOURCE(). An empty resource type, such as
+ * OMA_RESOURCE_TYPE, is left out like with the runtime created resources.
+ */
+
+#include "mbed-client/m2mbase.h"
+
+#include <stddef.h> // NULL
+
+#ifndef RESOURCE_ATTRIBUTES_LIST
+#ifndef DISABLE_RESOURCE_TYPE
+#define M2M_STATIC_RESOURCE_TYPE_INIT(name, resource_type) (sizeof(resource_type) > 1 ? (char *)resource_type : NULL),
+#else
+#define M2M_STATIC_RESOURCE_TYPE_INIT(name, resource_type)
+#endif
+#ifndef DISABLE_INTERFACE_DESCRIPTION
+#define M2M_STATIC_RESOURCE_ATTRIBUTES_INIT(name, resource_type) M2M_STATIC_RESOURCE_TYPE_INIT(name, resource_type) NULL,
+#else
+#define M2M_STATIC_RESOURCE_ATTRIBUTES_INIT(name, resource_type) M2M_STATIC_RESOURCE_TYPE_INIT(name, resource_type)
+#endif
+#define M2M_STATIC_RESOURCE_ATTRIBUTES(name, resource_type)
+#else
+#define M2M_STATIC_RESOURCE_ATTRIBUTES(name, resource_type) \
+    static const sn_nsdl_attribute_item_s name##_attributes[] = { \
+        { ATTR_RESOURCE_TYPE, (char *)resource_type }, \
+        { ATTR_END, NULL } \
+    };
+#define M2M_STATIC_RESOURCE_ATTRIBUTES_INIT(name, resource_type) \
+    (sizeof(resource_type) > 1 ? const_cast<sn_nsdl_attribute_item_s *>(name##_attributes) : NULL),
+#endif
+
+#if MBED_CLIENT_COMPACT_LWM2M_PARAMETERS
+#define M2M_STATIC_LWM2M_PARAMETERS_INIT(id, dynamic_params, data_type, multiple_instance, read_write_callback_set) { \
+        { (char *)id },                                         /* identifier.name */ \
+        dynamic_params, \
+        M2MBase::Resource, \
+        data_type, \
+        multiple_instance, \
+        false,                                                  /* free_on_delete, also marks read-only */ \
+        false,                                                  /* identifier_int_type */ \
+        read_write_callback_set, \
+        false                                                   /* max_age_set */ \
+    }
+#else
+#define M2M_STATIC_LWM2M_PARAMETERS_INIT(id, dynamic_params, data_type, multiple_instance, read_write_callback_set) { \
+        0,                                                      /* max_age */ \
+        { (char *)id },                                         /* identifier.name */ \
+        dynamic_params, \
+        M2MBase::Resource, \
+        data_type, \
+        multiple_instance, \
+        false,                                                  /* free_on_delete, also marks read-only */ \
+        false,                                                  /* identifier_int_type */ \
+        read_write_callback_set \
+    }
+#endif
+
+#define M2M_STATIC_RESOURCE_DEF(name, object_id, instance_id, resource_id, resource_type, data_type, multiple_instance, \
+                                read_write_callback_set) \
+    M2M_STATIC_RESOURCE_ATTRIBUTES(name, resource_type) \
+    static const sn_nsdl_static_resource_parameters_s name##_static_params = { \
+        M2M_STATIC_RESOURCE_ATTRIBUTES_INIT(name, resource_type) \
+        (char *)(#object_id "/" #instance_id "/" #resource_id), /* path */ \
+        false,                                                  /* external_memory_block */ \
+        M2MBase::Dynamic,                                       /* mode */ \
+        false                                                   /* free_on_delete */ \
+    }; \
+    static sn_nsdl_dynamic_resource_parameters_s name##_dynamic_params = { \
+        NULL,                                                   /* sn_grs_dyn_res_callback, set on creation */ \
+        const_cast<sn_nsdl_static_resource_parameters_s *>(&name##_static_params), \
+        NULL,                                                   /* resource */ \
+        { NULL, NULL },                                         /* link */ \
+        0,                                                      /* resource_len */ \
+        0,                                                      /* coap_content_type */ \
+        0,                                                      /* access */ \
+        0,                                                      /* registered */ \
+        true                                                    /* publish_uri, rest are zero */ \
+    }; \
+    static const M2MBase::lwm2m_parameters_s name = \
+        M2M_STATIC_LWM2M_PARAMETERS_INIT(#resource_id, &name##_dynamic_params, data_type, multiple_instance, read_write_callback_set)
+
+/**
+ * \brief Defines constant descriptors of one resource, and the dynamic parameters it uses.
+ *
+ * \param name Name of the defined M2MBase::lwm2m_parameters_s variable.
+ * \param object_id Object ID, an integer literal.
+ * \param instance_id Object instance ID, an integer literal.
+ * \param resource_id Resource ID, an integer literal.
+ * \param resource_type Resource type as string literal.
+ * \param data_type Data type of the resource, for example M2MBase::INTEGER.
+ * \param multiple_instance true if the resource has resource instances.
+ */
+#define M2M_STATIC_RESOURCE(name, object_id, instance_id, resource_id, resource_type, data_type, multiple_instance) \
+    M2M_STATIC_RESOURCE_DEF(name, object_id, instance_id, resource_id, resource_type, data_type, multiple_instance, false)
+
+/**
+ * \brief As M2M_STATIC_RESOURCE(), for a resource whose value is only accessed through
+ * read and write callbacks and is not stored by the client.
+ */
+#define M2M_STATIC_CALLBACK_RESOURCE(name, object_id, instance_id, resource_id, resource_type, data_type, multiple_instance) \
+    M2M_STATIC_RESOURCE_DEF(name, object_id, instance_id, resource_id, resource_type, data_type, multiple_instance, true)
+
+#endif // M2M_STATIC_RESOURCE_H
@@ -30,12 +30,17 @@ namespace m2m
 {
 
 
-  /** A simple C++ string class, used as replacement for std::string. */
+  /** A simple C++ string class, used as replacement for std::string.
+      Strings of up to INLINE_CAPACITY characters are stored inside the object,
+      longer ones are allocated from heap. */
   class String
   {
-    char* p;           ///< The data.
+    enum { INLINE_CAPACITY = 15 };
+
+    char* p;           ///< The data, points to inline_ for short strings.
     size_t allocated_;  ///< The allocated memory size (including trailing NULL).
     size_t size_;       ///< The currently used memory size (excluding trailing NULL).
+    char inline_[INLINE_CAPACITY + 1]; ///< Storage of short strings.
 
   public:
     typedef size_t size_type;
@@ -46,9 +51,15 @@ namespace m2m
     String(const String&);
     String(const char*);
     String(const char*, size_t);
+#if __cplusplus >= 201103L
+    String(String&&);
+#endif
 
     String& operator=(const char*);
     String& operator=(const String&);
+#if __cplusplus >= 201103L
+    String& operator=(String&&);
+#endif
 
     String& operator+=(const String&);
     String& operator+=(const char*);
@@ -161,7 +172,11 @@ namespace m2m
   private:
     // reallocate the internal memory
     void new_realloc( size_type n);
-    char* strdup(const char* other);
+    // set initial content, used by constructors
+    void init(const char* str, size_type n);
+    bool is_inline() const { return p == inline_; }
+    // give heap memory back and become an empty inline string
+    void reset();
 
     friend class ::Test_M2MString;
 
@@ -79,6 +79,18 @@ public:
      */
     bool is_total_interval_passed();
 
+    /**
+     * \brief Returns the time since the timer was started or last restarted at expiry.
+     * \return Elapsed time in milliseconds.
+     */
+    uint64_t elapsed_time();
+
+    /**
+     * \brief Returns the time until the timer expires next.
+     * \return Remaining time in milliseconds, UINT64_MAX if the timer is not running.
+     */
+    uint64_t remaining_time();
+
 private:
 
     M2MTimerObserver&   _observer;
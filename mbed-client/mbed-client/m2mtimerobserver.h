@@ -40,6 +40,9 @@ public:
         RegistrationFlowTimer,
         StaggerWaitTimer,
         DnsQueryFallback,
+        ConnectionAttempt,
+        LwM2MSend,
+        WakeWindow,
         TypeNotUsed // Last item. Add new types above this!
     }Type;
 
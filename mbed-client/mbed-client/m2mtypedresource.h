@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2021 Pelion. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef M2M_TYPED_RESOURCE_H
+#define M2M_TYPED_RESOURCE_H
+
+/** \file m2mtypedresource.h \brief Typed access to resource values.
+ *
+ * M2MTypedResource<T> wraps an M2MResource and reads and writes its value as a native
+ * int64_t, float, bool or m2m::Opaque. The data type and the text conversion are picked
+ * at compile time, and the last value is kept in native form. Setting the value the
+ * resource already has returns without a conversion, and reading a value that has not
+ * been written since skips the parsing done by M2MResourceBase::get_value_int() and
+ * M2MResourceBase::get_value_float().
+ *
+ * The resource itself still stores its value as text, so CoAP requests, the TLV and
+ * SenML serializers and the resource callbacks see it as before. A value written by the
+ * server is noticed on the next get(), as the text no longer matches the cached one.
+ *
+ * Usage:
+ * \code
+ * M2MResource *res = M2MTypedResource<float>::create(*inst, 5700, "temperature", true);
+ * M2MTypedResource<float> temperature(*res);
+ * temperature.set(21.5f);
+ * \endcode
+ *
+ * The wrapper holds a reference to the resource, it must not outlive it.
+ */
+
+#include "mbed-client/m2mobjectinstance.h"
+#include "mbed-client/m2mresource.h"
+#include "mbed-client/m2mstring.h"
+
+#include <stdint.h>
+#include <stdio.h>  // snprintf
+#include <stdlib.h> // atof
+#include <string.h> // memcmp, memcpy
+
+namespace m2m
+{
+
+/** \brief Value of an opaque resource, points to the bytes stored in the resource. */
+struct Opaque {
+    const uint8_t *data;
+    uint32_t length;
+};
+
+/** \brief Data type and text conversion of the native value types.
+ *
+ * Only the specializations below exist, so a resource of an unsupported type does not compile.
+ */
+template <typename T>
+struct TypedResourceTraits;
+
+template <>
+struct TypedResourceTraits<int64_t> {
+    static M2MResourceInstance::ResourceType type()
+    {
+        return M2MResourceInstance::INTEGER;
+    }
+
+    enum { text_size = REGISTRY_INT64_STRING_MAX_LEN };
+
+    static uint32_t to_text(int64_t value, char *text)
+    {
+        return itoa_c(value, text);
+    }
+
+    static int64_t from_text(const uint8_t *text, uint32_t length)
+    {
+        int64_t value = 0;
+        String::convert_ascii_to_int((const char *)text, length, value);
+        return value;
+    }
+};
+
+template <>
+struct TypedResourceTraits<float> {
+    static M2MResourceInstance::ResourceType type()
+    {
+        return M2MResourceInstance::FLOAT;
+    }
+
+    enum { text_size = REGISTRY_FLOAT_STRING_MAX_LEN };
+
+    static uint32_t to_text(float value, char *text)
+    {
+        // Same format as M2MResourceBase::set_value_float()
+#if MBED_MINIMAL_PRINTF
+        int length = snprintf(text, text_size, "%f", value);
+#else
+        int length = snprintf(text, text_size, "%e", value);
+#endif
+        return (length > 0 && length < text_size) ? length : 0;
+    }
+
+    static float from_text(const uint8_t *text, uint32_t length)
+    {
+        char temp[text_size + 1];
+        if (length > text_size) {
+            return 0;
+        }
+        memcpy(temp, text, length);
+        temp[length] = 0;
+        return atof(temp);
+    }
+};
+
+template <>
+struct TypedResourceTraits<bool> {
+    static M2MResourceInstance::ResourceType type()
+    {
+        return M2MResourceInstance::BOOLEAN;
+    }
+
+    enum { text_size = 2 };
+
+    static uint32_t to_text(bool value, char *text)
+    {
+        text[0] = value ? '1' : '0';
+        text[1] = 0;
+        return 1;
+    }
+
+    static bool from_text(const uint8_t *text, uint32_t length)
+    {
+        return TypedResourceTraits<int64_t>::from_text(text, length) != 0;
+    }
+};
+
+/** \brief Typed view of an M2MResource of type int64_t, float or bool. */
+template <typename T>
+class M2MTypedResource {
+public:
+
+    /**
+     * \brief Creates a dynamic resource of the data type matching T.
+     * \param object_instance The object instance the resource is created in.
+     * \param resource_name The name of the resource.
+     * \param resource_type The type of the resource.
+     * \param observable True if the resource is observable.
+     * \return The resource or NULL if it could not be created.
+     */
+    static M2MResource *create(M2MObjectInstance &object_instance, const uint16_t resource_name,
+                               const char *resource_type, bool observable)
+    {
+        return object_instance.create_dynamic_resource(resource_name, resource_type,
+                                                       TypedResourceTraits<T>::type(), observable);
+    }
+
+    /**
+     * \brief Constructor.
+     * \param resource The resource, its data type must match T.
+     */
+    explicit M2MTypedResource(M2MResource &resource)
+        : _resource(resource),
+          _value(),
+          _text_length(0)
+    {
+    }
+
+    /**
+     * \brief Sets the value of the resource.
+     * \param value The new value.
+     * \return True if the value is set.
+     */
+    bool set(T value)
+    {
+        if (value == _value && in_sync()) {
+            return true;
+        }
+        char text[TypedResourceTraits<T>::text_size];
+        const uint32_t length = TypedResourceTraits<T>::to_text(value, text);
+        if (!length || !_resource.set_value((const uint8_t *)text, length)) {
+            return false;
+        }
+        _value = value;
+        memcpy(_text, text, length);
+        _text_length = length;
+        return true;
+    }
+
+    /**
+     * \brief Returns the value of the resource, 0 if the resource has no valid value.
+     */
+    T get() const
+    {
+        if (!in_sync()) {
+            const uint8_t *text = _resource.value();
+            const uint32_t length = _resource.value_length();
+            _value = text ? TypedResourceTraits<T>::from_text(text, length) : T();
+            _text_length = (text && length <= sizeof(_text)) ? length : 0;
+            if (_text_length) {
+                memcpy(_text, text, _text_length);
+            }
+        }
+        return _value;
+    }
+
+    /**
+     * \brief Returns the wrapped resource.
+     */
+    M2MResource &resource() const
+    {
+        return _resource;
+    }
+
+private:
+
+    // True if the resource still holds the text of the cached value
+    bool in_sync() const
+    {
+        return _text_length &&
+               _resource.value_length() == _text_length &&
+               memcmp(_resource.value(), _text, _text_length) == 0;
+    }
+
+    M2MResource &_resource;
+    mutable T _value;
+    mutable char _text[TypedResourceTraits<T>::text_size];
+    mutable uint8_t _text_length;
+};
+
+/** \brief Typed view of an opaque M2MResource, no conversion is needed. */
+template <>
+class M2MTypedResource<Opaque> {
+public:
+
+    static M2MResource *create(M2MObjectInstance &object_instance, const uint16_t resource_name,
+                               const char *resource_type, bool observable)
+    {
+        return object_instance.create_dynamic_resource(resource_name, resource_type,
+                                                       M2MResourceInstance::OPAQUE, observable);
+    }
+
+    explicit M2MTypedResource(M2MResource &resource)
+        : _resource(resource)
+    {
+    }
+
+    bool set(const uint8_t *data, uint32_t length)
+    {
+        return _resource.set_value(data, length);
+    }
+
+    bool set(const Opaque &value)
+    {
+        return set(value.data, value.length);
+    }
+
+    Opaque get() const
+    {
+        Opaque value = { _resource.value(), _resource.value_length() };
+        return value;
+    }
+
+    M2MResource &resource() const
+    {
+        return _resource;
+    }
+
+private:
+    M2MResource &_resource;
+};
+
+} // namespace m2m
+
+#endif // M2M_TYPED_RESOURCE_H
@@ -19,63 +19,159 @@
 
 /** \file m2mvector.h \brief header for m2m::Vector */
 
+#include <new>      // placement new
+#include <string.h> // memcpy
+
 namespace m2m
 {
 
+/** \brief Tells m2m::Vector whether its elements may be moved in memory with memcpy.
+ *
+ * Pointers and the basic arithmetic types are trivially relocatable, other types are
+ * relocated by move (or copy) construction followed by destruction. Use
+ * M2M_VECTOR_TRIVIALLY_RELOCATABLE() to mark further types.
+ */
+template <typename ObjectTemplate>
+struct VectorTraits {
+    enum { trivially_relocatable = 0 };
+};
+
+template <typename ObjectTemplate>
+struct VectorTraits<ObjectTemplate *> {
+    enum { trivially_relocatable = 1 };
+};
+
+#define M2M_VECTOR_TRIVIALLY_RELOCATABLE(type) \
+    template <> struct VectorTraits<type> { enum { trivially_relocatable = 1 }; }
+
+M2M_VECTOR_TRIVIALLY_RELOCATABLE(char);
+M2M_VECTOR_TRIVIALLY_RELOCATABLE(signed char);
+M2M_VECTOR_TRIVIALLY_RELOCATABLE(unsigned char);
+M2M_VECTOR_TRIVIALLY_RELOCATABLE(short);
+M2M_VECTOR_TRIVIALLY_RELOCATABLE(unsigned short);
+M2M_VECTOR_TRIVIALLY_RELOCATABLE(int);
+M2M_VECTOR_TRIVIALLY_RELOCATABLE(unsigned int);
+M2M_VECTOR_TRIVIALLY_RELOCATABLE(long);
+M2M_VECTOR_TRIVIALLY_RELOCATABLE(unsigned long);
+M2M_VECTOR_TRIVIALLY_RELOCATABLE(long long);
+M2M_VECTOR_TRIVIALLY_RELOCATABLE(unsigned long long);
+M2M_VECTOR_TRIVIALLY_RELOCATABLE(float);
+M2M_VECTOR_TRIVIALLY_RELOCATABLE(double);
+
+#if __cplusplus >= 201103L
+#define M2M_VECTOR_MOVE(x) static_cast<ObjectTemplate &&>(x)
+#else
+#define M2M_VECTOR_MOVE(x) (x)
+#endif
+
 template <typename ObjectTemplate>
 
 /** \brief A simple C++ Vector class, used as replacement for std::vector.
+ *
+ * Storage is uninitialized beyond size(), elements are constructed in place when added
+ * and destroyed when removed.
 */
 class Vector
 {
   public:
-    explicit Vector( int init_size = MIN_CAPACITY)
+    /** Storage is allocated on first insertion, unless init_size is given. */
+    explicit Vector( int init_size = 0)
             : _size(0),
-              _capacity((init_size >= MIN_CAPACITY) ? init_size : MIN_CAPACITY) {
-        _object_template = new ObjectTemplate[ _capacity ];
+              _capacity((init_size > 0) ? init_size : 0),
+              _object_template((init_size > 0) ? allocate(init_size) : 0) {
     }
 
-    Vector(const Vector & rhs ): _object_template(0) {
+    Vector(const Vector & rhs )
+            : _size(0),
+              _capacity(0),
+              _object_template(0) {
         operator=(rhs);
     }
 
+#if __cplusplus >= 201103L
+    Vector(Vector && rhs)
+            : _size(rhs._size),
+              _capacity(rhs._capacity),
+              _object_template(rhs._object_template) {
+        rhs._size = 0;
+        rhs._capacity = 0;
+        rhs._object_template = 0;
+    }
+#endif
+
     ~Vector() {
-        delete [] _object_template;
+        destroy(_object_template, _size);
+        deallocate(_object_template);
     }
 
     const Vector & operator=(const Vector & rhs) {
         if(this != &rhs) {
-            delete[] _object_template;
-            _size = rhs.size();
-            _capacity = rhs._capacity;
+            destroy(_object_template, _size);
+            _size = 0;
+            if(rhs.size() > _capacity) {
+                deallocate(_object_template);
+                _capacity = rhs.size();
+                _object_template = allocate(_capacity);
+            }
 
-            _object_template = new ObjectTemplate[capacity()];
-            for(int k = 0; k < size(); k++) {
-                _object_template[k] = rhs._object_template[k];
+            for(int k = 0; k < rhs.size(); k++) {
+                new (&_object_template[k]) ObjectTemplate(rhs._object_template[k]);
             }
+            _size = rhs.size();
         }
         return *this;
     }
 
+#if __cplusplus >= 201103L
+    const Vector & operator=(Vector && rhs) {
+        if(this != &rhs) {
+            destroy(_object_template, _size);
+            deallocate(_object_template);
+            _size = rhs._size;
+            _capacity = rhs._capacity;
+            _object_template = rhs._object_template;
+            rhs._size = 0;
+            rhs._capacity = 0;
+            rhs._object_template = 0;
+        }
+        return *this;
+    }
+#endif
+
     void resize(int new_size) {
         if(new_size > _capacity) {
             reserve(new_size * 2 + 1);
         }
+        if(new_size < _size) {
+            destroy(&_object_template[new_size], _size - new_size);
+        }
+        for(int k = _size; k < new_size; k++) {
+            new (&_object_template[k]) ObjectTemplate();
+        }
         _size = new_size;
     }
 
     void reserve(int new_capacity) {
-        if(new_capacity < _size) {
+        if(new_capacity < _size || new_capacity < MIN_CAPACITY) {
             return;
         }
         ObjectTemplate *old_array = _object_template;
 
-        _object_template = new ObjectTemplate[new_capacity];
-        for(int k = 0; k < _size; k++) {
-            _object_template[k] = old_array[k];
-        }
+        _object_template = allocate(new_capacity);
+        relocate(_object_template, old_array, _size);
         _capacity = new_capacity;
-        delete [] old_array;
+        deallocate(old_array);
+    }
+
+    /** Releases unused capacity, capacity becomes size(). */
+    void shrink_to_fit() {
+        if(_size == 0) {
+            deallocate(_object_template);
+            _object_template = 0;
+            _capacity = 0;
+        } else if(_capacity > _size) {
+            reserve(_size);
+        }
     }
 
     ObjectTemplate & operator[](int idx) {
@@ -100,17 +196,42 @@ class Vector
 
     void push_back(const ObjectTemplate& x) {
         if(_size == _capacity) {
-            reserve(2 * _capacity + 1);
+            // x may be an element of this vector, so it is copied before old storage is released
+            ObjectTemplate *new_array = allocate(2 * _capacity + 1);
+            new (&new_array[_size]) ObjectTemplate(x);
+            grow_to(new_array, 2 * _capacity + 1);
+        } else {
+            new (&_object_template[_size]) ObjectTemplate(x);
         }
-        _object_template[_size] = x;
         _size++;
     }
 
+#if __cplusplus >= 201103L
+    void push_back(ObjectTemplate && x) {
+        emplace_back(static_cast<ObjectTemplate &&>(x));
+    }
+
+    /** Constructs a new element in place at the end, from the given constructor arguments. */
+    template <typename... Args>
+    ObjectTemplate & emplace_back(Args && ... args) {
+        if(_size == _capacity) {
+            ObjectTemplate *new_array = allocate(2 * _capacity + 1);
+            new (&new_array[_size]) ObjectTemplate(static_cast<Args &&>(args)...);
+            grow_to(new_array, 2 * _capacity + 1);
+        } else {
+            new (&_object_template[_size]) ObjectTemplate(static_cast<Args &&>(args)...);
+        }
+        return _object_template[_size++];
+    }
+#endif
+
     void pop_back() {
         _size--;
+        _object_template[_size].~ObjectTemplate();
     }
 
     void clear() {
+        destroy(_object_template, _size);
         _size = 0;
     }
 
@@ -122,25 +243,32 @@ class Vector
     typedef const ObjectTemplate* const_iterator;
 
     iterator begin() {
-        return &_object_template[0];
+        return _object_template;
     }
 
     const_iterator begin() const {
-        return &_object_template[0];
+        return _object_template;
     }
 
     iterator end() {
-        return &_object_template[_size];
+        return _object_template + _size;
     }
 
     const_iterator end() const {
-        return &_object_template[_size];
+        return _object_template + _size;
     }
 
     void erase(int position) {
         if(position < _size) {
-            for(int k = position; k + 1 < _size; k++) {
-                _object_template[k] = _object_template[k + 1];
+            if(VectorTraits<ObjectTemplate>::trivially_relocatable) {
+                _object_template[position].~ObjectTemplate();
+                memmove(static_cast<void *>(&_object_template[position]), &_object_template[position + 1],
+                        (_size - position - 1) * sizeof(ObjectTemplate));
+            } else {
+                for(int k = position; k + 1 < _size; k++) {
+                    _object_template[k] = M2M_VECTOR_MOVE(_object_template[k + 1]);
+                }
+                _object_template[_size - 1].~ObjectTemplate();
             }
             _size--;
         }
@@ -151,11 +279,49 @@ class Vector
     };
 
   private:
+    static ObjectTemplate *allocate(int count) {
+        return static_cast<ObjectTemplate *>(::operator new(count * sizeof(ObjectTemplate)));
+    }
+
+    static void deallocate(ObjectTemplate *array) {
+        ::operator delete(array);
+    }
+
+    static void destroy(ObjectTemplate *array, int count) {
+        for(int k = 0; k < count; k++) {
+            array[k].~ObjectTemplate();
+        }
+    }
+
+    // Moves count constructed elements from src to uninitialized dst, src is left uninitialized
+    static void relocate(ObjectTemplate *dst, ObjectTemplate *src, int count) {
+        if(VectorTraits<ObjectTemplate>::trivially_relocatable) {
+            if(count > 0) {
+                memcpy(static_cast<void *>(dst), src, count * sizeof(ObjectTemplate));
+            }
+        } else {
+            for(int k = 0; k < count; k++) {
+                new (&dst[k]) ObjectTemplate(M2M_VECTOR_MOVE(src[k]));
+                src[k].~ObjectTemplate();
+            }
+        }
+    }
+
+    // Takes new_array into use, existing elements are relocated to it
+    void grow_to(ObjectTemplate *new_array, int new_capacity) {
+        relocate(new_array, _object_template, _size);
+        deallocate(_object_template);
+        _object_template = new_array;
+        _capacity = new_capacity;
+    }
+
     int                 _size;
     int                 _capacity;
     ObjectTemplate*     _object_template;
 };
 
+#undef M2M_VECTOR_MOVE
+
 } // namespace
 
 #endif // M2M_VECTOR_H
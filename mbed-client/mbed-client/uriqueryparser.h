@@ -61,6 +61,36 @@ int parse_query_parameter_value_from_uri(const char *uri, const char *parameter_
  */
 int parse_query_parameter_value_from_query(const char *query, const char *parameter_name, const char **parameter_value);
 
+/**
+ * @brief One parameter of a query, pointing into the query.
+ */
+typedef struct query_parameter_s {
+    const char  *key;
+    int         key_len;
+    const char  *value;     /**< NULL if the parameter has no '=' */
+    int         value_len;
+} query_parameter_s;
+
+/**
+ * @brief Returns the next parameter of a query and moves past it, without copying anything.
+ *        The query is scanned once, a character at a time.
+ *
+ * **Example usage:**
+ * @code{.cpp}
+ * const char *query = "pmin=10&pmax=60";
+ * query_parameter_s parameter;
+ * while (next_query_parameter(&query, NULL, &parameter)) {
+ *     // parameter.key = "pmin", parameter.key_len = 4, parameter.value = "10", parameter.value_len = 2
+ * }
+ * @endcode
+ *
+ * @param[in,out] query The rest of the query to parse, moved past the returned parameter.
+ * @param query_end End of the query, NULL if the query ends at a null character.
+ * @param[out] parameter The parameter found.
+ * @return 1 if a parameter was found, 0 at the end of the query.
+ */
+int next_query_parameter(const char **query, const char *query_end, query_parameter_s *parameter);
+
 
 #endif /* URIQUERYPARSER_H_ */
 
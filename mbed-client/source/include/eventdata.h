@@ -26,10 +26,15 @@ typedef Vector<M2MObject *> M2MObjectList;
 
 class M2MSecurity;
 
+/**
+ * Base of the data passed with a state machine event. The data lives on the
+ * stack of the caller for the duration of the transition and is never deleted
+ * through this type, so it carries no vtable.
+ */
 class EventData
 {
-public:
-    virtual ~EventData() {}
+protected:
+    ~EventData() {}
 };
 
 class M2MSecurityData : public EventData
@@ -37,7 +42,6 @@ class M2MSecurityData : public EventData
 public:
     M2MSecurityData()
     :_object(NULL){}
-    virtual ~M2MSecurityData() {}
     M2MSecurity  *_object;
 };
 
@@ -47,7 +51,6 @@ public:
     ResolvedAddressData()
     :_address(NULL),
     _port(0){}
-    virtual ~ResolvedAddressData() {}
     const M2MConnectionObserver::SocketAddress    *_address;
     uint16_t                                       _port;
 };
@@ -60,7 +63,6 @@ public:
     _size(0),
     _port(0),
     _address(NULL){}
-    virtual ~ReceivedData() {}
     uint8_t                                         *_data;
     uint16_t                                        _size;
     uint16_t                                        _port;
@@ -72,7 +74,6 @@ class M2MRegisterData : public EventData
 public:
     M2MRegisterData()
     :_object(NULL){}
-    virtual ~M2MRegisterData() {}
     M2MSecurity     *_object;
     M2MBaseList    _base_list;
 };
@@ -83,7 +84,6 @@ public:
     M2MUpdateRegisterData()
     :_object(NULL),
     _lifetime(0){}
-    virtual ~M2MUpdateRegisterData() {}
     M2MSecurity     *_object;
     uint32_t        _lifetime;
     M2MBaseList    _base_list;
@@ -93,7 +93,6 @@ class M2MResumeData : public EventData
 {
 public:
     M2MResumeData(): _interface(NULL) {}
-    virtual ~M2MResumeData() {}
     void        *_interface;
     M2MBaseList _base_list;
 };
@@ -18,6 +18,8 @@
 
 #include "mbed-client/m2mvector.h"
 
+#include <stdint.h>
+
 class M2MBase;
 class M2MCallbackAssociation;
 class M2MCallbackStorage;
@@ -80,7 +82,10 @@ public:
 #endif // ENABLE_ASYNC_REST_RESPONSE
 
         // typedef void(*outgoing_large_block_message_callback) (XXX);
-        M2MResourceInstanceReadCallback
+        M2MResourceInstanceReadCallback,
+
+        // uint32_t max age stored in the pointer, see M2MBase::set_max_age()
+        M2MBaseMaxAge
     };
 
     /**
@@ -115,6 +120,8 @@ public:
 class M2MCallbackStorage {
 public:
 
+    M2MCallbackStorage();
+
     ~M2MCallbackStorage();
 
     // get the shared instance of the storage.
@@ -160,6 +167,14 @@ private:
 
     M2MCallbackAssociation *do_get_association_item(const M2MBase &object, M2MCallbackAssociation::M2MCallbackType type) const;
 
+    static uint32_t hash(const M2MBase *object, M2MCallbackAssociation::M2MCallbackType type);
+    int find_slot(const M2MBase *object, M2MCallbackAssociation::M2MCallbackType type) const;
+    int find_slot_of(int position) const;
+    bool reserve_index(int count);
+    void index_insert(int position);
+    void index_remove(int slot);
+    void erase_association(int slot);
+
 private:
 
     /**
@@ -176,6 +191,18 @@ private:
      * the get_callback(<object>,<type>) and call the first one.
      */
     M2MCallbackAssociationList _callbacks;
+
+    /**
+     * Open addressing hash index to _callbacks, keyed by <object>+<type> and using linear probing.
+     * A slot holds the position in _callbacks plus one, zero marks an empty slot. The table
+     * is kept at most half full, so lookups are O(1) regardless of the number of callbacks.
+     * Removal moves the last association into the freed position, so the order of
+     * _callbacks is not the order the callbacks were added in.
+     */
+    int *_index;
+
+    /** Number of slots in _index, zero or a power of two. */
+    int _index_size;
 };
 
 inline const M2MCallbackAssociationList &M2MCallbackStorage::get_callbacks() const
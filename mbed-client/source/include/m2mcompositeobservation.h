@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2021 Pelion. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef M2M_COMPOSITE_OBSERVATION_H
+#define M2M_COMPOSITE_OBSERVATION_H
+
+#include "mbed-client/m2mconfig.h"
+#include "mbed-client/m2minterface.h"
+#include "mbed-client/m2mreportobserver.h"
+#include "include/m2mreporthandler.h"
+
+#if MBED_CLIENT_COMPOSITE_OPERATIONS
+
+class M2MNsdlInterface;
+
+/**
+ * @brief M2MCompositeObservation
+ * One LwM2M Observe-Composite relationship. All observed paths share the
+ * token, the report handler and so the pmin and pmax periods. A change in
+ * any of the paths only marks the observation pending, M2MNsdlInterface
+ * then sends the values of all paths in one SenML-CBOR notification from
+ * the notification event.
+ */
+class M2MCompositeObservation : public M2MReportObserver {
+
+private:
+    // Prevents the use of assignment operator by accident.
+    M2MCompositeObservation &operator=(const M2MCompositeObservation & /*other*/);
+
+    // Prevents the use of copy constructor by accident
+    M2MCompositeObservation(const M2MCompositeObservation & /*other*/);
+
+public:
+
+    /**
+     * \brief Constructor.
+     * @param nsdl_interface Interface that sends the notifications.
+     */
+    M2MCompositeObservation(M2MNsdlInterface &nsdl_interface);
+
+    virtual ~M2MCompositeObservation();
+
+    /**
+     * \brief Returns the observed paths, in the order of the request.
+     */
+    M2MBaseList &paths();
+
+    /**
+     * \brief Returns the report handler holding token, observation number
+     * and the notification attributes.
+     */
+    M2MReportHandler &report_handler();
+
+    /**
+     * \brief Checks whether the token matches the token of this observation.
+     */
+    bool has_token(const uint8_t *token, uint8_t token_length) const;
+
+    /**
+     * \brief Checks whether the given resource or resource instance is one
+     * of the observed paths or below one of them.
+     */
+    bool covers(const M2MBase &base) const;
+
+    /**
+     * \brief Removes the given base from the observed paths.
+     * \return true if there are paths left.
+     */
+    bool remove_path(const M2MBase &base);
+
+    /**
+     * \brief Checks whether a notification is waiting to be sent.
+     */
+    bool notification_pending() const;
+
+    /**
+     * \brief Marks the pending notification sent or dropped.
+     */
+    void clear_notification_pending();
+
+    /**
+     * \brief Message ID of the latest notification, to match a reset.
+     */
+    int32_t msg_id() const;
+
+    /**
+     * \brief Sets the message ID of the latest notification.
+     */
+    void set_msg_id(int32_t msg_id);
+
+protected: // from M2MReportObserver
+
+    virtual bool observation_to_be_sent(const m2m::Vector<uint16_t> &changed_instance_ids,
+                                        uint16_t obs_number,
+                                        bool send_object = false);
+
+private:
+
+    M2MNsdlInterface    &_nsdl_interface;
+    M2MReportHandler    _report_handler;
+    M2MBaseList         _paths;
+    int32_t             _msg_id;
+    bool                _notification_pending;
+};
+
+#endif // MBED_CLIENT_COMPOSITE_OPERATIONS
+
+#endif // M2M_COMPOSITE_OBSERVATION_H
@@ -49,26 +49,59 @@ public:
      */
     static uint8_t *create_resource_payload(const M2MResource *res, uint32_t &data_length);
 
+    /**
+     * \brief Creates the block of the Discover payload of the given object, object instance or resource
+     * that the request asks for. Only the requested block is written into the returned buffer, the rest of
+     * the payload is just counted, so the complete payload is never held in memory. If the payload does not
+     * fit into one block, the Block2 and Size2 options of the response are set.
+     * @param nsdl NSDL handle, for the configured block size.
+     * @param base M2MObject, M2MObjectInstance or M2MResource which is to create payload.
+     * @param request Received Discover request.
+     * @param response Response whose options are set.
+     * @param data_length reference which is updated to length of the data returned. Initial value does not mather.
+     * \return NULL if allocation failed or the requested block is past the payload, otherwise allocated uint8_t* with the block.
+     */
+    static uint8_t *create_payload_block(nsdl_s *nsdl, M2MBase &base, const sn_coap_hdr_s &request,
+                                         sn_coap_hdr_s &response, uint32_t &data_length);
+
 private:
     // Prevent instantiate of this class
     M2MDiscover();
 
-    static void create_object_payload(const M2MObject *object, uint8_t **data, uint32_t &data_length);
+    // Payload is written through this, bytes before offset and after offset + size are only counted.
+    typedef struct discover_writer_s {
+        uint8_t     *buffer;    // NULL when only counting
+        uint32_t    offset;     // Offset of buffer within the payload
+        uint32_t    size;       // Size of buffer
+        uint32_t    length;     // Length of the payload so far
+    } discover_writer_s;
+
+    static void write_payload(const M2MBase &base, discover_writer_s &writer);
 
-    static void create_object_instance_payload(const M2MObjectInstance *obj_instance, uint8_t **data, uint32_t &data_length, bool add_resource_dimension, bool add_resource_attribute, bool add_object_attributes);
+    static void create_object_payload(const M2MObject *object, discover_writer_s &writer);
+
+    static void create_object_instance_payload(const M2MObjectInstance *obj_instance, discover_writer_s &writer, bool add_resource_dimension, bool add_resource_attribute, bool add_object_attributes);
+
+    static void create_resource_payload(const M2MResource *res, discover_writer_s &writer, bool add_resource_dimension, bool add_resource_attribute, bool add_inherited = false);
+
+    static uint8_t *create_payload(const M2MBase &base, uint32_t &data_length);
+
+#if MBED_CLIENT_DISCOVER_CACHE
+    static const uint8_t *cached_object_payload(M2MObject &object, uint32_t &data_length);
+#endif
 
-    static void create_resource_payload(const M2MResource *res, uint8_t **data, uint32_t &data_length, bool add_resource_dimension, bool add_resource_attribute, bool add_inherited = false);
+    static void write(discover_writer_s &writer, const char *str, uint32_t length);
 
-    static void set_path(const char *path, uint8_t **data, uint32_t &data_length);
+    static void set_path(const char *path, discover_writer_s &writer);
 
-    static void set_path_and_attributes(M2MReportHandler *report_handler, const char *path, uint8_t **data, uint32_t &data_length);
+    static void set_path_and_attributes(M2MReportHandler *report_handler, const char *path, discover_writer_s &writer);
 
-    static void set_string_and_value(uint8_t **data, uint32_t &data_length, const char* str, float value, int32_t int_value, bool float_type);
+    static void set_string_and_value(discover_writer_s &writer, const char* str, float value, int32_t int_value, bool float_type);
 
-    static void set_comma(uint8_t **data, uint32_t &data_length);
+    static void set_comma(discover_writer_s &writer);
 
 #if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1)
-    static void set_resource_attributes(const M2MResource &res, uint8_t **data, uint32_t &data_length, bool add_inherited);
+    static void set_resource_attributes(const M2MResource &res, discover_writer_s &writer, bool add_inherited);
 
     static const char *get_attribute_string(M2MReportHandler::WriteAttribute attribute);
 
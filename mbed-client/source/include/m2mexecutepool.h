@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2021 Pelion. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef M2M_EXECUTE_POOL_H
+#define M2M_EXECUTE_POOL_H
+
+#include "mbed-client/m2mconfig.h"
+#include "mbed-client/m2mresource.h"
+
+#if MBED_CLIENT_EXECUTE_THREADS
+
+/**
+ * @brief M2MExecutePool
+ * Runs the execute callbacks of resources on MBED_CLIENT_EXECUTE_THREADS
+ * worker threads, so that a slow callback does not hold up the event loop.
+ * The callbacks of one resource run one at a time, in the order the POST
+ * requests were received. The workers never take the event loop mutex: a
+ * delayed POST response sent from a callback is recorded and sent from the
+ * event loop once the callback has returned.
+ */
+class M2MExecutePool {
+
+public:
+
+    /**
+     * \brief Queues the execute callbacks of the resource, called from the event loop.
+     * @param resource Resource the POST request was for.
+     * @param params Parameters of the request, the argument value is copied.
+     * @return true if queued, false if the callbacks need to be run by the caller.
+     */
+    static bool dispatch(M2MResource &resource, const M2MResource::M2MExecuteParameter &params);
+
+    /**
+     * \brief Records a delayed POST response sent from a callback running on a worker.
+     * @param resource Resource sending the response.
+     * @param code Code of the response.
+     * @return true if recorded, false if not called from the callback of the resource.
+     */
+    static bool defer_delayed_response(M2MResource &resource, sn_coap_msg_code_e code);
+
+    /**
+     * \brief Drops the queued callbacks of a resource being deleted and waits
+     * for its running callback, if any, to return.
+     * @param resource Resource being deleted.
+     */
+    static void cancel(M2MResource &resource);
+
+    /**
+     * \brief Runs the execute callbacks of a queued job, called on a worker.
+     * @param resource Resource the POST request was for.
+     * @param callback Execute callback of the resource, or NULL.
+     * @param callback2 Execute function of the resource, or NULL.
+     * @param value Copy of the argument of the request.
+     * @param value_length Length of the argument.
+     */
+    static void run(M2MResource &resource, execute_callback *callback, execute_callback_2 callback2,
+                    const uint8_t *value, uint16_t value_length);
+};
+
+#endif // MBED_CLIENT_EXECUTE_THREADS
+
+#endif // M2M_EXECUTE_POOL_H
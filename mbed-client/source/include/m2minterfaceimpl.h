@@ -341,6 +341,26 @@ public:
      */
     virtual void set_cid_value(const uint8_t *data_ptr, const size_t data_len);
 
+#if MBED_CLIENT_LWM2M_SEND_SAMPLES
+    virtual bool add_send_path(M2MBase *base);
+
+    virtual void remove_send_path(M2MBase *base);
+
+    virtual void set_send_storage(send_storage_load_cb load_cb, send_storage_save_cb save_cb, void *context);
+#endif
+
+#if MBED_CLIENT_REGISTRATION_RESUME
+    virtual void set_registration_storage(registration_storage_load_cb load_cb, registration_storage_save_cb save_cb, void *context);
+#endif
+
+#if MBED_CLIENT_WAKE_WINDOW
+    virtual uint64_t next_wake_time();
+#endif
+
+#if MBED_CLIENT_LATENCY_HISTOGRAM
+    virtual void get_latency_histogram(LatencyOperation operation, uint32_t *buckets, bool reset);
+#endif
+
 protected: // From M2MNsdlObserver
 
     virtual void coap_message_ready(uint8_t *data_ptr,
@@ -581,6 +601,17 @@ private: // state machine state functions
      */
     void create_random_initial_reconnection_time();
 
+    /**
+     * Helper method for starting the retry timer of the next reconnection attempt
+     * and growing the reconnection time for the attempt after it.
+     */
+    void start_reconnection_timer();
+
+    /**
+     * Checks whether the server has asked the client to retry later, see MBED_CLIENT_SERVER_BACKOFF_HINT.
+     */
+    bool has_server_backoff_hint() const;
+
     void update_network_latency_configurations_with_rtt();
 
     /**
@@ -642,6 +673,9 @@ private:
     // Reconnection related variables (in seconds)
     uint16_t                                _initial_reconnection_time;
     uint32_t                                _reconnection_time;
+#if MBED_CLIENT_SERVER_BACKOFF_HINT
+    uint32_t                                _server_backoff_time;   // Retry delay asked by the server, 0 if none
+#endif
 
     friend class Test_M2MInterfaceImpl;
 
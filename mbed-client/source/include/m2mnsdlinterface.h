@@ -26,8 +26,10 @@
 #include "mbed-client/m2mbase.h"
 #include "mbed-client/m2mserver.h"
 #include "include/nsdllinker.h"
+#include "include/m2msamplebuffer.h"
 #include "eventOS_event.h"
 #include "pal.h"
+#include "mbed-cloud-client/PerfCounters.h"
 
 //FORWARD DECLARARTION
 class M2MSecurity;
@@ -39,6 +41,9 @@ class M2MNsdlObserver;
 class M2MServer;
 class M2MConnectionHandler;
 class M2MNotificationHandler;
+#if MBED_CLIENT_COMPOSITE_OPERATIONS
+class M2MCompositeObservation;
+#endif
 
 const int UNDEFINED_MSG_ID = -1;
 
@@ -69,6 +74,12 @@ public:
         bool                resend;
         DownloadType        download_type;
         ns_list_link_t      link;
+#if MBED_CLIENT_LATENCY_HISTOGRAM
+        uint32_t            sent_ticks;     // Event loop ticks when the request was sent
+#endif
+#if MBED_CLIENT_RESPONSE_INDEX_SIZE
+        request_context_s   *token_next;    // Next request in the same token index bucket
+#endif
     };
 
     struct nsdl_coap_data_s {
@@ -83,6 +94,13 @@ public:
         M2MBase::MessageType type;
         bool                 blockwise_used;
         ns_list_link_t       link;
+#if MBED_CLIENT_LATENCY_HISTOGRAM
+        uint32_t             sent_ticks;    // Event loop ticks when the message was sent
+#endif
+#if MBED_CLIENT_RESPONSE_INDEX_SIZE
+        coap_response_s      *id_next;      // Next response in the same message id index bucket
+        coap_response_s      *uri_next;     // Next response in the same uri index bucket
+#endif
     };
 
     typedef NS_LIST_HEAD(request_context_s, link) request_context_list_t;
@@ -374,6 +392,12 @@ public:
      */
     void stop_nsdl_execution_timer();
 
+    /**
+     * @brief Stops the NSDL execution timer without stopping the client,
+     * e.g. while in queue mode sleep. Restart with start_nsdl_execution_timer().
+     */
+    void pause_nsdl_execution_timer();
+
     /**
      * @brief Returns security object.
      * @return M2MSecurity object, contains lwm2m server information.
@@ -411,6 +435,80 @@ public:
     */
     void send_next_notification(NotificationQueueOption option);
 
+#if MBED_CLIENT_COMPOSITE_OPERATIONS
+    /**
+     * @brief Requests the notification event for a composite observation
+     * whose notification is pending.
+    */
+    void composite_notification_pending();
+#endif
+
+#if MBED_CLIENT_LWM2M_SEND_SAMPLES
+    /**
+     * @brief Starts recording value changes under the path for the Send operation.
+     * @return false if already added or out of memory.
+    */
+    bool add_send_path(M2MBase *base);
+
+    /**
+     * @brief Stops recording value changes under the path.
+    */
+    void remove_send_path(M2MBase *base);
+
+    /**
+     * @brief Sets the storage of the Send buffer and loads the stored samples.
+    */
+    void set_send_storage(send_storage_load_cb load_cb, send_storage_save_cb save_cb, void *context);
+#endif
+
+#if MBED_CLIENT_SERVER_BACKOFF_HINT
+    /**
+     * @brief Returns the retry delay in seconds given by the server in the latest 5.03
+     * response to registration or registration update, 0 if none.
+    */
+    uint32_t server_backoff_hint() const;
+
+    /**
+     * @brief Returns the retry delay like server_backoff_hint() and forgets it.
+    */
+    uint32_t take_server_backoff_hint();
+#endif
+
+#if MBED_CLIENT_LATENCY_HISTOGRAM
+    /**
+     * @brief Copies the latency histogram of an operation, see M2MInterface::get_latency_histogram().
+    */
+    void get_latency_histogram(M2MInterface::LatencyOperation operation, uint32_t *buckets, bool reset);
+#endif
+
+#if MBED_CLIENT_REGISTRATION_RESUME
+    /**
+     * @brief Sets the storage of the registration, the stored one is resumed on first registration.
+    */
+    void set_registration_storage(registration_storage_load_cb load_cb, registration_storage_save_cb save_cb, void *context);
+
+    /**
+     * @brief Restores the stored registration, if the registration has not changed since it was made.
+     * Only tried for the first registration after the storage is set.
+     * @return True if the registration is to be refreshed with send_update_registration().
+    */
+    bool resume_registration();
+#endif
+
+#if MBED_CLIENT_WAKE_WINDOW
+    /**
+     * @brief Returns the time in milliseconds until the client needs the
+     * network next, UINT64_MAX if nothing is scheduled.
+    */
+    uint64_t next_wake_time();
+
+    /**
+     * @brief Indicates that data was sent. Sends soon the registration
+     * update and the pmax reports due within MBED_CLIENT_WAKE_WINDOW.
+    */
+    void wake_window_opened();
+#endif
+
 #ifndef MBED_CLIENT_DISABLE_BOOTSTRAP_FEATURE
     /**
      * @brief Store the "BS finished" response id.
@@ -512,6 +610,11 @@ protected: // from M2MObservationHandler
     virtual void value_updated(M2MBase *base);
 
     virtual void remove_object(M2MBase *object);
+
+#if MBED_CLIENT_COMPOSITE_OPERATIONS || MBED_CLIENT_LWM2M_SEND_SAMPLES
+    virtual void value_changed(M2MBase *base);
+#endif
+
 #ifndef DISABLE_DELAYED_RESPONSE
     virtual void send_delayed_response(M2MBase *base, sn_coap_msg_code_e code = COAP_MSG_CODE_RESPONSE_CHANGED);
 #endif //DISABLE_DELAYED_RESPONSE
@@ -570,6 +673,20 @@ private:
 
     M2MBase *find_resource(const String &object) const;
 
+    /**
+     * \brief Resolves "object/instance/resource/resource_instance" path by
+     * splitting it once and descending the object tree level by level.
+     * \param path, Path to resolve.
+     * \param found[OUT], Matching object, instance or resource, NULL if not found.
+     * \return false if the path cannot be resolved this way and the full tree
+     * walk must be used instead.
+     */
+    bool resolve_resource_path(const char *path, M2MBase *&found) const;
+
+    static bool path_component_to_id(const char *component, size_t length, uint16_t &id);
+
+    static bool path_component_matches(const char *name, const char *component, size_t length);
+
 #ifdef MBED_CLOUD_CLIENT_EDGE_EXTENSION
     M2MBase *find_resource(const M2MEndpoint *endpoint,
                            const String &object_name) const;
@@ -601,6 +718,31 @@ private:
 
     void send_resource_observation(M2MResource *resource, uint16_t obs_number);
 
+#if MBED_CLIENT_OBSERVATION_DIFF
+    /**
+     * \brief Adds the resources of the object instance changed since its last
+     * notification to the list, or the instance itself when a full snapshot is due.
+     * \return true if only the changed resources were added.
+     */
+    static bool add_changed_resources(M2MObjectInstance &object_instance, M2MBaseList &list);
+#endif
+
+#if MBED_CLIENT_WAKE_WINDOW
+    void send_due_within_wake_window();
+#endif
+
+#ifndef DISABLE_BLOCK_MESSAGE
+    /**
+     * @brief Sends a notification of a resource read through a callback. Only
+     * the first block is read, the server requests the rest blockwise.
+     */
+    void send_streamed_resource_observation(M2MResource *resource,
+                                            uint16_t obs_number,
+                                            uint8_t *token,
+                                            uint8_t token_length,
+                                            uint16_t content_type);
+#endif
+
 
 
     /**
@@ -689,6 +831,13 @@ private:
     */
     bool parse_and_send_uri_query_parameters();
 
+    /**
+     * @brief Builds the URI query parameters of registration from the server address.
+     * @param query_params Destination, MAX_URI_QUERY_LEN bytes.
+     * @return False if the server address has no parameters or they do not fit.
+    */
+    bool build_uri_query_parameters(char *query_params);
+
     /**
      * @brief Callback function that triggers the registration update call.
      * @param argument, Arguments part of the POST request.
@@ -721,10 +870,114 @@ private:
     bool send_next_notification_for_object(M2MObject &object, NotificationQueueOption option);
     bool handle_notification_queue(M2MObject &object, NotificationQueueOption option);
 
+#if MBED_CLIENT_COMPOSITE_OPERATIONS
+    /**
+     * @brief Handles a FETCH request, i.e. Read-Composite, Observe-Composite or
+     * cancellation of a composite observation, and sends the response.
+     * @param coap_header Received request.
+     * @param address Address of the server.
+     * @return 0 if the response was sent, otherwise 1.
+     */
+    uint8_t handle_composite_request(sn_coap_hdr_s *coap_header, sn_nsdl_addr_s *address);
+
+    /**
+     * @brief SenML path list callback, adds the base found with the path to the list
+     * given as context.
+     */
+    static bool add_composite_path(const char *path, void *context);
+
+    M2MCompositeObservation *find_composite_observation(const uint8_t *token, uint8_t token_length) const;
+
+    void delete_composite_observation(M2MCompositeObservation *observation);
+
+    void clear_composite_observations();
+
+    void send_composite_notification(M2MCompositeObservation &observation);
+
+    /**
+     * @brief Cancels the composite observation whose notification got reset.
+     * @return true if msg_id belonged to a composite notification.
+     */
+    bool handle_composite_notification_reset(int32_t msg_id);
+#endif
+
+#if MBED_CLIENT_LWM2M_SEND_SAMPLES
+    /**
+     * @brief Checks whether the resource or resource instance is one of the
+     * Send paths or below one of them.
+     */
+    bool is_send_path(const M2MBase &base) const;
+
+    /**
+     * @brief Stores the current value of the resource or resource instance
+     * as a sample and sends the samples if possible.
+     */
+    void record_sample(const M2MResourceBase &resource);
+
+    /**
+     * @brief Sends the oldest samples with the Send operation, unless a Send
+     * request is already ongoing, the client is not registered or the rate
+     * limit is in effect, in which case the send timer is started.
+     */
+    void send_samples();
+
+    /**
+     * @brief Checks whether the message is the response to the ongoing Send request.
+     */
+    bool is_send_response(const sn_coap_hdr_s *coap_header) const;
+
+    void handle_send_response(const sn_coap_hdr_s *coap_header);
+
+    /**
+     * @brief Stores the samples with the storage callback, if one is set.
+     */
+    void save_samples();
+#endif
+
+#if MBED_CLIENT_REGISTRATION_RESUME
+    /**
+     * @brief Stores fingerprint and location of the registration with the storage callback, if one is set.
+     */
+    void save_registration();
+#endif
+
+#if MBED_CLIENT_SERVER_BACKOFF_HINT
+    /**
+     * @brief Takes the Max-Age of a 5.03 response as the retry delay asked by the server.
+     * @return True if the response was 5.03.
+     */
+    bool store_server_backoff_hint(const sn_coap_hdr_s *coap_header);
+#endif
+
+#if MBED_CLIENT_LATENCY_HISTOGRAM
+    /**
+     * @brief Adds the time since the given event loop ticks to the histogram of the operation.
+    */
+    void record_latency(M2MInterface::LatencyOperation operation, uint32_t sent_ticks);
+#endif
+
     static char *parse_uri_query_parameters(char *uri);
 
     void send_coap_ping();
 
+#if PERF_COUNTERS_ENABLED
+    // Adds the CoAP retransmissions since the previous call to the performance counters
+    void publish_coap_stats();
+#endif
+
+    /**
+     * @brief Adds the time passed since the NSDL execution timer was armed
+     * to the NSDL time, so that messages built now are timed correctly.
+     */
+    void update_nsdl_time();
+
+    /**
+     * @brief Arms the NSDL execution timer for the next time CoAP or CoAP ping has work to do.
+     * @param only_if_earlier If true, the timer is re-armed only when the work is due
+     * before the timer would expire anyway.
+     */
+    void schedule_nsdl_execution(bool only_if_earlier);
+
     void send_empty_ack(const sn_coap_hdr_s *header, sn_nsdl_addr_s *address);
 
     struct M2MNsdlInterface::nsdl_coap_data_s *create_coap_event_data(sn_coap_hdr_s *received_coap_header,
@@ -758,6 +1011,24 @@ private:
 
     struct coap_response_s *find_response(int32_t msg_id);
 
+    request_context_s *find_request(const uint8_t *token);
+
+    void remove_request(request_context_s *request);
+
+    void remove_response(coap_response_s *response);
+
+    void set_response_msg_id(coap_response_s *response, int32_t msg_id);
+
+#if MBED_CLIENT_RESPONSE_INDEX_SIZE
+    static uint16_t index_bucket(uint32_t key);
+
+    static uint16_t index_uri_bucket(const char *uri_path);
+
+    void response_id_index_add(coap_response_s *response);
+
+    void response_id_index_remove(coap_response_s *response);
+#endif
+
 #if !defined(DISABLE_DELAYED_RESPONSE) || defined(ENABLE_ASYNC_REST_RESPONSE)
     struct coap_response_s *find_delayed_response(const char *uri_path,
                                                   const M2MBase::MessageType type,
@@ -795,9 +1066,17 @@ private:
     String                                  _internal_endpoint_name;
     uint32_t                                _counter_for_nsdl;
     uint32_t                                _next_coap_ping_send_time;
+    uint32_t                                _nsdl_execution_interval; // seconds, 0 when timer is not armed
+    uint32_t                                _nsdl_execution_elapsed; // seconds of the interval added to _counter_for_nsdl
+    uint16_t                                _nsdl_execution_phase; // milliseconds of the second passed before arming
     char                                    *_server_address; // BS or M2M address
     request_context_list_t                  _request_context_list;
     response_list_t                         _response_list;
+#if MBED_CLIENT_RESPONSE_INDEX_SIZE
+    request_context_s                       *_request_token_index[MBED_CLIENT_RESPONSE_INDEX_SIZE];
+    coap_response_s                         *_response_id_index[MBED_CLIENT_RESPONSE_INDEX_SIZE];
+    coap_response_s                         *_response_uri_index[MBED_CLIENT_RESPONSE_INDEX_SIZE];
+#endif
     char                                    *_custom_uri_query_params;
     M2MNotificationHandler                  *_notification_handler;
     arm_event_storage_t                     _event;
@@ -816,6 +1095,41 @@ private:
     bool                                    _alert_mode;
     NotificationQueueOption                 _last_notif_queue_event;
     sn_coap_msg_code_e                      _current_request_code;
+#if MBED_CLIENT_COMPOSITE_OPERATIONS
+    m2m::Vector<M2MCompositeObservation *>  _composite_observations;
+#endif
+#if MBED_CLIENT_LWM2M_SEND_SAMPLES
+    M2MSampleBuffer                         _send_samples;
+    M2MBaseList                             _send_paths;
+    M2MTimer                                _send_timer;
+    send_storage_load_cb                    _send_load_cb;
+    send_storage_save_cb                    _send_save_cb;
+    void                                    *_send_storage_context;
+    uint32_t                                _send_token;            // Token of the ongoing Send request, 0 if none
+    uint32_t                                _next_send_time;        // NSDL time, in seconds, of the earliest next Send
+    uint16_t                                _send_in_flight;        // Samples in the ongoing Send request
+#endif
+#if MBED_CLIENT_REGISTRATION_RESUME
+    registration_storage_load_cb            _registration_load_cb;
+    registration_storage_save_cb            _registration_save_cb;
+    void                                    *_registration_storage_context;
+    bool                                    _registration_resume_pending;   // Stored registration not yet tried
+    bool                                    _registration_resumed;          // Waiting for the update of a resumed registration
+#endif
+#if MBED_CLIENT_SERVER_BACKOFF_HINT
+    uint32_t                                _server_backoff_hint;           // Seconds, from Max-Age of 5.03 response
+#endif
+#if MBED_CLIENT_LATENCY_HISTOGRAM
+    uint32_t                                _latency_histogram[M2MInterface::LatencyOperationCount][M2M_LATENCY_HISTOGRAM_BUCKETS];
+    uint32_t                                _register_sent_ticks;
+    uint32_t                                _update_sent_ticks;
+#endif
+#if MBED_CLIENT_WAKE_WINDOW
+    M2MTimer                                _wake_window_timer;
+#endif
+#if PERF_COUNTERS_ENABLED
+    sn_coap_exchange_stats_s                _coap_stats_published;
+#endif
 
     friend class Test_M2MNsdlInterface;
 
@@ -26,8 +26,12 @@
 #include "mbed-client/m2mresourceinstance.h"
 #include "mbed-client/m2mvector.h"
 #include "mbed-client/m2mtimer.h"
+#if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1) && (MBED_CLIENT_REPORT_TIMER_TOLERANCE > 0)
+#include "include/m2mreportscheduler.h"
+#endif
 
 //FORWARD DECLARATION
+struct query_parameter_s;
 class M2MReportObserver;
 class M2MTimer;
 class M2MResourceInstance;
@@ -52,6 +56,30 @@ typedef union low_step_u {
     float   float_value;
     int64_t int_value;
 } low_step_t;
+
+// Bits of the compiled notification attributes, set for each attribute that limits notifications
+#define REPORT_CHECK_GT     0x01
+#define REPORT_CHECK_LT     0x02
+#define REPORT_CHECK_ST     0x04
+
+/**
+ * gt, lt and st compiled at write-attributes time for the float value path.
+ */
+typedef struct float_predicate_s {
+    float   gt;
+    float   lt;
+} float_predicate_t;
+
+/**
+ * gt, lt and st compiled at write-attributes time for the integer value path.
+ * The thresholds are rounded, so that the value is compared as an integer:
+ * value > gt is value > floor(gt) and value < lt is value < ceil(lt).
+ */
+typedef struct int_predicate_s {
+    int64_t gt;
+    int64_t lt;
+    int64_t st; // ceil(st)
+} int_predicate_t;
 #endif
 /**
  *  @brief M2MReportHandler.
@@ -116,6 +144,13 @@ public:
      */
     void set_notification_trigger(uint16_t obj_instance_id = 0);
 
+    /**
+     * @brief Sets notification trigger for several object instances at once,
+     * so that they are reported in one notification.
+     * @param obj_instance_ids, Object instance ids that have changed
+     */
+    void set_notification_trigger(const m2m::Vector<uint16_t> &obj_instance_ids);
+
 #if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1)
     /**
      * @brief Parses the received query for notification
@@ -252,6 +287,23 @@ public:
      */
     bool notification_send_in_progress() const;
 
+#if MBED_CLIENT_NOTIFICATION_QUEUE
+    /**
+     * @brief Returns the first report handler under observation with a queued
+     * notification or a notification in progress, in the order they were queued.
+     * Handlers no longer waiting are dropped from the queue on the way.
+     *
+     * @return The report handler, or NULL if there is none.
+     */
+    static M2MReportHandler *next_queued_notification();
+
+    /**
+     * @brief Moves the handler to the end of the queue if its notification is still
+     * waiting, or drops it from the queue.
+     */
+    void requeue_notification();
+#endif
+
     /**
      * @brief Sets whether notification will be sent using blockwise or not.
      *
@@ -287,6 +339,22 @@ public:
      */
     bool is_confirmable() const;
 
+#if MBED_CLIENT_ADAPTIVE_CONFIRMABLE
+    /**
+     * @brief Sends non-confirmable notifications with a confirmable one at least every
+     * con_every notifications or con_interval seconds. Both 0 return to set_confirmable().
+     *
+     * @param con_every Every how manyth notification is confirmable, 0 for no limit.
+     * @param con_interval Maximum seconds between confirmable notifications, 0 for no limit.
+     */
+    void set_confirmable_policy(uint16_t con_every, uint16_t con_interval);
+
+    /**
+     * @brief Makes the next notification confirmable, as the last one was not delivered.
+     */
+    void notification_lost();
+#endif
+
 #if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1)
     /**
      * @brief Start the pmin and pmax timers without setting object under observation
@@ -307,11 +375,31 @@ protected : // from M2MTimerObserver
 private:
 
 #if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1)
-    bool set_notification_attribute(const char *option,
+    bool set_notification_attribute(const query_parameter_s &parameter,
                                     M2MBase::BaseType type,
                                     M2MResourceInstance::ResourceType resource_type);
+
+    /**
+    * @brief Returns the WriteAttribute named by the parameter key, 0 if the name is unknown.
+    */
+    static uint8_t find_write_attribute(const query_parameter_s &parameter);
+
+    /**
+    * @brief Compiles gt, lt and st into the predicate of the value type.
+    */
+    void compile_predicate();
 #endif
 
+    /**
+    * @brief Adds an object instance to the changed ones, if not there yet.
+    */
+    void add_changed_instance_id(uint16_t obj_instance_id);
+
+    /**
+    * @brief Schedules the notification of the changed object instances.
+    */
+    void trigger_notification();
+
     /**
     * @brief Reports a sample that satisfies the reporting criteria.
     *
@@ -320,6 +408,18 @@ private:
     */
     void report(bool in_queue = false);
 
+#if MBED_CLIENT_ADAPTIVE_CONFIRMABLE
+    /**
+    * @brief Picks the message type of the next notification by the policy.
+    */
+    void select_message_type();
+
+    /**
+    * @brief Updates the policy state after a notification was sent.
+    */
+    void message_type_sent();
+#endif
+
 #if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1)
     /**
     * @brief Manage timers for pmin and pmax.
@@ -334,16 +434,16 @@ private:
 
 
     /**
-     * @brief Check if current value match threshold values.
+     * @brief Check if the new float value matches gt, lt and st.
      * @return True if notify can be send otherwise false.
      */
-    bool check_threshold_values() const;
+    bool check_float_value(float value) const;
 
     /**
-     * @brief Check whether current value matches with GT & LT.
-     * @return True if current value match with GT or LT values.
+     * @brief Check if the new integer value matches gt, lt and st.
+     * @return True if notify can be send otherwise false.
      */
-    bool check_gt_lt_params() const;
+    bool check_int_value(int64_t value) const;
 #endif
 
     /**
@@ -355,8 +455,21 @@ private:
 
     /**
      * \brief New value is ready to be sent.
+     * \param in_range True if the value matches the notification attributes.
+    */
+    void send_value(bool in_range);
+
+#if MBED_CLIENT_NOTIFICATION_QUEUE
+    /**
+     * \brief Appends the handler to the queue of waiting notifications, if not there yet.
+    */
+    void queue_notification();
+
+    /**
+     * \brief Removes the handler from the queue of waiting notifications.
     */
-    void send_value();
+    void unqueue_notification();
+#endif
 
 private:
     M2MReportObserver           &_observer;
@@ -374,8 +487,13 @@ private:
 #endif
     unsigned                    _observation_number : 24;
 #if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1)
+#if MBED_CLIENT_REPORT_TIMER_TOLERANCE > 0
+    M2MReportScheduler::Entry   _pmin_timer;
+    M2MReportScheduler::Entry   _pmax_timer;
+#else
     M2MTimer                    _pmin_timer;
     M2MTimer                    _pmax_timer;
+#endif
     int32_t                     _pmax;
     int32_t                     _pmin;
     high_step_t                 _high_step;
@@ -384,6 +502,11 @@ private:
     float                       _gt;
     float                       _lt;
     float                       _st;
+    union {
+        float_predicate_t       float_predicate;
+        int_predicate_t         int_predicate;
+    }                           _predicate;
+    uint8_t                     _predicate_checks;
     bool                        _last_value_valid;
 #endif
     uint8_t                     *_token;
@@ -396,10 +519,27 @@ private:
     bool                        _blockwise_notify : 1;
 #if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1)
     bool                        _pmin_quiet_period : 1;
+#endif
+#if MBED_CLIENT_NOTIFICATION_QUEUE
+    bool                        _notification_queued : 1;
 #endif
     bool                        _waiting_to_report;
     bool                        _confirmable;
+#if MBED_CLIENT_ADAPTIVE_CONFIRMABLE
+    bool                        _con_current : 1;       // Type of the notification being sent
+    bool                        _con_escalated : 1;     // Next notification is confirmable
+    uint16_t                    _con_every;
+    uint16_t                    _con_interval;
+    uint16_t                    _non_count;             // Non-confirmable notifications since the last confirmable one
+    uint32_t                    _con_ticks;             // Time of the last confirmable notification
+#endif
     M2MResourceBase             *_resource_base;
+#if MBED_CLIENT_NOTIFICATION_QUEUE
+    M2MReportHandler            *_queue_prev;
+    M2MReportHandler            *_queue_next;
+    static M2MReportHandler     *_queue_head;
+    static M2MReportHandler     *_queue_tail;
+#endif
     friend class Test_M2MReportHandler;
     friend class Test_M2MResourceInstance;
 };
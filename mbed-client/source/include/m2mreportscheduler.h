@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2021 Pelion. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef M2M_REPORT_SCHEDULER_H
+#define M2M_REPORT_SCHEDULER_H
+
+#include <stdint.h>
+#include "mbed-client/m2mconfig.h"
+#include "mbed-client/m2mtimer.h"
+#include "mbed-client/m2mtimerobserver.h"
+
+#if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1) && (MBED_CLIENT_REPORT_TIMER_TOLERANCE > 0)
+
+/**
+ * @brief M2MReportScheduler
+ * Shared timer for the pmin and pmax periods of all report handlers.
+ * Deadlines are rounded to multiples of MBED_CLIENT_REPORT_TIMER_TOLERANCE
+ * and kept in one list sorted by deadline, so a single event loop timer is
+ * armed for the earliest bucket and every entry due in it expires in the
+ * same pass. The notifications the expirations trigger then go out through
+ * the normal notification queue one after another.
+ */
+class M2MReportScheduler : public M2MTimerObserver {
+
+public:
+
+    /**
+     * @brief Schedulable deadline, owned by the object that observes it.
+     * Used in place of a M2MTimer, it is unscheduled automatically when
+     * destroyed.
+     */
+    class Entry {
+
+    public:
+
+        /**
+         * \brief Constructor.
+         * @param observer Observer notified when the deadline is reached.
+         * @param type Type given to the observer, PMaxTimer deadlines are
+         * rounded down, all others up.
+         */
+        Entry(M2MTimerObserver &observer, M2MTimerObserver::Type type);
+
+        ~Entry();
+
+        /**
+         * \brief Schedules the entry, replacing an earlier deadline if any.
+         * @param interval Time from now in milliseconds.
+         */
+        void start_timer(uint64_t interval);
+
+        /**
+         * \brief Unschedules the entry.
+         */
+        void stop_timer();
+
+    private:
+
+        M2MTimerObserver        &_observer;
+        Entry                   *_prev;
+        Entry                   *_next;
+        uint64_t                _still_left;
+        uint32_t                _deadline;
+        M2MTimerObserver::Type  _type;
+        bool                    _scheduled;
+        bool                    _expire_early;
+
+        friend class M2MReportScheduler;
+    };
+
+    /**
+     * \brief Returns the scheduler instance, creating it on first use.
+     */
+    static M2MReportScheduler *get_instance();
+
+    /**
+     * \brief Deletes the scheduler instance. Entries still scheduled are
+     * dropped without being expired.
+     */
+    static void delete_instance();
+
+    /**
+     * \brief Takes a reference to the scheduler, which is shared by all
+     * client instances of the process.
+     */
+    static void acquire_instance();
+
+    /**
+     * \brief Releases a reference taken with acquire_instance(). The
+     * scheduler is deleted with the last reference.
+     */
+    static void release_instance();
+
+#if MBED_CLIENT_WAKE_WINDOW
+    /**
+     * \brief Returns the time until the earliest deadline.
+     * \return Time in milliseconds, UINT64_MAX if nothing is scheduled.
+     */
+    uint64_t time_to_next_deadline() const;
+
+    /**
+     * \brief Expires now the pmax deadlines due within the given time, so
+     * that their reports go out while the radio is on anyway. The report
+     * handlers still hold back a report whose pmin has not passed.
+     * @param window Time from now in milliseconds.
+     */
+    void expire_pmax_early(uint64_t window);
+#endif
+
+protected: // from M2MTimerObserver
+
+    virtual void timer_expired(M2MTimerObserver::Type type);
+
+private:
+
+    M2MReportScheduler();
+
+    virtual ~M2MReportScheduler();
+
+    void schedule(Entry &entry, uint64_t interval);
+
+    void unschedule(Entry &entry);
+
+    void insert(Entry &entry);
+
+    void arm_timer();
+
+private:
+
+    static M2MReportScheduler   *_static_instance;
+    static uint16_t             _references;
+
+    M2MTimer                    _timer;
+    Entry                       *_head;
+    Entry                       *_tail;
+    uint32_t                    _armed_deadline;
+    bool                        _armed;
+    bool                        _dispatching;
+};
+
+#endif // MBED_CLIENT_REPORT_TIMER_TOLERANCE
+
+#endif // M2M_REPORT_SCHEDULER_H
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2021 Pelion. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef M2M_SAMPLE_BUFFER_H
+#define M2M_SAMPLE_BUFFER_H
+
+#include "mbed-client/m2mconfig.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if MBED_CLIENT_LWM2M_SEND_SAMPLES
+
+class M2MResourceBase;
+
+// Resource instance ID of a sample taken from a single instance resource
+#define M2M_SAMPLE_NO_INSTANCE 0xFFFF
+
+/**
+ * \brief One timestamped resource value. The path is stored as IDs, so that
+ * the sample stays valid when stored over a reset.
+ */
+typedef struct m2m_sample_s {
+    union {
+        int64_t     int_value;          // INTEGER, BOOLEAN and TIME
+        float       float_value;        // FLOAT
+    } value;
+    uint32_t        time;               // Seconds since epoch, or since start if absolute_time is not set
+    uint16_t        object_id;
+    uint16_t        object_instance_id;
+    uint16_t        resource_id;
+    uint16_t        resource_instance_id;
+    uint8_t         type;               // M2MResourceBase::ResourceType
+    uint8_t         absolute_time;
+} m2m_sample_s;
+
+/**
+ * @brief M2MSampleBuffer
+ * Fixed size ring buffer of the samples waiting for the LwM2M Send operation.
+ * When full, a new sample replaces the oldest one.
+ */
+class M2MSampleBuffer {
+
+private:
+    // Prevents the use of assignment operator by accident.
+    M2MSampleBuffer &operator=(const M2MSampleBuffer & /*other*/);
+
+    // Prevents the use of copy constructor by accident
+    M2MSampleBuffer(const M2MSampleBuffer & /*other*/);
+
+public:
+
+    M2MSampleBuffer();
+
+    /**
+     * \brief Fills a sample from the current value of the resource.
+     * @param resource Resource or resource instance.
+     * @param time Timestamp of the sample.
+     * @param absolute_time true if time is seconds since epoch.
+     * @param sample Filled sample.
+     * \return false if the value type can not be sampled.
+     */
+    static bool make_sample(const M2MResourceBase &resource, uint32_t time, bool absolute_time, m2m_sample_s &sample);
+
+    /**
+     * \brief Adds a sample as the newest one.
+     * \return false if the oldest sample was dropped to make room.
+     */
+    bool push(const m2m_sample_s &sample);
+
+    /**
+     * \brief Removes the given number of the oldest samples.
+     */
+    void pop(uint16_t count);
+
+    /**
+     * \brief Returns the number of samples.
+     */
+    uint16_t count() const;
+
+    /**
+     * \brief Returns a sample, 0 being the oldest.
+     */
+    const m2m_sample_s &sample(uint16_t index) const;
+
+    /**
+     * \brief Returns the size of the stored form with the current samples.
+     */
+    size_t storage_size() const;
+
+    /**
+     * \brief Writes the samples, oldest first, in the stored form.
+     * @param buffer Buffer of at least storage_size() bytes.
+     * \return Number of bytes written.
+     */
+    size_t save(uint8_t *buffer) const;
+
+    /**
+     * \brief Replaces the samples with the ones in the stored form. Samples
+     * without absolute time are dropped, as the time since start is not
+     * meaningful after a reset.
+     * \return false if the data is not a stored sample buffer.
+     */
+    bool load(const uint8_t *buffer, size_t size);
+
+    /**
+     * \brief Maximum size of the stored form.
+     */
+    static size_t max_storage_size();
+
+private:
+
+    m2m_sample_s    _samples[MBED_CLIENT_LWM2M_SEND_SAMPLES];
+    uint16_t        _first;
+    uint16_t        _count;
+};
+
+#endif // MBED_CLIENT_LWM2M_SEND_SAMPLES
+
+#endif // M2M_SAMPLE_BUFFER_H
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2021 Pelion. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef M2M_SENML_CBOR_SERIALIZER_H
+#define M2M_SENML_CBOR_SERIALIZER_H
+
+#include "mbed-client/m2mobject.h"
+#include "mbed-client/m2mobjectinstance.h"
+#include "mbed-client/m2mresource.h"
+#include "mbed-client/m2minterface.h"
+#include "include/m2msamplebuffer.h"
+
+#if defined (MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR) && (MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR == 1)
+
+struct CborEncoder;
+
+/**
+ * @brief M2MSenMLCborSerializer
+ * Constructs SenML-CBOR (RFC 8428, content format 112) representation of object
+ * instances and resources. All resource values of the given instances are packed
+ * as records of one SenML pack, with the object or object instance path as the
+ * base name of the first record.
+ */
+class M2MSenMLCborSerializer {
+
+public:
+
+    /**
+     * \brief Serializes given object instances of an object. Record names are
+     * relative to "/<object>/", e.g. "0/5700" or "0/5701/1" for resource instances.
+     * @param object Parent object of the instances.
+     * @param object_instance_list List of object instances to serialize.
+     * @param size Updated to length of the data returned.
+     * \return NULL if allocation failed or there is nothing to serialize,
+     * otherwise allocated payload which must be freed by the caller.
+     */
+    static uint8_t *serialize(const M2MObject &object, const M2MObjectInstanceList &object_instance_list, uint32_t &size);
+
+    /**
+     * \brief Serializes resources of given object instance. Record names are
+     * relative to "/<object>/<instance>/", e.g. "5700" or "5701/1".
+     * @param object_instance Object instance to serialize.
+     * @param size Updated to length of the data returned.
+     * \return NULL if allocation failed or there is nothing to serialize,
+     * otherwise allocated payload which must be freed by the caller.
+     */
+    static uint8_t *serialize(const M2MObjectInstance &object_instance, uint32_t &size);
+
+#if MBED_CLIENT_COMPOSITE_OPERATIONS || MBED_CLIENT_OBSERVATION_DIFF
+    /**
+     * \brief Serializes the readable resources under the given paths, which may
+     * be objects, object instances, resources or resource instances. Base name
+     * is "/" and record names are full paths, e.g. "3303/0/5700".
+     * @param base_list Paths of a composite read or observation, or the changed
+     * resources of a partial notification.
+     * @param size Updated to length of the data returned.
+     * \return NULL if allocation failed or there is nothing to serialize,
+     * otherwise allocated payload which must be freed by the caller.
+     */
+    static uint8_t *serialize(const M2MBaseList &base_list, uint32_t &size);
+#endif
+
+#if MBED_CLIENT_COMPOSITE_OPERATIONS
+    /**
+     * \brief Callback receiving one path of a SenML-CBOR path list.
+     * @param path Path without the leading '/', e.g. "3303/0/5700".
+     * @param context Context given to parse_path_list().
+     * \return false to stop parsing.
+     */
+    typedef bool (*path_callback)(const char *path, void *context);
+
+    /**
+     * \brief Parses the path list of a composite request, a SenML pack whose
+     * records hold only base name and name. The path of a record is the base
+     * name in effect concatenated with the name of the record.
+     * @param data SenML-CBOR payload.
+     * @param size Length of the payload.
+     * @param callback Called once per path, in order.
+     * @param context Passed to the callback.
+     * \return false if the payload is malformed, a path is too long or the
+     * callback stopped parsing.
+     */
+    static bool parse_path_list(const uint8_t *data, uint32_t size, path_callback callback, void *context);
+#endif
+
+#if MBED_CLIENT_LWM2M_SEND_SAMPLES
+    /**
+     * \brief Serializes the oldest samples of the buffer for the LwM2M Send
+     * operation. Base name is "/" and record names are full paths. Time of a
+     * sample without absolute time is written relative to now, i.e. negative.
+     * @param buffer Samples to send.
+     * @param count Number of the oldest samples to serialize.
+     * @param now Current time, in the time base of the relative samples.
+     * @param size Updated to length of the data returned.
+     * \return NULL if allocation failed, otherwise allocated payload which
+     * must be freed by the caller.
+     */
+    static uint8_t *serialize(const M2MSampleBuffer &buffer, uint16_t count, uint32_t now, uint32_t &size);
+#endif
+
+private:
+
+    static uint8_t *serialize(const M2MBase *base, const M2MObjectInstanceList *object_instance_list,
+                              const M2MResourceList *resource_list, const M2MBaseList *base_list, uint32_t &size);
+
+    static bool encode_pack(CborEncoder &encoder, const M2MBase *base, const M2MObjectInstanceList *object_instance_list,
+                            const M2MResourceList *resource_list, const M2MBaseList *base_list);
+
+#if MBED_CLIENT_COMPOSITE_OPERATIONS || MBED_CLIENT_OBSERVATION_DIFF
+    static bool encode_base(CborEncoder &pack, const char *&base_name, const M2MBase &base);
+#endif
+
+#if MBED_CLIENT_LWM2M_SEND_SAMPLES
+    static bool encode_samples(CborEncoder &encoder, const M2MSampleBuffer &buffer, uint16_t count, uint32_t now);
+#endif
+
+    static bool encode_resources(CborEncoder &pack, const char *&base_name, char *name, size_t name_len,
+                                 const M2MResourceList &resource_list);
+
+    static bool encode_resource(CborEncoder &pack, const char *&base_name, char *name, size_t name_len,
+                                const M2MResource &resource);
+
+    static bool encode_record(CborEncoder &pack, const char *&base_name, const char *name,
+                              const M2MResourceBase &resource);
+};
+
+#endif // MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR
+
+#endif // M2M_SENML_CBOR_SERIALIZER_H
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2021 Pelion. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef M2M_SHARED_STRING_H
+#define M2M_SHARED_STRING_H
+
+#include "mbed-client/m2mconfig.h"
+
+#include <stddef.h>
+
+#if MBED_CLIENT_SHARED_RESOURCE_STRINGS
+
+/**
+ * @brief M2MSharedString
+ * Reference counted copies of the strings describing resources. The same
+ * resource type or name is typically used by every instance of an object,
+ * so a gateway with hundreds of instances keeps one copy of each string.
+ * The strings are immutable, a resource changing its resource type releases
+ * the old string and acquires the new one.
+ */
+class M2MSharedString {
+
+public:
+
+    /**
+     * \brief Returns a zero terminated copy of the string, shared with the
+     * other holders of the same string.
+     * @param str The string, does not need to be zero terminated.
+     * @param length Length of the string.
+     * @return The shared copy, NULL if out of memory.
+     */
+    static char *acquire(const char *str, size_t length);
+
+    /**
+     * \brief Releases a string returned by acquire(), the copy is freed with
+     * its last holder. A string not acquired from here is freed.
+     * @param str The string, may be NULL.
+     */
+    static void release(char *str);
+};
+
+#endif // MBED_CLIENT_SHARED_RESOURCE_STRINGS
+
+#endif // M2M_SHARED_STRING_H
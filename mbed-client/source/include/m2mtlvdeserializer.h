@@ -43,6 +43,16 @@ public :
         Post
     } Operation;
 
+    /**
+     * One TLV entry. The value points into the deserialized buffer, nothing is copied.
+     */
+    typedef struct {
+        uint8_t         type;   ///< TYPE_OBJECT_INSTANCE, TYPE_RESOURCE_INSTANCE, TYPE_MULTIPLE_RESOURCE or TYPE_RESOURCE.
+        uint16_t        id;     ///< Object instance, resource or resource instance ID.
+        const uint8_t   *value; ///< Value, or the nested entries of an object instance or a multiple resource.
+        uint32_t        length; ///< Length of the value.
+    } Entry;
+
 
     /**
      * This method checks whether the given binary encodes an object instance
@@ -122,6 +132,18 @@ public :
      */
     static uint16_t instance_id(const uint8_t *tlv);
 
+    /**
+     * Reads the TLV entry at the given offset. Nested entries of an object instance
+     * or a multiple resource are read by calling this again with the entry value
+     * as the buffer.
+     * @param tlv Binary to read.
+     * @param tlv_size Size of the binary.
+     * @param offset Offset of the entry, on success moved to the next entry.
+     * @param entry Read entry.
+     * @return <code>false</code> at the end of the binary or if the entry does not fit in it.
+     */
+    static bool next_entry(const uint8_t *tlv, uint32_t tlv_size, uint32_t &offset, M2MTLVDeserializer::Entry &entry);
+
 private:
 
     static M2MTLVDeserializer::Error deserialize_object_instances(const uint8_t *tlv,
@@ -138,6 +160,11 @@ private:
                                                     M2MTLVDeserializer::Operation operation,
                                                     bool update_value);
 
+    static M2MTLVDeserializer::Error deserialize_resource_entry(const M2MTLVDeserializer::Entry &entry,
+                                                         M2MObjectInstance &object_instance,
+                                                         M2MTLVDeserializer::Operation operation,
+                                                         bool update_value);
+
     static M2MTLVDeserializer::Error deserialize_resource(const uint8_t *tlv,
                                                     uint32_t tlv_size,
                                                     M2MResource &resource,
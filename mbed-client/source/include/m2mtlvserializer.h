@@ -76,29 +76,63 @@ public:
 
     static uint8_t* serialize(const M2MResource *resource, uint32_t &size);
 
+    /**
+     * Callback receiving the encoded TLV in consecutive pieces, see the streaming
+     * serialize() methods.
+     * @param data Next piece of the encoded data, valid only during the call.
+     * @param length Length of the piece.
+     * @param context Context given to serialize().
+     * @return false to abort serializing.
+     */
+    typedef bool (*write_callback)(const uint8_t *data, uint32_t length, void *context);
+
+    /**
+     * Streaming variants of the serialize() methods above. The TLV is passed to
+     * the callback as it is encoded, for example to fill blockwise message payloads,
+     * so no buffer for the whole payload is allocated.
+     * @return true if all data was passed to the callback.
+     */
+    static bool serialize(const M2MObjectInstanceList &object_instance_list, write_callback callback, void *context);
+
+    static bool serialize(const M2MResourceList &resource_list, write_callback callback, void *context);
+
+    static bool serialize(const M2MResource *resource, write_callback callback, void *context);
+
 private :
 
-    static uint8_t* serialize_object_instances(const M2MObjectInstanceList &object_instance_list, uint32_t &size);
+    /**
+     * Destination of the encoded data. Without buffer and callback only counts
+     * the size, which is used to size the buffer and the nested TLV headers.
+     */
+    class Writer;
+
+    static bool serialize_object_instances(const M2MObjectInstanceList &object_instance_list, Writer &writer);
+
+    static bool serialize_resources(const M2MResourceList &resource_list, Writer &writer);
+
+    static bool resources_valid(const M2MResourceList &resource_list);
+
+    static bool serialize(uint16_t id, const M2MObjectInstance *object_instance, Writer &writer);
+
+    static bool serialize(const M2MResource *resource, Writer &writer);
+
+    static bool serialize_resource(const M2MResource *resource, Writer &writer);
 
-    static uint8_t* serialize_resources(const M2MResourceList &resource_list, uint32_t &size, bool &valid);
+    static bool serialize_multiple_resource(const M2MResource *resource, Writer &writer);
 
-    static bool serialize(uint16_t id, const M2MObjectInstance *object_instance, uint8_t *&data, uint32_t &size);
-    
-    static bool serialize(const M2MResource *resource, uint8_t *&data, uint32_t &size);
+    static bool serialize_resource_instances(const M2MResource *resource, Writer &writer);
 
-    static bool serialize_resource(const M2MResource *resource, uint8_t *&data, uint32_t &size);
+    static bool serialize_resource_instance(uint16_t id, const M2MResourceInstance *resource, Writer &writer);
 
-    static bool serialize_multiple_resource(const M2MResource *resource, uint8_t *&data, uint32_t &size);
+    static bool serialize_TILV(uint8_t type, uint16_t id, const uint8_t *value, uint32_t value_length, Writer &writer);
 
-    static bool serialize_resource_instance(uint16_t id, const M2MResourceInstance *resource, uint8_t *&data, uint32_t &size);
-    
-    static bool serialize_TILV (uint8_t type, uint16_t id, uint8_t *value, uint32_t value_length, uint8_t *&data, uint32_t &size);
+    static bool serialize_TIL(uint8_t type, uint16_t id, uint32_t value_length, Writer &writer);
 
     static void serialize_id(uint16_t id, uint32_t &size, uint8_t *id_ptr);
 
     static void serialize_length(uint32_t length, uint32_t &size, uint8_t *length_ptr);
 
-    static bool serialize_TLV_binary_int(const M2MResourceBase *resource, uint8_t type, uint16_t id, uint8_t *&data, uint32_t &size);
+    static bool serialize_TLV_binary_int(const M2MResourceBase *resource, uint8_t type, uint16_t id, Writer &writer);
 
-    static bool serialize_TLV_binary_float(const M2MResourceBase *resource, uint8_t type, uint16_t id, uint8_t *&data, uint32_t &size);
+    static bool serialize_TLV_binary_float(const M2MResourceBase *resource, uint8_t type, uint16_t id, Writer &writer);
 };
@@ -27,6 +27,7 @@
 #include "include/m2mreporthandler.h"
 #include "include/nsdlaccesshelper.h"
 #include "include/m2mcallbackstorage.h"
+#include "include/m2msharedstring.h"
 #include "mbed-trace/mbed_trace.h"
 
 #include "sn_nsdl_lib.h"
@@ -36,6 +37,7 @@
 #include <stdlib.h>
 #include "common_functions.h"
 #include "ns_hal_init.h"
+#include "ns_types.h"
 
 #ifdef MBED_CONF_MBED_CLIENT_EVENT_LOOP_SIZE
 #define MBED_CLIENT_EVENT_LOOP_SIZE MBED_CONF_MBED_CLIENT_EVENT_LOOP_SIZE
@@ -45,6 +47,11 @@
 
 #define TRACE_GROUP "mClt"
 
+#if MBED_CLIENT_COMPACT_LWM2M_PARAMETERS
+// Regression check of the compact layout: two pointers and one flag word
+NS_STATIC_ASSERT(sizeof(M2MBase::lwm2m_parameters_s) <= 3 * sizeof(void *), "lwm2m_parameters_s has grown")
+#endif
+
 M2MBase::M2MBase(const String &resource_name,
                  M2MBase::Mode mode,
 #ifndef DISABLE_RESOURCE_TYPE
@@ -91,7 +98,7 @@ M2MBase::M2MBase(const String &resource_name,
                 const size_t len = strlen(resource_type.c_str());
                 if (len > 0) {
 #ifndef RESOURCE_ATTRIBUTES_LIST
-                    params->resource_type_ptr = (char *)alloc_string_copy((uint8_t *) resource_type.c_str(), len);
+                    params->resource_type_ptr = alloc_resource_string(resource_type.c_str(), len);
 #else
                     sn_nsdl_attribute_item_s item;
                     item.attribute_name = ATTR_RESOURCE_TYPE;
@@ -109,7 +116,7 @@ M2MBase::M2MBase(const String &resource_name,
 
         if ((!resource_name.empty())) {
             _sn_resource->identifier_int_type = false;
-            _sn_resource->identifier.name = stringdup((char *)resource_name.c_str());
+            _sn_resource->identifier.name = alloc_resource_string(resource_name.c_str(), resource_name.length());
         } else {
             tr_debug("M2MBase::M2Mbase resource name is EMPTY ===========");
             _sn_resource->identifier_int_type = true;
@@ -146,6 +153,11 @@ M2MBase::~M2MBase()
 #ifdef ENABLE_ASYNC_REST_RESPONSE
     M2MCallbackStorage::remove_callback(*this, M2MCallbackAssociation::M2MBaseAsyncCoapRequestCallback);
 #endif
+#if MBED_CLIENT_COMPACT_LWM2M_PARAMETERS
+    if (_sn_resource->max_age_set) {
+        M2MCallbackStorage::remove_callback(*this, M2MCallbackAssociation::M2MBaseMaxAge);
+    }
+#endif
 }
 
 char *M2MBase::create_path_base(const M2MBase &parent, const char *name)
@@ -215,12 +227,12 @@ void M2MBase::set_operation(M2MBase::Operation opr)
 void M2MBase::set_interface_description(const char *desc)
 {
     assert(_sn_resource->dynamic_resource_params->static_resource_parameters->free_on_delete);
-    free(_sn_resource->dynamic_resource_params->static_resource_parameters->interface_description_ptr);
+    free_resource_string(_sn_resource->dynamic_resource_params->static_resource_parameters->interface_description_ptr);
     _sn_resource->dynamic_resource_params->static_resource_parameters->interface_description_ptr = NULL;
     const size_t len = strlen(desc);
     if (len > 0) {
         _sn_resource->dynamic_resource_params->static_resource_parameters->interface_description_ptr =
-            (char *)alloc_string_copy((uint8_t *) desc, len);
+            alloc_resource_string(desc, len);
     }
     set_changed();
 }
@@ -242,12 +254,12 @@ void M2MBase::set_resource_type(const String &res_type)
 void M2MBase::set_resource_type(const char *res_type)
 {
     assert(_sn_resource->dynamic_resource_params->static_resource_parameters->free_on_delete);
-    free(_sn_resource->dynamic_resource_params->static_resource_parameters->resource_type_ptr);
+    free_resource_string(_sn_resource->dynamic_resource_params->static_resource_parameters->resource_type_ptr);
     _sn_resource->dynamic_resource_params->static_resource_parameters->resource_type_ptr = NULL;
     const size_t len = strlen(res_type);
     if (len > 0) {
-        _sn_resource->dynamic_resource_params->static_resource_parameters->resource_type_ptr = (char *)
-                                                                                               alloc_string_copy((uint8_t *) res_type, len);
+        _sn_resource->dynamic_resource_params->static_resource_parameters->resource_type_ptr =
+            alloc_resource_string(res_type, len);
     }
     set_changed();
 }
@@ -337,6 +349,18 @@ void M2MBase::set_confirmable(bool confirmable)
     _report_handler->set_confirmable(confirmable);
 }
 
+#if MBED_CLIENT_ADAPTIVE_CONFIRMABLE
+void M2MBase::set_confirmable_policy(uint16_t con_every, uint16_t con_interval)
+{
+    if (!_report_handler) {
+        _report_handler = new M2MReportHandler(*this, _sn_resource->data_type);
+        assert(_report_handler);
+    }
+
+    _report_handler->set_confirmable_policy(con_every, con_interval);
+}
+#endif
+
 void M2MBase::add_observation_level(M2MBase::Observation obs_level)
 {
     if (_report_handler) {
@@ -399,7 +423,18 @@ void M2MBase::set_instance_id(const uint16_t inst_id)
 
 void M2MBase::set_max_age(const uint32_t max_age)
 {
+#if MBED_CLIENT_COMPACT_LWM2M_PARAMETERS
+    // Max age is rarely set, so it is kept in the callback storage instead of every resource
+    if (_sn_resource->max_age_set) {
+        M2MCallbackStorage::remove_callback(*this, M2MCallbackAssociation::M2MBaseMaxAge);
+    }
+    _sn_resource->max_age_set = (max_age != 0);
+    if (max_age) {
+        M2MCallbackStorage::add_callback(*this, (void *)(uintptr_t)max_age, M2MCallbackAssociation::M2MBaseMaxAge);
+    }
+#else
     _sn_resource->max_age = max_age;
+#endif
 }
 
 M2MBase::BaseType M2MBase::base_type() const
@@ -525,7 +560,14 @@ uint16_t M2MBase::observation_number() const
 
 uint32_t M2MBase::max_age() const
 {
+#if MBED_CLIENT_COMPACT_LWM2M_PARAMETERS
+    if (_sn_resource->max_age_set) {
+        return (uint32_t)(uintptr_t)M2MCallbackStorage::get_callback(*this, M2MCallbackAssociation::M2MBaseMaxAge);
+    }
+    return 0;
+#else
     return _sn_resource->max_age;
+#endif
 }
 #if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1)
 bool M2MBase::handle_observation_attribute(const char *query)
@@ -862,30 +904,54 @@ void M2MBase::free_resources()
         //free(params->resource);
 #ifndef RESOURCE_ATTRIBUTES_LIST
 #ifndef DISABLE_RESOURCE_TYPE
-        free(params->resource_type_ptr);
+        free_resource_string(params->resource_type_ptr);
 #endif
 #ifndef DISABLE_INTERFACE_DESCRIPTION
-        free(params->interface_description_ptr);
+        free_resource_string(params->interface_description_ptr);
 #endif
 #else
         sn_nsdl_free_resource_attributes_list(_sn_resource->dynamic_resource_params->static_resource_parameters);
 #endif
         free(params);
     }
-    if (_sn_resource->dynamic_resource_params->free_on_delete) {
+    if (SN_NSDL_RESOURCE_VALUE_ALLOCATED(_sn_resource->dynamic_resource_params)) {
         free(_sn_resource->dynamic_resource_params->resource);
+    }
+    if (_sn_resource->dynamic_resource_params->free_on_delete) {
         free(_sn_resource->dynamic_resource_params);
+    } else {
+        // Value is always allocated by the client, statically defined parameters can be used again
+        _sn_resource->dynamic_resource_params->resource = NULL;
+        _sn_resource->dynamic_resource_params->resource_len = 0;
     }
 
     if (_sn_resource->free_on_delete && _sn_resource->identifier_int_type == false) {
         tr_debug("M2MBase::free_resources()");
-        free(_sn_resource->identifier.name);
+        free_resource_string(_sn_resource->identifier.name);
     }
     if (_sn_resource->free_on_delete) {
         free(_sn_resource);
     }
 }
 
+char *M2MBase::alloc_resource_string(const char *source, size_t size)
+{
+#if MBED_CLIENT_SHARED_RESOURCE_STRINGS
+    return M2MSharedString::acquire(source, size);
+#else
+    return (char *)alloc_string_copy((const uint8_t *)source, size);
+#endif
+}
+
+void M2MBase::free_resource_string(char *str)
+{
+#if MBED_CLIENT_SHARED_RESOURCE_STRINGS
+    M2MSharedString::release(str);
+#else
+    free(str);
+#endif
+}
+
 size_t M2MBase::resource_name_length() const
 {
     assert(_sn_resource->identifier_int_type == false);
@@ -996,7 +1062,8 @@ void M2MBase::send_message_delivery_status(const M2MBase &object, const MessageD
 
 void M2MBase::set_changed()
 {
-#ifdef MBED_CLOUD_CLIENT_EDGE_EXTENSION
+#if defined (MBED_CLOUD_CLIENT_EDGE_EXTENSION) || MBED_CLIENT_DISCOVER_CACHE
+    // The object caches its Discover payload, so it needs to see the changes below it
     M2MBase *parent = get_parent();
     if (parent) {
         parent->set_changed();
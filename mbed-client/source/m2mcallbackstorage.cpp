@@ -17,6 +17,11 @@
 #include "include/m2mcallbackstorage.h"
 
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Initial number of slots in the hash index, must be a power of two.
+#define M2M_CALLBACK_INDEX_MIN_SIZE 16
 
 
 // Dummy constructor, which does not init any value to something meaningful but needed for array construction.
@@ -47,6 +52,12 @@ void M2MCallbackStorage::delete_instance()
     M2MCallbackStorage::_static_instance = NULL;
 }
 
+M2MCallbackStorage::M2MCallbackStorage()
+: _index(NULL),
+  _index_size(0)
+{
+}
+
 M2MCallbackStorage::~M2MCallbackStorage()
 {
     // Go through the list and delete all the FP<n> objects if there are any.
@@ -56,6 +67,7 @@ M2MCallbackStorage::~M2MCallbackStorage()
     for (int index = _callbacks.size()-1; index >=0; index --) {
         _callbacks.erase(index);
     }
+    free(_index);
 }
 
 bool M2MCallbackStorage::add_callback(const M2MBase &object,
@@ -77,10 +89,11 @@ bool M2MCallbackStorage::do_add_callback(const M2MBase &object, void *callback,
     bool add_success = false;
 
     // verify that the same callback is not re-added.
-    if (!does_callback_exist(object, callback, type)) {
+    if (!does_callback_exist(object, callback, type) && reserve_index(_callbacks.size() + 1)) {
 
         const M2MCallbackAssociation association(&object, callback, type, client_args);
         _callbacks.push_back(association);
+        index_insert(_callbacks.size() - 1);
         add_success = true;
     }
     return add_success;
@@ -102,7 +115,7 @@ void M2MCallbackStorage::do_remove_callbacks(const M2MBase &object)
     // find any association to given object and delete them from the vector
     for (int index = 0; index < _callbacks.size();) {
         if (_callbacks[index]._object == &object) {
-            _callbacks.erase(index);
+            erase_association(find_slot_of(index));
         } else {
             index++;
         }
@@ -124,12 +137,10 @@ void* M2MCallbackStorage::remove_callback(const M2MBase &object, M2MCallbackAsso
 void* M2MCallbackStorage::do_remove_callback(const M2MBase &object, M2MCallbackAssociation::M2MCallbackType type)
 {
     void* callback = NULL;
-    for (int index = 0; index < _callbacks.size(); index++) {
-
-        if ((_callbacks[index]._object == &object) && (_callbacks[index]._type == type)) {
-            callback = _callbacks[index]._callback;
-            _callbacks.erase(index);
-        }
+    int slot;
+    while ((slot = find_slot(&object, type)) >= 0) {
+        callback = _callbacks[_index[slot] - 1]._callback;
+        erase_association(slot);
     }
     return callback;
 }
@@ -148,16 +159,9 @@ void* M2MCallbackStorage::get_callback(const M2MBase &object, M2MCallbackAssocia
 void* M2MCallbackStorage::do_get_callback(const M2MBase &object, M2MCallbackAssociation::M2MCallbackType type) const
 {
     void* callback = NULL;
-    if (!_callbacks.empty()) {
-        M2MCallbackAssociationList::const_iterator it = _callbacks.begin();
-
-        for ( ; it != _callbacks.end(); it++ ) {
-
-            if ((it->_object == &object) && (it->_type == type)) {
-                callback = it->_callback;
-                break;
-            }
-        }
+    const int slot = find_slot(&object, type);
+    if (slot >= 0) {
+        callback = _callbacks[_index[slot] - 1]._callback;
     }
     return callback;
 }
@@ -176,16 +180,9 @@ M2MCallbackAssociation* M2MCallbackStorage::get_association_item(const M2MBase &
 M2MCallbackAssociation* M2MCallbackStorage::do_get_association_item(const M2MBase &object, M2MCallbackAssociation::M2MCallbackType type) const
 {
     M2MCallbackAssociation* callback_association = NULL;
-    if (!_callbacks.empty()) {
-        M2MCallbackAssociationList::const_iterator it = _callbacks.begin();
-
-        for ( ; it != _callbacks.end(); it++ ) {
-
-            if ((it->_object == &object) && (it->_type == type)) {
-                callback_association = (M2MCallbackAssociation*)it;
-                break;
-            }
-        }
+    const int slot = find_slot(&object, type);
+    if (slot >= 0) {
+        callback_association = (M2MCallbackAssociation*)&_callbacks[_index[slot] - 1];
     }
     return callback_association;
 }
@@ -203,12 +200,14 @@ bool M2MCallbackStorage::does_callback_exist(const M2MBase &object, void *callba
 {
     bool match_found = false;
 
-    if (!_callbacks.empty()) {
-        M2MCallbackAssociationList::const_iterator it = _callbacks.begin();
+    if (_index_size) {
+        const int mask = _index_size - 1;
 
-        for ( ; it != _callbacks.end(); it++ ) {
+        // callbacks with the same object and type are in the same probe sequence
+        for (int slot = hash(&object, type) & mask; _index[slot]; slot = (slot + 1) & mask) {
+            const M2MCallbackAssociation &association = _callbacks[_index[slot] - 1];
 
-            if ((it->_object == &object) && (it->_callback == callback) && (it->_type == type)) {
+            if ((association._object == &object) && (association._callback == callback) && (association._type == type)) {
                 match_found = true;
                 break;
             }
@@ -217,3 +216,115 @@ bool M2MCallbackStorage::does_callback_exist(const M2MBase &object, void *callba
 
     return match_found;
 }
+
+uint32_t M2MCallbackStorage::hash(const M2MBase *object, M2MCallbackAssociation::M2MCallbackType type)
+{
+    const uint64_t address = (uintptr_t)object;
+    uint32_t h = (uint32_t)(address >> 2) ^ (uint32_t)(address >> 32);
+    h ^= (uint32_t)type * 0x9E3779B9u;
+    h *= 0x85EBCA6Bu;
+    return h ^ (h >> 16);
+}
+
+int M2MCallbackStorage::find_slot(const M2MBase *object, M2MCallbackAssociation::M2MCallbackType type) const
+{
+    if (_index_size) {
+        const int mask = _index_size - 1;
+
+        // the index is never full, so an empty slot ends the probe sequence
+        for (int slot = hash(object, type) & mask; _index[slot]; slot = (slot + 1) & mask) {
+            const M2MCallbackAssociation &association = _callbacks[_index[slot] - 1];
+
+            if ((association._object == object) && (association._type == type)) {
+                return slot;
+            }
+        }
+    }
+    return -1;
+}
+
+int M2MCallbackStorage::find_slot_of(int position) const
+{
+    const int mask = _index_size - 1;
+    const M2MCallbackAssociation &association = _callbacks[position];
+    int slot = hash(association._object, association._type) & mask;
+
+    while (_index[slot] != position + 1) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+bool M2MCallbackStorage::reserve_index(int count)
+{
+    if (count * 2 <= _index_size) {
+        return true;
+    }
+
+    int new_size = _index_size ? _index_size * 2 : M2M_CALLBACK_INDEX_MIN_SIZE;
+    while (new_size < count * 2) {
+        new_size *= 2;
+    }
+
+    int *new_index = (int*)malloc(new_size * sizeof(int));
+    if (!new_index) {
+        return false;
+    }
+    memset(new_index, 0, new_size * sizeof(int));
+
+    free(_index);
+    _index = new_index;
+    _index_size = new_size;
+
+    for (int position = 0; position < _callbacks.size(); position++) {
+        index_insert(position);
+    }
+    return true;
+}
+
+void M2MCallbackStorage::index_insert(int position)
+{
+    const int mask = _index_size - 1;
+    const M2MCallbackAssociation &association = _callbacks[position];
+    int slot = hash(association._object, association._type) & mask;
+
+    while (_index[slot]) {
+        slot = (slot + 1) & mask;
+    }
+    _index[slot] = position + 1;
+}
+
+void M2MCallbackStorage::index_remove(int slot)
+{
+    // Backward shift deletion: move the following entries of the probe sequence
+    // back to the hole when that does not move them before their home slot,
+    // so lookups need no tombstones.
+    const int mask = _index_size - 1;
+    int hole = slot;
+
+    for (int next = (slot + 1) & mask; _index[next]; next = (next + 1) & mask) {
+        const M2MCallbackAssociation &association = _callbacks[_index[next] - 1];
+        const int home = hash(association._object, association._type) & mask;
+
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            _index[hole] = _index[next];
+            hole = next;
+        }
+    }
+    _index[hole] = 0;
+}
+
+void M2MCallbackStorage::erase_association(int slot)
+{
+    const int position = _index[slot] - 1;
+    const int last = _callbacks.size() - 1;
+
+    index_remove(slot);
+
+    // fill the gap with the last association instead of shifting the whole tail
+    if (position != last) {
+        _index[find_slot_of(last)] = position + 1;
+        _callbacks[position] = _callbacks[last];
+    }
+    _callbacks.pop_back();
+}
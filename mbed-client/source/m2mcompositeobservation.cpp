@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2021 Pelion. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "include/m2mcompositeobservation.h"
+
+#if MBED_CLIENT_COMPOSITE_OPERATIONS
+
+#include "include/m2mnsdlinterface.h"
+#include "mbed-client/m2mobjectinstance.h"
+#include "mbed-client/m2mresource.h"
+#include "mbed-client/m2mresourceinstance.h"
+#include "mbed-trace/mbed_trace.h"
+
+#include <string.h>
+
+#define TRACE_GROUP "mClt"
+
+M2MCompositeObservation::M2MCompositeObservation(M2MNsdlInterface &nsdl_interface)
+    : _nsdl_interface(nsdl_interface),
+      _report_handler(*this, M2MBase::OPAQUE),
+      _msg_id(0),
+      _notification_pending(false)
+{
+    // Notifications are sent non-confirmable, they do not take part in the
+    // confirmable notification queue of the objects
+    _report_handler.set_confirmable(false);
+}
+
+M2MCompositeObservation::~M2MCompositeObservation()
+{
+    _report_handler.set_under_observation(false);
+}
+
+M2MBaseList &M2MCompositeObservation::paths()
+{
+    return _paths;
+}
+
+M2MReportHandler &M2MCompositeObservation::report_handler()
+{
+    return _report_handler;
+}
+
+bool M2MCompositeObservation::has_token(const uint8_t *token, uint8_t token_length) const
+{
+    uint8_t own_token[MAX_TOKEN_SIZE];
+    uint8_t own_token_length = 0;
+    _report_handler.get_observation_token(own_token, own_token_length);
+    return token && token_length == own_token_length && memcmp(token, own_token, token_length) == 0;
+}
+
+bool M2MCompositeObservation::covers(const M2MBase &base) const
+{
+    // Walk up from the changed resource or resource instance, any level may be observed
+    const M2MBase *level = &base;
+    while (level) {
+        M2MBaseList::const_iterator it = _paths.begin();
+        for (; it != _paths.end(); it++) {
+            if (*it == level) {
+                return true;
+            }
+        }
+
+        switch (level->base_type()) {
+            case M2MBase::ResourceInstance:
+                level = &static_cast<const M2MResourceInstance *>(level)->get_parent_resource();
+                break;
+            case M2MBase::Resource:
+                level = &static_cast<const M2MResource *>(level)->get_parent_object_instance();
+                break;
+            case M2MBase::ObjectInstance:
+                level = &static_cast<const M2MObjectInstance *>(level)->get_parent_object();
+                break;
+            default:
+                level = NULL;
+                break;
+        }
+    }
+    return false;
+}
+
+bool M2MCompositeObservation::remove_path(const M2MBase &base)
+{
+    int index = 0;
+    while (index < _paths.size()) {
+        if (_paths[index] == &base) {
+            _paths.erase(index);
+        } else {
+            index++;
+        }
+    }
+    return !_paths.empty();
+}
+
+bool M2MCompositeObservation::notification_pending() const
+{
+    return _notification_pending;
+}
+
+void M2MCompositeObservation::clear_notification_pending()
+{
+    _notification_pending = false;
+}
+
+int32_t M2MCompositeObservation::msg_id() const
+{
+    return _msg_id;
+}
+
+void M2MCompositeObservation::set_msg_id(int32_t msg_id)
+{
+    _msg_id = msg_id;
+}
+
+bool M2MCompositeObservation::observation_to_be_sent(const m2m::Vector<uint16_t> & /*changed_instance_ids*/,
+                                                     uint16_t /*obs_number*/,
+                                                     bool /*send_object*/)
+{
+    // Values changed during this event loop round are collected into one notification
+    tr_debug("M2MCompositeObservation::observation_to_be_sent()");
+    _notification_pending = true;
+    _nsdl_interface.composite_notification_pending();
+    return true;
+}
+
+#endif // MBED_CLIENT_COMPOSITE_OPERATIONS
@@ -19,19 +19,67 @@
 #include "mbed-client/m2mobject.h"
 #include "mbed-client/m2mobjectinstance.h"
 #include "mbed-client/m2mresource.h"
+#include "mbed-client/m2mstaticresource.h"
 #include "mbed-trace/mbed_trace.h"
 
 #define BUFFER_SIZE 21
 #define TRACE_GROUP "mClt"
 
+// The object is a singleton, so the resources which are created on every start up use
+// descriptors in flash instead of allocating the names, paths and parameters from heap.
+// The IDs must match the DEVICE_ constants.
+M2M_STATIC_RESOURCE(device_manufacturer, 3, 0, 0, OMA_RESOURCE_TYPE, M2MBase::STRING, false);
+M2M_STATIC_RESOURCE(device_model_number, 3, 0, 1, OMA_RESOURCE_TYPE, M2MBase::STRING, false);
+M2M_STATIC_RESOURCE(device_serial_number, 3, 0, 2, OMA_RESOURCE_TYPE, M2MBase::STRING, false);
+M2M_STATIC_RESOURCE(device_reboot, 3, 0, 4, OMA_RESOURCE_TYPE, M2MBase::OPAQUE, false);
+M2M_STATIC_RESOURCE(device_current_time, 3, 0, 13, OMA_RESOURCE_TYPE, M2MBase::INTEGER, false);
+M2M_STATIC_RESOURCE(device_utc_offset, 3, 0, 14, OMA_RESOURCE_TYPE, M2MBase::STRING, false);
+M2M_STATIC_RESOURCE(device_timezone, 3, 0, 15, OMA_RESOURCE_TYPE, M2MBase::STRING, false);
+M2M_STATIC_RESOURCE(device_supported_binding_mode, 3, 0, 16, OMA_RESOURCE_TYPE, M2MBase::STRING, false);
+M2M_STATIC_RESOURCE(device_device_type, 3, 0, 17, OMA_RESOURCE_TYPE, M2MBase::STRING, false);
+M2M_STATIC_RESOURCE(device_hardware_version, 3, 0, 18, OMA_RESOURCE_TYPE, M2MBase::STRING, false);
+M2M_STATIC_RESOURCE(device_software_version, 3, 0, 19, OMA_RESOURCE_TYPE, M2MBase::STRING, false);
+M2M_STATIC_RESOURCE(device_memory_total, 3, 0, 21, OMA_RESOURCE_TYPE, M2MBase::INTEGER, false);
+
+// Returns the descriptors of a resource, NULL if it is allocated from heap
+static const M2MBase::lwm2m_parameters_s *static_resource(M2MDevice::DeviceResource resource)
+{
+    switch (resource) {
+        case M2MDevice::Manufacturer:
+            return &device_manufacturer;
+        case M2MDevice::ModelNumber:
+            return &device_model_number;
+        case M2MDevice::SerialNumber:
+            return &device_serial_number;
+        case M2MDevice::Reboot:
+            return &device_reboot;
+        case M2MDevice::CurrentTime:
+            return &device_current_time;
+        case M2MDevice::UTCOffset:
+            return &device_utc_offset;
+        case M2MDevice::Timezone:
+            return &device_timezone;
+        case M2MDevice::SupportedBindingMode:
+            return &device_supported_binding_mode;
+        case M2MDevice::DeviceType:
+            return &device_device_type;
+        case M2MDevice::HardwareVersion:
+            return &device_hardware_version;
+        case M2MDevice::SoftwareVersion:
+            return &device_software_version;
+        case M2MDevice::MemoryTotal:
+            return &device_memory_total;
+        default:
+            return NULL;
+    }
+}
+
 M2MDevice *M2MDevice::_instance = NULL;
 
 M2MDevice *M2MDevice::get_instance()
 {
     if (_instance == NULL) {
         // ownership of this path is transferred to M2MBase.
-        // Since this object is a singleton, we could use the C-structs to avoid heap
-        // allocation on a lot of M2MDevice -objects data.
         char *path = stringdup(M2M_DEVICE_ID);
         if (path) {
             _instance = new M2MDevice(path);
@@ -58,8 +106,7 @@ M2MDevice::M2MDevice(char *path)
         _device_instance->set_register_uri(false);
         _device_instance->set_coap_content_type(COAP_CONTENT_OMA_TLV_TYPE);
         _device_instance->set_observable(true); // this object instance has observable resources so also obj inst should be observable
-        M2MResource *res = _device_instance->create_dynamic_resource(DEVICE_REBOOT,
-                                                                     OMA_RESOURCE_TYPE,
+        M2MResource *res = _device_instance->create_dynamic_resource(&device_reboot,
                                                                      M2MResourceInstance::OPAQUE,
                                                                      false);
         if (res) {
@@ -77,8 +124,7 @@ M2MDevice::M2MDevice(char *path)
             instance->set_register_uri(true);
         }
 
-        res = _device_instance->create_dynamic_resource(DEVICE_SUPPORTED_BINDING_MODE,
-                                                        OMA_RESOURCE_TYPE,
+        res = _device_instance->create_dynamic_resource(&device_supported_binding_mode,
                                                         M2MResourceInstance::STRING,
                                                         true);
         if (res) {
@@ -137,10 +183,17 @@ M2MResource *M2MDevice::create_resource(DeviceResource resource, const String &v
 
     if (!device_id.empty()) {
         if (_device_instance) {
-            res = _device_instance->create_dynamic_resource(device_id,
-                                                            OMA_RESOURCE_TYPE,
-                                                            M2MResourceInstance::STRING,
-                                                            true);
+            const M2MBase::lwm2m_parameters_s *static_res = static_resource(resource);
+            if (static_res) {
+                res = _device_instance->create_dynamic_resource(static_res,
+                                                                M2MResourceInstance::STRING,
+                                                                true);
+            } else {
+                res = _device_instance->create_dynamic_resource(device_id,
+                                                                OMA_RESOURCE_TYPE,
+                                                                M2MResourceInstance::STRING,
+                                                                true);
+            }
 
             if (res) {
                 res->set_operation(operation);
@@ -193,10 +246,17 @@ M2MResource *M2MDevice::create_resource(DeviceResource resource, int64_t value)
 
     if (!device_id.empty()) {
         if (_device_instance) {
-            res = _device_instance->create_dynamic_resource(device_id,
-                                                            OMA_RESOURCE_TYPE,
-                                                            M2MResourceInstance::INTEGER,
-                                                            true);
+            const M2MBase::lwm2m_parameters_s *static_res = static_resource(resource);
+            if (static_res) {
+                res = _device_instance->create_dynamic_resource(static_res,
+                                                                M2MResourceInstance::INTEGER,
+                                                                true);
+            } else {
+                res = _device_instance->create_dynamic_resource(device_id,
+                                                                OMA_RESOURCE_TYPE,
+                                                                M2MResourceInstance::INTEGER,
+                                                                true);
+            }
 
             if (res) {
 
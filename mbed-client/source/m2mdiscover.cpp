@@ -17,8 +17,12 @@
 #include "include/m2mdiscover.h"
 #include "include/m2mreporthandler.h"
 #include "mbed-trace/mbed_trace.h"
+#include "sn_coap_protocol.h"
+#include "sn_grs.h"
 
+#include <inttypes.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #if defined (MBED_CONF_MBED_CLIENT_ENABLE_DISCOVERY) && (MBED_CONF_MBED_CLIENT_ENABLE_DISCOVERY == 1)
@@ -27,71 +31,154 @@
 
 uint8_t *M2MDiscover::create_object_payload(const M2MObject *object, uint32_t &data_length)
 {
-    // First we do a dryrun to calculate the needed space
-    uint32_t len = 0;
-    uint8_t *data = 0;
-    create_object_payload(object, &data, len);
-
-    // Then allocate memory and fill the data
-    data = (uint8_t *)malloc(len + 1);
-    len = 0;
+    return create_payload(*object, data_length);
+}
 
-    if (data) {
-        // copy pointer as it's moved inside the function
-        uint8_t *tmp_data = data;
-        create_object_payload(object, &tmp_data, len);
+uint8_t *M2MDiscover::create_object_instance_payload(const M2MObjectInstance *obj_instance, uint32_t &data_length)
+{
+    return create_payload(*obj_instance, data_length);
+}
 
-        tr_debug("M2MDiscover::create_object_payload - len: %d, data:\n%.*s", len, len, (char *)data);
-        data_length = len;
-    }
-    return data;
+uint8_t *M2MDiscover::create_resource_payload(const M2MResource *res, uint32_t &data_length)
+{
+    return create_payload(*res, data_length);
 }
 
-uint8_t *M2MDiscover::create_object_instance_payload(const M2MObjectInstance *obj_instance, uint32_t &data_length)
+uint8_t *M2MDiscover::create_payload_block(nsdl_s *nsdl, M2MBase &base, const sn_coap_hdr_s &request,
+                                           sn_coap_hdr_s &response, uint32_t &data_length)
 {
-    // First we do a dryrun to calculate the needed space
-    uint32_t len = 0;
-    uint8_t *data = 0;
-    create_object_instance_payload(obj_instance, &data, len, true, true, true);
+    uint32_t block_number = 0;
+    uint16_t block_size = 0;
+#ifndef DISABLE_BLOCK_MESSAGE
+    block_size = sn_coap_protocol_get_configured_blockwise_size(nsdl->grs->coap);
+    if (request.options_list_ptr && request.options_list_ptr->block2 != -1) {
+        // Server may ask for smaller blocks than configured
+        uint16_t requested_size = 1u << ((request.options_list_ptr->block2 & 0x07) + 4);
+        if (!block_size || requested_size < block_size) {
+            block_size = requested_size;
+        }
+        block_number = request.options_list_ptr->block2 >> 4;
+    }
+#endif
 
-    // Then allocate memory and fill the data
-    data = (uint8_t *)malloc(len + 1);
-    len = 0;
+    if (!block_size) {
+        return create_payload(base, data_length);
+    }
 
-    if (data) {
-        // copy pointer as it's moved inside the function
-        uint8_t *tmp_data = data;
-        create_object_instance_payload(obj_instance, &tmp_data, len, true, true, true);
+    data_length = 0;
+    uint8_t *data = (uint8_t *)malloc(block_size);
+    if (!data) {
+        return NULL;
+    }
+
+    discover_writer_s writer;
+    writer.buffer = data;
+    writer.offset = block_number * block_size;
+    writer.size = block_size;
+    writer.length = 0;
+
+#if MBED_CLIENT_DISCOVER_CACHE
+    const uint8_t *cache = NULL;
+    if (base.base_type() == M2MBase::Object) {
+        cache = cached_object_payload(static_cast<M2MObject &>(base), writer.length);
+    }
+    if (cache) {
+        if (writer.length > writer.offset) {
+            uint32_t length = writer.length - writer.offset;
+            memcpy(data, cache + writer.offset, length < block_size ? length : block_size);
+        }
+    } else
+#endif
+    {
+        write_payload(base, writer);
+    }
+
+    if (writer.length <= writer.offset) {
+        tr_error("M2MDiscover::create_payload_block - block %" PRIu32 " not in payload of %" PRIu32, block_number, writer.length);
+        free(data);
+        return NULL;
+    }
 
-        tr_debug("M2MDiscover::create_object_instance_payload - len: %d, data:\n%.*s", len, len, (char *)data);
-        data_length = len;
+    data_length = writer.length - writer.offset;
+    if (data_length > block_size) {
+        data_length = block_size;
     }
+
+    if (writer.length > block_size) {
+        sn_coap_options_list_s *options = sn_nsdl_alloc_options_list(nsdl, &response);
+        if (!options) {
+            free(data);
+            data_length = 0;
+            return NULL;
+        }
+        options->use_size2 = true;
+        options->size2 = writer.length;
+        options->block2 = (block_number << 4) | sn_coap_convert_block_size(block_size);
+        if (writer.length > writer.offset + block_size) {
+            options->block2 |= 0x08;
+        }
+    }
+
+    tr_debug("M2MDiscover::create_payload_block - block %" PRIu32 ", len: %" PRIu32 " of %" PRIu32, block_number, data_length, writer.length);
     return data;
 }
 
-uint8_t *M2MDiscover::create_resource_payload(const M2MResource *res, uint32_t &data_length)
+uint8_t *M2MDiscover::create_payload(const M2MBase &base, uint32_t &data_length)
 {
     // First we do a dryrun to calculate the needed space
-    uint32_t len = 0;
-    uint8_t *data = 0;
-    create_resource_payload(res, &data, len, true, true, true);
+    discover_writer_s writer;
+    writer.buffer = NULL;
+    writer.offset = 0;
+    writer.size = 0;
+    writer.length = 0;
+    write_payload(base, writer);
 
     // Then allocate memory and fill the data
-    data = (uint8_t *)malloc(len + 1);
-    len = 0;
+    uint8_t *data = (uint8_t *)malloc(writer.length + 1);
 
     if (data) {
-        // copy pointer as it's moved inside the function
-        uint8_t *tmp_data = data;
-        create_resource_payload(res, &tmp_data, len, true, true, true);
+        writer.buffer = data;
+        writer.size = writer.length;
+        writer.length = 0;
+        write_payload(base, writer);
 
-        tr_debug("M2MDiscover::create_resource_payload - len: %d, data:\n%.*s", len, len, (char *)data);
-        data_length = len;
+        tr_debug("M2MDiscover::create_payload - len: %" PRIu32 ", data:\n%.*s", writer.length, (int)writer.length, (char *)data);
+        data_length = writer.length;
     }
     return data;
 }
 
-void M2MDiscover::create_object_payload(const M2MObject *object, uint8_t **data, uint32_t &data_length)
+#if MBED_CLIENT_DISCOVER_CACHE
+const uint8_t *M2MDiscover::cached_object_payload(M2MObject &object, uint32_t &data_length)
+{
+    if (!object._discover_cache) {
+        object._discover_cache = create_payload(object, object._discover_cache_length);
+    }
+    data_length = object._discover_cache_length;
+    return object._discover_cache;
+}
+#endif
+
+void M2MDiscover::write_payload(const M2MBase &base, discover_writer_s &writer)
+{
+    switch (base.base_type()) {
+        case M2MBase::Object:
+            create_object_payload(static_cast<const M2MObject *>(&base), writer);
+            break;
+        case M2MBase::ObjectInstance:
+            create_object_instance_payload(static_cast<const M2MObjectInstance *>(&base), writer, true, true, true);
+            break;
+        case M2MBase::Resource:
+            create_resource_payload(static_cast<const M2MResource *>(&base), writer, true, true, true);
+            break;
+        default:
+            // Discover is not defined for a resource instance
+            tr_error("M2MDiscover::write_payload - invalid base type: %d", base.base_type());
+            break;
+    }
+}
+
+void M2MDiscover::create_object_payload(const M2MObject *object, discover_writer_s &writer)
 {
     // when Discover is done to object level, only object level attributes are listed and then list of object instances and their resources
     // for example </3>;pmin=10,</3/0>,</3/0/1>,</3/0/2>,</3/0/3>,</3/0/4>,</3/0/6>,</3/0/7>,</3/0/8>,</3/0/11>,</3/0/16>
@@ -100,27 +187,27 @@ void M2MDiscover::create_object_payload(const M2MObject *object, uint8_t **data,
     const M2MObjectInstanceList &object_instance_list = object->instances();
 
     // Add object path and it's Write-Attributes to payload
-    set_path_and_attributes(object->report_handler(), object->uri_path(), data, data_length);
+    set_path_and_attributes(object->report_handler(), object->uri_path(), writer);
 
     // Add object instances paths and their resource paths to payload
     if (!object_instance_list.empty()) {
         // add comma between object and object instances
-        set_comma(data, data_length);
+        set_comma(writer);
 
         M2MObjectInstanceList::const_iterator it;
         it = object_instance_list.begin();
         for (; it != object_instance_list.end();) {
-            create_object_instance_payload((const M2MObjectInstance *)*it, data, data_length, false, false, false);
+            create_object_instance_payload((const M2MObjectInstance *)*it, writer, false, false, false);
             it++;
             if (it != object_instance_list.end()) {
                 // add comma between object instances
-                set_comma(data, data_length);
+                set_comma(writer);
             }
         }
     }
 }
 
-void M2MDiscover::create_object_instance_payload(const M2MObjectInstance *obj_instance, uint8_t **data, uint32_t &data_length, bool add_resource_dimension,
+void M2MDiscover::create_object_instance_payload(const M2MObjectInstance *obj_instance, discover_writer_s &writer, bool add_resource_dimension,
                                                  bool add_resource_attribute, bool add_object_attribute)
 {
     // when Discover is done to object instance level, attributes for object instance must be listed, resources and their attibutes
@@ -132,30 +219,30 @@ void M2MDiscover::create_object_instance_payload(const M2MObjectInstance *obj_in
 
     // Add object instance path and it's Write-Attributes to payload
     if (add_object_attribute) {
-        set_path_and_attributes(obj_instance->report_handler(), obj_instance->uri_path(), data, data_length);
+        set_path_and_attributes(obj_instance->report_handler(), obj_instance->uri_path(), writer);
     } else {
-        set_path(obj_instance->uri_path(), data, data_length);
+        set_path(obj_instance->uri_path(), writer);
     }
 
     // Add resource paths to payload and possible Write-Attributes to payload
     if (!resource_list.empty()) {
         // add comma between object instance and resources
-        set_comma(data, data_length);
+        set_comma(writer);
 
         M2MResourceList::const_iterator it;
         it = resource_list.begin();
         for (; it != resource_list.end();) {
-            create_resource_payload((const M2MResource *)*it, data, data_length, add_resource_dimension, add_resource_attribute);
+            create_resource_payload((const M2MResource *)*it, writer, add_resource_dimension, add_resource_attribute);
             it++;
             if (it != resource_list.end()) {
                 // add comma between resources
-                set_comma(data, data_length);
+                set_comma(writer);
             }
         }
     }
 }
 
-void M2MDiscover::create_resource_payload(const M2MResource *res, uint8_t **data, uint32_t &data_length, bool add_resource_dimension, bool add_resource_attribute, bool add_inherited)
+void M2MDiscover::create_resource_payload(const M2MResource *res, discover_writer_s &writer, bool add_resource_dimension, bool add_resource_attribute, bool add_inherited)
 {
     // when Discover is done to resource level, list resource and it's attributes,
     // including the assigned R-Attributes and the R-Attributes inherited from the Object and Object Instance
@@ -164,62 +251,68 @@ void M2MDiscover::create_resource_payload(const M2MResource *res, uint8_t **data
     // with pmin assigned at the Object level, and pmax assigned at the Object Instance level
 
     // Add resource path to payload
-    set_path(res->uri_path(), data, data_length);
+    set_path(res->uri_path(), writer);
 
     // add dimension, e.g. how many resource instances does this resource have, if none, then nothing is added to payload
     if (add_resource_dimension && res->supports_multiple_instances()) {
-        set_string_and_value(data, data_length, ";dim=", 0, res->resource_instance_count(), false);
+        set_string_and_value(writer, ";dim=", 0, res->resource_instance_count(), false);
     }
 
 #if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1)
     // Add possible Write-Attributes to payload
     if (add_resource_attribute) {
-        set_resource_attributes(*res, data, data_length, add_inherited);
+        set_resource_attributes(*res, writer, add_inherited);
     }
 #endif
 }
 
-void M2MDiscover::set_comma(uint8_t **data, uint32_t &data_length)
+void M2MDiscover::write(discover_writer_s &writer, const char *str, uint32_t length)
 {
-     if (*data) {
-        memcpy(*data, ",", 1);
-        *data += 1;
+    // Copy the part which falls into the buffer
+    if (writer.buffer && writer.length + length > writer.offset && writer.length < writer.offset + writer.size) {
+        uint32_t skip = (writer.length < writer.offset) ? writer.offset - writer.length : 0;
+        uint32_t pos = writer.length + skip - writer.offset;
+        uint32_t copy = length - skip;
+        if (copy > writer.size - pos) {
+            copy = writer.size - pos;
+        }
+        memcpy(writer.buffer + pos, str + skip, copy);
     }
-    data_length++;
+    writer.length += length;
 }
 
-void M2MDiscover::set_string_and_value(uint8_t **data, uint32_t &data_length, const char* str, float float_value, int32_t int_value, bool float_type)
+void M2MDiscover::set_comma(discover_writer_s &writer)
 {
-    int max_val_len = REGISTRY_FLOAT_STRING_MAX_LEN;
-    if (*data == NULL) {
-        max_val_len = 0;
-    }
-    uint32_t tmp_len = strlen(str);
-    data_length += tmp_len;
-    if (*data) {
-        memcpy(*data, str, tmp_len);
-        *data += tmp_len;
-    }
+    write(writer, ",", 1);
+}
+
+void M2MDiscover::set_string_and_value(discover_writer_s &writer, const char* str, float float_value, int32_t int_value, bool float_type)
+{
+    char value[REGISTRY_FLOAT_STRING_MAX_LEN];
+    int value_len;
+
+    write(writer, str, strlen(str));
 
 #if MBED_MINIMAL_PRINTF
     if (float_type) {
-        tmp_len = snprintf((char *)*data, max_val_len, "%f", float_value);
+        value_len = snprintf(value, sizeof(value), "%f", float_value);
     } else {
-        tmp_len = snprintf((char *)*data, max_val_len, "%d", int_value);
+        value_len = snprintf(value, sizeof(value), "%d", int_value);
     }
 #else
-    tmp_len = snprintf((char *)*data, max_val_len, "%g", float_type ? float_value : int_value);
+    value_len = snprintf(value, sizeof(value), "%g", float_type ? float_value : int_value);
 #endif
 
-    data_length += tmp_len;
-    if (*data) {
-        // move data pointer to point after the added data
-        *data += tmp_len;
+    if (value_len > 0) {
+        if (value_len >= (int)sizeof(value)) {
+            value_len = sizeof(value) - 1;
+        }
+        write(writer, value, value_len);
     }
 }
 
 #if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1)
-void M2MDiscover::set_resource_attributes(const M2MResource &res, uint8_t **data, uint32_t &data_length, bool add_inherited)
+void M2MDiscover::set_resource_attributes(const M2MResource &res, discover_writer_s &writer, bool add_inherited)
 {
     float attribute_value_float;
     uint32_t attribute_value_int;
@@ -257,7 +350,7 @@ void M2MDiscover::set_resource_attributes(const M2MResource &res, uint8_t **data
             }
         }
         if (set_attribute) {
-            set_string_and_value(data, data_length, get_attribute_string((M2MReportHandler::WriteAttribute)attribute), attribute_value_float, attribute_value_int, float_val);
+            set_string_and_value(writer, get_attribute_string((M2MReportHandler::WriteAttribute)attribute), attribute_value_float, attribute_value_int, float_val);
         }
     }
 }
@@ -302,9 +395,9 @@ const char *M2MDiscover::get_attribute_string(M2MReportHandler::WriteAttribute a
 }
 #endif
 
-void M2MDiscover::set_path_and_attributes(M2MReportHandler *report_handler, const char *path, uint8_t **data, uint32_t &data_length)
+void M2MDiscover::set_path_and_attributes(M2MReportHandler *report_handler, const char *path, discover_writer_s &writer)
 {
-    set_path(path, data, data_length);
+    set_path(path, writer);
 
 #if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1)
     if (report_handler) {
@@ -319,26 +412,19 @@ void M2MDiscover::set_path_and_attributes(M2MReportHandler *report_handler, cons
                     float_val = true;
                 }
                 get_write_attributes(*report_handler, (M2MReportHandler::WriteAttribute)i, attribute_value_float, attribute_value_int, float_val);
-                set_string_and_value(data, data_length, get_attribute_string((M2MReportHandler::WriteAttribute)i), attribute_value_float, attribute_value_int, float_val);
+                set_string_and_value(writer, get_attribute_string((M2MReportHandler::WriteAttribute)i), attribute_value_float, attribute_value_int, float_val);
             }
         }
     }
 #endif
 }
 
-void M2MDiscover::set_path(const char *path, uint8_t **data, uint32_t &data_length)
+void M2MDiscover::set_path(const char *path, discover_writer_s &writer)
 {
-    data_length += 3; // </ >
-    data_length += strlen(path); // e.g. "3" or "3/0" or "3/0/7"
-
-    if (*data) {
-        memcpy(*data, "</", 2);
-        *data += 2;
-        memcpy(*data, path, strlen(path));
-        *data += strlen(path);
-        memcpy(*data, ">", 1);
-        *data += 1;
-    }
+    // e.g. "</3>" or "</3/0>" or "</3/0/7>"
+    write(writer, "</", 2);
+    write(writer, path, strlen(path));
+    write(writer, ">", 1);
 }
 
 #endif // defined (MBED_CONF_MBED_CLIENT_ENABLE_DISCOVERY) && (MBED_CONF_MBED_CLIENT_ENABLE_DISCOVERY == 1)
@@ -0,0 +1,363 @@
+/*
+ * Copyright (c) 2021 Pelion. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "include/m2mexecutepool.h"
+
+#if MBED_CLIENT_EXECUTE_THREADS
+
+#include "include/m2mcallbackstorage.h"
+#include "mbed-client/m2mstring.h"
+#include "eventOS_event.h"
+#include "eventOS_scheduler.h"
+#include "mbed-trace/mbed_trace.h"
+#include "pal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define TRACE_GROUP "mClt"
+
+#define MBED_CLIENT_EXECUTE_POOL_INIT_EVENT 0
+#define MBED_CLIENT_EXECUTE_POOL_DONE_EVENT 1
+
+struct execute_job_s {
+    M2MResource         *resource;      // NULL once the resource has been deleted
+    execute_callback    *callback;
+    execute_callback_2  callback2;
+    uint8_t             *value;
+    uint16_t            value_length;
+    bool                respond;        // Delayed response sent by the callback
+    sn_coap_msg_code_e  code;
+    execute_job_s       *next;
+};
+
+struct execute_worker_s {
+    palThreadID_t       thread;
+    execute_job_s       *job;           // Job running on the worker, NULL if idle
+};
+
+static palMutexID_t pool_mutex = NULLPTR;
+static palSemaphoreID_t pool_semaphore = NULLPTR;
+static int8_t pool_tasklet_id = -1;
+static bool pool_failed = false;
+static uint8_t pool_worker_count = 0;
+static execute_worker_s pool_workers[MBED_CLIENT_EXECUTE_THREADS];
+
+// Jobs waiting for a worker, in the order of the requests
+static execute_job_s *pool_queue_head = NULL;
+static execute_job_s *pool_queue_tail = NULL;
+
+// Jobs whose callbacks have returned, latest first, waiting for the event loop
+static execute_job_s *pool_done = NULL;
+
+// Sent to the event loop when the first job is added to pool_done
+static arm_event_storage_t pool_done_event;
+static bool pool_done_event_queued = false;
+
+static void execute_pool_free(execute_job_s *job)
+{
+    free(job->value);
+    free(job);
+}
+
+static bool execute_pool_running(const M2MResource *resource)
+{
+    for (uint8_t i = 0; i < pool_worker_count; i++) {
+        if (pool_workers[i].job && pool_workers[i].job->resource == resource) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Takes the first queued job whose resource has no callback running, must be called with the mutex held
+static execute_job_s *execute_pool_take()
+{
+    execute_job_s *prev = NULL;
+    for (execute_job_s *job = pool_queue_head; job; prev = job, job = job->next) {
+        if (!execute_pool_running(job->resource)) {
+            if (prev) {
+                prev->next = job->next;
+            } else {
+                pool_queue_head = job->next;
+            }
+            if (pool_queue_tail == job) {
+                pool_queue_tail = prev;
+            }
+            job->next = NULL;
+            return job;
+        }
+    }
+    return NULL;
+}
+
+static void execute_pool_worker(void const *argument)
+{
+    execute_worker_s *worker = (execute_worker_s *)argument;
+
+    pal_osMutexWait(pool_mutex, PAL_RTOS_WAIT_FOREVER);
+    worker->thread = pal_osThreadGetId();
+    pal_osMutexRelease(pool_mutex);
+
+    for (;;) {
+        pal_osMutexWait(pool_mutex, PAL_RTOS_WAIT_FOREVER);
+        execute_job_s *job = execute_pool_take();
+        worker->job = job;
+        pal_osMutexRelease(pool_mutex);
+
+        if (!job) {
+            // Released once per queued job, a wake finding nothing to take just waits again
+            pal_osSemaphoreWait(pool_semaphore, PAL_RTOS_WAIT_FOREVER, NULL);
+            continue;
+        }
+
+        if (job->resource) {
+            M2MExecutePool::run(*job->resource, job->callback, job->callback2, job->value, job->value_length);
+        }
+
+        // Hand the job back to the event loop, which sends the response and frees it
+        pal_osMutexWait(pool_mutex, PAL_RTOS_WAIT_FOREVER);
+        worker->job = NULL;
+        job->next = pool_done;
+        pool_done = job;
+        const bool send_event = !pool_done_event_queued;
+        pool_done_event_queued = true;
+        pal_osMutexRelease(pool_mutex);
+
+        if (send_event) {
+            eventOS_event_send_user_allocated(&pool_done_event);
+        }
+    }
+}
+
+static void execute_pool_tasklet(arm_event_s *event)
+{
+    if (event->event_type != MBED_CLIENT_EXECUTE_POOL_DONE_EVENT) {
+        return;
+    }
+
+    // Jobs are taken one at a time, oldest first, so that cancel() still
+    // sees the rest if a response leads to a resource being deleted
+    for (;;) {
+        pal_osMutexWait(pool_mutex, PAL_RTOS_WAIT_FOREVER);
+        execute_job_s **link = &pool_done;
+        while (*link && (*link)->next) {
+            link = &(*link)->next;
+        }
+        execute_job_s *job = *link;
+        *link = NULL;
+        if (!job) {
+            pool_done_event_queued = false;
+        }
+        pal_osMutexRelease(pool_mutex);
+
+        if (!job) {
+            break;
+        }
+        if (job->resource && job->respond) {
+            job->resource->send_delayed_post_response(job->code);
+        }
+        execute_pool_free(job);
+    }
+}
+
+static bool execute_pool_start()
+{
+    if (pool_worker_count > 0) {
+        return true;
+    }
+    if (pool_failed) {
+        return false;
+    }
+
+    pool_tasklet_id = eventOS_event_handler_create(execute_pool_tasklet, MBED_CLIENT_EXECUTE_POOL_INIT_EVENT);
+    if (pool_tasklet_id < 0 ||
+            pal_osMutexCreate(&pool_mutex) != PAL_SUCCESS ||
+            pal_osSemaphoreCreate(0, &pool_semaphore) != PAL_SUCCESS) {
+        tr_error("M2MExecutePool - failed to create the pool, callbacks run on the event loop");
+        pool_failed = true;
+        return false;
+    }
+
+    pool_done_event.data.receiver = pool_tasklet_id;
+    pool_done_event.data.sender = pool_tasklet_id;
+    pool_done_event.data.event_type = MBED_CLIENT_EXECUTE_POOL_DONE_EVENT;
+    pool_done_event.data.priority = ARM_LIB_MED_PRIORITY_EVENT;
+
+    for (uint8_t i = 0; i < MBED_CLIENT_EXECUTE_THREADS; i++) {
+        pool_workers[pool_worker_count].job = NULL;
+        palThreadID_t thread;
+        if (pal_osThreadCreateWithAlloc(execute_pool_worker, &pool_workers[pool_worker_count],
+                                        PAL_osPriorityBelowNormal, MBED_CLIENT_EXECUTE_THREAD_STACK_SIZE,
+                                        NULL, &thread) != PAL_SUCCESS) {
+            tr_error("M2MExecutePool - failed to create worker %d", i);
+            break;
+        }
+        pal_osMutexWait(pool_mutex, PAL_RTOS_WAIT_FOREVER);
+        pool_worker_count++;
+        pal_osMutexRelease(pool_mutex);
+    }
+
+    if (pool_worker_count == 0) {
+        pool_failed = true;
+        return false;
+    }
+    return true;
+}
+
+bool M2MExecutePool::dispatch(M2MResource &resource, const M2MResource::M2MExecuteParameter &params)
+{
+    if (!execute_pool_start()) {
+        return false;
+    }
+
+    execute_callback *callback = (execute_callback *)M2MCallbackStorage::get_callback(resource,
+                                                                                     M2MCallbackAssociation::M2MResourceInstanceExecuteCallback);
+    execute_callback_2 callback2 = (execute_callback_2)M2MCallbackStorage::get_callback(resource,
+                                                                                       M2MCallbackAssociation::M2MResourceInstanceExecuteCallback2);
+    if (!callback && !callback2) {
+        return false;
+    }
+
+    execute_job_s *job = (execute_job_s *)malloc(sizeof(execute_job_s));
+    if (!job) {
+        return false;
+    }
+    job->value = NULL;
+    job->value_length = 0;
+    if (params._value && params._value_length) {
+        job->value = (uint8_t *)malloc(params._value_length);
+        if (!job->value) {
+            free(job);
+            return false;
+        }
+        memcpy(job->value, params._value, params._value_length);
+        job->value_length = params._value_length;
+    }
+    job->resource = &resource;
+    job->callback = callback;
+    job->callback2 = callback2;
+    job->respond = false;
+    job->code = COAP_MSG_CODE_RESPONSE_CHANGED;
+    job->next = NULL;
+
+    pal_osMutexWait(pool_mutex, PAL_RTOS_WAIT_FOREVER);
+    if (pool_queue_tail) {
+        pool_queue_tail->next = job;
+    } else {
+        pool_queue_head = job;
+    }
+    pool_queue_tail = job;
+    pal_osMutexRelease(pool_mutex);
+
+    pal_osSemaphoreRelease(pool_semaphore);
+    return true;
+}
+
+bool M2MExecutePool::defer_delayed_response(M2MResource &resource, sn_coap_msg_code_e code)
+{
+    if (pool_worker_count == 0) {
+        return false;
+    }
+
+    bool deferred = false;
+    const palThreadID_t thread = pal_osThreadGetId();
+
+    pal_osMutexWait(pool_mutex, PAL_RTOS_WAIT_FOREVER);
+    for (uint8_t i = 0; i < pool_worker_count; i++) {
+        execute_job_s *job = pool_workers[i].job;
+        if (job && pool_workers[i].thread == thread && job->resource == &resource) {
+            job->respond = true;
+            job->code = code;
+            deferred = true;
+            break;
+        }
+    }
+    pal_osMutexRelease(pool_mutex);
+
+    return deferred;
+}
+
+void M2MExecutePool::run(M2MResource &resource, execute_callback *callback, execute_callback_2 callback2,
+                         const uint8_t *value, uint16_t value_length)
+{
+#ifndef MEMORY_OPTIMIZED_API
+    const String obj_name(resource.object_name());
+    const String &res_name = resource.name();
+    M2MResource::M2MExecuteParameter exec_params(obj_name, res_name, resource.object_instance_id());
+#else
+    M2MResource::M2MExecuteParameter exec_params(resource.object_name(), resource.name(), resource.object_instance_id());
+#endif
+#ifdef MBED_CLOUD_CLIENT_EDGE_EXTENSION
+    exec_params.set_resource(&resource);
+#endif
+    exec_params._value = value;
+    exec_params._value_length = value_length;
+
+    if (callback) {
+        (*callback)(&exec_params);
+    }
+    if (callback2) {
+        (*callback2)(&exec_params);
+    }
+}
+
+void M2MExecutePool::cancel(M2MResource &resource)
+{
+    if (pool_worker_count == 0) {
+        return;
+    }
+
+    const palThreadID_t thread = pal_osThreadGetId();
+
+    pal_osMutexWait(pool_mutex, PAL_RTOS_WAIT_FOREVER);
+
+    execute_job_s **link = &pool_queue_head;
+    pool_queue_tail = NULL;
+    while (*link) {
+        execute_job_s *job = *link;
+        if (job->resource == &resource) {
+            *link = job->next;
+            execute_pool_free(job);
+        } else {
+            pool_queue_tail = job;
+            link = &job->next;
+        }
+    }
+
+    for (execute_job_s *job = pool_done; job; job = job->next) {
+        if (job->resource == &resource) {
+            job->resource = NULL;
+        }
+    }
+
+    // A callback deleting its own resource does not touch it after returning
+    for (uint8_t i = 0; i < pool_worker_count; i++) {
+        if (pool_workers[i].thread == thread && pool_workers[i].job && pool_workers[i].job->resource == &resource) {
+            pool_workers[i].job->resource = NULL;
+        }
+    }
+
+    while (execute_pool_running(&resource)) {
+        pal_osMutexRelease(pool_mutex);
+        pal_osDelay(1);
+        pal_osMutexWait(pool_mutex, PAL_RTOS_WAIT_FOREVER);
+    }
+
+    pal_osMutexRelease(pool_mutex);
+}
+
+#endif // MBED_CLIENT_EXECUTE_THREADS
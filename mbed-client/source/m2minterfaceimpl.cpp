@@ -32,6 +32,7 @@
 #include "mbed-trace/mbed_trace.h"
 #include "randLIB.h"
 #include "pal.h"
+#include "mbed-cloud-client/SpanTrace.h"
 
 #include <assert.h>
 #include <inttypes.h>
@@ -81,6 +82,9 @@ M2MInterfaceImpl::M2MInterfaceImpl(M2MInterfaceObserver &observer,
       _security(NULL),
       _initial_reconnection_time(0),
       _reconnection_time(0)
+#if MBED_CLIENT_SERVER_BACKOFF_HINT
+      , _server_backoff_time(0)
+#endif
 {
     tr_debug("M2MInterfaceImpl::M2MInterfaceImpl() -IN");
     memset(&_server_address, 0, sizeof(_server_address));
@@ -411,7 +415,9 @@ void M2MInterfaceImpl::registration_error(uint8_t error_code, bool retry, bool f
     tr_error("M2MInterfaceImpl::registration_error code [%d]", error_code);
 
     if (_binding_mode == M2MInterface::UDP || _binding_mode == M2MInterface::UDP_QUEUE) {
-        if (error_code != M2MInterface::MemoryFail && _connection_handler.is_cid_available()) {
+        // A server that asked to come back later is reachable, no need to check the network with a ping
+        if (error_code != M2MInterface::MemoryFail && _connection_handler.is_cid_available() &&
+                !has_server_backoff_hint()) {
             // Check if we can ping LWm2m server with DTLS client hello (send it immediately and lets have timeout of 60 seconds)
             //   if(server responds)
             //       CID has expired, delete CID do handshake
@@ -541,18 +547,7 @@ void M2MInterfaceImpl::bootstrap_error(M2MInterface::Error error, const char *re
 
     _retry_timer_expired = false;
     _retry_timer.stop_timer();
-    create_random_initial_reconnection_time();
-    _retry_timer.start_timer(_reconnection_time * 1000,
-                             M2MTimerObserver::RetryTimer);
-    tr_info("M2MInterfaceImpl::bootstrap_error - reconnecting in %" PRIu32 "(s)", _reconnection_time);
-    _reconnection_time = _reconnection_time * RECONNECT_INCREMENT_FACTOR;
-    // The timeout is randomized to + 10% and -10% range from reconnection value
-    _reconnection_time = randLIB_randomise_base(_reconnection_time, 0x7333, 0x8CCD);
-
-    if (_reconnection_time >= MBED_CLIENT_MAX_RECONNECT_TIMEOUT) {
-        // The max timeout is randomized to + 10% and -10% range from maximum value
-        _reconnection_time = randLIB_randomise_base(MBED_CLIENT_MAX_RECONNECT_TIMEOUT, 0x7333, 0x8CCD);
-    }
+    start_reconnection_timer();
 }
 #endif //MBED_CLIENT_DISABLE_BOOTSTRAP_FEATURE
 
@@ -681,20 +676,7 @@ void M2MInterfaceImpl::socket_error(int error_code, bool retry)
         _reconnecting = true;
         _connection_handler.stop_listening();
         _retry_timer_expired = false;
-        create_random_initial_reconnection_time();
-        _retry_timer.start_timer(_reconnection_time * 1000,
-                                 M2MTimerObserver::RetryTimer);
-
-        tr_info("M2MInterfaceImpl::socket_error - reconnecting in %" PRIu32 "(s)", _reconnection_time);
-
-        _reconnection_time = _reconnection_time * RECONNECT_INCREMENT_FACTOR;
-        // The timeout is randomized to + 10% and -10% range from reconnection value
-        _reconnection_time = randLIB_randomise_base(_reconnection_time, 0x7333, 0x8CCD);
-
-        if (_reconnection_time >= MBED_CLIENT_MAX_RECONNECT_TIMEOUT) {
-            // The max timeout is randomized to + 10% and -10% range from maximum value
-            _reconnection_time = randLIB_randomise_base(MBED_CLIENT_MAX_RECONNECT_TIMEOUT, 0x7333, 0x8CCD);
-        }
+        start_reconnection_timer();
 #ifndef DISABLE_ERROR_DESCRIPTION
         snprintf(_error_description, sizeof(_error_description), ERROR_REASON_9, error_code_des);
 #endif
@@ -707,6 +689,9 @@ void M2MInterfaceImpl::socket_error(int error_code, bool retry)
         _security = NULL;
         _reconnecting = false;
         _reconnection_time = _initial_reconnection_time;
+#if MBED_CLIENT_SERVER_BACKOFF_HINT
+        _server_backoff_time = 0;
+#endif
         _reconnection_state = M2MInterfaceImpl::None;
 #ifndef DISABLE_ERROR_DESCRIPTION
         snprintf(_error_description, sizeof(_error_description), ERROR_REASON_10, error_code_des);
@@ -766,6 +751,11 @@ void M2MInterfaceImpl::data_sent()
 
     // Delay the time when CoAP ping will be send.
     _nsdl_interface.calculate_new_coap_ping_send_time();
+
+#if MBED_CLIENT_WAKE_WINDOW
+    // The radio is on, send what would soon wake it up again
+    _nsdl_interface.wake_window_opened();
+#endif
 }
 
 void M2MInterfaceImpl::timer_expired(M2MTimerObserver::Type type)
@@ -782,8 +772,7 @@ void M2MInterfaceImpl::timer_expired(M2MTimerObserver::Type type)
 #endif // (PAL_USE_SSL_SESSION_RESUME == 0)
         } else {
             tr_debug("M2MInterfaceImpl::timer_expired() - sleep");
-            M2MTimer &timer = _nsdl_interface.get_nsdl_execution_timer();
-            timer.stop_timer();
+            _nsdl_interface.pause_nsdl_execution_timer();
             _queue_mode_timer_ongoing = true;
             if (_callback_handler) {
                 _callback_handler();
@@ -990,40 +979,45 @@ void M2MInterfaceImpl::state_register(EventData *data)
             if (_security) {
                 int32_t m2m_id = _security->get_security_instance_id(M2MSecurity::M2MServer);
                 if (m2m_id >= 0) {
-                    if (_nsdl_interface.create_nsdl_list_structure(event->_base_list)) {
-                        // If the nsdl resource structure is created successfully
-                        String server_address = _security->resource_value_string(M2MSecurity::M2MServerUri, m2m_id);
-                        _nsdl_interface.set_server_address(server_address.c_str());
-                        tr_info("M2MInterfaceImpl::state_register - server_address %s", server_address.c_str());
-                        String  coap;
-                        if (server_address.compare(0, sizeof(COAP) - 1, COAP) == 0) {
-                            coap = COAP;
-                        } else if (server_address.compare(0, sizeof(COAPS) - 1, COAPS) == 0) {
-                            _security->resource_value_int(M2MSecurity::SecurityMode, m2m_id) != M2MSecurity::NoSecurity ? coap = COAPS : coap = "";
-                        }
-                        if (!coap.empty()) {
-                            server_address = server_address.substr(coap.size(),
-                                                                   server_address.size() - coap.size());
-                            process_address(server_address, _server_ip_address, _server_port);
-
-                            tr_info("M2MInterfaceImpl::state_register - IP address %s, Port %d", _server_ip_address.c_str(), _server_port);
-                            if (!_server_ip_address.empty()) {
-                                // Backoff logic not needed in DTLS mode. DTLS timer will handle timeouts properly.
-                                // This timer is stopped when handshake is completed (address resolved).
-                                if (_binding_mode == TCP || _binding_mode == TCP_QUEUE) {
-                                    _retry_timer.stop_timer();
-                                    _retry_timer.start_timer(HANDSHAKE_TIMEOUT_MSECS, M2MTimerObserver::RegistrationFlowTimer);
-                                }
+                    String server_address = _security->resource_value_string(M2MSecurity::M2MServerUri, m2m_id);
+                    _nsdl_interface.set_server_address(server_address.c_str());
+                    tr_info("M2MInterfaceImpl::state_register - server_address %s", server_address.c_str());
+                    String  coap;
+                    if (server_address.compare(0, sizeof(COAP) - 1, COAP) == 0) {
+                        coap = COAP;
+                    } else if (server_address.compare(0, sizeof(COAPS) - 1, COAPS) == 0) {
+                        _security->resource_value_int(M2MSecurity::SecurityMode, m2m_id) != M2MSecurity::NoSecurity ? coap = COAPS : coap = "";
+                    }
+                    if (!coap.empty()) {
+                        server_address = server_address.substr(coap.size(),
+                                                               server_address.size() - coap.size());
+                        process_address(server_address, _server_ip_address, _server_port);
+
+                        tr_info("M2MInterfaceImpl::state_register - IP address %s, Port %d", _server_ip_address.c_str(), _server_port);
+                        if (!_server_ip_address.empty()) {
+                            // Backoff logic not needed in DTLS mode. DTLS timer will handle timeouts properly.
+                            // This timer is stopped when handshake is completed (address resolved).
+                            if (_binding_mode == TCP || _binding_mode == TCP_QUEUE) {
+                                _retry_timer.stop_timer();
+                                _retry_timer.start_timer(HANDSHAKE_TIMEOUT_MSECS, M2MTimerObserver::RegistrationFlowTimer);
+                            }
+
+                            update_network_latency_configurations_with_rtt();
+                            _connection_handler.resolve_server_address(_server_ip_address, _server_port,
+                                                                       M2MConnectionObserver::LWM2MServer,
+                                                                       _security);
 
+                            // The address is resolved asynchronously, build the resource
+                            // structure meanwhile. The registration message is created
+                            // from it only once the address is known.
+                            if (_nsdl_interface.create_nsdl_list_structure(event->_base_list)) {
                                 error = M2MInterface::ErrorNone;
-                                update_network_latency_configurations_with_rtt();
-                                _connection_handler.resolve_server_address(_server_ip_address, _server_port,
-                                                                           M2MConnectionObserver::LWM2MServer,
-                                                                           _security);
+                            } else {
+                                tr_error("M2MInterfaceImpl::state_register - fail to create nsdl list structure!");
+                                _retry_timer.stop_timer();
+                                _connection_handler.force_close();
                             }
                         }
-                    } else {
-                        tr_error("M2MInterfaceImpl::state_register - fail to create nsdl list structure!");
                     }
                 }
             }
@@ -1036,9 +1030,6 @@ void M2MInterfaceImpl::state_register(EventData *data)
         }
     } else {
         _listen_port = 0;
-        if (event) {
-            _nsdl_interface.create_nsdl_list_structure(event->_base_list);
-        }
         _connection_handler.bind_connection(_listen_port);
 
         // Backoff logic not needed in DTLS mode. DTLS timer will handle timeouts properly.
@@ -1052,6 +1043,9 @@ void M2MInterfaceImpl::state_register(EventData *data)
         _connection_handler.resolve_server_address(_server_ip_address, _server_port,
                                                    M2MConnectionObserver::LWM2MServer,
                                                    _security);
+        if (event) {
+            _nsdl_interface.create_nsdl_list_structure(event->_base_list);
+        }
     }
 }
 
@@ -1115,6 +1109,13 @@ void M2MInterfaceImpl::state_register_address_resolved(EventData *data)
 
         switch (_reconnection_state) {
             case M2MInterfaceImpl::None:
+#if MBED_CLIENT_REGISTRATION_RESUME
+                // Registration made before a reset is refreshed with an update, over the stored DTLS session
+                if (_connection_handler.is_cid_available() && _nsdl_interface.resume_registration()) {
+                    internal_event(STATE_UPDATE_REGISTRATION);
+                    break;
+                }
+#endif
                 if (!_nsdl_interface.send_register_message()) {
                     // If resource creation fails then inform error to application
                     tr_error("M2MInterfaceImpl::state_register_address_resolved : M2MInterface::MemoryFail");
@@ -1141,6 +1142,9 @@ void M2MInterfaceImpl::state_registered(EventData */*data*/)
     _retry_timer.stop_timer();
 
     _reconnection_time = _initial_reconnection_time;
+#if MBED_CLIENT_SERVER_BACKOFF_HINT
+    _server_backoff_time = 0;
+#endif
     _reconnecting = false;
     _nsdl_interface.set_registration_status(true);
     // Continue with the unregistration process if it has failed due to connection lost
@@ -1345,6 +1349,7 @@ void M2MInterfaceImpl::internal_event(uint8_t new_state,
     _event_data = p_data;
     _event_generated = true;
     _current_state = new_state;
+    SPAN_TRACE_INSTANT(M2M_STATE, new_state);
     state_engine();
 }
 
@@ -1564,7 +1569,7 @@ void M2MInterfaceImpl::network_interface_status_change(NetworkInterfaceStatus st
 {
     if (status == M2MConnectionObserver::NetworkInterfaceConnected) {
         tr_info("M2MInterfaceImpl::network_interface_status_change - connected");
-        if (_reconnecting) {
+        if (_reconnecting && !has_server_backoff_hint()) {
             // Estimate new reconnection time based on Stagger. This ensures controlled recovery in constrained network with large number of devices.
             uint32_t rand_time = 10 + _nsdl_interface.get_network_stagger_estimate(false);
             // The new timeout is randomized to + 10% and -10% range from original random value
@@ -1585,6 +1590,18 @@ void M2MInterfaceImpl::network_interface_status_change(NetworkInterfaceStatus st
         }
         _observer.network_status_changed(true);
 
+    } else if (status == M2MConnectionObserver::NetworkInterfaceRebound) {
+        tr_info("M2MInterfaceImpl::network_interface_status_change - connected, DTLS session kept");
+        // Let the server learn the new address right away. If it no longer accepts the
+        // connection ID, the update fails and the normal reconnection does a full handshake.
+        if (_nsdl_interface.is_registered() && !_reconnecting && !_nsdl_interface.is_update_register_ongoing()) {
+            M2MUpdateRegisterData data;
+            data._object = _security;
+            data._lifetime = 0;
+            start_register_update(&data);
+        }
+        _observer.network_status_changed(true);
+
     } else {
         tr_info("M2MInterfaceImpl::network_interface_status_change - disconnected");
         _observer.network_status_changed(false);
@@ -1603,6 +1620,60 @@ void M2MInterfaceImpl::create_random_initial_reconnection_time()
     }
 }
 
+void M2MInterfaceImpl::start_reconnection_timer()
+{
+    create_random_initial_reconnection_time();
+
+#if MBED_CLIENT_SERVER_BACKOFF_HINT
+    uint32_t hint = _nsdl_interface.take_server_backoff_hint();
+    if (hint) {
+        // Kept over the reconnection attempts until registered again
+        _server_backoff_time = hint;
+        tr_info("M2MInterfaceImpl::start_reconnection_timer - server asked to retry after %" PRIu32 "(s)", hint);
+    }
+
+    if (_server_backoff_time) {
+        // Decorrelated jitter: random wait between the server hint and three times the previous wait,
+        // so that devices told the same hint spread over a growing window instead of retrying together.
+        uint32_t max_time = MBED_CLIENT_MAX_RECONNECT_TIMEOUT;
+        if (max_time < _server_backoff_time) {
+            max_time = _server_backoff_time;
+        }
+        uint32_t upper = (_reconnection_time > max_time / 3) ? max_time : _reconnection_time * 3;
+        if (upper < _server_backoff_time) {
+            upper = _server_backoff_time;
+        }
+        _reconnection_time = _server_backoff_time + randLIB_get_32bit() % (upper - _server_backoff_time + 1);
+
+        _retry_timer.start_timer(_reconnection_time * 1000, M2MTimerObserver::RetryTimer);
+        tr_info("M2MInterfaceImpl::start_reconnection_timer - reconnecting in %" PRIu32 "(s)", _reconnection_time);
+        return;
+    }
+#endif
+
+    _retry_timer.start_timer(_reconnection_time * 1000,
+                             M2MTimerObserver::RetryTimer);
+    tr_info("M2MInterfaceImpl::start_reconnection_timer - reconnecting in %" PRIu32 "(s)", _reconnection_time);
+
+    _reconnection_time = _reconnection_time * RECONNECT_INCREMENT_FACTOR;
+    // The timeout is randomized to + 10% and -10% range from reconnection value
+    _reconnection_time = randLIB_randomise_base(_reconnection_time, 0x7333, 0x8CCD);
+
+    if (_reconnection_time >= MBED_CLIENT_MAX_RECONNECT_TIMEOUT) {
+        // The max timeout is randomized to + 10% and -10% range from maximum value
+        _reconnection_time = randLIB_randomise_base(MBED_CLIENT_MAX_RECONNECT_TIMEOUT, 0x7333, 0x8CCD);
+    }
+}
+
+bool M2MInterfaceImpl::has_server_backoff_hint() const
+{
+#if MBED_CLIENT_SERVER_BACKOFF_HINT
+    return _server_backoff_time || _nsdl_interface.server_backoff_hint();
+#else
+    return false;
+#endif
+}
+
 void M2MInterfaceImpl::update_network_latency_configurations_with_rtt()
 {
     tr_debug("M2MInterfaceImpl::update_network_latency_configurations_with_rtt(): %d", _nsdl_interface.get_network_rtt_estimate());
@@ -1632,3 +1703,41 @@ void M2MInterfaceImpl::set_cid_value(const uint8_t *data_ptr, const size_t data_
 {
     _nsdl_interface.set_cid_value(data_ptr, data_len);
 }
+
+#if MBED_CLIENT_LWM2M_SEND_SAMPLES
+bool M2MInterfaceImpl::add_send_path(M2MBase *base)
+{
+    return _nsdl_interface.add_send_path(base);
+}
+
+void M2MInterfaceImpl::remove_send_path(M2MBase *base)
+{
+    _nsdl_interface.remove_send_path(base);
+}
+
+void M2MInterfaceImpl::set_send_storage(send_storage_load_cb load_cb, send_storage_save_cb save_cb, void *context)
+{
+    _nsdl_interface.set_send_storage(load_cb, save_cb, context);
+}
+#endif
+
+#if MBED_CLIENT_REGISTRATION_RESUME
+void M2MInterfaceImpl::set_registration_storage(registration_storage_load_cb load_cb, registration_storage_save_cb save_cb, void *context)
+{
+    _nsdl_interface.set_registration_storage(load_cb, save_cb, context);
+}
+#endif
+
+#if MBED_CLIENT_WAKE_WINDOW
+uint64_t M2MInterfaceImpl::next_wake_time()
+{
+    return _nsdl_interface.next_wake_time();
+}
+#endif
+
+#if MBED_CLIENT_LATENCY_HISTOGRAM
+void M2MInterfaceImpl::get_latency_histogram(LatencyOperation operation, uint32_t *buckets, bool reset)
+{
+    _nsdl_interface.get_latency_histogram(operation, buckets, reset);
+}
+#endif
@@ -29,6 +29,8 @@
 #include "include/m2mnsdlobserver.h"
 #include "include/m2mtlvdeserializer.h"
 #include "include/m2mtlvserializer.h"
+#include "include/m2msenmlcborserializer.h"
+#include "include/m2mcompositeobservation.h"
 #include "include/m2mnsdlinterface.h"
 #include "include/m2mreporthandler.h"
 #include "mbed-client/m2mstring.h"
@@ -87,6 +89,10 @@
 #define MAX_QUERY_COUNT 10
 
 #define REGISTRATION_UPDATE_DELAY 10 // wait 10ms before sending registration update for PUT to resource 1/0/1
+#if MBED_CLIENT_WAKE_WINDOW
+#define WAKE_WINDOW_DELAY 10 // wait 10ms after data is sent before sending what is due within the wake window
+#endif
+#define LWM2M_SEND_URI "dp" // LwM2M 1.1 Send operation, data reporting interface
 
 const char *MCC_VERSION = "mccv=4.10.0";
 
@@ -232,6 +238,9 @@ M2MNsdlInterface::M2MNsdlInterface(M2MNsdlObserver &observer, M2MConnectionHandl
       _connection_handler(connection_handler),
       _counter_for_nsdl(0),
       _next_coap_ping_send_time(0),
+      _nsdl_execution_interval(0),
+      _nsdl_execution_elapsed(0),
+      _nsdl_execution_phase(0),
       _server_address(NULL),
       _custom_uri_query_params(NULL),
       _notification_handler(new M2MNotificationHandler()),
@@ -249,9 +258,39 @@ M2MNsdlInterface::M2MNsdlInterface(M2MNsdlObserver &observer, M2MConnectionHandl
       _alert_mode(false),
       _last_notif_queue_event(M2MNsdlInterface::SEND_NOTIFICATION),
       _current_request_code(COAP_MSG_CODE_EMPTY)
+#if MBED_CLIENT_LWM2M_SEND_SAMPLES
+      , _send_timer(*this),
+      _send_load_cb(NULL),
+      _send_save_cb(NULL),
+      _send_storage_context(NULL),
+      _send_token(0),
+      _next_send_time(0),
+      _send_in_flight(0)
+#endif
+#if MBED_CLIENT_REGISTRATION_RESUME
+      , _registration_load_cb(NULL),
+      _registration_save_cb(NULL),
+      _registration_storage_context(NULL),
+      _registration_resume_pending(false),
+      _registration_resumed(false)
+#endif
+#if MBED_CLIENT_SERVER_BACKOFF_HINT
+      , _server_backoff_hint(0)
+#endif
+#if MBED_CLIENT_LATENCY_HISTOGRAM
+      , _register_sent_ticks(0),
+      _update_sent_ticks(0)
+#endif
+#if MBED_CLIENT_WAKE_WINDOW
+      , _wake_window_timer(*this)
+#endif
 {
     tr_debug("M2MNsdlInterface::M2MNsdlInterface()");
 
+#if PERF_COUNTERS_ENABLED
+    memset(&_coap_stats_published, 0, sizeof(_coap_stats_published));
+#endif
+
     _event.data.data_ptr = NULL;
     _event.data.event_data = 0;
     _event.data.event_id = 0;
@@ -280,6 +319,13 @@ M2MNsdlInterface::M2MNsdlInterface(M2MNsdlObserver &observer, M2MConnectionHandl
 
     _event.data.receiver = M2MNsdlInterface::_tasklet_id;
 
+#if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1) && (MBED_CLIENT_REPORT_TIMER_TOLERANCE > 0)
+    M2MReportScheduler::acquire_instance();
+#endif
+#if MBED_CLIENT_LATENCY_HISTOGRAM
+    memset(_latency_histogram, 0, sizeof(_latency_histogram));
+#endif
+
     initialize();
 }
 
@@ -295,6 +341,9 @@ M2MNsdlInterface::~M2MNsdlInterface()
         memory_free(_endpoint);
     }
 
+#if MBED_CLIENT_COMPOSITE_OPERATIONS
+    clear_composite_observations();
+#endif
     delete _notification_handler;
     _base_list.clear();
     _security = NULL;
@@ -305,6 +354,9 @@ M2MNsdlInterface::~M2MNsdlInterface()
     free_request_context_list(NULL, false);
     free_response_list();
     memory_free(_custom_uri_query_params);
+#if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1) && (MBED_CLIENT_REPORT_TIMER_TOLERANCE > 0)
+    M2MReportScheduler::release_instance();
+#endif
     tr_debug("M2MNsdlInterface::~M2MNsdlInterface() - OUT");
 }
 
@@ -342,6 +394,11 @@ bool M2MNsdlInterface::initialize()
     create_nsdl_object_structure(_server);
     ns_list_init(&_request_context_list);
     ns_list_init(&_response_list);
+#if MBED_CLIENT_RESPONSE_INDEX_SIZE
+    memset(_request_token_index, 0, sizeof(_request_token_index));
+    memset(_response_id_index, 0, sizeof(_response_id_index));
+    memset(_response_uri_index, 0, sizeof(_response_uri_index));
+#endif
 
     return success;
 }
@@ -548,10 +605,14 @@ bool M2MNsdlInterface::send_register_message()
 {
     tr_info("M2MNsdlInterface::send_register_message()");
     bool success = false;
+    update_nsdl_time();
 
     // Clear the observation tokens
     send_next_notification(M2MNsdlInterface::CLEAR_NOTIFICATION_TOKEN);
 
+#if MBED_CLIENT_LATENCY_HISTOGRAM
+    _register_sent_ticks = eventOS_event_timer_ticks();
+#endif
     if (_server_address) {
         success = parse_and_send_uri_query_parameters();
     }
@@ -579,6 +640,7 @@ void M2MNsdlInterface::send_request(DownloadType type,
     assert(uri != NULL);
     int32_t message_id = 0;
     request_context_s *data_request = NULL;
+    update_nsdl_time();
 
     if (msg_code == COAP_MSG_CODE_REQUEST_GET && (!_registered || _alert_mode)) {
         tr_error("M2MNsdlInterface::send_request - client registered: %d, alert mode: %d!", _registered, _alert_mode);
@@ -636,6 +698,15 @@ void M2MNsdlInterface::send_request(DownloadType type,
         data_request->msg_code = msg_code;
 
         ns_list_add_to_end(&_request_context_list, data_request);
+#if MBED_CLIENT_RESPONSE_INDEX_SIZE
+        // Appended to the bucket so that a duplicate token is found in list order
+        data_request->token_next = NULL;
+        request_context_s **link = &_request_token_index[index_bucket(token)];
+        while (*link) {
+            link = &(*link)->token_next;
+        }
+        *link = data_request;
+#endif
 
     }
 
@@ -645,6 +716,9 @@ void M2MNsdlInterface::send_request(DownloadType type,
         return;
     }
 
+#if MBED_CLIENT_LATENCY_HISTOGRAM
+    data_request->sent_ticks = eventOS_event_timer_ticks();
+#endif
     message_id = sn_nsdl_send_request(_nsdl_handle,
                                       data_request->msg_code,
                                       data_request->uri_path,
@@ -657,9 +731,7 @@ void M2MNsdlInterface::send_request(DownloadType type,
     if (message_id == SN_NSDL_RESEND_QUEUE_FULL) {
         data_request->resend = true;
     } else if (message_id <= 0) {
-        ns_list_remove(&_request_context_list, data_request);
-        memory_free(data_request->uri_path);
-        memory_free(data_request);
+        remove_request(data_request);
         error_cb(FAILED_TO_ALLOCATE_MEMORY, context);
     }
 }
@@ -671,6 +743,7 @@ bool M2MNsdlInterface::send_update_registration(const uint32_t lifetime)
 
     bool success = false;
     bool lifetime_changed = true;
+    update_nsdl_time();
 
     _registration_timer.stop_timer();
 
@@ -687,6 +760,9 @@ bool M2MNsdlInterface::send_update_registration(const uint32_t lifetime)
         set_endpoint_lifetime_buffer(lifetime);
     }
 
+#if MBED_CLIENT_LATENCY_HISTOGRAM
+    _update_sent_ticks = eventOS_event_timer_ticks();
+#endif
     int32_t ret = do_send_update_register(lifetime_changed);
     if (ret == SN_NSDL_RESEND_QUEUE_FULL) {
         tr_warn("M2MNsdlInterface::send_update_registration - resend queue full, try again after clearing the queue");
@@ -712,6 +788,7 @@ bool M2MNsdlInterface::send_unregister_message()
         return true;
     }
 
+    update_nsdl_time();
     if (sn_nsdl_unregister_endpoint(_nsdl_handle) > 0) {
         return true;
     }
@@ -753,7 +830,11 @@ uint8_t M2MNsdlInterface::send_to_server_callback(struct nsdl_s * /*nsdl_handle*
                                                   sn_nsdl_addr_s *address)
 {
     tr_debug("M2MNsdlInterface::send_to_server_callback(data size %d)", data_len);
+    PERF_COUNTER_ADD(COAP_MESSAGES_SENT, 1);
+    PERF_COUNTER_ADD(COAP_BYTES_SENT, data_len);
     _observer.coap_message_ready(data_ptr, data_len, address);
+    // A stored message may need to be re-sent before the execution timer would expire
+    schedule_nsdl_execution(true);
     return 1;
 }
 
@@ -793,7 +874,15 @@ uint8_t M2MNsdlInterface::received_from_server_callback(struct nsdl_s *nsdl_hand
 
             handle_register_update_response(coap_header);
 
-        } else if (coap_header->token_ptr && is_response_to_request(coap_header, request_context)) {
+        }
+#if MBED_CLIENT_LWM2M_SEND_SAMPLES
+        else if (is_send_response(coap_header)) {
+
+            handle_send_response(coap_header);
+
+        }
+#endif
+        else if (coap_header->token_ptr && is_response_to_request(coap_header, request_context)) {
 
             handle_request_response(coap_header, &request_context);
 
@@ -869,7 +958,15 @@ uint8_t M2MNsdlInterface::received_from_server_callback(struct nsdl_s *nsdl_hand
                                                              obj_instance,
                                                              is_bootstrap_msg);
 
-            } else if (COAP_STATUS_BUILDER_BLOCK_SENDING_DONE == coap_header->coap_status &&
+            }
+#if MBED_CLIENT_COMPOSITE_OPERATIONS
+            else if (COAP_MSG_CODE_REQUEST_FETCH == coap_header->msg_code && !is_bootstrap_msg) {
+
+                value = handle_composite_request(coap_header, address);
+
+            }
+#endif
+            else if (COAP_STATUS_BUILDER_BLOCK_SENDING_DONE == coap_header->coap_status &&
                        (coap_header->msg_code == COAP_MSG_CODE_RESPONSE_CONTENT ||
                         coap_header->msg_code == COAP_MSG_CODE_RESPONSE_CHANGED)) {
 
@@ -884,6 +981,11 @@ uint8_t M2MNsdlInterface::received_from_server_callback(struct nsdl_s *nsdl_hand
                             base->handle_observation(nsdl_handle, *coap_header, *coap_header, this, code);
                             base->start_observation(*coap_header, this);
                         } else {
+#if MBED_CLIENT_LATENCY_HISTOGRAM
+                            if (resp->type == M2MBase::NOTIFICATION) {
+                                record_latency(M2MInterface::LatencyNotification, resp->sent_ticks);
+                            }
+#endif
                             handle_message_status_callback(base, resp->type, M2MBase::MESSAGE_STATUS_DELIVERED);
                         }
 
@@ -904,6 +1006,11 @@ uint8_t M2MNsdlInterface::received_from_server_callback(struct nsdl_s *nsdl_hand
                     if (base && resp->type != M2MBase::NOTIFICATION) {
                         handle_message_status_callback(base, resp->type, M2MBase::MESSAGE_STATUS_SEND_FAILED);
                     }
+#if MBED_CLIENT_ADAPTIVE_CONFIRMABLE
+                    if (base && resp->type == M2MBase::NOTIFICATION && base->report_handler()) {
+                        base->report_handler()->notification_lost();
+                    }
+#endif
                     free_response_list();
                 }
 
@@ -1314,8 +1421,11 @@ bool M2MNsdlInterface::process_received_data(uint8_t *data,
                                              sn_nsdl_addr_s *address)
 {
     tr_debug("M2MNsdlInterface::process_received_data(data size %d)", data_size);
+    PERF_COUNTER_ADD(COAP_MESSAGES_RECEIVED, 1);
+    PERF_COUNTER_ADD(COAP_BYTES_RECEIVED, data_size);
 
     sn_coap_hdr_s *coap_packet_ptr = NULL;
+    update_nsdl_time();
     /* Parse CoAP packet */
     coap_packet_ptr = sn_coap_protocol_parse(_nsdl_handle->grs->coap, address, data_size, data, (void *)_nsdl_handle);
 
@@ -1345,6 +1455,7 @@ void M2MNsdlInterface::stop_timers()
     _registration_timer.stop_timer();
     _nsdl_execution_timer.stop_timer();
     _nsdl_execution_timer_running = false;
+    _nsdl_execution_interval = 0;
     _bootstrap_id = 0;
     _nsdl_handle->update_register_token = 0;
     _nsdl_handle->unregister_token = 0;
@@ -1375,9 +1486,17 @@ bool M2MNsdlInterface::alert_mode() const
 void M2MNsdlInterface::timer_expired(M2MTimerObserver::Type type)
 {
     if (M2MTimerObserver::NsdlExecution == type) {
+        _counter_for_nsdl += _nsdl_execution_interval - _nsdl_execution_elapsed;
+        _nsdl_execution_interval = 0;
         sn_nsdl_exec(_nsdl_handle, _counter_for_nsdl);
-        _counter_for_nsdl++;
+#if PERF_COUNTERS_ENABLED
+        publish_coap_stats();
+#endif
         send_coap_ping();
+        // Callbacks from exec may have stopped or restarted the client
+        if (_nsdl_execution_timer_running && !_nsdl_execution_interval) {
+            schedule_nsdl_execution(false);
+        }
     } else if ((M2MTimerObserver::Registration) == type &&
                (is_unregister_ongoing() == false) &&
                (is_update_register_ongoing() == false)) {
@@ -1389,6 +1508,16 @@ void M2MNsdlInterface::timer_expired(M2MTimerObserver::Type type)
     } else if (M2MTimerObserver::RetryTimer == type) {
         send_pending_request();
     }
+#if MBED_CLIENT_LWM2M_SEND_SAMPLES
+    else if (M2MTimerObserver::LwM2MSend == type) {
+        send_samples();
+    }
+#endif
+#if MBED_CLIENT_WAKE_WINDOW
+    else if (M2MTimerObserver::WakeWindow == type) {
+        send_due_within_wake_window();
+    }
+#endif
 }
 
 bool M2MNsdlInterface::observation_to_be_sent(M2MBase *object,
@@ -1397,6 +1526,7 @@ bool M2MNsdlInterface::observation_to_be_sent(M2MBase *object,
                                               bool send_object)
 {
     claim_mutex();
+    update_nsdl_time();
 
     if (object && _nsdl_execution_timer_running && _registered) {
         tr_debug("M2MNsdlInterface::observation_to_be_sent() uri %s", object->uri_path());
@@ -1436,6 +1566,7 @@ void M2MNsdlInterface::send_delayed_response(M2MBase *base, sn_coap_msg_code_e c
 {
     claim_mutex();
     tr_debug("M2MNsdlInterface::send_delayed_response()");
+    update_nsdl_time();
     M2MResource *resource = NULL;
     if (base) {
         if (M2MBase::Resource == base->base_type()) {
@@ -1460,7 +1591,7 @@ void M2MNsdlInterface::send_delayed_response(M2MBase *base, sn_coap_msg_code_e c
 
                 if (sn_nsdl_send_coap_message(_nsdl_handle, &_nsdl_handle->server_address, &coap_response) >= 0) {
                     // Update msgid, this will be used to track server response
-                    resp->msg_id = coap_response.msg_id;
+                    set_response_msg_id(resp, coap_response.msg_id);
                     handle_message_status_callback(base, M2MBase::DELAYED_POST_RESPONSE, M2MBase::MESSAGE_STATUS_SENT);
                 } else {
                     // Failed to create a message
@@ -1490,6 +1621,7 @@ void M2MNsdlInterface::send_asynchronous_response(M2MBase *base,
 {
     claim_mutex();
     tr_debug("M2MNsdlInterface::send_asynchronous_response() %s", base->uri_path());
+    update_nsdl_time();
     if (base) {
         coap_response_s *resp = find_delayed_response(base->uri_path(), M2MBase::DELAYED_RESPONSE);
         // If there is no response it means that this API is called
@@ -1509,7 +1641,7 @@ void M2MNsdlInterface::send_asynchronous_response(M2MBase *base,
 
                 if (sn_nsdl_send_coap_message(_nsdl_handle, &_nsdl_handle->server_address, coap_response) >= 0) {
                     // Update msgid, this will be used to track server response
-                    resp->msg_id = coap_response->msg_id;
+                    set_response_msg_id(resp, coap_response->msg_id);
                     handle_message_status_callback(base, M2MBase::DELAYED_RESPONSE, M2MBase::MESSAGE_STATUS_SENT);
                     msg_sent = true;
                     if (M2MBase::is_blockwise_needed(_nsdl_handle, payload_len)) {
@@ -1545,6 +1677,21 @@ void M2MNsdlInterface::resource_to_be_deleted(M2MBase *base)
     remove_nsdl_resource(base);
 #if !defined(DISABLE_DELAYED_RESPONSE) || defined(ENABLE_ASYNC_REST_RESPONSE)
     remove_items_from_response_list_for_uri(base->uri_path());
+#endif
+#if MBED_CLIENT_COMPOSITE_OPERATIONS
+    // Children are deleted first and each reports itself, so exact matches are enough
+    int index = 0;
+    while (index < _composite_observations.size()) {
+        M2MCompositeObservation *observation = _composite_observations[index];
+        if (!observation->remove_path(*base)) {
+            delete_composite_observation(observation);
+        } else {
+            index++;
+        }
+    }
+#endif
+#if MBED_CLIENT_LWM2M_SEND_SAMPLES
+    remove_send_path(base);
 #endif
     // Since the M2MObject's are stored in _base_list, they need to be removed from there also.
     if (base && base->base_type() == M2MBase::Object) {
@@ -1811,6 +1958,7 @@ bool M2MNsdlInterface::create_nsdl_resource(M2MBase *base)
             if (endpoint->is_deleted()) {
                 sn_nsdl_dynamic_resource_parameters_s *nsdl_resource = endpoint->get_nsdl_resource();
                 nsdl_resource->registered = SN_NDSL_RESOURCE_DELETE;
+                sn_nsdl_resource_changed(_nsdl_handle, nsdl_resource);
             }
         }
 #endif
@@ -1855,11 +2003,140 @@ uint32_t M2MNsdlInterface::registration_time() const
     return value;
 }
 
+bool M2MNsdlInterface::path_component_to_id(const char *component, size_t length, uint16_t &id)
+{
+    // Accept only canonical decimal numbers, as used when instance paths are created
+    if (length == 0 || length > 5 || (length > 1 && component[0] == '0')) {
+        return false;
+    }
+
+    uint32_t value = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (component[i] < '0' || component[i] > '9') {
+            return false;
+        }
+        value = value * 10 + (component[i] - '0');
+    }
+
+    if (value > UINT16_MAX) {
+        return false;
+    }
+
+    id = (uint16_t)value;
+    return true;
+}
+
+bool M2MNsdlInterface::path_component_matches(const char *name, const char *component, size_t length)
+{
+    return (name && strncmp(name, component, length) == 0 && name[length] == '\0');
+}
+
+bool M2MNsdlInterface::resolve_resource_path(const char *path, M2MBase *&found) const
+{
+    const char *component[4];
+    size_t component_length[4];
+    uint8_t depth = 0;
+    uint16_t id = 0;
+
+    found = NULL;
+
+    if (!path) {
+        return false;
+    }
+
+    // Split the path into object/instance/resource/resource instance components
+    const char *start = path;
+    while (true) {
+        const char *end = strchr(start, '/');
+        size_t length = end ? (size_t)(end - start) : strlen(start);
+        if (length == 0 || depth == 4) {
+            return false;
+        }
+        component[depth] = start;
+        component_length[depth] = length;
+        depth++;
+        if (!end) {
+            break;
+        }
+        start = end + 1;
+    }
+
+    // Object level
+    M2MObject *object = NULL;
+    M2MBaseList::const_iterator it = _base_list.begin();
+    for (; it != _base_list.end(); it++) {
+        if ((*it)->base_type() == M2MBase::Object &&
+                path_component_matches((*it)->name(), component[0], component_length[0])) {
+            object = (M2MObject *)*it;
+            break;
+        }
+    }
+
+    if (!object) {
+#ifdef MBED_CLOUD_CLIENT_EDGE_EXTENSION
+        // Path may point below an endpoint directory, let the full walk handle it.
+        return false;
+#else
+        return true;
+#endif
+    }
+
+    found = object;
+
+    // Object instance level
+    if (depth > 1) {
+        if (!path_component_to_id(component[1], component_length[1], id)) {
+            found = NULL;
+            return false;
+        }
+        M2MObjectInstance *object_instance = object->object_instance(id);
+        found = object_instance;
+
+        // Resource level
+        if (object_instance && depth > 2) {
+            M2MResource *resource = NULL;
+            const M2MResourceList &list = object_instance->resources();
+            M2MResourceList::const_iterator res = list.begin();
+            for (; res != list.end(); res++) {
+                if (path_component_matches((*res)->name(), component[2], component_length[2])) {
+                    resource = *res;
+                    break;
+                }
+            }
+            found = resource;
+
+            // Resource instance level
+            if (resource && depth > 3) {
+                found = NULL;
+                if (!path_component_to_id(component[3], component_length[3], id)) {
+                    return false;
+                }
+                if (resource->supports_multiple_instances()) {
+                    found = resource->resource_instance(id);
+                }
+            }
+        }
+    }
+
+    // Names containing '/' are not resolvable by components, fall back to the full walk.
+    if (found && strcmp(found->uri_path(), path) != 0) {
+        found = NULL;
+        return false;
+    }
+
+    return true;
+}
+
 M2MBase *M2MNsdlInterface::find_resource(const String &object_name) const
 {
     tr_debug("M2MNsdlInterface::find_resource(object level) - from %p name (%s) ", this, object_name.c_str());
     M2MObject *current = NULL;
     M2MBase *found = NULL;
+
+    if (resolve_resource_path(object_name.c_str(), found)) {
+        return found;
+    }
+
     if (!_base_list.empty()) {
         M2MBaseList::const_iterator it;
         it = _base_list.begin();
@@ -2153,9 +2430,18 @@ void M2MNsdlInterface::send_object_observation(M2MObject *object,
         uint32_t length = 0;
         uint8_t token[MAX_TOKEN_SIZE];
         uint8_t token_length = 0;
+#if defined (MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR) && (MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR == 1)
+        // Changes collected during the observation period are sent as one SenML pack
+        const bool senml_cbor = (object->coap_content_type() == COAP_CONTENT_OMA_SENML_CBOR_TYPE);
+#endif
 
         // Send whole object structure
         if (send_object) {
+#if defined (MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR) && (MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR == 1)
+            if (senml_cbor) {
+                value = M2MSenMLCborSerializer::serialize(*object, object->instances(), length);
+            } else
+#endif
             value = M2MTLVSerializer::serialize(object->instances(), length);
         }
         // Send only changed object instances
@@ -2170,6 +2456,29 @@ void M2MNsdlInterface::send_object_observation(M2MObject *object,
                 }
             }
             if (!list.empty()) {
+#if MBED_CLIENT_OBSERVATION_DIFF
+                if (senml_cbor) {
+                    // Changed resources of each instance, with full paths
+                    M2MBaseList changed;
+                    M2MObjectInstanceList::const_iterator inst = list.begin();
+                    for (; inst != list.end(); inst++) {
+                        if ((*inst)->is_under_observation()) {
+                            // The tracked changes belong to the observation of the instance
+                            changed.push_back(*inst);
+                        } else {
+                            add_changed_resources(**inst, changed);
+                        }
+                    }
+                    value = M2MSenMLCborSerializer::serialize(changed, length);
+                    if (!value) {
+                        value = M2MSenMLCborSerializer::serialize(*object, list, length);
+                    }
+                } else
+#elif defined (MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR) && (MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR == 1)
+                if (senml_cbor) {
+                    value = M2MSenMLCborSerializer::serialize(*object, list, length);
+                } else
+#endif
                 value = M2MTLVSerializer::serialize(list, length);
                 list.clear();
             }
@@ -2199,6 +2508,21 @@ void M2MNsdlInterface::send_object_instance_observation(M2MObjectInstance *objec
         uint8_t token[MAX_TOKEN_SIZE];
         uint8_t token_length = 0;
 
+#if MBED_CLIENT_OBSERVATION_DIFF
+        if (object_instance->coap_content_type() == COAP_CONTENT_OMA_SENML_CBOR_TYPE) {
+            M2MBaseList changed;
+            if (add_changed_resources(*object_instance, changed)) {
+                value = M2MSenMLCborSerializer::serialize(changed, length);
+            }
+            if (!value) {
+                value = M2MSenMLCborSerializer::serialize(*object_instance, length);
+            }
+        } else
+#elif defined (MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR) && (MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR == 1)
+        if (object_instance->coap_content_type() == COAP_CONTENT_OMA_SENML_CBOR_TYPE) {
+            value = M2MSenMLCborSerializer::serialize(*object_instance, length);
+        } else
+#endif
         value = M2MTLVSerializer::serialize(object_instance->resources(), length);
 
         object_instance->get_observation_token((uint8_t *)&token, token_length);
@@ -2215,6 +2539,22 @@ void M2MNsdlInterface::send_object_instance_observation(M2MObjectInstance *objec
     }
 }
 
+#if MBED_CLIENT_OBSERVATION_DIFF
+bool M2MNsdlInterface::add_changed_resources(M2MObjectInstance &object_instance, M2MBaseList &list)
+{
+    M2MResourceList resources;
+    if (!object_instance.take_changed_resources(resources)) {
+        list.push_back(&object_instance);
+        return false;
+    }
+    M2MResourceList::const_iterator it = resources.begin();
+    for (; it != resources.end(); it++) {
+        list.push_back(*it);
+    }
+    return true;
+}
+#endif
+
 void M2MNsdlInterface::send_resource_observation(M2MResource *resource,
                                                  uint16_t obs_number)
 {
@@ -2231,6 +2571,14 @@ void M2MNsdlInterface::send_resource_observation(M2MResource *resource,
             content_type = COAP_CONTENT_OMA_OPAQUE_TYPE;
         }
 
+#ifndef DISABLE_BLOCK_MESSAGE
+        if (resource->resource_instance_count() == 0 && content_type != COAP_CONTENT_OMA_TLV_TYPE &&
+                M2MCallbackStorage::get_association_item(*resource, M2MCallbackAssociation::M2MResourceInstanceReadCallback)) {
+            send_streamed_resource_observation(resource, obs_number, token, token_length, content_type);
+            return;
+        }
+#endif
+
         if (resource->resource_instance_count() > 0 || content_type == COAP_CONTENT_OMA_TLV_TYPE) {
             value = M2MTLVSerializer::serialize(resource, length);
         } else {
@@ -2248,6 +2596,138 @@ void M2MNsdlInterface::send_resource_observation(M2MResource *resource,
         memory_free(value);
     }
 }
+#ifndef DISABLE_BLOCK_MESSAGE
+void M2MNsdlInterface::send_streamed_resource_observation(M2MResource *resource,
+                                                          uint16_t obs_number,
+                                                          uint8_t *token,
+                                                          uint8_t token_length,
+                                                          uint16_t content_type)
+{
+    // Only the first block is read here. The server fetches the rest with Block2 GET
+    // requests, which handle_get_request() serves from the read callback, so the
+    // value is never held in memory as a whole.
+    const uint16_t block_size = sn_nsdl_get_block_size(_nsdl_handle);
+    uint8_t *value = NULL;
+    size_t length = block_size;
+    size_t total_size = 0;
+    coap_response_code_e code = resource->read_value_block(value, length, total_size, 0);
+    const bool more = total_size > length;
+
+    int32_t msgid = -1;
+    sn_coap_hdr_s *notification = (sn_coap_hdr_s *)memory_alloc(sizeof(sn_coap_hdr_s));
+    if (code >= COAP_RESPONSE_BAD_REQUEST || length > block_size || (more && length != block_size) || !notification) {
+        tr_error("M2MNsdlInterface::send_streamed_resource_observation - read failed, code %d", code);
+        memory_free(notification);
+        handle_observation_response(resource, msgid);
+        return;
+    }
+
+    memset(notification, 0, sizeof(sn_coap_hdr_s));
+    if (!sn_nsdl_alloc_options_list(_nsdl_handle, notification)) {
+        memory_free(notification);
+        handle_observation_response(resource, msgid);
+        return;
+    }
+
+    notification->msg_type = resource->report_handler()->is_confirmable() ? COAP_MSG_TYPE_CONFIRMABLE : COAP_MSG_TYPE_NON_CONFIRMABLE;
+    notification->msg_code = COAP_MSG_CODE_RESPONSE_CONTENT;
+    notification->token_ptr = token;
+    notification->token_len = token_length;
+    notification->content_format = sn_coap_content_format_e(content_type);
+    notification->payload_ptr = value;
+    notification->payload_len = (uint16_t)length;
+    notification->options_list_ptr->observe = obs_number;
+    notification->options_list_ptr->max_age = resource->max_age();
+    if (more) {
+        notification->options_list_ptr->block2 = sn_coap_convert_block_size(block_size) | 0x08;
+        notification->options_list_ptr->use_size2 = true;
+        notification->options_list_ptr->size2 = total_size;
+    }
+
+    // The CoAP library does not keep a copy of a single block, so the notification
+    // is delivered once the first block is acknowledged
+    resource->report_handler()->set_blockwise_notify(false);
+
+    if (sn_nsdl_send_coap_message(_nsdl_handle, &_nsdl_handle->server_address, notification) == 0) {
+        msgid = notification->msg_id;
+        tr_info("M2MNsdlInterface::send_streamed_resource_observation - %lu of %lu bytes",
+                (unsigned long)length, (unsigned long)total_size);
+    }
+    handle_observation_response(resource, msgid);
+
+    // Token and payload are not owned by the message
+    notification->token_ptr = NULL;
+    notification->payload_ptr = NULL;
+    sn_nsdl_release_allocated_coap_msg_mem(_nsdl_handle, notification);
+}
+#endif
+
+#if MBED_CLIENT_WAKE_WINDOW
+uint64_t M2MNsdlInterface::next_wake_time()
+{
+    uint64_t next = _registration_timer.remaining_time();
+
+    // CoAP ping time counts only while the client is awake
+    if (_binding_mode == M2MInterface::TCP && _registered && _nsdl_execution_interval) {
+        update_nsdl_time();
+        uint64_t ping = 0;
+        if (_next_coap_ping_send_time > _counter_for_nsdl) {
+            ping = (uint64_t)(_next_coap_ping_send_time - _counter_for_nsdl) * 1000;
+        }
+        if (ping < next) {
+            next = ping;
+        }
+    }
+
+#if MBED_CLIENT_LWM2M_SEND_SAMPLES
+    const uint64_t send = _send_timer.remaining_time();
+    if (send < next) {
+        next = send;
+    }
+#endif
+
+#if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1)
+    const uint64_t report = M2MReportScheduler::get_instance()->time_to_next_deadline();
+    if (report < next) {
+        next = report;
+    }
+#endif
+
+    return next;
+}
+
+void M2MNsdlInterface::wake_window_opened()
+{
+    // Sent from the event loop, not from within the send callback
+    if (_registered && _wake_window_timer.remaining_time() == UINT64_MAX) {
+        _wake_window_timer.start_timer(WAKE_WINDOW_DELAY, M2MTimerObserver::WakeWindow, true);
+    }
+}
+
+void M2MNsdlInterface::send_due_within_wake_window()
+{
+    if (!_registered || !_nsdl_execution_timer_running) {
+        return;
+    }
+
+    const uint64_t window = (uint64_t)MBED_CLIENT_WAKE_WINDOW * 1000;
+
+    // Any time before the lifetime expires is fine for the update
+    if (!is_update_register_ongoing() && !is_unregister_ongoing() &&
+            _registration_timer.remaining_time() <= window) {
+        tr_info("M2MNsdlInterface::send_due_within_wake_window - registration update");
+        if (!send_update_registration()) {
+            _observer.registration_error(M2MInterface::MemoryFail, false);
+            return;
+        }
+    }
+
+#if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1)
+    M2MReportScheduler::get_instance()->expire_pmax_early(window);
+#endif
+}
+#endif
+
 nsdl_s *M2MNsdlInterface::get_nsdl_handle() const
 {
     return _nsdl_handle;
@@ -2776,6 +3256,17 @@ bool M2MNsdlInterface::is_unregister_ongoing() const
 bool M2MNsdlInterface::parse_and_send_uri_query_parameters()
 {
     bool msg_sent = false;
+    char query_params[MAX_URI_QUERY_LEN];
+    if (build_uri_query_parameters(query_params)) {
+        tr_debug("M2MNsdlInterface::parse_and_send_uri_query_parameters - uri params: %s", query_params);
+        msg_sent = sn_nsdl_register_endpoint(_nsdl_handle, _endpoint, query_params) > 0;
+    }
+    return msg_sent;
+}
+
+bool M2MNsdlInterface::build_uri_query_parameters(char *query_params)
+{
+    bool success = false;
     char *address_copy = M2MBase::alloc_string_copy(_server_address);
     if (address_copy) {
         const char *query = parse_uri_query_parameters(_server_address);
@@ -2786,7 +3277,6 @@ bool M2MNsdlInterface::parse_and_send_uri_query_parameters()
             }
 
             if (query_len <= MAX_URI_QUERY_LEN) {
-                char query_params[MAX_URI_QUERY_LEN];
                 strcpy(query_params, "&");
                 strcat(query_params, query);
                 strcat(query_params, "&");
@@ -2795,17 +3285,15 @@ bool M2MNsdlInterface::parse_and_send_uri_query_parameters()
                     strcat(query_params, "&");
                     strcat(query_params, _custom_uri_query_params);
                 }
-
-                tr_debug("M2MNsdlInterface::parse_and_send_uri_query_parameters - uri params: %s", query_params);
-                msg_sent = sn_nsdl_register_endpoint(_nsdl_handle, _endpoint, query_params) > 0;
+                success = true;
             } else {
-                tr_error("M2MNsdlInterface::parse_and_send_uri_query_parameters - max uri param length reached (%lu)",
+                tr_error("M2MNsdlInterface::build_uri_query_parameters - max uri param length reached (%lu)",
                          (unsigned long)query_len);
             }
         }
         free(address_copy);
     }
-    return msg_sent;
+    return success;
 }
 
 void M2MNsdlInterface::claim_mutex()
@@ -2821,18 +3309,81 @@ void M2MNsdlInterface::release_mutex()
 void M2MNsdlInterface::start_nsdl_execution_timer()
 {
     tr_debug("M2MNsdlInterface::start_nsdl_execution_timer");
+    update_nsdl_time();
     _nsdl_execution_timer_running = true;
-    _nsdl_execution_timer.stop_timer();
-    _nsdl_execution_timer.start_timer(ONE_SECOND_TIMER * 1000,
-                                      M2MTimerObserver::NsdlExecution,
-                                      false);
+    schedule_nsdl_execution(false);
 }
 
 void M2MNsdlInterface::stop_nsdl_execution_timer()
 {
     tr_debug("M2MNsdlInterface::stop_nsdl_execution_timer");
     _nsdl_execution_timer_running = false;
+    _nsdl_execution_interval = 0;
+    _nsdl_execution_timer.stop_timer();
+}
+
+void M2MNsdlInterface::pause_nsdl_execution_timer()
+{
+    tr_debug("M2MNsdlInterface::pause_nsdl_execution_timer");
+    update_nsdl_time();
+    _nsdl_execution_interval = 0;
+    _nsdl_execution_timer.stop_timer();
+}
+
+void M2MNsdlInterface::update_nsdl_time()
+{
+    if (!_nsdl_execution_interval) {
+        return;
+    }
+
+    uint64_t elapsed = (_nsdl_execution_timer.elapsed_time() + _nsdl_execution_phase) / 1000;
+
+    // The last second is added when the timer expires
+    if (elapsed >= _nsdl_execution_interval) {
+        elapsed = _nsdl_execution_interval - 1;
+    }
+
+    if (elapsed > _nsdl_execution_elapsed) {
+        _counter_for_nsdl += (uint32_t)elapsed - _nsdl_execution_elapsed;
+        _nsdl_execution_elapsed = (uint32_t)elapsed;
+        sn_nsdl_set_time(_nsdl_handle, _counter_for_nsdl);
+    }
+}
+
+void M2MNsdlInterface::schedule_nsdl_execution(bool only_if_earlier)
+{
+    uint32_t next_time = sn_nsdl_get_next_exec_time(_nsdl_handle);
+    uint16_t phase = 0;
+
+    if (_binding_mode == M2MInterface::TCP && _registered && _next_coap_ping_send_time < next_time) {
+        next_time = _next_coap_ping_send_time;
+    }
+
+    uint32_t interval = ONE_SECOND_TIMER;
+    if (next_time > _counter_for_nsdl + ONE_SECOND_TIMER) {
+        interval = next_time - _counter_for_nsdl;
+        if (interval > MBED_CLIENT_NSDL_EXECUTION_MAX_INTERVAL) {
+            interval = MBED_CLIENT_NSDL_EXECUTION_MAX_INTERVAL;
+        }
+    }
+
+    if (_nsdl_execution_interval) {
+        update_nsdl_time();
+        if (only_if_earlier && interval >= _nsdl_execution_interval - _nsdl_execution_elapsed) {
+            return;
+        }
+        // Keep the part of the current second that has already passed
+        phase = (_nsdl_execution_timer.elapsed_time() + _nsdl_execution_phase) % 1000;
+    } else if (only_if_earlier) {
+        return;
+    }
+
+    _nsdl_execution_interval = interval;
+    _nsdl_execution_elapsed = 0;
+    _nsdl_execution_phase = phase;
     _nsdl_execution_timer.stop_timer();
+    _nsdl_execution_timer.start_timer((uint64_t)interval * 1000 - phase,
+                                      M2MTimerObserver::NsdlExecution);
 }
 
 M2MSecurity *M2MNsdlInterface::get_security_object()
@@ -2891,17 +3442,57 @@ uint8_t M2MNsdlInterface::find_auto_obs_token(const char *path, uint8_t *token)
 
 bool M2MNsdlInterface::is_response_to_request(const sn_coap_hdr_s *coap_header, request_context_s &get_data)
 {
+    request_context_s *data = find_request(coap_header->token_ptr);
+    if (data) {
+        get_data = *data;
+        return true;
+    }
+
+    return false;
+}
+
+M2MNsdlInterface::request_context_s *M2MNsdlInterface::find_request(const uint8_t *token)
+{
+    uint32_t msg_token;
+    memcpy(&msg_token, token, sizeof(msg_token));
+
+#if MBED_CLIENT_RESPONSE_INDEX_SIZE
+    request_context_s *data = _request_token_index[index_bucket(msg_token)];
+    while (data) {
+        if (data->msg_token == msg_token) {
+            return data;
+        }
+        data = data->token_next;
+    }
+#else
     // ns_list_foreach() replacement since it does not compile with IAR 7.x versions.
     request_context_s *data = (request_context_s *)ns_list_get_first(&_request_context_list);
     while (data) {
-        if (memcmp(coap_header->token_ptr, &data->msg_token, sizeof(data->msg_token)) == 0) {
-            get_data = *data;
-            return true;
+        if (data->msg_token == msg_token) {
+            return data;
         }
         data = (request_context_s *)ns_list_get_next(&_request_context_list, data);
     }
+#endif
 
-    return false;
+    return NULL;
+}
+
+void M2MNsdlInterface::remove_request(request_context_s *request)
+{
+    ns_list_remove(&_request_context_list, request);
+#if MBED_CLIENT_RESPONSE_INDEX_SIZE
+    request_context_s **link = &_request_token_index[index_bucket(request->msg_token)];
+    while (*link) {
+        if (*link == request) {
+            *link = request->token_next;
+            break;
+        }
+        link = &(*link)->token_next;
+    }
+#endif
+    memory_free(request->uri_path);
+    memory_free(request);
 }
 
 void M2MNsdlInterface::free_request_context_list(const sn_coap_hdr_s *coap_header, bool call_error_cb, request_error_t error_code)
@@ -2914,43 +3505,55 @@ void M2MNsdlInterface::free_request_context_list(const sn_coap_hdr_s *coap_heade
             if (call_error_cb) {
                 data->on_request_error_cb(error_code, data->context);
             }
-            ns_list_remove(&_request_context_list, data);
-            memory_free(data->uri_path);
-            memory_free(data);
+            remove_request(data);
         }
 
         // Clean just one item from the list
     } else {
-        // ns_list_foreach() replacement since it does not compile with IAR 7.x versions.
-        request_context_s *data = (request_context_s *)ns_list_get_first(&_request_context_list);
-        while (data) {
-            if (memcmp(coap_header->token_ptr, &data->msg_token, sizeof(data->msg_token)) == 0) {
-                if (call_error_cb) {
-                    data->on_request_error_cb(error_code, data->context);
-                }
-                ns_list_remove(&_request_context_list, data);
-                memory_free(data->uri_path);
-                memory_free(data);
-                return;
-            }
-            data = (request_context_s *)ns_list_get_next(&_request_context_list, data);
+        request_context_s *data = find_request(coap_header->token_ptr);
+        if (data) {
+            if (call_error_cb) {
+                data->on_request_error_cb(error_code, data->context);
+            }
+            remove_request(data);
         }
     }
 }
 
 void M2MNsdlInterface::set_request_context_to_be_resend(uint8_t *token, uint8_t token_len)
 {
-    // ns_list_foreach() replacement since it does not compile with IAR 7.x versions.
-    request_context_s *data = (request_context_s *)ns_list_get_first(&_request_context_list);
-    while (data) {
-        if (token && token_len) {
-            if (token_len == sizeof(data->msg_token) &&
-                    memcmp((uint8_t *)&data->msg_token, token, token_len) == 0) {
+    if (token && token_len) {
+        if (token_len != sizeof(uint32_t)) {
+            return;
+        }
+        uint32_t msg_token;
+        memcpy(&msg_token, token, sizeof(msg_token));
+#if MBED_CLIENT_RESPONSE_INDEX_SIZE
+        request_context_s *data = _request_token_index[index_bucket(msg_token)];
+        while (data) {
+            if (data->msg_token == msg_token) {
                 data->resend = true;
             }
-        } else {
-            data->resend = true;
+            data = data->token_next;
         }
+        return;
+#else
+        // ns_list_foreach() replacement since it does not compile with IAR 7.x versions.
+        request_context_s *data = (request_context_s *)ns_list_get_first(&_request_context_list);
+        while (data) {
+            if (data->msg_token == msg_token) {
+                data->resend = true;
+            }
+            data = (request_context_s *)ns_list_get_next(&_request_context_list, data);
+        }
+        return;
+#endif
+    }
+
+    // ns_list_foreach() replacement since it does not compile with IAR 7.x versions.
+    request_context_s *data = (request_context_s *)ns_list_get_first(&_request_context_list);
+    while (data) {
+        data->resend = true;
         data = (request_context_s *)ns_list_get_next(&_request_context_list, data);
     }
 }
@@ -3016,10 +3619,22 @@ void M2MNsdlInterface::clear_received_blockwise_messages()
     sn_nsdl_clear_coap_received_blockwise_messages(_nsdl_handle);
 }
 
+#if PERF_COUNTERS_ENABLED
+void M2MNsdlInterface::publish_coap_stats()
+{
+    sn_coap_exchange_stats_s stats;
+    if (_nsdl_handle && sn_coap_protocol_get_exchange_stats(_nsdl_handle->grs->coap, &stats) == 0) {
+        PERF_COUNTER_ADD(COAP_RETRANSMISSIONS, stats.retransmissions - _coap_stats_published.retransmissions);
+        PERF_COUNTER_ADD(COAP_SEND_TIMEOUTS, stats.send_timeouts - _coap_stats_published.send_timeouts);
+        _coap_stats_published = stats;
+    }
+}
+#endif
+
 void M2MNsdlInterface::send_coap_ping()
 {
     if (_binding_mode == M2MInterface::TCP && _registered &&
-            _counter_for_nsdl == _next_coap_ping_send_time &&
+            _counter_for_nsdl >= _next_coap_ping_send_time &&
             !coap_ping_in_process()) {
 
         tr_info("M2MNsdlInterface::send_coap_ping()");
@@ -3041,6 +3656,7 @@ void M2MNsdlInterface::calculate_new_coap_ping_send_time()
         return;
     }
 
+    update_nsdl_time();
     _next_coap_ping_send_time = _counter_for_nsdl + MBED_CLIENT_TCP_KEEPALIVE_INTERVAL;
 }
 
@@ -3048,7 +3664,40 @@ void M2MNsdlInterface::send_next_notification(NotificationQueueOption option)
 {
     tr_info("M2MNsdlInterface::send_next_notification - option %d", option);
     claim_mutex();
-    if (!_base_list.empty()) {
+#if MBED_CLIENT_COMPOSITE_OPERATIONS
+    if (option == M2MNsdlInterface::CLEAR_NOTIFICATION_TOKEN) {
+        // Server forgets the observations on full registration
+        clear_composite_observations();
+    } else {
+        m2m::Vector<M2MCompositeObservation *>::const_iterator it = _composite_observations.begin();
+        for (; it != _composite_observations.end(); it++) {
+            if (!(*it)->notification_pending()) {
+                continue;
+            }
+            if (option == M2MNsdlInterface::SEND_NOTIFICATION) {
+                send_composite_notification(**it);
+            } else {
+                (*it)->clear_notification_pending();
+            }
+        }
+    }
+#endif
+    bool walk_tree = true;
+#if MBED_CLIENT_NOTIFICATION_QUEUE
+    // Coming back from alert mode restarts the timers of every report handler, which needs the full walk
+    if (option == M2MNsdlInterface::SEND_NOTIFICATION && _last_notif_queue_event != M2MNsdlInterface::REMOVE_NOTIFICATION) {
+        walk_tree = false;
+        M2MReportHandler *reporter = M2MReportHandler::next_queued_notification();
+        if (reporter) {
+            reporter->schedule_report(true);
+            // Waiting for the acknowledgement, or still queued, it goes behind the others
+            reporter->requeue_notification();
+            release_mutex();
+            return;
+        }
+    }
+#endif
+    if (walk_tree && !_base_list.empty()) {
         M2MBaseList::const_iterator base_iterator;
         base_iterator = _base_list.begin();
         for (; base_iterator != _base_list.end(); base_iterator++) {
@@ -3117,6 +3766,540 @@ bool M2MNsdlInterface::send_next_notification_for_object(M2MObject &object, Noti
     return false;
 }
 
+#if MBED_CLIENT_COMPOSITE_OPERATIONS
+struct composite_path_context_s {
+    M2MNsdlInterface    *nsdl_interface;
+    M2MBaseList         *paths;
+    bool                not_found;
+};
+
+uint8_t M2MNsdlInterface::handle_composite_request(sn_coap_hdr_s *coap_header, sn_nsdl_addr_s *address)
+{
+    const int32_t observe = coap_header->options_list_ptr ? coap_header->options_list_ptr->observe : -1;
+    sn_coap_msg_code_e msg_code = COAP_MSG_CODE_RESPONSE_CONTENT;
+    M2MCompositeObservation *observation = NULL;
+    M2MBaseList read_paths;
+    M2MBaseList *paths = &read_paths;
+    uint8_t *payload = NULL;
+    uint32_t payload_len = 0;
+
+    tr_debug("M2MNsdlInterface::handle_composite_request - observe %" PRId32, observe);
+
+    if (START_OBSERVATION == observe) {
+        observation = new M2MCompositeObservation(*this);
+        paths = &observation->paths();
+    }
+
+    if (coap_header->content_format != sn_coap_content_format_e(COAP_CONTENT_OMA_SENML_CBOR_TYPE)) {
+        tr_error("M2MNsdlInterface::handle_composite_request - content format %d not supported", coap_header->content_format);
+        msg_code = COAP_MSG_CODE_RESPONSE_UNSUPPORTED_CONTENT_FORMAT;
+    } else {
+        composite_path_context_s context = { this, paths, false };
+        if (!coap_header->payload_ptr ||
+                !M2MSenMLCborSerializer::parse_path_list(coap_header->payload_ptr, coap_header->payload_len,
+                                                         add_composite_path, &context)) {
+            msg_code = context.not_found ? COAP_MSG_CODE_RESPONSE_NOT_FOUND : COAP_MSG_CODE_RESPONSE_BAD_REQUEST;
+        } else if (START_OBSERVATION == observe && coap_header->token_ptr == NULL) {
+            tr_error("M2MNsdlInterface::handle_composite_request - missing token!");
+            msg_code = COAP_MSG_CODE_RESPONSE_BAD_REQUEST;
+        }
+    }
+
+#if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1)
+    // Write-Attributes can not address a composite observation, so pmin and pmax are taken from the query
+    if (observation && msg_code == COAP_MSG_CODE_RESPONSE_CONTENT && coap_header->options_list_ptr->uri_query_ptr) {
+        String query = coap_to_string(coap_header->options_list_ptr->uri_query_ptr,
+                                      coap_header->options_list_ptr->uri_query_len);
+        if (!observation->report_handler().parse_notification_attribute(query.c_str(), M2MBase::ObjectInstance)) {
+            tr_error("M2MNsdlInterface::handle_composite_request - invalid query %s", query.c_str());
+            msg_code = COAP_MSG_CODE_RESPONSE_BAD_REQUEST;
+        }
+    }
+#endif
+
+    if (msg_code == COAP_MSG_CODE_RESPONSE_CONTENT) {
+        payload = M2MSenMLCborSerializer::serialize(*paths, payload_len);
+        if (!payload) {
+            // Nothing readable under the paths, or out of memory
+            msg_code = COAP_MSG_CODE_RESPONSE_METHOD_NOT_ALLOWED;
+        }
+    }
+
+    if (msg_code == COAP_MSG_CODE_RESPONSE_CONTENT) {
+        if (observation) {
+            // Observe-Composite with a token already in use replaces the earlier observation
+            delete_composite_observation(find_composite_observation(coap_header->token_ptr, coap_header->token_len));
+            observation->report_handler().set_observation_token(coap_header->token_ptr, coap_header->token_len);
+            observation->report_handler().set_under_observation(true);
+            _composite_observations.push_back(observation);
+            tr_info("M2MNsdlInterface::handle_composite_request - observing %d paths", paths->size());
+        } else if (STOP_OBSERVATION == observe) {
+            delete_composite_observation(find_composite_observation(coap_header->token_ptr, coap_header->token_len));
+        }
+    } else {
+        delete observation;
+        observation = NULL;
+    }
+
+    sn_coap_hdr_s *coap_response = sn_nsdl_build_response(_nsdl_handle, coap_header, msg_code);
+    uint8_t value = 1;
+    if (coap_response) {
+        if (payload) {
+            coap_response->payload_ptr = payload;
+            coap_response->payload_len = payload_len;
+            coap_response->content_format = sn_coap_content_format_e(COAP_CONTENT_OMA_SENML_CBOR_TYPE);
+            if (observation) {
+                coap_response->options_list_ptr = sn_nsdl_alloc_options_list(_nsdl_handle, coap_response);
+                if (coap_response->options_list_ptr) {
+                    coap_response->options_list_ptr->observe = observation->report_handler().observation_number();
+                }
+            }
+        }
+        value = (sn_nsdl_send_coap_message(_nsdl_handle, address, coap_response) == 0) ? 0 : 1;
+        coap_response->payload_ptr = NULL;
+        sn_nsdl_release_allocated_coap_msg_mem(_nsdl_handle, coap_response);
+    }
+    free(payload);
+
+    return value;
+}
+
+bool M2MNsdlInterface::add_composite_path(const char *path, void *context)
+{
+    composite_path_context_s *path_context = (composite_path_context_s *)context;
+    M2MBase *base = path_context->nsdl_interface->find_resource(String(path));
+    if (!base) {
+        tr_error("M2MNsdlInterface::add_composite_path - %s not found", path);
+        path_context->not_found = true;
+        return false;
+    }
+    path_context->paths->push_back(base);
+    return true;
+}
+
+M2MCompositeObservation *M2MNsdlInterface::find_composite_observation(const uint8_t *token, uint8_t token_length) const
+{
+    m2m::Vector<M2MCompositeObservation *>::const_iterator it = _composite_observations.begin();
+    for (; it != _composite_observations.end(); it++) {
+        if ((*it)->has_token(token, token_length)) {
+            return *it;
+        }
+    }
+    return NULL;
+}
+
+void M2MNsdlInterface::delete_composite_observation(M2MCompositeObservation *observation)
+{
+    if (!observation) {
+        return;
+    }
+
+    for (int index = 0; index < _composite_observations.size(); index++) {
+        if (_composite_observations[index] == observation) {
+            _composite_observations.erase(index);
+            break;
+        }
+    }
+    delete observation;
+}
+
+void M2MNsdlInterface::clear_composite_observations()
+{
+    while (!_composite_observations.empty()) {
+        delete_composite_observation(_composite_observations[0]);
+    }
+}
+
+void M2MNsdlInterface::composite_notification_pending()
+{
+    _notification_handler->send_notification(this);
+}
+
+void M2MNsdlInterface::send_composite_notification(M2MCompositeObservation &observation)
+{
+    observation.clear_notification_pending();
+
+    if (!_nsdl_execution_timer_running || !_registered) {
+        tr_info("M2MNsdlInterface::send_composite_notification() - in reconnection mode or not registered");
+        return;
+    }
+
+    uint32_t length = 0;
+    uint8_t *value = M2MSenMLCborSerializer::serialize(observation.paths(), length);
+    if (!value) {
+        tr_error("M2MNsdlInterface::send_composite_notification() - serialization failed");
+        return;
+    }
+
+    uint8_t token[MAX_TOKEN_SIZE];
+    uint8_t token_length = 0;
+    observation.report_handler().get_observation_token(token, token_length);
+
+    // Sent non-confirmable, so it does not wait for nor block the confirmable notification queue
+    int32_t msgid = sn_nsdl_send_observation_notification(_nsdl_handle, token, token_length, value, length,
+                                                          sn_coap_observe_e(observation.report_handler().observation_number()),
+                                                          false,
+                                                          sn_coap_content_format_e(COAP_CONTENT_OMA_SENML_CBOR_TYPE),
+                                                          -1, 0);
+    observation.set_msg_id(msgid);
+    tr_info("M2MNsdlInterface::send_composite_notification() - %" PRIu32 " bytes, msg id %" PRId32, length, msgid);
+
+    free(value);
+}
+
+bool M2MNsdlInterface::handle_composite_notification_reset(int32_t msg_id)
+{
+    m2m::Vector<M2MCompositeObservation *>::const_iterator it = _composite_observations.begin();
+    for (; it != _composite_observations.end(); it++) {
+        if ((*it)->msg_id() == msg_id) {
+            tr_info("M2MNsdlInterface::handle_composite_notification_reset - observation cancelled");
+            delete_composite_observation(*it);
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif // MBED_CLIENT_COMPOSITE_OPERATIONS
+
+#if MBED_CLIENT_COMPOSITE_OPERATIONS || MBED_CLIENT_LWM2M_SEND_SAMPLES
+void M2MNsdlInterface::value_changed(M2MBase *base)
+{
+    if (!base) {
+        return;
+    }
+
+    claim_mutex();
+#if MBED_CLIENT_COMPOSITE_OPERATIONS
+    m2m::Vector<M2MCompositeObservation *>::const_iterator it = _composite_observations.begin();
+    for (; it != _composite_observations.end(); it++) {
+        if ((*it)->covers(*base)) {
+            (*it)->report_handler().set_notification_trigger();
+        }
+    }
+#endif
+#if MBED_CLIENT_LWM2M_SEND_SAMPLES
+    if (is_send_path(*base)) {
+        record_sample(*static_cast<M2MResourceBase *>(base));
+    }
+#endif
+    release_mutex();
+}
+#endif
+
+#if MBED_CLIENT_LWM2M_SEND_SAMPLES
+bool M2MNsdlInterface::add_send_path(M2MBase *base)
+{
+    if (!base) {
+        return false;
+    }
+
+    claim_mutex();
+    bool added = false;
+    M2MBaseList::const_iterator it = _send_paths.begin();
+    for (; it != _send_paths.end(); it++) {
+        if (*it == base) {
+            break;
+        }
+    }
+    if (it == _send_paths.end()) {
+        _send_paths.push_back(base);
+        added = true;
+    }
+    release_mutex();
+    return added;
+}
+
+void M2MNsdlInterface::remove_send_path(M2MBase *base)
+{
+    claim_mutex();
+    for (int index = 0; index < _send_paths.size(); index++) {
+        if (_send_paths[index] == base) {
+            _send_paths.erase(index);
+            break;
+        }
+    }
+    release_mutex();
+}
+
+void M2MNsdlInterface::set_send_storage(send_storage_load_cb load_cb, send_storage_save_cb save_cb, void *context)
+{
+    claim_mutex();
+    _send_load_cb = load_cb;
+    _send_save_cb = save_cb;
+    _send_storage_context = context;
+
+    if (_send_load_cb && !_send_samples.count()) {
+        size_t size = M2MSampleBuffer::max_storage_size();
+        uint8_t *buffer = (uint8_t *)malloc(size);
+        if (buffer) {
+            size = _send_load_cb(buffer, size, _send_storage_context);
+            if (size) {
+                _send_samples.load(buffer, size);
+            }
+            free(buffer);
+        } else {
+            tr_error("M2MNsdlInterface::set_send_storage - failed to allocate %lu bytes", (unsigned long)size);
+        }
+    }
+    release_mutex();
+}
+
+bool M2MNsdlInterface::is_send_path(const M2MBase &base) const
+{
+    // Walk up from the changed resource or resource instance, any level may be added
+    const M2MBase *level = &base;
+    while (level && !_send_paths.empty()) {
+        M2MBaseList::const_iterator it = _send_paths.begin();
+        for (; it != _send_paths.end(); it++) {
+            if (*it == level) {
+                return true;
+            }
+        }
+
+        switch (level->base_type()) {
+            case M2MBase::ResourceInstance:
+                level = &static_cast<const M2MResourceInstance *>(level)->get_parent_resource();
+                break;
+            case M2MBase::Resource:
+                level = &static_cast<const M2MResource *>(level)->get_parent_object_instance();
+                break;
+            case M2MBase::ObjectInstance:
+                level = &static_cast<const M2MObjectInstance *>(level)->get_parent_object();
+                break;
+            default:
+                level = NULL;
+                break;
+        }
+    }
+    return false;
+}
+
+void M2MNsdlInterface::record_sample(const M2MResourceBase &resource)
+{
+    // Wall clock time if it is known, otherwise time since start, sent relative to the time of sending
+    const uint64_t epoch = pal_osGetTime();
+    update_nsdl_time();
+
+    m2m_sample_s sample;
+    if (!M2MSampleBuffer::make_sample(resource, epoch ? (uint32_t)epoch : _counter_for_nsdl, epoch != 0, sample)) {
+        tr_debug("M2MNsdlInterface::record_sample - %s has no numeric value", resource.uri_path());
+        return;
+    }
+
+    if (!_send_samples.push(sample) && _send_in_flight) {
+        // Dropped sample was part of the ongoing request
+        _send_in_flight--;
+    }
+
+    if (_registered && !_alert_mode && _nsdl_execution_timer_running) {
+        send_samples();
+    } else {
+        save_samples();
+    }
+}
+
+void M2MNsdlInterface::send_samples()
+{
+    if (_send_token || !_send_samples.count()) {
+        return;
+    }
+
+    if (!_nsdl_execution_timer_running || !_registered || _alert_mode) {
+        tr_debug("M2MNsdlInterface::send_samples - not registered, %u samples buffered", _send_samples.count());
+        return;
+    }
+
+    update_nsdl_time();
+    if (_counter_for_nsdl < _next_send_time) {
+        // Samples arriving meanwhile go to the same request
+        _send_timer.start_timer((uint64_t)(_next_send_time - _counter_for_nsdl) * 1000, M2MTimerObserver::LwM2MSend);
+        return;
+    }
+
+    uint16_t count = _send_samples.count();
+    if (count > MBED_CLIENT_LWM2M_SEND_BATCH_SIZE) {
+        count = MBED_CLIENT_LWM2M_SEND_BATCH_SIZE;
+    }
+
+    uint32_t length = 0;
+    uint8_t *payload = M2MSenMLCborSerializer::serialize(_send_samples, count, _counter_for_nsdl, length);
+    sn_coap_hdr_s *coap_header = (sn_coap_hdr_s *)memory_alloc(sizeof(sn_coap_hdr_s));
+    if (!payload || !coap_header || length > UINT16_MAX) {
+        tr_error("M2MNsdlInterface::send_samples - failed to create request");
+        free(payload);
+        memory_free(coap_header);
+        return;
+    }
+
+    uint32_t token = 0;
+    randLIB_get_n_bytes_random(&token, sizeof(token));
+    if (!token) {
+        token++;
+    }
+
+    memset(coap_header, 0, sizeof(sn_coap_hdr_s));
+    coap_header->msg_type = COAP_MSG_TYPE_CONFIRMABLE;
+    coap_header->msg_code = COAP_MSG_CODE_REQUEST_POST;
+    coap_header->uri_path_ptr = (uint8_t *)LWM2M_SEND_URI;
+    coap_header->uri_path_len = sizeof(LWM2M_SEND_URI) - 1;
+    coap_header->token_ptr = (uint8_t *)&token;
+    coap_header->token_len = sizeof(token);
+    coap_header->content_format = sn_coap_content_format_e(COAP_CONTENT_OMA_SENML_CBOR_TYPE);
+    coap_header->payload_ptr = payload;
+    coap_header->payload_len = (uint16_t)length;
+
+    // Payload larger than the block size is sent blockwise by the CoAP library
+    if (sn_nsdl_send_coap_message(_nsdl_handle, &_nsdl_handle->server_address, coap_header) == 0) {
+        _send_token = token;
+        _send_in_flight = count;
+        _next_send_time = _counter_for_nsdl + MBED_CLIENT_LWM2M_SEND_INTERVAL;
+        tr_info("M2MNsdlInterface::send_samples - %u samples, %" PRIu32 " bytes", count, length);
+    } else {
+        tr_error("M2MNsdlInterface::send_samples - sending failed");
+    }
+
+    // Not owned by the header
+    coap_header->uri_path_ptr = NULL;
+    coap_header->token_ptr = NULL;
+    coap_header->payload_ptr = NULL;
+    sn_nsdl_release_allocated_coap_msg_mem(_nsdl_handle, coap_header);
+    free(payload);
+}
+
+bool M2MNsdlInterface::is_send_response(const sn_coap_hdr_s *coap_header) const
+{
+    return _send_token && coap_header->token_ptr &&
+           coap_header->token_len == sizeof(_send_token) &&
+           memcmp(coap_header->token_ptr, &_send_token, sizeof(_send_token)) == 0;
+}
+
+void M2MNsdlInterface::handle_send_response(const sn_coap_hdr_s *coap_header)
+{
+    const uint16_t sent = _send_in_flight;
+    _send_token = 0;
+    _send_in_flight = 0;
+
+    if (coap_header->coap_status == COAP_STATUS_BUILDER_MESSAGE_SENDING_FAILED ||
+            coap_header->coap_status == COAP_STATUS_BUILDER_BLOCK_SENDING_FAILED) {
+        // Samples are kept and sent after reconnecting
+        tr_error("M2MNsdlInterface::handle_send_response - sending failed");
+        save_samples();
+        _observer.registration_error(M2MInterface::NetworkError, true);
+        return;
+    }
+
+    if (coap_header->msg_code >= COAP_MSG_CODE_RESPONSE_INTERNAL_SERVER_ERROR) {
+        // Server may accept them later
+        tr_warn("M2MNsdlInterface::handle_send_response - server error %d, samples kept", coap_header->msg_code);
+    } else {
+        if (coap_header->msg_code >= COAP_MSG_CODE_RESPONSE_BAD_REQUEST) {
+            // Sending the same samples again would fail the same way
+            tr_error("M2MNsdlInterface::handle_send_response - rejected %d, %u samples dropped", coap_header->msg_code, sent);
+        } else {
+            tr_info("M2MNsdlInterface::handle_send_response - %u samples delivered", sent);
+        }
+        _send_samples.pop(sent);
+        save_samples();
+    }
+
+    send_samples();
+}
+
+void M2MNsdlInterface::save_samples()
+{
+    if (!_send_save_cb) {
+        return;
+    }
+
+    if (!_send_samples.count()) {
+        _send_save_cb(NULL, 0, _send_storage_context);
+        return;
+    }
+
+    size_t size = _send_samples.storage_size();
+    uint8_t *buffer = (uint8_t *)malloc(size);
+    if (!buffer) {
+        tr_error("M2MNsdlInterface::save_samples - failed to allocate %lu bytes", (unsigned long)size);
+        return;
+    }
+    size = _send_samples.save(buffer);
+    if (!_send_save_cb(buffer, size, _send_storage_context)) {
+        tr_error("M2MNsdlInterface::save_samples - storing failed");
+    }
+    free(buffer);
+}
+#endif // MBED_CLIENT_LWM2M_SEND_SAMPLES
+
+#if MBED_CLIENT_REGISTRATION_RESUME
+// Stored registration is the fingerprint in network byte order followed by the location
+#define REGISTRATION_RECORD_MAX_SIZE (sizeof(uint32_t) + UINT8_MAX)
+
+void M2MNsdlInterface::set_registration_storage(registration_storage_load_cb load_cb, registration_storage_save_cb save_cb, void *context)
+{
+    claim_mutex();
+    _registration_load_cb = load_cb;
+    _registration_save_cb = save_cb;
+    _registration_storage_context = context;
+    _registration_resume_pending = (load_cb != NULL);
+    release_mutex();
+}
+
+bool M2MNsdlInterface::resume_registration()
+{
+    if (!_registration_resume_pending) {
+        return false;
+    }
+    _registration_resume_pending = false;
+
+    uint8_t record[REGISTRATION_RECORD_MAX_SIZE];
+    size_t size = _registration_load_cb(record, sizeof(record), _registration_storage_context);
+    if (size <= sizeof(uint32_t) || size > sizeof(record)) {
+        return false;
+    }
+
+    // Same parameters as send_register_message() would use
+    char query_params[MAX_URI_QUERY_LEN];
+    const char *query = NULL;
+    if (_server_address && build_uri_query_parameters(query_params)) {
+        query = query_params;
+    }
+
+    update_nsdl_time();
+    if (sn_nsdl_resume_registration(_nsdl_handle, _endpoint, query, common_read_32_bit(record),
+                                    record + sizeof(uint32_t), size - sizeof(uint32_t)) != SN_NSDL_SUCCESS) {
+        tr_info("M2MNsdlInterface::resume_registration - stored registration not valid, full registration");
+        return false;
+    }
+
+    tr_info("M2MNsdlInterface::resume_registration - updating stored registration");
+    _registration_resumed = true;
+    return true;
+}
+
+void M2MNsdlInterface::save_registration()
+{
+    if (!_registration_save_cb) {
+        return;
+    }
+
+    const sn_nsdl_ep_parameters_s *ep = _nsdl_handle->ep_information_ptr;
+    uint32_t fingerprint = sn_nsdl_get_registration_fingerprint(_nsdl_handle);
+    if (!fingerprint || !ep->location_ptr || !ep->location_len) {
+        // Without location the registration cannot be updated
+        _registration_save_cb(NULL, 0, _registration_storage_context);
+        return;
+    }
+
+    uint8_t record[REGISTRATION_RECORD_MAX_SIZE];
+    common_write_32_bit(fingerprint, record);
+    memcpy(record + sizeof(uint32_t), ep->location_ptr, ep->location_len);
+    if (!_registration_save_cb(record, sizeof(uint32_t) + ep->location_len, _registration_storage_context)) {
+        tr_error("M2MNsdlInterface::save_registration - storing failed");
+    }
+}
+#endif // MBED_CLIENT_REGISTRATION_RESUME
+
 void M2MNsdlInterface::send_empty_ack(const sn_coap_hdr_s *header, sn_nsdl_addr_s *address)
 {
     tr_debug("M2MNsdlInterface::send_empty_ack()");
@@ -3222,8 +4405,14 @@ bool M2MNsdlInterface::is_registered() const
 
 void M2MNsdlInterface::handle_register_response(const sn_coap_hdr_s *coap_header)
 {
+#if MBED_CLIENT_REGISTRATION_RESUME
+    _registration_resumed = false;
+#endif
     if (coap_header->msg_code == COAP_MSG_CODE_RESPONSE_CREATED) {
         tr_info("M2MNsdlInterface::handle_register_response - registered");
+#if MBED_CLIENT_LATENCY_HISTOGRAM
+        record_latency(M2MInterface::LatencyRegister, _register_sent_ticks);
+#endif
         // If lifetime is less than zero then leave the field empty
         if (coap_header->options_list_ptr) {
             uint32_t max_time = coap_header->options_list_ptr->max_age;
@@ -3241,6 +4430,9 @@ void M2MNsdlInterface::handle_register_response(const sn_coap_hdr_s *coap_header
             }
 
         }
+#if MBED_CLIENT_REGISTRATION_RESUME
+        save_registration();
+#endif
         if (_endpoint->lifetime_ptr) {
             _registration_timer.stop_timer();
             _registration_timer.start_timer(registration_time() * 1000,
@@ -3258,6 +4450,13 @@ void M2MNsdlInterface::handle_register_response(const sn_coap_hdr_s *coap_header
         // Check if there are any pending download requests
         send_pending_request();
 
+#if MBED_CLIENT_LWM2M_SEND_SAMPLES
+        // Send request of the earlier session is not waited for
+        _send_token = 0;
+        _send_in_flight = 0;
+        send_samples();
+#endif
+
     } else {
         tr_error("M2MNsdlInterface::handle_register_response - registration error %d", coap_header->msg_code);
         if (coap_header->coap_status == COAP_STATUS_BUILDER_MESSAGE_SENDING_FAILED ||
@@ -3265,6 +4464,10 @@ void M2MNsdlInterface::handle_register_response(const sn_coap_hdr_s *coap_header
             tr_error("M2MNsdlInterface::handle_register_response - message sending failed !!!!");
         }
 
+#if MBED_CLIENT_SERVER_BACKOFF_HINT
+        store_server_backoff_hint(coap_header);
+#endif
+
         if (COAP_MSG_CODE_RESPONSE_BAD_REQUEST == coap_header->msg_code ||
                 COAP_MSG_CODE_RESPONSE_FORBIDDEN == coap_header->msg_code) {
             _observer.registration_error(M2MInterface::InvalidParameters, false);
@@ -3284,6 +4487,11 @@ void M2MNsdlInterface::handle_unregister_response(const sn_coap_hdr_s *coap_head
 
     if (coap_header->msg_code == COAP_MSG_CODE_RESPONSE_DELETED) {
         _registration_timer.stop_timer();
+#if MBED_CLIENT_REGISTRATION_RESUME
+        if (_registration_save_cb) {
+            _registration_save_cb(NULL, 0, _registration_storage_context);
+        }
+#endif
         _observer.client_unregistered();
     } else {
         tr_error("M2MNsdlInterface::handle_unregister_response - unregistration error %d", coap_header->msg_code);
@@ -3300,7 +4508,20 @@ void M2MNsdlInterface::handle_register_update_response(const sn_coap_hdr_s *coap
 {
     if (coap_header->msg_code == COAP_MSG_CODE_RESPONSE_CHANGED) {
         tr_info("M2MNsdlInterface::handle_register_update_response - registration_updated");
+#if MBED_CLIENT_LATENCY_HISTOGRAM
+        record_latency(M2MInterface::LatencyRegisterUpdate, _update_sent_ticks);
+#endif
+#if MBED_CLIENT_REGISTRATION_RESUME
+        if (_registration_resumed) {
+            // For the application, the resumed registration is the first one after the reset
+            _registration_resumed = false;
+            _observer.client_registered(_server);
+        } else {
+            _observer.registration_updated(*_server);
+        }
+#else
         _observer.registration_updated(*_server);
+#endif
 
         _notification_send_ongoing = false;
         // Check if there are any pending notifications in queue
@@ -3309,6 +4530,10 @@ void M2MNsdlInterface::handle_register_update_response(const sn_coap_hdr_s *coap
         // Check if there are any pending download requests
         send_pending_request();
 
+#if MBED_CLIENT_LWM2M_SEND_SAMPLES
+        send_samples();
+#endif
+
     } else {
         tr_error("M2MNsdlInterface::handle_register_update_response - registration_updated failed %d, %d", coap_header->msg_code, coap_header->coap_status);
         _nsdl_handle->update_register_token = 0;
@@ -3319,11 +4544,22 @@ void M2MNsdlInterface::handle_register_update_response(const sn_coap_hdr_s *coap
             // Inform interfaceimpl to do a reconnection and registration update
             // till we get CoAP level response for the request
             _observer.registration_error(M2MInterface::NetworkError, true);
+#if MBED_CLIENT_SERVER_BACKOFF_HINT
+        } else if (store_server_backoff_hint(coap_header)) {
+            // Server is overloaded, a full registration now would only add to it
+            _observer.registration_error(M2MInterface::NetworkError, true);
+#endif
         } else {
+#if MBED_CLIENT_REGISTRATION_RESUME
+            _registration_resumed = false;
+#endif
             // Clear observation tokens and do a full registration
             send_next_notification(M2MNsdlInterface::CLEAR_NOTIFICATION_TOKEN);
 
             bool msg_sent = false;
+#if MBED_CLIENT_LATENCY_HISTOGRAM
+            _register_sent_ticks = eventOS_event_timer_ticks();
+#endif
             if (_server_address) {
                 msg_sent = parse_and_send_uri_query_parameters();
             }
@@ -3334,6 +4570,60 @@ void M2MNsdlInterface::handle_register_update_response(const sn_coap_hdr_s *coap
     }
 }
 
+#if MBED_CLIENT_SERVER_BACKOFF_HINT
+bool M2MNsdlInterface::store_server_backoff_hint(const sn_coap_hdr_s *coap_header)
+{
+    if (coap_header->msg_code != COAP_MSG_CODE_RESPONSE_SERVICE_UNAVAILABLE) {
+        return false;
+    }
+
+    // RFC 7252: Max-Age of 5.03 is the time after which to retry, 60 seconds if the option is missing
+    uint32_t max_age = 60;
+    if (coap_header->options_list_ptr) {
+        max_age = coap_header->options_list_ptr->max_age;
+    }
+    _server_backoff_hint = max_age ? max_age : 1;
+    tr_info("M2MNsdlInterface::store_server_backoff_hint - retry after %" PRIu32 " seconds", _server_backoff_hint);
+    return true;
+}
+
+uint32_t M2MNsdlInterface::server_backoff_hint() const
+{
+    return _server_backoff_hint;
+}
+
+uint32_t M2MNsdlInterface::take_server_backoff_hint()
+{
+    uint32_t hint = _server_backoff_hint;
+    _server_backoff_hint = 0;
+    return hint;
+}
+#endif // MBED_CLIENT_SERVER_BACKOFF_HINT
+
+#if MBED_CLIENT_LATENCY_HISTOGRAM
+void M2MNsdlInterface::record_latency(M2MInterface::LatencyOperation operation, uint32_t sent_ticks)
+{
+    uint32_t latency = eventOS_event_timer_ticks_to_ms(eventOS_event_timer_ticks() - sent_ticks);
+    uint8_t bucket = 0;
+    while (latency && bucket < M2M_LATENCY_HISTOGRAM_BUCKETS - 1) {
+        latency >>= 1;
+        bucket++;
+    }
+    _latency_histogram[operation][bucket]++;
+}
+
+void M2MNsdlInterface::get_latency_histogram(M2MInterface::LatencyOperation operation, uint32_t *buckets, bool reset)
+{
+    if (operation >= M2MInterface::LatencyOperationCount || !buckets) {
+        return;
+    }
+    memcpy(buckets, _latency_histogram[operation], sizeof(_latency_histogram[operation]));
+    if (reset) {
+        memset(_latency_histogram[operation], 0, sizeof(_latency_histogram[operation]));
+    }
+}
+#endif // MBED_CLIENT_LATENCY_HISTOGRAM
+
 void M2MNsdlInterface::handle_request_response(const sn_coap_hdr_s *coap_header,
                                                request_context_s *request_context)
 {
@@ -3354,6 +4644,10 @@ void M2MNsdlInterface::handle_request_response(const sn_coap_hdr_s *coap_header,
         // Reset retry timer for next GET request
         _download_retry_time = 0;
 
+#if MBED_CLIENT_LATENCY_HISTOGRAM
+        record_latency(M2MInterface::LatencyRequest, request_context->sent_ticks);
+#endif
+
         // Take copy of uri_path in case of sync mode
         // Pointer is freed already by "free_request_context_list" and then used again in send_request() call
         char *temp = NULL;
@@ -3572,6 +4866,11 @@ void M2MNsdlInterface::handle_empty_ack(const sn_coap_hdr_s *coap_header, bool i
         }
 #endif //MBED_CLIENT_DISABLE_BOOTSTRAP_FEATURE
     } else if (COAP_MSG_TYPE_RESET == coap_header->msg_type) {
+#if MBED_CLIENT_COMPOSITE_OPERATIONS
+        if (handle_composite_notification_reset(coap_header->msg_id)) {
+            return;
+        }
+#endif
         coap_response_s *resp = find_response(coap_header->msg_id);
         if (resp) {
             if (resp->type == M2MBase::PING) {
@@ -3609,6 +4908,11 @@ void M2MNsdlInterface::handle_empty_ack(const sn_coap_hdr_s *coap_header, bool i
 
                 if (report) {
                     if (!data->blockwise_used) {
+#if MBED_CLIENT_LATENCY_HISTOGRAM
+                        if (data->type == M2MBase::NOTIFICATION) {
+                            record_latency(M2MInterface::LatencyNotification, data->sent_ticks);
+                        }
+#endif
                         handle_message_status_callback(base, data->type, M2MBase::MESSAGE_STATUS_DELIVERED);
                         remove_item_from_response_list(NULL, coap_header->msg_id);
                     }
@@ -3748,17 +5052,18 @@ void M2MNsdlInterface::free_response_list()
 {
     // ns_list_foreach() replacement since it does not compile with IAR 7.x versions.
     while (!ns_list_is_empty(&_response_list)) {
-        coap_response_s *data = (coap_response_s *)ns_list_get_first(&_response_list);
-        ns_list_remove(&_response_list, data);
-        memory_free(data->uri_path);
-        memory_free(data);
+        remove_response((coap_response_s *)ns_list_get_first(&_response_list));
     }
 }
 
 void M2MNsdlInterface::remove_item_from_response_list(const char *uri_path, const int32_t msg_id)
 {
+#if MBED_CLIENT_RESPONSE_INDEX_SIZE
+    coap_response_s *data = _response_id_index[index_bucket(msg_id)];
+#else
     // ns_list_foreach() replacement since it does not compile with IAR 7.x versions.
     coap_response_s *data = (coap_response_s *)ns_list_get_first(&_response_list);
+#endif
     while (data) {
         if (data->msg_id == msg_id) {
             bool remove = true;
@@ -3769,33 +5074,39 @@ void M2MNsdlInterface::remove_item_from_response_list(const char *uri_path, cons
                 }
             }
             if (remove) {
-                ns_list_remove(&_response_list, data);
-                memory_free(data->uri_path);
-                memory_free(data);
+                remove_response(data);
                 return;
             }
         }
+#if MBED_CLIENT_RESPONSE_INDEX_SIZE
+        data = data->id_next;
+#else
         data = (coap_response_s *)ns_list_get_next(&_response_list, data);
+#endif
     }
 }
 
 #if !defined(DISABLE_DELAYED_RESPONSE) || defined(ENABLE_ASYNC_REST_RESPONSE)
 void M2MNsdlInterface::remove_items_from_response_list_for_uri(const char *uri_path)
 {
+    if (!uri_path) {
+        return;
+    }
+
+#if MBED_CLIENT_RESPONSE_INDEX_SIZE
+    coap_response_s *data = _response_uri_index[index_uri_bucket(uri_path)];
+#else
     // ns_list_foreach() replacement since it does not compile with IAR 7.x versions.
     coap_response_s *data = (coap_response_s *)ns_list_get_first(&_response_list);
+#endif
     while (data) {
-        bool remove = false;
-        if (uri_path && data->uri_path) {
-            if ((strcmp(uri_path, data->uri_path) == 0)) {
-                remove = true;
-            }
-        }
+#if MBED_CLIENT_RESPONSE_INDEX_SIZE
+        coap_response_s *next = data->uri_next;
+#else
         coap_response_s *next = (coap_response_s *)ns_list_get_next(&_response_list, data);
-        if (remove) {
-            ns_list_remove(&_response_list, data);
-            memory_free(data->uri_path);
-            memory_free(data);
+#endif
+        if (data->uri_path && strcmp(uri_path, data->uri_path) == 0) {
+            remove_response(data);
         }
         data = next;
     }
@@ -3819,14 +5130,68 @@ void M2MNsdlInterface::store_to_response_list(const char *uri, int32_t msg_id, M
         resp->msg_id = msg_id;
         resp->type = type;
         resp->blockwise_used = false;
+#if MBED_CLIENT_LATENCY_HISTOGRAM
+        resp->sent_ticks = eventOS_event_timer_ticks();
+#endif
         ns_list_add_to_end(&_response_list, resp);
+#if MBED_CLIENT_RESPONSE_INDEX_SIZE
+        response_id_index_add(resp);
+        resp->uri_next = NULL;
+        if (resp->uri_path) {
+            coap_response_s **link = &_response_uri_index[index_uri_bucket(resp->uri_path)];
+            while (*link) {
+                link = &(*link)->uri_next;
+            }
+            *link = resp;
+        }
+#endif
     } else {
         tr_error("M2MNsdlInterface::store_to_response_list - failed to allocate coap_response_s!");
     }
 }
 
+void M2MNsdlInterface::remove_response(coap_response_s *response)
+{
+    ns_list_remove(&_response_list, response);
+#if MBED_CLIENT_RESPONSE_INDEX_SIZE
+    response_id_index_remove(response);
+    if (response->uri_path) {
+        coap_response_s **link = &_response_uri_index[index_uri_bucket(response->uri_path)];
+        while (*link) {
+            if (*link == response) {
+                *link = response->uri_next;
+                break;
+            }
+            link = &(*link)->uri_next;
+        }
+    }
+#endif
+    memory_free(response->uri_path);
+    memory_free(response);
+}
+
+void M2MNsdlInterface::set_response_msg_id(coap_response_s *response, int32_t msg_id)
+{
+#if MBED_CLIENT_RESPONSE_INDEX_SIZE
+    response_id_index_remove(response);
+    response->msg_id = msg_id;
+    response_id_index_add(response);
+#else
+    response->msg_id = msg_id;
+#endif
+}
+
 struct M2MNsdlInterface::coap_response_s *M2MNsdlInterface::find_response(int32_t msg_id)
 {
+#if MBED_CLIENT_RESPONSE_INDEX_SIZE
+    coap_response_s *data = _response_id_index[index_bucket(msg_id)];
+    while (data) {
+        if (data->msg_id == msg_id) {
+            return data;
+        }
+        data = data->id_next;
+    }
+#else
     coap_response_s *data = (coap_response_s *)ns_list_get_first(&_response_list);
     while (data) {
         if (data->msg_id == msg_id) {
@@ -3834,6 +5199,7 @@ struct M2MNsdlInterface::coap_response_s *M2MNsdlInterface::find_response(int32_
         }
         data = (coap_response_s *)ns_list_get_next(&_response_list, data);
     }
+#endif
 
     return NULL;
 }
@@ -3843,7 +5209,11 @@ struct M2MNsdlInterface::coap_response_s *M2MNsdlInterface::find_delayed_respons
                                                                                   const M2MBase::MessageType type,
                                                                                   int32_t message_id)
 {
+#if MBED_CLIENT_RESPONSE_INDEX_SIZE
+    coap_response_s *data = _response_uri_index[index_uri_bucket(uri_path)];
+#else
     coap_response_s *data = (coap_response_s *)ns_list_get_first(&_response_list);
+#endif
     while (data) {
         if (data->uri_path &&
                 strcmp(data->uri_path, uri_path) == 0 &&
@@ -3851,13 +5221,60 @@ struct M2MNsdlInterface::coap_response_s *M2MNsdlInterface::find_delayed_respons
                 ((message_id == UNDEFINED_MSG_ID) || (data->msg_id == message_id))) {
             return data;
         }
+#if MBED_CLIENT_RESPONSE_INDEX_SIZE
+        data = data->uri_next;
+#else
         data = (coap_response_s *)ns_list_get_next(&_response_list, data);
+#endif
     }
 
     return NULL;
 }
 #endif // DISABLE_DELAYED_RESPONSE
 
+#if MBED_CLIENT_RESPONSE_INDEX_SIZE
+uint16_t M2MNsdlInterface::index_bucket(uint32_t key)
+{
+    // Tokens are random but message ids are sequential, spread them over the buckets
+    return (uint16_t)(((key * 2654435761u) >> 16) % MBED_CLIENT_RESPONSE_INDEX_SIZE);
+}
+
+uint16_t M2MNsdlInterface::index_uri_bucket(const char *uri_path)
+{
+    uint32_t hash = 2166136261u;
+
+    while (*uri_path) {
+        hash ^= (uint8_t)*uri_path++;
+        hash *= 16777619u;
+    }
+
+    return (uint16_t)(hash % MBED_CLIENT_RESPONSE_INDEX_SIZE);
+}
+
+void M2MNsdlInterface::response_id_index_add(coap_response_s *response)
+{
+    // Appended to the bucket so that a duplicate message id is found in list order
+    response->id_next = NULL;
+    coap_response_s **link = &_response_id_index[index_bucket(response->msg_id)];
+    while (*link) {
+        link = &(*link)->id_next;
+    }
+    *link = response;
+}
+
+void M2MNsdlInterface::response_id_index_remove(coap_response_s *response)
+{
+    coap_response_s **link = &_response_id_index[index_bucket(response->msg_id)];
+    while (*link) {
+        if (*link == response) {
+            *link = response->id_next;
+            return;
+        }
+        link = &(*link)->id_next;
+    }
+}
+#endif
+
 void M2MNsdlInterface::failed_to_send_request(request_context_s *request, const sn_coap_hdr_s *coap_header)
 {
     sn_nsdl_remove_msg_from_retransmission(_nsdl_handle,
@@ -3886,9 +5303,7 @@ void M2MNsdlInterface::remove_ping_from_response_list()
     coap_response_s *data = (coap_response_s *)ns_list_get_first(&_response_list);
     while (data) {
         if (data->type == M2MBase::PING) {
-            ns_list_remove(&_response_list, data);
-            memory_free(data->uri_path);
-            memory_free(data);
+            remove_response(data);
             return;
         }
         data = (coap_response_s *)ns_list_get_next(&_response_list, data);
@@ -3983,6 +5398,7 @@ uint16_t M2MNsdlInterface::get_network_stagger_estimate(bool boostrap) const
 void M2MNsdlInterface::update_network_rtt_estimate()
 {
     _network_rtt_estimate = pal_getRttEstimate();
+    PERF_COUNTER_SET(NETWORK_RTT_ESTIMATE, _network_rtt_estimate);
     tr_info("M2MNsdlInterface::update_network_rtt_estimate() to %d", _network_rtt_estimate);
 }
 
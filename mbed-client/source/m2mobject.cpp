@@ -31,6 +31,7 @@
 #include "mbed-client/m2mstringbuffer.h"
 #include "include/m2mcallbackstorage.h"
 #include "include/m2mdiscover.h"
+#include "include/m2msenmlcborserializer.h"
 
 #include <stdlib.h>
 
@@ -46,7 +47,12 @@ M2MObject::M2MObject(const String &object_name, char *path, bool external_blockw
               path,
               external_blockwise_store,
               false),
-      _observation_handler(NULL)
+      _observation_handler(NULL),
+      _update_depth(0)
+#if MBED_CLIENT_DISCOVER_CACHE
+    , _discover_cache(NULL),
+      _discover_cache_length(0)
+#endif
 #ifdef MBED_CLOUD_CLIENT_EDGE_EXTENSION
     , _endpoint(NULL)
 #endif
@@ -60,7 +66,12 @@ M2MObject::M2MObject(const String &object_name, char *path, bool external_blockw
 
 M2MObject::M2MObject(const M2MBase::lwm2m_parameters_s *static_res)
     : M2MBase(static_res),
-      _observation_handler(NULL)
+      _observation_handler(NULL),
+      _update_depth(0)
+#if MBED_CLIENT_DISCOVER_CACHE
+    , _discover_cache(NULL),
+      _discover_cache_length(0)
+#endif
 #ifdef MBED_CLOUD_CLIENT_EDGE_EXTENSION
     , _endpoint(NULL)
 #endif
@@ -88,6 +99,10 @@ M2MObject::~M2MObject()
         _instance_list.clear();
     }
 
+#if MBED_CLIENT_DISCOVER_CACHE
+    clear_discover_cache();
+#endif
+
     free_resources();
 }
 
@@ -255,6 +270,9 @@ sn_coap_hdr_s *M2MObject::handle_get_request(nsdl_s *nsdl,
                             (coap_response->content_format != COAP_CONTENT_OMA_TLV_TYPE)
 #if defined (MBED_CONF_MBED_CLIENT_ENABLE_DISCOVERY) && (MBED_CONF_MBED_CLIENT_ENABLE_DISCOVERY == 1)
                             && (coap_response->content_format != COAP_CONTENT_OMA_LINK_FORMAT_TYPE)
+#endif
+#if defined (MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR) && (MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR == 1)
+                            && (coap_response->content_format != COAP_CONTENT_OMA_SENML_CBOR_TYPE)
 #endif
                             ) {
                         is_content_type_supported = false;
@@ -274,11 +292,18 @@ sn_coap_hdr_s *M2MObject::handle_get_request(nsdl_s *nsdl,
                         set_coap_content_type(coap_response->content_format);
                         data = M2MTLVSerializer::serialize(_instance_list, data_length);
                     }
+#if defined (MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR) && (MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR == 1)
+                    else if (coap_response->content_format == COAP_CONTENT_OMA_SENML_CBOR_TYPE) {
+                        // Notifications of this observation use the same content format
+                        set_coap_content_type(coap_response->content_format);
+                        data = M2MSenMLCborSerializer::serialize(*this, _instance_list, data_length);
+                    }
+#endif
 #if defined (MBED_CONF_MBED_CLIENT_ENABLE_DISCOVERY) && (MBED_CONF_MBED_CLIENT_ENABLE_DISCOVERY == 1)
                     else if (coap_response->content_format == COAP_CONTENT_OMA_LINK_FORMAT_TYPE) {
                         // Discover
                         data_length = 0;
-                        data = M2MDiscover::create_object_payload(this, data_length);
+                        data = M2MDiscover::create_payload_block(nsdl, *this, *received_coap_header, *coap_response, data_length);
                         if (!data) {
                             data_length = 0;
                             tr_error("M2MObject::handle_get_request() - Discover data allocation failed!");
@@ -346,6 +371,10 @@ sn_coap_hdr_s *M2MObject::handle_put_request(nsdl_s *nsdl,
                     tr_debug("M2MObject::handle_put_request() - Invalid query");
                     msg_code = COAP_MSG_CODE_RESPONSE_BAD_REQUEST; // 4.00
                 }
+#if MBED_CLIENT_DISCOVER_CACHE
+                // Object level attributes are part of the Discover payload
+                clear_discover_cache();
+#endif
 #else
                 msg_code = COAP_MSG_CODE_RESPONSE_BAD_REQUEST; // 4.00
 #endif
@@ -538,6 +567,42 @@ void M2MObject::notification_update(uint16_t obj_instance_id)
     }
 }
 
+void M2MObject::begin_update()
+{
+    _update_depth++;
+}
+
+void M2MObject::commit_update()
+{
+    if (!_update_depth) {
+        tr_error("M2MObject::commit_update() - no update in progress");
+        return;
+    }
+    if (--_update_depth) {
+        return;
+    }
+
+    // Object instances still in their own update report when that ends
+    m2m::Vector<uint16_t> changed_instance_ids;
+    M2MObjectInstanceList::const_iterator it = _instance_list.begin();
+    for (; it != _instance_list.end(); it++) {
+        if (!(*it)->_update_depth && (*it)->report_deferred_changes(false)) {
+            changed_instance_ids.push_back((*it)->instance_id());
+        }
+    }
+
+    M2MReportHandler *report_handler = M2MBase::report_handler();
+    if (!changed_instance_ids.empty() && report_handler && is_under_observation() &&
+            (M2MBase::O_Attribute & observation_level()) == M2MBase::O_Attribute) {
+        report_handler->set_notification_trigger(changed_instance_ids);
+    }
+}
+
+bool M2MObject::update_in_progress() const
+{
+    return _update_depth != 0;
+}
+
 #ifdef MBED_CLOUD_CLIENT_EDGE_EXTENSION
 void M2MObject::set_endpoint(M2MEndpoint *endpoint)
 {
@@ -558,3 +623,18 @@ M2MBase *M2MObject::get_parent() const
     return NULL;
 #endif
 }
+
+#if MBED_CLIENT_DISCOVER_CACHE
+void M2MObject::set_changed()
+{
+    clear_discover_cache();
+    M2MBase::set_changed();
+}
+
+void M2MObject::clear_discover_cache()
+{
+    free(_discover_cache);
+    _discover_cache = NULL;
+    _discover_cache_length = 0;
+}
+#endif
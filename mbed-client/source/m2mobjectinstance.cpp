@@ -34,6 +34,7 @@
 #include "mbed-trace/mbed_trace.h"
 #include "include/m2mcallbackstorage.h"
 #include "include/m2mdiscover.h"
+#include "include/m2msenmlcborserializer.h"
 #include <stdlib.h>
 #include <stdio.h>
 
@@ -52,7 +53,14 @@ M2MObjectInstance::M2MObjectInstance(M2MObject &parent,
               path,
               external_blockwise_store,
               false),
-      _parent(parent)
+      _parent(parent),
+      _update_depth(0),
+      _update_changed(false)
+#if MBED_CLIENT_OBSERVATION_DIFF
+    , _changed_resources(0),
+      _partial_notifications(0),
+      _full_notification(true)
+#endif
 {
     M2MBase::set_base_type(M2MBase::ObjectInstance);
     M2MBase::set_coap_content_type(COAP_CONTENT_OMA_TLV_TYPE);
@@ -60,7 +68,10 @@ M2MObjectInstance::M2MObjectInstance(M2MObject &parent,
 }
 
 M2MObjectInstance::M2MObjectInstance(M2MObject &parent, const lwm2m_parameters_s *static_res)
-    : M2MBase(static_res), _parent(parent)
+    : M2MBase(static_res), _parent(parent), _update_depth(0), _update_changed(false)
+#if MBED_CLIENT_OBSERVATION_DIFF
+    , _changed_resources(0), _partial_notifications(0), _full_notification(true)
+#endif
 {
     M2MBase::set_coap_content_type(COAP_CONTENT_OMA_TLV_TYPE);
     M2MBase::set_operation(M2MBase::GET_ALLOWED);
@@ -502,6 +513,9 @@ sn_coap_hdr_s *M2MObjectInstance::handle_get_request(nsdl_s *nsdl,
                             (coap_response->content_format != COAP_CONTENT_OMA_TLV_TYPE)
 #if defined (MBED_CONF_MBED_CLIENT_ENABLE_DISCOVERY) && (MBED_CONF_MBED_CLIENT_ENABLE_DISCOVERY == 1)
                             && (coap_response->content_format != COAP_CONTENT_OMA_LINK_FORMAT_TYPE)
+#endif
+#if defined (MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR) && (MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR == 1)
+                            && (coap_response->content_format != COAP_CONTENT_OMA_SENML_CBOR_TYPE)
 #endif
                             ) {
                         is_content_type_supported = false;
@@ -521,11 +535,18 @@ sn_coap_hdr_s *M2MObjectInstance::handle_get_request(nsdl_s *nsdl,
                         set_coap_content_type(coap_response->content_format);
                         data = M2MTLVSerializer::serialize(_resource_list, data_length);
                     }
+#if defined (MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR) && (MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR == 1)
+                    else if (coap_response->content_format == COAP_CONTENT_OMA_SENML_CBOR_TYPE) {
+                        // Notifications of this observation use the same content format
+                        set_coap_content_type(coap_response->content_format);
+                        data = M2MSenMLCborSerializer::serialize(*this, data_length);
+                    }
+#endif
 #if defined (MBED_CONF_MBED_CLIENT_ENABLE_DISCOVERY) && (MBED_CONF_MBED_CLIENT_ENABLE_DISCOVERY == 1)
                     else if (coap_response->content_format == COAP_CONTENT_OMA_LINK_FORMAT_TYPE) {
                         // Discover
                         data_length = 0;
-                        data = M2MDiscover::create_object_instance_payload(this, data_length);
+                        data = M2MDiscover::create_payload_block(nsdl, *this, *received_coap_header, *coap_response, data_length);
                         if (!data) {
                             data_length = 0;
                             tr_error("M2MObjectInstance::handle_get_request() - Discover data allocation failed!");
@@ -779,6 +800,125 @@ void M2MObjectInstance::notification_update(M2MBase::Observation observation_lev
     }
 }
 
+void M2MObjectInstance::begin_update()
+{
+    _update_depth++;
+}
+
+void M2MObjectInstance::commit_update()
+{
+    if (!_update_depth) {
+        tr_error("M2MObjectInstance::commit_update() - no update in progress");
+        return;
+    }
+    if (--_update_depth == 0 && !_parent.update_in_progress()) {
+        report_deferred_changes(true);
+    }
+}
+
+bool M2MObjectInstance::update_in_progress() const
+{
+    return _update_depth != 0 || _parent.update_in_progress();
+}
+
+void M2MObjectInstance::defer_report()
+{
+    _update_changed = true;
+}
+
+bool M2MObjectInstance::report_deferred_changes(bool report_object)
+{
+    if (!_update_changed) {
+        return false;
+    }
+    _update_changed = false;
+
+    M2MResourceList::const_iterator it = _resource_list.begin();
+    for (; it != _resource_list.end(); it++) {
+        M2MResource *res = *it;
+        if (res->supports_multiple_instances()) {
+            M2MResourceInstanceList::const_iterator inst = res->resource_instances().begin();
+            for (; inst != res->resource_instances().end(); inst++) {
+                report_deferred_change(**inst);
+            }
+        }
+        report_deferred_change(*res);
+    }
+
+    // One notification for all the changed resources
+    int observation_level = (int)M2MBase::observation_level() | (int)_parent.observation_level();
+    if (!report_object) {
+        observation_level &= ~M2MBase::O_Attribute;
+    }
+    notification_update((M2MBase::Observation)observation_level);
+    return true;
+}
+
+#if MBED_CLIENT_OBSERVATION_DIFF
+void M2MObjectInstance::request_full_notification()
+{
+    _full_notification = true;
+}
+
+void M2MObjectInstance::set_resource_changed(const M2MResource &resource)
+{
+    if (_full_notification) {
+        return;
+    }
+    M2MResourceList::const_iterator it = _resource_list.begin();
+    for (uint8_t pos = 0; it != _resource_list.end(); it++, pos++) {
+        if (*it == &resource) {
+            if (pos < 64) {
+                _changed_resources |= ((uint64_t)1 << pos);
+            } else {
+                _full_notification = true;
+            }
+            return;
+        }
+    }
+}
+
+bool M2MObjectInstance::take_changed_resources(M2MResourceList &list)
+{
+    const uint64_t changed = _changed_resources;
+    _changed_resources = 0;
+
+    if (_full_notification || !changed ||
+            (MBED_CLIENT_OBSERVATION_DIFF_FULL_INTERVAL &&
+             _partial_notifications >= MBED_CLIENT_OBSERVATION_DIFF_FULL_INTERVAL)) {
+        _full_notification = false;
+        _partial_notifications = 0;
+        return false;
+    }
+
+    M2MResourceList::const_iterator it = _resource_list.begin();
+    for (uint8_t pos = 0; it != _resource_list.end() && pos < 64; it++, pos++) {
+        if (changed & ((uint64_t)1 << pos)) {
+            list.push_back(*it);
+        }
+    }
+    _partial_notifications++;
+    return true;
+}
+
+void M2MObjectInstance::set_changed()
+{
+    // Positions in _resource_list may have moved and the server has not seen the new resources
+    _full_notification = true;
+    _changed_resources = 0;
+    M2MBase::set_changed();
+}
+#endif
+
+void M2MObjectInstance::report_deferred_change(M2MResourceBase &resource)
+{
+    sn_nsdl_dynamic_resource_parameters_s *res = resource.get_nsdl_resource();
+    if (res->report_deferred) {
+        res->report_deferred = false;
+        resource.report_change(false);
+    }
+}
+
 M2MBase *M2MObjectInstance::get_parent() const
 {
     return (M2MBase *) &get_parent_object();
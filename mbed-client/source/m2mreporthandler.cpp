@@ -29,13 +29,48 @@
 #include "mbed-client/m2mreportobserver.h"
 #include "mbed-client/m2mconstants.h"
 #include "mbed-client/m2mtimer.h"
+#include "mbed-client/uriqueryparser.h"
 #include "include/m2mreporthandler.h"
 #include "mbed-trace/mbed_trace.h"
+#if MBED_CLIENT_ADAPTIVE_CONFIRMABLE
+#include "eventOS_event_timer.h"
+#endif
 #include <string.h>
 #include <stdlib.h>
 
 #define TRACE_GROUP "mClt"
 
+#if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1)
+// Float to integer conversions for the integer thresholds, saturating at the int64_t range
+static int64_t float_to_int_floor(float value)
+{
+    if (value >= 9.2e18f) {
+        return INT64_MAX;
+    } else if (value <= -9.2e18f) {
+        return INT64_MIN;
+    }
+    int64_t result = (int64_t)value;
+    if ((float)result > value) {
+        result--;
+    }
+    return result;
+}
+
+static int64_t float_to_int_ceil(float value)
+{
+    if (value >= 9.2e18f) {
+        return INT64_MAX;
+    } else if (value <= -9.2e18f) {
+        return INT64_MIN;
+    }
+    int64_t result = (int64_t)value;
+    if ((float)result < value) {
+        result++;
+    }
+    return result;
+}
+#endif
+
 M2MReportHandler::M2MReportHandler(M2MReportObserver &observer, M2MBase::DataType type)
     : _observer(observer),
       _is_under_observation(false),
@@ -52,15 +87,21 @@ M2MReportHandler::M2MReportHandler(M2MReportObserver &observer, M2MBase::DataTyp
 #endif
       _observation_number(0),
 #if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1)
+#if MBED_CLIENT_REPORT_TIMER_TOLERANCE > 0
+      _pmin_timer(*this, M2MTimerObserver::PMinTimer),
+      _pmax_timer(*this, M2MTimerObserver::PMaxTimer),
+#else
       _pmin_timer(*this),
       _pmax_timer(*this),
 #endif
+#endif
 #if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1)
       _pmax(-1.0f),
       _pmin(1.0f),
       _gt(0.0f),
       _lt(0.0f),
       _st(0.0f),
+      _predicate_checks(0),
       _last_value_valid(false),
 #endif
       _token(NULL),
@@ -69,10 +110,25 @@ M2MReportHandler::M2MReportHandler(M2MReportObserver &observer, M2MBase::DataTyp
       _blockwise_notify(false),
 #if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1)
       _pmin_quiet_period(false),
+#endif
+#if MBED_CLIENT_NOTIFICATION_QUEUE
+      _notification_queued(false),
 #endif
       _waiting_to_report(false),
       _confirmable(true),
+#if MBED_CLIENT_ADAPTIVE_CONFIRMABLE
+      _con_current(true),
+      _con_escalated(true),
+      _con_every(MBED_CLIENT_CON_NOTIFICATION_COUNT),
+      _con_interval(MBED_CLIENT_CON_NOTIFICATION_INTERVAL),
+      _non_count(0),
+      _con_ticks(0),
+#endif
       _resource_base(NULL)
+#if MBED_CLIENT_NOTIFICATION_QUEUE
+      , _queue_prev(NULL),
+      _queue_next(NULL)
+#endif
 {
     tr_debug("M2MReportHandler::M2MReportHandler()");
 #if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1)
@@ -87,6 +143,7 @@ M2MReportHandler::M2MReportHandler(M2MReportObserver &observer, M2MBase::DataTyp
         _last_value.int_value = -1;
         _current_value.int_value = 0;
     }
+    compile_predicate();
 #endif
 }
 
@@ -94,6 +151,9 @@ M2MReportHandler::~M2MReportHandler()
 {
     tr_debug("M2MReportHandler::~M2MReportHandler()");
     free(_token);
+#if MBED_CLIENT_NOTIFICATION_QUEUE
+    unqueue_notification();
+#endif
 }
 
 void M2MReportHandler::set_under_observation(bool observed)
@@ -101,6 +161,12 @@ void M2MReportHandler::set_under_observation(bool observed)
     tr_debug("M2MReportHandler::set_under_observation(observed %d)", (int)observed);
 
     _is_under_observation = observed;
+#if MBED_CLIENT_NOTIFICATION_QUEUE
+    // Dropped from the queue while not observed
+    if (observed && (_notification_in_queue || _notification_send_in_progress)) {
+        queue_notification();
+    }
+#endif
 
 #if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1)
     stop_timers();
@@ -123,10 +189,15 @@ void M2MReportHandler::set_value_float(float value)
     _current_value.float_value = value;
 
     if (!_last_value_valid || _current_value.float_value != _last_value.float_value) {
-        send_value();
+        const bool in_range = check_float_value(value);
+        if (in_range) {
+            _high_step.float_value = value + _st;
+            _low_step.float_value = value - _st;
+        }
+        send_value(in_range);
     }
 #else
-    send_value();
+    send_value(true);
 #endif
 }
 
@@ -137,29 +208,50 @@ void M2MReportHandler::set_value_int(int64_t value)
     _current_value.int_value = value;
 
     if (!_last_value_valid || _current_value.int_value != _last_value.int_value) {
-        send_value();
+        const bool in_range = check_int_value(value);
+        if (in_range) {
+            _high_step.int_value = value + _predicate.int_predicate.st;
+            _low_step.int_value = value - _predicate.int_predicate.st;
+        }
+        send_value(in_range);
     }
 #else
-    send_value();
+    send_value(true);
 #endif
 }
 
 void M2MReportHandler::set_notification_trigger(uint16_t obj_instance_id)
 {
     tr_debug("M2MReportHandler::set_notification_trigger(): %d", obj_instance_id);
+    add_changed_instance_id(obj_instance_id);
+    trigger_notification();
+}
+
+void M2MReportHandler::set_notification_trigger(const m2m::Vector<uint16_t> &obj_instance_ids)
+{
+    tr_debug("M2MReportHandler::set_notification_trigger(): %d instances", obj_instance_ids.size());
+    m2m::Vector<uint16_t>::const_iterator it = obj_instance_ids.begin();
+    for (; it != obj_instance_ids.end(); it++) {
+        add_changed_instance_id(*it);
+    }
+    trigger_notification();
+}
+
+void M2MReportHandler::add_changed_instance_id(uint16_t obj_instance_id)
+{
     // Add to array if not there yet
     m2m::Vector<uint16_t>::const_iterator it;
     it = _changed_instance_ids.begin();
-    bool found = false;
     for (; it != _changed_instance_ids.end(); it++) {
         if ((*it) == obj_instance_id) {
-            found = true;
-            break;
+            return;
         }
     }
-    if (!found) {
-        _changed_instance_ids.push_back(obj_instance_id);
-    }
+    _changed_instance_ids.push_back(obj_instance_id);
+}
+
+void M2MReportHandler::trigger_notification()
+{
 #if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1)
     if (_resource_type == M2MBase::FLOAT) {
         _current_value.float_value = 0;
@@ -183,66 +275,38 @@ bool M2MReportHandler::parse_notification_attribute(const char *query,
 {
     tr_debug("M2MReportHandler::parse_notification_attribute(Query %s, Base type %d)", query, (int)type);
     bool success = false;
-    const char *sep_pos = strchr(query, '&');
-    const char *rest = query;
-    if (sep_pos != NULL) {
-        char query_options[5][20];
-        float pmin = _pmin;
-        float pmax = _pmax;
-        float lt = _lt;
-        float gt = _gt;
-        float st = _st;
-        high_step_t high = _high_step;
-        low_step_t low = _low_step;
-        uint8_t attr = _attribute_state;
-
-        memset(query_options, 0, sizeof(query_options[0][0]) * 5 * 20);
-        uint8_t num_options = 0;
-        while (sep_pos != NULL && num_options < 5) {
-            size_t len = (size_t)(sep_pos - rest);
-            if (len > 19) {
-                len = 19;
-            }
-            memcpy(query_options[num_options], rest, len);
-            sep_pos++;
-            rest = sep_pos;
-            sep_pos = strchr(rest, '&');
-            num_options++;
-        }
-        if (num_options < 5 && strlen(rest) > 0) {
-            size_t len = (size_t)strlen(rest);
-            if (len > 19) {
-                len = 19;
-            }
-            memcpy(query_options[num_options++], rest, len);
-        }
-
-        for (int option = 0; option < num_options; option++) {
-            success = set_notification_attribute(query_options[option], type, resource_type);
-            if (!success) {
-                tr_error("M2MReportHandler::parse_notification_attribute - break");
-                break;
-            }
+    float pmin = _pmin;
+    float pmax = _pmax;
+    float lt = _lt;
+    float gt = _gt;
+    float st = _st;
+    high_step_t high = _high_step;
+    low_step_t low = _low_step;
+    uint8_t attr = _attribute_state;
+
+    // Options are parsed in place, an empty option is accepted only after the last '&'
+    query_parameter_s parameter;
+    while (next_query_parameter(&query, NULL, &parameter)) {
+        success = set_notification_attribute(parameter, type, resource_type);
+        if (!success) {
+            break;
         }
+    }
 
-        if (success) {
-            success = check_attribute_validity();
-        } else {
-            tr_debug("M2MReportHandler::parse_notification_attribute - not valid query");
-            _pmin = pmin;
-            _pmax = pmax;
-            _st = st;
-            _lt = lt;
-            _gt = gt;
-            _high_step = high;
-            _low_step = low;
-            _attribute_state = attr;
-        }
+    if (success) {
+        success = check_attribute_validity();
     } else {
-        if (set_notification_attribute(query, type, resource_type)) {
-            success = check_attribute_validity();
-        }
+        tr_debug("M2MReportHandler::parse_notification_attribute - not valid query");
+        _pmin = pmin;
+        _pmax = pmax;
+        _st = st;
+        _lt = lt;
+        _gt = gt;
+        _high_step = high;
+        _low_step = low;
+        _attribute_state = attr;
     }
+    compile_predicate();
 
     return success;
 }
@@ -331,67 +395,81 @@ void M2MReportHandler::timer_expired(M2MTimerObserver::Type type)
     }
 }
 
-bool M2MReportHandler::set_notification_attribute(const char *option,
+uint8_t M2MReportHandler::find_write_attribute(const query_parameter_s &parameter)
+{
+    // Perfect hash of the attribute names: (first character ^ last character) % 7
+    static const struct {
+        const char  *name;
+        uint8_t     attribute;
+    } write_attributes[7] = {
+        { ST_SIZE, M2MReportHandler::St },
+        { PMAX, M2MReportHandler::Pmax },
+        { PMIN, M2MReportHandler::Pmin },
+        { LT, M2MReportHandler::Lt },
+        { NULL, 0 },
+        { GT, M2MReportHandler::Gt },
+        { NULL, 0 }
+    };
+
+    if (parameter.key_len == 0) {
+        return 0;
+    }
+    const uint8_t hash = ((uint8_t)parameter.key[0] ^ (uint8_t)parameter.key[parameter.key_len - 1]) % 7;
+    const char *name = write_attributes[hash].name;
+    if (name && strlen(name) == (size_t)parameter.key_len && memcmp(name, parameter.key, parameter.key_len) == 0) {
+        return write_attributes[hash].attribute;
+    }
+    return 0;
+}
+
+bool M2MReportHandler::set_notification_attribute(const query_parameter_s &parameter,
                                                   M2MBase::BaseType type,
                                                   M2MResourceInstance::ResourceType resource_type)
 {
     bool success = false;
     const int max_size = 20;
-    char attribute[max_size];
     char value[max_size];
 
-    const char *pos = strstr(option, EQUAL);
-    if (pos) {
-        size_t attr_len = pos - option;
-        // Skip the "=" mark
-        pos++;
-        size_t value_len = strlen(pos);
-        if (value_len && value_len < max_size && attr_len < max_size) {
-            memcpy(attribute, option, attr_len);
-            attribute[attr_len] = '\0';
-            memcpy(value, pos, value_len);
-            value[value_len] = '\0';
-            success = true;
-        }
+    // Only the value is copied, as it is converted to a number
+    if (parameter.value && parameter.value_len && parameter.value_len < max_size) {
+        memcpy(value, parameter.value, parameter.value_len);
+        value[parameter.value_len] = '\0';
+        success = true;
     }
 
     if (success) {
-        if (strcmp(attribute, PMIN) == 0) {
+        const uint8_t attribute = find_write_attribute(parameter);
+        if (attribute == M2MReportHandler::Pmin) {
             _pmin = atoi(value);
-            success = true;
             _attribute_state |= M2MReportHandler::Pmin;
-            tr_info("observation_attributes %s %" PRId32, attribute, _pmin);
-        } else if (strcmp(attribute, PMAX) == 0) {
+            tr_info("observation_attributes %s %" PRId32, PMIN, _pmin);
+        } else if (attribute == M2MReportHandler::Pmax) {
             _pmax = atoi(value);
-            success = true;
             _attribute_state |= M2MReportHandler::Pmax;
-            tr_info("observation_attributes %s %" PRId32, attribute, _pmax);
-        } else if (strcmp(attribute, GT) == 0 &&
+            tr_info("observation_attributes %s %" PRId32, PMAX, _pmax);
+        } else if (attribute == M2MReportHandler::Gt &&
                    (M2MBase::Resource == type)) {
-            success = true;
             _gt = atof(value);
             _attribute_state |= M2MReportHandler::Gt;
-            tr_info("observation_attributes %s %f", attribute, _gt);
-        } else if (strcmp(attribute, LT) == 0 &&
+            tr_info("observation_attributes %s %f", GT, _gt);
+        } else if (attribute == M2MReportHandler::Lt &&
                    (M2MBase::Resource == type)) {
-            success = true;
             _lt = atof(value);
             _attribute_state |= M2MReportHandler::Lt;
-            tr_info("observation_attributes %s %f", attribute, _lt);
-        } else if ((strcmp(attribute, ST_SIZE) == 0)
-                   && (M2MBase::Resource == type)) {
-            success = true;
+            tr_info("observation_attributes %s %f", LT, _lt);
+        } else if (attribute == M2MReportHandler::St &&
+                   (M2MBase::Resource == type)) {
             _st = atof(value);
             if (_resource_type == M2MBase::FLOAT) {
                 _high_step.float_value = _current_value.float_value + _st;
                 _low_step.float_value = _current_value.float_value - _st;
             } else {
-                _high_step.int_value = _current_value.int_value + _st;
-                _low_step.int_value = _current_value.int_value - _st;
+                _high_step.int_value = _current_value.int_value + float_to_int_ceil(_st);
+                _low_step.int_value = _current_value.int_value - float_to_int_ceil(_st);
             }
 
             _attribute_state |= M2MReportHandler::St;
-            tr_info("observation_attributes %s %f", attribute, _st);
+            tr_info("observation_attributes %s %f", ST_SIZE, _st);
         } else {
             tr_error("M2MReportHandler::set_notification_attribute - unknown write attribute!");
             success = false;
@@ -411,6 +489,29 @@ bool M2MReportHandler::set_notification_attribute(const char *option,
     }
     return success;
 }
+
+void M2MReportHandler::compile_predicate()
+{
+    _predicate_checks = 0;
+    if (_attribute_state & M2MReportHandler::Gt) {
+        _predicate_checks |= REPORT_CHECK_GT;
+    }
+    if (_attribute_state & M2MReportHandler::Lt) {
+        _predicate_checks |= REPORT_CHECK_LT;
+    }
+    if (_attribute_state & M2MReportHandler::St) {
+        _predicate_checks |= REPORT_CHECK_ST;
+    }
+
+    if (_resource_type == M2MBase::FLOAT) {
+        _predicate.float_predicate.gt = _gt;
+        _predicate.float_predicate.lt = _lt;
+    } else {
+        _predicate.int_predicate.gt = float_to_int_floor(_gt);
+        _predicate.int_predicate.lt = float_to_int_ceil(_lt);
+        _predicate.int_predicate.st = float_to_int_ceil(_st);
+    }
+}
 #endif
 
 void M2MReportHandler::schedule_report(bool in_queue)
@@ -473,9 +574,15 @@ void M2MReportHandler::report(bool in_queue)
             _observation_number++;
         }
 
+#if MBED_CLIENT_ADAPTIVE_CONFIRMABLE
+        select_message_type();
+#endif
         if (_observer.observation_to_be_sent(_changed_instance_ids, observation_number())) {
             _changed_instance_ids.clear();
-            if (_confirmable) {
+#if MBED_CLIENT_ADAPTIVE_CONFIRMABLE
+            message_type_sent();
+#endif
+            if (is_confirmable()) {
                 set_notification_send_in_progress(true);
             }
 #if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1)
@@ -502,9 +609,15 @@ void M2MReportHandler::report(bool in_queue)
                 _observation_number++;
             }
 
+#if MBED_CLIENT_ADAPTIVE_CONFIRMABLE
+            select_message_type();
+#endif
             if (_observer.observation_to_be_sent(_changed_instance_ids, observation_number(), true)) {
                 _changed_instance_ids.clear();
-                if (_confirmable) {
+#if MBED_CLIENT_ADAPTIVE_CONFIRMABLE
+                message_type_sent();
+#endif
+                if (is_confirmable()) {
                     set_notification_send_in_progress(true);
                 }
             } else {
@@ -549,18 +662,26 @@ void M2MReportHandler::handle_timers()
             _pmin_exceeded = false;
             time_interval = (uint64_t)((uint64_t)_pmin * 1000);
             tr_debug("M2MReportHandler::handle_timers() - Start PMIN interval: %d", (int)time_interval);
+#if MBED_CLIENT_REPORT_TIMER_TOLERANCE > 0
+            _pmin_timer.start_timer(time_interval);
+#else
             _pmin_timer.start_timer(time_interval,
                                     M2MTimerObserver::PMinTimer,
                                     true);
+#endif
         }
     }
     if ((_attribute_state & M2MReportHandler::Pmax) == M2MReportHandler::Pmax) {
         if (_pmax > 0) {
             time_interval = (uint64_t)((uint64_t)_pmax * 1000);
             tr_debug("M2MReportHandler::handle_timers() - Start PMAX interval: %d", (int)time_interval);
+#if MBED_CLIENT_REPORT_TIMER_TOLERANCE > 0
+            _pmax_timer.start_timer(time_interval);
+#else
             _pmax_timer.start_timer(time_interval,
                                     M2MTimerObserver::PMaxTimer,
                                     true);
+#endif
         }
     }
 }
@@ -622,6 +743,7 @@ void M2MReportHandler::set_default_values()
         _last_value.int_value = -1;
     }
     _last_value_valid = false;
+    compile_predicate();
 #endif
 }
 
@@ -640,119 +762,46 @@ void M2MReportHandler::init_int_values(int64_t value)
     _last_value_valid = false;
 }
 
-bool M2MReportHandler::check_threshold_values() const
+bool M2MReportHandler::check_float_value(float value) const
 {
-    tr_debug("M2MReportHandler::check_threshold_values");
-    if (_resource_type == M2MBase::FLOAT) {
-        tr_debug("Current value: %f", _current_value.float_value);
-        tr_debug("Last value: %f", _last_value.float_value);
-        tr_debug("High step: %f", _high_step.float_value);
-        tr_debug("Low step: %f", _low_step.float_value);
-    } else {
-        tr_debug("Current value: %" PRId64, _current_value.int_value);
-        tr_debug("Last value: %" PRId64, _last_value.int_value);
-        tr_debug("High step: %" PRId64, _high_step.int_value);
-        tr_debug("Low step: %" PRId64, _low_step.int_value);
-    }
-
-    tr_debug("Less than: %f", _lt);
-    tr_debug("Greater than: %f", _gt);
-    tr_debug("Step: %f", _st);
-
-    bool can_send = check_gt_lt_params();
-    if (can_send) {
-        if ((_attribute_state & M2MReportHandler::St) == M2MReportHandler::St) {
-            can_send = false;
-
-            if (_resource_type == M2MBase::FLOAT) {
-                if (_current_value.float_value >= _high_step.float_value ||
-                        _current_value.float_value <= _low_step.float_value) {
-                    can_send = true;
-                }
-            } else {
-                if ((_current_value.int_value >= _high_step.int_value ||
-                        _current_value.int_value <= _low_step.int_value)) {
-                    can_send = true;
-                }
-            }
-        }
-    }
-
-    tr_debug("M2MReportHandler::check_threshold_values - value can be sent = %d", (int)can_send);
-    return can_send;
+    const float_predicate_t &predicate = _predicate.float_predicate;
+    const float last = _last_value.float_value;
+    const unsigned checks = _predicate_checks;
+
+    // A value passes gt and lt when it crosses one of them in either direction,
+    // or when neither is set. Without a valid last value, the first value is always sent.
+    const unsigned gt_crossed = (value > predicate.gt) ^ (last > predicate.gt);
+    const unsigned lt_crossed = (value < predicate.lt) ^ (last < predicate.lt);
+    const unsigned in_band = !_last_value_valid |
+                             !(checks & (REPORT_CHECK_GT | REPORT_CHECK_LT)) |
+                             (gt_crossed & (checks & REPORT_CHECK_GT)) |
+                             (lt_crossed & ((checks & REPORT_CHECK_LT) >> 1));
+    const unsigned in_step = !(checks & REPORT_CHECK_ST) |
+                             (value >= _high_step.float_value) |
+                             (value <= _low_step.float_value);
+
+    tr_debug("M2MReportHandler::check_float_value - %f, last %f, in band %u, in step %u", value, last, in_band, in_step);
+    return in_band & in_step;
 }
 
-bool M2MReportHandler::check_gt_lt_params() const
+bool M2MReportHandler::check_int_value(int64_t value) const
 {
-    tr_debug("M2MReportHandler::check_gt_lt_params");
-    if (!_last_value_valid) {
-        tr_debug("No valid _last_value, sending initial notification");
-        return true;
-    }
-    bool can_send = false;
-    // GT & LT set.
-    if ((_attribute_state & (M2MReportHandler::Lt | M2MReportHandler::Gt)) ==
-            (M2MReportHandler::Lt | M2MReportHandler::Gt)) {
-        if (_resource_type == M2MBase::FLOAT) {
-            if ((_current_value.float_value > _gt  && _last_value.float_value <= _gt) ||
-                    (_current_value.float_value < _lt && _last_value.float_value >= _lt)) {
-                can_send = true;
-            } else if ((_current_value.float_value <= _gt && _last_value.float_value > _gt) ||
-                       (_current_value.float_value >= _lt && _last_value.float_value < _lt)) {
-                can_send = true;
-            }
-        } else {
-            if ((_current_value.int_value > _gt && _last_value.int_value <= _gt) ||
-                    (_current_value.int_value < _lt && _last_value.int_value >= _lt)) {
-                can_send = true;
-            } else if ((_current_value.int_value <= _gt && _last_value.int_value > _gt) ||
-                       (_current_value.int_value >= _lt && _last_value.int_value < _lt)) {
-                can_send = true;
-            }
-        }
-    }
-    // Only LT
-    else if ((_attribute_state & M2MReportHandler::Lt) == M2MReportHandler::Lt &&
-             (_attribute_state & M2MReportHandler::Gt) == 0) {
-        if (_resource_type == M2MBase::FLOAT) {
-            if (_current_value.float_value < _lt && _last_value.float_value >= _lt) {
-                can_send = true;
-            } else if (_current_value.float_value >= _lt && _last_value.float_value < _lt) {
-                can_send = true;
-            }
-        } else {
-            if (_current_value.int_value < _lt && _last_value.int_value >= _lt) {
-                can_send = true;
-            } else if (_current_value.int_value >= _lt && _last_value.int_value < _lt) {
-                can_send = true;
-            }
-        }
-
-    }
-    // Only GT
-    else if ((_attribute_state & M2MReportHandler::Gt) == M2MReportHandler::Gt &&
-             (_attribute_state & M2MReportHandler::Lt) == 0) {
-        if (_resource_type == M2MBase::FLOAT) {
-            if (_current_value.float_value > _gt && _last_value.float_value <= _gt) {
-                can_send = true;
-            } else if (_current_value.float_value <= _gt && _last_value.float_value > _gt) {
-                can_send = true;
-            }
-        } else {
-            if (_current_value.int_value > _gt && _last_value.int_value <= _gt) {
-                can_send = true;
-            } else if (_current_value.int_value <= _gt && _last_value.int_value > _gt) {
-                can_send = true;
-            }
-        }
-
-    }
-    // GT & LT not set.
-    else {
-        can_send = true;
-    }
-    tr_debug("M2MReportHandler::check_gt_lt_params - value in range = %d", (int)can_send);
-    return can_send;
+    const int_predicate_t &predicate = _predicate.int_predicate;
+    const int64_t last = _last_value.int_value;
+    const unsigned checks = _predicate_checks;
+
+    const unsigned gt_crossed = (value > predicate.gt) ^ (last > predicate.gt);
+    const unsigned lt_crossed = (value < predicate.lt) ^ (last < predicate.lt);
+    const unsigned in_band = !_last_value_valid |
+                             !(checks & (REPORT_CHECK_GT | REPORT_CHECK_LT)) |
+                             (gt_crossed & (checks & REPORT_CHECK_GT)) |
+                             (lt_crossed & ((checks & REPORT_CHECK_LT) >> 1));
+    const unsigned in_step = !(checks & REPORT_CHECK_ST) |
+                             (value >= _high_step.int_value) |
+                             (value <= _low_step.int_value);
+
+    tr_debug("M2MReportHandler::check_int_value - %" PRId64 ", last %" PRId64 ", in band %u, in step %u", value, last, in_band, in_step);
+    return in_band & in_step;
 }
 
 uint8_t M2MReportHandler::attribute_flags() const
@@ -838,6 +887,11 @@ uint8_t *M2MReportHandler::alloc_copy(const uint8_t *source, uint32_t size)
 void M2MReportHandler::set_notification_in_queue(bool to_queue)
 {
     _notification_in_queue = to_queue;
+#if MBED_CLIENT_NOTIFICATION_QUEUE
+    if (to_queue) {
+        queue_notification();
+    }
+#endif
 }
 
 bool M2MReportHandler::notification_in_queue() const
@@ -848,6 +902,11 @@ bool M2MReportHandler::notification_in_queue() const
 void M2MReportHandler::set_notification_send_in_progress(bool progress)
 {
     _notification_send_in_progress = progress;
+#if MBED_CLIENT_NOTIFICATION_QUEUE
+    if (progress) {
+        queue_notification();
+    }
+#endif
 }
 
 bool M2MReportHandler::notification_send_in_progress() const
@@ -855,6 +914,69 @@ bool M2MReportHandler::notification_send_in_progress() const
     return _notification_send_in_progress;
 }
 
+#if MBED_CLIENT_NOTIFICATION_QUEUE
+M2MReportHandler *M2MReportHandler::_queue_head = NULL;
+M2MReportHandler *M2MReportHandler::_queue_tail = NULL;
+
+void M2MReportHandler::queue_notification()
+{
+    if (_notification_queued) {
+        return;
+    }
+    _queue_prev = _queue_tail;
+    _queue_next = NULL;
+    if (_queue_tail) {
+        _queue_tail->_queue_next = this;
+    } else {
+        _queue_head = this;
+    }
+    _queue_tail = this;
+    _notification_queued = true;
+}
+
+void M2MReportHandler::unqueue_notification()
+{
+    if (!_notification_queued) {
+        return;
+    }
+    if (_queue_prev) {
+        _queue_prev->_queue_next = _queue_next;
+    } else {
+        _queue_head = _queue_next;
+    }
+    if (_queue_next) {
+        _queue_next->_queue_prev = _queue_prev;
+    } else {
+        _queue_tail = _queue_prev;
+    }
+    _queue_prev = NULL;
+    _queue_next = NULL;
+    _notification_queued = false;
+}
+
+M2MReportHandler *M2MReportHandler::next_queued_notification()
+{
+    while (_queue_head) {
+        M2MReportHandler *reporter = _queue_head;
+        if (reporter->_is_under_observation &&
+                (reporter->_notification_in_queue || reporter->_notification_send_in_progress)) {
+            return reporter;
+        }
+        // Flags were cleared without touching the queue, or the observation is gone
+        reporter->unqueue_notification();
+    }
+    return NULL;
+}
+
+void M2MReportHandler::requeue_notification()
+{
+    unqueue_notification();
+    if (_notification_in_queue || _notification_send_in_progress) {
+        queue_notification();
+    }
+}
+#endif
+
 void M2MReportHandler::set_blockwise_notify(bool blockwise_notify)
 {
     _blockwise_notify = blockwise_notify;
@@ -865,22 +987,20 @@ bool M2MReportHandler::blockwise_notify() const
     return _blockwise_notify;
 }
 
-void M2MReportHandler::send_value()
+void M2MReportHandler::send_value(bool in_range)
 {
     tr_debug("M2MReportHandler::send_value() - new value");
 #if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1)
-    if (check_threshold_values()) {
+    if (in_range) {
+#if MBED_CLIENT_ADAPTIVE_CONFIRMABLE
+        // With gt or lt set, a value is reported only when it crosses one of them
+        if (_last_value_valid && (_predicate_checks & (REPORT_CHECK_GT | REPORT_CHECK_LT))) {
+            _con_escalated = true;
+        }
+#endif
         if (_confirmable) {
             set_notification_in_queue(true);
         }
-        if (_resource_type == M2MBase::FLOAT) {
-            _high_step.float_value = _current_value.float_value + _st;
-            _low_step.float_value = _current_value.float_value - _st;
-        }
-        if (_resource_type == M2MBase::INTEGER) {
-            _high_step.int_value = _current_value.int_value + _st;
-            _low_step.int_value = _current_value.int_value - _st;
-        }
         schedule_report();
     } else {
         tr_debug("M2MReportHandler::send_value - value not in range");
@@ -894,6 +1014,7 @@ void M2MReportHandler::send_value()
         }
     }
 #else
+    (void)in_range;
     if (_confirmable) {
         set_notification_in_queue(true);
     }
@@ -904,9 +1025,60 @@ void M2MReportHandler::send_value()
 void M2MReportHandler::set_confirmable(bool confirmable)
 {
     _confirmable = confirmable;
+#if MBED_CLIENT_ADAPTIVE_CONFIRMABLE
+    _con_every = 0;
+    _con_interval = 0;
+#endif
 }
 
 bool M2MReportHandler::is_confirmable() const
 {
+#if MBED_CLIENT_ADAPTIVE_CONFIRMABLE
+    if (_con_every || _con_interval) {
+        return _con_current;
+    }
+#endif
     return _confirmable;
 }
+
+#if MBED_CLIENT_ADAPTIVE_CONFIRMABLE
+void M2MReportHandler::set_confirmable_policy(uint16_t con_every, uint16_t con_interval)
+{
+    _con_every = con_every;
+    _con_interval = con_interval;
+    // The first notification under the policy is confirmable
+    _con_current = true;
+    _con_escalated = true;
+    _non_count = 0;
+}
+
+void M2MReportHandler::notification_lost()
+{
+    _con_escalated = true;
+}
+
+void M2MReportHandler::select_message_type()
+{
+    if (!_con_every && !_con_interval) {
+        return;
+    }
+    const uint32_t elapsed = eventOS_event_timer_ticks() - _con_ticks;
+    _con_current = _con_escalated ||
+                   (_con_every && _non_count + 1 >= _con_every) ||
+                   (_con_interval && elapsed >= eventOS_event_timer_ms_to_ticks((uint32_t)_con_interval * 1000));
+}
+
+void M2MReportHandler::message_type_sent()
+{
+    if (!_con_every && !_con_interval) {
+        return;
+    }
+    if (_con_current) {
+        _con_escalated = false;
+        _non_count = 0;
+        _con_ticks = eventOS_event_timer_ticks();
+    } else if (_non_count < UINT16_MAX) {
+        _non_count++;
+    }
+}
+#endif
@@ -0,0 +1,348 @@
+/*
+ * Copyright (c) 2021 Pelion. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Note: this macro is needed on armcc to get the the limit macros like INT32_MAX
+#ifndef __STDC_LIMIT_MACROS
+#define __STDC_LIMIT_MACROS
+#endif
+
+// Note: this macro is needed on armcc to get the the PRI*32 macros
+// from inttypes.h in a C++ code.
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include "include/m2mreportscheduler.h"
+
+#if defined (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS) && (MBED_CONF_MBED_CLIENT_ENABLE_OBSERVATION_PARAMETERS == 1) && (MBED_CLIENT_REPORT_TIMER_TOLERANCE > 0)
+
+#include "eventOS_event_timer.h"
+#include "mbed-trace/mbed_trace.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+
+#define TRACE_GROUP "mClt"
+
+// Longest wait of one round, longer intervals are scheduled in several rounds
+// so that the tick arithmetic below never overflows
+#define REPORT_SCHEDULER_MAX_ROUND INT32_MAX
+
+M2MReportScheduler *M2MReportScheduler::_static_instance = NULL;
+uint16_t M2MReportScheduler::_references = 0;
+
+// Wrap-safe comparison of two tick counts
+static inline bool ticks_reached(uint32_t deadline, uint32_t now)
+{
+    return (int32_t)(deadline - now) <= 0;
+}
+
+M2MReportScheduler::Entry::Entry(M2MTimerObserver &observer, M2MTimerObserver::Type type)
+    : _observer(observer),
+      _prev(NULL),
+      _next(NULL),
+      _still_left(0),
+      _deadline(0),
+      _type(type),
+      _scheduled(false),
+      _expire_early(false)
+{
+}
+
+M2MReportScheduler::Entry::~Entry()
+{
+    stop_timer();
+}
+
+void M2MReportScheduler::Entry::start_timer(uint64_t interval)
+{
+    M2MReportScheduler *scheduler = M2MReportScheduler::get_instance();
+    if (scheduler) {
+        scheduler->schedule(*this, interval);
+    }
+}
+
+void M2MReportScheduler::Entry::stop_timer()
+{
+    // Must not create the instance, entries are also stopped from destructors
+    if (_scheduled && M2MReportScheduler::_static_instance) {
+        M2MReportScheduler::_static_instance->unschedule(*this);
+    }
+}
+
+M2MReportScheduler *M2MReportScheduler::get_instance()
+{
+    if (M2MReportScheduler::_static_instance == NULL) {
+        M2MReportScheduler::_static_instance = new M2MReportScheduler();
+    }
+    return M2MReportScheduler::_static_instance;
+}
+
+void M2MReportScheduler::delete_instance()
+{
+    delete M2MReportScheduler::_static_instance;
+    M2MReportScheduler::_static_instance = NULL;
+}
+
+void M2MReportScheduler::acquire_instance()
+{
+    M2MReportScheduler::_references++;
+}
+
+void M2MReportScheduler::release_instance()
+{
+    // Entries of the other client instances stay scheduled
+    if (M2MReportScheduler::_references > 0 && --M2MReportScheduler::_references == 0) {
+        delete_instance();
+    }
+}
+
+M2MReportScheduler::M2MReportScheduler()
+    : _timer(*this),
+      _head(NULL),
+      _tail(NULL),
+      _armed_deadline(0),
+      _armed(false),
+      _dispatching(false)
+{
+}
+
+M2MReportScheduler::~M2MReportScheduler()
+{
+    _timer.stop_timer();
+
+    Entry *entry = _head;
+    while (entry) {
+        Entry *next = entry->_next;
+        entry->_prev = NULL;
+        entry->_next = NULL;
+        entry->_scheduled = false;
+        entry = next;
+    }
+    _head = NULL;
+    _tail = NULL;
+}
+
+void M2MReportScheduler::schedule(Entry &entry, uint64_t interval)
+{
+    unschedule(entry);
+
+    if (interval > REPORT_SCHEDULER_MAX_ROUND) {
+        entry._still_left = interval - REPORT_SCHEDULER_MAX_ROUND;
+        interval = REPORT_SCHEDULER_MAX_ROUND;
+    } else {
+        entry._still_left = 0;
+    }
+
+    const uint32_t tolerance = eventOS_event_timer_ms_to_ticks(MBED_CLIENT_REPORT_TIMER_TOLERANCE);
+    const uint32_t now = eventOS_event_timer_ticks();
+    uint32_t ticks = eventOS_event_timer_ms_to_ticks((uint32_t)interval);
+    if (ticks == 0) {
+        ticks = 1;
+    }
+
+    // pmax is an upper limit for the report period and is never extended,
+    // everything else only waits until the next bucket boundary
+    const uint32_t exact = now + ticks;
+    const uint32_t remainder = exact % tolerance;
+    uint32_t deadline = exact;
+    if (remainder) {
+        if (entry._type == M2MTimerObserver::PMaxTimer && !entry._still_left) {
+            deadline -= remainder;
+        } else {
+            deadline += tolerance - remainder;
+        }
+    }
+
+    // Rounding down can not go to the past, keep such short pmax exact
+    if (ticks_reached(deadline, now)) {
+        deadline = exact;
+    }
+
+    entry._deadline = deadline;
+    insert(entry);
+}
+
+void M2MReportScheduler::insert(Entry &entry)
+{
+    // Deadlines are mostly later than the ones queued before, so walk from the tail.
+    // Entries with equal deadline expire in the order they were scheduled.
+    Entry *prev = _tail;
+    while (prev && !ticks_reached(prev->_deadline, entry._deadline)) {
+        prev = prev->_prev;
+    }
+
+    entry._prev = prev;
+    if (prev) {
+        entry._next = prev->_next;
+        prev->_next = &entry;
+    } else {
+        entry._next = _head;
+        _head = &entry;
+    }
+
+    if (entry._next) {
+        entry._next->_prev = &entry;
+    } else {
+        _tail = &entry;
+    }
+    entry._scheduled = true;
+
+    if (_head == &entry && !_dispatching) {
+        arm_timer();
+    }
+}
+
+void M2MReportScheduler::unschedule(Entry &entry)
+{
+    if (!entry._scheduled) {
+        return;
+    }
+
+    if (entry._prev) {
+        entry._prev->_next = entry._next;
+    } else {
+        _head = entry._next;
+    }
+
+    if (entry._next) {
+        entry._next->_prev = entry._prev;
+    } else {
+        _tail = entry._prev;
+    }
+
+    entry._prev = NULL;
+    entry._next = NULL;
+    entry._scheduled = false;
+    entry._expire_early = false;
+
+    // Timer armed for a removed head is left running, the spurious expiration
+    // just re-arms it. That is cheaper than restarting it on every report.
+    if (!_head && !_dispatching) {
+        arm_timer();
+    }
+}
+
+void M2MReportScheduler::arm_timer()
+{
+    if (!_head) {
+        if (_armed) {
+            _timer.stop_timer();
+            _armed = false;
+        }
+        return;
+    }
+
+    if (_armed && _armed_deadline == _head->_deadline) {
+        return;
+    }
+
+    const uint32_t now = eventOS_event_timer_ticks();
+    uint32_t wait = 0;
+    if (!ticks_reached(_head->_deadline, now)) {
+        wait = _head->_deadline - now;
+    }
+
+    _timer.start_timer(eventOS_event_timer_ticks_to_ms(wait), M2MTimerObserver::Notdefined, true);
+    _armed_deadline = _head->_deadline;
+    _armed = true;
+}
+
+void M2MReportScheduler::timer_expired(M2MTimerObserver::Type)
+{
+    _armed = false;
+    _dispatching = true;
+
+    // Entries rescheduled by the observers always get a deadline after now,
+    // so this terminates even if every observer restarts its entry.
+    const uint32_t now = eventOS_event_timer_ticks();
+    uint32_t count = 0;
+    while (_head && ticks_reached(_head->_deadline, now)) {
+        Entry *entry = _head;
+        unschedule(*entry);
+
+        if (entry->_still_left) {
+            schedule(*entry, entry->_still_left);
+        } else {
+            count++;
+            entry->_observer.timer_expired(entry->_type);
+        }
+    }
+    tr_debug("M2MReportScheduler::timer_expired - %" PRIu32 " entries expired", count);
+
+    _dispatching = false;
+    arm_timer();
+}
+
+#if MBED_CLIENT_WAKE_WINDOW
+uint64_t M2MReportScheduler::time_to_next_deadline() const
+{
+    const uint32_t now = eventOS_event_timer_ticks();
+    uint64_t earliest = UINT64_MAX;
+    for (const Entry *entry = _head; entry; entry = entry->_next) {
+        uint64_t time = 0;
+        if (!ticks_reached(entry->_deadline, now)) {
+            time = eventOS_event_timer_ticks_to_ms(entry->_deadline - now);
+        }
+        // A long interval does not expire at the end of its first round
+        time += entry->_still_left;
+        if (time < earliest) {
+            earliest = time;
+        }
+    }
+    return earliest;
+}
+
+void M2MReportScheduler::expire_pmax_early(uint64_t window)
+{
+    if (_dispatching) {
+        return;
+    }
+
+    const uint32_t now = eventOS_event_timer_ticks();
+    if (window > REPORT_SCHEDULER_MAX_ROUND) {
+        window = REPORT_SCHEDULER_MAX_ROUND;
+    }
+    const uint32_t limit = now + eventOS_event_timer_ms_to_ticks((uint32_t)window);
+
+    // Mark first, entries the observers schedule again are not marked and
+    // so are not expired twice, however short their pmax is
+    for (Entry *entry = _head; entry && ticks_reached(entry->_deadline, limit); entry = entry->_next) {
+        entry->_expire_early = (entry->_type == M2MTimerObserver::PMaxTimer && !entry->_still_left);
+    }
+
+    _dispatching = true;
+    uint32_t count = 0;
+    Entry *entry = _head;
+    while (entry) {
+        if (!entry->_expire_early) {
+            entry = entry->_next;
+            continue;
+        }
+        unschedule(*entry);
+        count++;
+        entry->_observer.timer_expired(entry->_type);
+        // The observer may have moved any entry, start over
+        entry = _head;
+    }
+    tr_debug("M2MReportScheduler::expire_pmax_early - %" PRIu32 " entries expired", count);
+
+    _dispatching = false;
+    arm_timer();
+}
+#endif
+
+#endif // MBED_CLIENT_REPORT_TIMER_TOLERANCE
@@ -20,6 +20,7 @@
 #include "include/m2mtlvserializer.h"
 #include "include/m2mtlvdeserializer.h"
 #include "include/m2mdiscover.h"
+#include "include/m2mexecutepool.h"
 #include "mbed-trace/mbed_trace.h"
 
 #include <stdlib.h>
@@ -99,6 +100,9 @@ M2MResource::M2MResource(M2MObjectInstance &parent,
 
 M2MResource::~M2MResource()
 {
+#if MBED_CLIENT_EXECUTE_THREADS
+    M2MExecutePool::cancel(*this);
+#endif
     if(!_resource_instance_list.empty()) {
         M2MResourceInstance* res = NULL;
         M2MResourceInstanceList::const_iterator it;
@@ -132,6 +136,12 @@ void M2MResource::set_delayed_response(bool delayed_response)
 bool M2MResource::send_delayed_post_response(sn_coap_msg_code_e code)
 {
     bool success = false;
+#if MBED_CLIENT_EXECUTE_THREADS
+    // Called from an execute callback running on a worker thread, sent once the callback returns
+    if (_delayed_response && M2MExecutePool::defer_delayed_response(*this, code)) {
+        return true;
+    }
+#endif
     if(_delayed_response) {
         success = true;
         // At least on some unit tests the resource object is not fully constructed, which would
@@ -370,7 +380,7 @@ sn_coap_hdr_s* M2MResource::handle_get_request(nsdl_s *nsdl,
                         else if (coap_response->content_format == COAP_CONTENT_OMA_LINK_FORMAT_TYPE) {
                             // Discover
                             data_length = 0;
-                            data = M2MDiscover::create_resource_payload(this, data_length);
+                            data = M2MDiscover::create_payload_block(nsdl, *this, *received_coap_header, *coap_response, data_length);
                             if (!data) {
                                 data_length = 0;
                                 tr_error("M2MResource::handle_get_request() - Discover data allocation failed!");
@@ -597,7 +607,13 @@ sn_coap_hdr_s* M2MResource::handle_post_request(nsdl_s *nsdl,
                     }
                 }
 #endif
+#if MBED_CLIENT_EXECUTE_THREADS
+                if (!M2MExecutePool::dispatch(*this, exec_params)) {
+                    execute(&exec_params);
+                }
+#else
                 execute(&exec_params);
+#endif
             }
 
         } else { // if ((object->operation() & SN_GRS_POST_ALLOWED) != 0)
@@ -635,6 +651,30 @@ M2MResource& M2MResource::get_parent_resource() const
     return (M2MResource&)*this;
 }
 
+void M2MResource::execute_with_argument(const uint8_t *value, uint16_t value_length)
+{
+#ifndef MEMORY_OPTIMIZED_API
+    const String &obj_name = object_name();
+    const String &res_name = name();
+    M2MResource::M2MExecuteParameter exec_params(obj_name, res_name, object_instance_id());
+#else
+    M2MResource::M2MExecuteParameter exec_params(object_name(), name(), object_instance_id());
+#endif
+#ifdef MBED_CLOUD_CLIENT_EDGE_EXTENSION
+    exec_params.set_resource(this);
+#endif
+    exec_params._value = value;
+    exec_params._value_length = value ? value_length : 0;
+
+#if MBED_CLIENT_EXECUTE_THREADS
+    if (!M2MExecutePool::dispatch(*this, exec_params)) {
+        execute(&exec_params);
+    }
+#else
+    execute(&exec_params);
+#endif
+}
+
 const char* M2MResource::object_name() const
 {
     const M2MObjectInstance& parent_object_instance = _parent;
@@ -44,10 +44,6 @@
 
 #define TRACE_GROUP "mClt"
 
-// -9223372036854775808 - +9223372036854775807
-// max length of int64_t string is 20 bytes + nil
-#define REGISTRY_INT64_STRING_MAX_LEN 21
-
 
 M2MResourceBase::M2MResourceBase(
     const String &res_name,
@@ -174,7 +170,10 @@ bool M2MResourceBase::set_resource_read_callback(read_resource_value_callback ca
 {
     M2MCallbackStorage::remove_callback(*this, M2MCallbackAssociation::M2MResourceBaseValueReadCallback);
     M2MBase::lwm2m_parameters_s *param = M2MBase::get_lwm2m_parameters();
-    param->read_write_callback_set = true;
+    // Descriptors in flash, see M2M_STATIC_CALLBACK_RESOURCE(), have the flag set already
+    if (!param->read_write_callback_set) {
+        param->read_write_callback_set = true;
+    }
     return M2MCallbackStorage::add_callback(*this,
                                             (void *)callback,
                                             M2MCallbackAssociation::M2MResourceBaseValueReadCallback,
@@ -185,7 +184,10 @@ bool M2MResourceBase::set_resource_read_size_callback(read_resource_value_size_c
 {
     M2MCallbackStorage::remove_callback(*this, M2MCallbackAssociation::M2MResourceBaseValueReadSizeCallback);
     M2MBase::lwm2m_parameters_s *param = M2MBase::get_lwm2m_parameters();
-    param->read_write_callback_set = true;
+    // Descriptors in flash, see M2M_STATIC_CALLBACK_RESOURCE(), have the flag set already
+    if (!param->read_write_callback_set) {
+        param->read_write_callback_set = true;
+    }
     return M2MCallbackStorage::add_callback(*this,
                                             (void *)callback,
                                             M2MCallbackAssociation::M2MResourceBaseValueReadSizeCallback,
@@ -196,7 +198,10 @@ bool M2MResourceBase::set_resource_write_callback(write_resource_value_callback
 {
     M2MCallbackStorage::remove_callback(*this, M2MCallbackAssociation::M2MResourceBaseValueWriteCallback);
     M2MBase::lwm2m_parameters_s *param = M2MBase::get_lwm2m_parameters();
-    param->read_write_callback_set = true;
+    // Descriptors in flash, see M2M_STATIC_CALLBACK_RESOURCE(), have the flag set already
+    if (!param->read_write_callback_set) {
+        param->read_write_callback_set = true;
+    }
 
     return M2MCallbackStorage::add_callback(*this,
                                             (void *)callback,
@@ -209,7 +214,7 @@ void M2MResourceBase::clear_value()
     tr_debug("M2MResourceBase::clear_value");
 
     sn_nsdl_dynamic_resource_parameters_s *res = get_nsdl_resource();
-    free(res->resource);
+    free_value();
     res->resource = NULL;
     res->resource_len = 0;
 
@@ -255,15 +260,15 @@ bool M2MResourceBase::set_value(const uint8_t *value,
         if (param->read_write_callback_set) {
             return write_resource_value(*this, value, value_length);
         } else {
-            uint8_t *value_copy = alloc_string_copy(value, value_length);
-            if (value_copy) {
-                value_set_callback callback = (value_set_callback)M2MCallbackStorage::get_callback(*this, M2MCallbackAssociation::M2MResourceBaseValueSetCallback);
-                if (callback) {
+            value_set_callback callback = (value_set_callback)M2MCallbackStorage::get_callback(*this, M2MCallbackAssociation::M2MResourceBaseValueSetCallback);
+            if (callback) {
+                uint8_t *value_copy = alloc_string_copy(value, value_length);
+                if (value_copy) {
                     (*callback)((const M2MResourceBase *)this, value_copy, value_length);
-                } else {
-                    update_value(value_copy, value_length);
+                    success = true;
                 }
-                success = true;
+            } else {
+                success = copy_value(value, value_length);
             }
         }
     }
@@ -292,7 +297,7 @@ void M2MResourceBase::update_value(uint8_t *value, const uint32_t value_length)
 {
     bool changed = has_value_changed(value, value_length);
     sn_nsdl_dynamic_resource_parameters_s *res = get_nsdl_resource();
-    free(res->resource);
+    free_value();
     res->resource = value;
     res->resource_len = value_length;
     if (changed) {
@@ -300,6 +305,47 @@ void M2MResourceBase::update_value(uint8_t *value, const uint32_t value_length)
     }
 }
 
+bool M2MResourceBase::copy_value(const uint8_t *value, const uint32_t value_length)
+{
+    if (!has_value_changed(value, value_length)) {
+        return true;
+    }
+
+    sn_nsdl_dynamic_resource_parameters_s *res = get_nsdl_resource();
+    if (res->resource && value_length == res->resource_len) {
+        // Same size, typical for sensor readings, overwrite in place without touching the heap
+        memcpy(res->resource, value, value_length);
+    }
+#if MBED_CLIENT_INLINE_RESOURCE_VALUE_SIZE
+    else if (value_length < MBED_CLIENT_INLINE_RESOURCE_VALUE_SIZE) {
+        free_value();
+        memcpy(res->value_buffer, value, value_length);
+        res->value_buffer[value_length] = '\0';
+        res->resource = res->value_buffer;
+    }
+#endif
+    else {
+        uint8_t *value_copy = alloc_string_copy(value, value_length);
+        if (!value_copy) {
+            return false;
+        }
+        free_value();
+        res->resource = value_copy;
+    }
+    res->resource_len = value_length;
+
+    report_value_change();
+    return true;
+}
+
+void M2MResourceBase::free_value()
+{
+    sn_nsdl_dynamic_resource_parameters_s *res = get_nsdl_resource();
+    if (SN_NSDL_RESOURCE_VALUE_ALLOCATED(res)) {
+        free(res->resource);
+    }
+}
+
 void M2MResourceBase::report_to_parents()
 {
     M2MBase::Observation observation_level = M2MBase::observation_level();
@@ -320,7 +366,7 @@ void M2MResourceBase::report_to_parents()
     }
 }
 
-void M2MResourceBase::report()
+void M2MResourceBase::report(bool report_parents)
 {
     M2MBase::Observation observation_level = M2MBase::observation_level();
     tr_debug("M2MResourceBase::report() - level %d", observation_level);
@@ -336,8 +382,9 @@ void M2MResourceBase::report()
 
     tr_debug("M2MResourceBase::report() - combined level %d", parent_observation_level);
 
-    if ((M2MBase::O_Attribute & parent_observation_level) == M2MBase::O_Attribute ||
-            (M2MBase::OI_Attribute & parent_observation_level) == M2MBase::OI_Attribute) {
+    if (report_parents &&
+            ((M2MBase::O_Attribute & parent_observation_level) == M2MBase::O_Attribute ||
+             (M2MBase::OI_Attribute & parent_observation_level) == M2MBase::OI_Attribute)) {
         M2MReportHandler *report_handler = M2MBase::report_handler();
         if (report_handler) {
             report_handler->wait_to_report(this);
@@ -407,6 +454,27 @@ bool M2MResourceBase::has_value_changed(const uint8_t *value, const uint32_t val
 }
 
 void M2MResourceBase::report_value_change()
+{
+#if MBED_CLIENT_COMPOSITE_OPERATIONS || MBED_CLIENT_LWM2M_SEND_SAMPLES
+    M2MObservationHandler *obs_handler = observation_handler();
+    if (obs_handler) {
+        obs_handler->value_changed(this);
+    }
+#endif
+    M2MObjectInstance &object_instance = get_parent_resource().get_parent_object_instance();
+#if MBED_CLIENT_OBSERVATION_DIFF
+    object_instance.set_resource_changed(get_parent_resource());
+#endif
+    if (object_instance.update_in_progress()) {
+        // Evaluated once when the update is committed
+        get_nsdl_resource()->report_deferred = true;
+        object_instance.defer_report();
+        return;
+    }
+    report_change(true);
+}
+
+void M2MResourceBase::report_change(bool report_parents)
 {
     if (resource_instance_type() == M2MResourceBase::STRING ||
             resource_instance_type() == M2MResourceBase::OPAQUE) {
@@ -415,7 +483,7 @@ void M2MResourceBase::report_value_change()
             report_handler->set_notification_trigger();
         }
     }
-    report();
+    report(report_parents);
 }
 
 void M2MResourceBase::execute(void *arguments)
@@ -476,6 +544,22 @@ int M2MResourceBase::read_resource_value_size(const M2MResourceBase &resource, s
     }
 }
 
+coap_response_code_e M2MResourceBase::read_value_block(uint8_t *&buffer, size_t &buffer_size, size_t &total_size, size_t offset)
+{
+    M2MCallbackAssociation *item = M2MCallbackStorage::get_association_item(*this,
+                                                                            M2MCallbackAssociation::M2MResourceInstanceReadCallback);
+    if (!item) {
+        buffer_size = 0;
+        total_size = 0;
+        return COAP_RESPONSE_NOT_FOUND;
+    }
+
+    read_value_callback callback = (read_value_callback)item->_callback;
+    assert(callback);
+    total_size = 0;
+    return (*callback)(*this, buffer, buffer_size, total_size, offset, item->_client_args);
+}
+
 bool M2MResourceBase::write_resource_value(const M2MResourceBase &resource, const uint8_t *buffer, const size_t buffer_size)
 {
     tr_debug("M2MResourceBase::write_resource_value");
@@ -661,7 +745,7 @@ sn_coap_hdr_s *M2MResourceBase::handle_get_request(nsdl_s *nsdl,
             else if (coap_response->content_format == COAP_CONTENT_OMA_LINK_FORMAT_TYPE) {
                 // Discover
                 payload_len = 0;
-                uint8_t *data = M2MDiscover::create_resource_payload((const M2MResource *)this, payload_len);
+                uint8_t *data = M2MDiscover::create_payload_block(nsdl, *this, *received_coap_header, *coap_response, payload_len);
                 if (!data) {
                     payload_len = 0;
                     tr_error("M2MResource::handle_get_request() - Discover data allocation failed!");
@@ -958,7 +1042,7 @@ void M2MResourceBase::read_data_from_application(M2MCallbackAssociation *item,
             }
 
             // Set more bit into response
-            if (total_size >= (block_number + 1) * block_size) {
+            if (total_size > (block_number + 1) * block_size) {
                 coap_response->options_list_ptr->block2 |= 0x08;
             }
         }
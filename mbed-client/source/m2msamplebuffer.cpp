@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2021 Pelion. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "include/m2msamplebuffer.h"
+
+#if MBED_CLIENT_LWM2M_SEND_SAMPLES
+
+#include "mbed-client/m2mresourcebase.h"
+#include "mbed-trace/mbed_trace.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define TRACE_GROUP "mClt"
+
+// Stored form: version, sample size, sample count and the samples, oldest first
+#define SAMPLE_STORAGE_VERSION      1
+#define SAMPLE_STORAGE_HEADER_SIZE  4
+
+M2MSampleBuffer::M2MSampleBuffer()
+    : _first(0),
+      _count(0)
+{
+}
+
+bool M2MSampleBuffer::make_sample(const M2MResourceBase &resource, uint32_t time, bool absolute_time, m2m_sample_s &sample)
+{
+    memset(&sample, 0, sizeof(sample));
+
+    switch (resource.resource_instance_type()) {
+        case M2MResourceBase::INTEGER:
+        case M2MResourceBase::BOOLEAN:
+        case M2MResourceBase::TIME:
+            sample.value.int_value = resource.get_value_int();
+            break;
+        case M2MResourceBase::FLOAT:
+            sample.value.float_value = resource.get_value_float();
+            break;
+        default:
+            return false;
+    }
+
+    // "<object>/<object instance>/<resource>[/<resource instance>]"
+    uint16_t ids[4] = { 0, 0, 0, M2M_SAMPLE_NO_INSTANCE };
+    const char *path = resource.uri_path();
+    for (int index = 0; index < 4 && path && *path; index++) {
+        char *end = NULL;
+        unsigned long id = strtoul(path, &end, 10);
+        if (end == path || id > 0xFFFF) {
+            return false;
+        }
+        ids[index] = (uint16_t)id;
+        path = (*end == '/') ? end + 1 : end;
+    }
+
+    sample.object_id = ids[0];
+    sample.object_instance_id = ids[1];
+    sample.resource_id = ids[2];
+    sample.resource_instance_id = ids[3];
+    sample.type = (uint8_t)resource.resource_instance_type();
+    sample.time = time;
+    sample.absolute_time = absolute_time;
+    return true;
+}
+
+bool M2MSampleBuffer::push(const m2m_sample_s &sample)
+{
+    bool room = true;
+    if (_count == MBED_CLIENT_LWM2M_SEND_SAMPLES) {
+        tr_warn("M2MSampleBuffer::push - buffer full, oldest sample dropped");
+        pop(1);
+        room = false;
+    }
+    _samples[(_first + _count) % MBED_CLIENT_LWM2M_SEND_SAMPLES] = sample;
+    _count++;
+    return room;
+}
+
+void M2MSampleBuffer::pop(uint16_t count)
+{
+    if (count > _count) {
+        count = _count;
+    }
+    _first = (_first + count) % MBED_CLIENT_LWM2M_SEND_SAMPLES;
+    _count -= count;
+}
+
+uint16_t M2MSampleBuffer::count() const
+{
+    return _count;
+}
+
+const m2m_sample_s &M2MSampleBuffer::sample(uint16_t index) const
+{
+    return _samples[(_first + index) % MBED_CLIENT_LWM2M_SEND_SAMPLES];
+}
+
+size_t M2MSampleBuffer::storage_size() const
+{
+    return SAMPLE_STORAGE_HEADER_SIZE + _count * sizeof(m2m_sample_s);
+}
+
+size_t M2MSampleBuffer::max_storage_size()
+{
+    return SAMPLE_STORAGE_HEADER_SIZE + MBED_CLIENT_LWM2M_SEND_SAMPLES * sizeof(m2m_sample_s);
+}
+
+size_t M2MSampleBuffer::save(uint8_t *buffer) const
+{
+    buffer[0] = SAMPLE_STORAGE_VERSION;
+    buffer[1] = sizeof(m2m_sample_s);
+    memcpy(buffer + 2, &_count, sizeof(_count));
+
+    uint8_t *pos = buffer + SAMPLE_STORAGE_HEADER_SIZE;
+    for (uint16_t index = 0; index < _count; index++) {
+        memcpy(pos, &sample(index), sizeof(m2m_sample_s));
+        pos += sizeof(m2m_sample_s);
+    }
+    return pos - buffer;
+}
+
+bool M2MSampleBuffer::load(const uint8_t *buffer, size_t size)
+{
+    uint16_t count = 0;
+    if (size < SAMPLE_STORAGE_HEADER_SIZE ||
+            buffer[0] != SAMPLE_STORAGE_VERSION ||
+            buffer[1] != sizeof(m2m_sample_s)) {
+        tr_error("M2MSampleBuffer::load - unknown format");
+        return false;
+    }
+    memcpy(&count, buffer + 2, sizeof(count));
+    if (size != SAMPLE_STORAGE_HEADER_SIZE + count * sizeof(m2m_sample_s)) {
+        tr_error("M2MSampleBuffer::load - invalid size %lu", (unsigned long)size);
+        return false;
+    }
+
+    _first = 0;
+    _count = 0;
+    const uint8_t *pos = buffer + SAMPLE_STORAGE_HEADER_SIZE;
+    for (uint16_t index = 0; index < count; index++) {
+        m2m_sample_s stored;
+        memcpy(&stored, pos, sizeof(stored));
+        pos += sizeof(stored);
+        if (stored.absolute_time) {
+            push(stored);
+        }
+    }
+    tr_info("M2MSampleBuffer::load - %u of %u samples restored", _count, count);
+    return true;
+}
+
+#endif // MBED_CLIENT_LWM2M_SEND_SAMPLES
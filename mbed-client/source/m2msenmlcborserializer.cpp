@@ -0,0 +1,477 @@
+/*
+ * Copyright (c) 2021 Pelion. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "include/m2msenmlcborserializer.h"
+#include "mbed-client/m2mresourceinstance.h"
+#include "mbed-trace/mbed_trace.h"
+#include "tinycbor.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined (MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR) && (MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR == 1)
+
+#define TRACE_GROUP "mClt"
+
+// SenML labels, see RFC 8428 chapter 6
+#define SENML_BASE_NAME     -2
+#define SENML_NAME          0
+#define SENML_VALUE         2
+#define SENML_STRING_VALUE  3
+#define SENML_BOOLEAN_VALUE 4
+#define SENML_TIME          6
+#define SENML_DATA_VALUE    8
+
+// "<object>/<object instance>/<resource>/<resource instance>"
+#define SENML_MAX_NAME_LENGTH 24
+
+// Out of memory is expected while calculating the needed space
+#define SENML_CBOR_OK(err) ((err) == CborNoError || (err) == CborErrorOutOfMemory)
+
+uint8_t *M2MSenMLCborSerializer::serialize(const M2MObject &object, const M2MObjectInstanceList &object_instance_list, uint32_t &size)
+{
+    return serialize(&object, &object_instance_list, NULL, NULL, size);
+}
+
+uint8_t *M2MSenMLCborSerializer::serialize(const M2MObjectInstance &object_instance, uint32_t &size)
+{
+    return serialize(&object_instance, NULL, &object_instance.resources(), NULL, size);
+}
+
+#if MBED_CLIENT_COMPOSITE_OPERATIONS || MBED_CLIENT_OBSERVATION_DIFF
+uint8_t *M2MSenMLCborSerializer::serialize(const M2MBaseList &base_list, uint32_t &size)
+{
+    return serialize(NULL, NULL, NULL, &base_list, size);
+}
+#endif
+
+uint8_t *M2MSenMLCborSerializer::serialize(const M2MBase *base, const M2MObjectInstanceList *object_instance_list,
+                                           const M2MResourceList *resource_list, const M2MBaseList *base_list, uint32_t &size)
+{
+    CborEncoder encoder;
+    size = 0;
+
+    // First we do a dryrun to calculate the needed space
+    cbor_encoder_init(&encoder, NULL, 0, 0);
+    if (!encode_pack(encoder, base, object_instance_list, resource_list, base_list)) {
+        return NULL;
+    }
+
+    size_t len = cbor_encoder_get_extra_bytes_needed(&encoder);
+    uint8_t *data = (uint8_t *)malloc(len);
+    if (!data) {
+        tr_error("M2MSenMLCborSerializer::serialize - failed to allocate %lu bytes", (unsigned long)len);
+        return NULL;
+    }
+
+    // Then fill the data
+    cbor_encoder_init(&encoder, data, len, 0);
+    if (!encode_pack(encoder, base, object_instance_list, resource_list, base_list) ||
+            cbor_encoder_get_extra_bytes_needed(&encoder)) {
+        free(data);
+        return NULL;
+    }
+
+    size = cbor_encoder_get_buffer_size(&encoder, data);
+    return data;
+}
+
+bool M2MSenMLCborSerializer::encode_pack(CborEncoder &encoder, const M2MBase *base, const M2MObjectInstanceList *object_instance_list,
+                                         const M2MResourceList *resource_list, const M2MBaseList *base_list)
+{
+    // Base name "/<path>/", or "/" for a composite pack, is written only to the first record
+    const char *path = base ? base->uri_path() : "";
+    const size_t path_len = strlen(path);
+    char *base_name = (char *)malloc(path_len + 3);
+    if (!base_name) {
+        return false;
+    }
+    base_name[0] = '/';
+    memcpy(base_name + 1, path, path_len);
+    if (path_len) {
+        base_name[path_len + 1] = '/';
+        base_name[path_len + 2] = '\0';
+    } else {
+        base_name[1] = '\0';
+    }
+
+    const char *pending_base_name = base_name;
+    bool success = true;
+    char name[SENML_MAX_NAME_LENGTH];
+
+    // Record count is not known beforehand, the pack is generated in one pass
+    CborEncoder pack;
+    CborError err = cbor_encoder_create_array(&encoder, &pack, CborIndefiniteLength);
+
+    if (object_instance_list) {
+        M2MObjectInstanceList::const_iterator it = object_instance_list->begin();
+        for (; success && it != object_instance_list->end(); it++) {
+            int name_len = snprintf(name, sizeof(name), "%u/", (*it)->instance_id());
+            success = encode_resources(pack, pending_base_name, name, name_len, (*it)->resources());
+        }
+    } else if (resource_list) {
+        success = encode_resources(pack, pending_base_name, name, 0, *resource_list);
+    }
+#if MBED_CLIENT_COMPOSITE_OPERATIONS || MBED_CLIENT_OBSERVATION_DIFF
+    else if (base_list) {
+        M2MBaseList::const_iterator it = base_list->begin();
+        for (; success && it != base_list->end(); it++) {
+            success = encode_base(pack, pending_base_name, **it);
+        }
+    }
+#endif
+
+    if (SENML_CBOR_OK(err)) {
+        err = cbor_encoder_close_container(&encoder, &pack);
+    }
+
+    // Empty pack means there was nothing readable to send
+    if (pending_base_name) {
+        success = false;
+    }
+
+    free(base_name);
+    return success && SENML_CBOR_OK(err);
+}
+
+#if MBED_CLIENT_COMPOSITE_OPERATIONS || MBED_CLIENT_OBSERVATION_DIFF
+bool M2MSenMLCborSerializer::encode_base(CborEncoder &pack, const char *&base_name, const M2MBase &base)
+{
+    char name[SENML_MAX_NAME_LENGTH];
+    int name_len;
+
+    switch (base.base_type()) {
+        case M2MBase::Object: {
+            const M2MObjectInstanceList &instance_list = static_cast<const M2MObject &>(base).instances();
+            M2MObjectInstanceList::const_iterator it = instance_list.begin();
+            for (; it != instance_list.end(); it++) {
+                name_len = snprintf(name, sizeof(name), "%s/", (*it)->uri_path());
+                if (name_len < 0 || (size_t)name_len >= sizeof(name) ||
+                        !encode_resources(pack, base_name, name, name_len, (*it)->resources())) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case M2MBase::ObjectInstance:
+            name_len = snprintf(name, sizeof(name), "%s/", base.uri_path());
+            if (name_len < 0 || (size_t)name_len >= sizeof(name)) {
+                return false;
+            }
+            return encode_resources(pack, base_name, name, name_len,
+                                    static_cast<const M2MObjectInstance &>(base).resources());
+        case M2MBase::Resource: {
+            const M2MResource &resource = static_cast<const M2MResource &>(base);
+            name_len = snprintf(name, sizeof(name), "%s/", resource.get_parent_object_instance().uri_path());
+            if (name_len < 0 || (size_t)name_len >= sizeof(name)) {
+                return false;
+            }
+            return encode_resource(pack, base_name, name, name_len, resource);
+        }
+        case M2MBase::ResourceInstance:
+            if ((base.operation() & M2MBase::GET_ALLOWED) != M2MBase::GET_ALLOWED) {
+                return true;
+            }
+            return encode_record(pack, base_name, base.uri_path(), static_cast<const M2MResourceInstance &>(base));
+        default:
+            return false;
+    }
+}
+#endif // MBED_CLIENT_COMPOSITE_OPERATIONS || MBED_CLIENT_OBSERVATION_DIFF
+
+#if MBED_CLIENT_COMPOSITE_OPERATIONS
+bool M2MSenMLCborSerializer::parse_path_list(const uint8_t *data, uint32_t size, path_callback callback, void *context)
+{
+    CborParser parser;
+    CborValue pack;
+    CborValue record;
+    // Base name may have a leading '/' that is not part of the path
+    char base_name[SENML_MAX_NAME_LENGTH + 1] = "";
+    char path[SENML_MAX_NAME_LENGTH + 1];
+
+    if (cbor_parser_init(data, size, 0, &parser, &pack) != CborNoError ||
+            !cbor_value_is_array(&pack) ||
+            cbor_value_enter_container(&pack, &record) != CborNoError) {
+        return false;
+    }
+
+    while (!cbor_value_at_end(&record)) {
+        CborValue field;
+        char name[SENML_MAX_NAME_LENGTH + 1] = "";
+
+        if (!cbor_value_is_map(&record) || cbor_value_enter_container(&record, &field) != CborNoError) {
+            return false;
+        }
+
+        while (!cbor_value_at_end(&field)) {
+            int label;
+            if (!cbor_value_is_integer(&field) || cbor_value_get_int(&field, &label) != CborNoError ||
+                    cbor_value_advance_fixed(&field) != CborNoError) {
+                return false;
+            }
+
+            if (label == SENML_BASE_NAME || label == SENML_NAME) {
+                char *target = (label == SENML_BASE_NAME) ? base_name : name;
+                size_t len = SENML_MAX_NAME_LENGTH + 1;
+                if (!cbor_value_is_text_string(&field) ||
+                        cbor_value_copy_text_string(&field, target, &len, &field) != CborNoError) {
+                    tr_error("M2MSenMLCborSerializer::parse_path_list - invalid or too long name");
+                    return false;
+                }
+            } else if (cbor_value_advance(&field) != CborNoError) {
+                return false;
+            }
+        }
+
+        if (cbor_value_leave_container(&record, &field) != CborNoError) {
+            return false;
+        }
+
+        const char *full = base_name;
+        if (*full == '/') {
+            full++;
+        }
+        int path_len = snprintf(path, sizeof(path), "%s%s", full, name);
+        if (path_len <= 0 || (size_t)path_len >= sizeof(path)) {
+            return false;
+        }
+        // Trailing slash of a base name or a name is not part of the path
+        if (path[path_len - 1] == '/') {
+            path[path_len - 1] = '\0';
+        }
+
+        if (!callback(path, context)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+#endif // MBED_CLIENT_COMPOSITE_OPERATIONS
+
+#if MBED_CLIENT_LWM2M_SEND_SAMPLES
+uint8_t *M2MSenMLCborSerializer::serialize(const M2MSampleBuffer &buffer, uint16_t count, uint32_t now, uint32_t &size)
+{
+    CborEncoder encoder;
+    size = 0;
+
+    cbor_encoder_init(&encoder, NULL, 0, 0);
+    if (!count || !encode_samples(encoder, buffer, count, now)) {
+        return NULL;
+    }
+
+    size_t len = cbor_encoder_get_extra_bytes_needed(&encoder);
+    uint8_t *data = (uint8_t *)malloc(len);
+    if (!data) {
+        tr_error("M2MSenMLCborSerializer::serialize - failed to allocate %lu bytes", (unsigned long)len);
+        return NULL;
+    }
+
+    cbor_encoder_init(&encoder, data, len, 0);
+    if (!encode_samples(encoder, buffer, count, now) ||
+            cbor_encoder_get_extra_bytes_needed(&encoder)) {
+        free(data);
+        return NULL;
+    }
+
+    size = cbor_encoder_get_buffer_size(&encoder, data);
+    return data;
+}
+
+bool M2MSenMLCborSerializer::encode_samples(CborEncoder &encoder, const M2MSampleBuffer &buffer, uint16_t count, uint32_t now)
+{
+    char name[SENML_MAX_NAME_LENGTH];
+    CborEncoder pack;
+    CborError err = cbor_encoder_create_array(&encoder, &pack, count);
+
+    for (uint16_t index = 0; index < count && SENML_CBOR_OK(err); index++) {
+        const m2m_sample_s &sample = buffer.sample(index);
+        if (sample.resource_instance_id == M2M_SAMPLE_NO_INSTANCE) {
+            snprintf(name, sizeof(name), "%u/%u/%u", sample.object_id, sample.object_instance_id, sample.resource_id);
+        } else {
+            snprintf(name, sizeof(name), "%u/%u/%u/%u", sample.object_id, sample.object_instance_id,
+                     sample.resource_id, sample.resource_instance_id);
+        }
+
+        CborEncoder record;
+        err = cbor_encoder_create_map(&pack, &record, index ? 3 : 4);
+        if (!index && SENML_CBOR_OK(err)) {
+            err = cbor_encode_int(&record, SENML_BASE_NAME);
+            if (SENML_CBOR_OK(err)) {
+                err = cbor_encode_text_stringz(&record, "/");
+            }
+        }
+        if (SENML_CBOR_OK(err)) {
+            err = cbor_encode_int(&record, SENML_NAME);
+        }
+        if (SENML_CBOR_OK(err)) {
+            err = cbor_encode_text_stringz(&record, name);
+        }
+        if (SENML_CBOR_OK(err)) {
+            switch (sample.type) {
+                case M2MResourceBase::FLOAT:
+                    err = cbor_encode_int(&record, SENML_VALUE);
+                    if (SENML_CBOR_OK(err)) {
+                        err = cbor_encode_float(&record, sample.value.float_value);
+                    }
+                    break;
+                case M2MResourceBase::BOOLEAN:
+                    err = cbor_encode_int(&record, SENML_BOOLEAN_VALUE);
+                    if (SENML_CBOR_OK(err)) {
+                        err = cbor_encode_boolean(&record, sample.value.int_value != 0);
+                    }
+                    break;
+                default:
+                    err = cbor_encode_int(&record, SENML_VALUE);
+                    if (SENML_CBOR_OK(err)) {
+                        err = cbor_encode_int(&record, sample.value.int_value);
+                    }
+                    break;
+            }
+        }
+        if (SENML_CBOR_OK(err)) {
+            err = cbor_encode_int(&record, SENML_TIME);
+        }
+        if (SENML_CBOR_OK(err)) {
+            // Values below 2^28 are relative to the time of reception, see RFC 8428 chapter 4.5.3
+            err = cbor_encode_int(&record, sample.absolute_time ? (int64_t)sample.time : (int64_t)sample.time - (int64_t)now);
+        }
+        if (SENML_CBOR_OK(err)) {
+            err = cbor_encoder_close_container(&pack, &record);
+        }
+    }
+
+    if (SENML_CBOR_OK(err)) {
+        err = cbor_encoder_close_container(&encoder, &pack);
+    }
+    return SENML_CBOR_OK(err);
+}
+#endif // MBED_CLIENT_LWM2M_SEND_SAMPLES
+
+bool M2MSenMLCborSerializer::encode_resources(CborEncoder &pack, const char *&base_name, char *name, size_t name_len,
+                                              const M2MResourceList &resource_list)
+{
+    M2MResourceList::const_iterator it = resource_list.begin();
+    for (; it != resource_list.end(); it++) {
+        if (!encode_resource(pack, base_name, name, name_len, **it)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool M2MSenMLCborSerializer::encode_resource(CborEncoder &pack, const char *&base_name, char *name, size_t name_len,
+                                             const M2MResource &resource)
+{
+    if ((resource.operation() & M2MBase::GET_ALLOWED) != M2MBase::GET_ALLOWED) {
+        return true;
+    }
+
+    int res_len = snprintf(name + name_len, SENML_MAX_NAME_LENGTH - name_len, "%s", resource.name());
+    if (res_len < 0 || (size_t)(name_len + res_len) >= SENML_MAX_NAME_LENGTH) {
+        tr_error("M2MSenMLCborSerializer::encode_resource - name too long");
+        return false;
+    }
+
+    if (!resource.supports_multiple_instances()) {
+        return encode_record(pack, base_name, name, resource);
+    }
+
+    const M2MResourceInstanceList &instance_list = resource.resource_instances();
+    M2MResourceInstanceList::const_iterator inst = instance_list.begin();
+    for (; inst != instance_list.end(); inst++) {
+        if (((*inst)->operation() & M2MBase::GET_ALLOWED) != M2MBase::GET_ALLOWED) {
+            continue;
+        }
+        int inst_len = snprintf(name + name_len + res_len, SENML_MAX_NAME_LENGTH - name_len - res_len, "/%u", (*inst)->instance_id());
+        if (inst_len < 0 || (size_t)(name_len + res_len + inst_len) >= SENML_MAX_NAME_LENGTH) {
+            return false;
+        }
+        if (!encode_record(pack, base_name, name, **inst)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool M2MSenMLCborSerializer::encode_record(CborEncoder &pack, const char *&base_name, const char *name,
+                                           const M2MResourceBase &resource)
+{
+    CborEncoder record;
+    CborError err = cbor_encoder_create_map(&pack, &record, base_name ? 3 : 2);
+
+    if (base_name) {
+        if (SENML_CBOR_OK(err)) {
+            err = cbor_encode_int(&record, SENML_BASE_NAME);
+        }
+        if (SENML_CBOR_OK(err)) {
+            err = cbor_encode_text_stringz(&record, base_name);
+        }
+        base_name = NULL;
+    }
+
+    if (SENML_CBOR_OK(err)) {
+        err = cbor_encode_int(&record, SENML_NAME);
+    }
+    if (SENML_CBOR_OK(err)) {
+        err = cbor_encode_text_stringz(&record, name);
+    }
+
+    if (SENML_CBOR_OK(err)) {
+        switch (resource.resource_instance_type()) {
+            case M2MResourceBase::INTEGER:
+            case M2MResourceBase::TIME:
+                err = cbor_encode_int(&record, SENML_VALUE);
+                if (SENML_CBOR_OK(err)) {
+                    err = cbor_encode_int(&record, resource.get_value_int());
+                }
+                break;
+            case M2MResourceBase::FLOAT:
+                err = cbor_encode_int(&record, SENML_VALUE);
+                if (SENML_CBOR_OK(err)) {
+                    err = cbor_encode_float(&record, resource.get_value_float());
+                }
+                break;
+            case M2MResourceBase::BOOLEAN:
+                err = cbor_encode_int(&record, SENML_BOOLEAN_VALUE);
+                if (SENML_CBOR_OK(err)) {
+                    err = cbor_encode_boolean(&record, resource.get_value_int() != 0);
+                }
+                break;
+            case M2MResourceBase::OPAQUE:
+                err = cbor_encode_int(&record, SENML_DATA_VALUE);
+                if (SENML_CBOR_OK(err)) {
+                    err = cbor_encode_byte_string(&record, resource.value(), resource.value_length());
+                }
+                break;
+            default:
+                err = cbor_encode_int(&record, SENML_STRING_VALUE);
+                if (SENML_CBOR_OK(err)) {
+                    err = cbor_encode_text_string(&record, (const char *)resource.value(), resource.value_length());
+                }
+                break;
+        }
+    }
+
+    if (SENML_CBOR_OK(err)) {
+        err = cbor_encoder_close_container(&pack, &record);
+    }
+
+    return SENML_CBOR_OK(err);
+}
+
+#endif // MBED_CONF_MBED_CLIENT_ENABLE_SENML_CBOR
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2021 Pelion. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "include/m2msharedstring.h"
+
+#if MBED_CLIENT_SHARED_RESOURCE_STRINGS
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct shared_string_s {
+    shared_string_s     *next;
+    char                *str;           // Allocated on its own, so that it can also be freed as a plain string
+    uint32_t            refs;
+};
+
+// Distinct strings are few, the names and resource types of the objects in use
+static shared_string_s *shared_strings = NULL;
+
+char *M2MSharedString::acquire(const char *str, size_t length)
+{
+    for (shared_string_s *entry = shared_strings; entry; entry = entry->next) {
+        if (strncmp(entry->str, str, length) == 0 && entry->str[length] == '\0') {
+            entry->refs++;
+            return entry->str;
+        }
+    }
+
+    shared_string_s *entry = (shared_string_s *)malloc(sizeof(shared_string_s));
+    if (!entry) {
+        return NULL;
+    }
+    entry->str = (char *)malloc(length + 1);
+    if (!entry->str) {
+        free(entry);
+        return NULL;
+    }
+    memcpy(entry->str, str, length);
+    entry->str[length] = '\0';
+    entry->refs = 1;
+    entry->next = shared_strings;
+    shared_strings = entry;
+    return entry->str;
+}
+
+void M2MSharedString::release(char *str)
+{
+    if (!str) {
+        return;
+    }
+    for (shared_string_s **link = &shared_strings; *link; link = &(*link)->next) {
+        shared_string_s *entry = *link;
+        if (entry->str == str) {
+            if (--entry->refs == 0) {
+                *link = entry->next;
+                free(entry->str);
+                free(entry);
+            }
+            return;
+        }
+    }
+    free(str);
+}
+
+#endif // MBED_CLIENT_SHARED_RESOURCE_STRINGS
@@ -31,65 +31,95 @@ namespace m2m {
 
 const String::size_type String::npos = static_cast<size_t>(-1);
 
-char* String::strdup(const char* s)
+void String::init(const char* str, size_type n)
 {
-    const size_t len = strlen(s)+1;
-    char *p2 = static_cast<char*>(malloc(len));
-    if (p2) {
-        memcpy(p2, s, len);
-        allocated_ = len;
-        size_ = len-1;
+    if (n <= INLINE_CAPACITY) {
+        p = inline_;
+        allocated_ = sizeof(inline_);
+    } else {
+        p = static_cast<char*>(malloc(n + 1));
+        allocated_ = n + 1;
     }
-    return p2;
+    size_ = n;
+    memcpy(p, str, n);
+    p[n] = 0;
+}
+
+void String::reset()
+{
+    if (!is_inline()) {
+        free(p);
+    }
+    p = inline_;
+    allocated_ = sizeof(inline_);
+    size_ = 0;
+    p[0] = 0;
 }
 
 String::String()
-    : p( strdup("") )
+    : p(inline_), allocated_(sizeof(inline_)), size_(0)
 {
+    inline_[0] = 0;
 }
 
 String::~String()
 {
-    free(p);
+    if (!is_inline()) {
+        free(p);
+    }
     p = 0;
 }
 
 String::String(const String& s)
-    : p(0)
 {
-    p = static_cast<char*>(malloc(s.size_ + 1));
-
-    allocated_ = s.size_ + 1;
-    size_      = s.size_;
-    memcpy(p, s.p, size_ + 1);
+    init(s.p, s.size_);
 }
 
 String::String(const char* s)
-    : p(strdup(s))
 {
+    init(s, strlen(s));
 }
 
 String::String(const char* str, size_t n)
 {
-    p = static_cast<char*>(malloc(n + 1));
+    init(str, n);
+}
 
-    allocated_ = n + 1;
-    size_      = n;
-    memcpy(p, str, n);
-    p[n] = 0;
+#if __cplusplus >= 201103L
+String::String(String&& s)
+{
+    if (s.is_inline()) {
+        init(s.p, s.size_);
+    } else {
+        // take over the heap memory, source is left empty
+        p = s.p;
+        allocated_ = s.allocated_;
+        size_ = s.size_;
+        s.p = s.inline_;
+        s.allocated_ = sizeof(s.inline_);
+        s.size_ = 0;
+        s.p[0] = 0;
+    }
 }
+#endif
 
 String& String::operator=(const char* s)
 {
     if ( p != s ) {
-        // s could point into our own string, so we have to allocate a new string
+        // s could point into our own string, so memmove is used when it fits
         const size_t len = strlen(s);
-        char* copy = (char*) malloc( len + 1);
-        memmove(copy, s, len+1); // trailing 0
-        free( p );
-        p = copy;
+        if (len < allocated_) {
+            memmove(p, s, len+1); // trailing 0
+        } else {
+            char* copy = (char*) malloc( len + 1);
+            memmove(copy, s, len+1); // trailing 0
+            if (!is_inline()) {
+                free( p );
+            }
+            p = copy;
+            allocated_ = len+1;
+        }
         size_ = len;
-        allocated_ = len+1;
     }
     return *this;
 }
@@ -99,6 +129,21 @@ String& String::operator=(const String& s)
     return operator=(s.p);
 }
 
+#if __cplusplus >= 201103L
+String& String::operator=(String&& s)
+{
+    if (this != &s) {
+        if (s.is_inline()) {
+            operator=(s.p);
+        } else {
+            reset();
+            this->swap(s);
+        }
+    }
+    return *this;
+}
+#endif
+
 String& String::operator+=(const String& s)
 {
     if (s.size_ > 0) {
@@ -309,7 +354,15 @@ int String::find_last_of(char c) const {
 
 void String::new_realloc( size_type n) {
     if (n > 0 ) {
-        char* pnew = static_cast<char*>(realloc(p, n)); // could return NULL
+        char* pnew;
+        if (is_inline()) {
+            // inline storage can only grow to heap
+            pnew = static_cast<char*>(malloc(n)); // could return NULL
+            if (pnew)
+                memcpy(pnew, p, size_ + 1);
+        } else {
+            pnew = static_cast<char*>(realloc(p, n)); // could return NULL
+        }
         if (pnew)
             p = pnew;
     }
@@ -346,6 +399,16 @@ void String::swap(String& s) {
     size_t temp;
     char* tempPtr;
 
+    // inline content moves with the object, pointers are fixed after the swap
+    const bool this_inline = is_inline();
+    const bool s_inline = s.is_inline();
+    if (this_inline || s_inline) {
+        char tempBuf[sizeof(inline_)];
+        memcpy(tempBuf, inline_, sizeof(inline_));
+        memcpy(inline_, s.inline_, sizeof(inline_));
+        memcpy(s.inline_, tempBuf, sizeof(inline_));
+    }
+
     temp = allocated_;
     allocated_ = s.allocated_;
     s.allocated_ = temp;
@@ -355,8 +418,8 @@ void String::swap(String& s) {
     s.size_ = temp;
 
     tempPtr = p;
-    p = s.p;
-    s.p = tempPtr;
+    p = s_inline ? inline_ : s.p;
+    s.p = this_inline ? s.inline_ : tempPtr;
 }
 
 
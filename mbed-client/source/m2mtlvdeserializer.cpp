@@ -153,24 +153,24 @@ M2MTLVDeserializer::Error M2MTLVDeserializer::deserialize_object_instances(const
 {
     tr_debug("M2MTLVDeserializer::deserialize_object_instances()");
     M2MTLVDeserializer::Error error = M2MTLVDeserializer::None;
-    TypeIdLength til(tlv, offset);
-    til.deserialize();
-    offset = til._offset;
-
     const M2MObjectInstanceList &list = object.instances();
-    M2MObjectInstanceList::const_iterator it;
-    it = list.begin();
+    Entry entry;
 
-    if (TYPE_OBJECT_INSTANCE == til._type) {
-        for (; it != list.end(); it++) {
-            if ((*it)->instance_id() == til._id) {
-                error = deserialize_resources(tlv, tlv_size, offset, (**it), operation, update_value);
-            }
+    while (M2MTLVDeserializer::None == error && offset < tlv_size) {
+        if (!next_entry(tlv, tlv_size, offset, entry)) {
+            return M2MTLVDeserializer::NotValid;
+        }
+        if (TYPE_OBJECT_INSTANCE != entry.type) {
+            break;
         }
-        offset += til._length;
 
-        if (offset < tlv_size) {
-            error = deserialize_object_instances(tlv, tlv_size, offset, object, operation, update_value);
+        M2MObjectInstanceList::const_iterator it;
+        it = list.begin();
+        for (; it != list.end(); it++) {
+            if ((*it)->instance_id() == entry.id) {
+                // the value of the instance entry holds its resources
+                error = deserialize_resources(entry.value, entry.length, 0, (**it), operation, update_value);
+            }
         }
     }
     return error;
@@ -185,26 +185,39 @@ M2MTLVDeserializer::Error M2MTLVDeserializer::deserialize_resources(const uint8_
 {
     tr_debug("M2MTLVDeserializer::deserialize_resources()");
     M2MTLVDeserializer::Error error = M2MTLVDeserializer::None;
-    TypeIdLength til(tlv, offset);
-    til.deserialize();
-    offset = til._offset;
+    Entry entry;
+
+    while (M2MTLVDeserializer::None == error && offset < tlv_size) {
+        if (!next_entry(tlv, tlv_size, offset, entry)) {
+            return M2MTLVDeserializer::NotValid;
+        }
+        error = deserialize_resource_entry(entry, object_instance, operation, update_value);
+    }
+    return error;
+}
 
+M2MTLVDeserializer::Error M2MTLVDeserializer::deserialize_resource_entry(const M2MTLVDeserializer::Entry &entry,
+                                                                         M2MObjectInstance &object_instance,
+                                                                         M2MTLVDeserializer::Operation operation,
+                                                                         bool update_value)
+{
+    M2MTLVDeserializer::Error error = M2MTLVDeserializer::None;
     const M2MResourceList &list = object_instance.resources();
     M2MResourceList::const_iterator it;
     it = list.begin();
 
     bool found = false;
     bool multi = false;
-    if (TYPE_RESOURCE == til._type || TYPE_RESOURCE_INSTANCE == til._type) {
+    if (TYPE_RESOURCE == entry.type || TYPE_RESOURCE_INSTANCE == entry.type) {
         multi = false;
         for (; it != list.end(); it++) {
-            if ((*it)->name_id() == til._id) {
-                tr_debug("M2MTLVDeserializer::deserialize_resources() - Resource ID %d ", til._id);
+            if ((*it)->name_id() == entry.id) {
+                tr_debug("M2MTLVDeserializer::deserialize_resources() - Resource ID %d ", entry.id);
                 found = true;
                 if (update_value) {
-                    if (til._length > 0) {
+                    if (entry.length > 0) {
                         tr_debug("M2MTLVDeserializer::deserialize_resources() - Update value");
-                        if (!set_resource_instance_value((*it), tlv + offset, til._length)) {
+                        if (!set_resource_instance_value((*it), entry.value, entry.length)) {
                             error = M2MTLVDeserializer::OutOfMemory;
                             break;
                         }
@@ -220,13 +233,13 @@ M2MTLVDeserializer::Error M2MTLVDeserializer::deserialize_resources(const uint8_
                 }
             }
         }
-    } else if (TYPE_MULTIPLE_RESOURCE == til._type) {
+    } else if (TYPE_MULTIPLE_RESOURCE == entry.type) {
         multi = true;
         for (; it != list.end(); it++) {
             if ((*it)->supports_multiple_instances() &&
-                    (*it)->name_id() == til._id) {
+                    (*it)->name_id() == entry.id) {
                 found = true;
-                error = deserialize_resource_instances(tlv, tlv_size, offset, (**it), object_instance, operation, update_value);
+                error = deserialize_resource_instances(entry.value, entry.length, 0, (**it), object_instance, operation, update_value);
             }
         }
     } else {
@@ -238,12 +251,12 @@ M2MTLVDeserializer::Error M2MTLVDeserializer::deserialize_resources(const uint8_
         if (M2MTLVDeserializer::Post == operation) {
             //Create a new Resource
             String id;
-            id.append_int(til._id);
+            id.append_int(entry.id);
             M2MResource *resource = object_instance.create_dynamic_resource(id, "", M2MResourceInstance::OPAQUE, true, multi);
             if (resource) {
                 resource->set_operation(M2MBase::GET_PUT_POST_DELETE_ALLOWED);
-                if (TYPE_MULTIPLE_RESOURCE == til._type) {
-                    error = deserialize_resource_instances(tlv, tlv_size, offset, (*resource), object_instance, operation, update_value);
+                if (TYPE_MULTIPLE_RESOURCE == entry.type) {
+                    error = deserialize_resource_instances(entry.value, entry.length, 0, (*resource), object_instance, operation, update_value);
                 }
             }
         } else if (M2MTLVDeserializer::Put == operation) {
@@ -251,12 +264,6 @@ M2MTLVDeserializer::Error M2MTLVDeserializer::deserialize_resources(const uint8_
         }
     }
 
-    offset += til._length;
-
-    if (offset < tlv_size) {
-        error = deserialize_resources(tlv, tlv_size, offset, object_instance, operation, update_value);
-    }
-
     return error;
 }
 
@@ -268,13 +275,14 @@ M2MTLVDeserializer::Error M2MTLVDeserializer::deserialize_resource(const uint8_t
 {
     M2MTLVDeserializer::Error error = M2MTLVDeserializer::None;
     if (resource.operation() & M2MBase::PUT_ALLOWED) {
-        int offset = 0;
-        TypeIdLength til(tlv, offset);
-        til.deserialize();
-        offset = til._offset;
+        uint32_t offset = 0;
+        Entry entry;
+        if (!next_entry(tlv, tlv_size, offset, entry)) {
+            return M2MTLVDeserializer::NotValid;
+        }
 
         if (resource.resource_instance_type() == M2MResourceBase::INTEGER) {
-            int64_t value = String::convert_array_to_integer(tlv + offset, til._length);
+            int64_t value = String::convert_array_to_integer(entry.value, entry.length);
             if ((strcmp(resource.uri_path(), SERVER_LIFETIME_PATH) == 0) && (value < MINIMUM_REGISTRATION_TIME)) {
                 // Check that lifetime can't go below 60s
                 return M2MTLVDeserializer::NotAccepted;
@@ -286,7 +294,7 @@ M2MTLVDeserializer::Error M2MTLVDeserializer::deserialize_resource(const uint8_t
         }
 
         tr_debug("M2MTLVDeserializer::deserialize_resource() - Update value");
-        if (!set_resource_instance_value(&resource, tlv + offset, til._length)) {
+        if (!set_resource_instance_value(&resource, entry.value, entry.length)) {
             error = M2MTLVDeserializer::OutOfMemory;
         }
     } else {
@@ -305,58 +313,56 @@ M2MTLVDeserializer::Error M2MTLVDeserializer::deserialize_resource_instances(con
                                                                              bool update_value)
 {
     M2MTLVDeserializer::Error error = M2MTLVDeserializer::None;
-    TypeIdLength til(tlv, offset);
-    til.deserialize();
-    offset = til._offset;
+    Entry entry;
 
-    if (TYPE_MULTIPLE_RESOURCE == til._type || TYPE_RESOURCE_INSTANCE == til._type) {
-        const M2MResourceInstanceList &list = resource.resource_instances();
-        M2MResourceInstanceList::const_iterator it;
-        it = list.begin();
-        bool found = false;
-        for (; it != list.end(); it++) {
-            if ((*it)->instance_id() == til._id && TYPE_RESOURCE_INSTANCE == til._type) {
-                found = true;
-                if (update_value) {
-                    if (til._length > 0) {
-                        if (!set_resource_instance_value((*it), tlv + offset, til._length)) {
-                            error = M2MTLVDeserializer::OutOfMemory;
-                            break;
+    while (M2MTLVDeserializer::None == error && offset < tlv_size) {
+        if (!next_entry(tlv, tlv_size, offset, entry)) {
+            return M2MTLVDeserializer::NotValid;
+        }
+
+        if (TYPE_MULTIPLE_RESOURCE == entry.type || TYPE_RESOURCE_INSTANCE == entry.type) {
+            const M2MResourceInstanceList &list = resource.resource_instances();
+            M2MResourceInstanceList::const_iterator it;
+            it = list.begin();
+            bool found = false;
+            for (; it != list.end(); it++) {
+                if ((*it)->instance_id() == entry.id && TYPE_RESOURCE_INSTANCE == entry.type) {
+                    found = true;
+                    if (update_value) {
+                        if (entry.length > 0) {
+                            if (!set_resource_instance_value((*it), entry.value, entry.length)) {
+                                error = M2MTLVDeserializer::OutOfMemory;
+                                break;
+                            }
+                        } else {
+                            (*it)->clear_value();
                         }
-                    } else {
-                        (*it)->clear_value();
+                        break;
+                    } else if (0 == ((*it)->operation() & M2MBase::PUT_ALLOWED)) {
+                        error = M2MTLVDeserializer::NotAllowed;
+                        break;
                     }
-                    break;
-                } else if (0 == ((*it)->operation() & M2MBase::PUT_ALLOWED)) {
-                    error = M2MTLVDeserializer::NotAllowed;
-                    break;
                 }
             }
-        }
 
-        if (!found) {
-            if (M2MTLVDeserializer::Post == operation) {
-                // Create a new Resource Instance
-                M2MResourceInstance *res_instance = object_instance.create_dynamic_resource_instance(resource.name(), "",
-                                                                                                     resource.resource_instance_type(),
-                                                                                                     true,
-                                                                                                     til._id);
-                if (res_instance) {
-                    res_instance->set_operation(M2MBase::GET_PUT_POST_DELETE_ALLOWED);
+            if (!found) {
+                if (M2MTLVDeserializer::Post == operation) {
+                    // Create a new Resource Instance
+                    M2MResourceInstance *res_instance = object_instance.create_dynamic_resource_instance(resource.name(), "",
+                                                                                                         resource.resource_instance_type(),
+                                                                                                         true,
+                                                                                                         entry.id);
+                    if (res_instance) {
+                        res_instance->set_operation(M2MBase::GET_PUT_POST_DELETE_ALLOWED);
+                    }
+                } else if (M2MTLVDeserializer::Put == operation) {
+                    error = M2MTLVDeserializer::NotFound;
                 }
-            } else if (M2MTLVDeserializer::Put == operation) {
-                error = M2MTLVDeserializer::NotFound;
             }
+        } else {
+            error = M2MTLVDeserializer::NotValid;
+            return error;
         }
-    } else {
-        error = M2MTLVDeserializer::NotValid;
-        return error;
-    }
-
-    offset += til._length;
-
-    if (offset < tlv_size) {
-        error = deserialize_resource_instances(tlv, tlv_size, offset, resource, object_instance, operation, update_value);
     }
     return error;
 }
@@ -372,60 +378,58 @@ M2MTLVDeserializer::Error M2MTLVDeserializer::deserialize_resource_instances(con
         return M2MTLVDeserializer::NotValid;
     }
     M2MTLVDeserializer::Error error = M2MTLVDeserializer::None;
-    TypeIdLength til(tlv, offset);
-    til.deserialize();
-    offset = til._offset;
+    Entry entry;
 
-    if (TYPE_RESOURCE_INSTANCE == til._type) {
-        const M2MResourceInstanceList &list = resource.resource_instances();
-        M2MResourceInstanceList::const_iterator it;
-        it = list.begin();
-        bool found = false;
-        for (; it != list.end(); it++) {
-            if ((*it)->instance_id() == til._id) {
-                found = true;
-                if (update_value) {
-                    if (til._length > 0) {
-                        if (!set_resource_instance_value((*it), tlv + offset, til._length)) {
-                            error = M2MTLVDeserializer::OutOfMemory;
-                            break;
+    while (M2MTLVDeserializer::None == error && offset < tlv_size) {
+        if (!next_entry(tlv, tlv_size, offset, entry)) {
+            return M2MTLVDeserializer::NotValid;
+        }
+
+        if (TYPE_RESOURCE_INSTANCE == entry.type) {
+            const M2MResourceInstanceList &list = resource.resource_instances();
+            M2MResourceInstanceList::const_iterator it;
+            it = list.begin();
+            bool found = false;
+            for (; it != list.end(); it++) {
+                if ((*it)->instance_id() == entry.id) {
+                    found = true;
+                    if (update_value) {
+                        if (entry.length > 0) {
+                            if (!set_resource_instance_value((*it), entry.value, entry.length)) {
+                                error = M2MTLVDeserializer::OutOfMemory;
+                                break;
+                            }
+                        } else {
+                            (*it)->clear_value();
                         }
-                    } else {
-                        (*it)->clear_value();
+                        break;
+                    } else if (0 == ((*it)->operation() & M2MBase::PUT_ALLOWED)) {
+                        error = M2MTLVDeserializer::NotAllowed;
+                        break;
                     }
-                    break;
-                } else if (0 == ((*it)->operation() & M2MBase::PUT_ALLOWED)) {
-                    error = M2MTLVDeserializer::NotAllowed;
-                    break;
                 }
             }
-        }
-        if (!found) {
-            if (M2MTLVDeserializer::Post == operation) {
-                error = M2MTLVDeserializer::NotAllowed;
-            } else if (M2MTLVDeserializer::Put == operation) {
-                // Create a new Resource Instance
-                M2MResourceInstance *res_instance = resource.get_parent_object_instance().create_dynamic_resource_instance(
-                                                        resource.name(),
-                                                        "",
-                                                        resource.resource_instance_type(),
-                                                        true,
-                                                        til._id);
-                if (res_instance) {
-                    res_instance->set_operation(M2MBase::GET_PUT_DELETE_ALLOWED);
+            if (!found) {
+                if (M2MTLVDeserializer::Post == operation) {
+                    error = M2MTLVDeserializer::NotAllowed;
+                } else if (M2MTLVDeserializer::Put == operation) {
+                    // Create a new Resource Instance
+                    M2MResourceInstance *res_instance = resource.get_parent_object_instance().create_dynamic_resource_instance(
+                                                            resource.name(),
+                                                            "",
+                                                            resource.resource_instance_type(),
+                                                            true,
+                                                            entry.id);
+                    if (res_instance) {
+                        res_instance->set_operation(M2MBase::GET_PUT_DELETE_ALLOWED);
+                    }
                 }
-            }
 
+            }
+        } else {
+            error = M2MTLVDeserializer::NotValid;
+            return error;
         }
-    } else {
-        error = M2MTLVDeserializer::NotValid;
-        return error;
-    }
-
-    offset += til._length;
-
-    if (offset < tlv_size) {
-        error = deserialize_resource_instances(tlv, tlv_size, offset, resource, operation, update_value);
     }
     return error;
 }
@@ -490,6 +494,7 @@ bool M2MTLVDeserializer::set_resource_instance_value(M2MResourceBase *res, const
         case M2MResourceBase::STRING:
         case M2MResourceBase::OPAQUE:
         case M2MResourceBase::OBJLINK:
+            // tlv points into the received payload, a resource with a write callback gets it without a copy
             success = res->set_value(tlv, size);
             break;
         case M2MResourceBase::FLOAT: {
@@ -512,18 +517,15 @@ void M2MTLVDeserializer::remove_resources(const uint8_t *tlv,
 {
     tr_debug("M2MTLVDeserializer::remove_resources");
     uint32_t offset = offset_size;
+    Entry entry;
     const M2MResourceList &list = object_instance.resources();
     M2MResourceList::const_iterator it;
 
     it = list.begin();
     for (; it != list.end();) {
         bool found = false;
-        while (offset < tlv_size) {
-            TypeIdLength til(tlv, offset);
-            til.deserialize();
-            offset = til._offset;
-            offset += til._length;
-            if ((*it)->name_id() == til._id) {
+        while (next_entry(tlv, tlv_size, offset, entry)) {
+            if ((*it)->name_id() == entry.id) {
                 offset = offset_size;
                 found = true;
                 break;
@@ -548,18 +550,15 @@ void M2MTLVDeserializer::remove_resource_instances(const uint8_t *tlv,
 {
     tr_debug("M2MTLVDeserializer::remove_resource_instances");
     uint32_t offset = offset_size;
+    Entry entry;
     const M2MResourceInstanceList &list = resource.resource_instances();
     M2MResourceInstanceList::const_iterator it;
     it = list.begin();
 
     for (; it != list.end();) {
         bool found = false;
-        while (offset < tlv_size) {
-            TypeIdLength til(tlv, offset);
-            til.deserialize();
-            offset = til._offset;
-            offset += til._length;
-            if ((*it)->instance_id() == til._id) {
+        while (next_entry(tlv, tlv_size, offset, entry)) {
+            if ((*it)->instance_id() == entry.id) {
                 offset = offset_size;
                 found = true;
                 break;
@@ -577,6 +576,45 @@ void M2MTLVDeserializer::remove_resource_instances(const uint8_t *tlv,
     }
 }
 
+bool M2MTLVDeserializer::next_entry(const uint8_t *tlv, uint32_t tlv_size, uint32_t &offset, M2MTLVDeserializer::Entry &entry)
+{
+    if (offset >= tlv_size) {
+        return false;
+    }
+
+    const uint8_t header = tlv[offset];
+    const uint32_t id_size = (header & ID16) ? 2 : 1;
+    const uint32_t length_size = (header & LENGTH24) >> 3;
+    uint32_t position = offset + 1;
+
+    if (tlv_size - position < id_size + length_size) {
+        return false;
+    }
+
+    entry.type = header & 0xC0;
+    entry.id = tlv[position++];
+    if (id_size == 2) {
+        entry.id = (entry.id << 8) + tlv[position++];
+    }
+
+    if (length_size == 0) {
+        entry.length = header & 0x07;
+    } else {
+        entry.length = 0;
+        for (uint32_t i = 0; i < length_size; i++) {
+            entry.length = (entry.length << 8) + tlv[position++];
+        }
+    }
+
+    if (entry.length > tlv_size - position) {
+        return false;
+    }
+
+    entry.value = tlv + position;
+    offset = position + entry.length;
+    return true;
+}
+
 TypeIdLength::TypeIdLength(const uint8_t *tlv, uint32_t offset)
     : _tlv(tlv), _offset(offset), _type(tlv[offset] & 0xC0), _id(0), _length(0)
 {
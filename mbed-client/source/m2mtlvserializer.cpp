@@ -17,6 +17,7 @@
 #include "mbed-client/m2mconstants.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include "common_functions.h"
 
 #define TRACE_GROUP "mClt"
@@ -25,170 +26,267 @@
 #define MAX_TLV_ID_SIZE 2
 #define TLV_TYPE_SIZE 1
 
+class M2MTLVSerializer::Writer {
+public:
+    explicit Writer(uint8_t *buffer = NULL)
+        : _buffer(buffer), _callback(NULL), _context(NULL), _size(0)
+    {
+    }
+
+    Writer(write_callback callback, void *context)
+        : _buffer(NULL), _callback(callback), _context(context), _size(0)
+    {
+    }
+
+    bool write(const uint8_t *data, uint32_t length)
+    {
+        if (!length) {
+            return true;
+        }
+        if (_callback) {
+            if (!_callback(data, length, _context)) {
+                return false;
+            }
+        } else if (_buffer) {
+            memcpy(_buffer + _size, data, length);
+        }
+        _size += length;
+        return true;
+    }
+
+    /** True if nothing is written, only the size is counted. */
+    bool counting() const
+    {
+        return !_buffer && !_callback;
+    }
+
+    /** Counts length bytes, only valid when counting(). */
+    void skip(uint32_t length)
+    {
+        _size += length;
+    }
+
+    uint32_t size() const
+    {
+        return _size;
+    }
+
+private:
+    uint8_t         *_buffer;
+    write_callback  _callback;
+    void            *_context;
+    uint32_t        _size;
+};
+
 uint8_t *M2MTLVSerializer::serialize(const M2MObjectInstanceList &object_instance_list, uint32_t &size)
 {
-    return serialize_object_instances(object_instance_list, size);
+    // First pass only counts the size, so the data is written with a single allocation
+    Writer counter;
+    uint8_t *data = NULL;
+
+    if (serialize_object_instances(object_instance_list, counter) && counter.size()) {
+        data = (uint8_t *)malloc(counter.size());
+        if (data) {
+            Writer writer(data);
+            serialize_object_instances(object_instance_list, writer);
+            size = writer.size();
+        }
+    }
+    return data;
 }
 
 uint8_t *M2MTLVSerializer::serialize(const M2MResourceList &resource_list, uint32_t &size)
 {
-    bool valid = true;
-    return serialize_resources(resource_list, size, valid);
+    Writer counter;
+    uint8_t *data = NULL;
+
+    if (serialize_resources(resource_list, counter) && counter.size()) {
+        data = (uint8_t *)malloc(counter.size());
+        if (data) {
+            Writer writer(data);
+            serialize_resources(resource_list, writer);
+            size = writer.size();
+        }
+    }
+    return data;
 }
 
 uint8_t *M2MTLVSerializer::serialize(const M2MResource *resource, uint32_t &size)
 {
+    Writer counter;
     uint8_t *data = NULL;
-    serialize(resource, data, size);
+
+    if (serialize(resource, counter) && counter.size()) {
+        data = (uint8_t *)malloc(counter.size());
+        if (data) {
+            Writer writer(data);
+            serialize(resource, writer);
+            size = writer.size();
+        }
+    }
     return data;
 }
 
-uint8_t *M2MTLVSerializer::serialize_object_instances(const M2MObjectInstanceList &object_instance_list, uint32_t &size)
+bool M2MTLVSerializer::serialize(const M2MObjectInstanceList &object_instance_list, write_callback callback, void *context)
 {
-    uint8_t *data = NULL;
+    Writer writer(callback, context);
+    return serialize_object_instances(object_instance_list, writer);
+}
+
+bool M2MTLVSerializer::serialize(const M2MResourceList &resource_list, write_callback callback, void *context)
+{
+    Writer writer(callback, context);
+    return serialize_resources(resource_list, writer);
+}
 
-    if (!object_instance_list.empty()) {
-        M2MObjectInstanceList::const_iterator it;
-        it = object_instance_list.begin();
-        for (; it != object_instance_list.end(); it++) {
+bool M2MTLVSerializer::serialize(const M2MResource *resource, write_callback callback, void *context)
+{
+    Writer writer(callback, context);
+    return serialize(resource, writer);
+}
+
+bool M2MTLVSerializer::serialize_object_instances(const M2MObjectInstanceList &object_instance_list, Writer &writer)
+{
+    M2MObjectInstanceList::const_iterator it;
+    it = object_instance_list.begin();
+    for (; it != object_instance_list.end(); it++) {
+        // object instances with resources that can not be serialized are left out
+        if (resources_valid((*it)->resources())) {
             uint16_t id = (*it)->instance_id();
-            serialize(id, *it, data, size);
+            if (!serialize(id, *it, writer)) {
+                return false;
+            }
         }
     }
-    return data;
+    return true;
 }
 
-uint8_t *M2MTLVSerializer::serialize_resources(const M2MResourceList &resource_list, uint32_t &size, bool &valid)
+bool M2MTLVSerializer::resources_valid(const M2MResourceList &resource_list)
 {
-    uint8_t *data = NULL;
-
-    if (!resource_list.empty()) {
-        M2MResourceList::const_iterator it;
-        it = resource_list.begin();
-        for (; it != resource_list.end(); it++) {
-            if ((*it)->name_id() == -1) {
-                valid = false;
-                break;
-            }
+    M2MResourceList::const_iterator it;
+    it = resource_list.begin();
+    for (; it != resource_list.end(); it++) {
+        if ((*it)->name_id() == -1) {
+            return false;
         }
-        if (valid) {
-            it = resource_list.begin();
-            for (; it != resource_list.end(); it++) {
-                if (((*it)->operation() & M2MBase::GET_ALLOWED) == M2MBase::GET_ALLOWED) {
-                    if (!serialize(*it, data, size)) {
-                        /* serializing has failed */
-                        /* free data so far */
-                        free(data);
-                        /* invalidate */
-                        valid = false;
-                        /* return NULL immediately */
-                        return NULL;
-                    }
-                }
+    }
+    return true;
+}
+
+bool M2MTLVSerializer::serialize_resources(const M2MResourceList &resource_list, Writer &writer)
+{
+    if (!resources_valid(resource_list)) {
+        return false;
+    }
+
+    M2MResourceList::const_iterator it;
+    it = resource_list.begin();
+    for (; it != resource_list.end(); it++) {
+        if (((*it)->operation() & M2MBase::GET_ALLOWED) == M2MBase::GET_ALLOWED) {
+            if (!serialize(*it, writer)) {
+                /* serializing has failed */
+                return false;
             }
         }
     }
-    return data;
+    return true;
 }
 
-bool M2MTLVSerializer::serialize(uint16_t id, const M2MObjectInstance *object_instance, uint8_t *&data, uint32_t &size)
+bool M2MTLVSerializer::serialize(uint16_t id, const M2MObjectInstance *object_instance, Writer &writer)
 {
-    uint8_t *resource_data = NULL;
-    uint32_t resource_size = 0;
-    bool success;
+    // the length of the nested resources is needed for the object instance header
+    Writer counter;
+    if (!serialize_resources(object_instance->resources(), counter) ||
+            !serialize_TIL(TYPE_OBJECT_INSTANCE, id, counter.size(), writer)) {
+        return false;
+    }
 
-    bool valid = true;
-    resource_data = serialize_resources(object_instance->resources(), resource_size, valid);
-    if (valid) {
-        if (serialize_TILV(TYPE_OBJECT_INSTANCE, id, resource_data, resource_size, data, size)) {
-            success = true;
-        } else {
-            /* serializing object instance failed */
-            success = false;
-        }
-        free(resource_data);
-    } else {
-        /* serializing resources failed */
-        success = false;
+    if (writer.counting()) {
+        writer.skip(counter.size());
+        return true;
     }
-    return success;
+    return serialize_resources(object_instance->resources(), writer);
 }
 
-bool M2MTLVSerializer::serialize(const M2MResource *resource, uint8_t *&data, uint32_t &size)
+bool M2MTLVSerializer::serialize(const M2MResource *resource, Writer &writer)
 {
     bool success = false;
     if (resource->name_id() != -1) {
         success = resource->supports_multiple_instances() ?
-                  serialize_multiple_resource(resource, data, size) :
-                  serialize_resource(resource, data, size);
+                  serialize_multiple_resource(resource, writer) :
+                  serialize_resource(resource, writer);
     }
     return success;
 }
 
-bool M2MTLVSerializer::serialize_resource(const M2MResource *resource, uint8_t *&data, uint32_t &size)
+bool M2MTLVSerializer::serialize_resource(const M2MResource *resource, Writer &writer)
 {
     bool success = false;
     if (resource->name_id() != -1) {
         if ((resource->resource_instance_type() == M2MResourceBase::INTEGER) ||
                 (resource->resource_instance_type() == M2MResourceBase::BOOLEAN) ||
                 (resource->resource_instance_type() == M2MResourceBase::TIME)) {
-            success = serialize_TLV_binary_int(resource, TYPE_RESOURCE, resource->name_id(), data, size);
+            success = serialize_TLV_binary_int(resource, TYPE_RESOURCE, resource->name_id(), writer);
         } else if (resource->resource_instance_type() == M2MResourceBase::FLOAT) {
-            success = serialize_TLV_binary_float(resource, TYPE_RESOURCE, resource->name_id(), data, size);
+            success = serialize_TLV_binary_float(resource, TYPE_RESOURCE, resource->name_id(), writer);
         } else {
             success = serialize_TILV(TYPE_RESOURCE, resource->name_id(),
-                                     resource->value(), resource->value_length(), data, size);
+                                     resource->value(), resource->value_length(), writer);
         }
     }
     return success;
 }
 
-bool M2MTLVSerializer::serialize_multiple_resource(const M2MResource *resource, uint8_t *&data, uint32_t &size)
+bool M2MTLVSerializer::serialize_multiple_resource(const M2MResource *resource, Writer &writer)
 {
-    bool success = false;
-    uint8_t *nested_data = NULL;
-    uint32_t nested_data_size = 0;
+    if (resource->name_id() == -1 ||
+            (resource->operation() & M2MBase::GET_ALLOWED) != M2MBase::GET_ALLOWED) {
+        return false;
+    }
+
+    // the length of the nested instances is needed for the resource header
+    Writer counter;
+    if (!serialize_resource_instances(resource, counter) ||
+            !serialize_TIL(TYPE_MULTIPLE_RESOURCE, resource->name_id(), counter.size(), writer)) {
+        return false;
+    }
 
+    if (writer.counting()) {
+        writer.skip(counter.size());
+        return true;
+    }
+    return serialize_resource_instances(resource, writer);
+}
+
+bool M2MTLVSerializer::serialize_resource_instances(const M2MResource *resource, Writer &writer)
+{
     const M2MResourceInstanceList &instance_list = resource->resource_instances();
-    if (!instance_list.empty()) {
-        M2MResourceInstanceList::const_iterator it;
-        it = instance_list.begin();
-        for (; it != instance_list.end(); it++) {
-            uint16_t id = (*it)->instance_id();
-            if (((*it)->operation() & M2MBase::GET_ALLOWED) == M2MBase::GET_ALLOWED) {
-                if (!serialize_resource_instance(id, (*it), nested_data, nested_data_size)) {
-                    /* serializing instance has failed */
-                    /* free data so far allocated */
-                    free(nested_data);
-                    /* return fail immediately*/
-                    success = false;
-                    return success;
-                }
+    M2MResourceInstanceList::const_iterator it;
+    it = instance_list.begin();
+    for (; it != instance_list.end(); it++) {
+        uint16_t id = (*it)->instance_id();
+        if (((*it)->operation() & M2MBase::GET_ALLOWED) == M2MBase::GET_ALLOWED) {
+            if (!serialize_resource_instance(id, (*it), writer)) {
+                /* serializing instance has failed */
+                return false;
             }
         }
     }
-    if (resource->name_id() != -1 &&
-            (resource->operation() & M2MBase::GET_ALLOWED) == M2MBase::GET_ALLOWED) {
-        success = serialize_TILV(TYPE_MULTIPLE_RESOURCE, resource->name_id(),
-                                 nested_data, nested_data_size, data, size);
-    }
-
-    free(nested_data);
-    return success;
+    return true;
 }
 
-bool M2MTLVSerializer::serialize_resource_instance(uint16_t id, const M2MResourceInstance *resource, uint8_t *&data, uint32_t &size)
+bool M2MTLVSerializer::serialize_resource_instance(uint16_t id, const M2MResourceInstance *resource, Writer &writer)
 {
     bool success;
 
     if ((resource->resource_instance_type() == M2MResourceBase::INTEGER) ||
             (resource->resource_instance_type() == M2MResourceBase::BOOLEAN) ||
             (resource->resource_instance_type() == M2MResourceBase::TIME)) {
-        success = serialize_TLV_binary_int(resource, TYPE_RESOURCE_INSTANCE, id, data, size);
+        success = serialize_TLV_binary_int(resource, TYPE_RESOURCE_INSTANCE, id, writer);
     } else if (resource->resource_instance_type() == M2MResourceBase::FLOAT) {
-        success = serialize_TLV_binary_float(resource, TYPE_RESOURCE_INSTANCE, id, data, size);
+        success = serialize_TLV_binary_float(resource, TYPE_RESOURCE_INSTANCE, id, writer);
     } else {
-        success = serialize_TILV(TYPE_RESOURCE_INSTANCE, id, resource->value(), resource->value_length(), data, size);
+        success = serialize_TILV(TYPE_RESOURCE_INSTANCE, id, resource->value(), resource->value_length(), writer);
     }
 
     return success;
@@ -196,76 +294,71 @@ bool M2MTLVSerializer::serialize_resource_instance(uint16_t id, const M2MResourc
 
 /* See, OMA-TS-LightweightM2M-V1_0-20170208-A, Appendix C,
  * Data Types, Integer, Boolean and Time TLV Format */
-bool M2MTLVSerializer::serialize_TLV_binary_int(const M2MResourceBase *resource, uint8_t type, uint16_t id, uint8_t *&data, uint32_t &size)
+bool M2MTLVSerializer::serialize_TLV_binary_int(const M2MResourceBase *resource, uint8_t type, uint16_t id, Writer &writer)
 {
+    const uint32_t buffer_size = (resource->resource_instance_type() == M2MResourceBase::BOOLEAN) ? 1 : 8;
+
+    if (writer.counting()) {
+        // the size does not depend on the value, do not parse it
+        serialize_TIL(type, id, buffer_size, writer);
+        writer.skip(buffer_size);
+        return true;
+    }
+
     int64_t valueInt = resource->get_value_int();
-    uint32_t buffer_size;
     /* max len 8 bytes */
     uint8_t buffer[8];
 
-    if (resource->resource_instance_type() == M2MResourceBase::BOOLEAN) {
-        buffer_size = 1;
+    if (buffer_size == 1) {
         buffer[0] = valueInt;
     } else {
-        buffer_size = 8;
         common_write_64_bit(valueInt, buffer);
     }
 
-    return serialize_TILV(type, id, buffer, buffer_size, data, size);
+    return serialize_TILV(type, id, buffer, buffer_size, writer);
 }
 
 /* See, OMA-TS-LightweightM2M-V1_0-20170208-A, Appendix C,
  * Data Type Float (32 bit only) TLV Format */
-bool M2MTLVSerializer::serialize_TLV_binary_float(const M2MResourceBase *resource, uint8_t type, uint16_t id, uint8_t *&data, uint32_t &size)
+bool M2MTLVSerializer::serialize_TLV_binary_float(const M2MResourceBase *resource, uint8_t type, uint16_t id, Writer &writer)
 {
+    if (writer.counting()) {
+        serialize_TIL(type, id, 4, writer);
+        writer.skip(4);
+        return true;
+    }
+
     float valueFloat = resource->get_value_float();
     /* max len 8 bytes */
     uint8_t buffer[4];
 
     common_write_32_bit(valueFloat, buffer);
 
-    return serialize_TILV(type, id, buffer, 4, data, size);
+    return serialize_TILV(type, id, buffer, 4, writer);
 }
 
+bool M2MTLVSerializer::serialize_TILV(uint8_t type, uint16_t id, const uint8_t *value, uint32_t value_length, Writer &writer)
+{
+    return serialize_TIL(type, id, value_length, writer) && writer.write(value, value_length);
+}
 
-bool M2MTLVSerializer::serialize_TILV(uint8_t type, uint16_t id, uint8_t *value, uint32_t value_length, uint8_t *&data, uint32_t &size)
+bool M2MTLVSerializer::serialize_TIL(uint8_t type, uint16_t id, uint32_t value_length, Writer &writer)
 {
-    uint8_t *tlv = 0;
-    const uint32_t type_length = TLV_TYPE_SIZE;
     type += id < 256 ? 0 : ID16;
     type += value_length < 8 ? value_length :
             value_length < 256 ? LENGTH8 :
             value_length < 65536 ? LENGTH16 : LENGTH24;
-    uint8_t tlv_type;
-    tlv_type = type & 0xFF;
+
+    uint8_t header[TLV_TYPE_SIZE + MAX_TLV_ID_SIZE + MAX_TLV_LENGTH_SIZE];
+    header[0] = type & 0xFF;
 
     uint32_t id_size;
-    uint8_t id_array[MAX_TLV_ID_SIZE];
-    serialize_id(id, id_size, id_array);
+    serialize_id(id, id_size, header + TLV_TYPE_SIZE);
 
     uint32_t length_size;
-    uint8_t length_array[MAX_TLV_LENGTH_SIZE];
-    serialize_length(value_length, length_size, length_array);
+    serialize_length(value_length, length_size, header + TLV_TYPE_SIZE + id_size);
 
-    tlv = (uint8_t *)malloc(size + type_length + id_size + length_size + value_length);
-    if (!tlv) {
-        /* memory allocation has failed */
-        /* return failure immediately */
-        return false;
-        /* eventually NULL will be returned to serializer public method caller */
-    }
-    if (data) {
-        memcpy(tlv, data, size);
-        free(data);
-    }
-    memcpy(tlv + size, &tlv_type, type_length);
-    memcpy(tlv + size + type_length, id_array, id_size);
-    memcpy(tlv + size + type_length + id_size, length_array, length_size);
-    memcpy(tlv + size + type_length + id_size + length_size, value, value_length);
-
-    data = tlv;
-    size += type_length + id_size + length_size + value_length;
-    return true;
+    return writer.write(header, TLV_TYPE_SIZE + id_size + length_size);
 }
 
 void M2MTLVSerializer::serialize_id(uint16_t id, uint32_t &size, uint8_t *id_ptr)
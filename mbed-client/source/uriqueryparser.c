@@ -48,55 +48,57 @@ int parse_query_parameter_value_from_query(const char *query, const char *parame
 
     *parameter_value = NULL;
     const int param_name_len = strlen(parameter_name);
-    const int query_len = strlen(query);
 
-    if (param_name_len == 0 || query_len == 0) {
+    if (param_name_len == 0) {
         return -1;
     }
 
-    const char *value_ptr = query;
-
-    do {
-        value_ptr = strstr(value_ptr, parameter_name);
-
-        // No match at all, then break
-        if (!value_ptr) {
-            break;
+    query_parameter_s parameter;
+    while (next_query_parameter(&query, NULL, &parameter)) {
+        // Parameter without '=' does not match, there might be another one left
+        if (parameter.value &&
+                parameter.key_len == param_name_len &&
+                memcmp(parameter.key, parameter_name, param_name_len) == 0) {
+            *parameter_value = parameter.value;
+            return parameter.value_len;
         }
+    }
+    return -1;
+}
 
-        // Check that match was at the beginning or there is a & before the match
-        if (!(value_ptr == query || *(value_ptr - 1) == '&')) {
-            // Offset value_ptr past the match to find next one
-            value_ptr += param_name_len;
-            continue;
-        }
+int next_query_parameter(const char **query, const char *query_end, query_parameter_s *parameter)
+{
+    assert(query);
+    assert(parameter);
 
-        // Offset to after parameter name
-        value_ptr += param_name_len;
+    const char *pos = *query;
+    if (pos == NULL || pos == query_end || *pos == '\0') {
+        return 0;
+    }
 
-        // Check that parameter was not at the end
-        if (value_ptr >= query + query_len) {
-            break;
-        }
+    parameter->key = pos;
+    parameter->value = NULL;
+    parameter->value_len = 0;
 
-        // CHeck that there is an '=' after parameter name, continue if not as there might be
-        // another parameter left
-        if (*value_ptr != '=') {
-            continue;
+    while (pos != query_end && *pos != '\0' && *pos != '&') {
+        // First '=' ends the key, the rest belongs to the value
+        if (*pos == '=' && parameter->value == NULL) {
+            parameter->key_len = pos - parameter->key;
+            parameter->value = pos + 1;
         }
+        pos++;
+    }
 
-        *parameter_value = ++value_ptr;
-        break;
-
-    } while (value_ptr);
+    if (parameter->value) {
+        parameter->value_len = pos - parameter->value;
+    } else {
+        parameter->key_len = pos - parameter->key;
+    }
 
-    // If parameter found, calculate length of value either ending at an '&' or the end
-    if (*parameter_value != NULL) {
-        value_ptr = strchr(*parameter_value, '&');
-        if (value_ptr) {
-            return value_ptr - *parameter_value;
-        }
-        return strlen(*parameter_value);
+    // Skip the '&', an empty parameter after the last one ends the query
+    if (pos != query_end && *pos == '&') {
+        pos++;
     }
-    return -1;
+    *query = pos;
+    return 1;
 }
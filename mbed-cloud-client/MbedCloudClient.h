@@ -222,6 +222,17 @@ public:
         Sleep
     } Status;
 
+    /**
+     * \brief An enum defining the phases of the client startup,
+     * reported through the `on_startup_phase()` callback.
+     */
+    typedef enum {
+        StartupInitialized = 0,     ///< Client components, such as Update Client, are initialized.
+        StartupBootstrapped,        ///< Bootstrap is complete. Not reported if the device was already bootstrapped.
+        StartupRegistering,         ///< Credentials are available and the registration starts.
+        StartupRegistered           ///< The client is registered.
+    } StartupPhase;
+
     /**
      * \brief Constructor
      */
@@ -390,6 +401,14 @@ public:
     template<typename T>
     void on_status_changed(T *object, void (T::*member)(int));
 
+    /**
+     * \brief Set the callback function that is called when a phase of the client startup
+     * is complete, with the milliseconds elapsed since `setup()`.
+     * The phase can be mapped from the `MbedCloudClient::StartupPhase` enum.
+     * \param fn Function pointer to the function that is called when a startup phase completes.
+     */
+    void on_startup_phase(void(*fn)(int phase, uint32_t elapsed_ms));
+
     /**
      * \brief Set the callback function that is called when Device Management Client is unregistered
      * successfully from Device Management. This is used for a statically defined function.
@@ -664,6 +683,13 @@ protected: // from ServiceClientCallback
     */
     virtual void value_updated(M2MBase *base, M2MBase::BaseType type);
 
+    /**
+    * \brief A callback indicating that a phase of the client startup is complete.
+    * \param phase The completed phase.
+    * \param elapsed_ms Milliseconds since the startup began.
+    */
+    virtual void startup_phase(ServiceClientStartupPhase phase, uint32_t elapsed_ms);
+
 #ifdef MBED_CLOUD_CLIENT_SUPPORT_MULTICAST_UPDATE
     /**
     * \brief A callback indicating that new external firmware is available.
@@ -683,6 +709,7 @@ private:
     FP0<void>                                       _on_registration_updated;
     FP1<void, int>                                   _on_error;
     FP1<void, int>                                   _on_status_changed;
+    FP2<void, int, uint32_t>                        _on_startup_phase;
     const char                                      *_error_description;
     bool                                            _init_done;
 #ifdef MBED_CLOUD_CLIENT_SUPPORT_MULTICAST_UPDATE
@@ -0,0 +1,155 @@
+// ----------------------------------------------------------------------------
+// Copyright (c) 2021 Pelion. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+/** \file PerfCounters.h
+ *  \brief Performance counters and gauges of the client modules.
+ *
+ * The counters are listed once in PERF_COUNTER_LIST, there is no runtime registration.
+ * Each entry gives the name used in the enumeration and the dump, the kind of the value
+ * and the resource ID under the performance counter LwM2M object:
+ *  - PERF_KIND_COUNTER, events counted with PERF_COUNTER_ADD().
+ *  - PERF_KIND_GAUGE, the latest value set with PERF_COUNTER_SET().
+ *  - PERF_KIND_MAX, a high water mark raised with PERF_COUNTER_MAX().
+ *
+ * The updates are lock free, so they can be made from any thread and from interrupts.
+ * The counters are compiled in with the mbed-cloud-client.perf-counters configuration,
+ * otherwise the macros expand to nothing and the arguments are not evaluated.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef MBED_CONF_MBED_CLOUD_CLIENT_PERF_COUNTERS
+#define PERF_COUNTERS_ENABLED MBED_CONF_MBED_CLOUD_CLIENT_PERF_COUNTERS
+#else
+#define PERF_COUNTERS_ENABLED 0
+#endif
+
+// X(name, kind, resource ID)
+#define PERF_COUNTER_LIST(X) \
+    X(COAP_RETRANSMISSIONS,     PERF_KIND_COUNTER,  1) /* CoAP messages sent again after a missing ACK */ \
+    X(COAP_SEND_TIMEOUTS,       PERF_KIND_COUNTER,  2) /* CoAP messages which ran out of retransmissions */ \
+    X(NETWORK_RTT_ESTIMATE,     PERF_KIND_GAUGE,    3) /* Coarse network RTT estimate, seconds */ \
+    X(COAP_MESSAGES_SENT,       PERF_KIND_COUNTER,  4) /* CoAP messages sent, retransmissions included */ \
+    X(COAP_BYTES_SENT,          PERF_KIND_COUNTER,  5) /* Bytes of the CoAP messages sent */ \
+    X(COAP_MESSAGES_RECEIVED,   PERF_KIND_COUNTER,  6) /* CoAP messages received */ \
+    X(COAP_BYTES_RECEIVED,      PERF_KIND_COUNTER,  7) /* Bytes of the CoAP messages received */ \
+    X(TLS_HANDSHAKES,           PERF_KIND_COUNTER, 10) /* Completed (D)TLS handshakes */ \
+    X(TLS_HANDSHAKE_TIME,       PERF_KIND_GAUGE,   11) /* Duration of the latest handshake, ms */ \
+    X(TLS_HANDSHAKE_TIME_MAX,   PERF_KIND_MAX,     12) /* Longest handshake, ms */ \
+    X(HEAP_HIGH_WATER,          PERF_KIND_MAX,     20) /* Most bytes allocated from the nanostack heap */ \
+    X(HEAP_ALLOC_FAILURES,      PERF_KIND_GAUGE,   21) /* Failed nanostack heap allocations */ \
+    X(UC_SCHEDULER_HIGH_WATER,  PERF_KIND_MAX,     22) /* Most callbacks queued in the update client scheduler */ \
+    X(STORAGE_READS,            PERF_KIND_COUNTER, 30) /* Items read from KCM by the client storage layer */ \
+    X(STORAGE_CACHE_HITS,       PERF_KIND_COUNTER, 31) /* Configuration items served from the storage cache */ \
+    X(FOTA_FRAGMENTS,           PERF_KIND_COUNTER, 40) /* Image fragments received by FOTA */ \
+    X(FOTA_BYTES,               PERF_KIND_COUNTER, 41) /* Image bytes received by FOTA */ \
+    X(DS_REPORTS,               PERF_KIND_COUNTER, 50) /* Metrics reports published by Device Sentry */ \
+    X(RESOURCE_LOOKUPS,         PERF_KIND_COUNTER, 60) /* Exact path lookups in the resource table */ \
+    X(RESOURCE_LOOKUP_STEPS_MAX, PERF_KIND_MAX,    61) /* Most resources compared in one lookup */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    PERF_KIND_COUNTER,
+    PERF_KIND_GAUGE,
+    PERF_KIND_MAX
+} perf_counter_kind_e;
+
+typedef enum {
+#define PERF_COUNTER_ENUM(name, kind, resource_id) PERF_COUNTER_##name,
+    PERF_COUNTER_LIST(PERF_COUNTER_ENUM)
+#undef PERF_COUNTER_ENUM
+    PERF_COUNTER_COUNT
+} perf_counter_e;
+
+#if PERF_COUNTERS_ENABLED
+
+extern volatile uint32_t perf_counter_values[PERF_COUNTER_COUNT];
+
+#define PERF_COUNTER_ADD(name, n) \
+    ((void)__atomic_fetch_add(&perf_counter_values[PERF_COUNTER_##name], (uint32_t)(n), __ATOMIC_RELAXED))
+
+#define PERF_COUNTER_SET(name, v) \
+    __atomic_store_n(&perf_counter_values[PERF_COUNTER_##name], (uint32_t)(v), __ATOMIC_RELAXED)
+
+#define PERF_COUNTER_MAX(name, v) \
+    perf_counter_raise(PERF_COUNTER_##name, (uint32_t)(v))
+
+/**
+ * \brief Raises a high water mark to the value if it is larger.
+ */
+void perf_counter_raise(perf_counter_e counter, uint32_t value);
+
+/**
+ * \brief Returns the value of a counter.
+ */
+uint32_t perf_counter_get(perf_counter_e counter);
+
+/**
+ * \brief Returns the name of a counter, such as "COAP_RETRANSMISSIONS".
+ */
+const char *perf_counter_name(perf_counter_e counter);
+
+/**
+ * \brief Returns the kind of a counter.
+ */
+perf_counter_kind_e perf_counter_kind(perf_counter_e counter);
+
+/**
+ * \brief Returns the resource ID of a counter in the performance counter object.
+ */
+uint16_t perf_counter_resource_id(perf_counter_e counter);
+
+/**
+ * \brief Updates the values which are read from the modules owning them, such as the heap
+ * statistics. Called before the values are dumped or published.
+ */
+void perf_counters_sample(void);
+
+/**
+ * \brief Writes the counters as "name value" lines, sampling them first.
+ * \param buffer Buffer for the text, zero terminated.
+ * \param buffer_size Size of the buffer.
+ * \return Length of the full text without the terminator, it was truncated if this is
+ *         buffer_size or more.
+ */
+size_t perf_counters_dump(char *buffer, size_t buffer_size);
+
+/**
+ * \brief Clears the counters and high water marks, the gauges are left as they are.
+ */
+void perf_counters_reset(void);
+
+#else
+
+#define PERF_COUNTER_ADD(name, n) ((void)0)
+#define PERF_COUNTER_SET(name, v) ((void)0)
+#define PERF_COUNTER_MAX(name, v) ((void)0)
+
+#endif // PERF_COUNTERS_ENABLED
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PERF_COUNTERS_H
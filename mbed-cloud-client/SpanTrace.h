@@ -0,0 +1,136 @@
+// ----------------------------------------------------------------------------
+// Copyright (c) 2021 Pelion. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef SPAN_TRACE_H
+#define SPAN_TRACE_H
+
+/** \file SpanTrace.h
+ *  \brief Timing spans of the connection lifecycle.
+ *
+ * The begin and end of each phase of connecting to the service, from the DNS query to the
+ * registration, are recorded with a microsecond timestamp into a ring buffer, which keeps
+ * the latest mbed-cloud-client.span-trace-entries events. The buffer can be exported as
+ * Chrome trace JSON, which opens in Perfetto or chrome://tracing, or as a compact binary
+ * dump for devices which cannot spare the memory for the text.
+ *
+ * The spans are listed once in SPAN_TRACE_LIST. Their order is the span number in the
+ * binary dump, so new spans are added to the end. The recording is lock free, and compiled
+ * in with the mbed-cloud-client.span-trace configuration, otherwise the macros expand to
+ * nothing and the arguments are not evaluated.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef MBED_CONF_MBED_CLOUD_CLIENT_SPAN_TRACE
+#define SPAN_TRACE_ENABLED MBED_CONF_MBED_CLOUD_CLIENT_SPAN_TRACE
+#else
+#define SPAN_TRACE_ENABLED 0
+#endif
+
+// X(name)
+#define SPAN_TRACE_LIST(X) \
+    X(BOOTSTRAP)            /* ConnectorClient bootstrap, until it succeeds or fails */ \
+    X(EST)                  /* ConnectorClient LwM2M certificate enrollment */ \
+    X(REGISTRATION)         /* ConnectorClient registration to the LwM2M server */ \
+    X(M2M_STATE)            /* M2MInterfaceImpl state change, instant, the argument is the new state */ \
+    X(DNS)                  /* Server address resolution */ \
+    X(CONNECT)              /* Socket connect, near zero for UDP */ \
+    X(TLS_HANDSHAKE)        /* (D)TLS handshake of the connection handler */ \
+    X(TLS_HANDSHAKE_STEP)   /* One pal_handShake() call, a flight when the handshake is not blocking */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+#define SPAN_TRACE_ENUM(name) SPAN_TRACE_##name,
+    SPAN_TRACE_LIST(SPAN_TRACE_ENUM)
+#undef SPAN_TRACE_ENUM
+    SPAN_TRACE_COUNT
+} span_trace_e;
+
+/** Phases use the Chrome trace event letters. */
+typedef enum {
+    SPAN_PHASE_BEGIN = 'B',
+    SPAN_PHASE_END = 'E',
+    SPAN_PHASE_INSTANT = 'i'
+} span_trace_phase_e;
+
+#if SPAN_TRACE_ENABLED
+
+#define SPAN_TRACE_BEGIN(name) \
+    span_trace_record(SPAN_TRACE_##name, SPAN_PHASE_BEGIN, 0)
+
+/** The argument is the result of the phase, such as 0 for success. */
+#define SPAN_TRACE_END(name, arg) \
+    span_trace_record(SPAN_TRACE_##name, SPAN_PHASE_END, (uint16_t)(arg))
+
+#define SPAN_TRACE_INSTANT(name, arg) \
+    span_trace_record(SPAN_TRACE_##name, SPAN_PHASE_INSTANT, (uint16_t)(arg))
+
+/**
+ * \brief Records an event, overwriting the oldest one when the buffer is full.
+ */
+void span_trace_record(span_trace_e span, span_trace_phase_e phase, uint16_t arg);
+
+/**
+ * \brief Returns the name of a span, such as "TLS_HANDSHAKE".
+ */
+const char *span_trace_name(span_trace_e span);
+
+/**
+ * \brief Writes the recorded events as Chrome trace JSON.
+ * \param buffer Buffer for the text, zero terminated.
+ * \param buffer_size Size of the buffer.
+ * \return Length of the full text without the terminator, it was truncated if this is
+ *         buffer_size or more.
+ */
+size_t span_trace_export_json(char *buffer, size_t buffer_size);
+
+/**
+ * \brief Writes the recorded events as a binary dump.
+ *
+ * The dump is an 8 byte header, the magic "SPTR", a version byte of 1, the size of an
+ * event and the number of events as a 16 bit value, followed by the events oldest first.
+ * Each event is the timestamp in microseconds as a 32 bit value which wraps around, the
+ * span number, the phase letter and the argument as a 16 bit value. The multibyte values
+ * are little endian.
+ * \param buffer Buffer for the dump.
+ * \param buffer_size Size of the buffer, the oldest events are left out if it is too small.
+ * \return Bytes written, 0 if the buffer cannot hold the header.
+ */
+size_t span_trace_export_binary(uint8_t *buffer, size_t buffer_size);
+
+/**
+ * \brief Forgets the recorded events.
+ */
+void span_trace_clear(void);
+
+#else
+
+#define SPAN_TRACE_BEGIN(name) ((void)0)
+#define SPAN_TRACE_END(name, arg) ((void)0)
+#define SPAN_TRACE_INSTANT(name, arg) ((void)0)
+
+#endif // SPAN_TRACE_ENABLED
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SPAN_TRACE_H
@@ -64,6 +64,7 @@ typedef enum sn_coap_msg_code_ {
     COAP_MSG_CODE_REQUEST_POST                          = 2,
     COAP_MSG_CODE_REQUEST_PUT                           = 3,
     COAP_MSG_CODE_REQUEST_DELETE                        = 4,
+    COAP_MSG_CODE_REQUEST_FETCH                         = 5,
 
     COAP_MSG_CODE_RESPONSE_CREATED                      = 65,
     COAP_MSG_CODE_RESPONSE_DELETED                      = 66,
@@ -129,6 +130,7 @@ typedef enum sn_coap_content_format_ {
     COAP_CT_OCTET_STREAM        = 42,
     COAP_CT_EXI                 = 47,
     COAP_CT_JSON                = 50,
+    COAP_CT_LINK_FORMAT_CBOR    = 64,
     COAP_CT__MAX                = 0xffff
 } sn_coap_content_format_e;
 
@@ -219,6 +221,9 @@ typedef struct sn_coap_options_list_ {
  */
 typedef struct sn_coap_hdr_ {
     uint8_t                 token_len;          /**< 1-8 bytes. */
+#if SN_COAP_PARSER_SINGLE_ALLOCATION
+    uint16_t                parser_arena_len;   /**< Internal, size of the single allocation made by the parser or 0 */
+#endif
 
     sn_coap_status_e        coap_status;        /**< Used for telling to User special cases when parsing message */
     sn_coap_msg_code_e      msg_code;           /**< Empty: 0; Requests: 1-31; Responses: 64-191 */
@@ -29,6 +29,26 @@ extern "C" {
 
 #include "sn_coap_header.h"
 
+/**
+ * \brief Statistics of the CoAP internal memory pool, see SN_COAP_MEMORY_POOL_SMALL_BLOCKS.
+ */
+typedef struct sn_coap_pool_stats_ {
+    uint16_t small_block_size;      /**< Size of a small block in bytes */
+    uint16_t small_block_count;     /**< Number of small blocks */
+    uint16_t small_in_use;          /**< Small blocks currently allocated */
+    uint16_t small_high_water;      /**< Maximum number of small blocks allocated at the same time */
+    uint16_t large_block_size;      /**< Size of a large block in bytes */
+    uint16_t large_block_count;     /**< Number of large blocks */
+    uint16_t large_in_use;          /**< Large blocks currently allocated */
+    uint16_t large_high_water;      /**< Maximum number of large blocks allocated at the same time */
+    uint32_t misses;                /**< Allocations served from heap because the pool was exhausted or the block too small */
+} sn_coap_pool_stats_s;
+
+typedef struct sn_coap_exchange_stats_ {
+    uint32_t retransmissions;       /**< Messages sent again after a missing acknowledgement */
+    uint32_t send_timeouts;         /**< Messages which ran out of retransmissions */
+} sn_coap_exchange_stats_s;
+
 /**
  * \fn struct coap_s *sn_coap_protocol_init(void* (*used_malloc_func_ptr)(uint16_t), void (*used_free_func_ptr)(void*),
         uint8_t (*used_tx_callback_ptr)(sn_nsdl_capab_e , uint8_t *, uint16_t, sn_nsdl_addr_s *),
@@ -86,11 +106,46 @@ extern int8_t sn_coap_protocol_destroy(struct coap_s *handle);
  *          -2 = Failure in given pointer (= NULL)\n
  *          -3 = Failure in Reset message\n
  *          -4 = Failure in Resending message store\n
+ *         0 is returned for a Confirmable message which was stored, but must not be sent
+ *         now as SN_COAP_NSTART messages to the destination are in flight. The library
+ *         sends it through the tx callback when an earlier exchange completes.\n
  *         If there is not enough memory (or User given limit exceeded) for storing
  *         resending messages, situation is ignored.
  */
 extern int16_t sn_coap_protocol_build(struct coap_s *handle, sn_nsdl_addr_s *dst_addr_ptr, uint8_t *dst_packet_data_ptr, sn_coap_hdr_s *src_coap_msg_ptr, void *param);
 
+/**
+ * \brief Callback producing the next payload block of a request built with sn_coap_protocol_build_stream()
+ *
+ * \param param is the param given to sn_coap_protocol_build_stream()
+ *
+ * \param *dst_ptr is pointer to the block_size bytes to fill
+ *
+ * \param block_size is the block size in use
+ *
+ * \param *more must be set to true if payload continues after this block, the block must then be full
+ *
+ * \return Number of payload bytes written, < 0 if payload can not be produced
+ */
+typedef int32_t (*sn_coap_payload_producer_cb)(void *param, uint8_t *dst_ptr, uint16_t block_size, bool *more);
+
+/**
+ * \fn int16_t sn_coap_protocol_build_stream(struct coap_s *handle, sn_nsdl_addr_s *dst_addr_ptr, uint8_t *dst_packet_data_ptr, sn_coap_hdr_s *src_coap_msg_ptr, sn_coap_payload_producer_cb producer, void *param)
+ *
+ * \brief Builds the first block of a request, whose payload is produced one block at a time
+ *
+ * Works as sn_coap_protocol_build(), except that src_coap_msg_ptr carries only the first block
+ * of the payload, which must be full, and Block1 option with the more bit set. The following
+ * blocks are asked from the producer when the previous one is acknowledged, so the whole payload
+ * is never held in memory. As its total size is not known, Size1 option is not sent.
+ *
+ * \param producer is the callback producing the blocks after the first one
+ *
+ * \return See sn_coap_protocol_build(), -2 also if blockwise transfer is disabled
+ */
+extern int16_t sn_coap_protocol_build_stream(struct coap_s *handle, sn_nsdl_addr_s *dst_addr_ptr, uint8_t *dst_packet_data_ptr, sn_coap_hdr_s *src_coap_msg_ptr,
+                                             sn_coap_payload_producer_cb producer, void *param);
+
 /**
  * \fn sn_coap_hdr_s *sn_coap_protocol_parse(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, uint16_t packet_data_len, uint8_t *packet_data_ptr)
  *
@@ -134,6 +189,37 @@ extern sn_coap_hdr_s *sn_coap_protocol_parse(struct coap_s *handle, sn_nsdl_addr
 
 extern int8_t sn_coap_protocol_exec(struct coap_s *handle, uint32_t current_time);
 
+/**
+ * \fn int8_t sn_coap_protocol_set_time(struct coap_s *handle, uint32_t current_time)
+ *
+ * \brief Updates the system time without processing any queues.
+ *
+ *        Messages and infos stored after this call are timed from current_time. Use this when
+ *        sn_coap_protocol_exec() is called less often than once in a second.
+ *
+ * \param *handle Pointer to CoAP library handle
+ *
+ * \param current_time is System time in seconds, in the same time base as given to sn_coap_protocol_exec()
+ *
+ * \return  0 if success
+ *          -1 if failed
+ */
+extern int8_t sn_coap_protocol_set_time(struct coap_s *handle, uint32_t current_time);
+
+/**
+ * \fn uint32_t sn_coap_protocol_get_next_exec_time(struct coap_s *handle)
+ *
+ * \brief Returns the time when sn_coap_protocol_exec() has next work to do, i.e. a message to
+ *        re-send or stored data to time out.
+ *
+ * \param *handle Pointer to CoAP library handle
+ *
+ * \return System time in seconds, in the same time base as given to sn_coap_protocol_exec().
+ *         Time may be in the past, if something is already due.\n
+ *         UINT32_MAX if there is nothing pending.
+ */
+extern uint32_t sn_coap_protocol_get_next_exec_time(struct coap_s *handle);
+
 /**
  * \fn int8_t sn_coap_protocol_set_block_size(uint16_t block_size)
  *
@@ -314,6 +400,30 @@ extern void sn_coap_protocol_linked_list_duplication_info_remove(struct coap_s *
                                                                  const uint16_t port,
                                                                  const uint16_t msg_id);
 
+/**
+ * \fn int8_t sn_coap_protocol_get_pool_stats(struct coap_s *handle, sn_coap_pool_stats_s *stats)
+ *
+ * \brief Get usage statistics of the internal memory pool. All values are zero if the pool is disabled.
+ *
+ * \param *handle Pointer to CoAP library handle
+ * \param *stats Pointer to statistics to be filled
+ *
+ * \return 0 = success, -1 = failure
+ */
+extern int8_t sn_coap_protocol_get_pool_stats(struct coap_s *handle, sn_coap_pool_stats_s *stats);
+
+/**
+ * \fn int8_t sn_coap_protocol_get_exchange_stats(struct coap_s *handle, sn_coap_exchange_stats_s *stats)
+ *
+ * \brief Get the retransmission counts since the library was initialized. All values are zero if resending is disabled.
+ *
+ * \param *handle Pointer to CoAP library handle
+ * \param *stats Pointer to statistics to be filled
+ *
+ * \return 0 = success, -1 = failure
+ */
+extern int8_t sn_coap_protocol_get_exchange_stats(struct coap_s *handle, sn_coap_exchange_stats_s *stats);
+
 #endif /* SN_COAP_PROTOCOL_H_ */
 
 #ifdef __cplusplus
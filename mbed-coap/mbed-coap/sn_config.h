@@ -210,6 +210,56 @@
 #define SN_COAP_MAX_ALLOWED_RESPONSE_TIMEOUT            40  /**< Maximum allowed re-sending timeout */
 #endif
 
+/**
+ * \def SN_COAP_ADAPTIVE_RTO
+ * \brief Enables CoCoA (draft-ietf-core-cocoa) adaptive retransmission timeout.
+ * Round trip times of confirmable exchanges are measured per destination. Exchanges
+ * acknowledged without retransmission update a strong estimator and the ones which
+ * needed one or two retransmissions a weak estimator, and both feed the RTO of the
+ * destination. The backoff factor is 2 up to an RTO of 3 seconds and 1.5 above it.
+ * The interval given to 'sn_coap_protocol_set_retransmission_parameters()' is the
+ * initial RTO. Measurements have the one second resolution of the library time,
+ * so the RTO is kept between 1 and 60 seconds.
+ * By default, disabled, which uses the fixed interval with binary backoff.
+ */
+#ifdef MBED_CONF_MBED_CLIENT_SN_COAP_ADAPTIVE_RTO
+#define SN_COAP_ADAPTIVE_RTO MBED_CONF_MBED_CLIENT_SN_COAP_ADAPTIVE_RTO
+#endif
+
+#ifndef SN_COAP_ADAPTIVE_RTO
+#define SN_COAP_ADAPTIVE_RTO                            0
+#endif
+
+/**
+ * \def SN_COAP_ADAPTIVE_RTO_PEERS
+ * \brief Number of destinations the adaptive RTO is tracked for. The least recently
+ * updated one is replaced when a new destination is seen.
+ * By default 2.
+ */
+#ifdef MBED_CONF_MBED_CLIENT_SN_COAP_ADAPTIVE_RTO_PEERS
+#define SN_COAP_ADAPTIVE_RTO_PEERS MBED_CONF_MBED_CLIENT_SN_COAP_ADAPTIVE_RTO_PEERS
+#endif
+
+#ifndef SN_COAP_ADAPTIVE_RTO_PEERS
+#define SN_COAP_ADAPTIVE_RTO_PEERS                      2
+#endif
+
+/**
+ * \def SN_COAP_NSTART
+ * \brief Maximum number of outstanding confirmable messages per destination (NSTART).
+ * Messages built while the window is full are kept in the resending queue and sent
+ * by the library when an earlier exchange completes, 'sn_coap_protocol_build()'
+ * returns 0 for them. Continuation blocks of a blockwise transfer are not limited.
+ * By default 0, which does not limit the messages in flight.
+ */
+#ifdef MBED_CONF_MBED_CLIENT_SN_COAP_NSTART
+#define SN_COAP_NSTART MBED_CONF_MBED_CLIENT_SN_COAP_NSTART
+#endif
+
+#ifndef SN_COAP_NSTART
+#define SN_COAP_NSTART                                  0
+#endif
+
 /**
  * \def SN_COAP_MAX_ALLOWED_RESENDING_BUFF_SIZE_MSGS
  * \brief Maximum allowed count of messages that can be stored into resend buffer at runtime via
@@ -290,6 +340,60 @@
 #define SN_COAP_BLOCKWISE_INTERNAL_BLOCK_2_HANDLING_ENABLED  1
 #endif
 
+/**
+ * \def SN_COAP_MEMORY_POOL_SMALL_BLOCKS
+ * \brief Number of small blocks in the CoAP internal memory pool.
+ * Small blocks hold the bookkeeping structures of the resend, duplicate detection
+ * and blockwise lists together with the stored addresses and tokens.
+ * Setting this and SN_COAP_MEMORY_POOL_LARGE_BLOCKS to 0 disables the pool and
+ * all memory is allocated through the malloc function given to sn_coap_protocol_init().
+ * By default, the pool is disabled.
+ */
+#ifdef MBED_CONF_MBED_CLIENT_SN_COAP_MEMORY_POOL_SMALL_BLOCKS
+#define SN_COAP_MEMORY_POOL_SMALL_BLOCKS MBED_CONF_MBED_CLIENT_SN_COAP_MEMORY_POOL_SMALL_BLOCKS
+#endif
+
+#ifndef SN_COAP_MEMORY_POOL_SMALL_BLOCKS
+#define SN_COAP_MEMORY_POOL_SMALL_BLOCKS                0
+#endif
+
+/**
+ * \def SN_COAP_MEMORY_POOL_LARGE_BLOCKS
+ * \brief Number of large blocks in the CoAP internal memory pool.
+ * Large blocks hold the packet copies stored for resending and duplicate detection,
+ * and the temporary packets the library builds itself.
+ * By default, the pool is disabled.
+ */
+#ifdef MBED_CONF_MBED_CLIENT_SN_COAP_MEMORY_POOL_LARGE_BLOCKS
+#define SN_COAP_MEMORY_POOL_LARGE_BLOCKS MBED_CONF_MBED_CLIENT_SN_COAP_MEMORY_POOL_LARGE_BLOCKS
+#endif
+
+#ifndef SN_COAP_MEMORY_POOL_LARGE_BLOCKS
+#define SN_COAP_MEMORY_POOL_LARGE_BLOCKS                0
+#endif
+
+/**
+ * \def SN_COAP_MEMORY_POOL_LARGE_BLOCK_SIZE
+ * \brief Size of one large block in the CoAP internal memory pool. Packets which do not
+ * fit into a large block are allocated from heap and counted as pool misses.
+ * By default, the size is one blockwise payload plus room for the CoAP header and options.
+ */
+#ifdef MBED_CONF_MBED_CLIENT_SN_COAP_MEMORY_POOL_LARGE_BLOCK_SIZE
+#define SN_COAP_MEMORY_POOL_LARGE_BLOCK_SIZE MBED_CONF_MBED_CLIENT_SN_COAP_MEMORY_POOL_LARGE_BLOCK_SIZE
+#endif
+
+#ifndef SN_COAP_MEMORY_POOL_LARGE_BLOCK_SIZE
+#if SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE
+#define SN_COAP_MEMORY_POOL_LARGE_BLOCK_SIZE            (SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE + 64)
+#else
+#define SN_COAP_MEMORY_POOL_LARGE_BLOCK_SIZE            320
+#endif
+#endif
+
+#if SN_COAP_MEMORY_POOL_LARGE_BLOCKS * SN_COAP_MEMORY_POOL_LARGE_BLOCK_SIZE > 65535
+#error "SN_COAP_MEMORY_POOL_LARGE_BLOCKS * SN_COAP_MEMORY_POOL_LARGE_BLOCK_SIZE must fit into 16 bits"
+#endif
+
 /**
  * \def SN_COAP_REDUCE_BLOCKWISE_HEAP_FOOTPRINT
  * \brief A heap optimization switch, which removes unnecessary copy of the blockwise data.
@@ -300,4 +404,19 @@
 #define SN_COAP_REDUCE_BLOCKWISE_HEAP_FOOTPRINT              0   /**< Disabled by default */
 #endif
 
+/**
+ * \def SN_COAP_PARSER_SINGLE_ALLOCATION
+ * \brief A heap optimization switch, which makes the parser place the message header, options list,
+ * token and all option values into one allocation sized by a pre-pass over the packet.
+ * sn_coap_parser_release_allocated_coap_msg_mem() must still be used to release the message.
+ * Fields which the application replaces after parsing are released separately as before.
+ */
+#ifdef MBED_CONF_MBED_CLIENT_SN_COAP_PARSER_SINGLE_ALLOCATION
+#define SN_COAP_PARSER_SINGLE_ALLOCATION MBED_CONF_MBED_CLIENT_SN_COAP_PARSER_SINGLE_ALLOCATION
+#endif
+
+#ifndef SN_COAP_PARSER_SINGLE_ALLOCATION
+#define SN_COAP_PARSER_SINGLE_ALLOCATION                     0   /**< Disabled by default */
+#endif
+
 #endif // SN_CONFIG_H
@@ -47,6 +47,13 @@ int8_t prepare_blockwise_message(struct coap_s *handle, struct sn_coap_hdr_ *coa
 typedef struct coap_send_msg_ {
     uint_fast8_t        resending_counter;  /* Tells how many times message is still tried to resend */
     uint32_t            resending_time;     /* Tells next resending time */
+#if SN_COAP_ADAPTIVE_RTO
+    uint32_t            sent_time;          /* Time of the first transmission, for round trip measurement */
+    uint16_t            rto;                /* RTO the resending times are backed off from, 1/8 seconds */
+#endif
+#if SN_COAP_NSTART
+    bool                deferred;           /* Not sent yet, waits for room in the in-flight window */
+#endif
 
     sn_nsdl_transmit_s  send_msg_ptr;
 
@@ -57,14 +64,30 @@ typedef struct coap_send_msg_ {
 
 typedef NS_LIST_HEAD(coap_send_msg_s, link) coap_send_msg_list_t;
 
+#if SN_COAP_ADAPTIVE_RTO
+/* CoCoA round trip state of one destination, times are in 1/8 seconds */
+typedef struct coap_rto_peer_ {
+    uint8_t             addr[16];
+    uint8_t             addr_len;           /* 0 if the entry is not in use */
+    uint16_t            port;
+    uint16_t            rto;                /* Overall RTO */
+    uint16_t            srtt_strong;        /* 0 until the first strong measurement */
+    uint16_t            rttvar_strong;
+    uint16_t            srtt_weak;          /* 0 until the first weak measurement */
+    uint16_t            rttvar_weak;
+    uint32_t            updated;            /* System time of the last RTO change */
+} coap_rto_peer_s;
+#endif
+
 /* Structure which is stored to Linked list for message duplication detection purposes */
 typedef struct coap_duplication_info_ {
     uint32_t            timestamp; /* Tells when duplication information is stored to Linked list */
     uint16_t            msg_id;
     uint16_t            packet_len;
     uint8_t             *packet_ptr;
-    sn_nsdl_addr_s      *address;
+    sn_nsdl_addr_s      address;    /* Address bytes are stored right after this structure */
     void                *param;
+    struct coap_duplication_info_ *hash_next; /* Next info in the same hash bucket */
     ns_list_link_t      link;
 } coap_duplication_info_s;
 
@@ -79,6 +102,9 @@ typedef struct coap_blockwise_msg_ {
     void                *param;
     uint16_t            msg_id;
 
+    /* Produces the payload blocks, when payload is not stored with the message */
+    sn_coap_payload_producer_cb producer;
+
     ns_list_link_t      link;
 } coap_blockwise_msg_s;
 
@@ -101,6 +127,18 @@ typedef struct coap_blockwise_payload_ {
 
 typedef NS_LIST_HEAD(coap_blockwise_payload_s, link) coap_blockwise_payload_list_t;
 
+#if SN_COAP_MEMORY_POOL_SMALL_BLOCKS || SN_COAP_MEMORY_POOL_LARGE_BLOCKS
+/* One size class of the internal memory pool, free blocks are linked through their first word */
+typedef struct coap_pool_class_ {
+    uint8_t             *blocks;
+    void                *free_list;
+    uint16_t            block_size;
+    uint16_t            block_count;
+    uint16_t            in_use;
+    uint16_t            high_water;
+} coap_pool_class_s;
+#endif
+
 struct coap_s {
     uint8_t sn_coap_resending_queue_msgs;
     uint8_t sn_coap_resending_count;
@@ -110,6 +148,8 @@ struct coap_s {
     uint16_t sn_coap_block_data_size;
     #if ENABLE_RESENDINGS
     uint16_t count_resent_msgs;
+    uint32_t retransmissions;   /* Messages sent again after a missing ACK */
+    uint32_t send_timeouts;     /* Messages which ran out of retransmissions */
     #endif
 #if SN_COAP_DUPLICATION_MAX_MSGS_COUNT
     uint16_t                      count_duplication_msgs;
@@ -123,10 +163,15 @@ struct coap_s {
 
     #if ENABLE_RESENDINGS /* If Message resending is not used at all, this part of code will not be compiled */
         coap_send_msg_list_t linked_list_resent_msgs; /* Active resending messages are stored to this Linked list */
+    #if SN_COAP_ADAPTIVE_RTO
+        coap_rto_peer_s      rto_peers[SN_COAP_ADAPTIVE_RTO_PEERS];
+    #endif
     #endif
 
     #if SN_COAP_DUPLICATION_MAX_MSGS_COUNT /* If Message duplication detection is not used at all, this part of code will not be compiled */
         coap_duplication_info_list_t  linked_list_duplication_msgs; /* Messages for duplicated messages detection is stored to this Linked list */
+        coap_duplication_info_s       **duplication_hash_table; /* Same messages hashed by port and Message ID, NULL if not allocated */
+        uint16_t                      duplication_hash_mask;
     #endif
 
     #if SN_COAP_BLOCKWISE_ENABLED || SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE /* If Message blockwise is not enabled, this part of code will not be compiled */
@@ -136,6 +181,12 @@ struct coap_s {
 
     uint32_t system_time;    /* System time seconds */
     uint32_t sn_coap_resending_queue_bytes;
+
+#if SN_COAP_MEMORY_POOL_SMALL_BLOCKS || SN_COAP_MEMORY_POOL_LARGE_BLOCKS
+    coap_pool_class_s pool_small;   /* Bookkeeping structures, addresses and tokens */
+    coap_pool_class_s pool_large;   /* Stored and temporary packets */
+    uint32_t          pool_misses;  /* Allocations which had to go to heap */
+#endif
 };
 
 /* Utility function which performs a call to sn_coap_protocol_malloc() and memset's the result to zero. */
@@ -144,6 +195,15 @@ void *sn_coap_protocol_calloc(struct coap_s *handle, uint_fast16_t length);
 /* Utility function which performs a call to sn_coap_protocol_malloc() and memcopy's the source to result buffer. */
 void *sn_coap_protocol_malloc_copy(struct coap_s *handle, const void *source, uint_fast16_t length);
 
+/* Allocation functions for memory which is owned by the library and never released by the user.
+ * These use the internal memory pool when it is enabled and fall back to sn_coap_protocol_malloc().
+ * Memory from these must be released with sn_coap_protocol_pool_free(), which accepts also NULL
+ * and pointers allocated with sn_coap_protocol_malloc(). */
+void *sn_coap_protocol_pool_malloc(struct coap_s *handle, uint_fast16_t length);
+void *sn_coap_protocol_pool_calloc(struct coap_s *handle, uint_fast16_t length);
+void *sn_coap_protocol_pool_malloc_copy(struct coap_s *handle, const void *source, uint_fast16_t length);
+void sn_coap_protocol_pool_free(struct coap_s *handle, void *ptr);
+
 #ifdef __cplusplus
 }
 #endif
@@ -36,6 +36,14 @@
 #include "mbed-trace/mbed_trace.h"
 
 #define TRACE_GROUP "coap"
+
+/* Walks the parts of a repeatable option given as one separated string */
+typedef struct sn_coap_option_parts_ {
+    const uint8_t *ptr;
+    const uint8_t *end;
+    uint8_t separator;
+    bool done;
+} sn_coap_option_parts_s;
 /* * * * LOCAL FUNCTION PROTOTYPES * * * */
 static uint8_t *sn_coap_builder_header_build(uint8_t *dst_packet_data_pptr, const sn_coap_hdr_s *src_coap_msg_ptr);
 static uint8_t *sn_coap_builder_options_build(uint8_t *dst_packet_data_ptr, const sn_coap_hdr_s *src_coap_msg_ptr);
@@ -44,9 +52,8 @@ static uint8_t *sn_coap_builder_options_build_add_one_option(uint8_t *dst_packet
 static uint8_t *sn_coap_builder_options_build_add_multiple_option(uint8_t *dst_packet_data_pptr, const uint8_t *src_pptr, uint_fast16_t src_len, sn_coap_option_numbers_e option, uint16_t *previous_option_number);
 static uint_fast8_t sn_coap_builder_options_calc_uint_option_size(uint32_t option_value);
 static uint8_t *sn_coap_builder_options_build_add_uint_option(uint8_t *dst_packet_data_ptr, uint32_t value, sn_coap_option_numbers_e option_number, uint16_t *previous_option_number);
-static uint_fast8_t  sn_coap_builder_options_get_option_part_count(uint_fast16_t query_len, const uint8_t *query_ptr, sn_coap_option_numbers_e option);
-static uint_fast16_t sn_coap_builder_options_get_option_part_length_from_whole_option_string(uint_fast16_t query_len, const uint8_t *query_ptr, uint_fast8_t query_index, sn_coap_option_numbers_e option);
-static int_fast16_t sn_coap_builder_options_get_option_part_position(uint_fast16_t query_len, const uint8_t *query_ptr, uint_fast8_t query_index, sn_coap_option_numbers_e option);
+static void sn_coap_builder_option_parts_init(sn_coap_option_parts_s *parts, uint_fast16_t option_len, const uint8_t *option_ptr, sn_coap_option_numbers_e option);
+static bool sn_coap_builder_option_parts_next(sn_coap_option_parts_s *parts, const uint8_t **part_ptr, uint_fast16_t *part_len);
 static uint8_t *sn_coap_builder_payload_build(uint8_t *dst_packet_data_ptr, const sn_coap_hdr_s *src_coap_msg_ptr);
 static uint_fast8_t sn_coap_builder_options_calculate_jump_need(const sn_coap_hdr_s *src_coap_msg_ptr);
 
@@ -808,25 +815,15 @@ static uint8_t *sn_coap_builder_options_build_add_multiple_option(uint8_t * rest
 {
     /* Check if there is option at all */
     if (src_pptr != NULL) {
-        const uint8_t * restrict query_ptr  = src_pptr;
-        uint_fast8_t query_part_count       = 0;
-        uint_fast16_t query_len             = src_len;
-        uint_fast8_t i                      = 0;
-        uint_fast16_t query_part_offset     = 0;
-
-        /* Get query part count */
-        query_part_count = sn_coap_builder_options_get_option_part_count(query_len, query_ptr, option);
+        sn_coap_option_parts_s parts;
+        const uint8_t *part_ptr;
+        uint_fast16_t part_len;
 
         /* * * * Options by adding all parts to option * * * */
-        for (i = 0; i < query_part_count; i++) {
-            /* Get length of query part */
-            uint_fast16_t one_query_part_len = sn_coap_builder_options_get_option_part_length_from_whole_option_string(query_len, query_ptr, i, option);
-
-            /* Get position of query part */
-            query_part_offset = sn_coap_builder_options_get_option_part_position(query_len, query_ptr, i, option);
-
+        sn_coap_builder_option_parts_init(&parts, src_len, src_pptr, option);
+        while (sn_coap_builder_option_parts_next(&parts, &part_ptr, &part_len)) {
             /* Add Uri-query's one part to Options */
-            dst_packet_data_ptr = sn_coap_builder_options_build_add_one_option(dst_packet_data_ptr, one_query_part_len, src_pptr + query_part_offset, option, previous_option_number);
+            dst_packet_data_ptr = sn_coap_builder_options_build_add_one_option(dst_packet_data_ptr, part_len, part_ptr, option, previous_option_number);
         }
     }
     /* Success */
@@ -847,19 +844,18 @@ static uint8_t *sn_coap_builder_options_build_add_multiple_option(uint8_t * rest
  */
 static uint_fast16_t sn_coap_builder_options_calc_option_size(uint16_t query_len, const uint8_t *query_ptr, sn_coap_option_numbers_e option)
 {
-    uint_fast8_t  query_part_count  = sn_coap_builder_options_get_option_part_count(query_len, query_ptr, option);
-    uint_fast8_t  i                 = 0;
+    sn_coap_option_parts_s parts;
+    const uint8_t *part_ptr;
+    uint_fast16_t one_query_part_len;
     uint_fast16_t ret_value         = 0;
 
     /* * * * * * * * * * * * * * * * * * * * * * * * */
     /* * * * Calculate Uri-query options length  * * */
     /* * * * * * * * * * * * * * * * * * * * * * * * */
-    for (i = 0; i < query_part_count; i++) {
+    sn_coap_builder_option_parts_init(&parts, query_len, query_ptr, option);
+    while (sn_coap_builder_option_parts_next(&parts, &part_ptr, &one_query_part_len)) {
         /* * * Length of Option number and Option value length * * */
 
-        /* Get length of Query part */
-        uint_fast16_t one_query_part_len = sn_coap_builder_options_get_option_part_length_from_whole_option_string(query_len, query_ptr, i, option);
-
         /* Check option length */
         switch (option) {
             case (COAP_OPTION_ETAG):            /* Length 1-8 */
@@ -916,159 +912,74 @@ static uint_fast16_t sn_coap_builder_options_calc_option_size(uint16_t query_len
 
 
 /**
- * \fn static uint8_t sn_coap_builder_options_get_option_part_count(uint16_t query_len, uint8_t *query_ptr, sn_coap_option_numbers_e option)
- *
- * \brief Gets query part count from whole option string
- *
- * \param query_len is length of whole Path
- *
- * \param *query_ptr is pointer to the start of whole Path
- *
- * \return Return value is count of query parts
- */
-static uint_fast8_t sn_coap_builder_options_get_option_part_count(uint_fast16_t query_len, const uint8_t *query_ptr, sn_coap_option_numbers_e option)
-{
-    if (query_len <= 2) {
-        return 1;
-    }
-
-    const uint8_t *query_end           = query_ptr + query_len - 1;
-    uint8_t       char_to_search       = '&';
-
-    if (option == COAP_OPTION_URI_PATH || option == COAP_OPTION_LOCATION_PATH) {
-        char_to_search = '/';
-    }
-
-    /* Loop whole query and search '\0' characters (not first and last char) */
-    uint_fast8_t  returned_query_count = 1;
-    query_ptr++;
-    do {
-        if (*query_ptr++ == char_to_search) { /* If match */
-            returned_query_count++;
-        }
-    } while (query_ptr < query_end);
-
-    return returned_query_count;
-}
-
-/**
- * \fn static uint16_t sn_coap_builder_options_get_option_part_length_from_whole_option_string(uint16_t query_len,
-                                                                             uint8_t *query_ptr,
-                                                                             uint8_t query_index, sn_coap_option_numbers_e option)
+ * \fn static void sn_coap_builder_option_parts_init(sn_coap_option_parts_s *parts, uint_fast16_t option_len, const uint8_t *option_ptr, sn_coap_option_numbers_e option)
  *
- * \brief Gets one's query part length from whole query string
+ * \brief Prepares walking the parts of a whole option string
  *
- * \param query_len is length of whole string
+ * Parts are separated by '/' for paths and by '&' otherwise. A separator at
+ * the start or at the end of the string does not start a new part, and there
+ * is always at least one part.
  *
- * \param *query_ptr is pointer to the start of whole string
+ * \param *parts is the walk state to initialize
  *
- * \param query_index is query part index to be found
+ * \param option_len is length of whole option string
  *
- * \param sn_coap_option_numbers_e option is option number of the option
+ * \param *option_ptr is pointer to the start of whole option string
  *
- * \return Return value is length of query part
+ * \param option is option number of the option
  */
-static uint_fast16_t sn_coap_builder_options_get_option_part_length_from_whole_option_string(uint_fast16_t query_len, const uint8_t *query_ptr,
-        uint_fast8_t query_index, sn_coap_option_numbers_e option)
+static void sn_coap_builder_option_parts_init(sn_coap_option_parts_s *parts, uint_fast16_t option_len, const uint8_t *option_ptr, sn_coap_option_numbers_e option)
 {
-    uint_fast16_t returned_query_part_len = 0;
-    uint_fast8_t  temp_query_index        = 0;
-    uint_fast16_t query_len_index         = 0;
-    uint_fast8_t  char_to_search          = '&';
-
+    parts->separator = '&';
     if (option == COAP_OPTION_URI_PATH || option == COAP_OPTION_LOCATION_PATH) {
-        char_to_search = '/';
+        parts->separator = '/';
     }
 
-    /* Loop whole query and search '\0' characters */
-    for (query_len_index = 0; query_len_index < query_len; query_len_index++) {
-        /* Store character to temp_char for helping debugging */
-        uint_fast8_t temp_char = *query_ptr;
-
-        /* If new query part starts */
-        if (temp_char == char_to_search && returned_query_part_len > 0) { /* returned_query_part_len > 0 is for querys which start with "\0" */
-            /* If query part index is wanted */
-            if (temp_query_index == query_index) {
-                /* Return length of query part */
-                return returned_query_part_len;
-            } else {
-                /* Reset length of query part because wanted query part finding continues*/
-                returned_query_part_len = 0;
-            }
-
-            /* Next query part is looped */
-            temp_query_index++;
-        } else if (temp_char != char_to_search) { /* Else if query part continues */
-            /* Increase query part length */
-            returned_query_part_len++;
-        }
+    parts->ptr = option_ptr;
+    parts->end = option_ptr + option_len;
+    parts->done = false;
 
-        query_ptr++;
+    if (option_len > 0 && option_ptr[0] == parts->separator) {
+        parts->ptr++;
+    }
+    if (option_len > 1 && option_ptr[option_len - 1] == parts->separator) {
+        parts->end--;
     }
-
-    /* Return length of query part in cases that query part does not finish to '\0' character (last query part can be like that) */
-    return returned_query_part_len;
 }
 
 /**
- * \fn static uint16_t sn_coap_builder_options_get_option_part_position(uint16_t query_len,
-                                                               uint8_t *query_ptr,
-                                                               uint8_t query_index, sn_coap_option_numbers_e option)
+ * \fn static bool sn_coap_builder_option_parts_next(sn_coap_option_parts_s *parts, const uint8_t **part_ptr, uint_fast16_t *part_len)
  *
- * \brief Gets query part position in whole query
+ * \brief Gets the next part of a whole option string
  *
- * \param query_len is length of whole query
+ * \param *parts is the walk state
  *
- * \param *query_ptr is pointer to the start of whole query
+ * \param **part_ptr is set to the start of the part
  *
- * \param query_index is query part index to be found
+ * \param *part_len is set to the length of the part
  *
- * \return Return value is position (= offset) of query part in whole query. In
- *         fail cases -1 is returned.
+ * \return Return value is false when all parts have been walked
  */
-static int_fast16_t sn_coap_builder_options_get_option_part_position(uint_fast16_t query_len, const uint8_t *query_ptr,
-        uint_fast8_t query_index, sn_coap_option_numbers_e option)
+static bool sn_coap_builder_option_parts_next(sn_coap_option_parts_s *parts, const uint8_t **part_ptr, uint_fast16_t *part_len)
 {
-    uint_fast16_t returned_query_part_offset = 0;
-    uint_fast8_t  temp_query_index           = 0;
-    uint_fast16_t query_len_index            = 0;
-    uint_fast8_t  char_to_search             = '&';
-
-    if (option == COAP_OPTION_URI_PATH || option == COAP_OPTION_LOCATION_PATH) {
-        char_to_search = '/';
+    if (parts->done) {
+        return false;
     }
 
-    if (query_index == 0) {
-        if (*query_ptr == 0 || *query_ptr == char_to_search) {
-            return 1;
-        } else {
-            return 0;
-        }
+    const uint8_t *separator_ptr = NULL;
+    if (parts->ptr < parts->end) {
+        separator_ptr = memchr(parts->ptr, parts->separator, parts->end - parts->ptr);
     }
 
-    /* Loop whole query and search separator characters */
-    for (query_len_index = 0; query_len_index < query_len; query_len_index++) {
-        /* Store character to temp_char for helping debugging */
-        uint_fast8_t temp_char = *query_ptr;
-
-        /* If new query part starts */
-        if (temp_char == char_to_search && returned_query_part_offset > 0) { /* returned_query_part_offset > 0 is for querys which start with searched char */
-            /* If query part index is wanted */
-            if (temp_query_index == (query_index - 1)) {
-                /* Return offset of query part */
-                return (returned_query_part_offset + 1); /* Plus one is for passing separator */
-            }
-
-            /* Next query part is looped */
-            temp_query_index++;
-        }
-
-        returned_query_part_offset++;
-
-        query_ptr++;
+    *part_ptr = parts->ptr;
+    if (separator_ptr) {
+        *part_len = separator_ptr - parts->ptr;
+        parts->ptr = separator_ptr + 1;
+    } else {
+        *part_len = parts->end - parts->ptr;
+        parts->done = true;
     }
-
-    return -1; //Dead code?
+    return true;
 }
 
 
@@ -70,6 +70,7 @@ int8_t sn_coap_header_validity_check(const sn_coap_hdr_s *src_coap_msg_ptr, coap
         case COAP_MSG_CODE_REQUEST_POST:
         case COAP_MSG_CODE_REQUEST_PUT:
         case COAP_MSG_CODE_REQUEST_DELETE:
+        case COAP_MSG_CODE_REQUEST_FETCH:
         case COAP_MSG_CODE_RESPONSE_CREATED:
         case COAP_MSG_CODE_RESPONSE_DELETED:
         case COAP_MSG_CODE_RESPONSE_VALID:
@@ -38,15 +38,32 @@
 #include "mbed-trace/mbed_trace.h"
 
 #define TRACE_GROUP "coap"
+
+/* Bump allocator for the parsed message fields, a NULL arena means separate heap allocations */
+typedef struct sn_coap_parser_arena_ {
+    sn_coap_options_list_s  *options_list_ptr;  /* Reserved options list, NULL if the message needs none */
+    uint8_t                 *next_ptr;
+    uint8_t                 *end_ptr;
+} sn_coap_parser_arena_s;
+
+#define SN_COAP_PARSER_ARENA_ALIGN(size)    (((size) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
+
 /* * * * * * * * * * * * * * * * * * * * */
 /* * * * LOCAL FUNCTION PROTOTYPES * * * */
 /* * * * * * * * * * * * * * * * * * * * */
 
 static const uint8_t *sn_coap_parser_header_parse(const uint8_t *packet_data_ptr, sn_coap_hdr_s *dst_coap_msg_ptr, coap_version_e *coap_version_ptr);
-static const uint8_t *sn_coap_parser_options_parse(const uint8_t *packet_data_ptr, struct coap_s *handle, sn_coap_hdr_s *dst_coap_msg_ptr, const uint8_t *packet_data_start_ptr, uint_fast16_t packet_len);
-static const uint8_t *sn_coap_parser_options_parse_multiple_options(const uint8_t *packet_data_ptr, struct coap_s *handle, uint_fast16_t packet_left_len,  uint8_t **dst_pptr, uint16_t *dst_len_ptr, sn_coap_option_numbers_e option, uint_fast16_t option_number_len);
+static const uint8_t *sn_coap_parser_options_parse(const uint8_t *packet_data_ptr, struct coap_s *handle, sn_coap_parser_arena_s *arena, sn_coap_hdr_s *dst_coap_msg_ptr, const uint8_t *packet_data_start_ptr, uint_fast16_t packet_len);
+static const uint8_t *sn_coap_parser_options_parse_multiple_options(const uint8_t *packet_data_ptr, struct coap_s *handle, sn_coap_parser_arena_s *arena, uint_fast16_t packet_left_len,  uint8_t **dst_pptr, uint16_t *dst_len_ptr, sn_coap_option_numbers_e option, uint_fast16_t option_number_len);
 static int            sn_coap_parser_options_count_needed_memory_multiple_option(const uint8_t *packet_data_ptr, uint_fast16_t packet_left_len, sn_coap_option_numbers_e option, uint_fast16_t option_number_len);
 static const uint8_t *sn_coap_parser_payload_parse(const uint8_t *packet_data_ptr, uint16_t packet_data_len, uint8_t *packet_data_start_ptr, sn_coap_hdr_s *dst_coap_msg_ptr);
+static void          *sn_coap_parser_alloc_data(struct coap_s *handle, sn_coap_parser_arena_s *arena, uint_fast16_t length);
+static void          *sn_coap_parser_copy_data(struct coap_s *handle, sn_coap_parser_arena_s *arena, const uint8_t *source, uint_fast16_t length);
+static sn_coap_options_list_s *sn_coap_parser_init_options(sn_coap_options_list_s *options_list_ptr);
+#if SN_COAP_PARSER_SINGLE_ALLOCATION
+static sn_coap_hdr_s *sn_coap_parser_alloc_arena_message(struct coap_s *handle, uint16_t packet_data_len, const uint8_t *packet_data_ptr, sn_coap_parser_arena_s *arena);
+static void           sn_coap_parser_release_arena_message(void (*local_free)(void *), sn_coap_hdr_s *freed_coap_msg_ptr);
+#endif
 
 sn_coap_hdr_s *sn_coap_parser_init_message(sn_coap_hdr_s *coap_msg_ptr)
 {
@@ -117,15 +134,22 @@ sn_coap_options_list_s *sn_coap_parser_alloc_options(struct coap_s *handle, sn_c
     }
 
     /* * * * Allocate memory for options and initialize allocated memory with with default values  * * * */
-    /* XXX not technically legal to memset pointers to 0 */
-    options_list_ptr = sn_coap_protocol_calloc(handle, sizeof(sn_coap_options_list_s));
+    options_list_ptr = handle->sn_coap_protocol_malloc(sizeof(sn_coap_options_list_s));
 
     if (options_list_ptr == NULL) {
         tr_error("sn_coap_parser_alloc_options - failed to allocate options list!");
         return NULL;
     }
 
-    coap_msg_ptr->options_list_ptr = options_list_ptr;
+    coap_msg_ptr->options_list_ptr = sn_coap_parser_init_options(options_list_ptr);
+
+    return options_list_ptr;
+}
+
+static sn_coap_options_list_s *sn_coap_parser_init_options(sn_coap_options_list_s *options_list_ptr)
+{
+    /* XXX not technically legal to memset pointers to 0 */
+    memset(options_list_ptr, 0x00, sizeof(sn_coap_options_list_s));
 
     options_list_ptr->uri_port = COAP_OPTION_URI_PORT_NONE;
     options_list_ptr->observe = COAP_OBSERVE_NONE;
@@ -136,18 +160,81 @@ sn_coap_options_list_s *sn_coap_parser_alloc_options(struct coap_s *handle, sn_c
     return options_list_ptr;
 }
 
+/**
+ * \brief Returns options list of a message being parsed, taking it from the arena if there is one
+ */
+static sn_coap_options_list_s *sn_coap_parser_get_options(struct coap_s *handle, sn_coap_parser_arena_s *arena, sn_coap_hdr_s *coap_msg_ptr)
+{
+    if (arena == NULL || coap_msg_ptr->options_list_ptr) {
+        return sn_coap_parser_alloc_options(handle, coap_msg_ptr);
+    }
+
+    if (arena->options_list_ptr == NULL) {
+        return NULL;
+    }
+
+    coap_msg_ptr->options_list_ptr = sn_coap_parser_init_options(arena->options_list_ptr);
+
+    return coap_msg_ptr->options_list_ptr;
+}
+
+/**
+ * \brief Allocates memory for a parsed field, from the arena if there is one and from heap otherwise
+ */
+static void *sn_coap_parser_alloc_data(struct coap_s *handle, sn_coap_parser_arena_s *arena, uint_fast16_t length)
+{
+    uint8_t *data_ptr;
+
+    if (arena == NULL) {
+        return handle->sn_coap_protocol_malloc(length);
+    }
+
+    if ((uint_fast16_t)(arena->end_ptr - arena->next_ptr) < length) {
+        return NULL;
+    }
+
+    data_ptr = arena->next_ptr;
+    arena->next_ptr += length;
+
+    return data_ptr;
+}
+
+static void *sn_coap_parser_copy_data(struct coap_s *handle, sn_coap_parser_arena_s *arena, const uint8_t *source, uint_fast16_t length)
+{
+    void *dest = sn_coap_parser_alloc_data(handle, arena, length);
+
+    if (dest) {
+        memcpy(dest, source, length);
+    }
+    return dest;
+}
+
 sn_coap_hdr_s *sn_coap_parser(struct coap_s *handle, uint16_t packet_data_len, uint8_t *packet_data_ptr, coap_version_e *coap_version_ptr)
 {
     const uint8_t *data_temp_ptr                    = packet_data_ptr;
     sn_coap_hdr_s *parsed_and_returned_coap_msg_ptr = NULL;
+    sn_coap_parser_arena_s *arena_ptr               = NULL;
+#if SN_COAP_PARSER_SINGLE_ALLOCATION
+    sn_coap_parser_arena_s arena;
+#endif
 
     /* * * * Check given pointer * * * */
     if (packet_data_ptr == NULL || packet_data_len < 4 || handle == NULL) {
         return NULL;
     }
 
+#if SN_COAP_PARSER_SINGLE_ALLOCATION
+    /* * * * Size the whole message and allocate it in one block  * * * */
+    parsed_and_returned_coap_msg_ptr = sn_coap_parser_alloc_arena_message(handle, packet_data_len, packet_data_ptr, &arena);
+    if (parsed_and_returned_coap_msg_ptr) {
+        arena_ptr = &arena;
+    }
+#endif
+
     /* * * * Allocate and initialize CoAP message  * * * */
-    parsed_and_returned_coap_msg_ptr = sn_coap_parser_alloc_message(handle);
+    if (parsed_and_returned_coap_msg_ptr == NULL) {
+        parsed_and_returned_coap_msg_ptr = sn_coap_parser_alloc_message(handle);
+    }
 
     if (parsed_and_returned_coap_msg_ptr == NULL) {
         tr_error("sn_coap_parser - failed to allocate message!");
@@ -158,7 +245,7 @@ sn_coap_hdr_s *sn_coap_parser(struct coap_s *handle, uint16_t packet_data_len, u
     data_temp_ptr = sn_coap_parser_header_parse(data_temp_ptr, parsed_and_returned_coap_msg_ptr, coap_version_ptr);
 
     /* * * * Options parsing, move pointer over the options... * * * */
-    data_temp_ptr = sn_coap_parser_options_parse(data_temp_ptr, handle, parsed_and_returned_coap_msg_ptr, packet_data_ptr, packet_data_len);
+    data_temp_ptr = sn_coap_parser_options_parse(data_temp_ptr, handle, arena_ptr, parsed_and_returned_coap_msg_ptr, packet_data_ptr, packet_data_len);
     if (!data_temp_ptr) {
         parsed_and_returned_coap_msg_ptr->coap_status = COAP_STATUS_PARSER_ERROR_IN_HEADER;
         return parsed_and_returned_coap_msg_ptr;
@@ -189,6 +276,13 @@ void sn_coap_parser_release_allocated_coap_msg_mem(struct coap_s *handle, sn_coa
         // saves one instruction per call.
         void (*local_free)(void *) = handle->sn_coap_protocol_free;
 
+#if SN_COAP_PARSER_SINGLE_ALLOCATION
+        if (freed_coap_msg_ptr->parser_arena_len) {
+            sn_coap_parser_release_arena_message(local_free, freed_coap_msg_ptr);
+            return;
+        }
+#endif
+
         local_free(freed_coap_msg_ptr->uri_path_ptr);
         local_free(freed_coap_msg_ptr->token_ptr);
 
@@ -447,6 +541,126 @@ static int_fast8_t parse_ext_option(uint_fast16_t *dst, const uint8_t * restrict
     return 0;
 }
 
+#if SN_COAP_PARSER_SINGLE_ALLOCATION
+/**
+ * \brief Counts the memory needed for the token and option values of a packet
+ *
+ * The count is an upper bound, as every option value is counted with one separator byte.
+ *
+ * \param *packet_data_ptr is start of the packet data
+ * \param packet_len is length of the packet data
+ * \param *options_needed is set to true if the message needs an options list
+ *
+ * \return Return value is the needed memory in bytes, or -1 if the packet is malformed
+ */
+static int_fast32_t sn_coap_parser_count_needed_arena_data(const uint8_t *packet_data_ptr, uint_fast16_t packet_len, bool *options_needed)
+{
+    const uint8_t *data_ptr       = packet_data_ptr;
+    uint_fast16_t option_number   = 0;
+    uint_fast16_t token_len       = *packet_data_ptr & COAP_HEADER_TOKEN_LENGTH_MASK;
+    int_fast32_t needed           = token_len;
+    uint_fast16_t message_left;
+
+    *options_needed = false;
+
+    sn_coap_parser_move_packet_ptr(&data_ptr, packet_data_ptr, packet_len, COAP_HEADER_LENGTH);
+    if (sn_coap_parser_check_packet_ptr(data_ptr, packet_data_ptr, packet_len, token_len) != 0) {
+        return -1;
+    }
+    message_left = sn_coap_parser_move_packet_ptr(&data_ptr, packet_data_ptr, packet_len, token_len);
+
+    while (message_left && *data_ptr != 0xff) {
+        uint_fast16_t option_delta = *data_ptr >> COAP_OPTIONS_OPTION_NUMBER_SHIFT;
+        uint_fast16_t option_len = *data_ptr & 0x0F;
+
+        message_left = sn_coap_parser_move_packet_ptr(&data_ptr, packet_data_ptr, packet_len, 1);
+        if (parse_ext_option(&option_delta, &data_ptr, packet_data_ptr, packet_len, &message_left) != 0 ||
+                parse_ext_option(&option_len, &data_ptr, packet_data_ptr, packet_len, &message_left) != 0 ||
+                sn_coap_parser_add_u16_limit(option_number, option_delta, &option_number) != 0 ||
+                message_left < option_len) {
+            return -1;
+        }
+
+        if (option_number != COAP_OPTION_URI_PATH && option_number != COAP_OPTION_CONTENT_FORMAT) {
+            *options_needed = true;
+        }
+
+        needed += option_len + 1;
+        message_left = sn_coap_parser_move_packet_ptr(&data_ptr, packet_data_ptr, packet_len, option_len);
+    }
+
+    return needed;
+}
+
+/**
+ * \brief Allocates a message and room for all of its parsed fields in one block
+ *
+ * \return Return value is the initialized message, or NULL if the packet should be parsed with separate allocations
+ */
+static sn_coap_hdr_s *sn_coap_parser_alloc_arena_message(struct coap_s *handle, uint16_t packet_data_len, const uint8_t *packet_data_ptr, sn_coap_parser_arena_s *arena)
+{
+    bool options_needed;
+    int_fast32_t data_len = sn_coap_parser_count_needed_arena_data(packet_data_ptr, packet_data_len, &options_needed);
+
+    /* Malformed packets are left for the normal path to report */
+    if (data_len < 0) {
+        return NULL;
+    }
+
+    uint_fast32_t header_size = SN_COAP_PARSER_ARENA_ALIGN(sizeof(sn_coap_hdr_s));
+    uint_fast32_t options_size = options_needed ? SN_COAP_PARSER_ARENA_ALIGN(sizeof(sn_coap_options_list_s)) : 0;
+    uint_fast32_t arena_len = header_size + options_size + data_len;
+
+    if (arena_len > UINT16_MAX) {
+        return NULL;
+    }
+
+    uint8_t *arena_block = handle->sn_coap_protocol_malloc(arena_len);
+    if (arena_block == NULL) {
+        return NULL;
+    }
+
+    sn_coap_hdr_s *coap_msg_ptr = sn_coap_parser_init_message((sn_coap_hdr_s *)arena_block);
+    coap_msg_ptr->parser_arena_len = arena_len;
+
+    arena->options_list_ptr = options_size ? (sn_coap_options_list_s *)(arena_block + header_size) : NULL;
+    arena->next_ptr = arena_block + header_size + options_size;
+    arena->end_ptr = arena_block + arena_len;
+
+    return coap_msg_ptr;
+}
+
+static void sn_coap_parser_release_arena_part(void (*local_free)(void *), const sn_coap_hdr_s *coap_msg_ptr, void *ptr)
+{
+    const uint8_t *arena_start = (const uint8_t *)coap_msg_ptr;
+
+    /* Fields replaced after parsing are allocated separately */
+    if ((uint8_t *)ptr < arena_start || (uint8_t *)ptr >= arena_start + coap_msg_ptr->parser_arena_len) {
+        local_free(ptr);
+    }
+}
+
+static void sn_coap_parser_release_arena_message(void (*local_free)(void *), sn_coap_hdr_s *freed_coap_msg_ptr)
+{
+    sn_coap_options_list_s *options_list_ptr = freed_coap_msg_ptr->options_list_ptr;
+
+    sn_coap_parser_release_arena_part(local_free, freed_coap_msg_ptr, freed_coap_msg_ptr->uri_path_ptr);
+    sn_coap_parser_release_arena_part(local_free, freed_coap_msg_ptr, freed_coap_msg_ptr->token_ptr);
+
+    if (options_list_ptr != NULL) {
+        sn_coap_parser_release_arena_part(local_free, freed_coap_msg_ptr, options_list_ptr->proxy_uri_ptr);
+        sn_coap_parser_release_arena_part(local_free, freed_coap_msg_ptr, options_list_ptr->etag_ptr);
+        sn_coap_parser_release_arena_part(local_free, freed_coap_msg_ptr, options_list_ptr->uri_host_ptr);
+        sn_coap_parser_release_arena_part(local_free, freed_coap_msg_ptr, options_list_ptr->location_path_ptr);
+        sn_coap_parser_release_arena_part(local_free, freed_coap_msg_ptr, options_list_ptr->location_query_ptr);
+        sn_coap_parser_release_arena_part(local_free, freed_coap_msg_ptr, options_list_ptr->uri_query_ptr);
+        sn_coap_parser_release_arena_part(local_free, freed_coap_msg_ptr, options_list_ptr);
+    }
+
+    local_free(freed_coap_msg_ptr);
+}
+#endif
+
 /**
  * \fn static uint8_t sn_coap_parser_options_parse(uint8_t **packet_data_pptr, sn_coap_hdr_s *dst_coap_msg_ptr)
  *
@@ -457,7 +671,7 @@ static int_fast8_t parse_ext_option(uint_fast16_t *dst, const uint8_t * restrict
  *
  * \return Return value is advanced input pointer in ok case and NULL in failure case
  */
-static const uint8_t * sn_coap_parser_options_parse(const uint8_t * restrict packet_data_ptr, struct coap_s * restrict handle, sn_coap_hdr_s * restrict dst_coap_msg_ptr, const uint8_t *packet_data_start_ptr, uint_fast16_t packet_len)
+static const uint8_t * sn_coap_parser_options_parse(const uint8_t * restrict packet_data_ptr, struct coap_s * restrict handle, sn_coap_parser_arena_s *arena, sn_coap_hdr_s * restrict dst_coap_msg_ptr, const uint8_t *packet_data_start_ptr, uint_fast16_t packet_len)
 {
     uint_fast16_t previous_option_number = 0;
     uint_fast16_t message_left           = sn_coap_parser_move_packet_ptr(&packet_data_ptr, packet_data_start_ptr, packet_len, 0);
@@ -478,7 +692,7 @@ static const uint8_t * sn_coap_parser_options_parse(const uint8_t * restrict pac
             return NULL;
         }
 
-        dst_coap_msg_ptr->token_ptr = sn_coap_protocol_malloc_copy(handle, packet_data_ptr, dst_coap_msg_ptr->token_len);
+        dst_coap_msg_ptr->token_ptr = sn_coap_parser_copy_data(handle, arena, packet_data_ptr, dst_coap_msg_ptr->token_len);
 
         if (dst_coap_msg_ptr->token_ptr == NULL) {
             tr_error("sn_coap_parser_options_parse - failed to allocate token!");
@@ -535,7 +749,7 @@ static const uint8_t * sn_coap_parser_options_parse(const uint8_t * restrict pac
             case COAP_OPTION_ACCEPT:
             case COAP_OPTION_SIZE1:
             case COAP_OPTION_SIZE2:
-                if (sn_coap_parser_alloc_options(handle, dst_coap_msg_ptr) == NULL) {
+                if (sn_coap_parser_get_options(handle, arena, dst_coap_msg_ptr) == NULL) {
                     tr_error("sn_coap_parser_options_parse - failed to allocate options!");
                     return NULL;
                 }
@@ -572,7 +786,7 @@ static const uint8_t * sn_coap_parser_options_parse(const uint8_t * restrict pac
                     return NULL;
                 }
                 dst_coap_msg_ptr->options_list_ptr->proxy_uri_len = option_len;
-                dst_coap_msg_ptr->options_list_ptr->proxy_uri_ptr = sn_coap_protocol_malloc_copy(handle, packet_data_ptr, option_len);
+                dst_coap_msg_ptr->options_list_ptr->proxy_uri_ptr = sn_coap_parser_copy_data(handle, arena, packet_data_ptr, option_len);
 
                 if (dst_coap_msg_ptr->options_list_ptr->proxy_uri_ptr == NULL) {
                     tr_error("sn_coap_parser_options_parse - COAP_OPTION_PROXY_URI allocation failed!");
@@ -588,7 +802,7 @@ static const uint8_t * sn_coap_parser_options_parse(const uint8_t * restrict pac
                 }
                 /* This is managed independently because User gives this option in one character table */
                 uint16_t len;
-                packet_data_ptr = sn_coap_parser_options_parse_multiple_options(packet_data_ptr, handle,
+                packet_data_ptr = sn_coap_parser_options_parse_multiple_options(packet_data_ptr, handle, arena,
                              message_left,
                              &dst_coap_msg_ptr->options_list_ptr->etag_ptr,
                              &len,
@@ -606,7 +820,7 @@ static const uint8_t * sn_coap_parser_options_parse(const uint8_t * restrict pac
                     return NULL;
                 }
                 dst_coap_msg_ptr->options_list_ptr->uri_host_len = option_len;
-                dst_coap_msg_ptr->options_list_ptr->uri_host_ptr = sn_coap_protocol_malloc_copy(handle, packet_data_ptr, option_len);
+                dst_coap_msg_ptr->options_list_ptr->uri_host_ptr = sn_coap_parser_copy_data(handle, arena, packet_data_ptr, option_len);
 
                 if (dst_coap_msg_ptr->options_list_ptr->uri_host_ptr == NULL) {
                     tr_error("sn_coap_parser_options_parse - COAP_OPTION_URI_HOST allocation failed!");
@@ -621,7 +835,7 @@ static const uint8_t * sn_coap_parser_options_parse(const uint8_t * restrict pac
                     return NULL;
                 }
                 /* This is managed independently because User gives this option in one character table */
-                packet_data_ptr = sn_coap_parser_options_parse_multiple_options(packet_data_ptr, handle, message_left,
+                packet_data_ptr = sn_coap_parser_options_parse_multiple_options(packet_data_ptr, handle, arena, message_left,
                              &dst_coap_msg_ptr->options_list_ptr->location_path_ptr, &dst_coap_msg_ptr->options_list_ptr->location_path_len,
                              COAP_OPTION_LOCATION_PATH, option_len);
                 if (!packet_data_ptr) {
@@ -643,7 +857,7 @@ static const uint8_t * sn_coap_parser_options_parse(const uint8_t * restrict pac
                     tr_error("sn_coap_parser_options_parse - COAP_OPTION_LOCATION_QUERY exists!");
                     return NULL;
                 }
-                packet_data_ptr = sn_coap_parser_options_parse_multiple_options(packet_data_ptr, handle, message_left,
+                packet_data_ptr = sn_coap_parser_options_parse_multiple_options(packet_data_ptr, handle, arena, message_left,
                              &dst_coap_msg_ptr->options_list_ptr->location_query_ptr, &dst_coap_msg_ptr->options_list_ptr->location_query_len,
                              COAP_OPTION_LOCATION_QUERY, option_len);
                 if (!packet_data_ptr) {
@@ -658,7 +872,7 @@ static const uint8_t * sn_coap_parser_options_parse(const uint8_t * restrict pac
                     tr_error("sn_coap_parser_options_parse - COAP_OPTION_URI_PATH exists!");
                     return NULL;
                 }
-                packet_data_ptr = sn_coap_parser_options_parse_multiple_options(packet_data_ptr, handle, message_left,
+                packet_data_ptr = sn_coap_parser_options_parse_multiple_options(packet_data_ptr, handle, arena, message_left,
                              &dst_coap_msg_ptr->uri_path_ptr, &dst_coap_msg_ptr->uri_path_len,
                              COAP_OPTION_URI_PATH, option_len);
                 if (!packet_data_ptr) {
@@ -676,7 +890,7 @@ static const uint8_t * sn_coap_parser_options_parse(const uint8_t * restrict pac
                 break;
 
             case COAP_OPTION_URI_QUERY:
-                packet_data_ptr = sn_coap_parser_options_parse_multiple_options(packet_data_ptr, handle, message_left,
+                packet_data_ptr = sn_coap_parser_options_parse_multiple_options(packet_data_ptr, handle, arena, message_left,
                              &dst_coap_msg_ptr->options_list_ptr->uri_query_ptr, &dst_coap_msg_ptr->options_list_ptr->uri_query_len,
                              COAP_OPTION_URI_QUERY, option_len);
                 if (!packet_data_ptr) {
@@ -758,7 +972,7 @@ static const uint8_t * sn_coap_parser_options_parse(const uint8_t * restrict pac
  *
  * \return Return value is advanced input pointer. In failure case NULL is returned.
 */
-static const uint8_t *sn_coap_parser_options_parse_multiple_options(const uint8_t * restrict packet_data_ptr, struct coap_s * restrict handle, uint_fast16_t packet_left_len,  uint8_t ** restrict dst_pptr, uint16_t * restrict dst_len_ptr, sn_coap_option_numbers_e option, uint_fast16_t option_number_len)
+static const uint8_t *sn_coap_parser_options_parse_multiple_options(const uint8_t * restrict packet_data_ptr, struct coap_s * restrict handle, sn_coap_parser_arena_s *arena, uint_fast16_t packet_left_len,  uint8_t ** restrict dst_pptr, uint16_t * restrict dst_len_ptr, sn_coap_option_numbers_e option, uint_fast16_t option_number_len)
 {
 
     int           uri_query_needed_heap       = sn_coap_parser_options_count_needed_memory_multiple_option(packet_data_ptr, packet_left_len, option, option_number_len);
@@ -772,7 +986,7 @@ static const uint8_t *sn_coap_parser_options_parse_multiple_options(const uint8_
     }
 
     if (uri_query_needed_heap) {
-        *dst_pptr = handle->sn_coap_protocol_malloc(uri_query_needed_heap);
+        *dst_pptr = sn_coap_parser_alloc_data(handle, arena, uri_query_needed_heap);
 
         if (*dst_pptr == NULL) {
             tr_error("sn_coap_parser_options_parse_multiple_options - failed to allocate options!");
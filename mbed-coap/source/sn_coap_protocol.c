@@ -51,36 +51,50 @@
 static void                  sn_coap_protocol_linked_list_duplication_info_store(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, uint16_t msg_id, void *param);
 static coap_duplication_info_s *sn_coap_protocol_linked_list_duplication_info_search(const struct coap_s *handle, const sn_nsdl_addr_s *scr_addr_ptr, const uint16_t msg_id);
 static void                  sn_coap_protocol_linked_list_duplication_info_remove_old_ones(struct coap_s *handle);
+static void                  sn_coap_protocol_linked_list_duplication_info_unlink(struct coap_s *handle, coap_duplication_info_s *duplication_info_ptr);
 static void                  sn_coap_protocol_duplication_info_free(struct coap_s *handle, coap_duplication_info_s *duplication_info_ptr);
-static bool                  sn_coap_protocol_update_duplicate_package_data(const struct coap_s *handle, const sn_nsdl_addr_s *dst_addr_ptr, const sn_coap_hdr_s *coap_msg_ptr, const int_fast16_t data_size, const uint8_t *dst_packet_data_ptr);
-static bool                  sn_coap_protocol_update_duplicate_package_data_all(const struct coap_s *handle, const sn_nsdl_addr_s *dst_addr_ptr, const sn_coap_hdr_s *coap_msg_ptr, const int_fast16_t data_size, const uint8_t *dst_packet_data_ptr);
+static void                  sn_coap_protocol_duplication_hash_table_resize(struct coap_s *handle);
+static bool                  sn_coap_protocol_update_duplicate_package_data(struct coap_s *handle, const sn_nsdl_addr_s *dst_addr_ptr, const sn_coap_hdr_s *coap_msg_ptr, const int_fast16_t data_size, const uint8_t *dst_packet_data_ptr);
+static bool                  sn_coap_protocol_update_duplicate_package_data_all(struct coap_s *handle, const sn_nsdl_addr_s *dst_addr_ptr, const sn_coap_hdr_s *coap_msg_ptr, const int_fast16_t data_size, const uint8_t *dst_packet_data_ptr);
 
 #endif
 
+static int16_t                  sn_coap_protocol_build_internal(struct coap_s *handle, sn_nsdl_addr_s *dst_addr_ptr, uint8_t *dst_packet_data_ptr, sn_coap_hdr_s *src_coap_msg_ptr, void *param, sn_coap_payload_producer_cb producer);
+
 #if SN_COAP_BLOCKWISE_ENABLED || SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE /* If Message blockwising is not enabled, this part of code will not be compiled */
 static void                     sn_coap_protocol_linked_list_blockwise_msg_remove(struct coap_s *handle, coap_blockwise_msg_s *removed_msg_ptr);
 static void                     sn_coap_protocol_linked_list_blockwise_payload_store(struct coap_s *handle, sn_nsdl_addr_s *addr_ptr, uint16_t payload_len, uint8_t *payload_ptr, uint8_t *token_ptr, uint8_t token_len, uint32_t block_number, uint16_t block_size, uint32_t size1);
-static uint8_t                  *sn_coap_protocol_linked_list_blockwise_payload_search(struct coap_s *handle, const sn_nsdl_addr_s *src_addr_ptr, uint16_t *payload_length, const uint8_t *token_ptr, uint8_t token_len);
 static coap_blockwise_payload_s *sn_coap_protocol_linked_list_blockwise_search(struct coap_s *handle, const sn_nsdl_addr_s *src_addr_ptr, const uint8_t *token_ptr, uint8_t token_len);
 static bool                     sn_coap_protocol_linked_list_blockwise_payload_search_compare_block_number(struct coap_s *handle, const sn_nsdl_addr_s *src_addr_ptr, const uint8_t *token_ptr, uint8_t token_len, uint32_t block_number);
 static void                     sn_coap_protocol_linked_list_blockwise_payload_remove(struct coap_s *handle, coap_blockwise_payload_s *removed_payload_ptr);
-static uint32_t                 sn_coap_protocol_linked_list_blockwise_payloads_get_len(struct coap_s *handle, const sn_nsdl_addr_s *src_addr_ptr, const uint8_t *token_ptr, uint8_t token_len);
 static void                     sn_coap_protocol_handle_blockwise_timeout(struct coap_s *handle);
 static sn_coap_hdr_s            *sn_coap_handle_blockwise_message(struct coap_s *handle, sn_nsdl_addr_s *src_addr_ptr, sn_coap_hdr_s *received_coap_msg_ptr, void *param, bool *keep_in_resend_queue);
 static bool                     sn_coap_handle_last_blockwise(struct coap_s *handle, const sn_nsdl_addr_s *src_addr_ptr, sn_coap_hdr_s *received_coap_msg_ptr);
 static sn_coap_hdr_s            *sn_coap_protocol_copy_header(struct coap_s *handle, const sn_coap_hdr_s *source_header_ptr);
 static coap_blockwise_msg_s     *search_sent_blockwise_message(struct coap_s *handle, uint16_t msg_id);
-static int16_t                  store_blockwise_copy(struct coap_s *handle, const sn_coap_hdr_s *src_coap_msg_ptr, void *param, uint16_t original_payload_len, bool copy_payload);
+static int16_t                  store_blockwise_copy(struct coap_s *handle, const sn_coap_hdr_s *src_coap_msg_ptr, void *param, uint16_t original_payload_len, bool copy_payload, sn_coap_payload_producer_cb producer);
 #endif
 
 #if ENABLE_RESENDINGS
-static uint8_t               sn_coap_protocol_linked_list_send_msg_store(struct coap_s *handle, sn_nsdl_addr_s *dst_addr_ptr, uint_fast16_t send_packet_data_len, uint8_t *send_packet_data_ptr, uint32_t sending_time, void *param);
+static uint8_t               sn_coap_protocol_linked_list_send_msg_store(struct coap_s *handle, sn_nsdl_addr_s *dst_addr_ptr, uint_fast16_t send_packet_data_len, uint8_t *send_packet_data_ptr, void *param, bool deferrable);
 static void                  sn_coap_protocol_linked_list_send_msg_remove(struct coap_s *handle, const sn_nsdl_addr_s *src_addr_ptr, uint16_t msg_id);
 static coap_send_msg_s      *sn_coap_protocol_allocate_mem_for_msg(struct coap_s *handle, sn_nsdl_addr_s *dst_addr_ptr, uint_fast16_t packet_data_len);
 static void                  sn_coap_protocol_release_allocated_send_msg_mem(struct coap_s *handle, coap_send_msg_s *freed_send_msg_ptr);
+static void                  sn_coap_protocol_linked_list_send_msg_insert(struct coap_s *handle, coap_send_msg_s *stored_msg_ptr);
 static uint_fast16_t         sn_coap_count_linked_list_size(const coap_send_msg_list_t *linked_list_ptr);
+static uint32_t              sn_coap_protocol_resend_time(struct coap_s *handle, const coap_send_msg_s *msg_ptr);
+#if SN_COAP_ADAPTIVE_RTO
+static coap_rto_peer_s      *sn_coap_protocol_rto_peer_get(struct coap_s *handle, const sn_nsdl_addr_s *addr_ptr);
+static uint16_t              sn_coap_protocol_rto_get(struct coap_s *handle, const sn_nsdl_addr_s *addr_ptr);
+static void                  sn_coap_protocol_rto_update(struct coap_s *handle, const coap_send_msg_s *msg_ptr);
+#else
 static uint32_t              sn_coap_calculate_new_resend_time(const uint32_t current_time, const uint8_t interval, const uint8_t counter);
 #endif
+#if SN_COAP_NSTART
+static uint_fast16_t         sn_coap_protocol_count_in_flight(struct coap_s *handle, const sn_nsdl_addr_s *addr_ptr);
+static void                  sn_coap_protocol_send_deferred(struct coap_s *handle);
+#endif
+#endif
 
 static uint16_t              read_packet_msg_id(const coap_send_msg_s *stored_msg);
 static uint16_t              get_new_message_id(void);
@@ -92,6 +106,31 @@ static bool                  compare_port(const sn_nsdl_addr_s *left, const sn_n
 /* * * * * * * * * * * * * * * * * */
 static uint16_t message_id;
 
+#if ENABLE_RESENDINGS && SN_COAP_ADAPTIVE_RTO
+#define SN_COAP_RTO_UNITS           8                           /* Adaptive RTO is kept in 1/8 seconds */
+#define SN_COAP_RTO_MIN             (1 * SN_COAP_RTO_UNITS)
+#define SN_COAP_RTO_MAX             (60 * SN_COAP_RTO_UNITS)
+#endif
+
+#if SN_COAP_MEMORY_POOL_SMALL_BLOCKS || SN_COAP_MEMORY_POOL_LARGE_BLOCKS
+/* Small blocks must hold any of the list structures and a pointer for the free list link */
+typedef union {
+    coap_send_msg_s             send_msg;
+    uint8_t                     duplication_info[sizeof(coap_duplication_info_s) + 16];
+    coap_blockwise_msg_s        blockwise_msg;
+    coap_blockwise_payload_s    blockwise_payload;
+    sn_nsdl_addr_s              address;
+    uint8_t                     ipv6_address[16];
+    void                        *link;
+} coap_pool_small_block_u;
+
+#define SN_COAP_POOL_ALIGN(size)    (((size) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
+
+static bool sn_coap_protocol_pool_class_init(struct coap_s *handle, coap_pool_class_s *pool, uint16_t block_size, uint16_t block_count);
+static void *sn_coap_protocol_pool_class_alloc(coap_pool_class_s *pool);
+static bool sn_coap_protocol_pool_class_free(coap_pool_class_s *pool, void *ptr);
+#endif
+
 int8_t sn_coap_protocol_destroy(struct coap_s *handle)
 {
     if (handle == NULL) {
@@ -110,6 +149,7 @@ int8_t sn_coap_protocol_destroy(struct coap_s *handle)
 
         sn_coap_protocol_duplication_info_free(handle, tmp);
     }
+    handle->sn_coap_protocol_free(handle->duplication_hash_table);
 
 #endif
 
@@ -121,6 +161,11 @@ int8_t sn_coap_protocol_destroy(struct coap_s *handle)
     sn_coap_protocol_clear_received_blockwise_messages(handle);
 #endif
 
+#if SN_COAP_MEMORY_POOL_SMALL_BLOCKS || SN_COAP_MEMORY_POOL_LARGE_BLOCKS
+    handle->sn_coap_protocol_free(handle->pool_small.blocks);
+    handle->sn_coap_protocol_free(handle->pool_large.blocks);
+#endif
+
     handle->sn_coap_protocol_free(handle);
     return 0;
 }
@@ -170,6 +215,7 @@ struct coap_s *sn_coap_protocol_init(void *(*used_malloc_func_ptr)(uint16_t), vo
     /* * * * Create Linked list for storing Duplication info * * * */
     ns_list_init(&handle->linked_list_duplication_msgs);
     handle->sn_coap_duplication_buffer_size = SN_COAP_DUPLICATION_MAX_MSGS_COUNT;
+    sn_coap_protocol_duplication_hash_table_resize(handle);
 #endif
 
 #if SN_COAP_BLOCKWISE_ENABLED || SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE /* If Message blockwising is not enabled, this part of code will not be compiled */
@@ -180,6 +226,20 @@ struct coap_s *sn_coap_protocol_init(void *(*used_malloc_func_ptr)(uint16_t), vo
 
 #endif /* ENABLE_RESENDINGS */
 
+#if SN_COAP_MEMORY_POOL_SMALL_BLOCKS || SN_COAP_MEMORY_POOL_LARGE_BLOCKS
+    /* Library works without the pool, every allocation is then just counted as a miss */
+    if (!sn_coap_protocol_pool_class_init(handle, &handle->pool_small,
+                                          SN_COAP_POOL_ALIGN(sizeof(coap_pool_small_block_u)),
+                                          SN_COAP_MEMORY_POOL_SMALL_BLOCKS)) {
+        tr_warn("sn_coap_protocol_init - failed to allocate small block pool");
+    }
+    if (!sn_coap_protocol_pool_class_init(handle, &handle->pool_large,
+                                          SN_COAP_POOL_ALIGN(SN_COAP_MEMORY_POOL_LARGE_BLOCK_SIZE),
+                                          SN_COAP_MEMORY_POOL_LARGE_BLOCKS)) {
+        tr_warn("sn_coap_protocol_init - failed to allocate large block pool");
+    }
+#endif
+
     message_id = 0;
     return handle;
 }
@@ -251,6 +311,7 @@ int8_t sn_coap_protocol_set_duplicate_buffer_size(struct coap_s *handle, uint8_t
     }
     if (message_count <= SN_COAP_MAX_ALLOWED_DUPLICATION_MESSAGE_COUNT) {
         handle->sn_coap_duplication_buffer_size = message_count;
+        sn_coap_protocol_duplication_hash_table_resize(handle);
         return 0;
     }
 #endif
@@ -273,6 +334,10 @@ int8_t sn_coap_protocol_set_retransmission_parameters(struct coap_s *handle,
         } else {
             handle->sn_coap_resending_intervall = resending_intervall;
         }
+#if SN_COAP_ADAPTIVE_RTO
+        /* New parameters are given when the network changes, measure from the new initial RTO */
+        memset(handle->rto_peers, 0, sizeof(handle->rto_peers));
+#endif
         return 0;
     }
 #endif
@@ -325,6 +390,9 @@ int8_t sn_coap_protocol_delete_retransmission(struct coap_s *handle, uint16_t ms
                 ns_list_remove(&handle->linked_list_resent_msgs, tmp);
                 --handle->count_resent_msgs;
                 sn_coap_protocol_release_allocated_send_msg_mem(handle, tmp);
+#if SN_COAP_NSTART
+                sn_coap_protocol_send_deferred(handle);
+#endif
                 return 0;
             }
         }
@@ -352,6 +420,9 @@ int8_t sn_coap_protocol_delete_retransmission_by_token(struct coap_s *handle, co
 
                 /* Free memory of stored message */
                 sn_coap_protocol_release_allocated_send_msg_mem(handle, stored_msg);
+#if SN_COAP_NSTART
+                sn_coap_protocol_send_deferred(handle);
+#endif
                 return 0;
             }
         }
@@ -411,10 +482,44 @@ int8_t prepare_blockwise_message(struct coap_s *handle, sn_coap_hdr_s *src_coap_
 
 int16_t sn_coap_protocol_build(struct coap_s *handle, sn_nsdl_addr_s *dst_addr_ptr,
                                uint8_t *dst_packet_data_ptr, sn_coap_hdr_s *src_coap_msg_ptr, void *param)
+{
+    return sn_coap_protocol_build_internal(handle, dst_addr_ptr, dst_packet_data_ptr, src_coap_msg_ptr, param, NULL);
+}
+
+int16_t sn_coap_protocol_build_stream(struct coap_s *handle, sn_nsdl_addr_s *dst_addr_ptr, uint8_t *dst_packet_data_ptr, sn_coap_hdr_s *src_coap_msg_ptr,
+                                      sn_coap_payload_producer_cb producer, void *param)
+{
+#if SN_COAP_BLOCKWISE_ENABLED || SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE
+    if ((handle == NULL) || (src_coap_msg_ptr == NULL) || (producer == NULL) ||
+            (handle->sn_coap_block_data_size == 0) ||
+            (src_coap_msg_ptr->msg_code > COAP_MSG_CODE_REQUEST_DELETE) ||
+            (src_coap_msg_ptr->payload_len != handle->sn_coap_block_data_size) ||
+            (src_coap_msg_ptr->options_list_ptr == NULL) ||
+            !(src_coap_msg_ptr->options_list_ptr->block1 & 0x08)) {
+        return -2;
+    }
+
+    return sn_coap_protocol_build_internal(handle, dst_addr_ptr, dst_packet_data_ptr, src_coap_msg_ptr, param, producer);
+#else
+    (void) handle;
+    (void) dst_addr_ptr;
+    (void) dst_packet_data_ptr;
+    (void) src_coap_msg_ptr;
+    (void) producer;
+    (void) param;
+    return -2;
+#endif
+}
+
+static int16_t sn_coap_protocol_build_internal(struct coap_s *handle, sn_nsdl_addr_s *dst_addr_ptr, uint8_t *dst_packet_data_ptr,
+                                               sn_coap_hdr_s *src_coap_msg_ptr, void *param, sn_coap_payload_producer_cb producer)
 {
     int16_t  byte_count_built     = 0;
 #if SN_COAP_BLOCKWISE_ENABLED || SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE /* If Message blockwising is not enabled, this part of code will not be compiled */
     uint16_t original_payload_len = 0;
+#endif
+#if ENABLE_RESENDINGS && SN_COAP_NSTART
+    bool deferred = false;
 #endif
     /* * * * Check given pointers  * * * */
     if ((dst_addr_ptr == NULL) || (dst_packet_data_ptr == NULL) || (src_coap_msg_ptr == NULL) || handle == NULL) {
@@ -462,12 +567,14 @@ int16_t sn_coap_protocol_build(struct coap_s *handle, sn_nsdl_addr_s *dst_addr_p
     /* Check if built Message type was confirmable, only these messages are resent */
     if (src_coap_msg_ptr->msg_type == COAP_MSG_TYPE_CONFIRMABLE) {
         /* Store message to Linked list for resending purposes */
-        uint32_t resend_time = sn_coap_calculate_new_resend_time(handle->system_time, handle->sn_coap_resending_intervall, 0);
-        if (sn_coap_protocol_linked_list_send_msg_store(handle, dst_addr_ptr, byte_count_built, dst_packet_data_ptr,
-                                                        resend_time,
-                                                        param) == 0) {
+        uint8_t stored = sn_coap_protocol_linked_list_send_msg_store(handle, dst_addr_ptr, byte_count_built, dst_packet_data_ptr,
+                                                                     param, true);
+        if (stored == 0) {
             return -4;
         }
+#if SN_COAP_NSTART
+        deferred = (stored == 2);
+#endif
     }
 
 #endif /* ENABLE_RESENDINGS */
@@ -490,7 +597,7 @@ int16_t sn_coap_protocol_build(struct coap_s *handle, sn_nsdl_addr_s *dst_addr_p
         /* * * * Manage rest blockwise messages sending by storing them to Linked list * * * */
         /* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
-        int status = store_blockwise_copy(handle, src_coap_msg_ptr, param, original_payload_len, true);
+        int status = store_blockwise_copy(handle, src_coap_msg_ptr, param, original_payload_len, true, NULL);
         if (status < 0) {
             return status;
         }
@@ -498,7 +605,7 @@ int16_t sn_coap_protocol_build(struct coap_s *handle, sn_nsdl_addr_s *dst_addr_p
     } else if (src_coap_msg_ptr->msg_code <= COAP_MSG_CODE_REQUEST_DELETE &&
                src_coap_msg_ptr->msg_code != COAP_MSG_CODE_EMPTY) {
 
-        int status = store_blockwise_copy(handle, src_coap_msg_ptr, param, original_payload_len, false);
+        int status = store_blockwise_copy(handle, src_coap_msg_ptr, param, original_payload_len, false, producer);
         if (status < 0) {
             return status;
         }
@@ -506,16 +613,23 @@ int16_t sn_coap_protocol_build(struct coap_s *handle, sn_nsdl_addr_s *dst_addr_p
 
 #endif /* SN_COAP_BLOCKWISE_ENABLED || SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE */
 
+#if ENABLE_RESENDINGS && SN_COAP_NSTART
+    /* In-flight window is full, the library sends the message later */
+    if (deferred) {
+        return 0;
+    }
+#endif
+
     /* * * * Return built CoAP message Packet data length  * * * */
     return byte_count_built;
 }
 
 #if SN_COAP_BLOCKWISE_ENABLED || SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE
-static int16_t store_blockwise_copy(struct coap_s *handle, const sn_coap_hdr_s *src_coap_msg_ptr, void *param, uint16_t original_payload_len, bool copy_payload)
+static int16_t store_blockwise_copy(struct coap_s *handle, const sn_coap_hdr_s *src_coap_msg_ptr, void *param, uint16_t original_payload_len, bool copy_payload, sn_coap_payload_producer_cb producer)
 {
     coap_blockwise_msg_s *restrict stored_blockwise_msg_ptr;
 
-    stored_blockwise_msg_ptr = sn_coap_protocol_calloc(handle, sizeof(coap_blockwise_msg_s));
+    stored_blockwise_msg_ptr = sn_coap_protocol_pool_calloc(handle, sizeof(coap_blockwise_msg_s));
     if (!stored_blockwise_msg_ptr) {
         //block payload save failed, only first block can be build. Perhaps we should return error.
         tr_error("sn_coap_protocol_build - blockwise message allocation failed!");
@@ -527,7 +641,7 @@ static int16_t store_blockwise_copy(struct coap_s *handle, const sn_coap_hdr_s *
 
     sn_coap_hdr_s *restrict copied_msg_ptr = sn_coap_protocol_copy_header(handle, src_coap_msg_ptr);
     if (copied_msg_ptr == NULL) {
-        handle->sn_coap_protocol_free(stored_blockwise_msg_ptr);
+        sn_coap_protocol_pool_free(handle, stored_blockwise_msg_ptr);
         tr_error("sn_coap_protocol_build - block header copy failed!");
         return -2;
     }
@@ -540,7 +654,7 @@ static int16_t store_blockwise_copy(struct coap_s *handle, const sn_coap_hdr_s *
         if (!copied_msg_ptr->payload_ptr) {
             //block payload save failed, only first block can be build. Perhaps we should return error.
             sn_coap_parser_release_allocated_coap_msg_mem(handle, copied_msg_ptr);
-            handle->sn_coap_protocol_free(stored_blockwise_msg_ptr);
+            sn_coap_protocol_pool_free(handle, stored_blockwise_msg_ptr);
             tr_error("sn_coap_protocol_build - block payload allocation failed!");
             return -2;
         }
@@ -548,6 +662,7 @@ static int16_t store_blockwise_copy(struct coap_s *handle, const sn_coap_hdr_s *
 
     stored_blockwise_msg_ptr->param = param;
     stored_blockwise_msg_ptr->msg_id = copied_msg_ptr->msg_id;
+    stored_blockwise_msg_ptr->producer = producer;
 
     ns_list_add_to_end(&handle->linked_list_blockwise_sent_msgs, stored_blockwise_msg_ptr);
 
@@ -657,14 +772,9 @@ sn_coap_hdr_s *sn_coap_protocol_parse(struct coap_s *restrict handle, sn_nsdl_ad
             if (stored_duplication_msgs_count >= handle->sn_coap_duplication_buffer_size) {
                 tr_debug("sn_coap_protocol_parse - duplicate list full, dropping oldest");
 
-                // Get oldest stored duplication message
-                coap_duplication_info_s *stored_duplication_info_ptr = ns_list_get_first(&handle->linked_list_duplication_msgs);
-
                 // Remove oldest stored duplication message for getting room for new duplication message
-                sn_coap_protocol_linked_list_duplication_info_remove(handle,
-                                                                     stored_duplication_info_ptr->address->addr_ptr,
-                                                                     stored_duplication_info_ptr->address->port,
-                                                                     stored_duplication_info_ptr->msg_id);
+                sn_coap_protocol_linked_list_duplication_info_unlink(handle,
+                                                                     ns_list_get_first(&handle->linked_list_duplication_msgs));
             }
 
             // Store Duplication info to Linked list
@@ -679,7 +789,7 @@ sn_coap_hdr_s *sn_coap_protocol_parse(struct coap_s *restrict handle, sn_nsdl_ad
                 if (response->packet_ptr) {
                     tr_debug("sn_coap_protocol_parse - send ack for duplicate message");
                     handle->sn_coap_tx_callback(response->packet_ptr,
-                                                response->packet_len, response->address, response->param);
+                                                response->packet_len, &response->address, response->param);
                 } else {
                     tr_error("sn_coap_protocol_parse - response not yet build");
                 }
@@ -739,7 +849,7 @@ sn_coap_hdr_s *sn_coap_protocol_parse(struct coap_s *restrict handle, sn_nsdl_ad
 
         packet_data_size = sn_coap_builder_calc_needed_packet_data_size_2(resp, handle->sn_coap_block_data_size);
 
-        packet_data_ptr = handle->sn_coap_protocol_malloc(packet_data_size);
+        packet_data_ptr = sn_coap_protocol_pool_malloc(handle, packet_data_size);
 
         if (packet_data_ptr == NULL) {
             tr_error("sn_coap_protocol_parse - payload too large, failed to allocate buffer!");
@@ -763,7 +873,7 @@ sn_coap_hdr_s *sn_coap_protocol_parse(struct coap_s *restrict handle, sn_nsdl_ad
 
         handle->sn_coap_tx_callback(packet_data_ptr, packet_data_size, src_addr_ptr, param);
 
-        handle->sn_coap_protocol_free(packet_data_ptr);
+        sn_coap_protocol_pool_free(handle, packet_data_ptr);
 
         returned_dst_coap_msg_ptr->coap_status = COAP_STATUS_PARSER_BLOCKWISE_MSG_RECEIVING;
 
@@ -772,7 +882,7 @@ sn_coap_hdr_s *sn_coap_protocol_parse(struct coap_s *restrict handle, sn_nsdl_ad
 cleanup:
         sn_coap_parser_release_allocated_coap_msg_mem(handle, resp);
         sn_coap_parser_release_allocated_coap_msg_mem(handle, returned_dst_coap_msg_ptr);
-        handle->sn_coap_protocol_free(packet_data_ptr);
+        sn_coap_protocol_pool_free(handle, packet_data_ptr);
         return NULL;
 
     } else if (returned_dst_coap_msg_ptr->msg_code != COAP_MSG_CODE_EMPTY) {
@@ -850,69 +960,120 @@ int8_t sn_coap_protocol_exec(struct coap_s *handle, uint32_t current_time)
 #endif
 
 #if ENABLE_RESENDINGS
-    /* Check if there is ongoing active message sendings */
-    /* foreach_safe isn't sufficient because callback routine could cancel messages. */
-rescan:
-    ns_list_foreach(coap_send_msg_s, stored_msg_ptr, &handle->linked_list_resent_msgs) {
-        // First check that msg belongs to handle
-        /* Check if it is time to send this message */
-        if (current_time >= stored_msg_ptr->resending_time) {
-            /* * * Increase Resending counter  * * */
-            stored_msg_ptr->resending_counter++;
+    /* Resending list is kept in resending time order, so only the head needs to be checked. */
+    /* Callback routine could cancel messages, so the head is fetched again on every round. */
+    coap_send_msg_s *stored_msg_ptr;
+    while ((stored_msg_ptr = ns_list_get_first(&handle->linked_list_resent_msgs)) != NULL &&
+            current_time >= stored_msg_ptr->resending_time) {
+        /* * * Increase Resending counter  * * */
+        stored_msg_ptr->resending_counter++;
 
-            /* Check if all re-sendings have been done */
-            if (stored_msg_ptr->resending_counter > handle->sn_coap_resending_count) {
-                coap_version_e coap_version = COAP_VERSION_UNKNOWN;
+        /* Check if all re-sendings have been done */
+        if (stored_msg_ptr->resending_counter > handle->sn_coap_resending_count) {
+            coap_version_e coap_version = COAP_VERSION_UNKNOWN;
 
+            handle->send_timeouts++;
 
-                /* Remove message from Linked list */
-                ns_list_remove(&handle->linked_list_resent_msgs, stored_msg_ptr);
-                --handle->count_resent_msgs;
 
-                /* If RX callback have been defined.. */
-                if (handle->sn_coap_rx_callback != 0) {
-                    sn_coap_hdr_s *tmp_coap_hdr_ptr;
-                    /* Parse CoAP message, set status and call RX callback */
-                    tmp_coap_hdr_ptr = sn_coap_parser(handle, stored_msg_ptr->send_msg_ptr.packet_len, stored_msg_ptr->send_msg_ptr.packet_ptr, &coap_version);
+            /* Remove message from Linked list */
+            ns_list_remove(&handle->linked_list_resent_msgs, stored_msg_ptr);
+            --handle->count_resent_msgs;
+
+            /* If RX callback have been defined.. */
+            if (handle->sn_coap_rx_callback != 0) {
+                sn_coap_hdr_s *tmp_coap_hdr_ptr;
+                /* Parse CoAP message, set status and call RX callback */
+                tmp_coap_hdr_ptr = sn_coap_parser(handle, stored_msg_ptr->send_msg_ptr.packet_len, stored_msg_ptr->send_msg_ptr.packet_ptr, &coap_version);
 
-                    if (tmp_coap_hdr_ptr != 0) {
+                if (tmp_coap_hdr_ptr != 0) {
 #if SN_COAP_BLOCKWISE_ENABLED || SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE
-                        sn_coap_protocol_remove_sent_blockwise_message(handle, tmp_coap_hdr_ptr->msg_id);
+                    sn_coap_protocol_remove_sent_blockwise_message(handle, tmp_coap_hdr_ptr->msg_id);
 #endif // SN_COAP_BLOCKWISE_ENABLED || SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE
-                        tmp_coap_hdr_ptr->coap_status = COAP_STATUS_BUILDER_MESSAGE_SENDING_FAILED;
-                        handle->sn_coap_rx_callback(tmp_coap_hdr_ptr, &stored_msg_ptr->send_msg_ptr.dst_addr_ptr, stored_msg_ptr->param);
+                    tmp_coap_hdr_ptr->coap_status = COAP_STATUS_BUILDER_MESSAGE_SENDING_FAILED;
+                    handle->sn_coap_rx_callback(tmp_coap_hdr_ptr, &stored_msg_ptr->send_msg_ptr.dst_addr_ptr, stored_msg_ptr->param);
 
-                        sn_coap_parser_release_allocated_coap_msg_mem(handle, tmp_coap_hdr_ptr);
-                    }
+                    sn_coap_parser_release_allocated_coap_msg_mem(handle, tmp_coap_hdr_ptr);
                 }
-
-                /* Free memory of stored message */
-                sn_coap_protocol_release_allocated_send_msg_mem(handle, stored_msg_ptr);
-            } else {
-                /* Send message  */
-                handle->sn_coap_tx_callback(stored_msg_ptr->send_msg_ptr.packet_ptr,
-                                            stored_msg_ptr->send_msg_ptr.packet_len, &stored_msg_ptr->send_msg_ptr.dst_addr_ptr, stored_msg_ptr->param);
-
-                /* * * Count new Resending time  * * */
-                stored_msg_ptr->resending_time = sn_coap_calculate_new_resend_time(current_time,
-                                                                                   handle->sn_coap_resending_intervall,
-                                                                                   stored_msg_ptr->resending_counter);
             }
-            /* Callback routine could have wiped the list (eg as a response to sending failed) */
-            /* Be super cautious and rescan from the start */
-            goto rescan;
+
+            /* Free memory of stored message */
+            sn_coap_protocol_release_allocated_send_msg_mem(handle, stored_msg_ptr);
+        } else {
+            /* * * Count new Resending time and move the message to its new place * * */
+            /* This is done before sending, as the callback routine could cancel the message */
+            stored_msg_ptr->resending_time = sn_coap_protocol_resend_time(handle, stored_msg_ptr);
+            ns_list_remove(&handle->linked_list_resent_msgs, stored_msg_ptr);
+            sn_coap_protocol_linked_list_send_msg_insert(handle, stored_msg_ptr);
+
+            /* Send message  */
+            handle->retransmissions++;
+            handle->sn_coap_tx_callback(stored_msg_ptr->send_msg_ptr.packet_ptr,
+                                        stored_msg_ptr->send_msg_ptr.packet_len, &stored_msg_ptr->send_msg_ptr.dst_addr_ptr, stored_msg_ptr->param);
         }
     }
 
+#if SN_COAP_NSTART
+    /* Exchanges which ran out of retransmissions made room in the window */
+    sn_coap_protocol_send_deferred(handle);
+#endif
+
 #endif /* ENABLE_RESENDINGS */
 
     return 0;
 }
 
+int8_t sn_coap_protocol_set_time(struct coap_s *handle, uint32_t current_time)
+{
+    if (!handle) {
+        return -1;
+    }
+
+    handle->system_time = current_time;
+    return 0;
+}
+
+uint32_t sn_coap_protocol_get_next_exec_time(struct coap_s *handle)
+{
+    uint32_t next_time = UINT32_MAX;
+
+    if (!handle) {
+        return next_time;
+    }
+
+#if SN_COAP_BLOCKWISE_ENABLED || SN_COAP_MAX_BLOCKWISE_PAYLOAD_SIZE
+    /* Blockwise payloads are refreshed in place, but there are only a few of them */
+    ns_list_foreach(coap_blockwise_payload_s, payload_ptr, &handle->linked_list_blockwise_received_payloads) {
+        uint32_t timeout = payload_ptr->timestamp + SN_COAP_BLOCKWISE_MAX_TIME_DATA_STORED + 1;
+        if (timeout < next_time) {
+            next_time = timeout;
+        }
+    }
+#endif
+
+#if SN_COAP_DUPLICATION_MAX_MSGS_COUNT
+    coap_duplication_info_s *duplication_info_ptr = ns_list_get_first(&handle->linked_list_duplication_msgs);
+    if (duplication_info_ptr) {
+        uint32_t timeout = duplication_info_ptr->timestamp + SN_COAP_DUPLICATION_MAX_TIME_MSGS_STORED + 1;
+        if (timeout < next_time) {
+            next_time = timeout;
+        }
+    }
+#endif
+
+#if ENABLE_RESENDINGS
+    coap_send_msg_s *stored_msg_ptr = ns_list_get_first(&handle->linked_list_resent_msgs);
+    if (stored_msg_ptr && stored_msg_ptr->resending_time < next_time) {
+        next_time = stored_msg_ptr->resending_time;
+    }
+#endif
+
+    return next_time;
+}
+
 #if ENABLE_RESENDINGS  /* If Message resending is not used at all, this part of code will not be compiled */
 
 /**************************************************************************//**
- * \fn static uint8_t sn_coap_protocol_linked_list_send_msg_store(sn_nsdl_addr_s *dst_addr_ptr, uint16_t send_packet_data_len, uint8_t *send_packet_data_ptr, uint32_t sending_time)
+ * \fn static uint8_t sn_coap_protocol_linked_list_send_msg_store(sn_nsdl_addr_s *dst_addr_ptr, uint16_t send_packet_data_len, uint8_t *send_packet_data_ptr, void *param, bool deferrable)
  *
  * \brief Stores message to Linked list for sending purposes.
 
@@ -922,15 +1083,17 @@ rescan:
  *
  * \param *send_packet_data_ptr is Packet data to be stored
  *
- * \param sending_time is stored sending time
+ * \param deferrable tells if the message has not been sent yet and may wait for room in the in-flight window
  *
  * \return 0 Allocation or buffer limit reached
  *
  * \return 1 Msg stored properly
+ *
+ * \return 2 Msg stored, but not to be sent before the library does it
  *****************************************************************************/
 
 static uint8_t sn_coap_protocol_linked_list_send_msg_store(struct coap_s *restrict handle, sn_nsdl_addr_s *restrict dst_addr_ptr, uint_fast16_t send_packet_data_len,
-                                                           uint8_t *restrict send_packet_data_ptr, uint32_t sending_time, void *param)
+                                                           uint8_t *restrict send_packet_data_ptr, void *param, bool deferrable)
 {
 
     coap_send_msg_s *restrict stored_msg_ptr;
@@ -965,7 +1128,6 @@ static uint8_t sn_coap_protocol_linked_list_send_msg_store(struct coap_s *restri
 
     /* Filling of coap_send_msg_s with initialization values */
     stored_msg_ptr->resending_counter = 0;
-    stored_msg_ptr->resending_time = sending_time;
 
     /* Filling of sn_nsdl_transmit_s */
     stored_msg_ptr->send_msg_ptr.protocol = SN_NSDL_PROTOCOL_COAP;
@@ -980,12 +1142,51 @@ static uint8_t sn_coap_protocol_linked_list_send_msg_store(struct coap_s *restri
 
     stored_msg_ptr->param = param;
 
+#if SN_COAP_NSTART
+    stored_msg_ptr->deferred = deferrable &&
+                               sn_coap_protocol_count_in_flight(handle, dst_addr_ptr) >= SN_COAP_NSTART;
+#else
+    (void)deferrable;
+#endif
+#if SN_COAP_ADAPTIVE_RTO
+    stored_msg_ptr->sent_time = handle->system_time;
+    stored_msg_ptr->rto = sn_coap_protocol_rto_get(handle, dst_addr_ptr);
+#endif
+    stored_msg_ptr->resending_time = sn_coap_protocol_resend_time(handle, stored_msg_ptr);
+
     /* Storing Resending message to Linked list */
-    ns_list_add_to_end(&handle->linked_list_resent_msgs, stored_msg_ptr);
+    sn_coap_protocol_linked_list_send_msg_insert(handle, stored_msg_ptr);
     ++handle->count_resent_msgs;
+#if SN_COAP_NSTART
+    if (stored_msg_ptr->deferred) {
+        return 2;
+    }
+#endif
     return 1;
 }
 
+/**************************************************************************//**
+ * \fn static void sn_coap_protocol_linked_list_send_msg_insert(struct coap_s *handle, coap_send_msg_s *stored_msg_ptr)
+ *
+ * \brief Inserts message to resending list, keeping the list in resending time order.
+ *        Messages with equal resending time keep their insertion order.
+ *
+ * \param *stored_msg_ptr is the message to be inserted
+ *****************************************************************************/
+
+static void sn_coap_protocol_linked_list_send_msg_insert(struct coap_s *handle, coap_send_msg_s *stored_msg_ptr)
+{
+    /* New messages are normally due last, so search from the end */
+    ns_list_foreach_reverse(coap_send_msg_s, msg_ptr, &handle->linked_list_resent_msgs) {
+        if (msg_ptr->resending_time <= stored_msg_ptr->resending_time) {
+            ns_list_add_after(&handle->linked_list_resent_msgs, msg_ptr, stored_msg_ptr);
+            return;
+        }
+    }
+
+    ns_list_add_to_start(&handle->linked_list_resent_msgs, stored_msg_ptr);
+}
+
 
 /**************************************************************************//**
  * \fn static void sn_coap_protocol_linked_list_send_msg_remove(sn_nsdl_addr_s *src_addr_ptr, uint16_t msg_id)
@@ -1012,21 +1213,271 @@ static void sn_coap_protocol_linked_list_send_msg_remove(struct coap_s *restrict
                 ns_list_remove(&handle->linked_list_resent_msgs, stored_msg_ptr);
                 --handle->count_resent_msgs;
 
+#if SN_COAP_ADAPTIVE_RTO
+#if SN_COAP_NSTART
+                if (!stored_msg_ptr->deferred)
+#endif
+                {
+                    sn_coap_protocol_rto_update(handle, stored_msg_ptr);
+                }
+#endif
+
                 /* Free memory of stored message */
                 sn_coap_protocol_release_allocated_send_msg_mem(handle, stored_msg_ptr);
 
+#if SN_COAP_NSTART
+                sn_coap_protocol_send_deferred(handle);
+#endif
                 return;
             }
         }
     }
 }
 
+#if !SN_COAP_ADAPTIVE_RTO
 uint32_t sn_coap_calculate_new_resend_time(const uint32_t current_time, const uint8_t interval, const uint8_t counter)
 {
     uint32_t resend_time = interval << counter;
     uint16_t random_factor = randLIB_get_random_in_range(100, RESPONSE_RANDOM_FACTOR * 100);
     return current_time + ((resend_time * random_factor) / 100);
 }
+#endif
+
+/**************************************************************************//**
+ * \fn static uint32_t sn_coap_protocol_resend_time(struct coap_s *handle, const coap_send_msg_s *msg_ptr)
+ *
+ * \brief Calculates the next resending time of a stored message from the current system time.
+ *
+ * \param *msg_ptr is the message, its resending counter tells the backoff step
+ *
+ * \return Resending time, UINT32_MAX for a message which has not been sent yet
+ *****************************************************************************/
+
+static uint32_t sn_coap_protocol_resend_time(struct coap_s *handle, const coap_send_msg_s *msg_ptr)
+{
+#if SN_COAP_NSTART
+    if (msg_ptr->deferred) {
+        /* Keeps it behind the sent messages until there is room in the window */
+        return UINT32_MAX;
+    }
+#endif
+#if SN_COAP_ADAPTIVE_RTO
+    /* Variable backoff of CoCoA. The RTO is never below 1 s here, so the factor 3 for short RTO is not used. */
+    uint32_t timeout = msg_ptr->rto;
+    for (uint_fast8_t i = 0; i < msg_ptr->resending_counter; i++) {
+        if (msg_ptr->rto > 3 * SN_COAP_RTO_UNITS) {
+            timeout = (timeout * 3) / 2;
+        } else {
+            timeout *= 2;
+        }
+    }
+    uint16_t random_factor = randLIB_get_random_in_range(100, RESPONSE_RANDOM_FACTOR * 100);
+    timeout = (timeout * random_factor) / 100;
+    return handle->system_time + (timeout + SN_COAP_RTO_UNITS - 1) / SN_COAP_RTO_UNITS;
+#else
+    return sn_coap_calculate_new_resend_time(handle->system_time, handle->sn_coap_resending_intervall, msg_ptr->resending_counter);
+#endif
+}
+
+#if SN_COAP_ADAPTIVE_RTO
+/**************************************************************************//**
+ * \fn static coap_rto_peer_s *sn_coap_protocol_rto_peer_get(struct coap_s *handle, const sn_nsdl_addr_s *addr_ptr)
+ *
+ * \brief Finds the round trip state of a destination, replacing the least recently
+ *        updated one if the destination is new.
+ *
+ * \param *addr_ptr is the destination address
+ *
+ * \return The state, NULL if the address can not be tracked
+ *****************************************************************************/
+
+static coap_rto_peer_s *sn_coap_protocol_rto_peer_get(struct coap_s *handle, const sn_nsdl_addr_s *addr_ptr)
+{
+    coap_rto_peer_s *replaced = NULL;
+
+    if (addr_ptr->addr_len == 0 || addr_ptr->addr_len > sizeof(handle->rto_peers[0].addr)) {
+        return NULL;
+    }
+
+    for (uint_fast8_t i = 0; i < SN_COAP_ADAPTIVE_RTO_PEERS; i++) {
+        coap_rto_peer_s *peer = &handle->rto_peers[i];
+        if (peer->addr_len == addr_ptr->addr_len && peer->port == addr_ptr->port &&
+                memcmp(peer->addr, addr_ptr->addr_ptr, addr_ptr->addr_len) == 0) {
+            return peer;
+        }
+        if (!replaced || (replaced->addr_len && (!peer->addr_len || peer->updated < replaced->updated))) {
+            replaced = peer;
+        }
+    }
+
+    uint32_t rto = (uint32_t)handle->sn_coap_resending_intervall * SN_COAP_RTO_UNITS;
+    if (rto < SN_COAP_RTO_MIN) {
+        rto = SN_COAP_RTO_MIN;
+    } else if (rto > SN_COAP_RTO_MAX) {
+        rto = SN_COAP_RTO_MAX;
+    }
+
+    memset(replaced, 0, sizeof(coap_rto_peer_s));
+    memcpy(replaced->addr, addr_ptr->addr_ptr, addr_ptr->addr_len);
+    replaced->addr_len = addr_ptr->addr_len;
+    replaced->port = addr_ptr->port;
+    replaced->rto = rto;
+    replaced->updated = handle->system_time;
+    return replaced;
+}
+
+/**************************************************************************//**
+ * \fn static uint16_t sn_coap_protocol_rto_get(struct coap_s *handle, const sn_nsdl_addr_s *addr_ptr)
+ *
+ * \brief Returns the RTO for a new message to a destination, in 1/8 seconds.
+ *
+ * \param *addr_ptr is the destination address
+ *****************************************************************************/
+
+static uint16_t sn_coap_protocol_rto_get(struct coap_s *handle, const sn_nsdl_addr_s *addr_ptr)
+{
+    coap_rto_peer_s *peer = sn_coap_protocol_rto_peer_get(handle, addr_ptr);
+    if (!peer) {
+        uint32_t rto = (uint32_t)handle->sn_coap_resending_intervall * SN_COAP_RTO_UNITS;
+        return rto < SN_COAP_RTO_MIN ? SN_COAP_RTO_MIN : (rto > SN_COAP_RTO_MAX ? SN_COAP_RTO_MAX : rto);
+    }
+
+    /* A long RTO which has not been updated during the last 4 * RTO ages towards 2 seconds */
+    if (peer->rto > 3 * SN_COAP_RTO_UNITS &&
+            (handle->system_time - peer->updated) * SN_COAP_RTO_UNITS >= 4 * (uint32_t)peer->rto) {
+        peer->rto = (2 * SN_COAP_RTO_UNITS + peer->rto) / 2;
+        peer->updated = handle->system_time;
+    }
+
+    return peer->rto;
+}
+
+/**************************************************************************//**
+ * \fn static uint32_t sn_coap_protocol_rtt_estimate(uint16_t *srtt, uint16_t *rttvar, uint32_t rtt, uint_fast8_t k)
+ *
+ * \brief Updates one RFC 6298 estimator with a measurement and returns its RTO.
+ *
+ * \param k is the variance multiplier, 4 for the strong and 1 for the weak estimator
+ *****************************************************************************/
+
+static uint32_t sn_coap_protocol_rtt_estimate(uint16_t *srtt, uint16_t *rttvar, uint32_t rtt, uint_fast8_t k)
+{
+    if (*srtt == 0) {
+        *srtt = rtt;
+        *rttvar = rtt / 2;
+    } else {
+        uint32_t delta = (*srtt > rtt) ? (*srtt - rtt) : (rtt - *srtt);
+        *rttvar = (3 * (uint32_t)*rttvar + delta) / 4;
+        *srtt = (7 * (uint32_t)*srtt + rtt) / 8;
+    }
+    return *srtt + k * (uint32_t)*rttvar;
+}
+
+/**************************************************************************//**
+ * \fn static void sn_coap_protocol_rto_update(struct coap_s *handle, const coap_send_msg_s *msg_ptr)
+ *
+ * \brief Updates the RTO of a destination with the round trip of an acknowledged message.
+ *
+ * \param *msg_ptr is the acknowledged message, measured from its first transmission
+ *****************************************************************************/
+
+static void sn_coap_protocol_rto_update(struct coap_s *handle, const coap_send_msg_s *msg_ptr)
+{
+    /* Exchanges which needed more than two retransmissions give no usable measurement */
+    if (msg_ptr->resending_counter > 2) {
+        return;
+    }
+
+    coap_rto_peer_s *peer = sn_coap_protocol_rto_peer_get(handle, &msg_ptr->send_msg_ptr.dst_addr_ptr);
+    if (!peer) {
+        return;
+    }
+
+    /* Time has one second resolution, a response within the same second counts as half a second */
+    uint32_t rtt = (handle->system_time - msg_ptr->sent_time) * SN_COAP_RTO_UNITS;
+    if (rtt == 0) {
+        rtt = SN_COAP_RTO_UNITS / 2;
+    } else if (rtt > SN_COAP_RTO_MAX) {
+        rtt = SN_COAP_RTO_MAX;
+    }
+
+    uint32_t rto;
+    if (msg_ptr->resending_counter == 0) {
+        rto = sn_coap_protocol_rtt_estimate(&peer->srtt_strong, &peer->rttvar_strong, rtt, 4);
+    } else {
+        rto = sn_coap_protocol_rtt_estimate(&peer->srtt_weak, &peer->rttvar_weak, rtt, 1);
+    }
+
+    rto = (rto + peer->rto) / 2;
+    if (rto < SN_COAP_RTO_MIN) {
+        rto = SN_COAP_RTO_MIN;
+    } else if (rto > SN_COAP_RTO_MAX) {
+        rto = SN_COAP_RTO_MAX;
+    }
+    peer->rto = rto;
+    peer->updated = handle->system_time;
+
+    tr_debug("sn_coap_protocol_rto_update - rtt %" PRIu32 ", retransmissions %u, rto %" PRIu16 "/8 s",
+             rtt, (unsigned)msg_ptr->resending_counter, peer->rto);
+}
+#endif /* SN_COAP_ADAPTIVE_RTO */
+
+#if SN_COAP_NSTART
+/**************************************************************************//**
+ * \fn static uint_fast16_t sn_coap_protocol_count_in_flight(struct coap_s *handle, const sn_nsdl_addr_s *addr_ptr)
+ *
+ * \brief Counts sent confirmable messages to a destination which are waiting for acknowledgement.
+ *
+ * \param *addr_ptr is the destination address
+ *****************************************************************************/
+
+static uint_fast16_t sn_coap_protocol_count_in_flight(struct coap_s *handle, const sn_nsdl_addr_s *addr_ptr)
+{
+    uint_fast16_t count = 0;
+
+    ns_list_foreach(coap_send_msg_s, msg_ptr, &handle->linked_list_resent_msgs) {
+        if (!msg_ptr->deferred && compare_port(addr_ptr, &msg_ptr->send_msg_ptr.dst_addr_ptr)) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/**************************************************************************//**
+ * \fn static void sn_coap_protocol_send_deferred(struct coap_s *handle)
+ *
+ * \brief Sends the deferred messages which fit into the in-flight window, oldest first.
+ *****************************************************************************/
+
+static void sn_coap_protocol_send_deferred(struct coap_s *handle)
+{
+    bool sent;
+
+    do {
+        sent = false;
+        ns_list_foreach(coap_send_msg_s, msg_ptr, &handle->linked_list_resent_msgs) {
+            if (msg_ptr->deferred &&
+                    sn_coap_protocol_count_in_flight(handle, &msg_ptr->send_msg_ptr.dst_addr_ptr) < SN_COAP_NSTART) {
+                msg_ptr->deferred = false;
+#if SN_COAP_ADAPTIVE_RTO
+                msg_ptr->sent_time = handle->system_time;
+                msg_ptr->rto = sn_coap_protocol_rto_get(handle, &msg_ptr->send_msg_ptr.dst_addr_ptr);
+#endif
+                msg_ptr->resending_time = sn_coap_protocol_resend_time(handle, msg_ptr);
+                ns_list_remove(&handle->linked_list_resent_msgs, msg_ptr);
+                sn_coap_protocol_linked_list_send_msg_insert(handle, msg_ptr);
+
+                /* List may change in the callback, so start over after every message */
+                handle->sn_coap_tx_callback(msg_ptr->send_msg_ptr.packet_ptr,
+                                            msg_ptr->send_msg_ptr.packet_len, &msg_ptr->send_msg_ptr.dst_addr_ptr, msg_ptr->param);
+                sent = true;
+                break;
+            }
+        }
+    } while (sent);
+}
+#endif /* SN_COAP_NSTART */
 
 #endif /* ENABLE_RESENDINGS */
 
@@ -1057,6 +1508,70 @@ uint16_t sn_coap_protocol_get_configured_blockwise_size(struct coap_s *handle)
 
 #if SN_COAP_DUPLICATION_MAX_MSGS_COUNT /* If Message duplication detection is not used at all, this part of code will not be compiled */
 
+/**************************************************************************//**
+ * \fn static uint_fast16_t sn_coap_protocol_duplication_info_hash(const struct coap_s *handle, uint16_t port, uint16_t msg_id)
+ *
+ * \brief Calculates hash table bucket of Duplication info
+ *
+ * Address bytes are left out, as the Message ID differs between messages far
+ * more than the peers do and removal by address does not know the address length.
+ *
+ * \param port is source port of the message
+ * \param msg_id is Message ID of the message
+ *
+ * \return Index to duplication_hash_table
+ *****************************************************************************/
+
+static uint_fast16_t sn_coap_protocol_duplication_info_hash(const struct coap_s *handle, uint16_t port, uint16_t msg_id)
+{
+    uint_fast32_t hash = ((uint_fast32_t)port << 16 | msg_id) * 0x9E3779B1u;
+    return (uint_fast16_t)(hash >> 16) & handle->duplication_hash_mask;
+}
+
+/**************************************************************************//**
+ * \fn static void sn_coap_protocol_duplication_hash_table_resize(struct coap_s *handle)
+ *
+ * \brief Sizes hash table of Duplication infos by duplication buffer size
+ *
+ * If the table can not be allocated, searches fall back to walking the Linked list.
+ *****************************************************************************/
+
+static void sn_coap_protocol_duplication_hash_table_resize(struct coap_s *handle)
+{
+    uint_fast16_t bucket_count = 1;
+    while (bucket_count < handle->sn_coap_duplication_buffer_size) {
+        bucket_count <<= 1;
+    }
+
+    if (handle->duplication_hash_table && bucket_count == (uint_fast16_t)handle->duplication_hash_mask + 1) {
+        return;
+    }
+
+    handle->sn_coap_protocol_free(handle->duplication_hash_table);
+    handle->duplication_hash_table = NULL;
+    handle->duplication_hash_mask = 0;
+
+    if (handle->sn_coap_duplication_buffer_size == 0) {
+        return;
+    }
+
+    handle->duplication_hash_table = sn_coap_protocol_calloc(handle, bucket_count * sizeof(coap_duplication_info_s *));
+    if (handle->duplication_hash_table == NULL) {
+        tr_warn("sn_coap_protocol_duplication_hash_table_resize - failed to allocate hash table!");
+        return;
+    }
+    handle->duplication_hash_mask = bucket_count - 1;
+
+    /* Rehash already stored infos */
+    ns_list_foreach(coap_duplication_info_s, stored_duplication_info_ptr, &handle->linked_list_duplication_msgs) {
+        uint_fast16_t bucket = sn_coap_protocol_duplication_info_hash(handle,
+                                                                      stored_duplication_info_ptr->address.port,
+                                                                      stored_duplication_info_ptr->msg_id);
+        stored_duplication_info_ptr->hash_next = handle->duplication_hash_table[bucket];
+        handle->duplication_hash_table[bucket] = stored_duplication_info_ptr;
+    }
+}
+
 /**************************************************************************//**
  * \fn static void sn_coap_protocol_linked_list_duplication_info_store(sn_nsdl_addr_s *addr_ptr, uint16_t msg_id)
  *
@@ -1071,44 +1586,57 @@ static void sn_coap_protocol_linked_list_duplication_info_store(struct coap_s *r
 {
     coap_duplication_info_s *restrict stored_duplication_info_ptr = NULL;
 
-    /* * * * Allocating memory for stored Duplication info * * * */
-
-    /* Allocate memory for stored Duplication info's structure */
-    stored_duplication_info_ptr = sn_coap_protocol_calloc(handle, sizeof(coap_duplication_info_s));
+    /* * * * Allocating memory for stored Duplication info and its address * * * */
+    stored_duplication_info_ptr = sn_coap_protocol_pool_calloc(handle, sizeof(coap_duplication_info_s) + addr_ptr->addr_len);
 
     if (stored_duplication_info_ptr == NULL) {
         tr_error("sn_coap_protocol_linked_list_duplication_info_store - failed to allocate duplication info!");
         return;
     }
 
-    /* Allocate memory for stored Duplication info's address */
-    stored_duplication_info_ptr->address = sn_coap_protocol_calloc(handle, sizeof(sn_nsdl_addr_s));
-    if (stored_duplication_info_ptr->address == NULL) {
-        tr_error("sn_coap_protocol_linked_list_duplication_info_store - failed to allocate address!");
-        sn_coap_protocol_duplication_info_free(handle, stored_duplication_info_ptr);
-        return;
-    }
-
-    stored_duplication_info_ptr->address->addr_ptr = handle->sn_coap_protocol_malloc(addr_ptr->addr_len);
-
-    if (stored_duplication_info_ptr->address->addr_ptr == NULL) {
-        tr_error("sn_coap_protocol_linked_list_duplication_info_store - failed to allocate address pointer!");
-        sn_coap_protocol_duplication_info_free(handle, stored_duplication_info_ptr);
-        return;
-    }
-
     /* * * * Filling fields of stored Duplication info * * * */
     stored_duplication_info_ptr->timestamp = handle->system_time;
-    stored_duplication_info_ptr->address->addr_len = addr_ptr->addr_len;
-    memcpy(stored_duplication_info_ptr->address->addr_ptr, addr_ptr->addr_ptr, addr_ptr->addr_len);
-    stored_duplication_info_ptr->address->port = addr_ptr->port;
+    stored_duplication_info_ptr->address.addr_ptr = (uint8_t *)(stored_duplication_info_ptr + 1);
+    stored_duplication_info_ptr->address.addr_len = addr_ptr->addr_len;
+    memcpy(stored_duplication_info_ptr->address.addr_ptr, addr_ptr->addr_ptr, addr_ptr->addr_len);
+    stored_duplication_info_ptr->address.port = addr_ptr->port;
     stored_duplication_info_ptr->msg_id = msg_id;
 
     stored_duplication_info_ptr->param = param;
-    /* * * * Storing Duplication info to Linked list * * * */
+    /* * * * Storing Duplication info to Linked list and hash table * * * */
 
     ns_list_add_to_end(&handle->linked_list_duplication_msgs, stored_duplication_info_ptr);
     ++handle->count_duplication_msgs;
+
+    if (handle->duplication_hash_table) {
+        uint_fast16_t bucket = sn_coap_protocol_duplication_info_hash(handle, addr_ptr->port, msg_id);
+        stored_duplication_info_ptr->hash_next = handle->duplication_hash_table[bucket];
+        handle->duplication_hash_table[bucket] = stored_duplication_info_ptr;
+    }
+}
+
+/**************************************************************************//**
+ * \fn static coap_duplication_info_s *sn_coap_protocol_duplication_info_first(const struct coap_s *handle, uint16_t port, uint16_t msg_id)
+ *
+ * \brief Returns first stored Duplication info which may match given port and Message ID
+ *
+ * Continue with sn_coap_protocol_duplication_info_next().
+ *****************************************************************************/
+
+static coap_duplication_info_s *sn_coap_protocol_duplication_info_first(const struct coap_s *handle, uint16_t port, uint16_t msg_id)
+{
+    if (handle->duplication_hash_table) {
+        return handle->duplication_hash_table[sn_coap_protocol_duplication_info_hash(handle, port, msg_id)];
+    }
+    return ns_list_get_first(&handle->linked_list_duplication_msgs);
+}
+
+static coap_duplication_info_s *sn_coap_protocol_duplication_info_next(const struct coap_s *handle, const coap_duplication_info_s *duplication_info_ptr)
+{
+    if (handle->duplication_hash_table) {
+        return duplication_info_ptr->hash_next;
+    }
+    return ns_list_get_next(&handle->linked_list_duplication_msgs, duplication_info_ptr);
 }
 
 /**************************************************************************//**
@@ -1125,21 +1653,48 @@ static void sn_coap_protocol_linked_list_duplication_info_store(struct coap_s *r
 static coap_duplication_info_s *sn_coap_protocol_linked_list_duplication_info_search(const struct coap_s *handle,
                                                                                      const sn_nsdl_addr_s *addr_ptr, const uint16_t msg_id)
 {
-    /* Loop all nodes in Linked list for searching Message ID */
-    ns_list_foreach(coap_duplication_info_s, stored_duplication_info_ptr, &handle->linked_list_duplication_msgs) {
+    coap_duplication_info_s *stored_duplication_info_ptr = sn_coap_protocol_duplication_info_first(handle, addr_ptr->port, msg_id);
+
+    while (stored_duplication_info_ptr) {
         /* If message's Message ID is same than is searched */
         if (stored_duplication_info_ptr->msg_id == msg_id) {
             /* If message's Source address & port is same than is searched */
-            if (compare_port(addr_ptr, stored_duplication_info_ptr->address)) {
+            if (compare_port(addr_ptr, &stored_duplication_info_ptr->address)) {
                 /* * * Correct Duplication info found * * * */
                 return stored_duplication_info_ptr;
             }
         }
+        stored_duplication_info_ptr = sn_coap_protocol_duplication_info_next(handle, stored_duplication_info_ptr);
     }
     return NULL;
 }
 
+/**************************************************************************//**
+ * \fn static void sn_coap_protocol_linked_list_duplication_info_unlink(struct coap_s *handle, coap_duplication_info_s *duplication_info_ptr)
+ *
+ * \brief Removes stored Duplication info from Linked list and hash table and frees it
+ *****************************************************************************/
+
+static void sn_coap_protocol_linked_list_duplication_info_unlink(struct coap_s *handle, coap_duplication_info_s *duplication_info_ptr)
+{
+    if (handle->duplication_hash_table) {
+        coap_duplication_info_s **link_ptr = &handle->duplication_hash_table[sn_coap_protocol_duplication_info_hash(handle,
+                                                                                                                   duplication_info_ptr->address.port,
+                                                                                                                   duplication_info_ptr->msg_id)];
+        while (*link_ptr && *link_ptr != duplication_info_ptr) {
+            link_ptr = &(*link_ptr)->hash_next;
+        }
+        if (*link_ptr) {
+            *link_ptr = duplication_info_ptr->hash_next;
+        }
+    }
 
+    ns_list_remove(&handle->linked_list_duplication_msgs, duplication_info_ptr);
+    --handle->count_duplication_msgs;
+
+    /* Free memory of stored Duplication info */
+    sn_coap_protocol_duplication_info_free(handle, duplication_info_ptr);
+}
 
 /**************************************************************************//**
  * \fn static void sn_coap_protocol_linked_list_duplication_info_remove_old_ones(struct coap_s *handle)
@@ -1149,16 +1704,14 @@ static coap_duplication_info_s *sn_coap_protocol_linked_list_duplication_info_se
 
 static void sn_coap_protocol_linked_list_duplication_info_remove_old_ones(struct coap_s *handle)
 {
-
+    /* Infos are added to the end of the list as they arrive, so the oldest ones are first */
     ns_list_foreach_safe(coap_duplication_info_s, removed_duplication_info_ptr, &handle->linked_list_duplication_msgs) {
-        if ((handle->system_time - removed_duplication_info_ptr->timestamp)  > SN_COAP_DUPLICATION_MAX_TIME_MSGS_STORED) {
-            /* * * * Old Duplication info found, remove it from Linked list * * * */
-            ns_list_remove(&handle->linked_list_duplication_msgs, removed_duplication_info_ptr);
-            --handle->count_duplication_msgs;
-
-            /* Free memory of stored Duplication info */
-            sn_coap_protocol_duplication_info_free(handle, removed_duplication_info_ptr);
+        if ((handle->system_time - removed_duplication_info_ptr->timestamp) <= SN_COAP_DUPLICATION_MAX_TIME_MSGS_STORED) {
+            break;
         }
+
+        /* * * * Old Duplication info found, remove it * * * */
+        sn_coap_protocol_linked_list_duplication_info_unlink(handle, removed_duplication_info_ptr);
     }
 }
 
@@ -1167,27 +1720,25 @@ static void sn_coap_protocol_linked_list_duplication_info_remove_old_ones(struct
 void sn_coap_protocol_linked_list_duplication_info_remove(struct coap_s *handle, const uint8_t *scr_addr_ptr, const uint16_t port, const uint16_t msg_id)
 {
 #if SN_COAP_DUPLICATION_MAX_MSGS_COUNT
-    /* Loop all stored duplication messages in Linked list */
-    ns_list_foreach(coap_duplication_info_s, removed_duplication_info_ptr, &handle->linked_list_duplication_msgs) {
+    /* Loop stored duplication messages which may have the same port and Message ID */
+    coap_duplication_info_s *removed_duplication_info_ptr = sn_coap_protocol_duplication_info_first(handle, port, msg_id);
+    while (removed_duplication_info_ptr) {
         /* If message's Address is same than is searched */
         if (0 == memcmp(scr_addr_ptr,
-                        removed_duplication_info_ptr->address->addr_ptr,
-                        removed_duplication_info_ptr->address->addr_len)) {
+                        removed_duplication_info_ptr->address.addr_ptr,
+                        removed_duplication_info_ptr->address.addr_len)) {
             /* If message's Address prt is same than is searched */
-            if (removed_duplication_info_ptr->address->port == port) {
+            if (removed_duplication_info_ptr->address.port == port) {
                 /* If Message ID is same than is searched */
                 if (removed_duplication_info_ptr->msg_id == msg_id) {
-                    /* * * * Correct Duplication info found, remove it from Linked list * * * */
+                    /* * * * Correct Duplication info found, remove it * * * */
                     tr_info("sn_coap_protocol_linked_list_duplication_info_remove - message id %d removed", msg_id);
-                    ns_list_remove(&handle->linked_list_duplication_msgs, removed_duplication_info_ptr);
-                    --handle->count_duplication_msgs;
-
-                    /* Free memory of stored Duplication info */
-                    sn_coap_protocol_duplication_info_free(handle, removed_duplication_info_ptr);
+                    sn_coap_protocol_linked_list_duplication_info_unlink(handle, removed_duplication_info_ptr);
                     return;
                 }
             }
         }
+        removed_duplication_info_ptr = sn_coap_protocol_duplication_info_next(handle, removed_duplication_info_ptr);
     }
 #else
     (void)handle;
@@ -1200,14 +1751,9 @@ void sn_coap_protocol_linked_list_duplication_info_remove(struct coap_s *handle,
 #if SN_COAP_DUPLICATION_MAX_MSGS_COUNT
 static void sn_coap_protocol_duplication_info_free(struct coap_s *handle, coap_duplication_info_s *duplication_info_ptr)
 {
-    // General purpose free functions ignore null pointer inputs - this
-    // private one knows it never receives null.
-    if (duplication_info_ptr->address) {
-        handle->sn_coap_protocol_free(duplication_info_ptr->address->addr_ptr);
-        handle->sn_coap_protocol_free(duplication_info_ptr->address);
-    }
-    handle->sn_coap_protocol_free(duplication_info_ptr->packet_ptr);
-    handle->sn_coap_protocol_free(duplication_info_ptr);
+    // Address is stored in the same allocation as the info
+    sn_coap_protocol_pool_free(handle, duplication_info_ptr->packet_ptr);
+    sn_coap_protocol_pool_free(handle, duplication_info_ptr);
 }
 #endif // SN_COAP_DUPLICATION_MAX_MSGS_COUNT
 
@@ -1230,7 +1776,7 @@ static void sn_coap_protocol_linked_list_blockwise_msg_remove(struct coap_s *han
         sn_coap_parser_release_allocated_coap_msg_mem(handle, removed_msg_ptr->coap_msg_ptr);
     }
 
-    handle->sn_coap_protocol_free(removed_msg_ptr);
+    sn_coap_protocol_pool_free(handle, removed_msg_ptr);
 }
 
 /**************************************************************************//**
@@ -1261,50 +1807,51 @@ static void sn_coap_protocol_linked_list_blockwise_payload_store(struct coap_s *
         return;
     }
 
+    // There is one stored payload per transfer, which the blocks are assembled to
+    coap_blockwise_payload_s *restrict stored_blockwise_payload_ptr = sn_coap_protocol_linked_list_blockwise_search(handle, addr_ptr, token_ptr, token_len);
+
     // Do not add duplicates to list, this could happen if server needs to retransmit block message again
-    if (sn_coap_protocol_linked_list_blockwise_payload_search_compare_block_number(handle,
-                                                                                   addr_ptr,
-                                                                                   token_ptr,
-                                                                                   token_len,
-                                                                                   block_number)) {
+    if (stored_blockwise_payload_ptr && stored_blockwise_payload_ptr->block_number == block_number) {
         return;
     }
 
-    coap_blockwise_payload_s *restrict stored_blockwise_payload_ptr = sn_coap_protocol_linked_list_blockwise_search(handle, addr_ptr, token_ptr, token_len);
-
     if (stored_blockwise_payload_ptr && stored_blockwise_payload_ptr->use_size1) {
-        memcpy(stored_blockwise_payload_ptr->payload_ptr + (block_number * block_size), payload_ptr, payload_len);
+        // Whole payload was allocated with the first block, write this one to its offset
+        uint32_t offset = block_number * block_size;
+        if (offset > stored_blockwise_payload_ptr->payload_len ||
+                payload_len > stored_blockwise_payload_ptr->payload_len - offset) {
+            tr_error("sn_coap_protocol_linked_list_blockwise_payload_store - block exceeds size1!");
+            sn_coap_protocol_linked_list_blockwise_payload_remove(handle, stored_blockwise_payload_ptr);
+            return;
+        }
+        memcpy(stored_blockwise_payload_ptr->payload_ptr + offset, payload_ptr, payload_len);
     } else if (stored_blockwise_payload_ptr) {
-        uint16_t new_len = stored_blockwise_payload_ptr->payload_len + payload_len;
-        tr_debug("sn_coap_protocol_linked_list_blockwise_payload_store - reallocate from %d to %d", stored_blockwise_payload_ptr->payload_len, new_len);
-
-        uint8_t *restrict temp_ptr = handle->sn_coap_protocol_malloc(stored_blockwise_payload_ptr->payload_len);
-        if (temp_ptr == NULL) {
-            tr_error("sn_coap_protocol_linked_list_blockwise_payload_store - failed to allocate temp buffer!");
+        uint32_t new_len = (uint32_t)stored_blockwise_payload_ptr->payload_len + payload_len;
+        if (new_len > UINT16_MAX) {
+            tr_error("sn_coap_protocol_linked_list_blockwise_payload_store - payload too large!");
             sn_coap_protocol_linked_list_blockwise_payload_remove(handle, stored_blockwise_payload_ptr);
             return;
         }
+        tr_debug("sn_coap_protocol_linked_list_blockwise_payload_store - reallocate from %d to %" PRIu32, stored_blockwise_payload_ptr->payload_len, new_len);
 
-        memcpy(temp_ptr, stored_blockwise_payload_ptr->payload_ptr, stored_blockwise_payload_ptr->payload_len);
-
-        handle->sn_coap_protocol_free(stored_blockwise_payload_ptr->payload_ptr);
-        stored_blockwise_payload_ptr->payload_ptr = handle->sn_coap_protocol_malloc(new_len);
-
-        if (stored_blockwise_payload_ptr->payload_ptr == NULL) {
+        // Size is not known, grow the payload by the block. The old payload is copied
+        // straight to the new one, so only the two of them are allocated at a time.
+        uint8_t *restrict new_payload_ptr = handle->sn_coap_protocol_malloc(new_len);
+        if (new_payload_ptr == NULL) {
             tr_error("sn_coap_protocol_linked_list_blockwise_payload_store - failed to reallocate payload!");
-            handle->sn_coap_protocol_free(temp_ptr);
             sn_coap_protocol_linked_list_blockwise_payload_remove(handle, stored_blockwise_payload_ptr);
             return;
         }
 
-        memcpy(stored_blockwise_payload_ptr->payload_ptr, temp_ptr, stored_blockwise_payload_ptr->payload_len);
-        memcpy(stored_blockwise_payload_ptr->payload_ptr + stored_blockwise_payload_ptr->payload_len, payload_ptr, payload_len);
-        stored_blockwise_payload_ptr->payload_len = new_len;
-        handle->sn_coap_protocol_free(temp_ptr);
+        memcpy(new_payload_ptr, stored_blockwise_payload_ptr->payload_ptr, stored_blockwise_payload_ptr->payload_len);
+        memcpy(new_payload_ptr + stored_blockwise_payload_ptr->payload_len, payload_ptr, payload_len);
+        handle->sn_coap_protocol_free(stored_blockwise_payload_ptr->payload_ptr);
+        stored_blockwise_payload_ptr->payload_ptr = new_payload_ptr;
+        stored_blockwise_payload_ptr->payload_len = (uint16_t)new_len;
 
     } else {
         stored_blockwise_payload_ptr = NULL;
-        stored_blockwise_payload_ptr = handle->sn_coap_protocol_malloc(sizeof(coap_blockwise_payload_s));
+        stored_blockwise_payload_ptr = sn_coap_protocol_pool_malloc(handle, sizeof(coap_blockwise_payload_s));
 
         if (stored_blockwise_payload_ptr == NULL) {
             tr_error("sn_coap_protocol_linked_list_blockwise_payload_store - failed to allocate blockwise!");
@@ -1316,10 +1863,16 @@ static void sn_coap_protocol_linked_list_blockwise_payload_store(struct coap_s *
 
         /* Allocate memory for stored Payload's data */
         if (stored_blockwise_payload_ptr->use_size1) {
+            uint32_t offset = block_number * block_size;
+            if (size1 > UINT16_MAX || offset > size1 || payload_len > size1 - offset) {
+                tr_error("sn_coap_protocol_linked_list_blockwise_payload_store - block exceeds size1!");
+                sn_coap_protocol_pool_free(handle, stored_blockwise_payload_ptr);
+                return;
+            }
             stored_blockwise_payload_ptr->payload_ptr = handle->sn_coap_protocol_malloc(size1);
             if (stored_blockwise_payload_ptr->payload_ptr) {
-                memcpy(stored_blockwise_payload_ptr->payload_ptr, payload_ptr, payload_len);
-                stored_blockwise_payload_ptr->payload_len = size1;
+                memcpy(stored_blockwise_payload_ptr->payload_ptr + offset, payload_ptr, payload_len);
+                stored_blockwise_payload_ptr->payload_len = (uint16_t)size1;
             }
         } else {
             stored_blockwise_payload_ptr->payload_ptr = sn_coap_protocol_malloc_copy(handle, payload_ptr, payload_len);
@@ -1328,29 +1881,29 @@ static void sn_coap_protocol_linked_list_blockwise_payload_store(struct coap_s *
 
         if (stored_blockwise_payload_ptr->payload_ptr == NULL) {
             tr_error("sn_coap_protocol_linked_list_blockwise_payload_store - failed to allocate payload!");
-            handle->sn_coap_protocol_free(stored_blockwise_payload_ptr);
+            sn_coap_protocol_pool_free(handle, stored_blockwise_payload_ptr);
             return;
         }
 
         /* Allocate memory for stored Payload's address */
-        stored_blockwise_payload_ptr->addr_ptr = sn_coap_protocol_malloc_copy(handle, addr_ptr->addr_ptr, addr_ptr->addr_len);
+        stored_blockwise_payload_ptr->addr_ptr = sn_coap_protocol_pool_malloc_copy(handle, addr_ptr->addr_ptr, addr_ptr->addr_len);
 
         if (stored_blockwise_payload_ptr->addr_ptr == NULL) {
             tr_error("sn_coap_protocol_linked_list_blockwise_payload_store - failed to allocate address pointer!");
             handle->sn_coap_protocol_free(stored_blockwise_payload_ptr->payload_ptr);
-            handle->sn_coap_protocol_free(stored_blockwise_payload_ptr);
+            sn_coap_protocol_pool_free(handle, stored_blockwise_payload_ptr);
             return;
         }
 
         /* Allocate & copy token number */
         if (token_ptr && token_len) {
-            stored_blockwise_payload_ptr->token_ptr = sn_coap_protocol_malloc_copy(handle, token_ptr, token_len);
+            stored_blockwise_payload_ptr->token_ptr = sn_coap_protocol_pool_malloc_copy(handle, token_ptr, token_len);
 
             if (!stored_blockwise_payload_ptr->token_ptr) {
                 tr_error("sn_coap_protocol_linked_list_blockwise_payload_store - failed to allocate token pointer!");
-                handle->sn_coap_protocol_free(stored_blockwise_payload_ptr->addr_ptr);
+                sn_coap_protocol_pool_free(handle, stored_blockwise_payload_ptr->addr_ptr);
                 handle->sn_coap_protocol_free(stored_blockwise_payload_ptr->payload_ptr);
-                handle->sn_coap_protocol_free(stored_blockwise_payload_ptr);
+                sn_coap_protocol_pool_free(handle, stored_blockwise_payload_ptr);
                 return;
             }
 
@@ -1371,41 +1924,6 @@ static void sn_coap_protocol_linked_list_blockwise_payload_store(struct coap_s *
     stored_blockwise_payload_ptr->timestamp = handle->system_time;
 }
 
-/**************************************************************************//**
- * \fn static uint8_t *sn_coap_protocol_linked_list_blockwise_payload_search(sn_nsdl_addr_s *src_addr_ptr, uint16_t *payload_length)
- *
- * \brief Searches stored blockwise payload from Linked list (Address as key)
- *
- * \param *addr_ptr is pointer to Address key to be searched
- * \param *payload_length is pointer to returned Payload length
- *
- * \return Return value is pointer to found stored blockwise payload in Linked
- *         list or NULL if payload not found
- *****************************************************************************/
-
-static uint8_t *sn_coap_protocol_linked_list_blockwise_payload_search(struct coap_s *handle, const sn_nsdl_addr_s *src_addr_ptr, uint16_t *payload_length, const uint8_t *token_ptr, uint8_t token_len)
-{
-    /* Loop all stored blockwise payloads in Linked list */
-    ns_list_foreach(coap_blockwise_payload_s, stored_payload_info_ptr, &handle->linked_list_blockwise_received_payloads) {
-        /* If payload's Source address and port is same than is searched */
-        if ((0 == memcmp(src_addr_ptr->addr_ptr, stored_payload_info_ptr->addr_ptr, src_addr_ptr->addr_len)) && (stored_payload_info_ptr->port == src_addr_ptr->port)) {
-            /* Check token */
-            if (token_ptr) {
-                if (!stored_payload_info_ptr->token_ptr || (token_len != stored_payload_info_ptr->token_len) || (memcmp(stored_payload_info_ptr->token_ptr, token_ptr, token_len))) {
-                    continue;
-                }
-            } else if (stored_payload_info_ptr->token_ptr) {
-                continue;
-            }
-            /* * * Correct Payload found * * * */
-            *payload_length = stored_payload_info_ptr->payload_len;
-            return stored_payload_info_ptr->payload_ptr;
-        }
-    }
-
-    return NULL;
-}
-
 /**************************************************************************//**
  * \fn static uint8_t *sn_coap_protocol_linked_list_blockwise_search(sn_nsdl_addr_s *src_addr_ptr, uint16_t *payload_length)
  *
@@ -1480,44 +1998,11 @@ static void sn_coap_protocol_linked_list_blockwise_payload_remove(struct coap_s
 {
     ns_list_remove(&handle->linked_list_blockwise_received_payloads, removed_payload_ptr);
     /* Free memory of stored payload */
-    handle->sn_coap_protocol_free(removed_payload_ptr->addr_ptr);
+    sn_coap_protocol_pool_free(handle, removed_payload_ptr->addr_ptr);
     handle->sn_coap_protocol_free(removed_payload_ptr->payload_ptr);
-    handle->sn_coap_protocol_free(removed_payload_ptr->token_ptr);
+    sn_coap_protocol_pool_free(handle, removed_payload_ptr->token_ptr);
 
-    handle->sn_coap_protocol_free(removed_payload_ptr);
-}
-
-/**************************************************************************//**
- * \fn static uint32_t sn_coap_protocol_linked_list_blockwise_payloads_get_len(sn_nsdl_addr_s *src_addr_ptr)
- *
- * \brief Counts length of Payloads in Linked list (Address as key)
- *
- * \param *addr_ptr is pointer to Address key
- *
- * \return Return value is length of Payloads as bytes
- *****************************************************************************/
-
-static uint32_t sn_coap_protocol_linked_list_blockwise_payloads_get_len(struct coap_s *handle, const sn_nsdl_addr_s *src_addr_ptr, const uint8_t *token_ptr, uint8_t token_len)
-{
-    uint32_t ret_whole_payload_len = 0;
-    /* Loop all stored blockwise payloads in Linked list */
-    ns_list_foreach(coap_blockwise_payload_s, searched_payload_info_ptr, &handle->linked_list_blockwise_received_payloads) {
-        /* If payload's Source address and port is same than is searched */
-        if ((0 == memcmp(src_addr_ptr->addr_ptr, searched_payload_info_ptr->addr_ptr, src_addr_ptr->addr_len)) && (searched_payload_info_ptr->port == src_addr_ptr->port)) {
-            /* Check token */
-            if (token_ptr) {
-                if (!searched_payload_info_ptr->token_ptr || (token_len != searched_payload_info_ptr->token_len) || (memcmp(searched_payload_info_ptr->token_ptr, token_ptr, token_len))) {
-                    continue;
-                }
-            } else if (searched_payload_info_ptr->token_ptr) {
-                continue;
-            }
-            /* * * Correct Payload found * * * */
-            ret_whole_payload_len += searched_payload_info_ptr->payload_len;
-        }
-    }
-
-    return ret_whole_payload_len;
+    sn_coap_protocol_pool_free(handle, removed_payload_ptr);
 }
 
 /**************************************************************************//**
@@ -1558,15 +2043,15 @@ static void sn_coap_protocol_handle_blockwise_timeout(struct coap_s *handle)
 coap_send_msg_s *sn_coap_protocol_allocate_mem_for_msg(struct coap_s *handle, sn_nsdl_addr_s *dst_addr_ptr, uint_fast16_t packet_data_len)
 {
 
-    coap_send_msg_s *msg_ptr = sn_coap_protocol_calloc(handle, sizeof(coap_send_msg_s));
+    coap_send_msg_s *msg_ptr = sn_coap_protocol_pool_calloc(handle, sizeof(coap_send_msg_s));
 
     if (msg_ptr == NULL) {
         return 0;
     }
 
-    msg_ptr->send_msg_ptr.packet_ptr = handle->sn_coap_protocol_malloc(packet_data_len);
+    msg_ptr->send_msg_ptr.packet_ptr = sn_coap_protocol_pool_malloc(handle, packet_data_len);
 
-    msg_ptr->send_msg_ptr.dst_addr_ptr.addr_ptr = sn_coap_protocol_calloc(handle, dst_addr_ptr->addr_len);
+    msg_ptr->send_msg_ptr.dst_addr_ptr.addr_ptr = sn_coap_protocol_pool_calloc(handle, dst_addr_ptr->addr_len);
 
     if ((msg_ptr->send_msg_ptr.dst_addr_ptr.addr_ptr == NULL) ||
             (msg_ptr->send_msg_ptr.packet_ptr == NULL)) {
@@ -1591,11 +2076,11 @@ static void sn_coap_protocol_release_allocated_send_msg_mem(struct coap_s *handl
 {
     if (freed_send_msg_ptr != NULL) {
 
-        handle->sn_coap_protocol_free(freed_send_msg_ptr->send_msg_ptr.dst_addr_ptr.addr_ptr);
+        sn_coap_protocol_pool_free(handle, freed_send_msg_ptr->send_msg_ptr.dst_addr_ptr.addr_ptr);
 
-        handle->sn_coap_protocol_free(freed_send_msg_ptr->send_msg_ptr.packet_ptr);
+        sn_coap_protocol_pool_free(handle, freed_send_msg_ptr->send_msg_ptr.packet_ptr);
 
-        handle->sn_coap_protocol_free(freed_send_msg_ptr);
+        sn_coap_protocol_pool_free(handle, freed_send_msg_ptr);
     }
 }
 
@@ -1644,7 +2129,7 @@ void sn_coap_protocol_remove_sent_blockwise_message(struct coap_s *handle, uint1
         handle->sn_coap_protocol_free(tmp->coap_msg_ptr->payload_ptr);
         sn_coap_parser_release_allocated_coap_msg_mem(handle, tmp->coap_msg_ptr);
         ns_list_remove(&handle->linked_list_blockwise_sent_msgs, tmp);
-        handle->sn_coap_protocol_free(tmp);
+        sn_coap_protocol_pool_free(handle, tmp);
     }
 }
 
@@ -1718,6 +2203,7 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
 
     uint16_t original_payload_len = 0;
     uint8_t *original_payload_ptr = NULL;
+    uint8_t *block_payload_ptr = NULL;
 
     /* Block1 Option in a request (e.g., PUT or POST) */
     // Blocked request sending, received ACK, sending next block..
@@ -1769,7 +2255,29 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
                         original_payload_len = stored_blockwise_msg_temp_ptr->coap_msg_ptr->payload_len;
                         original_payload_ptr = stored_blockwise_msg_temp_ptr->coap_msg_ptr->payload_ptr;
 
-                        if ((block_size * (block_number + 1)) > stored_blockwise_msg_temp_ptr->coap_msg_ptr->payload_len) {
+                        if (stored_blockwise_msg_temp_ptr->producer) {
+                            /* Payload is not stored, produce the next block of it */
+                            bool more = false;
+                            int32_t produced_len = -1;
+
+                            block_payload_ptr = sn_coap_protocol_pool_malloc(handle, block_size);
+                            if (block_payload_ptr) {
+                                produced_len = stored_blockwise_msg_temp_ptr->producer(stored_blockwise_msg_temp_ptr->param,
+                                                                                       block_payload_ptr, block_size, &more);
+                            }
+                            if ((produced_len < 0) || (more && ((uint32_t)produced_len != block_size))) {
+                                tr_error("sn_coap_handle_blockwise_message - (send block1) failed to produce payload!");
+                                sn_coap_protocol_pool_free(handle, block_payload_ptr);
+                                sn_coap_protocol_remove_sent_blockwise_message(handle, stored_blockwise_msg_temp_ptr->coap_msg_ptr->msg_id);
+                                return NULL;
+                            }
+                            if (more) {
+                                /* set more - bit */
+                                src_coap_blockwise_ack_msg_ptr->options_list_ptr->block1 |= 0x08;
+                            }
+                            src_coap_blockwise_ack_msg_ptr->payload_len = produced_len;
+                            src_coap_blockwise_ack_msg_ptr->payload_ptr = block_payload_ptr;
+                        } else if ((block_size * (block_number + 1)) > stored_blockwise_msg_temp_ptr->coap_msg_ptr->payload_len) {
                             src_coap_blockwise_ack_msg_ptr->payload_len = stored_blockwise_msg_temp_ptr->coap_msg_ptr->payload_len - (block_size * (block_number));
                             src_coap_blockwise_ack_msg_ptr->payload_ptr = src_coap_blockwise_ack_msg_ptr->payload_ptr + (block_size * block_number);
                         }
@@ -1785,9 +2293,10 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
                         /* Build and send block message */
                         dst_packed_data_needed_mem = sn_coap_builder_calc_needed_packet_data_size_2(src_coap_blockwise_ack_msg_ptr, handle->sn_coap_block_data_size);
 
-                        dst_ack_packet_data_ptr = handle->sn_coap_protocol_malloc(dst_packed_data_needed_mem);
+                        dst_ack_packet_data_ptr = sn_coap_protocol_pool_malloc(handle, dst_packed_data_needed_mem);
                         if (!dst_ack_packet_data_ptr) {
                             tr_error("sn_coap_handle_blockwise_message - (send block1) failed to allocate ack message!");
+                            sn_coap_protocol_pool_free(handle, block_payload_ptr);
                             handle->sn_coap_protocol_free(src_coap_blockwise_ack_msg_ptr->options_list_ptr);
                             handle->sn_coap_protocol_free(original_payload_ptr);
                             handle->sn_coap_protocol_free(src_coap_blockwise_ack_msg_ptr);
@@ -1797,21 +2306,21 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
                         src_coap_blockwise_ack_msg_ptr->msg_id = get_new_message_id();
 
                         sn_coap_builder_2(dst_ack_packet_data_ptr, src_coap_blockwise_ack_msg_ptr, handle->sn_coap_block_data_size);
+                        sn_coap_protocol_pool_free(handle, block_payload_ptr);
+                        block_payload_ptr = NULL;
 
                         handle->sn_coap_tx_callback(dst_ack_packet_data_ptr, dst_packed_data_needed_mem, src_addr_ptr, param);
 
 #if ENABLE_RESENDINGS
-                        uint32_t resend_time = sn_coap_calculate_new_resend_time(handle->system_time, handle->sn_coap_resending_intervall, 0);
-
                         if (src_coap_blockwise_ack_msg_ptr->msg_type == COAP_MSG_TYPE_CONFIRMABLE) {
                             sn_coap_protocol_linked_list_send_msg_store(handle, src_addr_ptr,
                                                                         dst_packed_data_needed_mem,
                                                                         dst_ack_packet_data_ptr,
-                                                                        resend_time, param);
+                                                                        param, false);
                         }
 #endif
 
-                        handle->sn_coap_protocol_free(dst_ack_packet_data_ptr);
+                        sn_coap_protocol_pool_free(handle, dst_ack_packet_data_ptr);
                         dst_ack_packet_data_ptr = 0;
 
                         stored_blockwise_msg_temp_ptr->coap_msg_ptr->payload_len = original_payload_len;
@@ -1918,7 +2427,7 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
 
                 dst_packed_data_needed_mem = sn_coap_builder_calc_needed_packet_data_size_2(src_coap_blockwise_ack_msg_ptr, handle->sn_coap_block_data_size);
 
-                dst_ack_packet_data_ptr = handle->sn_coap_protocol_malloc(dst_packed_data_needed_mem);
+                dst_ack_packet_data_ptr = sn_coap_protocol_pool_malloc(handle, dst_packed_data_needed_mem);
                 if (!dst_ack_packet_data_ptr) {
                     tr_error("sn_coap_handle_blockwise_message - (recv block1) message allocation failed!");
                     handle->sn_coap_protocol_free(src_coap_blockwise_ack_msg_ptr->options_list_ptr);
@@ -1936,7 +2445,7 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
                                                                     dst_packed_data_needed_mem,
                                                                     dst_ack_packet_data_ptr)) {
                     sn_coap_parser_release_allocated_coap_msg_mem(handle, src_coap_blockwise_ack_msg_ptr);
-                    handle->sn_coap_protocol_free(dst_ack_packet_data_ptr);
+                    sn_coap_protocol_pool_free(handle, dst_ack_packet_data_ptr);
                     return NULL;
                 }
 #endif
@@ -1958,7 +2467,7 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
                 handle->sn_coap_tx_callback(dst_ack_packet_data_ptr, dst_packed_data_needed_mem, src_addr_ptr, param);
 
                 sn_coap_parser_release_allocated_coap_msg_mem(handle, src_coap_blockwise_ack_msg_ptr);
-                handle->sn_coap_protocol_free(dst_ack_packet_data_ptr);
+                sn_coap_protocol_pool_free(handle, dst_ack_packet_data_ptr);
                 dst_ack_packet_data_ptr = 0;
 
                 received_coap_msg_ptr->coap_status = COAP_STATUS_PARSER_BLOCKWISE_MSG_RECEIVING;
@@ -2069,7 +2578,7 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
                     dst_packed_data_needed_mem = sn_coap_builder_calc_needed_packet_data_size_2(src_coap_blockwise_ack_msg_ptr, handle->sn_coap_block_data_size);
 
                     /* Then allocate memory for Packet data */
-                    dst_ack_packet_data_ptr = sn_coap_protocol_calloc(handle, dst_packed_data_needed_mem);
+                    dst_ack_packet_data_ptr = sn_coap_protocol_pool_calloc(handle, dst_packed_data_needed_mem);
 
                     if (dst_ack_packet_data_ptr == NULL) {
                         tr_error("sn_coap_handle_blockwise_message - (send block2) failed to allocate packet!");
@@ -2080,7 +2589,7 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
                     /* * * Then build Acknowledgement message to Packed data * * */
                     if ((sn_coap_builder_2(dst_ack_packet_data_ptr, src_coap_blockwise_ack_msg_ptr, handle->sn_coap_block_data_size)) < 0) {
                         tr_error("sn_coap_handle_blockwise_message - (send block2) builder failed!");
-                        handle->sn_coap_protocol_free(dst_ack_packet_data_ptr);
+                        sn_coap_protocol_pool_free(handle, dst_ack_packet_data_ptr);
                         sn_coap_parser_release_allocated_coap_msg_mem(handle, src_coap_blockwise_ack_msg_ptr);
                         return NULL;
                     }
@@ -2088,10 +2597,10 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
                     /* * * Save to linked list * * */
                     coap_blockwise_msg_s *stored_blockwise_msg_ptr;
 
-                    stored_blockwise_msg_ptr = sn_coap_protocol_calloc(handle, sizeof(coap_blockwise_msg_s));
+                    stored_blockwise_msg_ptr = sn_coap_protocol_pool_calloc(handle, sizeof(coap_blockwise_msg_s));
                     if (!stored_blockwise_msg_ptr) {
                         tr_error("sn_coap_handle_blockwise_message - (send block2) failed to allocate blockwise message!");
-                        handle->sn_coap_protocol_free(dst_ack_packet_data_ptr);
+                        sn_coap_protocol_pool_free(handle, dst_ack_packet_data_ptr);
                         sn_coap_parser_release_allocated_coap_msg_mem(handle, src_coap_blockwise_ack_msg_ptr);
                         return 0;
                     }
@@ -2108,13 +2617,12 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
                                                 dst_packed_data_needed_mem, src_addr_ptr, param);
 
 #if ENABLE_RESENDINGS
-                    uint32_t resend_time = sn_coap_calculate_new_resend_time(handle->system_time, handle->sn_coap_resending_intervall, 0);
                     sn_coap_protocol_linked_list_send_msg_store(handle, src_addr_ptr,
                                                                 dst_packed_data_needed_mem,
                                                                 dst_ack_packet_data_ptr,
-                                                                resend_time, param);
+                                                                param, false);
 #endif
-                    handle->sn_coap_protocol_free(dst_ack_packet_data_ptr);
+                    sn_coap_protocol_pool_free(handle, dst_ack_packet_data_ptr);
                     dst_ack_packet_data_ptr = 0;
                 }
 
@@ -2212,7 +2720,7 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
                 /* Build and send block message */
                 dst_packed_data_needed_mem = sn_coap_builder_calc_needed_packet_data_size_2(src_coap_blockwise_ack_msg_ptr, handle->sn_coap_block_data_size);
 
-                dst_ack_packet_data_ptr = handle->sn_coap_protocol_malloc(dst_packed_data_needed_mem);
+                dst_ack_packet_data_ptr = sn_coap_protocol_pool_malloc(handle, dst_packed_data_needed_mem);
                 if (!dst_ack_packet_data_ptr) {
                     tr_error("sn_coap_handle_blockwise_message - (recv block2) failed to allocate packet!");
                     handle->sn_coap_protocol_free(original_payload_ptr);
@@ -2231,14 +2739,14 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
                                                                         dst_packed_data_needed_mem,
                                                                         dst_ack_packet_data_ptr)) {
                     sn_coap_parser_release_allocated_coap_msg_mem(handle, src_coap_blockwise_ack_msg_ptr);
-                    handle->sn_coap_protocol_free(dst_ack_packet_data_ptr);
+                    sn_coap_protocol_pool_free(handle, dst_ack_packet_data_ptr);
                     return NULL;
                 }
 #endif
 
                 handle->sn_coap_tx_callback(dst_ack_packet_data_ptr, dst_packed_data_needed_mem, src_addr_ptr, param);
 
-                handle->sn_coap_protocol_free(dst_ack_packet_data_ptr);
+                sn_coap_protocol_pool_free(handle, dst_ack_packet_data_ptr);
                 dst_ack_packet_data_ptr = 0;
 
                 stored_blockwise_msg_temp_ptr->coap_msg_ptr->payload_len = original_payload_len;
@@ -2264,15 +2772,17 @@ static sn_coap_hdr_s *sn_coap_handle_blockwise_message(struct coap_s *handle, sn
 
 static bool sn_coap_handle_last_blockwise(struct coap_s *handle, const sn_nsdl_addr_s *src_addr_ptr, sn_coap_hdr_s *received_coap_msg_ptr)
 {
-    uint16_t payload_len            = 0;
-    uint32_t whole_payload_len      = sn_coap_protocol_linked_list_blockwise_payloads_get_len(handle, src_addr_ptr, received_coap_msg_ptr->token_ptr, received_coap_msg_ptr->token_len);
-    uint8_t *payload_ptr            = sn_coap_protocol_linked_list_blockwise_payload_search(handle, src_addr_ptr, &payload_len, received_coap_msg_ptr->token_ptr, received_coap_msg_ptr->token_len);
-
-    tr_debug("sn_coap_handle_last_blockwise - whole len %" PRIu32, whole_payload_len);
-    if (!whole_payload_len) {
+    // The blocks have been assembled to the stored payload of the transfer
+    coap_blockwise_payload_s *stored_payload_ptr = sn_coap_protocol_linked_list_blockwise_search(handle, src_addr_ptr, received_coap_msg_ptr->token_ptr, received_coap_msg_ptr->token_len);
+    if (!stored_payload_ptr || !stored_payload_ptr->payload_len) {
         return false;
     }
 
+    uint32_t whole_payload_len      = stored_payload_ptr->payload_len;
+    uint8_t *payload_ptr            = stored_payload_ptr->payload_ptr;
+
+    tr_debug("sn_coap_handle_last_blockwise - whole len %" PRIu32, whole_payload_len);
+
 #if SN_COAP_REDUCE_BLOCKWISE_HEAP_FOOTPRINT
     received_coap_msg_ptr->payload_ptr = payload_ptr;
     received_coap_msg_ptr->payload_len = whole_payload_len;
@@ -2423,7 +2933,7 @@ static sn_coap_hdr_s *sn_coap_protocol_copy_header(struct coap_s *restrict handl
 #endif
 
 #if SN_COAP_DUPLICATION_MAX_MSGS_COUNT
-static bool sn_coap_protocol_update_duplicate_package_data(const struct coap_s *handle,
+static bool sn_coap_protocol_update_duplicate_package_data(struct coap_s *handle,
                                                            const sn_nsdl_addr_s *dst_addr_ptr,
                                                            const sn_coap_hdr_s *coap_msg_ptr,
                                                            const int_fast16_t data_size,
@@ -2436,7 +2946,7 @@ static bool sn_coap_protocol_update_duplicate_package_data(const struct coap_s *
     return true;
 }
 
-static bool sn_coap_protocol_update_duplicate_package_data_all(const struct coap_s *handle,
+static bool sn_coap_protocol_update_duplicate_package_data_all(struct coap_s *handle,
                                                                const sn_nsdl_addr_s *dst_addr_ptr,
                                                                const sn_coap_hdr_s *coap_msg_ptr,
                                                                const int_fast16_t data_size,
@@ -2448,7 +2958,7 @@ static bool sn_coap_protocol_update_duplicate_package_data_all(const struct coap
 
     /* Update package data to duplication info struct if it's not there yet */
     if (info && info->packet_ptr == NULL) {
-        info->packet_ptr = handle->sn_coap_protocol_malloc(data_size);
+        info->packet_ptr = sn_coap_protocol_pool_malloc(handle, data_size);
         if (info->packet_ptr) {
             tr_debug("sn_coap_protocol_update_duplication_package_data - added to duplicate list!");
             memcpy(info->packet_ptr, dst_packet_data_ptr, data_size);
@@ -2487,6 +2997,165 @@ void *sn_coap_protocol_calloc(struct coap_s *handle, uint_fast16_t length)
     return result;
 }
 
+#if SN_COAP_MEMORY_POOL_SMALL_BLOCKS || SN_COAP_MEMORY_POOL_LARGE_BLOCKS
+static bool sn_coap_protocol_pool_class_init(struct coap_s *handle, coap_pool_class_s *pool, uint16_t block_size, uint16_t block_count)
+{
+    pool->block_size = block_size;
+
+    if (block_count == 0) {
+        return true;
+    }
+
+    /* Allocator takes a 16 bit length */
+    if ((uint32_t)block_size * block_count > UINT16_MAX) {
+        return false;
+    }
+
+    pool->blocks = handle->sn_coap_protocol_malloc(block_size * block_count);
+    if (!pool->blocks) {
+        return false;
+    }
+
+    pool->block_count = block_count;
+
+    /* Chain all blocks to the free list, lowest address first */
+    for (uint16_t i = block_count; i > 0; i--) {
+        void *block = pool->blocks + (uint32_t)(i - 1) * block_size;
+        *(void **)block = pool->free_list;
+        pool->free_list = block;
+    }
+
+    return true;
+}
+
+static void *sn_coap_protocol_pool_class_alloc(coap_pool_class_s *pool)
+{
+    void *block = pool->free_list;
+
+    if (block) {
+        pool->free_list = *(void **)block;
+        pool->in_use++;
+        if (pool->in_use > pool->high_water) {
+            pool->high_water = pool->in_use;
+        }
+    }
+    return block;
+}
+
+static bool sn_coap_protocol_pool_class_free(coap_pool_class_s *pool, void *ptr)
+{
+    uint8_t *block = ptr;
+
+    if (!pool->blocks || block < pool->blocks ||
+            block >= pool->blocks + (uint32_t)pool->block_size * pool->block_count) {
+        return false;
+    }
+
+    *(void **)block = pool->free_list;
+    pool->free_list = block;
+    pool->in_use--;
+    return true;
+}
+#endif
+
+void *sn_coap_protocol_pool_malloc(struct coap_s *handle, uint_fast16_t length)
+{
+#if SN_COAP_MEMORY_POOL_SMALL_BLOCKS || SN_COAP_MEMORY_POOL_LARGE_BLOCKS
+    void *block = NULL;
+
+    if (length <= handle->pool_small.block_size) {
+        block = sn_coap_protocol_pool_class_alloc(&handle->pool_small);
+    }
+
+    /* Small requests may borrow a large block when small ones have run out */
+    if (!block && length <= handle->pool_large.block_size) {
+        block = sn_coap_protocol_pool_class_alloc(&handle->pool_large);
+    }
+
+    if (block) {
+        return block;
+    }
+
+    handle->pool_misses++;
+#endif
+    return handle->sn_coap_protocol_malloc(length);
+}
+
+void *sn_coap_protocol_pool_calloc(struct coap_s *handle, uint_fast16_t length)
+{
+    void *result = sn_coap_protocol_pool_malloc(handle, length);
+
+    if (result) {
+        memset(result, 0, length);
+    }
+    return result;
+}
+
+void *sn_coap_protocol_pool_malloc_copy(struct coap_s *handle, const void *source, uint_fast16_t length)
+{
+    void *dest = sn_coap_protocol_pool_malloc(handle, length);
+
+    if ((dest) && (source)) {
+        memcpy(dest, source, length);
+    }
+    return dest;
+}
+
+void sn_coap_protocol_pool_free(struct coap_s *handle, void *ptr)
+{
+    if (!ptr) {
+        return;
+    }
+
+#if SN_COAP_MEMORY_POOL_SMALL_BLOCKS || SN_COAP_MEMORY_POOL_LARGE_BLOCKS
+    if (sn_coap_protocol_pool_class_free(&handle->pool_small, ptr) ||
+            sn_coap_protocol_pool_class_free(&handle->pool_large, ptr)) {
+        return;
+    }
+#endif
+
+    handle->sn_coap_protocol_free(ptr);
+}
+
+int8_t sn_coap_protocol_get_pool_stats(struct coap_s *handle, sn_coap_pool_stats_s *stats)
+{
+    if (!handle || !stats) {
+        return -1;
+    }
+
+    memset(stats, 0, sizeof(sn_coap_pool_stats_s));
+
+#if SN_COAP_MEMORY_POOL_SMALL_BLOCKS || SN_COAP_MEMORY_POOL_LARGE_BLOCKS
+    stats->small_block_size = handle->pool_small.block_size;
+    stats->small_block_count = handle->pool_small.block_count;
+    stats->small_in_use = handle->pool_small.in_use;
+    stats->small_high_water = handle->pool_small.high_water;
+    stats->large_block_size = handle->pool_large.block_size;
+    stats->large_block_count = handle->pool_large.block_count;
+    stats->large_in_use = handle->pool_large.in_use;
+    stats->large_high_water = handle->pool_large.high_water;
+    stats->misses = handle->pool_misses;
+#endif
+
+    return 0;
+}
+
+int8_t sn_coap_protocol_get_exchange_stats(struct coap_s *handle, sn_coap_exchange_stats_s *stats)
+{
+    if (!handle || !stats) {
+        return -1;
+    }
+
+    memset(stats, 0, sizeof(sn_coap_exchange_stats_s));
+
+#if ENABLE_RESENDINGS
+    stats->retransmissions = handle->retransmissions;
+    stats->send_timeouts = handle->send_timeouts;
+#endif
+
+    return 0;
+}
+
 static bool compare_port(const sn_nsdl_addr_s *left, const sn_nsdl_addr_s *right)
 {
     bool match = false;
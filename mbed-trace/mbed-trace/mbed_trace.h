@@ -122,30 +122,47 @@ extern "C" {
 #define MBED_TRACE_MAX_LEVEL TRACE_LEVEL_DEBUG
 #endif
 
+/**
+ * Limit the traces of one source file further by defining TRACE_GROUP_MAX_LEVEL
+ * together with TRACE_GROUP, before including this header. Traces above the level
+ * are removed by the compiler, including the evaluation of their arguments.
+ */
+#ifndef TRACE_GROUP_MAX_LEVEL
+#define TRACE_GROUP_MAX_LEVEL MBED_TRACE_MAX_LEVEL
+#endif
+
+/**
+ * Trace call of the tr_ macros. The arguments are evaluated only when the level is
+ * compiled in for the file and active, and the group is not filtered out.
+ */
+#define mbed_tracef_if(dlevel, ...) \
+    ((void) (((dlevel) <= TRACE_GROUP_MAX_LEVEL && mbed_trace_enabled(dlevel, TRACE_GROUP)) ? \
+             (mbed_tracef(dlevel, TRACE_GROUP, __VA_ARGS__), 0) : 0))
+
 //usage macros:
 #if MBED_TRACE_MAX_LEVEL >= TRACE_LEVEL_DEBUG
-#define tr_debug(...)           mbed_tracef(TRACE_LEVEL_DEBUG,   TRACE_GROUP, __VA_ARGS__)   //!< Print debug message
+#define tr_debug(...)           mbed_tracef_if(TRACE_LEVEL_DEBUG,   __VA_ARGS__)   //!< Print debug message
 #else
 #define tr_debug(...)
 #endif
 
 #if MBED_TRACE_MAX_LEVEL >= TRACE_LEVEL_INFO
-#define tr_info(...)            mbed_tracef(TRACE_LEVEL_INFO,    TRACE_GROUP, __VA_ARGS__)   //!< Print info message
+#define tr_info(...)            mbed_tracef_if(TRACE_LEVEL_INFO,    __VA_ARGS__)   //!< Print info message
 #else
 #define tr_info(...)
 #endif
 
 #if MBED_TRACE_MAX_LEVEL >= TRACE_LEVEL_WARN
-#define tr_warning(...)         mbed_tracef(TRACE_LEVEL_WARN,    TRACE_GROUP, __VA_ARGS__)   //!< Print warning message
-#define tr_warn(...)            mbed_tracef(TRACE_LEVEL_WARN,    TRACE_GROUP, __VA_ARGS__)   //!< Alternative warning message
+#define tr_warning(...)         mbed_tracef_if(TRACE_LEVEL_WARN,    __VA_ARGS__)   //!< Print warning message
+#define tr_warn(...)            mbed_tracef_if(TRACE_LEVEL_WARN,    __VA_ARGS__)   //!< Alternative warning message
 #else
 #define tr_warning(...)
 #define tr_warn(...)
 #endif
 
 #if MBED_TRACE_MAX_LEVEL >= TRACE_LEVEL_ERROR
-#define tr_error(...)           mbed_tracef(TRACE_LEVEL_ERROR,   TRACE_GROUP, __VA_ARGS__)   //!< Print Error Message
-#define tr_err(...)             mbed_tracef(TRACE_LEVEL_ERROR,   TRACE_GROUP, __VA_ARGS__)   //!< Alternative error message
+#define tr_error(...)           mbed_tracef_if(TRACE_LEVEL_ERROR,   __VA_ARGS__)   //!< Print Error Message
+#define tr_err(...)             mbed_tracef_if(TRACE_LEVEL_ERROR,   __VA_ARGS__)   //!< Alternative error message
 #else
 #define tr_error(...)
 #define tr_err(...)
@@ -286,6 +303,17 @@ void mbed_trace_include_filters_set(char* filters);
 /** get trace include filters
  */
 const char* mbed_trace_include_filters_get(void);
+/**
+ * Check if a trace would be printed, without formatting it
+ * Used by the tr_ macros to skip the arguments of disabled traces. The level is
+ * compared to the active levels, and the group to a cache of the filter results.
+ * Groups of more than 4 characters are not cached and only filtered when traced.
+ *
+ * @param dlevel debug level
+ * @param grp    trace group
+ * @return false when the trace would not be printed
+ */
+bool mbed_trace_enabled(uint8_t dlevel, const char *grp);
 /**
  * General trace function
  * This should be used every time when user want to print out something important thing
@@ -328,6 +356,26 @@ void mbed_vtracef(uint8_t dlevel, const char* grp, const char *fmt, va_list ap);
  *  Get last trace from buffer
  */
 const char* mbed_trace_last(void);
+/**
+ * Print the traces recorded in deferred mode
+ * When built with MBED_TRACE_DEFERRED_BUFFER_SIZE, traces other than tr_cmdline()
+ * are not formatted by the calling thread. The level, group, format string pointer
+ * and arguments are copied to a ring buffer, and this function formats and prints
+ * them, for example from an idle tasklet. Format strings and groups must therefore
+ * be constant, string arguments are copied.
+ * The calling thread holds the trace mutex only for the copy, and this function
+ * does not take it, so it must not be called from several threads at a time.
+ * When the buffer is full, traces are lost and their number is printed.
+ *
+ * @return number of traces printed
+ */
+int mbed_trace_deferred_flush(void);
+/**
+ * Set time stamp function for deferred traces
+ * The time is taken when a trace is recorded and printed as the trace prefix
+ * instead of the prefix function, which would only give the time of printing.
+ */
+void mbed_trace_deferred_time_function_set(uint32_t (*time_f)(void));
 #if MBED_CONF_MBED_TRACE_FEA_IPV6 == 1
 /**
  * mbed_tracef helping function for convert ipv6
@@ -398,9 +446,12 @@ char* mbed_trace_array(const uint8_t* buf, uint16_t len);
 #undef mbed_trace_exclude_filters_get
 #undef mbed_trace_include_filters_set
 #undef mbed_trace_include_filters_get
+#undef mbed_trace_enabled
 #undef mbed_tracef
 #undef mbed_vtracef
 #undef mbed_trace_last
+#undef mbed_trace_deferred_flush
+#undef mbed_trace_deferred_time_function_set
 #undef mbed_trace_ipv6
 #undef mbed_trace_ipv6_prefix
 #undef mbed_trace_array
@@ -423,7 +474,10 @@ char* mbed_trace_array(const uint8_t* buf, uint16_t len);
 #define mbed_trace_exclude_filters_get(...)         ((const char *) 0)
 #define mbed_trace_include_filters_set(...)         ((void) 0)
 #define mbed_trace_include_filters_get(...)         ((const char *) 0)
+#define mbed_trace_enabled(...)                     ((bool) 0)
 #define mbed_trace_last(...)                        ((const char *) 0)
+#define mbed_trace_deferred_flush(...)              ((int) 0)
+#define mbed_trace_deferred_time_function_set(...)  ((void) 0)
 #define mbed_tracef(...)                            ((void) 0)
 #define mbed_vtracef(...)                           ((void) 0)
 /**
@@ -16,6 +16,8 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #ifdef MBED_CONF_MBED_TRACE_ENABLE
 #undef MBED_CONF_MBED_TRACE_ENABLE
@@ -92,10 +94,51 @@
 #define DEFAULT_TRACE_CONFIG              TRACE_MODE_COLOR | TRACE_ACTIVE_LEVEL_ALL | TRACE_CARRIAGE_RETURN
 #endif
 
+/** deferred mode ring buffer size in bytes, a power of two. Traces are then
+    recorded unformatted and printed by mbed_trace_deferred_flush().
+    0 formats and prints traces in the calling thread. */
+#ifndef MBED_TRACE_DEFERRED_BUFFER_SIZE
+#define MBED_TRACE_DEFERRED_BUFFER_SIZE   0
+#endif
+
+/** max size of one deferred trace with its arguments in bytes */
+#ifndef MBED_TRACE_DEFERRED_RECORD_LENGTH
+#define MBED_TRACE_DEFERRED_RECORD_LENGTH 256
+#endif
+
+/** max length of a string argument copied to a deferred trace */
+#ifndef MBED_TRACE_DEFERRED_STRING_LENGTH
+#define MBED_TRACE_DEFERRED_STRING_LENGTH 64
+#endif
+
+#if MBED_TRACE_DEFERRED_BUFFER_SIZE
+#if !defined(__GNUC__)
+#error "MBED_TRACE_DEFERRED_BUFFER_SIZE needs the GCC atomic builtins"
+#endif
+#if (MBED_TRACE_DEFERRED_BUFFER_SIZE & (MBED_TRACE_DEFERRED_BUFFER_SIZE - 1)) != 0
+#error "MBED_TRACE_DEFERRED_BUFFER_SIZE must be a power of two"
+#endif
+#if MBED_TRACE_DEFERRED_BUFFER_SIZE < MBED_TRACE_DEFERRED_RECORD_LENGTH || MBED_TRACE_DEFERRED_RECORD_LENGTH > 0xFFFF
+#error "MBED_TRACE_DEFERRED_RECORD_LENGTH must fit in MBED_TRACE_DEFERRED_BUFFER_SIZE and 16 bits"
+#endif
+#endif
+
+/** number of groups, of each filter result, cached for the group filters */
+#ifndef MBED_TRACE_GROUP_CACHE_SIZE
+#define MBED_TRACE_GROUP_CACHE_SIZE       16
+#endif
+
+#if (MBED_TRACE_GROUP_CACHE_SIZE & (MBED_TRACE_GROUP_CACHE_SIZE - 1)) != 0
+#error "MBED_TRACE_GROUP_CACHE_SIZE must be zero or a power of two"
+#endif
+
 /** default print function, just redirect str to printf */
 static void mbed_trace_realloc( char **buffer, int *length_ptr, int new_length);
 static void mbed_trace_default_print(const char *str);
 static void mbed_trace_reset_tmp(void);
+static void mbed_trace_filters_changed(void);
+static void mbed_trace_print_line(char *line, int line_length, const char *prefix,
+                                  uint8_t dlevel, const char *grp, const char *fmt, va_list ap);
 
 typedef struct trace_s {
     /** trace configuration bits */
@@ -106,6 +149,14 @@ typedef struct trace_s {
     char *filters_include;
     /** Filters length */
     int filters_length;
+    /** true when either filter is set */
+    bool filters_active;
+#if MBED_TRACE_GROUP_CACHE_SIZE
+    /** ids of groups filtered out, indexed by the hash of the id */
+    uint32_t groups_skipped[MBED_TRACE_GROUP_CACHE_SIZE];
+    /** ids of groups passing the filters */
+    uint32_t groups_passed[MBED_TRACE_GROUP_CACHE_SIZE];
+#endif
     /** trace line */
     char *line;
     /** trace line length */
@@ -131,6 +182,22 @@ typedef struct trace_s {
     void (*mutex_release_f)(void);
     /** number of times the mutex has been locked */
     int mutex_lock_count;
+#if MBED_TRACE_DEFERRED_BUFFER_SIZE
+    /** ring buffer of deferred traces */
+    uint8_t *deferred;
+    /** write position, advanced by the tracing threads holding the mutex */
+    uint32_t deferred_head;
+    /** read position, advanced by mbed_trace_deferred_flush() */
+    uint32_t deferred_tail;
+    /** traces lost because the ring buffer was full */
+    uint32_t deferred_lost;
+    /** trace line of mbed_trace_deferred_flush(), the tracing threads use line */
+    char *deferred_line;
+    /** trace text of mbed_trace_deferred_flush() */
+    char *deferred_text;
+    /** time stamp function for deferred traces */
+    uint32_t (*deferred_time_f)(void);
+#endif
 } trace_t;
 
 static trace_t m_trace = {
@@ -162,6 +229,21 @@ int mbed_trace_init(void)
     }
     m_trace.tmp_data_ptr = m_trace.tmp_data;
 
+#if MBED_TRACE_DEFERRED_BUFFER_SIZE
+    if (m_trace.deferred == NULL) {
+        m_trace.deferred = MBED_TRACE_MEM_ALLOC(MBED_TRACE_DEFERRED_BUFFER_SIZE);
+        m_trace.deferred_head = 0;
+        m_trace.deferred_tail = 0;
+        m_trace.deferred_lost = 0;
+    }
+    if (m_trace.deferred_line == NULL) {
+        m_trace.deferred_line = MBED_TRACE_MEM_ALLOC(m_trace.line_length);
+    }
+    if (m_trace.deferred_text == NULL) {
+        m_trace.deferred_text = MBED_TRACE_MEM_ALLOC(m_trace.line_length);
+    }
+#endif
+
     if (m_trace.filters_exclude == NULL) {
         m_trace.filters_exclude = MBED_TRACE_MEM_ALLOC(m_trace.filters_length);
     }
@@ -172,7 +254,13 @@ int mbed_trace_init(void)
     if (m_trace.line == NULL ||
             m_trace.tmp_data == NULL ||
             m_trace.filters_exclude == NULL  ||
-            m_trace.filters_include == NULL) {
+            m_trace.filters_include == NULL
+#if MBED_TRACE_DEFERRED_BUFFER_SIZE
+            || m_trace.deferred == NULL
+            || m_trace.deferred_line == NULL
+            || m_trace.deferred_text == NULL
+#endif
+       ) {
         //memory allocation fail
         mbed_trace_free();
         return -1;
@@ -181,6 +269,7 @@ int mbed_trace_init(void)
     memset(m_trace.filters_exclude, 0, m_trace.filters_length);
     memset(m_trace.filters_include, 0, m_trace.filters_length);
     memset(m_trace.line, 0, m_trace.line_length);
+    mbed_trace_filters_changed();
 
     return 0;
 }
@@ -191,12 +280,22 @@ void mbed_trace_free(void)
     MBED_TRACE_MEM_FREE(m_trace.tmp_data);
     MBED_TRACE_MEM_FREE(m_trace.filters_exclude);
     MBED_TRACE_MEM_FREE(m_trace.filters_include);
+#if MBED_TRACE_DEFERRED_BUFFER_SIZE
+    MBED_TRACE_MEM_FREE(m_trace.deferred);
+    MBED_TRACE_MEM_FREE(m_trace.deferred_line);
+    MBED_TRACE_MEM_FREE(m_trace.deferred_text);
+    m_trace.deferred = 0;
+    m_trace.deferred_line = 0;
+    m_trace.deferred_text = 0;
+    m_trace.deferred_time_f = 0;
+#endif
 
     // reset to default values
     m_trace.trace_config = DEFAULT_TRACE_CONFIG;
     m_trace.filters_exclude = 0;
     m_trace.filters_include = 0;
     m_trace.filters_length = DEFAULT_TRACE_FILTER_LENGTH;
+    m_trace.filters_active = false;
     m_trace.line = 0;
     m_trace.line_length = DEFAULT_TRACE_LINE_LENGTH;
     m_trace.tmp_data = 0;
@@ -219,6 +318,10 @@ void mbed_trace_buffer_sizes(int lineLength, int tmpLength)
 {
     if( lineLength > 0 ) {
         mbed_trace_realloc( &(m_trace.line), &m_trace.line_length, lineLength );
+#if MBED_TRACE_DEFERRED_BUFFER_SIZE
+        mbed_trace_realloc( &(m_trace.deferred_line), &m_trace.line_length, lineLength );
+        mbed_trace_realloc( &(m_trace.deferred_text), &m_trace.line_length, lineLength );
+#endif
     }
     if( tmpLength > 0 ) {
         mbed_trace_realloc( &(m_trace.tmp_data), &m_trace.tmp_data_length, tmpLength);
@@ -264,6 +367,7 @@ void mbed_trace_exclude_filters_set(char *filters)
     } else {
         m_trace.filters_exclude[0] = 0;
     }
+    mbed_trace_filters_changed();
 }
 const char *mbed_trace_exclude_filters_get(void)
 {
@@ -280,123 +384,123 @@ void mbed_trace_include_filters_set(char *filters)
     } else {
         m_trace.filters_include[0] = 0;
     }
+    mbed_trace_filters_changed();
+}
+static void mbed_trace_filters_changed(void)
+{
+    m_trace.filters_active = m_trace.filters_exclude[0] != '\0' || m_trace.filters_include[0] != '\0';
+#if MBED_TRACE_GROUP_CACHE_SIZE
+    memset(m_trace.groups_skipped, 0, sizeof(m_trace.groups_skipped));
+    memset(m_trace.groups_passed, 0, sizeof(m_trace.groups_passed));
+#endif
+}
+#if MBED_TRACE_GROUP_CACHE_SIZE
+/* Pack a group of up to 4 characters to an id, longer groups give 0 and are not cached */
+static uint32_t mbed_trace_group_id(const char *grp)
+{
+    uint32_t id = 0;
+    uint8_t i;
+    for (i = 0; i < 4 && grp[i] != '\0'; i++) {
+        id = (id << 8) | (uint8_t)grp[i];
+    }
+    return grp[i] == '\0' ? id : 0;
+}
+static uint32_t mbed_trace_group_slot(uint32_t id)
+{
+    return (id ^ (id >> 9) ^ (id >> 18)) & (MBED_TRACE_GROUP_CACHE_SIZE - 1);
+}
+#endif
+static bool mbed_trace_filtered(const char *grp)
+{
+    if (m_trace.filters_exclude[0] != '\0' &&
+            strstr(m_trace.filters_exclude, grp) != 0) {
+        //grp was in exclude list
+        return true;
+    }
+    if (m_trace.filters_include[0] != '\0' &&
+            strstr(m_trace.filters_include, grp) == 0) {
+        //grp was not in include list
+        return true;
+    }
+    return false;
 }
 static int8_t mbed_trace_skip(int8_t dlevel, const char *grp)
 {
-    if (dlevel >= 0 && grp != 0) {
+    if (dlevel >= 0 && grp != 0 && m_trace.filters_active) {
         // filter debug prints only when dlevel is >0 and grp is given
-
-        /// @TODO this could be much better..
-        if (m_trace.filters_exclude[0] != '\0' &&
-                strstr(m_trace.filters_exclude, grp) != 0) {
-            //grp was in exclude list
-            return 1;
+#if MBED_TRACE_GROUP_CACHE_SIZE
+        // the filters are matched once per group, and the result cached
+        uint32_t id = mbed_trace_group_id(grp);
+        uint32_t slot = mbed_trace_group_slot(id);
+        if (id != 0) {
+            if (m_trace.groups_skipped[slot] == id) {
+                return 1;
+            }
+            if (m_trace.groups_passed[slot] == id) {
+                return 0;
+            }
         }
-        if (m_trace.filters_include[0] != '\0' &&
-                strstr(m_trace.filters_include, grp) == 0) {
-            //grp was in include list
-            return 1;
+        bool filtered = mbed_trace_filtered(grp);
+        if (id != 0) {
+            if (filtered) {
+                m_trace.groups_skipped[slot] = id;
+            } else {
+                m_trace.groups_passed[slot] = id;
+            }
         }
+        return filtered;
+#else
+        return mbed_trace_filtered(grp);
+#endif
     }
     return 0;
 }
-static void mbed_trace_default_print(const char *str)
+bool mbed_trace_enabled(uint8_t dlevel, const char *grp)
 {
-    puts(str);
+    // called without the mutex, so only the cached filter results are used
+    if (((m_trace.trace_config & TRACE_MASK_LEVEL) & dlevel) == 0) {
+        return false;
+    }
+#if MBED_TRACE_GROUP_CACHE_SIZE
+    if (m_trace.filters_active && grp != 0) {
+        uint32_t id = mbed_trace_group_id(grp);
+        if (id != 0 && m_trace.groups_skipped[mbed_trace_group_slot(id)] == id) {
+            return false;
+        }
+    }
+#else
+    (void) grp;
+#endif
+    return true;
 }
-void mbed_tracef(uint8_t dlevel, const char *grp, const char *fmt, ...)
+static void mbed_trace_default_print(const char *str)
 {
-    va_list ap;
-    va_start(ap, fmt);
-    mbed_vtracef(dlevel, grp, fmt, ap);
-    va_end(ap);
+    puts(str);
 }
-void mbed_vtracef(uint8_t dlevel, const char* grp, const char *fmt, va_list ap)
+/* Format a trace line to line and print it, prefix replaces the prefix function when given */
+static void mbed_trace_print_line(char *line, int line_length, const char *prefix,
+                                  uint8_t dlevel, const char *grp, const char *fmt, va_list ap)
 {
-    if ( m_trace.mutex_wait_f ) {
-        m_trace.mutex_wait_f();
-        m_trace.mutex_lock_count++;
-    }
-
-    if (NULL == m_trace.line) {
-        goto end;
-    }
-
-    m_trace.line[0] = 0; //by default trace is empty
+    bool color = (m_trace.trace_config & TRACE_MODE_COLOR) != 0;
+    bool plain = (m_trace.trace_config & TRACE_MODE_PLAIN) != 0;
+    bool cr    = (m_trace.trace_config & TRACE_CARRIAGE_RETURN) != 0;
 
-    if (mbed_trace_skip(dlevel, grp) || fmt == 0 || grp == 0 || !m_trace.printf) {
-        //return tmp data pointer back to the beginning
-        mbed_trace_reset_tmp();
-        goto end;
-    }
-    if ((m_trace.trace_config & TRACE_MASK_LEVEL) &  dlevel) {
-        bool color = (m_trace.trace_config & TRACE_MODE_COLOR) != 0;
-        bool plain = (m_trace.trace_config & TRACE_MODE_PLAIN) != 0;
-        bool cr    = (m_trace.trace_config & TRACE_CARRIAGE_RETURN) != 0;
-
-        int retval = 0, bLeft = m_trace.line_length;
-        char *ptr = m_trace.line;
-        if (plain == true || dlevel == TRACE_LEVEL_CMD) {
-            //add trace data
-            retval = vsnprintf(ptr, bLeft, fmt, ap);
-            if (dlevel == TRACE_LEVEL_CMD && m_trace.cmd_printf) {
-                m_trace.cmd_printf(m_trace.line);
-                m_trace.cmd_printf("\n");
-            } else {
-                //print out whole data
-                m_trace.printf(m_trace.line);
-            }
+    int retval = 0, bLeft = line_length;
+    char *ptr = line;
+    if (plain == true || dlevel == TRACE_LEVEL_CMD) {
+        //add trace data
+        retval = vsnprintf(ptr, bLeft, fmt, ap);
+        if (dlevel == TRACE_LEVEL_CMD && m_trace.cmd_printf) {
+            m_trace.cmd_printf(line);
+            m_trace.cmd_printf("\n");
         } else {
-            if (color) {
-                if (cr) {
-                    retval = snprintf(ptr, bLeft, "\r\x1b[2K");
-                    if (retval >= bLeft) {
-                        retval = 0;
-                    }
-                    if (retval > 0) {
-                        ptr += retval;
-                        bLeft -= retval;
-                    }
-                }
-                if (bLeft > 0) {
-                    //include color in ANSI/VT100 escape code
-                    switch (dlevel) {
-                        case (TRACE_LEVEL_ERROR):
-                            retval = snprintf(ptr, bLeft, "%s", VT100_COLOR_ERROR);
-                            break;
-                        case (TRACE_LEVEL_WARN):
-                            retval = snprintf(ptr, bLeft, "%s", VT100_COLOR_WARN);
-                            break;
-                        case (TRACE_LEVEL_INFO):
-                            retval = snprintf(ptr, bLeft, "%s", VT100_COLOR_INFO);
-                            break;
-                        case (TRACE_LEVEL_DEBUG):
-                            retval = snprintf(ptr, bLeft, "%s", VT100_COLOR_DEBUG);
-                            break;
-                        default:
-                            color = 0; //avoid unneeded color-terminate code
-                            retval = 0;
-                            break;
-                    }
-                    if (retval >= bLeft) {
-                        retval = 0;
-                    }
-                    if (retval > 0 && color) {
-                        ptr += retval;
-                        bLeft -= retval;
-                    }
-                }
-
-            }
-            if (bLeft > 0 && m_trace.prefix_f) {
-                //find out length of body
-                size_t sz = 0;
-                va_list ap2;
-                va_copy(ap2, ap);
-                sz = vsnprintf(NULL, 0, fmt, ap2) + retval + (retval ? 4 : 0);
-                va_end(ap2);
-                //add prefix string
-                retval = snprintf(ptr, bLeft, "%s", m_trace.prefix_f(sz));
+            //print out whole data
+            m_trace.printf(line);
+        }
+    } else {
+        if (color) {
+            if (cr) {
+                retval = snprintf(ptr, bLeft, "\r\x1b[2K");
                 if (retval >= bLeft) {
                     retval = 0;
                 }
@@ -406,70 +510,593 @@ void mbed_vtracef(uint8_t dlevel, const char* grp, const char *fmt, va_list ap)
                 }
             }
             if (bLeft > 0) {
-                //add group tag
+                //include color in ANSI/VT100 escape code
                 switch (dlevel) {
                     case (TRACE_LEVEL_ERROR):
-                        retval = snprintf(ptr, bLeft, "[ERR ][%-4s]: ", grp);
+                        retval = snprintf(ptr, bLeft, "%s", VT100_COLOR_ERROR);
                         break;
                     case (TRACE_LEVEL_WARN):
-                        retval = snprintf(ptr, bLeft, "[WARN][%-4s]: ", grp);
+                        retval = snprintf(ptr, bLeft, "%s", VT100_COLOR_WARN);
                         break;
                     case (TRACE_LEVEL_INFO):
-                        retval = snprintf(ptr, bLeft, "[INFO][%-4s]: ", grp);
+                        retval = snprintf(ptr, bLeft, "%s", VT100_COLOR_INFO);
                         break;
                     case (TRACE_LEVEL_DEBUG):
-                        retval = snprintf(ptr, bLeft, "[DBG ][%-4s]: ", grp);
+                        retval = snprintf(ptr, bLeft, "%s", VT100_COLOR_DEBUG);
                         break;
                     default:
-                        retval = snprintf(ptr, bLeft, "              ");
+                        color = 0; //avoid unneeded color-terminate code
+                        retval = 0;
                         break;
                 }
                 if (retval >= bLeft) {
                     retval = 0;
                 }
-                if (retval > 0) {
+                if (retval > 0 && color) {
                     ptr += retval;
                     bLeft -= retval;
                 }
             }
-            if (retval > 0 && bLeft > 0) {
-                //add trace text
-                retval = vsnprintf(ptr, bLeft, fmt, ap);
-                if (retval >= bLeft) {
-                    retval = 0;
-                }
-                if (retval > 0) {
-                    ptr += retval;
-                    bLeft -= retval;
-                }
+
+        }
+        if (bLeft > 0 && (prefix || m_trace.prefix_f)) {
+            if (!prefix) {
+                //find out length of body
+                size_t sz = 0;
+                va_list ap2;
+                va_copy(ap2, ap);
+                sz = vsnprintf(NULL, 0, fmt, ap2) + retval + (retval ? 4 : 0);
+                va_end(ap2);
+                prefix = m_trace.prefix_f(sz);
+            }
+            //add prefix string
+            retval = snprintf(ptr, bLeft, "%s", prefix);
+            if (retval >= bLeft) {
+                retval = 0;
+            }
+            if (retval > 0) {
+                ptr += retval;
+                bLeft -= retval;
+            }
+        }
+        if (bLeft > 0) {
+            //add group tag
+            switch (dlevel) {
+                case (TRACE_LEVEL_ERROR):
+                    retval = snprintf(ptr, bLeft, "[ERR ][%-4s]: ", grp);
+                    break;
+                case (TRACE_LEVEL_WARN):
+                    retval = snprintf(ptr, bLeft, "[WARN][%-4s]: ", grp);
+                    break;
+                case (TRACE_LEVEL_INFO):
+                    retval = snprintf(ptr, bLeft, "[INFO][%-4s]: ", grp);
+                    break;
+                case (TRACE_LEVEL_DEBUG):
+                    retval = snprintf(ptr, bLeft, "[DBG ][%-4s]: ", grp);
+                    break;
+                default:
+                    retval = snprintf(ptr, bLeft, "              ");
+                    break;
+            }
+            if (retval >= bLeft) {
+                retval = 0;
+            }
+            if (retval > 0) {
+                ptr += retval;
+                bLeft -= retval;
             }
+        }
+        if (retval > 0 && bLeft > 0) {
+            //add trace text
+            retval = vsnprintf(ptr, bLeft, fmt, ap);
+            if (retval >= bLeft) {
+                retval = 0;
+            }
+            if (retval > 0) {
+                ptr += retval;
+                bLeft -= retval;
+            }
+        }
 
-            if (retval > 0 && bLeft > 0  && m_trace.suffix_f) {
-                //add suffix string
-                retval = snprintf(ptr, bLeft, "%s", m_trace.suffix_f());
-                if (retval >= bLeft) {
-                    retval = 0;
+        if (retval > 0 && bLeft > 0  && m_trace.suffix_f) {
+            //add suffix string
+            retval = snprintf(ptr, bLeft, "%s", m_trace.suffix_f());
+            if (retval >= bLeft) {
+                retval = 0;
+            }
+            if (retval > 0) {
+                ptr += retval;
+                bLeft -= retval;
+            }
+        }
+
+        if (retval > 0 && bLeft > 0  && color) {
+            //add zero color VT100 when color mode
+            retval = snprintf(ptr, bLeft, "\x1b[0m");
+            if (retval >= bLeft) {
+                retval = 0;
+            }
+            if (retval > 0) {
+                // not used anymore
+                //ptr += retval;
+                //bLeft -= retval;
+            }
+        }
+        //print out whole data
+        m_trace.printf(line);
+    }
+}
+
+#if MBED_TRACE_DEFERRED_BUFFER_SIZE
+/* Deferred traces are recorded as the header followed by the arguments in
+ * the order of the format string, copied with memcpy so that they need no
+ * alignment. String arguments are copied with their terminating zero. The
+ * format string and group are stored as pointers, so they must be constants.
+ */
+typedef struct {
+    uint16_t length;        /** record length in bytes, header included */
+    uint8_t dlevel;
+    uint8_t truncated;      /** arguments did not fit in the record */
+    uint32_t time;
+    const char *grp;
+    const char *fmt;
+} trace_record_t;
+
+typedef enum {
+    TRACE_ARG_NONE,
+    TRACE_ARG_INT,
+    TRACE_ARG_LONG,
+    TRACE_ARG_LLONG,
+    TRACE_ARG_SIZE,
+    TRACE_ARG_INTMAX,
+    TRACE_ARG_PTRDIFF,
+    TRACE_ARG_DOUBLE,
+    TRACE_ARG_LDOUBLE,
+    TRACE_ARG_POINTER,
+    TRACE_ARG_STRING
+} trace_arg_t;
+
+typedef struct {
+    const char *end;        /** first character after the conversion */
+    bool width_arg;         /** width given with '*' */
+    bool precision_arg;     /** precision given with '*' */
+    char length;            /** length modifier, 'H' for hh and 'q' for ll */
+    char conversion;
+} trace_spec_t;
+
+/* Parse the conversion specification after a '%', false if it is not supported */
+static bool mbed_trace_spec_parse(const char *fmt, trace_spec_t *spec)
+{
+    memset(spec, 0, sizeof(*spec));
+    while (*fmt && strchr("-+ #0'", *fmt)) {
+        fmt++;
+    }
+    if (*fmt == '*') {
+        spec->width_arg = true;
+        fmt++;
+    }
+    while (*fmt >= '0' && *fmt <= '9') {
+        fmt++;
+    }
+    if (*fmt == '.') {
+        fmt++;
+        if (*fmt == '*') {
+            spec->precision_arg = true;
+            fmt++;
+        }
+        while (*fmt >= '0' && *fmt <= '9') {
+            fmt++;
+        }
+    }
+    if (*fmt == 'h' || *fmt == 'l') {
+        spec->length = *fmt++;
+        if (*fmt == spec->length) {
+            spec->length = (spec->length == 'h') ? 'H' : 'q';
+            fmt++;
+        }
+    } else if (*fmt && strchr("Lqjzt", *fmt)) {
+        spec->length = *fmt++;
+    }
+    spec->conversion = *fmt;
+    spec->end = fmt + 1;
+    return *fmt && strchr("diouxXcfFeEgGaAspn%", *fmt);
+}
+
+static trace_arg_t mbed_trace_spec_arg(const trace_spec_t *spec)
+{
+    switch (spec->conversion) {
+        case '%':
+            return TRACE_ARG_NONE;
+        case 's':
+            return TRACE_ARG_STRING;
+        case 'p':
+        case 'n':
+            return TRACE_ARG_POINTER;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            return (spec->length == 'L') ? TRACE_ARG_LDOUBLE : TRACE_ARG_DOUBLE;
+        default:
+            break;
+    }
+    switch (spec->length) {
+        case 'l':
+            return TRACE_ARG_LONG;
+        case 'q':
+            return TRACE_ARG_LLONG;
+        case 'z':
+            return TRACE_ARG_SIZE;
+        case 'j':
+            return TRACE_ARG_INTMAX;
+        case 't':
+            return TRACE_ARG_PTRDIFF;
+        default:
+            return TRACE_ARG_INT;
+    }
+}
+
+static bool mbed_trace_deferred_put(uint8_t **pos, const uint8_t *end, const void *value, size_t size)
+{
+    if ((size_t)(end - *pos) < size) {
+        return false;
+    }
+    memcpy(*pos, value, size);
+    *pos += size;
+    return true;
+}
+
+static bool mbed_trace_deferred_get(const uint8_t **pos, const uint8_t *end, void *value, size_t size)
+{
+    if ((size_t)(end - *pos) < size) {
+        return false;
+    }
+    memcpy(value, *pos, size);
+    *pos += size;
+    return true;
+}
+
+/* Copy the arguments to the record, returns false if they did not all fit */
+static bool mbed_trace_deferred_put_args(uint8_t **pos, const uint8_t *end, const char *fmt, va_list ap)
+{
+    while ((fmt = strchr(fmt, '%')) != NULL) {
+        trace_spec_t spec;
+        if (!mbed_trace_spec_parse(fmt + 1, &spec)) {
+            // the arguments after an unknown conversion can not be found
+            return false;
+        }
+        fmt = spec.end;
+
+        if (spec.width_arg) {
+            int value = va_arg(ap, int);
+            if (!mbed_trace_deferred_put(pos, end, &value, sizeof(value))) {
+                return false;
+            }
+        }
+        if (spec.precision_arg) {
+            int value = va_arg(ap, int);
+            if (!mbed_trace_deferred_put(pos, end, &value, sizeof(value))) {
+                return false;
+            }
+        }
+
+        bool stored = true;
+        switch (mbed_trace_spec_arg(&spec)) {
+            case TRACE_ARG_NONE:
+                break;
+            case TRACE_ARG_INT: {
+                int value = va_arg(ap, int);
+                stored = mbed_trace_deferred_put(pos, end, &value, sizeof(value));
+                break;
+            }
+            case TRACE_ARG_LONG: {
+                long value = va_arg(ap, long);
+                stored = mbed_trace_deferred_put(pos, end, &value, sizeof(value));
+                break;
+            }
+            case TRACE_ARG_LLONG: {
+                long long value = va_arg(ap, long long);
+                stored = mbed_trace_deferred_put(pos, end, &value, sizeof(value));
+                break;
+            }
+            case TRACE_ARG_SIZE: {
+                size_t value = va_arg(ap, size_t);
+                stored = mbed_trace_deferred_put(pos, end, &value, sizeof(value));
+                break;
+            }
+            case TRACE_ARG_INTMAX: {
+                intmax_t value = va_arg(ap, intmax_t);
+                stored = mbed_trace_deferred_put(pos, end, &value, sizeof(value));
+                break;
+            }
+            case TRACE_ARG_PTRDIFF: {
+                ptrdiff_t value = va_arg(ap, ptrdiff_t);
+                stored = mbed_trace_deferred_put(pos, end, &value, sizeof(value));
+                break;
+            }
+            case TRACE_ARG_DOUBLE: {
+                double value = va_arg(ap, double);
+                stored = mbed_trace_deferred_put(pos, end, &value, sizeof(value));
+                break;
+            }
+            case TRACE_ARG_LDOUBLE: {
+                long double value = va_arg(ap, long double);
+                stored = mbed_trace_deferred_put(pos, end, &value, sizeof(value));
+                break;
+            }
+            case TRACE_ARG_POINTER: {
+                void *value = va_arg(ap, void *);
+                stored = mbed_trace_deferred_put(pos, end, &value, sizeof(value));
+                break;
+            }
+            case TRACE_ARG_STRING: {
+                // strings may be temporary, like the ones of mbed_trace_array()
+                const char *value = va_arg(ap, const char *);
+                size_t length = 0;
+                if (value == NULL || spec.length == 'l') {
+                    value = (value == NULL) ? "(null)" : "";
                 }
-                if (retval > 0) {
-                    ptr += retval;
-                    bLeft -= retval;
+                while (length < MBED_TRACE_DEFERRED_STRING_LENGTH && value[length]) {
+                    length++;
+                }
+                stored = (size_t)(end - *pos) > length;
+                if (stored) {
+                    memcpy(*pos, value, length);
+                    (*pos)[length] = 0;
+                    *pos += length + 1;
                 }
+                break;
             }
+        }
+        if (!stored) {
+            return false;
+        }
+    }
+    return true;
+}
 
-            if (retval > 0 && bLeft > 0  && color) {
-                //add zero color VT100 when color mode
-                retval = snprintf(ptr, bLeft, "\x1b[0m");
-                if (retval >= bLeft) {
-                    retval = 0;
-                }
-                if (retval > 0) {
-                    // not used anymore
-                    //ptr += retval;
-                    //bLeft -= retval;
+/* Record a trace, called with the trace mutex held */
+static void mbed_trace_deferred_record(uint8_t dlevel, const char *grp, const char *fmt, va_list ap)
+{
+    uint8_t data[MBED_TRACE_DEFERRED_RECORD_LENGTH];
+    uint8_t *pos = data + sizeof(trace_record_t);
+    trace_record_t record;
+
+    record.dlevel = dlevel;
+    record.truncated = !mbed_trace_deferred_put_args(&pos, data + sizeof(data), fmt, ap);
+    record.length = pos - data;
+    record.time = m_trace.deferred_time_f ? m_trace.deferred_time_f() : 0;
+    record.grp = grp;
+    record.fmt = fmt;
+    memcpy(data, &record, sizeof(record));
+
+    // only the tracing thread holding the mutex writes, only the flushing thread reads
+    uint32_t head = m_trace.deferred_head;
+    uint32_t tail = __atomic_load_n(&m_trace.deferred_tail, __ATOMIC_ACQUIRE);
+    if (MBED_TRACE_DEFERRED_BUFFER_SIZE - (head - tail) < record.length) {
+        __atomic_fetch_add(&m_trace.deferred_lost, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    uint32_t offset = head % MBED_TRACE_DEFERRED_BUFFER_SIZE;
+    uint32_t first = MBED_TRACE_DEFERRED_BUFFER_SIZE - offset;
+    if (first > record.length) {
+        first = record.length;
+    }
+    memcpy(m_trace.deferred + offset, data, first);
+    memcpy(m_trace.deferred, data + first, record.length - first);
+    __atomic_store_n(&m_trace.deferred_head, head + record.length, __ATOMIC_RELEASE);
+}
+
+static void mbed_trace_deferred_read(uint32_t tail, void *data, uint32_t length)
+{
+    uint32_t offset = tail % MBED_TRACE_DEFERRED_BUFFER_SIZE;
+    uint32_t first = MBED_TRACE_DEFERRED_BUFFER_SIZE - offset;
+    if (first > length) {
+        first = length;
+    }
+    memcpy(data, m_trace.deferred + offset, first);
+    memcpy((uint8_t *)data + first, m_trace.deferred, length - first);
+}
+
+/* Format the text of a record, one conversion at a time */
+static void mbed_trace_deferred_format(char *text, int text_length, const trace_record_t *record,
+                                       const uint8_t *pos, const uint8_t *end)
+{
+    const char *fmt = record->fmt;
+    bool complete = true;
+
+    while (*fmt && text_length > 1) {
+        if (*fmt != '%') {
+            *text++ = *fmt++;
+            text_length--;
+            continue;
+        }
+
+        trace_spec_t spec;
+        if (!mbed_trace_spec_parse(fmt + 1, &spec) || spec.end - fmt > 24) {
+            complete = false;
+            break;
+        }
+
+        // conversion with the '*' arguments written out
+        char conversion[48];
+        int length = 0;
+        for (const char *c = fmt; c < spec.end; c++) {
+            if (*c != '*') {
+                conversion[length++] = *c;
+                continue;
+            }
+            int value;
+            if (!mbed_trace_deferred_get(&pos, end, &value, sizeof(value))) {
+                complete = false;
+                break;
+            }
+            if (value < 0 && c[-1] == '.') {
+                length--; // negative precision is taken as if omitted
+            } else {
+                length += snprintf(conversion + length, 12, "%d", value);
+            }
+        }
+        if (!complete) {
+            break;
+        }
+        conversion[length] = 0;
+        fmt = spec.end;
+
+        int retval = 0;
+        switch (mbed_trace_spec_arg(&spec)) {
+            case TRACE_ARG_NONE:
+                retval = snprintf(text, text_length, "%%");
+                break;
+#define TRACE_FORMAT_ARG(type) \
+            { \
+                type value; \
+                complete = mbed_trace_deferred_get(&pos, end, &value, sizeof(value)); \
+                if (complete && spec.conversion != 'n') { \
+                    retval = snprintf(text, text_length, conversion, value); \
+                } \
+                break; \
+            }
+            case TRACE_ARG_INT:
+                TRACE_FORMAT_ARG(int)
+            case TRACE_ARG_LONG:
+                TRACE_FORMAT_ARG(long)
+            case TRACE_ARG_LLONG:
+                TRACE_FORMAT_ARG(long long)
+            case TRACE_ARG_SIZE:
+                TRACE_FORMAT_ARG(size_t)
+            case TRACE_ARG_INTMAX:
+                TRACE_FORMAT_ARG(intmax_t)
+            case TRACE_ARG_PTRDIFF:
+                TRACE_FORMAT_ARG(ptrdiff_t)
+            case TRACE_ARG_DOUBLE:
+                TRACE_FORMAT_ARG(double)
+            case TRACE_ARG_LDOUBLE:
+                TRACE_FORMAT_ARG(long double)
+            case TRACE_ARG_POINTER:
+                TRACE_FORMAT_ARG(void *)
+#undef TRACE_FORMAT_ARG
+            case TRACE_ARG_STRING: {
+                const char *value = (const char *)pos;
+                const uint8_t *value_end = memchr(pos, 0, end - pos);
+                complete = value_end != NULL;
+                if (complete) {
+                    pos = value_end + 1;
+                    retval = snprintf(text, text_length, conversion, value);
                 }
+                break;
             }
-            //print out whole data
-            m_trace.printf(m_trace.line);
+        }
+        if (!complete || retval < 0) {
+            break;
+        }
+        if (retval >= text_length) {
+            retval = text_length - 1;
+        }
+        text += retval;
+        text_length -= retval;
+    }
+
+    if ((!complete || record->truncated) && text_length > 3) {
+        memcpy(text, "...", 3);
+        text += 3;
+    }
+    *text = 0;
+}
+
+static void mbed_trace_deferred_print(const char *prefix, uint8_t dlevel, const char *grp, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    mbed_trace_print_line(m_trace.deferred_line, m_trace.line_length, prefix, dlevel, grp, fmt, ap);
+    va_end(ap);
+}
+#endif
+
+int mbed_trace_deferred_flush(void)
+{
+    int count = 0;
+#if MBED_TRACE_DEFERRED_BUFFER_SIZE
+    if (m_trace.deferred == NULL || m_trace.deferred_line == NULL || m_trace.deferred_text == NULL) {
+        return 0;
+    }
+
+    uint32_t head = __atomic_load_n(&m_trace.deferred_head, __ATOMIC_ACQUIRE);
+    uint32_t tail = m_trace.deferred_tail;
+    while (tail != head) {
+        uint8_t data[MBED_TRACE_DEFERRED_RECORD_LENGTH];
+        trace_record_t record;
+        mbed_trace_deferred_read(tail, &record, sizeof(record));
+        mbed_trace_deferred_read(tail, data, record.length);
+        tail += record.length;
+        __atomic_store_n(&m_trace.deferred_tail, tail, __ATOMIC_RELEASE);
+
+        mbed_trace_deferred_format(m_trace.deferred_text, m_trace.line_length, &record,
+                                   data + sizeof(record), data + record.length);
+        char prefix[16];
+        if (m_trace.deferred_time_f) {
+            snprintf(prefix, sizeof(prefix), "[%lu]", (unsigned long)record.time);
+        }
+        mbed_trace_deferred_print(m_trace.deferred_time_f ? prefix : NULL, record.dlevel, record.grp,
+                                  "%s", m_trace.deferred_text);
+        count++;
+    }
+
+    uint32_t lost = __atomic_exchange_n(&m_trace.deferred_lost, 0, __ATOMIC_RELAXED);
+    if (lost) {
+        mbed_trace_deferred_print(NULL, TRACE_LEVEL_WARN, "mTRC", "%lu traces lost", (unsigned long)lost);
+    }
+#endif
+    return count;
+}
+
+void mbed_trace_deferred_time_function_set(uint32_t (*time_f)(void))
+{
+#if MBED_TRACE_DEFERRED_BUFFER_SIZE
+    m_trace.deferred_time_f = time_f;
+#else
+    (void)time_f;
+#endif
+}
+
+void mbed_tracef(uint8_t dlevel, const char *grp, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    mbed_vtracef(dlevel, grp, fmt, ap);
+    va_end(ap);
+}
+void mbed_vtracef(uint8_t dlevel, const char* grp, const char *fmt, va_list ap)
+{
+    if ( m_trace.mutex_wait_f ) {
+        m_trace.mutex_wait_f();
+        m_trace.mutex_lock_count++;
+    }
+
+    if (NULL == m_trace.line) {
+        goto end;
+    }
+
+    m_trace.line[0] = 0; //by default trace is empty
+
+    if (mbed_trace_skip(dlevel, grp) || fmt == 0 || grp == 0 || !m_trace.printf) {
+        //return tmp data pointer back to the beginning
+        mbed_trace_reset_tmp();
+        goto end;
+    }
+    if ((m_trace.trace_config & TRACE_MASK_LEVEL) &  dlevel) {
+#if MBED_TRACE_DEFERRED_BUFFER_SIZE
+        if (m_trace.deferred && dlevel != TRACE_LEVEL_CMD) {
+            mbed_trace_deferred_record(dlevel, grp, fmt, ap);
+        } else
+#endif
+        {
+            mbed_trace_print_line(m_trace.line, m_trace.line_length, NULL, dlevel, grp, fmt, ap);
         }
         //return tmp data pointer back to the beginning
         mbed_trace_reset_tmp();
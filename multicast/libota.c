@@ -36,6 +36,9 @@
 #include "libota.h"
 
 static void ota_start_timer(ota_timers_e timer_id, uint32_t start_time, uint32_t random_window);
+static uint32_t ota_get_fragment_interval(void);
+static void ota_adapt_fragment_interval_to_request(uint8_t *bitmask_ptr, uint16_t segment_id);
+static void ota_adapt_fragment_interval_to_new_campaign(void);
 static void ota_send_estimated_resend_time(uint32_t resend_time_in_secs);
 static void ota_get_state(char *ota_state_ptr);
 static bool check_session(uint8_t *payload_ptr, uint16_t *payload_index);
@@ -59,6 +62,28 @@ static size_t resend_payload_size = 0;
 #define OTA_CHECKSUM_CALCULATING_BYTE_COUNT                 512 // In bytes
 #define OTA_CHECKSUM_CALCULATING_INTERVAL                   10  // In milliseconds
 
+// Fragment CRC is calculated a byte at a time with a 256 entry table. Slice-by-4 processes four bytes at a time with
+// three more tables built at first use (1.5 kB RAM), so it is enabled by default only on Linux.
+#ifndef LIBOTA_CRC_SLICE_BY_4
+#if defined(__linux__)
+#define LIBOTA_CRC_SLICE_BY_4                               1
+#else
+#define LIBOTA_CRC_SLICE_BY_4                               0
+#endif
+#endif
+
+// Router sends a PARITY command, XOR of the fragments in the group, after every OTA_PARITY_GROUP_SIZE fragments
+// of the multicast pass. Node that missed one fragment of a group rebuilds it without requesting it. 0 disables.
+#ifndef MBED_CLOUD_CLIENT_MULTICAST_PARITY_GROUP_SIZE
+#define OTA_PARITY_GROUP_SIZE                               0
+#else
+#define OTA_PARITY_GROUP_SIZE MBED_CLOUD_CLIENT_MULTICAST_PARITY_GROUP_SIZE
+#endif
+
+#if OTA_PARITY_GROUP_SIZE > 255
+#error "MBED_CLOUD_CLIENT_MULTICAST_PARITY_GROUP_SIZE must not be bigger than 255"
+#endif
+
 // * * * Timer random timeout values (values are seconds) * * *
 #if defined(MBED_CLOUD_CLIENT_MULTICAST_SMALL_NETWORK) || defined(__NANOSIMULATOR__)
 #define CRITICAL_MESSAGE_SEND_COUNT                         2   // How many times critical messages are sent (manifest, start and activate)
@@ -97,6 +122,25 @@ static size_t resend_payload_size = 0;
 // going into missing fragments requesting state.
 #define OTA_START_RESEND_DELAY                              (OTA_MISSING_FRAGMENT_FALLBACK_TIMEOUT / CRITICAL_MESSAGE_SEND_COUNT)
 
+// Router adapts delay between fragments to the fragment requests it gets. Request missing more than
+// 1 / OTA_ADAPTIVE_INTERVAL_LOSS_DIVISOR of its segment increases the delay by half. Campaign that ends without
+// such requests decreases it by one eighth. Delay stays between OTA_MULTICAST_INTERVAL / 4 and OTA_MULTICAST_INTERVAL * 4.
+#ifndef MBED_CLOUD_CLIENT_MULTICAST_ADAPTIVE_INTERVAL
+#define OTA_ADAPTIVE_INTERVAL                               0
+#else
+#define OTA_ADAPTIVE_INTERVAL MBED_CLOUD_CLIENT_MULTICAST_ADAPTIVE_INTERVAL
+#endif
+
+#if OTA_ADAPTIVE_INTERVAL
+#define OTA_ADAPTIVE_INTERVAL_LOSS_DIVISOR                  8
+#define OTA_ADAPTIVE_INTERVAL_MIN                           ((OTA_MULTICAST_INTERVAL / 4) > 0 ? (OTA_MULTICAST_INTERVAL / 4) : 1)
+#define OTA_ADAPTIVE_INTERVAL_MAX                           (OTA_MULTICAST_INTERVAL * 4)
+
+static uint32_t ota_adaptive_interval = OTA_MULTICAST_INTERVAL;
+static bool ota_adaptive_interval_loss_seen = false;
+static bool ota_adaptive_interval_campaign_done = false;
+#endif
+
 void ota_lib_reset()
 {
     if (ota_free_fptr) {
@@ -107,8 +151,12 @@ void ota_lib_reset()
         ota_free_fptr(ota_checksum_calculating_ptr.ota_sha256_context_ptr);
         ota_checksum_calculating_ptr.ota_sha256_context_ptr = NULL;
 
+        ota_free_fptr(ota_fw_deliver_parity_ptr);
+        ota_fw_deliver_parity_ptr = NULL;
+
         ota_free_fptr(ota_parameters.fragments_bitmask_ptr);
         ota_parameters.fragments_bitmask_ptr = NULL;
+        ota_missing_fragment_total_count = 0;
 
         ota_free_fptr(ota_parameters.pull_url_ptr);
         ota_parameters.pull_url_ptr = NULL;
@@ -196,6 +244,7 @@ ota_error_code_e ota_lib_configure(ota_lib_config_data_t *lib_config_data_ptr,
 
     ota_fw_delivering = false;
 
+    ota_missing_fragment_total_count = ota_count_missing_fragments();
     uint16_t missing_fragment_total_count = ota_get_missing_fragment_total_count();
 
     if (missing_fragment_total_count > 0) {
@@ -281,6 +330,12 @@ void ota_socket_receive_data(uint16_t payload_length, uint8_t *payload_ptr, ota_
             }
             break;
 
+        case OTA_CMD_PARITY:
+            if (ota_lib_config_data.device_type != OTA_DEVICE_TYPE_BORDER_ROUTER) {
+                ota_manage_parity_command(payload_length, payload_ptr);
+            }
+            break;
+
         case OTA_CMD_END_FRAGMENTS:
             if (ota_lib_config_data.device_type != OTA_DEVICE_TYPE_BORDER_ROUTER) {
                 ota_manage_end_fragments_command(payload_length, payload_ptr);
@@ -350,14 +405,21 @@ void ota_timer_expired(uint8_t timer_id)
                     // receive at least one fragment to prevent premature missing fragments requesting phase
                     ota_start_timer(OTA_FRAGMENTS_DELIVERING_TIMER, OTA_MULTICAST_INTERVAL, 0);
                 }
+            } else if (ota_fw_deliver_parity_pending) {
+                ota_deliver_parity(ota_lib_config_data.mpl_multicast_socket_addr);
+                ota_start_timer(OTA_FRAGMENTS_DELIVERING_TIMER, ota_get_fragment_interval(), 0);
             } else if (ota_fw_deliver_current_fragment_id <= ota_parameters.fw_fragment_count) {
                 if (ota_deliver_one_fragment(ota_fw_deliver_current_fragment_id, ota_lib_config_data.mpl_multicast_socket_addr) == OTA_OK) {
+                    ota_add_delivered_fragment_to_parity(ota_fw_deliver_current_fragment_id);
                     ota_fw_deliver_current_fragment_id++;
                 }
-                ota_start_timer(OTA_FRAGMENTS_DELIVERING_TIMER, OTA_MULTICAST_INTERVAL, 0);
+                ota_start_timer(OTA_FRAGMENTS_DELIVERING_TIMER, ota_get_fragment_interval(), 0);
             } else {
                 ota_start_timer(OTA_END_FRAGMENTS_TIMER, OTA_NOTIFICATION_TIMER_DELAY, OTA_TIMER_RANDOM_WINDOW);
                 ota_fw_delivering = false;
+
+                ota_free_fptr(ota_fw_deliver_parity_ptr);
+                ota_fw_deliver_parity_ptr = NULL;
             }
         }
     } else if (timer_id == OTA_FRAGMENTS_REQUEST_SERVICE_TIMER) {
@@ -366,7 +428,7 @@ void ota_timer_expired(uint8_t timer_id)
             uint16_t missing_fragment_count_for_requester = ota_get_next_missing_fragment_id_for_requester(false);
 
             if (missing_fragment_count_for_requester > 0) {
-                ota_start_timer(OTA_FRAGMENTS_REQUEST_SERVICE_TIMER, OTA_MULTICAST_INTERVAL, 30);
+                ota_start_timer(OTA_FRAGMENTS_REQUEST_SERVICE_TIMER, ota_get_fragment_interval(), 30);
             } else {
                 tr_info("All requested fragments sent");
                 ota_fragments_request_service = false;
@@ -500,6 +562,7 @@ static ota_error_code_e ota_manage_start_command(uint16_t payload_length, uint8_
 
     if (ota_parameters.fragments_bitmask_ptr != NULL) {
         ota_init_fragments_bit_mask(0x00);
+        ota_free_whole_fw_checksum_context();
         ota_start_timer(OTA_FALLBACK_TIMER, OTA_MISSING_FRAGMENT_FALLBACK_TIMEOUT, 0);
         ota_parameters.ota_state = OTA_STATE_STARTED;
 
@@ -624,11 +687,15 @@ static ota_error_code_e ota_border_router_manage_command(uint16_t payload_length
                     status = ota_start_received_fptr(&ota_parameters);
                     if (status == OTA_OK) {
                         tr_info("State changed to \"OTA STARTED\"");
+                        ota_adapt_fragment_interval_to_new_campaign();
                         // Report to server the estimate for full multicast process.
                         // Initial multicast-phase + enough time to do fragment requests from nodes.
                         // Doubling the estimate is for the fragment request time.
                         uint32_t start_sending_duration = OTA_START_RESEND_DELAY * (CRITICAL_MESSAGE_SEND_COUNT - 1);
-                        uint32_t multicasting_duration = OTA_MULTICAST_INTERVAL * ota_parameters.fw_fragment_count;
+                        uint32_t multicasting_duration = ota_get_fragment_interval() * ota_parameters.fw_fragment_count;
+#if OTA_PARITY_GROUP_SIZE > 0
+                        multicasting_duration += ota_get_fragment_interval() * ((ota_parameters.fw_fragment_count + OTA_PARITY_GROUP_SIZE - 1) / OTA_PARITY_GROUP_SIZE);
+#endif
                         uint32_t resend_time = start_sending_duration + (2 * multicasting_duration) + OTA_MISSING_FRAGMENT_FALLBACK_TIMEOUT;
                         ota_send_estimated_resend_time(resend_time);
                         ota_parameters.ota_state = OTA_STATE_STARTED;
@@ -747,61 +814,7 @@ static void ota_manage_fragment_command(uint16_t payload_length, uint8_t *payloa
             fragment_id > 0 && fragment_id <= ota_parameters.fw_fragment_count) {
 
         if (ota_fragments_request_service == false) {
-            bool fragment_already_received_flag = ota_check_if_fragment_already_received(fragment_id);
-
-            if (fragment_already_received_flag == false) {
-                uint32_t offset = (fragment_id - 1) * (uint32_t)ota_parameters.fw_fragment_byte_count;
-                uint32_t len = ota_parameters.fw_fragment_byte_count;
-
-                if (offset + len > ota_parameters.fw_total_byte_count) {
-                    len = ota_parameters.fw_total_byte_count - offset;
-                }
-
-                uint32_t written_byte_count = ota_write_fw_bytes_fptr(ota_parameters.ota_session_id,
-                                                                      offset,
-                                                                      len,
-                                                                      &payload_ptr[payload_index]);
-
-                if (written_byte_count == len) {
-                    uint16_t segment_bitmask_id = (ota_parameters.fragments_bitmask_length - 1) - ((fragment_id - 1) / 8);
-                    uint8_t segment_bitmask_bit_number = (fragment_id - 1) % 8;
-
-                    uint8_t segment_bitmask_bit = (0x01 << segment_bitmask_bit_number);
-                    ota_parameters.fragments_bitmask_ptr[segment_bitmask_id] |= segment_bitmask_bit;
-
-                    ota_error_code_e rc = ota_store_parameters_fptr(&ota_parameters);
-                    if (rc != OTA_OK) {
-                        tr_err("Storing OTA parameters failed, RC: %d", rc);
-                    }
-
-                    uint16_t missing_fragment_total_count = ota_get_missing_fragment_total_count();
-
-                    tr_info("Missing fragments total count: %u Received fragment total count: %u",
-                            missing_fragment_total_count,
-                            (ota_parameters.fw_fragment_count - missing_fragment_total_count));
-
-                    ota_get_and_log_first_missing_segment(NULL);
-
-                    if (missing_fragment_total_count == 0) {
-                        ota_parameters.ota_state = OTA_STATE_CHECKSUM_CALCULATING;
-
-                        rc = ota_store_parameters_fptr(&ota_parameters);
-                        if (rc != OTA_OK) {
-                            tr_err("Storing OTA parameters failed, RC: %d", rc);
-                        }
-
-                        ota_manage_whole_fw_checksum_calculating();
-                    } else {
-                        ota_start_timer(OTA_FALLBACK_TIMER, OTA_MISSING_FRAGMENT_FALLBACK_TIMEOUT, 0);
-                    }
-                } else {
-                    // TODO! should the whole process to be stopped here? do we know is this a temporary failure or permanent?
-                    // This will lead to case where node is constantly asking missing fragments.
-                    tr_err("Fragment storing to data storage failed. (%"PRIu32" <> %u)", written_byte_count, ota_parameters.fw_fragment_byte_count);
-                }
-            } else {
-                ota_get_and_log_first_missing_segment(NULL);
-            }
+            ota_store_received_fragment(fragment_id, &payload_ptr[payload_index]);
         } else if (ota_fragments_request_service) {
             uint16_t segment_id = (((fragment_id - 1) / OTA_SEGMENT_SIZE) + 1);
 
@@ -851,6 +864,165 @@ static void ota_manage_fragment_command(uint16_t payload_length, uint8_t *payloa
     ota_update_status_resource();
 }
 
+static void ota_store_received_fragment(uint16_t fragment_id, uint8_t *fragment_ptr)
+{
+    bool fragment_already_received_flag = ota_check_if_fragment_already_received(fragment_id);
+
+    if (fragment_already_received_flag == false) {
+        uint32_t offset = (fragment_id - 1) * (uint32_t)ota_parameters.fw_fragment_byte_count;
+        uint32_t len = ota_parameters.fw_fragment_byte_count;
+
+        if (offset + len > ota_parameters.fw_total_byte_count) {
+            len = ota_parameters.fw_total_byte_count - offset;
+        }
+
+        uint32_t written_byte_count = ota_write_fw_bytes_fptr(ota_parameters.ota_session_id,
+                                                              offset,
+                                                              len,
+                                                              fragment_ptr);
+
+        if (written_byte_count == len) {
+            ota_set_fragment_received(fragment_id);
+            ota_update_whole_fw_checksum_with_fragment(offset, fragment_ptr, len);
+
+            ota_error_code_e rc = ota_store_parameters_fptr(&ota_parameters);
+            if (rc != OTA_OK) {
+                tr_err("Storing OTA parameters failed, RC: %d", rc);
+            }
+
+            uint16_t missing_fragment_total_count = ota_get_missing_fragment_total_count();
+
+            tr_info("Missing fragments total count: %u Received fragment total count: %u",
+                    missing_fragment_total_count,
+                    (ota_parameters.fw_fragment_count - missing_fragment_total_count));
+
+            ota_get_and_log_first_missing_segment(NULL);
+
+            if (missing_fragment_total_count == 0) {
+                ota_parameters.ota_state = OTA_STATE_CHECKSUM_CALCULATING;
+
+                rc = ota_store_parameters_fptr(&ota_parameters);
+                if (rc != OTA_OK) {
+                    tr_err("Storing OTA parameters failed, RC: %d", rc);
+                }
+
+                ota_manage_whole_fw_checksum_calculating();
+            } else {
+                ota_start_timer(OTA_FALLBACK_TIMER, OTA_MISSING_FRAGMENT_FALLBACK_TIMEOUT, 0);
+            }
+        } else {
+            // TODO! should the whole process to be stopped here? do we know is this a temporary failure or permanent?
+            // This will lead to case where node is constantly asking missing fragments.
+            tr_err("Fragment storing to data storage failed. (%"PRIu32" <> %u)", written_byte_count, ota_parameters.fw_fragment_byte_count);
+        }
+    } else {
+        ota_get_and_log_first_missing_segment(NULL);
+    }
+}
+
+static void ota_manage_parity_command(uint16_t payload_length, uint8_t *payload_ptr)
+{
+    uint16_t payload_index;
+
+    tr_info("***Received OTA PARITY command. Length: %d", payload_length);
+
+    if (!check_session(payload_ptr, &payload_index)) {
+        tr_warn("Process not found from storage.");
+        return;
+    }
+
+    if (payload_length != ota_parameters.fw_fragment_byte_count + OTA_PARITY_CMD_LENGTH) {
+        tr_err("Received PARITY command data length not correct: %u (%u)",
+               payload_length, ota_parameters.fw_fragment_byte_count + OTA_PARITY_CMD_LENGTH);
+        return;
+    }
+
+    if (ota_parameters.ota_state != OTA_STATE_STARTED &&
+            ota_parameters.ota_state != OTA_STATE_MISSING_FRAGMENTS_REQUESTING) {
+        tr_debug("No need for parity in state %d", ota_parameters.ota_state);
+        return;
+    }
+
+    uint16_t first_fragment_id = common_read_16_bit(&payload_ptr[payload_index]);
+    uint8_t fragment_count = payload_ptr[OTA_PARITY_CMD_FRAGMENT_COUNT_INDEX];
+    uint8_t *parity_ptr = &payload_ptr[OTA_PARITY_CMD_PARITY_BYTES_INDEX];
+
+    if (first_fragment_id == 0 || fragment_count == 0 ||
+            (first_fragment_id + fragment_count - 1) > ota_parameters.fw_fragment_count) {
+        tr_err("Received parity for invalid fragments %u - %u", first_fragment_id, first_fragment_id + fragment_count - 1);
+        return;
+    }
+
+    uint16_t parity_checksum = common_read_16_bit(&payload_ptr[payload_length - 2]);
+    uint16_t calculated_parity_checksum = ota_calculate_checksum_over_one_fragment(parity_ptr, ota_parameters.fw_fragment_byte_count);
+
+    if (parity_checksum != calculated_parity_checksum) {
+        tr_err("Checksums mismatch. Parity checksum: 0x%X Calculated checksum: 0x%X", parity_checksum, calculated_parity_checksum);
+        return;
+    }
+
+    // One missing fragment can be rebuilt, it is XOR of the parity and all other fragments of the group
+    uint16_t missing_fragment_id = 0;
+    for (uint16_t fragment_id = first_fragment_id; fragment_id < first_fragment_id + fragment_count; fragment_id++) {
+        if (!ota_check_if_fragment_already_received(fragment_id)) {
+            if (missing_fragment_id != 0) {
+                tr_info("More than one fragment missing from fragments %u - %u", first_fragment_id, first_fragment_id + fragment_count - 1);
+                return;
+            }
+            missing_fragment_id = fragment_id;
+        }
+    }
+
+    if (missing_fragment_id == 0) {
+        tr_debug("No missing fragments in fragments %u - %u", first_fragment_id, first_fragment_id + fragment_count - 1);
+        return;
+    }
+
+    uint8_t *rebuilt_fragment_ptr = ota_malloc_fptr(2 * (uint32_t)ota_parameters.fw_fragment_byte_count);
+    if (rebuilt_fragment_ptr == NULL) {
+        tr_err("Memory allocation failed for rebuilding fragment %u", missing_fragment_id);
+        return;
+    }
+
+    uint8_t *read_fragment_ptr = &rebuilt_fragment_ptr[ota_parameters.fw_fragment_byte_count];
+    memcpy(rebuilt_fragment_ptr, parity_ptr, ota_parameters.fw_fragment_byte_count);
+
+    for (uint16_t fragment_id = first_fragment_id; fragment_id < first_fragment_id + fragment_count; fragment_id++) {
+        if (fragment_id == missing_fragment_id) {
+            continue;
+        }
+
+        uint32_t offset = (fragment_id - 1) * (uint32_t)ota_parameters.fw_fragment_byte_count;
+        uint32_t len = ota_parameters.fw_fragment_byte_count;
+
+        if (offset + len > ota_parameters.fw_total_byte_count) {
+            len = ota_parameters.fw_total_byte_count - offset;
+        }
+
+        // Router pads the last fragment with zeros
+        memset(read_fragment_ptr, 0, ota_parameters.fw_fragment_byte_count);
+
+        uint32_t read_byte_count = ota_read_fw_bytes_fptr(ota_parameters.ota_session_id, offset, len, read_fragment_ptr);
+        if (read_byte_count != len) {
+            tr_err("Reading from data storage failed (%"PRIu32" <> %"PRIu32")", read_byte_count, len);
+            ota_free_fptr(rebuilt_fragment_ptr);
+            return;
+        }
+
+        for (uint16_t i = 0; i < ota_parameters.fw_fragment_byte_count; i++) {
+            rebuilt_fragment_ptr[i] ^= read_fragment_ptr[i];
+        }
+    }
+
+    tr_info("Fragment %u rebuilt from parity", missing_fragment_id);
+
+    ota_store_received_fragment(missing_fragment_id, rebuilt_fragment_ptr);
+
+    ota_free_fptr(rebuilt_fragment_ptr);
+
+    ota_update_status_resource();
+}
+
 static void ota_manage_abort_command(uint16_t payload_length, uint8_t *payload_ptr)
 {
     tr_info("ota_manage_abort_command - OTA process count: %u", ota_parameters.ota_process_count);
@@ -874,15 +1046,11 @@ static void ota_manage_abort_command(uint16_t payload_length, uint8_t *payload_p
 
     if (ota_parameters.ota_state == OTA_STATE_CHECKSUM_CALCULATING) {
         tr_warn("Checksum calculating over whole received image is aborted!!!");
-
-        mbedtls_sha256_free(ota_checksum_calculating_ptr.ota_sha256_context_ptr);
-
-        ota_free_fptr(ota_checksum_calculating_ptr.ota_sha256_context_ptr);
-        ota_checksum_calculating_ptr.ota_sha256_context_ptr = NULL;
-
-        memset(&ota_checksum_calculating_ptr, 0, sizeof(ota_checksum_calculating_t));
     }
 
+    // Checksum may also be calculated while fragments are still being received
+    ota_free_whole_fw_checksum_context();
+
     if (ota_parameters.ota_state != OTA_STATE_ABORTED) {
         if (ota_parameters.ota_state != OTA_STATE_UPDATE_FW) {
             tr_info("State changed to \"OTA ABORTED\"");
@@ -1077,6 +1245,12 @@ static void ota_manage_fragments_request_command(uint16_t payload_length, uint8_
             return;
         }
 
+        // Requests that are not served still tell how lossy the network is
+        if (ota_lib_config_data.device_type == OTA_DEVICE_TYPE_BORDER_ROUTER) {
+            ota_adapt_fragment_interval_to_request(&payload_ptr[payload_index + 2],
+                                                   common_read_16_bit(&payload_ptr[payload_index]));
+        }
+
         if (ota_fragments_request_service) {
             tr_warn("Fragment request serving already ongoing!");
             return;
@@ -1122,6 +1296,36 @@ static void ota_manage_fragments_request_command(uint16_t payload_length, uint8_
     }
 }
 
+// Fragments bitmask holds fragment 1 in bit 0 of the last byte, fragment 9 in bit 0 of the byte before it
+// and so on. Bits after the last fragment are always set, so zero bits are exactly the missing fragments.
+
+// Number of set bits in a word
+static inline uint8_t ota_popcount32(uint32_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint8_t)__builtin_popcount(value);
+#else
+    value = value - ((value >> 1) & 0x55555555);
+    value = (value & 0x33333333) + ((value >> 2) & 0x33333333);
+    return (uint8_t)((((value + (value >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24);
+#endif
+}
+
+// Index of lowest set bit, value must not be zero
+static inline uint8_t ota_ctz32(uint32_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint8_t)__builtin_ctz(value);
+#else
+    uint8_t bit_number = 0;
+    while ((value & 1) == 0) {
+        value >>= 1;
+        bit_number++;
+    }
+    return bit_number;
+#endif
+}
+
 static bool ota_check_if_fragment_already_received(uint16_t fragment_id)
 {
     uint16_t fragment_bitmask_id = (ota_parameters.fragments_bitmask_length - 1) - ((fragment_id - 1) / 8);
@@ -1135,59 +1339,90 @@ static bool ota_check_if_fragment_already_received(uint16_t fragment_id)
     return false;
 }
 
-static uint16_t ota_get_missing_fragment_total_count()
+static void ota_set_fragment_received(uint16_t fragment_id)
+{
+    uint16_t fragment_bitmask_id = (ota_parameters.fragments_bitmask_length - 1) - ((fragment_id - 1) / 8);
+    uint8_t fragment_bitmask_bit = (0x01 << ((fragment_id - 1) % 8));
+
+    if ((ota_parameters.fragments_bitmask_ptr[fragment_bitmask_id] & fragment_bitmask_bit) == 0) {
+        ota_parameters.fragments_bitmask_ptr[fragment_bitmask_id] |= fragment_bitmask_bit;
+        ota_missing_fragment_total_count--;
+    }
+}
+
+static uint16_t ota_count_missing_fragments()
 {
-    uint16_t returned_missing_fragment_total_count = 0;
-    uint8_t *fragment_bitmask_temp_ptr = &ota_parameters.fragments_bitmask_ptr[ota_parameters.fragments_bitmask_length - 1];
+    uint32_t received_bit_count = 0;
+    uint32_t word;
+    uint16_t i = 0;
 
-    for (uint16_t fragment_id = 1; fragment_id <= ota_parameters.fw_fragment_count; fragment_bitmask_temp_ptr--) {
-        uint8_t one_byte_bitmask = *fragment_bitmask_temp_ptr;
+    if (ota_parameters.fragments_bitmask_ptr == NULL) {
+        return 0;
+    }
 
-        for (uint8_t bit_counter = 0; bit_counter < 8; bit_counter++, fragment_id++) {
-            uint8_t bit_id = (1 << bit_counter);
+    for (; i + sizeof(word) <= ota_parameters.fragments_bitmask_length; i += sizeof(word)) {
+        memcpy(&word, &ota_parameters.fragments_bitmask_ptr[i], sizeof(word));
+        received_bit_count += ota_popcount32(word);
+    }
 
-            if ((one_byte_bitmask & bit_id) == 0) {
-                returned_missing_fragment_total_count++;
-            }
-        }
+    for (; i < ota_parameters.fragments_bitmask_length; i++) {
+        received_bit_count += ota_popcount32(ota_parameters.fragments_bitmask_ptr[i]);
     }
 
-    return returned_missing_fragment_total_count;
+    return (uint16_t)(((uint32_t)ota_parameters.fragments_bitmask_length * 8) - received_bit_count);
+}
+
+static uint16_t ota_get_missing_fragment_total_count()
+{
+    return ota_missing_fragment_total_count;
 }
 
 static uint16_t ota_get_and_log_first_missing_segment(uint8_t *missing_fragment_bitmasks_ptr)
 {
-    uint8_t *segment_bitmask_temp_ptr =
-        &ota_parameters.fragments_bitmask_ptr[ota_parameters.fragments_bitmask_length - 1];
+    uint16_t segment_id = 0;
+    uint16_t fragment_id = 0;
 
-    if (missing_fragment_bitmasks_ptr != NULL) {
-        memset(missing_fragment_bitmasks_ptr, 0, OTA_FRAGMENTS_REQ_BITMASK_LENGTH);
+    // Skip fully received words from the end, where the first fragments are
+    if (ota_missing_fragment_total_count > 0) {
+        int32_t i = ota_parameters.fragments_bitmask_length;
+        uint32_t word = 0xFFFFFFFF;
+
+        while (i >= (int32_t)sizeof(word) && word == 0xFFFFFFFF) {
+            i -= sizeof(word);
+            memcpy(&word, &ota_parameters.fragments_bitmask_ptr[i], sizeof(word));
+        }
+        if (word != 0xFFFFFFFF) {
+            i += sizeof(word);
+        }
+
+        while (i > 0) {
+            i--;
+            uint8_t missing_bits = (uint8_t)~ota_parameters.fragments_bitmask_ptr[i];
+            if (missing_bits != 0) {
+                fragment_id = ((ota_parameters.fragments_bitmask_length - 1 - i) * 8) + ota_ctz32(missing_bits) + 1;
+                segment_id = ((fragment_id - 1) / OTA_SEGMENT_SIZE) + 1;
+                break;
+            }
+        }
     }
 
-    uint16_t fragment_id = 1;
+    if (missing_fragment_bitmasks_ptr != NULL) {
+        memset(missing_fragment_bitmasks_ptr, 0, OTA_FRAGMENTS_REQ_BITMASK_LENGTH);
 
-    for (uint16_t segment_id = 1; segment_id <= ota_parameters.fw_segment_count; segment_id++) {
-        if (missing_fragment_bitmasks_ptr != NULL) {
+        // Without missing fragments, last segment is given
+        uint16_t copied_segment_id = segment_id ? segment_id : ota_parameters.fw_segment_count;
+        if (copied_segment_id > 0) {
             memcpy(missing_fragment_bitmasks_ptr,
-                   &ota_parameters.fragments_bitmask_ptr[(ota_parameters.fragments_bitmask_length) - (segment_id * OTA_FRAGMENTS_REQ_BITMASK_LENGTH)],
+                   &ota_parameters.fragments_bitmask_ptr[(ota_parameters.fragments_bitmask_length) - (copied_segment_id * OTA_FRAGMENTS_REQ_BITMASK_LENGTH)],
                    OTA_FRAGMENTS_REQ_BITMASK_LENGTH);
         }
+    }
 
-        for (uint8_t j = 0; j < OTA_FRAGMENTS_REQ_BITMASK_LENGTH; j++, segment_bitmask_temp_ptr--) {
-            uint8_t one_byte_bitmask = *segment_bitmask_temp_ptr;
-
-            for (uint8_t bit_counter = 0; bit_counter < 8; bit_counter++, fragment_id++) {
-                uint8_t bit_id = (1 << bit_counter);
-
-                if ((one_byte_bitmask & bit_id) == 0) {
-                    tr_info("First missing segment ID: %u Fragment ID: %u", segment_id, fragment_id);
-                    return segment_id;
-                }
-            }
-        }
+    if (segment_id > 0) {
+        tr_info("First missing segment ID: %u Fragment ID: %u", segment_id, fragment_id);
     }
 
-    return 0;
+    return segment_id;
 }
 
 static void ota_request_missing_fragments()
@@ -1262,6 +1497,67 @@ static ota_error_code_e ota_deliver_one_fragment(const uint16_t fragment_id, ota
     return OTA_OK;
 }
 
+static void ota_add_delivered_fragment_to_parity(const uint16_t fragment_id)
+{
+    if (ota_fw_deliver_parity_ptr == NULL) {
+        return;
+    }
+
+    // Fragment is still in socket buffer, zero padded after the end of image
+    for (uint16_t i = 0; i < ota_parameters.fw_fragment_byte_count; i++) {
+        ota_fw_deliver_parity_ptr[i] ^= socket_buf.ptr[OTA_FRAGMENT_CMD_FRAGMENT_BYTES_INDEX + i];
+    }
+
+    if ((fragment_id - ota_fw_deliver_parity_first_fragment_id + 1) == OTA_PARITY_GROUP_SIZE ||
+            fragment_id == ota_parameters.fw_fragment_count) {
+        ota_fw_deliver_parity_pending = true;
+    }
+}
+
+static ota_error_code_e ota_deliver_parity(ota_ip_address_t address)
+{
+    uint16_t fragment_id = ota_fw_deliver_parity_first_fragment_id;
+    uint8_t fragment_count = ota_fw_deliver_current_fragment_id - fragment_id;
+    ota_error_code_e status = OTA_OK;
+
+    ota_fw_deliver_parity_pending = false;
+    ota_fw_deliver_parity_first_fragment_id = ota_fw_deliver_current_fragment_id;
+
+    tr_info("Device will build parity for fragments %u - %u", fragment_id, fragment_id + fragment_count - 1);
+
+    if (ota_parameters.fw_fragment_byte_count + OTA_PARITY_CMD_LENGTH > socket_buf.size) {
+        tr_err("Building PARITY command failure! Message does not fit to buffer");
+        status = OTA_PARAMETER_FAIL;
+    } else {
+        uint16_t payload_index = 0;
+
+        create_multicast_header(OTA_CMD_PARITY);
+        payload_index += OTA_SESSION_ID_SIZE + 1;
+
+        common_write_16_bit(fragment_id, &socket_buf.ptr[payload_index]);
+        payload_index += 2;
+
+        socket_buf.ptr[payload_index] = fragment_count;
+        payload_index += 1;
+
+        memcpy(&socket_buf.ptr[payload_index], ota_fw_deliver_parity_ptr, ota_parameters.fw_fragment_byte_count);
+
+        uint16_t calculated_parity_checksum = ota_calculate_checksum_over_one_fragment(&socket_buf.ptr[payload_index], ota_parameters.fw_fragment_byte_count);
+
+        payload_index += ota_parameters.fw_fragment_byte_count;
+        common_write_16_bit(calculated_parity_checksum, &socket_buf.ptr[payload_index]);
+
+        if (ota_socket_send_fptr(&address, ota_parameters.fw_fragment_byte_count + OTA_PARITY_CMD_LENGTH, socket_buf.ptr) != 0) {
+            tr_err("ota_deliver_parity - failed to send data!");
+            status = OTA_PARAMETER_FAIL;
+        }
+    }
+
+    memset(ota_fw_deliver_parity_ptr, 0, ota_parameters.fw_fragment_byte_count);
+
+    return status;
+}
+
 static void ota_serve_fragments_request_by_sending_one_fragment()
 {
     tr_info("ota_serve_fragments_request_by_sending_one_fragment()");
@@ -1277,54 +1573,159 @@ static void ota_serve_fragments_request_by_sending_one_fragment()
 
 static uint16_t ota_get_next_missing_fragment_id_for_requester(bool bit_mask_change)
 {
-    uint16_t fragment_id = 1 + ((ota_fragments_request_service_segment_id - 1) * OTA_SEGMENT_SIZE);
+    uint32_t fragment_id = 1 + ((ota_fragments_request_service_segment_id - 1) * OTA_SEGMENT_SIZE);
 
     if (fragment_id > ota_parameters.fw_fragment_count) {
         tr_err("Fragment ID in request bigger than total fragment count!");
         return 0;
     }
 
-    for (int8_t i = (OTA_FRAGMENTS_REQ_BITMASK_LENGTH - 1); i >= 0; i--) {
-        for (uint8_t bit_counter = 0; bit_counter < 8; bit_counter++, fragment_id++) {
-            if (fragment_id > ota_parameters.fw_fragment_count) {
+    for (int8_t i = (OTA_FRAGMENTS_REQ_BITMASK_LENGTH - 1); i >= 0; i--, fragment_id += 8) {
+        if (fragment_id > ota_parameters.fw_fragment_count) {
+            ota_fragments_request_service_bitmask_tbl[i] = 0xFF;
+            continue;
+        }
+
+        uint8_t missing_bits = (uint8_t)~ota_fragments_request_service_bitmask_tbl[i];
+
+        // Ignore bits after the last fragment
+        if (fragment_id + 7 > ota_parameters.fw_fragment_count) {
+            missing_bits &= (uint8_t)((1 << (ota_parameters.fw_fragment_count - fragment_id + 1)) - 1);
+            if (missing_bits == 0) {
                 ota_fragments_request_service_bitmask_tbl[i] = 0xFF;
-                break;
+                continue;
             }
+        }
 
-            uint8_t bit_id = (1 << bit_counter);
-
-            if ((ota_fragments_request_service_bitmask_tbl[i] & bit_id) == 0) {
-                if (bit_mask_change == true) {
-                    ota_fragments_request_service_bitmask_tbl[i] += bit_id;
-                }
-                return fragment_id;
+        if (missing_bits != 0) {
+            uint8_t bit_number = ota_ctz32(missing_bits);
+            if (bit_mask_change == true) {
+                ota_fragments_request_service_bitmask_tbl[i] |= (1 << bit_number);
             }
+            return (uint16_t)(fragment_id + bit_number);
         }
     }
 
     return 0;
 }
 
+// CRC-16/KERMIT (reflected polynomial 0x8408) of every byte value
+static const uint16_t ota_crc16_table[256] = {
+    0x0000, 0x1189, 0x2312, 0x329B, 0x4624, 0x57AD, 0x6536, 0x74BF,
+    0x8C48, 0x9DC1, 0xAF5A, 0xBED3, 0xCA6C, 0xDBE5, 0xE97E, 0xF8F7,
+    0x1081, 0x0108, 0x3393, 0x221A, 0x56A5, 0x472C, 0x75B7, 0x643E,
+    0x9CC9, 0x8D40, 0xBFDB, 0xAE52, 0xDAED, 0xCB64, 0xF9FF, 0xE876,
+    0x2102, 0x308B, 0x0210, 0x1399, 0x6726, 0x76AF, 0x4434, 0x55BD,
+    0xAD4A, 0xBCC3, 0x8E58, 0x9FD1, 0xEB6E, 0xFAE7, 0xC87C, 0xD9F5,
+    0x3183, 0x200A, 0x1291, 0x0318, 0x77A7, 0x662E, 0x54B5, 0x453C,
+    0xBDCB, 0xAC42, 0x9ED9, 0x8F50, 0xFBEF, 0xEA66, 0xD8FD, 0xC974,
+    0x4204, 0x538D, 0x6116, 0x709F, 0x0420, 0x15A9, 0x2732, 0x36BB,
+    0xCE4C, 0xDFC5, 0xED5E, 0xFCD7, 0x8868, 0x99E1, 0xAB7A, 0xBAF3,
+    0x5285, 0x430C, 0x7197, 0x601E, 0x14A1, 0x0528, 0x37B3, 0x263A,
+    0xDECD, 0xCF44, 0xFDDF, 0xEC56, 0x98E9, 0x8960, 0xBBFB, 0xAA72,
+    0x6306, 0x728F, 0x4014, 0x519D, 0x2522, 0x34AB, 0x0630, 0x17B9,
+    0xEF4E, 0xFEC7, 0xCC5C, 0xDDD5, 0xA96A, 0xB8E3, 0x8A78, 0x9BF1,
+    0x7387, 0x620E, 0x5095, 0x411C, 0x35A3, 0x242A, 0x16B1, 0x0738,
+    0xFFCF, 0xEE46, 0xDCDD, 0xCD54, 0xB9EB, 0xA862, 0x9AF9, 0x8B70,
+    0x8408, 0x9581, 0xA71A, 0xB693, 0xC22C, 0xD3A5, 0xE13E, 0xF0B7,
+    0x0840, 0x19C9, 0x2B52, 0x3ADB, 0x4E64, 0x5FED, 0x6D76, 0x7CFF,
+    0x9489, 0x8500, 0xB79B, 0xA612, 0xD2AD, 0xC324, 0xF1BF, 0xE036,
+    0x18C1, 0x0948, 0x3BD3, 0x2A5A, 0x5EE5, 0x4F6C, 0x7DF7, 0x6C7E,
+    0xA50A, 0xB483, 0x8618, 0x9791, 0xE32E, 0xF2A7, 0xC03C, 0xD1B5,
+    0x2942, 0x38CB, 0x0A50, 0x1BD9, 0x6F66, 0x7EEF, 0x4C74, 0x5DFD,
+    0xB58B, 0xA402, 0x9699, 0x8710, 0xF3AF, 0xE226, 0xD0BD, 0xC134,
+    0x39C3, 0x284A, 0x1AD1, 0x0B58, 0x7FE7, 0x6E6E, 0x5CF5, 0x4D7C,
+    0xC60C, 0xD785, 0xE51E, 0xF497, 0x8028, 0x91A1, 0xA33A, 0xB2B3,
+    0x4A44, 0x5BCD, 0x6956, 0x78DF, 0x0C60, 0x1DE9, 0x2F72, 0x3EFB,
+    0xD68D, 0xC704, 0xF59F, 0xE416, 0x90A9, 0x8120, 0xB3BB, 0xA232,
+    0x5AC5, 0x4B4C, 0x79D7, 0x685E, 0x1CE1, 0x0D68, 0x3FF3, 0x2E7A,
+    0xE70E, 0xF687, 0xC41C, 0xD595, 0xA12A, 0xB0A3, 0x8238, 0x93B1,
+    0x6B46, 0x7ACF, 0x4854, 0x59DD, 0x2D62, 0x3CEB, 0x0E70, 0x1FF9,
+    0xF78F, 0xE606, 0xD49D, 0xC514, 0xB1AB, 0xA022, 0x92B9, 0x8330,
+    0x7BC7, 0x6A4E, 0x58D5, 0x495C, 0x3DE3, 0x2C6A, 0x1EF1, 0x0F78
+};
+
+#if LIBOTA_CRC_SLICE_BY_4
+// ota_crc16_slice_tbl[n][i] is CRC of byte i followed by n + 1 zero bytes
+static uint16_t ota_crc16_slice_tbl[3][256];
+static bool ota_crc16_slice_tbl_ready = false;
+
+static void ota_init_crc16_slice_tbl(void)
+{
+    for (uint16_t i = 0; i < 256; i++) {
+        uint16_t crc = ota_crc16_table[i];
+        for (uint8_t n = 0; n < 3; n++) {
+            crc = (crc >> 8) ^ ota_crc16_table[crc & 0xFF];
+            ota_crc16_slice_tbl[n][i] = crc;
+        }
+    }
+    ota_crc16_slice_tbl_ready = true;
+}
+#endif
+
 static uint16_t ota_calculate_checksum_over_one_fragment(uint8_t *data_ptr, uint16_t data_length)
 {
     uint16_t returned_crc = 0;
     uint16_t i = 0;
-    long q = 0;
-    uint8_t c = 0;
 
-    for (i = 0; i < data_length; i++) {
-        c = data_ptr[i];
-        q = (returned_crc ^ c) & 0x0f;
+#if LIBOTA_CRC_SLICE_BY_4
+    if (!ota_crc16_slice_tbl_ready) {
+        ota_init_crc16_slice_tbl();
+    }
 
-        returned_crc = (returned_crc >> 4) ^ (q * 0x1081);
-        q = (returned_crc ^ (c >> 4)) & 0xf;
+    for (; (i + 4) <= data_length; i += 4) {
+        returned_crc = ota_crc16_slice_tbl[2][(data_ptr[i] ^ returned_crc) & 0xFF] ^
+                       ota_crc16_slice_tbl[1][(data_ptr[i + 1] ^ (returned_crc >> 8)) & 0xFF] ^
+                       ota_crc16_slice_tbl[0][data_ptr[i + 2]] ^
+                       ota_crc16_table[data_ptr[i + 3]];
+    }
+#endif
 
-        returned_crc = (returned_crc >> 4) ^ (q * 0x1081);
+    for (; i < data_length; i++) {
+        returned_crc = (returned_crc >> 8) ^ ota_crc16_table[(returned_crc ^ data_ptr[i]) & 0xFF];
     }
 
     return returned_crc;
 }
 
+static void ota_free_whole_fw_checksum_context(void)
+{
+    mbedtls_sha256_free(ota_checksum_calculating_ptr.ota_sha256_context_ptr);
+    ota_free_fptr(ota_checksum_calculating_ptr.ota_sha256_context_ptr);
+
+    memset(&ota_checksum_calculating_ptr, 0, sizeof(ota_checksum_calculating_t));
+}
+
+// Fragments received in order are hashed right away, so that only the rest of the image
+// needs to be read back from data storage when all fragments have been received
+static void ota_update_whole_fw_checksum_with_fragment(uint32_t offset, uint8_t *data_ptr, uint32_t data_length)
+{
+    if (ota_parameters.ota_state == OTA_STATE_CHECKSUM_CALCULATING ||
+            offset != ota_checksum_calculating_ptr.current_byte_id) {
+        return;
+    }
+
+    if (ota_checksum_calculating_ptr.ota_sha256_context_ptr == NULL) {
+        if (offset != 0) {
+            return;
+        }
+
+        ota_checksum_calculating_ptr.ota_sha256_context_ptr = ota_malloc_fptr(sizeof(mbedtls_sha256_context));
+        if (ota_checksum_calculating_ptr.ota_sha256_context_ptr == NULL) {
+            tr_warn("Memory allocation failed for ota_sha256_context_ptr, whole FW checksum is calculated at the end");
+            return;
+        }
+
+        memset(ota_checksum_calculating_ptr.ota_sha256_context_ptr, 0, sizeof(mbedtls_sha256_context));
+
+        mbedtls_sha256_init(ota_checksum_calculating_ptr.ota_sha256_context_ptr);
+        mbedtls_sha256_starts(ota_checksum_calculating_ptr.ota_sha256_context_ptr, 0);
+    }
+
+    mbedtls_sha256_update(ota_checksum_calculating_ptr.ota_sha256_context_ptr, data_ptr, data_length);
+    ota_checksum_calculating_ptr.current_byte_id += data_length;
+}
+
 static void ota_manage_whole_fw_checksum_calculating(void)
 {
     bool new_round_needed = false;
@@ -1352,17 +1753,27 @@ static void ota_manage_whole_fw_checksum_calculating(void)
             if ((ota_checksum_calculating_ptr.current_byte_id + pushed_fw_data_byte_count) > fw_total_data_byte_count) {
                 pushed_fw_data_byte_count = (fw_total_data_byte_count - ota_checksum_calculating_ptr.current_byte_id);
             }
+            if (ota_checksum_calculating_ptr.current_byte_id > 0 && ota_checksum_calculating_ptr.current_byte_id == fw_total_data_byte_count) {
+                tr_info("Whole FW checksum calculated while receiving fragments");
+            }
             tr_info("Calculating whole FW checksum! pushed byte count: %"PRIu32" Byte ID: %"PRIu32" ",
                     pushed_fw_data_byte_count,
                     ota_checksum_calculating_ptr.current_byte_id);
 
-            uint8_t *pushed_fw_data_byte_ptr = ota_malloc_fptr(pushed_fw_data_byte_count);
+            // Nothing is left to read if all fragments were hashed while receiving them
+            uint8_t *pushed_fw_data_byte_ptr = NULL;
+            if (pushed_fw_data_byte_count > 0) {
+                pushed_fw_data_byte_ptr = ota_malloc_fptr(pushed_fw_data_byte_count);
+            }
 
-            if (pushed_fw_data_byte_ptr != NULL) {
-                uint32_t read_byte_count = ota_read_fw_bytes_fptr(ota_parameters.ota_session_id,
-                                                                  ota_checksum_calculating_ptr.current_byte_id,
-                                                                  pushed_fw_data_byte_count,
-                                                                  pushed_fw_data_byte_ptr);
+            if (pushed_fw_data_byte_ptr != NULL || pushed_fw_data_byte_count == 0) {
+                uint32_t read_byte_count = 0;
+                if (pushed_fw_data_byte_count > 0) {
+                    read_byte_count = ota_read_fw_bytes_fptr(ota_parameters.ota_session_id,
+                                                             ota_checksum_calculating_ptr.current_byte_id,
+                                                             pushed_fw_data_byte_count,
+                                                             pushed_fw_data_byte_ptr);
+                }
 
                 ota_checksum_calculating_ptr.current_byte_id += read_byte_count;
 
@@ -1460,6 +1871,77 @@ static void ota_start_timer(ota_timers_e timer_id, uint32_t start_time, uint32_t
     ota_request_timer_fptr(timer_id, start_time);
 }
 
+static uint32_t ota_get_fragment_interval(void)
+{
+#if OTA_ADAPTIVE_INTERVAL
+    return ota_adaptive_interval;
+#else
+    return OTA_MULTICAST_INTERVAL;
+#endif
+}
+
+static void ota_adapt_fragment_interval_to_request(uint8_t *bitmask_ptr, uint16_t segment_id)
+{
+#if OTA_ADAPTIVE_INTERVAL
+    uint32_t first_fragment_id = 1 + ((uint32_t)(segment_id - 1) * OTA_SEGMENT_SIZE);
+
+    if (segment_id == 0 || first_fragment_id > ota_parameters.fw_fragment_count) {
+        return;
+    }
+
+    uint16_t segment_fragment_count = ota_parameters.fw_fragment_count - first_fragment_id + 1;
+    if (segment_fragment_count > OTA_SEGMENT_SIZE) {
+        segment_fragment_count = OTA_SEGMENT_SIZE;
+    }
+
+    // Bits after the last fragment are not counted as missing
+    uint16_t received_count = 0;
+    uint16_t bit_count = 0;
+    for (int8_t i = (OTA_FRAGMENTS_REQ_BITMASK_LENGTH - 1); i >= 0 && bit_count < segment_fragment_count; i--, bit_count += 8) {
+        uint8_t received_bits = bitmask_ptr[i];
+        if (segment_fragment_count - bit_count < 8) {
+            received_bits &= (uint8_t)((1 << (segment_fragment_count - bit_count)) - 1);
+        }
+        received_count += ota_popcount32(received_bits);
+    }
+
+    uint16_t missing_count = segment_fragment_count - received_count;
+
+    if (missing_count * OTA_ADAPTIVE_INTERVAL_LOSS_DIVISOR > segment_fragment_count) {
+        ota_adaptive_interval_loss_seen = true;
+
+        if (ota_adaptive_interval < OTA_ADAPTIVE_INTERVAL_MAX) {
+            ota_adaptive_interval += (ota_adaptive_interval / 2) ? (ota_adaptive_interval / 2) : 1;
+            if (ota_adaptive_interval > OTA_ADAPTIVE_INTERVAL_MAX) {
+                ota_adaptive_interval = OTA_ADAPTIVE_INTERVAL_MAX;
+            }
+            tr_info("%u / %u fragments missing in segment %u, fragment interval increased to %"PRIu32"s",
+                    missing_count, segment_fragment_count, segment_id, ota_adaptive_interval);
+        }
+    }
+#else
+    (void)bitmask_ptr;
+    (void)segment_id;
+#endif
+}
+
+static void ota_adapt_fragment_interval_to_new_campaign(void)
+{
+#if OTA_ADAPTIVE_INTERVAL
+    if (ota_adaptive_interval_campaign_done && !ota_adaptive_interval_loss_seen &&
+            ota_adaptive_interval > OTA_ADAPTIVE_INTERVAL_MIN) {
+        ota_adaptive_interval -= (ota_adaptive_interval / 8) ? (ota_adaptive_interval / 8) : 1;
+        if (ota_adaptive_interval < OTA_ADAPTIVE_INTERVAL_MIN) {
+            ota_adaptive_interval = OTA_ADAPTIVE_INTERVAL_MIN;
+        }
+        tr_info("Previous campaign had no heavy fragment loss, fragment interval decreased to %"PRIu32"s", ota_adaptive_interval);
+    }
+
+    ota_adaptive_interval_campaign_done = false;
+    ota_adaptive_interval_loss_seen = false;
+#endif
+}
+
 uint8_t ota_lwm2m_command(struct nsdl_s *handle_ptr, sn_coap_hdr_s *coap_ptr, sn_nsdl_addr_s *address_ptr, sn_nsdl_capab_e proto)
 {
     (void)proto;
@@ -1580,27 +2062,22 @@ static void ota_init_fragments_bit_mask(uint8_t init_value)
 {
     if (ota_parameters.fragments_bitmask_ptr != NULL) {
         memset(ota_parameters.fragments_bitmask_ptr, 0xFF, ota_parameters.fragments_bitmask_length);
+        ota_missing_fragment_total_count = 0;
 
-        uint8_t *fragment_bitmask_temp_ptr =
-            &ota_parameters.fragments_bitmask_ptr[ota_parameters.fragments_bitmask_length - 1];
+        if (init_value == 0) {
+            uint16_t full_byte_count = ota_parameters.fw_fragment_count / 8;
+            uint8_t last_byte_bit_count = ota_parameters.fw_fragment_count % 8;
 
-        for (uint16_t fragment_counter_temp = 0;
-                fragment_counter_temp < ota_parameters.fw_fragment_count;
-                fragment_bitmask_temp_ptr--) {
+            memset(&ota_parameters.fragments_bitmask_ptr[ota_parameters.fragments_bitmask_length - full_byte_count],
+                   0,
+                   full_byte_count);
 
-            for (uint8_t j = 0; j < 8; j++) {
-                if (init_value == 0)                {
-                    *fragment_bitmask_temp_ptr &= ~(1 << j);
-                } else {
-                    *fragment_bitmask_temp_ptr |= (1 << j);
-                }
-
-                fragment_counter_temp++;
-
-                if (fragment_counter_temp >= ota_parameters.fw_fragment_count) {
-                    break;
-                }
+            if (last_byte_bit_count != 0) {
+                ota_parameters.fragments_bitmask_ptr[ota_parameters.fragments_bitmask_length - 1 - full_byte_count] =
+                    (uint8_t)(0xFF << last_byte_bit_count);
             }
+
+            ota_missing_fragment_total_count = ota_parameters.fw_fragment_count;
         }
     }
 }
@@ -1696,11 +2173,14 @@ static void ota_delete_process(uint8_t *session_id)
     ota_free_fptr(ota_parameters.pull_url_ptr);
     ota_parameters.pull_url_ptr = NULL;
 
-    mbedtls_sha256_free(ota_checksum_calculating_ptr.ota_sha256_context_ptr);
-    ota_free_fptr(ota_checksum_calculating_ptr.ota_sha256_context_ptr);
-    ota_checksum_calculating_ptr.ota_sha256_context_ptr = NULL;
+    ota_free_whole_fw_checksum_context();
+
+    ota_free_fptr(ota_fw_deliver_parity_ptr);
+    ota_fw_deliver_parity_ptr = NULL;
+    ota_fw_deliver_parity_pending = false;
 
     memset(&ota_parameters, 0, sizeof(ota_parameters));
+    ota_missing_fragment_total_count = 0;
 
     // Ready for new multicast session
     uint8_t payload[1] = "1";
@@ -1725,8 +2205,11 @@ void ota_firmware_pulled()
     memset(ota_parameters.fragments_bitmask_ptr,
            0xff,
            ota_parameters.fragments_bitmask_length);
+    ota_missing_fragment_total_count = 0;
     ota_parameters.ota_state = OTA_STATE_CHECKSUM_CALCULATING;
 
+    // Pulled image was not written through fragments, calculate checksum from the beginning
+    ota_free_whole_fw_checksum_context();
     ota_manage_whole_fw_checksum_calculating();
 }
 
@@ -1802,11 +2285,27 @@ ota_error_code_e ota_send_multicast_command(ota_commands_e command, uint8_t *pay
         ota_start_timer(OTA_FRAGMENTS_DELIVERING_TIMER, OTA_START_RESEND_DELAY, 0);
         ota_fw_delivering = true;
         ota_fw_deliver_current_fragment_id = 1;
+
+#if OTA_PARITY_GROUP_SIZE > 0
+        ota_fw_deliver_parity_first_fragment_id = 1;
+        ota_fw_deliver_parity_pending = false;
+        // Fragment size may have changed since previous delivery
+        ota_free_fptr(ota_fw_deliver_parity_ptr);
+        ota_fw_deliver_parity_ptr = ota_malloc_fptr(ota_parameters.fw_fragment_byte_count);
+        if (ota_fw_deliver_parity_ptr != NULL) {
+            memset(ota_fw_deliver_parity_ptr, 0, ota_parameters.fw_fragment_byte_count);
+        } else {
+            tr_warn("Memory allocation failed for parity, fragments are sent without it");
+        }
+#endif
     } else if (command == OTA_CMD_MANIFEST) {
         ota_start_timer(OTA_MULTICAST_MANIFEST_MSG_SENT_TIMER, OTA_MULTICAST_INTERVAL, 0);
     } else {
         // OTA_CMD_ACTIVATE
         ota_start_timer(OTA_MULTICAST_MSG_SENT_TIMER, OTA_MULTICAST_INTERVAL, 0);
+#if OTA_ADAPTIVE_INTERVAL
+        ota_adaptive_interval_campaign_done = true;
+#endif
     }
 
     return OTA_OK;
@@ -29,6 +29,7 @@
 // Message lengths in bytes
 #define OTA_START_CMD_LENGTH            58
 #define OTA_FRAGMENT_CMD_LENGTH         21
+#define OTA_PARITY_CMD_LENGTH           22
 #define OTA_END_FRAGMENTS_CMD_LENGTH    17
 #define OTA_FRAGMENTS_REQ_LENGTH        18
 #define OTA_UPDATE_FW_CMD_LENGTH        20
@@ -38,6 +39,8 @@
 #define OTA_CMD_PROCESS_ID_INDEX                    1
 #define OTA_START_CMD_DEVICE_TYPE_INDEX             17
 #define OTA_FRAGMENT_CMD_FRAGMENT_BYTES_INDEX       19
+#define OTA_PARITY_CMD_FRAGMENT_COUNT_INDEX         19
+#define OTA_PARITY_CMD_PARITY_BYTES_INDEX           20
 
 #define MULTICAST_CMD_ID_INDEX                      0
 #define MULTICAST_CMD_TYPE_INDEX                    1
@@ -59,7 +62,8 @@ typedef enum
     OTA_CMD_FRAGMENT,
     OTA_CMD_END_FRAGMENTS,
     OTA_CMD_FRAGMENTS_REQUEST,
-    OTA_CMD_ABORT
+    OTA_CMD_ABORT,
+    OTA_CMD_PARITY
 } ota_commands_e;
 
 typedef enum
@@ -101,6 +105,10 @@ static bool                         ota_fragments_request_service = false;
 static uint8_t                      ota_fw_update_received = false;
 static bool                         ota_fw_delivering = false;
 static uint16_t                     ota_fw_deliver_current_fragment_id = 0;
+static uint16_t                     ota_missing_fragment_total_count = 0; // Zero bits in ota_parameters.fragments_bitmask_ptr
+static uint8_t                      *ota_fw_deliver_parity_ptr = NULL; // Only for router: XOR of fragments delivered in current parity group
+static uint16_t                     ota_fw_deliver_parity_first_fragment_id = 0;
+static bool                         ota_fw_deliver_parity_pending = false;
 
 // * * * OTA library API function pointers * * *
 static ota_error_code_e (*ota_store_new_process_fptr)(uint8_t*);
@@ -127,6 +135,8 @@ static ota_error_code_e ota_manage_start_command(uint16_t payload_length, uint8_
 static ota_error_code_e ota_border_router_manage_command(uint16_t payload_length, uint8_t *payload_ptr);
 static void             ota_parse_start_command_parameters(uint8_t *payload_ptr);
 static void             ota_manage_fragment_command(uint16_t payload_length, uint8_t *payload_ptr);
+static void             ota_manage_parity_command(uint16_t payload_length, uint8_t *payload_ptr);
+static void             ota_store_received_fragment(uint16_t fragment_id, uint8_t *fragment_ptr);
 static void             ota_manage_abort_command(uint16_t payload_length, uint8_t *payload_ptr);
 static void             ota_manage_end_fragments_command(uint16_t payload_length, uint8_t *payload_ptr);
 static void             ota_manage_update_fw_command(uint16_t payload_length, uint8_t *payload_ptr);
@@ -137,14 +147,20 @@ static ota_error_code_e ota_send_multicast_command(ota_commands_e command, uint8
 static void             ota_request_missing_fragments();
 static bool             ota_check_if_fragment_already_received(uint16_t fragment_id);
 static uint16_t         ota_get_missing_fragment_total_count();
+static uint16_t         ota_count_missing_fragments();
+static void             ota_set_fragment_received(uint16_t fragment_id);
 static uint16_t         ota_get_and_log_first_missing_segment(uint8_t *missing_fragment_bitmasks_ptr);
 static uint16_t         ota_get_next_missing_fragment_id_for_requester(bool bit_mask_change);
 static uint16_t         ota_calculate_checksum_over_one_fragment(uint8_t *data_ptr, uint16_t data_length);
 static void             ota_manage_whole_fw_checksum_calculating(void);
+static void             ota_update_whole_fw_checksum_with_fragment(uint32_t offset, uint8_t *data_ptr, uint32_t data_length);
+static void             ota_free_whole_fw_checksum_context(void);
 static void             ota_init_fragments_bit_mask(uint8_t init_value);
 static ota_error_code_e ota_add_new_process(uint8_t *session_id);
 static void             ota_delete_process(uint8_t *session_id);
 static uint8_t          ota_get_first_missing_fragments_process_id(bool fallback_flag);
 static void             ota_get_state(char *ota_state_ptr);
 static ota_error_code_e ota_deliver_one_fragment(const uint16_t fragment_id, ota_ip_address_t address);
+static void             ota_add_delivered_fragment_to_parity(const uint16_t fragment_id);
+static ota_error_code_e ota_deliver_parity(ota_ip_address_t address);
 static void             ota_update_status_resource();
@@ -27,6 +27,9 @@
 #include <assert.h>
 
 #include "sn_coap_header.h"
+#if defined(MBED_CLOUD_CLIENT_MULTICAST_GROUP_REQUESTS)
+#include "sn_coap_protocol.h"
+#endif
 #include "pal.h"
 #include "m2mtimer.h"
 #include "multicast.h"
@@ -65,6 +68,15 @@ extern "C" {
 #define OTA_SOCKET_MULTICAST_PORT           48381 // Socket port number for OTA (used for Link local multicast and MPL multicast)
 #define MULTICAST_OBJECT_ID                 "33458"
 #define RECEIVE_BUFFER_SIZE                 1200  // Max radio packet size
+#ifndef RECEIVE_BATCH_SIZE
+#define RECEIVE_BATCH_SIZE                  1     // Packets read per socket callback, each takes RECEIVE_BUFFER_SIZE of stack
+#endif
+#if defined(MBED_CLOUD_CLIENT_MULTICAST_GROUP_REQUESTS)
+#ifndef MBED_CLOUD_CLIENT_MULTICAST_GROUP_PORT
+#define MBED_CLOUD_CLIENT_MULTICAST_GROUP_PORT  5683  // Socket port number for CoAP group requests (RFC 7390)
+#endif
+#define MULTICAST_GROUP_PATH_MAX_LEN        64    // Longest accepted <object>/<instance>/<resource>[/<instance>] path
+#endif
 
 static bool arm_uc_multicast_manifest_rejected = false;
 static bool arm_uc_multicast_send_in_progress = false;
@@ -92,6 +104,14 @@ static ota_error_code_e arm_uc_multicast_get_parent_addr(uint8_t *addr);
 static void             arm_uc_multicast_update_client_event(struct arm_event_s *event);
 static void             arm_uc_multicast_update_client_init();
 static void             arm_uc_multicast_update_client_external_update_event(struct arm_event_s *event);
+#if defined(MBED_CLOUD_CLIENT_MULTICAST_GROUP_REQUESTS)
+static bool             arm_uc_multicast_group_init();
+static void             arm_uc_multicast_group_deinit();
+static void             arm_uc_multicast_group_receive(uint8_t *data, uint16_t length, const palSocketAddress_t *address);
+#if defined(ARM_UC_MULTICAST_NODE_MODE)
+static void             arm_uc_multicast_group_send_response(uint8_t response_id);
+#endif
+#endif
 
 palSocket_t                 arm_uc_multicast_socket;
 palSocket_t                 arm_uc_multicast_missing_frag_socket;
@@ -114,6 +134,30 @@ static arm_event_storage_t  arm_uc_multicast_event;
 static const int16_t        multicast_hops = 24;
 static arm_uc_hub_state_t   arm_uc_hub_state = ARM_UC_HUB_STATE_UNINITIALIZED;
 
+#if defined(MBED_CLOUD_CLIENT_MULTICAST_GROUP_REQUESTS)
+palSocket_t                 arm_uc_multicast_group_socket;
+static struct coap_s       *arm_uc_multicast_group_coap = NULL;
+#if defined(ARM_UC_MULTICAST_NODE_MODE)
+// Responses waiting for their randomized delay, identified by the timer event id
+typedef struct multicast_group_response {
+    struct multicast_group_response *next;
+    palSocketAddress_t      address;
+    uint8_t                 *packet;
+    uint16_t                length;
+    uint8_t                 id;
+} multicast_group_response_t;
+
+static M2MBaseList         *arm_uc_multicast_group_objects = NULL;
+static multicast_group_response_t *arm_uc_multicast_group_responses = NULL;
+static uint8_t              arm_uc_multicast_group_response_id = 0;
+#else
+static uint8_t              arm_uc_multicast_group_token[4];
+static bool                 arm_uc_multicast_group_token_valid = false;
+static uint16_t             arm_uc_multicast_group_response_count = 0;
+static arm_uc_multicast_group_response_cb arm_uc_multicast_group_response_callback = NULL;
+#endif
+#endif // MBED_CLOUD_CLIENT_MULTICAST_GROUP_REQUESTS
+
 #if defined(ARM_UC_MULTICAST_BORDER_ROUTER_MODE)
 struct manifest_firmware_info_t fw_info;
 #endif
@@ -311,6 +355,15 @@ multicast_status_e arm_uc_multicast_init(M2MBaseList &list, ConnectorClient &cli
         return MULTICAST_STATUS_INIT_FAILED;
     }
 
+#if defined(MBED_CLOUD_CLIENT_MULTICAST_GROUP_REQUESTS)
+#if defined(ARM_UC_MULTICAST_NODE_MODE)
+    arm_uc_multicast_group_objects = &list;
+#endif
+    if (!arm_uc_multicast_group_init()) {
+        return MULTICAST_STATUS_INIT_FAILED;
+    }
+#endif
+
     memset(&arm_uc_multicast_event, 0, sizeof(arm_uc_multicast_event));
 
     arm_uc_multicast_ota_config.unicast_socket_addr.port = OTA_SOCKET_UNICAST_PORT;
@@ -353,6 +406,9 @@ void arm_uc_multicast_deinit()
     ota_lib_reset();
     pal_close(&arm_uc_multicast_socket);
     pal_close(&arm_uc_multicast_missing_frag_socket);
+#if defined(MBED_CLOUD_CLIENT_MULTICAST_GROUP_REQUESTS)
+    arm_uc_multicast_group_deinit();
+#endif
     delete arm_uc_multicast_object;
     arm_uc_multicast_object = NULL;
 }
@@ -375,6 +431,10 @@ void arm_uc_multicast_tasklet(struct arm_event_s *event)
         stored_ota_parameters.ota_process_count = 0;
     } else if (ARM_UC_OTA_FULL_REG_EVENT == event->event_type) {
         arm_uc_multicast_m2m_client->start_full_registration();
+#if defined(MBED_CLOUD_CLIENT_MULTICAST_GROUP_REQUESTS) && defined(ARM_UC_MULTICAST_NODE_MODE)
+    } else if (ARM_UC_OTA_GROUP_RESPONSE_EVENT == event->event_type) {
+        arm_uc_multicast_group_send_response(event->event_id);
+#endif
     } else if (ARM_UC_HUB_EVENT_TIMER == event->event_type) {
         arm_uc_multicast_event.data.event_data = arm_uc_hub_state;
         arm_uc_multicast_event.data.event_type = ARM_UC_OTA_MULTICAST_UPDATE_CLIENT_EVENT;
@@ -463,50 +523,69 @@ static void arm_uc_multicast_socket_callback(void *port)
 {
     tr_debug("arm_uc_multicast_socket_callback - port % " PRIdPTR "", (intptr_t)port);
 
-    size_t recv;
+    uint32_t received = 0;
+    uint32_t first = 0;
     palStatus_t status;
-    uint8_t recv_buffer[RECEIVE_BUFFER_SIZE];
-
-    palSocketAddress_t address = { 0, { 0 } };
-    palSocketLength_t addrlen = 0;
+    uint8_t recv_buffer[RECEIVE_BATCH_SIZE][RECEIVE_BUFFER_SIZE];
+    palSocketAddress_t address[RECEIVE_BATCH_SIZE];
+    palDatagram_t datagrams[RECEIVE_BATCH_SIZE];
+
+    for (uint32_t i = 0; i < RECEIVE_BATCH_SIZE; i++) {
+        memset(&address[i], 0, sizeof(address[i]));
+        datagrams[i].buffer = recv_buffer[i];
+        datagrams[i].length = RECEIVE_BUFFER_SIZE;
+        datagrams[i].address = &address[i];
+    }
 
     // Read from the right socket
     if ((intptr_t)port == OTA_SOCKET_MULTICAST_PORT) {
-        status = pal_receiveFrom(arm_uc_multicast_socket, recv_buffer, RECEIVE_BUFFER_SIZE, &address, &addrlen, &recv);
+        status = pal_receiveFromBatch(arm_uc_multicast_socket, datagrams, RECEIVE_BATCH_SIZE, &received);
         // Skip data coming from multicast loop
         if (arm_uc_multicast_send_in_progress) {
             tr_info("arm_uc_multicast_socket_callback - multicast loopback data --> skip");
             arm_uc_multicast_send_in_progress = false;
-            return;
+            first = 1;
         }
+#if defined(MBED_CLOUD_CLIENT_MULTICAST_GROUP_REQUESTS)
+    } else if ((intptr_t)port == MBED_CLOUD_CLIENT_MULTICAST_GROUP_PORT) {
+        status = pal_receiveFromBatch(arm_uc_multicast_group_socket, datagrams, RECEIVE_BATCH_SIZE, &received);
+        if (status == PAL_SUCCESS) {
+            for (uint32_t i = 0; i < received; i++) {
+                arm_uc_multicast_group_receive(recv_buffer[i], (uint16_t)datagrams[i].bytesTransferred, &address[i]);
+            }
+        }
+        return;
+#endif
     } else {
-        status = pal_receiveFrom(arm_uc_multicast_missing_frag_socket, recv_buffer, RECEIVE_BUFFER_SIZE, &address, &addrlen, &recv);
+        status = pal_receiveFromBatch(arm_uc_multicast_missing_frag_socket, datagrams, RECEIVE_BATCH_SIZE, &received);
     }
 
     if (status == PAL_SUCCESS) {
-        uint16_t recv_port;
-        ota_ip_address_t ota_addr;
-        status = pal_getSockAddrPort(&address, &recv_port);
-        if (status != PAL_SUCCESS) {
-            tr_error("arm_uc_multicast_socket_callback - pal_getSockAddrPort failed");
-        }
+        for (uint32_t i = first; i < received; i++) {
+            uint16_t recv_port;
+            ota_ip_address_t ota_addr;
+            status = pal_getSockAddrPort(&address[i], &recv_port);
+            if (status != PAL_SUCCESS) {
+                tr_error("arm_uc_multicast_socket_callback - pal_getSockAddrPort failed");
+            }
 
-        if (address.addressType == PAL_AF_INET6 && status == PAL_SUCCESS) {
-            palIpV6Addr_t addr;
-            status = pal_getSockAddrIPV6Addr(&address, addr);
-            if (status == PAL_SUCCESS) {
-                ota_addr.type = OTA_ADDRESS_IPV6; // TODO! can this be something else than ipv6?
-                ota_addr.port = recv_port;
-                memcpy(ota_addr.address_tbl, &addr, sizeof(addr));
-            } else {
-                tr_error("arm_uc_multicast_socket_callback - pal_getSockAddrIPV6Addr failed");
+            if (address[i].addressType == PAL_AF_INET6 && status == PAL_SUCCESS) {
+                palIpV6Addr_t addr;
+                status = pal_getSockAddrIPV6Addr(&address[i], addr);
+                if (status == PAL_SUCCESS) {
+                    ota_addr.type = OTA_ADDRESS_IPV6; // TODO! can this be something else than ipv6?
+                    ota_addr.port = recv_port;
+                    memcpy(ota_addr.address_tbl, &addr, sizeof(addr));
+                } else {
+                    tr_error("arm_uc_multicast_socket_callback - pal_getSockAddrIPV6Addr failed");
+                }
             }
-        }
 
-        if (status == PAL_SUCCESS) {
-            ota_socket_receive_data((uint16_t)recv, recv_buffer, &ota_addr);
+            if (status == PAL_SUCCESS) {
+                ota_socket_receive_data((uint16_t)datagrams[i].bytesTransferred, recv_buffer[i], &ota_addr);
+            }
         }
-    } else {
+    } else if (first == 0) {
         tr_debug("arm_uc_multicast_socket_callback - read error %" PRIx32, status);
     }
 }
@@ -614,6 +693,335 @@ static bool arm_uc_multicast_open_socket(palSocket_t *socket, uint16_t port)
     return true;
 }
 
+#if defined(MBED_CLOUD_CLIENT_MULTICAST_GROUP_REQUESTS)
+/************************************************/
+/* CoAP group requests (RFC 7390)               */
+/*  - border router sends one PUT or POST to    */
+/*    the MPL multicast address                 */
+/*  - nodes apply it and respond after a random */
+/*    delay, spreading the responses over the   */
+/*    same window as the OTA notifications      */
+/************************************************/
+static void *arm_uc_multicast_group_malloc(uint16_t size)
+{
+    return malloc(size);
+}
+
+static uint8_t arm_uc_multicast_group_coap_tx(uint8_t *, uint16_t, sn_nsdl_addr_s *, void *)
+{
+    // Packets are built and sent by this module, the protocol part is only used for parsing
+    return 0;
+}
+
+static bool arm_uc_multicast_group_init()
+{
+    arm_uc_multicast_group_coap = sn_coap_protocol_init(arm_uc_multicast_group_malloc, free,
+                                                        arm_uc_multicast_group_coap_tx, NULL);
+    if (!arm_uc_multicast_group_coap) {
+        tr_error("arm_uc_multicast_group_init - failed to init CoAP");
+        return false;
+    }
+
+    return arm_uc_multicast_open_socket(&arm_uc_multicast_group_socket, MBED_CLOUD_CLIENT_MULTICAST_GROUP_PORT);
+}
+
+static void arm_uc_multicast_group_deinit()
+{
+    pal_close(&arm_uc_multicast_group_socket);
+
+#if defined(ARM_UC_MULTICAST_NODE_MODE)
+    while (arm_uc_multicast_group_responses) {
+        multicast_group_response_t *response = arm_uc_multicast_group_responses;
+        arm_uc_multicast_group_responses = response->next;
+        free(response->packet);
+        free(response);
+    }
+    arm_uc_multicast_group_objects = NULL;
+#else
+    arm_uc_multicast_group_token_valid = false;
+#endif
+
+    if (arm_uc_multicast_group_coap) {
+        sn_coap_protocol_destroy(arm_uc_multicast_group_coap);
+        arm_uc_multicast_group_coap = NULL;
+    }
+}
+
+#if defined(ARM_UC_MULTICAST_NODE_MODE)
+static M2MObject *arm_uc_multicast_group_find_object(const char *name)
+{
+    M2MBaseList::const_iterator it = arm_uc_multicast_group_objects->begin();
+    for (; it != arm_uc_multicast_group_objects->end(); it++) {
+        if ((*it)->base_type() == M2MBase::Object && strcmp((*it)->name(), name) == 0) {
+            return static_cast<M2MObject *>(*it);
+        }
+    }
+    return NULL;
+}
+
+static sn_coap_msg_code_e arm_uc_multicast_group_put(M2MResourceBase *target, const char *name, const sn_coap_hdr_s *request)
+{
+    if ((target->operation() & M2MBase::PUT_ALLOWED) == 0) {
+        return COAP_MSG_CODE_RESPONSE_METHOD_NOT_ALLOWED;
+    }
+
+    if (request->content_format != COAP_CT_NONE &&
+            request->content_format != COAP_CT_TEXT_PLAIN &&
+            request->content_format != COAP_CT_OCTET_STREAM) {
+        return COAP_MSG_CODE_RESPONSE_UNSUPPORTED_CONTENT_FORMAT;
+    }
+
+    if (!request->payload_ptr) {
+        return COAP_MSG_CODE_RESPONSE_BAD_REQUEST;
+    }
+
+    if (!target->set_value(request->payload_ptr, request->payload_len)) {
+        return COAP_MSG_CODE_RESPONSE_INTERNAL_SERVER_ERROR;
+    }
+
+    if (target->is_value_updated_function_set()) {
+        target->execute_value_updated(name);
+    }
+
+    return COAP_MSG_CODE_RESPONSE_CHANGED;
+}
+
+static sn_coap_msg_code_e arm_uc_multicast_group_post(M2MResource *target, const sn_coap_hdr_s *request)
+{
+    if ((target->operation() & M2MBase::POST_ALLOWED) == 0) {
+        return COAP_MSG_CODE_RESPONSE_METHOD_NOT_ALLOWED;
+    }
+
+    if (request->payload_ptr && request->content_format != COAP_CT_NONE && request->content_format != COAP_CT_TEXT_PLAIN) {
+        return COAP_MSG_CODE_RESPONSE_UNSUPPORTED_CONTENT_FORMAT;
+    }
+
+    target->execute_with_argument(request->payload_ptr, request->payload_len);
+
+    return COAP_MSG_CODE_RESPONSE_CHANGED;
+}
+
+// Applies a group request to the resource or resource instance addressed by its path
+static sn_coap_msg_code_e arm_uc_multicast_group_apply(const sn_coap_hdr_s *request)
+{
+    char path[MULTICAST_GROUP_PATH_MAX_LEN + 1];
+    char *segments[4] = { NULL };
+    uint8_t segment_count = 0;
+
+    if (!request->uri_path_ptr || request->uri_path_len == 0 || request->uri_path_len > MULTICAST_GROUP_PATH_MAX_LEN) {
+        return COAP_MSG_CODE_RESPONSE_BAD_REQUEST;
+    }
+
+    memcpy(path, request->uri_path_ptr, request->uri_path_len);
+    path[request->uri_path_len] = '\0';
+
+    char *segment = path;
+    while (segment && segment_count < 4) {
+        segments[segment_count++] = segment;
+        segment = strchr(segment, '/');
+        if (segment) {
+            *segment++ = '\0';
+        }
+    }
+
+    if (segment || segment_count < 3) {
+        return COAP_MSG_CODE_RESPONSE_BAD_REQUEST;
+    }
+
+    M2MObject *object = arm_uc_multicast_group_find_object(segments[0]);
+    M2MObjectInstance *instance = object ? object->object_instance((uint16_t)strtoul(segments[1], NULL, 10)) : NULL;
+    M2MResource *resource = instance ? instance->resource(segments[2]) : NULL;
+    if (!resource) {
+        return COAP_MSG_CODE_RESPONSE_NOT_FOUND;
+    }
+
+    if (request->msg_code == COAP_MSG_CODE_REQUEST_POST) {
+        return (segment_count == 3) ? arm_uc_multicast_group_post(resource, request) : COAP_MSG_CODE_RESPONSE_METHOD_NOT_ALLOWED;
+    }
+
+    if (segment_count == 4) {
+        M2MResourceInstance *resource_instance = resource->resource_instance((uint16_t)strtoul(segments[3], NULL, 10));
+        if (!resource_instance) {
+            return COAP_MSG_CODE_RESPONSE_NOT_FOUND;
+        }
+        return arm_uc_multicast_group_put(resource_instance, resource->name(), request);
+    }
+
+    if (resource->supports_multiple_instances()) {
+        return COAP_MSG_CODE_RESPONSE_METHOD_NOT_ALLOWED;
+    }
+
+    return arm_uc_multicast_group_put(resource, resource->name(), request);
+}
+
+static void arm_uc_multicast_group_queue_response(const sn_coap_hdr_s *request, sn_coap_msg_code_e code,
+                                                  const palSocketAddress_t *address)
+{
+    sn_coap_hdr_s response;
+    sn_coap_parser_init_message(&response);
+
+    // Responses to group requests are never piggybacked, see RFC 7390 section 2.7
+    response.msg_type = COAP_MSG_TYPE_NON_CONFIRMABLE;
+    response.msg_code = code;
+    response.msg_id = randLIB_get_16bit();
+    response.token_ptr = request->token_ptr;
+    response.token_len = request->token_len;
+
+    multicast_group_response_t *pending = (multicast_group_response_t *)malloc(sizeof(multicast_group_response_t));
+    if (!pending) {
+        tr_error("arm_uc_multicast_group_queue_response - out of memory");
+        return;
+    }
+
+    pending->length = sn_coap_builder_calc_needed_packet_data_size(&response);
+    pending->packet = (uint8_t *)malloc(pending->length);
+    if (!pending->packet || sn_coap_builder(pending->packet, &response) < 0) {
+        tr_error("arm_uc_multicast_group_queue_response - failed to build response");
+        free(pending->packet);
+        free(pending);
+        return;
+    }
+
+    memcpy(&pending->address, address, sizeof(palSocketAddress_t));
+    pending->id = arm_uc_multicast_group_response_id++;
+    pending->next = arm_uc_multicast_group_responses;
+    arm_uc_multicast_group_responses = pending;
+
+    // Every node of the group got the same request, spread their responses
+    uint32_t delay = randLIB_get_random_in_range(ARM_UC_OTA_MULTICAST_RAND_START, ARM_UC_OTA_MULTICAST_RAND_END) * 1000 +
+                     randLIB_get_random_in_range(0, 999);
+    tr_info("arm_uc_multicast_group_queue_response - code %d in %" PRIu32 " ms", code, delay);
+    eventOS_event_timer_request(pending->id, ARM_UC_OTA_GROUP_RESPONSE_EVENT, arm_uc_multicast_tasklet_id, delay);
+}
+
+static void arm_uc_multicast_group_send_response(uint8_t response_id)
+{
+    multicast_group_response_t **link = &arm_uc_multicast_group_responses;
+    while (*link && (*link)->id != response_id) {
+        link = &(*link)->next;
+    }
+
+    multicast_group_response_t *response = *link;
+    if (!response) {
+        return;
+    }
+    *link = response->next;
+
+    size_t sent;
+    if (pal_sendTo(arm_uc_multicast_group_socket, response->packet, response->length,
+                   &response->address, sizeof(response->address), &sent) != PAL_SUCCESS) {
+        tr_error("arm_uc_multicast_group_send_response - send failed");
+    }
+
+    free(response->packet);
+    free(response);
+}
+#endif // ARM_UC_MULTICAST_NODE_MODE
+
+static void arm_uc_multicast_group_receive(uint8_t *data, uint16_t length, const palSocketAddress_t *address)
+{
+    coap_version_e version = COAP_VERSION_UNKNOWN;
+    sn_coap_hdr_s *message = sn_coap_parser(arm_uc_multicast_group_coap, length, data, &version);
+    if (!message) {
+        tr_error("arm_uc_multicast_group_receive - failed to parse");
+        return;
+    }
+
+#if defined(ARM_UC_MULTICAST_NODE_MODE)
+    if (message->msg_code == COAP_MSG_CODE_REQUEST_PUT || message->msg_code == COAP_MSG_CODE_REQUEST_POST) {
+        sn_coap_msg_code_e code = arm_uc_multicast_group_apply(message);
+        tr_info("arm_uc_multicast_group_receive - group request, result %d", code);
+        // Nodes without the resource stay silent, the group may mix device types
+        if (code != COAP_MSG_CODE_RESPONSE_NOT_FOUND) {
+            arm_uc_multicast_group_queue_response(message, code, address);
+        }
+    }
+#else
+    // Own requests are looped back, only responses to the latest request are counted
+    if (message->msg_code >= COAP_MSG_CODE_RESPONSE_CREATED &&
+            arm_uc_multicast_group_token_valid &&
+            message->token_len == sizeof(arm_uc_multicast_group_token) &&
+            memcmp(message->token_ptr, arm_uc_multicast_group_token, sizeof(arm_uc_multicast_group_token)) == 0) {
+        palIpV6Addr_t addr;
+        if (pal_getSockAddrIPV6Addr(address, addr) == PAL_SUCCESS) {
+            arm_uc_multicast_group_response_count++;
+            tr_info("arm_uc_multicast_group_receive - response %d from %s (%" PRIu16 " total)",
+                    message->msg_code, trace_ipv6(addr), arm_uc_multicast_group_response_count);
+            if (arm_uc_multicast_group_response_callback) {
+                arm_uc_multicast_group_response_callback(addr, message->msg_code, arm_uc_multicast_group_response_count);
+            }
+        }
+    }
+#endif
+
+    sn_coap_parser_release_allocated_coap_msg_mem(arm_uc_multicast_group_coap, message);
+}
+
+#if defined(ARM_UC_MULTICAST_BORDER_ROUTER_MODE)
+multicast_status_e arm_uc_multicast_group_request(sn_coap_msg_code_e method, const char *uri_path,
+                                                  const uint8_t *payload, uint16_t payload_len)
+{
+    if (!arm_uc_multicast_group_coap || !uri_path ||
+            (method != COAP_MSG_CODE_REQUEST_PUT && method != COAP_MSG_CODE_REQUEST_POST)) {
+        return MULTICAST_STATUS_ERROR;
+    }
+
+    randLIB_get_n_bytes_random(arm_uc_multicast_group_token, sizeof(arm_uc_multicast_group_token));
+    arm_uc_multicast_group_token_valid = true;
+    arm_uc_multicast_group_response_count = 0;
+
+    sn_coap_hdr_s request;
+    sn_coap_parser_init_message(&request);
+    request.msg_type = COAP_MSG_TYPE_NON_CONFIRMABLE;
+    request.msg_code = method;
+    request.msg_id = randLIB_get_16bit();
+    request.token_ptr = arm_uc_multicast_group_token;
+    request.token_len = sizeof(arm_uc_multicast_group_token);
+    request.uri_path_ptr = (uint8_t *)uri_path;
+    request.uri_path_len = strlen(uri_path);
+    if (payload && payload_len) {
+        request.content_format = COAP_CT_TEXT_PLAIN;
+        request.payload_ptr = (uint8_t *)payload;
+        request.payload_len = payload_len;
+    }
+
+    uint16_t length = sn_coap_builder_calc_needed_packet_data_size(&request);
+    uint8_t *packet = (uint8_t *)malloc(length);
+    if (!packet || sn_coap_builder(packet, &request) < 0) {
+        tr_error("arm_uc_multicast_group_request - failed to build request");
+        free(packet);
+        return MULTICAST_STATUS_ERROR;
+    }
+
+    palSocketAddress_t pal_addr = { 0, { 0 } };
+    palIpV6Addr_t addr;
+    memcpy(addr, arm_uc_multicast_address, 16);
+    size_t sent;
+    palStatus_t status = pal_setSockAddrIPV6Addr(&pal_addr, addr);
+    if (status == PAL_SUCCESS) {
+        status = pal_setSockAddrPort(&pal_addr, MBED_CLOUD_CLIENT_MULTICAST_GROUP_PORT);
+    }
+    if (status == PAL_SUCCESS) {
+        status = pal_sendTo(arm_uc_multicast_group_socket, packet, length, &pal_addr, sizeof(pal_addr), &sent);
+    }
+    free(packet);
+
+    if (status != PAL_SUCCESS) {
+        tr_error("arm_uc_multicast_group_request - send failed %" PRIx32, status);
+        return MULTICAST_STATUS_ERROR;
+    }
+
+    tr_info("arm_uc_multicast_group_request - %s sent to the group", uri_path);
+    return MULTICAST_STATUS_SUCCESS;
+}
+
+void arm_uc_multicast_group_set_response_callback(arm_uc_multicast_group_response_cb callback)
+{
+    arm_uc_multicast_group_response_callback = callback;
+}
+#endif // ARM_UC_MULTICAST_BORDER_ROUTER_MODE
+#endif // MBED_CLOUD_CLIENT_MULTICAST_GROUP_REQUESTS
+
 /************************************************/
 /* Timer implementation                         */
 /************************************************/
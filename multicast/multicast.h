@@ -29,6 +29,7 @@
 #define ARM_UC_OTA_MULTICAST_EXTERNAL_UPDATE_EVENT  4
 #define ARM_UC_OTA_DELETE_SESSION_EVENT             5
 #define ARM_UC_OTA_FULL_REG_EVENT                   6
+#define ARM_UC_OTA_GROUP_RESPONSE_EVENT             7
 // Make sure that timer id does not collapse with one defined in ota_timers_e
 #define ARM_UC_HUB_EVENT_TIMER                      100
 
@@ -116,6 +117,40 @@ void arm_uc_multicast_network_connected();
  */
 multicast_status_e arm_uc_multicast_init(M2MBaseList &list, ConnectorClient &client, const int8_t tasklet_id);
 
+#if defined(MBED_CLOUD_CLIENT_MULTICAST_GROUP_REQUESTS)
+#include "sn_coap_header.h"
+
+/**
+ *  @brief Called for each node responding to the latest group request.
+ *
+ *  @param address IPv6 address of the node
+ *  @param code Result of the request on the node
+ *  @param count Number of responses received to the request so far
+ */
+typedef void (*arm_uc_multicast_group_response_cb)(const uint8_t *address, sn_coap_msg_code_e code, uint16_t count);
+
+/**
+ *  @brief Sends a CoAP PUT or POST to every node of the mesh (RFC 7390 group communication).
+ *         Nodes apply it to their own resource at the same path and respond after a random
+ *         delay, nodes without the resource do not respond. Border router mode only.
+ *
+ *  @param method COAP_MSG_CODE_REQUEST_PUT or COAP_MSG_CODE_REQUEST_POST
+ *  @param uri_path Path of the resource, for example "3303/0/5700"
+ *  @param payload Value in text format, may be NULL
+ *  @param payload_len Length of the value
+ *  @return MULTICAST_STATUS_SUCCESS on success, or some error if failed
+ */
+multicast_status_e arm_uc_multicast_group_request(sn_coap_msg_code_e method, const char *uri_path,
+                                                  const uint8_t *payload, uint16_t payload_len);
+
+/**
+ *  @brief Sets the callback receiving the responses to group requests.
+ *
+ *  @param callback Callback, NULL to only count the responses
+ */
+void arm_uc_multicast_group_set_response_callback(arm_uc_multicast_group_response_cb callback);
+#endif // MBED_CLOUD_CLIENT_MULTICAST_GROUP_REQUESTS
+
 #endif // __cplusplus
 
 #endif /* ARM_UC_MULTICAST_H */
@@ -25,5 +25,6 @@
 extern uint16_t ip_fcf_v(uint_fast8_t count, const ns_iovec_t vec[static count]);
 extern uint16_t ipv6_fcf(const uint8_t src_address[static 16], const uint8_t dest_address[static 16],
                          uint16_t data_length, const uint8_t data_ptr[static data_length],  uint8_t next_protocol);
+extern uint16_t ip_fcf_update(uint16_t checksum, const uint8_t *old_data, const uint8_t *new_data, uint_fast16_t length);
 
 #endif
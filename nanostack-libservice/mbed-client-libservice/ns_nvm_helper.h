@@ -38,6 +38,11 @@
  * -initialize the NVM if not initialized
  * -read data from the key
  *
+ * Requests are queued while an earlier one is in progress. A write to a key which
+ * already has a write waiting in the queue replaces that write, and both callbacks are
+ * called when the data has been written. Writes queued back to back are flushed once,
+ * and a read of a key with a write waiting in the queue is answered from its data.
+ *
  * When client deletes a key this module will:
  * -initialize the NVM if not initialized
  * -delete the key from NVM
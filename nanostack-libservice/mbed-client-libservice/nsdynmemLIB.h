@@ -67,6 +67,60 @@ typedef struct mem_stat_t {
 
 typedef struct ns_mem_book ns_mem_book_t;
 
+/* Build the segregated-fit allocation mode, see ns_mem_set_segregated_fit() */
+#ifndef NS_DYN_MEM_SEGREGATED_FIT
+#define NS_DYN_MEM_SEGREGATED_FIT 1
+#endif
+
+/* Keep small freed blocks in a cache per thread, see ns_dyn_mem_flush_thread_cache().
+   This needs thread-local storage and POSIX threads, so it is only built on Linux. */
+#ifndef NS_DYN_MEM_THREAD_CACHE
+#if defined(__linux__) && !defined(STANDARD_MALLOC)
+#define NS_DYN_MEM_THREAD_CACHE 1
+#else
+#define NS_DYN_MEM_THREAD_CACHE 0
+#endif
+#endif
+
+/* Number of blocks a thread can cache for each size class */
+#ifndef NS_DYN_MEM_THREAD_CACHE_DEPTH
+#define NS_DYN_MEM_THREAD_CACHE_DEPTH 8
+#endif
+
+#if NS_DYN_MEM_THREAD_CACHE && (NS_DYN_MEM_THREAD_CACHE_DEPTH < 2 || NS_DYN_MEM_THREAD_CACHE_DEPTH > 255)
+#error "NS_DYN_MEM_THREAD_CACHE_DEPTH must be between 2 and 255"
+#endif
+
+/* Record live allocations by call site, see ns_dyn_mem_profile_get() */
+#ifndef NS_DYN_MEM_PROFILE
+#define NS_DYN_MEM_PROFILE 0
+#endif
+
+/* Number of call sites recorded, the last entry collects the sites that did not fit */
+#ifndef NS_DYN_MEM_PROFILE_SITES
+#define NS_DYN_MEM_PROFILE_SITES 32
+#endif
+
+#if NS_DYN_MEM_PROFILE && (defined(STANDARD_MALLOC) || !defined(__GNUC__))
+#error "NS_DYN_MEM_PROFILE needs the library heap and __builtin_return_address()"
+#endif
+
+#if NS_DYN_MEM_PROFILE && NS_DYN_MEM_PROFILE_SITES < 2
+#error "NS_DYN_MEM_PROFILE_SITES must be at least 2"
+#endif
+
+/**
+ * /struct ns_mem_profile_site_t
+ * /brief Allocations made from one call site
+ */
+typedef struct ns_mem_profile_site {
+    const void *site;                           /**< Return address of the allocation call, NULL for the sites that did not fit. */
+    uint32_t alloc_cnt;                         /**< Allocations made. */
+    uint32_t live_cnt;                          /**< Blocks allocated and not yet freed. */
+    ns_mem_heap_size_t live_bytes;              /**< Heap taken by those blocks in bytes. */
+    ns_mem_heap_size_t live_bytes_max;          /**< live_bytes max value. */
+} ns_mem_profile_site_t;
+
 /**
   * \brief Init and set Dynamical heap pointer and length.
   *
@@ -136,6 +190,77 @@ extern const mem_stat_t *ns_dyn_mem_get_mem_stat(void);
   */
 extern int ns_dyn_mem_set_temporary_alloc_free_heap_threshold(uint8_t free_heap_percentage, ns_mem_heap_size_t free_heap_amount);
 
+/**
+  * \brief Select segregated-fit allocation for the default heap.
+  *
+  * See ns_mem_set_segregated_fit().
+  *
+  * \param enable true for segregated-fit, false for first-fit allocation
+  *
+  * \return 0 on success, <0 otherwise
+  */
+extern int ns_dyn_mem_set_segregated_fit(bool enable);
+
+/**
+  * \brief Return the blocks cached by the calling thread to their heap.
+  *
+  * With NS_DYN_MEM_THREAD_CACHE, long period allocations of up to 128 bytes
+  * are served from a small cache of each thread, which is refilled from and
+  * returned to the heap several blocks at a time. This avoids entering the
+  * critical section on most small allocations and frees. Cached blocks are
+  * counted as allocated in the memory statistics.
+  *
+  * The cache is flushed when the thread exits, and when an allocation of the
+  * thread would otherwise fail. This function flushes it earlier, for example
+  * before reading the memory statistics.
+  */
+extern void ns_dyn_mem_flush_thread_cache(void);
+
+/**
+  * \brief Get the size of free heap and of its largest free block.
+  *
+  * The fragmentation index is the part of the free heap that is not in the
+  * largest free block. At 0 the free heap is one block, near 100 it is in
+  * many small blocks and a large allocation fails even if there is enough
+  * free heap in total.
+  *
+  * \param book Address of book keeping structure
+  * \param largest_free Largest free block in bytes, or NULL
+  * \param total_free Free heap in bytes, or NULL
+  *
+  * \return 0-100, fragmentation index in percent
+  * \return <0 on error
+  */
+extern int ns_mem_get_fragmentation(ns_mem_book_t *book, ns_mem_heap_size_t *largest_free, ns_mem_heap_size_t *total_free);
+
+/**
+  * \brief Get the fragmentation of the default heap.
+  *
+  * See ns_mem_get_fragmentation().
+  */
+extern int ns_dyn_mem_get_fragmentation(ns_mem_heap_size_t *largest_free, ns_mem_heap_size_t *total_free);
+
+/**
+  * \brief Get the live allocations of each call site.
+  *
+  * With NS_DYN_MEM_PROFILE, every allocation records the return address of
+  * the ns_dyn_mem_alloc() or ns_mem_alloc() call, and the profile keeps the
+  * blocks and bytes each call site holds. The addresses can be resolved with
+  * the map file or addr2line. Recording takes one more word per block.
+  * Blocks of all heaps are counted together.
+  *
+  * \param sites Array for the call sites
+  * \param max_sites Size of the array
+  *
+  * \return Number of call sites copied, 0 without NS_DYN_MEM_PROFILE
+  */
+extern uint16_t ns_dyn_mem_profile_get(ns_mem_profile_site_t *sites, uint16_t max_sites);
+
+/**
+  * \brief Print the call sites and the fragmentation of the default heap over trace.
+  */
+extern void ns_dyn_mem_profile_trace(void);
+
 /**
   * \brief Init and set Dynamical heap pointer and length.
   *
@@ -210,6 +335,26 @@ extern const mem_stat_t *ns_mem_get_mem_stat(ns_mem_book_t *book);
   */
 extern int ns_mem_set_temporary_alloc_free_heap_threshold(ns_mem_book_t *book, uint8_t free_heap_percentage, ns_mem_heap_size_t free_heap_amount);
 
+/**
+  * \brief Select segregated-fit allocation for a heap.
+  *
+  * By default free blocks are kept in one list in address order, and allocation
+  * takes the first block that fits, so its time grows with heap fragmentation.
+  * In segregated-fit mode free blocks are kept in lists by size class, so that
+  * allocation and free take constant time. Temporary allocations still take the
+  * bottom and long period allocations the top of the chosen block, but blocks
+  * are no longer chosen by address. Memory statistics and the temporary
+  * allocation threshold work the same in both modes.
+  *
+  * The mode can be changed at any time, the free blocks are then sorted again.
+  *
+  * \param book Address of book keeping structure
+  * \param enable true for segregated-fit, false for first-fit allocation
+  *
+  * \return 0 on success, <0 otherwise
+  */
+extern int ns_mem_set_segregated_fit(ns_mem_book_t *book, bool enable);
+
 #ifdef __cplusplus
 }
 #endif
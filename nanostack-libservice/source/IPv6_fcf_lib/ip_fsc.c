@@ -16,6 +16,38 @@
 #include "stdint.h"
 #include "ip_fsc.h"
 
+/* Add data starting at an even offset to a ones-complement sum as big-endian 16-bit
+ * words, four bytes at a time. A trailing odd byte is added as the high byte of a word.
+ * The carries are left in the 64-bit accumulator and folded only at the end.
+ */
+static uint_fast64_t ip_fcf_sum(uint_fast64_t acc, const uint8_t *data_ptr, uint_fast16_t data_length)
+{
+    while (data_length >= 4) {
+        acc += (uint_fast32_t) data_ptr[0] << 24 | (uint_fast32_t) data_ptr[1] << 16 |
+               (uint_fast32_t) data_ptr[2] << 8 | data_ptr[3];
+        data_ptr += 4;
+        data_length -= 4;
+    }
+    if (data_length >= 2) {
+        acc += (uint_fast16_t) data_ptr[0] << 8 | data_ptr[1];
+        data_ptr += 2;
+        data_length -= 2;
+    }
+    if (data_length) {
+        acc += (uint_fast16_t) data_ptr[0] << 8;
+    }
+    return acc;
+}
+
+/* Fold the carries of a ones-complement sum down to 16 bits */
+static uint16_t ip_fcf_fold(uint_fast64_t acc)
+{
+    while (acc >> 16) {
+        acc = (acc >> 16) + (acc & 0xffff);
+    }
+    return (uint16_t) acc;
+}
+
 /** \brief Compute IP checksum for arbitary data
  *
  * Compute an IP checksum, given a arbitrary gather list.
@@ -23,40 +55,48 @@
  * See ipv6_fcf for discussion of use.
  *
  * This will work for any arbitrary gather list - it can handle odd
- * alignments. The one limitation is that the 32-bit accumulator limits
- * it to basically 64K of total data.
+ * alignments.
  */
 uint16_t ip_fcf_v(uint_fast8_t count, const ns_iovec_t vec[static count])
 {
-    uint_fast32_t acc32 = 0;
+    uint_fast64_t acc = 0;
     bool odd = false;
     while (count) {
         const uint8_t *data_ptr = vec->iov_base;
         uint_fast16_t data_length = vec->iov_len;
         if (odd && data_length > 0) {
-            acc32 += *data_ptr++;
+            acc += *data_ptr++;
             data_length--;
             odd = false;
         }
-        while (data_length >= 2) {
-            acc32 += (uint_fast16_t) data_ptr[0] << 8 | data_ptr[1];
-            data_ptr += 2;
-            data_length -= 2;
-        }
-        if (data_length) {
-            acc32 += (uint_fast16_t) data_ptr[0] << 8;
+        acc = ip_fcf_sum(acc, data_ptr, data_length);
+        if (data_length & 1) {
             odd = true;
         }
         vec++;
         count--;
     }
 
-    // Fold down up to 0xffff carries in the 32-bit accumulator
-    acc32 = (acc32 >> 16) + (acc32 & 0xffff);
+    return ~ip_fcf_fold(acc);
+}
+
+/** \brief Update an IP checksum for changed data
+ *
+ * Incrementally update a checksum when a field covered by it is rewritten,
+ * as described in RFC 1624, instead of computing it again over all the data.
+ *
+ * The field must start at an even offset of the checksummed data, such as
+ * an address or a port. As with ipv6_fcf, a UDP checksum of 0x0000 must be
+ * transformed to 0xFFFF by the caller.
+ */
+uint16_t ip_fcf_update(uint16_t checksum, const uint8_t *old_data, const uint8_t *new_data, uint_fast16_t length)
+{
+    // HC' = ~(~HC + ~m + m'), where the sum of ~m is the complement of the sum of m
+    uint_fast64_t acc = (uint16_t) ~checksum;
+    acc += (uint16_t) ~ip_fcf_fold(ip_fcf_sum(0, old_data, length));
+    acc = ip_fcf_sum(acc, new_data, length);
 
-    // Could be one more carry from the previous addition (result <= 0x1fffe)
-    uint16_t sum16 = (uint16_t)((acc32 >> 16) + (acc32 & 0xffff));
-    return ~sum16;
+    return ~ip_fcf_fold(acc);
 }
 
 /** \brief Compute IPv6 checksum
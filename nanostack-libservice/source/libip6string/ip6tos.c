@@ -27,61 +27,57 @@
  */
 uint_fast8_t ip6tos(const void *ip6addr, char *p)
 {
+    static const char hex_digits[] = "0123456789abcdef";
     char *p_orig = p;
     uint_fast8_t zero_start = 255, zero_len = 1;
+    uint_fast8_t run_start = 0, run_len = 0;
     const uint8_t *addr = ip6addr;
-    uint_fast16_t part;
+    uint16_t parts[8];
 
-    /* Follow RFC 5952 - pre-scan for longest run of zeros */
+    /* Follow RFC 5952 - find the longest run of zeros in one pass. If runs
+     * are equal, we stick with the first one - RFC 5952 S4.2.3. Note that
+     * zero_len being initialised to 1 stops us shortening a 1-part run (S4.2.2.)
+     */
     for (uint_fast8_t n = 0; n < 8; n++) {
-        part = *addr++;
-        part = (part << 8) | *addr++;
-        if (part != 0) {
+        parts[n] = common_read_16_bit(addr + 2 * n);
+        if (parts[n] != 0) {
+            run_len = 0;
             continue;
         }
-
-        /* We're at the start of a run of zeros - scan to non-zero (or end) */
-        uint_fast8_t n0 = n;
-        for (n = n0 + 1; n < 8; n++) {
-            part = *addr++;
-            part = (part << 8) | *addr++;
-            if (part != 0) {
-                break;
-            }
+        if (run_len++ == 0) {
+            run_start = n;
         }
-
-        /* Now n0->initial zero of run, n->after final zero in run. Is this the
-         * longest run yet? If equal, we stick with the previous one - RFC 5952
-         * S4.2.3. Note that zero_len being initialised to 1 stops us
-         * shortening a 1-part run (S4.2.2.)
-         */
-        if (n - n0 > zero_len) {
-            zero_start = n0;
-            zero_len = n - n0;
+        if (run_len > zero_len) {
+            zero_start = run_start;
+            zero_len = run_len;
         }
-
-        /* Continue scan for initial zeros from part n+1 - we've already
-         * consumed part n, and know it's non-zero. */
     }
 
-    /* Now go back and print, jumping over any zero run */
-    addr = ip6addr;
+    /* Now print, jumping over any zero run */
     for (uint_fast8_t n = 0; n < 8;) {
         if (n == zero_start) {
             if (n == 0) {
                 *p++ = ':';
             }
             *p++ = ':';
-            addr += 2 * zero_len;
             n += zero_len;
             continue;
         }
 
-        part = *addr++;
-        part = (part << 8) | *addr++;
-        n++;
+        uint_fast16_t part = parts[n++];
 
-        p += sprintf(p, "%"PRIxFAST16, part);
+        /* Hex digits from the first non-zero one */
+        uint_fast8_t shift = 12;
+        while (shift && !(part >> shift)) {
+            shift -= 4;
+        }
+        for (;;) {
+            *p++ = hex_digits[(part >> shift) & 0xf];
+            if (!shift) {
+                break;
+            }
+            shift -= 4;
+        }
 
         /* One iteration writes "part:" rather than ":part", and has the
          * explicit check for n == 8 below, to allow easy extension for
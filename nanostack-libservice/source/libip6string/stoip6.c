@@ -19,8 +19,7 @@
 #include "common_functions.h"
 #include "ip6string.h"
 
-static uint16_t hex(const char *p);
-static bool is_hex(char c);
+static uint_fast8_t hex_value(char c);
 
 /**
  * Convert numeric IPv6 address string to a binary.
@@ -45,11 +44,14 @@ bool stoip6(const char *ip6addr, size_t len, void *dest)
     // First go forward the string, until end, noting :: position if any
     // We're decrementing `len` as we go forward, and stop when it reaches 0
     for (field_no = 0, p = ip6addr; len && *p; p = q + 1) {
+        uint_fast16_t value = 0;
 
         for (q = p; len && *q && (*q != ':'); len -= 1) { // Seek for ':' or end
-            if (!is_hex(*q++)) { // There must only be hex characters besides ':'
+            uint_fast8_t digit = hex_value(*q++);
+            if (digit > 0xf) { // There must only be hex characters besides ':'
                 goto error;
             }
+            value = (value << 4) | digit;
         }
 
         if ((q - p) > 4) { // We can't have more than 4 hex digits per segment
@@ -61,7 +63,7 @@ bool stoip6(const char *ip6addr, size_t len, void *dest)
         }
 
         // Convert and write this part, (high-endian AKA network byte order)
-        addr = common_write_16_bit(hex(p), addr);
+        addr = common_write_16_bit(value, addr);
         field_no++;
 
         // We handle the colons
@@ -146,35 +148,23 @@ int stoip6_prefix(const char *ip6addr, void *dest, int_fast16_t *prefix_len_out)
     return 0;
 }
 
-static bool is_hex(char c)
+/* Values of characters '0' to 'f', 0xff for the ones that are not hex digits */
+static const uint8_t hex_values['f' - '0' + 1] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9,                                           // '0' - '9'
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,                               // ':' - '@'
+    10, 11, 12, 13, 14, 15,                                                 // 'A' - 'F'
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, // 'G' - 'R'
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, // 'S' - '^'
+    0xff, 0xff,                                                             // '_' - '`'
+    10, 11, 12, 13, 14, 15                                                  // 'a' - 'f'
+};
+
+static uint_fast8_t hex_value(char c)
 {
-    // 'A' (0x41) and 'a' (0x61) are mapped in the ASCII table in such a way that masking the 0x20 bit turn 'a' in 'A'
-    if ((c & ~0x20) >= 'A' && (c & ~0x20) <= 'F') {
-        return true;
-    }
-
-    if (c >= '0' && c <= '9') {
-        return true;
-    }
-
-    return false;
-}
+    uint8_t index = (uint8_t)c - '0';
 
-static uint16_t hex(const char *p)
-{
-    uint16_t val = 0;
-
-    for (;;) {
-        char c = *p++;
-        if ((c >= '0') && (c <= '9')) {
-            val = (val << 4) | (c - '0');
-        } else if ((c >= 'A') && (c <= 'F')) {
-            val = (val << 4) | (10 + (c - 'A'));
-        } else if ((c >= 'a') && (c <= 'f')) {
-            val = (val << 4) | (10 + (c - 'a'));
-        } else {
-            break; // Non hex character
-        }
+    if (index >= sizeof(hex_values)) {
+        return 0xff;
     }
-    return val;
+    return hex_values[index];
 }
@@ -19,6 +19,14 @@
 #include "platform/arm_hal_interrupt.h"
 #include <stdlib.h>
 #include "ns_list.h"
+#if NS_DYN_MEM_THREAD_CACHE
+#include <pthread.h>
+#endif
+#if NS_DYN_MEM_PROFILE
+#include "ns_trace.h"
+
+#define TRACE_GROUP "dmem"
+#endif
 
 #ifndef STANDARD_MALLOC
 typedef enum mem_stat_update_t {
@@ -33,6 +41,20 @@ typedef struct {
 
 typedef int ns_mem_word_size_t; // internal signed heap block size type
 
+#if NS_DYN_MEM_THREAD_CACHE
+// size classes of the thread cache are 16, 32, 64 and 128 bytes
+#define NS_MEM_CACHE_CLASSES 4
+#define NS_MEM_CACHE_MIN_SIZE 16
+#define NS_MEM_CACHE_MAX_SIZE (NS_MEM_CACHE_MIN_SIZE << (NS_MEM_CACHE_CLASSES - 1))
+#endif
+
+#if NS_DYN_MEM_SEGREGATED_FIT
+// one free list per power of two of the block data size in words
+#define NS_MEM_BIN_COUNT (sizeof(ns_mem_word_size_t) * 8)
+
+typedef NS_LIST_HEAD(hole_t, link) hole_list_t;
+#endif
+
 /* struct for book keeping variables */
 struct ns_mem_book {
     ns_mem_word_size_t     *heap_main;
@@ -42,9 +64,28 @@ struct ns_mem_book {
     NS_LIST_HEAD(hole_t, link) holes_list;
     ns_mem_heap_size_t heap_size;
     ns_mem_heap_size_t temporary_alloc_heap_limit;   /* Amount of reserved heap temporary alloc can't exceed */
+#if NS_DYN_MEM_THREAD_CACHE
+    uint32_t id;                        /* changes when the heap is initialised, see ns_mem_cache_get() */
+#endif
+#if NS_DYN_MEM_SEGREGATED_FIT
+    bool segregated_fit;                /* holes are kept in bins instead of holes_list */
+    uint32_t bin_map;                   /* bit set for each non-empty bin */
+    hole_list_t bins[NS_MEM_BIN_COUNT];
+#endif
 };
 
 static ns_mem_book_t *default_book; // heap pointer for original "ns_" API use
+#if NS_DYN_MEM_THREAD_CACHE
+static uint32_t book_id; // id of the latest initialised heap
+#endif
+
+#if NS_DYN_MEM_PROFILE
+static ns_mem_profile_site_t profile_sites[NS_DYN_MEM_PROFILE_SITES];
+static ns_mem_word_size_t profile_site_cnt;
+#define NS_MEM_CALL_SITE __builtin_return_address(0)
+#else
+#define NS_MEM_CALL_SITE NULL
+#endif
 
 // size of a hole_t in our word units
 #define HOLE_T_SIZE ((ns_mem_word_size_t) ((sizeof(hole_t) + sizeof(ns_mem_word_size_t) - 1) / sizeof(ns_mem_word_size_t)))
@@ -120,6 +161,13 @@ ns_mem_book_t *ns_mem_init(void *heap, ns_mem_heap_size_t h_size,
 
     ns_list_init(&book->holes_list);
     ns_list_add_to_start(&book->holes_list, hole_from_block_start(book->heap_main));
+#if NS_DYN_MEM_SEGREGATED_FIT
+    book->segregated_fit = false;
+    book->bin_map = 0;
+    for (unsigned i = 0; i < NS_MEM_BIN_COUNT; i++) {
+        ns_list_init(&book->bins[i]);
+    }
+#endif
 
     book->mem_stat_info_ptr = info_ptr;
     //RESET Memory by Hea Len
@@ -128,6 +176,9 @@ ns_mem_book_t *ns_mem_init(void *heap, ns_mem_heap_size_t h_size,
         book->mem_stat_info_ptr->heap_sector_size = book->heap_size;
     }
     book->temporary_alloc_heap_limit = book->heap_size / 100 * (100 - TEMPORARY_ALLOC_FREE_HEAP_THRESHOLD);
+#if NS_DYN_MEM_THREAD_CACHE
+    book->id = ++book_id;
+#endif
 #endif
     //There really is no support to standard malloc in this library anymore
     book->heap_failure_callback = passed_fptr;
@@ -235,34 +286,131 @@ static int8_t ns_mem_block_validate(ns_mem_word_size_t *block_start)
     }
     return ret_val;
 }
-#endif
 
-// For direction, use 1 for direction up and -1 for down
-static void *ns_mem_internal_alloc(ns_mem_book_t *book, const ns_mem_block_size_t alloc_size, int direction)
+#if NS_DYN_MEM_SEGREGATED_FIT
+// Bin of a hole is the position of the highest set bit of its data size
+static unsigned ns_mem_bin_index(ns_mem_word_size_t data_size)
 {
-#ifndef STANDARD_MALLOC
-    if (!book) {
-        /* We can not do anything except return NULL because we can't find book
-           keeping block */
-        return NULL;
+    unsigned index = 0;
+    while (data_size >>= 1) {
+        index++;
     }
+    return index;
+}
 
-    if (book->mem_stat_info_ptr && direction == 1) {
-        if (book->mem_stat_info_ptr->heap_sector_allocated_bytes > book->temporary_alloc_heap_limit) {
-            /* Not enough heap for temporary memory allocation */
-            dev_stat_update(book->mem_stat_info_ptr, DEV_HEAP_ALLOC_FAIL, 0);
+static void ns_mem_bin_add(ns_mem_book_t *book, ns_mem_word_size_t *block_start, ns_mem_word_size_t data_size)
+{
+    unsigned index = ns_mem_bin_index(data_size);
+    ns_list_add_to_start(&book->bins[index], hole_from_block_start(block_start));
+    book->bin_map |= (uint32_t) 1 << index;
+}
+
+static void ns_mem_bin_remove(ns_mem_book_t *book, ns_mem_word_size_t *block_start, ns_mem_word_size_t data_size)
+{
+    unsigned index = ns_mem_bin_index(data_size);
+    ns_list_remove(&book->bins[index], hole_from_block_start(block_start));
+    if (ns_list_is_empty(&book->bins[index])) {
+        book->bin_map &= ~((uint32_t) 1 << index);
+    }
+}
+
+// Find and unlink a hole of at least data_size words. Every hole in a bin above
+// the size's own bin is big enough, so the first non-empty one is taken from the
+// bin map. Only if there is none, the size's own bin is searched.
+static ns_mem_word_size_t *ns_mem_bin_take(ns_mem_book_t *book, ns_mem_word_size_t data_size)
+{
+    unsigned index = ns_mem_bin_index(data_size);
+    unsigned first = (data_size & (data_size - 1)) ? index + 1 : index;
+    uint32_t map = first < NS_MEM_BIN_COUNT ? book->bin_map >> first : 0;
+    ns_mem_word_size_t *block_ptr = NULL;
+
+    if (map) {
+        while (!(map & 1)) {
+            map >>= 1;
+            first++;
+        }
+        block_ptr = block_start_from_hole(ns_list_get_first(&book->bins[first]));
+    } else if (first != index) {
+        ns_list_foreach(hole_t, cur_hole, &book->bins[index]) {
+            ns_mem_word_size_t *p = block_start_from_hole(cur_hole);
+            if (-*p >= data_size) {
+                block_ptr = p;
+                break;
+            }
+        }
+    }
+
+    if (block_ptr) {
+        if (ns_mem_block_validate(block_ptr) != 0 || *block_ptr >= 0) {
+            heap_failure(book, NS_DYN_MEM_HEAP_SECTOR_CORRUPTED);
             return NULL;
         }
+        ns_mem_bin_remove(book, block_ptr, -*block_ptr);
     }
+    return block_ptr;
+}
+
+// Put every hole of the heap on the free list(s) of the current mode
+static void ns_mem_rebuild_holes(ns_mem_book_t *book)
+{
+    ns_list_init(&book->holes_list);
+    for (unsigned i = 0; i < NS_MEM_BIN_COUNT; i++) {
+        ns_list_init(&book->bins[i]);
+    }
+    book->bin_map = 0;
+
+    for (ns_mem_word_size_t *p = book->heap_main; p < book->heap_main_end; p += 1 + abs(*p) + 1) {
+        if (*p < 0 && -*p >= HOLE_T_SIZE) {
+            if (book->segregated_fit) {
+                ns_mem_bin_add(book, p, -*p);
+            } else {
+                ns_list_add_to_end(&book->holes_list, hole_from_block_start(p));
+            }
+        }
+    }
+}
+#endif // NS_DYN_MEM_SEGREGATED_FIT
+#endif
 
+#ifndef STANDARD_MALLOC
+// Takes a block of at least *data_size words from the heap, must be called in
+// critical section. *data_size is set to the size of the block taken.
+// For direction, use 1 for direction up and -1 for down
+static ns_mem_word_size_t *ns_mem_heap_take(ns_mem_book_t *book, ns_mem_word_size_t *data_size_ptr, int direction)
+{
+    ns_mem_word_size_t data_size = *data_size_ptr;
     ns_mem_word_size_t *block_ptr = NULL;
 
-    platform_enter_critical();
+#if NS_DYN_MEM_SEGREGATED_FIT
+    if (book->segregated_fit) {
+        block_ptr = ns_mem_bin_take(book, data_size);
+        if (!block_ptr) {
+            return NULL;
+        }
 
-    ns_mem_word_size_t data_size = convert_allocation_size(book, alloc_size);
-    if (!data_size) {
-        goto done;
+        ns_mem_word_size_t hole_data_size = -*block_ptr;
+        if (hole_data_size >= (data_size + 2 + HOLE_T_SIZE)) {
+            ns_mem_word_size_t hole_size = hole_data_size - data_size - 2;
+            ns_mem_word_size_t *hole_ptr;
+            // temporary allocations take the bottom of the hole, others the top
+            if (direction > 0) {
+                hole_ptr = block_ptr + 1 + data_size + 1;
+            } else {
+                hole_ptr = block_ptr;
+                block_ptr += 1 + hole_size + 1;
+            }
+            hole_ptr[0] = -hole_size;
+            hole_ptr[1 + hole_size] = -hole_size;
+            ns_mem_bin_add(book, hole_ptr, hole_size);
+        } else {
+            data_size = hole_data_size;
+        }
+        block_ptr[0] = data_size;
+        block_ptr[1 + data_size] = data_size;
+        *data_size_ptr = data_size;
+        return block_ptr;
     }
+#endif
 
     // ns_list_foreach, either forwards or backwards, result to ptr
     for (hole_t *cur_hole = direction > 0 ? ns_list_get_first(&book->holes_list)
@@ -285,12 +433,10 @@ static void *ns_mem_internal_alloc(ns_mem_book_t *book, const ns_mem_block_size_
     }
 
     if (!block_ptr) {
-        goto done;
+        return NULL;
     }
 
-    // Separate declaration from initialization to keep IAR happy as the gotos skip this block.
-    ns_mem_word_size_t block_data_size;
-    block_data_size = -*block_ptr;
+    ns_mem_word_size_t block_data_size = -*block_ptr;
     if (block_data_size >= (data_size + 2 + HOLE_T_SIZE)) {
         ns_mem_word_size_t hole_size = block_data_size - data_size - 2;
         ns_mem_word_size_t *hole_ptr;
@@ -323,8 +469,51 @@ static void *ns_mem_internal_alloc(ns_mem_book_t *book, const ns_mem_block_size_
     }
     block_ptr[0] = data_size;
     block_ptr[1 + data_size] = data_size;
+    *data_size_ptr = data_size;
+    return block_ptr;
+}
+
+#if NS_DYN_MEM_THREAD_CACHE
+static void *ns_mem_cache_alloc(ns_mem_book_t *book, ns_mem_block_size_t alloc_size);
+#endif
+#endif
+
+// For direction, use 1 for direction up and -1 for down
+static void *ns_mem_internal_alloc(ns_mem_book_t *book, const ns_mem_block_size_t alloc_size, int direction)
+{
+#ifndef STANDARD_MALLOC
+    if (!book) {
+        /* We can not do anything except return NULL because we can't find book
+           keeping block */
+        return NULL;
+    }
+
+    if (book->mem_stat_info_ptr && direction == 1) {
+        if (book->mem_stat_info_ptr->heap_sector_allocated_bytes > book->temporary_alloc_heap_limit) {
+            /* Not enough heap for temporary memory allocation */
+            dev_stat_update(book->mem_stat_info_ptr, DEV_HEAP_ALLOC_FAIL, 0);
+            return NULL;
+        }
+    }
+
+#if NS_DYN_MEM_THREAD_CACHE
+    if (direction < 0 && alloc_size > 0 && alloc_size <= NS_MEM_CACHE_MAX_SIZE) {
+        void *block = ns_mem_cache_alloc(book, alloc_size);
+        if (block) {
+            return block;
+        }
+    }
+#endif
+
+    ns_mem_word_size_t *block_ptr = NULL;
+
+    platform_enter_critical();
+
+    ns_mem_word_size_t data_size = convert_allocation_size(book, alloc_size);
+    if (data_size) {
+        block_ptr = ns_mem_heap_take(book, &data_size, direction);
+    }
 
-done:
     if (book->mem_stat_info_ptr) {
         if (block_ptr) {
             //Update Allocate OK
@@ -349,24 +538,99 @@ done:
 #endif
 }
 
+#if NS_DYN_MEM_PROFILE
+// Profile entry of an allocation site, must be called in critical section
+static ns_mem_word_size_t ns_mem_profile_site_index(const void *site)
+{
+    ns_mem_word_size_t index;
+    for (index = 0; index < profile_site_cnt; index++) {
+        if (profile_sites[index].site == site) {
+            return index;
+        }
+    }
+    if (profile_site_cnt < NS_DYN_MEM_PROFILE_SITES - 1) {
+        profile_sites[profile_site_cnt].site = site;
+        return profile_site_cnt++;
+    }
+    // the last entry collects the sites that did not fit
+    profile_site_cnt = NS_DYN_MEM_PROFILE_SITES;
+    return NS_DYN_MEM_PROFILE_SITES - 1;
+}
+
+// The site is recorded in the last word of the block data
+static void ns_mem_profile_alloc(void *block, const void *site)
+{
+    ns_mem_word_size_t *ptr = (ns_mem_word_size_t *)block - 1;
+    ns_mem_word_size_t data_size = *ptr;
+
+    platform_enter_critical();
+    ns_mem_word_size_t index = ns_mem_profile_site_index(site);
+    ns_mem_profile_site_t *entry = &profile_sites[index];
+    ptr[data_size] = index;
+    entry->alloc_cnt++;
+    entry->live_cnt++;
+    entry->live_bytes += (data_size + 2) * sizeof(ns_mem_word_size_t);
+    if (entry->live_bytes_max < entry->live_bytes) {
+        entry->live_bytes_max = entry->live_bytes;
+    }
+    platform_exit_critical();
+}
+
+static void ns_mem_profile_free(ns_mem_book_t *book, void *block)
+{
+    ns_mem_word_size_t *ptr = (ns_mem_word_size_t *)block - 1;
+
+    // invalid blocks are reported when they are freed to the heap
+    if (!book || ptr < book->heap_main || ptr >= book->heap_main_end || *ptr <= 0 ||
+            ptr + *ptr >= book->heap_main_end || ns_mem_block_validate(ptr) != 0) {
+        return;
+    }
+
+    platform_enter_critical();
+    ns_mem_word_size_t index = ptr[*ptr];
+    if (index >= 0 && index < profile_site_cnt) {
+        ns_mem_profile_site_t *entry = &profile_sites[index];
+        entry->live_cnt--;
+        entry->live_bytes -= (*ptr + 2) * sizeof(ns_mem_word_size_t);
+    }
+    platform_exit_critical();
+}
+#endif
+
+// Allocation by the public functions, site is the return address of their caller
+static void *ns_mem_site_alloc(ns_mem_book_t *book, ns_mem_block_size_t alloc_size, int direction, const void *site)
+{
+#if NS_DYN_MEM_PROFILE
+    // one more word at the end of the block for the site
+    void *block = ns_mem_internal_alloc(book, alloc_size ? alloc_size + sizeof(ns_mem_word_size_t) : 0, direction);
+    if (block) {
+        ns_mem_profile_alloc(block, site);
+    }
+    return block;
+#else
+    (void) site;
+    return ns_mem_internal_alloc(book, alloc_size, direction);
+#endif
+}
+
 void *ns_mem_alloc(ns_mem_book_t *heap, ns_mem_block_size_t alloc_size)
 {
-    return ns_mem_internal_alloc(heap, alloc_size, -1);
+    return ns_mem_site_alloc(heap, alloc_size, -1, NS_MEM_CALL_SITE);
 }
 
 void *ns_mem_temporary_alloc(ns_mem_book_t *heap, ns_mem_block_size_t alloc_size)
 {
-    return ns_mem_internal_alloc(heap, alloc_size, 1);
+    return ns_mem_site_alloc(heap, alloc_size, 1, NS_MEM_CALL_SITE);
 }
 
 void *ns_dyn_mem_alloc(ns_mem_block_size_t alloc_size)
 {
-    return ns_mem_alloc(default_book, alloc_size);
+    return ns_mem_site_alloc(default_book, alloc_size, -1, NS_MEM_CALL_SITE);
 }
 
 void *ns_dyn_mem_temporary_alloc(ns_mem_block_size_t alloc_size)
 {
-    return ns_mem_temporary_alloc(default_book, alloc_size);
+    return ns_mem_site_alloc(default_book, alloc_size, 1, NS_MEM_CALL_SITE);
 }
 
 #ifndef STANDARD_MALLOC
@@ -397,6 +661,11 @@ static void ns_mem_free_and_merge_with_adjacent_blocks(ns_mem_book_t *book, ns_m
             }
             if (block_size >= 1 + HOLE_T_SIZE + 1) {
                 existing_start = hole_from_block_start(start);
+#if NS_DYN_MEM_SEGREGATED_FIT
+                if (book->segregated_fit) {
+                    ns_mem_bin_remove(book, start, block_size - 2);
+                }
+#endif
             }
         }
     }
@@ -412,10 +681,27 @@ static void ns_mem_free_and_merge_with_adjacent_blocks(ns_mem_book_t *book, ns_m
             }
             if (block_size >= 1 + HOLE_T_SIZE + 1) {
                 existing_end = hole_from_block_start(block_start);
+#if NS_DYN_MEM_SEGREGATED_FIT
+                if (book->segregated_fit) {
+                    ns_mem_bin_remove(book, block_start, block_size - 2);
+                }
+#endif
             }
         }
     }
 
+#if NS_DYN_MEM_SEGREGATED_FIT
+    if (book->segregated_fit) {
+        // merged hole goes to the bin of its new size, whichever descriptors it replaces
+        *start = -merged_data_size;
+        *end = -merged_data_size;
+        if (merged_data_size >= HOLE_T_SIZE) {
+            ns_mem_bin_add(book, start, merged_data_size);
+        }
+        return;
+    }
+#endif
+
     hole_t *to_add = hole_from_block_start(start);
     hole_t *before = NULL;
     if (existing_end) {
@@ -457,18 +743,13 @@ static void ns_mem_free_and_merge_with_adjacent_blocks(ns_mem_book_t *book, ns_m
 }
 #endif
 
-void ns_mem_free(ns_mem_book_t *book, void *block)
-{
 #ifndef STANDARD_MALLOC
-
-    if (!block) {
-        return;
-    }
-
+// Returns a block to the heap, must be called in critical section
+static void ns_mem_locked_free(ns_mem_book_t *book, void *block)
+{
     ns_mem_word_size_t *ptr = block;
     ns_mem_word_size_t size;
 
-    platform_enter_critical();
     ptr --;
     //Read Current Size
     size = *ptr;
@@ -489,6 +770,187 @@ void ns_mem_free(ns_mem_book_t *book, void *block)
             }
         }
     }
+}
+
+#if NS_DYN_MEM_THREAD_CACHE
+/* Each thread keeps a magazine of free blocks for each size class, so that the
+ * common small allocations and frees do not enter the critical section. Cached
+ * blocks stay allocated in the heap. A magazine is refilled and emptied half
+ * way at a time, so that alternating allocations and frees at its limits do not
+ * go to the heap each time.
+ */
+typedef struct {
+    ns_mem_book_t *book;                /* heap of the cached blocks */
+    uint32_t book_id;                   /* ns_mem_init() of that heap */
+    bool registered;                    /* flushed at thread exit */
+    uint8_t count[NS_MEM_CACHE_CLASSES];
+    void *blocks[NS_MEM_CACHE_CLASSES][NS_DYN_MEM_THREAD_CACHE_DEPTH];
+} ns_mem_cache_t;
+
+static __thread ns_mem_cache_t ns_mem_cache;
+static pthread_once_t ns_mem_cache_once = PTHREAD_ONCE_INIT;
+static pthread_key_t ns_mem_cache_key;
+
+// Size class of a block of up to NS_MEM_CACHE_MAX_SIZE bytes
+static unsigned ns_mem_cache_class(ns_mem_block_size_t size)
+{
+    unsigned cache_class = 0;
+    while (((ns_mem_block_size_t) NS_MEM_CACHE_MIN_SIZE << cache_class) < size) {
+        cache_class++;
+    }
+    return cache_class;
+}
+
+static void ns_mem_cache_flush(ns_mem_cache_t *cache)
+{
+    // blocks of a heap that has been initialised again are gone with it
+    bool valid = cache->book && cache->book->id == cache->book_id;
+
+    if (valid) {
+        platform_enter_critical();
+    }
+    for (unsigned cache_class = 0; cache_class < NS_MEM_CACHE_CLASSES; cache_class++) {
+        while (cache->count[cache_class]) {
+            void *block = cache->blocks[cache_class][--cache->count[cache_class]];
+            if (valid) {
+                ns_mem_locked_free(cache->book, block);
+            }
+        }
+    }
+    if (valid) {
+        platform_exit_critical();
+    }
+}
+
+static void ns_mem_cache_thread_exit(void *cache)
+{
+    ns_mem_cache_flush(cache);
+}
+
+static void ns_mem_cache_key_create(void)
+{
+    pthread_key_create(&ns_mem_cache_key, ns_mem_cache_thread_exit);
+}
+
+// Cache of the calling thread for the heap, NULL if it can not be used
+static ns_mem_cache_t *ns_mem_cache_get(ns_mem_book_t *book)
+{
+    ns_mem_cache_t *cache = &ns_mem_cache;
+
+    if (cache->book != book || cache->book_id != book->id) {
+        ns_mem_cache_flush(cache);
+        if (!cache->registered) {
+            // without the destructor the blocks would be lost with the thread
+            pthread_once(&ns_mem_cache_once, ns_mem_cache_key_create);
+            if (pthread_setspecific(ns_mem_cache_key, cache) != 0) {
+                return NULL;
+            }
+            cache->registered = true;
+        }
+        cache->book = book;
+        cache->book_id = book->id;
+    }
+    return cache;
+}
+
+// Takes half a magazine of blocks from the heap in one critical section
+static bool ns_mem_cache_refill(ns_mem_cache_t *cache, unsigned cache_class)
+{
+    ns_mem_book_t *book = cache->book;
+
+    platform_enter_critical();
+    while (cache->count[cache_class] < NS_DYN_MEM_THREAD_CACHE_DEPTH / 2) {
+        ns_mem_word_size_t data_size = convert_allocation_size(book, NS_MEM_CACHE_MIN_SIZE << cache_class);
+        ns_mem_word_size_t *block_ptr = ns_mem_heap_take(book, &data_size, -1);
+        if (!block_ptr) {
+            break;
+        }
+        dev_stat_update(book->mem_stat_info_ptr, DEV_HEAP_ALLOC_OK, (data_size + 2) * sizeof(ns_mem_word_size_t));
+        cache->blocks[cache_class][cache->count[cache_class]++] = block_ptr + 1;
+    }
+    platform_exit_critical();
+
+    return cache->count[cache_class] != 0;
+}
+
+// Returns NULL if the allocation must be made from the heap
+static void *ns_mem_cache_alloc(ns_mem_book_t *book, ns_mem_block_size_t alloc_size)
+{
+    ns_mem_cache_t *cache = ns_mem_cache_get(book);
+    if (!cache) {
+        return NULL;
+    }
+
+    unsigned cache_class = ns_mem_cache_class(alloc_size);
+    if (!cache->count[cache_class] && !ns_mem_cache_refill(cache, cache_class)) {
+        // heap is full, give back what this thread holds in other classes
+        ns_mem_cache_flush(cache);
+        return NULL;
+    }
+    return cache->blocks[cache_class][--cache->count[cache_class]];
+}
+
+// Returns false if the block must be freed to the heap
+static bool ns_mem_cache_free(ns_mem_book_t *book, void *block)
+{
+    ns_mem_word_size_t *ptr = (ns_mem_word_size_t *)block - 1;
+
+    // only blocks of exactly a class size, anything else is checked by the heap
+    if (ptr < book->heap_main || ptr >= book->heap_main_end || *ptr <= 0 ||
+            ptr + *ptr >= book->heap_main_end || ns_mem_block_validate(ptr) != 0) {
+        return false;
+    }
+    ns_mem_block_size_t size = *ptr * sizeof(ns_mem_word_size_t);
+    if (size < NS_MEM_CACHE_MIN_SIZE || size > NS_MEM_CACHE_MAX_SIZE || (size & (size - 1))) {
+        return false;
+    }
+
+    ns_mem_cache_t *cache = ns_mem_cache_get(book);
+    if (!cache) {
+        return false;
+    }
+
+    unsigned cache_class = ns_mem_cache_class(size);
+    for (unsigned i = 0; i < cache->count[cache_class]; i++) {
+        if (cache->blocks[cache_class][i] == block) {
+            heap_failure(book, NS_DYN_MEM_DOUBLE_FREE);
+            return true;
+        }
+    }
+
+    if (cache->count[cache_class] == NS_DYN_MEM_THREAD_CACHE_DEPTH) {
+        platform_enter_critical();
+        while (cache->count[cache_class] > NS_DYN_MEM_THREAD_CACHE_DEPTH / 2) {
+            ns_mem_locked_free(book, cache->blocks[cache_class][--cache->count[cache_class]]);
+        }
+        platform_exit_critical();
+    }
+    cache->blocks[cache_class][cache->count[cache_class]++] = block;
+    return true;
+}
+#endif // NS_DYN_MEM_THREAD_CACHE
+#endif
+
+void ns_mem_free(ns_mem_book_t *book, void *block)
+{
+#ifndef STANDARD_MALLOC
+
+    if (!block) {
+        return;
+    }
+
+#if NS_DYN_MEM_PROFILE
+    ns_mem_profile_free(book, block);
+#endif
+
+#if NS_DYN_MEM_THREAD_CACHE
+    if (ns_mem_cache_free(book, block)) {
+        return;
+    }
+#endif
+
+    platform_enter_critical();
+    ns_mem_locked_free(book, block);
     platform_exit_critical();
 #else
     platform_enter_critical();
@@ -501,3 +963,136 @@ void ns_dyn_mem_free(void *block)
 {
     ns_mem_free(default_book, block);
 }
+
+int ns_mem_set_segregated_fit(ns_mem_book_t *book, bool enable)
+{
+#if !defined(STANDARD_MALLOC) && NS_DYN_MEM_SEGREGATED_FIT
+    if (!book) {
+        return -1;
+    }
+
+    platform_enter_critical();
+    if (book->segregated_fit != enable) {
+        book->segregated_fit = enable;
+        ns_mem_rebuild_holes(book);
+    }
+    platform_exit_critical();
+
+    return 0;
+#else
+    (void) book;
+    (void) enable;
+    return -3;
+#endif
+}
+
+int ns_dyn_mem_set_segregated_fit(bool enable)
+{
+    return ns_mem_set_segregated_fit(default_book, enable);
+}
+
+void ns_dyn_mem_flush_thread_cache(void)
+{
+#if !defined(STANDARD_MALLOC) && NS_DYN_MEM_THREAD_CACHE
+    ns_mem_cache_flush(&ns_mem_cache);
+#endif
+}
+
+int ns_mem_get_fragmentation(ns_mem_book_t *book, ns_mem_heap_size_t *largest_free, ns_mem_heap_size_t *total_free)
+{
+#ifndef STANDARD_MALLOC
+    ns_mem_heap_size_t largest = 0;
+    ns_mem_heap_size_t total = 0;
+    int ret_val = 0;
+
+    if (!book || !book->heap_main) {
+        return -1;
+    }
+
+    platform_enter_critical();
+    for (ns_mem_word_size_t *ptr = book->heap_main; ptr < book->heap_main_end; ptr += 2 + abs(*ptr)) {
+        if (ns_mem_block_validate(ptr) != 0) {
+            heap_failure(book, NS_DYN_MEM_HEAP_SECTOR_CORRUPTED);
+            ret_val = -1;
+            break;
+        }
+        if (*ptr < 0) {
+            ns_mem_heap_size_t size = -*ptr * sizeof(ns_mem_word_size_t);
+            total += size;
+            if (largest < size) {
+                largest = size;
+            }
+        }
+    }
+    platform_exit_critical();
+
+    if (largest_free) {
+        *largest_free = largest;
+    }
+    if (total_free) {
+        *total_free = total;
+    }
+    if (ret_val == 0 && total) {
+        ret_val = 100 - (int)((uint64_t)largest * 100 / total);
+    }
+    return ret_val;
+#else
+    (void) book;
+    (void) largest_free;
+    (void) total_free;
+    return -3;
+#endif
+}
+
+int ns_dyn_mem_get_fragmentation(ns_mem_heap_size_t *largest_free, ns_mem_heap_size_t *total_free)
+{
+    return ns_mem_get_fragmentation(default_book, largest_free, total_free);
+}
+
+uint16_t ns_dyn_mem_profile_get(ns_mem_profile_site_t *sites, uint16_t max_sites)
+{
+    uint16_t count = 0;
+#if NS_DYN_MEM_PROFILE
+    platform_enter_critical();
+    while (count < max_sites && count < profile_site_cnt) {
+        sites[count] = profile_sites[count];
+        count++;
+    }
+    platform_exit_critical();
+#else
+    (void) sites;
+    (void) max_sites;
+#endif
+    return count;
+}
+
+void ns_dyn_mem_profile_trace(void)
+{
+#if NS_DYN_MEM_PROFILE
+    ns_mem_heap_size_t largest_free;
+    ns_mem_heap_size_t total_free;
+    int fragmentation = ns_dyn_mem_get_fragmentation(&largest_free, &total_free);
+    if (fragmentation >= 0) {
+        tr_info("heap free %lu bytes, largest block %lu bytes, fragmentation %d%%",
+                (unsigned long)total_free, (unsigned long)largest_free, fragmentation);
+    }
+
+    // one site at a time, tracing is not done in the critical section
+    for (uint16_t index = 0; index < NS_DYN_MEM_PROFILE_SITES; index++) {
+        ns_mem_profile_site_t site;
+        platform_enter_critical();
+        bool valid = index < profile_site_cnt;
+        if (valid) {
+            site = profile_sites[index];
+        }
+        platform_exit_critical();
+        if (!valid) {
+            break;
+        }
+        tr_info("site %p: %lu bytes in %lu blocks, max %lu bytes, %lu allocations",
+                site.site, (unsigned long)site.live_bytes, (unsigned long)site.live_cnt,
+                (unsigned long)site.live_bytes_max, (unsigned long)site.alloc_cnt);
+        (void) site;
+    }
+#endif
+}
@@ -33,8 +33,9 @@
 #define NS_NVM_KEY_WRITE    0x04
 #define NS_NVM_FLUSH        0x05
 #define NS_NVM_KEY_DELETE   0x06
+#define NS_NVM_KEY_READ_DONE 0x07 /* read answered from a queued write */
 
-typedef struct {
+typedef struct ns_nvm_request {
     ns_nvm_callback *callback;
     const char *client_key_name;
     void *client_context;
@@ -42,6 +43,7 @@ typedef struct {
     uint8_t *buffer;
     uint16_t *buffer_len;
     void *original_request;
+    struct ns_nvm_request *coalesced; /* earlier queued write to the same key, replaced by this one */
     ns_list_link_t link;
 } ns_nvm_request_t;
 
@@ -52,9 +54,16 @@ static ns_nvm_request_t *ns_nvm_create_request(ns_nvm_callback *callback, void *
 static int ns_nvm_operation_start(ns_nvm_request_t *request);
 static int ns_nvm_operation_continue(ns_nvm_request_t *request, bool free_request);
 static void ns_nvm_operation_end(ns_nvm_request_t *ns_nvm_request_ptr, int client_retval);
+static void ns_nvm_flush_end(ns_nvm_request_t *ns_nvm_request_ptr, int client_retval);
+static void ns_nvm_request_complete(ns_nvm_request_t *request, int client_retval);
+static void ns_nvm_process_pending(void);
+static ns_nvm_request_t *ns_nvm_find_queued(const char *key_name);
 
 static NS_LIST_DEFINE(ns_nvm_request_list, ns_nvm_request_t, link);
 
+/* Written and deleted keys waiting for the flush, which is done once for a batch of queued writes */
+static NS_LIST_DEFINE(ns_nvm_flush_list, ns_nvm_request_t, link);
+
 /*
  * Callback from platform NVM adaptation
  */
@@ -75,6 +84,8 @@ void ns_nvm_callback_func(platform_nvm_status status, void *args)
             ns_dyn_mem_free(ns_nvm_request_ptr);
             break;
         case NS_NVM_FLUSH:
+            ns_nvm_flush_end(ns_nvm_request_ptr, client_retval);
+            break;
         case NS_NVM_KEY_READ:
             ns_nvm_operation_end(ns_nvm_request_ptr, client_retval);
             break;
@@ -89,9 +100,9 @@ void ns_nvm_callback_func(platform_nvm_status status, void *args)
         case NS_NVM_KEY_DELETE:
         case NS_NVM_KEY_WRITE:
             if (status == PLATFORM_NVM_OK) {
-                // write ok, flush the changes
-                ns_nvm_request_ptr->operation = NS_NVM_FLUSH;
-                platform_nvm_flush(ns_nvm_callback_func, ns_nvm_request_ptr);
+                // write ok, flush the changes together with the writes queued after this one
+                ns_list_add_to_end(&ns_nvm_flush_list, ns_nvm_request_ptr);
+                ns_nvm_process_pending();
             } else {
                 // write failed, inform client
                 ns_nvm_operation_end(ns_nvm_request_ptr, client_retval);
@@ -115,6 +126,16 @@ int ns_nvm_data_read(ns_nvm_callback *callback, const char *key_name, uint8_t *b
         return NS_NVM_ERROR;
     }
     ns_nvm_request_t *ns_nvm_request_ptr = ns_nvm_create_request(callback, context, key_name, buf, buf_len, NS_NVM_KEY_READ);
+    ns_nvm_request_t *queued_req = ns_nvm_find_queued(key_name);
+    if (ns_nvm_request_ptr && queued_req && queued_req->operation == NS_NVM_KEY_WRITE && *queued_req->buffer_len <= *buf_len) {
+        // The key is about to be written, answer from the queued data. The callback is
+        // still called from the queue, after the requests issued before this one.
+        memcpy(buf, queued_req->buffer, *queued_req->buffer_len);
+        *buf_len = *queued_req->buffer_len;
+        ns_nvm_request_ptr->operation = NS_NVM_KEY_READ_DONE;
+        ns_list_add_to_end(&ns_nvm_request_list, ns_nvm_request_ptr);
+        return NS_NVM_OK;
+    }
     return ns_nvm_operation_start(ns_nvm_request_ptr);
 }
 
@@ -124,6 +145,13 @@ int ns_nvm_data_write(ns_nvm_callback *callback, const char *key_name, uint8_t *
         return NS_NVM_ERROR;
     }
     ns_nvm_request_t *ns_nvm_request_ptr = ns_nvm_create_request(callback, context, key_name, buf, buf_len, NS_NVM_KEY_WRITE);
+    ns_nvm_request_t *queued_req = ns_nvm_find_queued(key_name);
+    if (ns_nvm_request_ptr && queued_req && queued_req->operation == NS_NVM_KEY_WRITE) {
+        // The earlier write has not started, write this data in its place and complete both
+        ns_nvm_request_ptr->coalesced = queued_req;
+        ns_list_replace(&ns_nvm_request_list, queued_req, ns_nvm_request_ptr);
+        return NS_NVM_OK;
+    }
     return ns_nvm_operation_start(ns_nvm_request_ptr);
 }
 
@@ -176,6 +204,7 @@ static ns_nvm_request_t *ns_nvm_create_request(ns_nvm_callback *callback, void *
     ns_nvm_request_ptr->operation = operation;
     ns_nvm_request_ptr->buffer = buf;
     ns_nvm_request_ptr->buffer_len = buf_len;
+    ns_nvm_request_ptr->coalesced = NULL;
 
     return ns_nvm_request_ptr;
 }
@@ -212,18 +241,88 @@ static int ns_nvm_operation_continue(ns_nvm_request_t *request, bool free_reques
 
 static void ns_nvm_operation_end(ns_nvm_request_t *ns_nvm_request_ptr, int client_retval)
 {
-    ns_nvm_request_ptr->callback(client_retval, ns_nvm_request_ptr->client_context);
-    ns_dyn_mem_free(ns_nvm_request_ptr);
-    ns_nvm_operation_in_progress = false;
+    ns_nvm_request_complete(ns_nvm_request_ptr, client_retval);
+    ns_nvm_process_pending();
+}
 
-    ns_list_foreach_safe(ns_nvm_request_t, pending_req, &ns_nvm_request_list) {
-        // there are pending requests to be processed
-        ns_list_remove(&ns_nvm_request_list, pending_req);
-        int ret = ns_nvm_operation_continue(pending_req, false);
-        if (ret != NS_NVM_OK) {
-            ns_nvm_operation_end(pending_req, ret);
-        } else {
+static void ns_nvm_flush_end(ns_nvm_request_t *ns_nvm_request_ptr, int client_retval)
+{
+    ns_nvm_request_t *flushed_req;
+
+    while ((flushed_req = ns_list_get_first(&ns_nvm_flush_list)) != NULL) {
+        ns_list_remove(&ns_nvm_flush_list, flushed_req);
+        ns_nvm_request_complete(flushed_req, client_retval);
+    }
+    ns_nvm_operation_end(ns_nvm_request_ptr, client_retval);
+}
+
+static void ns_nvm_request_complete(ns_nvm_request_t *request, int client_retval)
+{
+    ns_nvm_request_t *previous = NULL;
+    ns_nvm_request_t *next;
+
+    // reverse the chain of coalesced writes so that the callbacks are called in the order of the calls
+    while (request) {
+        next = request->coalesced;
+        request->coalesced = previous;
+        previous = request;
+        request = next;
+    }
+    while (previous) {
+        next = previous->coalesced;
+        previous->callback(client_retval, previous->client_context);
+        ns_dyn_mem_free(previous);
+        previous = next;
+    }
+}
+
+static void ns_nvm_process_pending(void)
+{
+    ns_nvm_request_t *pending_req;
+
+    // callbacks called from here queue their requests instead of starting them
+    ns_nvm_operation_in_progress = true;
+
+    while ((pending_req = ns_list_get_first(&ns_nvm_request_list)) != NULL) {
+        if (pending_req->operation == NS_NVM_KEY_READ_DONE) {
+            ns_list_remove(&ns_nvm_request_list, pending_req);
+            ns_nvm_request_complete(pending_req, NS_NVM_OK);
+            continue;
+        }
+        if (!ns_list_is_empty(&ns_nvm_flush_list) &&
+                pending_req->operation != NS_NVM_KEY_WRITE && pending_req->operation != NS_NVM_KEY_DELETE) {
+            // the batch of writes ends here, flush it before this request
             break;
         }
+        ns_list_remove(&ns_nvm_request_list, pending_req);
+        if (ns_nvm_operation_continue(pending_req, false) == NS_NVM_OK) {
+            return;
+        }
+        ns_nvm_operation_in_progress = true;
+        ns_nvm_request_complete(pending_req, NS_NVM_ERROR);
+    }
+
+    pending_req = ns_list_get_last(&ns_nvm_flush_list);
+    if (pending_req) {
+        // one flush for the whole batch, the last write carries it
+        ns_list_remove(&ns_nvm_flush_list, pending_req);
+        pending_req->operation = NS_NVM_FLUSH;
+        if (platform_nvm_flush(ns_nvm_callback_func, pending_req) != PLATFORM_NVM_OK) {
+            ns_nvm_flush_end(pending_req, NS_NVM_ERROR);
+        }
+        return;
+    }
+
+    ns_nvm_operation_in_progress = false;
+}
+
+static ns_nvm_request_t *ns_nvm_find_queued(const char *key_name)
+{
+    // the latest request to the key which has not started yet, reads already answered do not count
+    ns_list_foreach_reverse(ns_nvm_request_t, pending_req, &ns_nvm_request_list) {
+        if (pending_req->operation != NS_NVM_KEY_READ_DONE && strcmp(pending_req->client_key_name, key_name) == 0) {
+            return pending_req;
+        }
     }
+    return NULL;
 }
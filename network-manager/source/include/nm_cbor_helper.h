@@ -39,7 +39,6 @@ extern "C" {
 #define CH_NOISE_TABLE_MAX_ENCODING_BUFF(ch_noise_table_length) ((ch_noise_table_length*2)+CH_NOISE_TABLE_CBOR_OVERHEAD)
 
 #define ROUTING_TABLE_CBOR_OVERHEAD                 30
-#define ROUTING_TABLE_MAX_ENCODING_BUFF(table_length) (table_length+ROUTING_TABLE_CBOR_OVERHEAD)
 
 #define ONE_TIME_CBOR_DATA_SIZE_FOR_DEVICE_COUNT        23
 #define NEIGHBOR_INFO_CBOR_DATA_SIZE_PER_DEVICE         65
@@ -48,7 +47,8 @@ extern "C" {
 nm_status_t nm_cbor_config_struct_update(void *st_cfg, uint8_t *cbor_data, config_type_t type, size_t len);
 nm_status_t nm_config_to_cbor(void *st_cfg, uint8_t *cbor_data, config_type_t type, size_t *len);
 nm_status_t nm_statistics_to_cbor(void *stats, uint8_t *cbor_data, config_type_t type, size_t *len);
-nm_status_t nm_routing_table_to_cbor(uint8_t *routing_table, size_t routing_table_length, uint8_t *cbor_data, size_t *len);
+/* Encodes the routing table map up to the head of its byte string, at most ROUTING_TABLE_CBOR_OVERHEAD bytes */
+nm_status_t nm_routing_table_header_to_cbor(size_t routing_table_length, uint8_t *cbor_header, size_t *len);
 nm_status_t nm_ch_noise_statistics_to_cbor(int8_t *table, uint8_t index, uint8_t *cbor_data, size_t *len);
 
 #ifdef __cplusplus
@@ -39,6 +39,7 @@ nm_status_t nm_factory_configure_border_router(void);
 nm_status_t nm_configure_border_router(void);
 nm_status_t nm_res_set_br_config(uint8_t *data, size_t length);
 nm_status_t nm_res_get_br_stats(uint8_t **datap, size_t *length);
+/* The routing table buffer is owned by the interface manager and reused by the next call, it must not be freed */
 nm_status_t nm_res_get_routing_table(uint8_t **datap, size_t *length);
 void apply_br_config_after_delay(uint16_t delay);
 void apply_br_config_to_nannostack(void);
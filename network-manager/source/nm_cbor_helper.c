@@ -16,8 +16,10 @@
 
 #if defined MBED_CONF_MBED_CLOUD_CLIENT_NETWORK_MANAGER && (MBED_CONF_MBED_CLOUD_CLIENT_NETWORK_MANAGER == 1)
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include "tinycbor.h"
 #include "NetworkManager_internal.h"
 #include "nm_cbor_helper.h"
@@ -143,135 +145,136 @@
 #define CBOR_TAG_NBR_TYPE                           "type"
 
 
-static bool get_string_value_from_stream(CborValue *main_value, const char *str_name, CborValue *map_value, char **temp_buffer)
+/* Longest tag of a configuration field, longer keys are unknown */
+#define CBOR_CONFIG_TAG_MAX_LEN                     32
+
+typedef enum {
+    CBOR_FIELD_UINT,            // unsigned integer, to a member of 1, 2 or 4 bytes
+    CBOR_FIELD_TEXT,            // text string, to a char array with room for the terminator
+    CBOR_FIELD_UINT32_ARRAY,    // array of unsigned integers, to a uint32_t array
+    CBOR_FIELD_CUSTOM           // decoded by the decode function of the field
+} cbor_field_type_t;
+
+/* Maps a configuration tag to the structure member the value is decoded to */
+typedef struct {
+    const char *tag;
+    cbor_field_type_t type;
+    uint16_t offset;
+    uint16_t size;
+    bool (*decode)(const CborValue *value, void *st_cfg);
+} cbor_config_field_t;
+
+#define CBOR_CONFIG_FIELD(tag, type, st, member) \
+    { tag, type, offsetof(st, member), sizeof(((st *)0)->member), NULL }
+#define CBOR_CONFIG_CUSTOM_FIELD(tag, decode) \
+    { tag, CBOR_FIELD_CUSTOM, 0, 0, decode }
+
+static bool decode_uint_field(const CborValue *value, void *member, uint16_t size)
 {
-    CborValue element;
-    size_t temp_buffer_size = 0;
+    uint64_t read_val = 0;
 
-    if (cbor_value_map_find_value(main_value, str_name, map_value) != CborNoError) {
-        tr_debug("Finding string in map fail");
-        return false;
-    }
-    if (cbor_value_is_text_string(map_value) != true) {
-        tr_debug("Value is not string");
+    if (cbor_value_is_unsigned_integer(value) != true) {
+        tr_debug("Value is not integer ");
         return false;
     }
-    if (cbor_value_calculate_string_length(map_value, &temp_buffer_size) != CborNoError) {
-        tr_debug("String length fail");
+    if (cbor_value_get_uint64(value, &read_val) != CborNoError) {
+        tr_debug("Get unsigned integer fail");
         return false;
     }
-    tr_debug("Length of string is %d", temp_buffer_size);
-    if (cbor_value_dup_text_string(map_value, temp_buffer, &temp_buffer_size, &element) != CborNoError && temp_buffer == NULL) {
-        tr_debug("Get string fail");
-        return false;
+
+    switch (size) {
+        case sizeof(uint8_t):
+            *(uint8_t *)member = (uint8_t)read_val;
+            break;
+        case sizeof(uint16_t):
+            *(uint16_t *)member = (uint16_t)read_val;
+            break;
+        case sizeof(uint32_t):
+            *(uint32_t *)member = (uint32_t)read_val;
+            break;
+        default:
+            tr_err("Unsupported integer size %d", size);
+            return false;
     }
     return true;
 }
 
-static bool get_uint32_value_from_stream(CborValue *main_value, const char *str_name, CborValue *map_value, uint32_t *uint_value)
+static bool decode_text_field(const CborValue *value, char *member, uint16_t size)
 {
-    uint64_t read_val = 0;
-    if (cbor_value_map_find_value(main_value, str_name, map_value) != CborNoError) {
-        tr_debug("Find unsigned integer in map fail");
-        return false;
-    }
-    if (cbor_value_is_unsigned_integer(map_value) != true) {
-        tr_debug("Value is not integer ");
+    char temp_buffer[64];
+    size_t temp_buffer_size = sizeof(temp_buffer);
+
+    if (cbor_value_is_text_string(value) != true) {
+        tr_debug("Value is not string");
         return false;
     }
-    if (cbor_value_get_uint64(map_value, &read_val) != CborNoError) {
-        tr_debug("Get unsigned integer fail");
+    // Copy through a buffer so that a string too long for the member leaves it as it is
+    if (size > sizeof(temp_buffer) || cbor_value_copy_text_string(value, temp_buffer, &temp_buffer_size, NULL) != CborNoError ||
+            temp_buffer_size >= size) {
+        tr_debug("Get string fail");
         return false;
     }
-    *uint_value = (uint32_t)read_val;
+    memcpy(member, temp_buffer, temp_buffer_size + 1);
     return true;
 }
 
-static bool get_int_array_from_stream(CborValue *main_value, const char *str_name, CborValue *map_value, uint32_t *int_array, size_t *array_len)
+static bool decode_uint32_array_field(const CborValue *value, uint32_t *member, uint16_t size)
 {
     CborValue array_value;
     size_t array_index = 0;
     uint64_t int_value = 0;
 
-    if (int_array == NULL) {
-        tr_err("array pointer NULL");
-        return false;
-    }
-
-    if (cbor_value_map_find_value(main_value, str_name, map_value) != CborNoError) {
-        tr_debug("Find integer array in map fail");
-        return false;
-    }
-
-    if (cbor_value_get_type(map_value) != CborArrayType) {
+    if (cbor_value_get_type(value) != CborArrayType) {
         tr_debug("Value is not integer array");
         return false;
     }
 
-    if (cbor_value_enter_container(map_value, &array_value) !=  CborNoError) {
+    if (cbor_value_enter_container(value, &array_value) !=  CborNoError) {
         tr_debug("Couldn't enter to the Array map");
         return false;
     }
 
     while (!cbor_value_at_end(&array_value)) {
+        if (array_index == size / sizeof(uint32_t)) {
+            tr_debug("Integer array too long");
+            return false;
+        }
         if (cbor_value_get_uint64(&array_value, &int_value) != CborNoError) {
             tr_debug("Get integer fail");
             return false;
         }
-        int_array[array_index++] = (uint32_t)int_value;
+        member[array_index++] = (uint32_t)int_value;
         cbor_value_advance_fixed(&array_value);
     }
-    *array_len = array_index;
+    tr_debug("Received integer array length: %d", array_index);
     return true;
 }
 
-static bool get_byte_value_from_stream(CborValue *main_value, const char *str_name, CborValue *map_value, uint8_t **temp_buffer, size_t *temp_buffer_size)
+static bool decode_config_field(const cbor_config_field_t *field, const CborValue *value, void *st_cfg)
 {
-    CborValue element;
-
-    if (cbor_value_map_find_value(main_value, str_name, map_value) != CborNoError) {
-        tr_debug("Finding byte string in map fail");
-        return false;
-    }
-    if (cbor_value_is_byte_string(map_value) != true) {
-        tr_debug("Value is not byte string");
-        return false;
-    }
-    if (cbor_value_calculate_string_length(map_value, temp_buffer_size) != CborNoError) {
-        tr_debug("Byte string length fail");
-        return false;
-    }
-    if (cbor_value_dup_byte_string(map_value, temp_buffer, temp_buffer_size, &element) != CborNoError) {
-        tr_debug("Get byte string fail");
-        return false;
-    }
-
-    return true;
-}
-
-static nm_status_t update_app_config(void *st_app, uint8_t *cbor_data, size_t len)
-{
-    /* this is a place holder for application configuration to update ,as this configuration yet to decide */
-    return NM_STATUS_SUCCESS;
-}
-
-static nm_status_t update_bb_config(void *st_app, uint8_t *cbor_data, size_t len)
-{
-    /* this is a place holder for backhaul configuration to update ,as this configuration yet to decide */
-    return NM_STATUS_SUCCESS;
+    void *member = (uint8_t *)st_cfg + field->offset;
+
+    switch (field->type) {
+        case CBOR_FIELD_UINT:
+            return decode_uint_field(value, member, field->size);
+        case CBOR_FIELD_TEXT:
+            return decode_text_field(value, (char *)member, field->size);
+        case CBOR_FIELD_UINT32_ARRAY:
+            return decode_uint32_array_field(value, (uint32_t *)member, field->size);
+        case CBOR_FIELD_CUSTOM:
+            return field->decode(value, st_cfg);
+    }
+    return false;
 }
 
-static nm_status_t update_ws_config(void *st_app, uint8_t *cbor_data, size_t len)
+/* Decodes a configuration map in one pass, each key is looked up in the field table */
+static nm_status_t decode_config_map(const uint8_t *cbor_data, size_t len, const cbor_config_field_t *fields, size_t field_count, void *st_cfg)
 {
-    /* Following structure is as per current parameters defined in code that may be going to modify, add or remove. */
     CborParser parser;
     CborValue main_value;
+    CborValue key_value;
     CborValue map_value;
-
-    size_t array_length = 0;
-    uint32_t int_value = 0;
-    char *temp_buffer = NULL;
-    nm_ws_config_t *ws_cfg = (nm_ws_config_t *)st_app;
+    char key[CBOR_CONFIG_TAG_MAX_LEN + 1];
 
     if (cbor_parser_init(cbor_data, len, 0, &parser, &main_value) != CborNoError) {
         tr_debug("CborParser init fail");
@@ -281,104 +284,94 @@ static nm_status_t update_ws_config(void *st_app, uint8_t *cbor_data, size_t len
         tr_debug("Cbor main_value map fail");
         return NM_STATUS_FAIL;
     }
-
-    // Finding network_name
-    if (get_string_value_from_stream(&main_value, CBOR_TAG_NW_NAME, &map_value, &temp_buffer) == true) {
-        strcpy(ws_cfg->network_name, temp_buffer);
-    }
-    if (temp_buffer != NULL) {
-        free(temp_buffer);
-        temp_buffer = NULL;
-    }
-
-    // Finding channel_mask
-    if (get_int_array_from_stream(&main_value, CBOR_TAG_CH_MASK, &map_value, ws_cfg->channel_mask, &array_length) == true) {
-        tr_debug("Received Channel Mask Array length: %d", array_length);
-    }
-
-    // Finding Regulatory_domain
-    if (get_uint32_value_from_stream(&main_value, CBOR_TAG_REG_DOMAIN, &map_value, &int_value) == true) {
-        ws_cfg->reg_op.regulatory_domain = (uint8_t)int_value;
-    }
-
-    // Finding operating_class
-    if (get_uint32_value_from_stream(&main_value, CBOR_TAG_OP_CLASS, &map_value, &int_value) == true) {
-        ws_cfg->reg_op.operating_class = (uint8_t)int_value;
-    }
-
-    // Finding operating_mode
-    if (get_uint32_value_from_stream(&main_value, CBOR_TAG_OP_MODE, &map_value, &int_value) == true) {
-        ws_cfg->reg_op.operating_mode = (uint8_t)int_value;
-    }
-
-    // Finding network_size
-    if (get_uint32_value_from_stream(&main_value, CBOR_TAG_NW_SIZE, &map_value, &int_value) == true) {
-        ws_cfg->network_size = (uint8_t)int_value;
-    }
-
-    // Finding uc_channel_function
-    if (get_uint32_value_from_stream(&main_value, CBOR_TAG_UC_FUNC, &map_value, &int_value) == true) {
-        ws_cfg->uc_ch_config.uc_channel_function = (mesh_channel_function_t)int_value;
-    }
-
-    // Finding uc_fixed_channel
-    if (get_uint32_value_from_stream(&main_value, CBOR_TAG_UC_FIX, &map_value, &int_value) == true) {
-        ws_cfg->uc_ch_config.uc_fixed_channel = (uint16_t)int_value;
-    }
-
-    // Finding uc_dwell_interval
-    if (get_uint32_value_from_stream(&main_value, CBOR_TAG_UC_DWELL, &map_value, &int_value) == true) {
-        ws_cfg->uc_ch_config.uc_dwell_interval = (uint8_t)int_value;
-    }
-
-    // Finding bc_channel_function
-    if (get_uint32_value_from_stream(&main_value, CBOR_TAG_BC_FUNC, &map_value, &int_value) == true) {
-        ws_cfg->bc_ch_config.bc_channel_function = (mesh_channel_function_t)int_value;
+    if (cbor_value_enter_container(&main_value, &key_value) != CborNoError) {
+        tr_debug("Couldn't enter to the map");
+        return NM_STATUS_FAIL;
     }
 
-    // Finding bc_fixed_channel
-    if (get_uint32_value_from_stream(&main_value, CBOR_TAG_BC_FIX, &map_value, &int_value) == true) {
-        ws_cfg->bc_ch_config.bc_fixed_channel = (uint16_t)int_value;
-    }
+    while (!cbor_value_at_end(&key_value)) {
+        const cbor_config_field_t *field = NULL;
+        size_t key_len = sizeof(key);
+        CborError err;
+
+        if (cbor_value_is_text_string(&key_value)) {
+            // Too long key also moves map_value to the value, and is skipped as unknown
+            err = cbor_value_copy_text_string(&key_value, key, &key_len, &map_value);
+            if (err == CborNoError) {
+                for (size_t i = 0; i < field_count; i++) {
+                    if (strcmp(key, fields[i].tag) == 0) {
+                        field = &fields[i];
+                        break;
+                    }
+                }
+            } else if (err == CborErrorOutOfMemory) {
+                err = CborNoError;
+            }
+        } else {
+            map_value = key_value;
+            err = cbor_value_advance(&map_value);
+        }
+        if (err != CborNoError || cbor_value_at_end(&map_value)) {
+            // Keep what was decoded so far, as separate lookups of each key would have
+            tr_debug("Malformed map entry");
+            break;
+        }
 
-    // Finding bc_dwell_interval
-    if (get_uint32_value_from_stream(&main_value, CBOR_TAG_BC_DWELL, &map_value, &int_value) == true) {
-        ws_cfg->bc_ch_config.bc_dwell_interval = (uint8_t)int_value;
-    }
+        if (field != NULL && decode_config_field(field, &map_value, st_cfg) != true) {
+            tr_debug("Decoding %s fail", field->tag);
+        }
 
-    // Finding broadcast_interval
-    if (get_uint32_value_from_stream(&main_value, CBOR_TAG_BC_INTERVAL, &map_value, &int_value) == true) {
-        ws_cfg->bc_ch_config.bc_interval = int_value;
+        key_value = map_value;
+        if (cbor_value_advance(&key_value) != CborNoError) {
+            tr_debug("Malformed map value");
+            break;
+        }
     }
 
-    // Finding disc_trickle_imin
-    if (get_uint32_value_from_stream(&main_value, CBOR_TAG_TRICKLE_IMIN, &map_value, &int_value) == true) {
-        ws_cfg->timing_param.disc_trickle_imin = (uint16_t)int_value;
-    }
+    return NM_STATUS_SUCCESS;
+}
 
-    // Finding disc_trickle_imax
-    if (get_uint32_value_from_stream(&main_value, CBOR_TAG_TRICKLE_IMAX, &map_value, &int_value) == true) {
-        ws_cfg->timing_param.disc_trickle_imax = (uint16_t)int_value;
-    }
+static nm_status_t update_app_config(void *st_app, uint8_t *cbor_data, size_t len)
+{
+    /* this is a place holder for application configuration to update ,as this configuration yet to decide */
+    return NM_STATUS_SUCCESS;
+}
 
-    // Finding disc_trickle_k
-    if (get_uint32_value_from_stream(&main_value, CBOR_TAG_TRICKLE_CONST, &map_value, &int_value) == true) {
-        ws_cfg->timing_param.disc_trickle_k = (uint8_t)int_value;
-    }
+static nm_status_t update_bb_config(void *st_app, uint8_t *cbor_data, size_t len)
+{
+    /* this is a place holder for backhaul configuration to update ,as this configuration yet to decide */
+    return NM_STATUS_SUCCESS;
+}
 
-    // Finding pan_timeout
-    if (get_uint32_value_from_stream(&main_value, CBOR_TAG_PAN_TIMEOUT, &map_value, &int_value) == true) {
-        ws_cfg->timing_param.pan_timeout = (uint16_t)int_value;
-    }
+/* Following table is as per current parameters defined in code that may be going to modify, add or remove. */
+static const cbor_config_field_t ws_config_fields[] = {
+    CBOR_CONFIG_FIELD(CBOR_TAG_NW_NAME,         CBOR_FIELD_TEXT,         nm_ws_config_t, network_name),
+    CBOR_CONFIG_FIELD(CBOR_TAG_CH_MASK,         CBOR_FIELD_UINT32_ARRAY, nm_ws_config_t, channel_mask),
+    CBOR_CONFIG_FIELD(CBOR_TAG_REG_DOMAIN,      CBOR_FIELD_UINT,         nm_ws_config_t, reg_op.regulatory_domain),
+    CBOR_CONFIG_FIELD(CBOR_TAG_OP_CLASS,        CBOR_FIELD_UINT,         nm_ws_config_t, reg_op.operating_class),
+    CBOR_CONFIG_FIELD(CBOR_TAG_OP_MODE,         CBOR_FIELD_UINT,         nm_ws_config_t, reg_op.operating_mode),
+    CBOR_CONFIG_FIELD(CBOR_TAG_NW_SIZE,         CBOR_FIELD_UINT,         nm_ws_config_t, network_size),
+    CBOR_CONFIG_FIELD(CBOR_TAG_UC_FUNC,         CBOR_FIELD_UINT,         nm_ws_config_t, uc_ch_config.uc_channel_function),
+    CBOR_CONFIG_FIELD(CBOR_TAG_UC_FIX,          CBOR_FIELD_UINT,         nm_ws_config_t, uc_ch_config.uc_fixed_channel),
+    CBOR_CONFIG_FIELD(CBOR_TAG_UC_DWELL,        CBOR_FIELD_UINT,         nm_ws_config_t, uc_ch_config.uc_dwell_interval),
+    CBOR_CONFIG_FIELD(CBOR_TAG_BC_FUNC,         CBOR_FIELD_UINT,         nm_ws_config_t, bc_ch_config.bc_channel_function),
+    CBOR_CONFIG_FIELD(CBOR_TAG_BC_FIX,          CBOR_FIELD_UINT,         nm_ws_config_t, bc_ch_config.bc_fixed_channel),
+    CBOR_CONFIG_FIELD(CBOR_TAG_BC_DWELL,        CBOR_FIELD_UINT,         nm_ws_config_t, bc_ch_config.bc_dwell_interval),
+    CBOR_CONFIG_FIELD(CBOR_TAG_BC_INTERVAL,     CBOR_FIELD_UINT,         nm_ws_config_t, bc_ch_config.bc_interval),
+    CBOR_CONFIG_FIELD(CBOR_TAG_TRICKLE_IMIN,    CBOR_FIELD_UINT,         nm_ws_config_t, timing_param.disc_trickle_imin),
+    CBOR_CONFIG_FIELD(CBOR_TAG_TRICKLE_IMAX,    CBOR_FIELD_UINT,         nm_ws_config_t, timing_param.disc_trickle_imax),
+    CBOR_CONFIG_FIELD(CBOR_TAG_TRICKLE_CONST,   CBOR_FIELD_UINT,         nm_ws_config_t, timing_param.disc_trickle_k),
+    CBOR_CONFIG_FIELD(CBOR_TAG_PAN_TIMEOUT,     CBOR_FIELD_UINT,         nm_ws_config_t, timing_param.pan_timeout),
+    CBOR_CONFIG_FIELD(CBOR_TAG_WS_DELAY,        CBOR_FIELD_UINT,         nm_ws_config_t, delay),
+    CBOR_CONFIG_FIELD(CBOR_TAG_DEV_MIN_SENS,    CBOR_FIELD_UINT,         nm_ws_config_t, device_min_sens),
+};
 
-    // Finding ws_delay
-    if (get_uint32_value_from_stream(&main_value, CBOR_TAG_WS_DELAY, &map_value, &int_value) == true) {
-        ws_cfg->delay = (uint16_t)int_value;
-    }
+static nm_status_t update_ws_config(void *st_app, uint8_t *cbor_data, size_t len)
+{
+    nm_ws_config_t *ws_cfg = (nm_ws_config_t *)st_app;
 
-    // Finding device_min_sens
-    if (get_uint32_value_from_stream(&main_value, CBOR_TAG_DEV_MIN_SENS, &map_value, &int_value) == true) {
-        ws_cfg->device_min_sens = (uint8_t)int_value;
+    if (decode_config_map(cbor_data, len, ws_config_fields, sizeof(ws_config_fields) / sizeof(ws_config_fields[0]), ws_cfg) != NM_STATUS_SUCCESS) {
+        return NM_STATUS_FAIL;
     }
 
     /* This parameters going to update from binary only */
@@ -386,77 +379,64 @@ static nm_status_t update_ws_config(void *st_app, uint8_t *cbor_data, size_t len
     return NM_STATUS_SUCCESS;
 }
 
-static nm_status_t update_br_config(void *st_app, uint8_t *cbor_data, size_t len)
+static bool decode_radius_server_secret(const CborValue *value, void *st_cfg)
 {
-    /* Following structure is as per current parameters defined in code that may be going to modify, add or remove. */
-    CborParser parser;
-    CborValue main_value;
-    CborValue map_value;
-
-    char *temp_buffer = NULL;
+    nm_br_config_t *br_cfg = (nm_br_config_t *)st_cfg;
     uint8_t *secret_buffer = NULL;
     size_t temp_buffer_size = 0;
-    uint32_t int_value = 0;
-
-    nm_br_config_t *br_cfg = (nm_br_config_t *)st_app;
 
-    if (cbor_parser_init(cbor_data, len, 0, &parser, &main_value) != CborNoError) {
-        tr_debug("CborParser init fail");
-        return NM_STATUS_FAIL;
-    }
-    if (cbor_value_is_map(&main_value) != true) {
-        tr_debug("Cbor main_value map fail");
-        return NM_STATUS_FAIL;
+    if (cbor_value_is_byte_string(value) != true) {
+        tr_debug("Value is not byte string");
+        return false;
     }
-
-    // Finding dio_interval_min
-    if (get_uint32_value_from_stream(&main_value, CBOR_TAG_DIO_INTERVAL_MIN, &map_value, &int_value) == true) {
-        br_cfg->rpl_config.dio_interval_min = (uint8_t)int_value;
+    if (cbor_value_dup_byte_string(value, &secret_buffer, &temp_buffer_size, NULL) != CborNoError) {
+        tr_debug("Get byte string fail");
+        return false;
     }
 
-    // Finding dio_interval_doublings
-    if (get_uint32_value_from_stream(&main_value, CBOR_TAG_DIO_INTERVAL_DOUBLING, &map_value, &int_value) == true) {
-        br_cfg->rpl_config.dio_interval_doublings = (uint8_t)int_value;
+    if (br_cfg->radius_config.secret != NULL && br_cfg->radius_config.secret_len != 0) {
+        free(br_cfg->radius_config.secret);
+        br_cfg->radius_config.secret_len = 0;
+        br_cfg->radius_config.secret = NULL;
     }
+    br_cfg->radius_config.secret_len = (uint16_t)temp_buffer_size;
+    br_cfg->radius_config.secret = secret_buffer;
+    return true;
+}
 
-    // Finding dio_redundancy_constant
-    if (get_uint32_value_from_stream(&main_value, CBOR_TAG_DIO_REDUNDANCY_CONST, &map_value, &int_value) == true) {
-        br_cfg->rpl_config.dio_redundancy_constant = (uint8_t)int_value;
-    }
+static bool decode_radius_server_addr(const CborValue *value, void *st_cfg)
+{
+    nm_br_config_t *br_cfg = (nm_br_config_t *)st_cfg;
+    char temp_buffer[sizeof(br_cfg->radius_config.address)];
 
-    // Finding pan_id
-    if (get_uint32_value_from_stream(&main_value, CBOR_TAG_PAN_ID, &map_value, &int_value) == true) {
-        br_cfg->pan_id = (uint16_t)int_value;
+    if (decode_text_field(value, temp_buffer, sizeof(temp_buffer)) != true) {
+        return false;
     }
 
-    // Finding br_delay
-    if (get_uint32_value_from_stream(&main_value, CBOR_TAG_BR_DELAY, &map_value, &int_value) == true) {
-        br_cfg->delay = (uint16_t)int_value;
+    if (!strcasecmp(temp_buffer, "NULL")) {
+        memset(br_cfg->radius_config.address, '\0', sizeof(br_cfg->radius_config.address));
+    } else {
+        strcpy(br_cfg->radius_config.address, temp_buffer);
     }
+    return true;
+}
 
-    //Finding Radius Server Secret
-    if (get_byte_value_from_stream(&main_value, CBOR_TAG_RADIUS_SERVER_SECRET, &map_value, &secret_buffer, &temp_buffer_size) == true) {
-        if (br_cfg->radius_config.secret != NULL && br_cfg->radius_config.secret_len != 0) {
-            free(br_cfg->radius_config.secret);
-            br_cfg->radius_config.secret_len = 0;
-            br_cfg->radius_config.secret = NULL;
-        }
-        br_cfg->radius_config.secret_len = (uint16_t)temp_buffer_size;
-        br_cfg->radius_config.secret = secret_buffer;
-    }
+static const cbor_config_field_t br_config_fields[] = {
+    CBOR_CONFIG_FIELD(CBOR_TAG_DIO_INTERVAL_MIN,        CBOR_FIELD_UINT, nm_br_config_t, rpl_config.dio_interval_min),
+    CBOR_CONFIG_FIELD(CBOR_TAG_DIO_INTERVAL_DOUBLING,   CBOR_FIELD_UINT, nm_br_config_t, rpl_config.dio_interval_doublings),
+    CBOR_CONFIG_FIELD(CBOR_TAG_DIO_REDUNDANCY_CONST,    CBOR_FIELD_UINT, nm_br_config_t, rpl_config.dio_redundancy_constant),
+    CBOR_CONFIG_FIELD(CBOR_TAG_PAN_ID,                  CBOR_FIELD_UINT, nm_br_config_t, pan_id),
+    CBOR_CONFIG_FIELD(CBOR_TAG_BR_DELAY,                CBOR_FIELD_UINT, nm_br_config_t, delay),
+    CBOR_CONFIG_CUSTOM_FIELD(CBOR_TAG_RADIUS_SERVER_SECRET, decode_radius_server_secret),
+    CBOR_CONFIG_CUSTOM_FIELD(CBOR_TAG_RADIUS_SERVER_ADDR,   decode_radius_server_addr),
+};
 
-    //Finding Radius Server address
-    if (get_string_value_from_stream(&main_value, CBOR_TAG_RADIUS_SERVER_ADDR, &map_value, &temp_buffer) == true) {
-        if(!strcasecmp(temp_buffer,"NULL")) {
-            memset(br_cfg->radius_config.address, '\0', sizeof(br_cfg->radius_config.address));
-        } else {
-        strcpy(br_cfg->radius_config.address, temp_buffer);
-        }
-    }
+static nm_status_t update_br_config(void *st_app, uint8_t *cbor_data, size_t len)
+{
+    nm_br_config_t *br_cfg = (nm_br_config_t *)st_app;
 
-    if (temp_buffer != NULL) {
-        free(temp_buffer);
-        temp_buffer = NULL;
+    if (decode_config_map(cbor_data, len, br_config_fields, sizeof(br_config_fields) / sizeof(br_config_fields[0]), br_cfg) != NM_STATUS_SUCCESS) {
+        return NM_STATUS_FAIL;
     }
 
     /* This parameters going to update from binary only */
@@ -1473,17 +1453,17 @@ nm_status_t nm_statistics_to_cbor(void *stats, uint8_t *cbor_data, config_type_t
     return status;
 }
 
-nm_status_t nm_routing_table_to_cbor(uint8_t *routing_table, size_t routing_table_length, uint8_t *cbor_data, size_t *len)
+nm_status_t nm_routing_table_header_to_cbor(size_t routing_table_length, uint8_t *cbor_header, size_t *len)
 {
     CborError cbor_error = CborNoError;
     CborEncoder encoder;
     CborEncoder map;
 
-    if ((routing_table == NULL) || (cbor_data == NULL)) {
+    if (cbor_header == NULL) {
         return NM_STATUS_FAIL;
     }
 
-    cbor_encoder_init(&encoder, cbor_data, ROUTING_TABLE_MAX_ENCODING_BUFF(routing_table_length), 0);
+    cbor_encoder_init(&encoder, cbor_header, ROUTING_TABLE_CBOR_OVERHEAD, 0);
 
     // Create map
     cbor_error = cbor_encoder_create_map(&encoder, &map, 1);
@@ -1492,22 +1472,31 @@ nm_status_t nm_routing_table_to_cbor(uint8_t *routing_table, size_t routing_tabl
         return NM_STATUS_FAIL;
     }
 
-    if (encode_text_string(&map, CBOR_TAG_ROUTING_TABLE, sizeof(CBOR_TAG_ROUTING_TABLE) - 1)) {
-        if (!encode_byte_array(&map, routing_table, routing_table_length)) {
-            printf("FAILED to CBORise Routing Table\n");
-            return NM_STATUS_FAIL;
-        }
-    }
-
-    // Close Map
-    cbor_error = cbor_encoder_close_container(&encoder, &map);
-    if (cbor_error) {
-        tr_debug("Failed closing presence map with error code %d", cbor_error);
+    if (!encode_text_string(&map, CBOR_TAG_ROUTING_TABLE, sizeof(CBOR_TAG_ROUTING_TABLE) - 1)) {
         return NM_STATUS_FAIL;
     }
 
-    size_t ret = cbor_encoder_get_buffer_size(&encoder, cbor_data);
-    tr_debug("Length of ws_stats_to_cbor buffer is %d", ret);
+    /* Only the head of the byte string is encoded, the routing table follows it.
+     * The map is complete with the byte string, so it is not closed. */
+    size_t ret = cbor_encoder_get_buffer_size(&map, cbor_header);
+    if (routing_table_length < 24) {
+        cbor_header[ret++] = 0x40 | (uint8_t)routing_table_length;
+    } else if (routing_table_length <= 0xFF) {
+        cbor_header[ret++] = 0x58;
+        cbor_header[ret++] = (uint8_t)routing_table_length;
+    } else if (routing_table_length <= 0xFFFF) {
+        cbor_header[ret++] = 0x59;
+        cbor_header[ret++] = (uint8_t)(routing_table_length >> 8);
+        cbor_header[ret++] = (uint8_t)routing_table_length;
+    } else {
+        cbor_header[ret++] = 0x5A;
+        cbor_header[ret++] = (uint8_t)(routing_table_length >> 24);
+        cbor_header[ret++] = (uint8_t)(routing_table_length >> 16);
+        cbor_header[ret++] = (uint8_t)(routing_table_length >> 8);
+        cbor_header[ret++] = (uint8_t)routing_table_length;
+    }
+
+    tr_debug("Length of routing table header is %d", ret);
     *len = ret;
 
     return NM_STATUS_SUCCESS;
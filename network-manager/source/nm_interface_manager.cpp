@@ -1402,12 +1402,19 @@ nm_status_t nm_res_get_br_stats(uint8_t **datap, size_t *length)
     return NM_STATUS_SUCCESS;
 }
 
+/* The routing table is read from Nanostack straight to its place in the encoded
+ * resource, after ROUTING_TABLE_CBOR_OVERHEAD bytes kept for the CBOR header. The
+ * buffer is kept between the reads and grows only with the number of devices. */
+static uint8_t *routing_table_cache = NULL;
+static size_t routing_table_cache_size = 0;
+
 nm_status_t nm_res_get_routing_table(uint8_t **datap, size_t *length)
 {
     ws_br_info_t br_info = {0};
     ws_br_route_info_t *route_info = NULL;
     size_t routing_table_length = 0;
     size_t required_length = 0;
+    size_t header_length = 0;
     int dev_count = -1;
 
     if (ws_br->info_get(&br_info) != MESH_ERROR_NONE) {
@@ -1422,33 +1429,43 @@ nm_status_t nm_res_get_routing_table(uint8_t **datap, size_t *length)
     }
 
     required_length = routing_table_length + ROUTING_TABLE_CBOR_OVERHEAD;
-    tr_info("Allocating New buffer of Size %d bytes for routing table", required_length);
-    *datap = (uint8_t *)nm_dyn_mem_alloc(required_length);
-    if (*datap == NULL) {
-        tr_error("FAILED to allocate memory for Cborise Route Info");
-        return NM_STATUS_FAIL;
+    if (required_length > routing_table_cache_size) {
+        tr_info("Allocating New buffer of Size %d bytes for routing table", required_length);
+        nm_dyn_mem_free(routing_table_cache);
+        routing_table_cache_size = 0;
+        routing_table_cache = (uint8_t *)nm_dyn_mem_alloc(required_length);
+        if (routing_table_cache == NULL) {
+            tr_error("FAILED to allocate memory for Cborise Route Info");
+            return NM_STATUS_FAIL;
+        }
+        routing_table_cache_size = required_length;
     }
 
-    route_info = (ws_br_route_info_t *)(*datap + ROUTING_TABLE_CBOR_OVERHEAD);
+    route_info = (ws_br_route_info_t *)(routing_table_cache + ROUTING_TABLE_CBOR_OVERHEAD);
     if (br_info.device_count > 0) {
         dev_count = ws_br->routing_table_get(route_info, br_info.device_count);
         if (dev_count <= 0) {
             tr_warn("FAILED reading Routing Table from Nanostack");
-            nm_dyn_mem_free(*datap);
             return NM_STATUS_FAIL;
         }
         tr_info("Joined device count = %d", dev_count);
+        /* Devices may have left after the count was read */
+        routing_table_length = dev_count * sizeof(ws_br_route_info_t);
     } else {
         *(uint8_t *)route_info = 0x00; /* Routing table with 1 byte of value 0 means empty table */
         tr_info("Sending EMPTY Routing Table");
     }
 
-    if (nm_routing_table_to_cbor((uint8_t *)route_info, routing_table_length, *datap, length) == NM_STATUS_FAIL) {
+    uint8_t header[ROUTING_TABLE_CBOR_OVERHEAD];
+    if (nm_routing_table_header_to_cbor(routing_table_length, header, &header_length) == NM_STATUS_FAIL) {
         tr_warn("FAILED to CBORise Routing Table");
-        /* Free dynamically allocated memory */
-        nm_dyn_mem_free(*datap);
         return NM_STATUS_FAIL;
     }
+
+    /* The header ends where the routing table starts */
+    *datap = routing_table_cache + ROUTING_TABLE_CBOR_OVERHEAD - header_length;
+    memcpy(*datap, header, header_length);
+    *length = header_length + routing_table_length;
     return NM_STATUS_SUCCESS;
 }
 
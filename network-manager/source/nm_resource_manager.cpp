@@ -345,11 +345,8 @@ void msg_delivery_handle(const M2MBase &base,
                 tr_debug("br_stats data Memory freed");
             }
         } else if (obj == routing_table) {
-            if (routing_table_buf != NULL) {
-                nm_dyn_mem_free(routing_table_buf);
-                routing_table_buf = NULL;
-                tr_debug("routing_table data Memory freed");
-            }
+            /* routing table buffer is kept by the interface manager */
+            routing_table_buf = NULL;
         } else if (obj == node_stats) {
             if (node_stats_buf != NULL) {
                 nm_dyn_mem_free(node_stats_buf);
@@ -546,7 +543,6 @@ nm_status_t nm_res_manager_get(void *resource_object)
                 return NM_STATUS_FAIL;
             }
             tr_info("Routing Table resource value Set to Cloud Client");
-            nm_dyn_mem_free(buf);
             return NM_STATUS_SUCCESS;
         }
         tr_warn("FAILED to fetch Routing Table");
@@ -92,4 +92,17 @@ int8_t platform_tick_timer_stop(void)
     return retval;
 }
 
+#ifdef NS_EVENTLOOP_PROFILING
+// Microsecond counter for event loop profiling, derived from the PAL system tick
+extern "C"
+uint32_t platform_profiling_timer_us(void)
+{
+    const uint64_t ticks = pal_osKernelSysTick();
+    const uint64_t frequency = pal_osKernelSysTickFrequency();
+
+    // Split to avoid overflowing the multiplication with fast tick counters
+    return (uint32_t)((ticks / frequency) * 1000000 + ((ticks % frequency) * 1000000) / frequency);
+}
+#endif
+
 
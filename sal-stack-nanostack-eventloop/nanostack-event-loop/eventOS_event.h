@@ -21,6 +21,7 @@ extern "C" {
 
 #include "ns_types.h"
 #include "ns_list.h"
+#include "platform/eventloop_config.h"
 
 /**
  * \enum arm_library_event_priority_e
@@ -58,6 +59,8 @@ typedef arm_event_t arm_event_s;
 partition "Event loop" {
 (*) -->[event created] "UNQUEUED"
 "UNQUEUED" -->[event_core_write()] "QUEUED"
+"UNQUEUED" -->[eventOS_event_send_user_allocated()\nwith NS_EVENTLOOP_LOCKFREE_SUBMIT] "SUBMITTED"
+"SUBMITTED" -->[event_core_read()] "QUEUED"
 "QUEUED" -->[event_core_read()] "RUNNING"
 "RUNNING" ->[event_core_free_push()] "UNQUEUED"
 }
@@ -80,7 +83,14 @@ typedef struct arm_event_storage {
         ARM_LIB_EVENT_UNQUEUED,
         ARM_LIB_EVENT_QUEUED,
         ARM_LIB_EVENT_RUNNING,
+        ARM_LIB_EVENT_SUBMITTED,
     } state;
+#ifdef NS_EVENTLOOP_TASKLET_STATISTICS
+    uint32_t queued_ticks; /**< Event timer ticks when the event was queued */
+#endif
+#ifdef NS_EVENTLOOP_PROFILING
+    uint32_t queued_us; /**< Profiling timer microseconds when the event was queued */
+#endif
     ns_list_link_t link;
 } arm_event_storage_t;
 
@@ -125,6 +135,10 @@ extern int8_t eventOS_event_send(const arm_event_t *event);
  * event - it can use NS_CONTAINER_OF() to get a pointer to the original
  * event passed to this call, or to its outer container.
  *
+ * With NS_EVENTLOOP_LOCKFREE_SUBMIT the event is pushed to a lock-free
+ * submission list and moved to the event queue by the scheduler, so the call
+ * does not take the platform critical section and can be made from any thread.
+ *
  * It is a program error to send a user-allocated event to a non-existent task.
  */
 extern void eventOS_event_send_user_allocated(arm_event_storage_t *event);
@@ -163,6 +177,67 @@ extern int8_t eventOS_event_handler_create(void (*handler_func_ptr)(arm_event_t
  */
 extern void eventOS_cancel(arm_event_storage_t *event);
 
+#ifdef NS_EVENTLOOP_TASKLET_STATISTICS
+#ifdef NS_EVENTLOOP_PROFILING
+/**
+ * Number of profiling histogram buckets. Bucket 0 counts values of 0 us,
+ * bucket n values from 2^(n-1) to 2^n - 1 us, and the last bucket everything
+ * longer, i.e. from about 4.2 seconds.
+ */
+#define EVENTOS_PROFILING_HISTOGRAM_BUCKETS 24
+#endif
+
+/**
+ * \struct eventOS_tasklet_statistics_t
+ * \brief Event dispatch statistics of a tasklet.
+ */
+typedef struct eventOS_tasklet_statistics {
+    uint32_t dispatch_count;    /**< Number of events delivered to the tasklet */
+    uint32_t max_latency_ticks; /**< Longest time an event waited in the queue, in event timer ticks */
+#ifdef NS_EVENTLOOP_PROFILING
+    uint32_t max_runtime_us;    /**< Longest handler call, in microseconds */
+    uint32_t runtime_histogram[EVENTOS_PROFILING_HISTOGRAM_BUCKETS]; /**< Handler call durations */
+    uint32_t latency_histogram[EVENTOS_PROFILING_HISTOGRAM_BUCKETS]; /**< Times events waited in the queue */
+#endif
+} eventOS_tasklet_statistics_t;
+
+/**
+ * \brief Read event dispatch statistics of a tasklet
+ *
+ * Latency is measured from queueing the event to calling the tasklet, so
+ * it includes time spent behind both higher priority and earlier events.
+ *
+ * \param tasklet_id Tasklet ID returned by eventOS_event_handler_create()
+ * \param statistics Filled with the statistics
+ * \param clear Reset the statistics after reading
+ *
+ * \return 0 on success
+ * \return -1 if tasklet does not exist
+ */
+extern int8_t eventOS_event_handler_statistics_get(int8_t tasklet_id, eventOS_tasklet_statistics_t *statistics, bool clear);
+#endif
+
+#ifdef NS_EVENTLOOP_PROFILING
+/**
+ * \struct eventOS_scheduler_profile_t
+ * \brief Event queue statistics of the scheduler.
+ */
+typedef struct eventOS_scheduler_profile {
+    uint16_t queue_depth;       /**< Number of events currently queued */
+    uint16_t max_queue_depth;   /**< Highest number of events queued at the same time */
+} eventOS_scheduler_profile_t;
+
+/**
+ * \brief Read event queue statistics of the scheduler
+ *
+ * Events waiting on timers are not counted until they are due.
+ *
+ * \param profile Filled with the statistics
+ * \param clear Reset the maximum queue depth to the current depth after reading
+ */
+extern void eventOS_scheduler_profile_get(eventOS_scheduler_profile_t *profile, bool clear);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
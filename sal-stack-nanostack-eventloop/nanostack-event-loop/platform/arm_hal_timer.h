@@ -88,6 +88,17 @@ extern int8_t platform_tick_timer_stop(void);
 
 #endif // NS_EVENTLOOP_USE_TICK_TIMER
 
+#ifdef NS_EVENTLOOP_PROFILING
+/**
+ * \brief This function is API for reading the free running microsecond
+ *        counter used for event loop profiling. The counter may wrap around.
+ *
+ * \return current time in microseconds
+ */
+extern uint32_t platform_profiling_timer_us(void);
+
+#endif // NS_EVENTLOOP_PROFILING
+
 #ifdef __cplusplus
 }
 #endif
@@ -27,6 +27,12 @@
 #undef NS_EVENTLOOP_USE_TICK_TIMER
 /* Exclude high resolution timer from build (removes need for "platform_timer" API) */
 #undef NS_EXCLUDE_HIGHRES_TIMER
+/* Collect per-tasklet dispatch statistics (see eventOS_event_handler_statistics_get) */
+#undef NS_EVENTLOOP_TASKLET_STATISTICS
+/* Send user-allocated events without taking the platform critical section (requires __atomic builtins) */
+#undef NS_EVENTLOOP_LOCKFREE_SUBMIT
+/* Collect per-tasklet runtime and latency histograms and queue depth (requires "platform_profiling_timer_us" API) */
+#undef NS_EVENTLOOP_PROFILING
 
 /*
  * mbedOS 5 specific configuration flag mapping to internal flags
@@ -39,6 +45,18 @@
 #define NS_EXCLUDE_HIGHRES_TIMER        1
 #endif
 
+#if defined(MBED_CONF_NANOSTACK_EVENTLOOP_TASKLET_STATISTICS) && MBED_CONF_NANOSTACK_EVENTLOOP_TASKLET_STATISTICS
+#define NS_EVENTLOOP_TASKLET_STATISTICS 1
+#endif
+
+#if defined(MBED_CONF_NANOSTACK_EVENTLOOP_LOCKFREE_SUBMIT) && MBED_CONF_NANOSTACK_EVENTLOOP_LOCKFREE_SUBMIT
+#define NS_EVENTLOOP_LOCKFREE_SUBMIT    1
+#endif
+
+#if defined(MBED_CONF_NANOSTACK_EVENTLOOP_PROFILING) && MBED_CONF_NANOSTACK_EVENTLOOP_PROFILING
+#define NS_EVENTLOOP_PROFILING          1
+#endif
+
 /*
  * Include the user config file if defined
  */
@@ -46,4 +64,9 @@
 #include NS_EVENTLOOP_USER_CONFIG_FILE
 #endif
 
+/* Profiling extends the tasklet statistics */
+#if defined(NS_EVENTLOOP_PROFILING) && !defined(NS_EVENTLOOP_TASKLET_STATISTICS)
+#define NS_EVENTLOOP_TASKLET_STATISTICS 1
+#endif
+
 #endif /* EVENTLOOP_CONFIG_H_ */
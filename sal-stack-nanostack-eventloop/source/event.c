@@ -18,23 +18,51 @@
 #include "ns_list.h"
 #include "eventOS_event.h"
 #include "eventOS_scheduler.h"
+#include "eventOS_event_timer.h"
 #include "timer_sys.h"
 #include "nsdynmemLIB.h"
 #include "ns_timer.h"
 #include "event.h"
 #include "platform/arm_hal_interrupt.h"
+#ifdef NS_EVENTLOOP_PROFILING
+#include "platform/arm_hal_timer.h"
+#include "common_functions.h"
+#endif
 
 
 typedef struct arm_core_tasklet {
     int8_t id; /**< Event handler Tasklet ID */
     void (*func_ptr)(arm_event_s *);
+#ifdef NS_EVENTLOOP_TASKLET_STATISTICS
+    eventOS_tasklet_statistics_t statistics;
+#endif
     ns_list_link_t link;
 } arm_core_tasklet_t;
 
+typedef NS_LIST_HEAD(arm_event_storage_t, link) event_queue_t;
+
+#define EVENT_PRIORITY_LEVELS (ARM_LIB_LOW_PRIORITY_EVENT + 1)
+
 static NS_LIST_DEFINE(arm_core_tasklet_list, arm_core_tasklet_t, link);
-static NS_LIST_DEFINE(event_queue_active, arm_event_storage_t, link);
+/* FIFO of queued events per priority level, so queueing needs no search */
+static event_queue_t event_queue_active[EVENT_PRIORITY_LEVELS];
 static NS_LIST_DEFINE(free_event_entry, arm_event_storage_t, link);
 
+#ifdef NS_EVENTLOOP_LOCKFREE_SUBMIT
+#ifndef __GNUC__
+#error "NS_EVENTLOOP_LOCKFREE_SUBMIT requires compiler support for __atomic builtins"
+#endif
+/* Events sent without lock, linked through link.next in reverse order of sending */
+static arm_event_storage_t *event_submit_stack;
+static void event_submit_drain_critical(void);
+#endif
+
+#ifdef NS_EVENTLOOP_PROFILING
+/* Events in event_queue_active, and the high water mark of it */
+static uint16_t event_queue_depth;
+static uint16_t event_queue_depth_max;
+#endif
+
 // Statically allocate initial pool of events.
 #define STARTUP_EVENT_POOL_SIZE 10
 static arm_event_storage_t startup_event_pool[STARTUP_EVENT_POOL_SIZE];
@@ -47,6 +75,17 @@ static arm_core_tasklet_t *tasklet_dynamically_allocate(void);
 static arm_event_storage_t *event_dynamically_allocate(void);
 static arm_event_storage_t *event_core_get(void);
 static void event_core_write(arm_event_storage_t *event);
+static void event_queued_critical(arm_event_storage_t *event);
+
+static event_queue_t *event_queue_for(const arm_event_storage_t *event)
+{
+    // Unknown priorities are handled as low, as they were sorted after it
+    unsigned level = event->data.priority;
+    if (level >= EVENT_PRIORITY_LEVELS) {
+        level = ARM_LIB_LOW_PRIORITY_EVENT;
+    }
+    return &event_queue_active[level];
+}
 
 static arm_core_tasklet_t *event_tasklet_handler_get(uint8_t tasklet_id)
 {
@@ -103,6 +142,9 @@ int8_t eventOS_event_handler_create(void (*handler_func_ptr)(arm_event_s *), uin
     //Fill in tasklet; add to list
     new->id = tasklet_get_free_id();
     new->func_ptr = handler_func_ptr;
+#ifdef NS_EVENTLOOP_TASKLET_STATISTICS
+    memset(&new->statistics, 0, sizeof(new->statistics));
+#endif
     ns_list_add_to_end(&arm_core_tasklet_list, new);
 
     //Queue "init" event for the new task
@@ -131,8 +173,46 @@ int8_t eventOS_event_send(const arm_event_t *event)
 void eventOS_event_send_user_allocated(arm_event_storage_t *event)
 {
     event->allocator = ARM_LIB_EVENT_USER;
+#ifdef NS_EVENTLOOP_LOCKFREE_SUBMIT
+    event->state = ARM_LIB_EVENT_SUBMITTED;
+    arm_event_storage_t *head = __atomic_load_n(&event_submit_stack, __ATOMIC_RELAXED);
+    do {
+        event->link.next = head;
+    } while (!__atomic_compare_exchange_n(&event_submit_stack, &head, event, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    eventOS_scheduler_signal();
+#else
     event_core_write(event);
+#endif
+}
+
+#ifdef NS_EVENTLOOP_LOCKFREE_SUBMIT
+// Requires lock to be held, which also makes the caller the only consumer
+static void event_submit_drain_critical(void)
+{
+    if (!__atomic_load_n(&event_submit_stack, __ATOMIC_RELAXED)) {
+        return;
+    }
+
+    // Taking the whole list at once can not suffer from ABA
+    arm_event_storage_t *event = __atomic_exchange_n(&event_submit_stack, NULL, __ATOMIC_ACQUIRE);
+
+    // Reverse to queue the events in the order they were sent
+    arm_event_storage_t *ordered = NULL;
+    while (event) {
+        arm_event_storage_t *next = event->link.next;
+        event->link.next = ordered;
+        ordered = event;
+        event = next;
+    }
+
+    while (ordered) {
+        arm_event_storage_t *next = ordered->link.next;
+        ns_list_add_to_end(event_queue_for(ordered), ordered);
+        event_queued_critical(ordered);
+        ordered = next;
+    }
 }
+#endif
 
 void eventOS_event_send_timer_allocated(arm_event_storage_t *event)
 {
@@ -142,7 +222,10 @@ void eventOS_event_send_timer_allocated(arm_event_storage_t *event)
 
 void eventOS_event_cancel_critical(arm_event_storage_t *event)
 {
-    ns_list_remove(&event_queue_active, event);
+    ns_list_remove(event_queue_for(event), event);
+#ifdef NS_EVENTLOOP_PROFILING
+    event_queue_depth--;
+#endif
 }
 
 static arm_event_storage_t *event_dynamically_allocate(void)
@@ -206,32 +289,48 @@ void event_core_free_push(arm_event_storage_t *free)
 
 static arm_event_storage_t *event_core_read(void)
 {
+    arm_event_storage_t *event = NULL;
     platform_enter_critical();
-    arm_event_storage_t *event = ns_list_get_first(&event_queue_active);
-    if (event) {
-        event->state = ARM_LIB_EVENT_RUNNING;
-        ns_list_remove(&event_queue_active, event);
+#ifdef NS_EVENTLOOP_LOCKFREE_SUBMIT
+    event_submit_drain_critical();
+#endif
+    // note enum ordering means the highest priority queue is first
+    for (unsigned level = 0; level < EVENT_PRIORITY_LEVELS; level++) {
+        event = ns_list_get_first(&event_queue_active[level]);
+        if (event) {
+            event->state = ARM_LIB_EVENT_RUNNING;
+            ns_list_remove(&event_queue_active[level], event);
+#ifdef NS_EVENTLOOP_PROFILING
+            event_queue_depth--;
+#endif
+            break;
+        }
     }
     platform_exit_critical();
     return event;
 }
 
+// Requires lock to be held
+static void event_queued_critical(arm_event_storage_t *event)
+{
+    event->state = ARM_LIB_EVENT_QUEUED;
+#ifdef NS_EVENTLOOP_TASKLET_STATISTICS
+    event->queued_ticks = eventOS_event_timer_ticks();
+#endif
+#ifdef NS_EVENTLOOP_PROFILING
+    event->queued_us = platform_profiling_timer_us();
+    event_queue_depth++;
+    if (event_queue_depth > event_queue_depth_max) {
+        event_queue_depth_max = event_queue_depth;
+    }
+#endif
+}
+
 void event_core_write(arm_event_storage_t *event)
 {
     platform_enter_critical();
-    bool added = false;
-    ns_list_foreach(arm_event_storage_t, event_tmp, &event_queue_active) {
-        // note enum ordering means we're checking if event_tmp is LOWER priority than event
-        if (event_tmp->data.priority > event->data.priority) {
-            ns_list_add_before(&event_queue_active, event_tmp, event);
-            added = true;
-            break;
-        }
-    }
-    if (!added) {
-        ns_list_add_to_end(&event_queue_active, event);
-    }
-    event->state = ARM_LIB_EVENT_QUEUED;
+    ns_list_add_to_end(event_queue_for(event), event);
+    event_queued_critical(event);
 
     /* Wake From Idle */
     platform_exit_critical();
@@ -241,15 +340,61 @@ void event_core_write(arm_event_storage_t *event)
 // Requires lock to be held
 arm_event_storage_t *eventOS_event_find_by_id_critical(uint8_t tasklet_id, uint8_t event_id)
 {
-    ns_list_foreach(arm_event_storage_t, cur, &event_queue_active) {
-        if (cur->data.receiver == tasklet_id && cur->data.event_id == event_id) {
-            return cur;
+#ifdef NS_EVENTLOOP_LOCKFREE_SUBMIT
+    event_submit_drain_critical();
+#endif
+    for (unsigned level = 0; level < EVENT_PRIORITY_LEVELS; level++) {
+        ns_list_foreach(arm_event_storage_t, cur, &event_queue_active[level]) {
+            if (cur->data.receiver == tasklet_id && cur->data.event_id == event_id) {
+                return cur;
+            }
         }
     }
 
     return NULL;
 }
 
+#ifdef NS_EVENTLOOP_TASKLET_STATISTICS
+int8_t eventOS_event_handler_statistics_get(int8_t tasklet_id, eventOS_tasklet_statistics_t *statistics, bool clear)
+{
+    arm_core_tasklet_t *tasklet = event_tasklet_handler_get(tasklet_id);
+    if (!tasklet || !statistics) {
+        return -1;
+    }
+
+    platform_enter_critical();
+    *statistics = tasklet->statistics;
+    if (clear) {
+        memset(&tasklet->statistics, 0, sizeof(tasklet->statistics));
+    }
+    platform_exit_critical();
+    return 0;
+}
+#endif
+
+#ifdef NS_EVENTLOOP_PROFILING
+void eventOS_scheduler_profile_get(eventOS_scheduler_profile_t *profile, bool clear)
+{
+    platform_enter_critical();
+    profile->queue_depth = event_queue_depth;
+    profile->max_queue_depth = event_queue_depth_max;
+    if (clear) {
+        event_queue_depth_max = event_queue_depth;
+    }
+    platform_exit_critical();
+}
+
+static void event_histogram_add(uint32_t *histogram, uint32_t value_us)
+{
+    // Bucket is the number of significant bits, so 1 us goes to bucket 1, 2-3 us to 2 and so on
+    uint_fast8_t bucket = 32 - common_count_leading_zeros_32(value_us);
+    if (bucket >= EVENTOS_PROFILING_HISTOGRAM_BUCKETS) {
+        bucket = EVENTOS_PROFILING_HISTOGRAM_BUCKETS - 1;
+    }
+    histogram[bucket]++;
+}
+#endif
+
 /**
  *
  * \brief Initialize Nanostack Core.
@@ -261,7 +406,13 @@ void eventOS_scheduler_init(void)
 {
     /* Reset Event List variables */
     ns_list_init(&free_event_entry);
-    ns_list_init(&event_queue_active);
+    for (unsigned level = 0; level < EVENT_PRIORITY_LEVELS; level++) {
+        ns_list_init(&event_queue_active[level]);
+    }
+#ifdef NS_EVENTLOOP_PROFILING
+    event_queue_depth = 0;
+    event_queue_depth_max = 0;
+#endif
     ns_list_init(&arm_core_tasklet_list);
 
     //Add first 10 entries to "free" list
@@ -337,8 +488,30 @@ bool eventOS_scheduler_dispatch_event(void)
      * itself to return void to simplify logic.
      */
 
+#ifdef NS_EVENTLOOP_TASKLET_STATISTICS
+    uint32_t latency = eventOS_event_timer_ticks() - cur_event->queued_ticks;
+    tasklet->statistics.dispatch_count++;
+    if (latency > tasklet->statistics.max_latency_ticks) {
+        tasklet->statistics.max_latency_ticks = latency;
+    }
+#endif
+
+#ifdef NS_EVENTLOOP_PROFILING
+    uint32_t start_us = platform_profiling_timer_us();
+    event_histogram_add(tasklet->statistics.latency_histogram, start_us - cur_event->queued_us);
+#endif
+
     /* Tasklet Scheduler Call */
     tasklet->func_ptr(&cur_event->data);
+
+#ifdef NS_EVENTLOOP_PROFILING
+    uint32_t runtime_us = platform_profiling_timer_us() - start_us;
+    event_histogram_add(tasklet->statistics.runtime_histogram, runtime_us);
+    if (runtime_us > tasklet->statistics.max_runtime_us) {
+        tasklet->statistics.max_runtime_us = runtime_us;
+    }
+#endif
+
     event_core_free_push(cur_event);
 
     /* Set Current Tasklet to Idle state */
@@ -376,6 +549,11 @@ void eventOS_cancel(arm_event_storage_t *event)
 
     platform_enter_critical();
 
+#ifdef NS_EVENTLOOP_LOCKFREE_SUBMIT
+    /* Move sent events to the queue so they can be removed from it */
+    event_submit_drain_critical();
+#endif
+
     /*
      * Notify timer of cancellation.
      */
@@ -172,4 +172,13 @@
 
 //#define USE_COUNTER_SIGNATURES
 
+//
+//  Size of the static buffer message allocations are taken from, see COSE_Arena_Release().
+//  Allocations that do not fit fall back to the heap, 0 uses the heap only.
+//
+
+#ifndef COSE_ARENA_SIZE
+#define COSE_ARENA_SIZE 1024
+#endif
+
 #endif
@@ -482,6 +482,15 @@ HCOSE COSE_Decode_tiny(const byte * rgbData, size_t cbData, int * ptype, COSE_ob
 bool  COSE_Sign0_map_get_int_tiny(HCOSE_SIGN0 h, int key, int flags, uint8_t **out_map_value, size_t *out_map_value_size, cose_errback * perror);
 #endif
 
+/**
+* Release all message allocations taken from the static arena (COSE_ARENA_SIZE) at once.
+*
+* Objects and buffers of a message are bump allocated from the arena and freeing them is a no-op,
+* the arena space is reused only after this call. Call it once the message has been processed
+* and all its handles freed.
+*/
+void COSE_Arena_Release(void);
+
 
 
 #ifdef __cplusplus
@@ -226,9 +226,16 @@ typedef struct _COSE_COUNTER_SIGN {
 
 
 
+#if COSE_ARENA_SIZE > 0
+extern void * _COSE_Arena_Calloc(size_t count, size_t size);
+extern void _COSE_Arena_Free(void * ptr);
 
+#define COSE_CALLOC(count, size, ctx) _COSE_Arena_Calloc(count, size)
+#define COSE_FREE(ptr) _COSE_Arena_Free(ptr)
+#else
 #define COSE_CALLOC(count, size, ctx) calloc(count, size)
 #define COSE_FREE(ptr) free(ptr)
+#endif
 
 
 #ifndef UNUSED_PARAM
@@ -875,3 +875,51 @@ cose_error _MapFromCBOR(CborError err)
     }
 }
 #endif
+
+#if COSE_ARENA_SIZE > 0
+#define COSE_ARENA_ALIGN sizeof(uint64_t)
+
+static union {
+    uint64_t align;
+    byte buffer[COSE_ARENA_SIZE];
+} arena;
+static size_t arenaUsed = 0;
+
+void * _COSE_Arena_Calloc(size_t count, size_t size)
+{
+    void * p;
+    size_t cb;
+
+    if ((count != 0) && (size > ((size_t)-1) / count)) return NULL;
+    cb = count * size;
+
+    // Does not fit, take the heap instead
+    if ((cb == 0) || (cb > COSE_ARENA_SIZE - arenaUsed)) return calloc(count, size);
+
+    p = &arena.buffer[arenaUsed];
+    memset(p, 0, cb);
+
+    cb = (cb + COSE_ARENA_ALIGN - 1) & ~(COSE_ARENA_ALIGN - 1);
+    arenaUsed = (cb < COSE_ARENA_SIZE - arenaUsed) ? arenaUsed + cb : COSE_ARENA_SIZE;
+    return p;
+}
+
+void _COSE_Arena_Free(void * ptr)
+{
+    // Arena space is reclaimed as a whole in COSE_Arena_Release()
+    if (((byte *)ptr >= arena.buffer) && ((byte *)ptr < arena.buffer + COSE_ARENA_SIZE)) return;
+    free(ptr);
+}
+
+void COSE_Arena_Release(void)
+{
+    arenaUsed = 0;
+}
+
+#else
+
+void COSE_Arena_Release(void)
+{
+}
+
+#endif
@@ -33,7 +33,7 @@ sda_status_internal_e sda_cose_validate_with_raw_pk(const uint8_t *cose_msg, siz
     SDA_ERR_RECOVERABLE_RETURN_IF((pKey == NULL), SDA_STATUS_INTERNAL_INVALID_PARAMETER, "Invalid pKey buffer");
 
     hSign = (HCOSE_SIGN0)COSE_Init_tiny(cose_msg, cose_msg_size, &type, COSE_sign0_object, &cose_error);
-    SDA_ERR_RECOVERABLE_RETURN_IF((!hSign), SDA_STATUS_INTERNAL_COSE_PARSING_ERROR, "COSE_Init failed");
+    SDA_ERR_RECOVERABLE_GOTO_IF((!hSign), sda_status_internal = SDA_STATUS_INTERNAL_COSE_PARSING_ERROR, Exit, "COSE_Init failed");
 
     // Does NULL check for pKey
     status = COSE_Sign0_validate_with_raw_pk_tiny(hSign, pKey, keySize, &cose_error);
@@ -41,6 +41,8 @@ sda_status_internal_e sda_cose_validate_with_raw_pk(const uint8_t *cose_msg, siz
 
 Exit:
     COSE_Sign0_Free(hSign );
+    // The message is done with, its allocations are released together
+    COSE_Arena_Release();
     SDA_LOG_TRACE_FUNC_EXIT_NO_ARGS();
     return sda_status_internal;
 }
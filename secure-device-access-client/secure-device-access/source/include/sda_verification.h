@@ -27,6 +27,14 @@
 extern "C" {
 #endif
 
+/**
+* Number of access tokens whose signature is remembered as verified, 0 disables the cache.
+* A session issues many operations under one token, only the first pays for the signature check.
+*/
+#ifndef SDA_VERIFIED_TOKEN_CACHE_SIZE
+#define SDA_VERIFIED_TOKEN_CACHE_SIZE 4
+#endif
+
 /**
 * Audience types
 */
@@ -82,6 +90,10 @@ sda_status_internal_e sda_operation_bundle_verify(const sda_message_data_s *bund
 */
 sda_status_internal_e sda_audience_verify_tiny(const uint8_t *audience_array_ptr, size_t audience_array_size);
 
+/** Forgets all verified access tokens.
+*/
+void sda_verified_token_cache_clear(void);
+
 extern uint64_t g_saved_nonce;
 
 #ifdef __cplusplus
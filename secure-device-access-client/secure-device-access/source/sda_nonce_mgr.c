@@ -23,125 +23,184 @@
 #include "cs_pal_crypto.h"
 
 /** Self describing nonce structure
-* value - the nonce value
-* age - the age of the nonce ranged [0 .. SDA_CYCLIC_BUFFER_MAX_SIZE] in the insertion
-*       time, 0 means the oldest nonce while SDA_CYCLIC_BUFFER_MAX_SIZE is the youngeset one.
+* value - the nonce value, 0 for a free entry
+* older - index of the next older nonce in the issue order, or of the next free entry
+* younger - index of the next younger nonce in the issue order
 */
 typedef struct {
     uint64_t value;
-    uint8_t age;
+    uint8_t older;
+    uint8_t younger;
 } nonce_s;
 
+// Power of two, at least twice the number of nonces so the probe sequences stay short
+#define SDA_NONCE_INDEX_SIZE         32
+#define SDA_NONCE_INDEX_MASK         (SDA_NONCE_INDEX_SIZE - 1)
+#define SDA_NONCE_NONE               0xFF
+
+#if SDA_NONCE_INDEX_SIZE < 2 * SDA_CYCLIC_BUFFER_MAX_SIZE || SDA_CYCLIC_BUFFER_MAX_SIZE >= SDA_NONCE_NONE
+#error "SDA_NONCE_INDEX_SIZE must be at least twice SDA_CYCLIC_BUFFER_MAX_SIZE"
+#endif
 
 static nonce_s g_nonce_array[SDA_CYCLIC_BUFFER_MAX_SIZE];
 
-#define SDA_NONCE_AGE_YOUNGEST       (SDA_ARRAY_LENGTH(g_nonce_array) - 1)
-#define SDA_NONCE_AGE_OLDEST         (0)
+// Open addressed index from the nonce value to its entry, SDA_NONCE_NONE marks an empty bucket
+static uint8_t g_nonce_index[SDA_NONCE_INDEX_SIZE];
 
+// The oldest and the youngest issued nonce, the entries between them are linked in the issue order
+static uint8_t g_nonce_oldest;
+static uint8_t g_nonce_youngest;
+static uint8_t g_nonce_free;
 
-/** Evacuates an entry in the array.
+/** Gets the home bucket of a nonce value.
+*
+* - The nonces are random, so their low bits are spread well enough.
 */
-static void circ_buf_nonce_clear(nonce_s *element)
+static uint32_t nonce_index_home(uint64_t nonce)
 {
-    SDA_LOG_TRACE_FUNC_ENTER_NO_ARGS();
-
-    element->value = 0;
-    element->age = 0;
-
-    SDA_LOG_TRACE_FUNC_EXIT_NO_ARGS();
+    return (uint32_t)(nonce ^ (nonce >> 32)) & SDA_NONCE_INDEX_MASK;
 }
 
-/** Gets oldest nonce's index in the array.
+/** Finds the bucket holding a nonce value.
+*
+* - Worth case run-time - O(n), expected O(1)
 *
-* - Worth case run-time - O(n)
+* @return the bucket, or SDA_NONCE_NONE if the nonce is not indexed.
 */
-static nonce_s *circ_buf_get_oldest()
+static uint32_t nonce_index_find(uint64_t nonce)
 {
-    int i = 0;
+    uint32_t bucket = nonce_index_home(nonce);
 
-    SDA_LOG_TRACE_FUNC_ENTER_NO_ARGS();
+    while (g_nonce_index[bucket] != SDA_NONCE_NONE) {
+        if (g_nonce_array[g_nonce_index[bucket]].value == nonce) {
+            return bucket;
+        }
+        bucket = (bucket + 1) & SDA_NONCE_INDEX_MASK;
+    }
 
-    while (g_nonce_array[i++].age != SDA_NONCE_AGE_OLDEST);
+    return SDA_NONCE_NONE;
+}
 
-    SDA_LOG_TRACE_FUNC_EXIT_NO_ARGS();
+static void nonce_index_insert(uint64_t nonce, uint8_t entry)
+{
+    uint32_t bucket = nonce_index_home(nonce);
+
+    while (g_nonce_index[bucket] != SDA_NONCE_NONE) {
+        bucket = (bucket + 1) & SDA_NONCE_INDEX_MASK;
+    }
+    g_nonce_index[bucket] = entry;
+}
+
+/** Empties a bucket and moves back the following entries of the probe run,
+* so that lookups need no tombstones.
+*/
+static void nonce_index_remove(uint32_t bucket)
+{
+    uint32_t next = bucket;
+
+    g_nonce_index[bucket] = SDA_NONCE_NONE;
 
-    return &(g_nonce_array[i - 1]);
+    for (;;) {
+        next = (next + 1) & SDA_NONCE_INDEX_MASK;
+        if (g_nonce_index[next] == SDA_NONCE_NONE) {
+            return;
+        }
+        // move the entry to the hole unless its home bucket lies cyclically in (hole, next]
+        uint32_t home = nonce_index_home(g_nonce_array[g_nonce_index[next]].value);
+        if (((next - home) & SDA_NONCE_INDEX_MASK) >= ((next - bucket) & SDA_NONCE_INDEX_MASK)) {
+            g_nonce_index[bucket] = g_nonce_index[next];
+            g_nonce_index[next] = SDA_NONCE_NONE;
+            bucket = next;
+        }
+    }
 }
 
-/** Updates the target index with the new nonce element.
+/** Unlinks an issued nonce from the issue order and returns its entry to the free list.
 *
-* - The new element insert is the youngest one.
-* - It updates all the nonce ages in the array due to
-*   the new element insertion.
-* - Worth case run-time - O(n)
+* - Worth case run-time - O(1)
 */
-static void circ_buf_update_ages(nonce_s *new, uint64_t nonce_new_value)
+static void circ_buf_nonce_clear(uint8_t entry)
 {
-    uint32_t i;
+    nonce_s *element = &g_nonce_array[entry];
 
     SDA_LOG_TRACE_FUNC_ENTER_NO_ARGS();
 
-    // traverse array and update age individually (if necessary)
-    for (i = 0; i < SDA_ARRAY_LENGTH(g_nonce_array); i++) {
-        if (g_nonce_array[i].age > new->age) {
-            g_nonce_array[i].age--;
-        }
+    if (element->older != SDA_NONCE_NONE) {
+        g_nonce_array[element->older].younger = element->younger;
+    } else {
+        g_nonce_oldest = element->younger;
+    }
+    if (element->younger != SDA_NONCE_NONE) {
+        g_nonce_array[element->younger].older = element->older;
+    } else {
+        g_nonce_youngest = element->older;
     }
 
-    // update array with the new one (value, age)
-    new->value = nonce_new_value;
-    new->age = SDA_NONCE_AGE_YOUNGEST;
+    element->value = 0;
+    element->younger = SDA_NONCE_NONE;
+    element->older = g_nonce_free;
+    g_nonce_free = entry;
 
     SDA_LOG_TRACE_FUNC_EXIT_NO_ARGS();
 }
 
 void circ_buf_insert(uint64_t nonce_value)
 {
-    nonce_s *nonce_new_p = NULL;
-
-    // traverse the circular buffer perhaps
-    // someone request his nonce value and
-    // free up some space
-    uint32_t i;
+    uint8_t entry;
+    nonce_s *element;
 
     SDA_LOG_TRACE_FUNC_ENTER_NO_ARGS();
 
-    for (i = 0; i < SDA_ARRAY_LENGTH(g_nonce_array); i++) {
-        if (g_nonce_array[i].value == 0) {
-            nonce_new_p = &g_nonce_array[i];
-            break;
-        }
+    if (g_nonce_free == SDA_NONCE_NONE) {
+        // the buffer is full, we have no option
+        // but dropping the oldest nonce from the array.
+        nonce_index_remove(nonce_index_find(g_nonce_array[g_nonce_oldest].value));
+        circ_buf_nonce_clear(g_nonce_oldest);
     }
 
-    if (nonce_new_p == NULL) {
-        // no.. buffer is still full, we have no option
-        // but dropping the oldest nonce from the array.
-        nonce_new_p = circ_buf_get_oldest();
+    entry = g_nonce_free;
+    element = &g_nonce_array[entry];
+    g_nonce_free = element->older;
+
+    // the new nonce is the youngest one
+    element->value = nonce_value;
+    element->older = g_nonce_youngest;
+    element->younger = SDA_NONCE_NONE;
+    if (g_nonce_youngest != SDA_NONCE_NONE) {
+        g_nonce_array[g_nonce_youngest].younger = entry;
+    } else {
+        g_nonce_oldest = entry;
     }
+    g_nonce_youngest = entry;
 
-    circ_buf_update_ages(nonce_new_p, nonce_value);
+    nonce_index_insert(nonce_value, entry);
 
     SDA_LOG_TRACE_FUNC_EXIT_NO_ARGS();
 }
 
 static bool circ_buf_delete(uint64_t nonce)
 {
-    uint32_t i;
+    uint32_t bucket;
+    uint8_t entry;
 
     SDA_LOG_TRACE_FUNC_ENTER_NO_ARGS();
 
-    for (i = 0; i < SDA_ARRAY_LENGTH(g_nonce_array); i++) {
-        if (g_nonce_array[i].value == nonce) {
-            // found it, remove from array
-            circ_buf_nonce_clear(&(g_nonce_array[i]));
-            return true;
-        }
+    // 0 marks a free entry and is never issued
+    bucket = (nonce != 0) ? nonce_index_find(nonce) : SDA_NONCE_NONE;
+    if (bucket == SDA_NONCE_NONE) {
+        SDA_LOG_TRACE_FUNC_EXIT("status=false");
+
+        // failed to find the target nonce value
+        return false;
     }
 
-    SDA_LOG_TRACE_FUNC_EXIT("status=false");
+    // found it, remove from array
+    entry = g_nonce_index[bucket];
+    nonce_index_remove(bucket);
+    circ_buf_nonce_clear(entry);
 
-    // failed to find the target nonce value
-    return false;
+    SDA_LOG_TRACE_FUNC_EXIT_NO_ARGS();
+    return true;
 }
 
 sda_status_internal_e sda_nonce_init(void)
@@ -150,10 +209,19 @@ sda_status_internal_e sda_nonce_init(void)
 
     SDA_LOG_TRACE_FUNC_ENTER_NO_ARGS();
 
+    // chain all the entries into the free list
     for (i = 0; i < SDA_ARRAY_LENGTH(g_nonce_array); i++) {
         g_nonce_array[i].value = 0;
-        g_nonce_array[i].age = SDA_NONCE_AGE_OLDEST;
+        g_nonce_array[i].older = (uint8_t)(i + 1 < SDA_ARRAY_LENGTH(g_nonce_array) ? i + 1 : SDA_NONCE_NONE);
+        g_nonce_array[i].younger = SDA_NONCE_NONE;
     }
+    for (i = 0; i < SDA_ARRAY_LENGTH(g_nonce_index); i++) {
+        g_nonce_index[i] = SDA_NONCE_NONE;
+    }
+
+    g_nonce_oldest = SDA_NONCE_NONE;
+    g_nonce_youngest = SDA_NONCE_NONE;
+    g_nonce_free = 0;
 
     SDA_LOG_TRACE_FUNC_EXIT_NO_ARGS();
     return SDA_STATUS_INTERNAL_SUCCESS;
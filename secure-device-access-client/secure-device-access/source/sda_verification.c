@@ -27,11 +27,84 @@
 #include "sda_nonce_mgr.h"
 #include "key_config_manager.h"
 #include "fcc_defs.h"
+#include "cs_hash.h"
 
 #define SDA_GARCE_TIME_PERIOD 300 //cwt parameters - "nbf" and "exp" should be verified with a grace period of 5 minutes(to allow for small clock drift between device and AS)
 
 const char g_device_id_parameter_name[] = "mbed.InternalEndpoint";
 
+#if SDA_VERIFIED_TOKEN_CACHE_SIZE > 0
+/**
+* An access token whose signature was verified. The token is identified by its hash and
+* the trust anchor it was verified with, so a replaced trust anchor invalidates the entry.
+*/
+typedef struct sda_verified_token_ {
+    uint8_t token_hash[PAL_SHA256_SIZE];
+    uint8_t trust_anchor[KCM_EC_SECP256R1_MAX_PUB_KEY_RAW_SIZE];
+    size_t trust_anchor_size;
+    uint64_t exp;
+    uint32_t last_used; // 0 for a free entry
+} sda_verified_token_s;
+
+static sda_verified_token_s g_verified_tokens[SDA_VERIFIED_TOKEN_CACHE_SIZE];
+static uint32_t g_verified_token_clock;
+
+/* Looks for a verified token, dropping the entries that have expired on the way.
+*/
+static bool sda_verified_token_find(const uint8_t *token_hash, const uint8_t *trust_anchor, size_t trust_anchor_size)
+{
+    uint64_t current_time = pal_osGetTime();
+    bool found = false;
+
+    for (int i = 0; i < SDA_VERIFIED_TOKEN_CACHE_SIZE; i++) {
+        sda_verified_token_s *entry = &g_verified_tokens[i];
+        if (entry->last_used == 0) {
+            continue;
+        }
+        if (current_time != 0 && entry->exp + SDA_GARCE_TIME_PERIOD < current_time) {
+            memset(entry, 0, sizeof(*entry));
+            continue;
+        }
+        if (memcmp(entry->token_hash, token_hash, PAL_SHA256_SIZE) == 0 &&
+                entry->trust_anchor_size == trust_anchor_size &&
+                memcmp(entry->trust_anchor, trust_anchor, trust_anchor_size) == 0) {
+            entry->last_used = ++g_verified_token_clock;
+            found = true;
+        }
+    }
+    return found;
+}
+
+/* Remembers a verified token in a free entry, or in place of the least recently used one.
+*/
+static void sda_verified_token_add(const uint8_t *token_hash, const uint8_t *trust_anchor, size_t trust_anchor_size, uint64_t exp)
+{
+    sda_verified_token_s *entry = &g_verified_tokens[0];
+
+    for (int i = 1; i < SDA_VERIFIED_TOKEN_CACHE_SIZE && entry->last_used != 0; i++) {
+        if (g_verified_tokens[i].last_used < entry->last_used) {
+            entry = &g_verified_tokens[i];
+        }
+    }
+
+    memcpy(entry->token_hash, token_hash, PAL_SHA256_SIZE);
+    memcpy(entry->trust_anchor, trust_anchor, trust_anchor_size);
+    entry->trust_anchor_size = trust_anchor_size;
+    entry->exp = exp;
+    entry->last_used = ++g_verified_token_clock;
+}
+
+void sda_verified_token_cache_clear(void)
+{
+    memset(g_verified_tokens, 0, sizeof(g_verified_tokens));
+    g_verified_token_clock = 0;
+}
+#else
+void sda_verified_token_cache_clear(void)
+{
+}
+#endif // SDA_VERIFIED_TOKEN_CACHE_SIZE > 0
+
 /* The function checks audience type and returns its data and type.
 *  In case the function failed to detect audience type its return an error.
 */
@@ -266,6 +339,10 @@ sda_status_internal_e sda_operation_bundle_verify(const sda_message_data_s *bund
     bool success;
     uint8_t *trust_anchor_name;
     size_t trust_anchor_name_size;
+#if SDA_VERIFIED_TOKEN_CACHE_SIZE > 0
+    uint8_t token_hash[PAL_SHA256_SIZE];
+    bool token_hashed;
+#endif
 
     SDA_LOG_TRACE_FUNC_ENTER_NO_ARGS();
 
@@ -289,11 +366,27 @@ sda_status_internal_e sda_operation_bundle_verify(const sda_message_data_s *bund
     sda_status_internal = sda_trust_anchor_get(trust_anchor_name, trust_anchor_name_size, raw_trust_anchor, sizeof(raw_trust_anchor), &trust_anchor_size);
     SDA_ERR_RECOVERABLE_RETURN_IF((sda_status_internal != SDA_STATUS_INTERNAL_SUCCESS), sda_status_internal, "Failed to get Trust Anchor");
 
-    //Validate access token signature against trust anchor public key
-    sda_status_internal = sda_cose_validate_with_raw_pk(bundle_data->access_token.data_buffer_ptr, bundle_data->access_token.data_buffer_size, raw_trust_anchor, trust_anchor_size);
-    SDA_DEMO_CHECK_ERROR((sda_status_internal != SDA_STATUS_INTERNAL_SUCCESS), "Failed to validate Access Token");
-    SDA_ERR_RECOVERABLE_RETURN_IF((sda_status_internal != SDA_STATUS_INTERNAL_SUCCESS), SDA_STATUS_INTERNAL_TOKEN_VERIFICATION_ERROR, "Failed to validate Access Token");
-    SDA_LOG_DEMO_INFO("Access Token verified successfully");
+#if SDA_VERIFIED_TOKEN_CACHE_SIZE > 0
+    // Signature of a token already verified with this trust anchor need not be checked again.
+    // If hashing fails, the token is just verified in full.
+    token_hashed = (cs_hash(CS_SHA256, bundle_data->access_token.data_buffer_ptr, bundle_data->access_token.data_buffer_size,
+                            token_hash, sizeof(token_hash)) == KCM_STATUS_SUCCESS);
+    if (token_hashed && sda_verified_token_find(token_hash, raw_trust_anchor, trust_anchor_size)) {
+        SDA_LOG_DEMO_INFO("Access Token verified earlier");
+    } else
+#endif
+    {
+        //Validate access token signature against trust anchor public key
+        sda_status_internal = sda_cose_validate_with_raw_pk(bundle_data->access_token.data_buffer_ptr, bundle_data->access_token.data_buffer_size, raw_trust_anchor, trust_anchor_size);
+        SDA_DEMO_CHECK_ERROR((sda_status_internal != SDA_STATUS_INTERNAL_SUCCESS), "Failed to validate Access Token");
+        SDA_ERR_RECOVERABLE_RETURN_IF((sda_status_internal != SDA_STATUS_INTERNAL_SUCCESS), SDA_STATUS_INTERNAL_TOKEN_VERIFICATION_ERROR, "Failed to validate Access Token");
+        SDA_LOG_DEMO_INFO("Access Token verified successfully");
+#if SDA_VERIFIED_TOKEN_CACHE_SIZE > 0
+        if (token_hashed) {
+            sda_verified_token_add(token_hash, raw_trust_anchor, trust_anchor_size, bundle_data->claims.exp);
+        }
+#endif
+    }
 
     // Now we validate the main operation bundle signature against POP public key from the access token
     sda_status_internal = sda_cose_validate_with_raw_pk(bundle_data->main_signed_operation_bundle.data_buffer_ptr, bundle_data->main_signed_operation_bundle.data_buffer_size, bundle_data->claims.pk, (bundle_data->claims).pk_size);
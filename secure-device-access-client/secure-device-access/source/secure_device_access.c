@@ -80,6 +80,7 @@ sda_status_e sda_init(void)
     if (!g_sda_initialized) {
 
         sda_status_internal = sda_nonce_init();
+        sda_verified_token_cache_clear();
 
         // kcm_init also initializes PAL
         if (kcm_init() != KCM_STATUS_SUCCESS) {
@@ -107,6 +108,7 @@ sda_status_e sda_finalize(void)
 
     if (g_sda_initialized) {
         sda_status_internal = sda_nonce_fini();
+        sda_verified_token_cache_clear();
 
         // kcm_init also initializes PAL
         if (kcm_finalize() != KCM_STATUS_SUCCESS) {
@@ -17,51 +17,175 @@
 // ----------------------------------------------------------------------------
 
 #include <stdint.h>
-#include "pal.h"
-#include "cs_pal_crypto.h"
+#include <string.h>
+#include "CertificateParser.h"
 #include "mbed-trace/mbed_trace.h"
 
 #define TRACE_GROUP "mClt"
 
-bool extract_field_from_certificate(const uint8_t* cer, size_t cer_len, const char *field, char* value)
+#define DER_TAG_SEQUENCE            0x30
+#define DER_TAG_SET                 0x31
+#define DER_TAG_OID                 0x06
+#define DER_TAG_CONTEXT_0           0xA0
+
+// Attribute type OIDs, 2.5.4.x
+static const uint8_t oid_attribute_prefix[] = { 0x55, 0x04 };
+#define OID_ATTRIBUTE_CN            0x03
+#define OID_ATTRIBUTE_L             0x07
+
+/*
+ * Reads the tag and length of the DER element at *pos and moves *pos to its content.
+ * Returns the content length, or -1 if the element does not fit before end.
+ */
+static int32_t der_read_header(const uint8_t **pos, const uint8_t *end, uint8_t *tag)
+{
+    const uint8_t *p = *pos;
+    size_t len;
+
+    if (end - p < 2) {
+        return -1;
+    }
+    *tag = *p++;
+    len = *p++;
+    if (len & 0x80) {
+        uint8_t octets = len & 0x7F;
+        if (octets == 0 || octets > 3 || end - p < octets) {
+            return -1;
+        }
+        len = 0;
+        while (octets--) {
+            len = (len << 8) | *p++;
+        }
+    }
+    if ((size_t)(end - p) < len) {
+        return -1;
+    }
+    *pos = p;
+    return (int32_t)len;
+}
+
+// Moves *pos to the content of the next element, which must have the given tag
+static int32_t der_enter(const uint8_t **pos, const uint8_t *end, uint8_t expected_tag)
+{
+    uint8_t tag;
+    int32_t len = der_read_header(pos, end, &tag);
+    return (tag == expected_tag) ? len : -1;
+}
+
+// Moves *pos past the next element
+static bool der_skip(const uint8_t **pos, const uint8_t *end)
+{
+    uint8_t tag;
+    int32_t len = der_read_header(pos, end, &tag);
+    if (len < 0) {
+        return false;
+    }
+    *pos += len;
+    return true;
+}
+
+static bool copy_field_value(const uint8_t *value, int32_t value_len, char *output)
 {
-#if 1 // TODO : Uncomment once PAL has feature to extract "L" from certificate
-    tr_debug("extract_field_from_certificate");
-
-    palX509Attr_t attr = PAL_X509_L_ATTR;
-    if (strcmp(field,"CN") == 0) {
-        attr = PAL_X509_CN_ATTR;
-    } else if (strcmp(field,"L") == 0) {
-        attr = PAL_X509_L_ATTR;
-    } else {
+    if (value_len >= CERTIFICATE_FIELD_MAX_SIZE) {
+        tr_error("extract_fields_from_certificate - field too long: %d", (int)value_len);
         return false;
     }
+    memcpy(output, value, value_len);
+    output[value_len] = '\0';
+    return true;
+}
+
+bool extract_fields_from_certificate(const uint8_t* cer, size_t cer_len, char *common_name, char *locality)
+{
+    const uint8_t *pos = cer;
+    const uint8_t *end = cer + cer_len;
+    int32_t len;
+
+    tr_debug("extract_fields_from_certificate");
 
-    palX509Handle_t cert = 0;
-    size_t len = 0;
-    palStatus_t ret = pal_x509Initiate(&cert);
-    if (ret != PAL_SUCCESS) {
-        tr_error("extract_field_from_certificate - cert init failed: %d", (int)ret);
-        pal_x509Free(&cert);
+    if (common_name) {
+        common_name[0] = '\0';
+    }
+    if (locality) {
+        locality[0] = '\0';
+    }
+
+    // Certificate and TBSCertificate
+    if (der_enter(&pos, end, DER_TAG_SEQUENCE) < 0 ||
+        (len = der_enter(&pos, end, DER_TAG_SEQUENCE)) < 0) {
+        tr_error("extract_fields_from_certificate - invalid certificate");
         return false;
     }
-    ret = pal_x509CertParse(cert, cer, cer_len);
-    if (ret != PAL_SUCCESS) {
-        tr_error("extract_field_from_certificate - cert parse failed: %d", (int)ret);
-        pal_x509Free(&cert);
+    end = pos + len;
+
+    // Optional version, then serial number, signature algorithm, issuer and validity
+    if (end - pos > 0 && *pos == DER_TAG_CONTEXT_0 && !der_skip(&pos, end)) {
         return false;
-    }    
-    ret = pal_x509CertGetAttribute(cert, attr, value, 65, &len);
-    if (ret != PAL_SUCCESS) {
-        tr_error("extract_field_from_certificate - cert attr get failed: %d", (int)ret);
-        pal_x509Free(&cert);
+    }
+    for (int i = 0; i < 4; i++) {
+        if (!der_skip(&pos, end)) {
+            tr_error("extract_fields_from_certificate - invalid certificate");
+            return false;
+        }
+    }
+
+    // Subject is a sequence of RDN sets, each holding attribute type and value pairs.
+    // Only the first occurrence of an attribute is taken.
+    len = der_enter(&pos, end, DER_TAG_SEQUENCE);
+    if (len < 0) {
+        tr_error("extract_fields_from_certificate - invalid subject");
         return false;
     }
-    pal_x509Free(&cert);
+    const uint8_t *subject_end = pos + len;
+    while (pos < subject_end) {
+        len = der_enter(&pos, subject_end, DER_TAG_SET);
+        if (len < 0) {
+            return false;
+        }
+        const uint8_t *set_end = pos + len;
+        while (pos < set_end) {
+            len = der_enter(&pos, set_end, DER_TAG_SEQUENCE);
+            if (len < 0) {
+                return false;
+            }
+            const uint8_t *attribute_end = pos + len;
+            int32_t oid_len = der_enter(&pos, attribute_end, DER_TAG_OID);
+            if (oid_len < 0) {
+                return false;
+            }
+            const uint8_t *oid = pos;
+            pos += oid_len;
+            uint8_t tag;
+            int32_t value_len = der_read_header(&pos, attribute_end, &tag);
+            if (value_len < 0) {
+                return false;
+            }
+
+            if (oid_len == sizeof(oid_attribute_prefix) + 1 &&
+                memcmp(oid, oid_attribute_prefix, sizeof(oid_attribute_prefix)) == 0) {
+                char *output = NULL;
+                if (oid[2] == OID_ATTRIBUTE_CN) {
+                    output = common_name;
+                } else if (oid[2] == OID_ATTRIBUTE_L) {
+                    output = locality;
+                }
+                if (output && output[0] == '\0' && !copy_field_value(pos, value_len, output)) {
+                    return false;
+                }
+            }
+            pos = attribute_end;
+        }
+    }
     return true;
-#else
-    return false;
-#endif
 }
 
-
+bool extract_field_from_certificate(const uint8_t* cer, size_t cer_len, const char *field, char* value)
+{
+    bool found = false;
+    if (strcmp(field, "CN") == 0) {
+        found = extract_fields_from_certificate(cer, cer_len, value, NULL);
+    } else if (strcmp(field, "L") == 0) {
+        found = extract_fields_from_certificate(cer, cer_len, NULL, value);
+    }
+    return found && value[0] != '\0';
+}
@@ -17,18 +17,134 @@
 // ----------------------------------------------------------------------------
 
 #include <string.h>
+#include <stdlib.h>
 #include <assert.h>
 #include "key_config_manager.h"
 #include "CloudClientStorage.h"
 #include "mbed-trace/mbed_trace.h"
 #include "mbed-client-libservice/common_functions.h"
+#include "mbed-cloud-client/PerfCounters.h"
 
 #define TRACE_GROUP "mClt"
 
+/*
+ * Read-through cache of configuration items. Endpoint name, server URIs, account ID and
+ * the device object values are read several times on every start and re-registration,
+ * each read costing a storage lookup and, with secure storage, a decryption. Keys and
+ * certificates are never cached. Items written or deleted through this API invalidate
+ * their cache entry, items changed directly through KCM require ccs_cache_clear().
+ */
+#ifdef MBED_CONF_MBED_CLOUD_CLIENT_CCS_CACHE_ENTRIES
+#define CCS_CACHE_ENTRIES MBED_CONF_MBED_CLOUD_CLIENT_CCS_CACHE_ENTRIES
+#endif
+
+#ifndef CCS_CACHE_ENTRIES
+#define CCS_CACHE_ENTRIES 8
+#endif
+
+// Larger items are always read from storage
+#ifndef CCS_CACHE_MAX_ITEM_SIZE
+#define CCS_CACHE_MAX_ITEM_SIZE 256
+#endif
+
+#if CCS_CACHE_ENTRIES > 0
+
+typedef struct ccs_cache_entry_s {
+    char        *key;           // NULL if the entry is free
+    uint8_t     *value;
+    size_t      value_length;
+    uint32_t    last_used;
+} ccs_cache_entry_s;
+
+static ccs_cache_entry_s ccs_cache[CCS_CACHE_ENTRIES];
+static uint32_t ccs_cache_clock;
+
+static void ccs_cache_free_entry(ccs_cache_entry_s *entry)
+{
+    if (entry->key) {
+        // Values may be secrets, such as the update PSK, so they do not linger in freed heap
+        memset(entry->value, 0, entry->value_length);
+        free(entry->key);
+        free(entry->value);
+        memset(entry, 0, sizeof(*entry));
+    }
+}
+
+static ccs_cache_entry_s *ccs_cache_find(const char *key)
+{
+    for (int i = 0; i < CCS_CACHE_ENTRIES; i++) {
+        if (ccs_cache[i].key && strcmp(ccs_cache[i].key, key) == 0) {
+            ccs_cache[i].last_used = ++ccs_cache_clock;
+            return &ccs_cache[i];
+        }
+    }
+    return NULL;
+}
+
+static void ccs_cache_invalidate(const char *key, ccs_item_type_e item_type)
+{
+    if (item_type == CCS_CONFIG_ITEM) {
+        ccs_cache_entry_s *entry = ccs_cache_find(key);
+        if (entry) {
+            ccs_cache_free_entry(entry);
+        }
+    }
+}
+
+static void ccs_cache_add(const char *key, const uint8_t *value, size_t value_length)
+{
+    if (value_length == 0 || value_length > CCS_CACHE_MAX_ITEM_SIZE) {
+        return;
+    }
+
+    // Take a free entry, or the least recently used one
+    ccs_cache_entry_s *entry = &ccs_cache[0];
+    for (int i = 0; i < CCS_CACHE_ENTRIES && entry->key; i++) {
+        if (!ccs_cache[i].key || ccs_cache[i].last_used < entry->last_used) {
+            entry = &ccs_cache[i];
+        }
+    }
+    ccs_cache_free_entry(entry);
+
+    size_t key_length = strlen(key) + 1;
+    entry->key = (char *)malloc(key_length);
+    entry->value = (uint8_t *)malloc(value_length);
+    if (!entry->key || !entry->value) {
+        // Caching is best effort
+        free(entry->key);
+        free(entry->value);
+        memset(entry, 0, sizeof(*entry));
+        return;
+    }
+    memcpy(entry->key, key, key_length);
+    memcpy(entry->value, value, value_length);
+    entry->value_length = value_length;
+    entry->last_used = ++ccs_cache_clock;
+}
+
+void ccs_cache_clear(void)
+{
+    for (int i = 0; i < CCS_CACHE_ENTRIES; i++) {
+        ccs_cache_free_entry(&ccs_cache[i]);
+    }
+}
+
+#else
+
+#define ccs_cache_invalidate(key, item_type)
+
+void ccs_cache_clear(void)
+{
+}
+
+#endif // CCS_CACHE_ENTRIES > 0
+
 ccs_status_e uninitialize_storage(void)
 {
     tr_debug("CloudClientStorage::uninitialize_storage");
 
+    ccs_cache_clear();
+
     kcm_status_e status = kcm_finalize();
     if(status != KCM_STATUS_SUCCESS) {
         tr_error("CloudClientStorage::uninitialize_storage - error %d", status);
@@ -40,6 +156,9 @@ ccs_status_e uninitialize_storage(void)
 ccs_status_e initialize_storage(void)
 {
     tr_debug("CloudClientStorage::initialize_storage");
+
+    // Items may have been changed directly through KCM, for example by a factory reset
+    ccs_cache_clear();
     kcm_status_e status = kcm_init();
     if(status != KCM_STATUS_SUCCESS) {
         tr_error("CloudClientStorage::::initialize_storage - error %d", status);
@@ -85,6 +204,8 @@ ccs_status_e ccs_delete_item(const char* key, ccs_item_type_e item_type)
         return CCS_STATUS_ERROR;
     }
 
+    ccs_cache_invalidate(key, item_type);
+
     ccs_status_e status = ccs_check_item(key, item_type);
     if (status == CCS_STATUS_KEY_DOESNT_EXIST) {
         // No need to call delete as item does not exist.
@@ -116,6 +237,16 @@ ccs_status_e ccs_item_size(const char* key, size_t* size_out, ccs_item_type_e it
     }
 
     tr_debug("CloudClientStorage::ccs_item_size [%s], item [%d]", key, item_type);
+
+#if CCS_CACHE_ENTRIES > 0
+    if (item_type == CCS_CONFIG_ITEM) {
+        const ccs_cache_entry_s *entry = ccs_cache_find(key);
+        if (entry) {
+            *size_out = entry->value_length;
+            return CCS_STATUS_SUCCESS;
+        }
+    }
+#endif
 #ifdef MBED_CONF_MBED_CLOUD_CLIENT_PSA_SUPPORT
     kcm_key_handle_t key_h;
 #endif
@@ -172,6 +303,19 @@ ccs_status_e ccs_get_item(const char* key,
 
     tr_debug("CloudClientStorage::ccs_get_item [%s], type [%d]", key, item_type);
 
+#if CCS_CACHE_ENTRIES > 0
+    if (item_type == CCS_CONFIG_ITEM) {
+        const ccs_cache_entry_s *entry = ccs_cache_find(key);
+        // A too small buffer is left for KCM to report
+        if (entry && entry->value_length <= buffer_size) {
+            memcpy(buffer, entry->value, entry->value_length);
+            *value_length = entry->value_length;
+            PERF_COUNTER_ADD(STORAGE_CACHE_HITS, 1);
+            return CCS_STATUS_SUCCESS;
+        }
+    }
+#endif
+
 #ifdef MBED_CONF_MBED_CLOUD_CLIENT_PSA_SUPPORT
     // If private key - get PSA key handle from KCM
     if (item_type == CCS_PRIVATE_KEY_ITEM) {
@@ -193,6 +337,7 @@ ccs_status_e ccs_get_item(const char* key,
         }
     } else {
 #endif
+        PERF_COUNTER_ADD(STORAGE_READS, 1);
         kcm_status = kcm_item_get_data((const uint8_t*)key,
                                        strlen(key),
                                        (kcm_item_type_e)item_type,
@@ -211,6 +356,12 @@ ccs_status_e ccs_get_item(const char* key,
         return CCS_STATUS_ERROR;
     }
 
+#if CCS_CACHE_ENTRIES > 0
+    if (item_type == CCS_CONFIG_ITEM) {
+        ccs_cache_add(key, buffer, *value_length);
+    }
+#endif
+
     return CCS_STATUS_SUCCESS;
 }
 
@@ -226,6 +377,8 @@ ccs_status_e ccs_set_item(const char* key,
 
     tr_debug("CloudClientStorage::ccs_set_item kcm [%s], type [%d]", key, item_type);
 
+    ccs_cache_invalidate(key, item_type);
+
     kcm_status_e kcm_status = kcm_item_store((const uint8_t*)key,
                                  strlen(key),
                                  (kcm_item_type_e)item_type,
@@ -37,6 +37,7 @@
 #include "include/ConnectorClient.h"
 #include "include/CloudClientStorage.h"
 #include "include/CertificateParser.h"
+#include "mbed-cloud-client/SpanTrace.h"
 
 #ifndef MBED_CLIENT_DISABLE_EST_FEATURE
 #include "include/EstClient.h"
@@ -72,9 +73,149 @@ class EventData {
 
 };
 
+#if MBED_CLIENT_LWM2M_SEND_SAMPLES
+// LwM2M Send samples not yet delivered are kept in the KCM storage over a reset
+static size_t load_send_samples(uint8_t *buffer, size_t buffer_size, void */*context*/)
+{
+    size_t value_length = 0;
+    if (ccs_get_item(KEY_SEND_SAMPLES, buffer, buffer_size, &value_length, CCS_CONFIG_ITEM) != CCS_STATUS_SUCCESS) {
+        return 0;
+    }
+    return value_length;
+}
+
+static bool save_send_samples(const uint8_t *buffer, size_t buffer_size, void */*context*/)
+{
+    ccs_delete_item(KEY_SEND_SAMPLES, CCS_CONFIG_ITEM);
+    if (!buffer_size) {
+        return true;
+    }
+    return ccs_set_item(KEY_SEND_SAMPLES, buffer, buffer_size, CCS_CONFIG_ITEM) == CCS_STATUS_SUCCESS;
+}
+#endif // MBED_CLIENT_LWM2M_SEND_SAMPLES
+
+#if MBED_CLIENT_REGISTRATION_RESUME
+// Registration is kept in the KCM storage over a reset, next to the DTLS session stored by PAL
+static size_t load_registration(uint8_t *buffer, size_t buffer_size, void */*context*/)
+{
+    size_t value_length = 0;
+    if (ccs_get_item(KEY_REGISTRATION, buffer, buffer_size, &value_length, CCS_CONFIG_ITEM) != CCS_STATUS_SUCCESS) {
+        return 0;
+    }
+    return value_length;
+}
+
+static bool save_registration(const uint8_t *buffer, size_t buffer_size, void */*context*/)
+{
+    ccs_delete_item(KEY_REGISTRATION, CCS_CONFIG_ITEM);
+    if (!buffer_size) {
+        return true;
+    }
+    return ccs_set_item(KEY_REGISTRATION, buffer, buffer_size, CCS_CONFIG_ITEM) == CCS_STATUS_SUCCESS;
+}
+#endif // MBED_CLIENT_REGISTRATION_RESUME
+
+#if MBED_CLIENT_DEFERRED_BOOTSTRAP_WRITES && defined(MBED_CONF_MBED_CLIENT_DISABLE_BOOTSTRAP_FEATURE)
+// Nothing to defer without bootstrap
+#undef MBED_CLIENT_DEFERRED_BOOTSTRAP_WRITES
+#define MBED_CLIENT_DEFERRED_BOOTSTRAP_WRITES 0
+#endif
+
+#if MBED_CLIENT_DEFERRED_BOOTSTRAP_WRITES
+// Security object items written during bootstrap, stored on Bootstrap-Finish
+struct bootstrap_item_s {
+    bootstrap_item_s    *next;
+    const char          *key;           // One of the g_fcc_* names
+    ccs_item_type_e     type;
+    uint8_t             *data;
+    size_t              size;
+};
+
+static bootstrap_item_s *bootstrap_items = NULL;
+static bool bootstrap_staging = false;
+
+static bootstrap_item_s *find_bootstrap_item(const char *key)
+{
+    for (bootstrap_item_s *item = bootstrap_items; item; item = item->next) {
+        if (strcmp(item->key, key) == 0) {
+            return item;
+        }
+    }
+    return NULL;
+}
+
+static void discard_bootstrap_items()
+{
+    while (bootstrap_items) {
+        bootstrap_item_s *item = bootstrap_items;
+        bootstrap_items = item->next;
+        free(item->data);
+        free(item);
+    }
+    bootstrap_staging = false;
+}
+
+static ccs_status_e stage_bootstrap_item(const char *key, const uint8_t *buffer, size_t buffer_size, ccs_item_type_e type)
+{
+    uint8_t *data = (uint8_t *)malloc(buffer_size ? buffer_size : 1);
+    if (!data) {
+        return CCS_STATUS_MEMORY_ERROR;
+    }
+    memcpy(data, buffer, buffer_size);
+
+    bootstrap_item_s *item = find_bootstrap_item(key);
+    if (item) {
+        free(item->data);
+    } else {
+        item = (bootstrap_item_s *)malloc(sizeof(bootstrap_item_s));
+        if (!item) {
+            free(data);
+            return CCS_STATUS_MEMORY_ERROR;
+        }
+        item->key = key;
+        item->next = bootstrap_items;
+        bootstrap_items = item;
+    }
+    item->type = type;
+    item->data = data;
+    item->size = buffer_size;
+    return CCS_STATUS_SUCCESS;
+}
+
+// Stores the staged items in one pass and stops staging, the items are freed also on failure
+static ccs_status_e commit_bootstrap_items()
+{
+    ccs_status_e status = CCS_STATUS_SUCCESS;
+    for (bootstrap_item_s *item = bootstrap_items; item && status == CCS_STATUS_SUCCESS; item = item->next) {
+        ccs_delete_item(item->key, item->type);
+        status = ccs_set_item(item->key, item->data, item->size, item->type);
+    }
+    discard_bootstrap_items();
+    return status;
+}
+#endif // MBED_CLIENT_DEFERRED_BOOTSTRAP_WRITES
+
+static ccs_status_e store_security_item(const char *key, const uint8_t *buffer, size_t buffer_size, ccs_item_type_e type)
+{
+#if MBED_CLIENT_DEFERRED_BOOTSTRAP_WRITES
+    if (bootstrap_staging) {
+        return stage_bootstrap_item(key, buffer, buffer_size, type);
+    }
+#endif
+    ccs_delete_item(key, type);
+    return ccs_set_item(key, buffer, buffer_size, type);
+}
+
 static int read_size_callback_helper(const char *key, size_t &buffer_len)
 {
     buffer_len = 0;
+#if MBED_CLIENT_DEFERRED_BOOTSTRAP_WRITES
+    const bootstrap_item_s *item = find_bootstrap_item(key);
+    if (item) {
+        buffer_len = item->size;
+        return CCS_STATUS_SUCCESS;
+    }
+#endif
     if (strcmp(key, g_fcc_lwm2m_device_private_key_name) == 0 ||
             strcmp(key, g_fcc_bootstrap_device_private_key_name) == 0) {
         if (ccs_item_size(key, &buffer_len, CCS_PRIVATE_KEY_ITEM) != CCS_STATUS_SUCCESS) {
@@ -93,6 +234,18 @@ static int read_callback_helper(const char *key, void *buffer, size_t &buffer_le
 {
     size_t cert_size = 0;
 
+#if MBED_CLIENT_DEFERRED_BOOTSTRAP_WRITES
+    const bootstrap_item_s *item = find_bootstrap_item(key);
+    if (item) {
+        if (item->size > buffer_len) {
+            return CCS_STATUS_ERROR;
+        }
+        memcpy(buffer, item->data, item->size);
+        buffer_len = item->size;
+        return CCS_STATUS_SUCCESS;
+    }
+#endif
+
     if (strcmp(key, g_fcc_lwm2m_device_private_key_name) == 0 ||
             strcmp(key, g_fcc_bootstrap_device_private_key_name) == 0) {
         if (ccs_get_item(key, (uint8_t *)buffer, buffer_len, &cert_size, CCS_PRIVATE_KEY_ITEM) != CCS_STATUS_SUCCESS) {
@@ -120,31 +273,25 @@ static bool write_security_object_data_to_kcm(const M2MResourceBase &resource, c
     switch (resource_id) {
         case M2MSecurity::PublicKey:
             if (object_instance_id == M2MSecurity::Bootstrap) {
-                ccs_delete_item(g_fcc_bootstrap_device_certificate_name, CCS_CERTIFICATE_ITEM);
-                status = ccs_set_item(g_fcc_bootstrap_device_certificate_name, buffer, buffer_size, CCS_CERTIFICATE_ITEM);
+                status = store_security_item(g_fcc_bootstrap_device_certificate_name, buffer, buffer_size, CCS_CERTIFICATE_ITEM);
             } else {
-                ccs_delete_item(g_fcc_lwm2m_device_certificate_name, CCS_CERTIFICATE_ITEM);
-                status = ccs_set_item(g_fcc_lwm2m_device_certificate_name, buffer, buffer_size, CCS_CERTIFICATE_ITEM);
+                status = store_security_item(g_fcc_lwm2m_device_certificate_name, buffer, buffer_size, CCS_CERTIFICATE_ITEM);
             }
             break;
 
         case M2MSecurity::ServerPublicKey:
             if (object_instance_id == M2MSecurity::Bootstrap) {
-                ccs_delete_item(g_fcc_bootstrap_server_ca_certificate_name, CCS_CERTIFICATE_ITEM);
-                status = ccs_set_item(g_fcc_bootstrap_server_ca_certificate_name, buffer, buffer_size, CCS_CERTIFICATE_ITEM);
+                status = store_security_item(g_fcc_bootstrap_server_ca_certificate_name, buffer, buffer_size, CCS_CERTIFICATE_ITEM);
             } else {
-                ccs_delete_item(g_fcc_lwm2m_server_ca_certificate_name, CCS_CERTIFICATE_ITEM);
-                status = ccs_set_item(g_fcc_lwm2m_server_ca_certificate_name, buffer, buffer_size, CCS_CERTIFICATE_ITEM);
+                status = store_security_item(g_fcc_lwm2m_server_ca_certificate_name, buffer, buffer_size, CCS_CERTIFICATE_ITEM);
             }
             break;
 
         case M2MSecurity::Secretkey:
             if (object_instance_id == M2MSecurity::Bootstrap) {
-                ccs_delete_item(g_fcc_bootstrap_device_private_key_name, CCS_PRIVATE_KEY_ITEM);
-                status = ccs_set_item(g_fcc_bootstrap_device_private_key_name, buffer, buffer_size, CCS_PRIVATE_KEY_ITEM);
+                status = store_security_item(g_fcc_bootstrap_device_private_key_name, buffer, buffer_size, CCS_PRIVATE_KEY_ITEM);
             } else {
-                ccs_delete_item(g_fcc_lwm2m_device_private_key_name, CCS_PRIVATE_KEY_ITEM);
-                status = ccs_set_item(g_fcc_lwm2m_device_private_key_name, buffer, buffer_size, CCS_PRIVATE_KEY_ITEM);
+                status = store_security_item(g_fcc_lwm2m_device_private_key_name, buffer, buffer_size, CCS_PRIVATE_KEY_ITEM);
             }
             break;
 
@@ -285,7 +432,7 @@ ConnectorClient::ConnectorClient(ConnectorClientCallback *callback)
 #endif
       _lwm2m_security_instance(0), _certificate_chain_handle(NULL)
 #ifndef MBED_CLIENT_DISABLE_EST_FEATURE
-    , _est_client(*this)
+    , _est_client(*this), _est_key_pregenerated(false)
 #endif // !MBED_CLIENT_DISABLE_EST_FEATURE
 
 {
@@ -303,6 +450,9 @@ ConnectorClient::~ConnectorClient()
 #ifndef MBED_CONF_MBED_CLIENT_DISABLE_BOOTSTRAP_FEATURE
     delete _rebootstrap_timer;
 #endif
+#if MBED_CLIENT_DEFERRED_BOOTSTRAP_WRITES
+    discard_bootstrap_items();
+#endif
 }
 
 bool ConnectorClient::setup()
@@ -336,6 +486,12 @@ bool ConnectorClient::setup()
             if (initialize_storage() == CCS_STATUS_SUCCESS) {
                 _security = security;
                 _interface = interface;
+#if MBED_CLIENT_LWM2M_SEND_SAMPLES
+                _interface->set_send_storage(load_send_samples, save_send_samples, NULL);
+#endif
+#if MBED_CLIENT_REGISTRATION_RESUME
+                _interface->set_registration_storage(load_registration, save_registration, NULL);
+#endif
                 _setup_complete = true;
             }
         }
@@ -492,8 +648,22 @@ void ConnectorClient::state_bootstrap_start()
     assert(_security != NULL);
     uint16_t delay = _interface->stagger_wait_time(true);
     tr_info("ConnectorClient::state_bootstrap_start() - bootstrap after %d seconds", delay);
+    SPAN_TRACE_BEGIN(BOOTSTRAP);
+
+#if MBED_CLIENT_DEFERRED_BOOTSTRAP_WRITES
+    // Items left from an interrupted bootstrap are not stored
+    discard_bootstrap_items();
+    bootstrap_staging = true;
+#endif
     _stagger_timer->start_timer(delay * 1000, M2MTimerObserver::StaggerWaitTimer);
 
+#ifndef MBED_CLIENT_DISABLE_EST_FEATURE
+    // Key generation takes a noticeable time on small targets, use the stagger wait for it
+    if (delay > 0) {
+        pregenerate_est_key();
+    }
+#endif // !MBED_CLIENT_DISABLE_EST_FEATURE
+
     internal_event(State_Bootstrap_Started);
 }
 
@@ -505,6 +675,7 @@ void ConnectorClient::state_bootstrap_started()
 void ConnectorClient::state_bootstrap_success()
 {
     assert(_callback != NULL);
+    SPAN_TRACE_END(BOOTSTRAP, 0);
     // Parse internal endpoint name from mDS cert
     _callback->registration_process_result(State_Bootstrap_Success);
 }
@@ -512,6 +683,10 @@ void ConnectorClient::state_bootstrap_success()
 void ConnectorClient::state_bootstrap_failure()
 {
     assert(_callback != NULL);
+    SPAN_TRACE_END(BOOTSTRAP, 1);
+#if MBED_CLIENT_DEFERRED_BOOTSTRAP_WRITES
+    discard_bootstrap_items();
+#endif
     _callback->registration_process_result(State_Bootstrap_Failure);
 }
 
@@ -704,8 +879,7 @@ bool ConnectorClient::create_register_object()
     // Endpoint
     if (success && _endpoint_info.mode != M2MSecurity::NoSecurity) {
         success = false;
-        // 64 characters for common name + 1 for null terminator
-        char device_id[65];
+        char device_id[CERTIFICATE_FIELD_MAX_SIZE];
 
         size_t cert_size = max_size;
         uint8_t certificate[MAX_CERTIFICATE_SIZE];
@@ -790,6 +964,7 @@ void ConnectorClient::state_est_start()
 {
     // - Generate CSR from data during bootstrap phase
     // - Call EST enrollment API from InterfaceImpl
+    SPAN_TRACE_BEGIN(EST);
 
     // Update the internal endpoint name and account id to endpoint info structure
     // as we get those during bootstrap phase
@@ -895,21 +1070,37 @@ void ConnectorClient::state_est_start()
     csr_params.key_usage = KCM_CSR_KU_NONE;
     csr_params.ext_key_usage = KCM_CSR_EXT_KU_NONE;
 
-    // Delete existing keys
     ccs_delete_item(g_fcc_lwm2m_device_certificate_name, CCS_CERTIFICATE_ITEM);
-    ccs_delete_item(g_fcc_lwm2m_device_private_key_name, CCS_PRIVATE_KEY_ITEM);
 
-    kcm_status_e status = kcm_generate_keys_and_csr(KCM_SCHEME_EC_SECP256R1,
-                                                    (const uint8_t *)g_fcc_lwm2m_device_private_key_name,
-                                                    strlen(g_fcc_lwm2m_device_private_key_name),
-                                                    NULL,
-                                                    0,
-                                                    false,
-                                                    &csr_params,
-                                                    buffer,
-                                                    MAX_CERTIFICATE_SIZE,
-                                                    &real_size,
-                                                    NULL);
+    kcm_status_e status;
+    if (_est_key_pregenerated &&
+            ccs_check_item(g_fcc_lwm2m_device_private_key_name, CCS_PRIVATE_KEY_ITEM) == CCS_STATUS_SUCCESS) {
+        // Key pair was generated during the bootstrap, only the CSR is left to do
+        tr_debug("ConnectorClient::state_est_start - using pre-generated key");
+        status = kcm_csr_generate((const uint8_t *)g_fcc_lwm2m_device_private_key_name,
+                                  strlen(g_fcc_lwm2m_device_private_key_name),
+                                  &csr_params,
+                                  buffer,
+                                  MAX_CERTIFICATE_SIZE,
+                                  &real_size);
+    } else {
+        // Delete existing key
+        ccs_delete_item(g_fcc_lwm2m_device_private_key_name, CCS_PRIVATE_KEY_ITEM);
+
+        status = kcm_generate_keys_and_csr(KCM_SCHEME_EC_SECP256R1,
+                                           (const uint8_t *)g_fcc_lwm2m_device_private_key_name,
+                                           strlen(g_fcc_lwm2m_device_private_key_name),
+                                           NULL,
+                                           0,
+                                           false,
+                                           &csr_params,
+                                           buffer,
+                                           MAX_CERTIFICATE_SIZE,
+                                           &real_size,
+                                           NULL);
+    }
+    // A key is used for one enrollment only
+    _est_key_pregenerated = false;
 
     free(csr_params.subject);
 
@@ -941,9 +1132,34 @@ void ConnectorClient::state_est_started()
 {
 }
 
+void ConnectorClient::pregenerate_est_key()
+{
+    // Whether the bootstrap server asks for EST is not known yet. Any LwM2M key left from
+    // before is kept, and credentials written by a bootstrap without EST replace this key.
+    if (_est_key_pregenerated ||
+            ccs_check_item(g_fcc_lwm2m_device_private_key_name, CCS_PRIVATE_KEY_ITEM) == CCS_STATUS_SUCCESS) {
+        return;
+    }
+
+    kcm_status_e status = kcm_key_pair_generate_and_store(KCM_SCHEME_EC_SECP256R1,
+                                                          (const uint8_t *)g_fcc_lwm2m_device_private_key_name,
+                                                          strlen(g_fcc_lwm2m_device_private_key_name),
+                                                          NULL,
+                                                          0,
+                                                          false,
+                                                          NULL);
+    if (status == KCM_STATUS_SUCCESS) {
+        _est_key_pregenerated = true;
+    } else {
+        // Not fatal, the key is generated on EST start instead
+        tr_warn("ConnectorClient::pregenerate_est_key - failed %d", status);
+    }
+}
+
 void ConnectorClient::state_est_success()
 {
     tr_info("ConnectorClient::state_est_success()");
+    SPAN_TRACE_END(EST, 0);
 #ifndef MBED_CONF_MBED_CLIENT_DISABLE_BOOTSTRAP_FEATURE
     _interface->finish_bootstrap();
 #endif
@@ -952,6 +1168,7 @@ void ConnectorClient::state_est_success()
 void ConnectorClient::state_est_failure()
 {
     tr_info("ConnectorClient::state_est_failure()");
+    SPAN_TRACE_END(EST, 1);
     internal_event(State_Bootstrap_Failure);
     //Failed to store credentials, bootstrap failed
     _callback->connector_error(M2MInterface::ESTEnrollmentFailed, ERROR_EST_ENROLLMENT_REQUEST_FAILED); // Translated to error code ConnectMemoryConnectFail
@@ -966,6 +1183,7 @@ void ConnectorClient::state_registration_start()
 
     uint16_t delay = _interface->stagger_wait_time(false);
     tr_info("ConnectorClient::state_registration_start() - register after %d seconds", delay);
+    SPAN_TRACE_BEGIN(REGISTRATION);
     _stagger_timer->start_timer(delay * 1000, M2MTimerObserver::StaggerWaitTimer);
 
     internal_event(State_Registration_Started);
@@ -979,6 +1197,7 @@ void ConnectorClient::state_registration_started()
 void ConnectorClient::state_registration_success()
 {
     assert(_callback != NULL);
+    SPAN_TRACE_END(REGISTRATION, 0);
     _endpoint_info.internal_endpoint_name = _interface->internal_endpoint_name();
 
     //The endpoint is maximum 32 character long, we put bigger buffer for future extensions
@@ -1014,6 +1233,7 @@ void ConnectorClient::state_registration_success()
 void ConnectorClient::state_registration_failure()
 {
     assert(_callback != NULL);
+    SPAN_TRACE_END(REGISTRATION, 1);
     // maybe some additional canceling and/or leanup is needed here?
     _callback->registration_process_result(State_Registration_Failure);
 }
@@ -1029,6 +1249,20 @@ void ConnectorClient::bootstrap_data_ready(M2MSecurity *security_object)
 #ifndef MBED_CONF_MBED_CLIENT_DISABLE_BOOTSTRAP_FEATURE
     tr_info("ConnectorClient::bootstrap_data_ready");
     if (security_object) {
+#if MBED_CLIENT_DEFERRED_BOOTSTRAP_WRITES
+        // Bootstrap-Finish received, store the certificates and keys written by the server
+        ccs_status_e commit_status = commit_bootstrap_items();
+        if (commit_status != CCS_STATUS_SUCCESS) {
+            tr_err("Failed to store bootstrap credentials: %d", commit_status);
+            internal_event(State_Bootstrap_Failure);
+            if (commit_status == CCS_STATUS_MEMORY_ERROR) {
+                _callback->connector_error(M2MInterface::MemoryFail, CONNECTOR_ERROR_NO_MEMORY);
+            } else {
+                _callback->connector_error(M2MInterface::FailedToStoreCredentials, CONNECTOR_ERROR_FAILED_TO_STORE_CREDENTIAL);
+            }
+            return;
+        }
+#endif
         // Update bootstrap credentials (we could skip this if we knew whether they were updated)
         // This will also update the address in case of first to claim
         ccs_status_e status = set_bootstrap_credentials(security_object);
@@ -1216,17 +1450,21 @@ ccs_status_e ConnectorClient::set_connector_credentials(M2MSecurity *security)
             return status;
         }
 
-        char device_id[64];
-        memset(device_id, 0, 64);
-        if (extract_field_from_certificate(public_key, buffer_size, "L", device_id)) {
-            tr_info("ConnectorClient::set_connector_credentials - L internal_endpoint_name : %s", device_id);
-            _endpoint_info.internal_endpoint_name = String(device_id);
+        // Both fields are taken from the subject in one pass
+        char internal_endpoint[CERTIFICATE_FIELD_MAX_SIZE];
+        char device_id[CERTIFICATE_FIELD_MAX_SIZE];
+        if (!extract_fields_from_certificate(public_key, buffer_size, device_id, internal_endpoint)) {
+            return status;
+        }
+
+        if (internal_endpoint[0] != '\0') {
+            tr_info("ConnectorClient::set_connector_credentials - L internal_endpoint_name : %s", internal_endpoint);
+            _endpoint_info.internal_endpoint_name = String(internal_endpoint);
             ccs_delete_item(KEY_INTERNAL_ENDPOINT, CCS_CONFIG_ITEM);
-            status = ccs_set_item(KEY_INTERNAL_ENDPOINT, (uint8_t *)device_id, strlen(device_id), CCS_CONFIG_ITEM);
+            status = ccs_set_item(KEY_INTERNAL_ENDPOINT, (uint8_t *)internal_endpoint, strlen(internal_endpoint), CCS_CONFIG_ITEM);
         }
 
-        memset(device_id, 0, 64);
-        if (extract_field_from_certificate(public_key, buffer_size, "CN", device_id)) {
+        if (device_id[0] != '\0') {
             tr_info("ConnectorClient::set_connector_credentials - CN endpoint_name : %s", device_id);
             _endpoint_info.endpoint_name = String(device_id);
         }
@@ -1560,6 +1798,9 @@ void ConnectorClient::bootstrap_again()
     ccs_delete_item(g_fcc_lwm2m_server_ca_certificate_name, CCS_CERTIFICATE_ITEM);
     ccs_delete_item(g_fcc_lwm2m_device_certificate_name, CCS_CERTIFICATE_ITEM);
     ccs_delete_item(g_fcc_lwm2m_device_private_key_name, CCS_PRIVATE_KEY_ITEM);
+#ifndef MBED_CLIENT_DISABLE_EST_FEATURE
+    _est_key_pregenerated = false;
+#endif // !MBED_CLIENT_DISABLE_EST_FEATURE
 
     // delete the old session id
     static const char *kcm_session_item_name = "sslsession";
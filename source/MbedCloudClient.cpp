@@ -185,6 +185,11 @@ void MbedCloudClient::on_status_changed(void(*fn)(int))
     _on_status_changed = fn;
 }
 
+void MbedCloudClient::on_startup_phase(void(*fn)(int, uint32_t))
+{
+    _on_startup_phase = fn;
+}
+
 #ifdef MBED_CLOUD_CLIENT_SUPPORT_MULTICAST_UPDATE
 void MbedCloudClient::on_external_update(void(*fn)(uint32_t, uint32_t))
 {
@@ -339,6 +344,12 @@ void MbedCloudClient::value_updated(M2MBase *base, M2MBase::BaseType type)
     }
 }
 
+void MbedCloudClient::startup_phase(ServiceClientStartupPhase phase, uint32_t elapsed_ms)
+{
+    // ServiceClientStartupPhase values match MbedCloudClient::StartupPhase
+    _on_startup_phase.call((int)phase, elapsed_ms);
+}
+
 void MbedCloudClient::send_get_request(DownloadType type,
                                        const char *uri,
                                        const size_t offset,
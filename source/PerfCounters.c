@@ -0,0 +1,114 @@
+// ----------------------------------------------------------------------------
+// Copyright (c) 2021 Pelion. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include "mbed-cloud-client/PerfCounters.h"
+
+#if PERF_COUNTERS_ENABLED
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "mbed-client-libservice/nsdynmemLIB.h"
+#if defined(MBED_CLOUD_CLIENT_SUPPORT_UPDATE) && !defined(MBED_CLOUD_CLIENT_FOTA_ENABLE)
+#include "update-client-common/arm_uc_scheduler.h"
+#endif
+
+typedef struct {
+    const char *name;
+    uint8_t kind;
+    uint16_t resource_id;
+} perf_counter_info_s;
+
+static const perf_counter_info_s perf_counter_info[PERF_COUNTER_COUNT] = {
+#define PERF_COUNTER_INFO(name, kind, resource_id) { #name, kind, resource_id },
+    PERF_COUNTER_LIST(PERF_COUNTER_INFO)
+#undef PERF_COUNTER_INFO
+};
+
+volatile uint32_t perf_counter_values[PERF_COUNTER_COUNT];
+
+void perf_counter_raise(perf_counter_e counter, uint32_t value)
+{
+    uint32_t current = __atomic_load_n(&perf_counter_values[counter], __ATOMIC_RELAXED);
+    while (value > current &&
+            !__atomic_compare_exchange_n(&perf_counter_values[counter], &current, value, true,
+                                         __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+uint32_t perf_counter_get(perf_counter_e counter)
+{
+    return __atomic_load_n(&perf_counter_values[counter], __ATOMIC_RELAXED);
+}
+
+const char *perf_counter_name(perf_counter_e counter)
+{
+    return perf_counter_info[counter].name;
+}
+
+perf_counter_kind_e perf_counter_kind(perf_counter_e counter)
+{
+    return (perf_counter_kind_e)perf_counter_info[counter].kind;
+}
+
+uint16_t perf_counter_resource_id(perf_counter_e counter)
+{
+    return perf_counter_info[counter].resource_id;
+}
+
+void perf_counters_sample(void)
+{
+    // NULL unless the application gave ns_dyn_mem a statistics structure
+    const mem_stat_t *mem_stat = ns_dyn_mem_get_mem_stat();
+    if (mem_stat) {
+        PERF_COUNTER_MAX(HEAP_HIGH_WATER, mem_stat->heap_sector_allocated_bytes_max);
+        PERF_COUNTER_SET(HEAP_ALLOC_FAILURES, mem_stat->heap_alloc_fail_cnt);
+    }
+#if defined(MBED_CLOUD_CLIENT_SUPPORT_UPDATE) && !defined(MBED_CLOUD_CLIENT_FOTA_ENABLE)
+    PERF_COUNTER_MAX(UC_SCHEDULER_HIGH_WATER, ARM_UC_SchedulerGetHighWatermark());
+#endif
+}
+
+size_t perf_counters_dump(char *buffer, size_t buffer_size)
+{
+    size_t length = 0;
+
+    perf_counters_sample();
+
+    if (buffer_size) {
+        buffer[0] = '\0';
+    }
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        int written = snprintf(length < buffer_size ? buffer + length : NULL,
+                               length < buffer_size ? buffer_size - length : 0,
+                               "%s %" PRIu32 "\n", perf_counter_name((perf_counter_e)i), perf_counter_get((perf_counter_e)i));
+        if (written > 0) {
+            length += written;
+        }
+    }
+    return length;
+}
+
+void perf_counters_reset(void)
+{
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        if (perf_counter_info[i].kind != PERF_KIND_GAUGE) {
+            __atomic_store_n(&perf_counter_values[i], 0, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+#endif // PERF_COUNTERS_ENABLED
@@ -0,0 +1,148 @@
+// ----------------------------------------------------------------------------
+// Copyright (c) 2021 Pelion. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include "include/PerfCountersObject.h"
+
+#if PERF_COUNTERS_ENABLED
+
+#include "mbed-client/m2minterfacefactory.h"
+#include "mbed-client/m2mobject.h"
+#include "mbed-client/m2mobjectinstance.h"
+#include "mbed-client/m2mresource.h"
+#include "eventOS_event.h"
+#include "eventOS_event_timer.h"
+#include "eventOS_scheduler.h"
+#include "mbed-trace/mbed_trace.h"
+
+#define TRACE_GROUP "mClt"
+
+#ifndef PERF_COUNTERS_OBJECT_ID
+#define PERF_COUNTERS_OBJECT_ID "35020"
+#endif
+
+#ifdef MBED_CONF_MBED_CLOUD_CLIENT_PERF_COUNTERS_INTERVAL
+#define PERF_COUNTERS_INTERVAL MBED_CONF_MBED_CLOUD_CLIENT_PERF_COUNTERS_INTERVAL
+#endif
+
+// Seconds between refreshes of the resource values
+#ifndef PERF_COUNTERS_INTERVAL
+#define PERF_COUNTERS_INTERVAL 60
+#endif
+
+#define PERF_COUNTERS_INIT_EVENT 0
+#define PERF_COUNTERS_REFRESH_EVENT 1
+
+static M2MObject *perf_object = NULL;
+static M2MResource *perf_resources[PERF_COUNTER_COUNT];
+static uint32_t perf_published[PERF_COUNTER_COUNT];
+static int8_t perf_tasklet_id = -1;
+static arm_event_storage_t *perf_timer = NULL;
+
+static void perf_counters_refresh()
+{
+    perf_counters_sample();
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        const uint32_t value = perf_counter_get((perf_counter_e)i);
+        // Unchanged values are not written, so observers are not notified of them
+        if (perf_resources[i] && value != perf_published[i]) {
+            perf_resources[i]->set_value((int64_t)value);
+            perf_published[i] = value;
+        }
+    }
+}
+
+static void perf_counters_tasklet(arm_event_s *event)
+{
+    if (event->event_type == PERF_COUNTERS_REFRESH_EVENT && perf_object) {
+        perf_counters_refresh();
+    }
+}
+
+bool PerfCountersObject::init(M2MBaseList &registration_list)
+{
+    if (perf_object) {
+        return true;
+    }
+
+    perf_object = M2MInterfaceFactory::create_object(PERF_COUNTERS_OBJECT_ID);
+    M2MObjectInstance *instance = perf_object ? perf_object->create_object_instance() : NULL;
+    if (!instance) {
+        tr_error("PerfCountersObject::init - failed to create the object");
+        finalize();
+        return false;
+    }
+
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        M2MResource *res = instance->create_dynamic_resource(perf_counter_resource_id((perf_counter_e)i),
+                                                             perf_counter_name((perf_counter_e)i),
+                                                             M2MResourceInstance::INTEGER, true);
+        if (!res) {
+            tr_error("PerfCountersObject::init - failed to create resource %d", perf_counter_resource_id((perf_counter_e)i));
+            finalize();
+            return false;
+        }
+        res->set_operation(M2MBase::GET_ALLOWED);
+        res->set_value((int64_t)0);
+        perf_resources[i] = res;
+        perf_published[i] = 0;
+    }
+
+    if (perf_tasklet_id < 0) {
+        eventOS_scheduler_mutex_wait();
+        perf_tasklet_id = eventOS_event_handler_create(perf_counters_tasklet, PERF_COUNTERS_INIT_EVENT);
+        eventOS_scheduler_mutex_release();
+    }
+
+    arm_event_t event = {
+        .receiver = perf_tasklet_id,
+        .sender = perf_tasklet_id,
+        .event_type = PERF_COUNTERS_REFRESH_EVENT,
+        .event_id = 0,
+        .data_ptr = NULL,
+        .priority = ARM_LIB_LOW_PRIORITY_EVENT,
+        .event_data = 0,
+    };
+    if (perf_tasklet_id >= 0) {
+        perf_timer = eventOS_event_timer_request_every(&event, eventOS_event_timer_ms_to_ticks(PERF_COUNTERS_INTERVAL * 1000));
+    }
+    if (!perf_timer) {
+        tr_error("PerfCountersObject::init - failed to start the refresh timer");
+        finalize();
+        return false;
+    }
+
+    perf_counters_refresh();
+    registration_list.push_back(perf_object);
+    return true;
+}
+
+void PerfCountersObject::finalize()
+{
+    if (perf_timer) {
+        eventOS_cancel(perf_timer);
+        perf_timer = NULL;
+    }
+
+    // Deleting the object deletes its resources
+    delete perf_object;
+    perf_object = NULL;
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        perf_resources[i] = NULL;
+    }
+}
+
+#endif // PERF_COUNTERS_ENABLED
@@ -37,6 +37,7 @@
 #include "mbed-trace/mbed_trace.h"
 #include "pal.h"
 #include "ns_hal_init.h"
+#include "eventOS_event_timer.h"
 #include "fota/fota_internal_ifs.h"
 #include "mbed-cloud-client/MbedCloudClientConfig.h"
 
@@ -50,6 +51,7 @@
 #endif // MBED_CONF_MBED_CLOUD_CLIENT_ENABLE_DEVICE_SENTRY
 
 #include "fota/fota.h"
+#include "include/PerfCountersObject.h"
 
 #ifdef SERVICE_CLIENT_SUPPORT_MULTICAST
 #include "multicast.h"
@@ -92,6 +94,8 @@ ServiceClient::ServiceClient(ServiceClientCallback &callback)
       _current_state(State_Init),
       _event_generated(false),
       _state_engine_running(false),
+      _startup_running(false),
+      _startup_ticks(0),
 #if defined(MBED_CLOUD_CLIENT_SUPPORT_UPDATE) && !defined(MBED_CLOUD_CLIENT_FOTA_ENABLE)
       _uc_hub_tasklet_id(-1),
       _setup_update_client(false),
@@ -121,6 +125,9 @@ ServiceClient::~ServiceClient()
 #ifdef MBED_CONF_MBED_CLOUD_CLIENT_ENABLE_DEVICE_SENTRY
     DeviceSentryClient::finalize();
 #endif // MBED_CONF_MBED_CLOUD_CLIENT_ENABLE_DEVICE_SENTRY
+#if PERF_COUNTERS_ENABLED
+    PerfCountersObject::finalize();
+#endif
 }
 
 bool ServiceClient::init()
@@ -181,6 +188,8 @@ void ServiceClient::initialize_and_register(M2MBaseList &reg_objs)
             _current_state == State_Unregister ||
             _current_state == State_Failure) {
         _client_objs = &reg_objs;
+        _startup_running = true;
+        _startup_ticks = eventOS_event_timer_ticks();
 
 #if defined(MBED_CLOUD_CLIENT_SUPPORT_UPDATE) && !defined(MBED_CLOUD_CLIENT_FOTA_ENABLE)
         tr_debug("ServiceClient::initialize_and_register: update client supported");
@@ -290,6 +299,11 @@ void ServiceClient::finish_initialization(void)
     }
 #endif /* MBED_CONF_MBED_CLOUD_CLIENT_ENABLE_DEVICE_SENTRY */
 
+#if PERF_COUNTERS_ENABLED
+    // The counters are diagnostics, the client works without the object
+    PerfCountersObject::init(*_client_objs);
+#endif
+
     if (device_object) {
         /* Publish device object resource to mds */
         M2MResourceList list = device_object->object_instance()->resources();
@@ -304,6 +318,7 @@ void ServiceClient::finish_initialization(void)
         /* Add Device Object to object list. */
         _client_objs->push_back(device_object);
     }
+    startup_phase(ServiceClientCallback::Service_Client_Startup_Initialized);
 #ifndef MBED_CONF_MBED_CLIENT_DISABLE_BOOTSTRAP_FEATURE
     internal_event(State_Bootstrap);
 #else
@@ -404,6 +419,7 @@ void ServiceClient::state_bootstrap()
 void ServiceClient::state_register()
 {
     tr_info("ServiceClient::state_register()");
+    startup_phase(ServiceClientCallback::Service_Client_Startup_Registering);
     _connector_client.start_registration(_client_objs);
 }
 
@@ -415,6 +431,8 @@ void ServiceClient::registration_process_result(ConnectorClient::StartupSubState
 #if defined(MBED_CLOUD_CLIENT_FOTA_ENABLE)
             fota_internal_resume();
 #endif
+            startup_phase(ServiceClientCallback::Service_Client_Startup_Registered);
+            _startup_running = false;
             internal_event(State_Success);
             break;
         case ConnectorClient::State_Registration_Failure:
@@ -423,6 +441,7 @@ void ServiceClient::registration_process_result(ConnectorClient::StartupSubState
             break;
 
         case ConnectorClient::State_Bootstrap_Success:
+            startup_phase(ServiceClientCallback::Service_Client_Startup_Bootstrapped);
             internal_event(State_Register);
             break;
 
@@ -515,6 +534,7 @@ void ServiceClient::state_success()
 void ServiceClient::state_failure()
 {
     tr_error("ServiceClient::state_failure()");
+    _startup_running = false;
     send_complete_event(ServiceClientCallback::Service_Client_Status_Failure);
 }
 
@@ -757,6 +777,15 @@ void ServiceClient::send_complete_event(ServiceClientCallback::ServiceClientCall
     }
 }
 
+void ServiceClient::startup_phase(ServiceClientCallback::ServiceClientStartupPhase phase)
+{
+    if (_startup_running) {
+        uint32_t elapsed_ms = eventOS_event_timer_ticks_to_ms(eventOS_event_timer_ticks() - _startup_ticks);
+        tr_info("ServiceClient::startup_phase() - phase %d done after %" PRIu32 " ms", (int)phase, elapsed_ms);
+        _service_callback.startup_phase(phase, elapsed_ms);
+    }
+}
+
 #ifdef MBED_CLOUD_CLIENT_SUPPORT_UPDATE
 void ServiceClient::set_update_authorize_handler(void (*handler)(int32_t request))
 {
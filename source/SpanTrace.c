@@ -0,0 +1,178 @@
+// ----------------------------------------------------------------------------
+// Copyright (c) 2021 Pelion. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include "mbed-cloud-client/SpanTrace.h"
+
+#if SPAN_TRACE_ENABLED
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "pal.h"
+
+#ifdef MBED_CONF_MBED_CLOUD_CLIENT_SPAN_TRACE_ENTRIES
+#define SPAN_TRACE_ENTRIES MBED_CONF_MBED_CLOUD_CLIENT_SPAN_TRACE_ENTRIES
+#endif
+
+#ifndef SPAN_TRACE_ENTRIES
+#define SPAN_TRACE_ENTRIES 128
+#endif
+
+#define SPAN_TRACE_DUMP_VERSION 1
+#define SPAN_TRACE_DUMP_HEADER_SIZE 8
+#define SPAN_TRACE_DUMP_EVENT_SIZE 8
+
+typedef struct {
+    uint32_t time_us;   // Wraps around after about 71 minutes
+    uint8_t span;
+    uint8_t phase;
+    uint16_t arg;
+} span_trace_event_s;
+
+static const char *const span_trace_names[SPAN_TRACE_COUNT] = {
+#define SPAN_TRACE_NAME(name) #name,
+    SPAN_TRACE_LIST(SPAN_TRACE_NAME)
+#undef SPAN_TRACE_NAME
+};
+
+static span_trace_event_s span_trace_events[SPAN_TRACE_ENTRIES];
+
+// Events recorded since the start or the last clear, the next one goes to this modulo the size
+static uint32_t span_trace_recorded;
+
+static uint32_t span_trace_time_us(void)
+{
+    static uint64_t frequency;
+    if (!frequency) {
+        frequency = pal_osKernelSysTickFrequency();
+    }
+    const uint64_t ticks = pal_osKernelSysTick();
+    // Split so that the multiplication does not overflow with a high tick frequency
+    return (uint32_t)((ticks / frequency) * 1000000 + (ticks % frequency) * 1000000 / frequency);
+}
+
+void span_trace_record(span_trace_e span, span_trace_phase_e phase, uint16_t arg)
+{
+    const uint32_t index = __atomic_fetch_add(&span_trace_recorded, 1, __ATOMIC_RELAXED) % SPAN_TRACE_ENTRIES;
+    span_trace_event_s *event = &span_trace_events[index];
+    event->time_us = span_trace_time_us();
+    event->span = (uint8_t)span;
+    event->phase = (uint8_t)phase;
+    event->arg = arg;
+}
+
+const char *span_trace_name(span_trace_e span)
+{
+    return span_trace_names[span];
+}
+
+// Index of the oldest event kept and the number of events kept
+static uint32_t span_trace_window(uint32_t *count)
+{
+    const uint32_t recorded = __atomic_load_n(&span_trace_recorded, __ATOMIC_RELAXED);
+    if (recorded <= SPAN_TRACE_ENTRIES) {
+        *count = recorded;
+        return 0;
+    }
+    *count = SPAN_TRACE_ENTRIES;
+    return recorded % SPAN_TRACE_ENTRIES;
+}
+
+static size_t span_trace_append(char *buffer, size_t buffer_size, size_t length, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(length < buffer_size ? buffer + length : NULL,
+                            length < buffer_size ? buffer_size - length : 0,
+                            format, args);
+    va_end(args);
+    return written > 0 ? length + written : length;
+}
+
+size_t span_trace_export_json(char *buffer, size_t buffer_size)
+{
+    uint32_t count;
+    const uint32_t first = span_trace_window(&count);
+    size_t length = 0;
+    uint64_t timestamp = 0;
+    uint32_t previous_us = 0;
+
+    if (buffer_size) {
+        buffer[0] = '\0';
+    }
+    length = span_trace_append(buffer, buffer_size, length, "{\"traceEvents\":[");
+    for (uint32_t i = 0; i < count; i++) {
+        const span_trace_event_s *event = &span_trace_events[(first + i) % SPAN_TRACE_ENTRIES];
+        // Timestamps count from the oldest event, unsigned subtraction unwraps the 32 bit time
+        if (i) {
+            timestamp += (uint32_t)(event->time_us - previous_us);
+        }
+        previous_us = event->time_us;
+        length = span_trace_append(buffer, buffer_size, length,
+                                   "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%" PRIu64 ",\"pid\":1,\"tid\":1%s,\"args\":{\"arg\":%u}}",
+                                   i ? "," : "", span_trace_names[event->span], event->phase, timestamp,
+                                   event->phase == SPAN_PHASE_INSTANT ? ",\"s\":\"t\"" : "", event->arg);
+    }
+    length = span_trace_append(buffer, buffer_size, length, "],\"displayTimeUnit\":\"ms\"}");
+    return length;
+}
+
+static uint8_t *span_trace_write_le(uint8_t *ptr, uint32_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++) {
+        *ptr++ = (uint8_t)(value >> (8 * i));
+    }
+    return ptr;
+}
+
+size_t span_trace_export_binary(uint8_t *buffer, size_t buffer_size)
+{
+    uint32_t count;
+    uint32_t first = span_trace_window(&count);
+
+    if (buffer_size < SPAN_TRACE_DUMP_HEADER_SIZE) {
+        return 0;
+    }
+    const size_t room = (buffer_size - SPAN_TRACE_DUMP_HEADER_SIZE) / SPAN_TRACE_DUMP_EVENT_SIZE;
+    if (count > room) {
+        first = (first + (count - room)) % SPAN_TRACE_ENTRIES;
+        count = room;
+    }
+
+    uint8_t *ptr = buffer;
+    memcpy(ptr, "SPTR", 4);
+    ptr += 4;
+    *ptr++ = SPAN_TRACE_DUMP_VERSION;
+    *ptr++ = SPAN_TRACE_DUMP_EVENT_SIZE;
+    ptr = span_trace_write_le(ptr, count, 2);
+    for (uint32_t i = 0; i < count; i++) {
+        const span_trace_event_s *event = &span_trace_events[(first + i) % SPAN_TRACE_ENTRIES];
+        ptr = span_trace_write_le(ptr, event->time_us, 4);
+        *ptr++ = event->span;
+        *ptr++ = event->phase;
+        ptr = span_trace_write_le(ptr, event->arg, 2);
+    }
+    return ptr - buffer;
+}
+
+void span_trace_clear(void)
+{
+    __atomic_store_n(&span_trace_recorded, 0, __ATOMIC_RELAXED);
+}
+
+#endif // SPAN_TRACE_ENABLED
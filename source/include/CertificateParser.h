@@ -27,12 +27,27 @@
 extern "C" {
 #endif
 
+// Maximum size of an extracted field, 64 characters and the null terminator
+#define CERTIFICATE_FIELD_MAX_SIZE 65
+
+/**
+*  \brief Extracts the Common Name and Locality fields from the subject of a DER certificate
+*  in one pass. The certificate is walked in place, nothing is allocated.
+*  \param cer, The certificate.
+*  \param cer_len, Length of the certificate.
+*  \param common_name [OUT], buffer of CERTIFICATE_FIELD_MAX_SIZE bytes for CN, or NULL.
+*  \param locality [OUT], buffer of CERTIFICATE_FIELD_MAX_SIZE bytes for L, or NULL.
+*  A field not present in the certificate is returned as empty string.
+*  \return True if success, False if the certificate could not be parsed.
+*/
+bool extract_fields_from_certificate(const uint8_t* cer, size_t cer_len, char *common_name, char *locality);
+
 /**
 *  \brief A utility function to extract Locality field from the mDS certificate and store it to KCM.
 *  \param certificate, The certificate from which the field has to be extracted.
 *  \param field, The field to be extracted.
-*  \param value [OUT], buffer containing field value. Maximum value can be 64 bytes.
-*  \return True if success, False if failure.
+*  \param value [OUT], buffer containing field value, of CERTIFICATE_FIELD_MAX_SIZE bytes.
+*  \return True if success, False if failure or if the field is not present.
 */
 bool extract_field_from_certificate(const uint8_t* cer, size_t cer_len, const char *field, char* value);
 
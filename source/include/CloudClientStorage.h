@@ -28,6 +28,8 @@
 #define KEY_INTERNAL_ENDPOINT                   "mbed.InternalEndpoint"
 #define KEY_DEVICE_SOFTWAREVERSION              "mbed.SoftwareVersion"
 #define KEY_FIRST_TO_CLAIM                      "mbed.FirstToClaim"
+#define KEY_SEND_SAMPLES                        "mbed.SendSamples"
+#define KEY_REGISTRATION                        "mbed.Registration"
 
 #ifdef __cplusplus
 extern "C" {
@@ -64,6 +66,12 @@ ccs_status_e uninitialize_storage(void);
 */
 ccs_status_e initialize_storage(void);
 
+/**
+*  \brief Drops the cached configuration items, so that they are read from storage again.
+*  Needed after items are changed directly through KCM instead of this API.
+*/
+void ccs_cache_clear(void);
+
 /* Bootstrap credential handling methods */
 ccs_status_e ccs_get_string_item(const char* key, uint8_t *buffer, const size_t buffer_size, ccs_item_type_e item_type);
 ccs_status_e ccs_check_item(const char* key, ccs_item_type_e item_type);
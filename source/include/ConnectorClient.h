@@ -378,6 +378,12 @@ private:
      * When the EST (enrollment-over-secure-transport) enrollment failed.
      */
     void state_est_failure();
+
+    /**
+     * Generates the LwM2M device key pair while waiting for the bootstrap to start,
+     * so that EST enrollment only needs to sign the CSR.
+     */
+    void pregenerate_est_key();
 #endif // !MBED_CLIENT_DISABLE_EST_FEATURE
 
     /**
@@ -484,6 +490,7 @@ private:
     void                                *_certificate_chain_handle;
 #ifndef MBED_CLIENT_DISABLE_EST_FEATURE
     EstClient                           _est_client;
+    bool                                _est_key_pregenerated;
 #endif // !MBED_CLIENT_DISABLE_EST_FEATURE
 };
 
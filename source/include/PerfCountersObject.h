@@ -0,0 +1,52 @@
+// ----------------------------------------------------------------------------
+// Copyright (c) 2021 Pelion. All rights reserved.
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef PERF_COUNTERS_OBJECT_H
+#define PERF_COUNTERS_OBJECT_H
+
+/** \internal \file PerfCountersObject.h */
+
+#include "mbed-cloud-client/PerfCounters.h"
+
+#if PERF_COUNTERS_ENABLED
+
+#include "mbed-client/m2minterface.h"
+
+/**
+ * LwM2M object publishing the performance counters, one read only and observable
+ * integer resource per counter. The values are refreshed periodically.
+ */
+namespace PerfCountersObject
+{
+
+/**
+ * @brief Creates the object and starts refreshing it.
+ * @param registration_list Mbed Cloud Client resource objects list
+ * @return true on success
+ */
+bool init(M2MBaseList &registration_list);
+
+/**
+ * @brief Stops refreshing and deletes the object.
+ */
+void finalize();
+
+};
+
+#endif // PERF_COUNTERS_ENABLED
+
+#endif // PERF_COUNTERS_OBJECT_H
@@ -67,6 +67,13 @@ public:
         Service_Client_Status_Sleep = 5
     } ServiceClientCallbackStatus;
 
+    typedef enum {
+        Service_Client_Startup_Initialized = 0,
+        Service_Client_Startup_Bootstrapped = 1,
+        Service_Client_Startup_Registering = 2,
+        Service_Client_Startup_Registered = 3
+    } ServiceClientStartupPhase;
+
     /**
     * \brief Indicates that the setup or close operation is complete
     * with success or failure.
@@ -90,6 +97,13 @@ public:
     */
     virtual void value_updated(M2MBase *base, M2MBase::BaseType type) = 0;
 
+    /**
+    * \brief Indicates that a phase of the client startup is complete.
+    * \param phase, The completed phase.
+    * \param elapsed_ms, Milliseconds since the startup began.
+    */
+    virtual void startup_phase(ServiceClientStartupPhase phase, uint32_t elapsed_ms) = 0;
+
 #ifdef MBED_CLOUD_CLIENT_SUPPORT_MULTICAST_UPDATE
     /**
     * \brief A callback indicating that new external firmware is available.
@@ -317,6 +331,12 @@ protected :
     */
     void send_complete_event(ServiceClientCallback::ServiceClientCallbackStatus status);
 
+    /**
+    * Reports a completed startup phase with the time since the startup began.
+    * \param phase, The completed phase.
+    */
+    void startup_phase(ServiceClientCallback::ServiceClientStartupPhase phase);
+
 private:
     M2MDevice *device_object_from_storage();
 
@@ -338,6 +358,8 @@ private:
     StartupMainState                _current_state;
     bool                            _event_generated;
     bool                            _state_engine_running;
+    bool                            _startup_running;
+    uint32_t                        _startup_ticks;
 #if defined(MBED_CLOUD_CLIENT_SUPPORT_UPDATE) && !defined(MBED_CLOUD_CLIENT_FOTA_ENABLE)
     int8_t                          _uc_hub_tasklet_id;
     bool                            _setup_update_client;
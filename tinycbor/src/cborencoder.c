@@ -278,6 +278,10 @@ static inline CborError append_byte_to_buffer(CborEncoder *encoder, uint8_t byte
 
 static inline CborError encode_number_no_update(CborEncoder *encoder, uint64_t ui, uint8_t shiftedMajorType)
 {
+    /* Small values, including most container and string heads, fit in the initial byte */
+    if (ui < Value8Bit)
+        return append_byte_to_buffer(encoder, (uint8_t)(ui + shiftedMajorType));
+
     /* Little-endian would have been so much more convenient here:
      * We could just write at the beginning of buf but append_to_buffer
      * only the necessary bytes.
@@ -288,19 +292,15 @@ static inline CborError encode_number_no_update(CborEncoder *encoder, uint64_t u
     uint8_t *bufstart = bufend - 1;
     put64(buf + 1, ui);     /* we probably have a bunch of zeros in the beginning */
 
-    if (ui < Value8Bit) {
-        *bufstart = (uint8_t)(*bufstart + shiftedMajorType);
-    } else {
-        uint8_t more = 0;
-        if (ui > 0xffU)
-            ++more;
-        if (ui > 0xffffU)
-            ++more;
-        if (ui > 0xffffffffU)
-            ++more;
-        bufstart -= (size_t)1 << more;
-        *bufstart = (uint8_t)(shiftedMajorType + Value8Bit + more);
-    }
+    uint8_t more = 0;
+    if (ui > 0xffU)
+        ++more;
+    if (ui > 0xffffU)
+        ++more;
+    if (ui > 0xffffffffU)
+        ++more;
+    bufstart -= (size_t)1 << more;
+    *bufstart = (uint8_t)(shiftedMajorType + Value8Bit + more);
 
     return append_to_buffer(encoder, bufstart, (size_t)(bufend - bufstart));
 }
@@ -269,6 +269,11 @@ static inline CborError validate_utf8_string(const void *ptr, size_t n)
     const uint8_t *buffer = (const uint8_t *)ptr;
     const uint8_t * const end = buffer + n;
     while (buffer < end) {
+        /* text is mostly ASCII, which needs no decoding */
+        buffer += utf8_ascii_prefix_len(buffer, end);
+        if (buffer == end)
+            break;
+
         uint32_t uc = get_utf8(&buffer, end);
         if (uc == ~0U)
             return CborErrorInvalidUtf8TextString;
@@ -28,6 +28,25 @@
 #include "compilersupport_p.h"
 
 #include <stdint.h>
+#include <string.h>
+
+/* Returns the number of bytes before the first non-ASCII byte, checking a word at a time */
+static inline size_t utf8_ascii_prefix_len(const uint8_t *buffer, const uint8_t *end)
+{
+    const uint8_t *ptr = buffer;
+    const size_t high_bits = (size_t)-1 / 0xff * 0x80;
+
+    while (end - ptr >= (ptrdiff_t)sizeof(size_t)) {
+        size_t word;
+        memcpy(&word, ptr, sizeof(word));
+        if (word & high_bits)
+            break;
+        ptr += sizeof(word);
+    }
+    while (ptr < end && *ptr < 0x80)
+        ++ptr;
+    return (size_t)(ptr - buffer);
+}
 
 static inline uint32_t get_utf8(const uint8_t **buffer, const uint8_t *end)
 {
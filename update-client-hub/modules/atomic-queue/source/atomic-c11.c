@@ -0,0 +1,73 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 Pelion Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include "atomic.h"
+
+#if AQ_ATOMIC_USE_C11
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+/* The queue and the scheduler hand plain uintptr_t and pointer fields to these
+ * functions, so they are accessed through atomic views of the same objects.
+ * This is valid on the POSIX compilers, where the atomic types have the size and
+ * representation of the plain ones and are lock free.
+ */
+_Static_assert(sizeof(atomic_uintptr_t) == sizeof(uintptr_t), "atomic_uintptr_t size mismatch");
+_Static_assert(sizeof(_Atomic int32_t) == sizeof(int32_t), "atomic int32_t size mismatch");
+
+/* The store only succeeds if *ptrAddr still holds the pointer that was checked,
+ * which takes the place of the exclusive monitor used on Cortex-M. The queue is
+ * popped by a single reader, and pushes only ever change the tail pointer, so a
+ * failed compare means another context modified *ptrAddr.
+ */
+int aq_atomic_cas_deref_uintptr(uintptr_t *volatile *ptrAddr,
+                                uintptr_t **currentPtrValue,
+                                uintptr_t expectedDerefValue,
+                                uintptr_t *newPtrValue,
+                                uintptr_t valueOffset)
+{
+    _Atomic(uintptr_t *) *atomic_ptr = (_Atomic(uintptr_t *) *) ptrAddr;
+    uintptr_t *current = atomic_load_explicit(atomic_ptr, memory_order_acquire);
+    if (currentPtrValue != NULL) {
+        *currentPtrValue = current;
+    }
+    if (current == NULL) {
+        return AQ_ATOMIC_CAS_DEREF_NULLPTR;
+    } else if (*(uintptr_t *)((uintptr_t)current + valueOffset) != expectedDerefValue) {
+        return AQ_ATOMIC_CAS_DEREF_VALUE;
+    } else if (!atomic_compare_exchange_strong_explicit(atomic_ptr, &current, newPtrValue,
+                                                        memory_order_acq_rel, memory_order_acquire)) {
+        return AQ_ATOMIC_CAS_DEREF_INTERUPTED;
+    } else {
+        return AQ_ATOMIC_CAS_DEREF_SUCCESS;
+    }
+}
+
+int aq_atomic_cas_uintptr(uintptr_t *ptr, uintptr_t oldval, uintptr_t newval)
+{
+    return atomic_compare_exchange_strong((atomic_uintptr_t *) ptr, &oldval, newval);
+}
+
+int32_t aq_atomic_inc_int32(int32_t *ptr, int32_t inc)
+{
+    return atomic_fetch_add((_Atomic int32_t *) ptr, inc) + inc;
+}
+
+#endif // AQ_ATOMIC_USE_C11
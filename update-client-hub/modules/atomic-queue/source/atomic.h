@@ -20,6 +20,15 @@
 #define ATOMIC_QUEUE_ATOMIC_H
 #include <stdint.h>
 
+/* POSIX builds with a C11 compiler use the <stdatomic.h> operations, rather than
+ * a critical section that is a process-wide mutex on POSIX. See atomic-c11.c.
+ */
+#if defined(TARGET_LIKE_POSIX) && !defined(ATOMIC_QUEUE_USE_PAL) \
+    && defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_ATOMICS__)
+#define AQ_ATOMIC_USE_C11 1
+#else
+#define AQ_ATOMIC_USE_C11 0
+#endif
 
 
 #ifdef __cplusplus
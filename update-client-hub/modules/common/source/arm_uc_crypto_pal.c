@@ -164,6 +164,102 @@ arm_uc_error_t ARM_UC_cryptoHMACSHA256(arm_uc_buffer_t *key,
     return result;
 }
 
+#define ARM_UC_HMAC_IPAD 0x36
+#define ARM_UC_HMAC_OPAD 0x5c
+
+arm_uc_error_t ARM_UC_cryptoHMACSHA256Setup(arm_uc_hmacHandle_t *hHmac, const arm_uc_buffer_t *key)
+{
+    arm_uc_error_t result = (arm_uc_error_t) { ARM_UC_CU_ERR_INVALID_PARAMETER };
+
+    if (hHmac && key && key->ptr) {
+        uint8_t block[ARM_UC_SHA256_BLOCK_SIZE] = { 0 };
+        palStatus_t rc = PAL_SUCCESS;
+
+        /* keys longer than a block are hashed first (RFC 2104) */
+        if (key->size > sizeof(block)) {
+            rc = pal_sha256(key->ptr, key->size, block);
+        } else {
+            memcpy(block, key->ptr, key->size);
+        }
+
+        /* keep the outer padded key for the finish, absorb the inner one now */
+        for (uint32_t index = 0; index < sizeof(block); index++) {
+            hHmac->outer_key[index] = block[index] ^ ARM_UC_HMAC_OPAD;
+            block[index] ^= ARM_UC_HMAC_IPAD;
+        }
+
+        if (rc == PAL_SUCCESS) {
+            rc = pal_mdInit(&hHmac->hDigest, PAL_SHA256);
+            if (rc == PAL_SUCCESS) {
+                rc = pal_mdUpdate(hHmac->hDigest, block, sizeof(block));
+                if (rc != PAL_SUCCESS) {
+                    pal_mdFree(&hHmac->hDigest);
+                }
+            }
+        }
+
+        memset(block, 0, sizeof(block));
+        if (rc == PAL_SUCCESS) {
+            result = (arm_uc_error_t) { ERR_NONE };
+        } else {
+            memset(hHmac->outer_key, 0, sizeof(hHmac->outer_key));
+        }
+    }
+
+    return result;
+}
+
+arm_uc_error_t ARM_UC_cryptoHMACSHA256Update(arm_uc_hmacHandle_t *hHmac, const arm_uc_buffer_t *input)
+{
+    arm_uc_error_t result = (arm_uc_error_t) { ARM_UC_CU_ERR_INVALID_PARAMETER };
+
+    if (hHmac && input) {
+        palStatus_t rc = pal_mdUpdate(hHmac->hDigest, input->ptr, input->size);
+        if (rc == PAL_SUCCESS) {
+            result = (arm_uc_error_t) { ERR_NONE };
+        }
+    }
+
+    return result;
+}
+
+arm_uc_error_t ARM_UC_cryptoHMACSHA256Finish(arm_uc_hmacHandle_t *hHmac, arm_uc_buffer_t *output)
+{
+    arm_uc_error_t result = (arm_uc_error_t) { ARM_UC_CU_ERR_INVALID_PARAMETER };
+
+    if (hHmac) {
+        uint8_t inner[ARM_UC_SHA256_SIZE];
+
+        /* inner hash */
+        palStatus_t rc = pal_mdFinal(hHmac->hDigest, inner);
+        pal_mdFree(&hHmac->hDigest);
+
+        if ((rc == PAL_SUCCESS) && output && (output->size_max >= ARM_UC_SHA256_SIZE)) {
+            /* outer hash over the padded key and the inner hash */
+            rc = pal_mdInit(&hHmac->hDigest, PAL_SHA256);
+            if (rc == PAL_SUCCESS) {
+                rc = pal_mdUpdate(hHmac->hDigest, hHmac->outer_key, sizeof(hHmac->outer_key));
+                if (rc == PAL_SUCCESS) {
+                    rc = pal_mdUpdate(hHmac->hDigest, inner, sizeof(inner));
+                }
+                if (rc == PAL_SUCCESS) {
+                    rc = pal_mdFinal(hHmac->hDigest, output->ptr);
+                }
+                pal_mdFree(&hHmac->hDigest);
+            }
+            if (rc == PAL_SUCCESS) {
+                output->size = ARM_UC_SHA256_SIZE;
+                result = (arm_uc_error_t) { ERR_NONE };
+            }
+        }
+
+        memset(inner, 0, sizeof(inner));
+        memset(hHmac->outer_key, 0, sizeof(hHmac->outer_key));
+    }
+
+    return result;
+}
+
 int8_t mbed_cloud_client_get_rot_128bit(uint8_t *key_buf, uint32_t length)
 {
     int8_t rv = -1;
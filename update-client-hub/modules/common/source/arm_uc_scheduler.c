@@ -26,13 +26,28 @@
 
 #include "atomic-queue/atomic-queue.h"
 
+#if ARM_UC_SCHEDULER_LATENCY_METRICS
+#include "pal.h"
+#endif
+
 static struct atomic_queue arm_uc_queue = { 0 };
+/* Priority lane, emptied before arm_uc_queue */
+static struct atomic_queue arm_uc_priority_queue = { 0 };
 static void (*arm_uc_notificationHandler)(void) = NULL;
 static volatile uintptr_t callbacks_pending = 0;
 
+#if ARM_UC_SCHEDULER_LATENCY_METRICS
+static uint32_t max_latency_msecs = 0;
+#endif
+
+static bool queues_empty(void)
+{
+    return (arm_uc_priority_queue.tail == NULL) && (arm_uc_queue.tail == NULL);
+}
+
 int32_t ARM_UC_SchedulerGetQueuedCount(void)
 {
-    return aq_count(&arm_uc_queue);
+    return aq_count(&arm_uc_priority_queue) + aq_count(&arm_uc_queue);
 }
 
 #if ARM_UC_SCHEDULER_STORAGE_POOL_SIZE
@@ -74,6 +89,9 @@ void ARM_UC_SchedulerInit(void)
     memset(&plugin_error_callback, 0, sizeof(arm_uc_callback_t));
     callbacks_pending = 0;
     plugin_error_pending = 0;
+#if ARM_UC_SCHEDULER_LATENCY_METRICS
+    max_latency_msecs = 0;
+#endif
 }
 
 /**
@@ -162,6 +180,15 @@ uint32_t ARM_UC_SchedulerGetHighWatermark(void)
     return i;
 }
 
+uint32_t ARM_UC_SchedulerGetMaxLatency(void)
+{
+#if ARM_UC_SCHEDULER_LATENCY_METRICS
+    return max_latency_msecs;
+#else
+    return 0;
+#endif
+}
+
 
 void ARM_UC_AddNotificationHandler(void (*handler)(void))
 {
@@ -173,10 +200,11 @@ void ARM_UC_SetSchedulerErrorHandler(void(*handler)(uint32_t))
     scheduler_error_cb = handler;
 }
 
-bool ARM_UC_PostCallbackCtx(arm_uc_callback_t *_storage,
-                            void *_ctx,
-                            arm_uc_context_callback_t _callback,
-                            uintptr_t _parameter)
+static bool post_callback(struct atomic_queue *queue,
+                          arm_uc_callback_t *_storage,
+                          void *_ctx,
+                          arm_uc_context_callback_t _callback,
+                          uintptr_t _parameter)
 {
     bool success = true;
     UC_SDLR_TRACE("%s Scheduling %p(%lu) with %p (context %p)", __PRETTY_FUNCTION__, _callback, _parameter, _storage, _ctx);
@@ -249,11 +277,14 @@ bool ARM_UC_PostCallbackCtx(arm_uc_callback_t *_storage,
         /* populate callback struct */
         _storage->callback = (void*)_callback;
         _storage->parameter = _parameter;
+#if ARM_UC_SCHEDULER_LATENCY_METRICS
+        _storage->posted_ticks = pal_osKernelSysTick();
+#endif
 
         UC_SDLR_TRACE("%s Queueing %p(%lu) in %p", __PRETTY_FUNCTION__, _callback, _parameter, _storage);
 
         /* push struct to atomic queue */
-        int result = aq_push_tail(&arm_uc_queue, (void *) _storage);
+        int result = aq_push_tail(queue, (void *) _storage);
 
         if (result == ATOMIC_QUEUE_SUCCESS) {
             UC_SDLR_TRACE("%s Scheduling success!", __PRETTY_FUNCTION__);
@@ -265,7 +296,7 @@ bool ARM_UC_PostCallbackCtx(arm_uc_callback_t *_storage,
              * If successful, notify.
              */
             if (arm_uc_notificationHandler) {
-                while (callbacks_pending == 0 && arm_uc_queue.tail != NULL) {
+                while (callbacks_pending == 0 && !queues_empty()) {
                     // Remove volatile qualifier from callbacks_pending
                     int cas_result = aq_atomic_cas_uintptr((uintptr_t *)&callbacks_pending, 0, 1);
                     if (cas_result) {
@@ -284,6 +315,14 @@ bool ARM_UC_PostCallbackCtx(arm_uc_callback_t *_storage,
     return success;
 }
 
+bool ARM_UC_PostCallbackCtx(arm_uc_callback_t *_storage,
+                            void *_ctx,
+                            arm_uc_context_callback_t _callback,
+                            uintptr_t _parameter)
+{
+    return post_callback(&arm_uc_queue, _storage, _ctx, _callback, _parameter);
+}
+
 bool ARM_UC_PostCallback(arm_uc_callback_t *_storage,
                          arm_uc_no_context_callback_t _callback,
                          uintptr_t _parameter)
@@ -291,6 +330,22 @@ bool ARM_UC_PostCallback(arm_uc_callback_t *_storage,
     return ARM_UC_PostCallbackCtx(_storage, ATOMIC_QUEUE_NO_CONTEXT, (arm_uc_context_callback_t)_callback, _parameter);
 }
 
+bool ARM_UC_PostPriorityCallbackCtx(arm_uc_callback_t *_storage,
+                                    void *_ctx,
+                                    arm_uc_context_callback_t _callback,
+                                    uintptr_t _parameter)
+{
+    return post_callback(&arm_uc_priority_queue, _storage, _ctx, _callback, _parameter);
+}
+
+bool ARM_UC_PostPriorityCallback(arm_uc_callback_t *_storage,
+                                 arm_uc_no_context_callback_t _callback,
+                                 uintptr_t _parameter)
+{
+    return ARM_UC_PostPriorityCallbackCtx(_storage, ATOMIC_QUEUE_NO_CONTEXT,
+                                          (arm_uc_context_callback_t)_callback, _parameter);
+}
+
 bool ARM_UC_PostErrorCallbackCtx(void *_ctx, arm_uc_context_callback_t _callback, uintptr_t _parameter)
 {
     UC_SDLR_TRACE("%s Scheduling error callback %p with parameter %lu and context %p", __PRETTY_FUNCTION__, _callback, _parameter, _ctx);
@@ -362,7 +417,7 @@ static bool try_clear_callbacks_pending() {
     while (true) {
         /* Preserve local copies of callbacks_pending and queue_empty */
         uintptr_t cbp_local = callbacks_pending;
-        bool queue_empty = arm_uc_queue.tail == NULL;
+        bool queue_empty = queues_empty();
         /* Case 1 */
         /* Flag clear, no elements queued. Nothing to do */
         if (!cbp_local && queue_empty) {
@@ -418,9 +473,13 @@ bool ARM_UC_ProcessElement(bool execute)
         plugin_error_pending = 0;
         element = &plugin_error_callback;
     }
-    /* If the error callback isn't taken, get an element from the queue */
+    /* If the error callback isn't taken, get an element from the priority
+     * queue, then from the normal queue */
     else {
-        element = (arm_uc_callback_t *) aq_pop_head(&arm_uc_queue);
+        element = (arm_uc_callback_t *) aq_pop_head(&arm_uc_priority_queue);
+        if (element == NULL) {
+            element = (arm_uc_callback_t *) aq_pop_head(&arm_uc_queue);
+        }
         /* If the queue is empty */
         if (element == NULL) {
             /* Try to shut down queue processing */
@@ -434,6 +493,14 @@ bool ARM_UC_ProcessElement(bool execute)
         void *callback =  element->callback;
         /* Store the parameter locally */
         uintptr_t parameter = element->parameter;
+#if ARM_UC_SCHEDULER_LATENCY_METRICS
+        if (element != &plugin_error_callback) {
+            uint32_t latency = (uint32_t)pal_osKernelSysMilliSecTick(pal_osKernelSysTick() - element->posted_ticks);
+            if (latency > max_latency_msecs) {
+                max_latency_msecs = latency;
+            }
+        }
+#endif
         /* Release the lock on the element */
         UC_SDLR_TRACE("%s Releasing %p", __PRETTY_FUNCTION__, element);
         void *ctx;
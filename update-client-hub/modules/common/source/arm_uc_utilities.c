@@ -444,4 +444,83 @@ size_t arm_uc_calculate_full_uri_length(const arm_uc_uri_t *uri)
             scheme_length);
 }
 
+void arm_uc_write_combine_init(arm_uc_write_combine_t *wc,
+                               uint8_t *buffer,
+                               uint32_t size,
+                               uint32_t page_size,
+                               arm_uc_program_t program)
+{
+    wc->buffer = buffer;
+    wc->size = (page_size != 0 && size % page_size == 0) ? size : 0;
+    wc->used = 0;
+    wc->limit = 0;
+    wc->address = 0;
+    wc->page_size = page_size;
+    wc->program = program;
+}
+
+int32_t arm_uc_write_combine_program(arm_uc_write_combine_t *wc,
+                                     const uint8_t *data,
+                                     uint32_t address,
+                                     uint32_t size)
+{
+    int32_t status = 0;
+
+    if (wc->size == 0) {
+        return wc->program(data, address, size);
+    }
+
+    /* only sequential data can be combined */
+    if (wc->used > 0 && address != wc->address + wc->used) {
+        status = arm_uc_write_combine_flush(wc);
+    }
+
+    while (status == 0 && size > 0) {
+        if (wc->used == 0) {
+            wc->address = address;
+            /* end the first chunk on a buffer sized boundary, so that the
+               following ones are aligned to it */
+            wc->limit = wc->size - (address % wc->size);
+
+            /* whole aligned chunks are programmed without copying */
+            if (wc->limit == wc->size && size >= wc->size) {
+                uint32_t direct_size = size - (size % wc->size);
+                status = wc->program(data, address, direct_size);
+                data += direct_size;
+                address += direct_size;
+                size -= direct_size;
+                continue;
+            }
+        }
+
+        uint32_t copy_size = ARM_UC_util_min(wc->limit - wc->used, size);
+        memcpy(&wc->buffer[wc->used], data, copy_size);
+        wc->used += copy_size;
+        data += copy_size;
+        address += copy_size;
+        size -= copy_size;
+
+        if (wc->used == wc->limit) {
+            status = wc->program(wc->buffer, wc->address, wc->used);
+            wc->used = 0;
+        }
+    }
+
+    return status;
+}
+
+int32_t arm_uc_write_combine_flush(arm_uc_write_combine_t *wc)
+{
+    int32_t status = 0;
+
+    if (wc->used > 0) {
+        uint32_t padded_size = ((wc->used + wc->page_size - 1) / wc->page_size) * wc->page_size;
+        memset(&wc->buffer[wc->used], 0xFF, padded_size - wc->used);
+        status = wc->program(wc->buffer, wc->address, padded_size);
+        wc->used = 0;
+    }
+
+    return status;
+}
+
 #endif // ARM_UC_ENABLE
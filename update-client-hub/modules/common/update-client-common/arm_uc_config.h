@@ -429,6 +429,13 @@ ARM_UC_FEATURE_SIMPLE_COAP_SOURCE
 // NOTE: The charset must be sorted except for the trailing character which is used as a padding character.
 #define MBED_CLOUD_UPDATE_BASE64_CHARSET "0123456789@ABCDEFGHIJKLMNOPQRSTUVWXYZ_abcdefghijklmnopqrstuvwxyz-"
 
+/* Keep the device key in RAM once it has been derived from the root of trust,
+   so the metadata header HMAC does not derive it again on every use.
+*/
+#ifndef ARM_UC_FEATURE_DEVICE_KEY_CACHE
+#define ARM_UC_FEATURE_DEVICE_KEY_CACHE 1
+#endif
+
 #ifndef ARM_UC_SCHEDULER_STORAGE_POOL_SIZE
 #define ARM_UC_SCHEDULER_STORAGE_POOL_SIZE 32
 #endif
@@ -459,5 +466,10 @@ ARM_UC_FEATURE_SIMPLE_COAP_SOURCE
 #define BS_PATCH_COMPILE_TIME_MEMORY_ALLOC 1024
 #endif
 
+// Size of read-ahead window over original image in delta-paal, 0 disables it
+#ifndef ARM_UC_DELTAPAAL_READ_CACHE_SIZE
+#define ARM_UC_DELTAPAAL_READ_CACHE_SIZE 0
+#endif
+
 #endif // ARM_UC_ENABLE
 #endif // ARM_UPDATE_CONFIG_H
@@ -39,6 +39,13 @@ typedef struct arm_uc_cipherHandle_t {
 } arm_uc_cipherHandle_t;
 
 #define ARM_UC_CU_SHA256 PAL_SHA256
+#define ARM_UC_SHA256_BLOCK_SIZE (512/8)
+
+/* PAL has no incremental HMAC, it is built on the streaming hash */
+typedef struct arm_uc_hmacHandle_t {
+    palMDHandle_t hDigest;
+    uint8_t outer_key[ARM_UC_SHA256_BLOCK_SIZE];
+} arm_uc_hmacHandle_t;
 
 #elif defined(ARM_UC_FEATURE_CRYPTO_MBEDTLS) && (ARM_UC_FEATURE_CRYPTO_MBEDTLS == 1) // ARM_UC_FEATURE_CRYPTO_PAL
 
@@ -58,6 +65,8 @@ typedef struct arm_uc_cipherHandle_t {
     size_t   aes_nc_off;
 } arm_uc_cipherHandle_t;
 
+typedef mbedtls_md_context_t arm_uc_hmacHandle_t;
+
 #define ARM_UC_CU_SHA256 MBEDTLS_MD_SHA256
 
 #else // ARM_UC_FEATURE_CRYPTO_PAL
@@ -75,6 +84,32 @@ arm_uc_error_t ARM_UC_cryptoDecryptSetup(arm_uc_cipherHandle_t *h, arm_uc_buffer
 arm_uc_error_t ARM_UC_cryptoDecryptUpdate(arm_uc_cipherHandle_t *h, const uint8_t *input_ptr, uint32_t input_size,
                                           arm_uc_buffer_t *output);
 arm_uc_error_t ARM_UC_cryptoDecryptFinish(arm_uc_cipherHandle_t *h, arm_uc_buffer_t *output);
+
+/**
+ * @brief Start an incremental HMAC-SHA256
+ * @details The message is fed in any number of pieces with ARM_UC_cryptoHMACSHA256Update,
+ *          the result is the same as ARM_UC_cryptoHMACSHA256 over the whole message.
+ *          Once the setup succeeded, ARM_UC_cryptoHMACSHA256Finish must be called
+ *          to release the handle, also after a failed update.
+ *
+ * @param h   handle to initialize
+ * @param key buffer struct containing the hmac key
+ *
+ * @return ERR_NONE on success, error code on failure.
+ */
+arm_uc_error_t ARM_UC_cryptoHMACSHA256Setup(arm_uc_hmacHandle_t *h, const arm_uc_buffer_t *key);
+arm_uc_error_t ARM_UC_cryptoHMACSHA256Update(arm_uc_hmacHandle_t *h, const arm_uc_buffer_t *input);
+
+/**
+ * @brief Finish an incremental HMAC-SHA256 and release the handle
+ *
+ * @param h      handle set up with ARM_UC_cryptoHMACSHA256Setup
+ * @param output buffer struct to contain the output HMAC.
+ *               The size member of the struct will be set on success.
+ *
+ * @return ERR_NONE on success, error code on failure.
+ */
+arm_uc_error_t ARM_UC_cryptoHMACSHA256Finish(arm_uc_hmacHandle_t *h, arm_uc_buffer_t *output);
 #endif // ARM_UC_ENABLE 1
 
 /**
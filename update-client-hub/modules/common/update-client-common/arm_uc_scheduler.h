@@ -158,8 +158,23 @@
  * high watermark of the pool: ARM_UC_SchedulerGetHighWatermark(). This can be
  * compared to ARM_UC_SCHEDULER_STORAGE_POOL_SIZE to determine how many
  * elements were left at maximum usage.
+ *
+ * Priority Lane:
+ * Callbacks posted with ARM_UC_PostPriorityCallback() go into a second queue,
+ * which is always emptied before the normal queue. Error and control events
+ * use it, so that they are not held up behind a long run of queued
+ * fragment-processing callbacks. Within each lane the order stays FIFO.
+ *
+ * Queue Latency:
+ * If ARM_UC_SCHEDULER_LATENCY_METRICS is set to 1, every callback is stamped
+ * when posted, and ARM_UC_SchedulerGetMaxLatency() returns the longest time a
+ * callback has waited in the queue.
  */
 
+#ifndef ARM_UC_SCHEDULER_LATENCY_METRICS
+#define ARM_UC_SCHEDULER_LATENCY_METRICS 0
+#endif
+
 /**
  * Use custom struct for the lockfree queue.
  * Struct contains function pointer callback and uint32_t parameter.
@@ -174,6 +189,9 @@ struct lockfree_queue_element {
     uintptr_t lock;
     void *callback;
     uintptr_t parameter;
+#if ARM_UC_SCHEDULER_LATENCY_METRICS
+    uint64_t posted_ticks;
+#endif
 };
 
 #include "atomic-queue/atomic-queue.h"
@@ -212,6 +230,31 @@ bool ARM_UC_PostCallback(arm_uc_callback_t *storage, arm_uc_no_context_callback_
  */
 bool ARM_UC_PostCallbackCtx(arm_uc_callback_t *storage, void *ctx, arm_uc_context_callback_t callback, uintptr_t parameter);
 
+/**
+ * @brief Add function to be executed to the priority queue.
+ * @details As ARM_UC_PostCallback(), but the callback is dispatched before all
+ *          callbacks in the normal queue. Intended for error and control events.
+ *
+ * @param storage Pointer to struct lockfree_queue_element.
+ * @param callback Function pointer to function being scheduled to run later.
+ * @param parameter uintptr_t value to be passed as parameter to the callback function.
+ * @return True when the callback was successfully scheduled.
+ */
+bool ARM_UC_PostPriorityCallback(arm_uc_callback_t *storage, arm_uc_no_context_callback_t callback, uintptr_t parameter);
+
+/**
+ * @brief Add function to be executed to the priority queue and associate a context with it.
+ * @details As ARM_UC_PostCallbackCtx(), but the callback is dispatched before all
+ *          callbacks in the normal queue.
+ *
+ * @param storage Pointer to struct lockfree_queue_element.
+ * @param[in] ctx The callback context, or ATOMIC_QUEUE_NO_CONTEXT.
+ * @param callback Function pointer to function being scheduled to run later.
+ * @param parameter uintptr_t value to be passed as parameter to the callback function.
+ * @return True when the callback was successfully scheduled.
+ */
+bool ARM_UC_PostPriorityCallbackCtx(arm_uc_callback_t *storage, void *ctx, arm_uc_context_callback_t callback, uintptr_t parameter);
+
 /**
  * @brief Schedule an error callback.
  * @details The error callback has priority over the other callbacks: as long as
@@ -277,6 +320,15 @@ void ARM_UC_SetSchedulerErrorHandler(void(*handler)(uint32_t));
  */
 uint32_t ARM_UC_SchedulerGetHighWatermark(void);
 
+/**
+ * @brief Get the longest time a callback has waited in the queue.
+ * @details Measured from posting the callback to dispatching it, over both
+ * lanes. Only available if ARM_UC_SCHEDULER_LATENCY_METRICS is set to 1.
+ *
+ * @return the maximum queue latency in milliseconds, or 0 if not measured.
+ */
+uint32_t ARM_UC_SchedulerGetMaxLatency(void);
+
 /**
  * @brief Get the current number of queued callbacks
  * @details This is a function for running tests. The value returned by this
@@ -156,6 +156,68 @@ void ARM_UC_Base64Dec(arm_uc_buffer_t *bin, const uint32_t size, const uint8_t *
  */
 size_t arm_uc_calculate_full_uri_length(const arm_uc_uri_t *uri);
 
+/**
+ * @brief Storage program function, returns 0 on success.
+ */
+typedef int32_t (*arm_uc_program_t)(const uint8_t *buffer, uint32_t address, uint32_t size);
+
+/**
+ * @brief Write-combining buffer in front of a storage program function.
+ * @details Collects sequential fragments into one buffer, so that storage is
+ *          programmed in buffer sized, buffer aligned chunks instead of one
+ *          call per fragment.
+ */
+typedef struct {
+    uint8_t *buffer;
+    uint32_t size;
+    uint32_t used;
+    uint32_t limit;
+    uint32_t address;
+    uint32_t page_size;
+    arm_uc_program_t program;
+} arm_uc_write_combine_t;
+
+/**
+ * @brief Set up a write-combining buffer, discarding any buffered data.
+ * @details If size is not a multiple of page_size, combining is disabled and
+ *          writes are passed directly to the program function.
+ *
+ * @param wc Write-combining buffer.
+ * @param buffer Memory for the buffer.
+ * @param size Size of the buffer, a multiple of the program page size.
+ * @param page_size Program page size of the storage.
+ * @param program Function for programming the storage.
+ */
+void arm_uc_write_combine_init(arm_uc_write_combine_t *wc,
+                               uint8_t *buffer,
+                               uint32_t size,
+                               uint32_t page_size,
+                               arm_uc_program_t program);
+
+/**
+ * @brief Write data through the write-combining buffer.
+ * @details Buffered data that does not end where the new data starts is
+ *          flushed first.
+ *
+ * @param wc Write-combining buffer.
+ * @param data Data to write.
+ * @param address Storage address of the data.
+ * @param size Size of the data.
+ * @return 0 on success, otherwise the program function's error.
+ */
+int32_t arm_uc_write_combine_program(arm_uc_write_combine_t *wc,
+                                     const uint8_t *data,
+                                     uint32_t address,
+                                     uint32_t size);
+
+/**
+ * @brief Program the buffered data, padded to a whole page with 0xFF.
+ *
+ * @param wc Write-combining buffer.
+ * @return 0 on success, otherwise the program function's error.
+ */
+int32_t arm_uc_write_combine_flush(arm_uc_write_combine_t *wc);
+
 #ifdef __cplusplus
 }
 #endif
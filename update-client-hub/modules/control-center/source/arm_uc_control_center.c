@@ -318,9 +318,9 @@ arm_uc_error_t ARM_UC_ControlCenter_Reject(arm_uc_request_t request, arm_uc_reje
  */
 void ARM_UC_ControlCenter_OverrideAuthorization(void)
 {
-    ARM_UC_PostCallback(&arm_uccc_override_callback,
-                        arm_uccc_override_task,
-                        0);
+    ARM_UC_PostPriorityCallback(&arm_uccc_override_callback,
+                                arm_uccc_override_task,
+                                0);
 }
 
 static void arm_uccc_override_task(uintptr_t unused)
@@ -56,6 +56,12 @@ static arm_uc_callback_t arm_uc_deltapaal_write_async_callback = { 0 };
   */
 // to store bspatch original seek diff and use it in original read
 static int64_t arm_uc_pal_deltapaal_bspatch_seek_diff = 0;
+#if (ARM_UC_DELTAPAAL_READ_CACHE_SIZE > 0)
+// read-ahead window over original image, holding cache_size bytes from cache_offset
+static uint8_t arm_uc_pal_deltapaal_cache_buf[ARM_UC_DELTAPAAL_READ_CACHE_SIZE];
+static uint32_t arm_uc_pal_deltapaal_cache_offset = 0;
+static uint32_t arm_uc_pal_deltapaal_cache_size = 0;
+#endif
 // to store the offset of full target new file being written
 static uint32_t arm_uc_pal_deltapaal_bspatch_new_offset = 0;
 // to keep offset how much of incoming buffer we have consumed
@@ -142,6 +148,35 @@ static bs_patch_api_return_code_t arm_uc_deltapaal_original_seek(const struct bs
     return EBSAPI_OPERATION_DONE_IMMEDIATELY;
 }
 
+#if (ARM_UC_DELTAPAAL_READ_CACHE_SIZE > 0)
+/**
+ * @brief arm_uc_deltapaal_original_read_cached - Serve a short original image read from the read-ahead window
+ * @details Window is refilled from the read offset on a miss. If a full window can not be read
+ *          (e.g. near end of flash), the read falls back to reading only the requested bytes.
+ * @param buffer buffer where read data should be stored
+ * @param length amount to read, smaller than the window
+ * @return ERR_NONE on success, error code otherwise
+ */
+static int arm_uc_deltapaal_original_read_cached(uint8_t* buffer, uint32_t length)
+{
+    uint32_t offset = (uint32_t)arm_uc_pal_deltapaal_bspatch_seek_diff;
+
+    if ((offset < arm_uc_pal_deltapaal_cache_offset) ||
+        (offset + length > arm_uc_pal_deltapaal_cache_offset + arm_uc_pal_deltapaal_cache_size)) {
+        arm_uc_pal_deltapaal_cache_size = 0;
+        if (arm_uc_deltapaal_original_reader(arm_uc_pal_deltapaal_cache_buf,
+                                             ARM_UC_DELTAPAAL_READ_CACHE_SIZE, offset) != ERR_NONE) {
+            return arm_uc_deltapaal_original_reader(buffer, length, offset);
+        }
+        arm_uc_pal_deltapaal_cache_offset = offset;
+        arm_uc_pal_deltapaal_cache_size = ARM_UC_DELTAPAAL_READ_CACHE_SIZE;
+    }
+
+    memcpy(buffer, arm_uc_pal_deltapaal_cache_buf + (offset - arm_uc_pal_deltapaal_cache_offset), length);
+    return ERR_NONE;
+}
+#endif
+
 /**
  * @brief arm_uc_deltapaal_original_read - BsPatch callback function to Read data from the original file/image
  * @param stream pointer to bspatch_stream
@@ -158,7 +193,14 @@ static bs_patch_api_return_code_t arm_uc_deltapaal_original_read(const struct bs
     int status = -1;
     (void)stream;
 
-    status = arm_uc_deltapaal_original_reader(buffer, length, (uint32_t)arm_uc_pal_deltapaal_bspatch_seek_diff);
+#if (ARM_UC_DELTAPAAL_READ_CACHE_SIZE > 0)
+    if (length < ARM_UC_DELTAPAAL_READ_CACHE_SIZE) {
+        status = arm_uc_deltapaal_original_read_cached(buffer, (uint32_t)length);
+    } else
+#endif
+    {
+        status = arm_uc_deltapaal_original_reader(buffer, length, (uint32_t)arm_uc_pal_deltapaal_bspatch_seek_diff);
+    }
 
     // @todo: Check read lenght: did we get everything ?
 
@@ -312,6 +354,10 @@ static void arm_uc_deltapaal_reset_internals(void)
 {
     UC_PAAL_TRACE("arm_uc_deltapaal_reset_internals");
     arm_uc_pal_deltapaal_bspatch_seek_diff = 0;
+#if (ARM_UC_DELTAPAAL_READ_CACHE_SIZE > 0)
+    arm_uc_pal_deltapaal_cache_offset = 0;
+    arm_uc_pal_deltapaal_cache_size = 0;
+#endif
     arm_uc_pal_deltapaal_bspatch_new_offset = 0;
     arm_uc_pal_deltapaal_incoming_hub_buf_ref_offset = 0;
     bspatch_read_patch_buffer_ptr = NULL;
@@ -19,7 +19,9 @@
 #include "arm_uc_mmDerManifestParser.h"
 #include "update-client-common/arm_uc_config.h"
 
+#include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 
 #define DER_MANDATORY 0
 #define DER_OPTIONAL 1
@@ -935,6 +937,184 @@ int32_t ARM_UC_mmDERParseTree(const struct arm_uc_mmDerElement *desc, arm_uc_buf
     }
     return rc;
 }
+#if ARM_UC_MM_DER_FIELD_INDEX
+/* Location of one field inside the indexed manifest. Offset 0 is the outer
+ * SEQUENCE tag, so it doubles as the "not present" marker for every other
+ * field; the root itself is never looked up through the index.
+ */
+typedef struct {
+    uint32_t offset;
+    uint32_t size;
+} arm_uc_mmDerFieldRef_t;
+
+#define ARM_UC_MM_DER_INDEX_DIGEST_BYTES 32
+
+static struct {
+    const uint8_t *ptr;
+    uint32_t size;
+    bool valid;
+    uint8_t digest[ARM_UC_MM_DER_INDEX_DIGEST_BYTES];
+    uint32_t digestSize;
+    arm_uc_mmDerFieldRef_t fields[ARM_UC_MM_DER_ID_COUNT];
+} arm_uc_mm_derIndex;
+
+/**
+ * @brief Records the location of every element of a DER tree
+ * @details Walks the tree the same way as `ARM_UC_mmDERGetValues`, but records every element it passes instead of
+ * a list of requested ones. Only the first occurrence of an ID is kept, which is the one `ARM_UC_mmDERGetValues`
+ * would return. Elements that are not found are left unrecorded; looking those up goes through the regular parser,
+ * which keeps its error reporting for missing fields.
+ *
+ * @param[in] desc  Contains the current parsing descriptor
+ * @param[in] pos   Pointer to pointer that holds the current parsing location
+ * @param[in] end   Pointer to the end of the current element's container
+ * @param[in] base  Start of the indexed buffer
+ * @retval 0 Success, otherwise a parser error
+ */
+static int32_t ARM_UC_mmDERIndexValues(const struct arm_uc_mmDerElement *desc, uint8_t **pos, uint8_t *end,
+                                       const uint8_t *base)
+{
+    size_t len;
+    int rc;
+    uint8_t *ElementEnd;
+
+    if (desc->tag == ARM_UC_MM_ASN1_CHOICE) {
+        int tag;
+        unsigned i;
+        rc = ARM_UC_mmDERPeekTag(*pos, end, &tag);
+        if (rc) {
+            return rc;
+        }
+        for (i = 0; i < desc->nSubElements; i++) {
+            if (tag == desc->subElements[i].tag) {
+                return ARM_UC_mmDERIndexValues(&desc->subElements[i], pos, end, base);
+            }
+        }
+        return ARM_UC_DP_ERR_ASN1_UNEXPECTED_TAG;
+    }
+    uint8_t *seqpos = *pos;
+    rc = ARM_UC_MM_ASN1_get_tag(pos, end, &len, desc->tag);
+    if (rc == ARM_UC_DP_ERR_ASN1_UNEXPECTED_TAG && desc->optional) {
+        return 0;
+    }
+    if (rc) {
+        return rc;
+    }
+    if (desc->id < ARM_UC_MM_DER_ID_COUNT && arm_uc_mm_derIndex.fields[desc->id].offset == 0) {
+        arm_uc_mmDerFieldRef_t *field = &arm_uc_mm_derIndex.fields[desc->id];
+        // Sequences are stored whole, as in ARM_UC_mmDERGetValues
+        if (desc->tag == (ARM_UC_MM_ASN1_CONSTRUCTED | ARM_UC_MM_ASN1_SEQUENCE) && desc->nSubElements != 1) {
+            field->offset = seqpos - base;
+            field->size = len + (*pos - seqpos);
+        } else {
+            field->offset = *pos - base;
+            field->size = len;
+        }
+    }
+    ElementEnd = *pos + len;
+    // SEQUENCE OF elements are not entered, their contents are extracted with ARM_UC_mmDERGetSequenceElement
+    if (desc->tag == (ARM_UC_MM_ASN1_CONSTRUCTED | ARM_UC_MM_ASN1_SEQUENCE) && desc->nSubElements != 1) {
+        int i;
+        end = *pos + len;
+        for (i = 0; rc == 0 && i < desc->nSubElements; i++) {
+            if (!(*pos >= end && desc->subElements[i].optional)) {
+                rc = ARM_UC_mmDERIndexValues(&desc->subElements[i], pos, end, base);
+            }
+        }
+    }
+    if (*pos > ElementEnd) {
+        return ARM_UC_DP_ERR_ASN1_LENGTH_MISMATCH;
+    }
+    *pos = ElementEnd;
+    return rc;
+}
+
+/**
+ * @brief Checks whether the index describes the manifest in the buffer
+ * @details The same buffer is reused for every manifest, so the pointer and size alone do not identify the
+ * manifest. The manifest digest covers the whole resource, so comparing it at the recorded offset catches a different
+ * manifest of the same size.
+ */
+static bool ARM_UC_mmDERIndexMatches(const arm_uc_buffer_t *buffer)
+{
+    const arm_uc_mmDerFieldRef_t *hash = &arm_uc_mm_derIndex.fields[ARM_UC_MM_DER_SIG_HASH];
+    return arm_uc_mm_derIndex.valid &&
+           arm_uc_mm_derIndex.ptr == buffer->ptr &&
+           arm_uc_mm_derIndex.size == buffer->size &&
+           memcmp(buffer->ptr + hash->offset, arm_uc_mm_derIndex.digest, arm_uc_mm_derIndex.digestSize) == 0;
+}
+
+static void ARM_UC_mmDERIndexBuild(const arm_uc_buffer_t *buffer)
+{
+    uint8_t *pos = buffer->ptr;
+    const arm_uc_mmDerFieldRef_t *hash = &arm_uc_mm_derIndex.fields[ARM_UC_MM_DER_SIG_HASH];
+
+    ARM_UC_mmDERFlushIndex();
+    if (ARM_UC_mmDERIndexValues(&SignedResource, &pos, buffer->ptr + buffer->size, buffer->ptr) != 0 ||
+            hash->offset == 0) {
+        ARM_UC_mmDERFlushIndex();
+        return;
+    }
+    arm_uc_mm_derIndex.ptr = buffer->ptr;
+    arm_uc_mm_derIndex.size = buffer->size;
+    arm_uc_mm_derIndex.digestSize = hash->size < ARM_UC_MM_DER_INDEX_DIGEST_BYTES ?
+                                    hash->size : ARM_UC_MM_DER_INDEX_DIGEST_BYTES;
+    memcpy(arm_uc_mm_derIndex.digest, buffer->ptr + hash->offset, arm_uc_mm_derIndex.digestSize);
+    arm_uc_mm_derIndex.valid = true;
+}
+
+/**
+ * @brief Looks up signed resource values from the field index
+ * @details Builds the index if the buffer holds a different manifest than the indexed one. The values are only
+ * returned if all of them are present, otherwise the caller falls back to `ARM_UC_mmDERParseTree`, so that missing
+ * fields are reported exactly as before.
+ * @retval true All values were found and written to `buffers`
+ */
+static bool ARM_UC_mmDERIndexLookup(arm_uc_buffer_t *buffer, uint32_t nValues, const int32_t *valueIDs,
+                                    arm_uc_buffer_t *buffers)
+{
+    uint32_t i;
+    if (buffer == NULL || buffer->ptr == NULL) {
+        return false;
+    }
+    if (!ARM_UC_mmDERIndexMatches(buffer)) {
+        ARM_UC_mmDERIndexBuild(buffer);
+        if (!arm_uc_mm_derIndex.valid) {
+            return false;
+        }
+    }
+    for (i = 0; i < nValues; i++) {
+        if (valueIDs[i] <= ARM_UC_MM_DER_ROOT || valueIDs[i] >= ARM_UC_MM_DER_ID_COUNT ||
+                arm_uc_mm_derIndex.fields[valueIDs[i]].offset == 0) {
+            return false;
+        }
+    }
+    // The buffer may be one of the output buffers
+    uint8_t *base = buffer->ptr;
+    for (i = 0; i < nValues; i++) {
+        const arm_uc_mmDerFieldRef_t *field = &arm_uc_mm_derIndex.fields[valueIDs[i]];
+        buffers[i].ptr = base + field->offset;
+        buffers[i].size = field->size;
+        buffers[i].size_max = field->size;
+    }
+    return true;
+}
+
+/**
+ * @brief Forgets the indexed manifest
+ * @details The index is checked against the manifest digest on every lookup, so this is only needed to release the
+ * reference to a buffer that is about to be freed or reused for something else than a manifest.
+ */
+void ARM_UC_mmDERFlushIndex(void)
+{
+    memset(&arm_uc_mm_derIndex, 0, sizeof(arm_uc_mm_derIndex));
+}
+#else
+void ARM_UC_mmDERFlushIndex(void)
+{
+}
+#endif // ARM_UC_MM_DER_FIELD_INDEX
+
 /**
  * @brief Parses a tree of DER data by calling `ARM_UC_mmDERGetValues`
  * @details Populates a parser state with the IDs to be extracted, the number of values and the buffers to extract into
@@ -952,5 +1132,10 @@ int32_t ARM_UC_mmDERParseTree(const struct arm_uc_mmDerElement *desc, arm_uc_buf
 int32_t ARM_UC_mmDERGetSignedResourceValues(arm_uc_buffer_t *buffer, uint32_t nValues, const int32_t *valueIDs,
                                             arm_uc_buffer_t *buffers)
 {
+#if ARM_UC_MM_DER_FIELD_INDEX
+    if (ARM_UC_mmDERIndexLookup(buffer, nValues, valueIDs, buffers)) {
+        return 0;
+    }
+#endif
     return ARM_UC_mmDERParseTree(&SignedResource, buffer, nValues, valueIDs, buffers);
 }
@@ -320,8 +320,23 @@ enum derIDs {
 #define ENUM_AUTO(X) X,
     ARM_UC_MM_DER_ID_LIST
 #undef ENUM_AUTO
+    ARM_UC_MM_DER_ID_COUNT
 };
 
+/**
+ * Field index of the last parsed signed resource. When enabled, the first
+ * lookup on a manifest walks the whole DER tree once and records where every
+ * field is, so that the following lookups on the same manifest do not walk it
+ * again.
+ */
+#if defined(MBED_CONF_UPDATE_CLIENT_MANIFEST_FIELD_INDEX)
+#define ARM_UC_MM_DER_FIELD_INDEX MBED_CONF_UPDATE_CLIENT_MANIFEST_FIELD_INDEX
+#endif
+
+#ifndef ARM_UC_MM_DER_FIELD_INDEX
+#define ARM_UC_MM_DER_FIELD_INDEX 1
+#endif
+
 #define ARM_UC_DER_PARSER_ERROR_PREFIX TWO_CC('D', 'P')
 
 struct arm_uc_mmDerElement {
@@ -351,6 +366,7 @@ uint64_t ARM_UC_mmDerBuf2Uint64(arm_uc_buffer_t *buf);
 int32_t ARM_UC_mmDERGetSequenceElement(arm_uc_buffer_t *buffer, uint32_t index, arm_uc_buffer_t *element);
 int32_t ARM_UC_mmDERParseTree(const struct arm_uc_mmDerElement *desc, arm_uc_buffer_t *buffer, uint32_t nValues,
                               const int32_t *valueIDs, arm_uc_buffer_t *buffers);
+void ARM_UC_mmDERFlushIndex(void);
 
 
 #ifdef __cplusplus
@@ -23,6 +23,7 @@
 #include "update-client-common/arm_uc_config.h"
 #if defined(ARM_UC_FEATURE_CRYPTO_MBEDTLS) && (ARM_UC_FEATURE_CRYPTO_MBEDTLS == 1)
 #include "mbedtls/md.h"
+#include "update-client-common/arm_uc_crypto.h"
 
 arm_uc_error_t ARM_UC_cryptoHMACSHA256(arm_uc_buffer_t *key,
                                        arm_uc_buffer_t *input,
@@ -45,4 +46,55 @@ arm_uc_error_t ARM_UC_cryptoHMACSHA256(arm_uc_buffer_t *key,
     return result;
 }
 
+arm_uc_error_t ARM_UC_cryptoHMACSHA256Setup(arm_uc_hmacHandle_t *hHmac, const arm_uc_buffer_t *key)
+{
+    arm_uc_error_t result = (arm_uc_error_t) { ARM_UC_CU_ERR_INVALID_PARAMETER };
+
+    if (hHmac && key) {
+        mbedtls_md_init(hHmac);
+        const mbedtls_md_info_t *md_info = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+        int rv = mbedtls_md_setup(hHmac, md_info, 1);
+        if (rv == 0) {
+            rv = mbedtls_md_hmac_starts(hHmac, key->ptr, key->size);
+        }
+        if (rv == 0) {
+            result = (arm_uc_error_t) { ERR_NONE };
+        } else {
+            mbedtls_md_free(hHmac);
+        }
+    }
+
+    return result;
+}
+
+arm_uc_error_t ARM_UC_cryptoHMACSHA256Update(arm_uc_hmacHandle_t *hHmac, const arm_uc_buffer_t *input)
+{
+    arm_uc_error_t result = (arm_uc_error_t) { ARM_UC_CU_ERR_INVALID_PARAMETER };
+
+    if (hHmac && input) {
+        if (mbedtls_md_hmac_update(hHmac, input->ptr, input->size) == 0) {
+            result = (arm_uc_error_t) { ERR_NONE };
+        }
+    }
+
+    return result;
+}
+
+arm_uc_error_t ARM_UC_cryptoHMACSHA256Finish(arm_uc_hmacHandle_t *hHmac, arm_uc_buffer_t *output)
+{
+    arm_uc_error_t result = (arm_uc_error_t) { ARM_UC_CU_ERR_INVALID_PARAMETER };
+
+    if (hHmac) {
+        if (output && (output->size_max >= ARM_UC_SHA256_SIZE) &&
+                (mbedtls_md_hmac_finish(hHmac, output->ptr) == 0)) {
+            output->size = ARM_UC_SHA256_SIZE;
+            result = (arm_uc_error_t) { ERR_NONE };
+        }
+        /* also wipes the padded keys */
+        mbedtls_md_free(hHmac);
+    }
+
+    return result;
+}
+
 #endif
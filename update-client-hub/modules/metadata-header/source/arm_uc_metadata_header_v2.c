@@ -21,14 +21,28 @@
 
 #include "update-client-metadata-header/arm_uc_metadata_header_v2.h"
 #include "update-client-metadata-header/arm_uc_buffer_utilities.h"
+#include "update-client-common/arm_uc_crypto.h"
+#include <stdbool.h>
 #include <string.h>
 
-extern arm_uc_error_t ARM_UC_cryptoHMACSHA256(arm_uc_buffer_t *key, arm_uc_buffer_t *input, arm_uc_buffer_t *output);
+#if defined(ARM_UC_FEATURE_DEVICE_KEY_CACHE) && (ARM_UC_FEATURE_DEVICE_KEY_CACHE == 1)
+/* The device key is derived from the root of trust once per boot */
+static uint8_t arm_uc_device_key_cache[ARM_UC_DEVICE_KEY_SIZE];
+static bool arm_uc_device_key_cached = false;
+#endif
 
 arm_uc_error_t ARM_UC_getDeviceKey256Bit(arm_uc_buffer_t *output)
 {
     arm_uc_error_t result = (arm_uc_error_t) { ARM_UC_CU_ERR_INVALID_PARAMETER };
 
+#if defined(ARM_UC_FEATURE_DEVICE_KEY_CACHE) && (ARM_UC_FEATURE_DEVICE_KEY_CACHE == 1)
+    if (arm_uc_device_key_cached && (output->size_max >= ARM_UC_DEVICE_KEY_SIZE)) {
+        memcpy(output->ptr, arm_uc_device_key_cache, ARM_UC_DEVICE_KEY_SIZE);
+        output->size = ARM_UC_DEVICE_KEY_SIZE;
+        return (arm_uc_error_t) { ERR_NONE };
+    }
+#endif
+
     if (output->size_max >= ARM_UC_DEVICE_KEY_SIZE) {
         int8_t rv = mbed_cloud_client_get_rot_128bit(output->ptr, output->size_max);
         if (rv == 0) {
@@ -51,6 +65,50 @@ arm_uc_error_t ARM_UC_getDeviceKey256Bit(arm_uc_buffer_t *output)
         /* clear buffer on failure so we don't leak the rot */
         memset(output->ptr, 0, output->size_max);
     }
+#if defined(ARM_UC_FEATURE_DEVICE_KEY_CACHE) && (ARM_UC_FEATURE_DEVICE_KEY_CACHE == 1)
+    else if (output->size == ARM_UC_DEVICE_KEY_SIZE) {
+        memcpy(arm_uc_device_key_cache, output->ptr, ARM_UC_DEVICE_KEY_SIZE);
+        arm_uc_device_key_cached = true;
+    }
+#endif
+
+    return result;
+}
+
+/* HMAC of the external header up to the HMAC field, keyed with the device key */
+static arm_uc_error_t arm_uc_external_header_hmac_v2(const uint8_t *header, arm_uc_buffer_t *output)
+{
+    /* read 256 bit device key */
+    uint8_t key_buf[ARM_UC_DEVICE_KEY_SIZE] = { 0 };
+    arm_uc_buffer_t key = {
+        .size_max = ARM_UC_DEVICE_KEY_SIZE,
+        .size = 0,
+        .ptr = key_buf
+    };
+    arm_uc_hmacHandle_t hmac;
+
+    arm_uc_error_t result = ARM_UC_getDeviceKey256Bit(&key);
+
+    if (result.error == ERR_NONE) {
+        result = ARM_UC_cryptoHMACSHA256Setup(&hmac, &key);
+        memset(key_buf, 0, sizeof(key_buf));
+    }
+
+    if (result.error == ERR_NONE) {
+        arm_uc_buffer_t input_buf = {
+            .size_max = ARM_UC_EXTERNAL_HMAC_OFFSET_V2,
+            .size = ARM_UC_EXTERNAL_HMAC_OFFSET_V2,
+            .ptr = (uint8_t *) header
+        };
+
+        result = ARM_UC_cryptoHMACSHA256Update(&hmac, &input_buf);
+
+        /* finish also after a failed update to release the handle */
+        arm_uc_error_t status = ARM_UC_cryptoHMACSHA256Finish(&hmac, output);
+        if (result.error == ERR_NONE) {
+            result = status;
+        }
+    }
 
     return result;
 }
@@ -147,55 +205,40 @@ arm_uc_error_t arm_uc_parse_external_header_v2(const uint8_t *input,
     arm_uc_error_t result = { .code = ERR_INVALID_PARAMETER };
 
     if (input && details) {
-
-        /* read 128 bit root-of-trust */
-        uint8_t key_buf[ARM_UC_DEVICE_KEY_SIZE] = { 0 };
-        arm_uc_buffer_t key = {
-            .size_max = ARM_UC_DEVICE_KEY_SIZE,
-            .size = 0,
-            .ptr = key_buf
+        arm_uc_hash_t hmac = { 0 };
+        arm_uc_buffer_t output_buf = {
+            .size_max = sizeof(arm_uc_hash_t),
+            .size = sizeof(arm_uc_hash_t),
+            .ptr = (uint8_t *) &hmac
         };
-        arm_uc_error_t status = ARM_UC_getDeviceKey256Bit(&key);
+
+        /* calculate header HMAC */
+        arm_uc_error_t status = arm_uc_external_header_hmac_v2(input, &output_buf);
 
         if (status.error == ERR_NONE) {
             arm_uc_buffer_t input_buf = {
-                .size_max = ARM_UC_EXTERNAL_HMAC_OFFSET_V2,
-                .size = ARM_UC_EXTERNAL_HMAC_OFFSET_V2,
-                .ptr = (uint8_t *) input
-            };
-            arm_uc_hash_t hmac = { 0 };
-            arm_uc_buffer_t output_buf = {
                 .size_max = sizeof(arm_uc_hash_t),
                 .size = sizeof(arm_uc_hash_t),
-                .ptr = (uint8_t *) &hmac
+                .ptr = (uint8_t *) &input[ARM_UC_EXTERNAL_HMAC_OFFSET_V2]
             };
 
-            /* calculate header HMAC */
-            status = ARM_UC_cryptoHMACSHA256(&key, &input_buf, &output_buf);
-
-            if (status.error == ERR_NONE) {
-                input_buf.size_max = sizeof(arm_uc_hash_t);
-                input_buf.size = sizeof(arm_uc_hash_t);
-                input_buf.ptr = (uint8_t *) &input[ARM_UC_EXTERNAL_HMAC_OFFSET_V2];
+            int diff = ARM_UC_BinCompareCT(&input_buf, &output_buf);
 
-                int diff = ARM_UC_BinCompareCT(&input_buf, &output_buf);
+            if (diff == 0) {
+                details->version = arm_uc_parse_uint64(&input[ARM_UC_EXTERNAL_FIRMWARE_VERSION_OFFSET_V2]);
+                details->size = arm_uc_parse_uint64(&input[ARM_UC_EXTERNAL_FIRMWARE_SIZE_OFFSET_V2]);
 
-                if (diff == 0) {
-                    details->version = arm_uc_parse_uint64(&input[ARM_UC_EXTERNAL_FIRMWARE_VERSION_OFFSET_V2]);
-                    details->size = arm_uc_parse_uint64(&input[ARM_UC_EXTERNAL_FIRMWARE_SIZE_OFFSET_V2]);
+                memcpy(details->hash,
+                       &input[ARM_UC_EXTERNAL_FIRMWARE_HASH_OFFSET_V2],
+                       ARM_UC_SHA256_SIZE);
 
-                    memcpy(details->hash,
-                           &input[ARM_UC_EXTERNAL_FIRMWARE_HASH_OFFSET_V2],
-                           ARM_UC_SHA256_SIZE);
+                memcpy(details->campaign,
+                       &input[ARM_UC_EXTERNAL_CAMPAIGN_OFFSET_V2],
+                       ARM_UC_GUID_SIZE);
 
-                    memcpy(details->campaign,
-                           &input[ARM_UC_EXTERNAL_CAMPAIGN_OFFSET_V2],
-                           ARM_UC_GUID_SIZE);
+                details->signatureSize = 0;
 
-                    details->signatureSize = 0;
-
-                    result.code = ERR_NONE;
-                }
+                result.code = ERR_NONE;
             }
         }
     }
@@ -248,34 +291,17 @@ arm_uc_error_t arm_uc_create_external_header_v2(const arm_uc_firmware_details_t
                input->campaign,
                ARM_UC_GUID_SIZE);
 
-        /* read 256 bit device key */
-        uint8_t key_buf[ARM_UC_DEVICE_KEY_SIZE] = { 0 };
-        arm_uc_buffer_t key = {
-            .size_max = ARM_UC_DEVICE_KEY_SIZE,
-            .size = 0,
-            .ptr = key_buf
+        arm_uc_buffer_t output_buf = {
+            .size_max = sizeof(arm_uc_hash_t),
+            .size = sizeof(arm_uc_hash_t),
+            .ptr = &output->ptr[ARM_UC_EXTERNAL_HMAC_OFFSET_V2]
         };
 
-        arm_uc_error_t status = ARM_UC_getDeviceKey256Bit(&key);
-
-        if (status.error == ERR_NONE) {
-            arm_uc_buffer_t input_buf = {
-                .size_max = ARM_UC_EXTERNAL_HMAC_OFFSET_V2,
-                .size = ARM_UC_EXTERNAL_HMAC_OFFSET_V2,
-                .ptr = output->ptr
-            };
-            arm_uc_buffer_t output_buf = {
-                .size_max = sizeof(arm_uc_hash_t),
-                .size = sizeof(arm_uc_hash_t),
-                .ptr = &output->ptr[ARM_UC_EXTERNAL_HMAC_OFFSET_V2]
-            };
-
-            /* calculate header HMAC */
-            result = ARM_UC_cryptoHMACSHA256(&key, &input_buf, &output_buf);
-            if (result.error == ERR_NONE) {
-                /* set output size */
-                output->size = ARM_UC_EXTERNAL_HEADER_SIZE_V2;
-            }
+        /* calculate header HMAC */
+        result = arm_uc_external_header_hmac_v2(output->ptr, &output_buf);
+        if (result.error == ERR_NONE) {
+            /* set output size */
+            output->size = ARM_UC_EXTERNAL_HEADER_SIZE_V2;
         }
     }
 
@@ -28,6 +28,7 @@
 #include "update-client-pal-blockdevice/arm_uc_pal_blockdevice_platform.h"
 
 #include "update-client-metadata-header/arm_uc_metadata_header_v2.h"
+#include "update-client-common/arm_uc_utilities.h"
 
 #include <inttypes.h>
 
@@ -49,6 +50,10 @@
 #define MBED_CONF_UPDATE_CLIENT_STORAGE_LOCATIONS 1
 #endif
 
+#ifndef MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE
+#define MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE 0
+#endif
+
 /* consistency check */
 #if (MBED_CONF_UPDATE_CLIENT_STORAGE_PAGE == 0)
 #error Update client storage page cannot be zero.
@@ -70,6 +75,10 @@
 #error Update client buffer must be divisible by the block page size
 #endif
 
+#if (MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE % MBED_CONF_UPDATE_CLIENT_STORAGE_PAGE) != 0
+#error Update client write combine size must be divisible by the block page size
+#endif
+
 static ARM_UC_PAAL_UPDATE_SignalEvent_t pal_blockdevice_event_handler = NULL;
 static uint32_t pal_blockdevice_firmware_size = 0;
 static uint32_t pal_blockdevice_page_size = 0;
@@ -83,6 +92,18 @@ static arm_uc_buffer_t metadata_buffer = {
         .ptr = _metadata
 };
 
+#if MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE
+/* fragments are collected here and programmed in write combine sized chunks */
+static uint8_t pal_blockdevice_combine_buffer[MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE];
+static arm_uc_write_combine_t pal_blockdevice_write_combine = { 0 };
+
+/* addresses in this module are 32 bit */
+static int32_t pal_blockdevice_program(const uint8_t *buffer, uint32_t address, uint32_t size)
+{
+    return arm_uc_blockdevice_program(buffer, address, size);
+}
+#endif
+
 static void pal_blockdevice_signal_internal(uint32_t event)
 {
     if (pal_blockdevice_event_handler) {
@@ -293,6 +314,15 @@ arm_uc_error_t ARM_UC_PAL_BlockDevice_Prepare(uint32_t slot_id,
                 /* store firmware size in global */
                 pal_blockdevice_firmware_size = details->size;
 
+#if MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE
+                /* discard data left over from an earlier image */
+                arm_uc_write_combine_init(&pal_blockdevice_write_combine,
+                                          pal_blockdevice_combine_buffer,
+                                          sizeof(pal_blockdevice_combine_buffer),
+                                          pal_blockdevice_page_size,
+                                          pal_blockdevice_program);
+#endif
+
                 /* signal done */
                 pal_blockdevice_signal_internal(ARM_UC_PAAL_EVENT_PREPARE_DONE);
             } else {
@@ -355,6 +385,22 @@ arm_uc_error_t ARM_UC_PAL_BlockDevice_Write(uint32_t slot_id,
             aligned_size = buffer->size;
         }
 
+#if MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE
+        /* the write combine buffer pads the last chunk to a whole page */
+        if (result.error == ERR_NONE &&
+                (aligned_size > 0 || pal_blockdevice_firmware_size == offset + buffer->size)) {
+            status = arm_uc_write_combine_program(&pal_blockdevice_write_combine,
+                                                  buffer->ptr,
+                                                  physical_address,
+                                                  buffer->size);
+            if ((status == ARM_UC_BLOCKDEVICE_SUCCESS) &&
+                    (pal_blockdevice_firmware_size == offset + buffer->size)) {
+                status = arm_uc_write_combine_flush(&pal_blockdevice_write_combine);
+            }
+        } else {
+            status = ARM_UC_BLOCKDEVICE_FAIL;
+        }
+#else
         /* aligned write */
         if (result.error == ERR_NONE && aligned_size > 0) {
             status = arm_uc_blockdevice_program(buffer->ptr,
@@ -381,6 +427,7 @@ arm_uc_error_t ARM_UC_PAL_BlockDevice_Write(uint32_t slot_id,
                 status = ARM_UC_BLOCKDEVICE_FAIL;
             }
         }
+#endif
 
         if (status == ARM_UC_BLOCKDEVICE_SUCCESS) {
             /* set return code */
@@ -410,6 +457,15 @@ arm_uc_error_t ARM_UC_PAL_BlockDevice_Finalize(uint32_t slot_id)
 
     UC_PAAL_TRACE("ARM_UC_PAL_BlockDevice_Finalize");
 
+#if MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE
+    /* program what is left in the write combine buffer */
+    if (arm_uc_write_combine_flush(&pal_blockdevice_write_combine) != ARM_UC_BLOCKDEVICE_SUCCESS) {
+        UC_PAAL_ERR_MSG("arm_uc_blockdevice_program failed");
+        result.code = ERR_INVALID_PARAMETER;
+        return result;
+    }
+#endif
+
     pal_blockdevice_signal_internal(ARM_UC_PAAL_EVENT_FINALIZE_DONE);
 
     return result;
@@ -450,7 +506,14 @@ arm_uc_error_t ARM_UC_PAL_BlockDevice_Read(uint32_t slot_id,
         uint32_t read_size = pal_blockdevice_round_up_to_page(buffer->size);
         int32_t status = ARM_UC_BLOCKDEVICE_FAIL;
 
-        if (read_size <= buffer->size_max) {
+#if MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE
+        /* data must be in storage before it is read back */
+        int32_t flush_status = arm_uc_write_combine_flush(&pal_blockdevice_write_combine);
+#else
+        int32_t flush_status = ARM_UC_BLOCKDEVICE_SUCCESS;
+#endif
+
+        if ((flush_status == ARM_UC_BLOCKDEVICE_SUCCESS) && (read_size <= buffer->size_max)) {
             status = arm_uc_blockdevice_read(buffer->ptr,
                                              physical_address,
                                              read_size);
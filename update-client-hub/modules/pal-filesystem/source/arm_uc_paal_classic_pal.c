@@ -24,6 +24,7 @@
 #include "update-client-pal-filesystem/arm_uc_pal_extensions.h"
 #include "update-client-metadata-header/arm_uc_metadata_header_v2.h"
 #include "arm_uc_pal_filesystem_utils.h"
+#include "update-client-common/arm_uc_utilities.h"
 
 #include "pal.h"
 
@@ -34,9 +35,53 @@
 
 #define ARM_UC_FIRMWARE_FOLDER_NAME "firmware"
 
+#ifndef MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE
+#define MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE 0
+#endif
+
 /* pointer to external callback handler */
 static ARM_UC_PAAL_UPDATE_SignalEvent_t arm_uc_pal_external_callback = NULL;
 
+#if MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE
+/* Fragments are collected here and written to the image in write combine
+   sized chunks. Once the image is finalized the same buffer holds the chunk
+   read ahead for the hub, which reads the image in small buffers.
+
+   The chunk writes and reads complete before pal_imageWrite and
+   pal_imageReadToBuffer return, as in all the PAL image ports, so their
+   events are not forwarded and each PAAL call signals once.
+*/
+static uint8_t arm_uc_pal_classic_chunk_buffer[MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE];
+static arm_uc_write_combine_t arm_uc_pal_classic_write_combine = { 0 };
+static uint32_t arm_uc_pal_classic_location = UINT32_MAX;
+static bool arm_uc_pal_classic_internal = false;
+
+/* image range held in the chunk buffer after a read ahead */
+static uint32_t arm_uc_pal_classic_read_location = UINT32_MAX;
+static uint32_t arm_uc_pal_classic_read_offset = 0;
+static uint32_t arm_uc_pal_classic_read_size = 0;
+
+static int32_t arm_uc_pal_classic_program(const uint8_t *buffer, uint32_t address, uint32_t size)
+{
+    palConstBuffer_t chunk = {
+        .maxBufferLength = size,
+        .bufferLength = size,
+        .buffer = buffer
+    };
+
+    arm_uc_pal_classic_internal = true;
+    palStatus_t status = pal_imageWrite(arm_uc_pal_classic_location, address, &chunk);
+    arm_uc_pal_classic_internal = false;
+
+    return status;
+}
+
+static palStatus_t arm_uc_pal_classic_flush(void)
+{
+    return arm_uc_write_combine_flush(&arm_uc_pal_classic_write_combine);
+}
+#endif
+
 static void arm_uc_pal_classic_signal_callback(uintptr_t event)
 {
     if (arm_uc_pal_external_callback) {
@@ -68,6 +113,14 @@ static void arm_uc_pal_classic_callback(palImageEvents_t event)
     */
     tr_debug("arm_uc_pal_classic_callback");
 
+#if MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE
+    /* chunk transfers signal through the PAAL call which started them */
+    if (arm_uc_pal_classic_internal &&
+            ((event == PAL_IMAGE_EVENT_WRITE) || (event == PAL_IMAGE_EVENT_READTOBUFFER))) {
+        return;
+    }
+#endif
+
     switch (event) {
         case PAL_IMAGE_EVENT_INIT:
             arm_uc_pal_classic_signal_callback(ARM_UC_PAAL_EVENT_INITIALIZE_DONE);
@@ -217,6 +270,17 @@ arm_uc_error_t ARM_UC_Classic_PAL_Prepare(uint32_t location,
                             (xfer_size == buffer->size)) {
                         result.code = ERR_NONE;
 
+#if MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE
+                        /* discard data left over from an earlier image */
+                        arm_uc_write_combine_init(&arm_uc_pal_classic_write_combine,
+                                                  arm_uc_pal_classic_chunk_buffer,
+                                                  sizeof(arm_uc_pal_classic_chunk_buffer),
+                                                  1,
+                                                  arm_uc_pal_classic_program);
+                        arm_uc_pal_classic_location = location;
+                        arm_uc_pal_classic_read_size = 0;
+#endif
+
                         arm_uc_pal_classic_signal_callback(ARM_UC_PAAL_EVENT_PREPARE_DONE);
                     }
 
@@ -260,6 +324,27 @@ arm_uc_error_t ARM_UC_Classic_PAL_Write(uint32_t location,
     arm_uc_error_t result = { .code = ERR_INVALID_PARAMETER };
 
     if (buffer) {
+#if MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE
+        palStatus_t status = PAL_ERR_INVALID_ARGUMENT;
+
+        /* the read ahead chunk is stale once the image changes */
+        arm_uc_pal_classic_read_size = 0;
+
+        /* only the image set up by the last prepare is combined */
+        if (location == arm_uc_pal_classic_location) {
+            status = arm_uc_write_combine_program(&arm_uc_pal_classic_write_combine,
+                                                  buffer->ptr,
+                                                  offset,
+                                                  buffer->size);
+        }
+
+        if (status == PAL_SUCCESS) {
+            result.code = ERR_NONE;
+            arm_uc_pal_classic_signal_callback(ARM_UC_PAAL_EVENT_WRITE_DONE);
+        } else {
+            result.code = ERR_NOT_READY;
+        }
+#else
         palStatus_t status = pal_imageWrite(location,
                                             offset,
                                             (palConstBuffer_t *) buffer);
@@ -269,6 +354,7 @@ arm_uc_error_t ARM_UC_Classic_PAL_Write(uint32_t location,
         } else {
             result.code = ERR_NOT_READY;
         }
+#endif
     }
 
     return result;
@@ -286,7 +372,16 @@ arm_uc_error_t ARM_UC_Classic_PAL_Finalize(uint32_t location)
 {
     arm_uc_error_t result = { .code = ERR_NOT_READY };
 
+#if MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE
+    /* write what is left in the write combine buffer */
+    palStatus_t status = arm_uc_pal_classic_flush();
+
+    if (status == PAL_SUCCESS) {
+        status = pal_imageFinalize(location);
+    }
+#else
     palStatus_t status = pal_imageFinalize(location);
+#endif
 
     if (status == PAL_SUCCESS) {
         result.code = ERR_NONE;
@@ -317,9 +412,63 @@ arm_uc_error_t ARM_UC_Classic_PAL_Read(uint32_t location,
     arm_uc_error_t result = { .code = ERR_INVALID_PARAMETER };
 
     if (buffer) {
+#if MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE
+        /* data must be in the image before it is read back */
+        palStatus_t status = arm_uc_pal_classic_flush();
+
+        if ((status == PAL_SUCCESS) &&
+                (buffer->size_max < sizeof(arm_uc_pal_classic_chunk_buffer))) {
+            uint32_t read_end = arm_uc_pal_classic_read_offset + arm_uc_pal_classic_read_size;
+
+            /* read ahead a whole chunk unless the buffered one covers the request */
+            if ((location != arm_uc_pal_classic_read_location) ||
+                    (offset < arm_uc_pal_classic_read_offset) ||
+                    (offset + buffer->size_max > read_end)) {
+                palBuffer_t chunk = {
+                    .maxBufferLength = sizeof(arm_uc_pal_classic_chunk_buffer),
+                    .bufferLength = 0,
+                    .buffer = arm_uc_pal_classic_chunk_buffer
+                };
+
+                arm_uc_pal_classic_internal = true;
+                status = pal_imageReadToBuffer(location, offset, &chunk);
+                arm_uc_pal_classic_internal = false;
+
+                arm_uc_pal_classic_read_location = location;
+                arm_uc_pal_classic_read_offset = offset;
+                arm_uc_pal_classic_read_size = (status == PAL_SUCCESS) ? chunk.bufferLength : 0;
+                read_end = offset + arm_uc_pal_classic_read_size;
+            }
+
+            if (status == PAL_SUCCESS) {
+                /* a short read means the end of the image */
+                buffer->size = ARM_UC_util_min(buffer->size_max, read_end - offset);
+                memcpy(buffer->ptr,
+                       &arm_uc_pal_classic_chunk_buffer[offset - arm_uc_pal_classic_read_offset],
+                       buffer->size);
+
+                tr_debug("pal_imageReadToBuffer succeeded: %" PRIX32, buffer->size);
+                result.code = ERR_NONE;
+                arm_uc_pal_classic_signal_callback(ARM_UC_PAAL_EVENT_READ_DONE);
+            } else {
+                tr_error("pal_imageReadToBuffer failed");
+                result.code = ERR_NOT_READY;
+            }
+
+            return result;
+        }
+
+        /* buffers as large as a chunk are read directly */
+        if (status == PAL_SUCCESS) {
+            status = pal_imageReadToBuffer(location,
+                                           offset,
+                                           (palBuffer_t *) buffer);
+        }
+#else
         palStatus_t status = pal_imageReadToBuffer(location,
                                                    offset,
                                                    (palBuffer_t *) buffer);
+#endif
 
         if (status == PAL_SUCCESS) {
             tr_debug("pal_imageReadToBuffer succeeded: %" PRIX32, buffer->size);
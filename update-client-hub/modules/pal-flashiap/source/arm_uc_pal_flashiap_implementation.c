@@ -24,6 +24,7 @@
 #include "update-client-pal-flashiap/arm_uc_pal_flashiap.h"
 #include "update-client-pal-flashiap/arm_uc_pal_flashiap_platform.h"
 #include "update-client-metadata-header/arm_uc_metadata_header_v2.h"
+#include "update-client-common/arm_uc_utilities.h"
 
 #include <inttypes.h>
 #include <stddef.h>
@@ -52,6 +53,10 @@
 #define MBED_CONF_UPDATE_CLIENT_STORAGE_LOCATIONS 1
 #endif
 
+#ifndef MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE
+#define MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE 0
+#endif
+
 /* consistency check */
 #if (MBED_CONF_UPDATE_CLIENT_STORAGE_PAGE == 0)
 #error Update client storage page cannot be zero.
@@ -69,6 +74,10 @@
 #error Update client buffer must be divisible by the block page size
 #endif
 
+#if (MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE % MBED_CONF_UPDATE_CLIENT_STORAGE_PAGE) != 0
+#error Update client write combine size must be divisible by the block page size
+#endif
+
 #ifdef ARM_UC_CUSTOM_FW_DETAILS
 arm_uc_error_t ARM_UC_PAL_FlashIAP_GetCustomDetails(arm_uc_firmware_details_t *details);
 #endif
@@ -87,6 +96,12 @@ static uint64_t arm_uc_pal_flashiap_firmware_size = 0;
 
 static void (*arm_uc_pal_flashiap_callback)(uint32_t) = NULL;
 
+#if MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE
+/* fragments are collected here and programmed in write combine sized chunks */
+static uint8_t arm_uc_pal_flashiap_combine_buffer[MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE];
+static arm_uc_write_combine_t arm_uc_pal_flashiap_write_combine = { 0 };
+#endif
+
 static void arm_uc_pal_flashiap_signal_internal(uint32_t event)
 {
     if (arm_uc_pal_flashiap_callback) {
@@ -369,6 +384,15 @@ arm_uc_error_t ARM_UC_PAL_FlashIAP_Prepare(uint32_t slot_id,
         /* store firmware size in global */
         arm_uc_pal_flashiap_firmware_size = details->size;
 
+#if MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE
+        /* discard data left over from an earlier image */
+        arm_uc_write_combine_init(&arm_uc_pal_flashiap_write_combine,
+                                  arm_uc_pal_flashiap_combine_buffer,
+                                  sizeof(arm_uc_pal_flashiap_combine_buffer),
+                                  arm_uc_flashiap_get_page_size(),
+                                  arm_uc_flashiap_program);
+#endif
+
         /* signal done */
         arm_uc_pal_flashiap_signal_internal(ARM_UC_PAAL_EVENT_PREPARE_DONE);
     }
@@ -413,6 +437,31 @@ arm_uc_error_t ARM_UC_PAL_FlashIAP_Write(uint32_t slot_id,
         uint32_t physical_address = slot_addr + hdr_size + offset;
         uint32_t write_size = buffer->size;
 
+#if MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE
+        /* the write combine buffer pads the last chunk to a whole page */
+        bool last_chunk = ((offset + buffer->size) >= arm_uc_pal_flashiap_firmware_size);
+        if (((write_size % page_size == 0) || last_chunk) && (physical_address % page_size == 0)) {
+            UC_PAAL_TRACE("programming addr %" PRIX32 " size %" PRIX32,
+                          physical_address, write_size);
+            int status = arm_uc_write_combine_program(&arm_uc_pal_flashiap_write_combine,
+                                                      (const uint8_t *) buffer->ptr,
+                                                      physical_address,
+                                                      write_size);
+            if ((status == ARM_UC_FLASHIAP_SUCCESS) && last_chunk) {
+                status = arm_uc_write_combine_flush(&arm_uc_pal_flashiap_write_combine);
+            }
+            if (status != ARM_UC_FLASHIAP_SUCCESS) {
+                UC_PAAL_ERR_MSG("arm_uc_flashiap_program failed: %" PRIi32, status);
+            } else {
+                result.code = ERR_NONE;
+                arm_uc_pal_flashiap_signal_internal(ARM_UC_PAAL_EVENT_WRITE_DONE);
+            }
+        } else {
+            UC_PAAL_ERR_MSG("program size %" PRIX32 " or address %" PRIX32
+                            " not aligned to page size %" PRIX32, buffer->size,
+                            physical_address, page_size);
+        }
+#else
         /* if last chunk, pad out to page_size aligned size */
         if ((buffer->size % page_size != 0) &&
                 ((offset + buffer->size) >= arm_uc_pal_flashiap_firmware_size) &&
@@ -438,6 +487,7 @@ arm_uc_error_t ARM_UC_PAL_FlashIAP_Write(uint32_t slot_id,
                             " not aligned to page size %" PRIX32, buffer->size,
                             physical_address, page_size);
         }
+#endif
     } else {
         result.code = ERR_INVALID_PARAMETER;
     }
@@ -459,6 +509,16 @@ arm_uc_error_t ARM_UC_PAL_FlashIAP_Finalize(uint32_t slot_id)
 
     UC_PAAL_TRACE("ARM_UC_PAL_FlashIAP_Finalize");
 
+#if MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE
+    /* program what is left in the write combine buffer */
+    int32_t status = arm_uc_write_combine_flush(&arm_uc_pal_flashiap_write_combine);
+    if (status != ARM_UC_FLASHIAP_SUCCESS) {
+        UC_PAAL_ERR_MSG("arm_uc_flashiap_program failed: %" PRIi32, status);
+        result.code = ERR_INVALID_PARAMETER;
+        return result;
+    }
+#endif
+
     arm_uc_pal_flashiap_signal_internal(ARM_UC_PAAL_EVENT_FINALIZE_DONE);
 
     return result;
@@ -502,9 +562,19 @@ arm_uc_error_t ARM_UC_PAL_FlashIAP_Read(uint32_t slot_id,
         UC_PAAL_TRACE("reading addr %" PRIX32 " size %" PRIX32,
                       physical_address, read_size);
 
+#if MBED_CONF_UPDATE_CLIENT_STORAGE_WRITE_COMBINE_SIZE
+        /* data must be in flash before it is read back */
+        int status = arm_uc_write_combine_flush(&arm_uc_pal_flashiap_write_combine);
+        if (status == ARM_UC_FLASHIAP_SUCCESS) {
+            status = arm_uc_flashiap_read(buffer->ptr,
+                                          physical_address,
+                                          read_size);
+        }
+#else
         int status = arm_uc_flashiap_read(buffer->ptr,
                                           physical_address,
                                           read_size);
+#endif
 
         if (status == ARM_UC_FLASHIAP_SUCCESS) {
             result.code = ERR_NONE;
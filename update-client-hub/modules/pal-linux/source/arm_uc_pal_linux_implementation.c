@@ -25,6 +25,7 @@
 #include "update-client-pal-linux/arm_uc_pal_linux_implementation.h"
 #include "update-client-paal/arm_uc_paal_update_api.h"
 #include "update-client-pal-linux/arm_uc_pal_linux_ext.h"
+#include "update-client-pal-linux/arm_uc_pal_linux_writer.h"
 #include "update-client-hub/source/update_client_hub_state_machine.h"
 #include "update-client-metadata-header/arm_uc_metadata_header_v2.h"
 
@@ -182,6 +183,11 @@ arm_uc_error_t ARM_UC_PAL_Linux_Prepare(uint32_t location,
     if (details && buffer) {
         UC_PAAL_TRACE("details size: %" PRIu64, details->size);
 
+#if ARM_UC_PAL_LINUX_ASYNC_WRITE
+        /* a previous download may have been abandoned before finalize */
+        arm_uc_pal_linux_writer_close();
+#endif
+
         /* write header */
         result = arm_uc_pal_linux_internal_write_header(&location, details);
 
@@ -204,6 +210,11 @@ arm_uc_error_t ARM_UC_PAL_Linux_Prepare(uint32_t location,
                 FILE *descriptor = fopen(file_path, "wb");
 
                 if (descriptor != NULL) {
+#if ARM_UC_PAL_LINUX_ASYNC_WRITE
+                    /* reserve the blocks up front, so the writer does not have to */
+                    arm_uc_pal_linux_writer_allocate(fileno(descriptor), details->size);
+#endif
+
                     /* allocate space by writing empty file */
                     memset(buffer->ptr, 0, buffer->size_max);
                     buffer->size = buffer->size_max;
@@ -319,6 +330,35 @@ arm_uc_error_t ARM_UC_PAL_Linux_Write(uint32_t location,
         /* reverse default error code */
         result.code = ERR_NONE;
 
+#if ARM_UC_PAL_LINUX_ASYNC_WRITE
+        /* in normal write, fragments are written by the writer thread */
+        if (!arm_uc_worker_parameters.write) {
+            if (!arm_uc_pal_linux_writer_is_open()) {
+                char file_path[ARM_UC_MAXIMUM_FILE_AND_PATH_LENGTH] = { 0 };
+
+                /* construct firmware file path */
+                result = arm_uc_pal_linux_internal_file_path(file_path,
+                                                             ARM_UC_MAXIMUM_FILE_AND_PATH_LENGTH,
+                                                             ARM_UC_FIRMWARE_FOLDER_PATH,
+                                                             "firmware",
+                                                             &location);
+
+                if (result.error == ERR_NONE) {
+                    result = arm_uc_pal_linux_writer_open(file_path);
+                } else {
+                    UC_PAAL_ERR_MSG("firmware file name and path too long");
+                }
+            }
+
+            /* WRITE_DONE is signalled by the writer */
+            if (result.error == ERR_NONE) {
+                result = arm_uc_pal_linux_writer_write(offset, buffer);
+            }
+
+            return result;
+        }
+#endif
+
         /* open file if descriptor is not set */
         if (arm_uc_firmware_descriptor == NULL) {
             char file_path[ARM_UC_MAXIMUM_FILE_AND_PATH_LENGTH] = { 0 };
@@ -421,6 +461,11 @@ arm_uc_error_t ARM_UC_PAL_Linux_Finalize(uint32_t location)
 {
     arm_uc_error_t result = { .code = ERR_NONE };
 
+#if ARM_UC_PAL_LINUX_ASYNC_WRITE
+    /* write the remaining queued fragments and flush the file */
+    result = arm_uc_pal_linux_writer_close();
+#endif
+
     /* only close firmware file if descriptor is not NULL */
     if (arm_uc_firmware_descriptor != NULL) {
         /* close file */
@@ -34,6 +34,12 @@
 #include <stdlib.h>
 #include <sys/stat.h>
 #include <sys/wait.h>
+#ifdef ARM_UC_PAL_LINUX_HELPER_SOCKET
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
 
 #define TRACE_GROUP  "UCPI"
 
@@ -50,7 +56,7 @@ void arm_uc_pal_linux_signal_callback(uint32_t event, bool from_thread)
     if (arm_uc_pal_external_callback) {
         if (from_thread) {
             /* Run given callback in the update client's thread */
-            ARM_UC_PostCallback(&event_cb_storage, arm_uc_pal_external_callback, event);
+            arm_uc_pal_linux_post_callback(&event_cb_storage, event);
         } else {
             arm_uc_pal_external_callback(event);
         }
@@ -62,6 +68,13 @@ void arm_uc_pal_linux_signal_callback(uint32_t event, bool from_thread)
     }
 }
 
+void arm_uc_pal_linux_post_callback(arm_uc_callback_t *storage, uint32_t event)
+{
+    if (arm_uc_pal_external_callback) {
+        ARM_UC_PostCallback(storage, arm_uc_pal_external_callback, event);
+    }
+}
+
 void arm_uc_pal_linux_internal_set_callback(ARM_UC_PAAL_UPDATE_SignalEvent_t callback)
 {
     arm_uc_pal_external_callback = callback;
@@ -262,6 +275,112 @@ static bool arm_uc_pal_linux_internal_command(arm_ucp_worker_t *parameters,
     return valid;
 }
 
+#ifdef ARM_UC_PAL_LINUX_HELPER_SOCKET
+/**
+ * @brief Run command through the persistent helper process.
+ *
+ * @param command Script command.
+ * @param output Buffer for the script output, zero terminated, can be NULL.
+ * @param output_length Size of the output buffer.
+ * @return Exit status of the script, -1 if the helper is not running.
+ *         A failed request counts as a failed script, as the helper may
+ *         have started it.
+ */
+static int arm_uc_pal_linux_internal_helper(const char *command,
+                                            char *output,
+                                            size_t output_length)
+{
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+
+    if (strlen(ARM_UC_PAL_LINUX_HELPER_SOCKET) >= sizeof(address.sun_path)) {
+        return -1;
+    }
+    strcpy(address.sun_path, ARM_UC_PAL_LINUX_HELPER_SOCKET);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    if (connect(fd, (struct sockaddr *) &address, sizeof(address)) != 0) {
+        /* helper not running, not an error */
+        UC_PAAL_TRACE("helper not available: %s", strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    /* send command line */
+    size_t length = strlen(command);
+    size_t sent = 0;
+    int status = 1;
+
+    while (sent <= length) {
+        /* the newline ends the request */
+        const char *data = (sent < length) ? &command[sent] : "\n";
+        ssize_t written = send(fd, data, (sent < length) ? (length - sent) : 1, MSG_NOSIGNAL);
+
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            break;
+        }
+        sent += written;
+    }
+
+    /* read exit status line and the output after it, until the helper closes */
+    if (sent > length) {
+        bool status_read = false;
+        int parsed = 0;
+        size_t used = 0;
+        char buffer[64];
+        ssize_t received;
+
+        while ((received = recv(fd, buffer, sizeof(buffer), 0)) != 0) {
+            if (received < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                status_read = false;
+                break;
+            }
+            for (ssize_t index = 0; index < received; index++) {
+                if (!status_read) {
+                    if (buffer[index] == '\n') {
+                        status_read = true;
+                        status = parsed;
+                    } else if ((buffer[index] >= '0') && (buffer[index] <= '9') && (parsed < 256)) {
+                        parsed = 10 * parsed + (buffer[index] - '0');
+                    } else {
+                        /* malformed response */
+                        received = 0;
+                        break;
+                    }
+                } else if (output && (used + 1 < output_length)) {
+                    output[used++] = buffer[index];
+                }
+            }
+            if (received == 0) {
+                status_read = false;
+                break;
+            }
+        }
+
+        if (!status_read) {
+            UC_PAAL_ERR_MSG("invalid response from helper");
+            status = 1;
+        } else if (output && output_length) {
+            output[used] = '\0';
+        }
+    } else {
+        UC_PAAL_ERR_MSG("failed to send command to helper: %s", strerror(errno));
+    }
+
+    close(fd);
+    return status;
+}
+#endif
+
 arm_uc_error_t arm_uc_pal_linux_internal_read(const char *file_path,
                                               uint32_t offset,
                                               arm_uc_buffer_t *buffer)
@@ -596,6 +715,36 @@ void *arm_uc_pal_linux_extended_pre_worker(void *params)
                                                   command,
                                                   ARM_UC_MAXIMUM_COMMAND_LENGTH);
 
+#ifdef ARM_UC_PAL_LINUX_HELPER_SOCKET
+    /* run script through the helper if it is running */
+    if (valid) {
+        int status = arm_uc_pal_linux_internal_helper(command,
+                                                      file_path,
+                                                      sizeof(file_path));
+
+        if (status >= 0) {
+            UC_PAAL_TRACE("Extended pre-script command run by helper: %s", command);
+
+            /* trim non-printable characters */
+            for (size_t index = 0; file_path[index] != '\0'; index++) {
+                if (file_path[index] < ' ') {
+                    file_path[index] = '\0';
+                    break;
+                }
+            }
+
+            if (status == 0) {
+                result.code = ERR_NONE;
+            } else {
+                UC_PAAL_ERR_MSG("Script exited with non-zero status %" PRId32, status);
+            }
+
+            /* skip the shell */
+            valid = false;
+        }
+    }
+#endif
+
     /* command is valid */
     if (valid) {
         UC_PAAL_TRACE("Extended pre-script command: %s", command);
@@ -729,9 +878,16 @@ void *arm_uc_pal_linux_extended_post_worker(void *params)
     if (valid) {
         UC_PAAL_TRACE("Extended post-script command: %s", command);
 
-        /* execute script command */
-        error = system(command);
-        error = WEXITSTATUS(error);
+#ifdef ARM_UC_PAL_LINUX_HELPER_SOCKET
+        /* run script through the helper if it is running */
+        error = arm_uc_pal_linux_internal_helper(command, NULL, 0);
+        if (error < 0)
+#endif
+        {
+            /* execute script command */
+            error = system(command);
+            error = WEXITSTATUS(error);
+        }
 
         /* update valid flag */
         valid = (error == 0);
@@ -0,0 +1,275 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 Pelion Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#include "update-client-common/arm_uc_config.h"
+#if defined(ARM_UC_FEATURE_PAL_LINUX) && (ARM_UC_FEATURE_PAL_LINUX == 1)
+#if defined(TARGET_IS_PC_LINUX)
+#define _FILE_OFFSET_BITS  64
+#define _GNU_SOURCE
+
+#include "update-client-pal-linux/arm_uc_pal_linux_writer.h"
+#include "update-client-pal-linux/arm_uc_pal_linux_implementation_internal.h"
+#include "update-client-common/arm_uc_scheduler.h"
+
+#if ARM_UC_PAL_LINUX_ASYNC_WRITE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TRACE_GROUP  "UCPI"
+
+typedef struct {
+    uint8_t *ptr;
+    uint32_t capacity;
+    uint32_t size;
+    uint32_t offset;
+} arm_uc_pal_linux_writer_slot_t;
+
+/* Fragments waiting to be written are kept in a ring of slots. The slot at
+   head stays in use until the writer thread has written it. */
+static struct {
+    int fd;
+    bool open;
+    bool stop;
+    int error;
+    pthread_t thread;
+    uint32_t head;
+    uint32_t count;
+    /* write accepted while all slots were in use, WRITE_DONE is deferred */
+    const arm_uc_buffer_t *pending;
+    uint32_t pending_offset;
+    uint64_t unsynced;
+    arm_uc_pal_linux_writer_slot_t slots[ARM_UC_PAL_LINUX_WRITE_QUEUE_DEPTH];
+} arm_uc_writer = { .fd = -1 };
+
+static pthread_mutex_t arm_uc_writer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t arm_uc_writer_cond = PTHREAD_COND_INITIALIZER;
+
+/* storage for posting the deferred WRITE_DONE from the writer thread */
+static arm_uc_callback_t arm_uc_writer_cb_storage = { 0 };
+
+/* Copy a fragment to the next free slot, must be called with the mutex held. */
+static bool arm_uc_pal_linux_writer_enqueue(uint32_t offset, const arm_uc_buffer_t *buffer)
+{
+    arm_uc_pal_linux_writer_slot_t *slot =
+        &arm_uc_writer.slots[(arm_uc_writer.head + arm_uc_writer.count) % ARM_UC_PAL_LINUX_WRITE_QUEUE_DEPTH];
+
+    if (slot->capacity < buffer->size) {
+        uint8_t *ptr = realloc(slot->ptr, buffer->size);
+        if (ptr == NULL) {
+            return false;
+        }
+        slot->ptr = ptr;
+        slot->capacity = buffer->size;
+    }
+    memcpy(slot->ptr, buffer->ptr, buffer->size);
+    slot->size = buffer->size;
+    slot->offset = offset;
+    arm_uc_writer.count++;
+    pthread_cond_signal(&arm_uc_writer_cond);
+    return true;
+}
+
+static int arm_uc_pal_linux_writer_write_slot(const arm_uc_pal_linux_writer_slot_t *slot)
+{
+    uint32_t index = 0;
+    while (index < slot->size) {
+        ssize_t xfer_size = pwrite(arm_uc_writer.fd,
+                                   slot->ptr + index,
+                                   slot->size - index,
+                                   (off_t) slot->offset + index);
+        if (xfer_size < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        index += xfer_size;
+    }
+
+    /* Start write-back of what has been written so far, without waiting for
+       it. Failure only means the data is written back later. */
+    arm_uc_writer.unsynced += slot->size;
+    if (arm_uc_writer.unsynced >= ARM_UC_PAL_LINUX_WRITE_SYNC_BYTES) {
+        arm_uc_writer.unsynced = 0;
+        sync_file_range(arm_uc_writer.fd, 0, 0, SYNC_FILE_RANGE_WRITE);
+    }
+    return 0;
+}
+
+static void *arm_uc_pal_linux_writer_thread(void *arg)
+{
+    (void) arg;
+
+    pthread_mutex_lock(&arm_uc_writer_mutex);
+    for (;;) {
+        while (arm_uc_writer.count == 0 && !arm_uc_writer.stop) {
+            pthread_cond_wait(&arm_uc_writer_cond, &arm_uc_writer_mutex);
+        }
+        if (arm_uc_writer.count == 0) {
+            break;
+        }
+
+        /* the slot at head is not touched by the producer, write it unlocked */
+        const arm_uc_pal_linux_writer_slot_t *slot = &arm_uc_writer.slots[arm_uc_writer.head];
+        pthread_mutex_unlock(&arm_uc_writer_mutex);
+        int status = arm_uc_writer.error ? 0 : arm_uc_pal_linux_writer_write_slot(slot);
+        pthread_mutex_lock(&arm_uc_writer_mutex);
+
+        if (status != 0 && arm_uc_writer.error == 0) {
+            UC_PAAL_ERR_MSG("failed to write firmware: %s", strerror(status));
+            arm_uc_writer.error = status;
+        }
+        arm_uc_writer.head = (arm_uc_writer.head + 1) % ARM_UC_PAL_LINUX_WRITE_QUEUE_DEPTH;
+        arm_uc_writer.count--;
+
+        /* a slot is free, take the deferred fragment and release its buffer */
+        if (arm_uc_writer.pending) {
+            uint32_t event = ARM_UC_PAAL_EVENT_WRITE_DONE;
+            if (arm_uc_writer.error ||
+                    !arm_uc_pal_linux_writer_enqueue(arm_uc_writer.pending_offset, arm_uc_writer.pending)) {
+                event = ARM_UC_PAAL_EVENT_WRITE_ERROR;
+            }
+            arm_uc_writer.pending = NULL;
+            arm_uc_pal_linux_post_callback(&arm_uc_writer_cb_storage, event);
+        }
+    }
+    pthread_mutex_unlock(&arm_uc_writer_mutex);
+
+    return NULL;
+}
+
+void arm_uc_pal_linux_writer_allocate(int fd, uint64_t size)
+{
+    /* Only reserve the blocks. Unlike posix_fallocate() this does not fall
+       back to writing zeros on file systems that do not support it, and the
+       file size is left to grow with the written data. */
+    if (fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, (off_t) size) != 0) {
+        UC_PAAL_TRACE("fallocate not available: %s", strerror(errno));
+    }
+}
+
+arm_uc_error_t arm_uc_pal_linux_writer_open(const char *file_path)
+{
+    arm_uc_error_t result = { .code = ERR_NONE };
+
+    errno = 0;
+    int fd = open(file_path, O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        UC_PAAL_ERR_MSG("failed to open file: %s", strerror(errno));
+        result.code = ERR_INVALID_PARAMETER;
+    } else {
+        arm_uc_writer.fd = fd;
+        arm_uc_writer.stop = false;
+        arm_uc_writer.error = 0;
+        arm_uc_writer.head = 0;
+        arm_uc_writer.count = 0;
+        arm_uc_writer.pending = NULL;
+        arm_uc_writer.unsynced = 0;
+
+        int status = pthread_create(&arm_uc_writer.thread, NULL, arm_uc_pal_linux_writer_thread, NULL);
+        if (status != 0) {
+            UC_PAAL_ERR_MSG("failed to start writer thread: %s", strerror(status));
+            close(fd);
+            arm_uc_writer.fd = -1;
+            result.code = ERR_INVALID_PARAMETER;
+        } else {
+            arm_uc_writer.open = true;
+        }
+    }
+
+    return result;
+}
+
+bool arm_uc_pal_linux_writer_is_open(void)
+{
+    return arm_uc_writer.open;
+}
+
+arm_uc_error_t arm_uc_pal_linux_writer_write(uint32_t offset, const arm_uc_buffer_t *buffer)
+{
+    arm_uc_error_t result = { .code = ERR_NONE };
+    bool done = false;
+
+    pthread_mutex_lock(&arm_uc_writer_mutex);
+    if (arm_uc_writer.error || arm_uc_writer.pending) {
+        result.code = ERR_INVALID_PARAMETER;
+    } else if (arm_uc_writer.count < ARM_UC_PAL_LINUX_WRITE_QUEUE_DEPTH) {
+        if (arm_uc_pal_linux_writer_enqueue(offset, buffer)) {
+            done = true;
+        } else {
+            UC_PAAL_ERR_MSG("failed to allocate write buffer");
+            result.code = ERR_INVALID_PARAMETER;
+        }
+    } else {
+        /* all slots in use, the writer thread signals WRITE_DONE when it takes the fragment */
+        arm_uc_writer.pending = buffer;
+        arm_uc_writer.pending_offset = offset;
+    }
+    pthread_mutex_unlock(&arm_uc_writer_mutex);
+
+    if (done) {
+        arm_uc_pal_linux_signal_callback(ARM_UC_PAAL_EVENT_WRITE_DONE, false);
+    }
+
+    return result;
+}
+
+arm_uc_error_t arm_uc_pal_linux_writer_close(void)
+{
+    arm_uc_error_t result = { .code = ERR_NONE };
+
+    if (arm_uc_writer.open) {
+        pthread_mutex_lock(&arm_uc_writer_mutex);
+        arm_uc_writer.stop = true;
+        pthread_cond_signal(&arm_uc_writer_cond);
+        pthread_mutex_unlock(&arm_uc_writer_mutex);
+        pthread_join(arm_uc_writer.thread, NULL);
+        arm_uc_writer.open = false;
+
+        /* most of the image has already been written back, so this is short */
+        if (arm_uc_writer.error == 0 && fdatasync(arm_uc_writer.fd) != 0) {
+            arm_uc_writer.error = errno;
+        }
+        if (close(arm_uc_writer.fd) != 0 && arm_uc_writer.error == 0) {
+            arm_uc_writer.error = errno;
+        }
+        arm_uc_writer.fd = -1;
+
+        if (arm_uc_writer.error) {
+            UC_PAAL_ERR_MSG("failed to write firmware file: %s", strerror(arm_uc_writer.error));
+            result.code = ERR_INVALID_PARAMETER;
+        }
+
+        for (uint32_t index = 0; index < ARM_UC_PAL_LINUX_WRITE_QUEUE_DEPTH; index++) {
+            free(arm_uc_writer.slots[index].ptr);
+            arm_uc_writer.slots[index].ptr = NULL;
+            arm_uc_writer.slots[index].capacity = 0;
+        }
+    }
+
+    return result;
+}
+
+#endif // ARM_UC_PAL_LINUX_ASYNC_WRITE
+#endif // TARGET_IS_PC_LINUX
+#endif // ARM_UC_FEATURE_PAL_LINUX
@@ -20,6 +20,7 @@
 #define ARM_UC_PAL_LINUX_IMPLEMENTATION_INTERNAL_H
 
 #include "update-client-paal/arm_uc_paal_update_api.h"
+#include "update-client-common/arm_uc_scheduler.h"
 
 #include <stdbool.h>
 #include <stdio.h>
@@ -48,6 +49,20 @@
 #define ARM_UC_MAXIMUM_FILE_AND_PATH_LENGTH 128
 #define ARM_UC_MAXIMUM_COMMAND_LENGTH 256
 
+/* ARM_UC_PAL_LINUX_HELPER_SOCKET can be defined as the path of the Unix
+   socket of a persistent helper process which runs the script commands,
+   so that a shell is not started for every operation. The commands are
+   passed to the helper as they would be to the shell, one connection per
+   command:
+
+     request:  <script> <arguments>\n
+     response: <exit status>\n<script output>
+
+   The helper closes the connection after the response. The output is
+   used as the script output would be, the file path for the read and
+   details operations. If the helper is not running, the commands are run
+   through the shell as without it. */
+
 /* This is the type of the "post_runner" function in the worker struct below.
    This function is called if the worker's command executed succesfully.
    The callback returns the event that the worker will signal. */
@@ -89,6 +104,9 @@ typedef struct LinuxWorkerThreadInfo {
 
 void arm_uc_pal_linux_signal_callback(uint32_t event, bool from_thread);
 
+/* signal event from a thread other than a worker, using the given storage */
+void arm_uc_pal_linux_post_callback(arm_uc_callback_t *storage, uint32_t event);
+
 /* set module variables */
 void arm_uc_pal_linux_internal_set_callback(ARM_UC_PAAL_UPDATE_SignalEvent_t callback);
 void arm_uc_pal_linux_internal_set_offset(uint32_t offset);
@@ -0,0 +1,98 @@
+// ----------------------------------------------------------------------------
+// Copyright 2021 Pelion Ltd.
+//
+// SPDX-License-Identifier: Apache-2.0
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// ----------------------------------------------------------------------------
+
+#ifndef ARM_UC_PAL_LINUX_WRITER_H
+#define ARM_UC_PAL_LINUX_WRITER_H
+
+#include "update-client-paal/arm_uc_paal_update_api.h"
+
+#include <stdbool.h>
+
+/* Write firmware fragments from a background thread, so that the update
+   client does not wait for the disk while downloading. */
+#ifndef ARM_UC_PAL_LINUX_ASYNC_WRITE
+#define ARM_UC_PAL_LINUX_ASYNC_WRITE 1
+#endif
+
+/* Number of fragments that can wait for the writer thread. When all are in
+   use, WRITE_DONE is signalled once the writer has taken the fragment. */
+#ifndef ARM_UC_PAL_LINUX_WRITE_QUEUE_DEPTH
+#define ARM_UC_PAL_LINUX_WRITE_QUEUE_DEPTH 4
+#endif
+
+/* Amount of data written between requests to start write-back, so that the
+   kernel does not collect the whole image as dirty pages until finalize. */
+#ifndef ARM_UC_PAL_LINUX_WRITE_SYNC_BYTES
+#define ARM_UC_PAL_LINUX_WRITE_SYNC_BYTES (1024 * 1024)
+#endif
+
+#if ARM_UC_PAL_LINUX_WRITE_QUEUE_DEPTH < 1
+#error "ARM_UC_PAL_LINUX_WRITE_QUEUE_DEPTH must be at least 1"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Reserve disk space for the whole image without writing it.
+ * @details Failure is not an error, the space is then allocated as the
+ *          image is written.
+ *
+ * @param fd Descriptor of the firmware file.
+ * @param size Size of the image.
+ */
+void arm_uc_pal_linux_writer_allocate(int fd, uint64_t size);
+
+/**
+ * @brief Open the firmware file and start the writer thread.
+ *
+ * @param file_path Path of the existing firmware file.
+ * @return ERR_NONE on success.
+ */
+arm_uc_error_t arm_uc_pal_linux_writer_open(const char *file_path);
+
+/**
+ * @brief True if the writer thread is running.
+ */
+bool arm_uc_pal_linux_writer_is_open(void);
+
+/**
+ * @brief Queue a fragment for writing.
+ * @details The fragment is copied, and WRITE_DONE is signalled as soon as
+ *          the buffer can be reused. The write itself may complete later,
+ *          a failure is reported by the next write or by close.
+ *
+ * @param offset Offset in bytes to where the fragment should be written.
+ * @param buffer Fragment to write.
+ * @return ERR_NONE on accept.
+ */
+arm_uc_error_t arm_uc_pal_linux_writer_write(uint32_t offset, const arm_uc_buffer_t *buffer);
+
+/**
+ * @brief Write the queued fragments, flush the file and stop the writer thread.
+ *
+ * @return ERR_NONE if all fragments were written and flushed.
+ */
+arm_uc_error_t arm_uc_pal_linux_writer_close(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ARM_UC_PAL_LINUX_WRITER_H
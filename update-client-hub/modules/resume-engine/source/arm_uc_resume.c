@@ -84,6 +84,17 @@
 #define RESUME_MAXIMUM_ACTIVITY_TIME_MSECS  ((ARM_UC_RESUME_DEFAULT_MAXIMUM_DOWNLOAD_TIME_SECS)*1000)
 #endif
 
+// Spread of the randomisation applied to every attempt delay, as a percentage of the delay.
+// A wider spread keeps devices that lost the link at the same time from retrying in step.
+#if defined(MBED_CONF_UPDATE_CLIENT_RESUME_JITTER_PERCENT)
+#define RESUME_JITTER_PERCENT               MBED_CONF_UPDATE_CLIENT_RESUME_JITTER_PERCENT
+#else
+#define RESUME_JITTER_PERCENT               ARM_UC_RESUME_DEFAULT_JITTER_PERCENT
+#endif
+#if (RESUME_JITTER_PERCENT < 0) || (RESUME_JITTER_PERCENT > 100)
+#error "Resume jitter percentage must be between 0 and 100."
+#endif
+
 // Interval events, disabled by default.
 #define RESUME_INITIAL_INTERVAL_DELAY_MSECS   0
 #define RESUME_INITIAL_INTERVAL_COUNT         0
@@ -263,6 +274,7 @@ static void reset_on_start_values(arm_uc_resume_t *a_resume_p)
     if (a_resume_p != NULL) {
         a_resume_p->num_attempts = 0;
         a_resume_p->sum_total_period = 0;
+        a_resume_p->sum_stall_period = 0;
     }
 }
 
@@ -286,20 +298,18 @@ static void set_between(uint32_t *a_value_p, uint32_t a_low, uint32_t a_high)
 }
 
 // @brief Calculate an interval randomised around the given value.
-// @details Get a 25% (+-12.5%) randomisation of the base interval value,
-//          calculated by multiplying it by a 0-maxuint random factor,
+// @details Get a RESUME_JITTER_PERCENT (25% by default, +-12.5%) randomisation of the base
+//          interval value, calculated by multiplying it by a 0-maxuint random factor,
 //          and add/subtract it to the base by adding with offset.
 //          Picking these values because they are reasonable but quick to calculate.
 // @param an_interval The base interval around which to randomise.
-// @return Interval +/- some random part of one-eighth of the interval.
-#define RANGE_FRACTION_DIV 4
-#define BOUND_FRACTION_DIV 8
+// @return Interval +/- some random part of half the jitter range.
 static uint32_t randomised_interval(uint32_t an_interval)
 {
     // Calculate range for max amount of wiggle allowed in both directions total.
-    uint32_t range = an_interval / RANGE_FRACTION_DIV;
+    uint32_t range = (uint32_t)(((uint64_t) an_interval * RESUME_JITTER_PERCENT) / 100);
     // Calculate bound for max allowed wiggle *either* above or below the interval.
-    uint32_t bound = an_interval / BOUND_FRACTION_DIV;
+    uint32_t bound = range / 2;
     // Actual wiggle for this attempt.
     // Calculated by multiplying max allowed wiggle by a fraction of rand()/RAND_MAX.
     // Use (RAND_MAX+1) if is power-of-two and not zero
@@ -350,9 +360,47 @@ static void calc_next_attempt_jittered_delay(arm_uc_resume_t *a_resume_p, uint32
 static void calc_initial_attempt_jittered_delay(arm_uc_resume_t *a_resume_p)
 {
     UC_RESUME_TRACE_ENTRY(">> %s (%" PRIx32 ")", __func__, (uint32_t)a_resume_p);
-
+    if (a_resume_p == NULL) {
+        return;
+    }
     reset_on_cycle_values(a_resume_p);
-    calc_next_attempt_jittered_delay(a_resume_p, a_resume_p->attempt_initial_delay);
+    // Start from the delay after which earlier stalls came back, rather than spend
+    //   attempts on a link that has not been seen to recover that quickly.
+    uint32_t initial_delay = a_resume_p->attempt_initial_delay;
+    if (a_resume_p->learned_delay > initial_delay) {
+        initial_delay = a_resume_p->learned_delay;
+    }
+    calc_next_attempt_jittered_delay(a_resume_p, initial_delay);
+}
+
+/**
+ * @brief Learn from a stall that was ended by one or more resume attempts.
+ * @details If the first attempt ended it, an earlier attempt might have done so too,
+ *            so the learned delay moves back towards the initial delay. Otherwise it
+ *            moves towards the period the stall actually lasted.
+ * @param a_resume_p Pointer to the active resume structure.
+ */
+static void update_learned_delay(arm_uc_resume_t *a_resume_p)
+{
+    if (a_resume_p == NULL) {
+        return;
+    }
+    uint32_t observed = a_resume_p->sum_stall_period;
+    if (a_resume_p->num_attempts <= 1) {
+        observed = a_resume_p->attempt_initial_delay;
+    }
+    if (a_resume_p->learned_delay == 0) {
+        a_resume_p->learned_delay = observed;
+    } else {
+        // Smoothed with weight 1/4 for the new observation.
+        a_resume_p->learned_delay = a_resume_p->learned_delay - a_resume_p->learned_delay / 4 + observed / 4;
+    }
+    set_between(&a_resume_p->learned_delay, a_resume_p->attempt_initial_delay, a_resume_p->attempt_max_delay);
+    ++a_resume_p->num_recoveries;
+    UC_RESUME_TRACE("resume recovery %" PRIu32 " after %" PRIu32 " attempts, %" PRIu32
+                    " msecs, learned delay %" PRIu32 " msecs",
+                    a_resume_p->num_recoveries, a_resume_p->num_attempts,
+                    a_resume_p->sum_stall_period, a_resume_p->learned_delay);
 }
 
 /**
@@ -423,6 +471,7 @@ static void do_check_resume_activity(uintptr_t a_param)
         // Update summed periods, total and per attempt.
         a_resume_p->sum_total_period += a_resume_p->actual_delay;
         a_resume_p->sum_attempt_period += a_resume_p->actual_delay;
+        a_resume_p->sum_stall_period += a_resume_p->actual_delay;
 
         // Identify the current state of affairs for the resume probe.
         if (!a_resume_p->currently_resuming) {
@@ -695,6 +744,12 @@ arm_uc_error_t arm_uc_resume_resynch_monitoring(arm_uc_resume_t *a_resume_p)
         }
     }
     if (ARM_UC_IS_NOT_ERROR(result)) {
+        // Activity is back, learn from it if it took resume attempts to get here.
+        if (a_resume_p->num_attempts != 0) {
+            update_learned_delay(a_resume_p);
+        }
+        a_resume_p->sum_stall_period = 0;
+
         // Clear attempts control values and restore the prior jitter delay.
         // Jittered delay is kept the same as it was before the reset.
         reset_on_attempt_values(a_resume_p);
@@ -162,6 +162,11 @@ typedef struct {
     uint32_t sum_interval_delays;   // summed interval delays from start of attempt.
     uint32_t sum_attempt_period;    // summed period of current attempt cycle.
     uint32_t sum_total_period;      // summed total period of full operation since last resynch.
+
+    // measured recovery behaviour, kept across resume cycles.
+    uint32_t sum_stall_period;      // summed period since activity was last seen.
+    uint32_t learned_delay;         // smoothed period after which stalled activity came back.
+    uint32_t num_recoveries;        // number of stalls ended by a resume attempt.
 } arm_uc_resume_t;
 
 // Developer-facing #defines allow easier testing of parameterised resume.
@@ -183,6 +188,7 @@ typedef struct {
 #define ARM_UC_RESUME_DEFAULT_INITIAL_DELAY_SECS            30
 #define ARM_UC_RESUME_DEFAULT_MAXIMUM_DELAY_SECS            (60*60)
 #define ARM_UC_RESUME_DEFAULT_MAXIMUM_DOWNLOAD_TIME_SECS    (7*24*60*60)
+#define ARM_UC_RESUME_DEFAULT_JITTER_PERCENT                25
 
 /**
  * @brief Initialize a client resume-struct with values to be used for resuming.
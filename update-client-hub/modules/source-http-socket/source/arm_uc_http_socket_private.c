@@ -377,6 +377,8 @@ static void arm_uc_http_clear_socket_fields(void)
     context->socket = NULL;
     context->socket_state = STATE_DISCONNECTED;
     context->expected_socket_event = SOCKET_EVENT_UNDEFINED;
+    context->open_keep_alive = false;
+    context->open_reused = false;
 }
 
 static void arm_uc_http_clear_dns_cache_fields(void)
@@ -415,6 +417,11 @@ arm_uc_error_t arm_uc_http_socket_initialize(
         context->callback_handler = a_handler_p;
 
         arm_uc_http_clear_dns_cache_fields();
+
+        /* Start measuring the link afresh */
+        context->measured_rtt_msecs = 0;
+        context->measured_bytes_per_sec = 0;
+        frags_per_burst = ARM_UC_MULTI_FRAGS_PER_HTTP_BURST;
     }
     if (ARM_UC_IS_ERROR(status)) {
         UC_SRCE_TRACE("warning: on socket initialize = %" PRIx32, (uint32_t)status.code);
@@ -531,7 +538,7 @@ arm_uc_error_t arm_uc_http_socket_fatal_error(
         arm_uc_http_socket_error(an_error);
         /* If callback handler is set, generate error event */
         if (context->callback_handler != NULL) {
-            ARM_UC_PostCallback(NULL, context->callback_handler, an_error);
+            ARM_UC_PostPriorityCallback(NULL, context->callback_handler, an_error);
         }
     }
     if (ARM_UC_IS_ERROR(status)) {
@@ -1440,6 +1447,18 @@ arm_uc_error_t arm_uc_http_socket_process_header(void)
             ARM_UC_SET_ERROR(status, SRCE_ERR_FAILED);
         }
     }
+    if (ARM_UC_IS_NOT_ERROR(status)) {
+        /* HTTP/1.1 connections are persistent unless the server says otherwise.
+         * Only the header is searched, before it is trimmed away. */
+        const char close_tag[] = "Connection: close";
+        const char close_tag_lower[] = "connection: close";
+        context->open_keep_alive =
+            (arm_uc_strnstrn(request_buffer->ptr, context->header_end_index,
+                             (const uint8_t *) close_tag, sizeof(close_tag) - 1) == UINT32_MAX)
+            && (arm_uc_strnstrn(request_buffer->ptr, context->header_end_index,
+                                (const uint8_t *) close_tag_lower, sizeof(close_tag_lower) - 1) == UINT32_MAX);
+        UC_SRCE_TRACE_VERBOSE("keep-alive %s", context->open_keep_alive ? "yes" : "no");
+    }
     if (ARM_UC_IS_NOT_ERROR(status)) {
         if (((http_status_code >= 301) && (http_status_code <= 303))
                 || (http_status_code == 307)) {
@@ -1582,6 +1601,108 @@ bool arm_uc_open_http_socket_matches_request(void)
     return result;
 }
 
+/**
+ * @brief Check that the open connection can carry a new request.
+ * @details The last burst must have been read out completely, so that the next
+ *          response starts at the front of the stream, and the server must not
+ *          have asked to close the connection.
+ * @return Whether or not the request can be sent on the open connection.
+ */
+static bool arm_uc_open_http_socket_can_keep_alive(void)
+{
+    UC_SRCE_TRACE_ENTRY(">> %s ..", __func__);
+
+    bool result = false;
+
+#if defined(ARM_UC_HTTP_KEEP_ALIVE) && (ARM_UC_HTTP_KEEP_ALIVE == 1)
+    if (context == NULL) {
+        UC_SRCE_ERR_MSG("error: &context = NULL");
+    } else if (context->socket_state != STATE_CONNECTED_IDLE) {
+        UC_SRCE_TRACE_VERBOSE("!keep-alive: context->socket_state %" PRIu32 " != STATE_CONNECTED_IDLE",
+                              (uint32_t)context->socket_state);
+    } else if (!context->open_keep_alive) {
+        UC_SRCE_TRACE_VERBOSE("!keep-alive: closed by server");
+    } else if (context->open_request_type != RQST_TYPE_GET_FRAG
+               || context->open_burst_received != context->open_burst_expected) {
+        UC_SRCE_TRACE_VERBOSE("!keep-alive: response not fully read");
+    } else if (context->request_uri == NULL || context->open_request_uri == NULL) {
+        UC_SRCE_TRACE_VERBOSE("!keep-alive: no request");
+    } else if (context->request_uri->port != context->open_request_uri->port
+               || strcmp((const char *) context->request_uri->host, (const char *) context->open_request_uri->host)) {
+        UC_SRCE_TRACE_VERBOSE("!keep-alive: different server");
+    } else {
+        result = true;
+    }
+#endif
+    return result;
+}
+
+// LINK MEASUREMENT.
+// -----------------
+
+/**
+ * @brief Smooth a measurement with weight 1/4 for the new sample.
+ */
+static uint32_t arm_uc_http_socket_smooth(uint32_t an_average, uint32_t a_sample)
+{
+    if (an_average == 0) {
+        return a_sample;
+    }
+    return an_average - an_average / 4 + a_sample / 4;
+}
+
+/**
+ * @brief Measure the round trip from sending a request to receiving its header.
+ */
+static void arm_uc_http_socket_measure_rtt(void)
+{
+    context->open_header_ticks = pal_osKernelSysTick();
+    uint32_t rtt = (uint32_t)pal_osKernelSysMilliSecTick(context->open_header_ticks - context->open_request_ticks);
+    context->measured_rtt_msecs = arm_uc_http_socket_smooth(context->measured_rtt_msecs, rtt);
+    UC_SRCE_TRACE_VERBOSE("rtt %" PRIu32 " msecs, smoothed %" PRIu32, rtt, context->measured_rtt_msecs);
+}
+
+/**
+ * @brief Measure the throughput of a burst that has been read out, and size the next
+ *        bursts from the bandwidth-delay product.
+ * @details The time from the header to the end of the burst includes the time the
+ *          client spent storing the fragments, so this is the throughput the download
+ *          actually gets rather than the raw link speed.
+ */
+static void arm_uc_http_socket_adapt_burst(void)
+{
+    if ((frags_per_burst == 0)
+            || (context->open_request_type != RQST_TYPE_GET_FRAG)
+            || (context->open_burst_received != context->open_burst_expected)
+            || (context->open_burst_requested == 0)) {
+        return;
+    }
+    uint32_t elapsed = (uint32_t)pal_osKernelSysMilliSecTick(pal_osKernelSysTick() - context->open_header_ticks);
+    if (elapsed == 0) {
+        return;
+    }
+    uint32_t bytes_per_sec = (uint32_t)(((uint64_t) context->open_burst_expected * 1000) / elapsed);
+    context->measured_bytes_per_sec = arm_uc_http_socket_smooth(context->measured_bytes_per_sec, bytes_per_sec);
+
+    uint32_t frag_size = context->open_burst_requested / frags_per_burst;
+    uint64_t target = ((uint64_t) context->measured_bytes_per_sec * context->measured_rtt_msecs
+                       * ARM_UC_HTTP_ADAPTIVE_BURST_RTT_FACTOR) / 1000;
+    uint64_t frags = target / frag_size;
+    uint64_t most = ARM_UC_HTTP_ADAPTIVE_MAX_FRAGS_PER_BURST;
+    if (most < ARM_UC_MULTI_FRAGS_PER_HTTP_BURST) {
+        most = ARM_UC_MULTI_FRAGS_PER_HTTP_BURST;
+    }
+    if (frags < ARM_UC_MULTI_FRAGS_PER_HTTP_BURST) {
+        frags = ARM_UC_MULTI_FRAGS_PER_HTTP_BURST;
+    } else if (frags > most) {
+        frags = most;
+    }
+    frags_per_burst = (uint32_t) frags;
+
+    UC_SRCE_TRACE("link: rtt %" PRIu32 " msecs, %" PRIu32 " bytes/sec, %" PRIu32 " frags per burst",
+                  context->measured_rtt_msecs, context->measured_bytes_per_sec, frags_per_burst);
+}
+
 // EVENT HANDLING.
 // ---------------
 
@@ -1796,6 +1917,10 @@ void arm_uc_http_socket_callback(
                     context->resume_socket_phase = SOCKET_EVENT_LOOKUP_START;
                     if (arm_uc_open_http_socket_matches_request() && arm_uc_dns_lookup_is_cached()) {
                         status = arm_uc_http_prepare_skip_to_event(SOCKET_EVENT_LOOKUP_DONE);
+                    } else if (arm_uc_open_http_socket_can_keep_alive() && arm_uc_dns_lookup_is_cached()) {
+                        // Send the next request on the open connection.
+                        context->open_reused = true;
+                        status = arm_uc_http_prepare_skip_to_event(SOCKET_EVENT_LOOKUP_DONE);
                     } else {
                         // clear previous dns cache
                         arm_uc_http_clear_dns_cache_fields();
@@ -1865,6 +1990,7 @@ void arm_uc_http_socket_callback(
                 case SOCKET_EVENT_SEND_START:
                     UC_SRCE_TRACE_SM("event: send start");
                     context->resume_socket_phase = SOCKET_EVENT_SEND_START;
+                    context->open_request_ticks = pal_osKernelSysTick();
                     status = arm_uc_http_socket_send_request();
                     break;
 
@@ -1936,7 +2062,15 @@ void arm_uc_http_socket_callback(
                             }
                             break;
                         default:
-                            ARM_UC_SET_ERROR(status, SRCE_ERR_FAILED);
+                            if (context->open_reused) {
+                                // The server dropped the kept-alive connection while it was idle,
+                                //   so reconnect straight away rather than waiting for resume.
+                                UC_SRCE_TRACE("event: kept-alive connection lost, reconnecting");
+                                context->open_reused = false;
+                                status = arm_uc_http_prepare_skip_to_event(SOCKET_EVENT_LOOKUP_START);
+                            } else {
+                                ARM_UC_SET_ERROR(status, SRCE_ERR_FAILED);
+                            }
                             break;
                     }
                     break;
@@ -1950,6 +2084,8 @@ void arm_uc_http_socket_callback(
 
                 case SOCKET_EVENT_HEADER_DONE:
                     UC_SRCE_TRACE_SM("event: header done. Reset resume engine");
+                    context->open_reused = false;
+                    arm_uc_http_socket_measure_rtt();
                     arm_uc_resume_resynch_monitoring(&resume_http);
                     empty_receive = 0;
                     status = arm_uc_http_prepare_skip_to_event(SOCKET_EVENT_FRAG_START);
@@ -2038,10 +2174,13 @@ void arm_uc_http_socket_callback(
                     ARM_UC_PostCallback(NULL, context->callback_handler, UCS_HTTP_EVENT_DOWNLOAD);
 
                     // Socket has been mangled by bad link, give it a chance to clear itself up.
-                    if (frags_per_burst && context->number_of_pieces >= frags_per_burst) {
+                    // A connection the server keeps alive is left open for the next burst.
+                    if (frags_per_burst && context->number_of_pieces >= frags_per_burst
+                            && !arm_uc_open_http_socket_can_keep_alive()) {
 
                         arm_uc_http_socket_close();
                     }
+                    arm_uc_http_socket_adapt_burst();
                     break;
 
                 case SOCKET_EVENT_TIMER_FIRED:
@@ -2097,6 +2236,10 @@ void arm_uc_http_socket_callback(
                         context->resume_socket_phase = SOCKET_EVENT_CONNECT_START;
                         if (resume_http.num_attempts % 2 == 0) {
                             arm_uc_http_clear_dns_cache_fields();
+#if PAL_USE_DNS_CACHE && ((PAL_DNS_API_VERSION == 0) || (PAL_DNS_API_VERSION == 1))
+                            // The PAL cache would otherwise return the same address again
+                            pal_removeDNSCacheEntry(context->request_uri->host);
+#endif
                         }
                     }
                     if (!arm_uc_dns_lookup_is_cached()) {
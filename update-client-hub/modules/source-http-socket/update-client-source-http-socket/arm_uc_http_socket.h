@@ -110,6 +110,26 @@ typedef void (*ARM_UCS_HttpEvent_t)(uintptr_t event);
 #endif
 #endif
 
+// Upper bound for the burst size chosen from the measured bandwidth-delay product.
+// Bursts are never made smaller than ARM_UC_MULTI_FRAGS_PER_HTTP_BURST, so setting this
+//   to the same value turns the adaptation off. Not used if bursts are disabled.
+#if !defined(ARM_UC_HTTP_ADAPTIVE_MAX_FRAGS_PER_BURST)
+#define ARM_UC_HTTP_ADAPTIVE_MAX_FRAGS_PER_BURST    ARM_UC_MULTI_FRAGS_PER_HTTP_BURST__HEAVY
+#endif
+
+// A burst is sized to this many times the bandwidth-delay product, so that the round trip
+//   spent on each range request is a small part of the time spent receiving its data.
+#if !defined(ARM_UC_HTTP_ADAPTIVE_BURST_RTT_FACTOR)
+#define ARM_UC_HTTP_ADAPTIVE_BURST_RTT_FACTOR       16
+#endif
+
+// Keep the connection open between bursts, so that the next range request goes out
+//   on the same socket without a new DNS lookup, TCP connect and TLS handshake.
+// The connection is closed as before if the server answers with "Connection: close".
+#if !defined(ARM_UC_HTTP_KEEP_ALIVE)
+#define ARM_UC_HTTP_KEEP_ALIVE                      1
+#endif
+
 // Developer-facing #defines allow easier testing of parameterised resume.
 // If not available, it becomes extremely difficult to detect exactly when the resume
 //   functionality is taking place, or to set values outside of the assumed 'reasonable'
@@ -159,6 +179,17 @@ typedef struct {
     uint32_t header_end_index;
     uint32_t number_of_pieces;
 
+    /* server allows further requests on the connection */
+    bool open_keep_alive;
+    /* current request was sent on a kept-alive connection */
+    bool open_reused;
+
+    /* link measurements, used to size the bursts */
+    uint64_t open_request_ticks;    // when the current request was sent
+    uint64_t open_header_ticks;     // when the response header arrived
+    uint32_t measured_rtt_msecs;    // smoothed request to response header time
+    uint32_t measured_bytes_per_sec;// smoothed throughput of a full burst
+
     /* socket and socket timer management */
     arm_uc_http_socket_state_t socket_state;
     palTimerID_t socket_timeout_timer_id;
@@ -75,6 +75,37 @@ typedef struct {
 // Hold information about the request in flight, there will always only be one request in flight
 static request_t request_in_flight;
 
+#if defined(ARM_UC_PROFILE_MBED_CLOUD_CLIENT) && (ARM_UC_PROFILE_MBED_CLOUD_CLIENT == 1)
+
+// Choose the source for each firmware fragment from the throughput measured on
+// the previous fragments, instead of always using the source of lowest cost.
+#if defined(MBED_CONF_UPDATE_CLIENT_FIRMWARE_SOURCE_SELECTION)
+#define ARM_UC_SM_FIRMWARE_SOURCE_SELECTION MBED_CONF_UPDATE_CLIENT_FIRMWARE_SOURCE_SELECTION
+#else
+#define ARM_UC_SM_FIRMWARE_SOURCE_SELECTION 1
+#endif
+
+#endif // ARM_UC_PROFILE_MBED_CLOUD_CLIENT
+
+#if defined(ARM_UC_SM_FIRMWARE_SOURCE_SELECTION) && (ARM_UC_SM_FIRMWARE_SOURCE_SELECTION == 1)
+
+// every this many fragments, a source other than the fastest is measured again.
+#define FIRMWARE_PROBE_INTERVAL     16
+
+// Measured state of each source for the firmware being downloaded, reset
+// when the first fragment is requested.
+typedef struct {
+    uint32_t throughput;            // bytes per second, 0 until measured
+    uint32_t fragments;             // fragments fetched since the last measurement
+    uint8_t failed;                 // source has failed a fragment of this firmware
+} source_stats_t;
+
+static source_stats_t firmware_stats[MAX_SOURCES];
+static uint64_t firmware_request_ticks;
+static uint32_t firmware_fragments;
+
+#endif // ARM_UC_SM_FIRMWARE_SOURCE_SELECTION
+
 // FORWARD DECLARATIONS.
 // ---------------------
 
@@ -158,7 +189,7 @@ static void ARM_UCSM_DoAsyncBusyRetryGet(uintptr_t unused)
         //      the resume engine is *really* only designed to protect a single fragment,
         //        but this seems way too fragile to have around.
         ARM_UCSM_SetError(ARM_UC_ERROR(SOMA_ERR_UNSPECIFIED));
-        ARM_UC_PostCallback(&event_cb_storage, event_cb, ARM_UC_SM_EVENT_ERROR);
+        ARM_UC_PostPriorityCallback(&event_cb_storage, event_cb, ARM_UC_SM_EVENT_ERROR);
     } else if (ARM_UCSM_Get(&request_in_flight).error != ERR_NONE) {
         ARM_UCSM_ScheduleAsyncBusyRetryGet();
     }
@@ -390,6 +421,115 @@ static arm_uc_error_t ARM_UCSM_SourceRegistryGetLowestCost(arm_uc_uri_t *uri,
     }
 }
 
+#if defined(ARM_UC_SM_FIRMWARE_SOURCE_SELECTION) && (ARM_UC_SM_FIRMWARE_SOURCE_SELECTION == 1)
+
+/**
+ * @brief find the index of the source to fetch the next firmware fragment from.
+ * @details Sources that have not been measured yet are tried first, in order of
+ *          cost. After that the fastest source is used, except that every
+ *          FIRMWARE_PROBE_INTERVAL fragments the source measured longest ago is
+ *          used, so that the fragments are shared according to the current
+ *          throughput of each source. Sources that failed a fragment of this
+ *          firmware are only used when no other source is left.
+ * @param uri Struct containing URL.
+ * @param excludes Array of size MAX_SOURCES of sources to skip for this request.
+ * @param index Used to return the index of the selected source.
+ * @return error status.
+ */
+static arm_uc_error_t ARM_UCSM_SourceRegistryGetFirmwareSource(arm_uc_uri_t *uri,
+                                                               uint8_t *excludes,
+                                                               uint32_t *index)
+{
+    uint8_t skip[MAX_SOURCES];
+    uint32_t candidate = MAX_SOURCES;
+    bool probe = (++firmware_fragments % FIRMWARE_PROBE_INTERVAL) == 0;
+
+    UC_SRCE_TRACE_ENTRY(">> %s", __func__);
+
+    // first pass skips the failed sources, second pass allows them.
+    for (uint32_t pass = 0; (pass < 2) && (candidate == MAX_SOURCES); pass++) {
+        uint32_t unmeasured = MAX_SOURCES;
+        uint32_t unmeasured_cost = UINT32_MAX;
+
+        for (uint32_t i = 0; i < MAX_SOURCES; i++) {
+            skip[i] = (excludes[i] == 1) || ((pass == 0) && (firmware_stats[i].failed == 1));
+        }
+
+        // lowest cost also confirms that at least one source can serve the uri.
+        if (ARM_UCSM_SourceRegistryGetLowestCost(uri, QUERY_TYPE_FIRMWARE, skip, &candidate).error != ERR_NONE) {
+            candidate = MAX_SOURCES;
+            continue;
+        }
+
+        for (uint32_t i = 0; i < MAX_SOURCES; i++) {
+            uint32_t cost = UINT32_MAX;
+
+            if ((skip[i] == 1) || (source_registry[i] == NULL)
+                    || (source_registry[i]->GetCapabilities().firmware != 1)
+                    || (source_registry[i]->GetFirmwareURLCost(uri, &cost).error != ERR_NONE)) {
+                continue;
+            }
+            if (firmware_stats[i].throughput == 0) {
+                if (cost < unmeasured_cost) {
+                    unmeasured_cost = cost;
+                    unmeasured = i;
+                }
+            } else if (probe) {
+                if (firmware_stats[i].fragments > firmware_stats[candidate].fragments) {
+                    candidate = i;
+                }
+            } else if (firmware_stats[i].throughput > firmware_stats[candidate].throughput) {
+                candidate = i;
+            }
+        }
+        if (unmeasured != MAX_SOURCES) {
+            candidate = unmeasured;
+        }
+    }
+
+    if (candidate == MAX_SOURCES) {
+        UC_SRCE_ERR_MSG(".. %s: Error - No route", __func__);
+        return ARM_UCSM_SetError((arm_uc_error_t) { SOMA_ERR_NO_ROUTE_TO_SOURCE });
+    }
+    *index = candidate;
+    UC_SRCE_TRACE_VERBOSE("%s index = %" PRIu32, __func__, candidate);
+    return (arm_uc_error_t) { ERR_NONE };
+}
+
+/**
+ * @brief Record the throughput of the source that delivered a fragment.
+ */
+static void ARM_UCSM_RecordFirmwareFragment(const request_t *req)
+{
+    uint32_t elapsed = (uint32_t) pal_osKernelSysMilliSecTick(pal_osKernelSysTick() - firmware_request_ticks);
+    uint32_t sample = 0;
+
+    if (elapsed == 0) {
+        elapsed = 1;
+    }
+    sample = (uint32_t)(((uint64_t) req->buffer->size * 1000) / elapsed);
+
+    for (uint32_t i = 0; i < MAX_SOURCES; i++) {
+        firmware_stats[i].fragments++;
+    }
+
+    source_stats_t *stats = &firmware_stats[req->current_source];
+    if (stats->throughput == 0) {
+        stats->throughput = sample;
+    } else {
+        // smooth over the last few fragments, the latest carries a quarter.
+        stats->throughput = (uint32_t)(((uint64_t) stats->throughput * 3 + sample) / 4);
+    }
+    if (stats->throughput == 0) {
+        stats->throughput = 1;
+    }
+    stats->fragments = 0;
+    UC_SRCE_TRACE_VERBOSE("source %" PRIu32 " throughput %" PRIu32 " B/s",
+                          (uint32_t) req->current_source, stats->throughput);
+}
+
+#endif // ARM_UC_SM_FIRMWARE_SOURCE_SELECTION
+
 #if defined(ARM_UC_PROFILE_MBED_CLOUD_CLIENT) && (ARM_UC_PROFILE_MBED_CLOUD_CLIENT == 1)
 
 /**
@@ -414,6 +554,16 @@ static arm_uc_error_t ARM_UCSM_Get(request_t *req)
     }
 
     uint32_t index = 0;
+#if defined(ARM_UC_SM_FIRMWARE_SOURCE_SELECTION) && (ARM_UC_SM_FIRMWARE_SOURCE_SELECTION == 1)
+    if ((req->type == QUERY_TYPE_FIRMWARE) && (req->uri != NULL)) {
+        // pick by measured throughput, checking that call is valid.
+        retval = ARM_UCSM_SourceRegistryGetFirmwareSource(
+                     req->uri,
+                     req->excludes,
+                     &index);
+        firmware_request_ticks = pal_osKernelSysTick();
+    } else
+#endif
     if (retval.error == ERR_NONE) {
         // get the source of lowest cost, checking that call is valid.
         retval = ARM_UCSM_SourceRegistryGetLowestCost(
@@ -467,6 +617,11 @@ static arm_uc_error_t ARM_UCSM_Get(request_t *req)
         // failure, try source with the next smallest cost.
         ARM_UCSM_SetError(retval);
         req->excludes[index] = 1;
+#if defined(ARM_UC_SM_FIRMWARE_SOURCE_SELECTION) && (ARM_UC_SM_FIRMWARE_SOURCE_SELECTION == 1)
+        if (req->type == QUERY_TYPE_FIRMWARE) {
+            firmware_stats[index].failed = 1;
+        }
+#endif
         UC_SRCE_TRACE_VERBOSE(".. %s: Error - failure (try source with the next smallest cost)", __func__);
         retval = ARM_UCSM_Get(req);
     } else {
@@ -561,7 +716,7 @@ static void ARM_UCSM_AsyncRetryGet(uintptr_t unused)
     if (retval.error != ERR_NONE) {
         ARM_UCSM_RequestStructInit(&request_in_flight);
         ARM_UCSM_SetError(retval);
-        ARM_UC_PostCallback(&event_cb_storage, event_cb, ARM_UC_SM_EVENT_ERROR);
+        ARM_UC_PostPriorityCallback(&event_cb_storage, event_cb, ARM_UC_SM_EVENT_ERROR);
     }
     UC_SRCE_TRACE_EXIT(".. %s", __func__);
 }
@@ -615,6 +770,13 @@ static void ARM_UCSM_CallbackWrapper(uintptr_t source_event)
             && (request_in_flight.type != QUERY_TYPE_UNKNOWN)) {
         UC_SRCE_TRACE("ARM_UCSM_TranslateEvent event error == %" PRId16, event);
         request_in_flight.excludes[request_in_flight.current_source] = 1;
+#if defined(ARM_UC_SM_FIRMWARE_SOURCE_SELECTION) && (ARM_UC_SM_FIRMWARE_SOURCE_SELECTION == 1)
+        // fetch the rest of the firmware from the other sources where possible.
+        if ((request_in_flight.type == QUERY_TYPE_FIRMWARE)
+                && (request_in_flight.current_source < MAX_SOURCES)) {
+            firmware_stats[request_in_flight.current_source].failed = 1;
+        }
+#endif
         arm_uc_error_t retval = ARM_UCSM_Get(&request_in_flight);
         if (retval.code != ERR_NONE) {
             UC_SRCE_TRACE("ARM_UCSM_Get() retval.code == %" PRIx32, retval.code);
@@ -623,6 +785,13 @@ static void ARM_UCSM_CallbackWrapper(uintptr_t source_event)
             ARM_UC_PostCallback(&event_cb_storage, event_cb, event);
         }
     } else {
+#if defined(ARM_UC_SM_FIRMWARE_SOURCE_SELECTION) && (ARM_UC_SM_FIRMWARE_SOURCE_SELECTION == 1)
+        if ((event == ARM_UC_SM_EVENT_FIRMWARE)
+                && (request_in_flight.type == QUERY_TYPE_FIRMWARE)
+                && (request_in_flight.current_source < MAX_SOURCES)) {
+            ARM_UCSM_RecordFirmwareFragment(&request_in_flight);
+        }
+#endif
         ARM_UCSM_RequestStructInit(&request_in_flight);
         ARM_UC_PostCallback(&event_cb_storage, event_cb, event);
     }
@@ -693,6 +862,14 @@ arm_uc_error_t ARM_UCSM_GetCommon(
     request_in_flight.offset = offset;
     request_in_flight.type   = type;
 
+#if defined(ARM_UC_SM_FIRMWARE_SOURCE_SELECTION) && (ARM_UC_SM_FIRMWARE_SOURCE_SELECTION == 1)
+    // the first fragment starts a new firmware, measure all sources again.
+    if ((type == QUERY_TYPE_FIRMWARE) && (offset == 0)) {
+        memset(firmware_stats, 0, sizeof(firmware_stats));
+        firmware_fragments = 0;
+    }
+#endif
+
     arm_uc_error_t retval = ARM_UCSM_Get(&request_in_flight);
     if (retval.code != ERR_NONE) {
         ARM_UCSM_SetError(retval);
@@ -69,6 +69,11 @@
     #define PAL_SOCKET_USE_K_WORK_POLL 0
 #endif
 
+/* Drain the datagrams already queued in the socket with one poll resubmission per batch */
+#ifndef PAL_NET_DATAGRAM_BATCH_SUPPORT
+    #define PAL_NET_DATAGRAM_BATCH_SUPPORT 1
+#endif
+
 #ifndef PAL_DEFAULT_RTT_ESTIMATE
     #define PAL_DEFAULT_RTT_ESTIMATE 1
 #endif